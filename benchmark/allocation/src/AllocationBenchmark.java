@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class AllocationBenchmark {
+  // Above the large object threshold of the heap.
+  private static final int LARGE_ARRAY_LENGTH = 64 * 1024;
+
+  private static class Small {
+    int field;
+  }
+
+  private static class Medium {
+    long field0, field1, field2, field3, field4, field5, field6, field7;
+  }
+
+  // Keeps the last allocation reachable so that the allocations are not optimized away.
+  private Object sink;
+
+  public AllocationBenchmark() {
+    timeSmallObject(1);
+    timeMediumObject(1);
+    timeObjectArray(1);
+    timeByteArray(1);
+    timeLargeByteArray(1);
+    timeStringFromChars(1);
+  }
+
+  public void timeSmallObject(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new Small();
+    }
+  }
+
+  public void timeMediumObject(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new Medium();
+    }
+  }
+
+  public void timeObjectArray(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new Object[16];
+    }
+  }
+
+  public void timeByteArray(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new byte[128];
+    }
+  }
+
+  public void timeLargeByteArray(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new byte[LARGE_ARRAY_LENGTH];
+    }
+  }
+
+  private final char[] chars = "allocation benchmark".toCharArray();
+
+  public void timeStringFromChars(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new String(chars);
+    }
+  }
+}
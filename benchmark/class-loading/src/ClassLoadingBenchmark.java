@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Proxy;
+
+public class ClassLoadingBenchmark {
+  public interface Loaded {
+    void run();
+  }
+
+  public ClassLoadingBenchmark() throws Exception {
+    timeDefineProxyClass(1);
+    timeForNameLoaded(1);
+    timeForNameMissing(1);
+  }
+
+  // Every class loader gets its own proxy class, which the class linker creates, links and
+  // initializes like a loaded class.
+  public Class<?> timeDefineProxyClass(int reps) {
+    Class<?> result = null;
+    for (int i = 0; i < reps; i++) {
+      ClassLoader loader = new ClassLoader(ClassLoadingBenchmark.class.getClassLoader()) {};
+      result = Proxy.getProxyClass(loader, Loaded.class);
+    }
+    return result;
+  }
+
+  // The lookup through the class loader chain of a class that is already loaded.
+  public Class<?> timeForNameLoaded(int reps) throws Exception {
+    Class<?> result = null;
+    ClassLoader loader = ClassLoadingBenchmark.class.getClassLoader();
+    for (int i = 0; i < reps; i++) {
+      result = Class.forName("ClassLoadingBenchmark$Loaded", false, loader);
+    }
+    return result;
+  }
+
+  // The lookup of a class that does not exist, which throws.
+  public int timeForNameMissing(int reps) {
+    int result = 0;
+    ClassLoader loader = ClassLoadingBenchmark.class.getClassLoader();
+    for (int i = 0; i < reps; i++) {
+      try {
+        Class.forName("ClassLoadingBenchmark$Missing", false, loader);
+      } catch (ClassNotFoundException expected) {
+        result++;
+      }
+    }
+    return result;
+  }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.zip.CRC32;
+
+public class Crc32Benchmark {
+  private static final int SHORT_LENGTH = 16;
+  private static final int LONG_LENGTH = 4096;
+
+  private final byte[] bytes = new byte[LONG_LENGTH];
+  private final CRC32 crc32 = new CRC32();
+
+  public Crc32Benchmark() {
+    for (int i = 0; i < LONG_LENGTH; i++) {
+      bytes[i] = (byte) (i * 31);
+    }
+    timeCrc32UpdateByte(1);
+    timeCrc32UpdateShortArray(1);
+    timeCrc32UpdateLongArray(1);
+  }
+
+  public long timeCrc32UpdateByte(int reps) {
+    crc32.reset();
+    for (int i = 0; i < reps; i++) {
+      crc32.update(i);
+    }
+    return crc32.getValue();
+  }
+
+  public long timeCrc32UpdateShortArray(int reps) {
+    crc32.reset();
+    for (int i = 0; i < reps; i++) {
+      crc32.update(bytes, 0, SHORT_LENGTH);
+    }
+    return crc32.getValue();
+  }
+
+  public long timeCrc32UpdateLongArray(int reps) {
+    crc32.reset();
+    for (int i = 0; i < reps; i++) {
+      crc32.update(bytes, 0, LONG_LENGTH);
+    }
+    return crc32.getValue();
+  }
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class DispatchBenchmark {
+  private static final int RECEIVERS = 64;
+
+  interface Shape {
+    int sides();
+  }
+
+  static class Base implements Shape {
+    public int sides() { return 0; }
+  }
+  static class Triangle extends Base {
+    public int sides() { return 3; }
+  }
+  static class Square extends Base {
+    public int sides() { return 4; }
+  }
+  static class Pentagon extends Base {
+    public int sides() { return 5; }
+  }
+  static class Hexagon extends Base {
+    public int sides() { return 6; }
+  }
+
+  // An interface with more methods than the classes implement, so that its calls are not
+  // resolved by the first entry of the interface method table.
+  interface Visitor {
+    int visit0();
+    int visit1();
+    int visit2();
+    int visit3();
+  }
+
+  static class VisitorA implements Visitor {
+    public int visit0() { return 0; }
+    public int visit1() { return 1; }
+    public int visit2() { return 2; }
+    public int visit3() { return 3; }
+  }
+  static class VisitorB implements Visitor {
+    public int visit0() { return 4; }
+    public int visit1() { return 5; }
+    public int visit2() { return 6; }
+    public int visit3() { return 7; }
+  }
+
+  private final Base[] monomorphic = new Base[RECEIVERS];
+  private final Base[] megamorphic = new Base[RECEIVERS];
+  private final Shape[] monomorphicShapes = new Shape[RECEIVERS];
+  private final Shape[] megamorphicShapes = new Shape[RECEIVERS];
+  private final Visitor[] visitors = new Visitor[RECEIVERS];
+
+  public DispatchBenchmark() {
+    Base[] kinds = { new Triangle(), new Square(), new Pentagon(), new Hexagon() };
+    for (int i = 0; i < RECEIVERS; i++) {
+      monomorphic[i] = kinds[0];
+      megamorphic[i] = kinds[i % kinds.length];
+      monomorphicShapes[i] = kinds[0];
+      megamorphicShapes[i] = kinds[i % kinds.length];
+      visitors[i] = (i % 2 == 0) ? new VisitorA() : new VisitorB();
+    }
+    timeVirtualMonomorphic(1);
+    timeVirtualMegamorphic(1);
+    timeInterfaceMonomorphic(1);
+    timeInterfaceMegamorphic(1);
+    timeInterfaceLargeTable(1);
+  }
+
+  public int timeVirtualMonomorphic(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += monomorphic[i & (RECEIVERS - 1)].sides();
+    }
+    return result;
+  }
+
+  public int timeVirtualMegamorphic(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += megamorphic[i & (RECEIVERS - 1)].sides();
+    }
+    return result;
+  }
+
+  public int timeInterfaceMonomorphic(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += monomorphicShapes[i & (RECEIVERS - 1)].sides();
+    }
+    return result;
+  }
+
+  public int timeInterfaceMegamorphic(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += megamorphicShapes[i & (RECEIVERS - 1)].sides();
+    }
+    return result;
+  }
+
+  public int timeInterfaceLargeTable(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      Visitor visitor = visitors[i & (RECEIVERS - 1)];
+      result += visitor.visit3() - visitor.visit1();
+    }
+    return result;
+  }
+}
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+import java.util.concurrent.atomic.AtomicLong;
+
+/**
+ * Allocates with a configurable pattern from several threads and reports the allocation rate
+ * and the latencies seen by the threads, then the GC pause log of the runtime. See info.txt.
+ */
+public class GcStress {
+  // Allocations timed together, timing every allocation would cost more than most of them.
+  private static final int BATCH = 64;
+  // Slots of a reference array that are pointed at other live objects.
+  private static final int MAX_REFERENCES = 8;
+  private static final int REFERENCE_SIZE = 4;
+
+  private static int threads = 4;
+  private static long seconds = 10;
+  private static long allocations = 0;
+  private static long seed = 42;
+  private static int[] sizes;
+  private static int[] sizeWeights;
+  private static int[] lifetimes;
+  private static int[] lifetimeWeights;
+  private static double pointerDensity = 0.5;
+
+  private static final AtomicLong allocatedBytes = new AtomicLong();
+  private static volatile boolean stop = false;
+
+  public static void main(String[] args) throws Exception {
+    String sizeSpec = "16:70,64:20,512:9,65536:1";
+    String lifetimeSpec = "0:90,1000:9,100000:1";
+    for (int i = 0; i < args.length; i++) {
+      if (args[i].equals("--threads")) {
+        threads = Integer.parseInt(args[++i]);
+      } else if (args[i].equals("--seconds")) {
+        seconds = Long.parseLong(args[++i]);
+      } else if (args[i].equals("--allocations")) {
+        allocations = Long.parseLong(args[++i]);
+      } else if (args[i].equals("--seed")) {
+        seed = Long.parseLong(args[++i]);
+      } else if (args[i].equals("--sizes")) {
+        sizeSpec = args[++i];
+      } else if (args[i].equals("--lifetimes")) {
+        lifetimeSpec = args[++i];
+      } else if (args[i].equals("--pointer-density")) {
+        pointerDensity = Double.parseDouble(args[++i]);
+      } else {
+        usage();
+      }
+    }
+    int[][] parsed = parseDistribution(sizeSpec);
+    sizes = parsed[0];
+    sizeWeights = parsed[1];
+    parsed = parseDistribution(lifetimeSpec);
+    lifetimes = parsed[0];
+    lifetimeWeights = parsed[1];
+    if (threads < 1 || seconds < 1 || allocations < 0 || pointerDensity < 0
+        || pointerDensity > 1) {
+      usage();
+    }
+    System.out.println("threads " + threads + " seed " + seed + " sizes " + sizeSpec
+        + " lifetimes " + lifetimeSpec + " pointer density " + pointerDensity);
+
+    Worker[] workers = new Worker[threads];
+    Thread[] workerThreads = new Thread[threads];
+    for (int i = 0; i < threads; i++) {
+      workers[i] = new Worker(new Random(seed + i));
+      workerThreads[i] = new Thread(workers[i], "GcStress-" + i);
+    }
+    long start = System.nanoTime();
+    for (Thread thread : workerThreads) {
+      thread.start();
+    }
+    // Sample the allocation rate every second, until the time is up or the workers are done.
+    List<Long> rates = new ArrayList<Long>();
+    long lastBytes = 0;
+    for (long second = 1; allocations != 0 || second <= seconds; second++) {
+      boolean done = join(workerThreads, start + second * 1000000000L);
+      long bytes = allocatedBytes.get();
+      rates.add(bytes - lastBytes);
+      lastBytes = bytes;
+      if (done) {
+        break;
+      }
+    }
+    stop = true;
+    join(workerThreads, Long.MAX_VALUE);
+    long elapsed = System.nanoTime() - start;
+
+    long[] latencies = new long[Histogram.BUCKETS];
+    for (Worker worker : workers) {
+      worker.latencies.addTo(latencies);
+    }
+    StringBuilder rateLine = new StringBuilder("allocation rate per second (MB):");
+    for (long rate : rates) {
+      rateLine.append(String.format(" %.1f", rate / 1e6));
+    }
+    System.out.println(String.format("allocated %.1f MB in %.2f s, %.1f MB/s",
+        lastBytes / 1e6, elapsed / 1e9, lastBytes / 1e6 / (elapsed / 1e9)));
+    System.out.println(rateLine);
+    System.out.println(String.format(
+        "batch of %d allocations: p50 %.3f ms p99 %.3f ms p99.9 %.3f ms max %.3f ms", BATCH,
+        Histogram.percentile(latencies, 0.5) / 1e6, Histogram.percentile(latencies, 0.99) / 1e6,
+        Histogram.percentile(latencies, 0.999) / 1e6, Histogram.percentile(latencies, 1) / 1e6));
+    printPauseLog();
+  }
+
+  private static void usage() {
+    System.err.println("Usage: GcStress [--threads N] [--seconds S | --allocations N] "
+        + "[--seed X] [--sizes SIZE:WEIGHT,...] [--lifetimes ALLOCATIONS:WEIGHT,...] "
+        + "[--pointer-density P]");
+    System.exit(1);
+  }
+
+  // Parses "value:weight,..." into the values and the cumulative weights.
+  private static int[][] parseDistribution(String spec) {
+    String[] entries = spec.split(",");
+    int[] values = new int[entries.length];
+    int[] cumulativeWeights = new int[entries.length];
+    int total = 0;
+    for (int i = 0; i < entries.length; i++) {
+      String[] parts = entries[i].split(":");
+      if (parts.length != 2) {
+        usage();
+      }
+      values[i] = Integer.parseInt(parts[0]);
+      total += Integer.parseInt(parts[1]);
+      cumulativeWeights[i] = total;
+      if (values[i] < 0 || total <= 0) {
+        usage();
+      }
+    }
+    return new int[][] { values, cumulativeWeights };
+  }
+
+  private static int pick(Random random, int[] cumulativeWeights) {
+    int r = random.nextInt(cumulativeWeights[cumulativeWeights.length - 1]);
+    int i = 0;
+    while (r >= cumulativeWeights[i]) {
+      i++;
+    }
+    return i;
+  }
+
+  // Returns true if all the threads finished before the deadline.
+  private static boolean join(Thread[] threads, long deadline) throws InterruptedException {
+    for (Thread thread : threads) {
+      long remaining = deadline - System.nanoTime();
+      if (remaining <= 0) {
+        return false;
+      }
+      thread.join(Math.max(1, remaining / 1000000));
+      if (thread.isAlive()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  private static void printPauseLog() throws Exception {
+    String log = null;
+    try {
+      Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+      Method getRuntimeStat = vmDebug.getDeclaredMethod("getRuntimeStat", String.class);
+      log = (String) getRuntimeStat.invoke(null, "art.gc.pause-profile");
+    } catch (ReflectiveOperationException e) {
+      // Not running on ART, or libcore does not know the stat yet.
+    }
+    if (log != null) {
+      System.out.print(log);
+    } else {
+      System.out.println("no GC pause log, see the SIGQUIT dump or "
+          + "-XX:DumpGCPerformanceOnShutdown instead");
+    }
+  }
+
+  private static class Worker implements Runnable {
+    private final Random random;
+    // One ring of live objects per lifetime. Each ring is sized so that an object stays in it
+    // for about its lifetime in allocations of the thread.
+    private final Object[][] rings;
+    private final int[] ringPositions;
+    final Histogram latencies = new Histogram();
+
+    Worker(Random random) {
+      this.random = random;
+      rings = new Object[lifetimes.length][];
+      ringPositions = new int[lifetimes.length];
+      int totalWeight = lifetimeWeights[lifetimeWeights.length - 1];
+      for (int i = 0; i < lifetimes.length; i++) {
+        int weight = lifetimeWeights[i] - (i > 0 ? lifetimeWeights[i - 1] : 0);
+        long ringSize = Math.round((double) lifetimes[i] * weight / totalWeight);
+        rings[i] = new Object[lifetimes[i] == 0 ? 0 : (int) Math.max(1, ringSize)];
+      }
+    }
+
+    public void run() {
+      long allocated = 0;
+      while (!stop && (allocations == 0 || allocated < allocations)) {
+        long bytes = 0;
+        long start = System.nanoTime();
+        int batch = (int) (allocations == 0 ? BATCH : Math.min(BATCH, allocations - allocated));
+        for (int i = 0; i < batch; i++) {
+          bytes += allocate();
+        }
+        latencies.add(System.nanoTime() - start);
+        allocated += batch;
+        allocatedBytes.addAndGet(bytes);
+      }
+    }
+
+    private int allocate() {
+      int size = sizes[pick(random, sizeWeights)];
+      Object obj;
+      if (random.nextDouble() < pointerDensity) {
+        Object[] array = new Object[Math.max(1, size / REFERENCE_SIZE)];
+        int references = Math.min(array.length, MAX_REFERENCES);
+        for (int i = 0; i < references; i++) {
+          array[i] = randomLiveObject();
+        }
+        obj = array;
+      } else {
+        obj = new byte[size];
+      }
+      int lifetime = pick(random, lifetimeWeights);
+      Object[] ring = rings[lifetime];
+      if (ring.length != 0) {
+        ring[ringPositions[lifetime]] = obj;
+        ringPositions[lifetime] = (ringPositions[lifetime] + 1) % ring.length;
+      }
+      return size;
+    }
+
+    private Object randomLiveObject() {
+      Object[] ring = rings[random.nextInt(rings.length)];
+      return ring.length != 0 ? ring[random.nextInt(ring.length)] : null;
+    }
+  }
+
+  // Log linear histogram of nanoseconds with 8 sub-buckets per power of two, so within 12.5%.
+  private static class Histogram {
+    static final int SUB_BUCKET_BITS = 3;
+    static final int BUCKETS = 64 << SUB_BUCKET_BITS;
+
+    private final long[] counts = new long[BUCKETS];
+
+    void add(long ns) {
+      counts[bucket(Math.max(ns, 1))]++;
+    }
+
+    void addTo(long[] total) {
+      for (int i = 0; i < BUCKETS; i++) {
+        total[i] += counts[i];
+      }
+    }
+
+    static int bucket(long value) {
+      int exponent = 63 - Long.numberOfLeadingZeros(value);
+      if (exponent < SUB_BUCKET_BITS) {
+        return (int) value;
+      }
+      int mantissa =
+          (int) (value >>> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+      return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) | mantissa;
+    }
+
+    // Returns the upper bound of the bucket.
+    static long bucketLimit(int bucket) {
+      int exponent = (bucket >>> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+      if (exponent < SUB_BUCKET_BITS) {
+        return bucket;
+      }
+      long mantissa = bucket & ((1 << SUB_BUCKET_BITS) - 1);
+      return ((1L << SUB_BUCKET_BITS | mantissa) + 1 << (exponent - SUB_BUCKET_BITS)) - 1;
+    }
+
+    static long percentile(long[] counts, double per) {
+      long total = 0;
+      for (long count : counts) {
+        total += count;
+      }
+      long rank = Math.max(1, (long) Math.ceil(per * total));
+      long seen = 0;
+      for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+          return bucketLimit(i);
+        }
+      }
+      return 0;
+    }
+  }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Comparator;
+import java.util.List;
+
+/**
+ * Runs the public "time" methods of the benchmark classes, which take the number of repetitions
+ * as their only argument like the Caliper benchmarks they also are, and reports the time per
+ * repetition.
+ *
+ * Usage: BenchmarkRunner [--trials N] [--trial-ms MS] [--filter SUBSTRING] Class...
+ *
+ * Each method is first calibrated so that a trial takes about --trial-ms, then timed over
+ * --trials trials. The median, mean and standard deviation of the trials and their relative
+ * spread are printed one line per method, so that runs can be compared with a plain diff or
+ * a spreadsheet.
+ */
+public class BenchmarkRunner {
+  private static int trials = 10;
+  private static long trialNs = 100 * 1000 * 1000L;
+  private static String filter = null;
+
+  public static void main(String[] args) throws Exception {
+    List<String> classNames = new ArrayList<String>();
+    for (int i = 0; i < args.length; i++) {
+      if (args[i].equals("--trials")) {
+        trials = Integer.parseInt(args[++i]);
+      } else if (args[i].equals("--trial-ms")) {
+        trialNs = Long.parseLong(args[++i]) * 1000 * 1000;
+      } else if (args[i].equals("--filter")) {
+        filter = args[++i];
+      } else {
+        classNames.add(args[i]);
+      }
+    }
+    if (classNames.isEmpty() || trials < 2 || trialNs <= 0) {
+      System.err.println("Usage: BenchmarkRunner [--trials N] [--trial-ms MS] "
+          + "[--filter SUBSTRING] Class...");
+      System.exit(1);
+    }
+    System.out.println(String.format("%-60s %12s %12s %12s %8s",
+        "benchmark", "median ns", "mean ns", "stddev ns", "spread"));
+    for (String className : classNames) {
+      run(Class.forName(className));
+    }
+  }
+
+  private static void run(Class<?> benchmarkClass) throws Exception {
+    // The constructors warm up the benchmarks, see the existing benchmarks.
+    Object benchmark = benchmarkClass.newInstance();
+    Method[] methods = benchmarkClass.getMethods();
+    Arrays.sort(methods, new Comparator<Method>() {
+      public int compare(Method a, Method b) {
+        return a.getName().compareTo(b.getName());
+      }
+    });
+    for (Method method : methods) {
+      if (!method.getName().startsWith("time")
+          || Modifier.isStatic(method.getModifiers())
+          || !Arrays.equals(method.getParameterTypes(), new Class<?>[] { int.class })) {
+        continue;
+      }
+      String name = benchmarkClass.getSimpleName() + "." + method.getName().substring(4);
+      if (filter != null && !name.contains(filter)) {
+        continue;
+      }
+      report(name, time(benchmark, method));
+    }
+  }
+
+  // Returns the time per repetition of each trial.
+  private static double[] time(Object benchmark, Method method) throws Exception {
+    // Double the repetitions until a run takes at least a tenth of a trial, then scale up.
+    int reps = 1;
+    long ns;
+    while ((ns = timeReps(benchmark, method, reps)) < trialNs / 10 && reps < (1 << 29)) {
+      reps *= 2;
+    }
+    double scaledReps = reps * (double) trialNs / Math.max(ns, 1);
+    reps = (int) Math.max(1, Math.min(Integer.MAX_VALUE, scaledReps));
+
+    double[] results = new double[trials];
+    for (int i = 0; i < trials; i++) {
+      results[i] = (double) timeReps(benchmark, method, reps) / reps;
+    }
+    return results;
+  }
+
+  private static long timeReps(Object benchmark, Method method, int reps) throws Exception {
+    // Start every trial from a similar heap so allocation heavy benchmarks are comparable.
+    System.gc();
+    System.runFinalization();
+    long start = System.nanoTime();
+    method.invoke(benchmark, reps);
+    return System.nanoTime() - start;
+  }
+
+  private static void report(String name, double[] results) {
+    double[] sorted = results.clone();
+    Arrays.sort(sorted);
+    double median = (sorted[(sorted.length - 1) / 2] + sorted[sorted.length / 2]) / 2;
+    double mean = 0;
+    for (double result : results) {
+      mean += result;
+    }
+    mean /= results.length;
+    double variance = 0;
+    for (double result : results) {
+      variance += (result - mean) * (result - mean);
+    }
+    double stddev = Math.sqrt(variance / (results.length - 1));
+    // A spread above a few percent means the result is noise, not a regression.
+    double spread = (median != 0) ? stddev / median * 100 : 0;
+    System.out.println(String.format("%-60s %12.2f %12.2f %12.2f %7.1f%%",
+        name, median, mean, stddev, spread));
+  }
+}
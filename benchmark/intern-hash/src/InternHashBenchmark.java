@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class InternHashBenchmark {
+  private static final int STRINGS = 256;
+
+  // Equal to interned strings, but not interned themselves.
+  private final String[] copiesOfInterned = new String[STRINGS];
+  private final char[][] chars = new char[STRINGS][];
+  private int next;
+
+  public InternHashBenchmark() {
+    for (int i = 0; i < STRINGS; i++) {
+      String interned = ("interned benchmark string " + i).intern();
+      copiesOfInterned[i] = new String(interned.toCharArray());
+      chars[i] = ("hashed benchmark string of medium length " + i).toCharArray();
+    }
+    timeInternExisting(1);
+    timeInternNew(1);
+    timeHashCode(1);
+    timeHashCodeCached(1);
+  }
+
+  public int timeInternExisting(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += copiesOfInterned[i & (STRINGS - 1)].intern().length();
+    }
+    return result;
+  }
+
+  // Interns strings that were not interned before, so each repetition adds to the table.
+  public int timeInternNew(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += ("new interned string " + next++).intern().length();
+    }
+    return result;
+  }
+
+  // Includes the allocation of the string, whose hash code is not computed yet.
+  public int timeHashCode(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += new String(chars[i & (STRINGS - 1)]).hashCode();
+    }
+    return result;
+  }
+
+  public int timeHashCodeCached(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += copiesOfInterned[i & (STRINGS - 1)].hashCode();
+    }
+    return result;
+  }
+}
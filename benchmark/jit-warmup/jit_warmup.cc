@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <unistd.h>
+
+#include "jni.h"
+
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "runtime.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace {
+
+// The order of the counters that sampleJit fills in, see JitWarmupRunner.
+enum JitCounter {
+  kQueueLength,
+  kCompilations,
+  kOsrCompilations,
+  kCodeCacheSize,
+  kDataCacheSize,
+  kNumberOfJitCounters
+};
+
+extern "C" JNIEXPORT jboolean JNICALL Java_JitWarmupRunner_sampleJit(
+    JNIEnv* env, jclass, jlongArray counters) {
+  if (env->GetArrayLength(counters) != kNumberOfJitCounters) {
+    return JNI_FALSE;
+  }
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr) {
+    return JNI_FALSE;
+  }
+  jit::JitCodeCache* code_cache = jit->GetCodeCache();
+  jlong values[kNumberOfJitCounters];
+  values[kQueueLength] = jit->GetCompilationQueueLength(Thread::Current());
+  values[kCompilations] = code_cache->GetNumberOfCompilations();
+  values[kOsrCompilations] = code_cache->GetNumberOfOsrCompilations();
+  values[kCodeCacheSize] = code_cache->CodeCacheSize();
+  values[kDataCacheSize] = code_cache->DataCacheSize();
+  env->SetLongArrayRegion(counters, 0, kNumberOfJitCounters, values);
+  return JNI_TRUE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_JitWarmupRunner_dumpJitInfo(JNIEnv* env, jclass) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr) {
+    return env->NewStringUTF("JIT disabled\n");
+  }
+  std::ostringstream os;
+  jit->DumpInfo(os);
+  return env->NewStringUTF(os.str().c_str());
+}
+
+// Returns the time since the process started in milliseconds, from the start time in clock
+// ticks since boot of /proc/self/stat, or -1 if it cannot be read.
+extern "C" JNIEXPORT jlong JNICALL Java_JitWarmupRunner_processUptimeMs(JNIEnv*, jclass) {
+  std::string stat;
+  std::string uptime;
+  if (!ReadFileToString("/proc/self/stat", &stat) || !ReadFileToString("/proc/uptime", &uptime)) {
+    return -1;
+  }
+  // Skip the command name, which may contain spaces, then the 19 fields before the start time.
+  size_t pos = stat.rfind(')');
+  std::vector<std::string> fields;
+  if (pos != std::string::npos) {
+    Split(stat.substr(pos + 2), ' ', &fields);
+  }
+  if (fields.size() < 20u) {
+    return -1;
+  }
+  uint64_t start_ticks = strtoull(fields[19].c_str(), nullptr, 10);
+  double uptime_s = strtod(uptime.c_str(), nullptr);
+  return static_cast<jlong>(uptime_s * 1000) -
+      static_cast<jlong>(start_ticks * 1000 / sysconf(_SC_CLK_TCK));
+}
+
+}  // namespace
+}  // namespace art
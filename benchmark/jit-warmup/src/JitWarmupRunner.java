@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Measures how fast the JIT brings a benchmark to its steady state. A "time" method of a
+ * benchmark, see BenchmarkRunner, is run in batches of a fixed number of repetitions from the
+ * start of the process, without any calibration or warm-up of its own.
+ *
+ * Usage: JitWarmupRunner [--duration-ms MS] [--window-ms MS] [--batch REPS] [--dump-jit-info]
+ *            Class.timeMethod
+ *
+ * Every --window-ms, one line gives the time since the process started, the throughput in
+ * repetitions per second over the window, and the JIT queue length, compilations, OSR
+ * compilations and code and data cache sizes at its end. The summary gives the steady-state
+ * throughput, the median of the last quarter of the windows, and the time from the process
+ * start to the end of the first window reaching 90% of it.
+ */
+public class JitWarmupRunner {
+  private static final int NUM_JIT_COUNTERS = 5;
+
+  private static native boolean sampleJit(long[] counters);
+  private static native String dumpJitInfo();
+  private static native long processUptimeMs();
+
+  private static long durationNs = 10 * 1000 * 1000 * 1000L;
+  private static long windowNs = 100 * 1000 * 1000L;
+  private static int batch = 100;
+  private static boolean printJitInfo = false;
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary("artbenchmark");
+    // Take the reference times first, so that the setup below counts towards the warm-up.
+    long startNs = System.nanoTime();
+    long uptimeMs = processUptimeMs();
+
+    String benchmarkName = null;
+    for (int i = 0; i < args.length; i++) {
+      if (args[i].equals("--duration-ms")) {
+        durationNs = Long.parseLong(args[++i]) * 1000 * 1000;
+      } else if (args[i].equals("--window-ms")) {
+        windowNs = Long.parseLong(args[++i]) * 1000 * 1000;
+      } else if (args[i].equals("--batch")) {
+        batch = Integer.parseInt(args[++i]);
+      } else if (args[i].equals("--dump-jit-info")) {
+        printJitInfo = true;
+      } else {
+        benchmarkName = args[i];
+      }
+    }
+    int dot = (benchmarkName != null) ? benchmarkName.lastIndexOf('.') : -1;
+    if (dot <= 0 || windowNs <= 0 || durationNs < 4 * windowNs || batch <= 0) {
+      System.err.println("Usage: JitWarmupRunner [--duration-ms MS] [--window-ms MS] "
+          + "[--batch REPS] [--dump-jit-info] Class.timeMethod");
+      System.exit(1);
+    }
+    Class<?> benchmarkClass = Class.forName(benchmarkName.substring(0, dot));
+    Method method = benchmarkClass.getMethod(benchmarkName.substring(dot + 1), int.class);
+    Object benchmark = benchmarkClass.newInstance();
+
+    long[] counters = new long[NUM_JIT_COUNTERS];
+    if (!sampleJit(counters)) {
+      System.err.println("The JIT is not enabled, run with -Xusejit:true");
+      System.exit(1);
+    }
+    // The process may have started before main(), -1 if unknown.
+    long baseMs = (uptimeMs >= 0) ? uptimeMs : 0;
+    System.out.println(String.format("%10s %14s %6s %8s %6s %10s %10s",
+        "ms", "reps/s", "queue", "compiled", "osr", "code KB", "data KB"));
+
+    List<Double> throughputs = new ArrayList<Double>();
+    List<Long> windowEndsMs = new ArrayList<Long>();
+    long endNs = startNs + durationNs;
+    long windowStartNs = System.nanoTime();
+    while (windowStartNs < endNs) {
+      long windowEndNs = windowStartNs + windowNs;
+      long reps = 0;
+      long now;
+      do {
+        method.invoke(benchmark, batch);
+        reps += batch;
+        now = System.nanoTime();
+      } while (now < windowEndNs);
+      sampleJit(counters);
+      double throughput = reps * 1e9 / (now - windowStartNs);
+      long windowEndMs = baseMs + (now - startNs) / (1000 * 1000);
+      throughputs.add(throughput);
+      windowEndsMs.add(windowEndMs);
+      System.out.println(String.format("%10d %14.1f %6d %8d %6d %10d %10d",
+          windowEndMs, throughput, counters[0], counters[1], counters[2],
+          counters[3] / 1024, counters[4] / 1024));
+      windowStartNs = now;
+    }
+
+    report(benchmarkName, throughputs, windowEndsMs, uptimeMs >= 0);
+    if (printJitInfo) {
+      System.out.print(dumpJitInfo());
+    }
+  }
+
+  private static void report(String name,
+                             List<Double> throughputs,
+                             List<Long> windowEndsMs,
+                             boolean fromProcessStart) {
+    int size = throughputs.size();
+    double[] lastQuarter = new double[Math.max(1, size / 4)];
+    for (int i = 0; i < lastQuarter.length; i++) {
+      lastQuarter[i] = throughputs.get(size - lastQuarter.length + i);
+    }
+    Arrays.sort(lastQuarter);
+    double steadyState = (lastQuarter[(lastQuarter.length - 1) / 2]
+        + lastQuarter[lastQuarter.length / 2]) / 2;
+    long timeToPeakMs = -1;
+    for (int i = 0; i < size; i++) {
+      if (throughputs.get(i) >= 0.9 * steadyState) {
+        timeToPeakMs = windowEndsMs.get(i);
+        break;
+      }
+    }
+    System.out.println(String.format("%s: steady state %.1f reps/s, 90%% of it after %d ms%s",
+        name, steadyState, timeToPeakMs, fromProcessStart ? "" : " (from main)"));
+  }
+}
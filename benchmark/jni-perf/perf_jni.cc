@@ -34,6 +34,24 @@ extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfSOAUncheckedCall(JNI
   ScopedObjectAccessUnchecked soa(Thread::Current());
 }
 
+// Round trips between kNative and kRunnable without the cost of the JNI call around them.
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfSOARoundTrips(JNIEnv* env,
+                                                                         jobject,
+                                                                         jint count) {
+  for (jint i = 0; i < count; ++i) {
+    ScopedObjectAccess soa(env);
+  }
+}
+
+// The reverse round trips, from kRunnable to kNative and back, as done around blocking calls.
+extern "C" JNIEXPORT void JNICALL Java_JniPerfBenchmark_perfThreadSuspensionRoundTrips(
+    JNIEnv* env, jobject, jint count) {
+  ScopedObjectAccess soa(env);
+  for (jint i = 0; i < count; ++i) {
+    ScopedThreadSuspension sts(soa.Self(), kNative);
+  }
+}
+
 }  // namespace
 
 }  // namespace art
@@ -20,6 +20,8 @@ public class JniPerfBenchmark {
   native void perfJniEmptyCall();
   native void perfSOACall();
   native void perfSOAUncheckedCall();
+  native void perfSOARoundTrips(int count);
+  native void perfThreadSuspensionRoundTrips(int count);
 
   public void timeFastJNI(int N) {
     // TODO: This might be an intrinsic.
@@ -46,6 +48,14 @@ public class JniPerfBenchmark {
     }
   }
 
+  public void timeSOARoundTrip(int N) {
+    perfSOARoundTrips(N);
+  }
+
+  public void timeThreadSuspensionRoundTrip(int N) {
+    perfThreadSuspensionRoundTrips(N);
+  }
+
   {
     System.loadLibrary("artbenchmark");
   }
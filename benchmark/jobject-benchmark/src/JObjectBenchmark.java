@@ -34,4 +34,24 @@ public class JObjectBenchmark {
   public native void timeAddRemoveWeakGlobal(int reps);
   public native void timeDecodeWeakGlobal(int reps);
   public native void timeDecodeHandleScopeRef(int reps);
+
+  // Add and remove globals on several threads at once, each doing `reps` iterations.
+  public void timeAddRemoveGlobalThreads(final int reps) throws InterruptedException {
+    Thread[] threads = new Thread[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+      threads[i] = new Thread() {
+        public void run() {
+          timeAddRemoveGlobal(reps);
+        }
+      };
+    }
+    for (Thread thread : threads) {
+      thread.start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+  }
+
+  private static final int NUM_THREADS = 4;
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class MonitorBenchmark {
+  private final Object thinLock = new Object();
+  private final Object fatLock = new Object();
+  private final Object contendedLock = new Object();
+  private int counter;
+
+  public MonitorBenchmark() throws InterruptedException {
+    // Waiting on a monitor inflates it, and monitors are not deflated while they are in use.
+    synchronized (fatLock) {
+      fatLock.wait(1);
+    }
+    timeThin(1);
+    timeFat(1);
+    timeContended(1);
+    timeNested(1);
+  }
+
+  public int timeThin(int reps) {
+    for (int i = 0; i < reps; i++) {
+      synchronized (thinLock) {
+        counter++;
+      }
+    }
+    return counter;
+  }
+
+  public int timeFat(int reps) {
+    for (int i = 0; i < reps; i++) {
+      synchronized (fatLock) {
+        counter++;
+      }
+    }
+    return counter;
+  }
+
+  public int timeNested(int reps) {
+    // Recursive locking only updates the count in the lock word.
+    for (int i = 0; i < reps; i++) {
+      synchronized (thinLock) {
+        synchronized (thinLock) {
+          counter++;
+        }
+      }
+    }
+    return counter;
+  }
+
+  // Another thread takes the same lock in a loop for the whole run.
+  public int timeContended(int reps) throws InterruptedException {
+    final boolean[] stop = new boolean[1];
+    Thread other = new Thread() {
+      public void run() {
+        while (true) {
+          synchronized (contendedLock) {
+            if (stop[0]) {
+              return;
+            }
+            counter++;
+          }
+        }
+      }
+    };
+    other.start();
+    for (int i = 0; i < reps; i++) {
+      synchronized (contendedLock) {
+        counter++;
+      }
+    }
+    synchronized (contendedLock) {
+      stop[0] = true;
+    }
+    other.join();
+    return counter;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Constructor;
+import java.lang.reflect.Field;
+import java.lang.reflect.Method;
+
+public class ReflectionBenchmark {
+  public int field;
+
+  public static int staticMethod(int value) {
+    return value + 1;
+  }
+
+  public int virtualMethod(int value) {
+    return value + field;
+  }
+
+  private final Method staticMethod;
+  private final Method virtualMethod;
+  private final Field intField;
+  private final Constructor<ReflectionBenchmark> constructor;
+
+  public ReflectionBenchmark() throws Exception {
+    staticMethod = ReflectionBenchmark.class.getMethod("staticMethod", int.class);
+    virtualMethod = ReflectionBenchmark.class.getMethod("virtualMethod", int.class);
+    intField = ReflectionBenchmark.class.getField("field");
+    constructor = ReflectionBenchmark.class.getConstructor(boolean.class);
+    timeInvokeStatic(1);
+    timeInvokeVirtual(1);
+    timeFieldGetInt(1);
+    timeNewInstance(1);
+    timeGetMethod(1);
+  }
+
+  public ReflectionBenchmark(boolean unused) {
+    staticMethod = null;
+    virtualMethod = null;
+    intField = null;
+    constructor = null;
+  }
+
+  public int timeInvokeStatic(int reps) throws Exception {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += (Integer) staticMethod.invoke(null, i);
+    }
+    return result;
+  }
+
+  public int timeInvokeVirtual(int reps) throws Exception {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += (Integer) virtualMethod.invoke(this, i);
+    }
+    return result;
+  }
+
+  public int timeFieldGetInt(int reps) throws Exception {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += intField.getInt(this);
+    }
+    return result;
+  }
+
+  public Object timeNewInstance(int reps) throws Exception {
+    Object result = null;
+    for (int i = 0; i < reps; i++) {
+      result = constructor.newInstance(false);
+    }
+    return result;
+  }
+
+  public Method timeGetMethod(int reps) throws Exception {
+    Method result = null;
+    for (int i = 0; i < reps; i++) {
+      result = ReflectionBenchmark.class.getMethod("virtualMethod", int.class);
+    }
+    return result;
+  }
+}
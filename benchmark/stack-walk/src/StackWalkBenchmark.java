@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StackWalkBenchmark {
+  public StackWalkBenchmark() {
+    timeFillInStackTraceShallow(1);
+    timeFillInStackTraceDeep(1);
+    timeGetStackTrace(1);
+    timeThreadGetStackTrace(1);
+  }
+
+  // Calls `action` with `depth` more frames on the stack.
+  private static int recurse(int depth, Runnable action) {
+    if (depth == 0) {
+      action.run();
+      return 0;
+    }
+    return recurse(depth - 1, action) + 1;
+  }
+
+  private static class FillInStackTrace implements Runnable {
+    private final int reps;
+    Throwable last;
+
+    FillInStackTrace(int reps) {
+      this.reps = reps;
+    }
+
+    public void run() {
+      for (int i = 0; i < reps; i++) {
+        last = new Throwable();
+      }
+    }
+  }
+
+  public void timeFillInStackTraceShallow(int reps) {
+    recurse(0, new FillInStackTrace(reps));
+  }
+
+  public void timeFillInStackTraceDeep(int reps) {
+    recurse(100, new FillInStackTrace(reps));
+  }
+
+  // Includes turning the internal stack trace into StackTraceElements.
+  public void timeGetStackTrace(final int reps) {
+    recurse(20, new Runnable() {
+      public void run() {
+        for (int i = 0; i < reps; i++) {
+          new Throwable().getStackTrace();
+        }
+      }
+    });
+  }
+
+  public void timeThreadGetStackTrace(final int reps) {
+    recurse(20, new Runnable() {
+      public void run() {
+        for (int i = 0; i < reps; i++) {
+          Thread.currentThread().getStackTrace();
+        }
+      }
+    });
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Arrays;
+
+public class StringIntrinsicsBenchmark {
+  private static final int LENGTH = 1024;
+
+  private final String string1;
+  private final String string2;
+  private final byte[] bytes1 = new byte[LENGTH];
+  private final byte[] bytes2 = new byte[LENGTH];
+  private final char[] chars1 = new char[LENGTH];
+  private final char[] chars2 = new char[LENGTH];
+  private final int[] ints1 = new int[LENGTH];
+  private final int[] ints2 = new int[LENGTH];
+
+  public StringIntrinsicsBenchmark() {
+    // Only the last character differs, so that all the data is looked at.
+    char[] data = new char[LENGTH];
+    Arrays.fill(data, 'a');
+    string1 = new String(data);
+    data[LENGTH - 1] = 'b';
+    string2 = new String(data);
+    timeStringEquals(1);
+    timeStringCompareTo(1);
+    timeStringIndexOf(1);
+    timeArraysEqualsByte(1);
+    timeArraysEqualsChar(1);
+    timeArraysEqualsInt(1);
+    timeArraysFillByte(1);
+    timeArraysFillChar(1);
+    timeArraysFillInt(1);
+  }
+
+  public boolean timeStringEquals(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; i++) {
+      result ^= string1.equals(string2);
+    }
+    return result;
+  }
+
+  public int timeStringCompareTo(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += string1.compareTo(string2);
+    }
+    return result;
+  }
+
+  public int timeStringIndexOf(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += string2.indexOf('b');
+    }
+    return result;
+  }
+
+  public boolean timeArraysEqualsByte(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; i++) {
+      result ^= Arrays.equals(bytes1, bytes2);
+    }
+    return result;
+  }
+
+  public boolean timeArraysEqualsChar(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; i++) {
+      result ^= Arrays.equals(chars1, chars2);
+    }
+    return result;
+  }
+
+  public boolean timeArraysEqualsInt(int reps) {
+    boolean result = false;
+    for (int i = 0; i < reps; i++) {
+      result ^= Arrays.equals(ints1, ints2);
+    }
+    return result;
+  }
+
+  public void timeArraysFillByte(int reps) {
+    for (int i = 0; i < reps; i++) {
+      Arrays.fill(bytes1, (byte) i);
+    }
+  }
+
+  public void timeArraysFillChar(int reps) {
+    for (int i = 0; i < reps; i++) {
+      Arrays.fill(chars1, (char) i);
+    }
+  }
+
+  public void timeArraysFillInt(int reps) {
+    for (int i = 0; i < reps; i++) {
+      Arrays.fill(ints1, i);
+    }
+  }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class SuspendCheckBenchmark {
+  private static final int LOOP_COUNT = 1000;
+
+  private final int[] array = new int[LOOP_COUNT];
+  private int counter;
+  private volatile boolean stopSuspending;
+
+  public SuspendCheckBenchmark() throws InterruptedException {
+    for (int i = 0; i < array.length; i++) {
+      array[i] = i;
+    }
+    timeEmptyLoop(1);
+    timeArraySum(1);
+    timeNestedLoops(1);
+    timeSuspended(1);
+  }
+
+  // The loop body is a single add, the suspend check is most of the back edge.
+  public int timeEmptyLoop(int reps) {
+    int result = counter;
+    for (int i = 0; i < reps; i++) {
+      for (int j = 0; j < LOOP_COUNT; j++) {
+        result += j;
+      }
+    }
+    counter = result;
+    return result;
+  }
+
+  public int timeArraySum(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      for (int j = 0; j < array.length; j++) {
+        result += array[j];
+      }
+    }
+    return result;
+  }
+
+  public int timeNestedLoops(int reps) {
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      for (int j = 0; j < 32; j++) {
+        for (int k = 0; k < 32; k++) {
+          result += j ^ k;
+        }
+      }
+    }
+    return result;
+  }
+
+  // Another thread keeps taking the stack trace of the looping thread, which suspends it, so
+  // that the suspend checks of the loop are actually taken.
+  public int timeSuspended(int reps) throws InterruptedException {
+    final Thread looper = Thread.currentThread();
+    stopSuspending = false;
+    Thread other = new Thread() {
+      public void run() {
+        while (!stopSuspending) {
+          looper.getStackTrace();
+        }
+      }
+    };
+    other.start();
+    int result = 0;
+    for (int i = 0; i < reps; i++) {
+      result += timeEmptyLoop(1);
+    }
+    stopSuspending = true;
+    other.join();
+    return result;
+  }
+}
@@ -26,6 +26,7 @@ GTEST_DEX_DIRECTORIES := \
   AbstractMethod \
   AllFields \
   ExceptionHandle \
+  FastNativeMethods \
   GetMethodSignature \
   Instrumentation \
   Interfaces \
@@ -67,9 +68,10 @@ $(ART_TEST_TARGET_GTEST_MainStripped_DEX): $(ART_TEST_TARGET_GTEST_Main_DEX)
 # Dex file dependencies for each gtest.
 ART_GTEST_dex2oat_environment_tests_DEX_DEPS := Main MainStripped MultiDex MultiDexModifiedSecondary Nested
 
-ART_GTEST_class_linker_test_DEX_DEPS := Interfaces MultiDex MyClass Nested Statics StaticsFromCode
+ART_GTEST_class_linker_test_DEX_DEPS := FastNativeMethods Interfaces MultiDex MyClass Nested Statics StaticsFromCode
 ART_GTEST_compiler_driver_test_DEX_DEPS := AbstractMethod StaticLeafMethods ProfileTestMultiDex
 ART_GTEST_dex_cache_test_DEX_DEPS := Main
+ART_GTEST_dex_layout_optimizer_test_DEX_DEPS := StaticLeafMethods
 ART_GTEST_dex_file_test_DEX_DEPS := GetMethodSignature Main Nested
 ART_GTEST_dex2oat_test_DEX_DEPS := $(ART_GTEST_dex2oat_environment_tests_DEX_DEPS) Statics
 ART_GTEST_exception_test_DEX_DEPS := ExceptionHandle
@@ -87,6 +89,7 @@ ART_GTEST_profile_compilation_info_test_DEX_DEPS := ProfileTestMultiDex
 ART_GTEST_stub_test_DEX_DEPS := AllFields
 ART_GTEST_transaction_test_DEX_DEPS := Transaction
 ART_GTEST_type_lookup_table_test_DEX_DEPS := Lookup
+ART_GTEST_verification_deps_test_DEX_DEPS := Main
 
 # The elf writer test has dependencies on core.oat.
 ART_GTEST_elf_writer_test_HOST_DEPS := $(HOST_CORE_IMAGE_default_no-pic_64) $(HOST_CORE_IMAGE_default_no-pic_32)
@@ -191,11 +194,14 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/base/bit_field_test.cc \
   runtime/base/bit_utils_test.cc \
   runtime/base/bit_vector_test.cc \
+  runtime/base/contention_profiler_test.cc \
   runtime/base/hash_set_test.cc \
   runtime/base/hex_dump_test.cc \
   runtime/base/histogram_test.cc \
   runtime/base/mutex_test.cc \
+  runtime/base/numa_test.cc \
   runtime/base/scoped_flock_test.cc \
+  runtime/base/startup_trace_test.cc \
   runtime/base/stringprintf_test.cc \
   runtime/base/time_utils_test.cc \
   runtime/base/timing_logger_test.cc \
@@ -214,14 +220,19 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/gc/accounting/card_table_test.cc \
   runtime/gc/accounting/mod_union_table_test.cc \
   runtime/gc/accounting/space_bitmap_test.cc \
+  runtime/gc/accounting/work_stealing_deque_test.cc \
+  runtime/gc/allocation_sampler_test.cc \
   runtime/gc/collector/immune_spaces_test.cc \
+  runtime/gc/gc_event_log_test.cc \
   runtime/gc/heap_test.cc \
+  runtime/gc/reference_processor_test.cc \
   runtime/gc/reference_queue_test.cc \
   runtime/gc/space/dlmalloc_space_static_test.cc \
   runtime/gc/space/dlmalloc_space_random_test.cc \
   runtime/gc/space/large_object_space_test.cc \
   runtime/gc/space/rosalloc_space_static_test.cc \
   runtime/gc/space/rosalloc_space_random_test.cc \
+  runtime/gc/space/rosalloc_space_test.cc \
   runtime/gc/space/space_create_test.cc \
   runtime/gc/task_processor_test.cc \
   runtime/gtest_test.cc \
@@ -230,6 +241,9 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/indirect_reference_table_test.cc \
   runtime/instrumentation_test.cc \
   runtime/intern_table_test.cc \
+  runtime/interpreter/dispatch_profiler_test.cc \
+  runtime/interpreter/interpreter_cache_test.cc \
+  runtime/interpreter/opcode_pair_profiler_test.cc \
   runtime/interpreter/safe_math_test.cc \
   runtime/interpreter/unstarted_runtime_test.cc \
   runtime/java_vm_ext_test.cc \
@@ -248,7 +262,9 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/parsed_options_test.cc \
   runtime/prebuilt_tools_test.cc \
   runtime/reference_table_test.cc \
+  runtime/suspend_latency_profiler_test.cc \
   runtime/thread_pool_test.cc \
+  runtime/thread_stack_pool_test.cc \
   runtime/transaction_test.cc \
   runtime/type_lookup_table_test.cc \
   runtime/utf_test.cc \
@@ -264,7 +280,10 @@ COMPILER_GTEST_COMMON_SRC_FILES := \
   compiler/compiled_method_test.cc \
   compiler/debug/dwarf/dwarf_test.cc \
   compiler/driver/compiled_method_storage_test.cc \
+  compiler/dex/dex_layout_optimizer_test.cc \
+  compiler/dex/verification_deps_test.cc \
   compiler/driver/compiler_driver_test.cc \
+  compiler/driver/pass_statistics_test.cc \
   compiler/elf_writer_test.cc \
   compiler/exception_test.cc \
   compiler/image_test.cc \
@@ -273,6 +292,7 @@ COMPILER_GTEST_COMMON_SRC_FILES := \
   compiler/linker/output_stream_test.cc \
   compiler/oat_test.cc \
   compiler/optimizing/bounds_check_elimination_test.cc \
+  compiler/optimizing/constant_propagation_test.cc \
   compiler/optimizing/dominator_test.cc \
   compiler/optimizing/find_loops_test.cc \
   compiler/optimizing/graph_checker_test.cc \
@@ -282,10 +302,14 @@ COMPILER_GTEST_COMMON_SRC_FILES := \
   compiler/optimizing/induction_var_range_test.cc \
   compiler/optimizing/licm_test.cc \
   compiler/optimizing/live_interval_test.cc \
+  compiler/optimizing/loop_unrolling_test.cc \
+  compiler/optimizing/loop_vectorization_test.cc \
   compiler/optimizing/nodes_test.cc \
   compiler/optimizing/parallel_move_test.cc \
   compiler/optimizing/pretty_printer_test.cc \
   compiler/optimizing/reference_type_propagation_test.cc \
+  compiler/optimizing/scheduler_test.cc \
+  compiler/optimizing/select_generator_test.cc \
   compiler/optimizing/side_effects_test.cc \
   compiler/optimizing/ssa_test.cc \
   compiler/optimizing/stack_map_test.cc \
@@ -475,6 +475,11 @@ struct XGcOption {
   bool verify_post_gc_rosalloc_ = false;
   bool measure_ = kIsDebugBuild;
   bool gcstress_ = false;
+  // If true, the concurrent copying collector runs young-generation collections that only
+  // evacuate the regions allocated since the previous GC.
+  bool generational_cc_ = false;
+  // If true, the mark compact collector marks concurrently with the mutators.
+  bool concurrent_mark_compact_ = false;
 };
 
 template <>
@@ -518,6 +523,14 @@ struct CmdlineType<XGcOption> : CmdlineTypeParser<XGcOption> {
         xgc.gcstress_ = false;
       } else if (gc_option == "measure") {
         xgc.measure_ = true;
+      } else if (gc_option == "generational_cc") {
+        xgc.generational_cc_ = true;
+      } else if (gc_option == "nogenerational_cc") {
+        xgc.generational_cc_ = false;
+      } else if (gc_option == "concurrent_mark_compact") {
+        xgc.concurrent_mark_compact_ = true;
+      } else if (gc_option == "noconcurrent_mark_compact") {
+        xgc.concurrent_mark_compact_ = false;
       } else if ((gc_option == "precise") ||
                  (gc_option == "noprecise") ||
                  (gc_option == "verifycardtable") ||
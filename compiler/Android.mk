@@ -21,7 +21,9 @@ include art/build/Android.common_build.mk
 LIBART_COMPILER_SRC_FILES := \
 	compiled_method.cc \
 	debug/elf_debug_writer.cc \
+	dex/dex_layout_optimizer.cc \
 	dex/dex_to_dex_compiler.cc \
+	dex/verification_deps.cc \
 	dex/verified_method.cc \
 	dex/verification_results.cc \
 	dex/quick_compiler_callbacks.cc \
@@ -31,6 +33,7 @@ LIBART_COMPILER_SRC_FILES := \
 	driver/compiler_driver.cc \
 	driver/compiler_options.cc \
 	driver/dex_compilation_unit.cc \
+	driver/pass_statistics.cc \
 	linker/buffered_output_stream.cc \
 	linker/file_output_stream.cc \
 	linker/multi_oat_relative_patcher.cc \
@@ -45,7 +48,9 @@ LIBART_COMPILER_SRC_FILES := \
 	optimizing/builder.cc \
 	optimizing/code_generator.cc \
 	optimizing/code_generator_utils.cc \
+	optimizing/code_sinking.cc \
 	optimizing/constant_folding.cc \
+	optimizing/constant_propagation.cc \
 	optimizing/dead_code_elimination.cc \
 	optimizing/dex_cache_array_fixups_arm.cc \
 	optimizing/graph_checker.cc \
@@ -60,6 +65,7 @@ LIBART_COMPILER_SRC_FILES := \
 	optimizing/licm.cc \
 	optimizing/load_store_elimination.cc \
 	optimizing/locations.cc \
+	optimizing/loop_unrolling.cc \
 	optimizing/nodes.cc \
 	optimizing/nodes_arm64.cc \
 	optimizing/optimization.cc \
@@ -71,6 +77,7 @@ LIBART_COMPILER_SRC_FILES := \
 	optimizing/register_allocator.cc \
 	optimizing/register_allocator_graph_color.cc \
 	optimizing/register_allocator_linear_scan.cc \
+	optimizing/scheduler.cc \
 	optimizing/select_generator.cc \
 	optimizing/sharpening.cc \
 	optimizing/side_effects_analysis.cc \
@@ -78,6 +85,7 @@ LIBART_COMPILER_SRC_FILES := \
 	optimizing/ssa_liveness_analysis.cc \
 	optimizing/ssa_phi_elimination.cc \
 	optimizing/stack_map_stream.cc \
+	optimizing/write_barrier_elimination.cc \
 	optimizing/x86_memory_gen.cc \
 	trampolines/trampoline_compiler.cc \
 	utils/assembler.cc \
@@ -113,6 +121,8 @@ LIBART_COMPILER_SRC_FILES_arm64 := \
 	optimizing/instruction_simplifier_arm64.cc \
 	optimizing/instruction_simplifier_shared.cc \
 	optimizing/intrinsics_arm64.cc \
+	optimizing/loop_vectorization.cc \
+	optimizing/scheduler_arm64.cc \
 	utils/arm64/assembler_arm64.cc \
 	utils/arm64/managed_register_arm64.cc \
 
@@ -151,6 +161,7 @@ LIBART_COMPILER_SRC_FILES_x86_64 := \
 	linker/x86_64/relative_patcher_x86_64.cc \
 	optimizing/intrinsics_x86_64.cc \
 	optimizing/code_generator_x86_64.cc \
+	optimizing/loop_vectorization.cc \
 	utils/x86_64/assembler_x86_64.cc \
 	utils/x86_64/managed_register_x86_64.cc \
 
@@ -16,6 +16,8 @@
 
 #include "elf_debug_writer.h"
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "debug/dwarf/dwarf_constants.h"
@@ -29,6 +31,7 @@
 #include "debug/method_debug_info.h"
 #include "elf_builder.h"
 #include "linker/vector_output_stream.h"
+#include "thread_pool.h"
 #include "utils/array_ref.h"
 
 namespace art {
@@ -88,24 +91,68 @@ void WriteDebugInfo(ElfBuilder<ElfTypes>* builder,
   }
 }
 
+// Methods of one task computing symbol names.
+static constexpr size_t kSymbolNamesPerTask = 1024;
+
+class DebugSymbolNamesTask FINAL : public SelfDeletingTask {
+ public:
+  DebugSymbolNamesTask(const ArrayRef<const MethodDebugInfo>& method_infos,
+                       size_t begin,
+                       size_t end,
+                       std::vector<std::string>* names)
+      : method_infos_(method_infos), begin_(begin), end_(end), names_(names) {}
+
+  void Run(Thread*) OVERRIDE {
+    MakeDebugSymbolNames(method_infos_, false /* with_signature */, begin_, end_, names_);
+  }
+
+ private:
+  const ArrayRef<const MethodDebugInfo> method_infos_;
+  const size_t begin_;
+  const size_t end_;
+  // Each task writes its own range of the names.
+  std::vector<std::string>* const names_;
+};
+
 std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
     const InstructionSetFeatures* features,
     size_t rodata_size,
     size_t text_size,
-    const ArrayRef<const MethodDebugInfo>& method_infos) {
+    const ArrayRef<const MethodDebugInfo>& method_infos,
+    size_t thread_count) {
+  std::vector<std::string> symbol_names(method_infos.size());
+  if (thread_count > 1 && method_infos.size() > kSymbolNamesPerTask) {
+    Thread* self = Thread::Current();
+    ThreadPool thread_pool("Mini-debug-info symbols", thread_count - 1);
+    for (size_t begin = 0; begin < method_infos.size(); begin += kSymbolNamesPerTask) {
+      size_t end = std::min(begin + kSymbolNamesPerTask, method_infos.size());
+      thread_pool.AddTask(self,
+                          new DebugSymbolNamesTask(method_infos, begin, end, &symbol_names));
+    }
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /* do_work */ true, /* may_hold_locks */ false);
+  } else {
+    MakeDebugSymbolNames(method_infos,
+                         false /* with_signature */,
+                         0u,
+                         method_infos.size(),
+                         &symbol_names);
+  }
   if (Is64BitInstructionSet(isa)) {
     return MakeMiniDebugInfoInternal<ElfTypes64>(isa,
                                                  features,
                                                  rodata_size,
                                                  text_size,
-                                                 method_infos);
+                                                 method_infos,
+                                                 &symbol_names);
   } else {
     return MakeMiniDebugInfoInternal<ElfTypes32>(isa,
                                                  features,
                                                  rodata_size,
                                                  text_size,
-                                                 method_infos);
+                                                 method_infos,
+                                                 &symbol_names);
   }
 }
 
@@ -173,6 +220,34 @@ std::vector<uint8_t> WriteDebugElfFileForClasses(InstructionSet isa,
   }
 }
 
+// The opaque method info of ElfJITDebugInfoWriter.
+struct JITMethodDebugInfo {
+  MethodDebugInfo info;
+  std::vector<uint8_t> cfi;
+};
+
+const void* ElfJITDebugInfoWriter::CreateMethodDebugInfo(const MethodDebugInfo& method_info) {
+  JITMethodDebugInfo* jit_info = new JITMethodDebugInfo;
+  jit_info->info = method_info;
+  jit_info->cfi.assign(method_info.cfi.begin(), method_info.cfi.end());
+  jit_info->info.cfi = ArrayRef<const uint8_t>(jit_info->cfi);
+  return jit_info;
+}
+
+std::vector<uint8_t> ElfJITDebugInfoWriter::WriteElfFile(
+    const std::vector<const void*>& method_infos) {
+  std::vector<MethodDebugInfo> infos;
+  infos.reserve(method_infos.size());
+  for (const void* method_info : method_infos) {
+    infos.push_back(reinterpret_cast<const JITMethodDebugInfo*>(method_info)->info);
+  }
+  return WriteDebugElfFileForMethods(isa_, features_, ArrayRef<const MethodDebugInfo>(infos));
+}
+
+void ElfJITDebugInfoWriter::DeleteMethodDebugInfo(const void* method_info) {
+  delete reinterpret_cast<const JITMethodDebugInfo*>(method_info);
+}
+
 std::vector<MethodDebugInfo> MakeTrampolineInfos(const OatHeader& header) {
   std::map<const char*, uint32_t> trampolines = {
     { "interpreterToInterpreterBridge", header.GetInterpreterToInterpreterBridgeOffset() },
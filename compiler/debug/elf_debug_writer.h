@@ -23,6 +23,7 @@
 #include "base/mutex.h"
 #include "debug/dwarf/dwarf_constants.h"
 #include "elf_builder.h"
+#include "jit/debugger_interface.h"
 #include "utils/array_ref.h"
 
 namespace art {
@@ -40,12 +41,14 @@ void WriteDebugInfo(
     dwarf::CFIFormat cfi_format,
     bool write_oat_patches);
 
+// The symbol names are computed by thread_count threads, including the calling one.
 std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
     const InstructionSetFeatures* features,
     size_t rodata_section_size,
     size_t text_section_size,
-    const ArrayRef<const MethodDebugInfo>& method_infos);
+    const ArrayRef<const MethodDebugInfo>& method_infos,
+    size_t thread_count);
 
 std::vector<uint8_t> WriteDebugElfFileForMethods(
     InstructionSet isa,
@@ -60,6 +63,26 @@ std::vector<uint8_t> WriteDebugElfFileForClasses(
 
 std::vector<MethodDebugInfo> MakeTrampolineInfos(const OatHeader& oat_header);
 
+// Writes one debug ELF file for each batch of JITed methods queued with AddJITMethodDebugInfo.
+class ElfJITDebugInfoWriter FINAL : public JITDebugInfoWriter {
+ public:
+  ElfJITDebugInfoWriter(InstructionSet isa, const InstructionSetFeatures* features)
+      : isa_(isa), features_(features) {}
+
+  // Returns the opaque method info for AddJITMethodDebugInfo. It copies the CFI, which the
+  // assembler of the method owns, the other data referenced by the info must outlive the code.
+  static const void* CreateMethodDebugInfo(const MethodDebugInfo& method_info);
+
+  std::vector<uint8_t> WriteElfFile(const std::vector<const void*>& method_infos) OVERRIDE;
+  void DeleteMethodDebugInfo(const void* method_info) OVERRIDE;
+
+ private:
+  const InstructionSet isa_;
+  const InstructionSetFeatures* const features_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElfJITDebugInfoWriter);
+};
+
 }  // namespace debug
 }  // namespace art
 
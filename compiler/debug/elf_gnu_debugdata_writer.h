@@ -82,7 +82,8 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
     const InstructionSetFeatures* features,
     size_t rodata_section_size,
     size_t text_section_size,
-    const ArrayRef<const MethodDebugInfo>& method_infos) {
+    const ArrayRef<const MethodDebugInfo>& method_infos,
+    std::vector<std::string>* symbol_names) {
   std::vector<uint8_t> buffer;
   buffer.reserve(KB);
   VectorOutputStream out("Mini-debug-info ELF file", &buffer);
@@ -92,7 +93,7 @@ static std::vector<uint8_t> MakeMiniDebugInfoInternal(
   // It is needed to detected relocations after compression.
   builder->GetRoData()->WriteNoBitsSection(rodata_section_size);
   builder->GetText()->WriteNoBitsSection(text_section_size);
-  WriteDebugSymbols(builder.get(), method_infos, false /* with_signature */);
+  WriteDebugSymbols(builder.get(), method_infos, false /* with_signature */, symbol_names);
   WriteCFISection(builder.get(),
                   method_infos,
                   dwarf::DW_DEBUG_FRAME_FORMAT,
@@ -17,7 +17,9 @@
 #ifndef ART_COMPILER_DEBUG_ELF_SYMTAB_WRITER_H_
 #define ART_COMPILER_DEBUG_ELF_SYMTAB_WRITER_H_
 
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "debug/method_debug_info.h"
 #include "elf_builder.h"
@@ -35,10 +37,13 @@ namespace debug {
 // one symbol which marks the whole .text section as code.
 constexpr bool kGenerateSingleArmMappingSymbol = true;
 
+// The names of the methods are most of the cost, so the callers may pass them precomputed by
+// MakeDebugSymbolNames. They are moved out of the vector.
 template <typename ElfTypes>
 static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
                               const ArrayRef<const MethodDebugInfo>& method_infos,
-                              bool with_signature) {
+                              bool with_signature,
+                              std::vector<std::string>* names = nullptr) {
   uint64_t mapping_symbol_address = std::numeric_limits<uint64_t>::max();
   auto* strtab = builder->GetStrTab();
   auto* symtab = builder->GetSymTab();
@@ -60,7 +65,9 @@ static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
   strtab->Write("");  // strtab should start with empty string.
   std::string last_name;
   size_t last_name_offset = 0;
-  for (const MethodDebugInfo& info : method_infos) {
+  DCHECK(names == nullptr || names->size() == method_infos.size());
+  for (size_t i = 0; i != method_infos.size(); ++i) {
+    const MethodDebugInfo& info = method_infos[i];
     if (info.deduped) {
       continue;  // Add symbol only for the first instance.
     }
@@ -69,7 +76,9 @@ static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
       name_offset = strtab->Write(info.trampoline_name);
     } else {
       DCHECK(info.dex_file != nullptr);
-      std::string name = PrettyMethod(info.dex_method_index, *info.dex_file, with_signature);
+      std::string name = (names != nullptr)
+          ? std::move((*names)[i])
+          : PrettyMethod(info.dex_method_index, *info.dex_file, with_signature);
       if (deduped_addresses.find(info.code_address) != deduped_addresses.end()) {
         name += " [DEDUPED]";
       }
@@ -105,6 +114,22 @@ static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
   symtab->End();
 }
 
+// Computes the names of the method symbols written by WriteDebugSymbols, the entries of the
+// trampolines and deduped methods are left empty.
+static void MakeDebugSymbolNames(const ArrayRef<const MethodDebugInfo>& method_infos,
+                                 bool with_signature,
+                                 size_t begin,
+                                 size_t end,
+                                 std::vector<std::string>* names) {
+  for (size_t i = begin; i != end; ++i) {
+    const MethodDebugInfo& info = method_infos[i];
+    if (!info.deduped && info.trampoline_name == nullptr) {
+      DCHECK(info.dex_file != nullptr);
+      (*names)[i] = PrettyMethod(info.dex_method_index, *info.dex_file, with_signature);
+    }
+  }
+}
+
 }  // namespace debug
 }  // namespace art
 
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_layout_optimizer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string.h>
+#include <vector>
+#include <zlib.h>
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "dex_file.h"
+#include "dex_instruction-inl.h"
+#include "jit/offline_profiling_info.h"
+#include "leb128.h"
+#include "method_reference.h"
+
+namespace art {
+
+namespace {
+
+// An item of the code item or string data section.
+struct DataItem {
+  uint32_t offset;
+  uint32_t size;
+  bool hot;
+};
+
+// A code_off entry of a class_data_item.
+struct CodeOffEntry {
+  uint32_t position;  // Offset of the ULEB128 in the dex file.
+  uint32_t length;    // Length of the ULEB128.
+  size_t code_item_index;
+};
+
+size_t CodeItemSize(const DexFile::CodeItem& code_item) {
+  const uint8_t* begin = reinterpret_cast<const uint8_t*>(&code_item);
+  if (code_item.tries_size_ == 0u) {
+    const uint8_t* insns_end =
+        reinterpret_cast<const uint8_t*>(code_item.insns_ + code_item.insns_size_in_code_units_);
+    return insns_end - begin;
+  }
+  const uint8_t* ptr = DexFile::GetCatchHandlerData(code_item, 0u);
+  uint32_t handlers_size = DecodeUnsignedLeb128(&ptr);
+  for (uint32_t i = 0; i != handlers_size; ++i) {
+    int32_t size = DecodeSignedLeb128(&ptr);
+    for (int32_t j = 0, num_pairs = std::abs(size); j != num_pairs; ++j) {
+      DecodeUnsignedLeb128(&ptr);  // type_idx
+      DecodeUnsignedLeb128(&ptr);  // addr
+    }
+    if (size <= 0) {
+      DecodeUnsignedLeb128(&ptr);  // catch_all_addr
+    }
+  }
+  return ptr - begin;
+}
+
+size_t StringDataSize(const uint8_t* string_data) {
+  const uint8_t* ptr = string_data;
+  DecodeUnsignedLeb128(&ptr);  // utf16_size
+  return (ptr - string_data) + strlen(reinterpret_cast<const char*>(ptr)) + 1u;
+}
+
+const DexFile::MapItem* FindMapItem(const DexFile& dex_file, uint16_t type) {
+  const DexFile::MapList* map_list =
+      reinterpret_cast<const DexFile::MapList*>(dex_file.Begin() + dex_file.GetHeader().map_off_);
+  for (uint32_t i = 0; i != map_list->size_; ++i) {
+    if (map_list->list_[i].type_ == type) {
+      return &map_list->list_[i];
+    }
+  }
+  return nullptr;
+}
+
+// Collect the items of a section in file order. Items are contiguous apart from the
+// zero padding needed for their alignment.
+template <typename SizeFn>
+std::vector<DataItem> CollectSectionItems(const DexFile& dex_file,
+                                          const DexFile::MapItem* map_item,
+                                          size_t alignment,
+                                          SizeFn size_fn) {
+  std::vector<DataItem> items;
+  if (map_item == nullptr) {
+    return items;
+  }
+  items.reserve(map_item->size_);
+  uint32_t offset = map_item->offset_;
+  for (uint32_t i = 0; i != map_item->size_; ++i) {
+    offset = RoundUp(offset, alignment);
+    uint32_t size = dchecked_integral_cast<uint32_t>(size_fn(dex_file.Begin() + offset));
+    items.push_back(DataItem { offset, size, /* hot */ false });
+    offset += size;
+  }
+  return items;
+}
+
+// Return the index of the item at `offset`, or -1 if no item starts there.
+ssize_t FindItem(const std::vector<DataItem>& items, uint32_t offset) {
+  auto it = std::lower_bound(items.begin(),
+                             items.end(),
+                             offset,
+                             [](const DataItem& item, uint32_t off) { return item.offset < off; });
+  return (it != items.end() && it->offset == offset) ? (it - items.begin()) : -1;
+}
+
+// Compute new offsets for the items, with the hot ones first. The last item stays last, so
+// the sum of the padding inside the section, and therefore the section size, is unchanged.
+std::vector<uint32_t> ComputeNewOffsets(const std::vector<DataItem>& items, size_t alignment) {
+  std::vector<uint32_t> new_offsets(items.size());
+  if (items.empty()) {
+    return new_offsets;
+  }
+  uint32_t offset = items.front().offset;
+  size_t last_index = items.size() - 1u;
+  for (bool hot : { true, false }) {
+    for (size_t i = 0; i != last_index; ++i) {
+      if (items[i].hot == hot) {
+        offset = RoundUp(offset, alignment);
+        new_offsets[i] = offset;
+        offset += items[i].size;
+      }
+    }
+  }
+  new_offsets[last_index] = RoundUp(offset, alignment);
+  DCHECK_EQ(new_offsets[last_index], items[last_index].offset);
+  return new_offsets;
+}
+
+void MoveSectionItems(uint8_t* dex_data,
+                      const std::vector<DataItem>& items,
+                      const std::vector<uint32_t>& new_offsets) {
+  if (items.empty()) {
+    return;
+  }
+  uint32_t section_begin = items.front().offset;
+  uint32_t section_end = items.back().offset + items.back().size;
+  // Padding between items must be zero, so start from a cleared section.
+  std::vector<uint8_t> section(section_end - section_begin, 0u);
+  for (size_t i = 0; i != items.size(); ++i) {
+    memcpy(&section[new_offsets[i] - section_begin], dex_data + items[i].offset, items[i].size);
+  }
+  memcpy(dex_data + section_begin, section.data(), section.size());
+}
+
+void EncodePaddedUnsignedLeb128(uint8_t* dest, uint32_t value, uint32_t length) {
+  DCHECK_LE(UnsignedLeb128Size(value), length);
+  for (uint32_t i = 0; i + 1u < length; ++i) {
+    dest[i] = static_cast<uint8_t>((value & 0x7fu) | 0x80u);
+    value >>= 7;
+  }
+  dest[length - 1u] = static_cast<uint8_t>(value);
+}
+
+void MarkStringHot(std::vector<DataItem>* string_items, const DexFile& dex_file, uint32_t idx) {
+  ssize_t index = FindItem(*string_items, dex_file.GetStringId(idx).string_data_off_);
+  if (index >= 0) {
+    (*string_items)[index].hot = true;
+  }
+}
+
+}  // namespace
+
+bool LayoutDexFileForProfile(uint8_t* dex_data,
+                             size_t dex_size,
+                             const std::string& location,
+                             uint32_t location_checksum,
+                             const ProfileCompilationInfo& profile) {
+  std::vector<DataItem> code_items;
+  std::vector<DataItem> string_items;
+  std::vector<CodeOffEntry> code_off_entries;
+  {
+    std::string error_msg;
+    std::unique_ptr<const DexFile> dex_file = DexFile::Open(dex_data,
+                                                            dex_size,
+                                                            location,
+                                                            location_checksum,
+                                                            /* oat_dex_file */ nullptr,
+                                                            /* verify */ true,
+                                                            /* verify_checksum */ true,
+                                                            &error_msg);
+    if (dex_file == nullptr) {
+      // The caller reports the error when it opens the dex file.
+      return false;
+    }
+
+    code_items = CollectSectionItems(*dex_file,
+                                     FindMapItem(*dex_file, DexFile::kDexTypeCodeItem),
+                                     /* alignment */ 4u,
+                                     [](const uint8_t* data) {
+                                       return CodeItemSize(
+                                           *reinterpret_cast<const DexFile::CodeItem*>(data));
+                                     });
+    string_items = CollectSectionItems(*dex_file,
+                                       FindMapItem(*dex_file, DexFile::kDexTypeStringDataItem),
+                                       /* alignment */ 1u,
+                                       StringDataSize);
+
+    // Walk the class data to find the code_off entries and the code items of the methods
+    // in the profile. ClassDataItemIterator does not expose the positions of the entries.
+    bool has_hot_methods = false;
+    for (size_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const uint8_t* class_data = dex_file->GetClassData(dex_file->GetClassDef(i));
+      if (class_data == nullptr) {
+        continue;
+      }
+      const uint8_t* ptr = class_data;
+      uint32_t static_fields_size = DecodeUnsignedLeb128(&ptr);
+      uint32_t instance_fields_size = DecodeUnsignedLeb128(&ptr);
+      uint32_t direct_methods_size = DecodeUnsignedLeb128(&ptr);
+      uint32_t virtual_methods_size = DecodeUnsignedLeb128(&ptr);
+      for (uint32_t j = 0; j != static_fields_size + instance_fields_size; ++j) {
+        DecodeUnsignedLeb128(&ptr);  // field_idx_diff
+        DecodeUnsignedLeb128(&ptr);  // access_flags
+      }
+      for (uint32_t methods_size : { direct_methods_size, virtual_methods_size }) {
+        uint32_t method_idx = 0u;
+        for (uint32_t j = 0; j != methods_size; ++j) {
+          method_idx += DecodeUnsignedLeb128(&ptr);
+          DecodeUnsignedLeb128(&ptr);  // access_flags
+          const uint8_t* code_off_ptr = ptr;
+          uint32_t code_off = DecodeUnsignedLeb128(&ptr);
+          if (code_off == 0u) {
+            continue;
+          }
+          ssize_t code_item_index = FindItem(code_items, code_off);
+          if (code_item_index < 0) {
+            return false;
+          }
+          code_off_entries.push_back(
+              CodeOffEntry { dchecked_integral_cast<uint32_t>(code_off_ptr - dex_file->Begin()),
+                             dchecked_integral_cast<uint32_t>(ptr - code_off_ptr),
+                             static_cast<size_t>(code_item_index) });
+          if (!profile.ContainsMethod(MethodReference(dex_file.get(), method_idx))) {
+            continue;
+          }
+          has_hot_methods = true;
+          code_items[code_item_index].hot = true;
+
+          // The strings needed to link and run the method.
+          const DexFile::MethodId& method_id = dex_file->GetMethodId(method_idx);
+          MarkStringHot(&string_items, *dex_file, method_id.name_idx_);
+          MarkStringHot(&string_items,
+                        *dex_file,
+                        dex_file->GetProtoId(method_id.proto_idx_).shorty_idx_);
+          MarkStringHot(&string_items,
+                        *dex_file,
+                        dex_file->GetTypeId(method_id.class_idx_).descriptor_idx_);
+          const DexFile::CodeItem* code_item = dex_file->GetCodeItem(code_off);
+          const uint16_t* insns = code_item->insns_;
+          for (uint32_t dex_pc = 0; dex_pc < code_item->insns_size_in_code_units_; ) {
+            const Instruction* inst = Instruction::At(insns + dex_pc);
+            if (inst->Opcode() == Instruction::CONST_STRING) {
+              MarkStringHot(&string_items, *dex_file, inst->VRegB_21c());
+            } else if (inst->Opcode() == Instruction::CONST_STRING_JUMBO) {
+              MarkStringHot(&string_items, *dex_file, inst->VRegB_31c());
+            }
+            dex_pc += inst->SizeInCodeUnits();
+          }
+        }
+      }
+    }
+    if (!has_hot_methods) {
+      return false;
+    }
+  }
+
+  std::vector<uint32_t> new_code_offsets = ComputeNewOffsets(code_items, /* alignment */ 4u);
+  std::vector<uint32_t> new_string_offsets = ComputeNewOffsets(string_items, /* alignment */ 1u);
+
+  // Code items that move further away may need a longer code_off encoding. Give up rather
+  // than resize class data items.
+  for (const CodeOffEntry& entry : code_off_entries) {
+    if (UnsignedLeb128Size(new_code_offsets[entry.code_item_index]) > entry.length) {
+      VLOG(compiler) << "Not relaying out " << location << ": code_off does not fit";
+      return false;
+    }
+  }
+
+  // Nothing can fail from here on.
+  MoveSectionItems(dex_data, code_items, new_code_offsets);
+  for (const CodeOffEntry& entry : code_off_entries) {
+    EncodePaddedUnsignedLeb128(dex_data + entry.position,
+                               new_code_offsets[entry.code_item_index],
+                               entry.length);
+  }
+  MoveSectionItems(dex_data, string_items, new_string_offsets);
+  DexFile::Header* header = reinterpret_cast<DexFile::Header*>(dex_data);
+  DexFile::StringId* string_ids = reinterpret_cast<DexFile::StringId*>(
+      dex_data + header->string_ids_off_);
+  for (uint32_t i = 0; i != header->string_ids_size_; ++i) {
+    ssize_t index = FindItem(string_items, string_ids[i].string_data_off_);
+    DCHECK_GE(index, 0);
+    string_ids[i].string_data_off_ = new_string_offsets[index];
+  }
+
+  // Update the checksum. The signature is not checked by the runtime and is left as is.
+  const uint32_t non_sum = sizeof(header->magic_) + sizeof(header->checksum_);
+  uint32_t adler_checksum = adler32(0L, Z_NULL, 0);
+  header->checksum_ = adler32(adler_checksum, dex_data + non_sum, dex_size - non_sum);
+  return true;
+}
+
+}  // namespace art
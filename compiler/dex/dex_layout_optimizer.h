@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEX_DEX_LAYOUT_OPTIMIZER_H_
+#define ART_COMPILER_DEX_DEX_LAYOUT_OPTIMIZER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace art {
+
+class ProfileCompilationInfo;
+
+// Rewrites a dex file in place so that the code items of the methods in the profile,
+// and the string data they use, are grouped at the start of their sections. The items
+// are only permuted, so the size of the file and of each section do not change; the
+// code_off entries of class_data_items, the string_id_items and the header checksum
+// are updated to match.
+//
+// Returns true if the dex file was rewritten. The dex file is left untouched if it does
+// not verify, if the profile does not reference it, or if it cannot be relaid out without
+// changing its size.
+bool LayoutDexFileForProfile(uint8_t* dex_data,
+                             size_t dex_size,
+                             const std::string& location,
+                             uint32_t location_checksum,
+                             const ProfileCompilationInfo& profile);
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DEX_DEX_LAYOUT_OPTIMIZER_H_
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_layout_optimizer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "jit/offline_profiling_info.h"
+#include "method_reference.h"
+
+namespace art {
+
+class DexLayoutOptimizerTest : public CommonRuntimeTest {
+ protected:
+  // Return (method_idx, code_off) for all methods with code, sorted by code_off.
+  static std::vector<std::pair<uint32_t, uint32_t>> GetCodeOffsets(const DexFile& dex_file) {
+    std::vector<std::pair<uint32_t, uint32_t>> result;
+    for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+      const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+      if (class_data == nullptr) {
+        continue;
+      }
+      ClassDataItemIterator it(dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+        if (it.GetMethodCodeItemOffset() != 0u) {
+          result.emplace_back(it.GetMemberIndex(), it.GetMethodCodeItemOffset());
+        }
+      }
+    }
+    std::sort(result.begin(),
+              result.end(),
+              [](const std::pair<uint32_t, uint32_t>& lhs,
+                 const std::pair<uint32_t, uint32_t>& rhs) {
+                return lhs.second < rhs.second;
+              });
+    return result;
+  }
+};
+
+TEST_F(DexLayoutOptimizerTest, HotCodeItemFirst) {
+  std::unique_ptr<const DexFile> original = OpenTestDexFile("StaticLeafMethods");
+  ASSERT_TRUE(original != nullptr);
+  std::vector<std::pair<uint32_t, uint32_t>> original_offsets = GetCodeOffsets(*original);
+  ASSERT_GE(original_offsets.size(), 3u);
+  // Pick a method in the middle of the code item section.
+  uint32_t hot_method_idx = original_offsets[original_offsets.size() / 2].first;
+  const DexFile::CodeItem* original_code_item =
+      original->GetCodeItem(original_offsets[original_offsets.size() / 2].second);
+
+  ProfileCompilationInfo profile;
+  std::vector<MethodReference> methods = { MethodReference(original.get(), hot_method_idx) };
+  ASSERT_TRUE(profile.AddMethodsAndClasses(methods, std::set<DexCacheResolvedClasses>()));
+
+  const uint8_t* begin = original->Begin();
+  std::vector<uint8_t> data(begin, begin + original->Size());
+  ASSERT_TRUE(LayoutDexFileForProfile(data.data(),
+                                      data.size(),
+                                      original->GetLocation(),
+                                      original->GetLocationChecksum(),
+                                      profile));
+
+  std::string error_msg;
+  std::unique_ptr<const DexFile> relaid_out = DexFile::Open(data.data(),
+                                                            data.size(),
+                                                            original->GetLocation(),
+                                                            original->GetLocationChecksum(),
+                                                            /* oat_dex_file */ nullptr,
+                                                            /* verify */ true,
+                                                            /* verify_checksum */ true,
+                                                            &error_msg);
+  ASSERT_TRUE(relaid_out != nullptr) << error_msg;
+
+  // The hot method's code item now comes first and has the same contents.
+  std::vector<std::pair<uint32_t, uint32_t>> new_offsets = GetCodeOffsets(*relaid_out);
+  ASSERT_EQ(original_offsets.size(), new_offsets.size());
+  EXPECT_EQ(hot_method_idx, new_offsets.front().first);
+  EXPECT_EQ(original_offsets.front().second, new_offsets.front().second);
+  const DexFile::CodeItem* new_code_item = relaid_out->GetCodeItem(new_offsets.front().second);
+  ASSERT_EQ(original_code_item->insns_size_in_code_units_,
+            new_code_item->insns_size_in_code_units_);
+  EXPECT_EQ(0, memcmp(original_code_item->insns_,
+                      new_code_item->insns_,
+                      new_code_item->insns_size_in_code_units_ * sizeof(uint16_t)));
+
+  // Strings are still the same.
+  ASSERT_EQ(original->NumStringIds(), relaid_out->NumStringIds());
+  for (uint32_t i = 0; i != original->NumStringIds(); ++i) {
+    EXPECT_STREQ(original->StringDataByIdx(i), relaid_out->StringDataByIdx(i));
+  }
+}
+
+TEST_F(DexLayoutOptimizerTest, NotInProfile) {
+  std::unique_ptr<const DexFile> original = OpenTestDexFile("StaticLeafMethods");
+  ASSERT_TRUE(original != nullptr);
+  ProfileCompilationInfo profile;
+  const uint8_t* begin = original->Begin();
+  std::vector<uint8_t> data(begin, begin + original->Size());
+  EXPECT_FALSE(LayoutDexFileForProfile(data.data(),
+                                       data.size(),
+                                       original->GetLocation(),
+                                       original->GetLocationChecksum(),
+                                       profile));
+  EXPECT_EQ(0, memcmp(begin, data.data(), data.size()));
+}
+
+}  // namespace art
@@ -83,6 +83,7 @@ static constexpr bool kIntrinsicIsStatic[] = {
     true,   // kIntrinsicRoundFloat
     true,   // kIntrinsicRoundDouble
     false,  // kIntrinsicReferenceGetReferent
+    false,  // kIntrinsicObjectClone
     false,  // kIntrinsicCharAt
     false,  // kIntrinsicCompareTo
     false,  // kIntrinsicEquals
@@ -92,6 +93,8 @@ static constexpr bool kIntrinsicIsStatic[] = {
     true,   // kIntrinsicNewStringFromBytes
     true,   // kIntrinsicNewStringFromChars
     true,   // kIntrinsicNewStringFromString
+    false,  // kIntrinsicStringBuilderAppend
+    false,  // kIntrinsicStringBuilderToString
     true,   // kIntrinsicCurrentThread
     true,   // kIntrinsicPeek
     true,   // kIntrinsicPoke
@@ -106,8 +109,15 @@ static constexpr bool kIntrinsicIsStatic[] = {
     false,  // kIntrinsicUnsafeLoadFence,
     false,  // kIntrinsicUnsafeStoreFence,
     false,  // kIntrinsicUnsafeFullFence,
+    true,   // kIntrinsicSystemArrayCopyByteArray
     true,   // kIntrinsicSystemArrayCopyCharArray
+    true,   // kIntrinsicSystemArrayCopyIntArray
+    true,   // kIntrinsicSystemArrayCopyLongArray
     true,   // kIntrinsicSystemArrayCopy
+    true,   // kIntrinsicArraysEquals
+    true,   // kIntrinsicArraysFill
+    true,   // kIntrinsicCRC32Update
+    true,   // kIntrinsicCRC32UpdateBytes
 };
 static_assert(arraysize(kIntrinsicIsStatic) == kInlineOpNop,
               "arraysize of kIntrinsicIsStatic unexpected");
@@ -164,6 +174,7 @@ static_assert(kIntrinsicIsStatic[kIntrinsicRint], "Rint must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicRoundFloat], "RoundFloat must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicRoundDouble], "RoundDouble must be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicReferenceGetReferent], "Get must not be static");
+static_assert(!kIntrinsicIsStatic[kIntrinsicObjectClone], "Clone must not be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicCharAt], "CharAt must not be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicCompareTo], "CompareTo must not be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicEquals], "String equals must not be static");
@@ -176,6 +187,10 @@ static_assert(kIntrinsicIsStatic[kIntrinsicNewStringFromChars],
               "NewStringFromChars must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicNewStringFromString],
               "NewStringFromString must be static");
+static_assert(!kIntrinsicIsStatic[kIntrinsicStringBuilderAppend],
+              "StringBuilderAppend must not be static");
+static_assert(!kIntrinsicIsStatic[kIntrinsicStringBuilderToString],
+              "StringBuilderToString must not be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicCurrentThread], "CurrentThread must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicPeek], "Peek must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicPoke], "Poke must be static");
@@ -190,10 +205,21 @@ static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeGetAndSetObject], "UnsafeGetAn
 static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeLoadFence], "UnsafeLoadFence must not be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeStoreFence], "UnsafeStoreFence must not be static");
 static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeFullFence], "UnsafeFullFence must not be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyByteArray],
+              "SystemArrayCopyByteArray must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyCharArray],
               "SystemArrayCopyCharArray must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyIntArray],
+              "SystemArrayCopyIntArray must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyLongArray],
+              "SystemArrayCopyLongArray must be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopy],
               "SystemArrayCopy must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicArraysEquals], "ArraysEquals must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicArraysFill], "ArraysFill must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicCRC32Update], "CRC32Update must be static");
+static_assert(kIntrinsicIsStatic[kIntrinsicCRC32UpdateBytes],
+              "CRC32UpdateBytes must be static");
 
 }  // anonymous namespace
 
@@ -211,6 +237,7 @@ const char* const DexFileMethodInliner::kClassCacheNames[] = {
     "[B",                      // kClassCacheJavaLangByteArray
     "[C",                      // kClassCacheJavaLangCharArray
     "[I",                      // kClassCacheJavaLangIntArray
+    "[J",                      // kClassCacheJavaLangLongArray
     "Ljava/lang/Object;",      // kClassCacheJavaLangObject
     "Ljava/lang/ref/Reference;",   // kClassCacheJavaLangRefReference
     "Ljava/lang/String;",      // kClassCacheJavaLangString
@@ -229,6 +256,8 @@ const char* const DexFileMethodInliner::kClassCacheNames[] = {
     "Llibcore/io/Memory;",     // kClassCacheLibcoreIoMemory
     "Lsun/misc/Unsafe;",       // kClassCacheSunMiscUnsafe
     "Ljava/lang/System;",      // kClassCacheJavaLangSystem
+    "Ljava/util/Arrays;",      // kClassCacheJavaUtilArrays
+    "Ljava/util/zip/CRC32;",   // kClassCacheJavaUtilZipCRC32
 };
 
 const char* const DexFileMethodInliner::kNameCacheNames[] = {
@@ -324,6 +353,12 @@ const char* const DexFileMethodInliner::kNameCacheNames[] = {
     "rotateRight",           // kNameCacheRotateRight
     "rotateLeft",            // kNameCacheRotateLeft
     "signum",                // kNameCacheSignum
+    "append",                // kNameCacheAppend
+    "toString",              // kNameCacheToString
+    "fill",                  // kNameCacheFill
+    "update",                // kNameCacheUpdate
+    "updateBytes",           // kNameCacheUpdateBytes
+    "clone",                 // kNameCacheClone
 };
 
 const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
@@ -418,9 +453,18 @@ const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
     // kProtoCacheObjectJObject_Object
     { kClassCacheJavaLangObject, 3, { kClassCacheJavaLangObject, kClassCacheLong,
         kClassCacheJavaLangObject } },
+    // kProtoCacheByteArrayIByteArrayII_V
+    { kClassCacheVoid, 5, {kClassCacheJavaLangByteArray, kClassCacheInt,
+        kClassCacheJavaLangByteArray, kClassCacheInt, kClassCacheInt} },
     // kProtoCacheCharArrayICharArrayII_V
     { kClassCacheVoid, 5, {kClassCacheJavaLangCharArray, kClassCacheInt,
         kClassCacheJavaLangCharArray, kClassCacheInt, kClassCacheInt} },
+    // kProtoCacheIntArrayIIntArrayII_V
+    { kClassCacheVoid, 5, {kClassCacheJavaLangIntArray, kClassCacheInt,
+        kClassCacheJavaLangIntArray, kClassCacheInt, kClassCacheInt} },
+    // kProtoCacheLongArrayILongArrayII_V
+    { kClassCacheVoid, 5, {kClassCacheJavaLangLongArray, kClassCacheInt,
+        kClassCacheJavaLangLongArray, kClassCacheInt, kClassCacheInt} },
     // kProtoCacheObjectIObjectII_V
     { kClassCacheVoid, 5, {kClassCacheJavaLangObject, kClassCacheInt,
         kClassCacheJavaLangObject, kClassCacheInt, kClassCacheInt} },
@@ -470,6 +514,33 @@ const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
     { kClassCacheVoid, 1, { kClassCacheJavaLangStringBuffer } },
     // kProtoCacheStringBuilder_V
     { kClassCacheVoid, 1, { kClassCacheJavaLangStringBuilder } },
+    // kProtoCache_String
+    { kClassCacheJavaLangString, 0, { } },
+    // kProtoCacheString_StringBuilder
+    { kClassCacheJavaLangStringBuilder, 1, { kClassCacheJavaLangString } },
+    // kProtoCacheZ_StringBuilder
+    { kClassCacheJavaLangStringBuilder, 1, { kClassCacheBoolean } },
+    // kProtoCacheC_StringBuilder
+    { kClassCacheJavaLangStringBuilder, 1, { kClassCacheChar } },
+    // kProtoCacheI_StringBuilder
+    { kClassCacheJavaLangStringBuilder, 1, { kClassCacheInt } },
+    // kProtoCacheJ_StringBuilder
+    { kClassCacheJavaLangStringBuilder, 1, { kClassCacheLong } },
+    // kProtoCacheByteArrayByteArray_Z
+    { kClassCacheBoolean, 2, { kClassCacheJavaLangByteArray, kClassCacheJavaLangByteArray } },
+    // kProtoCacheCharArrayCharArray_Z
+    { kClassCacheBoolean, 2, { kClassCacheJavaLangCharArray, kClassCacheJavaLangCharArray } },
+    // kProtoCacheIntArrayIntArray_Z
+    { kClassCacheBoolean, 2, { kClassCacheJavaLangIntArray, kClassCacheJavaLangIntArray } },
+    // kProtoCacheByteArrayB_V
+    { kClassCacheVoid, 2, { kClassCacheJavaLangByteArray, kClassCacheByte } },
+    // kProtoCacheCharArrayC_V
+    { kClassCacheVoid, 2, { kClassCacheJavaLangCharArray, kClassCacheChar } },
+    // kProtoCacheIntArrayI_V
+    { kClassCacheVoid, 2, { kClassCacheJavaLangIntArray, kClassCacheInt } },
+    // kProtoCacheIByteArrayII_I
+    { kClassCacheInt, 4, { kClassCacheInt, kClassCacheJavaLangByteArray, kClassCacheInt,
+        kClassCacheInt } },
 };
 
 const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods[] = {
@@ -568,6 +639,8 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
 
     INTRINSIC(JavaLangRefReference, ReferenceGetReferent, _Object, kIntrinsicReferenceGetReferent, 0),
 
+    INTRINSIC(JavaLangObject, Clone, _Object, kIntrinsicObjectClone, 0),
+
     INTRINSIC(JavaLangString, CharAt, I_C, kIntrinsicCharAt, 0),
     INTRINSIC(JavaLangString, CompareTo, String_I, kIntrinsicCompareTo, 0),
     INTRINSIC(JavaLangString, Equals, Object_Z, kIntrinsicEquals, 0),
@@ -584,6 +657,19 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
     INTRINSIC(JavaLangStringFactory, NewStringFromString, String_String,
               kIntrinsicNewStringFromString, kIntrinsicFlagNone),
 
+    INTRINSIC(JavaLangStringBuilder, Append, String_StringBuilder,
+              kIntrinsicStringBuilderAppend, kIntrinsicFlagAppendString),
+    INTRINSIC(JavaLangStringBuilder, Append, Z_StringBuilder,
+              kIntrinsicStringBuilderAppend, kIntrinsicFlagAppendBoolean),
+    INTRINSIC(JavaLangStringBuilder, Append, C_StringBuilder,
+              kIntrinsicStringBuilderAppend, kIntrinsicFlagAppendChar),
+    INTRINSIC(JavaLangStringBuilder, Append, I_StringBuilder,
+              kIntrinsicStringBuilderAppend, kIntrinsicFlagAppendInt),
+    INTRINSIC(JavaLangStringBuilder, Append, J_StringBuilder,
+              kIntrinsicStringBuilderAppend, kIntrinsicFlagAppendLong),
+    INTRINSIC(JavaLangStringBuilder, ToString, _String,
+              kIntrinsicStringBuilderToString, kIntrinsicFlagNone),
+
     INTRINSIC(JavaLangThread, CurrentThread, _Thread, kIntrinsicCurrentThread, 0),
 
     INTRINSIC(LibcoreIoMemory, PeekByte, J_B, kIntrinsicPeek, kSignedByte),
@@ -629,11 +715,27 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
     INTRINSIC(SunMiscUnsafe, StoreFence, _V, kIntrinsicUnsafeStoreFence, 0),
     INTRINSIC(SunMiscUnsafe, FullFence, _V, kIntrinsicUnsafeFullFence, 0),
 
+    INTRINSIC(JavaLangSystem, ArrayCopy, ByteArrayIByteArrayII_V ,
+              kIntrinsicSystemArrayCopyByteArray, 0),
     INTRINSIC(JavaLangSystem, ArrayCopy, CharArrayICharArrayII_V , kIntrinsicSystemArrayCopyCharArray,
               0),
+    INTRINSIC(JavaLangSystem, ArrayCopy, IntArrayIIntArrayII_V ,
+              kIntrinsicSystemArrayCopyIntArray, 0),
+    INTRINSIC(JavaLangSystem, ArrayCopy, LongArrayILongArrayII_V ,
+              kIntrinsicSystemArrayCopyLongArray, 0),
     INTRINSIC(JavaLangSystem, ArrayCopy, ObjectIObjectII_V , kIntrinsicSystemArrayCopy,
               0),
 
+    INTRINSIC(JavaUtilArrays, Equals, ByteArrayByteArray_Z, kIntrinsicArraysEquals, kSignedByte),
+    INTRINSIC(JavaUtilArrays, Equals, CharArrayCharArray_Z, kIntrinsicArraysEquals, kUnsignedHalf),
+    INTRINSIC(JavaUtilArrays, Equals, IntArrayIntArray_Z, kIntrinsicArraysEquals, k32),
+    INTRINSIC(JavaUtilArrays, Fill, ByteArrayB_V, kIntrinsicArraysFill, kSignedByte),
+    INTRINSIC(JavaUtilArrays, Fill, CharArrayC_V, kIntrinsicArraysFill, kUnsignedHalf),
+    INTRINSIC(JavaUtilArrays, Fill, IntArrayI_V, kIntrinsicArraysFill, k32),
+
+    INTRINSIC(JavaUtilZipCRC32, Update, II_I, kIntrinsicCRC32Update, 0),
+    INTRINSIC(JavaUtilZipCRC32, UpdateBytes, IByteArrayII_I, kIntrinsicCRC32UpdateBytes, 0),
+
     INTRINSIC(JavaLangInteger, RotateRight, II_I, kIntrinsicRotateRight, k32),
     INTRINSIC(JavaLangLong, RotateRight, JI_J, kIntrinsicRotateRight, k64),
     INTRINSIC(JavaLangInteger, RotateLeft, II_I, kIntrinsicRotateLeft, k32),
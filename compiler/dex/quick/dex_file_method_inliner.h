@@ -37,6 +37,7 @@ enum OpSize {
   k64,
   kSignedHalf,
   kSignedByte,
+  kUnsignedHalf,
 };
 
 /**
@@ -111,6 +112,7 @@ class DexFileMethodInliner {
       kClassCacheJavaLangByteArray,
       kClassCacheJavaLangCharArray,
       kClassCacheJavaLangIntArray,
+      kClassCacheJavaLangLongArray,
       kClassCacheJavaLangObject,
       kClassCacheJavaLangRefReference,
       kClassCacheJavaLangString,
@@ -129,6 +131,8 @@ class DexFileMethodInliner {
       kClassCacheLibcoreIoMemory,
       kClassCacheSunMiscUnsafe,
       kClassCacheJavaLangSystem,
+      kClassCacheJavaUtilArrays,
+      kClassCacheJavaUtilZipCRC32,
       kClassCacheLast
     };
 
@@ -231,6 +235,12 @@ class DexFileMethodInliner {
       kNameCacheRotateRight,
       kNameCacheRotateLeft,
       kNameCacheSignum,
+      kNameCacheAppend,
+      kNameCacheToString,
+      kNameCacheFill,
+      kNameCacheUpdate,
+      kNameCacheUpdateBytes,
+      kNameCacheClone,
       kNameCacheLast
     };
 
@@ -284,7 +294,10 @@ class DexFileMethodInliner {
       kProtoCacheObjectJ_Object,
       kProtoCacheObjectJObject_V,
       kProtoCacheObjectJObject_Object,
+      kProtoCacheByteArrayIByteArrayII_V,
       kProtoCacheCharArrayICharArrayII_V,
+      kProtoCacheIntArrayIIntArrayII_V,
+      kProtoCacheLongArrayILongArrayII_V,
       kProtoCacheObjectIObjectII_V,
       kProtoCacheIICharArrayI_V,
       kProtoCacheByteArrayIII_String,
@@ -306,6 +319,19 @@ class DexFileMethodInliner {
       kProtoCacheString_V,
       kProtoCacheStringBuffer_V,
       kProtoCacheStringBuilder_V,
+      kProtoCache_String,
+      kProtoCacheString_StringBuilder,
+      kProtoCacheZ_StringBuilder,
+      kProtoCacheC_StringBuilder,
+      kProtoCacheI_StringBuilder,
+      kProtoCacheJ_StringBuilder,
+      kProtoCacheByteArrayByteArray_Z,
+      kProtoCacheCharArrayCharArray_Z,
+      kProtoCacheIntArrayIntArray_Z,
+      kProtoCacheByteArrayB_V,
+      kProtoCacheCharArrayC_V,
+      kProtoCacheIntArrayI_V,
+      kProtoCacheIByteArrayII_I,
       kProtoCacheLast
     };
 
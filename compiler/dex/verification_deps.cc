@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verification_deps.h"
+
+#include <string.h>
+
+#include "art_field-inl.h"
+#include "art_method-inl.h"
+#include "base/casts.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "dex_file-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/iftable-inl.h"
+#include "modifiers.h"
+#include "os.h"
+#include "runtime.h"
+#include "thread.h"
+#include "utf.h"
+
+namespace art {
+
+const uint8_t VerificationDeps::kMagic[4] = { 'v', 'd', 'p', '\n' };
+const uint8_t VerificationDeps::kVersion[4] = { '0', '0', '1', '\0' };
+
+// 32-bit FNV-1a, see FNVHash in base/stl_util.h.
+static uint32_t HashUint32(uint32_t hash, uint32_t value) {
+  for (size_t shift = 0; shift != 32u; shift += 8u) {
+    hash = (hash ^ ((value >> shift) & 0xffu)) * 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t HashString(uint32_t hash, const char* value) {
+  return HashUint32(hash, ComputeModifiedUtf8Hash(value));
+}
+
+static uint32_t HashClass(uint32_t hash, mirror::Class* klass, PointerSize pointer_size)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  std::string temp;
+  // The super classes contribute their members to field and method resolution, and the
+  // interfaces to assignability checks.
+  for (mirror::Class* k = klass; k != nullptr; k = k->GetSuperClass()) {
+    hash = HashString(hash, k->GetDescriptor(&temp));
+    hash = HashUint32(hash, k->GetAccessFlags() & kAccJavaFlagsMask);
+    for (ArtField& field : k->GetSFields()) {
+      hash = HashString(hash, field.GetName());
+      hash = HashString(hash, field.GetTypeDescriptor());
+      hash = HashUint32(hash, field.GetAccessFlags() & kAccJavaFlagsMask);
+    }
+    for (ArtField& field : k->GetIFields()) {
+      hash = HashString(hash, field.GetName());
+      hash = HashString(hash, field.GetTypeDescriptor());
+      hash = HashUint32(hash, field.GetAccessFlags() & kAccJavaFlagsMask);
+    }
+    for (ArtMethod& method : k->GetDeclaredMethods(pointer_size)) {
+      hash = HashString(hash, method.GetName());
+      hash = HashString(hash, method.GetSignature().ToString().c_str());
+      hash = HashUint32(hash, method.GetAccessFlags() & kAccJavaFlagsMask);
+    }
+  }
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (int32_t i = 0, count = klass->GetIfTableCount(); i != count; ++i) {
+    hash = HashString(hash, iftable->GetInterface(i)->GetDescriptor(&temp));
+  }
+  return hash;
+}
+
+uint32_t VerificationDeps::ComputeExternalClassesHash(
+    const DexFile& dex_file,
+    const std::vector<const DexFile*>& dex_files,
+    Handle<mirror::ClassLoader> class_loader) {
+  Thread* self = Thread::Current();
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  PointerSize pointer_size = class_linker->GetImagePointerSize();
+  uint32_t hash = 2166136261u;
+  for (size_t type_idx = 0; type_idx != dex_file.NumTypeIds(); ++type_idx) {
+    const char* descriptor = dex_file.StringByTypeIdx(type_idx);
+    while (descriptor[0] == '[') {
+      ++descriptor;
+    }
+    if (descriptor[0] != 'L') {
+      continue;  // Primitive types do not change.
+    }
+    size_t descriptor_hash = ComputeModifiedUtf8Hash(descriptor);
+    bool is_internal = false;
+    for (const DexFile* other : dex_files) {
+      if (other->FindClassDef(descriptor, descriptor_hash) != nullptr) {
+        is_internal = true;
+        break;
+      }
+    }
+    if (is_internal) {
+      continue;
+    }
+    hash = HashUint32(hash, descriptor_hash);
+    mirror::Class* klass = class_linker->FindClass(self, descriptor, class_loader);
+    if (klass == nullptr) {
+      DCHECK(self->IsExceptionPending());
+      self->ClearException();
+      hash = HashUint32(hash, 0u);
+    } else {
+      hash = HashClass(hash, klass, pointer_size);
+    }
+  }
+  return hash;
+}
+
+void VerificationDeps::AddDexFile(const DexFile& dex_file, uint32_t external_classes_hash) {
+  DexFileDeps deps = { dex_file.GetLocationChecksum(), external_classes_hash };
+  dex_files_.Overwrite(dex_file.GetLocation(), deps);
+}
+
+bool VerificationDeps::HasSameExternalClasses(const DexFile& dex_file,
+                                              uint32_t external_classes_hash) const {
+  auto it = dex_files_.find(dex_file.GetLocation());
+  return it != dex_files_.end() &&
+      it->second.location_checksum == dex_file.GetLocationChecksum() &&
+      it->second.external_classes_hash == external_classes_hash;
+}
+
+static void AppendUint32(std::vector<uint8_t>* buffer, uint32_t value) {
+  for (size_t shift = 0; shift != 32u; shift += 8u) {
+    buffer->push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+// Reads a little-endian uint32_t from `*data` and advances it, or returns false at `end`.
+static bool ReadUint32(const uint8_t** data, const uint8_t* end, uint32_t* value) {
+  if (static_cast<size_t>(end - *data) < sizeof(uint32_t)) {
+    return false;
+  }
+  *value = 0u;
+  for (size_t shift = 0; shift != 32u; shift += 8u) {
+    *value |= static_cast<uint32_t>(**data) << shift;
+    ++*data;
+  }
+  return true;
+}
+
+// File format, all values little-endian:
+//   magic, version, oat checksum, number of dex files,
+//   for each dex file: location length, location, location checksum, external classes hash.
+bool VerificationDeps::WriteToFile(const std::string& filename, std::string* error_msg) const {
+  std::vector<uint8_t> buffer(kMagic, kMagic + sizeof(kMagic));
+  buffer.insert(buffer.end(), kVersion, kVersion + sizeof(kVersion));
+  AppendUint32(&buffer, oat_checksum_);
+  AppendUint32(&buffer, dchecked_integral_cast<uint32_t>(dex_files_.size()));
+  for (const auto& entry : dex_files_) {
+    AppendUint32(&buffer, dchecked_integral_cast<uint32_t>(entry.first.size()));
+    buffer.insert(buffer.end(), entry.first.begin(), entry.first.end());
+    AppendUint32(&buffer, entry.second.location_checksum);
+    AppendUint32(&buffer, entry.second.external_classes_hash);
+  }
+
+  std::unique_ptr<File> file(OS::CreateEmptyFile(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Failed to create " + filename;
+    return false;
+  }
+  if (!file->WriteFully(buffer.data(), buffer.size())) {
+    *error_msg = "Failed to write " + filename;
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = "Failed to flush and close " + filename;
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<VerificationDeps> VerificationDeps::ReadFromFile(const std::string& filename,
+                                                                 std::string* error_msg) {
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Failed to open " + filename;
+    return nullptr;
+  }
+  int64_t length = file->GetLength();
+  if (length < 0) {
+    *error_msg = "Failed to get the length of " + filename;
+    return nullptr;
+  }
+  std::vector<uint8_t> buffer(static_cast<size_t>(length));
+  if (!file->ReadFully(buffer.data(), buffer.size())) {
+    *error_msg = "Failed to read " + filename;
+    return nullptr;
+  }
+
+  const uint8_t* data = buffer.data();
+  const uint8_t* end = data + buffer.size();
+  if (buffer.size() < sizeof(kMagic) + sizeof(kVersion) ||
+      memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+      memcmp(data + sizeof(kMagic), kVersion, sizeof(kVersion)) != 0) {
+    *error_msg = "Invalid header in " + filename;
+    return nullptr;
+  }
+  data += sizeof(kMagic) + sizeof(kVersion);
+
+  std::unique_ptr<VerificationDeps> deps(new VerificationDeps());
+  uint32_t num_dex_files;
+  if (!ReadUint32(&data, end, &deps->oat_checksum_) || !ReadUint32(&data, end, &num_dex_files)) {
+    *error_msg = "Truncated header in " + filename;
+    return nullptr;
+  }
+  for (uint32_t i = 0; i != num_dex_files; ++i) {
+    uint32_t location_size;
+    DexFileDeps dex_file_deps;
+    if (!ReadUint32(&data, end, &location_size) ||
+        static_cast<size_t>(end - data) < location_size) {
+      *error_msg = "Truncated dex file entry in " + filename;
+      return nullptr;
+    }
+    std::string location(reinterpret_cast<const char*>(data), location_size);
+    data += location_size;
+    if (!ReadUint32(&data, end, &dex_file_deps.location_checksum) ||
+        !ReadUint32(&data, end, &dex_file_deps.external_classes_hash)) {
+      *error_msg = "Truncated dex file entry in " + filename;
+      return nullptr;
+    }
+    deps->dex_files_.Overwrite(location, dex_file_deps);
+  }
+  if (data != end) {
+    *error_msg = "Unexpected data at the end of " + filename;
+    return nullptr;
+  }
+  return deps;
+}
+
+}  // namespace art
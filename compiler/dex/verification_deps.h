@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEX_VERIFICATION_DEPS_H_
+#define ART_COMPILER_DEX_VERIFICATION_DEPS_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/mutex.h"
+#include "handle.h"
+#include "safe_map.h"
+
+namespace art {
+
+class DexFile;
+
+namespace mirror {
+class ClassLoader;
+}  // namespace mirror
+
+// What the verification results stored in an oat file depend on outside of the dex files
+// compiled into it: for each dex file, a hash of the classes it gets from the boot class path
+// and the class path. It is written next to the oat file so that a later compilation against
+// a different boot image can still reuse the verification results of that oat file, for the
+// dex files whose external classes did not change.
+class VerificationDeps {
+ public:
+  VerificationDeps() : oat_checksum_(0u) {}
+
+  // Hash the classes referenced by `dex_file` that are not defined in `dex_files`. The hash
+  // covers what verification looks at: the class hierarchy, the access flags of the classes
+  // and the names, types and access flags of their fields and methods. Classes that cannot
+  // be resolved are hashed by descriptor only.
+  static uint32_t ComputeExternalClassesHash(const DexFile& dex_file,
+                                             const std::vector<const DexFile*>& dex_files,
+                                             Handle<mirror::ClassLoader> class_loader)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  void AddDexFile(const DexFile& dex_file, uint32_t external_classes_hash);
+
+  // Returns whether `dex_file`, with the same location checksum, was recorded with the same
+  // external classes hash.
+  bool HasSameExternalClasses(const DexFile& dex_file, uint32_t external_classes_hash) const;
+
+  // The checksum of the oat file these dependencies belong to.
+  uint32_t GetOatChecksum() const {
+    return oat_checksum_;
+  }
+  void SetOatChecksum(uint32_t oat_checksum) {
+    oat_checksum_ = oat_checksum;
+  }
+
+  bool WriteToFile(const std::string& filename, std::string* error_msg) const;
+  static std::unique_ptr<VerificationDeps> ReadFromFile(const std::string& filename,
+                                                        std::string* error_msg);
+
+ private:
+  static const uint8_t kMagic[4];
+  static const uint8_t kVersion[4];
+
+  struct DexFileDeps {
+    uint32_t location_checksum;
+    uint32_t external_classes_hash;
+  };
+
+  uint32_t oat_checksum_;
+  // Keyed by dex location.
+  SafeMap<std::string, DexFileDeps> dex_files_;
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DEX_VERIFICATION_DEPS_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verification_deps.h"
+
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "handle_scope-inl.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+
+class VerificationDepsTest : public CommonRuntimeTest {};
+
+TEST_F(VerificationDepsTest, WriteAndRead) {
+  std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("Main");
+  ASSERT_TRUE(dex_file != nullptr);
+
+  VerificationDeps deps;
+  deps.SetOatChecksum(0x12345678u);
+  deps.AddDexFile(*dex_file, 0xcafebabeu);
+
+  ScratchFile file;
+  std::string error_msg;
+  ASSERT_TRUE(deps.WriteToFile(file.GetFilename(), &error_msg)) << error_msg;
+  std::unique_ptr<VerificationDeps> read_deps =
+      VerificationDeps::ReadFromFile(file.GetFilename(), &error_msg);
+  ASSERT_TRUE(read_deps != nullptr) << error_msg;
+
+  EXPECT_EQ(0x12345678u, read_deps->GetOatChecksum());
+  EXPECT_TRUE(read_deps->HasSameExternalClasses(*dex_file, 0xcafebabeu));
+  EXPECT_FALSE(read_deps->HasSameExternalClasses(*dex_file, 0xdeadbeefu));
+}
+
+TEST_F(VerificationDepsTest, ExternalClassesHash) {
+  jobject jclass_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    jclass_loader = LoadDex("Main");
+  }
+  std::vector<const DexFile*> dex_files = GetDexFiles(jclass_loader);
+  ASSERT_EQ(1u, dex_files.size());
+
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(jclass_loader)));
+  uint32_t hash =
+      VerificationDeps::ComputeExternalClassesHash(*dex_files[0], dex_files, class_loader);
+  EXPECT_EQ(hash,
+            VerificationDeps::ComputeExternalClassesHash(*dex_files[0], dex_files, class_loader));
+
+  // When the classes of the dex file come from elsewhere, they contribute to the hash.
+  std::vector<const DexFile*> no_dex_files;
+  EXPECT_NE(hash, VerificationDeps::ComputeExternalClassesHash(*dex_files[0],
+                                                               no_dex_files,
+                                                               class_loader));
+}
+
+}  // namespace art
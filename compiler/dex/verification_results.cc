@@ -74,6 +74,13 @@ void VerificationResults::ProcessVerifiedMethod(verifier::MethodVerifier* method
   DCHECK(verified_methods_.find(ref) != verified_methods_.end());
 }
 
+void VerificationResults::AddMethodVerifiedWithoutFailures(MethodReference ref) {
+  WriterMutexLock mu(Thread::Current(), verified_methods_lock_);
+  if (verified_methods_.find(ref) == verified_methods_.end()) {
+    verified_methods_.Put(ref, VerifiedMethod::CreateWithoutFailures());
+  }
+}
+
 const VerifiedMethod* VerificationResults::GetVerifiedMethod(MethodReference ref) {
   ReaderMutexLock mu(Thread::Current(), verified_methods_lock_);
   auto it = verified_methods_.find(ref);
@@ -46,6 +46,10 @@ class VerificationResults {
         SHARED_REQUIRES(Locks::mutator_lock_)
         REQUIRES(!verified_methods_lock_);
 
+    // Record a method that verified without failures in an earlier compilation.
+    void AddMethodVerifiedWithoutFailures(MethodReference ref)
+        REQUIRES(!verified_methods_lock_);
+
     const VerifiedMethod* GetVerifiedMethod(MethodReference ref)
         REQUIRES(!verified_methods_lock_);
 
@@ -68,6 +68,10 @@ const VerifiedMethod* VerifiedMethod::Create(verifier::MethodVerifier* method_ve
   return verified_method.release();
 }
 
+const VerifiedMethod* VerifiedMethod::CreateWithoutFailures() {
+  return new VerifiedMethod(/* encountered_error_types */ 0u, /* has_runtime_throw */ false);
+}
+
 const MethodReference* VerifiedMethod::GetDevirtTarget(uint32_t dex_pc) const {
   auto it = devirt_map_.find(dex_pc);
   return (it != devirt_map_.end()) ? &it->second : nullptr;
@@ -45,6 +45,11 @@ class VerifiedMethod {
 
   static const VerifiedMethod* Create(verifier::MethodVerifier* method_verifier, bool compile)
       SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Create the metadata of a method known to verify without failures, without running the
+  // verifier. No devirtualization or cast elision data is recorded.
+  static const VerifiedMethod* CreateWithoutFailures();
+
   ~VerifiedMethod() = default;
 
   const DevirtualizationMap& GetDevirtMap() const {
@@ -177,7 +177,7 @@ CompiledMethodStorage::CompiledMethodStorage(int swap_fd)
       dedupe_vmap_table_("dedupe vmap table",
                          LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
       dedupe_cfi_info_("dedupe cfi info", LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
-      dedupe_linker_patches_("dedupe cfi info",
+      dedupe_linker_patches_("dedupe linker patches",
                              LengthPrefixedArrayAlloc<LinkerPatch>(swap_space_.get())) {
 }
 
@@ -193,8 +193,10 @@ void CompiledMethodStorage::DumpMemoryUsage(std::ostream& os, bool extended) con
   if (extended) {
     Thread* self = Thread::Current();
     os << "\nCode dedupe: " << dedupe_code_.DumpStats(self);
+    os << "\nSrc mapping table dedupe: " << dedupe_src_mapping_table_.DumpStats(self);
     os << "\nVmap table dedupe: " << dedupe_vmap_table_.DumpStats(self);
     os << "\nCFI info dedupe: " << dedupe_cfi_info_.DumpStats(self);
+    os << "\nLinker patches dedupe: " << dedupe_linker_patches_.DumpStats(self);
   }
 }
 
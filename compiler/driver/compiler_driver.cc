@@ -16,6 +16,7 @@
 
 #include "compiler_driver.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 #include <unistd.h>
@@ -41,11 +42,13 @@
 #include "dex_file-inl.h"
 #include "dex_instruction-inl.h"
 #include "dex/dex_to_dex_compiler.h"
+#include "dex/verification_deps.h"
 #include "dex/verification_results.h"
 #include "dex/verified_method.h"
 #include "dex/quick/dex_file_method_inliner.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
 #include "driver/compiler_options.h"
+#include "driver/pass_statistics.h"
 #include "jni_internal.h"
 #include "object_lock.h"
 #include "runtime.h"
@@ -59,6 +62,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/throwable.h"
+#include "oat_file.h"
 #include "scoped_thread_state_change.h"
 #include "ScopedLocalRef.h"
 #include "handle_scope-inl.h"
@@ -84,6 +88,10 @@ static constexpr bool kRestrictCompilationFiltersToImage = true;
 // Print additional info during profile guided compilation.
 static constexpr bool kDebugProfileGuidedCompilation = false;
 
+// Classes with more dex code units than this are compiled as several work items, so that a
+// single large class does not keep one thread busy while the others are idle.
+static constexpr size_t kMaxCompileWorkItemCodeUnits = 4 * KB;
+
 static double Percentage(size_t x, size_t y) {
   return 100.0 * (static_cast<double>(x)) / (static_cast<double>(x + y));
 }
@@ -394,12 +402,20 @@ CompilerDriver::CompilerDriver(
       dump_stats_(dump_stats),
       dump_passes_(dump_passes),
       timings_logger_(timer),
+      pass_statistics_(compiler_options->GetPassStatsFileName().empty()
+                           ? nullptr
+                           : new PassStatistics()),
       compiler_context_(nullptr),
       support_boot_image_fixup_(instruction_set != kMips64),
       dex_files_for_oat_file_(nullptr),
+      input_oat_file_(nullptr),
+      input_verification_deps_(nullptr),
+      output_verification_deps_(nullptr),
       compiled_method_storage_(swap_fd),
       profile_compilation_info_(profile_compilation_info),
       max_arena_alloc_(0),
+      compile_deadline_ns_(0u),
+      methods_over_compile_budget_(0u),
       dex_to_dex_references_lock_("dex-to-dex references lock"),
       dex_to_dex_references_(),
       current_dex_to_dex_methods_(nullptr) {
@@ -480,6 +496,8 @@ void CompilerDriver::CompileAll(jobject class_loader,
   // 3) Attempt to verify all classes
   // 4) Attempt to initialize image classes, and trivially initialized classes
   PreCompile(class_loader, dex_files, timings);
+  // Verification leaves its arenas in the pool, release them before compiling.
+  Runtime::Current()->ReclaimArenaPoolMemory();
   // Compile:
   // 1) Compile all classes and methods enabled for compilation. May fall back to dex-to-dex
   //    compilation.
@@ -623,7 +641,9 @@ static void CompileMethod(Thread* self,
             (verifier::VERIFY_ERROR_FORCE_INTERPRETER | verifier::VERIFY_ERROR_LOCKING)) == 0 &&
         // Is eligable for compilation by methods-to-compile filter.
         driver->IsMethodToCompile(method_ref) &&
-        driver->ShouldCompileBasedOnProfile(method_ref);
+        driver->ShouldCompileBasedOnProfile(method_ref) &&
+        // Checked last, so that only methods we would otherwise compile are reported.
+        !driver->IsOverCompileBudget();
 
     if (compile) {
       // NOTE: if compiler declines to compile this method, it will return null.
@@ -985,6 +1005,19 @@ bool CompilerDriver::ShouldCompileBasedOnProfile(const MethodReference& method_r
   return result;
 }
 
+bool CompilerDriver::IsOverCompileBudget() {
+  if (compile_deadline_ns_ == 0u || NanoTime() <= compile_deadline_ns_) {
+    return false;
+  }
+  methods_over_compile_budget_.FetchAndAddRelaxed(1u);
+  return true;
+}
+
+bool CompilerDriver::IsMethodInProfile(const MethodReference& method_ref) const {
+  return profile_compilation_info_ != nullptr &&
+      profile_compilation_info_->ContainsMethod(method_ref);
+}
+
 bool CompilerDriver::ShouldVerifyClassBasedOnProfile(const DexFile& dex_file,
                                                      uint16_t class_idx) const {
   if (!compiler_options_->VerifyOnlyProfile()) {
@@ -2221,21 +2254,121 @@ void CompilerDriver::Verify(jobject class_loader,
   // Note: verification should not be pulling in classes anymore when compiling the boot image,
   //       as all should have been resolved before. As such, doing this in parallel should still
   //       be deterministic.
-  for (const DexFile* dex_file : dex_files) {
+  std::vector<uint32_t> external_classes_hashes =
+      ComputeExternalClassesHashes(class_loader, dex_files, timings);
+  std::vector<const OatDexFile*> input_oat_dex_files =
+      FindUnchangedDexFiles(dex_files, external_classes_hashes);
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile* dex_file = dex_files[i];
     CHECK(dex_file != nullptr);
     VerifyDexFile(class_loader,
                   *dex_file,
                   dex_files,
+                  input_oat_dex_files[i],
                   parallel_thread_pool_.get(),
                   parallel_thread_count_,
                   timings);
   }
 }
 
+std::vector<uint32_t> CompilerDriver::ComputeExternalClassesHashes(
+    jobject class_loader,
+    const std::vector<const DexFile*>& dex_files,
+    TimingLogger* timings) {
+  std::vector<uint32_t> result;
+  if ((input_oat_file_ == nullptr || input_verification_deps_ == nullptr) &&
+      output_verification_deps_ == nullptr) {
+    return result;
+  }
+  TimingLogger::ScopedTiming t("Compute external classes hashes", timings);
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(class_loader)));
+  result.reserve(dex_files.size());
+  for (const DexFile* dex_file : dex_files) {
+    uint32_t hash = VerificationDeps::ComputeExternalClassesHash(*dex_file, dex_files, loader);
+    if (output_verification_deps_ != nullptr) {
+      output_verification_deps_->AddDexFile(*dex_file, hash);
+    }
+    result.push_back(hash);
+  }
+  return result;
+}
+
+std::vector<const OatDexFile*> CompilerDriver::FindUnchangedDexFiles(
+    const std::vector<const DexFile*>& dex_files,
+    const std::vector<uint32_t>& external_classes_hashes) const {
+  std::vector<const OatDexFile*> result(dex_files.size(), nullptr);
+  if (input_oat_file_ == nullptr) {
+    return result;
+  }
+  // Without verification dependencies, the boot class path and the class path are checked by
+  // the caller providing the oat file. With them, each dex file is checked against the classes
+  // it uses from there. Either way, a dex file can then only be affected by changes to the other
+  // dex files compiled here.
+  std::unordered_set<std::string> changed_descriptors;
+  auto mark_changed = [&](size_t i) {
+    result[i] = nullptr;
+    const DexFile& dex_file = *dex_files[i];
+    for (size_t j = 0; j != dex_file.NumClassDefs(); ++j) {
+      changed_descriptors.insert(dex_file.GetClassDescriptor(dex_file.GetClassDef(j)));
+    }
+  };
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile& dex_file = *dex_files[i];
+    uint32_t checksum = dex_file.GetLocationChecksum();
+    result[i] = input_oat_file_->GetOatDexFile(dex_file.GetLocation().c_str(),
+                                               &checksum,
+                                               /* exception_if_not_found */ false);
+    if (result[i] != nullptr &&
+        input_verification_deps_ != nullptr &&
+        !input_verification_deps_->HasSameExternalClasses(dex_file, external_classes_hashes[i])) {
+      VLOG(compiler) << dex_file.GetLocation()
+                     << " references classes that changed in the boot class path or class path";
+      result[i] = nullptr;
+    }
+    if (result[i] == nullptr) {
+      mark_changed(i);
+    }
+  }
+  // Verifying a class can look at any class it references, and transitively at their super
+  // classes and interfaces, so treat any dex file referencing a changed class as changed too.
+  bool updated = !changed_descriptors.empty();
+  while (updated) {
+    updated = false;
+    for (size_t i = 0; i != dex_files.size(); ++i) {
+      if (result[i] == nullptr) {
+        continue;
+      }
+      const DexFile& dex_file = *dex_files[i];
+      for (size_t type_idx = 0; type_idx != dex_file.NumTypeIds(); ++type_idx) {
+        const char* descriptor = dex_file.StringByTypeIdx(type_idx);
+        if (changed_descriptors.find(descriptor) != changed_descriptors.end()) {
+          VLOG(compiler) << dex_file.GetLocation() << " references changed class "
+                         << PrettyDescriptor(descriptor);
+          mark_changed(i);
+          updated = true;
+          break;
+        }
+      }
+    }
+  }
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    if (result[i] != nullptr) {
+      VLOG(compiler) << "Reusing verification results of " << dex_files[i]->GetLocation()
+                     << " from " << input_oat_file_->GetLocation();
+    }
+  }
+  return result;
+}
+
 class VerifyClassVisitor : public CompilationVisitor {
  public:
-  VerifyClassVisitor(const ParallelCompilationManager* manager, LogSeverity log_level)
-     : manager_(manager), log_level_(log_level) {}
+  VerifyClassVisitor(const ParallelCompilationManager* manager,
+                     LogSeverity log_level,
+                     const OatDexFile* input_oat_dex_file)
+     : manager_(manager), log_level_(log_level), input_oat_dex_file_(input_oat_dex_file) {}
 
   virtual void Visit(size_t class_def_index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
     ATRACE_CALL();
@@ -2245,6 +2378,12 @@ class VerifyClassVisitor : public CompilationVisitor {
       // Skip verification since the class is not in the profile.
       return;
     }
+    if (input_oat_dex_file_ != nullptr &&
+        input_oat_dex_file_->GetOatClass(class_def_index).GetStatus() >=
+            mirror::Class::kStatusVerified &&
+        ReuseVerification(soa, class_def_index)) {
+      return;
+    }
     const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     const char* descriptor = dex_file.GetClassDescriptor(class_def);
     ClassLinker* class_linker = manager_->GetClassLinker();
@@ -2304,13 +2443,65 @@ class VerifyClassVisitor : public CompilationVisitor {
   }
 
  private:
+  // Mark the class as verified without running the verifier, as it fully verified when the
+  // input oat file was compiled and neither it nor its dependencies changed since then.
+  // Return false if the class must be verified normally.
+  bool ReuseVerification(const ScopedObjectAccess& soa, size_t class_def_index)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    const DexFile& dex_file = *manager_->GetDexFile();
+    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
+    jobject jclass_loader = manager_->GetClassLoader();
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader*>(jclass_loader)));
+    Handle<mirror::Class> klass(hs.NewHandle(manager_->GetClassLinker()->FindClass(
+        soa.Self(), dex_file.GetClassDescriptor(class_def), class_loader)));
+    if (klass.Get() == nullptr) {
+      soa.Self()->ClearException();
+      return false;
+    }
+    if (SkipClass(jclass_loader, dex_file, klass.Get()) || !klass->IsResolved()) {
+      return false;
+    }
+    if (klass->GetStatus() < mirror::Class::kStatusVerified) {
+      ObjectLock<mirror::Class> lock(soa.Self(), klass);
+      mirror::Class::SetStatus(klass, mirror::Class::kStatusVerified, soa.Self());
+      // Mark methods as pre-verified. If we don't do this, the interpreter will run with
+      // access checks.
+      klass->SetSkipAccessChecksFlagOnAllMethods(
+          GetInstructionSetPointerSize(manager_->GetCompiler()->GetInstructionSet()));
+      klass->SetVerificationAttempted();
+    }
+    // The compiler needs a VerifiedMethod for each method it compiles.
+    const uint8_t* class_data = dex_file.GetClassData(class_def);
+    if (class_data != nullptr) {
+      VerificationResults* verification_results =
+          manager_->GetCompiler()->GetVerificationResults();
+      ClassDataItemIterator it(dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+        if (it.GetMethodCodeItemOffset() != 0u) {
+          verification_results->AddMethodVerifiedWithoutFailures(
+              MethodReference(&dex_file, it.GetMemberIndex()));
+        }
+      }
+    }
+    ClassReference ref(&dex_file, class_def_index);
+    manager_->GetCompiler()->RecordClassStatus(ref, klass->GetStatus());
+    return true;
+  }
+
   const ParallelCompilationManager* const manager_;
   const LogSeverity log_level_;
+  const OatDexFile* const input_oat_dex_file_;
 };
 
 void CompilerDriver::VerifyDexFile(jobject class_loader,
                                    const DexFile& dex_file,
                                    const std::vector<const DexFile*>& dex_files,
+                                   const OatDexFile* input_oat_dex_file,
                                    ThreadPool* thread_pool,
                                    size_t thread_count,
                                    TimingLogger* timings) {
@@ -2321,7 +2512,7 @@ void CompilerDriver::VerifyDexFile(jobject class_loader,
   LogSeverity log_level = GetCompilerOptions().AbortOnHardVerifierFailure()
                               ? LogSeverity::INTERNAL_FATAL
                               : LogSeverity::WARNING;
-  VerifyClassVisitor visitor(&context, log_level);
+  VerifyClassVisitor visitor(&context, log_level, input_oat_dex_file);
   context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
 }
 
@@ -2428,8 +2619,10 @@ class InitializeClassVisitor : public CompilationVisitor {
           if (!klass->IsInitialized()) {
             // We need to initialize static fields, we only do this for image classes that aren't
             // marked with the $NoPreloadHolder (which implies this should not be initialized early).
-            bool can_init_static_fields = manager_->GetCompiler()->IsBootImage() &&
-                manager_->GetCompiler()->IsImageClass(descriptor) &&
+            // For app images, all the classes of the app are image classes.
+            const CompilerDriver* compiler = manager_->GetCompiler();
+            bool can_init_static_fields = (compiler->IsBootImage() || compiler->IsAppImage()) &&
+                compiler->IsImageClass(descriptor) &&
                 !StringPiece(descriptor).ends_with("$NoPreloadHolder;");
             if (can_init_static_fields) {
               VLOG(compiler) << "Initializing: " << descriptor;
@@ -2466,6 +2659,14 @@ class InitializeClassVisitor : public CompilationVisitor {
                 soa.Self()->ClearException();
                 transaction.Rollback();
                 CHECK_EQ(old_status, klass->GetStatus()) << "Previous class status not restored";
+              } else if (!compiler->IsBootImage() && transaction.ModifiedBootImage()) {
+                // The app image cannot carry changes to boot image objects, for example the
+                // statics of a boot class the initializer touched. Keep only initializers
+                // whose effects are confined to the app.
+                VLOG(compiler) << "Initialization of " << descriptor
+                    << " aborted because it modified the boot image";
+                transaction.Rollback();
+                CHECK_EQ(old_status, klass->GetStatus()) << "Previous class status not restored";
               }
             }
           }
@@ -2500,7 +2701,7 @@ void CompilerDriver::InitializeClasses(jobject jni_class_loader,
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ParallelCompilationManager context(class_linker, jni_class_loader, this, &dex_file, dex_files,
                                      init_thread_pool);
-  if (IsBootImage()) {
+  if (IsBootImage() || IsAppImage()) {
     // TODO: remove this when transactional mode supports multithreading.
     init_thread_count = 1U;
   }
@@ -2580,6 +2781,11 @@ void CompilerDriver::Compile(jobject class_loader,
             : profile_compilation_info_->DumpInfo(&dex_files));
   }
 
+  const size_t compile_budget_ms = compiler_options_->GetCompileBudgetMs();
+  if (compile_budget_ms != 0u) {
+    compile_deadline_ns_ = NanoTime() + MsToNs(compile_budget_ms);
+  }
+
   DCHECK(current_dex_to_dex_methods_ == nullptr);
   for (const DexFile* dex_file : dex_files) {
     CHECK(dex_file != nullptr);
@@ -2594,6 +2800,13 @@ void CompilerDriver::Compile(jobject class_loader,
     max_arena_alloc_ = std::max(arena_alloc, max_arena_alloc_);
     Runtime::Current()->ReclaimArenaPoolMemory();
   }
+  // The remaining dex-to-dex compilation is cheap and not subject to the budget.
+  compile_deadline_ns_ = 0u;
+  const size_t methods_over_compile_budget = methods_over_compile_budget_.LoadRelaxed();
+  if (methods_over_compile_budget != 0u) {
+    LOG(WARNING) << "Compile budget of " << compile_budget_ms << "ms exceeded, "
+                 << methods_over_compile_budget << " methods left to the interpreter and the JIT";
+  }
 
   ArrayRef<DexFileMethodSet> dex_to_dex_references;
   {
@@ -2616,12 +2829,64 @@ void CompilerDriver::Compile(jobject class_loader,
   VLOG(compiler) << "Compile: " << GetMemoryUsageString(false);
 }
 
+// A range of methods of a class to compile, numbered in class data order, i.e. direct methods
+// first, then virtual methods.
+struct CompileWorkItem {
+  uint16_t class_def_index;
+  uint32_t begin_method;
+  uint32_t end_method;
+  // Estimated compilation cost, in dex code units.
+  size_t cost;
+};
+
+// Split the classes of `dex_file` into work items and order them by decreasing cost. Starting
+// with the most expensive items keeps all threads busy until the end of the compilation.
+static std::vector<CompileWorkItem> CreateCompileWorkItems(const DexFile& dex_file) {
+  std::vector<CompileWorkItem> work_items;
+  work_items.reserve(dex_file.NumClassDefs());
+  for (size_t class_def_index = 0; class_def_index != dex_file.NumClassDefs(); ++class_def_index) {
+    CompileWorkItem item = { static_cast<uint16_t>(class_def_index), 0u, 0u, 0u };
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(class_def_index));
+    if (class_data != nullptr) {
+      ClassDataItemIterator it(dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      uint32_t method = 0u;
+      for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); ++method, it.Next()) {
+        const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+        // Count one unit for each method so that native methods are not free.
+        size_t cost = 1u + ((code_item != nullptr) ? code_item->insns_size_in_code_units_ : 0u);
+        if (item.cost != 0u && item.cost + cost > kMaxCompileWorkItemCodeUnits) {
+          item.end_method = method;
+          work_items.push_back(item);
+          item.begin_method = method;
+          item.cost = 0u;
+        }
+        item.cost += cost;
+      }
+      item.end_method = method;
+    }
+    work_items.push_back(item);
+  }
+  std::stable_sort(work_items.begin(),
+                   work_items.end(),
+                   [](const CompileWorkItem& lhs, const CompileWorkItem& rhs) {
+                     return lhs.cost > rhs.cost;
+                   });
+  return work_items;
+}
+
 class CompileClassVisitor : public CompilationVisitor {
  public:
-  explicit CompileClassVisitor(const ParallelCompilationManager* manager) : manager_(manager) {}
+  CompileClassVisitor(const ParallelCompilationManager* manager,
+                      const std::vector<CompileWorkItem>* work_items)
+      : manager_(manager), work_items_(work_items) {}
 
-  virtual void Visit(size_t class_def_index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
+  virtual void Visit(size_t index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
     ATRACE_CALL();
+    const CompileWorkItem& work_item = (*work_items_)[index];
+    const size_t class_def_index = work_item.class_def_index;
     const DexFile& dex_file = *manager_->GetDexFile();
     const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     ClassLinker* class_linker = manager_->GetClassLinker();
@@ -2677,45 +2942,37 @@ class CompileClassVisitor : public CompilationVisitor {
     bool compilation_enabled = driver->IsClassToCompile(
         dex_file.StringByTypeIdx(class_def.class_idx_));
 
-    // Compile direct methods
-    int64_t previous_direct_method_idx = -1;
-    while (it.HasNextDirectMethod()) {
+    // Compile the direct, then virtual, methods of the work item.
+    uint32_t method = 0u;
+    int64_t previous_method_idx = -1;
+    bool previous_was_direct = true;
+    for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); ++method, it.Next()) {
       uint32_t method_idx = it.GetMemberIndex();
-      if (method_idx == previous_direct_method_idx) {
+      bool is_direct = it.HasNextDirectMethod();
+      if (is_direct != previous_was_direct) {
+        previous_method_idx = -1;
+        previous_was_direct = is_direct;
+      }
+      if (method_idx == previous_method_idx) {
         // smali can create dex files with two encoded_methods sharing the same method_idx
         // http://code.google.com/p/smali/issues/detail?id=119
-        it.Next();
         continue;
       }
-      previous_direct_method_idx = method_idx;
-      CompileMethod(soa.Self(), driver, it.GetMethodCodeItem(), it.GetMethodAccessFlags(),
-                    it.GetMethodInvokeType(class_def), class_def_index,
-                    method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level,
-                    compilation_enabled, dex_cache);
-      it.Next();
-    }
-    // Compile virtual methods
-    int64_t previous_virtual_method_idx = -1;
-    while (it.HasNextVirtualMethod()) {
-      uint32_t method_idx = it.GetMemberIndex();
-      if (method_idx == previous_virtual_method_idx) {
-        // smali can create dex files with two encoded_methods sharing the same method_idx
-        // http://code.google.com/p/smali/issues/detail?id=119
-        it.Next();
+      previous_method_idx = method_idx;
+      if (method < work_item.begin_method || method >= work_item.end_method) {
         continue;
       }
-      previous_virtual_method_idx = method_idx;
       CompileMethod(soa.Self(), driver, it.GetMethodCodeItem(), it.GetMethodAccessFlags(),
                     it.GetMethodInvokeType(class_def), class_def_index,
                     method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level,
                     compilation_enabled, dex_cache);
-      it.Next();
     }
     DCHECK(!it.HasNext());
   }
 
  private:
   const ParallelCompilationManager* const manager_;
+  const std::vector<CompileWorkItem>* const work_items_;
 };
 
 void CompilerDriver::CompileDexFile(jobject class_loader,
@@ -2727,8 +2984,9 @@ void CompilerDriver::CompileDexFile(jobject class_loader,
   TimingLogger::ScopedTiming t("Compile Dex File", timings);
   ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
                                      &dex_file, dex_files, thread_pool);
-  CompileClassVisitor visitor(&context);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  std::vector<CompileWorkItem> work_items = CreateCompileWorkItems(dex_file);
+  CompileClassVisitor visitor(&context, &work_items);
+  context.ForAll(0, work_items.size(), &visitor, thread_count);
 }
 
 void CompilerDriver::AddCompiledMethod(const MethodReference& method_ref,
@@ -2905,8 +3163,10 @@ bool CompilerDriver::MayInlineInternal(const DexFile* inlined_from,
 
 void CompilerDriver::InitializeThreadPools() {
   size_t parallel_count = parallel_thread_count_ > 0 ? parallel_thread_count_ - 1 : 0;
-  parallel_thread_pool_.reset(
-      new ThreadPool("Compiler driver thread pool", parallel_count));
+  parallel_thread_pool_.reset(new ThreadPool("Compiler driver thread pool",
+                                            parallel_count,
+                                            /* prioritized */ false,
+                                            /* work_stealing */ true));
   single_thread_pool_.reset(new ThreadPool("Single-threaded Compiler driver thread pool", 0));
 }
 
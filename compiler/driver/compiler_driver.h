@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "arch/instruction_set.h"
+#include "atomic.h"
 #include "base/arena_allocator.h"
 #include "base/bit_utils.h"
 #include "base/mutex.h"
@@ -60,13 +61,17 @@ class DexCompilationUnit;
 class DexFileToMethodInlinerMap;
 struct InlineIGetIPutData;
 class InstructionSetFeatures;
+class OatDexFile;
+class OatFile;
 class ParallelCompilationManager;
+class PassStatistics;
 class ScopedObjectAccess;
 template <class Allocator> class SrcMap;
 class SrcMapElem;
 using SwapSrcMap = SrcMap<SwapAllocator<SrcMapElem>>;
 template<class T> class Handle;
 class TimingLogger;
+class VerificationDeps;
 class VerificationResults;
 class VerifiedMethod;
 
@@ -118,6 +123,24 @@ class CompilerDriver {
         : ArrayRef<const DexFile* const>();
   }
 
+  // Set an oat file previously compiled from the same application against the same boot image
+  // and class path. Verification results are reused for classes of dex files that did not change.
+  void SetInputOatFile(const OatFile* input_oat_file) {
+    input_oat_file_ = input_oat_file;
+  }
+
+  // Set the verification dependencies recorded with the input oat file. With them, the input
+  // oat file is also used for dex files whose classes from the boot class path and the class
+  // path did not change, even if the boot image or the class path did.
+  void SetInputVerificationDeps(const VerificationDeps* input_verification_deps) {
+    input_verification_deps_ = input_verification_deps;
+  }
+
+  // Record the verification dependencies of the dex files compiled here in `verification_deps`.
+  void SetOutputVerificationDeps(VerificationDeps* verification_deps) {
+    output_verification_deps_ = verification_deps;
+  }
+
   void CompileAll(jobject class_loader,
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings)
@@ -158,6 +181,11 @@ class CompilerDriver {
     return boot_image_;
   }
 
+  // Are we compiling and creating an app image file?
+  bool IsAppImage() const {
+    return app_image_;
+  }
+
   const std::unordered_set<std::string>* GetImageClasses() const {
     return image_classes_.get();
   }
@@ -414,6 +442,11 @@ class CompilerDriver {
     return timings_logger_;
   }
 
+  // Null unless --dump-pass-stats is given.
+  PassStatistics* GetPassStatistics() const {
+    return pass_statistics_.get();
+  }
+
   void SetDedupeEnabled(bool dedupe_enabled) {
     compiled_method_storage_.SetDedupeEnabled(dedupe_enabled);
   }
@@ -434,6 +467,18 @@ class CompilerDriver {
   // according to the profile file.
   bool ShouldCompileBasedOnProfile(const MethodReference& method_ref) const;
 
+  // Checks whether the --compile-budget deadline passed. The methods not compiled yet are then
+  // left to the interpreter and the JIT, and counted for the report at the end of Compile().
+  bool IsOverCompileBudget();
+
+  // Checks whether the profile lists the method as hot. Always false when compiling
+  // without a profile.
+  bool IsMethodInProfile(const MethodReference& method_ref) const;
+
+  const ProfileCompilationInfo* GetProfileCompilationInfo() const {
+    return profile_compilation_info_;
+  }
+
   // Checks whether profile guided verification is enabled and if the method should be verified
   // according to the profile file.
   bool ShouldVerifyClassBasedOnProfile(const DexFile& dex_file, uint16_t class_idx) const;
@@ -577,11 +622,25 @@ class CompilerDriver {
   void VerifyDexFile(jobject class_loader,
                      const DexFile& dex_file,
                      const std::vector<const DexFile*>& dex_files,
+                     const OatDexFile* input_oat_dex_file,
                      ThreadPool* thread_pool,
                      size_t thread_count,
                      TimingLogger* timings)
       REQUIRES(!Locks::mutator_lock_);
 
+  // Return the external classes hashes of `dex_files` if verification dependencies are used,
+  // recording them in the output verification dependencies, or an empty vector otherwise.
+  std::vector<uint32_t> ComputeExternalClassesHashes(jobject class_loader,
+                                                     const std::vector<const DexFile*>& dex_files,
+                                                     TimingLogger* timings)
+      REQUIRES(!Locks::mutator_lock_);
+
+  // Return, for each of `dex_files`, its entry in the input oat file if neither the dex file
+  // nor any dex file defining a class it references changed since then, or null otherwise.
+  std::vector<const OatDexFile*> FindUnchangedDexFiles(
+      const std::vector<const DexFile*>& dex_files,
+      const std::vector<uint32_t>& external_classes_hashes) const;
+
   void SetVerified(jobject class_loader,
                    const std::vector<const DexFile*>& dex_files,
                    TimingLogger* timings);
@@ -694,6 +753,8 @@ class CompilerDriver {
 
   CumulativeLogger* const timings_logger_;
 
+  std::unique_ptr<PassStatistics> pass_statistics_;
+
   typedef void (*CompilerCallbackFn)(CompilerDriver& driver);
   typedef MutexLock* (*CompilerMutexLockFn)(CompilerDriver& driver);
 
@@ -704,6 +765,15 @@ class CompilerDriver {
   // List of dex files that will be stored in the oat file.
   const std::vector<const DexFile*>* dex_files_for_oat_file_;
 
+  // Oat file of a previous compilation to reuse verification results from, or null.
+  const OatFile* input_oat_file_;
+
+  // Verification dependencies of the input oat file, or null.
+  const VerificationDeps* input_verification_deps_;
+
+  // Where to record the verification dependencies of this compilation, or null.
+  VerificationDeps* output_verification_deps_;
+
   CompiledMethodStorage compiled_method_storage_;
 
   // Info for profile guided compilation.
@@ -711,6 +781,11 @@ class CompilerDriver {
 
   size_t max_arena_alloc_;
 
+  // Deadline from --compile-budget, or 0 for no deadline.
+  uint64_t compile_deadline_ns_;
+  // Number of methods not compiled because of the deadline.
+  Atomic<size_t> methods_over_compile_budget_;
+
   // Data for delaying dex-to-dex compilation.
   Mutex dex_to_dex_references_lock_;
   // In the first phase, dex_to_dex_references_ collects methods for dex-to-dex compilation.
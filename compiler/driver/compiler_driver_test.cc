@@ -130,12 +130,16 @@ TEST_F(CompilerDriverTest, DISABLED_LARGE_CompileDexLibCore) {
         << " " << dex.GetMethodDeclaringClassDescriptor(dex.GetMethodId(i)) << " "
         << dex.GetMethodName(dex.GetMethodId(i));
   }
-  EXPECT_EQ(dex.NumFieldIds(), dex_cache->NumResolvedFields());
+  // The resolved fields are hash-indexed, so only the field last stored in each slot remains.
+  EXPECT_EQ(mirror::DexCache::NumResolvedFieldsFor(dex.NumFieldIds()),
+            dex_cache->NumResolvedFields());
+  mirror::FieldDexCachePair* fields = dex_cache->GetResolvedFields();
   for (size_t i = 0; i < dex_cache->NumResolvedFields(); i++) {
-    ArtField* field = cl->GetResolvedField(i, dex_cache);
-    EXPECT_TRUE(field != nullptr) << "field_idx=" << i
-                               << " " << dex.GetFieldDeclaringClassDescriptor(dex.GetFieldId(i))
-                               << " " << dex.GetFieldName(dex.GetFieldId(i));
+    mirror::FieldDexCachePair pair = mirror::DexCache::GetFieldPairPtrSize(fields, i, pointer_size);
+    EXPECT_TRUE(pair.field != nullptr) << "slot=" << i;
+    EXPECT_EQ(i, pair.index % mirror::DexCache::kDexCacheFieldCacheSize);
+    EXPECT_EQ(pair.field, cl->GetResolvedField(pair.index, dex_cache))
+        << "field_idx=" << pair.index;
   }
 
   // TODO check Class::IsVerified for all classes
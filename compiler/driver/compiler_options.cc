@@ -44,8 +44,12 @@ CompilerOptions::CompilerOptions()
       init_failure_output_(nullptr),
       dump_cfg_file_name_(""),
       dump_cfg_append_(false),
+      pass_stats_file_name_(""),
       force_determinism_(false),
-      register_allocation_strategy_(RegisterAllocator::kRegisterAllocatorDefault) {
+      register_allocation_strategy_(RegisterAllocator::kRegisterAllocatorDefault),
+      profile_guided_register_allocation_(true),
+      method_compile_budget_ms_(0u),
+      compile_budget_ms_(0u) {
 }
 
 CompilerOptions::~CompilerOptions() {
@@ -101,8 +105,12 @@ CompilerOptions::CompilerOptions(CompilerFilter::Filter compiler_filter,
     init_failure_output_(init_failure_output),
     dump_cfg_file_name_(dump_cfg_file_name),
     dump_cfg_append_(dump_cfg_append),
+    pass_stats_file_name_(""),
     force_determinism_(force_determinism),
-    register_allocation_strategy_(regalloc_strategy) {
+    register_allocation_strategy_(regalloc_strategy),
+    profile_guided_register_allocation_(true),
+    method_compile_budget_ms_(0u),
+    compile_budget_ms_(0u) {
 }
 
 void CompilerOptions::ParseHugeMethodMax(const StringPiece& option, UsageFn Usage) {
@@ -133,6 +141,14 @@ void CompilerOptions::ParseInlineMaxCodeUnits(const StringPiece& option, UsageFn
   ParseUintOption(option, "--inline-max-code-units", &inline_max_code_units_, Usage);
 }
 
+void CompilerOptions::ParseMethodCompileBudget(const StringPiece& option, UsageFn Usage) {
+  ParseUintOption(option, "--method-compile-budget", &method_compile_budget_ms_, Usage);
+}
+
+void CompilerOptions::ParseCompileBudget(const StringPiece& option, UsageFn Usage) {
+  ParseUintOption(option, "--compile-budget", &compile_budget_ms_, Usage);
+}
+
 void CompilerOptions::ParseDumpInitFailures(const StringPiece& option,
                                             UsageFn Usage ATTRIBUTE_UNUSED) {
   DCHECK(option.starts_with("--dump-init-failures="));
@@ -158,6 +174,7 @@ void CompilerOptions::ParseRegisterAllocationStrategy(const StringPiece& option,
   } else {
     Usage("Unrecognized register allocation strategy. Try linear-scan, or graph-color.");
   }
+  profile_guided_register_allocation_ = false;
 }
 
 bool CompilerOptions::ParseCompilerOption(const StringPiece& option, UsageFn Usage) {
@@ -206,8 +223,14 @@ bool CompilerOptions::ParseCompilerOption(const StringPiece& option, UsageFn Usa
     dump_cfg_file_name_ = option.substr(strlen("--dump-cfg=")).data();
   } else if (option.starts_with("--dump-cfg-append")) {
     dump_cfg_append_ = true;
+  } else if (option.starts_with("--dump-pass-stats=")) {
+    pass_stats_file_name_ = option.substr(strlen("--dump-pass-stats=")).data();
   } else if (option.starts_with("--register-allocation-strategy=")) {
     ParseRegisterAllocationStrategy(option, Usage);
+  } else if (option.starts_with("--method-compile-budget=")) {
+    ParseMethodCompileBudget(option, Usage);
+  } else if (option.starts_with("--compile-budget=")) {
+    ParseCompileBudget(option, Usage);
   } else {
     // Option not recognized.
     return false;
@@ -242,6 +242,11 @@ class CompilerOptions FINAL {
     return dump_cfg_append_;
   }
 
+  // Where to write the PassStatistics of the compilation, empty if they are not collected.
+  const std::string& GetPassStatsFileName() const {
+    return pass_stats_file_name_;
+  }
+
   bool IsForceDeterminism() const {
     return force_determinism_;
   }
@@ -250,6 +255,24 @@ class CompilerOptions FINAL {
     return register_allocation_strategy_;
   }
 
+  // Wall time in milliseconds after which the optimizing compiler finishes a method with the
+  // baseline passes only, or 0 for no limit.
+  size_t GetMethodCompileBudgetMs() const {
+    return method_compile_budget_ms_;
+  }
+
+  // Wall time in milliseconds after which the compiler driver stops compiling methods and
+  // leaves the remaining ones to the interpreter and the JIT, or 0 for no limit.
+  size_t GetCompileBudgetMs() const {
+    return compile_budget_ms_;
+  }
+
+  // Whether the hot methods of the profile get the graph coloring register allocator,
+  // whatever the default strategy. Choosing a strategy on the command line disables it.
+  bool UseProfileGuidedRegisterAllocation() const {
+    return profile_guided_register_allocation_;
+  }
+
  private:
   void ParseDumpInitFailures(const StringPiece& option, UsageFn Usage);
   void ParseDumpCfgPasses(const StringPiece& option, UsageFn Usage);
@@ -261,6 +284,8 @@ class CompilerOptions FINAL {
   void ParseLargeMethodMax(const StringPiece& option, UsageFn Usage);
   void ParseHugeMethodMax(const StringPiece& option, UsageFn Usage);
   void ParseRegisterAllocationStrategy(const StringPiece& option, UsageFn Usage);
+  void ParseMethodCompileBudget(const StringPiece& option, UsageFn Usage);
+  void ParseCompileBudget(const StringPiece& option, UsageFn Usage);
 
   CompilerFilter::Filter compiler_filter_;
   size_t huge_method_threshold_;
@@ -300,11 +325,17 @@ class CompilerOptions FINAL {
   std::string dump_cfg_file_name_;
   bool dump_cfg_append_;
 
+  std::string pass_stats_file_name_;
+
   // Whether the compiler should trade performance for determinism to guarantee exactly reproducable
   // outcomes.
   bool force_determinism_;
 
   RegisterAllocator::Strategy register_allocation_strategy_;
+  bool profile_guided_register_allocation_;
+
+  size_t method_compile_budget_ms_;
+  size_t compile_budget_ms_;
 
   friend class Dex2Oat;
 
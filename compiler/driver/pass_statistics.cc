@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pass_statistics.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
+#include "os.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+
+PassStatistics::PassStatistics()
+    : lock_("pass statistics lock"), methods_(0), time_ns_(0) {}
+
+bool PassStatistics::IsSlowestLocked(uint64_t time_ns) const {
+  return slowest_methods_.size() < kNumSlowestMethods ||
+      time_ns > slowest_methods_.back().record.time_ns;
+}
+
+bool PassStatistics::IsSlowest(uint64_t time_ns) {
+  MutexLock mu(Thread::Current(), lock_);
+  return IsSlowestLocked(time_ns);
+}
+
+void PassStatistics::AddMethod(const MethodRecord& record, const std::string& method_name) {
+  MutexLock mu(Thread::Current(), lock_);
+  ++methods_;
+  time_ns_ += record.time_ns;
+  for (const Pass& pass : record.passes) {
+    PassTotals& totals = passes_[pass.name];
+    ++totals.runs;
+    totals.time_ns += pass.time_ns;
+    totals.max_time_ns = std::max(totals.max_time_ns, pass.time_ns);
+    if (pass.instruction_delta > 0) {
+      totals.instructions_added += pass.instruction_delta;
+    } else {
+      totals.instructions_removed += -pass.instruction_delta;
+    }
+  }
+  if (!IsSlowestLocked(record.time_ns)) {
+    return;
+  }
+  if (slowest_methods_.size() == kNumSlowestMethods) {
+    slowest_methods_.pop_back();
+  }
+  auto pos = std::upper_bound(slowest_methods_.begin(),
+                              slowest_methods_.end(),
+                              record.time_ns,
+                              [](uint64_t time_ns, const SlowMethod& method) {
+                                return time_ns > method.record.time_ns;
+                              });
+  SlowMethod slow_method;
+  slow_method.name = method_name;
+  slow_method.record = record;
+  slowest_methods_.insert(pos, std::move(slow_method));
+}
+
+void PassStatistics::DumpJson(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  std::vector<std::pair<std::string, PassTotals>> passes(passes_.begin(), passes_.end());
+  std::sort(passes.begin(),
+            passes.end(),
+            [](const std::pair<std::string, PassTotals>& a,
+               const std::pair<std::string, PassTotals>& b) {
+              return a.second.time_ns > b.second.time_ns;
+            });
+  std::string json;
+  StringAppendF(&json, "{\n\"methods\":%" PRIu64 ",\n\"time_ns\":%" PRIu64 ",\n\"passes\":[",
+                methods_, time_ns_);
+  for (size_t i = 0; i != passes.size(); ++i) {
+    const PassTotals& totals = passes[i].second;
+    json += (i != 0) ? ",\n{\"name\":" : "\n{\"name\":";
+    AppendJsonString(&json, passes[i].first.c_str());
+    StringAppendF(&json,
+                  ",\"runs\":%" PRIu64 ",\"time_ns\":%" PRIu64 ",\"max_time_ns\":%" PRIu64
+                  ",\"instructions_added\":%" PRIu64 ",\"instructions_removed\":%" PRIu64 "}",
+                  totals.runs,
+                  totals.time_ns,
+                  totals.max_time_ns,
+                  totals.instructions_added,
+                  totals.instructions_removed);
+  }
+  json += "\n],\n\"slowest_methods\":[";
+  for (size_t i = 0; i != slowest_methods_.size(); ++i) {
+    const SlowMethod& method = slowest_methods_[i];
+    json += (i != 0) ? ",\n{\"method\":" : "\n{\"method\":";
+    AppendJsonString(&json, method.name.c_str());
+    StringAppendF(&json,
+                  ",\"time_ns\":%" PRIu64 ",\"instructions\":%zu,\"passes\":[",
+                  method.record.time_ns,
+                  method.record.instructions);
+    for (size_t j = 0; j != method.record.passes.size(); ++j) {
+      const Pass& pass = method.record.passes[j];
+      json += (j != 0) ? ",{\"name\":" : "{\"name\":";
+      AppendJsonString(&json, pass.name);
+      StringAppendF(&json,
+                    ",\"time_ns\":%" PRIu64 ",\"instruction_delta\":%" PRId64 "}",
+                    pass.time_ns,
+                    pass.instruction_delta);
+    }
+    json += "]}";
+  }
+  json += "\n]\n}\n";
+  os << json;
+}
+
+bool PassStatistics::WriteJsonFile(const std::string& filename, std::string* error_msg) {
+  std::ostringstream oss;
+  DumpJson(oss);
+  const std::string json = oss.str();
+  std::unique_ptr<File> file(OS::CreateEmptyFile(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Failed to create pass statistics file " + filename;
+    return false;
+  }
+  if (!file->WriteFully(json.data(), json.size())) {
+    *error_msg = "Failed to write pass statistics file " + filename;
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = "Failed to flush and close pass statistics file " + filename;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace art
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_PASS_STATISTICS_H_
+#define ART_COMPILER_DRIVER_PASS_STATISTICS_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+// Cumulative time and instruction count changes of each compiler pass over a whole compilation,
+// and the slowest methods with their passes, written as JSON with --dump-pass-stats=<file>.
+// Unlike --dump-passes, which logs the passes of every method, the output is small enough to
+// be collected from every build.
+class PassStatistics {
+ public:
+  static constexpr size_t kNumSlowestMethods = 50;
+
+  struct Pass {
+    // The pass names are the static names of the optimizations, they outlive the record.
+    const char* name;
+    uint64_t time_ns;
+    // Instructions and phis after the pass minus before.
+    int64_t instruction_delta;
+  };
+
+  // The passes of one method compilation, in order.
+  struct MethodRecord {
+    MethodRecord() : time_ns(0), instructions(0) {}
+
+    uint64_t time_ns;
+    // Instructions and phis at the end of the compilation.
+    size_t instructions;
+    std::vector<Pass> passes;
+  };
+
+  PassStatistics();
+
+  // Whether a method compiled in time_ns would be one of the slowest, so that the callers only
+  // compute the names of those.
+  bool IsSlowest(uint64_t time_ns) REQUIRES(!lock_);
+
+  // Add a method compilation. The method name is only used if IsSlowest(record.time_ns).
+  void AddMethod(const MethodRecord& record, const std::string& method_name) REQUIRES(!lock_);
+
+  void DumpJson(std::ostream& os) REQUIRES(!lock_);
+  bool WriteJsonFile(const std::string& filename, std::string* error_msg) REQUIRES(!lock_);
+
+ private:
+  struct PassTotals {
+    PassTotals() : runs(0), time_ns(0), max_time_ns(0), instructions_added(0),
+                   instructions_removed(0) {}
+
+    uint64_t runs;
+    uint64_t time_ns;
+    uint64_t max_time_ns;
+    uint64_t instructions_added;
+    uint64_t instructions_removed;
+  };
+
+  struct SlowMethod {
+    std::string name;
+    MethodRecord record;
+  };
+
+  bool IsSlowestLocked(uint64_t time_ns) const REQUIRES(lock_);
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  uint64_t methods_ GUARDED_BY(lock_);
+  uint64_t time_ns_ GUARDED_BY(lock_);
+  std::map<std::string, PassTotals> passes_ GUARDED_BY(lock_);
+  // Sorted by decreasing compile time.
+  std::vector<SlowMethod> slowest_methods_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(PassStatistics);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_PASS_STATISTICS_H_
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/pass_statistics.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+
+namespace art {
+
+class PassStatisticsTest : public CommonRuntimeTest {};
+
+static PassStatistics::MethodRecord MakeRecord(uint64_t time_ns) {
+  PassStatistics::MethodRecord record;
+  record.time_ns = time_ns;
+  record.instructions = 10;
+  record.passes.push_back({"dead_code_elimination", time_ns / 4, -3});
+  record.passes.push_back({"inliner", time_ns / 2, 5});
+  return record;
+}
+
+TEST_F(PassStatisticsTest, Totals) {
+  PassStatistics stats;
+  stats.AddMethod(MakeRecord(400), "void A.a()");
+  stats.AddMethod(MakeRecord(800), "void B.b()");
+  std::ostringstream oss;
+  stats.DumpJson(oss);
+  const std::string json = oss.str();
+  EXPECT_NE(json.find("\"methods\":2,"), std::string::npos) << json;
+  EXPECT_NE(json.find("\"time_ns\":1200,"), std::string::npos) << json;
+  EXPECT_NE(json.find("{\"name\":\"inliner\",\"runs\":2,\"time_ns\":600,\"max_time_ns\":400,"
+                      "\"instructions_added\":10,\"instructions_removed\":0}"),
+            std::string::npos) << json;
+  EXPECT_NE(json.find("{\"name\":\"dead_code_elimination\",\"runs\":2,\"time_ns\":300,"
+                      "\"max_time_ns\":200,\"instructions_added\":0,\"instructions_removed\":6}"),
+            std::string::npos) << json;
+  // The passes are sorted by decreasing time, and so are the methods.
+  EXPECT_LT(json.find("\"inliner\",\"runs\""), json.find("\"dead_code_elimination\",\"runs\""));
+  EXPECT_LT(json.find("void B.b()"), json.find("void A.a()"));
+  EXPECT_NE(json.find("{\"method\":\"void B.b()\",\"time_ns\":800,\"instructions\":10,"
+                      "\"passes\":[{\"name\":\"dead_code_elimination\",\"time_ns\":200,"
+                      "\"instruction_delta\":-3},{\"name\":\"inliner\",\"time_ns\":400,"
+                      "\"instruction_delta\":5}]}"),
+            std::string::npos) << json;
+}
+
+TEST_F(PassStatisticsTest, KeepsSlowestMethods) {
+  PassStatistics stats;
+  for (size_t i = 0; i != PassStatistics::kNumSlowestMethods; ++i) {
+    EXPECT_TRUE(stats.IsSlowest(1000 + i));
+    stats.AddMethod(MakeRecord(1000 + i), "void Slow.m" + std::to_string(i) + "()");
+  }
+  EXPECT_FALSE(stats.IsSlowest(1000));
+  EXPECT_TRUE(stats.IsSlowest(1001));
+  stats.AddMethod(MakeRecord(10), "void Fast.m()");
+  stats.AddMethod(MakeRecord(5000), "void Slowest.m()");
+  std::ostringstream oss;
+  stats.DumpJson(oss);
+  const std::string json = oss.str();
+  EXPECT_NE(json.find("\"methods\":52,"), std::string::npos) << json;
+  EXPECT_EQ(json.find("void Fast.m()"), std::string::npos) << json;
+  // The fastest of the slow methods made room for the slowest one.
+  EXPECT_EQ(json.find("\"void Slow.m0()\""), std::string::npos) << json;
+  EXPECT_NE(json.find("\"void Slow.m1()\""), std::string::npos) << json;
+  EXPECT_LT(json.find("void Slowest.m()"), json.find("void Slow.m49()"));
+}
+
+TEST_F(PassStatisticsTest, WriteJsonFile) {
+  PassStatistics stats;
+  stats.AddMethod(MakeRecord(100), "void \"Quoted\".m()");
+  ScratchFile file;
+  std::string error_msg;
+  ASSERT_TRUE(stats.WriteJsonFile(file.GetFilename(), &error_msg)) << error_msg;
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &contents));
+  std::ostringstream oss;
+  stats.DumpJson(oss);
+  EXPECT_EQ(oss.str(), contents);
+  EXPECT_NE(contents.find("\"void \\\"Quoted\\\".m()\""), std::string::npos) << contents;
+}
+
+}  // namespace art
@@ -54,12 +54,14 @@ class DebugInfoTask : public Task {
                 const InstructionSetFeatures* features,
                 size_t rodata_section_size,
                 size_t text_section_size,
-                const ArrayRef<const debug::MethodDebugInfo>& method_infos)
+                const ArrayRef<const debug::MethodDebugInfo>& method_infos,
+                size_t thread_count)
       : isa_(isa),
         instruction_set_features_(features),
         rodata_section_size_(rodata_section_size),
         text_section_size_(text_section_size),
-        method_infos_(method_infos) {
+        method_infos_(method_infos),
+        thread_count_(thread_count) {
   }
 
   void Run(Thread*) {
@@ -67,7 +69,8 @@ class DebugInfoTask : public Task {
                                        instruction_set_features_,
                                        rodata_section_size_,
                                        text_section_size_,
-                                       method_infos_);
+                                       method_infos_,
+                                       thread_count_);
   }
 
   std::vector<uint8_t>* GetResult() {
@@ -80,6 +83,7 @@ class DebugInfoTask : public Task {
   size_t rodata_section_size_;
   size_t text_section_size_;
   const ArrayRef<const debug::MethodDebugInfo>& method_infos_;
+  size_t thread_count_;
   std::vector<uint8_t> result_;
 };
 
@@ -94,7 +98,8 @@ class ElfWriterQuick FINAL : public ElfWriter {
 
   void Start() OVERRIDE;
   void SetLoadedSectionSizes(size_t rodata_size, size_t text_size, size_t bss_size) OVERRIDE;
-  void PrepareDebugInfo(const ArrayRef<const debug::MethodDebugInfo>& method_infos) OVERRIDE;
+  void PrepareDebugInfo(const ArrayRef<const debug::MethodDebugInfo>& method_infos,
+                        size_t thread_count) OVERRIDE;
   OutputStream* StartRoData() OVERRIDE;
   void EndRoData(OutputStream* rodata) OVERRIDE;
   OutputStream* StartText() OVERRIDE;
@@ -218,7 +223,7 @@ void ElfWriterQuick<ElfTypes>::WriteDynamicSection() {
 
 template <typename ElfTypes>
 void ElfWriterQuick<ElfTypes>::PrepareDebugInfo(
-    const ArrayRef<const debug::MethodDebugInfo>& method_infos) {
+    const ArrayRef<const debug::MethodDebugInfo>& method_infos, size_t thread_count) {
   if (!method_infos.empty() && compiler_options_->GetGenerateMiniDebugInfo()) {
     // Prepare the mini-debug-info in background while we do other I/O.
     Thread* self = Thread::Current();
@@ -227,7 +232,8 @@ void ElfWriterQuick<ElfTypes>::PrepareDebugInfo(
                           instruction_set_features_,
                           rodata_size_,
                           text_size_,
-                          method_infos));
+                          method_infos,
+                          thread_count));
     debug_info_thread_pool_ = std::unique_ptr<ThreadPool>(
         new ThreadPool("Mini-debug-info writer", 1));
     debug_info_thread_pool_->AddTask(self, debug_info_task_.get());
@@ -108,7 +108,9 @@ void ImageTest::TestWriteRead(ImageHeader::StorageMode storage_mode) {
           &compiler_driver_->GetCompilerOptions(),
           oat_file.GetFile());
       elf_writer->Start();
-      OatWriter oat_writer(/*compiling_boot_image*/true, &timings);
+      OatWriter oat_writer(/*compiling_boot_image*/true,
+                           &timings,
+                           /*profile_compilation_info*/nullptr);
       OutputStream* rodata = elf_writer->StartRoData();
       for (const DexFile* dex_file : dex_files) {
         ArrayRef<const uint8_t> raw_dex_file(
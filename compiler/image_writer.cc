@@ -20,6 +20,7 @@
 #include <lz4.h>
 #include <lz4hc.h>
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_set>
@@ -62,6 +63,7 @@
 #include "oat_file_manager.h"
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
+#include "thread_pool.h"
 #include "handle_scope-inl.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 
@@ -183,10 +185,17 @@ bool ImageWriter::Write(int image_fd,
   }
 
   {
+    // The worker threads attach to the runtime, so create the pool before taking the mutator
+    // lock. The calling thread also copies objects while it waits for the workers.
+    std::unique_ptr<ThreadPool> thread_pool;
+    if (compiler_driver_.GetThreadCount() > 1u) {
+      thread_pool.reset(new ThreadPool("Image writer thread pool",
+                                       compiler_driver_.GetThreadCount() - 1u));
+    }
     // TODO: heap validation can't handle these fix up passes.
     ScopedObjectAccess soa(Thread::Current());
     Runtime::Current()->GetHeap()->DisableObjectValidation();
-    CopyAndFixupObjects();
+    CopyAndFixupObjects(thread_pool.get());
   }
 
   for (size_t i = 0; i < image_filenames.size(); ++i) {
@@ -232,13 +241,24 @@ bool ImageWriter::Write(int image_fd,
     switch (image_storage_mode_) {
       case ImageHeader::kStorageModeLZ4HC:  // Fall-through.
       case ImageHeader::kStorageModeLZ4: {
-        const size_t compressed_max_size = LZ4_compressBound(image_data_size);
+        // Compress the blocks one after the other, after their end offsets.
+        const size_t num_blocks = image_header->GetNumCompressedBlocks();
+        const size_t compressed_max_size = num_blocks * sizeof(uint32_t) +
+            num_blocks * LZ4_compressBound(ImageHeader::kCompressedBlockSize);
         compressed_data.reset(new char[compressed_max_size]);
-        data_size = LZ4_compress(
-            reinterpret_cast<char*>(image_info.image_->Begin()) + sizeof(ImageHeader),
-            &compressed_data[0],
-            image_data_size);
-
+        uint32_t* block_ends = reinterpret_cast<uint32_t*>(&compressed_data[0]);
+        data_size = num_blocks * sizeof(uint32_t);
+        for (size_t i = 0; i != num_blocks; ++i) {
+          const size_t block_begin = image_header->CompressedBlockBegin(i);
+          const size_t block_size = image_header->CompressedBlockEnd(i) - block_begin;
+          const int compressed_size = LZ4_compress(
+              reinterpret_cast<char*>(image_info.image_->Begin()) + block_begin,
+              &compressed_data[data_size],
+              block_size);
+          CHECK_GT(compressed_size, 0) << "Failed to compress image block " << i;
+          data_size += compressed_size;
+          block_ends[i] = dchecked_integral_cast<uint32_t>(data_size);
+        }
         break;
       }
       /*
@@ -271,12 +291,21 @@ bool ImageWriter::Write(int image_fd,
                      << PrettyDuration(NanoTime() - compress_start_time);
       if (kIsDebugBuild) {
         std::unique_ptr<uint8_t[]> temp(new uint8_t[image_data_size]);
-        const size_t decompressed_size = LZ4_decompress_safe(
-            reinterpret_cast<char*>(&compressed_data[0]),
-            reinterpret_cast<char*>(&temp[0]),
-            data_size,
-            image_data_size);
-        CHECK_EQ(decompressed_size, image_data_size);
+        const uint32_t* block_ends = reinterpret_cast<const uint32_t*>(&compressed_data[0]);
+        const size_t num_blocks = image_header->GetNumCompressedBlocks();
+        size_t compressed_begin = num_blocks * sizeof(uint32_t);
+        for (size_t i = 0; i != num_blocks; ++i) {
+          const size_t block_begin = image_header->CompressedBlockBegin(i);
+          const size_t block_size = image_header->CompressedBlockEnd(i) - block_begin;
+          const int decompressed_size = LZ4_decompress_safe(
+              &compressed_data[compressed_begin],
+              reinterpret_cast<char*>(&temp[block_begin - sizeof(ImageHeader)]),
+              block_ends[i] - compressed_begin,
+              block_size);
+          CHECK_EQ(static_cast<size_t>(decompressed_size), block_size) << "Block " << i;
+          compressed_begin = block_ends[i];
+        }
+        CHECK_EQ(compressed_begin, data_size);
         CHECK_EQ(memcmp(image_data, &temp[0], image_data_size), 0) << image_storage_mode_;
       }
     }
@@ -901,11 +930,15 @@ void ImageWriter::PruneNonImageClasses() {
             << PrettyClass(declaring_class) << " not in class linker table";
       }
     }
-    ArtField** resolved_fields = dex_cache->GetResolvedFields();
+    mirror::FieldDexCachePair* resolved_fields = dex_cache->GetResolvedFields();
     for (size_t i = 0; i < dex_cache->NumResolvedFields(); i++) {
-      ArtField* field = mirror::DexCache::GetElementPtrSize(resolved_fields, i, target_ptr_size_);
-      if (field != nullptr && !KeepClass(field->GetDeclaringClass())) {
-        dex_cache->SetResolvedField(i, nullptr, target_ptr_size_);
+      mirror::FieldDexCachePair pair =
+          mirror::DexCache::GetFieldPairPtrSize(resolved_fields, i, target_ptr_size_);
+      if (pair.field != nullptr && !KeepClass(pair.field->GetDeclaringClass())) {
+        mirror::DexCache::SetFieldPairPtrSize(resolved_fields,
+                                              i,
+                                              mirror::FieldDexCachePair(),
+                                              target_ptr_size_);
       }
     }
     // Clean the dex field. It might have been populated during the initialization phase, but
@@ -1422,6 +1455,10 @@ void ImageWriter::CalculateNewObjectOffsets() {
           bin_offset = RoundUp(bin_offset, static_cast<size_t>(target_ptr_size_));
           break;
         }
+        case kBinDexCacheArray: {
+          bin_offset = RoundUp(bin_offset, DexCacheArraysLayout::Alignment(target_ptr_size_));
+          break;
+        }
         default: {
           // Normal alignment.
         }
@@ -1751,9 +1788,55 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
   }
 }
 
-void ImageWriter::CopyAndFixupObjects() {
-  gc::Heap* heap = Runtime::Current()->GetHeap();
-  heap->VisitObjects(CopyAndFixupObjectsCallback, this);
+class ImageWriter::CopyAndFixupObjectsTask FINAL : public Task {
+ public:
+  CopyAndFixupObjectsTask(ImageWriter* image_writer,
+                          mirror::Object* const* begin,
+                          mirror::Object* const* end)
+      : image_writer_(image_writer), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    for (mirror::Object* const* it = begin_; it != end_; ++it) {
+      image_writer_->CopyAndFixupObject(*it);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ImageWriter* const image_writer_;
+  mirror::Object* const* const begin_;
+  mirror::Object* const* const end_;
+};
+
+void ImageWriter::CopyAndFixupObjects(ThreadPool* thread_pool) {
+  // Collect the objects first. Visiting the heap is cheap compared to copying and fixing up
+  // the objects, which we can then split between threads.
+  std::vector<mirror::Object*> objects;
+  Runtime::Current()->GetHeap()->VisitObjects(CollectImageObjectsCallback, &objects);
+  if (thread_pool == nullptr) {
+    for (mirror::Object* obj : objects) {
+      CopyAndFixupObject(obj);
+    }
+  } else {
+    // Use more tasks than threads to balance the load; object sizes vary a lot.
+    static constexpr size_t kTasksPerThread = 8u;
+    Thread* self = Thread::Current();
+    size_t num_tasks = (thread_pool->GetThreadCount() + 1u) * kTasksPerThread;
+    size_t objects_per_task = RoundUp(objects.size(), num_tasks) / num_tasks;
+    for (size_t begin = 0; begin < objects.size(); begin += objects_per_task) {
+      size_t end = std::min(begin + objects_per_task, objects.size());
+      thread_pool->AddTask(
+          self, new CopyAndFixupObjectsTask(this, objects.data() + begin, objects.data() + end));
+    }
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+    thread_pool->StopWorkers(self);
+  }
+  pointer_arrays_.clear();
   // Fix up the object previously had hash codes.
   for (const auto& hash_pair : saved_hashcode_map_) {
     Object* obj = hash_pair.first;
@@ -1763,10 +1846,10 @@ void ImageWriter::CopyAndFixupObjects() {
   saved_hashcode_map_.clear();
 }
 
-void ImageWriter::CopyAndFixupObjectsCallback(Object* obj, void* arg) {
+void ImageWriter::CollectImageObjectsCallback(Object* obj, void* arg) {
   DCHECK(obj != nullptr);
   DCHECK(arg != nullptr);
-  reinterpret_cast<ImageWriter*>(arg)->CopyAndFixupObject(obj);
+  reinterpret_cast<std::vector<mirror::Object*>*>(arg)->push_back(obj);
 }
 
 void ImageWriter::FixupPointerArray(mirror::Object* dst, mirror::PointerArray* arr,
@@ -1815,7 +1898,8 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_info.image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_info.image_bitmap_->Set(dst);  // Mark the obj as live.
+  // Mark the obj as live. Other threads may be marking objects in the same bitmap word.
+  image_info.image_bitmap_->AtomicTestAndSet(dst);
 
   const size_t n = obj->SizeOf();
   DCHECK_LE(offset + n, image_info.image_->Size());
@@ -1973,9 +2057,9 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native pointer array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Each object is fixed up exactly once. Do not erase the entry, the map is shared
+      // by the threads copying objects.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), klass, it->second);
-      pointer_arrays_.erase(it);
       return;
     }
   }
@@ -2062,16 +2146,17 @@ void ImageWriter::FixupDexCache(mirror::DexCache* orig_dex_cache,
       mirror::DexCache::SetElementPtrSize(copy_methods, i, copy, target_ptr_size_);
     }
   }
-  ArtField** orig_fields = orig_dex_cache->GetResolvedFields();
+  mirror::FieldDexCachePair* orig_fields = orig_dex_cache->GetResolvedFields();
   if (orig_fields != nullptr) {
     copy_dex_cache->SetFieldPtrWithSize<false>(mirror::DexCache::ResolvedFieldsOffset(),
                                                NativeLocationInImage(orig_fields),
                                                PointerSize::k64);
-    ArtField** copy_fields = NativeCopyLocation(orig_fields, orig_dex_cache);
+    mirror::FieldDexCachePair* copy_fields = NativeCopyLocation(orig_fields, orig_dex_cache);
     for (size_t i = 0, num = orig_dex_cache->NumResolvedFields(); i != num; ++i) {
-      ArtField* orig = mirror::DexCache::GetElementPtrSize(orig_fields, i, target_ptr_size_);
-      ArtField* copy = NativeLocationInImage(orig);
-      mirror::DexCache::SetElementPtrSize(copy_fields, i, copy, target_ptr_size_);
+      mirror::FieldDexCachePair orig =
+          mirror::DexCache::GetFieldPairPtrSize(orig_fields, i, target_ptr_size_);
+      mirror::FieldDexCachePair copy(NativeLocationInImage(orig.field), orig.index);
+      mirror::DexCache::SetFieldPairPtrSize(copy_fields, i, copy, target_ptr_size_);
     }
   }
 
@@ -398,8 +398,10 @@ class ImageWriter FINAL {
 
   // Creates the contiguous image in memory and adjusts pointers.
   void CopyAndFixupNativeData(size_t oat_index) SHARED_REQUIRES(Locks::mutator_lock_);
-  void CopyAndFixupObjects() SHARED_REQUIRES(Locks::mutator_lock_);
-  static void CopyAndFixupObjectsCallback(mirror::Object* obj, void* arg)
+  // Copy and fix up the objects using `thread_pool` if not null. The objects are copied to
+  // disjoint locations in the images, so this parallelizes without synchronization.
+  void CopyAndFixupObjects(ThreadPool* thread_pool) SHARED_REQUIRES(Locks::mutator_lock_);
+  static void CollectImageObjectsCallback(mirror::Object* obj, void* arg)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void CopyAndFixupObject(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_);
   void CopyAndFixupMethod(ArtMethod* orig, ArtMethod* copy, const ImageInfo& image_info)
@@ -569,6 +571,8 @@ class ImageWriter FINAL {
   // Map of dex files to the indexes of oat files that they were compiled into.
   const std::unordered_map<const DexFile*, size_t>& dex_file_oat_index_map_;
 
+  class CopyAndFixupObjectsTask;
+
   friend class ContainsBootClassLoaderNonImageClassVisitor;
   friend class FixupClassVisitor;
   friend class FixupRootVisitor;
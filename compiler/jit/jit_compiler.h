@@ -28,6 +28,10 @@ namespace art {
 class ArtMethod;
 class InstructionSetFeatures;
 
+namespace debug {
+class ElfJITDebugInfoWriter;
+}  // namespace debug
+
 namespace jit {
 
 class JitCompiler {
@@ -36,7 +40,7 @@ class JitCompiler {
   virtual ~JitCompiler();
 
   // Compilation entrypoint. Returns whether the compilation succeeded.
-  bool CompileMethod(Thread* self, ArtMethod* method, bool osr)
+  bool CompileMethod(Thread* self, ArtMethod* method, bool osr, bool baseline)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   CompilerOptions* GetCompilerOptions() const {
@@ -52,7 +56,8 @@ class JitCompiler {
   std::unique_ptr<DexFileToMethodInlinerMap> method_inliner_map_;
   std::unique_ptr<CompilerDriver> compiler_driver_;
   std::unique_ptr<const InstructionSetFeatures> instruction_set_features_;
-  std::unique_ptr<File> perf_file_;
+  // Writes the debug info of the compiled methods for native debuggers, when it is generated.
+  std::unique_ptr<debug::ElfJITDebugInfoWriter> debug_info_writer_;
 
   JitCompiler();
 
@@ -168,7 +168,11 @@ bool ArmBaseRelativePatcher::ReserveSpaceProcessPatches(uint32_t quick_code_offs
             target_offset = std::max(target_offset, thunk_locations_.back());
           }
           if (patch_offset - target_offset > max_negative_displacement_) {
-            return true;
+            // Like for unresolved targets, we need a thunk only once the next aligned offset
+            // is out of range, or at the end of all code. Placing the thunk as late as
+            // possible lets it serve more of the calls that follow.
+            return (next_aligned_offset - patch_offset > max_positive_displacement_) ||
+                (quick_code_offset == next_aligned_offset);  // End of code.
           }
         }
       }
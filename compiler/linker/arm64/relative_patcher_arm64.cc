@@ -130,8 +130,12 @@ uint32_t Arm64RelativePatcher::WriteThunks(OutputStream* out, uint32_t offset) {
       if (aligned_code_delta != 0u && !WriteCodeAlignment(out, aligned_code_delta)) {
         return 0u;
       }
-      if (!WriteMiscThunk(out, ArrayRef<const uint8_t>(current_method_thunks_))) {
-        return 0u;
+      // Write the thunks one by one so that they are counted individually.
+      ArrayRef<const uint8_t> thunks(current_method_thunks_);
+      for (size_t i = 0u; i != thunks.size(); i += kAdrpThunkSize) {
+        if (!WriteMiscThunk(out, thunks.SubArray(i, kAdrpThunkSize))) {
+          return 0u;
+        }
       }
       offset = aligned_offset + current_method_thunks_.size();
       current_method_thunks_.clear();
@@ -297,6 +297,7 @@ class Arm64RelativePatcherTest : public RelativePatcherTest {
     auto expected_code = GenNopsAndAdrpAndUse(num_nops, method1_offset, target_offset, use_insn);
     InsertInsn(&expected_code, num_nops * 4u + 4u, insn2);
     EXPECT_TRUE(CheckLinkedMethod(MethodRef(1u), ArrayRef<const uint8_t>(expected_code)));
+    EXPECT_EQ(0u, patcher_->MiscThunksCount());
   }
 
   void TestNopsAdrpInsn2AndUseHasThunk(size_t num_nops,
@@ -337,6 +338,7 @@ class Arm64RelativePatcherTest : public RelativePatcherTest {
       DumpDiff(ArrayRef<const uint8_t>(expected_thunk_code), thunk_code);
       FAIL();
     }
+    EXPECT_EQ(1u, patcher_->MiscThunksCount());
   }
 
   void TestAdrpInsn2Ldr(uint32_t insn2,
@@ -495,6 +497,7 @@ TEST_F(Arm64RelativePatcherTestDefault, CallOther) {
   ASSERT_GE(diff_before, -1u << 27);
   auto method2_expected_code = GenNopsAndBl(0u, kBlPlus0 | ((diff_before >> 2) & 0x03ffffffu));
   EXPECT_TRUE(CheckLinkedMethod(MethodRef(2u), ArrayRef<const uint8_t>(method2_expected_code)));
+  EXPECT_EQ(0u, patcher_->RelativeCallThunksCount());
 }
 
 TEST_F(Arm64RelativePatcherTestDefault, CallTrampoline) {
@@ -630,6 +633,7 @@ TEST_F(Arm64RelativePatcherTestDefault, CallOtherJustTooFarAfter) {
   auto expected_code = GenNopsAndBl(0u, kBlPlus0 | (diff >> 2));
   EXPECT_TRUE(CheckLinkedMethod(MethodRef(1u), ArrayRef<const uint8_t>(expected_code)));
   CheckThunk(thunk_offset);
+  EXPECT_EQ(1u, patcher_->RelativeCallThunksCount());
 }
 
 TEST_F(Arm64RelativePatcherTestDefault, CallOtherJustTooFarBefore) {
@@ -661,6 +665,7 @@ TEST_F(Arm64RelativePatcherTestDefault, CallOtherJustTooFarBefore) {
   EXPECT_TRUE(CheckLinkedMethod(MethodRef(last_method_idx),
                                 ArrayRef<const uint8_t>(expected_code)));
   EXPECT_TRUE(CheckThunk(thunk_offset));
+  EXPECT_EQ(1u, patcher_->RelativeCallThunksCount());
 }
 
 TEST_F(Arm64RelativePatcherTestDefault, DexCacheReference1) {
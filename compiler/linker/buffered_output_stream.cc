@@ -61,6 +61,16 @@ bool BufferedOutputStream::FlushBuffer() {
 }
 
 off_t BufferedOutputStream::Seek(off_t offset, Whence whence) {
+  if (offset == 0 && whence == kSeekCurrent) {
+    // Querying the current position is frequent (OatWriter checks the offset of every
+    // method in debug builds, ElfBuilder records section bounds) and does not need the
+    // buffered data to hit the file.
+    off_t underlying_offset = out_->Seek(0, kSeekCurrent);
+    if (underlying_offset == static_cast<off_t>(-1)) {
+      return underlying_offset;
+    }
+    return underlying_offset + static_cast<off_t>(used_);
+  }
   if (!FlushBuffer()) {
     return -1;
   }
@@ -38,7 +38,8 @@ class BufferedOutputStream FINAL : public OutputStream {
   bool Flush() OVERRIDE;
 
  private:
-  static const size_t kBufferSize = 8 * KB;
+  // Large enough to group the writes of many small methods into a single write(2).
+  static const size_t kBufferSize = 64 * KB;
 
   bool FlushBuffer();
 
@@ -32,7 +32,9 @@ MultiOatRelativePatcher::MultiOatRelativePatcher(InstructionSet instruction_set,
       instruction_set_(instruction_set),
       start_size_code_alignment_(0u),
       start_size_relative_call_thunks_(0u),
-      start_size_misc_thunks_(0u) {
+      start_size_misc_thunks_(0u),
+      start_num_relative_call_thunks_(0u),
+      start_num_misc_thunks_(0u) {
 }
 
 void MultiOatRelativePatcher::StartOatFile(uint32_t adjustment) {
@@ -42,6 +44,8 @@ void MultiOatRelativePatcher::StartOatFile(uint32_t adjustment) {
   start_size_code_alignment_ = relative_patcher_->CodeAlignmentSize();
   start_size_relative_call_thunks_ = relative_patcher_->RelativeCallThunksSize();
   start_size_misc_thunks_ = relative_patcher_->MiscThunksSize();
+  start_num_relative_call_thunks_ = relative_patcher_->RelativeCallThunksCount();
+  start_num_misc_thunks_ = relative_patcher_->MiscThunksCount();
 }
 
 uint32_t MultiOatRelativePatcher::CodeAlignmentSize() const {
@@ -59,6 +63,16 @@ uint32_t MultiOatRelativePatcher::MiscThunksSize() const {
   return relative_patcher_->MiscThunksSize() - start_size_misc_thunks_;
 }
 
+uint32_t MultiOatRelativePatcher::RelativeCallThunksCount() const {
+  DCHECK_GE(relative_patcher_->RelativeCallThunksCount(), start_num_relative_call_thunks_);
+  return relative_patcher_->RelativeCallThunksCount() - start_num_relative_call_thunks_;
+}
+
+uint32_t MultiOatRelativePatcher::MiscThunksCount() const {
+  DCHECK_GE(relative_patcher_->MiscThunksCount(), start_num_misc_thunks_);
+  return relative_patcher_->MiscThunksCount() - start_num_misc_thunks_;
+}
+
 std::pair<bool, uint32_t> MultiOatRelativePatcher::MethodOffsetMap::FindMethodOffset(
     MethodReference ref) {
   auto it = map.find(ref);
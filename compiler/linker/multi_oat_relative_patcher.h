@@ -116,6 +116,8 @@ class MultiOatRelativePatcher FINAL {
   uint32_t CodeAlignmentSize() const;
   uint32_t RelativeCallThunksSize() const;
   uint32_t MiscThunksSize() const;
+  uint32_t RelativeCallThunksCount() const;
+  uint32_t MiscThunksCount() const;
 
  private:
   // Map method reference to assigned offset.
@@ -134,6 +136,8 @@ class MultiOatRelativePatcher FINAL {
   uint32_t start_size_code_alignment_;
   uint32_t start_size_relative_call_thunks_;
   uint32_t start_size_misc_thunks_;
+  uint32_t start_num_relative_call_thunks_;
+  uint32_t start_num_misc_thunks_;
 
   friend class MultiOatRelativePatcherTest;
 
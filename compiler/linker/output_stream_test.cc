@@ -134,4 +134,25 @@ TEST_F(OutputStreamTest, BufferedFlush) {
   ASSERT_TRUE(checking_output_stream->flush_called);
 }
 
+TEST_F(OutputStreamTest, BufferedSeekCurrent) {
+  std::vector<uint8_t> output;
+  {
+    BufferedOutputStream buffered(MakeUnique<VectorOutputStream>("test vector output", &output));
+    uint8_t buf[] = { 1, 2, 3, 4 };
+    EXPECT_TRUE(buffered.WriteFully(buf, sizeof(buf)));
+    // Querying the position accounts for the buffered data without flushing it.
+    EXPECT_EQ(4, buffered.Seek(0, kSeekCurrent));
+    EXPECT_TRUE(output.empty());
+    EXPECT_TRUE(buffered.WriteFully(buf, 2));
+    EXPECT_EQ(6, buffered.Seek(0, kSeekCurrent));
+    EXPECT_EQ(2, buffered.Seek(2, kSeekSet));
+    EXPECT_EQ(6u, output.size());
+    EXPECT_TRUE(buffered.WriteFully(buf, 1));
+    EXPECT_EQ(3, buffered.Seek(0, kSeekCurrent));
+  }
+  uint8_t expected[] = { 1, 2, 1, 4, 1, 2 };
+  ASSERT_EQ(sizeof(expected), output.size());
+  EXPECT_EQ(0, memcmp(expected, &output[0], output.size()));
+}
+
 }  // namespace art
@@ -125,6 +125,7 @@ bool RelativePatcher::WriteRelCallThunk(OutputStream* out, const ArrayRef<const
     return false;
   }
   size_relative_call_thunks_ += thunk.size();
+  num_relative_call_thunks_ += 1u;
   return true;
 }
 
@@ -133,6 +134,7 @@ bool RelativePatcher::WriteMiscThunk(OutputStream* out, const ArrayRef<const uin
     return false;
   }
   size_misc_thunks_ += thunk.size();
+  num_misc_thunks_ += 1u;
   return true;
 }
 
@@ -82,6 +82,14 @@ class RelativePatcher {
     return size_misc_thunks_;
   }
 
+  uint32_t RelativeCallThunksCount() const {
+    return num_relative_call_thunks_;
+  }
+
+  uint32_t MiscThunksCount() const {
+    return num_misc_thunks_;
+  }
+
   // Reserve space for thunks if needed before a method, return adjusted offset.
   virtual uint32_t ReserveSpace(uint32_t offset,
                                 const CompiledMethod* compiled_method,
@@ -113,7 +121,9 @@ class RelativePatcher {
   RelativePatcher()
       : size_code_alignment_(0u),
         size_relative_call_thunks_(0u),
-        size_misc_thunks_(0u) {
+        size_misc_thunks_(0u),
+        num_relative_call_thunks_(0u),
+        num_misc_thunks_(0u) {
   }
 
   bool WriteCodeAlignment(OutputStream* out, uint32_t aligned_code_delta);
@@ -124,6 +134,8 @@ class RelativePatcher {
   uint32_t size_code_alignment_;
   uint32_t size_relative_call_thunks_;
   uint32_t size_misc_thunks_;
+  uint32_t num_relative_call_thunks_;
+  uint32_t num_misc_thunks_;
 
   DISALLOW_COPY_AND_ASSIGN(RelativePatcher);
 };
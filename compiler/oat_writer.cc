@@ -31,6 +31,7 @@
 #include "compiled_class.h"
 #include "compiled_method.h"
 #include "debug/method_debug_info.h"
+#include "dex/dex_layout_optimizer.h"
 #include "dex/verification_results.h"
 #include "dex_file-inl.h"
 #include "driver/compiler_driver.h"
@@ -242,6 +243,10 @@ class OatWriter::OatDexFile {
   // Dex file size. Initialized when writing the dex file.
   size_t dex_file_size_;
 
+  // Number of type ids, for the size of the type lookup table. Initialized when writing the
+  // dex file.
+  uint32_t num_type_ids_;
+
   // Offset of start of OatDexFile from beginning of OatHeader. It is
   // used to validate file position when writing.
   size_t offset_;
@@ -273,9 +278,12 @@ class OatWriter::OatDexFile {
   DCHECK_EQ(static_cast<off_t>(file_offset + offset_), out->Seek(0, kSeekCurrent)) \
     << "file_offset=" << file_offset << " offset_=" << offset_
 
-OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
+OatWriter::OatWriter(bool compiling_boot_image,
+                     TimingLogger* timings,
+                     const ProfileCompilationInfo* profile_compilation_info)
   : write_state_(WriteState::kAddingDexFileSources),
     timings_(timings),
+    profile_compilation_info_(profile_compilation_info),
     raw_dex_files_(),
     zip_archives_(),
     zipped_dex_files_(),
@@ -321,6 +329,8 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
     size_oat_class_status_(0),
     size_oat_class_method_bitmaps_(0),
     size_oat_class_method_offsets_(0),
+    num_relative_call_thunks_(0),
+    num_misc_thunks_(0),
     relative_patcher_(nullptr),
     absolute_patch_locations_() {
 }
@@ -581,10 +591,25 @@ class OatWriter::DexMethodVisitor {
 
 class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
  public:
+  // The code visitors can be run in separate passes over the profiled methods and
+  // the other methods, see VisitDexMethodsInCodeOrder().
+  enum class CodePass {
+    kAllMethods,
+    kProfiledMethods,
+    kOtherMethods,
+  };
+
   OatDexMethodVisitor(OatWriter* writer, size_t offset)
     : DexMethodVisitor(writer, offset),
       oat_class_index_(0u),
-      method_offsets_index_(0u) {
+      method_offsets_index_(0u),
+      code_pass_(CodePass::kAllMethods) {
+  }
+
+  void StartCodePass(CodePass code_pass) {
+    DCHECK(oat_class_index_ == 0u || oat_class_index_ == writer_->oat_classes_.size());
+    oat_class_index_ = 0u;
+    code_pass_ = code_pass;
   }
 
   bool StartClass(const DexFile* dex_file, size_t class_def_index) {
@@ -599,9 +624,20 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
     return DexMethodVisitor::EndClass();
   }
 
+  bool IsLastCodePass() const {
+    return code_pass_ != CodePass::kProfiledMethods;
+  }
+
  protected:
+  bool IsInCodePass(const MethodReference& method_ref) const {
+    return code_pass_ == CodePass::kAllMethods ||
+        (code_pass_ == CodePass::kProfiledMethods) ==
+            writer_->compiler_driver_->IsMethodInProfile(method_ref);
+  }
+
   size_t oat_class_index_;
   size_t method_offsets_index_;
+  CodePass code_pass_;
 };
 
 class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
@@ -677,7 +713,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() {
     OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (oat_class_index_ == writer_->oat_classes_.size() && IsLastCodePass()) {
       offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
     }
     return true;
@@ -688,6 +724,13 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
     OatClass* oat_class = &writer_->oat_classes_[oat_class_index_];
     CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
 
+    if (compiled_method != nullptr &&
+        !IsInCodePass(MethodReference(dex_file_, it.GetMemberIndex()))) {
+      // Laid out in the other pass.
+      ++method_offsets_index_;
+      return true;
+    }
+
     if (compiled_method != nullptr) {
       // Derived from CompiledMethod.
       uint32_t quick_code_offset = 0;
@@ -985,7 +1028,7 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() SHARED_REQUIRES(Locks::mutator_lock_) {
     bool result = OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (oat_class_index_ == writer_->oat_classes_.size() && IsLastCodePass()) {
       DCHECK(result);  // OatDexMethodVisitor::EndClass() never fails.
       offset_ = writer_->relative_patcher_->WriteThunks(out_, offset_);
       if (UNLIKELY(offset_ == 0u)) {
@@ -1003,6 +1046,13 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
 
     // No thread suspension since dex_cache_ that may get invalidated if that occurs.
     ScopedAssertNoThreadSuspension tsc(Thread::Current(), __FUNCTION__);
+    if (compiled_method != nullptr &&
+        !IsInCodePass(MethodReference(dex_file_, it.GetMemberIndex()))) {
+      // Written in the other pass.
+      ++method_offsets_index_;
+      return true;
+    }
+
     if (compiled_method != nullptr) {  // ie. not an abstract method
       size_t file_offset = file_offset_;
       OutputStream* out = out_;
@@ -1391,6 +1441,21 @@ bool OatWriter::VisitDexMethods(DexMethodVisitor* visitor) {
   return true;
 }
 
+template <typename CodeVisitor>
+bool OatWriter::VisitDexMethodsInCodeOrder(CodeVisitor* visitor) {
+  if (compiler_driver_->GetProfileCompilationInfo() == nullptr) {
+    return VisitDexMethods(visitor);
+  }
+  // Place the code of the methods from the profile first so that the code used during
+  // startup is packed into as few pages of .text as possible.
+  visitor->StartCodePass(CodeVisitor::CodePass::kProfiledMethods);
+  if (UNLIKELY(!VisitDexMethods(visitor))) {
+    return false;
+  }
+  visitor->StartCodePass(CodeVisitor::CodePass::kOtherMethods);
+  return VisitDexMethods(visitor);
+}
+
 size_t OatWriter::InitOatHeader(InstructionSet instruction_set,
                                 const InstructionSetFeatures* instruction_set_features,
                                 uint32_t num_dex_files,
@@ -1491,7 +1556,12 @@ size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
       offset = visitor.GetOffset();                   \
     } while (false)
 
-  VISIT(InitCodeMethodVisitor);
+  {
+    InitCodeMethodVisitor visitor(this, offset);
+    bool success = VisitDexMethodsInCodeOrder(&visitor);
+    DCHECK(success);
+    offset = visitor.GetOffset();
+  }
   if (HasImage()) {
     VISIT(InitImageMethodVisitor);
   }
@@ -1622,6 +1692,9 @@ bool OatWriter::WriteCode(OutputStream* out) {
     VLOG(compiler) << "size_total=" << PrettySize(size_total) << " (" << size_total << "B)"; \
     CHECK_EQ(file_offset + size_total, static_cast<size_t>(oat_end_file_offset));
     CHECK_EQ(size_, size_total);
+
+    VLOG(compiler) << "num_relative_call_thunks=" << num_relative_call_thunks_;
+    VLOG(compiler) << "num_misc_thunks=" << num_misc_thunks_;
   }
 
   CHECK_EQ(file_offset + size_, static_cast<size_t>(oat_end_file_offset));
@@ -1760,22 +1833,19 @@ size_t OatWriter::WriteCode(OutputStream* out, const size_t file_offset, size_t
 size_t OatWriter::WriteCodeDexFiles(OutputStream* out,
                                     const size_t file_offset,
                                     size_t relative_offset) {
-  #define VISIT(VisitorType)                                              \
-    do {                                                                  \
-      VisitorType visitor(this, out, file_offset, relative_offset);       \
-      if (UNLIKELY(!VisitDexMethods(&visitor))) {                         \
-        return 0;                                                         \
-      }                                                                   \
-      relative_offset = visitor.GetOffset();                              \
-    } while (false)
-
-  VISIT(WriteCodeMethodVisitor);
-
-  #undef VISIT
+  {
+    WriteCodeMethodVisitor visitor(this, out, file_offset, relative_offset);
+    if (UNLIKELY(!VisitDexMethodsInCodeOrder(&visitor))) {
+      return 0;
+    }
+    relative_offset = visitor.GetOffset();
+  }
 
   size_code_alignment_ += relative_patcher_->CodeAlignmentSize();
   size_relative_call_thunks_ += relative_patcher_->RelativeCallThunksSize();
   size_misc_thunks_ += relative_patcher_->MiscThunksSize();
+  num_relative_call_thunks_ += relative_patcher_->RelativeCallThunksCount();
+  num_misc_thunks_ += relative_patcher_->MiscThunksCount();
 
   return relative_offset;
 }
@@ -1807,6 +1877,7 @@ bool OatWriter::ReadDexFileHeader(File* file, OatDexFile* oat_dex_file) {
   oat_dex_file->dex_file_size_ = header->file_size_;
   oat_dex_file->dex_file_location_checksum_ = header->checksum_;
   oat_dex_file->class_offsets_.resize(header->class_defs_size_);
+  oat_dex_file->num_type_ids_ = header->type_ids_size_;
   return true;
 }
 
@@ -2083,6 +2154,7 @@ bool OatWriter::WriteDexFile(OutputStream* rodata,
   // Note: For raw data, the checksum is passed directly to AddRawDexFileSource().
   oat_dex_file->dex_file_size_ = header->file_size_;
   oat_dex_file->class_offsets_.resize(header->class_defs_size_);
+  oat_dex_file->num_type_ids_ = header->type_ids_size_;
   return true;
 }
 
@@ -2173,8 +2245,7 @@ bool OatWriter::OpenDexFiles(
   for (OatDexFile& oat_dex_file : oat_dex_files_) {
     // Make sure no one messed with input files while we were copying data.
     // At the very least we need consistent file size and number of class definitions.
-    const uint8_t* raw_dex_file =
-        dex_files_map->Begin() + oat_dex_file.dex_file_offset_ - map_offset;
+    uint8_t* raw_dex_file = dex_files_map->Begin() + oat_dex_file.dex_file_offset_ - map_offset;
     if (!ValidateDexFileHeader(raw_dex_file, oat_dex_file.GetLocation())) {
       // Note: ValidateDexFileHeader() already logged an error message.
       LOG(ERROR) << "Failed to verify written dex file header!"
@@ -2196,6 +2267,18 @@ bool OatWriter::OpenDexFiles(
       return false;
     }
 
+    if (profile_compilation_info_ != nullptr) {
+      // The dex file is mapped writable, so we can relayout it in place. The location
+      // checksum still refers to the original dex file.
+      if (LayoutDexFileForProfile(raw_dex_file,
+                                  oat_dex_file.dex_file_size_,
+                                  oat_dex_file.GetLocation(),
+                                  oat_dex_file.dex_file_location_checksum_,
+                                  *profile_compilation_info_)) {
+        VLOG(compiler) << "Relaid out dex file " << oat_dex_file.GetLocation();
+      }
+    }
+
     // Now, open the dex file.
     dex_files.emplace_back(DexFile::Open(raw_dex_file,
                                          oat_dex_file.dex_file_size_,
@@ -2274,6 +2357,7 @@ OatWriter::OatDexFile::OatDexFile(const char* dex_file_location,
     : source_(source),
       create_type_lookup_table_(create_type_lookup_table),
       dex_file_size_(0),
+      num_type_ids_(0u),
       offset_(0),
       dex_file_location_size_(strlen(dex_file_location)),
       dex_file_location_data_(dex_file_location),
@@ -2296,7 +2380,7 @@ size_t OatWriter::OatDexFile::SizeOf() const {
 void OatWriter::OatDexFile::ReserveTypeLookupTable(OatWriter* oat_writer) {
   DCHECK_EQ(lookup_table_offset_, 0u);
   if (create_type_lookup_table_ == CreateTypeLookupTable::kCreate && !class_offsets_.empty()) {
-    size_t table_size = TypeLookupTable::RawDataLength(class_offsets_.size());
+    size_t table_size = TypeLookupTable::RawDataLength(class_offsets_.size(), num_type_ids_);
     if (table_size != 0u) {
       // Type tables are required to be 4 byte aligned.
       size_t original_offset = oat_writer->size_;
@@ -38,6 +38,7 @@ class CompiledMethod;
 class CompilerDriver;
 class ImageWriter;
 class OutputStream;
+class ProfileCompilationInfo;
 class TimingLogger;
 class TypeLookupTable;
 class ZipEntry;
@@ -62,7 +63,8 @@ class MultiOatRelativePatcher;
 // ...
 // Dex[D]
 //
-// TypeLookupTable[0] one descriptor to class def index hash table for each OatDexFile.
+// TypeLookupTable[0] one descriptor to class def index hash table for each OatDexFile,
+//                   followed by a descriptor to type index hash table.
 // TypeLookupTable[1]
 // ...
 // TypeLookupTable[D]
@@ -110,7 +112,11 @@ class OatWriter {
     kDefault = kCreate
   };
 
-  OatWriter(bool compiling_boot_image, TimingLogger* timings);
+  // If `profile_compilation_info` is not null, the dex files are relaid out to group
+  // the code and strings of the profiled methods, see LayoutDexFileForProfile().
+  OatWriter(bool compiling_boot_image,
+            TimingLogger* timings,
+            const ProfileCompilationInfo* profile_compilation_info);
 
   // To produce a valid oat file, the user must first add sources with any combination of
   //   - AddDexFileSource(),
@@ -236,6 +242,11 @@ class OatWriter {
   // with a given DexMethodVisitor.
   bool VisitDexMethods(DexMethodVisitor* visitor);
 
+  // Visit the methods with InitCodeMethodVisitor or WriteCodeMethodVisitor in the order
+  // of their code in .text. With a profile, the profiled methods are visited first.
+  template <typename CodeVisitor>
+  bool VisitDexMethodsInCodeOrder(CodeVisitor* visitor);
+
   size_t InitOatHeader(InstructionSet instruction_set,
                        const InstructionSetFeatures* instruction_set_features,
                        uint32_t num_dex_files,
@@ -283,6 +294,7 @@ class OatWriter {
 
   WriteState write_state_;
   TimingLogger* timings_;
+  const ProfileCompilationInfo* const profile_compilation_info_;
 
   std::vector<std::unique_ptr<File>> raw_dex_files_;
   std::vector<std::unique_ptr<ZipArchive>> zip_archives_;
@@ -358,6 +370,8 @@ class OatWriter {
   uint32_t size_oat_class_status_;
   uint32_t size_oat_class_method_bitmaps_;
   uint32_t size_oat_class_method_offsets_;
+  uint32_t num_relative_call_thunks_;
+  uint32_t num_misc_thunks_;
 
   // The helper for processing relative patches is external so that we can patch across oat files.
   linker::MultiOatRelativePatcher* relative_patcher_;
@@ -551,7 +551,7 @@ class BCEVisitor : public HGraphVisitor {
     HGraphVisitor::VisitBasicBlock(block);
     // We should never deoptimize from an osr method, otherwise we might wrongly optimize
     // code dominated by the deoptimization.
-    if (!GetGraph()->IsCompilingOsr()) {
+    if (GetGraph()->AllowsSpeculativeDeoptimization()) {
       AddComparesWithDeoptimization(block);
     }
   }
@@ -893,7 +893,7 @@ class BCEVisitor : public HGraphVisitor {
           // Do this test last, since it may generate code.
           CanHandleLength(loop, array_length, needs_taken_test)) {
         TransformLoopForDeoptimizationIfNeeded(loop, needs_taken_test);
-        TransformLoopForDynamicBCE(loop, bounds_check);
+        TransformLoopForDynamicBCE(loop, bounds_check, needs_finite_test);
         return;
       }
       // Otherwise, prepare dominator-based dynamic elimination.
@@ -1337,7 +1337,9 @@ class BCEVisitor : public HGraphVisitor {
    * number of eventually generated tests, related bounds checks with tests that can be
    * combined with tests for the given bounds check are collected first.
    */
-  void TransformLoopForDynamicBCE(HLoopInformation* loop, HBoundsCheck* bounds_check) {
+  void TransformLoopForDynamicBCE(HLoopInformation* loop,
+                                  HBoundsCheck* bounds_check,
+                                  bool needs_finite_test) {
     HInstruction* index = bounds_check->InputAt(0);
     HInstruction* array_length = bounds_check->InputAt(1);
     DCHECK(loop->IsDefinedOutOfTheLoop(array_length));  // pre-checked
@@ -1401,7 +1403,7 @@ class BCEVisitor : public HGraphVisitor {
           int32_t other_c = ValueBound::AsValueBound(other_index).GetConstant();
           // Generate code for either the maximum or minimum. Range analysis already was queried
           // whether code generation on the original and, thus, related bounds check was possible.
-          // It handles either loop invariants (lower is not set) or unit strides.
+          // It handles either loop invariants (lower is not set) or linear inductions.
           if (other_c == max_c) {
             induction_range_.GenerateRangeCode(
                 other_bounds_check, other_index, GetGraph(), block, &max_lower, &max_upper);
@@ -1418,10 +1420,14 @@ class BCEVisitor : public HGraphVisitor {
       // (2) two symbolic invariants
       //       if (min_upper >  max_upper) deoptimize;   unless min_c == max_c
       //       if (max_upper >= a.length ) deoptimize;
-      // (3) general case, unit strides (where lower would exceed upper for arithmetic wrap-around)
+      // (3) general case, linear inductions (where lower would exceed upper for arithmetic
+      //     wrap-around)
       //       if (min_lower >  max_lower) deoptimize;   unless min_c == max_c
       //       if (max_lower >  max_upper) deoptimize;
       //       if (max_upper >= a.length ) deoptimize;
+      // (4) a possibly infinite loop with a stride s > 1 (which, unlike a unit stride, may step
+      //     over an upper bound of a.length close to the maximum integer)
+      //       if (max_upper > MAX_INT - s) deoptimize;
       if (base == nullptr) {
         // Constants only.
         DCHECK_GE(min_c, 0);
@@ -1438,7 +1444,7 @@ class BCEVisitor : public HGraphVisitor {
                  max_lower == nullptr && max_upper != nullptr);
         }
       } else {
-        // General case, unit strides.
+        // General case, linear inductions.
         if (min_c != max_c) {
           DCHECK(min_lower != nullptr && min_upper != nullptr &&
                  max_lower != nullptr && max_upper != nullptr);
@@ -1451,6 +1457,14 @@ class BCEVisitor : public HGraphVisitor {
       }
       InsertDeoptInLoop(
           loop, block, new (GetGraph()->GetArena()) HAboveOrEqual(max_upper, array_length));
+      int64_t stride = 0;
+      if (needs_finite_test &&
+          induction_range_.GetStride(bounds_check, index, &stride) &&
+          stride > 1) {
+        HInstruction* max_index = GetGraph()->GetIntConstant(
+            static_cast<int32_t>(std::numeric_limits<int32_t>::max() - stride));
+        InsertDeoptInLoop(loop, block, new (GetGraph()->GetArena()) HAbove(max_upper, max_index));
+      }
     } else {
       // TODO: if rejected, avoid doing this again for subsequent instructions in this set?
     }
@@ -1468,7 +1482,7 @@ class BCEVisitor : public HGraphVisitor {
       }
       // We should never deoptimize from an osr method, otherwise we might wrongly optimize
       // code dominated by the deoptimization.
-      if (GetGraph()->IsCompilingOsr()) {
+      if (!GetGraph()->AllowsSpeculativeDeoptimization()) {
         return false;
       }
       // A try boundary preheader is hard to handle.
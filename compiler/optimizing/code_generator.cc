@@ -53,6 +53,7 @@
 #include "mirror/string.h"
 #include "parallel_move_resolver.h"
 #include "ssa_liveness_analysis.h"
+#include "string_builder_append.h"
 #include "utils/assembler.h"
 
 namespace art {
@@ -217,10 +218,66 @@ void CodeGenerator::GenerateSlowPaths() {
   current_slow_path_ = nullptr;
 }
 
+// Returns whether the profile shows `block` is not executed, while the branch leading
+// to it is. `block` must have a single predecessor.
+static bool IsUnlikelySuccessor(HBasicBlock* predecessor, HBasicBlock* block) {
+  HInstruction* last = predecessor->GetLastInstruction();
+  if (!last->IsIf()) {
+    return false;
+  }
+  HIf* if_instruction = last->AsIf();
+  if (if_instruction->IfTrueSuccessor() == if_instruction->IfFalseSuccessor()) {
+    return false;
+  }
+  return (block == if_instruction->IfTrueSuccessor())
+      ? if_instruction->IsTrueSuccessorUnlikely()
+      : if_instruction->IsFalseSuccessorUnlikely();
+}
+
+void CodeGenerator::LayOutColdBlocks() {
+  // A block is cold if it is an unlikely successor of a profiled HIf, or if it is dominated
+  // by a cold block: it can then only be executed after that block.
+  ArenaBitVector cold_blocks(
+      graph_->GetArena(), graph_->GetBlocks().size(), false, kArenaAllocCodeGenerator);
+  bool has_cold_blocks = false;
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    HBasicBlock* dominator = block->GetDominator();
+    if (dominator == nullptr) {
+      continue;
+    }
+    if (cold_blocks.IsBitSet(dominator->GetBlockId()) ||
+        (block->GetPredecessors().size() == 1u && IsUnlikelySuccessor(dominator, block))) {
+      cold_blocks.SetBit(block->GetBlockId());
+      has_cold_blocks = true;
+    }
+  }
+  if (!has_cold_blocks) {
+    return;
+  }
+
+  // Emit the hot blocks first, and then the cold blocks, keeping their relative order.
+  // The cold blocks end up with the slow paths, after the code executed in practice.
+  DCHECK(cold_block_layout_.empty());
+  cold_block_layout_.reserve(block_order_->size());
+  for (HBasicBlock* block : *block_order_) {
+    if (!cold_blocks.IsBitSet(block->GetBlockId())) {
+      cold_block_layout_.push_back(block);
+    }
+  }
+  for (HBasicBlock* block : *block_order_) {
+    if (cold_blocks.IsBitSet(block->GetBlockId())) {
+      cold_block_layout_.push_back(block);
+    }
+  }
+  DCHECK(cold_block_layout_[0] == graph_->GetEntryBlock());
+  block_order_ = &cold_block_layout_;
+}
+
 void CodeGenerator::Compile(CodeAllocator* allocator) {
   // The register allocator already called `InitializeCodeGeneration`,
   // where the frame size has been computed.
   DCHECK(block_order_ != nullptr);
+  LayOutColdBlocks();
   Initialize();
 
   HGraphVisitor* instruction_visitor = GetInstructionVisitor();
@@ -297,7 +354,8 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
   if (number_of_spill_slots == 0
       && !HasAllocatedCalleeSaveRegisters()
       && IsLeafMethod()
-      && !RequiresCurrentMethod()) {
+      && !RequiresCurrentMethod()
+      && !GetGraph()->HasShouldDeoptimizeFlag()) {
     DCHECK_EQ(maximum_number_of_live_core_registers, 0u);
     DCHECK_EQ(maximum_number_of_live_fpu_registers, 0u);
     SetFrameSize(CallPushesPC() ? GetWordSize() : 0);
@@ -306,6 +364,7 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
         first_register_slot_in_slow_path_
         + maximum_number_of_live_core_registers * GetWordSize()
         + maximum_number_of_live_fpu_registers * GetFloatingPointSpillSlotSize()
+        + (GetGraph()->HasShouldDeoptimizeFlag() ? kShouldDeoptimizeFlagSize : 0)
         + FrameEntrySpillSize(),
         kStackAlignment));
   }
@@ -647,7 +706,8 @@ static void CheckCovers(uint32_t dex_pc,
   CodeInfoEncoding encoding = code_info.ExtractEncoding();
   for (size_t i = 0; i < loop_headers.size(); ++i) {
     if (loop_headers[i]->GetDexPc() == dex_pc) {
-      if (graph.IsCompilingOsr()) {
+      if (graph.IsCompilingOsr() &&
+          loop_headers[i]->GetBlock()->GetLoopInformation()->IsIrreducible()) {
         DCHECK(code_info.GetOsrStackMapForDexPc(dex_pc, encoding).IsValid());
       }
       ++(*covered)[i];
@@ -797,11 +857,12 @@ void CodeGenerator::RecordPcInfo(HInstruction* instruction,
   if (instruction->IsSuspendCheck() &&
       (info != nullptr) &&
       graph_->IsCompilingOsr() &&
+      info->IsIrreducible() &&
       (inlining_depth == 0)) {
     DCHECK_EQ(info->GetSuspendCheck(), instruction);
     // We duplicate the stack map as a marker that this stack map can be an OSR entry.
     // Duplicating it avoids having the runtime recognize and skip an OSR stack map.
-    DCHECK(info->IsIrreducible());
+    // Only loops containing the OSR entry are irreducible, the others cannot be entered.
     stack_map_stream_.BeginStackMapEntry(
         dex_pc, native_pc, register_mask, locations->GetStackMask(), outer_environment_size, 0);
     EmitEnvironment(instruction->GetEnvironment(), slow_path);
@@ -919,6 +980,21 @@ void CodeGenerator::RecordCatchBlockInfo() {
   }
 }
 
+bool CodeGenerator::CanEncodeInlinedDexFile(const DexFile& dex_file) const {
+  return IsSameDexFile(dex_file, graph_->GetDexFile()) ||
+      (ContainsElement(dex_files_for_oat_file_, &graph_->GetDexFile()) &&
+       ContainsElement(dex_files_for_oat_file_, &dex_file));
+}
+
+uint32_t CodeGenerator::GetInlinedDexFileIndex(const DexFile& dex_file) const {
+  if (IsSameDexFile(dex_file, graph_->GetDexFile())) {
+    return InlineInfo::kOuterDexFileIndex;
+  }
+  DCHECK(CanEncodeInlinedDexFile(dex_file)) << dex_file.GetLocation();
+  auto it = std::find(dex_files_for_oat_file_.begin(), dex_files_for_oat_file_.end(), &dex_file);
+  return dchecked_integral_cast<uint32_t>(it - dex_files_for_oat_file_.begin());
+}
+
 void CodeGenerator::EmitEnvironment(HEnvironment* environment, SlowPathCode* slow_path) {
   if (environment == nullptr) return;
 
@@ -928,7 +1004,8 @@ void CodeGenerator::EmitEnvironment(HEnvironment* environment, SlowPathCode* slo
     stack_map_stream_.BeginInlineInfoEntry(environment->GetMethodIdx(),
                                            environment->GetDexPc(),
                                            environment->GetInvokeType(),
-                                           environment->Size());
+                                           environment->Size(),
+                                           GetInlinedDexFileIndex(environment->GetDexFile()));
   }
 
   // Walk over the environment, and record the location of dex registers.
@@ -1342,6 +1419,49 @@ void CodeGenerator::CreateSystemArrayCopyLocationSummary(HInvoke* invoke) {
   locations->AddTemp(Location::RequiresRegister());
 }
 
+LocationSummary* CodeGenerator::CreateStringBuilderAppendLocations(
+    HStringBuilderAppend* instruction) {
+  ArenaAllocator* allocator = GetGraph()->GetArena();
+  LocationSummary* locations =
+      new (allocator) LocationSummary(instruction, LocationSummary::kCallOnMainOnly);
+  locations->SetInAt(instruction->FormatIndex(),
+                     Location::ConstantLocation(instruction->GetFormat()));
+
+  // The arguments start after the ArtMethod* slot. The stack pointer is aligned,
+  // so aligning the offset aligns the address of the long arguments.
+  uint32_t format = static_cast<uint32_t>(instruction->GetFormat()->GetValue());
+  size_t pointer_size = static_cast<size_t>(InstructionSetPointerSize(GetInstructionSet()));
+  size_t stack_offset = pointer_size;
+  for (size_t i = 0, e = instruction->GetNumberOfArguments(); i != e; ++i) {
+    StringBuilderAppend::Argument kind =
+        static_cast<StringBuilderAppend::Argument>(format & StringBuilderAppend::kArgMask);
+    format >>= StringBuilderAppend::kBitsPerArg;
+    switch (kind) {
+      case StringBuilderAppend::Argument::kString:
+        static_assert(sizeof(mirror::HeapReference<mirror::Object>) == kVRegSize,
+                      "References must fit in a vreg slot");
+        FALLTHROUGH_INTENDED;
+      case StringBuilderAppend::Argument::kBoolean:
+      case StringBuilderAppend::Argument::kChar:
+      case StringBuilderAppend::Argument::kInt:
+        locations->SetInAt(i, Location::StackSlot(stack_offset));
+        stack_offset += kVRegSize;
+        break;
+      case StringBuilderAppend::Argument::kLong:
+        stack_offset = RoundUp(stack_offset, sizeof(int64_t));
+        locations->SetInAt(i, Location::DoubleStackSlot(stack_offset));
+        stack_offset += 2u * kVRegSize;
+        break;
+      default:
+        LOG(FATAL) << "Unexpected argument kind " << static_cast<uint32_t>(kind);
+        UNREACHABLE();
+    }
+  }
+  DCHECK_EQ(format, 0u);
+  GetGraph()->UpdateMaximumNumberOfOutVRegs((stack_offset - pointer_size) / kVRegSize);
+  return locations;
+}
+
 uint32_t CodeGenerator::GetReferenceSlowFlagOffset() const {
   ScopedObjectAccess soa(Thread::Current());
   mirror::Class* klass = mirror::Reference::GetJavaLangRefReference();
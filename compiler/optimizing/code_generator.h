@@ -31,7 +31,9 @@
 #include "memory_region.h"
 #include "nodes.h"
 #include "optimizing_compiler_stats.h"
+#include "stack.h"
 #include "stack_map_stream.h"
+#include "utils/array_ref.h"
 #include "utils/label.h"
 
 namespace art {
@@ -384,6 +386,14 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return type == Primitive::kPrimNot && !value->IsNullConstant();
   }
 
+  // The same for an instance or static field set, also honoring the write barrier elimination.
+  static bool FieldSetNeedsWriteBarrier(HInstruction* instruction, Primitive::Type field_type) {
+    DCHECK(instruction->IsInstanceFieldSet() || instruction->IsStaticFieldSet());
+    return StoreNeedsWriteBarrier(field_type, instruction->InputAt(1)) &&
+        (!instruction->IsInstanceFieldSet() ||
+         instruction->AsInstanceFieldSet()->GetNeedsWriteBarrier());
+  }
+
 
   // Perfoms checks pertaining to an InvokeRuntime call.
   void ValidateInvokeRuntime(HInstruction* instruction, SlowPathCode* slow_path);
@@ -445,6 +455,13 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return GetFpuSpillSize() + GetCoreSpillSize();
   }
 
+  // The CHA should deoptimize flag is right below the callee-save registers, where
+  // the runtime expects it.
+  uint32_t GetStackOffsetOfShouldDeoptimizeFlag() const {
+    DCHECK(GetGraph()->HasShouldDeoptimizeFlag());
+    return GetFrameSize() - FrameEntrySpillSize() - kShouldDeoptimizeFlagSize;
+  }
+
   virtual ParallelMoveResolver* GetMoveResolver() = 0;
 
   static void CreateCommonInvokeLocationSummary(
@@ -472,9 +489,21 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
 
   static void CreateSystemArrayCopyLocationSummary(HInvoke* invoke);
 
+  // Create the locations of an HStringBuilderAppend: the arguments are passed in the
+  // outgoing argument area, as described by StringBuilderAppend::AppendF().
+  LocationSummary* CreateStringBuilderAppendLocations(HStringBuilderAppend* instruction);
+
   void SetDisassemblyInformation(DisassemblyInformation* info) { disasm_info_ = info; }
   DisassemblyInformation* GetDisassemblyInformation() const { return disasm_info_; }
 
+  // The dex files of the oat file being compiled. The inline info of a method inlined from
+  // another dex file refers to its dex file by index in this list, so such methods can only
+  // be inlined with an environment if their dex file is here.
+  void SetDexFilesForOatFile(ArrayRef<const DexFile* const> dex_files) {
+    dex_files_for_oat_file_ = dex_files;
+  }
+  bool CanEncodeInlinedDexFile(const DexFile& dex_file) const;
+
   virtual void InvokeRuntime(QuickEntrypointEnum entrypoint,
                              HInstruction* instruction,
                              uint32_t dex_pc,
@@ -572,7 +601,9 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
         fpu_callee_save_mask_(fpu_callee_save_mask),
         stack_map_stream_(graph->GetArena()),
         block_order_(nullptr),
+        cold_block_layout_(graph->GetArena()->Adapter(kArenaAllocCodeGenerator)),
         disasm_info_(nullptr),
+        dex_files_for_oat_file_(),
         stats_(stats),
         graph_(graph),
         compiler_options_(compiler_options),
@@ -664,13 +695,21 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
   // The order to use for code generation.
   const ArenaVector<HBasicBlock*>* block_order_;
 
+  // The block order with the unlikely blocks moved to the end of the method, when
+  // the profile shows there are some.
+  ArenaVector<HBasicBlock*> cold_block_layout_;
+
   DisassemblyInformation* disasm_info_;
 
  private:
   size_t GetStackOffsetOfSavedRegister(size_t index);
+  void LayOutColdBlocks();
   void GenerateSlowPaths();
   void BlockIfInRegister(Location location, bool is_out = false) const;
   void EmitEnvironment(HEnvironment* environment, SlowPathCode* slow_path);
+  uint32_t GetInlinedDexFileIndex(const DexFile& dex_file) const;
+
+  ArrayRef<const DexFile* const> dex_files_for_oat_file_;
 
   OptimizingCompilerStats* stats_;
 
@@ -474,6 +474,80 @@ class ReadBarrierMarkSlowPathARM : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathARM);
 };
 
+// Slow path loading a heap reference with a Baker read barrier while
+// the GC is marking: the reference is loaded after the lock word of
+// `obj` and marked if `obj` is gray.
+class LoadReferenceWithBakerReadBarrierSlowPathARM : public SlowPathCode {
+ public:
+  LoadReferenceWithBakerReadBarrierSlowPathARM(HInstruction* instruction,
+                                               Location ref,
+                                               Register obj,
+                                               uint32_t offset,
+                                               Location index,
+                                               ScaleFactor scale_factor,
+                                               Location temp,
+                                               bool needs_null_check)
+      : SlowPathCode(instruction),
+        ref_(ref),
+        obj_(obj),
+        offset_(offset),
+        index_(index),
+        scale_factor_(scale_factor),
+        temp_(temp),
+        needs_null_check_(needs_null_check) {
+    DCHECK(kEmitCompilerReadBarrier);
+    DCHECK(kUseBakerReadBarrier);
+  }
+
+  const char* GetDescription() const OVERRIDE {
+    return "LoadReferenceWithBakerReadBarrierSlowPathARM";
+  }
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    Register reg = ref_.AsRegister<Register>();
+    DCHECK(locations->CanCall());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(reg));
+    DCHECK_NE(reg, SP);
+    DCHECK_NE(reg, LR);
+    DCHECK_NE(reg, PC);
+    DCHECK(0 <= reg && reg < kNumberOfCoreRegisters) << reg;
+
+    __ Bind(GetEntryLabel());
+    CodeGeneratorARM* arm_codegen = down_cast<CodeGeneratorARM*>(codegen);
+    arm_codegen->GenerateReferenceLoadWhileMarking(instruction_,
+                                                   ref_,
+                                                   obj_,
+                                                   offset_,
+                                                   index_,
+                                                   scale_factor_,
+                                                   temp_,
+                                                   needs_null_check_,
+                                                   GetExitLabel());
+    // `obj` is gray, mark the reference with the entrypoint dedicated
+    // to its register, which saves the live registers:
+    //
+    //   rX <- ReadBarrierMarkRegX(rX)
+    //
+    int32_t entry_point_offset =
+        CodeGenerator::GetReadBarrierMarkEntryPointsOffset<kArmPointerSize>(reg);
+    // This runtime call does not require a stack map.
+    arm_codegen->InvokeRuntimeWithoutRecordingPcInfo(entry_point_offset, instruction_, this);
+    __ b(GetExitLabel());
+  }
+
+ private:
+  const Location ref_;
+  const Register obj_;
+  const uint32_t offset_;
+  const Location index_;
+  const ScaleFactor scale_factor_;
+  const Location temp_;
+  const bool needs_null_check_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadReferenceWithBakerReadBarrierSlowPathARM);
+};
+
 // Slow path generating a read barrier for a heap reference.
 class ReadBarrierForHeapReferenceSlowPathARM : public SlowPathCode {
  public:
@@ -960,6 +1034,12 @@ void CodeGeneratorARM::GenerateFrameEntry() {
   __ AddConstant(SP, -adjust);
   __ cfi().AdjustCFAOffset(adjust);
   __ StoreToOffset(kStoreWord, kMethodRegisterArgument, SP, 0);
+
+  if (GetGraph()->HasShouldDeoptimizeFlag()) {
+    // Initialize should_deoptimize flag to 0.
+    __ LoadImmediate(IP, 0);
+    __ StoreToOffset(kStoreWord, IP, SP, GetStackOffsetOfShouldDeoptimizeFlag());
+  }
 }
 
 void CodeGeneratorARM::GenerateFrameExit() {
@@ -1569,6 +1649,19 @@ void InstructionCodeGeneratorARM::VisitDeoptimize(HDeoptimize* deoptimize) {
                         /* false_target */ nullptr);
 }
 
+void LocationsBuilderARM::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  LocationSummary* locations = new (GetGraph()->GetArena())
+      LocationSummary(flag, LocationSummary::kNoCall);
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorARM::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  __ LoadFromOffset(kLoadWord,
+                    flag->GetLocations()->Out().AsRegister<Register>(),
+                    SP,
+                    codegen_->GetStackOffsetOfShouldDeoptimizeFlag());
+}
+
 void LocationsBuilderARM::VisitSelect(HSelect* select) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(select);
   if (Primitive::IsFloatingPointType(select->GetType())) {
@@ -3578,6 +3671,22 @@ void InstructionCodeGeneratorARM::VisitNewInstance(HNewInstance* instruction) {
   }
 }
 
+void LocationsBuilderARM::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  LocationSummary* locations = codegen_->CreateStringBuilderAppendLocations(instruction);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->SetOut(Location::RegisterLocation(R0));
+}
+
+void InstructionCodeGeneratorARM::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  InvokeRuntimeCallingConvention calling_convention;
+  __ LoadImmediate(calling_convention.GetRegisterAt(0), instruction->GetFormat()->GetValue());
+  __ AddConstant(calling_convention.GetRegisterAt(1), SP, kArmWordSize);
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc(), nullptr);
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t, const uint32_t*>();
+}
+
 void LocationsBuilderARM::VisitNewArray(HNewArray* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnMainOnly);
@@ -5654,7 +5763,8 @@ static bool TypeCheckNeedsATemporary(TypeCheckKind type_check_kind) {
       (kUseBakerReadBarrier ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck);
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck);
 }
 
 void LocationsBuilderARM::VisitInstanceOf(HInstanceOf* instruction) {
@@ -5665,6 +5775,7 @@ void LocationsBuilderARM::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind =
           kEmitCompilerReadBarrier ? LocationSummary::kCallOnSlowPath : LocationSummary::kNoCall;
       break;
@@ -5762,6 +5873,19 @@ void InstructionCodeGeneratorARM::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ out = out->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, out_loc, display_offset, maybe_temp_loc);
+      __ cmp(out, ShifterOperand(cls));
+      // The class must be in the superclass display for the instanceof to succeed.
+      __ b(&zero, NE);
+      __ LoadImmediate(out, 1);
+      __ b(&done);
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       Label exact_check;
@@ -5851,6 +5975,7 @@ void LocationsBuilderARM::VisitCheckCast(HCheckCast* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind = (throws_into_catch || kEmitCompilerReadBarrier) ?
           LocationSummary::kCallOnSlowPath :
           LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
@@ -5894,7 +6019,8 @@ void InstructionCodeGeneratorARM::VisitCheckCast(HCheckCast* instruction) {
       (type_check_kind == TypeCheckKind::kExactCheck ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck) &&
       !instruction->CanThrowIntoCatchBlock();
   SlowPathCode* type_check_slow_path =
       new (GetGraph()->GetArena()) TypeCheckSlowPathARM(instruction,
@@ -5973,6 +6099,25 @@ void InstructionCodeGeneratorARM::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ temp = temp->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, temp_loc, display_offset, maybe_temp2_loc);
+      __ cmp(temp, ShifterOperand(cls));
+      __ b(&done, EQ);
+      // Otherwise, jump to the slow path to throw the exception.
+      //
+      // But before, move back the object's class into `temp` before
+      // going into the slow path, as it has been overwritten in the
+      // meantime.
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(
+          instruction, temp_loc, obj_loc, class_offset, maybe_temp2_loc);
+      __ b(type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       Label check_non_primitive_component_type;
@@ -6435,26 +6580,62 @@ void CodeGeneratorARM::GenerateReferenceLoadWithBakerReadBarrier(HInstruction* i
   DCHECK(kEmitCompilerReadBarrier);
   DCHECK(kUseBakerReadBarrier);
 
+  // Objects are only gray while the GC is marking, so the load of
+  // mirror::Object::monitor_ and the load-load ordering it requires
+  // (see GenerateReferenceLoadWhileMarking) are only needed then. The
+  // thread-local flag is only changed by checkpoints, hence it does
+  // not change while compiled code runs between suspend points. The
+  // fast path/slow path should look like:
+  //
+  //   if (Thread::Current()->GetIsGcMarking()) {
+  //     goto marking;  // Lock word load, gray check and marking, in a slow path.
+  //   }
+  //   HeapReference<Object> ref = *src;  // Original reference load.
+
+  Register temp_reg = temp.AsRegister<Register>();
+
+  // Slow path loading the reference and marking it if `obj` is gray.
+  SlowPathCode* slow_path = new (GetGraph()->GetArena())
+      LoadReferenceWithBakerReadBarrierSlowPathARM(
+          instruction, ref, obj, offset, index, scale_factor, temp, needs_null_check);
+  AddSlowPath(slow_path);
+
+  // temp = Thread::Current()->GetIsGcMarking()
+  __ LoadFromOffset(
+      kLoadWord, temp_reg, TR, Thread::IsGcMarkingOffset<kArmPointerSize>().Int32Value());
+  __ CompareAndBranchIfNonZero(temp_reg, slow_path->GetEntryLabel());
+  GenerateRawReferenceLoad(instruction, ref, obj, offset, index, scale_factor, needs_null_check);
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void CodeGeneratorARM::GenerateReferenceLoadWhileMarking(HInstruction* instruction,
+                                                         Location ref,
+                                                         Register obj,
+                                                         uint32_t offset,
+                                                         Location index,
+                                                         ScaleFactor scale_factor,
+                                                         Location temp,
+                                                         bool needs_null_check,
+                                                         Label* not_gray) {
   // In slow path based read barriers, the read barrier call is
   // inserted after the original load. However, in fast path based
   // Baker's read barriers, we need to perform the load of
   // mirror::Object::monitor_ *before* the original reference load.
   // This load-load ordering is required by the read barrier.
-  // The fast path/slow path (for Baker's algorithm) should look like:
+  // The code should look like:
   //
   //   uint32_t rb_state = Lockword(obj->monitor_).ReadBarrierState();
   //   lfence;  // Load fence or artificial data dependency to prevent load-load reordering
   //   HeapReference<Object> ref = *src;  // Original reference load.
   //   bool is_gray = (rb_state == ReadBarrier::gray_ptr_);
-  //   if (is_gray) {
-  //     ref = ReadBarrier::Mark(ref);  // Performed by runtime entrypoint slow path.
+  //   if (!is_gray) {
+  //     goto not_gray;
   //   }
   //
   // Note: the original implementation in ReadBarrier::Barrier is
   // slightly more complex as it performs additional checks that we do
   // not do here for performance reasons.
 
-  Register ref_reg = ref.AsRegister<Register>();
   Register temp_reg = temp.AsRegister<Register>();
   uint32_t monitor_offset = mirror::Object::MonitorOffset().Int32Value();
 
@@ -6474,6 +6655,30 @@ void CodeGeneratorARM::GenerateReferenceLoadWithBakerReadBarrier(HInstruction* i
   __ add(obj, obj, ShifterOperand(temp_reg, LSR, 32));
 
   // The actual reference load.
+  GenerateRawReferenceLoad(
+      instruction, ref, obj, offset, index, scale_factor, /* needs_null_check */ false);
+
+  // if (rb_state != ReadBarrier::gray_ptr_)
+  //   goto not_gray;
+  // Given the numeric representation, it's enough to check the low bit of the
+  // rb_state. We do that by shifting the bit out of the lock word with LSRS
+  // which can be a 16-bit instruction unlike the TST immediate.
+  static_assert(ReadBarrier::white_ptr_ == 0, "Expecting white to have value 0");
+  static_assert(ReadBarrier::gray_ptr_ == 1, "Expecting gray to have value 1");
+  static_assert(ReadBarrier::black_ptr_ == 2, "Expecting black to have value 2");
+  __ Lsrs(temp_reg, temp_reg, LockWord::kReadBarrierStateShift + 1);
+  __ b(not_gray, CC);  // Carry flag is the last bit shifted out by LSRS.
+}
+
+void CodeGeneratorARM::GenerateRawReferenceLoad(HInstruction* instruction,
+                                                Location ref,
+                                                Register obj,
+                                                uint32_t offset,
+                                                Location index,
+                                                ScaleFactor scale_factor,
+                                                bool needs_null_check) {
+  Register ref_reg = ref.AsRegister<Register>();
+
   if (index.IsValid()) {
     // Load types involving an "index": ArrayGet and
     // UnsafeGetObject/UnsafeGetObjectVolatile intrinsics.
@@ -6497,26 +6702,12 @@ void CodeGeneratorARM::GenerateReferenceLoadWithBakerReadBarrier(HInstruction* i
     // /* HeapReference<Object> */ ref = *(obj + offset)
     __ LoadFromOffset(kLoadWord, ref_reg, obj, offset);
   }
+  if (needs_null_check) {
+    MaybeRecordImplicitNullCheck(instruction);
+  }
 
   // Object* ref = ref_addr->AsMirrorPtr()
   __ MaybeUnpoisonHeapReference(ref_reg);
-
-  // Slow path used to mark the object `ref` when it is gray.
-  SlowPathCode* slow_path =
-      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM(instruction, ref);
-  AddSlowPath(slow_path);
-
-  // if (rb_state == ReadBarrier::gray_ptr_)
-  //   ref = ReadBarrier::Mark(ref);
-  // Given the numeric representation, it's enough to check the low bit of the
-  // rb_state. We do that by shifting the bit out of the lock word with LSRS
-  // which can be a 16-bit instruction unlike the TST immediate.
-  static_assert(ReadBarrier::white_ptr_ == 0, "Expecting white to have value 0");
-  static_assert(ReadBarrier::gray_ptr_ == 1, "Expecting gray to have value 1");
-  static_assert(ReadBarrier::black_ptr_ == 2, "Expecting black to have value 2");
-  __ Lsrs(temp_reg, temp_reg, LockWord::kReadBarrierStateShift + 1);
-  __ b(slow_path->GetEntryLabel(), CS);  // Carry flag is the last bit shifted out by LSRS.
-  __ Bind(slow_path->GetExitLabel());
 }
 
 void CodeGeneratorARM::GenerateReadBarrierSlow(HInstruction* instruction,
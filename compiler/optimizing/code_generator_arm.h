@@ -508,6 +508,26 @@ class CodeGeneratorARM : public CodeGenerator {
                                                  ScaleFactor scale_factor,
                                                  Location temp,
                                                  bool needs_null_check);
+  // Load the reference after the lock word of `obj` when the GC is
+  // marking, and branch to `not_gray` unless `obj` is gray. Used by
+  // the slow path of GenerateReferenceLoadWithBakerReadBarrier.
+  void GenerateReferenceLoadWhileMarking(HInstruction* instruction,
+                                         Location ref,
+                                         Register obj,
+                                         uint32_t offset,
+                                         Location index,
+                                         ScaleFactor scale_factor,
+                                         Location temp,
+                                         bool needs_null_check,
+                                         Label* not_gray);
+  // Load the reference without a read barrier.
+  void GenerateRawReferenceLoad(HInstruction* instruction,
+                                Location ref,
+                                Register obj,
+                                uint32_t offset,
+                                Location index,
+                                ScaleFactor scale_factor,
+                                bool needs_null_check);
 
   // Generate a read barrier for a heap reference within `instruction`
   // using a slow path.
@@ -642,6 +642,85 @@ class ReadBarrierMarkSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathARM64);
 };
 
+// Slow path loading a heap reference with a Baker read barrier while
+// the GC is marking: the reference is loaded after the lock word of
+// `obj` and marked if `obj` is gray.
+class LoadReferenceWithBakerReadBarrierSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  LoadReferenceWithBakerReadBarrierSlowPathARM64(HInstruction* instruction,
+                                                 Location ref,
+                                                 Register obj,
+                                                 uint32_t offset,
+                                                 Location index,
+                                                 size_t scale_factor,
+                                                 Register temp,
+                                                 bool needs_null_check,
+                                                 bool use_load_acquire)
+      : SlowPathCodeARM64(instruction),
+        ref_(ref),
+        obj_(obj),
+        offset_(offset),
+        index_(index),
+        scale_factor_(scale_factor),
+        temp_(temp),
+        needs_null_check_(needs_null_check),
+        use_load_acquire_(use_load_acquire) {
+    DCHECK(kEmitCompilerReadBarrier);
+    DCHECK(kUseBakerReadBarrier);
+  }
+
+  const char* GetDescription() const OVERRIDE {
+    return "LoadReferenceWithBakerReadBarrierSlowPathARM64";
+  }
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(locations->CanCall());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(ref_.reg()));
+    DCHECK_NE(ref_.reg(), LR);
+    DCHECK_NE(ref_.reg(), WSP);
+    DCHECK_NE(ref_.reg(), WZR);
+    // IP0 is used by the runtime call as a temp, it can not be the reference register.
+    DCHECK_NE(ref_.reg(), IP0);
+    DCHECK(0 <= ref_.reg() && ref_.reg() < kNumberOfWRegisters) << ref_.reg();
+
+    __ Bind(GetEntryLabel());
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+    arm64_codegen->GenerateReferenceLoadWhileMarking(instruction_,
+                                                     ref_,
+                                                     obj_,
+                                                     offset_,
+                                                     index_,
+                                                     scale_factor_,
+                                                     temp_,
+                                                     needs_null_check_,
+                                                     use_load_acquire_,
+                                                     GetExitLabel());
+    // `obj` is gray, mark the reference with the entrypoint dedicated
+    // to its register, which saves the live registers:
+    //
+    //   rX <- ReadBarrierMarkRegX(rX)
+    //
+    int32_t entry_point_offset =
+        CodeGenerator::GetReadBarrierMarkEntryPointsOffset<kArm64PointerSize>(ref_.reg());
+    // This runtime call does not require a stack map.
+    arm64_codegen->InvokeRuntimeWithoutRecordingPcInfo(entry_point_offset, instruction_, this);
+    __ B(GetExitLabel());
+  }
+
+ private:
+  const Location ref_;
+  const Register obj_;
+  const uint32_t offset_;
+  const Location index_;
+  const size_t scale_factor_;
+  const Register temp_;
+  const bool needs_null_check_;
+  const bool use_load_acquire_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadReferenceWithBakerReadBarrierSlowPathARM64);
+};
+
 // Slow path generating a read barrier for a heap reference.
 class ReadBarrierForHeapReferenceSlowPathARM64 : public SlowPathCodeARM64 {
  public:
@@ -1051,6 +1130,11 @@ void CodeGeneratorARM64::GenerateFrameEntry() {
         frame_size - GetCoreSpillSize());
     GetAssembler()->SpillRegisters(GetFramePreservedFPRegisters(),
         frame_size - FrameEntrySpillSize());
+
+    if (GetGraph()->HasShouldDeoptimizeFlag()) {
+      // Initialize should_deoptimize flag to 0.
+      __ Str(wzr, MemOperand(sp, GetStackOffsetOfShouldDeoptimizeFlag()));
+    }
   }
 }
 
@@ -1551,8 +1635,36 @@ void CodeGeneratorARM64::GenerateMemoryBarrier(MemBarrierKind kind) {
   __ Dmb(InnerShareable, type);
 }
 
+void InstructionCodeGeneratorARM64::GenerateImplicitSuspendCheck(HSuspendCheck* instruction,
+                                                                 HBasicBlock* successor) {
+  if (successor != nullptr) {
+    DCHECK(successor->IsLoopHeader());
+    codegen_->ClearSpillSlotsFromLoopPhisInStackMap(instruction);
+  }
+  {
+    // The second load faults when a suspend trigger is set, see Thread::TriggerSuspend. The
+    // fault handler then calls pTestSuspend, which returns after the load. The sequence must
+    // be exactly the one that SuspensionHandler::Action looks for.
+    MacroAssembler* masm = GetVIXLAssembler();
+    BlockPoolsScope block_pools(masm);
+    UseScratchRegisterScope temps(masm);
+    temps.Exclude(ip0);
+    int32_t trigger_offset = Thread::ThreadSuspendTriggerOffset<kArm64PointerSize>().Int32Value();
+    __ Ldr(ip0, MemOperand(tr, trigger_offset));
+    __ Ldr(wzr, MemOperand(ip0, 0));
+    codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  }
+  if (successor != nullptr) {
+    __ B(codegen_->GetLabelOf(successor));
+  }
+}
+
 void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruction,
                                                          HBasicBlock* successor) {
+  if (codegen_->GetCompilerOptions().GetImplicitSuspendChecks()) {
+    GenerateImplicitSuspendCheck(instruction, successor);
+    return;
+  }
   SuspendCheckSlowPathARM64* slow_path =
       down_cast<SuspendCheckSlowPathARM64*>(instruction->GetSlowPath());
   if (slow_path == nullptr) {
@@ -1755,7 +1867,7 @@ void InstructionCodeGeneratorARM64::HandleFieldSet(HInstruction* instruction,
     }
   }
 
-  if (CodeGenerator::StoreNeedsWriteBarrier(field_type, instruction->InputAt(1))) {
+  if (CodeGenerator::FieldSetNeedsWriteBarrier(instruction, field_type)) {
     codegen_->MarkGCCard(obj, Register(value), value_can_be_null);
   }
 }
@@ -2340,7 +2452,9 @@ void InstructionCodeGeneratorARM64::VisitArraySet(HArraySet* instruction) {
       }
     }
 
-    codegen_->MarkGCCard(array, value.W(), instruction->GetValueCanBeNull());
+    if (instruction->GetNeedsWriteBarrier()) {
+      codegen_->MarkGCCard(array, value.W(), instruction->GetValueCanBeNull());
+    }
 
     if (done.IsLinked()) {
       __ Bind(&done);
@@ -2985,6 +3099,17 @@ void InstructionCodeGeneratorARM64::VisitDeoptimize(HDeoptimize* deoptimize) {
                         /* false_target */ nullptr);
 }
 
+void LocationsBuilderARM64::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  LocationSummary* locations = new (GetGraph()->GetArena())
+      LocationSummary(flag, LocationSummary::kNoCall);
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  __ Ldr(OutputRegister(flag),
+         MemOperand(sp, codegen_->GetStackOffsetOfShouldDeoptimizeFlag()));
+}
+
 static inline bool IsConditionOnFloatingPointValues(HInstruction* condition) {
   return condition->IsCondition() &&
          Primitive::IsFloatingPointType(condition->InputAt(0)->GetType());
@@ -3098,7 +3223,8 @@ static bool TypeCheckNeedsATemporary(TypeCheckKind type_check_kind) {
       (kUseBakerReadBarrier ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck);
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck);
 }
 
 void LocationsBuilderARM64::VisitInstanceOf(HInstanceOf* instruction) {
@@ -3109,6 +3235,7 @@ void LocationsBuilderARM64::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind =
           kEmitCompilerReadBarrier ? LocationSummary::kCallOnSlowPath : LocationSummary::kNoCall;
       break;
@@ -3207,6 +3334,19 @@ void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ out = out->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, out_loc, display_offset, maybe_temp_loc);
+      __ Cmp(out, cls);
+      __ Cset(out, eq);
+      if (zero.IsLinked()) {
+        __ B(&done);
+      }
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       vixl::aarch64::Label exact_check;
@@ -3296,6 +3436,7 @@ void LocationsBuilderARM64::VisitCheckCast(HCheckCast* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind = (throws_into_catch || kEmitCompilerReadBarrier) ?
           LocationSummary::kCallOnSlowPath :
           LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
@@ -3339,7 +3480,8 @@ void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
       (type_check_kind == TypeCheckKind::kExactCheck ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck) &&
       !instruction->CanThrowIntoCatchBlock();
   SlowPathCodeARM64* type_check_slow_path =
       new (GetGraph()->GetArena()) TypeCheckSlowPathARM64(instruction,
@@ -3418,6 +3560,25 @@ void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ temp = temp->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, temp_loc, display_offset, maybe_temp2_loc);
+      __ Cmp(temp, cls);
+      __ B(eq, &done);
+      // Otherwise, jump to the slow path to throw the exception.
+      //
+      // But before, move back the object's class into `temp` before
+      // going into the slow path, as it has been overwritten in the
+      // meantime.
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(
+          instruction, temp_loc, obj_loc, class_offset, maybe_temp2_loc);
+      __ B(type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       vixl::aarch64::Label check_non_primitive_component_type;
@@ -3568,7 +3729,7 @@ void InstructionCodeGeneratorARM64::VisitInvokeInterface(HInvokeInterface* invok
 }
 
 void LocationsBuilderARM64::VisitInvokeVirtual(HInvokeVirtual* invoke) {
-  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena());
+  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena(), codegen_);
   if (intrinsic.TryDispatch(invoke)) {
     return;
   }
@@ -3581,7 +3742,7 @@ void LocationsBuilderARM64::VisitInvokeStaticOrDirect(HInvokeStaticOrDirect* inv
   // art::PrepareForRegisterAllocation.
   DCHECK(!invoke->IsStaticWithExplicitClinitCheck());
 
-  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena());
+  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena(), codegen_);
   if (intrinsic.TryDispatch(invoke)) {
     return;
   }
@@ -4454,6 +4615,22 @@ void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction)
   }
 }
 
+void LocationsBuilderARM64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  LocationSummary* locations = codegen_->CreateStringBuilderAppendLocations(instruction);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(0)));
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(1)));
+  locations->SetOut(LocationFrom(x0));
+}
+
+void InstructionCodeGeneratorARM64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  InvokeRuntimeCallingConvention calling_convention;
+  __ Mov(calling_convention.GetRegisterAt(0), instruction->GetFormat()->GetValue());
+  __ Add(calling_convention.GetRegisterAt(1).X(), sp, Operand(kArm64WordSize));
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc(), nullptr);
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t, const uint32_t*>();
+}
+
 void LocationsBuilderARM64::VisitNot(HNot* instruction) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
   locations->SetInAt(0, Location::RequiresRegister());
@@ -5199,32 +5376,73 @@ void CodeGeneratorARM64::GenerateReferenceLoadWithBakerReadBarrier(HInstruction*
   // `instruction->IsArrayGet()` => `!use_load_acquire`.
   DCHECK(!instruction->IsArrayGet() || !use_load_acquire);
 
-  MacroAssembler* masm = GetVIXLAssembler();
-  UseScratchRegisterScope temps(masm);
+  // Objects are only gray while the GC is marking, so the load of
+  // mirror::Object::monitor_ and the load-load ordering it requires
+  // (see GenerateReferenceLoadWhileMarking) are only needed then. The
+  // thread-local flag is only changed by checkpoints, hence it does
+  // not change while compiled code runs between suspend points. The
+  // fast path/slow path should look like:
+  //
+  //   if (Thread::Current()->GetIsGcMarking()) {
+  //     goto marking;  // Lock word load, gray check and marking, in a slow path.
+  //   }
+  //   HeapReference<Object> ref = *src;  // Original reference load.
 
+  // Slow path loading the reference and marking it if `obj` is gray.
+  SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena())
+      LoadReferenceWithBakerReadBarrierSlowPathARM64(instruction,
+                                                     ref,
+                                                     obj,
+                                                     offset,
+                                                     index,
+                                                     scale_factor,
+                                                     temp,
+                                                     needs_null_check,
+                                                     use_load_acquire);
+  AddSlowPath(slow_path);
+
+  // temp = Thread::Current()->GetIsGcMarking()
+  __ Ldr(temp, MemOperand(tr, Thread::IsGcMarkingOffset<kArm64PointerSize>().Int32Value()));
+  __ Cbnz(temp, slow_path->GetEntryLabel());
+  GenerateRawReferenceLoad(
+      instruction, ref, obj, offset, index, scale_factor, needs_null_check, use_load_acquire);
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void CodeGeneratorARM64::GenerateReferenceLoadWhileMarking(HInstruction* instruction,
+                                                           Location ref,
+                                                           Register obj,
+                                                           uint32_t offset,
+                                                           Location index,
+                                                           size_t scale_factor,
+                                                           Register temp,
+                                                           bool needs_null_check,
+                                                           bool use_load_acquire,
+                                                           vixl::aarch64::Label* not_gray) {
   // In slow path based read barriers, the read barrier call is
   // inserted after the original load. However, in fast path based
   // Baker's read barriers, we need to perform the load of
   // mirror::Object::monitor_ *before* the original reference load.
   // This load-load ordering is required by the read barrier.
-  // The fast path/slow path (for Baker's algorithm) should look like:
+  // The code should look like:
   //
   //   uint32_t rb_state = Lockword(obj->monitor_).ReadBarrierState();
   //   lfence;  // Load fence or artificial data dependency to prevent load-load reordering
   //   HeapReference<Object> ref = *src;  // Original reference load.
   //   bool is_gray = (rb_state == ReadBarrier::gray_ptr_);
-  //   if (is_gray) {
-  //     ref = ReadBarrier::Mark(ref);  // Performed by runtime entrypoint slow path.
+  //   if (!is_gray) {
+  //     goto not_gray;
   //   }
   //
   // Note: the original implementation in ReadBarrier::Barrier is
   // slightly more complex as it performs additional checks that we do
   // not do here for performance reasons.
 
-  Primitive::Type type = Primitive::kPrimNot;
-  Register ref_reg = RegisterFrom(ref, type);
   DCHECK(obj.IsW());
   uint32_t monitor_offset = mirror::Object::MonitorOffset().Int32Value();
+  // `temp` may be a scratch register of the caller, keep it for the gray check.
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  temps.Exclude(temp);
 
   // /* int32_t */ monitor = obj->monitor_
   __ Ldr(temp, HeapOperand(obj, monitor_offset));
@@ -5242,6 +5460,37 @@ void CodeGeneratorARM64::GenerateReferenceLoadWithBakerReadBarrier(HInstruction*
   __ Add(obj.X(), obj.X(), Operand(temp.X(), LSR, 32));
 
   // The actual reference load.
+  GenerateRawReferenceLoad(instruction,
+                           ref,
+                           obj,
+                           offset,
+                           index,
+                           scale_factor,
+                           /* needs_null_check */ false,
+                           use_load_acquire);
+
+  // if (rb_state != ReadBarrier::gray_ptr_)
+  //   goto not_gray;
+  // Given the numeric representation, it's enough to check the low bit of the rb_state.
+  static_assert(ReadBarrier::white_ptr_ == 0, "Expecting white to have value 0");
+  static_assert(ReadBarrier::gray_ptr_ == 1, "Expecting gray to have value 1");
+  static_assert(ReadBarrier::black_ptr_ == 2, "Expecting black to have value 2");
+  __ Tbz(temp, LockWord::kReadBarrierStateShift, not_gray);
+}
+
+void CodeGeneratorARM64::GenerateRawReferenceLoad(HInstruction* instruction,
+                                                  Location ref,
+                                                  Register obj,
+                                                  uint32_t offset,
+                                                  Location index,
+                                                  size_t scale_factor,
+                                                  bool needs_null_check,
+                                                  bool use_load_acquire) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  UseScratchRegisterScope temps(masm);
+  Primitive::Type type = Primitive::kPrimNot;
+  Register ref_reg = RegisterFrom(ref, type);
+
   if (index.IsValid()) {
     // Load types involving an "index".
     if (use_load_acquire) {
@@ -5270,33 +5519,25 @@ void CodeGeneratorARM64::GenerateReferenceLoadWithBakerReadBarrier(HInstruction*
         Load(type, ref_reg, HeapOperand(temp2, XRegisterFrom(index), LSL, scale_factor));
         temps.Release(temp2);
       }
+      if (needs_null_check) {
+        MaybeRecordImplicitNullCheck(instruction);
+      }
     }
   } else {
     // /* HeapReference<Object> */ ref = *(obj + offset)
     MemOperand field = HeapOperand(obj, offset);
     if (use_load_acquire) {
-      LoadAcquire(instruction, ref_reg, field, /* needs_null_check */ false);
+      LoadAcquire(instruction, ref_reg, field, needs_null_check);
     } else {
       Load(type, ref_reg, field);
+      if (needs_null_check) {
+        MaybeRecordImplicitNullCheck(instruction);
+      }
     }
   }
 
   // Object* ref = ref_addr->AsMirrorPtr()
   GetAssembler()->MaybeUnpoisonHeapReference(ref_reg);
-
-  // Slow path used to mark the object `ref` when it is gray.
-  SlowPathCodeARM64* slow_path =
-      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM64(instruction, ref);
-  AddSlowPath(slow_path);
-
-  // if (rb_state == ReadBarrier::gray_ptr_)
-  //   ref = ReadBarrier::Mark(ref);
-  // Given the numeric representation, it's enough to check the low bit of the rb_state.
-  static_assert(ReadBarrier::white_ptr_ == 0, "Expecting white to have value 0");
-  static_assert(ReadBarrier::gray_ptr_ == 1, "Expecting gray to have value 1");
-  static_assert(ReadBarrier::black_ptr_ == 2, "Expecting black to have value 2");
-  __ Tbnz(temp, LockWord::kReadBarrierStateShift, slow_path->GetEntryLabel());
-  __ Bind(slow_path->GetExitLabel());
 }
 
 void CodeGeneratorARM64::GenerateReadBarrierSlow(HInstruction* instruction,
@@ -5385,7 +5626,127 @@ void InstructionCodeGeneratorARM64::VisitClassTableGet(HClassTableGet* instructi
   }
 }
 
+void LocationsBuilderARM64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  if (Primitive::IsFloatingPointType(instruction->GetPackedType())) {
+    locations->SetInAt(0, Location::RequiresFpuRegister());
+  } else {
+    locations->SetInAt(0, Location::RequiresRegister());
+  }
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
 
+void InstructionCodeGeneratorARM64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  FPRegister dst = QRegisterFrom(locations->Out()).V4S();
+  if (Primitive::IsFloatingPointType(instruction->GetPackedType())) {
+    __ Dup(dst, QRegisterFrom(locations->InAt(0)).V4S(), 0);
+  } else {
+    __ Dup(dst, InputRegisterAt(instruction, 0));
+  }
+}
+
+// The register offset forms of the Q register loads and stores can only scale the index by
+// 16, compute the address of the first element in `temp` instead.
+static MemOperand VecArrayAddress(MacroAssembler* masm,
+                                  LocationSummary* locations,
+                                  Primitive::Type packed_type,
+                                  const Register& temp) {
+  uint32_t offset = mirror::Array::DataOffset(Primitive::ComponentSize(packed_type)).Uint32Value();
+  masm->Add(temp,
+            XRegisterFrom(locations->InAt(0)),
+            Operand(XRegisterFrom(locations->InAt(1)), LSL,
+                    Primitive::ComponentSizeShift(packed_type)));
+  return MemOperand(temp, offset);
+}
+
+void LocationsBuilderARM64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register temp = temps.AcquireX();
+  __ Ldr(QRegisterFrom(locations->Out()),
+         VecArrayAddress(GetVIXLAssembler(), locations, instruction->GetPackedType(), temp));
+}
+
+void LocationsBuilderARM64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register temp = temps.AcquireX();
+  __ Str(QRegisterFrom(locations->InAt(2)),
+         VecArrayAddress(GetVIXLAssembler(), locations, instruction->GetPackedType(), temp));
+}
+
+void LocationsBuilderARM64::VisitVecBinaryOperation(HVecBinaryOperation* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
+
+void InstructionCodeGeneratorARM64::VisitVecBinaryOperation(HVecBinaryOperation* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  FPRegister dst = QRegisterFrom(locations->Out());
+  FPRegister lhs = QRegisterFrom(locations->InAt(0));
+  FPRegister rhs = QRegisterFrom(locations->InAt(1));
+  bool is_fp = Primitive::IsFloatingPointType(instruction->GetPackedType());
+  switch (instruction->GetOpKind()) {
+    case HInstruction::kAdd:
+      if (is_fp) {
+        __ Fadd(dst.V4S(), lhs.V4S(), rhs.V4S());
+      } else {
+        __ Add(dst.V4S(), lhs.V4S(), rhs.V4S());
+      }
+      break;
+    case HInstruction::kSub:
+      if (is_fp) {
+        __ Fsub(dst.V4S(), lhs.V4S(), rhs.V4S());
+      } else {
+        __ Sub(dst.V4S(), lhs.V4S(), rhs.V4S());
+      }
+      break;
+    case HInstruction::kMul:
+      if (is_fp) {
+        __ Fmul(dst.V4S(), lhs.V4S(), rhs.V4S());
+      } else {
+        __ Mul(dst.V4S(), lhs.V4S(), rhs.V4S());
+      }
+      break;
+    case HInstruction::kDiv:
+      DCHECK(is_fp);
+      __ Fdiv(dst.V4S(), lhs.V4S(), rhs.V4S());
+      break;
+    case HInstruction::kAnd:
+      __ And(dst.V16B(), lhs.V16B(), rhs.V16B());
+      break;
+    case HInstruction::kOr:
+      __ Orr(dst.V16B(), lhs.V16B(), rhs.V16B());
+      break;
+    case HInstruction::kXor:
+      __ Eor(dst.V16B(), lhs.V16B(), rhs.V16B());
+      break;
+    default:
+      LOG(FATAL) << "Unexpected vector operation " << instruction->GetOpKind();
+      UNREACHABLE();
+  }
+}
 
 #undef __
 #undef QUICK_ENTRY_POINT
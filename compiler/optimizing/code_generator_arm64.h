@@ -234,6 +234,7 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(DECLARE_VISIT_INSTRUCTION)
 
 #undef DECLARE_VISIT_INSTRUCTION
 
@@ -249,6 +250,7 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   void GenerateClassInitializationCheck(SlowPathCodeARM64* slow_path,
                                         vixl::aarch64::Register class_reg);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
+  void GenerateImplicitSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void HandleBinaryOp(HBinaryOperation* instr);
 
   void HandleFieldSet(HInstruction* instruction,
@@ -327,6 +329,7 @@ class LocationsBuilderARM64 : public HGraphVisitor {
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(DECLARE_VISIT_INSTRUCTION)
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(DECLARE_VISIT_INSTRUCTION)
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(DECLARE_VISIT_INSTRUCTION)
 
 #undef DECLARE_VISIT_INSTRUCTION
 
@@ -597,6 +600,28 @@ class CodeGeneratorARM64 : public CodeGenerator {
                                                  vixl::aarch64::Register temp,
                                                  bool needs_null_check,
                                                  bool use_load_acquire);
+  // Load the reference after the lock word of `obj` when the GC is
+  // marking, and branch to `not_gray` unless `obj` is gray. Used by
+  // the slow path of GenerateReferenceLoadWithBakerReadBarrier.
+  void GenerateReferenceLoadWhileMarking(HInstruction* instruction,
+                                         Location ref,
+                                         vixl::aarch64::Register obj,
+                                         uint32_t offset,
+                                         Location index,
+                                         size_t scale_factor,
+                                         vixl::aarch64::Register temp,
+                                         bool needs_null_check,
+                                         bool use_load_acquire,
+                                         vixl::aarch64::Label* not_gray);
+  // Load the reference without a read barrier.
+  void GenerateRawReferenceLoad(HInstruction* instruction,
+                                Location ref,
+                                vixl::aarch64::Register obj,
+                                uint32_t offset,
+                                Location index,
+                                size_t scale_factor,
+                                bool needs_null_check,
+                                bool use_load_acquire);
 
   // Generate a read barrier for a heap reference within `instruction`
   // using a slow path.
@@ -915,6 +915,11 @@ void CodeGeneratorX86::GenerateFrameEntry() {
   __ subl(ESP, Immediate(adjust));
   __ cfi().AdjustCFAOffset(adjust);
   __ movl(Address(ESP, kCurrentMethodStackOffset), kMethodRegisterArgument);
+
+  if (GetGraph()->HasShouldDeoptimizeFlag()) {
+    // Initialize should_deoptimize flag to 0.
+    __ movl(Address(ESP, GetStackOffsetOfShouldDeoptimizeFlag()), Immediate(0));
+  }
 }
 
 void CodeGeneratorX86::GenerateFrameExit() {
@@ -1533,6 +1538,17 @@ void InstructionCodeGeneratorX86::VisitDeoptimize(HDeoptimize* deoptimize) {
                                /* false_target */ nullptr);
 }
 
+void LocationsBuilderX86::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  LocationSummary* locations = new (GetGraph()->GetArena())
+      LocationSummary(flag, LocationSummary::kNoCall);
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  __ movl(flag->GetLocations()->Out().AsRegister<Register>(),
+          Address(ESP, codegen_->GetStackOffsetOfShouldDeoptimizeFlag()));
+}
+
 static bool SelectCanUseCMOV(HSelect* select) {
   // There are no conditional move instructions for XMMs.
   if (Primitive::IsFloatingPointType(select->GetType())) {
@@ -4046,6 +4062,22 @@ void InstructionCodeGeneratorX86::VisitNewInstance(HNewInstance* instruction) {
   }
 }
 
+void LocationsBuilderX86::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  LocationSummary* locations = codegen_->CreateStringBuilderAppendLocations(instruction);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->SetOut(Location::RegisterLocation(EAX));
+}
+
+void InstructionCodeGeneratorX86::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  InvokeRuntimeCallingConvention calling_convention;
+  __ movl(calling_convention.GetRegisterAt(0), Immediate(instruction->GetFormat()->GetValue()));
+  __ leal(calling_convention.GetRegisterAt(1), Address(ESP, kX86WordSize));
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc(), nullptr);
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t, const uint32_t*>();
+}
+
 void LocationsBuilderX86::VisitNewArray(HNewArray* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnMainOnly);
@@ -6316,7 +6348,8 @@ static bool TypeCheckNeedsATemporary(TypeCheckKind type_check_kind) {
       (kUseBakerReadBarrier ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck);
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck);
 }
 
 void LocationsBuilderX86::VisitInstanceOf(HInstanceOf* instruction) {
@@ -6327,6 +6360,7 @@ void LocationsBuilderX86::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind =
           kEmitCompilerReadBarrier ? LocationSummary::kCallOnSlowPath : LocationSummary::kNoCall;
       break;
@@ -6442,6 +6476,24 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ out = out->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, out_loc, display_offset, maybe_temp_loc);
+      if (cls.IsRegister()) {
+        __ cmpl(out, cls.AsRegister<Register>());
+      } else {
+        DCHECK(cls.IsStackSlot()) << cls;
+        __ cmpl(out, Address(ESP, cls.GetStackIndex()));
+      }
+      // The class must be in the superclass display for the instanceof to succeed.
+      __ j(kNotEqual, &zero);
+      __ movl(out, Immediate(1));
+      __ jmp(&done);
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       NearLabel exact_check;
@@ -6540,6 +6592,7 @@ void LocationsBuilderX86::VisitCheckCast(HCheckCast* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind = (throws_into_catch || kEmitCompilerReadBarrier) ?
           LocationSummary::kCallOnSlowPath :
           LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
@@ -6582,7 +6635,8 @@ void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
       (type_check_kind == TypeCheckKind::kExactCheck ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck) &&
       !instruction->CanThrowIntoCatchBlock();
   SlowPathCode* type_check_slow_path =
       new (GetGraph()->GetArena()) TypeCheckSlowPathX86(instruction,
@@ -6679,6 +6733,30 @@ void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ temp = temp->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, temp_loc, display_offset, maybe_temp2_loc);
+      if (cls.IsRegister()) {
+        __ cmpl(temp, cls.AsRegister<Register>());
+      } else {
+        DCHECK(cls.IsStackSlot()) << cls;
+        __ cmpl(temp, Address(ESP, cls.GetStackIndex()));
+      }
+      __ j(kEqual, &done);
+      // Otherwise, jump to the slow path to throw the exception.
+      //
+      // But before, move back the object's class into `temp` before
+      // going into the slow path, as it has been overwritten in the
+      // meantime.
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(
+          instruction, temp_loc, obj_loc, class_offset, maybe_temp2_loc);
+      __ jmp(type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       NearLabel check_non_primitive_component_type;
@@ -1150,6 +1150,11 @@ void CodeGeneratorX86_64::GenerateFrameEntry() {
 
   __ movq(Address(CpuRegister(RSP), kCurrentMethodStackOffset),
           CpuRegister(kMethodRegisterArgument));
+
+  if (GetGraph()->HasShouldDeoptimizeFlag()) {
+    // Initialize should_deoptimize flag to 0.
+    __ movl(Address(CpuRegister(RSP), GetStackOffsetOfShouldDeoptimizeFlag()), Immediate(0));
+  }
 }
 
 void CodeGeneratorX86_64::GenerateFrameExit() {
@@ -1362,7 +1367,9 @@ void InstructionCodeGeneratorX86_64::GenerateCompareTest(HCondition* condition)
     case Primitive::kPrimInt:
     case Primitive::kPrimNot: {
       CpuRegister left_reg = left.AsRegister<CpuRegister>();
-      if (right.IsConstant()) {
+      if (condition->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(condition);
+      } else if (right.IsConstant()) {
         int32_t value = CodeGenerator::GetInt32ValueOf(right.GetConstant());
         if (value == 0) {
           __ testl(left_reg, left_reg);
@@ -1378,7 +1385,9 @@ void InstructionCodeGeneratorX86_64::GenerateCompareTest(HCondition* condition)
     }
     case Primitive::kPrimLong: {
       CpuRegister left_reg = left.AsRegister<CpuRegister>();
-      if (right.IsConstant()) {
+      if (condition->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(condition);
+      } else if (right.IsConstant()) {
         int64_t value = right.GetConstant()->AsLongConstant()->GetValue();
         codegen_->Compare64BitValue(left_reg, value);
       } else if (right.IsDoubleStackSlot()) {
@@ -1540,7 +1549,9 @@ void InstructionCodeGeneratorX86_64::GenerateTestAndBranch(HInstruction* instruc
 
     Location lhs = condition->GetLocations()->InAt(0);
     Location rhs = condition->GetLocations()->InAt(1);
-    if (rhs.IsRegister()) {
+    if (condition->InputAt(1)->IsEmittedAtUseSite()) {
+      GenerateFoldedLoadOperation(condition);
+    } else if (rhs.IsRegister()) {
       __ cmpl(lhs.AsRegister<CpuRegister>(), rhs.AsRegister<CpuRegister>());
     } else if (rhs.IsConstant()) {
       int32_t constant = CodeGenerator::GetInt32ValueOf(rhs.GetConstant());
@@ -1596,6 +1607,17 @@ void InstructionCodeGeneratorX86_64::VisitDeoptimize(HDeoptimize* deoptimize) {
                                /* false_target */ nullptr);
 }
 
+void LocationsBuilderX86_64::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  LocationSummary* locations = new (GetGraph()->GetArena())
+      LocationSummary(flag, LocationSummary::kNoCall);
+  locations->SetOut(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitShouldDeoptimizeFlag(HShouldDeoptimizeFlag* flag) {
+  __ movl(flag->GetLocations()->Out().AsRegister<CpuRegister>(),
+          Address(CpuRegister(RSP), codegen_->GetStackOffsetOfShouldDeoptimizeFlag()));
+}
+
 static bool SelectCanUseCMOV(HSelect* select) {
   // There are no conditional move instructions for XMMs.
   if (Primitive::IsFloatingPointType(select->GetType())) {
@@ -1708,6 +1730,14 @@ void CodeGeneratorX86_64::GenerateNop() {
 void LocationsBuilderX86_64::HandleCondition(HCondition* cond) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(cond, LocationSummary::kNoCall);
+  if (cond->InputAt(1)->IsEmittedAtUseSite()) {
+    // Int or long comparison with a field or array element.
+    locations->SetInAt(0, Location::RequiresRegister());
+    if (!cond->IsEmittedAtUseSite()) {
+      locations->SetOut(Location::RequiresRegister());
+    }
+    return;
+  }
   // Handle the long/FP comparisons made in instruction simplification.
   switch (cond->InputAt(0)->GetType()) {
     case Primitive::kPrimLong:
@@ -1747,7 +1777,9 @@ void InstructionCodeGeneratorX86_64::HandleCondition(HCondition* cond) {
       // Clear output register: setcc only sets the low byte.
       __ xorl(reg, reg);
 
-      if (rhs.IsRegister()) {
+      if (cond->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(cond);
+      } else if (rhs.IsRegister()) {
         __ cmpl(lhs.AsRegister<CpuRegister>(), rhs.AsRegister<CpuRegister>());
       } else if (rhs.IsConstant()) {
         int32_t constant = CodeGenerator::GetInt32ValueOf(rhs.GetConstant());
@@ -1761,7 +1793,9 @@ void InstructionCodeGeneratorX86_64::HandleCondition(HCondition* cond) {
       // Clear output register: setcc only sets the low byte.
       __ xorl(reg, reg);
 
-      if (rhs.IsRegister()) {
+      if (cond->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(cond);
+      } else if (rhs.IsRegister()) {
         __ cmpq(lhs.AsRegister<CpuRegister>(), rhs.AsRegister<CpuRegister>());
       } else if (rhs.IsConstant()) {
         int64_t value = rhs.GetConstant()->AsLongConstant()->GetValue();
@@ -1896,6 +1930,12 @@ void InstructionCodeGeneratorX86_64::VisitAboveOrEqual(HAboveOrEqual* comp) {
 void LocationsBuilderX86_64::VisitCompare(HCompare* compare) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(compare, LocationSummary::kNoCall);
+  if (compare->InputAt(1)->IsEmittedAtUseSite()) {
+    // Int or long comparison with a field or array element.
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister(), Location::kNoOutputOverlap);
+    return;
+  }
   switch (compare->InputAt(0)->GetType()) {
     case Primitive::kPrimBoolean:
     case Primitive::kPrimByte:
@@ -1937,7 +1977,9 @@ void InstructionCodeGeneratorX86_64::VisitCompare(HCompare* compare) {
     case Primitive::kPrimChar:
     case Primitive::kPrimInt: {
       CpuRegister left_reg = left.AsRegister<CpuRegister>();
-      if (right.IsConstant()) {
+      if (compare->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(compare);
+      } else if (right.IsConstant()) {
         int32_t value = right.GetConstant()->AsIntConstant()->GetValue();
         codegen_->Compare32BitValue(left_reg, value);
       } else if (right.IsStackSlot()) {
@@ -1949,7 +1991,9 @@ void InstructionCodeGeneratorX86_64::VisitCompare(HCompare* compare) {
     }
     case Primitive::kPrimLong: {
       CpuRegister left_reg = left.AsRegister<CpuRegister>();
-      if (right.IsConstant()) {
+      if (compare->InputAt(1)->IsEmittedAtUseSite()) {
+        GenerateFoldedLoadOperation(compare);
+      } else if (right.IsConstant()) {
         int64_t value = right.GetConstant()->AsLongConstant()->GetValue();
         codegen_->Compare64BitValue(left_reg, value);
       } else if (right.IsDoubleStackSlot()) {
@@ -2931,6 +2975,12 @@ void InstructionCodeGeneratorX86_64::VisitTypeConversion(HTypeConversion* conver
 void LocationsBuilderX86_64::VisitAdd(HAdd* add) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(add, LocationSummary::kNoCall);
+  if (add->InputAt(1)->IsEmittedAtUseSite()) {
+    // Int or long operation on a field or array element.
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetOut(Location::SameAsFirstInput());
+    return;
+  }
   switch (add->GetResultType()) {
     case Primitive::kPrimInt: {
       locations->SetInAt(0, Location::RequiresRegister());
@@ -2961,6 +3011,11 @@ void LocationsBuilderX86_64::VisitAdd(HAdd* add) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitAdd(HAdd* add) {
+  if (add->InputAt(1)->IsEmittedAtUseSite()) {
+    GenerateFoldedLoadOperation(add);
+    return;
+  }
+
   LocationSummary* locations = add->GetLocations();
   Location first = locations->InAt(0);
   Location second = locations->InAt(1);
@@ -3055,6 +3110,12 @@ void InstructionCodeGeneratorX86_64::VisitAdd(HAdd* add) {
 void LocationsBuilderX86_64::VisitSub(HSub* sub) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(sub, LocationSummary::kNoCall);
+  if (sub->InputAt(1)->IsEmittedAtUseSite()) {
+    // Int or long operation on a field or array element.
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetOut(Location::SameAsFirstInput());
+    return;
+  }
   switch (sub->GetResultType()) {
     case Primitive::kPrimInt: {
       locations->SetInAt(0, Location::RequiresRegister());
@@ -3081,6 +3142,11 @@ void LocationsBuilderX86_64::VisitSub(HSub* sub) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitSub(HSub* sub) {
+  if (sub->InputAt(1)->IsEmittedAtUseSite()) {
+    GenerateFoldedLoadOperation(sub);
+    return;
+  }
+
   LocationSummary* locations = sub->GetLocations();
   Location first = locations->InAt(0);
   Location second = locations->InAt(1);
@@ -3146,6 +3212,12 @@ void InstructionCodeGeneratorX86_64::VisitSub(HSub* sub) {
 void LocationsBuilderX86_64::VisitMul(HMul* mul) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(mul, LocationSummary::kNoCall);
+  if (mul->InputAt(1)->IsEmittedAtUseSite()) {
+    // Int or long operation on a field or array element.
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetOut(Location::SameAsFirstInput());
+    return;
+  }
   switch (mul->GetResultType()) {
     case Primitive::kPrimInt: {
       locations->SetInAt(0, Location::RequiresRegister());
@@ -3184,6 +3256,11 @@ void LocationsBuilderX86_64::VisitMul(HMul* mul) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitMul(HMul* mul) {
+  if (mul->InputAt(1)->IsEmittedAtUseSite()) {
+    GenerateFoldedLoadOperation(mul);
+    return;
+  }
+
   LocationSummary* locations = mul->GetLocations();
   Location first = locations->InAt(0);
   Location second = locations->InAt(1);
@@ -3974,6 +4051,24 @@ void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction)
   }
 }
 
+void LocationsBuilderX86_64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  LocationSummary* locations = codegen_->CreateStringBuilderAppendLocations(instruction);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->SetOut(Location::RegisterLocation(RAX));
+}
+
+void InstructionCodeGeneratorX86_64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  InvokeRuntimeCallingConvention calling_convention;
+  __ movl(CpuRegister(calling_convention.GetRegisterAt(0)),
+          Immediate(instruction->GetFormat()->GetValue()));
+  __ leaq(CpuRegister(calling_convention.GetRegisterAt(1)),
+          Address(CpuRegister(RSP), kX86_64WordSize));
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc(), nullptr);
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t, const uint32_t*>();
+}
+
 void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnMainOnly);
@@ -4141,6 +4236,10 @@ void LocationsBuilderX86_64::HandleFieldGet(HInstruction* instruction) {
                                                        LocationSummary::kCallOnSlowPath :
                                                        LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
+  if (instruction->IsEmittedAtUseSite()) {
+    // The user reads the field.
+    return;
+  }
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
     locations->SetOut(Location::RequiresFpuRegister());
   } else {
@@ -4161,6 +4260,9 @@ void LocationsBuilderX86_64::HandleFieldGet(HInstruction* instruction) {
 void InstructionCodeGeneratorX86_64::HandleFieldGet(HInstruction* instruction,
                                                     const FieldInfo& field_info) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
+  if (instruction->IsEmittedAtUseSite()) {
+    return;
+  }
 
   LocationSummary* locations = instruction->GetLocations();
   Location base_loc = locations->InAt(0);
@@ -4266,8 +4368,7 @@ void LocationsBuilderX86_64::HandleFieldSet(HInstruction* instruction,
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
   Primitive::Type field_type = field_info.GetFieldType();
   bool is_volatile = field_info.IsVolatile();
-  bool needs_write_barrier =
-      CodeGenerator::StoreNeedsWriteBarrier(field_type, instruction->InputAt(1));
+  bool needs_write_barrier = CodeGenerator::FieldSetNeedsWriteBarrier(instruction, field_type);
 
   locations->SetInAt(0, Location::RequiresRegister());
   if (Primitive::IsFloatingPointType(instruction->InputAt(1)->GetType())) {
@@ -4407,7 +4508,7 @@ void InstructionCodeGeneratorX86_64::HandleFieldSet(HInstruction* instruction,
     codegen_->MaybeRecordImplicitNullCheck(instruction);
   }
 
-  if (CodeGenerator::StoreNeedsWriteBarrier(field_type, instruction->InputAt(1))) {
+  if (CodeGenerator::FieldSetNeedsWriteBarrier(instruction, field_type)) {
     CpuRegister temp = locations->GetTemp(0).AsRegister<CpuRegister>();
     CpuRegister card = locations->GetTemp(1).AsRegister<CpuRegister>();
     codegen_->MarkGCCard(temp, card, base, value.AsRegister<CpuRegister>(), value_can_be_null);
@@ -4577,6 +4678,10 @@ void LocationsBuilderX86_64::VisitArrayGet(HArrayGet* instruction) {
                                                        LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(instruction->InputAt(1)));
+  if (instruction->IsEmittedAtUseSite()) {
+    // The user reads the element.
+    return;
+  }
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
     locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
   } else {
@@ -4595,6 +4700,10 @@ void LocationsBuilderX86_64::VisitArrayGet(HArrayGet* instruction) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
+  if (instruction->IsEmittedAtUseSite()) {
+    return;
+  }
+
   LocationSummary* locations = instruction->GetLocations();
   Location obj_loc = locations->InAt(0);
   CpuRegister obj = obj_loc.AsRegister<CpuRegister>();
@@ -4924,9 +5033,11 @@ void InstructionCodeGeneratorX86_64::VisitArraySet(HArraySet* instruction) {
         codegen_->MaybeRecordImplicitNullCheck(instruction);
       }
 
-      CpuRegister card = locations->GetTemp(1).AsRegister<CpuRegister>();
-      codegen_->MarkGCCard(
-          temp, card, array, value.AsRegister<CpuRegister>(), instruction->GetValueCanBeNull());
+      if (instruction->GetNeedsWriteBarrier()) {
+        CpuRegister card = locations->GetTemp(1).AsRegister<CpuRegister>();
+        codegen_->MarkGCCard(
+            temp, card, array, value.AsRegister<CpuRegister>(), instruction->GetValueCanBeNull());
+      }
       __ Bind(&done);
 
       if (slow_path != nullptr) {
@@ -5152,8 +5263,31 @@ void InstructionCodeGeneratorX86_64::VisitSuspendCheck(HSuspendCheck* instructio
   GenerateSuspendCheck(instruction, nullptr);
 }
 
+void InstructionCodeGeneratorX86_64::GenerateImplicitSuspendCheck(HSuspendCheck* instruction,
+                                                                  HBasicBlock* successor) {
+  if (successor != nullptr) {
+    DCHECK(successor->IsLoopHeader());
+    codegen_->ClearSpillSlotsFromLoopPhisInStackMap(instruction);
+  }
+  // The test faults when a suspend trigger is set, see Thread::TriggerSuspend. The fault
+  // handler then calls pTestSuspend, which returns after the test. The sequence must be
+  // exactly the one that SuspensionHandler::Action looks for.
+  CpuRegister temp(TMP);
+  int32_t trigger_offset = Thread::ThreadSuspendTriggerOffset<kX86_64PointerSize>().Int32Value();
+  __ gs()->movq(temp, Address::Absolute(trigger_offset, /* no_rip */ true));
+  __ testl(temp, Address(temp, 0));
+  codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  if (successor != nullptr) {
+    __ jmp(codegen_->GetLabelOf(successor));
+  }
+}
+
 void InstructionCodeGeneratorX86_64::GenerateSuspendCheck(HSuspendCheck* instruction,
                                                           HBasicBlock* successor) {
+  if (codegen_->GetCompilerOptions().GetImplicitSuspendChecks()) {
+    GenerateImplicitSuspendCheck(instruction, successor);
+    return;
+  }
   SuspendCheckSlowPathX86_64* slow_path =
       down_cast<SuspendCheckSlowPathX86_64*>(instruction->GetSlowPath());
   if (slow_path == nullptr) {
@@ -5727,7 +5861,8 @@ static bool TypeCheckNeedsATemporary(TypeCheckKind type_check_kind) {
       (kUseBakerReadBarrier ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck);
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck);
 }
 
 void LocationsBuilderX86_64::VisitInstanceOf(HInstanceOf* instruction) {
@@ -5738,6 +5873,7 @@ void LocationsBuilderX86_64::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind =
           kEmitCompilerReadBarrier ? LocationSummary::kCallOnSlowPath : LocationSummary::kNoCall;
       break;
@@ -5858,6 +5994,30 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ out = out->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, out_loc, display_offset, maybe_temp_loc);
+      if (cls.IsRegister()) {
+        __ cmpl(out, cls.AsRegister<CpuRegister>());
+      } else {
+        DCHECK(cls.IsStackSlot()) << cls;
+        __ cmpl(out, Address(CpuRegister(RSP), cls.GetStackIndex()));
+      }
+      if (zero.IsLinked()) {
+        // The class must be in the superclass display for the instanceof to succeed.
+        __ j(kNotEqual, &zero);
+        __ movl(out, Immediate(1));
+        __ jmp(&done);
+      } else {
+        __ setcc(kEqual, out);
+        // setcc only sets the low byte.
+        __ andl(out, Immediate(1));
+      }
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // Do an exact check.
       NearLabel exact_check;
@@ -5956,6 +6116,7 @@ void LocationsBuilderX86_64::VisitCheckCast(HCheckCast* instruction) {
     case TypeCheckKind::kAbstractClassCheck:
     case TypeCheckKind::kClassHierarchyCheck:
     case TypeCheckKind::kArrayObjectCheck:
+    case TypeCheckKind::kSuperclassDisplayCheck:
       call_kind = (throws_into_catch || kEmitCompilerReadBarrier) ?
           LocationSummary::kCallOnSlowPath :
           LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
@@ -5998,7 +6159,8 @@ void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
       (type_check_kind == TypeCheckKind::kExactCheck ||
        type_check_kind == TypeCheckKind::kAbstractClassCheck ||
        type_check_kind == TypeCheckKind::kClassHierarchyCheck ||
-       type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
+       type_check_kind == TypeCheckKind::kArrayObjectCheck ||
+       type_check_kind == TypeCheckKind::kSuperclassDisplayCheck) &&
       !instruction->CanThrowIntoCatchBlock();
   SlowPathCode* type_check_slow_path =
       new (GetGraph()->GetArena()) TypeCheckSlowPathX86_64(instruction,
@@ -6121,6 +6283,42 @@ void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kSuperclassDisplayCheck: {
+      NearLabel done;
+      // Avoid null check if we know obj is not null.
+      if (instruction->MustDoNullCheck()) {
+        __ testl(obj, obj);
+        __ j(kEqual, &done);
+      }
+
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(
+          instruction, temp_loc, obj_loc, class_offset, maybe_temp2_loc);
+
+      uint32_t display_offset = mirror::Class::SuperclassDisplayEntryOffset(
+          instruction->GetSuperclassDisplayDepth() - 1).Uint32Value();
+      // /* HeapReference<Class> */ temp = temp->superclass_display_[depth - 1]
+      GenerateReferenceLoadOneRegister(instruction, temp_loc, display_offset, maybe_temp2_loc);
+      if (cls.IsRegister()) {
+        __ cmpl(temp, cls.AsRegister<CpuRegister>());
+      } else {
+        DCHECK(cls.IsStackSlot()) << cls;
+        __ cmpl(temp, Address(CpuRegister(RSP), cls.GetStackIndex()));
+      }
+      __ j(kEqual, &done);
+      // Otherwise, jump to the slow path to throw the exception.
+      //
+      // But before, move back the object's class into `temp` before
+      // going into the slow path, as it has been overwritten in the
+      // meantime.
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(
+          instruction, temp_loc, obj_loc, class_offset, maybe_temp2_loc);
+      __ jmp(type_check_slow_path->GetEntryLabel());
+      __ Bind(&done);
+      break;
+    }
+
     case TypeCheckKind::kArrayObjectCheck: {
       // We cannot use a NearLabel here, as its range might be too
       // short in some cases when read barriers are enabled.  This has
@@ -6247,7 +6445,9 @@ void LocationsBuilderX86_64::HandleBitwiseOperation(HBinaryOperation* instructio
   DCHECK(instruction->GetResultType() == Primitive::kPrimInt
          || instruction->GetResultType() == Primitive::kPrimLong);
   locations->SetInAt(0, Location::RequiresRegister());
-  locations->SetInAt(1, Location::Any());
+  if (!instruction->InputAt(1)->IsEmittedAtUseSite()) {
+    locations->SetInAt(1, Location::Any());
+  }
   locations->SetOut(Location::SameAsFirstInput());
 }
 
@@ -6263,7 +6463,70 @@ void InstructionCodeGeneratorX86_64::VisitXor(HXor* instruction) {
   HandleBitwiseOperation(instruction);
 }
 
+void InstructionCodeGeneratorX86_64::GenerateFoldedLoadOperation(HBinaryOperation* operation) {
+  HInstruction* load = operation->InputAt(1);
+  CpuRegister first = operation->GetLocations()->InAt(0).AsRegister<CpuRegister>();
+  Address address = codegen_->FoldedLoadAddress(load);
+  bool is_64_bit = (load->GetType() == Primitive::kPrimLong);
+  DCHECK(!operation->GetLocations()->Out().IsValid() ||
+         operation->IsCompare() ||
+         operation->IsCondition() ||
+         operation->GetLocations()->InAt(0).Equals(operation->GetLocations()->Out()));
+
+  if (operation->IsAdd()) {
+    if (is_64_bit) {
+      __ addq(first, address);
+    } else {
+      __ addl(first, address);
+    }
+  } else if (operation->IsSub()) {
+    if (is_64_bit) {
+      __ subq(first, address);
+    } else {
+      __ subl(first, address);
+    }
+  } else if (operation->IsMul()) {
+    if (is_64_bit) {
+      __ imulq(first, address);
+    } else {
+      __ imull(first, address);
+    }
+  } else if (operation->IsAnd()) {
+    if (is_64_bit) {
+      __ andq(first, address);
+    } else {
+      __ andl(first, address);
+    }
+  } else if (operation->IsOr()) {
+    if (is_64_bit) {
+      __ orq(first, address);
+    } else {
+      __ orl(first, address);
+    }
+  } else if (operation->IsXor()) {
+    if (is_64_bit) {
+      __ xorq(first, address);
+    } else {
+      __ xorl(first, address);
+    }
+  } else {
+    DCHECK(operation->IsCompare() || operation->IsCondition());
+    if (is_64_bit) {
+      __ cmpq(first, address);
+    } else {
+      __ cmpl(first, address);
+    }
+  }
+  // The operation is the access that faults on a null object.
+  codegen_->MaybeRecordImplicitNullCheck(load);
+}
+
 void InstructionCodeGeneratorX86_64::HandleBitwiseOperation(HBinaryOperation* instruction) {
+  if (instruction->InputAt(1)->IsEmittedAtUseSite()) {
+    GenerateFoldedLoadOperation(instruction);
+    return;
+  }
+
   LocationSummary* locations = instruction->GetLocations();
   Location first = locations->InAt(0);
   Location second = locations->InAt(1);
@@ -6743,6 +7006,128 @@ void InstructionCodeGeneratorX86_64::VisitPackedSwitch(HPackedSwitch* switch_ins
   __ jmp(temp_reg);
 }
 
+void LocationsBuilderX86_64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  if (Primitive::IsFloatingPointType(instruction->GetPackedType())) {
+    locations->SetInAt(0, Location::RequiresFpuRegister());
+  } else {
+    locations->SetInAt(0, Location::RequiresRegister());
+  }
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kNoOutputOverlap);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecReplicateScalar(HVecReplicateScalar* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  if (Primitive::IsFloatingPointType(instruction->GetPackedType())) {
+    XmmRegister src = locations->InAt(0).AsFpuRegister<XmmRegister>();
+    if (dst != src) {
+      __ movaps(dst, src);
+    }
+    __ shufps(dst, dst, Immediate(0));
+  } else {
+    __ movd(dst, locations->InAt(0).AsRegister<CpuRegister>(), /* is64bit */ false);
+    __ pshufd(dst, dst, Immediate(0));
+  }
+}
+
+// Address of the first of the kVectorLength elements accessed by a vector load or store.
+static Address VecArrayAddress(LocationSummary* locations, Primitive::Type packed_type) {
+  DCHECK_EQ(Primitive::ComponentSize(packed_type), 4u);
+  uint32_t offset = mirror::Array::DataOffset(Primitive::ComponentSize(packed_type)).Uint32Value();
+  return Address(locations->InAt(0).AsRegister<CpuRegister>(),
+                 locations->InAt(1).AsRegister<CpuRegister>(),
+                 TIMES_4,
+                 offset);
+}
+
+void LocationsBuilderX86_64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecLoad(HVecLoad* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  __ movups(locations->Out().AsFpuRegister<XmmRegister>(),
+            VecArrayAddress(locations, instruction->GetPackedType()));
+}
+
+void LocationsBuilderX86_64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresFpuRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecStore(HVecStore* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  __ movups(VecArrayAddress(locations, instruction->GetPackedType()),
+            locations->InAt(2).AsFpuRegister<XmmRegister>());
+}
+
+void LocationsBuilderX86_64::VisitVecBinaryOperation(HVecBinaryOperation* instruction) {
+  LocationSummary* locations =
+      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetInAt(1, Location::RequiresFpuRegister());
+  // Not SameAsFirstInput: the first input is copied by the instruction itself, as parallel
+  // moves (swaps in particular) only preserve the low 64 bits of a vector value.
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kOutputOverlap);
+}
+
+void InstructionCodeGeneratorX86_64::VisitVecBinaryOperation(HVecBinaryOperation* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  XmmRegister dst = locations->Out().AsFpuRegister<XmmRegister>();
+  XmmRegister rhs = locations->InAt(1).AsFpuRegister<XmmRegister>();
+  bool is_fp = Primitive::IsFloatingPointType(instruction->GetPackedType());
+  __ movaps(dst, locations->InAt(0).AsFpuRegister<XmmRegister>());
+  switch (instruction->GetOpKind()) {
+    case HInstruction::kAdd:
+      if (is_fp) {
+        __ addps(dst, rhs);
+      } else {
+        __ paddd(dst, rhs);
+      }
+      break;
+    case HInstruction::kSub:
+      if (is_fp) {
+        __ subps(dst, rhs);
+      } else {
+        __ psubd(dst, rhs);
+      }
+      break;
+    case HInstruction::kMul:
+      if (is_fp) {
+        __ mulps(dst, rhs);
+      } else {
+        DCHECK(codegen_->GetInstructionSetFeatures().HasSSE4_1());
+        __ pmulld(dst, rhs);
+      }
+      break;
+    case HInstruction::kDiv:
+      DCHECK(is_fp);
+      __ divps(dst, rhs);
+      break;
+    case HInstruction::kAnd:
+      __ andps(dst, rhs);
+      break;
+    case HInstruction::kOr:
+      __ orps(dst, rhs);
+      break;
+    case HInstruction::kXor:
+      __ xorps(dst, rhs);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected vector operation " << instruction->GetOpKind();
+      UNREACHABLE();
+  }
+}
+
 void CodeGeneratorX86_64::Load32BitValue(CpuRegister dest, int32_t value) {
   if (value == 0) {
     __ xorl(dest, dest);
@@ -6808,6 +7193,26 @@ void CodeGeneratorX86_64::Compare64BitValue(CpuRegister dest, int64_t value) {
   }
 }
 
+Address CodeGeneratorX86_64::FoldedLoadAddress(HInstruction* load) {
+  DCHECK(load->IsEmittedAtUseSite());
+  LocationSummary* locations = load->GetLocations();
+  CpuRegister base = locations->InAt(0).AsRegister<CpuRegister>();
+  if (load->IsInstanceFieldGet()) {
+    return Address(base, load->AsInstanceFieldGet()->GetFieldOffset().Uint32Value());
+  }
+  if (load->IsStaticFieldGet()) {
+    return Address(base, load->AsStaticFieldGet()->GetFieldOffset().Uint32Value());
+  }
+  DCHECK(load->IsArrayGet());
+  uint32_t data_offset = CodeGenerator::GetArrayDataOffset(load->AsArrayGet());
+  ScaleFactor scale = (load->GetType() == Primitive::kPrimLong) ? TIMES_8 : TIMES_4;
+  Location index = locations->InAt(1);
+  if (index.IsConstant()) {
+    return Address(base, (index.GetConstant()->AsIntConstant()->GetValue() << scale) + data_offset);
+  }
+  return Address(base, index.AsRegister<CpuRegister>(), scale, data_offset);
+}
+
 void CodeGeneratorX86_64::Store64BitValueToStack(Location dest, int64_t value) {
   DCHECK(dest.IsDoubleStackSlot());
   if (IsInt<32>(value)) {
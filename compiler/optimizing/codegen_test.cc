@@ -437,6 +437,35 @@ TEST_F(CodegenTest, ReturnIf2) {
   TestCode(data, true, 0);
 }
 
+TEST_F(CodegenTest, ReturnIfUnlikelySuccessor) {
+  const uint16_t data[] = TWO_REGISTERS_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::CONST_4 | 1 << 8 | 1 << 12,
+    Instruction::IF_EQ, 3,
+    Instruction::RETURN | 0 << 8,
+    Instruction::RETURN | 1 << 8);
+
+  // The branch is taken. Check the code is correct whether the profile says the
+  // taken or the not taken successor is unlikely, and emitted after the other.
+  for (bool taken_is_unlikely : { true, false }) {
+    for (InstructionSet target_isa : GetTargetISAs()) {
+      ArenaPool pool;
+      ArenaAllocator arena(&pool);
+      HGraph* graph = CreateCFG(&arena, data);
+      RemoveSuspendChecks(graph);
+      auto hook_before_codegen = [taken_is_unlikely](HGraph* graph_in) {
+        for (HBasicBlock* block : graph_in->GetBlocks()) {
+          if (block != nullptr && block->GetLastInstruction()->IsIf()) {
+            block->GetLastInstruction()->AsIf()->SetBranchCounts(taken_is_unlikely ? 0u : 1000u,
+                                                                 taken_is_unlikely ? 1000u : 0u);
+          }
+        }
+      };
+      RunCode(target_isa, graph, hook_before_codegen, true, 1);
+    }
+  }
+}
+
 // Exercise bit-wise (one's complement) not-int instruction.
 #define NOT_INT_TEST(TEST_NAME, INPUT, EXPECTED_OUTPUT) \
 TEST_F(CodegenTest, TEST_NAME) {                        \
@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "constant_propagation.h"
+
+namespace art {
+
+HConstantPropagation::HConstantPropagation(HGraph* graph,
+                                           OptimizingCompilerStats* stats,
+                                           const char* name)
+    : HOptimization(graph, name, stats),
+      values_(graph->GetArena()->Adapter(kArenaAllocConstantPropagation)),
+      executable_blocks_(graph->GetArena(),
+                         /* start_bits */ 0u,
+                         /* expandable */ true,
+                         kArenaAllocConstantPropagation),
+      executable_edges_(std::less<std::pair<uint32_t, uint32_t>>(),
+                        graph->GetArena()->Adapter(kArenaAllocConstantPropagation)),
+      edge_worklist_(graph->GetArena()->Adapter(kArenaAllocConstantPropagation)),
+      instruction_worklist_(graph->GetArena()->Adapter(kArenaAllocConstantPropagation)) {
+}
+
+void HConstantPropagation::Run() {
+  // The passes are created before any of them runs, size the tables for the current graph.
+  values_.assign(graph_->GetCurrentInstructionId(), Value {nullptr, false});
+  executable_blocks_.ClearAllBits();
+  executable_edges_.clear();
+
+  HBasicBlock* entry = graph_->GetEntryBlock();
+  executable_blocks_.SetBit(entry->GetBlockId());
+  for (HInstructionIterator it(entry->GetInstructions()); !it.Done(); it.Advance()) {
+    VisitInstruction(it.Current());
+  }
+  AddSuccessorEdges(entry);
+
+  while (!edge_worklist_.empty() || !instruction_worklist_.empty()) {
+    while (!edge_worklist_.empty()) {
+      std::pair<HBasicBlock*, HBasicBlock*> edge = edge_worklist_.back();
+      edge_worklist_.pop_back();
+      VisitEdge(edge.first, edge.second);
+    }
+    while (!instruction_worklist_.empty()) {
+      HInstruction* instruction = instruction_worklist_.back();
+      instruction_worklist_.pop_back();
+      // The instructions of a block are visited once it becomes executable.
+      if (executable_blocks_.IsBitSet(instruction->GetBlock()->GetBlockId())) {
+        VisitInstruction(instruction);
+      }
+    }
+  }
+
+  ReplaceConstants();
+}
+
+HConstantPropagation::Value HConstantPropagation::GetValue(HInstruction* instruction) const {
+  if (instruction->IsConstant()) {
+    return Value {instruction->AsConstant(), false};
+  }
+  DCHECK_LT(instruction->GetId(), static_cast<int>(values_.size()));
+  return values_[instruction->GetId()];
+}
+
+void HConstantPropagation::SetValue(HInstruction* instruction, Value value) {
+  Value& old_value = values_[instruction->GetId()];
+  if (old_value.is_bottom || (!value.is_bottom && value.constant == old_value.constant)) {
+    return;
+  }
+  // A value only goes down the lattice.
+  DCHECK(old_value.IsTop() || value.is_bottom);
+  old_value = value;
+  for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+    instruction_worklist_.push_back(use.GetUser());
+  }
+}
+
+HConstantPropagation::Value HConstantPropagation::Evaluate(HInstruction* instruction) const {
+  static constexpr Value kTop = {nullptr, false};
+  static constexpr Value kBottom = {nullptr, true};
+  if (instruction->IsConstant()) {
+    return GetValue(instruction);
+  } else if (instruction->IsBinaryOperation()) {
+    Value left = GetValue(instruction->InputAt(0));
+    Value right = GetValue(instruction->InputAt(1));
+    if (left.is_bottom || right.is_bottom) {
+      return kBottom;
+    } else if (left.IsTop() || right.IsTop()) {
+      return kTop;
+    } else if ((instruction->IsDiv() || instruction->IsRem()) &&
+               !Primitive::IsFloatingPointType(instruction->GetType()) &&
+               right.constant->IsArithmeticZero()) {
+      // Never folded, the zero check in front of it throws.
+      return kBottom;
+    }
+    HConstant* constant =
+        instruction->AsBinaryOperation()->TryStaticEvaluation(left.constant, right.constant);
+    return (constant != nullptr) ? Value {constant, false} : kBottom;
+  } else if (instruction->IsUnaryOperation() || instruction->IsTypeConversion()) {
+    Value input = GetValue(instruction->InputAt(0));
+    if (input.is_bottom || input.IsTop()) {
+      return input;
+    }
+    HConstant* constant = instruction->IsUnaryOperation()
+        ? instruction->AsUnaryOperation()->TryStaticEvaluation(input.constant)
+        : instruction->AsTypeConversion()->TryStaticEvaluation(input.constant);
+    return (constant != nullptr) ? Value {constant, false} : kBottom;
+  } else if (instruction->IsSelect()) {
+    HSelect* select = instruction->AsSelect();
+    Value condition = GetValue(select->GetCondition());
+    if (condition.IsTop()) {
+      return kTop;
+    } else if (!condition.is_bottom && condition.constant->IsIntConstant()) {
+      HIntConstant* int_condition = condition.constant->AsIntConstant();
+      if (int_condition->IsTrue()) {
+        return GetValue(select->GetTrueValue());
+      } else if (int_condition->IsFalse()) {
+        return GetValue(select->GetFalseValue());
+      }
+    }
+    Value false_value = GetValue(select->GetFalseValue());
+    Value true_value = GetValue(select->GetTrueValue());
+    if (false_value.IsTop()) {
+      return true_value;
+    } else if (true_value.IsTop() ||
+               (!true_value.is_bottom && true_value.constant == false_value.constant)) {
+      return false_value;
+    }
+    return kBottom;
+  }
+  return kBottom;
+}
+
+HConstantPropagation::Value HConstantPropagation::EvaluatePhi(HPhi* phi) const {
+  if (phi->IsCatchPhi()) {
+    // The inputs of a catch phi are not tied to edges.
+    return Value {nullptr, true};
+  }
+  HBasicBlock* block = phi->GetBlock();
+  Value result = {nullptr, false};
+  for (size_t i = 0, e = phi->InputCount(); i != e; ++i) {
+    if (!IsExecutableEdge(block->GetPredecessors()[i], block)) {
+      continue;
+    }
+    Value input = GetValue(phi->InputAt(i));
+    if (input.is_bottom) {
+      return input;
+    } else if (input.IsTop()) {
+      continue;
+    } else if (result.IsTop()) {
+      result = input;
+    } else if (result.constant != input.constant) {
+      return Value {nullptr, true};
+    }
+  }
+  return result;
+}
+
+bool HConstantPropagation::IsExecutableEdge(HBasicBlock* from, HBasicBlock* to) const {
+  return executable_edges_.find(std::make_pair(from->GetBlockId(), to->GetBlockId())) !=
+      executable_edges_.end();
+}
+
+void HConstantPropagation::AddEdge(HBasicBlock* from, HBasicBlock* to) {
+  if (!IsExecutableEdge(from, to)) {
+    edge_worklist_.push_back(std::make_pair(from, to));
+  }
+}
+
+void HConstantPropagation::AddSuccessorEdges(HBasicBlock* block) {
+  HInstruction* last = block->GetLastInstruction();
+  HInstruction* input = nullptr;
+  if (last->IsIf() || last->IsPackedSwitch()) {
+    input = last->InputAt(0);
+  }
+  Value value = (input != nullptr) ? GetValue(input) : Value {nullptr, true};
+  if (value.IsTop()) {
+    // Wait for the branch input to be evaluated.
+    return;
+  }
+  if (!value.is_bottom && value.constant->IsIntConstant()) {
+    int32_t constant = value.constant->AsIntConstant()->GetValue();
+    if (last->IsIf() && (constant == 0 || constant == 1)) {
+      HIf* if_instruction = last->AsIf();
+      AddEdge(block,
+              (constant == 1) ? if_instruction->IfTrueSuccessor()
+                              : if_instruction->IfFalseSuccessor());
+      return;
+    } else if (last->IsPackedSwitch()) {
+      HPackedSwitch* switch_instruction = last->AsPackedSwitch();
+      // The same modulo 2^32 range check as in HDeadCodeElimination.
+      uint32_t switch_index =
+          static_cast<uint32_t>(constant) -
+          static_cast<uint32_t>(switch_instruction->GetStartValue());
+      AddEdge(block,
+              (switch_index < switch_instruction->GetNumEntries())
+                  ? block->GetSuccessors()[switch_index]
+                  : switch_instruction->GetDefaultBlock());
+      return;
+    }
+  }
+  // This includes the exceptional successors of try boundaries.
+  for (HBasicBlock* successor : block->GetSuccessors()) {
+    AddEdge(block, successor);
+  }
+}
+
+void HConstantPropagation::VisitEdge(HBasicBlock* from, HBasicBlock* to) {
+  if (IsExecutableEdge(from, to)) {
+    return;
+  }
+  executable_edges_.insert(std::make_pair(from->GetBlockId(), to->GetBlockId()));
+  // The phis merge one more input.
+  for (HInstructionIterator it(to->GetPhis()); !it.Done(); it.Advance()) {
+    VisitInstruction(it.Current());
+  }
+  if (!executable_blocks_.IsBitSet(to->GetBlockId())) {
+    executable_blocks_.SetBit(to->GetBlockId());
+    for (HInstructionIterator it(to->GetInstructions()); !it.Done(); it.Advance()) {
+      VisitInstruction(it.Current());
+    }
+    // Branches are visited again when their input changes, the other last instructions are
+    // only visited here.
+    if (!to->GetLastInstruction()->IsIf() && !to->GetLastInstruction()->IsPackedSwitch()) {
+      AddSuccessorEdges(to);
+    }
+  }
+}
+
+void HConstantPropagation::VisitInstruction(HInstruction* instruction) {
+  if (instruction->IsIf() || instruction->IsPackedSwitch()) {
+    AddSuccessorEdges(instruction->GetBlock());
+  } else if (instruction->IsPhi()) {
+    SetValue(instruction, EvaluatePhi(instruction->AsPhi()));
+  } else if (!instruction->IsConstant() && !instruction->IsControlFlow()) {
+    SetValue(instruction, Evaluate(instruction));
+  }
+}
+
+void HConstantPropagation::ReplaceConstants() {
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    if (!executable_blocks_.IsBitSet(block->GetBlockId())) {
+      continue;
+    }
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      HPhi* phi = it.Current()->AsPhi();
+      Value value = GetValue(phi);
+      if (value.constant != nullptr) {
+        phi->ReplaceWith(value.constant);
+        block->RemovePhi(phi);
+        MaybeRecordStat(MethodCompilationStat::kConstantPropagated);
+      }
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction->IsConstant() || instruction->IsControlFlow()) {
+        continue;
+      }
+      Value value = GetValue(instruction);
+      if (value.constant != nullptr) {
+        // Only operations without side effects get a constant value.
+        instruction->ReplaceWith(value.constant);
+        block->RemoveInstruction(instruction);
+        MaybeRecordStat(MethodCompilationStat::kConstantPropagated);
+      }
+    }
+  }
+}
+
+}  // namespace art
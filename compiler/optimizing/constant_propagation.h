@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_CONSTANT_PROPAGATION_H_
+#define ART_COMPILER_OPTIMIZING_CONSTANT_PROPAGATION_H_
+
+#include "base/arena_bit_vector.h"
+#include "base/arena_containers.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+/**
+ * Sparse conditional constant propagation (Wegman and Zadeck). Only the blocks reached
+ * through the branches that are taken for the constants found so far are evaluated, and a
+ * phi merges its inputs from these branches only, so that a constant flowing around a loop
+ * or through a branch on another constant is found, which HConstantFolding cannot do.
+ *
+ * The instructions found constant are replaced with the constant, including the conditions
+ * of the branches never taken, whose blocks HDeadCodeElimination then removes.
+ */
+class HConstantPropagation : public HOptimization {
+ public:
+  HConstantPropagation(HGraph* graph,
+                       OptimizingCompilerStats* stats,
+                       const char* name = kConstantPropagationPassName);
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kConstantPropagationPassName = "constant_propagation";
+
+ private:
+  // Value of an instruction in the lattice: not evaluated yet (top), the constant `constant`,
+  // or not a constant (bottom).
+  struct Value {
+    bool IsTop() const { return !is_bottom && constant == nullptr; }
+
+    HConstant* constant;
+    bool is_bottom;
+  };
+
+  Value GetValue(HInstruction* instruction) const;
+  // Lower the value of `instruction` to `value`, queueing its users if it changed.
+  void SetValue(HInstruction* instruction, Value value);
+  Value Evaluate(HInstruction* instruction) const;
+  Value EvaluatePhi(HPhi* phi) const;
+
+  bool IsExecutableEdge(HBasicBlock* from, HBasicBlock* to) const;
+  void AddEdge(HBasicBlock* from, HBasicBlock* to);
+  // Add the edges to the successors that the last instruction of `block` may branch to.
+  void AddSuccessorEdges(HBasicBlock* block);
+  void VisitEdge(HBasicBlock* from, HBasicBlock* to);
+  void VisitInstruction(HInstruction* instruction);
+
+  // Replace the instructions found to be constant.
+  void ReplaceConstants();
+
+  ArenaVector<Value> values_;
+  ArenaBitVector executable_blocks_;
+  // Executable edges, as the ids of the predecessor and of the successor.
+  ArenaSet<std::pair<uint32_t, uint32_t>> executable_edges_;
+  ArenaVector<std::pair<HBasicBlock*, HBasicBlock*>> edge_worklist_;
+  ArenaVector<HInstruction*> instruction_worklist_;
+
+  DISALLOW_COPY_AND_ASSIGN(HConstantPropagation);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_CONSTANT_PROPAGATION_H_
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "constant_propagation.h"
+#include "dead_code_elimination.h"
+#include "graph_checker.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+namespace art {
+
+/**
+ * Fixture class for the ConstantPropagation tests.
+ */
+class ConstantPropagationTest : public CommonCompilerTest {
+ public:
+  ConstantPropagationTest() : pool_(), allocator_(&pool_) {
+    graph_ = CreateGraph(&allocator_);
+  }
+
+  ~ConstantPropagationTest() { }
+
+  // Builds
+  //   int x = 1;
+  //   for (int i = 0; i < n; i++) { if (x != 1) x = 2; }
+  //   return x;
+  // where x stays 1, which only an optimistic propagation around the loop finds.
+  void BuildGraph() {
+    HBasicBlock* entry = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* preheader = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* header = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* body = new (&allocator_) HBasicBlock(graph_);
+    then_ = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* otherwise = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* merge = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* return_block = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* exit = new (&allocator_) HBasicBlock(graph_);
+
+    graph_->AddBlock(entry);
+    graph_->AddBlock(preheader);
+    graph_->AddBlock(header);
+    graph_->AddBlock(body);
+    graph_->AddBlock(then_);
+    graph_->AddBlock(otherwise);
+    graph_->AddBlock(merge);
+    graph_->AddBlock(return_block);
+    graph_->AddBlock(exit);
+    graph_->SetEntryBlock(entry);
+    graph_->SetExitBlock(exit);
+
+    entry->AddSuccessor(preheader);
+    preheader->AddSuccessor(header);
+    header->AddSuccessor(body);
+    header->AddSuccessor(return_block);
+    body->AddSuccessor(then_);
+    body->AddSuccessor(otherwise);
+    then_->AddSuccessor(merge);
+    otherwise->AddSuccessor(merge);
+    merge->AddSuccessor(header);
+    return_block->AddSuccessor(exit);
+
+    HInstruction* n = new (&allocator_) HParameterValue(
+        graph_->GetDexFile(), 0, 0, Primitive::kPrimInt);
+    entry->AddInstruction(n);
+    entry->AddInstruction(new (&allocator_) HGoto());
+    preheader->AddInstruction(new (&allocator_) HGoto());
+
+    HPhi* i = new (&allocator_) HPhi(&allocator_, 0, 0, Primitive::kPrimInt);
+    x_ = new (&allocator_) HPhi(&allocator_, 1, 0, Primitive::kPrimInt);
+    header->AddPhi(i);
+    header->AddPhi(x_);
+    HSuspendCheck* suspend_check = new (&allocator_) HSuspendCheck();
+    header->AddInstruction(suspend_check);
+    HEnvironment* environment = new (&allocator_) HEnvironment(
+        &allocator_, 1, graph_->GetDexFile(), graph_->GetMethodIdx(), 0, kStatic, suspend_check);
+    suspend_check->SetRawEnvironment(environment);
+    environment->SetRawEnvAt(0, i);
+    i->AddEnvUseAt(environment, 0);
+    HInstruction* loop_condition = new (&allocator_) HLessThan(i, n);
+    header->AddInstruction(loop_condition);
+    header->AddInstruction(new (&allocator_) HIf(loop_condition));
+
+    condition_ = new (&allocator_) HNotEqual(x_, graph_->GetIntConstant(1));
+    body->AddInstruction(condition_);
+    if_ = new (&allocator_) HIf(condition_);
+    body->AddInstruction(if_);
+    then_->AddInstruction(new (&allocator_) HGoto());
+    otherwise->AddInstruction(new (&allocator_) HGoto());
+
+    HPhi* merged_x = new (&allocator_) HPhi(&allocator_, 1, 0, Primitive::kPrimInt);
+    merge->AddPhi(merged_x);
+    HInstruction* increment =
+        new (&allocator_) HAdd(Primitive::kPrimInt, i, graph_->GetIntConstant(1));
+    merge->AddInstruction(increment);
+    merge->AddInstruction(new (&allocator_) HGoto());
+
+    merged_x->AddInput(graph_->GetIntConstant(2));
+    merged_x->AddInput(x_);
+    i->AddInput(graph_->GetIntConstant(0));
+    i->AddInput(increment);
+    x_->AddInput(graph_->GetIntConstant(1));
+    x_->AddInput(merged_x);
+
+    return_ = new (&allocator_) HReturn(x_);
+    return_block->AddInstruction(return_);
+    exit->AddInstruction(new (&allocator_) HExit());
+
+    graph_->BuildDominatorTree();
+  }
+
+  void CheckGraph() {
+    GraphChecker graph_checker(graph_);
+    graph_checker.Run();
+    ASSERT_TRUE(graph_checker.IsValid());
+  }
+
+  // General building fields.
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+
+  HBasicBlock* then_;
+  HPhi* x_;
+  HInstruction* condition_;
+  HIf* if_;
+  HReturn* return_;
+};
+
+//
+// The actual ConstantPropagation tests.
+//
+
+TEST_F(ConstantPropagationTest, ConstantAroundLoop) {
+  BuildGraph();
+  HConstantPropagation(graph_, nullptr).Run();
+  CheckGraph();
+
+  // The phi and the condition are replaced, and the branch is never taken.
+  EXPECT_EQ(return_->InputAt(0), graph_->GetIntConstant(1));
+  EXPECT_EQ(if_->InputAt(0), graph_->GetIntConstant(0));
+  EXPECT_EQ(x_->GetBlock(), nullptr);
+  EXPECT_EQ(condition_->GetBlock(), nullptr);
+
+  HDeadCodeElimination(graph_).Run();
+  CheckGraph();
+  EXPECT_EQ(then_->GetGraph(), nullptr);
+}
+
+TEST_F(ConstantPropagationTest, NotConstantWhenBranchTaken) {
+  BuildGraph();
+  // Start x at 3 instead, so that the branch is taken and x is either 3 or 2.
+  x_->ReplaceInput(graph_->GetIntConstant(3), 0);
+  HConstantPropagation(graph_, nullptr).Run();
+  CheckGraph();
+
+  EXPECT_EQ(return_->InputAt(0), x_);
+  EXPECT_EQ(if_->InputAt(0), condition_);
+}
+
+}  // namespace art
@@ -427,6 +427,8 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
         << array_set->GetValueCanBeNull() << std::noboolalpha;
     StartAttributeStream("needs_type_check") << std::boolalpha
         << array_set->NeedsTypeCheck() << std::noboolalpha;
+    StartAttributeStream("needs_write_barrier") << std::boolalpha
+        << array_set->GetNeedsWriteBarrier() << std::noboolalpha;
   }
 
   void VisitCompare(HCompare* compare) OVERRIDE {
@@ -473,6 +475,8 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
                                                       iset->GetFieldInfo().GetDexFile(),
                                                       /* with type */ false);
     StartAttributeStream("field_type") << iset->GetFieldType();
+    StartAttributeStream("needs_write_barrier") << std::boolalpha
+        << iset->GetNeedsWriteBarrier() << std::noboolalpha;
   }
 
   void VisitUnresolvedInstanceFieldGet(HUnresolvedInstanceFieldGet* field_access) OVERRIDE {
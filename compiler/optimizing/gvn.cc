@@ -124,10 +124,18 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
     return false;
   }
 
-  // Removes all instructions in the set affected by the given side effects.
-  void Kill(SideEffects side_effects) {
-    DeleteAllImpureWhich([side_effects](Node* node) {
-      return node->GetInstruction()->GetSideEffects().MayDependOn(side_effects);
+  // Removes all instructions in the set affected by the side effects of `instruction`.
+  void Kill(HInstruction* instruction) {
+    DeleteAllImpureWhich([instruction](Node* node) {
+      return SideEffectsAnalysis::MayDependOn(node->GetInstruction(), instruction);
+    });
+  }
+
+  // Removes all instructions in the set affected by the side effects of the loop
+  // of `loop_header`.
+  void KillLoopEffects(const SideEffectsAnalysis& side_effects, HBasicBlock* loop_header) {
+    DeleteAllImpureWhich([&side_effects, loop_header](Node* node) {
+      return side_effects.MayDependOnLoop(node->GetInstruction(), loop_header);
     });
   }
 
@@ -465,7 +473,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         } else {
           DCHECK(!block->GetLoopInformation()->IsIrreducible());
           DCHECK_EQ(block->GetDominator(), block->GetLoopInformation()->GetPreHeader());
-          set->Kill(side_effects_.GetLoopEffects(block));
+          set->KillLoopEffects(side_effects_, block);
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
@@ -501,11 +509,11 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         current->ReplaceWith(existing);
         current->GetBlock()->RemoveInstruction(current);
       } else {
-        set->Kill(current->GetSideEffects());
+        set->Kill(current);
         set->Add(current);
       }
     } else {
-      set->Kill(current->GetSideEffects());
+      set->Kill(current);
     }
     current = next;
   }
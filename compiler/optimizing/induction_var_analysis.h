@@ -27,7 +27,7 @@ namespace art {
 /**
  * Induction variable analysis. This class does not have a direct public API.
  * Instead, the results of induction variable analysis can be queried through
- * friend classes, such as InductionVarRange.
+ * friend classes, such as InductionVarRange and HLoopVectorization.
  *
  * The analysis implementation is based on the paper by M. Gerlek et al.
  * "Beyond Induction Variables: Detecting and Classifying Sequences Using a Demand-Driven SSA Form"
@@ -232,6 +232,7 @@ class HInductionVarAnalysis : public HOptimization {
 
   friend class InductionVarAnalysisTest;
   friend class InductionVarRange;
+  friend class HLoopVectorization;
   friend class InductionVarRangeTest;
 
   DISALLOW_COPY_AND_ASSIGN(HInductionVarAnalysis);
@@ -182,6 +182,32 @@ void InductionVarRange::GenerateTakenTest(HInstruction* context,
   }
 }
 
+bool InductionVarRange::GetStride(HInstruction* context,
+                                  HInstruction* instruction,
+                                  /*out*/ int64_t* stride) const {
+  HLoopInformation* loop = nullptr;
+  HInductionVarAnalysis::InductionInfo* info = nullptr;
+  HInductionVarAnalysis::InductionInfo* trip = nullptr;
+  return HasInductionInfo(context, instruction, &loop, &info, &trip) &&
+      info->induction_class == HInductionVarAnalysis::kLinear &&
+      IsConstant(info->op_a, kExact, stride);
+}
+
+bool InductionVarRange::IsFiniteTakenLoop(HLoopInformation* loop,
+                                          /*out*/ int64_t* trip_count) const {
+  HInstruction* control = loop->GetHeader()->GetLastInstruction();
+  HInductionVarAnalysis::InductionInfo* trip = induction_analysis_->LookupInfo(loop, control);
+  if (trip == nullptr ||
+      trip->induction_class != HInductionVarAnalysis::kInvariant ||
+      trip->operation != HInductionVarAnalysis::kTripCountInLoop) {
+    return false;
+  }
+  if (!IsConstant(trip->op_a, kExact, trip_count)) {
+    *trip_count = -1;
+  }
+  return true;
+}
+
 //
 // Private class methods.
 //
@@ -757,8 +783,9 @@ bool InductionVarRange::GenerateCode(HInductionVarAnalysis::InductionInfo* info,
         }
         break;
       case HInductionVarAnalysis::kLinear: {
-        // Linear induction a * i + b, for normalized 0 <= i < TC. Restrict to unit stride only
-        // to avoid arithmetic wrap-around situations that are hard to guard against.
+        // Linear induction a * i + b, for normalized 0 <= i < TC. Restrict to unit stride, or
+        // to the stride of the loop control, to avoid arithmetic wrap-around situations that
+        // are hard to guard against.
         int64_t stride_value = 0;
         if (IsConstant(info->op_a, kExact, &stride_value)) {
           if (stride_value == 1 || stride_value == -1) {
@@ -776,6 +803,34 @@ bool InductionVarRange::GenerateCode(HInductionVarAnalysis::InductionInfo* info,
               }
               return true;
             }
+          } else if (stride_value != 0) {
+            // With the stride of the loop control, TC = N / a, and a * (TC - 1) is bounded by
+            // N - a (or a * TC by N with the one extra in the loop-header), which avoids the
+            // division and a multiplication that could wrap around.
+            const bool is_min_a = stride_value > 0 ? is_min : !is_min;
+            if (is_min_a) {
+              return GenerateCode(info->op_b, trip, graph, block, result, in_body, is_min);
+            }
+            HInductionVarAnalysis::InductionInfo* count = trip->op_a;
+            int64_t trip_stride = 0;
+            if ((in_body || trip->operation == HInductionVarAnalysis::kTripCountInLoop ||
+                    trip->operation == HInductionVarAnalysis::kTripCountInLoopUnsafe) &&
+                count->induction_class == HInductionVarAnalysis::kInvariant &&
+                count->operation == HInductionVarAnalysis::kDiv &&
+                IsConstant(count->op_b, kExact, &trip_stride) &&
+                trip_stride == stride_value &&
+                GenerateCode(count->op_a, trip, graph, block, &opa, in_body, is_min) &&
+                GenerateCode(info->op_b, trip, graph, block, &opb, in_body, is_min)) {
+              if (graph != nullptr) {
+                *result = Insert(block, new (graph->GetArena()) HAdd(type, opa, opb));
+                if (in_body) {
+                  *result = Insert(block,
+                                   new (graph->GetArena())
+                                       HSub(type, *result, graph->GetIntConstant(stride_value)));
+                }
+              }
+              return true;
+            }
           }
         }
         break;
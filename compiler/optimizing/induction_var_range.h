@@ -114,6 +114,19 @@ class InductionVarRange {
                          HBasicBlock* block,
                          /*out*/ HInstruction** taken_test);
 
+  /**
+   * Returns true if the instruction is a linear induction with a constant stride in the loop
+   * of the given context. The stride is returned in parameter stride.
+   */
+  bool GetStride(HInstruction* context, HInstruction* instruction, /*out*/ int64_t* stride) const;
+
+  /**
+   * Returns true if the given loop is known to be entered and to run a finite number of
+   * iterations. The number of iterations is returned in trip_count if it is a known
+   * constant, trip_count is set to -1 otherwise.
+   */
+  bool IsFiniteTakenLoop(HLoopInformation* loop, /*out*/ int64_t* trip_count) const;
+
  private:
   /*
    * Enum used in IsConstant() request.
@@ -616,6 +616,11 @@ TEST_F(InductionVarRangeTest, ConstantTripCountUp) {
   EXPECT_FALSE(needs_finite_test);
   ExpectEqual(Value(1), v1);
   ExpectEqual(Value(1000), v2);
+
+  // Known trip count.
+  int64_t trip_count = 0;
+  EXPECT_TRUE(range_.IsFiniteTakenLoop(condition_->GetBlock()->GetLoopInformation(), &trip_count));
+  EXPECT_EQ(1000, trip_count);
 }
 
 TEST_F(InductionVarRangeTest, ConstantTripCountDown) {
@@ -650,6 +655,10 @@ TEST_F(InductionVarRangeTest, SymbolicTripCountUp) {
   bool needs_finite_test = true;
   bool needs_taken_test = true;
 
+  // Loop may not be taken.
+  int64_t trip_count = 0;
+  EXPECT_FALSE(range_.IsFiniteTakenLoop(condition_->GetBlock()->GetLoopInformation(), &trip_count));
+
   // In context of header: upper unknown.
   range_.GetInductionRange(condition_, condition_->InputAt(0), x_, &v1, &v2, &needs_finite_test);
   EXPECT_FALSE(needs_finite_test);
@@ -781,4 +790,56 @@ TEST_F(InductionVarRangeTest, SymbolicTripCountDown) {
   EXPECT_TRUE(taken->InputAt(1)->IsParameterValue());
 }
 
+TEST_F(InductionVarRangeTest, SymbolicTripCountUpStride) {
+  BuildLoop(0, x_, 2);
+  PerformInductionVarAnalysis();
+
+  bool needs_finite_test = false;
+  bool needs_taken_test = false;
+
+  HInstruction* lower = nullptr;
+  HInstruction* upper = nullptr;
+
+  // Can generate code in context of loop-body only, protected by both tests.
+  EXPECT_FALSE(range_.CanGenerateCode(
+      condition_, condition_->InputAt(0), &needs_finite_test, &needs_taken_test));
+  ASSERT_TRUE(range_.CanGenerateCode(
+      increment_, condition_->InputAt(0), &needs_finite_test, &needs_taken_test));
+  EXPECT_TRUE(needs_finite_test);
+  EXPECT_TRUE(needs_taken_test);
+
+  // Stride is the stride of the loop control.
+  int64_t stride = 0;
+  ASSERT_TRUE(range_.GetStride(increment_, condition_->InputAt(0), &stride));
+  EXPECT_EQ(2, stride);
+
+  // Generates code.
+  range_.GenerateRangeCode(
+      increment_, condition_->InputAt(0), graph_, loop_preheader_, &lower, &upper);
+
+  // Verify lower is 0.
+  ASSERT_TRUE(lower != nullptr);
+  ASSERT_TRUE(lower->IsIntConstant());
+  EXPECT_EQ(0, lower->AsIntConstant()->GetValue());
+
+  // Verify upper is (((V-1)+2)+0)-2, without the division of the trip-count.
+  ASSERT_TRUE(upper != nullptr);
+  ASSERT_TRUE(upper->IsSub());
+  ASSERT_TRUE(upper->InputAt(1)->IsIntConstant());
+  EXPECT_EQ(2, upper->InputAt(1)->AsIntConstant()->GetValue());
+  upper = upper->InputAt(0);
+  ASSERT_TRUE(upper->IsAdd());
+  ASSERT_TRUE(upper->InputAt(1)->IsIntConstant());
+  EXPECT_EQ(0, upper->InputAt(1)->AsIntConstant()->GetValue());
+  upper = upper->InputAt(0);
+  ASSERT_TRUE(upper->IsAdd());
+  ASSERT_TRUE(upper->InputAt(1)->IsIntConstant());
+  EXPECT_EQ(2, upper->InputAt(1)->AsIntConstant()->GetValue());
+  upper = upper->InputAt(0);
+  ASSERT_TRUE(upper->IsSub());
+  EXPECT_TRUE(upper->InputAt(0)->IsParameterValue());
+  ASSERT_TRUE(upper->InputAt(1)->IsIntConstant());
+  EXPECT_EQ(1, upper->InputAt(1)->AsIntConstant()->GetValue());
+}
+
 }  // namespace art
@@ -27,6 +27,7 @@
 #include "driver/compiler_driver-inl.h"
 #include "driver/compiler_options.h"
 #include "driver/dex_compilation_unit.h"
+#include "imtable.h"
 #include "instruction_simplifier.h"
 #include "intrinsics.h"
 #include "jit/jit.h"
@@ -48,6 +49,15 @@ namespace art {
 
 static constexpr size_t kMaximumNumberOfHInstructions = 32;
 
+// Instruction budgets of call sites known to be hot or cold, from the JIT inline caches
+// or from the AOT profile.
+static constexpr size_t kMaximumNumberOfHInstructionsForHotCallSite = 64;
+static constexpr size_t kMaximumNumberOfHInstructionsForColdCallSite = 16;
+
+// Limit the number of instructions that inlining adds to a compilation unit, so that the
+// larger budgets of hot call sites do not make the code grow without bound.
+static constexpr size_t kMaximumNumberOfTotalInlinedInstructions = 1024;
+
 // Limit the number of dex registers that we accumulate while inlining
 // to avoid creating large amount of nested environments.
 static constexpr size_t kMaximumNumberOfCumulatedDexRegisters = 64;
@@ -55,6 +65,11 @@ static constexpr size_t kMaximumNumberOfCumulatedDexRegisters = 64;
 // Avoid inlining within a huge method due to memory pressure.
 static constexpr size_t kMaximumCodeUnitSize = 4096;
 
+// At a megamorphic call site, inline at most that many receivers, and only those
+// accounting for at least that percentage of the calls recorded in the inline cache.
+static constexpr size_t kMaximumNumberOfMegamorphicTargets = 2;
+static constexpr uint32_t kMinimumMegamorphicTargetPercent = 30;
+
 void HInliner::Run() {
   const CompilerOptions& compiler_options = compiler_driver_->GetCompilerOptions();
   if ((compiler_options.GetInlineDepthLimit() == 0)
@@ -311,6 +326,10 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
 
   DCHECK(!invoke_instruction->IsInvokeStaticOrDirect());
 
+  if (TryInlineSingleImplementation(invoke_instruction, resolved_method)) {
+    return true;
+  }
+
   // Check if we can use an inline cache.
   ArtMethod* caller = graph_->GetArtMethod();
   if (Runtime::Current()->UseJitCompilation()) {
@@ -327,22 +346,29 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
         return false;
       } else if (ic.IsMonomorphic()) {
         MaybeRecordStat(kMonomorphicCall);
-        if (outermost_graph_->IsCompilingOsr()) {
+        if (!outermost_graph_->AllowsSpeculativeDeoptimization()) {
           // If we are compiling OSR, we pretend this call is polymorphic, as we may come from the
-          // interpreter and it may have seen different receiver types.
-          return TryInlinePolymorphicCall(invoke_instruction, resolved_method, ic);
+          // interpreter and it may have seen different receiver types. The same goes for methods
+          // that deoptimized too often: keep the invoke as a fallback.
+          return TryInlinePolymorphicCall(invoke_instruction, resolved_method, ic) ||
+              TryDevirtualizeImtConflictCall(invoke_instruction, resolved_method, ic);
         } else {
-          return TryInlineMonomorphicCall(invoke_instruction, resolved_method, ic);
+          return TryInlineMonomorphicCall(invoke_instruction, resolved_method, ic) ||
+              TryDevirtualizeImtConflictCall(invoke_instruction, resolved_method, ic);
         }
       } else if (ic.IsPolymorphic()) {
         MaybeRecordStat(kPolymorphicCall);
-        return TryInlinePolymorphicCall(invoke_instruction, resolved_method, ic);
+        return TryInlinePolymorphicCall(invoke_instruction, resolved_method, ic) ||
+            TryDevirtualizeImtConflictCall(invoke_instruction, resolved_method, ic);
       } else {
         DCHECK(ic.IsMegamorphic());
+        MaybeRecordStat(kMegamorphicCall);
+        if (TryInlineMegamorphicCall(invoke_instruction, resolved_method, ic)) {
+          return true;
+        }
         VLOG(compiler) << "Interface or virtual call to "
                        << PrettyMethod(method_index, caller_dex_file)
                        << " is megamorphic and not inlined";
-        MaybeRecordStat(kMegamorphicCall);
         return false;
       }
     }
@@ -432,6 +458,46 @@ bool HInliner::TryInlineMonomorphicCall(HInvoke* invoke_instruction,
   return true;
 }
 
+bool HInliner::TryInlineSingleImplementation(HInvoke* invoke_instruction,
+                                             ArtMethod* resolved_method) {
+  // Only JIT compiled code is invalidated when a class overriding the method is loaded. The
+  // guard is an HDeoptimize, which OSR code cannot take.
+  if (!Runtime::Current()->UseJitCompilation() ||
+      !outermost_graph_->AllowsSpeculativeDeoptimization() ||
+      !invoke_instruction->IsInvokeVirtual() ||
+      resolved_method->IsAbstract() ||
+      !resolved_method->HasSingleImplementation()) {
+    return false;
+  }
+
+  HInstruction* cursor = invoke_instruction->GetPrevious();
+  HBasicBlock* bb_cursor = invoke_instruction->GetBlock();
+  if (!TryInlineAndReplace(invoke_instruction, resolved_method, /* do_rtp */ true)) {
+    return false;
+  }
+
+  // We successfully inlined, now add a guard: the frame is flagged by the runtime when
+  // a class overriding `resolved_method` gets loaded.
+  ArenaAllocator* arena = graph_->GetArena();
+  HShouldDeoptimizeFlag* deopt_flag =
+      new (arena) HShouldDeoptimizeFlag(invoke_instruction->GetDexPc());
+  HNotEqual* compare = new (arena) HNotEqual(deopt_flag, graph_->GetIntConstant(0));
+  HDeoptimize* deoptimize = new (arena) HDeoptimize(compare, invoke_instruction->GetDexPc());
+  if (cursor != nullptr) {
+    bb_cursor->InsertInstructionAfter(deopt_flag, cursor);
+  } else {
+    bb_cursor->InsertInstructionBefore(deopt_flag, bb_cursor->GetFirstInstruction());
+  }
+  bb_cursor->InsertInstructionAfter(compare, deopt_flag);
+  bb_cursor->InsertInstructionAfter(deoptimize, compare);
+  deoptimize->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+
+  outermost_graph_->SetHasShouldDeoptimizeFlag();
+  outermost_graph_->AddCHASingleImplementationDependency(resolved_method);
+  MaybeRecordStat(kCHAInline);
+  return true;
+}
+
 HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
                                      HInstruction* cursor,
                                      HBasicBlock* bb_cursor,
@@ -522,7 +588,7 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
           (i != InlineCache::kIndividualCacheSize - 1) &&
           (ic.GetTypeAt(i + 1) == nullptr);
 
-      if (outermost_graph_->IsCompilingOsr()) {
+      if (!outermost_graph_->AllowsSpeculativeDeoptimization()) {
         // We do not support HDeoptimize in OSR methods.
         deoptimize = false;
       }
@@ -559,6 +625,178 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
   return true;
 }
 
+bool HInliner::TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                        ArtMethod* resolved_method,
+                                        const InlineCache& ic) {
+  DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
+      << invoke_instruction->DebugName();
+
+  // Take a snapshot of the inline cache, the interpreter keeps updating it.
+  mirror::Class* types[InlineCache::kIndividualCacheSize];
+  uint32_t counts[InlineCache::kIndividualCacheSize];
+  uint32_t total_count = ic.GetMegamorphicCount();
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    types[i] = ic.GetTypeAt(i);
+    counts[i] = (types[i] == nullptr) ? 0u : ic.GetCountAt(i);
+    total_count += counts[i];
+  }
+  if (total_count == 0) {
+    return false;
+  }
+
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
+  PointerSize pointer_size = class_linker->GetImagePointerSize();
+  const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
+
+  bool one_target_inlined = false;
+  for (size_t target = 0; target < kMaximumNumberOfMegamorphicTargets; ++target) {
+    // Pick the most frequent receiver not tried yet.
+    size_t best = 0;
+    for (size_t i = 1; i < InlineCache::kIndividualCacheSize; ++i) {
+      if (counts[i] > counts[best]) {
+        best = i;
+      }
+    }
+    if (counts[best] == 0 ||
+        counts[best] * 100u < total_count * kMinimumMegamorphicTargetPercent) {
+      break;
+    }
+    counts[best] = 0;
+    mirror::Class* type = types[best];
+
+    ArtMethod* method = nullptr;
+    if (invoke_instruction->IsInvokeInterface()) {
+      method = type->FindVirtualMethodForInterface(resolved_method, pointer_size);
+    } else {
+      DCHECK(invoke_instruction->IsInvokeVirtual());
+      method = type->FindVirtualMethodForVirtual(resolved_method, pointer_size);
+    }
+
+    HInstruction* receiver = invoke_instruction->InputAt(0);
+    HInstruction* cursor = invoke_instruction->GetPrevious();
+    HBasicBlock* bb_cursor = invoke_instruction->GetBlock();
+
+    uint32_t class_index = FindClassIndexIn(
+        type, caller_dex_file, caller_compilation_unit_.GetDexCache());
+    HInstruction* return_replacement = nullptr;
+    if (class_index == DexFile::kDexNoIndex ||
+        !TryBuildAndInline(invoke_instruction, method, &return_replacement)) {
+      continue;
+    }
+    one_target_inlined = true;
+    bool is_referrer = (type == outermost_graph_->GetArtMethod()->GetDeclaringClass());
+    // Other receivers are expected, so never deoptimize: they take the original invoke.
+    HInstruction* compare = AddTypeGuard(receiver,
+                                         cursor,
+                                         bb_cursor,
+                                         class_index,
+                                         is_referrer,
+                                         invoke_instruction,
+                                         /* with_deoptimization */ false);
+    CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke_instruction);
+  }
+
+  if (!one_target_inlined) {
+    return false;
+  }
+  MaybeRecordStat(kInlinedMegamorphicCall);
+
+  // Run type propagation to get the guards typed.
+  ReferenceTypePropagation rtp_fixup(graph_,
+                                     outer_compilation_unit_.GetDexCache(),
+                                     handles_,
+                                     /* is_first_run */ false);
+  rtp_fixup.Run();
+  return true;
+}
+
+// Returns whether an interface call through the IMT of `klass` goes to the conflict trampoline,
+// which searches the conflict table of the slot on each call.
+static bool IsImtConflict(mirror::Class* klass, HInvokeInterface* invoke, PointerSize pointer_size)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  if (!klass->ShouldHaveImt()) {
+    return false;
+  }
+  return klass->GetImt(pointer_size)->Get(invoke->GetImtIndex(), pointer_size)->IsRuntimeMethod();
+}
+
+bool HInliner::TryDevirtualizeImtConflictCall(HInvoke* invoke_instruction,
+                                              ArtMethod* resolved_method,
+                                              const InlineCache& ic) {
+  if (!invoke_instruction->IsInvokeInterface()) {
+    return false;
+  }
+  HInvokeInterface* invoke = invoke_instruction->AsInvokeInterface();
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
+  PointerSize pointer_size = class_linker->GetImagePointerSize();
+  const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
+  ArenaAllocator* arena = graph_->GetArena();
+
+  bool one_target_devirtualized = false;
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    mirror::Class* type = ic.GetTypeAt(i);
+    if (type == nullptr) {
+      break;
+    }
+    if (!IsImtConflict(type, invoke, pointer_size)) {
+      continue;
+    }
+    ArtMethod* method = type->FindVirtualMethodForInterface(resolved_method, pointer_size);
+    uint32_t class_index = FindClassIndexIn(
+        type, caller_dex_file, caller_compilation_unit_.GetDexCache());
+    if (method == nullptr || !method->IsInvokable() || class_index == DexFile::kDexNoIndex) {
+      continue;
+    }
+
+    HInstruction* receiver = invoke->InputAt(0);
+    HInstruction* cursor = invoke->GetPrevious();
+    HBasicBlock* bb_cursor = invoke->GetBlock();
+    bool is_referrer = (type == outermost_graph_->GetArtMethod()->GetDeclaringClass());
+    // Other receivers take the original invoke, they may not even have a conflict.
+    HInstruction* compare = AddTypeGuard(receiver,
+                                         cursor,
+                                         bb_cursor,
+                                         class_index,
+                                         is_referrer,
+                                         invoke,
+                                         /* with_deoptimization */ false);
+
+    // Once the receiver class is known, the target is at the same vtable index for all its
+    // instances, and a virtual call does not need the conflict table.
+    HInvokeVirtual* virtual_invoke = new (arena) HInvokeVirtual(arena,
+                                                                invoke->GetNumberOfArguments(),
+                                                                invoke->GetType(),
+                                                                invoke->GetDexPc(),
+                                                                invoke->GetDexMethodIndex(),
+                                                                method->GetMethodIndex());
+    for (size_t arg = 0; arg != invoke->GetNumberOfArguments(); ++arg) {
+      virtual_invoke->SetArgumentAt(arg, invoke->InputAt(arg));
+    }
+    bb_cursor->InsertInstructionAfter(virtual_invoke, compare);
+    virtual_invoke->CopyEnvironmentFrom(invoke->GetEnvironment());
+    if (invoke->GetType() == Primitive::kPrimNot) {
+      virtual_invoke->SetReferenceTypeInfo(invoke->GetReferenceTypeInfo());
+    }
+    HInstruction* return_replacement =
+        (invoke->GetType() == Primitive::kPrimVoid) ? nullptr : virtual_invoke;
+    CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke);
+    one_target_devirtualized = true;
+  }
+
+  if (!one_target_devirtualized) {
+    return false;
+  }
+  MaybeRecordStat(kDevirtualizedImtConflictCall);
+
+  // Run type propagation to get the guards typed.
+  ReferenceTypePropagation rtp_fixup(graph_,
+                                     outer_compilation_unit_.GetDexCache(),
+                                     handles_,
+                                     /* is_first_run */ false);
+  rtp_fixup.Run();
+  return true;
+}
+
 void HInliner::CreateDiamondPatternForPolymorphicInline(HInstruction* compare,
                                                         HInstruction* return_replacement,
                                                         HInstruction* invoke_instruction) {
@@ -726,7 +964,7 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
   bb_cursor->InsertInstructionAfter(class_table_get, receiver_class);
   bb_cursor->InsertInstructionAfter(compare, class_table_get);
 
-  if (outermost_graph_->IsCompilingOsr()) {
+  if (!outermost_graph_->AllowsSpeculativeDeoptimization()) {
     CreateDiamondPatternForPolymorphicInline(compare, return_replacement, invoke_instruction);
   } else {
     // TODO: Extend reference type propagation to understand the guard.
@@ -815,6 +1053,14 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
     return false;
   }
 
+  // The JIT would discard code inlining a method deoptimized with its inlining callers.
+  if (Runtime::Current()->UseJitCompilation() &&
+      Runtime::Current()->GetInstrumentation()->IsDeoptimized(method)) {
+    VLOG(compiler) << "Method " << PrettyMethod(method)
+                   << " is not inlined because it is deoptimized";
+    return false;
+  }
+
   // Check whether we're allowed to inline. The outermost compilation unit is the relevant
   // dex file here (though the transitivity of an inline chain would allow checking the calller).
   if (!compiler_driver_->MayInline(method->GetDexFile(),
@@ -1206,7 +1452,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
                              /* is_first_run */ false).Run();
   }
 
-  size_t number_of_instructions_budget = kMaximumNumberOfHInstructions;
+  size_t number_of_instructions_budget = GetInstructionBudget(invoke_instruction, resolved_method);
   size_t number_of_inlined_instructions =
       RunOptimizations(callee_graph, code_item, dex_compilation_unit);
   number_of_instructions_budget += number_of_inlined_instructions;
@@ -1241,6 +1487,11 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
   bool can_inline_environment =
       total_number_of_dex_registers_ < kMaximumNumberOfCumulatedDexRegisters;
 
+  // The inline info can refer to another dex file of the oat file being compiled,
+  // which shares the class loader of the outer method.
+  bool can_encode_environment =
+      same_dex_file || codegen_->CanEncodeInlinedDexFile(callee_dex_file);
+
   for (; !it.Done(); it.Advance()) {
     HBasicBlock* block = it.Current();
 
@@ -1269,10 +1520,10 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
         return false;
       }
 
-      if (!same_dex_file && current->NeedsEnvironment()) {
+      if (!can_encode_environment && current->NeedsEnvironment()) {
         VLOG(compiler) << "Method " << PrettyMethod(method_index, callee_dex_file)
                        << " could not be inlined because " << current->DebugName()
-                       << " needs an environment and is in a different dex file";
+                       << " needs an environment and is in a dex file of another oat file";
         return false;
       }
 
@@ -1313,6 +1564,13 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
       }
     }
   }
+  if (total_number_of_inlined_instructions_ + number_of_inlined_instructions_ +
+          number_of_instructions > kMaximumNumberOfTotalInlinedInstructions) {
+    VLOG(compiler) << "Method " << PrettyMethod(method_index, callee_dex_file)
+                   << " is not inlined because the compilation unit has reached"
+                   << " its code growth limit.";
+    return false;
+  }
   number_of_inlined_instructions_ += number_of_instructions;
 
   DCHECK_EQ(caller_instruction_counter, graph_->GetCurrentInstructionId())
@@ -1328,6 +1586,42 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
   return true;
 }
 
+size_t HInliner::GetInstructionBudget(HInvoke* invoke_instruction, ArtMethod* resolved_method) {
+  if (Runtime::Current()->UseJitCompilation()) {
+    // The caller is hot, as it is being compiled. Whether the call site is hot too is only
+    // known for virtual and interface calls, from the receiver counts of their inline cache.
+    ArtMethod* caller = graph_->GetArtMethod();
+    DCHECK(caller != nullptr);
+    ScopedProfilingInfoInlineUse spiis(caller, Thread::Current());
+    ProfilingInfo* profiling_info = spiis.GetProfilingInfo();
+    if (profiling_info == nullptr) {
+      return kMaximumNumberOfHInstructions;
+    }
+    const InlineCache* ic = profiling_info->GetInlineCache(invoke_instruction->GetDexPc());
+    if (ic == nullptr) {
+      return kMaximumNumberOfHInstructions;
+    }
+    size_t count = ic->GetMegamorphicCount();
+    for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+      count += ic->GetCountAt(i);
+    }
+    return (count >= Runtime::Current()->GetJit()->WarmMethodThreshold())
+        ? kMaximumNumberOfHInstructionsForHotCallSite
+        : kMaximumNumberOfHInstructions;
+  }
+
+  // When compiling ahead of time with a profile, the methods that are not in the profile
+  // have not been seen executing often.
+  const ProfileCompilationInfo* profile = compiler_driver_->GetProfileCompilationInfo();
+  if (profile != nullptr) {
+    MethodReference callee(resolved_method->GetDexFile(), resolved_method->GetDexMethodIndex());
+    return profile->ContainsMethod(callee)
+        ? kMaximumNumberOfHInstructionsForHotCallSite
+        : kMaximumNumberOfHInstructionsForColdCallSite;
+  }
+  return kMaximumNumberOfHInstructions;
+}
+
 size_t HInliner::RunOptimizations(HGraph* callee_graph,
                                   const DexFile::CodeItem* code_item,
                                   const DexCompilationUnit& dex_compilation_unit) {
@@ -1363,6 +1657,7 @@ size_t HInliner::RunOptimizations(HGraph* callee_graph,
                      handles_,
                      stats_,
                      total_number_of_dex_registers_ + code_item->registers_size_,
+                     total_number_of_inlined_instructions_ + number_of_inlined_instructions_,
                      depth_ + 1);
     inliner.Run();
     number_of_inlined_instructions += inliner.number_of_inlined_instructions_;
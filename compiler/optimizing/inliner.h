@@ -41,6 +41,7 @@ class HInliner : public HOptimization {
            StackHandleScopeCollection* handles,
            OptimizingCompilerStats* stats,
            size_t total_number_of_dex_registers,
+           size_t total_number_of_inlined_instructions,
            size_t depth)
       : HOptimization(outer_graph, kInlinerPassName, stats),
         outermost_graph_(outermost_graph),
@@ -49,6 +50,7 @@ class HInliner : public HOptimization {
         codegen_(codegen),
         compiler_driver_(compiler_driver),
         total_number_of_dex_registers_(total_number_of_dex_registers),
+        total_number_of_inlined_instructions_(total_number_of_inlined_instructions),
         depth_(depth),
         number_of_inlined_instructions_(0),
         handles_(handles) {}
@@ -76,6 +78,11 @@ class HInliner : public HOptimization {
                                bool same_dex_file,
                                HInstruction** return_replacement);
 
+  // Maximum number of instructions of `resolved_method` inlined in place of
+  // `invoke_instruction`, larger for hot call sites and smaller for cold ones.
+  size_t GetInstructionBudget(HInvoke* invoke_instruction, ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Run simple optimizations on `callee_graph`.
   // Returns the number of inlined instructions.
   size_t RunOptimizations(HGraph* callee_graph,
@@ -107,12 +114,35 @@ class HInliner : public HOptimization {
                                 const InlineCache& ic)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Try to inline the single implementation of a virtual method, as found by the class
+  // hierarchy analysis. If successful, the code in the graph will look like:
+  // if (should_deoptimize_flag != 0) deopt
+  // ... // inlined code
+  bool TryInlineSingleImplementation(HInvoke* invoke_instruction, ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Try to inline targets of a polymorphic call.
   bool TryInlinePolymorphicCall(HInvoke* invoke_instruction,
                                 ArtMethod* resolved_method,
                                 const InlineCache& ic)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Try to inline the most frequent targets of a megamorphic call, each behind a type guard,
+  // keeping the original invoke for the other receivers.
+  bool TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                ArtMethod* resolved_method,
+                                const InlineCache& ic)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Try to call the targets of an interface call whose IMT slot conflicts in the receiver
+  // classes of the inline cache with virtual calls, each behind a type guard, keeping the
+  // original invoke for the other receivers. Used when the targets could not be inlined, to
+  // skip the search of the conflict table.
+  bool TryDevirtualizeImtConflictCall(HInvoke* invoke_instruction,
+                                      ArtMethod* resolved_method,
+                                      const InlineCache& ic)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
   bool TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
                                             ArtMethod* resolved_method,
                                             const InlineCache& ic)
@@ -195,6 +225,8 @@ class HInliner : public HOptimization {
   CodeGenerator* const codegen_;
   CompilerDriver* const compiler_driver_;
   const size_t total_number_of_dex_registers_;
+  // Instructions inlined in the outermost graph before this inliner started.
+  const size_t total_number_of_inlined_instructions_;
   const size_t depth_;
   size_t number_of_inlined_instructions_;
   StackHandleScopeCollection* const handles_;
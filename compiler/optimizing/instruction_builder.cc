@@ -21,6 +21,7 @@
 #include "class_linker.h"
 #include "dex_instruction-inl.h"
 #include "driver/compiler_options.h"
+#include "jit/profiling_info.h"
 #include "scoped_thread_state_change.h"
 
 namespace art {
@@ -266,6 +267,13 @@ bool HInstructionBuilder::Build() {
   // Find locations where we want to generate extra stackmaps for native debugging.
   // This allows us to generate the info only at interesting points (for example,
   // at start of java statement) rather than before every dex instruction.
+  // The JIT code cache keeps the profiling info of the method alive while it is compiled.
+  if (graph_->GetArtMethod() != nullptr &&
+      dex_compilation_unit_ == outer_compilation_unit_ &&
+      Runtime::Current()->UseJitCompilation()) {
+    profiling_info_ = graph_->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+  }
+
   const bool native_debuggable = compiler_driver_ != nullptr &&
                                  compiler_driver_->GetCompilerOptions().GetNativeDebuggable();
   ArenaBitVector* native_debug_info_locations = nullptr;
@@ -472,13 +480,25 @@ void HInstructionBuilder::InitializeParameters() {
   }
 }
 
+void HInstructionBuilder::BuildIf(HInstruction* condition, uint32_t dex_pc) {
+  HIf* if_instruction = new (arena_) HIf(condition, dex_pc);
+  if (profiling_info_ != nullptr) {
+    const BranchCache* cache = profiling_info_->GetBranchCache(dex_pc);
+    if (cache != nullptr) {
+      // The true successor is the branch target.
+      if_instruction->SetBranchCounts(cache->GetTakenCount(), cache->GetNotTakenCount());
+    }
+  }
+  AppendInstruction(if_instruction);
+}
+
 template<typename T>
 void HInstructionBuilder::If_22t(const Instruction& instruction, uint32_t dex_pc) {
   HInstruction* first = LoadLocal(instruction.VRegA(), Primitive::kPrimInt);
   HInstruction* second = LoadLocal(instruction.VRegB(), Primitive::kPrimInt);
   T* comparison = new (arena_) T(first, second, dex_pc);
   AppendInstruction(comparison);
-  AppendInstruction(new (arena_) HIf(comparison, dex_pc));
+  BuildIf(comparison, dex_pc);
   current_block_ = nullptr;
 }
 
@@ -487,7 +507,7 @@ void HInstructionBuilder::If_21t(const Instruction& instruction, uint32_t dex_pc
   HInstruction* value = LoadLocal(instruction.VRegA(), Primitive::kPrimInt);
   T* comparison = new (arena_) T(value, graph_->GetIntConstant(0, dex_pc), dex_pc);
   AppendInstruction(comparison);
-  AppendInstruction(new (arena_) HIf(comparison, dex_pc));
+  BuildIf(comparison, dex_pc);
   current_block_ = nullptr;
 }
 
@@ -1606,8 +1626,10 @@ void HInstructionBuilder::BuildFillWideArrayData(HInstruction* object,
   }
 }
 
-static TypeCheckKind ComputeTypeCheckKind(Handle<mirror::Class> cls)
+static TypeCheckKind ComputeTypeCheckKind(Handle<mirror::Class> cls,
+                                          uint32_t* superclass_display_depth)
     SHARED_REQUIRES(Locks::mutator_lock_) {
+  *superclass_display_depth = 0u;
   if (cls.Get() == nullptr) {
     return TypeCheckKind::kUnresolvedCheck;
   } else if (cls->IsInterface()) {
@@ -1622,6 +1644,13 @@ static TypeCheckKind ComputeTypeCheckKind(Handle<mirror::Class> cls)
     }
   } else if (cls->IsFinal()) {
     return TypeCheckKind::kExactCheck;
+  }
+  // A class close enough to java.lang.Object is in the superclass display of all its
+  // subclasses, at its own depth.
+  uint32_t depth = cls->Depth();
+  if (depth != 0u && depth <= mirror::Class::kSuperclassDisplayLength) {
+    *superclass_display_depth = depth;
+    return TypeCheckKind::kSuperclassDisplayCheck;
   } else if (cls->IsAbstract()) {
     return TypeCheckKind::kAbstractClassCheck;
   } else {
@@ -1656,16 +1685,19 @@ void HInstructionBuilder::BuildTypeCheck(const Instruction& instruction,
       /* is_in_dex_cache */ false);
   AppendInstruction(cls);
 
-  TypeCheckKind check_kind = ComputeTypeCheckKind(resolved_class);
+  uint32_t superclass_display_depth;
+  TypeCheckKind check_kind = ComputeTypeCheckKind(resolved_class, &superclass_display_depth);
   if (instruction.Opcode() == Instruction::INSTANCE_OF) {
-    AppendInstruction(new (arena_) HInstanceOf(object, cls, check_kind, dex_pc));
+    AppendInstruction(new (arena_) HInstanceOf(
+        object, cls, check_kind, superclass_display_depth, dex_pc));
     UpdateLocal(destination, current_block_->GetLastInstruction());
   } else {
     DCHECK_EQ(instruction.Opcode(), Instruction::CHECK_CAST);
     // We emit a CheckCast followed by a BoundType. CheckCast is a statement
     // which may throw. If it succeeds BoundType sets the new type of `object`
     // for all subsequent uses.
-    AppendInstruction(new (arena_) HCheckCast(object, cls, check_kind, dex_pc));
+    AppendInstruction(new (arena_) HCheckCast(
+        object, cls, check_kind, superclass_display_depth, dex_pc));
     AppendInstruction(new (arena_) HBoundType(object, dex_pc));
     UpdateLocal(reference, current_block_->GetLastInstruction());
   }
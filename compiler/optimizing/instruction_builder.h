@@ -31,6 +31,7 @@
 namespace art {
 
 class Instruction;
+class ProfilingInfo;
 
 class HInstructionBuilder : public ValueObject {
  public:
@@ -65,7 +66,8 @@ class HInstructionBuilder : public ValueObject {
                                       arena_->Adapter(kArenaAllocGraphBuilder)),
         compilation_stats_(compiler_stats),
         dex_cache_(dex_cache),
-        loop_headers_(graph->GetArena()->Adapter(kArenaAllocGraphBuilder)) {
+        loop_headers_(graph->GetArena()->Adapter(kArenaAllocGraphBuilder)),
+        profiling_info_(nullptr) {
     loop_headers_.reserve(kDefaultNumberOfLoops);
   }
 
@@ -135,6 +137,10 @@ class HInstructionBuilder : public ValueObject {
   template<typename T> void If_21t(const Instruction& instruction, uint32_t dex_pc);
   template<typename T> void If_22t(const Instruction& instruction, uint32_t dex_pc);
 
+  // Appends the HIf of the conditional branch at `dex_pc`, with the branch counts
+  // of the profile if there is one.
+  void BuildIf(HInstruction* condition, uint32_t dex_pc);
+
   void Conversion_12x(const Instruction& instruction,
                       Primitive::Type input_type,
                       Primitive::Type result_type,
@@ -311,6 +317,10 @@ class HInstructionBuilder : public ValueObject {
 
   ArenaVector<HBasicBlock*> loop_headers_;
 
+  // Profiling info of the method when it is compiled by the JIT, or null. The profiles
+  // of the methods being inlined are not used.
+  ProfilingInfo* profiling_info_;
+
   static constexpr int kDefaultNumberOfLoops = 2;
 
   DISALLOW_COPY_AND_ASSIGN(HInstructionBuilder);
@@ -19,6 +19,7 @@
 #include "intrinsics.h"
 #include "mirror/class-inl.h"
 #include "scoped_thread_state_change.h"
+#include "string_builder_append.h"
 
 namespace art {
 
@@ -107,6 +108,8 @@ class InstructionSimplifierVisitor : public HGraphDelegateVisitor {
   void SimplifyStringCharAt(HInvoke* invoke);
   void SimplifyStringIsEmptyOrLength(HInvoke* invoke);
   void SimplifyMemBarrier(HInvoke* invoke, MemBarrierKind barrier_kind);
+  void SimplifyReturnThis(HInvoke* invoke);
+  void SimplifyStringBuilderToString(HInvoke* invoke);
 
   OptimizingCompilerStats* stats_;
   bool simplification_occurred_ = false;
@@ -752,6 +755,7 @@ void InstructionSimplifierVisitor::VisitIf(HIf* instruction) {
     // Swap successors if input is negated.
     instruction->ReplaceInput(condition->InputAt(0), 0);
     instruction->GetBlock()->SwapSuccessors();
+    instruction->SwapBranchCounts();
     RecordSimplification();
   }
 }
@@ -1840,6 +1844,144 @@ void InstructionSimplifierVisitor::SimplifyMemBarrier(HInvoke* invoke, MemBarrie
   invoke->GetBlock()->ReplaceAndRemoveInstructionWith(invoke, mem_barrier);
 }
 
+void InstructionSimplifierVisitor::SimplifyReturnThis(HInvoke* invoke) {
+  // StringBuilder.append() returns its receiver; let the users see the receiver instead.
+  if (invoke->HasUses() || invoke->HasEnvironmentUses()) {
+    invoke->ReplaceWith(invoke->InputAt(0));
+    RecordSimplification();
+  }
+}
+
+static bool IsStringBuilderDefaultConstructor(HInstruction* instruction) {
+  if (!instruction->IsInvokeStaticOrDirect() ||
+      instruction->AsInvokeStaticOrDirect()->GetNumberOfArguments() != 1u) {
+    return false;
+  }
+  HInvokeStaticOrDirect* invoke = instruction->AsInvokeStaticOrDirect();
+  const DexFile& dex_file = invoke->GetDexFile();
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(invoke->GetDexMethodIndex());
+  return strcmp(dex_file.GetMethodName(method_id), "<init>") == 0 &&
+      strcmp(dex_file.GetMethodDeclaringClassDescriptor(method_id),
+             "Ljava/lang/StringBuilder;") == 0;
+}
+
+// Replace a `new StringBuilder().append(...)...append(...).toString()` chain contained in
+// a single block, with the appends already simplified to return nothing, by a single
+// HStringBuilderAppend computing the result with one allocation.
+void InstructionSimplifierVisitor::SimplifyStringBuilderToString(HInvoke* invoke) {
+  DCHECK_EQ(invoke->GetIntrinsic(), Intrinsics::kStringBuilderToString);
+  if (invoke->CanThrowIntoCatchBlock()) {
+    return;
+  }
+
+  HBasicBlock* block = invoke->GetBlock();
+  HInstruction* sb = invoke->InputAt(0);
+  // Only a StringBuilder local to this block can be dropped.
+  if (!sb->IsNewInstance() || sb->GetBlock() != block) {
+    return;
+  }
+  for (const HUseListNode<HInstruction*>& use : sb->GetUses()) {
+    if (use.GetUser()->GetBlock() != block || use.GetIndex() != 0u) {
+      return;
+    }
+  }
+
+  // Walk backwards from the toString() to the allocation, accepting only appends of
+  // supported kinds and the default constructor as users of `sb`.
+  uint32_t format = 0u;
+  size_t number_of_arguments = 0u;
+  HInstruction* arguments[StringBuilderAppend::kMaxArgs];  // In reverse order.
+  bool seen_constructor = false;
+  for (HInstruction* user = invoke->GetPrevious(); user != sb; user = user->GetPrevious()) {
+    if (user->InputCount() == 0u || user->InputAt(0) != sb) {
+      continue;
+    }
+    if (seen_constructor) {
+      // Something used `sb` before its construction.
+      return;
+    }
+    if (IsStringBuilderDefaultConstructor(user)) {
+      seen_constructor = true;
+      continue;
+    }
+    if (!user->IsInvoke()) {
+      return;
+    }
+    StringBuilderAppend::Argument kind;
+    switch (user->AsInvoke()->GetIntrinsic()) {
+      case Intrinsics::kStringBuilderAppendString:
+        kind = StringBuilderAppend::Argument::kString;
+        break;
+      case Intrinsics::kStringBuilderAppendBoolean:
+        kind = StringBuilderAppend::Argument::kBoolean;
+        break;
+      case Intrinsics::kStringBuilderAppendChar:
+        kind = StringBuilderAppend::Argument::kChar;
+        break;
+      case Intrinsics::kStringBuilderAppendInt:
+        kind = StringBuilderAppend::Argument::kInt;
+        break;
+      case Intrinsics::kStringBuilderAppendLong:
+        kind = StringBuilderAppend::Argument::kLong;
+        break;
+      default:
+        return;
+    }
+    if (user->HasUses() || user->HasEnvironmentUses()) {
+      // SimplifyReturnThis() did not process this append.
+      return;
+    }
+    if (number_of_arguments == StringBuilderAppend::kMaxArgs) {
+      return;
+    }
+    format = (format << StringBuilderAppend::kBitsPerArg) | static_cast<uint32_t>(kind);
+    arguments[number_of_arguments] = user->InputAt(1);
+    ++number_of_arguments;
+  }
+  if (!seen_constructor || number_of_arguments == 0u) {
+    return;
+  }
+
+  // The environments of the removed calls die with them. Any other environment
+  // holding `sb` would need it for deoptimization.
+  for (const HUseListNode<HEnvironment*>& use : sb->GetEnvUses()) {
+    HInstruction* holder = use.GetUser()->GetHolder();
+    if (holder->GetBlock() != block || holder->InputCount() == 0u || holder->InputAt(0) != sb) {
+      return;
+    }
+  }
+
+  ArenaAllocator* arena = GetGraph()->GetArena();
+  HIntConstant* format_constant = GetGraph()->GetIntConstant(static_cast<int32_t>(format));
+  HStringBuilderAppend* append = new (arena) HStringBuilderAppend(
+      format_constant, number_of_arguments, arena, invoke->GetDexPc());
+  for (size_t i = 0; i != number_of_arguments; ++i) {
+    append->SetArgumentAt(i, arguments[number_of_arguments - 1u - i]);
+  }
+  append->SetReferenceTypeInfo(invoke->GetReferenceTypeInfo());
+  block->InsertInstructionBefore(append, invoke);
+  invoke->ReplaceWith(append);
+  // The toString() environment is copied except for `sb`, which is about to disappear.
+  for (HEnvironment* environment = invoke->GetEnvironment();
+       environment != nullptr;
+       environment = environment->GetParent()) {
+    for (size_t i = 0, e = environment->Size(); i != e; ++i) {
+      if (environment->GetInstructionAt(i) == sb) {
+        environment->RemoveAsUserOfInput(i);
+        environment->SetRawEnvAt(i, nullptr);
+      }
+    }
+  }
+  append->CopyEnvironmentFrom(invoke->GetEnvironment());
+  block->RemoveInstruction(invoke);
+  while (sb->HasNonEnvironmentUses()) {
+    block->RemoveInstruction(sb->GetUses().front().GetUser());
+  }
+  DCHECK(!sb->HasEnvironmentUses());
+  block->RemoveInstruction(sb);
+  RecordSimplification();
+}
+
 void InstructionSimplifierVisitor::VisitInvoke(HInvoke* instruction) {
   switch (instruction->GetIntrinsic()) {
     case Intrinsics::kStringEquals:
@@ -1896,6 +2038,16 @@ void InstructionSimplifierVisitor::VisitInvoke(HInvoke* instruction) {
     case Intrinsics::kUnsafeFullFence:
       SimplifyMemBarrier(instruction, MemBarrierKind::kAnyAny);
       break;
+    case Intrinsics::kStringBuilderAppendString:
+    case Intrinsics::kStringBuilderAppendBoolean:
+    case Intrinsics::kStringBuilderAppendChar:
+    case Intrinsics::kStringBuilderAppendInt:
+    case Intrinsics::kStringBuilderAppendLong:
+      SimplifyReturnThis(instruction);
+      break;
+    case Intrinsics::kStringBuilderToString:
+      SimplifyStringBuilderToString(instruction);
+      break;
     default:
       break;
   }
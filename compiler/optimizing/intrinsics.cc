@@ -22,7 +22,9 @@
 #include "dex/quick/dex_file_to_method_inliner_map.h"
 #include "driver/compiler_driver.h"
 #include "invoke_type.h"
+#include "mirror/class-inl.h"
 #include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
 #include "nodes.h"
 #include "quick/inline_method_analyser.h"
 #include "scoped_thread_state_change.h"
@@ -336,12 +338,50 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
       return Intrinsics::kMathRoundFloat;
 
     // System.arraycopy.
+    case kIntrinsicSystemArrayCopyByteArray:
+      return Intrinsics::kSystemArrayCopyByte;
     case kIntrinsicSystemArrayCopyCharArray:
       return Intrinsics::kSystemArrayCopyChar;
+    case kIntrinsicSystemArrayCopyIntArray:
+      return Intrinsics::kSystemArrayCopyInt;
+    case kIntrinsicSystemArrayCopyLongArray:
+      return Intrinsics::kSystemArrayCopyLong;
 
     case kIntrinsicSystemArrayCopy:
       return Intrinsics::kSystemArrayCopy;
 
+    // java.util.Arrays.
+    case kIntrinsicArraysEquals:
+      switch (static_cast<OpSize>(method.d.data)) {
+        case kSignedByte:
+          return Intrinsics::kArraysEqualsByte;
+        case kUnsignedHalf:
+          return Intrinsics::kArraysEqualsChar;
+        case k32:
+          return Intrinsics::kArraysEqualsInt;
+        default:
+          LOG(FATAL) << "Unknown/unsupported op size " << method.d.data;
+          UNREACHABLE();
+      }
+    case kIntrinsicArraysFill:
+      switch (static_cast<OpSize>(method.d.data)) {
+        case kSignedByte:
+          return Intrinsics::kArraysFillByte;
+        case kUnsignedHalf:
+          return Intrinsics::kArraysFillChar;
+        case k32:
+          return Intrinsics::kArraysFillInt;
+        default:
+          LOG(FATAL) << "Unknown/unsupported op size " << method.d.data;
+          UNREACHABLE();
+      }
+
+    // java.util.zip.CRC32.
+    case kIntrinsicCRC32Update:
+      return Intrinsics::kCRC32Update;
+    case kIntrinsicCRC32UpdateBytes:
+      return Intrinsics::kCRC32UpdateBytes;
+
     // Thread.currentThread.
     case kIntrinsicCurrentThread:
       return Intrinsics::kThreadCurrentThread;
@@ -400,6 +440,26 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
     case kIntrinsicNewStringFromString:
       return Intrinsics::kStringNewStringFromString;
 
+    // StringBuilder.
+    case kIntrinsicStringBuilderAppend:
+      switch (method.d.data) {
+        case kIntrinsicFlagAppendString:
+          return Intrinsics::kStringBuilderAppendString;
+        case kIntrinsicFlagAppendBoolean:
+          return Intrinsics::kStringBuilderAppendBoolean;
+        case kIntrinsicFlagAppendChar:
+          return Intrinsics::kStringBuilderAppendChar;
+        case kIntrinsicFlagAppendInt:
+          return Intrinsics::kStringBuilderAppendInt;
+        case kIntrinsicFlagAppendLong:
+          return Intrinsics::kStringBuilderAppendLong;
+        default:
+          LOG(FATAL) << "Unknown/unsupported append type " << method.d.data;
+          UNREACHABLE();
+      }
+    case kIntrinsicStringBuilderToString:
+      return Intrinsics::kStringBuilderToString;
+
     case kIntrinsicCas:
       switch (GetType(method.d.data, false)) {
         case Primitive::kPrimNot:
@@ -492,6 +552,8 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
 
     case kIntrinsicReferenceGetReferent:
       return Intrinsics::kReferenceGetReferent;
+    case kIntrinsicObjectClone:
+      return Intrinsics::kObjectClone;
 
     // Quick inliner cases. Remove after refactoring. They are here so that we can use the
     // compiler to warn on missing cases.
@@ -555,8 +617,9 @@ static bool CheckInvokeType(Intrinsics intrinsic, HInvoke* invoke, const DexFile
       return false;
 
     case kVirtual:
-      // Call might be devirtualized.
-      return (invoke_type == kVirtual || invoke_type == kDirect);
+      // Call might be devirtualized. An invoke-super of Object.clone() always calls it.
+      return (invoke_type == kVirtual || invoke_type == kDirect) ||
+          (intrinsic == Intrinsics::kObjectClone && invoke_type == kSuper);
 
     default:
       return false;
@@ -564,6 +627,70 @@ static bool CheckInvokeType(Intrinsics intrinsic, HInvoke* invoke, const DexFile
 }
 
 // TODO: Refactor DexFileMethodInliner and have something nicer than InlineMethod.
+static ArtMethod* GetResolvedMethod(HInvoke* invoke) SHARED_REQUIRES(Locks::mutator_lock_) {
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  return class_linker->FindDexCache(Thread::Current(), invoke->GetDexFile())->GetResolvedMethod(
+      invoke->GetDexMethodIndex(), class_linker->GetImagePointerSize());
+}
+
+// Whether the invoke calls Object.clone() through a type that inherits it, e.g. `int[].clone()`.
+// The DexFileMethodInliner only knows of the references to Object.clone() itself.
+static bool IsInheritedObjectClone(HInvoke* invoke) {
+  if (!invoke->IsInvokeVirtual() && !invoke->IsInvokeStaticOrDirect()) {
+    return false;
+  }
+  const DexFile& dex_file = invoke->GetDexFile();
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(invoke->GetDexMethodIndex());
+  if (strcmp(dex_file.GetMethodName(method_id), "clone") != 0 ||
+      strcmp(dex_file.GetMethodShorty(method_id), "L") != 0) {
+    return false;
+  }
+  ScopedObjectAccess soa(Thread::Current());
+  ArtMethod* art_method = GetResolvedMethod(invoke);
+  return art_method != nullptr && art_method->GetDeclaringClass()->IsObjectClass();
+}
+
+static bool IsCloneable(mirror::Class* klass) SHARED_REQUIRES(Locks::mutator_lock_) {
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (int32_t i = 0, count = klass->GetIfTableCount(); i != count; ++i) {
+    if (iftable->GetInterface(i)->DescriptorEquals("Ljava/lang/Cloneable;")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether the call of Object.clone() is known to copy an array or an instance of a Cloneable
+// class. Otherwise, it may dispatch to an override of clone(), or throw
+// CloneNotSupportedException, and is left to the regular call.
+static bool CanIntrinsifyObjectClone(HInvoke* invoke) {
+  ScopedObjectAccess soa(Thread::Current());
+  ReferenceTypeInfo info = invoke->InputAt(0)->GetReferenceTypeInfo();
+  if (!info.IsValid()) {
+    return false;
+  }
+  mirror::Class* klass = info.GetTypeHandle().Get();
+  if (klass->IsArrayClass()) {
+    // All arrays are Cloneable and use the clone() of Object.
+    return true;
+  }
+  if (!IsCloneable(klass)) {
+    return false;
+  }
+  if (invoke->IsInvokeStaticOrDirect() &&
+      invoke->AsInvokeStaticOrDirect()->GetOptimizedInvokeType() == kSuper) {
+    // Subclasses may override clone(), but super.clone() dispatches in the super class.
+    klass = klass->GetSuperClass();
+  } else if (!info.IsExact() && !klass->IsFinal()) {
+    return false;
+  }
+  ArtMethod* art_method = GetResolvedMethod(invoke);
+  return art_method != nullptr &&
+      art_method->GetDeclaringClass()->IsObjectClass() &&
+      klass->FindVirtualMethodForVirtual(
+          art_method, Runtime::Current()->GetClassLinker()->GetImagePointerSize()) == art_method;
+}
+
 void IntrinsicsRecognizer::Run() {
   for (HReversePostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
     HBasicBlock* block = it.Current();
@@ -576,22 +703,28 @@ void IntrinsicsRecognizer::Run() {
         const DexFile& dex_file = invoke->GetDexFile();
         DexFileMethodInliner* inliner = driver_->GetMethodInlinerMap()->GetMethodInliner(&dex_file);
         DCHECK(inliner != nullptr);
+        Intrinsics intrinsic = Intrinsics::kNone;
         if (inliner->IsIntrinsic(invoke->GetDexMethodIndex(), &method)) {
-          Intrinsics intrinsic = GetIntrinsic(method);
-
-          if (intrinsic != Intrinsics::kNone) {
-            if (!CheckInvokeType(intrinsic, invoke, dex_file)) {
-              LOG(WARNING) << "Found an intrinsic with unexpected invoke type: "
-                  << intrinsic << " for "
-                  << PrettyMethod(invoke->GetDexMethodIndex(), invoke->GetDexFile())
-                  << invoke->DebugName();
-            } else {
-              invoke->SetIntrinsic(intrinsic,
-                                   NeedsEnvironmentOrCache(intrinsic),
-                                   GetSideEffects(intrinsic),
-                                   GetExceptions(intrinsic));
-              MaybeRecordStat(MethodCompilationStat::kIntrinsicRecognized);
-            }
+          intrinsic = GetIntrinsic(method);
+        } else if (IsInheritedObjectClone(invoke)) {
+          intrinsic = Intrinsics::kObjectClone;
+        }
+        if (intrinsic == Intrinsics::kObjectClone && !CanIntrinsifyObjectClone(invoke)) {
+          intrinsic = Intrinsics::kNone;
+        }
+
+        if (intrinsic != Intrinsics::kNone) {
+          if (!CheckInvokeType(intrinsic, invoke, dex_file)) {
+            LOG(WARNING) << "Found an intrinsic with unexpected invoke type: "
+                << intrinsic << " for "
+                << PrettyMethod(invoke->GetDexMethodIndex(), invoke->GetDexFile())
+                << invoke->DebugName();
+          } else {
+            invoke->SetIntrinsic(intrinsic,
+                                 NeedsEnvironmentOrCache(intrinsic),
+                                 GetSideEffects(intrinsic),
+                                 GetExceptions(intrinsic));
+            MaybeRecordStat(MethodCompilationStat::kIntrinsicRecognized);
           }
         }
       }
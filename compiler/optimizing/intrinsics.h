@@ -34,6 +34,24 @@ static constexpr bool kRoundIsPlusPointFive = false;
 static constexpr uint32_t kPositiveInfinityFloat = 0x7f800000U;
 static constexpr uint64_t kPositiveInfinityDouble = UINT64_C(0x7ff0000000000000);
 
+// Constants of the inline Math.exp, which follows the fdlibm algorithm of StrictMath.exp:
+// with k = round(x / ln2) and r = x - k * ln2, where ln2 is split into a high part whose
+// products with k are exact and a low part, exp(x) = 2^k * exp(r) and
+//   exp(r) = 1 + r + r * c / (2 - c), c = r - r^2 * (P1 + r^2 * (P2 + ... + r^2 * P5)),
+// which is within one ulp. Outside of the fast path bound, or for NaN, the result can be
+// infinite or denormal and the intrinsics call the method instead.
+static constexpr double kExpFastPathBound = 708.0;
+static constexpr double kExpInvLn2 = 1.44269504088896338700e+00;
+static constexpr double kExpLn2Hi = 6.93147180369123816490e-01;
+static constexpr double kExpLn2Lo = 1.90821492927058770002e-10;
+static constexpr double kExpP1 = 1.66666666666666019037e-01;
+static constexpr double kExpP2 = -2.77777777770155933842e-03;
+static constexpr double kExpP3 = 6.61375632143793436117e-05;
+static constexpr double kExpP4 = -1.65339022054652515390e-06;
+static constexpr double kExpP5 = 4.13813679705723846039e-08;
+static constexpr int32_t kDoubleExponentBias = 1023;
+static constexpr int32_t kDoubleMantissaBits = 52;
+
 // Recognize intrinsics from HInvoke nodes.
 class IntrinsicsRecognizer : public HOptimization {
  public:
@@ -1336,6 +1336,25 @@ void IntrinsicCodeGeneratorARM::VisitStringNewStringFromString(HInvoke* invoke)
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderARM::VisitObjectClone(HInvoke* invoke) {
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnMainOnly,
+                                                            kIntrinsified);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->SetOut(Location::RegisterLocation(R0));
+}
+
+void IntrinsicCodeGeneratorARM::VisitObjectClone(HInvoke* invoke) {
+  ArmAssembler* assembler = GetAssembler();
+
+  __ LoadFromOffset(kLoadWord,
+      LR, TR, QUICK_ENTRYPOINT_OFFSET(kArmPointerSize, pCloneObject).Int32Value());
+  CheckEntrypointTypes<kQuickCloneObject, void*, mirror::Object*>();
+  __ blx(LR);
+  codegen_->RecordPcInfo(invoke, invoke->GetDexPc());
+}
+
 void IntrinsicLocationsBuilderARM::VisitSystemArrayCopy(HInvoke* invoke) {
   // TODO(rpl): Implement read barriers in the SystemArrayCopy
   // intrinsic and re-enable it (b/29516905).
@@ -2180,7 +2199,10 @@ UNIMPLEMENTED_INTRINSIC(ARM, MathRint)
 UNIMPLEMENTED_INTRINSIC(ARM, MathRoundDouble)   // Could be done by changing rounding mode, maybe?
 UNIMPLEMENTED_INTRINSIC(ARM, MathRoundFloat)    // Could be done by changing rounding mode, maybe?
 UNIMPLEMENTED_INTRINSIC(ARM, UnsafeCASLong)     // High register pressure.
+UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyByte)
 UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyChar)
+UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(ARM, SystemArrayCopyLong)
 UNIMPLEMENTED_INTRINSIC(ARM, ReferenceGetReferent)
 UNIMPLEMENTED_INTRINSIC(ARM, IntegerHighestOneBit)
 UNIMPLEMENTED_INTRINSIC(ARM, LongHighestOneBit)
@@ -2194,6 +2216,22 @@ UNIMPLEMENTED_INTRINSIC(ARM, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(ARM, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(ARM, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysEqualsChar)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysEqualsInt)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysFillChar)
+UNIMPLEMENTED_INTRINSIC(ARM, ArraysFillInt)
+UNIMPLEMENTED_INTRINSIC(ARM, CRC32Update)
+UNIMPLEMENTED_INTRINSIC(ARM, CRC32UpdateBytes)
+
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(ARM, StringBuilderToString)
+
 UNREACHABLE_INTRINSICS(ARM)
 
 #undef __
@@ -45,6 +45,7 @@ using helpers::FPRegisterFrom;
 using helpers::HeapOperand;
 using helpers::LocationFrom;
 using helpers::OperandFrom;
+using helpers::QRegisterFrom;
 using helpers::RegisterFrom;
 using helpers::SRegisterFrom;
 using helpers::WRegisterFrom;
@@ -126,8 +127,13 @@ class IntrinsicSlowPathARM64 : public SlowPathCodeARM64 {
     // Copy the result back to the expected output.
     Location out = invoke_->GetLocations()->Out();
     if (out.IsValid()) {
-      DCHECK(out.IsRegister());  // TODO: Replace this when we support output in memory.
-      DCHECK(!invoke_->GetLocations()->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+      // TODO: Replace this when we support output in memory.
+      DCHECK(out.IsRegister() || out.IsFpuRegister());
+      DCHECK(!out.IsRegister() ||
+             !invoke_->GetLocations()->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+      DCHECK(!out.IsFpuRegister() ||
+             !invoke_->GetLocations()->GetLiveRegisters()->ContainsFloatingPointRegister(
+                 out.reg()));
       MoveFromReturnRegister(out, invoke_->GetType(), codegen);
     }
 
@@ -1142,6 +1148,24 @@ void IntrinsicCodeGeneratorARM64::VisitUnsafeCASObject(HInvoke* invoke) {
   GenCas(invoke->GetLocations(), Primitive::kPrimNot, codegen_);
 }
 
+// The String and Arrays intrinsics below compare or scan 16 bytes at a time with NEON. The
+// last, partial block is handled by redoing the last 16 bytes of the data, which only works
+// when there are at least 16 bytes; shorter data uses a scalar loop. This way we never read
+// past the end of the data.
+static constexpr size_t kArm64VectorSize = 16u;
+
+// Compare the 16-bit lanes of `lhs` and `rhs`, clobbering `lhs`, and leave in `mask` one byte
+// set for each pair of different lanes, i.e. zero iff the blocks are equal.
+static void GenerateVectorMismatch(MacroAssembler* masm,
+                                   const FPRegister& lhs,
+                                   const FPRegister& rhs,
+                                   const Register& mask) {
+  __ Cmeq(lhs.V8H(), lhs.V8H(), rhs.V8H());
+  __ Mvn(lhs.V16B(), lhs.V16B());
+  __ Shrn(lhs.V8B(), lhs.V8H(), 4);
+  __ Fmov(mask.X(), lhs.D());
+}
+
 void IntrinsicLocationsBuilderARM64::VisitStringCompareTo(HInvoke* invoke) {
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             invoke->InputAt(1)->CanBeNull()
@@ -1153,6 +1177,8 @@ void IntrinsicLocationsBuilderARM64::VisitStringCompareTo(HInvoke* invoke) {
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
   locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
@@ -1167,8 +1193,12 @@ void IntrinsicCodeGeneratorARM64::VisitStringCompareTo(HInvoke* invoke) {
   Register temp0 = WRegisterFrom(locations->GetTemp(0));
   Register temp1 = WRegisterFrom(locations->GetTemp(1));
   Register temp2 = WRegisterFrom(locations->GetTemp(2));
+  FPRegister vtemp1 = QRegisterFrom(locations->GetTemp(3));
+  FPRegister vtemp2 = QRegisterFrom(locations->GetTemp(4));
 
   vixl::aarch64::Label loop;
+  vixl::aarch64::Label vector_loop;
+  vixl::aarch64::Label find_block_diff;
   vixl::aarch64::Label find_char_diff;
   vixl::aarch64::Label end;
 
@@ -1216,6 +1246,38 @@ void IntrinsicCodeGeneratorARM64::VisitStringCompareTo(HInvoke* invoke) {
 
   const size_t char_size = Primitive::ComponentSize(Primitive::kPrimChar);
   DCHECK_EQ(char_size, 2u);
+  const size_t chars_per_block = kArm64VectorSize / char_size;
+
+  // Compare 8 characters at a time if the shorter string has that many.
+  __ Cmp(temp2, chars_per_block);
+  __ B(lo, &loop);
+  // temp0 = offset of the last block of 8 characters.
+  __ Sub(temp0, temp2, chars_per_block);
+  __ Add(temp0, temp1, Operand(temp0, LSL, 1));
+  __ Bind(&vector_loop);
+  __ Ldr(vtemp1, MemOperand(str.X(), temp1.X()));
+  __ Ldr(vtemp2, MemOperand(arg.X(), temp1.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, temp4);
+  __ Cbnz(temp4, &find_block_diff);
+  __ Add(temp1, temp1, kArm64VectorSize);
+  __ Cmp(temp1, temp0);
+  __ B(ls, &vector_loop);
+  // Compare the last 8 characters, overlapping with the characters already compared.
+  __ Mov(temp1, temp0);
+  __ Ldr(vtemp1, MemOperand(str.X(), temp1.X()));
+  __ Ldr(vtemp2, MemOperand(arg.X(), temp1.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, temp4);
+  __ Cbz(temp4, &end);
+
+  // The lowest byte set in temp4 corresponds to the first character that differs.
+  __ Bind(&find_block_diff);
+  __ Rbit(temp4, temp4);
+  __ Clz(temp4, temp4);
+  __ Add(temp1.X(), temp1.X(), Operand(temp4, LSR, 2));
+  __ Ldrh(temp0, MemOperand(str.X(), temp1.X()));
+  __ Ldrh(temp2, MemOperand(arg.X(), temp1.X()));
+  __ Sub(out, temp0, temp2);
+  __ B(&end);
 
   // Promote temp0 to an X reg, ready for LDR.
   temp0 = temp0.X();
@@ -1267,6 +1329,8 @@ void IntrinsicLocationsBuilderARM64::VisitStringEquals(HInvoke* invoke) {
   // Temporary registers to store lengths of strings and for calculations.
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
   locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
@@ -1283,8 +1347,11 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   Register temp = scratch_scope.AcquireW();
   Register temp1 = WRegisterFrom(locations->GetTemp(0));
   Register temp2 = WRegisterFrom(locations->GetTemp(1));
+  FPRegister vtemp1 = QRegisterFrom(locations->GetTemp(2));
+  FPRegister vtemp2 = QRegisterFrom(locations->GetTemp(3));
 
   vixl::aarch64::Label loop;
+  vixl::aarch64::Label vector_loop;
   vixl::aarch64::Label end;
   vixl::aarch64::Label return_true;
   vixl::aarch64::Label return_false;
@@ -1293,6 +1360,7 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   const int32_t count_offset = mirror::String::CountOffset().Int32Value();
   const int32_t value_offset = mirror::String::ValueOffset().Int32Value();
   const int32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  const size_t chars_per_block = kArm64VectorSize / sizeof(uint16_t);
 
   // Note that the null check must have been done earlier.
   DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
@@ -1329,6 +1397,27 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   // Return true if both strings are empty.
   __ Cbz(temp, &return_true);
 
+  // Compare 8 characters at a time if the strings have that many.
+  __ Cmp(temp, chars_per_block);
+  __ B(lo, &loop);
+  // temp = offset of the last block of 8 characters.
+  __ Sub(temp, temp, chars_per_block);
+  __ Add(temp, temp1, Operand(temp, LSL, 1));
+  __ Bind(&vector_loop);
+  __ Ldr(vtemp1, MemOperand(str.X(), temp1.X()));
+  __ Ldr(vtemp2, MemOperand(arg.X(), temp1.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, out);
+  __ Cbnz(out, &return_false);
+  __ Add(temp1, temp1, kArm64VectorSize);
+  __ Cmp(temp1, temp);
+  __ B(ls, &vector_loop);
+  // Compare the last 8 characters, overlapping with the characters already compared.
+  __ Ldr(vtemp1, MemOperand(str.X(), temp.X()));
+  __ Ldr(vtemp2, MemOperand(arg.X(), temp.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, out);
+  __ Cbnz(out, &return_false);
+  __ B(&return_true);
+
   // Assertions that must hold in order to compare strings 4 characters at a time.
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String of odd length is not zero padded");
@@ -1359,6 +1448,28 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   __ Bind(&end);
 }
 
+static void CreateStringIndexOfLocations(HInvoke* invoke,
+                                         ArenaAllocator* allocator,
+                                         bool start_at_zero) {
+  LocationSummary* locations = new (allocator) LocationSummary(invoke,
+                                                               LocationSummary::kCallOnSlowPath,
+                                                               kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  if (!start_at_zero) {
+    locations->SetInAt(2, Location::RequiresRegister());
+  }
+  // Temporary registers for the remaining length, the index, the current address and the
+  // match mask, and for the searched character replicated and the loaded block.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
 static void GenerateVisitStringIndexOf(HInvoke* invoke,
                                        MacroAssembler* masm,
                                        CodeGeneratorARM64* codegen,
@@ -1369,6 +1480,16 @@ static void GenerateVisitStringIndexOf(HInvoke* invoke,
   // Note that the null check must have been done earlier.
   DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
 
+  Register string_obj = XRegisterFrom(locations->InAt(0));
+  Register search_value = WRegisterFrom(locations->InAt(1));
+  Register out = WRegisterFrom(locations->Out());
+  Register length = WRegisterFrom(locations->GetTemp(0));
+  Register index = WRegisterFrom(locations->GetTemp(1));
+  Register address = XRegisterFrom(locations->GetTemp(2));
+  Register mask = XRegisterFrom(locations->GetTemp(3));
+  FPRegister search_vector = QRegisterFrom(locations->GetTemp(4));
+  FPRegister block = QRegisterFrom(locations->GetTemp(5));
+
   // Check for code points > 0xFFFF. Either a slow-path check when we don't know statically,
   // or directly dispatch for a large constant, or omit slow-path for a small constant or a char.
   SlowPathCodeARM64* slow_path = nullptr;
@@ -1384,41 +1505,98 @@ static void GenerateVisitStringIndexOf(HInvoke* invoke,
       return;
     }
   } else if (code_point->GetType() != Primitive::kPrimChar) {
-    Register char_reg = WRegisterFrom(locations->InAt(1));
-    __ Tst(char_reg, 0xFFFF0000);
+    __ Tst(search_value, 0xFFFF0000);
     slow_path = new (allocator) IntrinsicSlowPathARM64(invoke);
     codegen->AddSlowPath(slow_path);
     __ B(ne, slow_path->GetEntryLabel());
   }
 
+  const int32_t count_offset = mirror::String::CountOffset().Int32Value();
+  const int32_t value_offset = mirror::String::ValueOffset().Int32Value();
+  const size_t char_size = Primitive::ComponentSize(Primitive::kPrimChar);
+  const size_t chars_per_block = kArm64VectorSize / char_size;
+
+  vixl::aarch64::Label vector_loop;
+  vixl::aarch64::Label scalar_loop;
+  vixl::aarch64::Label found_in_block;
+  vixl::aarch64::Label found_char;
+  vixl::aarch64::Label not_found;
+  vixl::aarch64::Label done;
+
+  __ Ldr(length, MemOperand(string_obj, count_offset));
   if (start_at_zero) {
-    // Start-index = 0.
-    Register tmp_reg = WRegisterFrom(locations->GetTemp(0));
-    __ Mov(tmp_reg, 0);
+    __ Mov(index, 0);
+  } else {
+    // Ensure we have a start index >= 0.
+    Register start_index = WRegisterFrom(locations->InAt(2));
+    __ Cmp(start_index, 0);
+    __ Csel(index, start_index, wzr, gt);
   }
+  // Do a start index check, this also handles the empty string.
+  __ Cmp(index, length);
+  __ B(ge, &not_found);
+
+  // From here on, length is the number of characters left to look at.
+  __ Sub(length, length, index);
+  __ Add(address, string_obj, value_offset);
+  __ Add(address, address, Operand(index.X(), LSL, 1));
+  __ Cmp(length, chars_per_block);
+  __ B(lo, &scalar_loop);
+
+  // Look at 8 characters at a time.
+  __ Dup(search_vector.V8H(), search_value);
+  __ Bind(&vector_loop);
+  __ Ldr(block, MemOperand(address));
+  __ Cmeq(block.V8H(), block.V8H(), search_vector.V8H());
+  __ Shrn(block.V8B(), block.V8H(), 4);
+  __ Fmov(mask, block.D());
+  __ Cbnz(mask, &found_in_block);
+  __ Add(address, address, kArm64VectorSize);
+  __ Sub(length, length, chars_per_block);
+  __ Cmp(length, chars_per_block);
+  __ B(hs, &vector_loop);
+  __ Cbz(length, &not_found);
+  // Look at the last 8 characters, overlapping with the characters already seen.
+  __ Sub(address, address, kArm64VectorSize);
+  __ Add(address, address, Operand(length.X(), LSL, 1));
+  __ Ldr(block, MemOperand(address));
+  __ Cmeq(block.V8H(), block.V8H(), search_vector.V8H());
+  __ Shrn(block.V8B(), block.V8H(), 4);
+  __ Fmov(mask, block.D());
+  __ Cbz(mask, &not_found);
+
+  // The lowest byte set in mask corresponds to the first matching character.
+  __ Bind(&found_in_block);
+  __ Rbit(mask, mask);
+  __ Clz(mask, mask);
+  __ Add(address, address, Operand(mask, LSR, 2));
+  __ Bind(&found_char);
+  __ Sub(address, address, string_obj);
+  __ Sub(address, address, value_offset);
+  __ Lsr(out, address.W(), 1);
+  __ B(&done);
+
+  // Fewer than 8 characters to look at, do it one at a time.
+  __ Bind(&scalar_loop);
+  __ Ldrh(mask.W(), MemOperand(address));
+  __ Cmp(mask.W(), search_value);
+  __ B(eq, &found_char);
+  __ Add(address, address, char_size);
+  __ Subs(length, length, 1);
+  __ B(ne, &scalar_loop);
+
+  // Failed to match; return -1.
+  __ Bind(&not_found);
+  __ Mov(out, -1);
 
-  __ Ldr(lr, MemOperand(tr, QUICK_ENTRYPOINT_OFFSET(kArm64PointerSize, pIndexOf).Int32Value()));
-  CheckEntrypointTypes<kQuickIndexOf, int32_t, void*, uint32_t, uint32_t>();
-  __ Blr(lr);
-
+  __ Bind(&done);
   if (slow_path != nullptr) {
     __ Bind(slow_path->GetExitLabel());
   }
 }
 
 void IntrinsicLocationsBuilderARM64::VisitStringIndexOf(HInvoke* invoke) {
-  LocationSummary* locations = new (arena_) LocationSummary(invoke,
-                                                            LocationSummary::kCallOnMainAndSlowPath,
-                                                            kIntrinsified);
-  // We have a hand-crafted assembly stub that follows the runtime calling convention. So it's
-  // best to align the inputs accordingly.
-  InvokeRuntimeCallingConvention calling_convention;
-  locations->SetInAt(0, LocationFrom(calling_convention.GetRegisterAt(0)));
-  locations->SetInAt(1, LocationFrom(calling_convention.GetRegisterAt(1)));
-  locations->SetOut(calling_convention.GetReturnLocation(Primitive::kPrimInt));
-
-  // Need to send start_index=0.
-  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(2)));
+  CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ true);
 }
 
 void IntrinsicCodeGeneratorARM64::VisitStringIndexOf(HInvoke* invoke) {
@@ -1427,16 +1605,7 @@ void IntrinsicCodeGeneratorARM64::VisitStringIndexOf(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM64::VisitStringIndexOfAfter(HInvoke* invoke) {
-  LocationSummary* locations = new (arena_) LocationSummary(invoke,
-                                                            LocationSummary::kCallOnMainAndSlowPath,
-                                                            kIntrinsified);
-  // We have a hand-crafted assembly stub that follows the runtime calling convention. So it's
-  // best to align the inputs accordingly.
-  InvokeRuntimeCallingConvention calling_convention;
-  locations->SetInAt(0, LocationFrom(calling_convention.GetRegisterAt(0)));
-  locations->SetInAt(1, LocationFrom(calling_convention.GetRegisterAt(1)));
-  locations->SetInAt(2, LocationFrom(calling_convention.GetRegisterAt(2)));
-  locations->SetOut(calling_convention.GetReturnLocation(Primitive::kPrimInt));
+  CreateStringIndexOfLocations(invoke, arena_, /* start_at_zero */ false);
 }
 
 void IntrinsicCodeGeneratorARM64::VisitStringIndexOfAfter(HInvoke* invoke) {
@@ -1444,6 +1613,363 @@ void IntrinsicCodeGeneratorARM64::VisitStringIndexOfAfter(HInvoke* invoke) {
       invoke, GetVIXLAssembler(), codegen_, GetAllocator(), /* start_at_zero */ false);
 }
 
+static void CreateArraysEqualsLocations(HInvoke* invoke, ArenaAllocator* allocator) {
+  LocationSummary* locations = new (allocator) LocationSummary(invoke,
+                                                               LocationSummary::kNoCall,
+                                                               kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // Temporary registers for the length in bytes, the offset and the vector comparison.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+static void GenerateArraysEquals(LocationSummary* locations,
+                                 MacroAssembler* masm,
+                                 Primitive::Type type) {
+  Register lhs = WRegisterFrom(locations->InAt(0));
+  Register rhs = WRegisterFrom(locations->InAt(1));
+  Register length = WRegisterFrom(locations->GetTemp(0));
+  Register offset = WRegisterFrom(locations->GetTemp(1));
+  FPRegister vtemp1 = QRegisterFrom(locations->GetTemp(2));
+  FPRegister vtemp2 = QRegisterFrom(locations->GetTemp(3));
+  Register out = XRegisterFrom(locations->Out());
+
+  UseScratchRegisterScope scratch_scope(masm);
+  Register temp = scratch_scope.AcquireW();
+
+  const size_t component_size = Primitive::ComponentSize(type);
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(component_size).Int32Value();
+
+  vixl::aarch64::Label vector_loop;
+  vixl::aarch64::Label scalar_loop;
+  vixl::aarch64::Label end;
+  vixl::aarch64::Label return_true;
+  vixl::aarch64::Label return_false;
+
+  // Same arrays, including both null.
+  __ Cmp(lhs, rhs);
+  __ B(&return_true, eq);
+  __ Cbz(lhs, &return_false);
+  __ Cbz(rhs, &return_false);
+
+  __ Ldr(length, MemOperand(lhs.X(), length_offset));
+  __ Ldr(temp, MemOperand(rhs.X(), length_offset));
+  __ Cmp(length, temp);
+  __ B(&return_false, ne);
+  // From here on, length is the offset of the end of the data.
+  __ Lsl(length, length, Primitive::ComponentSizeShift(type));
+  __ Add(length, length, data_offset);
+  __ Mov(offset, data_offset);
+  __ Cmp(length, data_offset + kArm64VectorSize);
+  __ B(lo, &scalar_loop);
+
+  // Compare 16 bytes at a time. Comparing 16-bit lanes is fine for any element size as we
+  // only look for full equality. From here on, length is the offset of the last block.
+  __ Sub(length, length, kArm64VectorSize);
+  __ Bind(&vector_loop);
+  __ Ldr(vtemp1, MemOperand(lhs.X(), offset.X()));
+  __ Ldr(vtemp2, MemOperand(rhs.X(), offset.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, out);
+  __ Cbnz(out, &return_false);
+  __ Add(offset, offset, kArm64VectorSize);
+  __ Cmp(offset, length);
+  __ B(ls, &vector_loop);
+  // Compare the last 16 bytes, overlapping with the bytes already compared.
+  __ Ldr(vtemp1, MemOperand(lhs.X(), length.X()));
+  __ Ldr(vtemp2, MemOperand(rhs.X(), length.X()));
+  GenerateVectorMismatch(masm, vtemp1, vtemp2, out);
+  __ Cbnz(out, &return_false);
+  __ B(&return_true);
+
+  // Fewer than 16 bytes to compare, do it one element at a time.
+  __ Bind(&scalar_loop);
+  __ Cmp(offset, length);
+  __ B(&return_true, eq);
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ Ldrb(out.W(), MemOperand(lhs.X(), offset.X()));
+      __ Ldrb(temp, MemOperand(rhs.X(), offset.X()));
+      break;
+    case Primitive::kPrimChar:
+      __ Ldrh(out.W(), MemOperand(lhs.X(), offset.X()));
+      __ Ldrh(temp, MemOperand(rhs.X(), offset.X()));
+      break;
+    case Primitive::kPrimInt:
+      __ Ldr(out.W(), MemOperand(lhs.X(), offset.X()));
+      __ Ldr(temp, MemOperand(rhs.X(), offset.X()));
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ Cmp(out.W(), temp);
+  __ B(&return_false, ne);
+  __ Add(offset, offset, component_size);
+  __ B(&scalar_loop);
+
+  __ Bind(&return_true);
+  __ Mov(out, 1);
+  __ B(&end);
+
+  __ Bind(&return_false);
+  __ Mov(out, 0);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetVIXLAssembler(), Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysEqualsChar(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysEqualsChar(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetVIXLAssembler(), Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysEqualsInt(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysEqualsInt(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetVIXLAssembler(), Primitive::kPrimInt);
+}
+
+static void CreateArraysFillLocations(HInvoke* invoke, ArenaAllocator* allocator) {
+  LocationSummary* locations = new (allocator) LocationSummary(invoke,
+                                                               LocationSummary::kCallOnSlowPath,
+                                                               kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // Temporary registers for the length in bytes, the offset and the replicated value.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+static void GenerateArraysFill(HInvoke* invoke,
+                               MacroAssembler* masm,
+                               CodeGeneratorARM64* codegen,
+                               ArenaAllocator* allocator,
+                               Primitive::Type type) {
+  LocationSummary* locations = invoke->GetLocations();
+  Register array = WRegisterFrom(locations->InAt(0));
+  Register value = WRegisterFrom(locations->InAt(1));
+  Register length = WRegisterFrom(locations->GetTemp(0));
+  Register offset = WRegisterFrom(locations->GetTemp(1));
+  FPRegister vvalue = QRegisterFrom(locations->GetTemp(2));
+
+  const size_t component_size = Primitive::ComponentSize(type);
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(component_size).Int32Value();
+
+  // Let the slow path throw the NullPointerException.
+  SlowPathCodeARM64* slow_path = nullptr;
+  if (invoke->InputAt(0)->CanBeNull()) {
+    slow_path = new (allocator) IntrinsicSlowPathARM64(invoke);
+    codegen->AddSlowPath(slow_path);
+    __ Cbz(array, slow_path->GetEntryLabel());
+  }
+
+  vixl::aarch64::Label vector_loop;
+  vixl::aarch64::Label scalar_loop;
+  vixl::aarch64::Label done;
+
+  __ Ldr(length, MemOperand(array.X(), length_offset));
+  // From here on, length is the offset of the end of the data.
+  __ Lsl(length, length, Primitive::ComponentSizeShift(type));
+  __ Add(length, length, data_offset);
+  __ Mov(offset, data_offset);
+  __ Cmp(length, data_offset + kArm64VectorSize);
+  __ B(lo, &scalar_loop);
+
+  // Replicate the value in all the lanes.
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ Dup(vvalue.V16B(), value);
+      break;
+    case Primitive::kPrimChar:
+      __ Dup(vvalue.V8H(), value);
+      break;
+    case Primitive::kPrimInt:
+      __ Dup(vvalue.V4S(), value);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+
+  // Store 16 bytes at a time. From here on, length is the offset of the last block.
+  __ Sub(length, length, kArm64VectorSize);
+  __ Bind(&vector_loop);
+  __ Str(vvalue, MemOperand(array.X(), offset.X()));
+  __ Add(offset, offset, kArm64VectorSize);
+  __ Cmp(offset, length);
+  __ B(ls, &vector_loop);
+  // Store the last 16 bytes, overlapping with the bytes already stored.
+  __ Str(vvalue, MemOperand(array.X(), length.X()));
+  __ B(&done);
+
+  // Fewer than 16 bytes to store, do it one element at a time.
+  __ Bind(&scalar_loop);
+  __ Cmp(offset, length);
+  __ B(&done, eq);
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ Strb(value, MemOperand(array.X(), offset.X()));
+      break;
+    case Primitive::kPrimChar:
+      __ Strh(value, MemOperand(array.X(), offset.X()));
+      break;
+    case Primitive::kPrimInt:
+      __ Str(value, MemOperand(array.X(), offset.X()));
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ Add(offset, offset, component_size);
+  __ B(&scalar_loop);
+
+  __ Bind(&done);
+  if (slow_path != nullptr) {
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysFillByte(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysFillByte(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysFillChar(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysFillChar(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysFillInt(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysFillInt(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimInt);
+}
+
+// java.util.zip.CRC32 computes the CRC-32 of zlib, which inverts the checksum before and after
+// the CRC32 instructions. These are optional in ARMv8.0, without them the native methods are
+// called.
+
+void IntrinsicLocationsBuilderARM64::VisitCRC32Update(HInvoke* invoke) {
+  if (!codegen_->GetInstructionSetFeatures().HasCRC()) {
+    return;
+  }
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kNoCall,
+                                                            kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The output is written before the byte is read.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitCRC32Update(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+  Register crc = WRegisterFrom(locations->InAt(0));
+  Register value = WRegisterFrom(locations->InAt(1));
+  Register out = WRegisterFrom(locations->Out());
+
+  __ Mvn(out, crc);
+  __ Crc32b(out, out, value);
+  __ Mvn(out, out);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
+  if (!codegen_->GetInstructionSetFeatures().HasCRC()) {
+    return;
+  }
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kNoCall,
+                                                            kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresRegister());
+  locations->SetInAt(3, Location::RequiresRegister());
+  // Temporary registers for the data pointer, the remaining length and the loaded data.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  // The output is written before the inputs are read.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+  // CRC32.update(byte[], int, int) has checked the array and the range before calling
+  // updateBytes(), so there is nothing to throw.
+  Register crc = WRegisterFrom(locations->InAt(0));
+  Register array = WRegisterFrom(locations->InAt(1));
+  Register offset = WRegisterFrom(locations->InAt(2));
+  Register length = WRegisterFrom(locations->InAt(3));
+  Register ptr = XRegisterFrom(locations->GetTemp(0));
+  Register remaining = WRegisterFrom(locations->GetTemp(1));
+  Register data = XRegisterFrom(locations->GetTemp(2));
+  Register out = WRegisterFrom(locations->Out());
+
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(uint8_t)).Int32Value();
+
+  vixl::aarch64::Label long_loop;
+  vixl::aarch64::Label byte_loop;
+  vixl::aarch64::Label tail;
+  vixl::aarch64::Label done;
+
+  __ Mvn(out, crc);
+  __ Add(ptr, array.X(), data_offset);
+  __ Add(ptr, ptr, Operand(offset, UXTW));
+
+  // Checksum 8 bytes at a time.
+  __ Subs(remaining, length, 8);
+  __ B(lt, &tail);
+  __ Bind(&long_loop);
+  __ Ldr(data, MemOperand(ptr, 8, PostIndex));
+  __ Crc32x(out, out, data);
+  __ Subs(remaining, remaining, 8);
+  __ B(ge, &long_loop);
+
+  // Checksum the last 0 to 7 bytes one at a time.
+  __ Bind(&tail);
+  __ Adds(remaining, remaining, 8);
+  __ B(eq, &done);
+  __ Bind(&byte_loop);
+  __ Ldrb(data.W(), MemOperand(ptr, 1, PostIndex));
+  __ Crc32b(out, out, data.W());
+  __ Subs(remaining, remaining, 1);
+  __ B(ne, &byte_loop);
+
+  __ Bind(&done);
+  __ Mvn(out, out);
+}
+
 void IntrinsicLocationsBuilderARM64::VisitStringNewStringFromBytes(HInvoke* invoke) {
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCallOnMainAndSlowPath,
@@ -1531,6 +2057,26 @@ void IntrinsicCodeGeneratorARM64::VisitStringNewStringFromString(HInvoke* invoke
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderARM64::VisitObjectClone(HInvoke* invoke) {
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnMainOnly,
+                                                            kIntrinsified);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->SetInAt(0, LocationFrom(calling_convention.GetRegisterAt(0)));
+  locations->SetOut(calling_convention.GetReturnLocation(Primitive::kPrimNot));
+}
+
+void IntrinsicCodeGeneratorARM64::VisitObjectClone(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+
+  // The receiver has already been null checked.
+  __ Ldr(lr,
+      MemOperand(tr, QUICK_ENTRYPOINT_OFFSET(kArm64PointerSize, pCloneObject).Int32Value()));
+  CheckEntrypointTypes<kQuickCloneObject, void*, mirror::Object*>();
+  __ Blr(lr);
+  codegen_->RecordPcInfo(invoke, invoke->GetDexPc());
+}
+
 static void CreateFPToFPCallLocations(ArenaAllocator* arena, HInvoke* invoke) {
   DCHECK_EQ(invoke->GetNumberOfArguments(), 1U);
   DCHECK(Primitive::IsFloatingPointType(invoke->InputAt(0)->GetType()));
@@ -1628,11 +2174,85 @@ void IntrinsicCodeGeneratorARM64::VisitMathCosh(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderARM64::VisitMathExp(HInvoke* invoke) {
-  CreateFPToFPCallLocations(arena_, invoke);
+  // Inline the common case, the method is only called on a slow path. See kExpFastPathBound.
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnSlowPath,
+                                                            kIntrinsified);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kOutputOverlap);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 }
 
 void IntrinsicCodeGeneratorARM64::VisitMathExp(HInvoke* invoke) {
-  GenFPToFPCall(invoke, GetVIXLAssembler(), codegen_, kQuickExp);
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+  FPRegister in = DRegisterFrom(locations->InAt(0));
+  FPRegister out = DRegisterFrom(locations->Out());
+  Register k = XRegisterFrom(locations->GetTemp(0));
+  FPRegister lo_part = DRegisterFrom(locations->GetTemp(1));
+  FPRegister hi_part = DRegisterFrom(locations->GetTemp(2));
+  FPRegister r2 = DRegisterFrom(locations->GetTemp(3));
+  FPRegister c = DRegisterFrom(locations->GetTemp(4));
+  FPRegister constant = DRegisterFrom(locations->GetTemp(5));
+
+  SlowPathCodeARM64* slow_path = new (GetAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen_->AddSlowPath(slow_path);
+
+  // Large, infinite and NaN inputs go to the slow path (`hi` is also taken if unordered).
+  __ Fabs(lo_part, in);
+  __ Fmov(constant, kExpFastPathBound);
+  __ Fcmp(lo_part, constant);
+  __ B(hi, slow_path->GetEntryLabel());
+
+  // k = round(x / ln2), with its double value in `lo_part`.
+  __ Fmov(constant, kExpInvLn2);
+  __ Fmul(lo_part, in, constant);
+  __ Fcvtns(k, lo_part);
+  __ Scvtf(lo_part, k);
+
+  // hi = x - k * ln2_hi, lo = k * ln2_lo and r = hi - lo in `out`. There are no fused
+  // multiply-adds anywhere, so that the roundings are the ones of the reference algorithm.
+  __ Fmov(constant, kExpLn2Hi);
+  __ Fmul(hi_part, lo_part, constant);
+  __ Fsub(hi_part, in, hi_part);
+  __ Fmov(constant, kExpLn2Lo);
+  __ Fmul(lo_part, lo_part, constant);
+  __ Fsub(out, hi_part, lo_part);
+
+  // c = r - r^2 * (P1 + r^2 * (P2 + r^2 * (P3 + r^2 * (P4 + r^2 * P5)))).
+  __ Fmul(r2, out, out);
+  __ Fmov(c, kExpP5);
+  static const double kCoefficients[] = { kExpP4, kExpP3, kExpP2, kExpP1 };
+  for (double coefficient : kCoefficients) {
+    __ Fmul(c, c, r2);
+    __ Fmov(constant, coefficient);
+    __ Fadd(c, c, constant);
+  }
+  __ Fmul(c, c, r2);
+  __ Fsub(c, out, c);
+
+  // exp(r) = 1 - ((lo - r * c / (2 - c)) - hi).
+  __ Fmov(constant, 2.0);
+  __ Fsub(r2, constant, c);
+  __ Fmul(c, out, c);
+  __ Fdiv(c, c, r2);
+  __ Fsub(lo_part, lo_part, c);
+  __ Fsub(lo_part, lo_part, hi_part);
+  __ Fmov(constant, 1.0);
+  __ Fsub(out, constant, lo_part);
+
+  // Scale by 2^k, which is a normal double in the fast path.
+  __ Add(k, k, kDoubleExponentBias);
+  __ Lsl(k, k, kDoubleMantissaBits);
+  __ Fmov(lo_part, k);
+  __ Fmul(out, out, lo_part);
+
+  __ Bind(slow_path->GetExitLabel());
 }
 
 void IntrinsicLocationsBuilderARM64::VisitMathExpm1(HInvoke* invoke) {
@@ -1799,9 +2419,9 @@ void IntrinsicCodeGeneratorARM64::VisitStringGetCharsNoCheck(HInvoke* invoke) {
   __ Bind(&done);
 }
 
-// Mirrors ARRAYCOPY_SHORT_CHAR_ARRAY_THRESHOLD in libcore, so we can choose to use the native
-// implementation there for longer copy lengths.
-static constexpr int32_t kSystemArrayCopyCharThreshold = 32;
+// Primitive copies of up to this many bytes are done inline, longer ones are left to libcore's
+// native implementation.
+static constexpr int32_t kSystemArrayCopyPrimitiveThreshold = 512;
 
 static void SetSystemArrayCopyLocationRequires(LocationSummary* locations,
                                                uint32_t at,
@@ -1814,7 +2434,9 @@ static void SetSystemArrayCopyLocationRequires(LocationSummary* locations,
   }
 }
 
-void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+static void CreateSystemArrayCopyPrimitiveLocations(HInvoke* invoke,
+                                                   ArenaAllocator* arena,
+                                                   Primitive::Type type) {
   // Check to see if we have known failures that will cause us to have to bail out
   // to the runtime, and just generate the runtime call directly.
   HIntConstant* src_pos = invoke->InputAt(1)->AsIntConstant();
@@ -1832,26 +2454,29 @@ void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   HIntConstant* length = invoke->InputAt(4)->AsIntConstant();
   if (length != nullptr) {
     int32_t len = length->GetValue();
-    if (len < 0 || len > kSystemArrayCopyCharThreshold) {
+    if (len < 0 ||
+        len > kSystemArrayCopyPrimitiveThreshold >> Primitive::ComponentSizeShift(type)) {
       // Just call as normal.
       return;
     }
   }
 
-  ArenaAllocator* allocator = invoke->GetBlock()->GetGraph()->GetArena();
-  LocationSummary* locations = new (allocator) LocationSummary(invoke,
-                                                               LocationSummary::kCallOnSlowPath,
-                                                               kIntrinsified);
-  // arraycopy(char[] src, int src_pos, char[] dst, int dst_pos, int length).
+  LocationSummary* locations = new (arena) LocationSummary(invoke,
+                                                           LocationSummary::kCallOnSlowPath,
+                                                           kIntrinsified);
+  // arraycopy(T[] src, int src_pos, T[] dst, int dst_pos, int length).
   locations->SetInAt(0, Location::RequiresRegister());
   SetSystemArrayCopyLocationRequires(locations, 1, invoke->InputAt(1));
   locations->SetInAt(2, Location::RequiresRegister());
   SetSystemArrayCopyLocationRequires(locations, 3, invoke->InputAt(3));
   SetSystemArrayCopyLocationRequires(locations, 4, invoke->InputAt(4));
 
+  // Temporary registers for the source and destination addresses, the number of bytes
+  // and the copied block.
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 }
 
 static void CheckSystemArrayCopyPosition(MacroAssembler* masm,
@@ -1910,8 +2535,6 @@ static void GenSystemArrayCopyAddresses(MacroAssembler* masm,
                                         const Register& src_base,
                                         const Register& dst_base,
                                         const Register& src_end) {
-  DCHECK(type == Primitive::kPrimNot || type == Primitive::kPrimChar)
-      << "Unexpected element type: " << type;
   const int32_t element_size = Primitive::ComponentSize(type);
   const int32_t element_size_shift = Primitive::ComponentSizeShift(type);
 
@@ -1940,8 +2563,11 @@ static void GenSystemArrayCopyAddresses(MacroAssembler* masm,
   }
 }
 
-void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
-  MacroAssembler* masm = GetVIXLAssembler();
+static void GenSystemArrayCopyPrimitive(HInvoke* invoke,
+                                        MacroAssembler* masm,
+                                        CodeGeneratorARM64* codegen,
+                                        ArenaAllocator* allocator,
+                                        Primitive::Type type) {
   LocationSummary* locations = invoke->GetLocations();
   Register src = XRegisterFrom(locations->InAt(0));
   Location src_pos = locations->InAt(1);
@@ -1949,8 +2575,8 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   Location dst_pos = locations->InAt(3);
   Location length = locations->InAt(4);
 
-  SlowPathCodeARM64* slow_path = new (GetAllocator()) IntrinsicSlowPathARM64(invoke);
-  codegen_->AddSlowPath(slow_path);
+  SlowPathCodeARM64* slow_path = new (allocator) IntrinsicSlowPathARM64(invoke);
+  codegen->AddSlowPath(slow_path);
 
   // If source and destination are the same, take the slow path. Overlapping copy regions must be
   // copied in reverse and we can't know in all cases if it's needed.
@@ -1963,21 +2589,24 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   // Bail out if the destination is null.
   __ Cbz(dst, slow_path->GetEntryLabel());
 
+  const int32_t element_size = Primitive::ComponentSize(type);
+  const int32_t max_length = kSystemArrayCopyPrimitiveThreshold / element_size;
   if (!length.IsConstant()) {
     // If the length is negative, bail out.
     __ Tbnz(WRegisterFrom(length), kWRegSize - 1, slow_path->GetEntryLabel());
-    // If the length > 32 then (currently) prefer libcore's native implementation.
-    __ Cmp(WRegisterFrom(length), kSystemArrayCopyCharThreshold);
+    // If the copy is long then (currently) prefer libcore's native implementation.
+    __ Cmp(WRegisterFrom(length), max_length);
     __ B(slow_path->GetEntryLabel(), gt);
   } else {
     // We have already checked in the LocationsBuilder for the constant case.
     DCHECK_GE(length.GetConstant()->AsIntConstant()->GetValue(), 0);
-    DCHECK_LE(length.GetConstant()->AsIntConstant()->GetValue(), 32);
+    DCHECK_LE(length.GetConstant()->AsIntConstant()->GetValue(), max_length);
   }
 
   Register src_curr_addr = WRegisterFrom(locations->GetTemp(0));
   Register dst_curr_addr = WRegisterFrom(locations->GetTemp(1));
-  Register src_stop_addr = WRegisterFrom(locations->GetTemp(2));
+  Register count = WRegisterFrom(locations->GetTemp(2));
+  FPRegister vtemp = QRegisterFrom(locations->GetTemp(3));
 
   CheckSystemArrayCopyPosition(masm,
                                src_pos,
@@ -1997,10 +2626,10 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
 
   src_curr_addr = src_curr_addr.X();
   dst_curr_addr = dst_curr_addr.X();
-  src_stop_addr = src_stop_addr.X();
+  count = count.X();
 
   GenSystemArrayCopyAddresses(masm,
-                              Primitive::kPrimChar,
+                              type,
                               src,
                               src_pos,
                               dst,
@@ -2008,24 +2637,100 @@ void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
                               length,
                               src_curr_addr,
                               dst_curr_addr,
-                              src_stop_addr);
+                              count);
+  // From here on, count is the number of bytes to copy.
+  __ Sub(count, count, src_curr_addr);
 
-  // Iterate over the arrays and do a raw copy of the chars.
-  const int32_t char_size = Primitive::ComponentSize(Primitive::kPrimChar);
   UseScratchRegisterScope temps(masm);
-  Register tmp = temps.AcquireW();
-  vixl::aarch64::Label loop, done;
+  vixl::aarch64::Label vector_loop, element_loop, done;
+  __ Cmp(count, kArm64VectorSize);
+  __ B(lo, &element_loop);
+
+  // Copy 16 bytes at a time. The last, partial block is handled by copying the last 16 bytes
+  // again, the arrays are different so the blocks cannot overlap. From here on, count is the
+  // offset of the last block.
+  Register offset = temps.AcquireX();
+  __ Sub(count, count, kArm64VectorSize);
+  __ Mov(offset, 0);
+  __ Bind(&vector_loop);
+  __ Ldr(vtemp, MemOperand(src_curr_addr, offset));
+  __ Str(vtemp, MemOperand(dst_curr_addr, offset));
+  __ Add(offset, offset, kArm64VectorSize);
+  __ Cmp(offset, count);
+  __ B(lo, &vector_loop);
+  __ Ldr(vtemp, MemOperand(src_curr_addr, count));
+  __ Str(vtemp, MemOperand(dst_curr_addr, count));
+  __ B(&done);
+
+  // Copy less than 16 bytes one element at a time.
+  __ Bind(&element_loop);
+  __ Cbz(count, &done);
+  Register tmp = (type == Primitive::kPrimLong) ? offset : offset.W();
+  vixl::aarch64::Label loop;
   __ Bind(&loop);
-  __ Cmp(src_curr_addr, src_stop_addr);
-  __ B(&done, eq);
-  __ Ldrh(tmp, MemOperand(src_curr_addr, char_size, PostIndex));
-  __ Strh(tmp, MemOperand(dst_curr_addr, char_size, PostIndex));
-  __ B(&loop);
+  MemOperand src_operand(src_curr_addr, element_size, PostIndex);
+  MemOperand dst_operand(dst_curr_addr, element_size, PostIndex);
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ Ldrb(tmp, src_operand);
+      __ Strb(tmp, dst_operand);
+      break;
+    case Primitive::kPrimChar:
+      __ Ldrh(tmp, src_operand);
+      __ Strh(tmp, dst_operand);
+      break;
+    case Primitive::kPrimInt:
+    case Primitive::kPrimLong:
+      __ Ldr(tmp, src_operand);
+      __ Str(tmp, dst_operand);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ Subs(count, count, element_size);
+  __ B(ne, &loop);
   __ Bind(&done);
 
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke, arena_, Primitive::kPrimChar);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke, arena_, Primitive::kPrimByte);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke, arena_, Primitive::kPrimInt);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimInt);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitSystemArrayCopyLong(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(invoke, arena_, Primitive::kPrimLong);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitSystemArrayCopyLong(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(
+      invoke, GetVIXLAssembler(), codegen_, GetAllocator(), Primitive::kPrimLong);
+}
+
 // We can choose to use the native implementation there for longer copy lengths.
 static constexpr int32_t kSystemArrayCopyThreshold = 128;
 
@@ -2356,6 +3061,13 @@ UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(ARM64, StringBuilderToString)
+
 UNREACHABLE_INTRINSICS(ARM64)
 
 #undef __
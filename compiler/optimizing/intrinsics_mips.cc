@@ -2510,7 +2510,10 @@ UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeCASLong)
 
 UNIMPLEMENTED_INTRINSIC(MIPS, ReferenceGetReferent)
 UNIMPLEMENTED_INTRINSIC(MIPS, StringGetCharsNoCheck)
+UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyByte)
 UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyChar)
+UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopyLong)
 UNIMPLEMENTED_INTRINSIC(MIPS, SystemArrayCopy)
 
 UNIMPLEMENTED_INTRINSIC(MIPS, MathCos)
@@ -2538,6 +2541,24 @@ UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysEqualsChar)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysEqualsInt)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillChar)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillInt)
+UNIMPLEMENTED_INTRINSIC(MIPS, CRC32Update)
+UNIMPLEMENTED_INTRINSIC(MIPS, CRC32UpdateBytes)
+
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderToString)
+
+UNIMPLEMENTED_INTRINSIC(MIPS, ObjectClone)
+
 UNREACHABLE_INTRINSICS(MIPS)
 
 #undef __
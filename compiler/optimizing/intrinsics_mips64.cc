@@ -1959,7 +1959,10 @@ void IntrinsicCodeGeneratorMIPS64::VisitLongLowestOneBit(HInvoke* invoke) {
 
 UNIMPLEMENTED_INTRINSIC(MIPS64, ReferenceGetReferent)
 UNIMPLEMENTED_INTRINSIC(MIPS64, StringGetCharsNoCheck)
+UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyByte)
 UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyChar)
+UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopyLong)
 UNIMPLEMENTED_INTRINSIC(MIPS64, SystemArrayCopy)
 
 UNIMPLEMENTED_INTRINSIC(MIPS64, MathCos)
@@ -1987,6 +1990,24 @@ UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysEqualsChar)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysEqualsInt)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillChar)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillInt)
+UNIMPLEMENTED_INTRINSIC(MIPS64, CRC32Update)
+UNIMPLEMENTED_INTRINSIC(MIPS64, CRC32UpdateBytes)
+
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderToString)
+
+UNIMPLEMENTED_INTRINSIC(MIPS64, ObjectClone)
+
 UNREACHABLE_INTRINSICS(MIPS64)
 
 #undef __
@@ -65,8 +65,13 @@ class IntrinsicSlowPath : public SlowPathCode {
     // Copy the result back to the expected output.
     Location out = invoke_->GetLocations()->Out();
     if (out.IsValid()) {
-      DCHECK(out.IsRegister());  // TODO: Replace this when we support output in memory.
-      DCHECK(!invoke_->GetLocations()->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+      // TODO: Replace this when we support output in memory.
+      DCHECK(out.IsRegister() || out.IsFpuRegister());
+      DCHECK(!out.IsRegister() ||
+             !invoke_->GetLocations()->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+      DCHECK(!out.IsFpuRegister() ||
+             !invoke_->GetLocations()->GetLiveRegisters()->ContainsFloatingPointRegister(
+                 out.reg()));
       codegen->MoveFromReturnRegister(out, invoke_->GetType());
     }
 
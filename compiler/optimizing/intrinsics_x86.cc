@@ -1567,6 +1567,23 @@ void IntrinsicCodeGeneratorX86::VisitStringNewStringFromString(HInvoke* invoke)
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderX86::VisitObjectClone(HInvoke* invoke) {
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnMainOnly,
+                                                            kIntrinsified);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->SetOut(Location::RegisterLocation(EAX));
+}
+
+void IntrinsicCodeGeneratorX86::VisitObjectClone(HInvoke* invoke) {
+  X86Assembler* assembler = GetAssembler();
+
+  __ fs()->call(Address::Absolute(QUICK_ENTRYPOINT_OFFSET(kX86PointerSize, pCloneObject)));
+  CheckEntrypointTypes<kQuickCloneObject, void*, mirror::Object*>();
+  codegen_->RecordPcInfo(invoke, invoke->GetDexPc());
+}
+
 void IntrinsicLocationsBuilderX86::VisitStringGetCharsNoCheck(HInvoke* invoke) {
   // public void getChars(int srcBegin, int srcEnd, char[] dst, int dstBegin);
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
@@ -2948,6 +2965,25 @@ UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(X86, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysEqualsChar)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysEqualsInt)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysFillChar)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysFillInt)
+UNIMPLEMENTED_INTRINSIC(X86, CRC32Update)
+UNIMPLEMENTED_INTRINSIC(X86, CRC32UpdateBytes)
+UNIMPLEMENTED_INTRINSIC(X86, SystemArrayCopyByte)
+UNIMPLEMENTED_INTRINSIC(X86, SystemArrayCopyInt)
+UNIMPLEMENTED_INTRINSIC(X86, SystemArrayCopyLong)
+
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(X86, StringBuilderToString)
+
 UNREACHABLE_INTRINSICS(X86)
 
 #undef __
@@ -778,11 +778,87 @@ void IntrinsicCodeGeneratorX86_64::VisitMathCosh(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitMathExp(HInvoke* invoke) {
-  CreateFPToFPCallLocations(arena_, invoke);
+  // Inline the common case, the method is only called on a slow path. See kExpFastPathBound.
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnSlowPath,
+                                                            kIntrinsified);
+  locations->SetInAt(0, Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresFpuRegister(), Location::kOutputOverlap);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitMathExp(HInvoke* invoke) {
-  GenFPToFPCall(invoke, codegen_, kQuickExp);
+  LocationSummary* locations = invoke->GetLocations();
+  XmmRegister in = locations->InAt(0).AsFpuRegister<XmmRegister>();
+  XmmRegister out = locations->Out().AsFpuRegister<XmmRegister>();
+  CpuRegister k = locations->GetTemp(0).AsRegister<CpuRegister>();
+  XmmRegister lo = locations->GetTemp(1).AsFpuRegister<XmmRegister>();
+  XmmRegister hi = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister r2 = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  XmmRegister c = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
+  X86_64Assembler* assembler = GetAssembler();
+
+  SlowPathCode* slow_path = new (GetAllocator()) IntrinsicSlowPathX86_64(invoke);
+  codegen_->AddSlowPath(slow_path);
+
+  // Large, infinite and NaN inputs go to the slow path. The mask goes through a register,
+  // see MathAbsFP.
+  __ movsd(c, codegen_->LiteralInt64Address(INT64_C(0x7FFFFFFFFFFFFFFF)));
+  __ movsd(lo, in);
+  __ andpd(lo, c);
+  __ ucomisd(lo, codegen_->LiteralDoubleAddress(kExpFastPathBound));
+  __ j(kUnordered, slow_path->GetEntryLabel());
+  __ j(kAbove, slow_path->GetEntryLabel());
+
+  // k = round(x / ln2), with the default rounding mode, and its double value in `lo`.
+  __ movsd(lo, in);
+  __ mulsd(lo, codegen_->LiteralDoubleAddress(kExpInvLn2));
+  __ cvtsd2si(k, lo);
+  __ cvtsi2sd(lo, k);
+
+  // hi = x - k * ln2_hi, lo = k * ln2_lo and r = hi - lo in `out`.
+  __ movsd(c, lo);
+  __ mulsd(c, codegen_->LiteralDoubleAddress(kExpLn2Hi));
+  __ movsd(hi, in);
+  __ subsd(hi, c);
+  __ mulsd(lo, codegen_->LiteralDoubleAddress(kExpLn2Lo));
+  __ movsd(out, hi);
+  __ subsd(out, lo);
+
+  // c = r - r^2 * (P1 + r^2 * (P2 + r^2 * (P3 + r^2 * (P4 + r^2 * P5)))).
+  __ movsd(r2, out);
+  __ mulsd(r2, out);
+  __ movsd(c, codegen_->LiteralDoubleAddress(kExpP5));
+  static const double kCoefficients[] = { kExpP4, kExpP3, kExpP2, kExpP1 };
+  for (double coefficient : kCoefficients) {
+    __ mulsd(c, r2);
+    __ addsd(c, codegen_->LiteralDoubleAddress(coefficient));
+  }
+  __ mulsd(c, r2);
+  __ movsd(r2, out);
+  __ subsd(r2, c);
+
+  // exp(r) = 1 - ((lo - r * c / (2 - c)) - hi), with c now in `r2`.
+  __ movsd(c, codegen_->LiteralDoubleAddress(2.0));
+  __ subsd(c, r2);
+  __ mulsd(r2, out);
+  __ divsd(r2, c);
+  __ subsd(lo, r2);
+  __ subsd(lo, hi);
+  __ movsd(out, codegen_->LiteralDoubleAddress(1.0));
+  __ subsd(out, lo);
+
+  // Scale by 2^k, which is a normal double in the fast path.
+  __ addl(k, Immediate(kDoubleExponentBias));
+  __ shlq(k, Immediate(kDoubleMantissaBits));
+  __ movd(lo, k);
+  __ mulsd(out, lo);
+
+  __ Bind(slow_path->GetExitLabel());
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitMathExpm1(HInvoke* invoke) {
@@ -875,7 +951,7 @@ void IntrinsicCodeGeneratorX86_64::VisitMathNextAfter(HInvoke* invoke) {
   GenFPToFPCall(invoke, codegen_, kQuickNextAfter);
 }
 
-void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+static void CreateSystemArrayCopyPrimitiveLocations(ArenaAllocator* arena, HInvoke* invoke) {
   // Check to see if we have known failures that will cause us to have to bail out
   // to the runtime, and just generate the runtime call directly.
   HIntConstant* src_pos = invoke->InputAt(1)->AsIntConstant();
@@ -898,20 +974,22 @@ void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke)
     }
   }
 
-  LocationSummary* locations = new (arena_) LocationSummary(invoke,
-                                                            LocationSummary::kCallOnSlowPath,
-                                                            kIntrinsified);
-  // arraycopy(Object src, int src_pos, Object dest, int dest_pos, int length).
+  LocationSummary* locations = new (arena) LocationSummary(invoke,
+                                                           LocationSummary::kCallOnSlowPath,
+                                                           kIntrinsified);
+  // arraycopy(T[] src, int src_pos, T[] dest, int dest_pos, int length).
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(invoke->InputAt(1)));
   locations->SetInAt(2, Location::RequiresRegister());
   locations->SetInAt(3, Location::RegisterOrConstant(invoke->InputAt(3)));
   locations->SetInAt(4, Location::RegisterOrConstant(invoke->InputAt(4)));
 
-  // And we need some temporaries.  We will use REP MOVSW, so we need fixed registers.
+  // And we need some temporaries.  We will use REP MOVSB, so we need fixed registers,
+  // and an XMM register for the 16-byte blocks.
   locations->AddTemp(Location::RegisterLocation(RSI));
   locations->AddTemp(Location::RegisterLocation(RDI));
   locations->AddTemp(Location::RegisterLocation(RCX));
+  locations->AddTemp(Location::RequiresFpuRegister());
 }
 
 static void CheckPosition(X86_64Assembler* assembler,
@@ -978,8 +1056,10 @@ static void CheckPosition(X86_64Assembler* assembler,
   }
 }
 
-void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
-  X86_64Assembler* assembler = GetAssembler();
+static void GenSystemArrayCopyPrimitive(HInvoke* invoke,
+                                        CodeGeneratorX86_64* codegen,
+                                        Primitive::Type type) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
   LocationSummary* locations = invoke->GetLocations();
 
   CpuRegister src = locations->InAt(0).AsRegister<CpuRegister>();
@@ -988,16 +1068,18 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   Location dest_pos = locations->InAt(3);
   Location length = locations->InAt(4);
 
-  // Temporaries that we need for MOVSW.
+  // Temporaries that we need for MOVSB.
   CpuRegister src_base = locations->GetTemp(0).AsRegister<CpuRegister>();
   DCHECK_EQ(src_base.AsRegister(), RSI);
   CpuRegister dest_base = locations->GetTemp(1).AsRegister<CpuRegister>();
   DCHECK_EQ(dest_base.AsRegister(), RDI);
   CpuRegister count = locations->GetTemp(2).AsRegister<CpuRegister>();
   DCHECK_EQ(count.AsRegister(), RCX);
+  XmmRegister block = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
 
-  SlowPathCode* slow_path = new (GetAllocator()) IntrinsicSlowPathX86_64(invoke);
-  codegen_->AddSlowPath(slow_path);
+  SlowPathCode* slow_path =
+      new (codegen->GetGraph()->GetArena()) IntrinsicSlowPathX86_64(invoke);
+  codegen->AddSlowPath(slow_path);
 
   // Bail out if the source and destination are the same.
   __ cmpl(src, dest);
@@ -1024,41 +1106,95 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
   // Validity checks: dest. Use src_base as a temporary register.
   CheckPosition(assembler, dest_pos, dest, length, slow_path, src_base);
 
-  // We need the count in RCX.
+  // We need the number of bytes to copy in RCX.
+  const size_t element_size = Primitive::ComponentSize(type);
+  const ScaleFactor scale_factor = static_cast<ScaleFactor>(Primitive::ComponentSizeShift(type));
   if (length.IsConstant()) {
-    __ movl(count, Immediate(length.GetConstant()->AsIntConstant()->GetValue()));
+    int64_t length_const = length.GetConstant()->AsIntConstant()->GetValue();
+    __ movq(count, Immediate(length_const * element_size));
   } else {
     __ movl(count, length.AsRegister<CpuRegister>());
+    if (scale_factor != TIMES_1) {
+      __ shlq(count, Immediate(scale_factor));
+    }
   }
 
   // Okay, everything checks out.  Finally time to do the copy.
-  // Check assumption that sizeof(Char) is 2 (used in scaling below).
-  const size_t char_size = Primitive::ComponentSize(Primitive::kPrimChar);
-  DCHECK_EQ(char_size, 2u);
-
-  const uint32_t data_offset = mirror::Array::DataOffset(char_size).Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(element_size).Uint32Value();
 
   if (src_pos.IsConstant()) {
     int32_t src_pos_const = src_pos.GetConstant()->AsIntConstant()->GetValue();
-    __ leal(src_base, Address(src, char_size * src_pos_const + data_offset));
+    __ leal(src_base, Address(src, element_size * src_pos_const + data_offset));
   } else {
-    __ leal(src_base, Address(src, src_pos.AsRegister<CpuRegister>(),
-                              ScaleFactor::TIMES_2, data_offset));
+    __ leal(src_base, Address(src, src_pos.AsRegister<CpuRegister>(), scale_factor, data_offset));
   }
   if (dest_pos.IsConstant()) {
     int32_t dest_pos_const = dest_pos.GetConstant()->AsIntConstant()->GetValue();
-    __ leal(dest_base, Address(dest, char_size * dest_pos_const + data_offset));
+    __ leal(dest_base, Address(dest, element_size * dest_pos_const + data_offset));
   } else {
-    __ leal(dest_base, Address(dest, dest_pos.AsRegister<CpuRegister>(),
-                               ScaleFactor::TIMES_2, data_offset));
+    __ leal(dest_base,
+            Address(dest, dest_pos.AsRegister<CpuRegister>(), scale_factor, data_offset));
   }
 
-  // Do the move.
-  __ rep_movsw();
+  // Copies of less than 16 bytes are done with REP MOVSB. Longer ones are done 16 bytes at a
+  // time and the last, partial block is handled by copying the last 16 bytes again, the arrays
+  // are different so the blocks cannot overlap.
+  NearLabel short_copy, loop, done;
+  __ cmpq(count, Immediate(16));
+  __ j(kLess, &short_copy);
+  __ Bind(&loop);
+  __ movups(block, Address(src_base, 0));
+  __ movups(Address(dest_base, 0), block);
+  __ addq(src_base, Immediate(16));
+  __ addq(dest_base, Immediate(16));
+  __ subq(count, Immediate(16));
+  __ cmpq(count, Immediate(16));
+  __ j(kGreaterEqual, &loop);
+  __ testq(count, count);
+  __ j(kEqual, &done);
+  __ movups(block, Address(src_base, count, TIMES_1, -16));
+  __ movups(Address(dest_base, count, TIMES_1, -16), block);
+  __ jmp(&done);
+
+  __ Bind(&short_copy);
+  __ rep_movsb();
+  __ Bind(&done);
 
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyByte(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyChar(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyInt(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, Primitive::kPrimInt);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopyLong(HInvoke* invoke) {
+  CreateSystemArrayCopyPrimitiveLocations(arena_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopyLong(HInvoke* invoke) {
+  GenSystemArrayCopyPrimitive(invoke, codegen_, Primitive::kPrimLong);
+}
+
 
 void IntrinsicLocationsBuilderX86_64::VisitSystemArrayCopy(HInvoke* invoke) {
   // TODO(rpl): Implement read barriers in the SystemArrayCopy
@@ -1298,32 +1434,148 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopy(HInvoke* invoke) {
   __ Bind(slow_path->GetExitLabel());
 }
 
+// The String and Arrays intrinsics below compare or scan 16 bytes at a time with SSE2, which
+// all x86-64 processors have. The last, partial block is handled by redoing the last 16 bytes
+// of the data, which only works when there are at least 16 bytes; shorter data uses a scalar
+// loop. This way we never read past the end of the data.
+static constexpr size_t kX86_64VectorSize = 16u;
+
+// Compare the 16 bytes at `lhs` and `rhs`, leaving a bit mask in `mask` with two bits set for
+// each pair of equal 16-bit values, i.e. 0xffff iff the blocks are equal.
+static void GenerateVectorCompare(X86_64Assembler* assembler,
+                                  const Address& lhs,
+                                  const Address& rhs,
+                                  CpuRegister mask,
+                                  XmmRegister temp1,
+                                  XmmRegister temp2) {
+  __ movups(temp1, lhs);
+  __ movups(temp2, rhs);
+  __ pcmpeqw(temp1, temp2);
+  __ pmovmskb(mask, temp1);
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitStringCompareTo(HInvoke* invoke) {
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
-                                                            LocationSummary::kCallOnMainAndSlowPath,
+                                                            invoke->InputAt(1)->CanBeNull()
+                                                                ? LocationSummary::kCallOnSlowPath
+                                                                : LocationSummary::kNoCall,
                                                             kIntrinsified);
-  InvokeRuntimeCallingConvention calling_convention;
-  locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
-  locations->SetInAt(1, Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
-  locations->SetOut(Location::RegisterLocation(RAX));
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitStringCompareTo(HInvoke* invoke) {
   X86_64Assembler* assembler = GetAssembler();
   LocationSummary* locations = invoke->GetLocations();
 
+  CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister arg = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister min_length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister temp1 = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister temp2 = locations->GetTemp(2).AsRegister<CpuRegister>();
+  CpuRegister index = locations->GetTemp(3).AsRegister<CpuRegister>();
+  XmmRegister vtemp1 = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
+  XmmRegister vtemp2 = locations->GetTemp(5).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  const int32_t count_offset = mirror::String::CountOffset().Int32Value();
+  const int32_t value_offset = mirror::String::ValueOffset().Int32Value();
+  const size_t chars_per_block = kX86_64VectorSize / sizeof(uint16_t);
+
   // Note that the null check must have been done earlier.
   DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
 
-  CpuRegister argument = locations->InAt(1).AsRegister<CpuRegister>();
-  __ testl(argument, argument);
-  SlowPathCode* slow_path = new (GetAllocator()) IntrinsicSlowPathX86_64(invoke);
-  codegen_->AddSlowPath(slow_path);
-  __ j(kEqual, slow_path->GetEntryLabel());
+  // Take slow path and throw if input can be and is null.
+  SlowPathCode* slow_path = nullptr;
+  const bool can_slow_path = invoke->InputAt(1)->CanBeNull();
+  if (can_slow_path) {
+    slow_path = new (GetAllocator()) IntrinsicSlowPathX86_64(invoke);
+    codegen_->AddSlowPath(slow_path);
+    __ testl(arg, arg);
+    __ j(kEqual, slow_path->GetEntryLabel());
+  }
 
-  __ gs()->call(Address::Absolute(QUICK_ENTRYPOINT_OFFSET(kX86_64PointerSize, pStringCompareTo),
-                                  /* no_rip */ true));
-  __ Bind(slow_path->GetExitLabel());
+  NearLabel end, vector_loop, found_block_diff, scalar_loop, found_char_diff;
+
+  // Reference equality check, return 0 if same reference.
+  __ xorl(out, out);
+  __ cmpl(str, arg);
+  __ j(kEqual, &end);
+  // out = length diff, min_length = min(len(str), len(arg)).
+  __ movl(min_length, Address(str, count_offset));
+  __ movl(temp1, Address(arg, count_offset));
+  __ movl(out, min_length);
+  __ subl(out, temp1);
+  __ cmpl(min_length, temp1);
+  __ cmov(kGreater, min_length, temp1, /* is64bit */ false);
+  // Shorter string is empty?
+  __ testl(min_length, min_length);
+  __ j(kEqual, &end);
+
+  __ xorl(index, index);
+  __ cmpl(min_length, Immediate(chars_per_block));
+  __ j(kBelow, &scalar_loop);
+
+  // Compare 8 characters at a time. From here on, min_length is the index of the last block.
+  __ subl(min_length, Immediate(chars_per_block));
+  __ Bind(&vector_loop);
+  GenerateVectorCompare(assembler,
+                        Address(str, index, ScaleFactor::TIMES_2, value_offset),
+                        Address(arg, index, ScaleFactor::TIMES_2, value_offset),
+                        temp1,
+                        vtemp1,
+                        vtemp2);
+  __ xorl(temp1, Immediate(0xffff));
+  __ j(kNotEqual, &found_block_diff);
+  __ addl(index, Immediate(chars_per_block));
+  __ cmpl(index, min_length);
+  __ j(kBelowEqual, &vector_loop);
+  // Compare the last 8 characters, overlapping with the characters already compared.
+  __ movl(index, min_length);
+  GenerateVectorCompare(assembler,
+                        Address(str, index, ScaleFactor::TIMES_2, value_offset),
+                        Address(arg, index, ScaleFactor::TIMES_2, value_offset),
+                        temp1,
+                        vtemp1,
+                        vtemp2);
+  __ xorl(temp1, Immediate(0xffff));
+  __ j(kEqual, &end);
+
+  // The lowest bit set in temp1 is the first byte of the first different character.
+  __ Bind(&found_block_diff);
+  __ bsfl(temp1, temp1);
+  __ shrl(temp1, Immediate(1));
+  __ addl(index, temp1);
+  __ movzxw(temp1, Address(str, index, ScaleFactor::TIMES_2, value_offset));
+  __ movzxw(temp2, Address(arg, index, ScaleFactor::TIMES_2, value_offset));
+  __ jmp(&found_char_diff);
+
+  // Fewer than 8 characters to compare, do it one at a time.
+  __ Bind(&scalar_loop);
+  __ movzxw(temp1, Address(str, index, ScaleFactor::TIMES_2, value_offset));
+  __ movzxw(temp2, Address(arg, index, ScaleFactor::TIMES_2, value_offset));
+  __ cmpl(temp1, temp2);
+  __ j(kNotEqual, &found_char_diff);
+  __ addl(index, Immediate(1));
+  __ cmpl(index, min_length);
+  __ j(kBelow, &scalar_loop);
+  __ jmp(&end);
+
+  __ Bind(&found_char_diff);
+  __ movl(out, temp1);
+  __ subl(out, temp2);
+
+  __ Bind(&end);
+  if (can_slow_path) {
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
@@ -1332,13 +1584,12 @@ void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
                                                             kIntrinsified);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
-
-  // Request temporary registers, RCX and RDI needed for repe_cmpsq instruction.
-  locations->AddTemp(Location::RegisterLocation(RCX));
-  locations->AddTemp(Location::RegisterLocation(RDI));
-
-  // Set output, RSI needed for repe_cmpsq instruction anyways.
-  locations->SetOut(Location::RegisterLocation(RSI), Location::kOutputOverlap);
+  // Temporary registers for the length, the index and the vector comparison.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
@@ -1347,16 +1598,19 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
 
   CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
   CpuRegister arg = locations->InAt(1).AsRegister<CpuRegister>();
-  CpuRegister rcx = locations->GetTemp(0).AsRegister<CpuRegister>();
-  CpuRegister rdi = locations->GetTemp(1).AsRegister<CpuRegister>();
-  CpuRegister rsi = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister index = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister vtemp1 = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister vtemp2 = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
 
-  NearLabel end, return_true, return_false;
+  NearLabel end, return_true, return_false, vector_loop, short_string;
 
   // Get offsets of count, value, and class fields within a string object.
   const uint32_t count_offset = mirror::String::CountOffset().Uint32Value();
   const uint32_t value_offset = mirror::String::ValueOffset().Uint32Value();
   const uint32_t class_offset = mirror::Object::ClassOffset().Uint32Value();
+  const size_t chars_per_block = kX86_64VectorSize / sizeof(uint16_t);
 
   // Note that the null check must have been done earlier.
   DCHECK(!invoke->CanDoImplicitNullCheckOn(invoke->InputAt(0)));
@@ -1373,8 +1627,8 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
     // All string objects must have the same type since String cannot be subclassed.
     // Receiver must be a string object, so its class field is equal to all strings' class fields.
     // If the argument is a string object, its class field must be equal to receiver's class field.
-    __ movl(rcx, Address(str, class_offset));
-    __ cmpl(rcx, Address(arg, class_offset));
+    __ movl(length, Address(str, class_offset));
+    __ cmpl(length, Address(arg, class_offset));
     __ j(kNotEqual, &return_false);
   }
 
@@ -1383,39 +1637,66 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   __ j(kEqual, &return_true);
 
   // Load length of receiver string.
-  __ movl(rcx, Address(str, count_offset));
+  __ movl(length, Address(str, count_offset));
   // Check if lengths are equal, return false if they're not.
-  __ cmpl(rcx, Address(arg, count_offset));
+  __ cmpl(length, Address(arg, count_offset));
   __ j(kNotEqual, &return_false);
   // Return true if both strings are empty.
-  __ jrcxz(&return_true);
-
-  // Load starting addresses of string values into RSI/RDI as required for repe_cmpsq instruction.
-  __ leal(rsi, Address(str, value_offset));
-  __ leal(rdi, Address(arg, value_offset));
-
-  // Divide string length by 4 and adjust for lengths not divisible by 4.
-  __ addl(rcx, Immediate(3));
-  __ shrl(rcx, Immediate(2));
+  __ testl(length, length);
+  __ j(kEqual, &return_true);
+  __ cmpl(length, Immediate(chars_per_block));
+  __ j(kBelow, &short_string);
+
+  // Compare 8 characters at a time. From here on, length is the index of the last block.
+  __ subl(length, Immediate(chars_per_block));
+  __ xorl(index, index);
+  __ Bind(&vector_loop);
+  GenerateVectorCompare(assembler,
+                        Address(str, index, ScaleFactor::TIMES_2, value_offset),
+                        Address(arg, index, ScaleFactor::TIMES_2, value_offset),
+                        out,
+                        vtemp1,
+                        vtemp2);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(index, Immediate(chars_per_block));
+  __ cmpl(index, length);
+  __ j(kBelowEqual, &vector_loop);
+  // Compare the last 8 characters, overlapping with the characters already compared.
+  GenerateVectorCompare(assembler,
+                        Address(str, length, ScaleFactor::TIMES_2, value_offset),
+                        Address(arg, length, ScaleFactor::TIMES_2, value_offset),
+                        out,
+                        vtemp1,
+                        vtemp2);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ jmp(&return_true);
 
   // Assertions that must hold in order to compare strings 4 characters at a time.
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String is not zero padded");
 
-  // Loop to compare strings four characters at a time starting at the beginning of the string.
-  __ repe_cmpsq();
-  // If strings are not equal, zero flag will be cleared.
+  // Fewer than 8 characters: compare them 4 at a time, including the equal zero padding.
+  __ Bind(&short_string);
+  __ movq(out, Address(str, value_offset));
+  __ cmpq(out, Address(arg, value_offset));
+  __ j(kNotEqual, &return_false);
+  __ cmpl(length, Immediate(4));
+  __ j(kBelowEqual, &return_true);
+  __ movq(out, Address(str, value_offset + sizeof(uint64_t)));
+  __ cmpq(out, Address(arg, value_offset + sizeof(uint64_t)));
   __ j(kNotEqual, &return_false);
 
   // Return true and exit the function.
   // If loop does not result in returning false, we return true.
   __ Bind(&return_true);
-  __ movl(rsi, Immediate(1));
+  __ movl(out, Immediate(1));
   __ jmp(&end);
 
   // Return false and exit the function.
   __ Bind(&return_false);
-  __ xorl(rsi, rsi);
+  __ xorl(out, out);
   __ Bind(&end);
 }
 
@@ -1425,23 +1706,21 @@ static void CreateStringIndexOfLocations(HInvoke* invoke,
   LocationSummary* locations = new (allocator) LocationSummary(invoke,
                                                                LocationSummary::kCallOnSlowPath,
                                                                kIntrinsified);
-  // The data needs to be in RDI for scasw. So request that the string is there, anyways.
-  locations->SetInAt(0, Location::RegisterLocation(RDI));
-  // If we look for a constant char, we'll still have to copy it into RAX. So just request the
-  // allocator to do that, anyways. We can still do the constant check by checking the parameter
-  // of the instruction explicitly.
-  // Note: This works as we don't clobber RAX anywhere.
-  locations->SetInAt(1, Location::RegisterLocation(RAX));
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
   if (!start_at_zero) {
     locations->SetInAt(2, Location::RequiresRegister());          // The starting index.
   }
-  // As we clobber RDI during execution anyways, also use it as the output.
-  locations->SetOut(Location::SameAsFirstInput());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 
-  // repne scasw uses RCX as the counter.
-  locations->AddTemp(Location::RegisterLocation(RCX));
-  // Need another temporary to be able to compute the result.
+  // The length, the index, the last block index and the match mask.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  // The searched character, replicated, and the loaded block.
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 }
 
 static void GenerateStringIndexOf(HInvoke* invoke,
@@ -1456,16 +1735,14 @@ static void GenerateStringIndexOf(HInvoke* invoke,
 
   CpuRegister string_obj = locations->InAt(0).AsRegister<CpuRegister>();
   CpuRegister search_value = locations->InAt(1).AsRegister<CpuRegister>();
-  CpuRegister counter = locations->GetTemp(0).AsRegister<CpuRegister>();
-  CpuRegister string_length = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister string_length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister index = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister last_block = locations->GetTemp(2).AsRegister<CpuRegister>();
+  CpuRegister mask = locations->GetTemp(3).AsRegister<CpuRegister>();
+  XmmRegister search_vector = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
+  XmmRegister block = locations->GetTemp(5).AsFpuRegister<XmmRegister>();
   CpuRegister out = locations->Out().AsRegister<CpuRegister>();
 
-  // Check our assumptions for registers.
-  DCHECK_EQ(string_obj.AsRegister(), RDI);
-  DCHECK_EQ(search_value.AsRegister(), RAX);
-  DCHECK_EQ(counter.AsRegister(), RCX);
-  DCHECK_EQ(out.AsRegister(), RDI);
-
   // Check for code points > 0xFFFF. Either a slow-path check when we don't know statically,
   // or directly dispatch for a large constant, or omit slow-path for a small constant or a char.
   SlowPathCode* slow_path = nullptr;
@@ -1493,55 +1770,73 @@ static void GenerateStringIndexOf(HInvoke* invoke,
   int32_t value_offset = mirror::String::ValueOffset().Int32Value();
   // Location of count within the String object.
   int32_t count_offset = mirror::String::CountOffset().Int32Value();
+  const size_t chars_per_block = kX86_64VectorSize / sizeof(uint16_t);
+
+  NearLabel not_found_label, done, vector_loop, found_in_block, scalar_loop, found_char;
 
   // Load string length, i.e., the count field of the string.
   __ movl(string_length, Address(string_obj, count_offset));
 
-  // Do a length check.
-  // TODO: Support jecxz.
-  NearLabel not_found_label;
-  __ testl(string_length, string_length);
-  __ j(kEqual, &not_found_label);
-
-  if (start_at_zero) {
-    // Number of chars to scan is the same as the string length.
-    __ movl(counter, string_length);
-
-    // Move to the start of the string.
-    __ addq(string_obj, Immediate(value_offset));
-  } else {
+  // Ensure we have a start index >= 0.
+  __ xorl(index, index);
+  if (!start_at_zero) {
     CpuRegister start_index = locations->InAt(2).AsRegister<CpuRegister>();
-
-    // Do a start_index check.
-    __ cmpl(start_index, string_length);
-    __ j(kGreaterEqual, &not_found_label);
-
-    // Ensure we have a start index >= 0;
-    __ xorl(counter, counter);
     __ cmpl(start_index, Immediate(0));
-    __ cmov(kGreater, counter, start_index, /* is64bit */ false);  // 32-bit copy is enough.
-
-    // Move to the start of the string: string_obj + value_offset + 2 * start_index.
-    __ leaq(string_obj, Address(string_obj, counter, ScaleFactor::TIMES_2, value_offset));
-
-    // Now update ecx, the work counter: it's gonna be string.length - start_index.
-    __ negq(counter);  // Needs to be 64-bit negation, as the address computation is 64-bit.
-    __ leaq(counter, Address(string_length, counter, ScaleFactor::TIMES_1, 0));
-  }
-
-  // Everything is set up for repne scasw:
-  //   * Comparison address in RDI.
-  //   * Counter in ECX.
-  __ repne_scasw();
-
-  // Did we find a match?
-  __ j(kNotEqual, &not_found_label);
+    __ cmov(kGreater, index, start_index, /* is64bit */ false);  // 32-bit copy is enough.
+  }
+  // Do a start index check, this also handles the empty string.
+  __ cmpl(index, string_length);
+  __ j(kGreaterEqual, &not_found_label);
+
+  __ movl(last_block, string_length);
+  __ subl(last_block, Immediate(chars_per_block));
+  __ cmpl(index, last_block);
+  __ j(kGreater, &scalar_loop);
+
+  // Replicate the searched character in all the 16-bit lanes.
+  __ movd(search_vector, search_value, /* is64bit */ false);
+  __ punpcklwd(search_vector, search_vector);
+  __ pshufd(search_vector, search_vector, Immediate(0));
+
+  // Look at 8 characters at a time.
+  __ Bind(&vector_loop);
+  __ movups(block, Address(string_obj, index, ScaleFactor::TIMES_2, value_offset));
+  __ pcmpeqw(block, search_vector);
+  __ pmovmskb(mask, block);
+  __ testl(mask, mask);
+  __ j(kNotEqual, &found_in_block);
+  __ addl(index, Immediate(chars_per_block));
+  __ cmpl(index, last_block);
+  __ j(kLessEqual, &vector_loop);
+  // Look at the last 8 characters, overlapping with the characters already seen.
+  __ cmpl(index, string_length);
+  __ j(kEqual, &not_found_label);
+  __ movl(index, last_block);
+  __ movups(block, Address(string_obj, index, ScaleFactor::TIMES_2, value_offset));
+  __ pcmpeqw(block, search_vector);
+  __ pmovmskb(mask, block);
+  __ testl(mask, mask);
+  __ j(kEqual, &not_found_label);
 
-  // Yes, we matched.  Compute the index of the result.
-  __ subl(string_length, counter);
-  __ leal(out, Address(string_length, -1));
+  // The lowest bit set in mask is the first byte of the first matching character.
+  __ Bind(&found_in_block);
+  __ bsfl(mask, mask);
+  __ shrl(mask, Immediate(1));
+  __ leal(out, Address(index, mask, ScaleFactor::TIMES_1, 0));
+  __ jmp(&done);
 
-  NearLabel done;
+  // Fewer than 8 characters to look at, do it one at a time.
+  __ Bind(&scalar_loop);
+  __ movzxw(mask, Address(string_obj, index, ScaleFactor::TIMES_2, value_offset));
+  __ cmpl(mask, search_value);
+  __ j(kEqual, &found_char);
+  __ addl(index, Immediate(1));
+  __ cmpl(index, string_length);
+  __ j(kLess, &scalar_loop);
+  __ jmp(&not_found_label);
+
+  __ Bind(&found_char);
+  __ movl(out, index);
   __ jmp(&done);
 
   // Failed to match; return -1.
@@ -1572,6 +1867,277 @@ void IntrinsicCodeGeneratorX86_64::VisitStringIndexOfAfter(HInvoke* invoke) {
       invoke, GetAssembler(), codegen_, GetAllocator(), /* start_at_zero */ false);
 }
 
+static void CreateArraysEqualsLocations(HInvoke* invoke, ArenaAllocator* allocator) {
+  LocationSummary* locations = new (allocator) LocationSummary(invoke,
+                                                               LocationSummary::kNoCall,
+                                                               kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // Temporary registers for the length in bytes, the index and the vector comparison.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+static void GenerateArraysEquals(LocationSummary* locations,
+                                 X86_64Assembler* assembler,
+                                 Primitive::Type type) {
+  CpuRegister lhs = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister rhs = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister index = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister vtemp1 = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister vtemp2 = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  const size_t component_size = Primitive::ComponentSize(type);
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(component_size).Uint32Value();
+
+  NearLabel end, return_true, return_false, vector_loop, scalar_loop;
+
+  // Same arrays, including both null.
+  __ cmpl(lhs, rhs);
+  __ j(kEqual, &return_true);
+  __ testl(lhs, lhs);
+  __ j(kEqual, &return_false);
+  __ testl(rhs, rhs);
+  __ j(kEqual, &return_false);
+
+  __ movl(length, Address(lhs, length_offset));
+  __ cmpl(length, Address(rhs, length_offset));
+  __ j(kNotEqual, &return_false);
+  if (component_size != 1u) {
+    __ shll(length, Immediate(Primitive::ComponentSizeShift(type)));
+  }
+  __ xorl(index, index);
+  __ cmpl(length, Immediate(kX86_64VectorSize));
+  __ j(kBelow, &scalar_loop);
+
+  // Compare 16 bytes at a time. From here on, length is the offset of the last block.
+  // Comparing 16-bit lanes is fine for any element size as we only look for full equality.
+  __ subl(length, Immediate(kX86_64VectorSize));
+  __ Bind(&vector_loop);
+  GenerateVectorCompare(assembler,
+                        Address(lhs, index, ScaleFactor::TIMES_1, data_offset),
+                        Address(rhs, index, ScaleFactor::TIMES_1, data_offset),
+                        out,
+                        vtemp1,
+                        vtemp2);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(index, Immediate(kX86_64VectorSize));
+  __ cmpl(index, length);
+  __ j(kBelowEqual, &vector_loop);
+  // Compare the last 16 bytes, overlapping with the bytes already compared.
+  GenerateVectorCompare(assembler,
+                        Address(lhs, length, ScaleFactor::TIMES_1, data_offset),
+                        Address(rhs, length, ScaleFactor::TIMES_1, data_offset),
+                        out,
+                        vtemp1,
+                        vtemp2);
+  __ cmpl(out, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ jmp(&return_true);
+
+  // Fewer than 16 bytes to compare, do it one element at a time.
+  __ Bind(&scalar_loop);
+  __ cmpl(index, length);
+  __ j(kEqual, &return_true);
+  Address lhs_element(lhs, index, ScaleFactor::TIMES_1, data_offset);
+  Address rhs_element(rhs, index, ScaleFactor::TIMES_1, data_offset);
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ movzxb(out, lhs_element);
+      __ movzxb(CpuRegister(TMP), rhs_element);
+      __ cmpl(out, CpuRegister(TMP));
+      break;
+    case Primitive::kPrimChar:
+      __ movzxw(out, lhs_element);
+      __ movzxw(CpuRegister(TMP), rhs_element);
+      __ cmpl(out, CpuRegister(TMP));
+      break;
+    case Primitive::kPrimInt:
+      __ movl(out, lhs_element);
+      __ cmpl(out, rhs_element);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ j(kNotEqual, &return_false);
+  __ addl(index, Immediate(component_size));
+  __ jmp(&scalar_loop);
+
+  __ Bind(&return_true);
+  __ movl(out, Immediate(1));
+  __ jmp(&end);
+
+  __ Bind(&return_false);
+  __ xorl(out, out);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetAssembler(), Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysEqualsChar(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysEqualsChar(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetAssembler(), Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysEqualsInt(HInvoke* invoke) {
+  CreateArraysEqualsLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysEqualsInt(HInvoke* invoke) {
+  GenerateArraysEquals(invoke->GetLocations(), GetAssembler(), Primitive::kPrimInt);
+}
+
+static void CreateArraysFillLocations(HInvoke* invoke, ArenaAllocator* allocator) {
+  LocationSummary* locations = new (allocator) LocationSummary(invoke,
+                                                               LocationSummary::kCallOnSlowPath,
+                                                               kIntrinsified);
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // Temporary registers for the length in bytes, the index and the replicated value.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+static void GenerateArraysFill(HInvoke* invoke,
+                               X86_64Assembler* assembler,
+                               CodeGeneratorX86_64* codegen,
+                               ArenaAllocator* allocator,
+                               Primitive::Type type) {
+  LocationSummary* locations = invoke->GetLocations();
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister value = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister index = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister vvalue = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+
+  const size_t component_size = Primitive::ComponentSize(type);
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(component_size).Uint32Value();
+
+  // Let the slow path throw the NullPointerException.
+  SlowPathCode* slow_path = nullptr;
+  if (invoke->InputAt(0)->CanBeNull()) {
+    slow_path = new (allocator) IntrinsicSlowPathX86_64(invoke);
+    codegen->AddSlowPath(slow_path);
+    __ testl(array, array);
+    __ j(kEqual, slow_path->GetEntryLabel());
+  }
+
+  NearLabel done, vector_loop, scalar_loop;
+
+  __ movl(length, Address(array, length_offset));
+  if (component_size != 1u) {
+    __ shll(length, Immediate(Primitive::ComponentSizeShift(type)));
+  }
+  __ xorl(index, index);
+  __ cmpl(length, Immediate(kX86_64VectorSize));
+  __ j(kBelow, &scalar_loop);
+
+  // Replicate the value in all the lanes, using index as a temporary.
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ movzxb(index, value);
+      __ imull(index, index, Immediate(0x01010101));
+      break;
+    case Primitive::kPrimChar:
+      __ movzxw(index, value);
+      __ imull(index, index, Immediate(0x00010001));
+      break;
+    case Primitive::kPrimInt:
+      __ movl(index, value);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ movd(vvalue, index, /* is64bit */ false);
+  __ pshufd(vvalue, vvalue, Immediate(0));
+  __ xorl(index, index);
+
+  // Store 16 bytes at a time. From here on, length is the offset of the last block.
+  __ subl(length, Immediate(kX86_64VectorSize));
+  __ Bind(&vector_loop);
+  __ movups(Address(array, index, ScaleFactor::TIMES_1, data_offset), vvalue);
+  __ addl(index, Immediate(kX86_64VectorSize));
+  __ cmpl(index, length);
+  __ j(kBelowEqual, &vector_loop);
+  // Store the last 16 bytes, overlapping with the bytes already stored.
+  __ movups(Address(array, length, ScaleFactor::TIMES_1, data_offset), vvalue);
+  __ jmp(&done);
+
+  // Fewer than 16 bytes to store, do it one element at a time.
+  __ Bind(&scalar_loop);
+  __ cmpl(index, length);
+  __ j(kEqual, &done);
+  Address element(array, index, ScaleFactor::TIMES_1, data_offset);
+  switch (type) {
+    case Primitive::kPrimByte:
+      __ movb(element, value);
+      break;
+    case Primitive::kPrimChar:
+      __ movw(element, value);
+      break;
+    case Primitive::kPrimInt:
+      __ movl(element, value);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type " << type;
+      UNREACHABLE();
+  }
+  __ addl(index, Immediate(component_size));
+  __ jmp(&scalar_loop);
+
+  __ Bind(&done);
+  if (slow_path != nullptr) {
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetAssembler(), codegen_, GetAllocator(), Primitive::kPrimByte);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillChar(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillChar(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetAssembler(), codegen_, GetAllocator(), Primitive::kPrimChar);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillInt(HInvoke* invoke) {
+  CreateArraysFillLocations(invoke, arena_);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillInt(HInvoke* invoke) {
+  GenerateArraysFill(
+      invoke, GetAssembler(), codegen_, GetAllocator(), Primitive::kPrimInt);
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitStringNewStringFromBytes(HInvoke* invoke) {
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
                                                             LocationSummary::kCallOnMainAndSlowPath,
@@ -1656,6 +2222,24 @@ void IntrinsicCodeGeneratorX86_64::VisitStringNewStringFromString(HInvoke* invok
   __ Bind(slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitObjectClone(HInvoke* invoke) {
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnMainOnly,
+                                                            kIntrinsified);
+  InvokeRuntimeCallingConvention calling_convention;
+  locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  locations->SetOut(Location::RegisterLocation(RAX));
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitObjectClone(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+
+  __ gs()->call(Address::Absolute(QUICK_ENTRYPOINT_OFFSET(kX86_64PointerSize, pCloneObject),
+                                  /* no_rip */ true));
+  CheckEntrypointTypes<kQuickCloneObject, void*, mirror::Object*>();
+  codegen_->RecordPcInfo(invoke, invoke->GetDexPc());
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitStringGetCharsNoCheck(HInvoke* invoke) {
   // public void getChars(int srcBegin, int srcEnd, char[] dst, int dstBegin);
   LocationSummary* locations = new (arena_) LocationSummary(invoke,
@@ -2752,6 +3336,17 @@ UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetInt)
 UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetObject)
 
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderAppendString)
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderAppendBoolean)
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderAppendChar)
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderAppendInt)
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderAppendLong)
+UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderToString)
+
+// The SSE4.2 crc32 instruction computes CRC-32C, not the CRC-32 of java.util.zip.CRC32.
+UNIMPLEMENTED_INTRINSIC(X86_64, CRC32Update)
+UNIMPLEMENTED_INTRINSIC(X86_64, CRC32UpdateBytes)
+
 UNREACHABLE_INTRINSICS(X86_64)
 
 #undef __
@@ -27,11 +27,17 @@ class ReferenceInfo;
 // The number of heap locations for most of the methods stays below this threshold.
 constexpr size_t kMaxNumberOfHeapLocations = 32;
 
+// A cap for the number of places where a partially escaping allocation can escape.
+constexpr size_t kMaxNumberOfEscapes = 4;
+
 // A ReferenceInfo contains additional info about a reference such as
 // whether it's a singleton, returned, etc.
 class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
  public:
-  ReferenceInfo(HInstruction* reference, size_t pos) : reference_(reference), position_(pos) {
+  ReferenceInfo(HInstruction* reference, size_t pos)
+      : reference_(reference),
+        position_(pos),
+        escapes_(reference->GetBlock()->GetGraph()->GetArena()->Adapter(kArenaAllocLSE)) {
     is_singleton_ = true;
     is_singleton_and_not_returned_ = true;
     if (!reference_->IsNewInstance() && !reference_->IsNewArray()) {
@@ -51,8 +57,16 @@ class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
         // Just be conservative for the uncommon cases.
         is_singleton_ = false;
         is_singleton_and_not_returned_ = false;
+        escapes_.clear();
         return;
       }
+      if (IsEscape(user) && CanEscapePartially(user)) {
+        // Recorded as an escape, checked once all uses are known.
+        if (std::find(escapes_.begin(), escapes_.end(), user) == escapes_.end()) {
+          escapes_.push_back(user);
+        }
+        continue;
+      }
       if (user->IsPhi() || user->IsSelect() || user->IsInvoke() ||
           (user->IsInstanceFieldSet() && (reference_ == user->InputAt(1))) ||
           (user->IsUnresolvedInstanceFieldSet() && (reference_ == user->InputAt(1))) ||
@@ -63,6 +77,7 @@ class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
         // reference_ isn't the only name that can refer to its value anymore.
         is_singleton_ = false;
         is_singleton_and_not_returned_ = false;
+        escapes_.clear();
         return;
       }
       if ((user->IsUnresolvedInstanceFieldGet() && (reference_ == user->InputAt(0))) ||
@@ -73,12 +88,21 @@ class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
         // we hit the unresolved access, but disabling is the simplest.
         is_singleton_ = false;
         is_singleton_and_not_returned_ = false;
+        escapes_.clear();
         return;
       }
       if (user->IsReturn()) {
         is_singleton_and_not_returned_ = false;
       }
     }
+
+    if (!escapes_.empty() &&
+        (escapes_.size() > kMaxNumberOfEscapes || IsUsedAfterEscapes())) {
+      // The reference is used once it escaped: it really is not a singleton.
+      is_singleton_ = false;
+      is_singleton_and_not_returned_ = false;
+      escapes_.clear();
+    }
   }
 
   HInstruction* GetReference() const {
@@ -102,11 +126,96 @@ class ReferenceInfo : public ArenaObject<kArenaAllocMisc> {
     return is_singleton_and_not_returned_;
   }
 
+  // Returns true if reference_ is an allocation which escapes (is passed to a callee,
+  // stored to heap or returned) but is not used after any of its escapes. Such a
+  // reference is treated as a singleton until it escapes. Its accesses may only be
+  // eliminated if the object is materialized right before each escape, which is
+  // decided once all accesses have been visited.
+  bool IsPartiallyEscaping() const {
+    return !escapes_.empty();
+  }
+
+  const ArenaVector<HInstruction*>& GetEscapes() const {
+    return escapes_;
+  }
+
  private:
+  bool IsEscape(HInstruction* user) const {
+    return user->IsInvoke() ||
+        user->IsReturn() ||
+        (user->IsInstanceFieldSet() && (reference_ == user->InputAt(1))) ||
+        (user->IsStaticFieldSet() && (reference_ == user->InputAt(1))) ||
+        (user->IsArraySet() && (reference_ == user->InputAt(2)));
+  }
+
+  // Returns whether `user` can be handled as the escape of a partially escaping
+  // allocation. Only plain instance allocations can be materialized again.
+  bool CanEscapePartially(HInstruction* user) const {
+    if (!reference_->IsNewInstance()) {
+      return false;
+    }
+    HNewInstance* new_instance = reference_->AsNewInstance();
+    if (new_instance->IsFinalizable() ||
+        new_instance->NeedsAccessCheck() ||
+        new_instance->IsStringAlloc()) {
+      return false;
+    }
+    // Storing the reference into itself is both an escape and an access.
+    return !(user->IsInstanceFieldSet() && (reference_ == user->InputAt(0)));
+  }
+
+  static bool UsesAsInput(HInstruction* instruction, HInstruction* input) {
+    for (size_t i = 0, e = instruction->InputCount(); i < e; ++i) {
+      if (instruction->InputAt(i) == input) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns whether a non-environment use of reference_, including an escape itself,
+  // can be executed after one of the escapes.
+  bool IsUsedAfterEscapes() const {
+    HGraph* graph = reference_->GetBlock()->GetGraph();
+    ArenaAllocator* arena = graph->GetArena();
+    ArenaBitVector use_blocks(arena, graph->GetBlocks().size(), false, kArenaAllocLSE);
+    for (const HUseListNode<HInstruction*>& use : reference_->GetUses()) {
+      use_blocks.SetBit(use.GetUser()->GetBlock()->GetBlockId());
+    }
+    ArenaBitVector visited(arena, graph->GetBlocks().size(), false, kArenaAllocLSE);
+    ArenaVector<HBasicBlock*> worklist(arena->Adapter(kArenaAllocLSE));
+    for (HInstruction* escape : escapes_) {
+      for (HInstruction* next = escape->GetNext(); next != nullptr; next = next->GetNext()) {
+        if (UsesAsInput(next, reference_)) {
+          return true;
+        }
+      }
+      visited.ClearAllBits();
+      worklist.assign(escape->GetBlock()->GetSuccessors().begin(),
+                      escape->GetBlock()->GetSuccessors().end());
+      while (!worklist.empty()) {
+        HBasicBlock* block = worklist.back();
+        worklist.pop_back();
+        if (visited.IsBitSet(block->GetBlockId())) {
+          continue;
+        }
+        visited.SetBit(block->GetBlockId());
+        if (use_blocks.IsBitSet(block->GetBlockId())) {
+          return true;
+        }
+        worklist.insert(worklist.end(),
+                        block->GetSuccessors().begin(),
+                        block->GetSuccessors().end());
+      }
+    }
+    return false;
+  }
+
   HInstruction* const reference_;
   const size_t position_;     // position in HeapLocationCollector's ref_info_array_.
   bool is_singleton_;         // can only be referred to by a single name in the method.
   bool is_singleton_and_not_returned_;  // reference_ is singleton and not returned to caller.
+  ArenaVector<HInstruction*> escapes_;  // where a partially escaping reference_ escapes.
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceInfo);
 };
@@ -211,6 +320,10 @@ class HeapLocationCollector : public HGraphVisitor {
     return heap_locations_[index];
   }
 
+  const ArenaVector<ReferenceInfo*>& GetReferenceInfos() const {
+    return ref_info_array_;
+  }
+
   ReferenceInfo* FindReferenceInfoOf(HInstruction* ref) const {
     for (size_t i = 0; i < ref_info_array_.size(); i++) {
       ReferenceInfo* ref_info = ref_info_array_[i];
@@ -522,7 +635,16 @@ class LSEVisitor : public HGraphVisitor {
         removed_loads_(graph->GetArena()->Adapter(kArenaAllocLSE)),
         substitute_instructions_for_loads_(graph->GetArena()->Adapter(kArenaAllocLSE)),
         possibly_removed_stores_(graph->GetArena()->Adapter(kArenaAllocLSE)),
-        singleton_new_instances_(graph->GetArena()->Adapter(kArenaAllocLSE)) {
+        singleton_new_instances_(graph->GetArena()->Adapter(kArenaAllocLSE)),
+        heap_values_at_escapes_(std::less<HInstruction*>(),
+                                graph->GetArena()->Adapter(kArenaAllocLSE)) {
+    for (ReferenceInfo* ref_info : heap_locations_collector.GetReferenceInfos()) {
+      for (HInstruction* escape : ref_info->GetEscapes()) {
+        // An invoke can be the escape of several allocations.
+        heap_values_at_escapes_.Overwrite(escape, ArenaVector<HInstruction*>(
+            graph->GetArena()->Adapter(kArenaAllocLSE)));
+      }
+    }
   }
 
   void VisitBasicBlock(HBasicBlock* block) OVERRIDE {
@@ -533,11 +655,35 @@ class LSEVisitor : public HGraphVisitor {
     } else {
       MergePredecessorValues(block);
     }
-    HGraphVisitor::VisitBasicBlock(block);
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      it.Current()->Accept(this);
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      auto escape_it = heap_values_at_escapes_.find(instruction);
+      if (escape_it != heap_values_at_escapes_.end()) {
+        // Remember the heap values a partially escaping allocation is materialized with.
+        escape_it->second = heap_values_for_[block->GetBlockId()];
+      }
+      instruction->Accept(this);
+    }
   }
 
   // Remove recorded instructions that should be eliminated.
   void RemoveInstructions() {
+    // Partially escaping allocations are materialized at their escapes while the
+    // loads are still around to find the values of the fields.
+    for (ReferenceInfo* ref_info : heap_location_collector_.GetReferenceInfos()) {
+      if (!ref_info->IsPartiallyEscaping()) {
+        continue;
+      }
+      if (CanMaterializeAtEscapes(ref_info)) {
+        MaterializeAtEscapes(ref_info);
+      } else {
+        KeepStoresInto(ref_info->GetReference());
+      }
+    }
+
     size_t size = removed_loads_.size();
     DCHECK_EQ(size, substitute_instructions_for_loads_.size());
     for (size_t i = 0; i < size; i++) {
@@ -546,14 +692,7 @@ class LSEVisitor : public HGraphVisitor {
       DCHECK(load->IsInstanceFieldGet() ||
              load->IsStaticFieldGet() ||
              load->IsArrayGet());
-      HInstruction* substitute = substitute_instructions_for_loads_[i];
-      DCHECK(substitute != nullptr);
-      // Keep tracing substitute till one that's not removed.
-      HInstruction* sub_sub = FindSubstitute(substitute);
-      while (sub_sub != substitute) {
-        substitute = sub_sub;
-        sub_sub = FindSubstitute(substitute);
-      }
+      HInstruction* substitute = FindFinalSubstitute(substitute_instructions_for_loads_[i]);
       load->ReplaceWith(substitute);
       load->GetBlock()->RemoveInstruction(load);
     }
@@ -1001,6 +1140,191 @@ class LSEVisitor : public HGraphVisitor {
     return instruction;
   }
 
+  // Keep tracing substitute till one that's not removed.
+  HInstruction* FindFinalSubstitute(HInstruction* substitute) {
+    DCHECK(substitute != nullptr);
+    HInstruction* sub_sub = FindSubstitute(substitute);
+    while (sub_sub != substitute) {
+      substitute = sub_sub;
+      sub_sub = FindSubstitute(substitute);
+    }
+    return substitute;
+  }
+
+  bool IsPossiblyRemovedStore(HInstruction* instruction) const {
+    return std::find(possibly_removed_stores_.begin(), possibly_removed_stores_.end(), instruction)
+        != possibly_removed_stores_.end();
+  }
+
+  // Returns the value the heap location `idx` holds according to `heap_values`,
+  // null if it is the default value.
+  HInstruction* GetMaterializedValue(const ArenaVector<HInstruction*>& heap_values, size_t idx) {
+    HInstruction* heap_value = heap_values[idx];
+    DCHECK_NE(heap_value, kUnknownHeapValue);
+    if (heap_value == kDefaultHeapValue) {
+      return nullptr;
+    }
+    if (heap_value->IsInstanceFieldSet()) {
+      heap_value = heap_value->InputAt(1);
+    }
+    return FindFinalSubstitute(heap_value);
+  }
+
+  // A partially escaping allocation can be removed if all its accesses are removed
+  // and the values of its fields are known at each escape.
+  bool CanMaterializeAtEscapes(ReferenceInfo* ref_info) {
+    if (heap_location_collector_.MayDeoptimize()) {
+      return false;
+    }
+    HInstruction* reference = ref_info->GetReference();
+    for (HInstruction* escape : ref_info->GetEscapes()) {
+      if (escape->GetBlock() == reference->GetBlock()) {
+        // The allocation escapes on all paths, there is nothing to gain.
+        return false;
+      }
+      if (IsPossiblyRemovedStore(escape)) {
+        // The value is forwarded to the loads of the stored location instead.
+        return false;
+      }
+    }
+    for (const HUseListNode<HInstruction*>& use : reference->GetUses()) {
+      HInstruction* user = use.GetUser();
+      const ArenaVector<HInstruction*>& escapes = ref_info->GetEscapes();
+      if (std::find(escapes.begin(), escapes.end(), user) != escapes.end()) {
+        continue;
+      }
+      if (user->IsInstanceFieldGet() &&
+          std::find(removed_loads_.begin(), removed_loads_.end(), user) != removed_loads_.end()) {
+        continue;
+      }
+      if (user->IsInstanceFieldSet() &&
+          user->InputAt(0) == reference &&
+          IsPossiblyRemovedStore(user)) {
+        continue;
+      }
+      return false;
+    }
+    for (HInstruction* substitute : substitute_instructions_for_loads_) {
+      if (FindFinalSubstitute(substitute) == reference) {
+        // The reference flows out of another removed location.
+        return false;
+      }
+    }
+    for (size_t i = 0, e = heap_location_collector_.GetNumberOfHeapLocations(); i < e; ++i) {
+      HeapLocation* location = heap_location_collector_.GetHeapLocation(i);
+      if (location->GetReferenceInfo() != ref_info) {
+        continue;
+      }
+      if (location->GetOffset() < mirror::kObjectHeaderSize ||
+          FindFieldInfo(reference, location) == nullptr) {
+        return false;
+      }
+      for (HInstruction* escape : ref_info->GetEscapes()) {
+        if (heap_values_at_escapes_.find(escape)->second[i] == kUnknownHeapValue) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Finds the field accessed through `location` in the uses of `reference`.
+  const FieldInfo* FindFieldInfo(HInstruction* reference, HeapLocation* location) {
+    for (const HUseListNode<HInstruction*>& use : reference->GetUses()) {
+      HInstruction* user = use.GetUser();
+      const FieldInfo* field_info = nullptr;
+      if (user->IsInstanceFieldGet()) {
+        field_info = &user->AsInstanceFieldGet()->GetFieldInfo();
+      } else if (user->IsInstanceFieldSet() && user->InputAt(0) == reference) {
+        field_info = &user->AsInstanceFieldSet()->GetFieldInfo();
+      }
+      if (field_info != nullptr &&
+          field_info->GetFieldOffset().SizeValue() == location->GetOffset() &&
+          field_info->GetDeclaringClassDefIndex() == location->GetDeclaringClassDefIndex()) {
+        return field_info;
+      }
+    }
+    return nullptr;
+  }
+
+  // Allocates a copy of the object right before each of its escapes, initialized with
+  // the values its fields hold there. The original allocation is then unused and
+  // removed along with the other singletons.
+  void MaterializeAtEscapes(ReferenceInfo* ref_info) {
+    ArenaAllocator* arena = GetGraph()->GetArena();
+    HNewInstance* allocation = ref_info->GetReference()->AsNewInstance();
+    for (HInstruction* escape : ref_info->GetEscapes()) {
+      HNewInstance* new_instance = new (arena) HNewInstance(
+          allocation->InputAt(0),
+          allocation->InputAt(1)->AsCurrentMethod(),
+          escape->GetDexPc(),
+          allocation->GetTypeIndex(),
+          allocation->GetDexFile(),
+          /* needs_access_check */ false,
+          /* finalizable */ false,
+          allocation->GetEntrypoint());
+      escape->GetBlock()->InsertInstructionBefore(new_instance, escape);
+      new_instance->CopyEnvironmentFrom(escape->HasEnvironment()
+                                            ? escape->GetEnvironment()
+                                            : allocation->GetEnvironment());
+      new_instance->SetReferenceTypeInfo(allocation->GetReferenceTypeInfo());
+
+      const ArenaVector<HInstruction*>& heap_values = heap_values_at_escapes_.find(escape)->second;
+      for (size_t i = 0, e = heap_location_collector_.GetNumberOfHeapLocations(); i < e; ++i) {
+        HeapLocation* location = heap_location_collector_.GetHeapLocation(i);
+        if (location->GetReferenceInfo() != ref_info) {
+          continue;
+        }
+        HInstruction* value = GetMaterializedValue(heap_values, i);
+        if (value == nullptr) {
+          // The new object already holds the default value.
+          continue;
+        }
+        const FieldInfo* field_info = FindFieldInfo(allocation, location);
+        HInstanceFieldSet* store = new (arena) HInstanceFieldSet(
+            new_instance,
+            value,
+            field_info->GetFieldType(),
+            field_info->GetFieldOffset(),
+            field_info->IsVolatile(),
+            field_info->GetFieldIndex(),
+            field_info->GetDeclaringClassDefIndex(),
+            field_info->GetDexFile(),
+            field_info->GetDexCache(),
+            escape->GetDexPc());
+        escape->GetBlock()->InsertInstructionBefore(store, escape);
+      }
+
+      for (size_t i = 0, e = escape->InputCount(); i < e; ++i) {
+        if (escape->InputAt(i) == allocation) {
+          escape->ReplaceInput(new_instance, i);
+        }
+      }
+      if (escape->HasEnvironment()) {
+        HEnvironment* environment = escape->GetEnvironment();
+        for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+          if (environment->GetInstructionAt(i) == allocation) {
+            environment->RemoveAsUserOfInput(i);
+            environment->SetRawEnvAt(i, new_instance);
+            new_instance->AddEnvUseAt(environment, i);
+          }
+        }
+      }
+    }
+  }
+
+  // The stores into a partially escaping allocation which is not materialized
+  // are needed by its escapes.
+  void KeepStoresInto(HInstruction* reference) {
+    possibly_removed_stores_.erase(
+        std::remove_if(possibly_removed_stores_.begin(),
+                       possibly_removed_stores_.end(),
+                       [reference](HInstruction* store) {
+                         return store->IsInstanceFieldSet() && store->InputAt(0) == reference;
+                       }),
+        possibly_removed_stores_.end());
+  }
+
   const HeapLocationCollector& heap_location_collector_;
   const SideEffectsAnalysis& side_effects_;
 
@@ -1018,6 +1342,9 @@ class LSEVisitor : public HGraphVisitor {
 
   ArenaVector<HInstruction*> singleton_new_instances_;
 
+  // The heap values right before each escape of the partially escaping allocations.
+  ArenaSafeMap<HInstruction*, ArenaVector<HInstruction*>> heap_values_at_escapes_;
+
   DISALLOW_COPY_AND_ASSIGN(LSEVisitor);
 };
 
@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loop_unrolling.h"
+
+#include "induction_var_analysis.h"
+#include "induction_var_range.h"
+
+namespace art {
+
+// Loops running at most that many iterations are candidates for full unrolling.
+static constexpr int64_t kMaxFullUnrollingTripCount = 8;
+
+// Maximum number of instructions added by fully unrolling a loop, and by peeling an
+// iteration of a loop.
+static constexpr size_t kFullUnrollingBudget = 48;
+static constexpr size_t kPeelingBudget = 24;
+
+// Instructions that `HLoopUnrolling::Clone` knows how to copy, besides conditions.
+#define FOR_EACH_CLONABLE_BINARY_OPERATION(M)                           \
+  M(Add)                                                                \
+  M(Sub)                                                                \
+  M(Mul)                                                                \
+  M(Div)                                                                \
+  M(Rem)                                                                \
+  M(And)                                                                \
+  M(Or)                                                                 \
+  M(Xor)                                                                \
+  M(Shl)                                                                \
+  M(Shr)                                                                \
+  M(UShr)
+
+#define FOR_EACH_CLONABLE_CONDITION(M)                                  \
+  M(Equal)                                                              \
+  M(NotEqual)                                                           \
+  M(LessThan)                                                           \
+  M(LessThanOrEqual)                                                    \
+  M(GreaterThan)                                                        \
+  M(GreaterThanOrEqual)                                                 \
+  M(Below)                                                              \
+  M(BelowOrEqual)                                                       \
+  M(Above)                                                              \
+  M(AboveOrEqual)
+
+#define FOR_EACH_CLONABLE_OTHER_INSTRUCTION(M)                          \
+  M(Neg)                                                                \
+  M(Not)                                                                \
+  M(TypeConversion)                                                     \
+  M(NullCheck)                                                          \
+  M(DivZeroCheck)                                                       \
+  M(BoundsCheck)                                                        \
+  M(ArrayLength)                                                        \
+  M(ArrayGet)                                                           \
+  M(ArraySet)                                                           \
+  M(BoundType)                                                          \
+  M(InstanceOf)                                                         \
+  M(CheckCast)
+
+static bool IsClonable(HInstruction* instruction) {
+  switch (instruction->GetKind()) {
+#define CASE_CLONABLE(name) case HInstruction::k##name:
+    FOR_EACH_CLONABLE_BINARY_OPERATION(CASE_CLONABLE)
+    FOR_EACH_CLONABLE_CONDITION(CASE_CLONABLE)
+    FOR_EACH_CLONABLE_OTHER_INSTRUCTION(CASE_CLONABLE)
+#undef CASE_CLONABLE
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Whether `instruction` is a check of loop invariant values, which peeling makes redundant
+// in the loop.
+static bool IsInvariantCheck(HLoopInformation* loop, HInstruction* instruction) {
+  if (!instruction->IsNullCheck() &&
+      !instruction->IsDivZeroCheck() &&
+      !instruction->IsBoundsCheck() &&
+      !instruction->IsInstanceOf() &&
+      !instruction->IsCheckCast()) {
+    return false;
+  }
+  for (HInstruction* input : instruction->GetInputs()) {
+    if (!loop->IsDefinedOutOfTheLoop(input)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Replaces the loop values in the environment chain of a copied instruction by their value
+// in the copied iteration.
+static void RemapEnvironment(HEnvironment* environment,
+                             const ArenaSafeMap<HInstruction*, HInstruction*>& values) {
+  for (; environment != nullptr; environment = environment->GetParent()) {
+    for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+      auto it = values.find(environment->GetInstructionAt(i));
+      if (it != values.end()) {
+        environment->RemoveAsUserOfInput(i);
+        environment->SetRawEnvAt(i, it->second);
+        it->second->AddEnvUseAt(environment, i);
+      }
+    }
+  }
+}
+
+HLoopUnrolling::HLoopUnrolling(HGraph* graph,
+                               HInductionVarAnalysis* induction_analysis,
+                               OptimizingCompilerStats* stats)
+    : HOptimization(graph, kLoopUnrollingPassName, stats),
+      induction_analysis_(induction_analysis) {}
+
+void HLoopUnrolling::Run() {
+  ArenaAllocator* arena = graph_->GetArena();
+  InductionVarRange induction_range(induction_analysis_);
+
+  // Innermost loops are disjoint, transforming one does not affect the shape of another.
+  ArenaVector<HLoopInformation*> loops(arena->Adapter(kArenaAllocLoopUnrolling));
+  for (HPostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    if (it.Current()->IsLoopHeader()) {
+      loops.push_back(it.Current()->GetLoopInformation());
+    }
+  }
+
+  bool cfg_changed = false;
+  for (HLoopInformation* loop : loops) {
+    HBasicBlock* body = GetSimpleLoopBody(loop);
+    if (body == nullptr) {
+      continue;
+    }
+    HBasicBlock* header = loop->GetHeader();
+    size_t body_size = 0;
+    bool has_invariant_check = false;
+    for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+      if (!it.Current()->IsGoto()) {
+        ++body_size;
+        has_invariant_check |= IsInvariantCheck(loop, it.Current());
+      }
+    }
+
+    int64_t trip_count = -1;
+    bool is_taken = induction_range.IsFiniteTakenLoop(loop, &trip_count);
+    if (is_taken &&
+        trip_count > 0 &&
+        trip_count <= kMaxFullUnrollingTripCount &&
+        static_cast<size_t>(trip_count) * body_size <= kFullUnrollingBudget) {
+      // Copy all the iterations, the loop is then left with none to run.
+      HInstruction* cursor = loop->GetPreHeader()->GetLastInstruction();
+      for (int64_t i = 0; i < trip_count; ++i) {
+        PeelIteration(loop, body, cursor);
+      }
+      HIf* exit_test = header->GetLastInstruction()->AsIf();
+      HInstruction* condition = exit_test->InputAt(0);
+      bool stay_if_true = (exit_test->IfTrueSuccessor() == body);
+      exit_test->ReplaceInput(graph_->GetIntConstant(stay_if_true ? 0 : 1), 0);
+      header->RemoveInstruction(condition);
+      MaybeRecordStat(MethodCompilationStat::kLoopFullyUnrolled);
+      continue;
+    }
+
+    if (!has_invariant_check || body_size > kPeelingBudget) {
+      continue;
+    }
+    if (is_taken) {
+      PeelIteration(loop, body, loop->GetPreHeader()->GetLastInstruction());
+    } else {
+      HBasicBlock* exit = header->GetSuccessors()[0] == body
+          ? header->GetSuccessors()[1]
+          : header->GetSuccessors()[0];
+      if (exit->GetSinglePredecessor() != header || !exit->GetPhis().IsEmpty()) {
+        continue;
+      }
+      PeelGuardedIteration(loop, body);
+      cfg_changed = true;
+    }
+    MaybeRecordStat(MethodCompilationStat::kLoopPeeled);
+  }
+
+  if (cfg_changed) {
+    graph_->ClearLoopInformation();
+    graph_->ClearDominanceInformation();
+    graph_->BuildDominatorTree();
+  }
+}
+
+HBasicBlock* HLoopUnrolling::GetSimpleLoopBody(HLoopInformation* loop) const {
+  HBasicBlock* header = loop->GetHeader();
+  if (loop->IsIrreducible() ||
+      loop->NumberOfBackEdges() != 1u ||
+      loop->GetBlocks().NumSetBits() != 2u ||
+      header->IsTryBlock() ||
+      !loop->GetPreHeader()->GetLastInstruction()->IsGoto()) {
+    return nullptr;
+  }
+  HBasicBlock* body = loop->GetBackEdges()[0];
+  if (body == header ||
+      body->IsTryBlock() ||
+      body->GetSinglePredecessor() != header ||
+      !body->GetPhis().IsEmpty() ||
+      !body->GetLastInstruction()->IsGoto()) {
+    return nullptr;
+  }
+
+  // The header only holds the phis, the suspend check and the exit test.
+  HInstruction* suspend_check = header->GetFirstInstruction();
+  if (!suspend_check->IsSuspendCheck() || suspend_check != loop->GetSuspendCheck()) {
+    return nullptr;
+  }
+  HInstruction* condition = suspend_check->GetNext();
+  HInstruction* exit_test = header->GetLastInstruction();
+  if (!exit_test->IsIf() ||
+      condition->GetNext() != exit_test ||
+      exit_test->InputAt(0) != condition ||
+      !condition->IsCondition() ||
+      !condition->HasOnlyOneNonEnvironmentUse() ||
+      !IsClonable(condition)) {
+    return nullptr;
+  }
+
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    if (!it.Current()->IsGoto() && !IsClonable(it.Current())) {
+      return nullptr;
+    }
+  }
+  return body;
+}
+
+void HLoopUnrolling::PeelIteration(HLoopInformation* loop,
+                                   HBasicBlock* body,
+                                   HInstruction* cursor) {
+  ArenaAllocator* arena = graph_->GetArena();
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* block = cursor->GetBlock();
+
+  ValueMap values(std::less<HInstruction*>(), arena->Adapter(kArenaAllocLoopUnrolling));
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    values.Put(it.Current(), it.Current()->InputAt(0));
+  }
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction->IsGoto()) {
+      continue;
+    }
+    HInstruction* copy = Clone(instruction, values);
+    block->InsertInstructionBefore(copy, cursor);
+    if (instruction->HasEnvironment()) {
+      copy->CopyEnvironmentFrom(instruction->GetEnvironment());
+      RemapEnvironment(copy->GetEnvironment(), values);
+    }
+    values.Put(instruction, copy);
+  }
+
+  // The phis now enter the loop with the values of the next iteration. All the back edge
+  // values are read before any phi is updated, as one phi may feed another.
+  ArenaVector<HInstruction*> next_values(arena->Adapter(kArenaAllocLoopUnrolling));
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HInstruction* back_edge_value = it.Current()->InputAt(1);
+    auto value_it = values.find(back_edge_value);
+    next_values.push_back(value_it != values.end() ? value_it->second : back_edge_value);
+  }
+  size_t phi_index = 0;
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    it.Current()->ReplaceInput(next_values[phi_index++], 0);
+  }
+}
+
+void HLoopUnrolling::PeelGuardedIteration(HLoopInformation* loop, HBasicBlock* body) {
+  ArenaAllocator* arena = graph_->GetArena();
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* pre_header = loop->GetPreHeader();
+  HIf* exit_test = header->GetLastInstruction()->AsIf();
+
+  // pre_header: if (<exit test of the first iteration>) -> peeled -> header <-> body
+  //                                                      -> exit
+  ValueMap initial_values(std::less<HInstruction*>(), arena->Adapter(kArenaAllocLoopUnrolling));
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    initial_values.Put(it.Current(), it.Current()->InputAt(0));
+  }
+  HBasicBlock* peeled = new (arena) HBasicBlock(graph_, header->GetDexPc());
+  graph_->AddBlock(peeled);
+  HInstruction* pre_header_goto = pre_header->GetLastInstruction();
+  HInstruction* guard = Clone(exit_test->InputAt(0), initial_values);
+  pre_header->InsertInstructionBefore(guard, pre_header_goto);
+  pre_header->RemoveInstruction(pre_header_goto);
+  pre_header->AddInstruction(new (arena) HIf(guard, exit_test->GetDexPc()));
+  header->ReplacePredecessor(pre_header, peeled);
+  HBasicBlock* exit = nullptr;
+  for (HBasicBlock* successor : header->GetSuccessors()) {
+    if (successor == body) {
+      pre_header->AddSuccessor(peeled);
+    } else {
+      exit = successor;
+      pre_header->AddSuccessor(exit);
+    }
+  }
+  peeled->AddInstruction(new (arena) HGoto(header->GetDexPc()));
+  PeelIteration(loop, body, peeled->GetLastInstruction());
+
+  // The values of the header phis after the loop now depend on whether it was entered.
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    ArenaVector<std::pair<HInstruction*, size_t>> uses(
+        arena->Adapter(kArenaAllocLoopUnrolling));
+    ArenaVector<std::pair<HEnvironment*, size_t>> env_uses(
+        arena->Adapter(kArenaAllocLoopUnrolling));
+    for (const HUseListNode<HInstruction*>& use : phi->GetUses()) {
+      if (!loop->Contains(*use.GetUser()->GetBlock())) {
+        uses.push_back(std::make_pair(use.GetUser(), use.GetIndex()));
+      }
+    }
+    for (const HUseListNode<HEnvironment*>& use : phi->GetEnvUses()) {
+      if (!loop->Contains(*use.GetUser()->GetHolder()->GetBlock())) {
+        env_uses.push_back(std::make_pair(use.GetUser(), use.GetIndex()));
+      }
+    }
+    if (uses.empty() && env_uses.empty()) {
+      continue;
+    }
+    HPhi* merge = new (arena) HPhi(arena, phi->GetRegNumber(), 0, phi->GetType());
+    exit->AddPhi(merge);
+    merge->AddInput(phi);  // From the header.
+    merge->AddInput(initial_values.Get(phi));  // From the pre-header.
+    if (phi->GetType() == Primitive::kPrimNot) {
+      // The header phi already merges its initial value.
+      merge->SetCanBeNull(phi->CanBeNull());
+      if (phi->GetReferenceTypeInfo().IsValid()) {
+        merge->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
+      }
+    }
+    for (const std::pair<HInstruction*, size_t>& use : uses) {
+      use.first->ReplaceInput(merge, use.second);
+    }
+    for (const std::pair<HEnvironment*, size_t>& use : env_uses) {
+      use.first->RemoveAsUserOfInput(use.second);
+      use.first->SetRawEnvAt(use.second, merge);
+      merge->AddEnvUseAt(use.first, use.second);
+    }
+  }
+}
+
+HInstruction* HLoopUnrolling::Clone(HInstruction* instruction, const ValueMap& values) const {
+  ArenaAllocator* arena = graph_->GetArena();
+  auto input = [&](size_t index) {
+    HInstruction* original = instruction->InputAt(index);
+    auto it = values.find(original);
+    return it != values.end() ? it->second : original;
+  };
+  const Primitive::Type type = instruction->GetType();
+  const uint32_t dex_pc = instruction->GetDexPc();
+  HInstruction* copy = nullptr;
+  switch (instruction->GetKind()) {
+#define CASE_BINARY_OPERATION(name)                                     \
+    case HInstruction::k##name:                                         \
+      copy = new (arena) H##name(type, input(0), input(1), dex_pc);     \
+      break;
+    FOR_EACH_CLONABLE_BINARY_OPERATION(CASE_BINARY_OPERATION)
+#undef CASE_BINARY_OPERATION
+#define CASE_CONDITION(name)                                            \
+    case HInstruction::k##name:                                         \
+      copy = new (arena) H##name(input(0), input(1), dex_pc);           \
+      copy->AsCondition()->SetBias(instruction->AsCondition()->GetBias()); \
+      break;
+    FOR_EACH_CLONABLE_CONDITION(CASE_CONDITION)
+#undef CASE_CONDITION
+    case HInstruction::kNeg:
+      copy = new (arena) HNeg(type, input(0), dex_pc);
+      break;
+    case HInstruction::kNot:
+      copy = new (arena) HNot(type, input(0), dex_pc);
+      break;
+    case HInstruction::kTypeConversion:
+      copy = new (arena) HTypeConversion(type, input(0), dex_pc);
+      break;
+    case HInstruction::kNullCheck:
+      copy = new (arena) HNullCheck(input(0), dex_pc);
+      break;
+    case HInstruction::kDivZeroCheck:
+      copy = new (arena) HDivZeroCheck(input(0), dex_pc);
+      break;
+    case HInstruction::kBoundsCheck:
+      copy = new (arena) HBoundsCheck(
+          input(0), input(1), dex_pc, instruction->AsBoundsCheck()->GetStringCharAtMethodIndex());
+      break;
+    case HInstruction::kArrayLength:
+      copy = new (arena) HArrayLength(
+          input(0), dex_pc, instruction->AsArrayLength()->IsStringLength());
+      break;
+    case HInstruction::kArrayGet:
+      copy = new (arena) HArrayGet(
+          input(0), input(1), type, dex_pc, instruction->AsArrayGet()->IsStringCharAt());
+      break;
+    case HInstruction::kArraySet: {
+      HArraySet* set = instruction->AsArraySet();
+      HArraySet* set_copy = new (arena) HArraySet(
+          input(0), input(1), input(2), set->GetRawExpectedComponentType(), dex_pc);
+      if (!set->NeedsTypeCheck()) {
+        set_copy->ClearNeedsTypeCheck();
+      }
+      if (!set->GetValueCanBeNull()) {
+        set_copy->ClearValueCanBeNull();
+      }
+      if (set->StaticTypeOfArrayIsObjectArray()) {
+        set_copy->SetStaticTypeOfArrayIsObjectArray();
+      }
+      copy = set_copy;
+      break;
+    }
+    case HInstruction::kBoundType: {
+      HBoundType* bound_type = instruction->AsBoundType();
+      HBoundType* bound_type_copy = new (arena) HBoundType(input(0), dex_pc);
+      bound_type_copy->SetUpperBound(bound_type->GetUpperBound(),
+                                     bound_type->GetUpperCanBeNull());
+      bound_type_copy->SetCanBeNull(bound_type->CanBeNull());
+      copy = bound_type_copy;
+      break;
+    }
+    case HInstruction::kInstanceOf: {
+      HInstanceOf* instance_of = instruction->AsInstanceOf();
+      HInstanceOf* instance_of_copy = new (arena) HInstanceOf(
+          input(0),
+          input(1)->AsLoadClass(),
+          instance_of->GetTypeCheckKind(),
+          instance_of->GetSuperclassDisplayDepth(),
+          dex_pc);
+      if (!instance_of->MustDoNullCheck()) {
+        instance_of_copy->ClearMustDoNullCheck();
+      }
+      copy = instance_of_copy;
+      break;
+    }
+    case HInstruction::kCheckCast: {
+      HCheckCast* check_cast = instruction->AsCheckCast();
+      HCheckCast* check_cast_copy = new (arena) HCheckCast(
+          input(0),
+          input(1)->AsLoadClass(),
+          check_cast->GetTypeCheckKind(),
+          check_cast->GetSuperclassDisplayDepth(),
+          dex_pc);
+      if (!check_cast->MustDoNullCheck()) {
+        check_cast_copy->ClearMustDoNullCheck();
+      }
+      copy = check_cast_copy;
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected instruction " << instruction->DebugName();
+      UNREACHABLE();
+  }
+  if (type == Primitive::kPrimNot && instruction->GetReferenceTypeInfo().IsValid()) {
+    copy->SetReferenceTypeInfo(instruction->GetReferenceTypeInfo());
+  }
+  return copy;
+}
+
+}  // namespace art
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_LOOP_UNROLLING_H_
+#define ART_COMPILER_OPTIMIZING_LOOP_UNROLLING_H_
+
+#include "base/arena_containers.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class HInductionVarAnalysis;
+
+/**
+ * Unrolls and peels innermost loops made of a header and a single body block,
+ * within a code size budget:
+ *
+ *  - A loop with a small constant trip count is fully unrolled: the iterations are
+ *    copied in front of the loop, whose exit test is then made constant so that dead
+ *    code elimination removes it.
+ *  - Otherwise, the first iteration of a loop whose body checks a loop invariant value
+ *    (null checks, type checks, ...) is peeled. The remaining iterations are then
+ *    dominated by the peeled checks, which GVN uses to remove them from the loop, and
+ *    BCE and LICM see a loop free of them.
+ *
+ * Trip counts come from the induction variable analysis. When the loop is not known to
+ * be entered, the peeled iteration is guarded by a copy of the exit test.
+ */
+class HLoopUnrolling : public HOptimization {
+ public:
+  HLoopUnrolling(HGraph* graph,
+                 HInductionVarAnalysis* induction_analysis,
+                 OptimizingCompilerStats* stats);
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kLoopUnrollingPassName = "loop_unrolling";
+
+ private:
+  // Maps instructions of the loop to their value in the iteration being copied.
+  using ValueMap = ArenaSafeMap<HInstruction*, HInstruction*>;
+
+  // Returns the body of the given loop if it has the shape handled by this pass,
+  // null otherwise.
+  HBasicBlock* GetSimpleLoopBody(HLoopInformation* loop) const;
+
+  // Copies one iteration of `loop` before the instruction `cursor`, which must dominate
+  // the loop. The header phis are then updated to start from the following iteration.
+  void PeelIteration(HLoopInformation* loop, HBasicBlock* body, HInstruction* cursor);
+
+  // Peels the first iteration of a loop which may not be entered, behind a copy of the
+  // exit test.
+  void PeelGuardedIteration(HLoopInformation* loop, HBasicBlock* body);
+
+  HInstruction* Clone(HInstruction* instruction, const ValueMap& values) const;
+
+  HInductionVarAnalysis* const induction_analysis_;
+
+  DISALLOW_COPY_AND_ASSIGN(HLoopUnrolling);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_LOOP_UNROLLING_H_
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "induction_var_analysis.h"
+#include "loop_unrolling.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+namespace art {
+
+/**
+ * Fixture class for the LoopUnrolling tests.
+ */
+class LoopUnrollingTest : public CommonCompilerTest {
+ public:
+  LoopUnrollingTest() : pool_(), allocator_(&pool_) {
+    graph_ = CreateGraph(&allocator_);
+  }
+
+  ~LoopUnrollingTest() { }
+
+  // Builds `for (int i = 0; i < upper; i++) { <body> }`, the body is populated by the
+  // tests before the increment.
+  void BuildLoop(HInstruction* upper) {
+    entry_ = new (&allocator_) HBasicBlock(graph_);
+    loop_preheader_ = new (&allocator_) HBasicBlock(graph_);
+    loop_header_ = new (&allocator_) HBasicBlock(graph_);
+    loop_body_ = new (&allocator_) HBasicBlock(graph_);
+    return_ = new (&allocator_) HBasicBlock(graph_);
+    exit_ = new (&allocator_) HBasicBlock(graph_);
+
+    graph_->AddBlock(entry_);
+    graph_->AddBlock(loop_preheader_);
+    graph_->AddBlock(loop_header_);
+    graph_->AddBlock(loop_body_);
+    graph_->AddBlock(return_);
+    graph_->AddBlock(exit_);
+
+    graph_->SetEntryBlock(entry_);
+    graph_->SetExitBlock(exit_);
+
+    entry_->AddSuccessor(loop_preheader_);
+    loop_preheader_->AddSuccessor(loop_header_);
+    loop_header_->AddSuccessor(loop_body_);
+    loop_header_->AddSuccessor(return_);
+    loop_body_->AddSuccessor(loop_header_);
+    return_->AddSuccessor(exit_);
+
+    entry_->AddInstruction(new (&allocator_) HGoto());
+    loop_preheader_->AddInstruction(new (&allocator_) HGoto());
+
+    phi_ = new (&allocator_) HPhi(&allocator_, 0, 0, Primitive::kPrimInt);
+    loop_header_->AddPhi(phi_);
+    HSuspendCheck* suspend_check = new (&allocator_) HSuspendCheck();
+    loop_header_->AddInstruction(suspend_check);
+    AddEnvironment(suspend_check);
+    condition_ = new (&allocator_) HLessThan(phi_, upper);
+    loop_header_->AddInstruction(condition_);
+    loop_header_->AddInstruction(new (&allocator_) HIf(condition_));
+
+    increment_ = new (&allocator_) HAdd(Primitive::kPrimInt, phi_, graph_->GetIntConstant(1));
+    loop_body_->AddInstruction(increment_);
+    loop_body_->AddInstruction(new (&allocator_) HGoto());
+    phi_->AddInput(graph_->GetIntConstant(0));
+    phi_->AddInput(increment_);
+
+    return_->AddInstruction(new (&allocator_) HReturn(phi_));
+    exit_->AddInstruction(new (&allocator_) HExit());
+  }
+
+  // Gives `instruction` an environment holding the induction.
+  void AddEnvironment(HInstruction* instruction) {
+    HEnvironment* environment = new (&allocator_) HEnvironment(
+        &allocator_, 1, graph_->GetDexFile(), graph_->GetMethodIdx(), 0, kStatic, instruction);
+    instruction->SetRawEnvironment(environment);
+    environment->SetRawEnvAt(0, phi_);
+    phi_->AddEnvUseAt(environment, 0);
+  }
+
+  HInstruction* InsertInBody(HInstruction* instruction) {
+    loop_body_->InsertInstructionBefore(instruction, increment_);
+    return instruction;
+  }
+
+  void PerformUnrolling() {
+    graph_->BuildDominatorTree();
+    HInductionVarAnalysis induction(graph_);
+    induction.Run();
+    HLoopUnrolling(graph_, &induction, nullptr).Run();
+  }
+
+  // Returns the number of instructions of the given kind in `block`.
+  static size_t CountInstructions(HBasicBlock* block, HInstruction::InstructionKind kind) {
+    size_t count = 0;
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (it.Current()->GetKind() == kind) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  // General building fields.
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+
+  // Specific basic blocks.
+  HBasicBlock* entry_;
+  HBasicBlock* loop_preheader_;
+  HBasicBlock* loop_header_;
+  HBasicBlock* loop_body_;
+  HBasicBlock* return_;
+  HBasicBlock* exit_;
+
+  HPhi* phi_;
+  HInstruction* condition_;
+  HInstruction* increment_;
+};
+
+//
+// The actual LoopUnrolling tests.
+//
+
+TEST_F(LoopUnrollingTest, FullUnrolling) {
+  // for (int i = 0; i < 4; i++) a[i] = i;
+  HInstruction* array =
+      new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+  BuildLoop(graph_->GetIntConstant(4));
+  entry_->InsertInstructionBefore(array, entry_->GetLastInstruction());
+  InsertInBody(new (&allocator_) HArraySet(array, phi_, phi_, Primitive::kPrimInt, 0));
+
+  PerformUnrolling();
+
+  // All iterations are in front of the loop, which is no longer entered.
+  EXPECT_EQ(4u, CountInstructions(loop_preheader_, HInstruction::kArraySet));
+  EXPECT_EQ(4u, CountInstructions(loop_preheader_, HInstruction::kAdd));
+  HInstruction* exit_test = loop_header_->GetLastInstruction();
+  ASSERT_TRUE(exit_test->IsIf());
+  EXPECT_TRUE(exit_test->InputAt(0)->IsIntConstant());
+  EXPECT_FALSE(condition_->IsInBlock());
+  // The value after the loop is the one computed by the last copied iteration.
+  EXPECT_EQ(phi_->InputAt(0)->GetBlock(), loop_preheader_);
+}
+
+TEST_F(LoopUnrollingTest, PeelInvariantNullCheck) {
+  // for (int i = 0; i < n; i++) a[i] = i;  with a null check of `a` in the loop.
+  HInstruction* array =
+      new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+  HInstruction* upper =
+      new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 1, Primitive::kPrimInt);
+  BuildLoop(upper);
+  entry_->InsertInstructionBefore(array, entry_->GetLastInstruction());
+  entry_->InsertInstructionBefore(upper, entry_->GetLastInstruction());
+  HInstruction* null_check = InsertInBody(new (&allocator_) HNullCheck(array, 0));
+  AddEnvironment(null_check);
+  InsertInBody(new (&allocator_) HArraySet(null_check, phi_, phi_, Primitive::kPrimInt, 0));
+
+  PerformUnrolling();
+
+  // The peeled iteration is guarded by the exit test and dominates the loop.
+  EXPECT_TRUE(loop_preheader_->GetLastInstruction()->IsIf());
+  HBasicBlock* peeled = loop_header_->GetLoopInformation()->GetPreHeader();
+  ASSERT_NE(peeled, loop_preheader_);
+  EXPECT_EQ(1u, CountInstructions(peeled, HInstruction::kNullCheck));
+  EXPECT_EQ(1u, CountInstructions(peeled, HInstruction::kArraySet));
+  EXPECT_EQ(1u, CountInstructions(loop_body_, HInstruction::kNullCheck));
+  EXPECT_EQ(phi_->InputAt(0)->GetBlock(), peeled);
+  // The environment of the copy sees the value of the induction in the first iteration.
+  HInstruction* peeled_check = peeled->GetFirstInstruction();
+  ASSERT_TRUE(peeled_check->IsNullCheck());
+  EXPECT_EQ(peeled_check->GetEnvironment()->GetInstructionAt(0), graph_->GetIntConstant(0));
+  // After the loop, `i` is either the initial value or the value at the loop exit.
+  HInstruction* result = return_->GetLastInstruction()->InputAt(0);
+  ASSERT_TRUE(result->IsPhi());
+  EXPECT_EQ(result->InputAt(0), phi_);
+  EXPECT_EQ(result->InputAt(1), graph_->GetIntConstant(0));
+}
+
+TEST_F(LoopUnrollingTest, NoPeelingWithoutInvariantCheck) {
+  // for (int i = 0; i < n; i++) a[i] = i;
+  HInstruction* array =
+      new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+  HInstruction* upper =
+      new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 1, Primitive::kPrimInt);
+  BuildLoop(upper);
+  entry_->InsertInstructionBefore(array, entry_->GetLastInstruction());
+  entry_->InsertInstructionBefore(upper, entry_->GetLastInstruction());
+  InsertInBody(new (&allocator_) HArraySet(array, phi_, phi_, Primitive::kPrimInt, 0));
+
+  PerformUnrolling();
+
+  EXPECT_TRUE(loop_preheader_->GetLastInstruction()->IsGoto());
+  EXPECT_EQ(phi_->InputAt(0), graph_->GetIntConstant(0));
+}
+
+}  // namespace art
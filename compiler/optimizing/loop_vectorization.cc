@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loop_vectorization.h"
+
+#include <limits>
+
+#include "arch/instruction_set_features.h"
+#include "arch/x86_64/instruction_set_features_x86_64.h"
+#include "base/arena_containers.h"
+#include "code_generator.h"
+#include "induction_var_analysis.h"
+
+namespace art {
+
+// Vector values must stay in registers: their spill slots and parallel moves only preserve
+// the low 64 bits. Within the vector body, which has no safepoint, the register allocator
+// never spills as long as all floating point values live there fit in registers. This is
+// the number of floating point registers kept out of that budget, for scratch and blocked
+// registers.
+static constexpr size_t kReservedFpRegisters = 4;
+
+static bool IsPackedType(Primitive::Type type) {
+  return type == Primitive::kPrimInt || type == Primitive::kPrimFloat;
+}
+
+HLoopVectorization::HLoopVectorization(HGraph* graph,
+                                       CodeGenerator* codegen,
+                                       const InstructionSetFeatures& isa_features,
+                                       HInductionVarAnalysis* induction_analysis,
+                                       OptimizingCompilerStats* stats)
+    : HOptimization(graph, kLoopVectorizationPassName, stats),
+      codegen_(codegen),
+      induction_analysis_(induction_analysis),
+      has_packed_int_mul_(isa_features.GetInstructionSet() != kX86_64 ||
+                          isa_features.AsX86_64InstructionSetFeatures()->HasSSE4_1()),
+      live_fp_scalars_(0) {}
+
+void HLoopVectorization::Run() {
+  InstructionSet instruction_set = codegen_->GetInstructionSet();
+  if (instruction_set != kArm64 && instruction_set != kX86_64) {
+    return;
+  }
+  // The vector loop has no dex pc of its own to enter from the interpreter, and leaves
+  // nothing for a debugger to inspect in the middle of its iterations.
+  if (graph_->IsCompilingOsr() || graph_->IsDebuggable()) {
+    return;
+  }
+
+  // Conservatively count the floating point values which may be live in any loop: those
+  // used outside of the block that defines them.
+  live_fp_scalars_ = 0;
+  for (HReversePostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    for (HInstructionIterator phi_it(block->GetPhis()); !phi_it.Done(); phi_it.Advance()) {
+      if (Primitive::IsFloatingPointType(phi_it.Current()->GetType())) {
+        ++live_fp_scalars_;
+      }
+    }
+    for (HInstructionIterator inst(block->GetInstructions()); !inst.Done(); inst.Advance()) {
+      HInstruction* instruction = inst.Current();
+      if (!Primitive::IsFloatingPointType(instruction->GetType())) {
+        continue;
+      }
+      bool used_elsewhere = false;
+      for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+        used_elsewhere |= (use.GetUser()->GetBlock() != block);
+      }
+      for (const HUseListNode<HEnvironment*>& use : instruction->GetEnvUses()) {
+        used_elsewhere |= (use.GetUser()->GetHolder()->GetBlock() != block);
+      }
+      if (used_elsewhere) {
+        ++live_fp_scalars_;
+      }
+    }
+  }
+
+  ArenaVector<Candidate> candidates(graph_->GetArena()->Adapter(kArenaAllocLoopVectorization));
+  for (HPostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    Candidate candidate;
+    if (block->IsLoopHeader() && IsCandidate(block->GetLoopInformation(), &candidate)) {
+      candidates.push_back(candidate);
+    }
+  }
+  if (candidates.empty()) {
+    return;
+  }
+
+  for (const Candidate& candidate : candidates) {
+    Vectorize(candidate);
+    MaybeRecordStat(MethodCompilationStat::kLoopVectorized);
+  }
+
+  // Each vector loop adds a loop and three blocks, recompute dominance and loop information.
+  graph_->ClearLoopInformation();
+  graph_->ClearDominanceInformation();
+  graph_->BuildDominatorTree();
+}
+
+bool HLoopVectorization::IsSupportedOperation(HInstruction::InstructionKind op,
+                                              Primitive::Type packed_type) const {
+  if (!HVecBinaryOperation::IsSupported(op, packed_type)) {
+    return false;
+  }
+  return op != HInstruction::kMul || packed_type != Primitive::kPrimInt || has_packed_int_mul_;
+}
+
+bool HLoopVectorization::IsCandidate(HLoopInformation* loop, Candidate* candidate) const {
+  // An innermost loop made of its header and a single body block.
+  HBasicBlock* header = loop->GetHeader();
+  if (loop->IsIrreducible() ||
+      loop->ContainsIrreducibleLoop() ||
+      loop->NumberOfBackEdges() != 1u ||
+      loop->GetBlocks().NumSetBits() != 2u ||
+      header->IsTryBlock() ||
+      !loop->GetPreHeader()->GetLastInstruction()->IsGoto()) {
+    return false;
+  }
+  HBasicBlock* body = loop->GetBackEdges()[0];
+  if (body == header || body->GetSinglePredecessor() != header || !body->GetPhis().IsEmpty()) {
+    return false;
+  }
+
+  // The header is `i = phi(lower, i + 1); suspend check; if (i < upper)`.
+  HInstruction* suspend_check = header->GetFirstInstruction();
+  if (header->GetFirstPhi() == nullptr ||
+      header->GetFirstPhi() != header->GetLastPhi() ||
+      !suspend_check->IsSuspendCheck() ||
+      suspend_check != loop->GetSuspendCheck() ||
+      !suspend_check->HasEnvironment()) {
+    return false;
+  }
+  HPhi* induction = header->GetFirstPhi()->AsPhi();
+  HInstruction* condition = suspend_check->GetNext();
+  HIf* exit_test = header->GetLastInstruction()->AsIf();
+  if (induction->GetType() != Primitive::kPrimInt ||
+      exit_test == nullptr ||
+      condition->GetNext() != exit_test ||
+      exit_test->InputAt(0) != condition ||
+      !condition->IsCondition() ||
+      !condition->HasOnlyOneNonEnvironmentUse() ||
+      condition->HasEnvironmentUses()) {
+    return false;
+  }
+  IfCondition stay_condition = (exit_test->IfTrueSuccessor() == body)
+      ? condition->AsCondition()->GetCondition()
+      : condition->AsCondition()->GetOppositeCondition();
+  HInstruction* upper = nullptr;
+  if (condition->InputAt(0) == induction && stay_condition == kCondLT) {
+    upper = condition->InputAt(1);
+  } else if (condition->InputAt(1) == induction && stay_condition == kCondGT) {
+    upper = condition->InputAt(0);
+  } else {
+    return false;
+  }
+  if (!loop->IsDefinedOutOfTheLoop(upper)) {
+    return false;
+  }
+
+  // The induction analysis confirms `i` steps by one and the loop is finite.
+  HInductionVarAnalysis::InductionInfo* info = induction_analysis_->LookupInfo(loop, induction);
+  int64_t stride = 0;
+  if (info == nullptr ||
+      info->induction_class != HInductionVarAnalysis::kLinear ||
+      !induction_analysis_->IsExact(info->op_a, &stride) ||
+      stride != 1) {
+    return false;
+  }
+  HInductionVarAnalysis::InductionInfo* trip_count =
+      induction_analysis_->LookupInfo(loop, exit_test);
+  if (trip_count == nullptr ||
+      (trip_count->operation != HInductionVarAnalysis::kTripCountInLoop &&
+       trip_count->operation != HInductionVarAnalysis::kTripCountInBody)) {
+    return false;
+  }
+  HInstruction* increment = induction->InputAt(1);
+  if (increment->GetBlock() != body ||
+      !increment->HasOnlyOneNonEnvironmentUse() ||
+      increment->HasEnvironmentUses()) {
+    return false;
+  }
+
+  candidate->loop = loop;
+  candidate->induction = induction;
+  candidate->increment = increment;
+  candidate->upper = upper;
+
+  // Every other instruction of the body must have a vector counterpart, and only feed the
+  // computation of that same body.
+  ArenaSet<HInstruction*> replicated_scalars(
+      std::less<HInstruction*>(), graph_->GetArena()->Adapter(kArenaAllocLoopVectorization));
+  size_t vector_values = 0;
+  bool has_store = false;
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction == increment || instruction == body->GetLastInstruction()) {
+      continue;
+    }
+    if (!IsVectorizable(*candidate, instruction) || instruction->HasEnvironmentUses()) {
+      return false;
+    }
+    for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+      if (use.GetUser()->GetBlock() != body) {
+        return false;
+      }
+    }
+    for (HInstruction* input : instruction->GetInputs()) {
+      if (loop->IsDefinedOutOfTheLoop(input) && IsPackedType(input->GetType())) {
+        replicated_scalars.insert(input);
+      }
+    }
+    if (instruction->IsArraySet()) {
+      has_store = true;
+    } else {
+      ++vector_values;
+    }
+  }
+  if (!has_store || !body->GetLastInstruction()->IsGoto()) {
+    return false;
+  }
+
+  size_t fp_values = vector_values + replicated_scalars.size() + live_fp_scalars_;
+  return fp_values + kReservedFpRegisters <= codegen_->GetNumberOfFloatingPointRegisters();
+}
+
+bool HLoopVectorization::IsVectorizable(const Candidate& candidate,
+                                        HInstruction* instruction) const {
+  HLoopInformation* loop = candidate.loop;
+  if (instruction->IsArrayGet()) {
+    HArrayGet* get = instruction->AsArrayGet();
+    return IsPackedType(get->GetType()) &&
+        !get->IsStringCharAt() &&
+        loop->IsDefinedOutOfTheLoop(get->GetArray()) &&
+        get->GetIndex() == candidate.induction;
+  } else if (instruction->IsArraySet()) {
+    HArraySet* set = instruction->AsArraySet();
+    Primitive::Type type = set->GetComponentType();
+    return IsPackedType(type) &&
+        !set->NeedsTypeCheck() &&
+        loop->IsDefinedOutOfTheLoop(set->GetArray()) &&
+        set->GetIndex() == candidate.induction &&
+        IsVectorOperand(candidate, set->GetValue(), type);
+  } else if (instruction->IsBinaryOperation()) {
+    HBinaryOperation* operation = instruction->AsBinaryOperation();
+    Primitive::Type type = operation->GetResultType();
+    return IsPackedType(type) &&
+        IsSupportedOperation(operation->GetKind(), type) &&
+        IsVectorOperand(candidate, operation->GetLeft(), type) &&
+        IsVectorOperand(candidate, operation->GetRight(), type);
+  }
+  return false;
+}
+
+bool HLoopVectorization::IsVectorOperand(const Candidate& candidate,
+                                         HInstruction* operand,
+                                         Primitive::Type packed_type) const {
+  if (operand->GetType() != packed_type) {
+    return false;
+  }
+  if (candidate.loop->IsDefinedOutOfTheLoop(operand)) {
+    // Replicated in all the lanes.
+    return true;
+  }
+  // Body instructions are checked in order, so one used here was found vectorizable.
+  HBasicBlock* body = candidate.loop->GetBackEdges()[0];
+  return operand->GetBlock() == body &&
+      operand != candidate.increment &&
+      (operand->IsArrayGet() || operand->IsBinaryOperation());
+}
+
+void HLoopVectorization::Vectorize(const Candidate& candidate) {
+  ArenaAllocator* arena = graph_->GetArena();
+  HLoopInformation* loop = candidate.loop;
+  HBasicBlock* header = loop->GetHeader();
+  HBasicBlock* body = loop->GetBackEdges()[0];
+  HBasicBlock* pre_header = loop->GetPreHeader();
+  HPhi* induction = candidate.induction;
+  uint32_t dex_pc = header->GetDexPc();
+
+  // pre_header -> vector_header <-> vector_body
+  //                     |
+  //                     v
+  //              scalar_pre_header -> header <-> body (the remaining iterations)
+  HBasicBlock* vector_header = new (arena) HBasicBlock(graph_, dex_pc);
+  HBasicBlock* vector_body = new (arena) HBasicBlock(graph_, dex_pc);
+  HBasicBlock* scalar_pre_header = new (arena) HBasicBlock(graph_, dex_pc);
+  graph_->AddBlock(vector_header);
+  graph_->AddBlock(vector_body);
+  graph_->AddBlock(scalar_pre_header);
+  header->ReplacePredecessor(pre_header, scalar_pre_header);
+  pre_header->AddSuccessor(vector_header);
+  vector_header->AddSuccessor(vector_body);  // True successor.
+  vector_header->AddSuccessor(scalar_pre_header);  // False successor.
+  vector_body->AddSuccessor(vector_header);
+  scalar_pre_header->AddInstruction(new (arena) HGoto(dex_pc));
+
+  // The vector loop runs while `i < upper - (kVectorLength - 1)`. Avoid the wrap around
+  // of that bound for very small `upper`, the vector loop is then not taken.
+  const int32_t min_upper = std::numeric_limits<int32_t>::min() + (kVectorLength - 1);
+  HInstruction* upper = candidate.upper;
+  HInstruction* cursor = pre_header->GetLastInstruction();
+  HInstruction* below_min = new (arena) HLessThan(upper, graph_->GetIntConstant(min_upper));
+  HInstruction* bias = new (arena) HSub(
+      Primitive::kPrimInt, upper, graph_->GetIntConstant(kVectorLength - 1), dex_pc);
+  HInstruction* vector_upper = new (arena) HSelect(
+      below_min, graph_->GetIntConstant(std::numeric_limits<int32_t>::min()), bias, dex_pc);
+  pre_header->InsertInstructionBefore(below_min, cursor);
+  pre_header->InsertInstructionBefore(bias, cursor);
+  pre_header->InsertInstructionBefore(vector_upper, cursor);
+
+  // Vector loop header, with a suspend check of its own whose environment sees the vector
+  // induction: at that point all the iterations before it have completed.
+  HPhi* vector_induction =
+      new (arena) HPhi(arena, induction->GetRegNumber(), 0, Primitive::kPrimInt, dex_pc);
+  vector_header->AddPhi(vector_induction);
+  HSuspendCheck* scalar_suspend_check = loop->GetSuspendCheck();
+  HSuspendCheck* suspend_check =
+      new (arena) HSuspendCheck(scalar_suspend_check->GetDexPc());
+  vector_header->AddInstruction(suspend_check);
+  suspend_check->CopyEnvironmentFrom(scalar_suspend_check->GetEnvironment());
+  for (HEnvironment* environment = suspend_check->GetEnvironment();
+       environment != nullptr;
+       environment = environment->GetParent()) {
+    for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+      if (environment->GetInstructionAt(i) == induction) {
+        environment->RemoveAsUserOfInput(i);
+        environment->SetRawEnvAt(i, vector_induction);
+        vector_induction->AddEnvUseAt(environment, i);
+      }
+    }
+  }
+  HInstruction* condition = new (arena) HLessThan(vector_induction, vector_upper, dex_pc);
+  vector_header->AddInstruction(condition);
+  vector_header->AddInstruction(new (arena) HIf(condition, dex_pc));
+
+  // Vector loop body, in the order of the scalar body. Loop invariant operands are replicated
+  // right before their first use rather than hoisted, so that no vector value is live at the
+  // suspend check.
+  ArenaSafeMap<HInstruction*, HInstruction*> vector_map(
+      std::less<HInstruction*>(), arena->Adapter(kArenaAllocLoopVectorization));
+  auto vector_operand = [&](HInstruction* operand, Primitive::Type packed_type) {
+    auto it = vector_map.find(operand);
+    if (it != vector_map.end()) {
+      return it->second;
+    }
+    DCHECK(loop->IsDefinedOutOfTheLoop(operand));
+    HInstruction* replicate =
+        new (arena) HVecReplicateScalar(operand, packed_type, operand->GetDexPc());
+    vector_body->AddInstruction(replicate);
+    vector_map.Put(operand, replicate);
+    return replicate;
+  };
+  for (HInstructionIterator it(body->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (instruction == candidate.increment || instruction->IsGoto()) {
+      continue;
+    }
+    HInstruction* vector = nullptr;
+    if (instruction->IsArrayGet()) {
+      HArrayGet* get = instruction->AsArrayGet();
+      vector = new (arena) HVecLoad(
+          get->GetArray(), vector_induction, get->GetType(), get->GetDexPc());
+    } else if (instruction->IsArraySet()) {
+      HArraySet* set = instruction->AsArraySet();
+      Primitive::Type type = set->GetComponentType();
+      vector = new (arena) HVecStore(set->GetArray(),
+                                     vector_induction,
+                                     vector_operand(set->GetValue(), type),
+                                     type,
+                                     set->GetDexPc());
+    } else {
+      HBinaryOperation* operation = instruction->AsBinaryOperation();
+      Primitive::Type type = operation->GetResultType();
+      HInstruction* left = vector_operand(operation->GetLeft(), type);
+      HInstruction* right = vector_operand(operation->GetRight(), type);
+      vector = new (arena) HVecBinaryOperation(
+          operation->GetKind(), left, right, type, operation->GetDexPc());
+    }
+    vector_body->AddInstruction(vector);
+    vector_map.Put(instruction, vector);
+  }
+  HInstruction* vector_increment = new (arena) HAdd(
+      Primitive::kPrimInt, vector_induction, graph_->GetIntConstant(kVectorLength), dex_pc);
+  vector_body->AddInstruction(vector_increment);
+  vector_body->AddInstruction(new (arena) HGoto(dex_pc));
+  vector_induction->AddInput(induction->InputAt(0));
+  vector_induction->AddInput(vector_increment);
+
+  // The scalar loop starts where the vector loop stopped.
+  induction->ReplaceInput(vector_induction, 0);
+}
+
+}  // namespace art
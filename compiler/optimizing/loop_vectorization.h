@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_LOOP_VECTORIZATION_H_
+#define ART_COMPILER_OPTIMIZING_LOOP_VECTORIZATION_H_
+
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class CodeGenerator;
+class HInductionVarAnalysis;
+class InstructionSetFeatures;
+
+/**
+ * Vectorizes innermost loops of the form
+ *
+ *    for (int i = lower; i < upper; i++) {
+ *      a[i] = b[i] <op> c[i] ...;
+ *    }
+ *
+ * whose body is a single block of int or float array accesses indexed by the basic
+ * induction and lane-wise operations on them. A vector loop processing kVectorLength
+ * iterations at a time is inserted before the loop, which is kept to run the remaining
+ * iterations. Every iteration only accesses the elements at its own index, so there is no
+ * dependence between iterations and no aliasing check is needed; the accesses must have been
+ * proven in bounds by BCE, which includes the deoptimization guards it may have added.
+ */
+class HLoopVectorization : public HOptimization {
+ public:
+  HLoopVectorization(HGraph* graph,
+                     CodeGenerator* codegen,
+                     const InstructionSetFeatures& isa_features,
+                     HInductionVarAnalysis* induction_analysis,
+                     OptimizingCompilerStats* stats);
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kLoopVectorizationPassName = "loop_vectorization";
+
+ private:
+  // A loop accepted by IsCandidate.
+  struct Candidate {
+    HLoopInformation* loop;
+    HPhi* induction;           // The basic induction `i`, stepping by one.
+    HInstruction* increment;   // The back edge value of `i`.
+    HInstruction* upper;       // The loop runs while `i < upper`.
+  };
+
+  bool IsCandidate(HLoopInformation* loop, Candidate* candidate) const;
+  bool IsVectorizable(const Candidate& candidate, HInstruction* instruction) const;
+  bool IsVectorOperand(const Candidate& candidate,
+                       HInstruction* operand,
+                       Primitive::Type packed_type) const;
+  bool IsSupportedOperation(HInstruction::InstructionKind op, Primitive::Type packed_type) const;
+
+  void Vectorize(const Candidate& candidate);
+
+  CodeGenerator* const codegen_;
+  HInductionVarAnalysis* const induction_analysis_;
+
+  // Whether packed 32-bit integer multiplications are available.
+  bool has_packed_int_mul_;
+
+  // Number of floating point values possibly live in a vector loop besides the vector
+  // values of its body, see Run.
+  size_t live_fp_scalars_;
+
+  DISALLOW_COPY_AND_ASSIGN(HLoopVectorization);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_LOOP_VECTORIZATION_H_
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "arch/instruction_set_features.h"
+#include "base/arena_allocator.h"
+#include "code_generator.h"
+#include "driver/compiler_options.h"
+#include "induction_var_analysis.h"
+#include "loop_vectorization.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+namespace art {
+
+#ifdef ART_ENABLE_CODEGEN_arm64
+
+/**
+ * Fixture class for the LoopVectorization tests.
+ */
+class LoopVectorizationTest : public CommonCompilerTest {
+ public:
+  LoopVectorizationTest() : pool_(), allocator_(&pool_) {
+    graph_ = CreateGraph(&allocator_);
+  }
+
+  ~LoopVectorizationTest() { }
+
+  // Builds `for (int i = 0; i < n; i++) { <body> }`, the body is populated by the tests
+  // before its goto.
+  void BuildLoop(Primitive::Type array_type) {
+    entry_ = new (&allocator_) HBasicBlock(graph_);
+    loop_preheader_ = new (&allocator_) HBasicBlock(graph_);
+    loop_header_ = new (&allocator_) HBasicBlock(graph_);
+    loop_body_ = new (&allocator_) HBasicBlock(graph_);
+    return_ = new (&allocator_) HBasicBlock(graph_);
+    exit_ = new (&allocator_) HBasicBlock(graph_);
+
+    graph_->AddBlock(entry_);
+    graph_->AddBlock(loop_preheader_);
+    graph_->AddBlock(loop_header_);
+    graph_->AddBlock(loop_body_);
+    graph_->AddBlock(return_);
+    graph_->AddBlock(exit_);
+
+    graph_->SetEntryBlock(entry_);
+    graph_->SetExitBlock(exit_);
+
+    entry_->AddSuccessor(loop_preheader_);
+    loop_preheader_->AddSuccessor(loop_header_);
+    loop_header_->AddSuccessor(loop_body_);
+    loop_header_->AddSuccessor(return_);
+    loop_body_->AddSuccessor(loop_header_);
+    return_->AddSuccessor(exit_);
+
+    array_a_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+    array_b_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 1, Primitive::kPrimNot);
+    scalar_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 2, array_type);
+    upper_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 3, Primitive::kPrimInt);
+    entry_->AddInstruction(array_a_);
+    entry_->AddInstruction(array_b_);
+    entry_->AddInstruction(scalar_);
+    entry_->AddInstruction(upper_);
+    entry_->AddInstruction(new (&allocator_) HGoto());
+    loop_preheader_->AddInstruction(new (&allocator_) HGoto());
+
+    phi_ = new (&allocator_) HPhi(&allocator_, 0, 0, Primitive::kPrimInt);
+    loop_header_->AddPhi(phi_);
+    HSuspendCheck* suspend_check = new (&allocator_) HSuspendCheck();
+    loop_header_->AddInstruction(suspend_check);
+    HEnvironment* environment = new (&allocator_) HEnvironment(
+        &allocator_, 1, graph_->GetDexFile(), graph_->GetMethodIdx(), 0, kStatic, suspend_check);
+    suspend_check->SetRawEnvironment(environment);
+    environment->SetRawEnvAt(0, phi_);
+    phi_->AddEnvUseAt(environment, 0);
+    HInstruction* condition = new (&allocator_) HLessThan(phi_, upper_);
+    loop_header_->AddInstruction(condition);
+    loop_header_->AddInstruction(new (&allocator_) HIf(condition));
+
+    increment_ = new (&allocator_) HAdd(Primitive::kPrimInt, phi_, graph_->GetIntConstant(1));
+    loop_body_->AddInstruction(increment_);
+    loop_body_->AddInstruction(new (&allocator_) HGoto());
+    phi_->AddInput(graph_->GetIntConstant(0));
+    phi_->AddInput(increment_);
+
+    return_->AddInstruction(new (&allocator_) HReturnVoid());
+    exit_->AddInstruction(new (&allocator_) HExit());
+  }
+
+  HInstruction* InsertInBody(HInstruction* instruction) {
+    loop_body_->InsertInstructionBefore(instruction, increment_);
+    return instruction;
+  }
+
+  void PerformVectorization() {
+    graph_->BuildDominatorTree();
+    HInductionVarAnalysis induction(graph_);
+    induction.Run();
+    std::string error;
+    std::unique_ptr<const InstructionSetFeatures> features(
+        InstructionSetFeatures::FromVariant(kArm64, "default", &error));
+    std::unique_ptr<CodeGenerator> codegen =
+        CodeGenerator::Create(graph_, kArm64, *features, compiler_options_);
+    HLoopVectorization(graph_, codegen.get(), *features, &induction, nullptr).Run();
+  }
+
+  size_t CountVectorInstructions() {
+    size_t count = 0;
+    for (HBasicBlock* block : graph_->GetBlocks()) {
+      if (block == nullptr) {
+        continue;
+      }
+      for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+        HInstruction* instruction = it.Current();
+        if (instruction->IsVecReplicateScalar() ||
+            instruction->IsVecLoad() ||
+            instruction->IsVecStore() ||
+            instruction->IsVecBinaryOperation()) {
+          ++count;
+        }
+      }
+    }
+    return count;
+  }
+
+  // General building fields.
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+  CompilerOptions compiler_options_;
+
+  // Specific basic blocks.
+  HBasicBlock* entry_;
+  HBasicBlock* loop_preheader_;
+  HBasicBlock* loop_header_;
+  HBasicBlock* loop_body_;
+  HBasicBlock* return_;
+  HBasicBlock* exit_;
+
+  HInstruction* array_a_;
+  HInstruction* array_b_;
+  HInstruction* scalar_;
+  HInstruction* upper_;
+  HPhi* phi_;
+  HInstruction* increment_;
+};
+
+//
+// The actual LoopVectorization tests.
+//
+
+TEST_F(LoopVectorizationTest, IntArrayAdd) {
+  // for (int i = 0; i < n; i++) a[i] = b[i] + x;
+  BuildLoop(Primitive::kPrimInt);
+  HInstruction* get = InsertInBody(
+      new (&allocator_) HArrayGet(array_b_, phi_, Primitive::kPrimInt, 0));
+  HInstruction* add = InsertInBody(
+      new (&allocator_) HAdd(Primitive::kPrimInt, get, scalar_));
+  InsertInBody(new (&allocator_) HArraySet(array_a_, phi_, add, Primitive::kPrimInt, 0));
+
+  PerformVectorization();
+
+  // Replicate, load, add and store.
+  EXPECT_EQ(4u, CountVectorInstructions());
+  // The scalar loop is kept for the remaining iterations, and starts at the end of the
+  // vector loop.
+  EXPECT_EQ(get->GetBlock(), loop_body_);
+  EXPECT_TRUE(phi_->InputAt(0)->IsPhi());
+  EXPECT_NE(phi_->InputAt(0)->GetBlock(), loop_header_);
+  EXPECT_TRUE(phi_->InputAt(0)->GetBlock()->IsLoopHeader());
+}
+
+TEST_F(LoopVectorizationTest, FloatArrayMul) {
+  // for (int i = 0; i < n; i++) a[i] = b[i] * a[i];
+  BuildLoop(Primitive::kPrimFloat);
+  HInstruction* get_b = InsertInBody(
+      new (&allocator_) HArrayGet(array_b_, phi_, Primitive::kPrimFloat, 0));
+  HInstruction* get_a = InsertInBody(
+      new (&allocator_) HArrayGet(array_a_, phi_, Primitive::kPrimFloat, 0));
+  HInstruction* mul = InsertInBody(
+      new (&allocator_) HMul(Primitive::kPrimFloat, get_b, get_a));
+  InsertInBody(new (&allocator_) HArraySet(array_a_, phi_, mul, Primitive::kPrimFloat, 0));
+
+  PerformVectorization();
+
+  // Two loads, a multiplication and a store.
+  EXPECT_EQ(4u, CountVectorInstructions());
+}
+
+TEST_F(LoopVectorizationTest, NoVectorizationOfIntDiv) {
+  // for (int i = 0; i < n; i++) a[i] = b[i] / x;
+  BuildLoop(Primitive::kPrimInt);
+  HInstruction* get = InsertInBody(
+      new (&allocator_) HArrayGet(array_b_, phi_, Primitive::kPrimInt, 0));
+  HInstruction* div = InsertInBody(
+      new (&allocator_) HDiv(Primitive::kPrimInt, get, scalar_, 0));
+  InsertInBody(new (&allocator_) HArraySet(array_a_, phi_, div, Primitive::kPrimInt, 0));
+
+  PerformVectorization();
+
+  EXPECT_EQ(0u, CountVectorInstructions());
+  EXPECT_EQ(phi_->InputAt(0), graph_->GetIntConstant(0));
+}
+
+TEST_F(LoopVectorizationTest, NoVectorizationOfInductionOperand) {
+  // for (int i = 0; i < n; i++) a[i] = b[i] + i;
+  BuildLoop(Primitive::kPrimInt);
+  HInstruction* get = InsertInBody(
+      new (&allocator_) HArrayGet(array_b_, phi_, Primitive::kPrimInt, 0));
+  HInstruction* add = InsertInBody(
+      new (&allocator_) HAdd(Primitive::kPrimInt, get, phi_));
+  InsertInBody(new (&allocator_) HArraySet(array_a_, phi_, add, Primitive::kPrimInt, 0));
+
+  PerformVectorization();
+
+  EXPECT_EQ(0u, CountVectorInstructions());
+}
+
+#endif  // ART_ENABLE_CODEGEN_arm64
+
+}  // namespace art
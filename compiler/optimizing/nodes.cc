@@ -671,10 +671,10 @@ void HLoopInformation::Populate() {
     }
   }
 
-  if (!is_irreducible_loop && graph->IsCompilingOsr()) {
-    // When compiling in OSR mode, all loops in the compiled method may be entered
+  if (!is_irreducible_loop && graph->IsCompilingOsr() && ContainsOsrEntry()) {
+    // When compiling in OSR mode, the loops containing the OSR entry may be entered
     // from the interpreter. We treat this OSR entry point just like an extra entry
-    // to an irreducible loop, so we need to mark the method's loops as irreducible.
+    // to an irreducible loop, so we need to mark these loops as irreducible.
     // This does not apply to inlined loops which do not act as OSR entry points.
     if (suspend_check_ == nullptr) {
       // Just building the graph in OSR mode, this loop is not inlined. We never build an
@@ -695,6 +695,22 @@ void HLoopInformation::Populate() {
   }
 }
 
+bool HLoopInformation::ContainsOsrEntry() const {
+  HGraph* graph = header_->GetGraph();
+  uint32_t osr_entry_dex_pc = graph->GetOsrEntryDexPc();
+  if (osr_entry_dex_pc == kNoDexPc) {
+    // We do not know where the interpreter will enter, it can be any loop.
+    return true;
+  }
+  // The loop is entered if the OSR entry is its header or the header of a nested loop.
+  for (uint32_t block_id : blocks_.Indexes()) {
+    if (graph->GetBlocks()[block_id]->GetDexPc() == osr_entry_dex_pc) {
+      return true;
+    }
+  }
+  return false;
+}
+
 HBasicBlock* HLoopInformation::GetPreHeader() const {
   HBasicBlock* block = header_->GetPredecessors()[0];
   DCHECK(irreducible_ || (block == header_->GetDominator()));
@@ -1149,9 +1165,13 @@ void HGraphVisitor::VisitBasicBlock(HBasicBlock* block) {
 }
 
 HConstant* HTypeConversion::TryStaticEvaluation() const {
+  return TryStaticEvaluation(GetInput());
+}
+
+HConstant* HTypeConversion::TryStaticEvaluation(HInstruction* input) const {
   HGraph* graph = GetBlock()->GetGraph();
-  if (GetInput()->IsIntConstant()) {
-    int32_t value = GetInput()->AsIntConstant()->GetValue();
+  if (input->IsIntConstant()) {
+    int32_t value = input->AsIntConstant()->GetValue();
     switch (GetResultType()) {
       case Primitive::kPrimLong:
         return graph->GetLongConstant(static_cast<int64_t>(value), GetDexPc());
@@ -1162,8 +1182,8 @@ HConstant* HTypeConversion::TryStaticEvaluation() const {
       default:
         return nullptr;
     }
-  } else if (GetInput()->IsLongConstant()) {
-    int64_t value = GetInput()->AsLongConstant()->GetValue();
+  } else if (input->IsLongConstant()) {
+    int64_t value = input->AsLongConstant()->GetValue();
     switch (GetResultType()) {
       case Primitive::kPrimInt:
         return graph->GetIntConstant(static_cast<int32_t>(value), GetDexPc());
@@ -1174,8 +1194,8 @@ HConstant* HTypeConversion::TryStaticEvaluation() const {
       default:
         return nullptr;
     }
-  } else if (GetInput()->IsFloatConstant()) {
-    float value = GetInput()->AsFloatConstant()->GetValue();
+  } else if (input->IsFloatConstant()) {
+    float value = input->AsFloatConstant()->GetValue();
     switch (GetResultType()) {
       case Primitive::kPrimInt:
         if (std::isnan(value))
@@ -1198,8 +1218,8 @@ HConstant* HTypeConversion::TryStaticEvaluation() const {
       default:
         return nullptr;
     }
-  } else if (GetInput()->IsDoubleConstant()) {
-    double value = GetInput()->AsDoubleConstant()->GetValue();
+  } else if (input->IsDoubleConstant()) {
+    double value = input->AsDoubleConstant()->GetValue();
     switch (GetResultType()) {
       case Primitive::kPrimInt:
         if (std::isnan(value))
@@ -1227,40 +1247,48 @@ HConstant* HTypeConversion::TryStaticEvaluation() const {
 }
 
 HConstant* HUnaryOperation::TryStaticEvaluation() const {
-  if (GetInput()->IsIntConstant()) {
-    return Evaluate(GetInput()->AsIntConstant());
-  } else if (GetInput()->IsLongConstant()) {
-    return Evaluate(GetInput()->AsLongConstant());
+  return TryStaticEvaluation(GetInput());
+}
+
+HConstant* HUnaryOperation::TryStaticEvaluation(HInstruction* input) const {
+  if (input->IsIntConstant()) {
+    return Evaluate(input->AsIntConstant());
+  } else if (input->IsLongConstant()) {
+    return Evaluate(input->AsLongConstant());
   } else if (kEnableFloatingPointStaticEvaluation) {
-    if (GetInput()->IsFloatConstant()) {
-      return Evaluate(GetInput()->AsFloatConstant());
-    } else if (GetInput()->IsDoubleConstant()) {
-      return Evaluate(GetInput()->AsDoubleConstant());
+    if (input->IsFloatConstant()) {
+      return Evaluate(input->AsFloatConstant());
+    } else if (input->IsDoubleConstant()) {
+      return Evaluate(input->AsDoubleConstant());
     }
   }
   return nullptr;
 }
 
 HConstant* HBinaryOperation::TryStaticEvaluation() const {
-  if (GetLeft()->IsIntConstant() && GetRight()->IsIntConstant()) {
-    return Evaluate(GetLeft()->AsIntConstant(), GetRight()->AsIntConstant());
-  } else if (GetLeft()->IsLongConstant()) {
-    if (GetRight()->IsIntConstant()) {
+  return TryStaticEvaluation(GetLeft(), GetRight());
+}
+
+HConstant* HBinaryOperation::TryStaticEvaluation(HInstruction* left, HInstruction* right) const {
+  if (left->IsIntConstant() && right->IsIntConstant()) {
+    return Evaluate(left->AsIntConstant(), right->AsIntConstant());
+  } else if (left->IsLongConstant()) {
+    if (right->IsIntConstant()) {
       // The binop(long, int) case is only valid for shifts and rotations.
       DCHECK(IsShl() || IsShr() || IsUShr() || IsRor()) << DebugName();
-      return Evaluate(GetLeft()->AsLongConstant(), GetRight()->AsIntConstant());
-    } else if (GetRight()->IsLongConstant()) {
-      return Evaluate(GetLeft()->AsLongConstant(), GetRight()->AsLongConstant());
+      return Evaluate(left->AsLongConstant(), right->AsIntConstant());
+    } else if (right->IsLongConstant()) {
+      return Evaluate(left->AsLongConstant(), right->AsLongConstant());
     }
-  } else if (GetLeft()->IsNullConstant() && GetRight()->IsNullConstant()) {
+  } else if (left->IsNullConstant() && right->IsNullConstant()) {
     // The binop(null, null) case is only valid for equal and not-equal conditions.
     DCHECK(IsEqual() || IsNotEqual()) << DebugName();
-    return Evaluate(GetLeft()->AsNullConstant(), GetRight()->AsNullConstant());
+    return Evaluate(left->AsNullConstant(), right->AsNullConstant());
   } else if (kEnableFloatingPointStaticEvaluation) {
-    if (GetLeft()->IsFloatConstant() && GetRight()->IsFloatConstant()) {
-      return Evaluate(GetLeft()->AsFloatConstant(), GetRight()->AsFloatConstant());
-    } else if (GetLeft()->IsDoubleConstant() && GetRight()->IsDoubleConstant()) {
-      return Evaluate(GetLeft()->AsDoubleConstant(), GetRight()->AsDoubleConstant());
+    if (left->IsFloatConstant() && right->IsFloatConstant()) {
+      return Evaluate(left->AsFloatConstant(), right->AsFloatConstant());
+    } else if (left->IsDoubleConstant() && right->IsDoubleConstant()) {
+      return Evaluate(left->AsDoubleConstant(), right->AsDoubleConstant());
     }
   }
   return nullptr;
@@ -1335,10 +1363,12 @@ std::ostream& operator<<(std::ostream& os, const HInstruction::InstructionKind&
   return os;
 }
 
-void HInstruction::MoveBefore(HInstruction* cursor) {
+void HInstruction::MoveBefore(HInstruction* cursor, bool ensure_safety) {
   DCHECK(!IsPhi());
   DCHECK(!IsControlFlow());
-  DCHECK(CanBeMoved());
+  if (ensure_safety) {
+    DCHECK(CanBeMoved());
+  }
   DCHECK(!cursor->IsPhi());
 
   next_->previous_ = previous_;
@@ -2626,6 +2656,8 @@ std::ostream& operator<<(std::ostream& os, TypeCheckKind rhs) {
       return os << "array_object_check";
     case TypeCheckKind::kArrayCheck:
       return os << "array_check";
+    case TypeCheckKind::kSuperclassDisplayCheck:
+      return os << "superclass_display_check";
     default:
       LOG(FATAL) << "Unknown TypeCheckKind: " << static_cast<int>(rhs);
       UNREACHABLE();
@@ -312,6 +312,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         has_bounds_checks_(false),
         has_try_catch_(false),
         has_irreducible_loops_(false),
+        has_should_deoptimize_flag_(false),
         debuggable_(debuggable),
         current_instruction_id_(start_instruction_id),
         dex_file_(dex_file),
@@ -327,7 +328,10 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         cached_double_constants_(std::less<int64_t>(), arena->Adapter(kArenaAllocConstantsMap)),
         cached_current_method_(nullptr),
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
-        osr_(osr) {
+        osr_(osr),
+        osr_entry_dex_pc_(kNoDexPc),
+        speculative_deoptimization_disabled_(false),
+        cha_single_implementation_list_(arena->Adapter(kArenaAllocCHA)) {
     blocks_.reserve(kDefaultNumberOfBlocks);
   }
 
@@ -517,12 +521,40 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  uint32_t GetOsrEntryDexPc() const { return osr_entry_dex_pc_; }
+  void SetOsrEntryDexPc(uint32_t dex_pc) {
+    DCHECK(IsCompilingOsr());
+    osr_entry_dex_pc_ = dex_pc;
+  }
+
+  // Whether the compiled code may rely on a fact checked by an HDeoptimize. OSR code cannot
+  // deoptimize, and the JIT stops speculating for methods that deoptimized too often.
+  bool AllowsSpeculativeDeoptimization() const {
+    return !osr_ && !speculative_deoptimization_disabled_;
+  }
+  void DisableSpeculativeDeoptimization() { speculative_deoptimization_disabled_ = true; }
+
   bool HasTryCatch() const { return has_try_catch_; }
   void SetHasTryCatch(bool value) { has_try_catch_ = value; }
 
   bool HasIrreducibleLoops() const { return has_irreducible_loops_; }
   void SetHasIrreducibleLoops(bool value) { has_irreducible_loops_ = value; }
 
+  // Whether the frame reserves a slot for the flag the runtime sets when the class
+  // hierarchy assumptions of this compiled code no longer hold.
+  bool HasShouldDeoptimizeFlag() const { return has_should_deoptimize_flag_; }
+  void SetHasShouldDeoptimizeFlag() { has_should_deoptimize_flag_ = true; }
+
+  // Methods assumed to have a single implementation. The compiled code must be
+  // invalidated when one of them gets overridden.
+  const ArenaSet<ArtMethod*>& GetCHASingleImplementationList() const {
+    return cha_single_implementation_list_;
+  }
+
+  void AddCHASingleImplementationDependency(ArtMethod* method) {
+    cha_single_implementation_list_.insert(method);
+  }
+
   ArtMethod* GetArtMethod() const { return art_method_; }
   void SetArtMethod(ArtMethod* method) { art_method_ = method; }
 
@@ -603,6 +635,9 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // Flag whether there are any irreducible loops in the graph.
   bool has_irreducible_loops_;
 
+  // Flag whether the frame has a slot for the should deoptimize flag, see HShouldDeoptimizeFlag.
+  bool has_should_deoptimize_flag_;
+
   // Indicates whether the graph should be compiled in a way that
   // ensures full debuggability. If false, we can apply more
   // aggressive optimizations that may limit the level of debugging.
@@ -648,10 +683,21 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   ReferenceTypeInfo inexact_object_rti_;
 
   // Whether we are compiling this graph for on stack replacement: this will
-  // make all loops seen as irreducible and emit special stack maps to mark
-  // compiled code entries which the interpreter can directly jump to.
+  // make the loops containing the OSR entry seen as irreducible and emit special
+  // stack maps to mark compiled code entries which the interpreter can directly jump to.
   const bool osr_;
 
+  // The loop header the interpreter is expected to enter the OSR compiled code at,
+  // or kNoDexPc if any loop can be an entry. Other loops are compiled as usual.
+  uint32_t osr_entry_dex_pc_;
+
+  // Whether previously compiled code of this method deoptimized too often on failed
+  // speculative checks, see AllowsSpeculativeDeoptimization.
+  bool speculative_deoptimization_disabled_;
+
+  // Methods the compiled code relies on having a single implementation.
+  ArenaSet<ArtMethod*> cha_single_implementation_list_;
+
   friend class SsaBuilder;           // For caching constants.
   friend class SsaLivenessAnalysis;  // For the linear order.
   friend class HInliner;             // For the reverse post order.
@@ -752,6 +798,9 @@ class HLoopInformation : public ArenaObject<kArenaAllocLoopInfo> {
 
  private:
   // Internal recursive implementation of `Populate`.
+  // Whether the OSR entry of the graph is in this loop.
+  bool ContainsOsrEntry() const;
+
   void PopulateRecursive(HBasicBlock* block);
   void PopulateIrreducibleRecursive(HBasicBlock* block, ArenaBitVector* finalized);
 
@@ -1264,9 +1313,11 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(ReturnVoid, Instruction)                                            \
   M(Ror, BinaryOperation)                                               \
   M(Shl, BinaryOperation)                                               \
+  M(ShouldDeoptimizeFlag, Instruction)                                  \
   M(Shr, BinaryOperation)                                               \
   M(StaticFieldGet, Instruction)                                        \
   M(StaticFieldSet, Instruction)                                        \
+  M(StringBuilderAppend, Instruction)                                   \
   M(UnresolvedInstanceFieldGet, Instruction)                            \
   M(UnresolvedInstanceFieldSet, Instruction)                            \
   M(UnresolvedStaticFieldGet, Instruction)                              \
@@ -1328,9 +1379,23 @@ class HLoopInformationOutwardIterator : public ValueObject {
 
 #define FOR_EACH_CONCRETE_INSTRUCTION_X86_64(M)
 
+/*
+ * Vector instructions, for the architectures the loop vectorizer supports.
+ */
+#if !defined(ART_ENABLE_CODEGEN_arm64) && !defined(ART_ENABLE_CODEGEN_x86_64)
+#define FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(M)
+#else
+#define FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(M)                         \
+  M(VecReplicateScalar, Instruction)                                    \
+  M(VecLoad, Instruction)                                               \
+  M(VecStore, Instruction)                                              \
+  M(VecBinaryOperation, Instruction)
+#endif
+
 #define FOR_EACH_CONCRETE_INSTRUCTION(M)                                \
   FOR_EACH_CONCRETE_INSTRUCTION_COMMON(M)                               \
   FOR_EACH_CONCRETE_INSTRUCTION_SHARED(M)                               \
+  FOR_EACH_CONCRETE_INSTRUCTION_VECTOR(M)                               \
   FOR_EACH_CONCRETE_INSTRUCTION_ARM(M)                                  \
   FOR_EACH_CONCRETE_INSTRUCTION_ARM64(M)                                \
   FOR_EACH_CONCRETE_INSTRUCTION_MIPS(M)                                 \
@@ -1997,8 +2062,10 @@ class HInstruction : public ArenaObject<kArenaAllocInstruction> {
     other->ReplaceInput(this, use_index);
   }
 
-  // Move `this` instruction before `cursor`.
-  void MoveBefore(HInstruction* cursor);
+  // Move `this` instruction before `cursor`. `ensure_safety` is false when the caller
+  // has checked by itself that moving an instruction that cannot trivially be moved (an
+  // allocation, a heap store, ...) is safe.
+  void MoveBefore(HInstruction* cursor, bool ensure_safety = true);
 
   // Move `this` before its first user and out of any loops. If there is no
   // out-of-loop user that dominates all other users, move the instruction
@@ -2719,7 +2786,9 @@ class HDoubleConstant FINAL : public HConstant {
 class HIf FINAL : public HTemplateInstruction<1> {
  public:
   explicit HIf(HInstruction* input, uint32_t dex_pc = kNoDexPc)
-      : HTemplateInstruction(SideEffects::None(), dex_pc) {
+      : HTemplateInstruction(SideEffects::None(), dex_pc),
+        true_count_(0u),
+        false_count_(0u) {
     SetRawInputAt(0, input);
   }
 
@@ -2733,9 +2802,39 @@ class HIf FINAL : public HTemplateInstruction<1> {
     return GetBlock()->GetSuccessors()[1];
   }
 
+  // Number of times the interpreter went to the true and the false successor, when the
+  // JIT profiled the branch. Both are zero otherwise.
+  uint16_t GetTrueCount() const { return true_count_; }
+  uint16_t GetFalseCount() const { return false_count_; }
+
+  void SetBranchCounts(uint16_t true_count, uint16_t false_count) {
+    true_count_ = true_count;
+    false_count_ = false_count;
+  }
+
+  // Must be called when the successors of the block are swapped.
+  void SwapBranchCounts() {
+    std::swap(true_count_, false_count_);
+  }
+
+  // Whether the profile shows the true (resp. false) successor is not executed, while
+  // the other successor is often enough for the profile to be meaningful.
+  bool IsTrueSuccessorUnlikely() const {
+    return true_count_ == 0u && false_count_ >= kMinimumBranchCount;
+  }
+
+  bool IsFalseSuccessorUnlikely() const {
+    return false_count_ == 0u && true_count_ >= kMinimumBranchCount;
+  }
+
   DECLARE_INSTRUCTION(If);
 
  private:
+  static constexpr uint16_t kMinimumBranchCount = 64u;
+
+  uint16_t true_count_;
+  uint16_t false_count_;
+
   DISALLOW_COPY_AND_ASSIGN(HIf);
 };
 
@@ -2825,6 +2924,22 @@ class HDeoptimize FINAL : public HTemplateInstruction<1> {
   DISALLOW_COPY_AND_ASSIGN(HDeoptimize);
 };
 
+// Reads the flag of the current frame that the runtime sets when a method this compiled
+// code assumed to have a single implementation gets overridden. An HDeoptimize on that
+// flag guards the calls devirtualized through class hierarchy analysis.
+class HShouldDeoptimizeFlag FINAL : public HExpression<0> {
+ public:
+  // The flag can be set by another thread at any suspension point, so the load
+  // is not movable.
+  explicit HShouldDeoptimizeFlag(uint32_t dex_pc)
+      : HExpression(Primitive::kPrimInt, SideEffects::None(), dex_pc) {}
+
+  DECLARE_INSTRUCTION(ShouldDeoptimizeFlag);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HShouldDeoptimizeFlag);
+};
+
 // Represents the ArtMethod that was passed as a first argument to
 // the method. It is used by instructions that depend on it, like
 // instructions that work with the dex cache.
@@ -2938,6 +3053,8 @@ class HUnaryOperation : public HExpression<1> {
   // containing the result of this evaluation.  If `this` cannot
   // be evaluated as a constant, return null.
   HConstant* TryStaticEvaluation() const;
+  // The same with `input` in place of the input of `this`.
+  HConstant* TryStaticEvaluation(HInstruction* input) const;
 
   // Apply this operation to `x`.
   virtual HConstant* Evaluate(HIntConstant* x) const = 0;
@@ -3010,6 +3127,8 @@ class HBinaryOperation : public HExpression<2> {
   // containing the result of this evaluation.  If `this` cannot
   // be evaluated as a constant, return null.
   HConstant* TryStaticEvaluation() const;
+  // The same with `left` and `right` in place of the inputs of `this`.
+  HConstant* TryStaticEvaluation(HInstruction* left, HInstruction* right) const;
 
   // Apply this operation to `x` and `y`.
   virtual HConstant* Evaluate(HNullConstant* x ATTRIBUTE_UNUSED,
@@ -3679,6 +3798,61 @@ class HNewInstance FINAL : public HExpression<2> {
   DISALLOW_COPY_AND_ASSIGN(HNewInstance);
 };
 
+// Concatenation of the arguments of a `new StringBuilder().append(...)...toString()`
+// chain, allocating the result String in a single runtime call. The inputs are the
+// appended values, followed by the format describing their kinds, see StringBuilderAppend.
+class HStringBuilderAppend FINAL : public HInstruction {
+ public:
+  HStringBuilderAppend(HIntConstant* format,
+                       uint32_t number_of_arguments,
+                       ArenaAllocator* arena,
+                       uint32_t dex_pc)
+      : HInstruction(SideEffects::CanTriggerGC(), dex_pc),
+        inputs_(number_of_arguments + 1u, arena->Adapter(kArenaAllocInvokeInputs)) {
+    DCHECK_NE(number_of_arguments, 0u);
+    SetRawInputAt(FormatIndex(), format);
+  }
+
+  void SetArgumentAt(size_t index, HInstruction* argument) {
+    DCHECK_LT(index, GetNumberOfArguments());
+    SetRawInputAt(index, argument);
+  }
+
+  // Return the number of arguments, excluding the format.
+  size_t GetNumberOfArguments() const {
+    DCHECK_GE(InputCount(), 1u);
+    return InputCount() - 1u;
+  }
+
+  size_t FormatIndex() const { return GetNumberOfArguments(); }
+
+  HIntConstant* GetFormat() {
+    return InputAt(FormatIndex())->AsIntConstant();
+  }
+
+  using HInstruction::GetInputRecords;  // Keep the const version visible.
+  ArrayRef<HUserRecord<HInstruction*>> GetInputRecords() OVERRIDE FINAL {
+    return ArrayRef<HUserRecord<HInstruction*>>(inputs_);
+  }
+
+  Primitive::Type GetType() const OVERRIDE { return Primitive::kPrimNot; }
+
+  // Calls runtime so needs an environment.
+  bool NeedsEnvironment() const OVERRIDE { return true; }
+
+  // Can throw OutOfMemoryError.
+  bool CanThrow() const OVERRIDE { return true; }
+
+  bool CanBeNull() const OVERRIDE { return false; }
+
+  DECLARE_INSTRUCTION(StringBuilderAppend);
+
+ private:
+  ArenaVector<HUserRecord<HInstruction*>> inputs_;
+
+  DISALLOW_COPY_AND_ASSIGN(HStringBuilderAppend);
+};
+
 enum class Intrinsics {
 #define OPTIMIZING_INTRINSICS(Name, IsStatic, NeedsEnvironmentOrCache, SideEffects, Exceptions) \
   k ## Name,
@@ -4926,6 +5100,8 @@ class HTypeConversion FINAL : public HExpression<1> {
   // Try to statically evaluate the conversion and return a HConstant
   // containing the result.  If the input cannot be converted, return nullptr.
   HConstant* TryStaticEvaluation() const;
+  // The same with `input` in place of the input of `this`.
+  HConstant* TryStaticEvaluation(HInstruction* input) const;
 
   static SideEffects SideEffectsForArchRuntimeCalls(Primitive::Type input_type,
                                                     Primitive::Type result_type) {
@@ -5083,6 +5259,7 @@ class HInstanceFieldSet FINAL : public HTemplateInstruction<2> {
                     dex_file,
                     dex_cache) {
     SetPackedFlag<kFlagValueCanBeNull>(true);
+    SetPackedFlag<kFlagNeedsWriteBarrier>(true);
     SetRawInputAt(0, object);
     SetRawInputAt(1, value);
   }
@@ -5098,12 +5275,17 @@ class HInstanceFieldSet FINAL : public HTemplateInstruction<2> {
   HInstruction* GetValue() const { return InputAt(1); }
   bool GetValueCanBeNull() const { return GetPackedFlag<kFlagValueCanBeNull>(); }
   void ClearValueCanBeNull() { SetPackedFlag<kFlagValueCanBeNull>(false); }
+  // Cleared by the write barrier elimination for a reference stored into an object allocated
+  // since the last GC point, the codegen then does not mark its card.
+  bool GetNeedsWriteBarrier() const { return GetPackedFlag<kFlagNeedsWriteBarrier>(); }
+  void ClearNeedsWriteBarrier() { SetPackedFlag<kFlagNeedsWriteBarrier>(false); }
 
   DECLARE_INSTRUCTION(InstanceFieldSet);
 
  private:
   static constexpr size_t kFlagValueCanBeNull = kNumberOfGenericPackedBits;
-  static constexpr size_t kNumberOfInstanceFieldSetPackedBits = kFlagValueCanBeNull + 1;
+  static constexpr size_t kFlagNeedsWriteBarrier = kFlagValueCanBeNull + 1;
+  static constexpr size_t kNumberOfInstanceFieldSetPackedBits = kFlagNeedsWriteBarrier + 1;
   static_assert(kNumberOfInstanceFieldSetPackedBits <= kMaxNumberOfPackedBits,
                 "Too many packed fields.");
 
@@ -5187,6 +5369,7 @@ class HArraySet FINAL : public HTemplateInstruction<3> {
     SetPackedFlag<kFlagNeedsTypeCheck>(value->GetType() == Primitive::kPrimNot);
     SetPackedFlag<kFlagValueCanBeNull>(true);
     SetPackedFlag<kFlagStaticTypeOfArrayIsObjectArray>(false);
+    SetPackedFlag<kFlagNeedsWriteBarrier>(true);
     SetRawInputAt(0, array);
     SetRawInputAt(1, index);
     SetRawInputAt(2, value);
@@ -5224,6 +5407,9 @@ class HArraySet FINAL : public HTemplateInstruction<3> {
   bool StaticTypeOfArrayIsObjectArray() const {
     return GetPackedFlag<kFlagStaticTypeOfArrayIsObjectArray>();
   }
+  // See HInstanceFieldSet::GetNeedsWriteBarrier().
+  bool GetNeedsWriteBarrier() const { return GetPackedFlag<kFlagNeedsWriteBarrier>(); }
+  void ClearNeedsWriteBarrier() { SetPackedFlag<kFlagNeedsWriteBarrier>(false); }
 
   HInstruction* GetArray() const { return InputAt(0); }
   HInstruction* GetIndex() const { return InputAt(1); }
@@ -5266,8 +5452,8 @@ class HArraySet FINAL : public HTemplateInstruction<3> {
   // Cached information for the reference_type_info_ so that codegen
   // does not need to inspect the static type.
   static constexpr size_t kFlagStaticTypeOfArrayIsObjectArray = kFlagValueCanBeNull + 1;
-  static constexpr size_t kNumberOfArraySetPackedBits =
-      kFlagStaticTypeOfArrayIsObjectArray + 1;
+  static constexpr size_t kFlagNeedsWriteBarrier = kFlagStaticTypeOfArrayIsObjectArray + 1;
+  static constexpr size_t kNumberOfArraySetPackedBits = kFlagNeedsWriteBarrier + 1;
   static_assert(kNumberOfArraySetPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
   using ExpectedComponentTypeField =
       BitField<Primitive::Type, kFieldExpectedComponentType, kFieldExpectedComponentTypeSize>;
@@ -5413,7 +5599,8 @@ class HLoadClass FINAL : public HInstruction {
     kBootImageLinkTimePcRelative,
 
     // Use a known boot image Class* address, embedded in the code by the codegen.
-    // Used for boot image classes referenced by apps in AOT- and JIT-compiled code.
+    // Used for boot image classes referenced by apps in AOT- and JIT-compiled code,
+    // and for app image classes in JIT-compiled code.
     // Note: codegen needs to emit a linker patch if indicated by compiler options'
     // GetIncludePatchInformation().
     kBootImageAddress,
@@ -5649,7 +5836,8 @@ class HLoadString FINAL : public HInstruction {
     kBootImageLinkTimePcRelative,
 
     // Use a known boot image String* address, embedded in the code by the codegen.
-    // Used for boot image strings referenced by apps in AOT- and JIT-compiled code.
+    // Used for boot image strings referenced by apps in AOT- and JIT-compiled code,
+    // and for app image strings in JIT-compiled code.
     // Note: codegen needs to emit a linker patch if indicated by compiler options'
     // GetIncludePatchInformation().
     kBootImageAddress,
@@ -6162,7 +6350,9 @@ enum class TypeCheckKind {
   kInterfaceCheck,        // No optimization yet when checking against an interface.
   kArrayObjectCheck,      // Can just check if the array is not primitive.
   kArrayCheck,            // No optimization yet when checking against a generic array.
-  kLast = kArrayCheck
+  kSuperclassDisplayCheck,  // Can do a single compare with the superclass display entry at
+                            // the depth of the class.
+  kLast = kSuperclassDisplayCheck
 };
 
 std::ostream& operator<<(std::ostream& os, TypeCheckKind rhs);
@@ -6172,11 +6362,14 @@ class HInstanceOf FINAL : public HExpression<2> {
   HInstanceOf(HInstruction* object,
               HLoadClass* constant,
               TypeCheckKind check_kind,
+              uint32_t superclass_display_depth,
               uint32_t dex_pc)
       : HExpression(Primitive::kPrimBoolean,
                     SideEffectsForArchRuntimeCalls(check_kind),
                     dex_pc) {
+    DCHECK_EQ(check_kind == TypeCheckKind::kSuperclassDisplayCheck, superclass_display_depth != 0);
     SetPackedField<TypeCheckKindField>(check_kind);
+    SetPackedField<SuperclassDisplayDepthField>(superclass_display_depth);
     SetPackedFlag<kFlagMustDoNullCheck>(true);
     SetRawInputAt(0, object);
     SetRawInputAt(1, constant);
@@ -6197,6 +6390,10 @@ class HInstanceOf FINAL : public HExpression<2> {
   void ClearMustDoNullCheck() { SetPackedFlag<kFlagMustDoNullCheck>(false); }
   TypeCheckKind GetTypeCheckKind() const { return GetPackedField<TypeCheckKindField>(); }
   bool IsExactCheck() const { return GetTypeCheckKind() == TypeCheckKind::kExactCheck; }
+  // The depth of the checked class for kSuperclassDisplayCheck, 0 otherwise.
+  uint32_t GetSuperclassDisplayDepth() const {
+    return GetPackedField<SuperclassDisplayDepthField>();
+  }
 
   static bool CanCallRuntime(TypeCheckKind check_kind) {
     // Mips currently does runtime calls for any other checks.
@@ -6213,10 +6410,18 @@ class HInstanceOf FINAL : public HExpression<2> {
   static constexpr size_t kFieldTypeCheckKind = kNumberOfExpressionPackedBits;
   static constexpr size_t kFieldTypeCheckKindSize =
       MinimumBitsToStore(static_cast<size_t>(TypeCheckKind::kLast));
-  static constexpr size_t kFlagMustDoNullCheck = kFieldTypeCheckKind + kFieldTypeCheckKindSize;
+  static constexpr size_t kFieldSuperclassDisplayDepth =
+      kFieldTypeCheckKind + kFieldTypeCheckKindSize;
+  static constexpr size_t kFieldSuperclassDisplayDepthSize =
+      MinimumBitsToStore(mirror::Class::kSuperclassDisplayLength);
+  static constexpr size_t kFlagMustDoNullCheck =
+      kFieldSuperclassDisplayDepth + kFieldSuperclassDisplayDepthSize;
   static constexpr size_t kNumberOfInstanceOfPackedBits = kFlagMustDoNullCheck + 1;
   static_assert(kNumberOfInstanceOfPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
   using TypeCheckKindField = BitField<TypeCheckKind, kFieldTypeCheckKind, kFieldTypeCheckKindSize>;
+  using SuperclassDisplayDepthField = BitField<uint32_t,
+                                               kFieldSuperclassDisplayDepth,
+                                               kFieldSuperclassDisplayDepthSize>;
 
   DISALLOW_COPY_AND_ASSIGN(HInstanceOf);
 };
@@ -6270,9 +6475,12 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   HCheckCast(HInstruction* object,
              HLoadClass* constant,
              TypeCheckKind check_kind,
+             uint32_t superclass_display_depth,
              uint32_t dex_pc)
       : HTemplateInstruction(SideEffects::CanTriggerGC(), dex_pc) {
+    DCHECK_EQ(check_kind == TypeCheckKind::kSuperclassDisplayCheck, superclass_display_depth != 0);
     SetPackedField<TypeCheckKindField>(check_kind);
+    SetPackedField<SuperclassDisplayDepthField>(superclass_display_depth);
     SetPackedFlag<kFlagMustDoNullCheck>(true);
     SetRawInputAt(0, object);
     SetRawInputAt(1, constant);
@@ -6295,6 +6503,10 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   void ClearMustDoNullCheck() { SetPackedFlag<kFlagMustDoNullCheck>(false); }
   TypeCheckKind GetTypeCheckKind() const { return GetPackedField<TypeCheckKindField>(); }
   bool IsExactCheck() const { return GetTypeCheckKind() == TypeCheckKind::kExactCheck; }
+  // The depth of the checked class for kSuperclassDisplayCheck, 0 otherwise.
+  uint32_t GetSuperclassDisplayDepth() const {
+    return GetPackedField<SuperclassDisplayDepthField>();
+  }
 
   DECLARE_INSTRUCTION(CheckCast);
 
@@ -6302,10 +6514,18 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   static constexpr size_t kFieldTypeCheckKind = kNumberOfGenericPackedBits;
   static constexpr size_t kFieldTypeCheckKindSize =
       MinimumBitsToStore(static_cast<size_t>(TypeCheckKind::kLast));
-  static constexpr size_t kFlagMustDoNullCheck = kFieldTypeCheckKind + kFieldTypeCheckKindSize;
+  static constexpr size_t kFieldSuperclassDisplayDepth =
+      kFieldTypeCheckKind + kFieldTypeCheckKindSize;
+  static constexpr size_t kFieldSuperclassDisplayDepthSize =
+      MinimumBitsToStore(mirror::Class::kSuperclassDisplayLength);
+  static constexpr size_t kFlagMustDoNullCheck =
+      kFieldSuperclassDisplayDepth + kFieldSuperclassDisplayDepthSize;
   static constexpr size_t kNumberOfCheckCastPackedBits = kFlagMustDoNullCheck + 1;
   static_assert(kNumberOfCheckCastPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
   using TypeCheckKindField = BitField<TypeCheckKind, kFieldTypeCheckKind, kFieldTypeCheckKindSize>;
+  using SuperclassDisplayDepthField = BitField<uint32_t,
+                                               kFieldSuperclassDisplayDepth,
+                                               kFieldSuperclassDisplayDepthSize>;
 
   DISALLOW_COPY_AND_ASSIGN(HCheckCast);
 };
@@ -6594,6 +6814,9 @@ class HParallelMove FINAL : public HTemplateInstruction<0> {
 #ifdef ART_ENABLE_CODEGEN_x86
 #include "nodes_x86.h"
 #endif
+#if defined(ART_ENABLE_CODEGEN_arm64) || defined(ART_ENABLE_CODEGEN_x86_64)
+#include "nodes_vector.h"
+#endif
 
 namespace art {
 
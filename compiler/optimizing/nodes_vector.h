@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_NODES_VECTOR_H_
+#define ART_COMPILER_OPTIMIZING_NODES_VECTOR_H_
+
+namespace art {
+
+// Number of lanes of the vector instructions below. All of them operate on 128-bit
+// registers holding 32-bit lanes, whose type is given by the packed type of the
+// instruction (int or float).
+static constexpr size_t kVectorLength = 4;
+
+// Vector values do not have a type of their own in the HIR. They are typed as double so
+// that the register allocator assigns them a floating point register, which is the low
+// half of a SIMD register on the architectures supporting these instructions. Spill slots
+// and moves of such values are only 64 bits wide: the vectorizer guarantees vector values
+// are neither live across a safepoint nor spilled, see HLoopVectorization.
+static constexpr Primitive::Type kVectorValueType = Primitive::kPrimDouble;
+
+// Replicates a scalar into all the lanes of a vector.
+class HVecReplicateScalar FINAL : public HExpression<1> {
+ public:
+  HVecReplicateScalar(HInstruction* scalar, Primitive::Type packed_type, uint32_t dex_pc)
+      : HExpression(kVectorValueType, SideEffects::None(), dex_pc), packed_type_(packed_type) {
+    DCHECK_EQ(scalar->GetType(), packed_type);
+    SetRawInputAt(0, scalar);
+  }
+
+  Primitive::Type GetPackedType() const { return packed_type_; }
+
+  DECLARE_INSTRUCTION(VecReplicateScalar);
+
+ private:
+  const Primitive::Type packed_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(HVecReplicateScalar);
+};
+
+// Loads kVectorLength consecutive elements from `array`, starting at `index`.
+class HVecLoad FINAL : public HExpression<2> {
+ public:
+  HVecLoad(HInstruction* array,
+           HInstruction* index,
+           Primitive::Type packed_type,
+           uint32_t dex_pc)
+      : HExpression(kVectorValueType, SideEffects::ArrayReadOfType(packed_type), dex_pc),
+        packed_type_(packed_type) {
+    SetRawInputAt(0, array);
+    SetRawInputAt(1, index);
+  }
+
+  HInstruction* GetArray() const { return InputAt(0); }
+  HInstruction* GetIndex() const { return InputAt(1); }
+  Primitive::Type GetPackedType() const { return packed_type_; }
+
+  DECLARE_INSTRUCTION(VecLoad);
+
+ private:
+  const Primitive::Type packed_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(HVecLoad);
+};
+
+// Stores the lanes of `value` to kVectorLength consecutive elements of `array`, starting
+// at `index`.
+class HVecStore FINAL : public HTemplateInstruction<3> {
+ public:
+  HVecStore(HInstruction* array,
+            HInstruction* index,
+            HInstruction* value,
+            Primitive::Type packed_type,
+            uint32_t dex_pc)
+      : HTemplateInstruction(SideEffects::ArrayWriteOfType(packed_type), dex_pc),
+        packed_type_(packed_type) {
+    DCHECK_EQ(value->GetType(), kVectorValueType);
+    SetRawInputAt(0, array);
+    SetRawInputAt(1, index);
+    SetRawInputAt(2, value);
+  }
+
+  HInstruction* GetArray() const { return InputAt(0); }
+  HInstruction* GetIndex() const { return InputAt(1); }
+  HInstruction* GetValue() const { return InputAt(2); }
+  Primitive::Type GetPackedType() const { return packed_type_; }
+
+  DECLARE_INSTRUCTION(VecStore);
+
+ private:
+  const Primitive::Type packed_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(HVecStore);
+};
+
+// Lane-wise `left <op> right`, where `op` is the kind of the scalar binary operation
+// this instruction was vectorized from.
+class HVecBinaryOperation FINAL : public HExpression<2> {
+ public:
+  HVecBinaryOperation(InstructionKind op,
+                      HInstruction* left,
+                      HInstruction* right,
+                      Primitive::Type packed_type,
+                      uint32_t dex_pc)
+      : HExpression(kVectorValueType, SideEffects::None(), dex_pc),
+        op_kind_(op),
+        packed_type_(packed_type) {
+    DCHECK(IsSupported(op, packed_type)) << op << " " << packed_type;
+    SetRawInputAt(0, left);
+    SetRawInputAt(1, right);
+  }
+
+  // Whether the scalar operation `op` on `packed_type` values has a vector counterpart.
+  static bool IsSupported(InstructionKind op, Primitive::Type packed_type) {
+    switch (op) {
+      case HInstruction::kAdd:
+      case HInstruction::kSub:
+      case HInstruction::kMul:
+        return packed_type == Primitive::kPrimInt || packed_type == Primitive::kPrimFloat;
+      case HInstruction::kDiv:
+        return packed_type == Primitive::kPrimFloat;
+      case HInstruction::kAnd:
+      case HInstruction::kOr:
+      case HInstruction::kXor:
+        return packed_type == Primitive::kPrimInt;
+      default:
+        return false;
+    }
+  }
+
+  HInstruction* GetLeft() const { return InputAt(0); }
+  HInstruction* GetRight() const { return InputAt(1); }
+  InstructionKind GetOpKind() const { return op_kind_; }
+  Primitive::Type GetPackedType() const { return packed_type_; }
+
+  DECLARE_INSTRUCTION(VecBinaryOperation);
+
+ private:
+  const InstructionKind op_kind_;
+  const Primitive::Type packed_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(HVecBinaryOperation);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_NODES_VECTOR_H_
@@ -46,13 +46,16 @@
 #include "base/arena_containers.h"
 #include "base/dumpable.h"
 #include "base/macros.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "bounds_check_elimination.h"
 #include "builder.h"
 #include "code_generator.h"
+#include "code_sinking.h"
 #include "compiled_method.h"
 #include "compiler.h"
 #include "constant_folding.h"
+#include "constant_propagation.h"
 #include "dead_code_elimination.h"
 #include "debug/elf_debug_writer.h"
 #include "debug/method_debug_info.h"
@@ -62,6 +65,7 @@
 #include "driver/compiler_driver-inl.h"
 #include "driver/compiler_options.h"
 #include "driver/dex_compilation_unit.h"
+#include "driver/pass_statistics.h"
 #include "elf_writer_quick.h"
 #include "graph_checker.h"
 #include "graph_visualizer.h"
@@ -74,14 +78,18 @@
 #include "jit/debugger_interface.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profiling_info.h"
 #include "jni/quick/jni_compiler.h"
 #include "licm.h"
 #include "load_store_elimination.h"
+#include "loop_unrolling.h"
+#include "loop_vectorization.h"
 #include "nodes.h"
 #include "oat_quick_method_header.h"
 #include "prepare_for_register_allocation.h"
 #include "reference_type_propagation.h"
 #include "register_allocator_linear_scan.h"
+#include "scheduler.h"
 #include "select_generator.h"
 #include "sharpening.h"
 #include "side_effects_analysis.h"
@@ -90,6 +98,7 @@
 #include "ssa_phi_elimination.h"
 #include "utils/assembler.h"
 #include "verifier/method_verifier.h"
+#include "write_barrier_elimination.h"
 
 namespace art {
 
@@ -141,7 +150,11 @@ class PassObserver : public ValueObject {
         disasm_info_(graph->GetArena()),
         visualizer_enabled_(!compiler_driver->GetCompilerOptions().GetDumpCfgFileName().empty()),
         visualizer_(visualizer_output, graph, *codegen),
-        graph_in_bad_state_(false) {
+        graph_in_bad_state_(false),
+        pass_statistics_(compiler_driver->GetPassStatistics()),
+        method_start_ns_(pass_statistics_ != nullptr ? NanoTime() : 0u),
+        pass_start_ns_(0u),
+        pass_start_instructions_(0u) {
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_driver, GetMethodName())) {
         timing_logger_enabled_ = visualizer_enabled_ = false;
@@ -158,6 +171,13 @@ class PassObserver : public ValueObject {
       LOG(INFO) << "TIMINGS " << GetMethodName();
       LOG(INFO) << Dumpable<TimingLogger>(timing_logger_);
     }
+    if (pass_statistics_ != nullptr) {
+      method_record_.time_ns = NanoTime() - method_start_ns_;
+      method_record_.instructions = CountInstructions();
+      pass_statistics_->AddMethod(
+          method_record_,
+          pass_statistics_->IsSlowest(method_record_.time_ns) ? GetMethodName() : "");
+    }
   }
 
   void DumpDisassembly() const {
@@ -185,10 +205,21 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (pass_statistics_ != nullptr) {
+      pass_start_instructions_ = static_cast<int64_t>(CountInstructions());
+      pass_start_ns_ = NanoTime();
+    }
   }
 
   void EndPass(const char* pass_name) {
     // Pause timer first, then dump graph.
+    if (pass_statistics_ != nullptr) {
+      const uint64_t pass_time_ns = NanoTime() - pass_start_ns_;
+      const int64_t instruction_delta =
+          static_cast<int64_t>(CountInstructions()) - pass_start_instructions_;
+      method_record_.passes.push_back(
+          PassStatistics::Pass { pass_name, pass_time_ns, instruction_delta });
+    }
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
@@ -208,6 +239,17 @@ class PassObserver : public ValueObject {
     }
   }
 
+  // Instructions and phis of the graph, to tell how much each pass grows or shrinks it.
+  size_t CountInstructions() const {
+    size_t count = 0;
+    for (HBasicBlock* block : graph_->GetBlocks()) {
+      if (block != nullptr) {
+        count += block->GetPhis().CountSize() + block->GetInstructions().CountSize();
+      }
+    }
+    return count;
+  }
+
   static bool IsVerboseMethod(CompilerDriver* compiler_driver, const char* method_name) {
     // Test an exact match to --verbose-methods. If verbose-methods is set, this overrides an
     // empty kStringFilter matching all methods.
@@ -241,6 +283,13 @@ class PassObserver : public ValueObject {
   // expected to validate.
   bool graph_in_bad_state_;
 
+  // Null unless --dump-pass-stats is given.
+  PassStatistics* const pass_statistics_;
+  const uint64_t method_start_ns_;
+  uint64_t pass_start_ns_;
+  int64_t pass_start_instructions_;
+  PassStatistics::MethodRecord method_record_;
+
   friend PassScope;
 
   DISALLOW_COPY_AND_ASSIGN(PassObserver);
@@ -301,7 +350,11 @@ class OptimizingCompiler FINAL : public Compiler {
     }
   }
 
-  bool JitCompile(Thread* self, jit::JitCodeCache* code_cache, ArtMethod* method, bool osr)
+  bool JitCompile(Thread* self,
+                  jit::JitCodeCache* code_cache,
+                  ArtMethod* method,
+                  bool osr,
+                  bool baseline)
       OVERRIDE
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -311,7 +364,9 @@ class OptimizingCompiler FINAL : public Compiler {
                                 CompilerDriver* driver,
                                 const DexCompilationUnit& dex_compilation_unit,
                                 PassObserver* pass_observer,
-                                StackHandleScopeCollection* handles) const;
+                                StackHandleScopeCollection* handles,
+                                bool baseline,
+                                uint64_t deadline_ns) const;
 
   virtual void RunOptimizations(HOptimization* optimizations[],
                                 size_t length,
@@ -330,7 +385,8 @@ class OptimizingCompiler FINAL : public Compiler {
   // This method:
   // 1) Builds the graph. Returns null if it failed to build it.
   // 2) Transforms the graph to SSA. Returns null if it failed.
-  // 3) Runs optimizations on the graph, including register allocator.
+  // 3) Runs optimizations on the graph, including register allocator. A `baseline`
+  //    compilation only runs the passes the code generator relies on.
   // 4) Generates code with the `code_allocator` provided.
   CodeGenerator* TryCompile(ArenaAllocator* arena,
                             CodeVectorAllocator* code_allocator,
@@ -343,7 +399,8 @@ class OptimizingCompiler FINAL : public Compiler {
                             const DexFile& dex_file,
                             Handle<mirror::DexCache> dex_cache,
                             ArtMethod* method,
-                            bool osr) const;
+                            bool osr,
+                            bool baseline) const;
 
   void MaybeRunInliner(HGraph* graph,
                        CodeGenerator* codegen,
@@ -357,6 +414,20 @@ class OptimizingCompiler FINAL : public Compiler {
                             CodeGenerator* codegen,
                             PassObserver* pass_observer) const;
 
+  // Run the remaining passes of a baseline compilation, once intrinsics recognition and
+  // sharpening ran, and allocate registers. The final instruction simplifier is already
+  // done if `simplified`.
+  void FinishBaseline(HGraph* graph,
+                      CodeGenerator* codegen,
+                      CompilerDriver* driver,
+                      PassObserver* pass_observer,
+                      bool simplified) const;
+
+  // Whether the compilation of the method of `dex_compilation_unit` went past the given
+  // --method-compile-budget deadline, 0 if there is none. Reports the method if so.
+  bool IsOverMethodCompileBudget(uint64_t deadline_ns,
+                                 const DexCompilationUnit& dex_compilation_unit) const;
+
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
   std::unique_ptr<std::ostream> visualizer_output_;
@@ -393,6 +464,7 @@ void OptimizingCompiler::UnInit() const {
 OptimizingCompiler::~OptimizingCompiler() {
   if (compilation_stats_.get() != nullptr) {
     compilation_stats_->Log();
+    compilation_stats_->LogLargestArenaUses();
   }
 }
 
@@ -453,6 +525,7 @@ void OptimizingCompiler::MaybeRunInliner(HGraph* graph,
       handles,
       stats,
       number_of_dex_registers,
+      /* total_number_of_inlined_instructions */ 0,
       /* depth */ 0);
   HOptimization* optimizations[] = { inliner };
 
@@ -544,6 +617,22 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
 }
 
 NO_INLINE  // Avoid increasing caller's frame size by large stack-allocated objects.
+// Hot methods of a profile guided compilation are worth the slower graph coloring
+// allocator, which spills and moves less. Other methods, and the JIT, which compiles
+// without a profile, use the strategy of the compiler options.
+static RegisterAllocator::Strategy SelectRegisterAllocationStrategy(
+    CompilerDriver* driver,
+    const DexCompilationUnit& dex_compilation_unit) {
+  const CompilerOptions& compiler_options = driver->GetCompilerOptions();
+  MethodReference method_ref(dex_compilation_unit.GetDexFile(),
+                             dex_compilation_unit.GetDexMethodIndex());
+  if (compiler_options.UseProfileGuidedRegisterAllocation() &&
+      driver->IsMethodInProfile(method_ref)) {
+    return RegisterAllocator::kRegisterAllocatorGraphColor;
+  }
+  return compiler_options.GetRegisterAllocationStrategy();
+}
+
 static void AllocateRegisters(HGraph* graph,
                               CodeGenerator* codegen,
                               PassObserver* pass_observer,
@@ -564,14 +653,65 @@ static void AllocateRegisters(HGraph* graph,
   }
 }
 
+void OptimizingCompiler::FinishBaseline(HGraph* graph,
+                                        CodeGenerator* codegen,
+                                        CompilerDriver* driver,
+                                        PassObserver* pass_observer,
+                                        bool simplified) const {
+  if (!simplified) {
+    // See `simplify3` in RunOptimizations.
+    HOptimization* optimizations[] = {
+      new (graph->GetArena()) InstructionSimplifier(
+          graph, compilation_stats_.get(), "instruction_simplifier_before_codegen"),
+    };
+    RunOptimizations(optimizations, arraysize(optimizations), pass_observer);
+  }
+  // The architecture passes are kept, some of them fix up what sharpening produced.
+  RunArchOptimizations(driver->GetInstructionSet(), graph, codegen, pass_observer);
+  // Linear scan, the graph coloring allocator does not scale to huge methods.
+  AllocateRegisters(graph,
+                    codegen,
+                    pass_observer,
+                    RegisterAllocator::kRegisterAllocatorLinearScan);
+}
+
+bool OptimizingCompiler::IsOverMethodCompileBudget(
+    uint64_t deadline_ns,
+    const DexCompilationUnit& dex_compilation_unit) const {
+  if (deadline_ns == 0u || NanoTime() <= deadline_ns) {
+    return false;
+  }
+  LOG(WARNING) << "Compilation of "
+               << PrettyMethod(dex_compilation_unit.GetDexMethodIndex(),
+                               *dex_compilation_unit.GetDexFile())
+               << " exceeded its budget, finishing with the baseline passes";
+  MaybeRecordStat(MethodCompilationStat::kCompiledOverBudgetBaseline);
+  return true;
+}
+
 void OptimizingCompiler::RunOptimizations(HGraph* graph,
                                           CodeGenerator* codegen,
                                           CompilerDriver* driver,
                                           const DexCompilationUnit& dex_compilation_unit,
                                           PassObserver* pass_observer,
-                                          StackHandleScopeCollection* handles) const {
+                                          StackHandleScopeCollection* handles,
+                                          bool baseline,
+                                          uint64_t deadline_ns) const {
   OptimizingCompilerStats* stats = compilation_stats_.get();
   ArenaAllocator* arena = graph->GetArena();
+  if (baseline) {
+    // The baseline JIT tier trades code quality for compile time: no inlining and no
+    // global optimizations, the method gets recompiled with the full pipeline if it
+    // stays hot. Huge methods are also compiled this way, see TryCompile.
+    HOptimization* baseline_optimizations[] = {
+      new (arena) IntrinsicsRecognizer(graph, driver, stats),
+      new (arena) HSharpening(graph, codegen, dex_compilation_unit, driver),
+    };
+    RunOptimizations(baseline_optimizations, arraysize(baseline_optimizations), pass_observer);
+    FinishBaseline(graph, codegen, driver, pass_observer, /* simplified */ false);
+    return;
+  }
+
   HDeadCodeElimination* dce1 = new (arena) HDeadCodeElimination(
       graph, stats, HDeadCodeElimination::kInitialDeadCodeEliminationPassName);
   HDeadCodeElimination* dce2 = new (arena) HDeadCodeElimination(
@@ -581,11 +721,16 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
   HSelectGenerator* select_generator = new (arena) HSelectGenerator(graph, stats);
   HConstantFolding* fold2 = new (arena) HConstantFolding(graph, "constant_folding_after_inlining");
   HConstantFolding* fold3 = new (arena) HConstantFolding(graph, "constant_folding_after_bce");
+  HConstantPropagation* propagation = new (arena) HConstantPropagation(graph, stats);
+  HDeadCodeElimination* dce_after_propagation = new (arena) HDeadCodeElimination(
+      graph, stats, "dead_code_elimination_after_constant_propagation");
   SideEffectsAnalysis* side_effects = new (arena) SideEffectsAnalysis(graph);
   GVNOptimization* gvn = new (arena) GVNOptimization(graph, *side_effects);
   LICM* licm = new (arena) LICM(graph, *side_effects, stats);
   LoadStoreElimination* lse = new (arena) LoadStoreElimination(graph, *side_effects);
   HInductionVarAnalysis* induction = new (arena) HInductionVarAnalysis(graph);
+  HInductionVarAnalysis* induction_before_unrolling = new (arena) HInductionVarAnalysis(graph);
+  HLoopUnrolling* unrolling = new (arena) HLoopUnrolling(graph, induction_before_unrolling, stats);
   BoundsCheckElimination* bce = new (arena) BoundsCheckElimination(graph, *side_effects, induction);
   HSharpening* sharpening = new (arena) HSharpening(graph, codegen, dex_compilation_unit, driver);
   InstructionSimplifier* simplify2 = new (arena) InstructionSimplifier(
@@ -593,6 +738,7 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
   InstructionSimplifier* simplify3 = new (arena) InstructionSimplifier(
       graph, stats, "instruction_simplifier_before_codegen");
   IntrinsicsRecognizer* intrinsics = new (arena) IntrinsicsRecognizer(graph, driver, stats);
+  CodeSinking* code_sinking = new (arena) CodeSinking(graph, stats);
 
   HOptimization* optimizations1[] = {
     intrinsics,
@@ -602,14 +748,32 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     dce1,
   };
   RunOptimizations(optimizations1, arraysize(optimizations1), pass_observer);
+  // A method past its compile budget skips the remaining optional passes. The budget is only
+  // checked between these groups of passes, which cannot be interrupted.
+  if (IsOverMethodCompileBudget(deadline_ns, dex_compilation_unit)) {
+    FinishBaseline(graph, codegen, driver, pass_observer, /* simplified */ false);
+    return;
+  }
 
   MaybeRunInliner(graph, codegen, driver, dex_compilation_unit, pass_observer, handles);
+  if (IsOverMethodCompileBudget(deadline_ns, dex_compilation_unit)) {
+    FinishBaseline(graph, codegen, driver, pass_observer, /* simplified */ false);
+    return;
+  }
 
   HOptimization* optimizations2[] = {
     // SelectGenerator depends on the InstructionSimplifier removing
     // redundant suspend checks to recognize empty blocks.
     select_generator,
+    // Unrolling and peeling come before the passes which clean up and hoist the copied
+    // instructions.
+    induction_before_unrolling,
+    unrolling,
     fold2,  // TODO: if we don't inline we can also skip fold2.
+    // Propagates the constants of the inlined arguments through the phis of the caller, and
+    // removes the branches on them before GVN, LICM and BCE look at the loops.
+    propagation,
+    dce_after_propagation,
     side_effects,
     gvn,
     licm,
@@ -619,16 +783,53 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     simplify2,
     lse,
     dce2,
+    // Code sinking runs once LSE and DCE removed the stores and allocations they could,
+    // and moves the remaining ones used only on throwing paths.
+    code_sinking,
     // The codegen has a few assumptions that only the instruction simplifier
     // can satisfy. For example, the code generator does not expect to see a
     // HTypeConversion from a type to the same type.
     simplify3,
   };
   RunOptimizations(optimizations2, arraysize(optimizations2), pass_observer);
+  if (IsOverMethodCompileBudget(deadline_ns, dex_compilation_unit)) {
+    FinishBaseline(graph, codegen, driver, pass_observer, /* simplified */ true);
+    return;
+  }
+
+#if defined(ART_ENABLE_CODEGEN_arm64) || defined(ART_ENABLE_CODEGEN_x86_64)
+  // The vectorizer matches loops whose bounds checks BCE removed, and needs a fresh
+  // induction analysis of the final loop bodies.
+  HInductionVarAnalysis* induction2 = new (arena) HInductionVarAnalysis(graph);
+  HLoopVectorization* vectorization = new (arena) HLoopVectorization(
+      graph, codegen, *driver->GetInstructionSetFeatures(), induction2, stats);
+  HOptimization* vector_optimizations[] = {
+    induction2,
+    vectorization,
+  };
+  RunOptimizations(vector_optimizations, arraysize(vector_optimizations), pass_observer);
+#endif
 
   RunArchOptimizations(driver->GetInstructionSet(), graph, codegen, pass_observer);
+
+  // Scheduling comes last, once the architecture passes produced the final instructions.
+  HInstructionScheduling* scheduling = new (arena) HInstructionScheduling(
+      graph, driver->GetInstructionSet(), *driver->GetInstructionSetFeatures());
+  HOptimization* scheduling_optimizations[] = { scheduling };
+  RunOptimizations(scheduling_optimizations, arraysize(scheduling_optimizations), pass_observer);
+
+  // Only the ARM64 and x86-64 code generators look at the write barriers it removes. It needs
+  // the final order of the instructions, so it comes after the scheduling.
+  if (driver->GetInstructionSet() == kArm64 || driver->GetInstructionSet() == kX86_64) {
+    WriteBarrierElimination* wbe = new (arena) WriteBarrierElimination(graph, stats);
+    HOptimization* write_barrier_optimizations[] = { wbe };
+    RunOptimizations(write_barrier_optimizations,
+                     arraysize(write_barrier_optimizations),
+                     pass_observer);
+  }
+
   RegisterAllocator::Strategy regalloc_strategy =
-      driver->GetCompilerOptions().GetRegisterAllocationStrategy();
+      SelectRegisterAllocationStrategy(driver, dex_compilation_unit);
   AllocateRegisters(graph, codegen, pass_observer, regalloc_strategy);
 }
 
@@ -684,7 +885,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
                                               const DexFile& dex_file,
                                               Handle<mirror::DexCache> dex_cache,
                                               ArtMethod* method,
-                                              bool osr) const {
+                                              bool osr,
+                                              bool baseline) const {
   MaybeRecordStat(MethodCompilationStat::kAttemptCompilation);
   CompilerDriver* compiler_driver = GetCompilerDriver();
   InstructionSet instruction_set = compiler_driver->GetInstructionSet();
@@ -764,6 +966,20 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
     graph->SetArtMethod(method);
     ScopedObjectAccess soa(Thread::Current());
     interpreter_metadata = method->GetQuickenedInfo();
+    if (osr) {
+      // Only the loops around where the interpreter last branched to need to be OSR
+      // entries, so that the other loops are optimized as in regular compiled code.
+      ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+      if (info != nullptr && info->GetOsrEntryDexPc() != DexFile::kDexNoIndex) {
+        graph->SetOsrEntryDexPc(info->GetOsrEntryDexPc());
+      }
+    }
+    if (Runtime::Current()->UseJitCompilation()) {
+      ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+      if (info != nullptr && !info->ShouldSpeculate()) {
+        graph->DisableSpeculativeDeoptimization();
+      }
+    }
     uint16_t type_index = method->GetDeclaringClass()->GetDexTypeIndex();
 
     // Update the dex cache if the type is not in it yet. Note that under AOT,
@@ -788,6 +1004,15 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
   }
   codegen->GetAssembler()->cfi().SetEnabled(
       compiler_driver->GetCompilerOptions().GenerateAnyDebugInfo());
+  if (!compiler_driver->IsBootImage()) {
+    // A multi-image boot image splits the dex files being compiled over several oat files,
+    // the dex file indexes of the inline info would not be those of the outer method's oat file.
+    codegen->SetDexFilesForOatFile(compiler_driver->GetDexFilesForOatFile());
+  }
+
+  const size_t method_compile_budget_ms = compiler_options.GetMethodCompileBudgetMs();
+  const uint64_t deadline_ns =
+      (method_compile_budget_ms != 0u) ? NanoTime() + MsToNs(method_compile_budget_ms) : 0u;
 
   PassObserver pass_observer(graph,
                              codegen.get(),
@@ -837,12 +1062,27 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
       }
     }
 
+    // Compiling a huge method with the full pipeline takes too long, but leaving it to the
+    // interpreter costs more: use the baseline pipeline, which skips the global passes.
+    bool huge_method = compiler_options.GetCompilerFilter() != CompilerFilter::kEverything &&
+        compiler_options.IsHugeMethod(code_item->insns_size_in_code_units_);
+    if (huge_method && !baseline) {
+      VLOG(compiler) << "Baseline compilation of huge method "
+                     << PrettyMethod(method_idx, dex_file) << ": "
+                     << code_item->insns_size_in_code_units_ << " code units";
+      MaybeRecordStat(MethodCompilationStat::kCompiledHugeMethodBaseline);
+    }
+    bool over_budget =
+        !baseline && !huge_method && IsOverMethodCompileBudget(deadline_ns, dex_compilation_unit);
+
     RunOptimizations(graph,
                      codegen.get(),
                      compiler_driver,
                      dex_compilation_unit,
                      &pass_observer,
-                     &handles);
+                     &handles,
+                     baseline || huge_method || over_budget,
+                     deadline_ns);
 
     codegen->Compile(code_allocator);
     pass_observer.DumpDisassembly();
@@ -881,10 +1121,14 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                    dex_file,
                    dex_cache,
                    nullptr,
-                   /* osr */ false));
+                   /* osr */ false,
+                   /* baseline */ false));
     if (codegen.get() != nullptr) {
       MaybeRecordStat(MethodCompilationStat::kCompiled);
       method = Emit(&arena, &code_allocator, codegen.get(), compiler_driver, code_item);
+      if (compilation_stats_.get() != nullptr) {
+        compilation_stats_->RecordArenaUse(arena.BytesUsed(), method_idx, dex_file);
+      }
 
       if (kArenaAllocatorCountAllocations) {
         if (arena.BytesAllocated() > kArenaAllocatorMemoryReportThreshold) {
@@ -935,7 +1179,45 @@ bool IsCompilingWithCoreImage() {
 bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     ArtMethod* method,
-                                    bool osr) {
+                                    bool osr,
+                                    bool baseline) {
+  if (method->IsNative()) {
+    // Replace the generic JNI trampoline with the stub AOT compilation would have generated.
+    DCHECK(!osr);
+    const DexFile* dex_file = method->GetDexFile();
+    const uint32_t method_idx = method->GetDexMethodIndex();
+    CompiledMethod* compiled_method = nullptr;
+    {
+      ScopedThreadSuspension sts(self, kNative);
+      compiled_method = JniCompile(method->GetAccessFlags(), method_idx, *dex_file);
+    }
+    if (compiled_method == nullptr) {
+      return false;
+    }
+    ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
+    // A JNI stub does not rely on any single implementation.
+    ArenaAllocator arena(Runtime::Current()->GetJitArenaPool());
+    ArenaSet<ArtMethod*> no_cha_dependencies(arena.Adapter(kArenaAllocCHA));
+    const void* code = code_cache->CommitCode(
+        self,
+        method,
+        /* vmap_table */ nullptr,
+        compiled_method->GetFrameSizeInBytes(),
+        compiled_method->GetCoreSpillMask(),
+        compiled_method->GetFpSpillMask(),
+        quick_code.data(),
+        quick_code.size(),
+        /* osr */ false,
+        /* baseline */ false,
+        no_cha_dependencies);
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(GetCompilerDriver(), compiled_method);
+    if (code == nullptr) {
+      return false;
+    }
+    MaybeRecordStat(MethodCompilationStat::kCompiledJniStub);
+    return true;
+  }
+
   StackHandleScope<2> hs(self);
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
       method->GetDeclaringClass()->GetClassLoader()));
@@ -968,7 +1250,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    *dex_file,
                    dex_cache,
                    method,
-                   osr));
+                   osr,
+                   baseline));
     if (codegen.get() == nullptr) {
       return false;
     }
@@ -997,7 +1280,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
       codegen->GetFpuSpillMask(),
       code_allocator.GetMemory().data(),
       code_allocator.GetSize(),
-      osr);
+      osr,
+      baseline,
+      graph->GetCHASingleImplementationList());
 
   if (code == nullptr) {
     code_cache->ClearData(self, stack_map_data);
@@ -1025,11 +1310,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
     info.frame_size_in_bytes = method_header->GetFrameSizeInBytes();
     info.code_info = stack_map_size == 0 ? nullptr : stack_map_data;
     info.cfi = ArrayRef<const uint8_t>(*codegen->GetAssembler()->cfi().data());
-    std::vector<uint8_t> elf_file = debug::WriteDebugElfFileForMethods(
-        GetCompilerDriver()->GetInstructionSet(),
-        GetCompilerDriver()->GetInstructionSetFeatures(),
-        ArrayRef<const debug::MethodDebugInfo>(&info, 1));
-    CreateJITCodeEntryForAddress(code_address, std::move(elf_file));
+    // The ELF file is written lazily, together with other methods.
+    AddJITMethodDebugInfo(code_address, debug::ElfJITDebugInfoWriter::CreateMethodDebugInfo(info));
   }
 
   Runtime::Current()->GetJit()->AddMemoryUsage(method, arena.BytesUsed());
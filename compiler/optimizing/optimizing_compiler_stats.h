@@ -18,16 +18,23 @@
 #define ART_COMPILER_OPTIMIZING_OPTIMIZING_COMPILER_STATS_H_
 
 #include <iomanip>
+#include <sstream>
 #include <string>
 #include <type_traits>
 
 #include "atomic.h"
+#include "base/arena_allocator.h"
+#include "base/mutex.h"
+#include "thread.h"
+#include "utils.h"
 
 namespace art {
 
 enum MethodCompilationStat {
   kAttemptCompilation = 0,
   kCompiled,
+  kCompiledHugeMethodBaseline,
+  kCompiledOverBudgetBaseline,
   kInlinedInvoke,
   kReplacedInvokeWithSimplePattern,
   kInstructionSimplifications,
@@ -42,7 +49,6 @@ enum MethodCompilationStat {
   kNotCompiledInvalidBytecode,
   kNotCompiledThrowCatchLoop,
   kNotCompiledAmbiguousArrayOp,
-  kNotCompiledHugeMethod,
   kNotCompiledLargeMethodNoBranches,
   kNotCompiledMalformedOpcode,
   kNotCompiledNoCodegen,
@@ -54,6 +60,9 @@ enum MethodCompilationStat {
   kNotCompiledVerifyAtRuntime,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedMegamorphicCall,
+  kCHAInline,
+  kDevirtualizedImtConflictCall,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
@@ -66,17 +75,45 @@ enum MethodCompilationStat {
   kImplicitNullCheckGenerated,
   kExplicitNullCheckGenerated,
   kSimplifyIf,
+  kLoopVectorized,
+  kLoopPeeled,
+  kLoopFullyUnrolled,
+  kInstructionSunk,
+  kRemovedWriteBarrier,
+  kConstantPropagated,
+  kFoldedLoadIntoMemoryOperand,
+  kCompiledJniStub,
   kLastStat
 };
 
 class OptimizingCompilerStats {
  public:
-  OptimizingCompilerStats() {}
+  OptimizingCompilerStats()
+      : arena_uses_lock_("Optimizing compiler arena uses lock"),
+        largest_arena_uses_(kNumLargestArenaUses) {}
 
   void RecordStat(MethodCompilationStat stat, size_t count = 1) {
     compile_stats_[stat] += count;
   }
 
+  // Record the arena memory used to compile a method.
+  void RecordArenaUse(size_t bytes, uint32_t method_idx, const DexFile& dex_file)
+      REQUIRES(!arena_uses_lock_) {
+    MutexLock mu(Thread::Current(), arena_uses_lock_);
+    if (largest_arena_uses_.IsKept(bytes)) {
+      largest_arena_uses_.Add(bytes, PrettyMethod(method_idx, dex_file));
+    }
+  }
+
+  // Log the methods that used the most arena memory. Unlike Log(), this also logs in release
+  // builds, as the stats are only collected with --dump-stats.
+  void LogLargestArenaUses() REQUIRES(!arena_uses_lock_) {
+    MutexLock mu(Thread::Current(), arena_uses_lock_);
+    std::ostringstream oss;
+    largest_arena_uses_.Dump(oss);
+    LOG(INFO) << "Methods using the most arena memory to compile:\n" << oss.str();
+  }
+
   void Log() const {
     if (!kIsDebugBuild && !VLOG_IS_ON(compiler)) {
       // Log only in debug builds or if the compiler is verbose.
@@ -107,6 +144,8 @@ class OptimizingCompilerStats {
     switch (stat) {
       case kAttemptCompilation : name = "AttemptCompilation"; break;
       case kCompiled : name = "Compiled"; break;
+      case kCompiledHugeMethodBaseline : name = "CompiledHugeMethodBaseline"; break;
+      case kCompiledOverBudgetBaseline : name = "CompiledOverBudgetBaseline"; break;
       case kInlinedInvoke : name = "InlinedInvoke"; break;
       case kReplacedInvokeWithSimplePattern: name = "ReplacedInvokeWithSimplePattern"; break;
       case kInstructionSimplifications: name = "InstructionSimplifications"; break;
@@ -121,7 +160,6 @@ class OptimizingCompilerStats {
       case kNotCompiledInvalidBytecode: name = "NotCompiledInvalidBytecode"; break;
       case kNotCompiledThrowCatchLoop : name = "NotCompiledThrowCatchLoop"; break;
       case kNotCompiledAmbiguousArrayOp : name = "NotCompiledAmbiguousArrayOp"; break;
-      case kNotCompiledHugeMethod : name = "NotCompiledHugeMethod"; break;
       case kNotCompiledLargeMethodNoBranches : name = "NotCompiledLargeMethodNoBranches"; break;
       case kNotCompiledMalformedOpcode : name = "NotCompiledMalformedOpcode"; break;
       case kNotCompiledNoCodegen : name = "NotCompiledNoCodegen"; break;
@@ -133,6 +171,9 @@ class OptimizingCompilerStats {
       case kNotCompiledVerifyAtRuntime : name = "NotCompiledVerifyAtRuntime"; break;
       case kInlinedMonomorphicCall: name = "InlinedMonomorphicCall"; break;
       case kInlinedPolymorphicCall: name = "InlinedPolymorphicCall"; break;
+      case kInlinedMegamorphicCall: name = "InlinedMegamorphicCall"; break;
+      case kCHAInline: name = "CHAInline"; break;
+      case kDevirtualizedImtConflictCall: name = "DevirtualizedImtConflictCall"; break;
       case kMonomorphicCall: name = "MonomorphicCall"; break;
       case kPolymorphicCall: name = "PolymorphicCall"; break;
       case kMegamorphicCall: name = "MegamorphicCall"; break;
@@ -145,6 +186,14 @@ class OptimizingCompilerStats {
       case kImplicitNullCheckGenerated: name = "ImplicitNullCheckGenerated"; break;
       case kExplicitNullCheckGenerated: name = "ExplicitNullCheckGenerated"; break;
       case kSimplifyIf: name = "SimplifyIf"; break;
+      case kLoopVectorized: name = "LoopVectorized"; break;
+      case kLoopPeeled: name = "LoopPeeled"; break;
+      case kLoopFullyUnrolled: name = "LoopFullyUnrolled"; break;
+      case kInstructionSunk: name = "InstructionSunk"; break;
+      case kRemovedWriteBarrier: name = "RemovedWriteBarrier"; break;
+      case kConstantPropagated: name = "ConstantPropagated"; break;
+      case kFoldedLoadIntoMemoryOperand: name = "FoldedLoadIntoMemoryOperand"; break;
+      case kCompiledJniStub: name = "CompiledJniStub"; break;
 
       case kLastStat:
         LOG(FATAL) << "invalid stat "
@@ -154,8 +203,13 @@ class OptimizingCompilerStats {
     return "OptStat#" + name;
   }
 
+  static constexpr size_t kNumLargestArenaUses = 10;
+
   AtomicInteger compile_stats_[kLastStat];
 
+  Mutex arena_uses_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  LargestArenaUses largest_arena_uses_ GUARDED_BY(arena_uses_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(OptimizingCompilerStats);
 };
 
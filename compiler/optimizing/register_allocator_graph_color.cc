@@ -16,6 +16,8 @@
 
 #include "register_allocator_graph_color.h"
 
+#include <limits>
+
 #include "code_generator.h"
 #include "register_allocation_resolver.h"
 #include "ssa_liveness_analysis.h"
@@ -37,6 +39,52 @@ static constexpr size_t kMaxNumRegs = 32;
 // intervals are split when coloring fails.
 static constexpr size_t kMaxGraphColoringAttemptsDebug = 100;
 
+// Spill weights are multiplied by this factor for each loop around a use, on the assumption
+// that loop bodies execute that many more times than the code around them.
+static constexpr float kLoopSpillWeightMultiplier = 10.0f;
+
+// Loop depths beyond this one are not distinguished, which keeps the spill weights finite.
+static constexpr size_t kMaxLoopDepthForSpillWeight = 8;
+
+// Intervals this short cannot be split any further (see SplitAtRegisterUses).
+static constexpr size_t kMaxUnsplittableIntervalLength = 2;
+
+// Estimated number of executions of `block`, relative to the code outside of loops.
+static float EstimateFrequency(const HBasicBlock* block) {
+  float frequency = 1.0f;
+  size_t depth = 0;
+  for (HLoopInformationOutwardIterator it(*block);
+       !it.Done() && depth < kMaxLoopDepthForSpillWeight;
+       it.Advance(), ++depth) {
+    frequency *= kLoopSpillWeightMultiplier;
+  }
+  return frequency;
+}
+
+// The spill weight of an interval estimates how many loads and stores spilling it would
+// cost per position it covers: the more register uses, and the deeper in loops, the more
+// expensive. Intervals which cannot be split get the maximum weight, since spilling them
+// does not make the interference graph any sparser.
+static float ComputeSpillWeight(LiveInterval* interval) {
+  if (interval->IsTemp() || interval->GetLength() <= kMaxUnsplittableIntervalLength) {
+    return std::numeric_limits<float>::max();
+  }
+  float use_weight = 0.0f;
+  if (interval->IsParent() && interval->DefinitionRequiresRegister()) {
+    use_weight += EstimateFrequency(interval->GetDefinedBy()->GetBlock());
+  }
+  size_t start = interval->GetStart();
+  size_t end = interval->GetEnd();
+  for (UsePosition* use = interval->GetFirstUse();
+       use != nullptr && use->GetPosition() <= end;
+       use = use->GetNext()) {
+    if (use->GetPosition() >= start && use->RequiresRegister()) {
+      use_weight += EstimateFrequency(use->GetUser()->GetBlock());
+    }
+  }
+  return use_weight / interval->GetLength();
+}
+
 // Interference nodes make up the interference graph, which is the primary data structure in
 // graph coloring register allocation. Each node represents a single live interval, and contains
 // a set of adjacent nodes corresponding to intervals overlapping with its own. To save memory,
@@ -56,13 +104,28 @@ static constexpr size_t kMaxGraphColoringAttemptsDebug = 100;
 // block an entire two-register aligned slot for the pair node.
 // The degree is defined this way because we use it to decide whether a node is guaranteed a color,
 // and thus whether it is safe to prune it from the interference graph early on.
+//
+// Nodes whose intervals are connected by a move, and which do not interfere, may be coalesced
+// into a single node before pruning. The remaining node then stands for all of them: it gets
+// their interferences, and its color (or spill) is given to all the coalesced intervals.
 class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
  public:
   InterferenceNode(ArenaAllocator* allocator, LiveInterval* interval, size_t id)
         : interval_(interval),
           adjacent_nodes_(CmpPtr, allocator->Adapter(kArenaAllocRegisterAllocator)),
           out_degree_(0),
-          id_(id) {}
+          id_(id),
+          alias_(this),
+          coalesced_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+          affinities_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+          requires_register_(false),
+          spill_weight_(0.0f) {
+    // Only the nodes to color need these, and they are meaningless for synthesized intervals.
+    if (!interval->HasRegister() && !interval->IsSlowPathSafepoint()) {
+      requires_register_ = interval->RequiresRegister();
+      spill_weight_ = ComputeSpillWeight(interval);
+    }
+  }
 
   // Used to maintain determinism when storing InterferenceNode pointers in sets.
   static bool CmpPtr(const InterferenceNode* lhs, const InterferenceNode* rhs) {
@@ -101,6 +164,65 @@ class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
     return id_;
   }
 
+  // Whether this node, or a node coalesced with it, requires a register. Cached, since
+  // LiveInterval::RequiresRegister() iterates over the uses of the interval.
+  bool RequiresRegister() const {
+    return requires_register_;
+  }
+
+  float GetSpillWeight() const {
+    return spill_weight_;
+  }
+
+  // The node this one was coalesced into, or this node if it was not coalesced.
+  InterferenceNode* GetAlias() {
+    InterferenceNode* node = this;
+    while (node->alias_ != node) {
+      node = node->alias_;
+    }
+    return node;
+  }
+
+  bool IsCoalesced() const {
+    return alias_ != this;
+  }
+
+  // Merge `other` into this node. The nodes must not interfere.
+  void Coalesce(InterferenceNode* other) {
+    DCHECK(!IsCoalesced());
+    DCHECK(!other->IsCoalesced());
+    DCHECK(!ContainsInterference(other));
+    for (InterferenceNode* adjacent : other->adjacent_nodes_) {
+      if (!adjacent->GetInterval()->HasRegister()) {
+        // Fixed nodes have no outgoing edges.
+        adjacent->RemoveInterference(other);
+        adjacent->AddInterference(this);
+      }
+      AddInterference(adjacent);
+    }
+    other->alias_ = this;
+    coalesced_nodes_.push_back(other);
+    coalesced_nodes_.insert(coalesced_nodes_.end(),
+                            other->coalesced_nodes_.begin(),
+                            other->coalesced_nodes_.end());
+    requires_register_ = requires_register_ || other->requires_register_;
+    spill_weight_ += other->spill_weight_;
+  }
+
+  const ArenaVector<InterferenceNode*>& GetCoalescedNodes() const {
+    return coalesced_nodes_;
+  }
+
+  // Record that the value of this node is moved from or to `interval`. Giving both the
+  // same register removes the move.
+  void AddAffinity(LiveInterval* interval) {
+    affinities_.push_back(interval);
+  }
+
+  const ArenaVector<LiveInterval*>& GetAffinities() const {
+    return affinities_;
+  }
+
  private:
   // We give extra weight to edges adjacent to pair nodes. See the general comment on the
   // interference graph above.
@@ -126,9 +248,17 @@ class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
   // interference nodes in sets.
   const size_t id_;
 
-  // TODO: We could cache the result of interval_->RequiresRegister(), since it
-  //       will not change for the lifetime of this node. (Currently, RequiresRegister() requires
-  //       iterating through all uses of a live interval.)
+  // The node this one was coalesced into, or `this`.
+  InterferenceNode* alias_;
+
+  // The nodes coalesced into this one, directly or not.
+  ArenaVector<InterferenceNode*> coalesced_nodes_;
+
+  // The intervals this node's interval is moved from or to.
+  ArenaVector<LiveInterval*> affinities_;
+
+  bool requires_register_;
+  float spill_weight_;
 
   DISALLOW_COPY_AND_ASSIGN(InterferenceNode);
 };
@@ -163,6 +293,7 @@ RegisterAllocatorGraphColor::RegisterAllocatorGraphColor(ArenaAllocator* allocat
         number_of_globally_blocked_fp_regs_(0),
         max_safepoint_live_core_regs_(0),
         max_safepoint_live_fp_regs_(0),
+        coalesce_moves_(true),
         coloring_attempt_allocator_(nullptr) {
   // Before we ask for blocked registers, set them up in the code generator.
   codegen->SetupBlockedRegisters();
@@ -205,6 +336,7 @@ void RegisterAllocatorGraphColor::AllocateRegisters() {
         : codegen_->GetNumberOfFloatingPointRegisters();
 
     size_t attempt = 0;
+    coalesce_moves_ = true;
     while (true) {
       ++attempt;
       DCHECK(attempt <= kMaxGraphColoringAttemptsDebug)
@@ -224,12 +356,16 @@ void RegisterAllocatorGraphColor::AllocateRegisters() {
           coloring_attempt_allocator_->Adapter(kArenaAllocRegisterAllocator));
       BuildInterferenceGraph(intervals, &prunable_nodes, &safepoints);
 
-      // (3) Prune all uncolored nodes from interference graph.
+      // (3) Record the moves between intervals, and coalesce the nodes they connect when
+      //     it cannot make the graph harder to color.
+      CoalesceMoves(prunable_nodes, num_registers);
+
+      // (4) Prune all uncolored nodes from interference graph.
       ArenaStdStack<InterferenceNode*> pruned_nodes(
           coloring_attempt_allocator_->Adapter(kArenaAllocRegisterAllocator));
       PruneInterferenceGraph(prunable_nodes, num_registers, &pruned_nodes);
 
-      // (4) Color pruned nodes based on interferences.
+      // (5) Color pruned nodes based on interferences.
       bool successful = ColorInterferenceGraph(&pruned_nodes, num_registers);
 
       if (successful) {
@@ -275,7 +411,7 @@ void RegisterAllocatorGraphColor::AllocateRegisters() {
     }  // while unsuccessful
   }  // for processing_core_instructions
 
-  // (5) Resolve locations and deconstruct SSA form.
+  // (6) Resolve locations and deconstruct SSA form.
   RegisterAllocationResolver(allocator_, codegen_, liveness_)
       .Resolve(max_safepoint_live_core_regs_,
                max_safepoint_live_fp_regs_,
@@ -762,30 +898,34 @@ void RegisterAllocatorGraphColor::BuildInterferenceGraph(
 
 // The order in which we color nodes is vital to both correctness (forward
 // progress) and code quality. Specifically, we must prioritize intervals
-// that require registers, and after that we must prioritize short intervals.
+// that require registers, and after that we must prioritize intervals that are
+// expensive to spill, which includes the short intervals that cannot be split.
 // That way, if we fail to color a node, it either won't require a register,
 // or it will be a long interval that can be split in order to make the
 // interference graph sparser.
 // TODO: May also want to consider:
-// - Loop depth
 // - Constants (since they can be rematerialized)
 // - Allocated spill slots
 static bool GreaterNodePriority(const InterferenceNode* lhs,
                                 const InterferenceNode* rhs) {
-  LiveInterval* lhs_interval = lhs->GetInterval();
-  LiveInterval* rhs_interval = rhs->GetInterval();
-
   // (1) Choose the interval that requires a register.
-  if (lhs_interval->RequiresRegister() != rhs_interval->RequiresRegister()) {
-    return lhs_interval->RequiresRegister();
+  if (lhs->RequiresRegister() != rhs->RequiresRegister()) {
+    return lhs->RequiresRegister();
+  }
+
+  // (2) Choose the interval that is more expensive to spill.
+  if (lhs->GetSpillWeight() != rhs->GetSpillWeight()) {
+    return lhs->GetSpillWeight() > rhs->GetSpillWeight();
   }
 
-  // (2) Choose the interval that has a shorter life span.
+  // (3) Choose the interval that has a shorter life span.
+  LiveInterval* lhs_interval = lhs->GetInterval();
+  LiveInterval* rhs_interval = rhs->GetInterval();
   if (lhs_interval->GetLength() != rhs_interval->GetLength()) {
     return lhs_interval->GetLength() < rhs_interval->GetLength();
   }
 
-  // (3) Just choose the interval based on a deterministic ordering.
+  // (4) Just choose the interval based on a deterministic ordering.
   return InterferenceNode::CmpPtr(lhs, rhs);
 }
 
@@ -812,6 +952,10 @@ void RegisterAllocatorGraphColor::PruneInterferenceGraph(
         << "Fixed nodes should never be pruned";
     DCHECK(!node->GetInterval()->IsSlowPathSafepoint())
         << "Safepoint nodes should never be pruned";
+    if (node->IsCoalesced()) {
+      // Represented by the node it was coalesced into.
+      continue;
+    }
     if (node->GetOutDegree() < num_regs) {
       low_degree_worklist.push_back(node);
     } else {
@@ -888,6 +1032,31 @@ static std::bitset<kMaxNumRegs> BuildConflictMask(Container& intervals) {
   return conflict_mask;
 }
 
+// Return a free register of an interval that the value of `node`, or of a node coalesced
+// with it, is moved from or to. Coloring `node` with it removes the move.
+static int FindAffinityRegister(InterferenceNode* node,
+                                const std::bitset<kMaxNumRegs>& conflict_mask,
+                                size_t num_regs) {
+  auto find_in = [&conflict_mask, num_regs](InterferenceNode* current) {
+    for (LiveInterval* affinity : current->GetAffinities()) {
+      if (affinity->HasRegister() && !affinity->HasHighInterval()) {
+        int reg = affinity->GetRegister();
+        if (static_cast<size_t>(reg) < num_regs && !conflict_mask[reg]) {
+          return reg;
+        }
+      }
+    }
+    return kNoRegister;
+  };
+  int reg = find_in(node);
+  for (auto it = node->GetCoalescedNodes().begin(), end = node->GetCoalescedNodes().end();
+       reg == kNoRegister && it != end;
+       ++it) {
+    reg = find_in(*it);
+  }
+  return reg;
+}
+
 bool RegisterAllocatorGraphColor::ColorInterferenceGraph(
       ArenaStdStack<InterferenceNode*>* pruned_nodes,
       size_t num_regs) {
@@ -911,13 +1080,18 @@ bool RegisterAllocatorGraphColor::ColorInterferenceGraph(
         reg += 2;
       }
     } else {
-      // We use CTZ (count trailing zeros) to quickly find the lowest available register.
-      // Note that CTZ is undefined for 0, so we special-case it.
-      reg = conflict_mask.all() ? conflict_mask.size() : CTZ(~conflict_mask.to_ulong());
+      int affinity_reg = FindAffinityRegister(node, conflict_mask, num_regs);
+      if (affinity_reg != kNoRegister) {
+        reg = affinity_reg;
+      } else {
+        // We use CTZ (count trailing zeros) to quickly find the lowest available register.
+        // Note that CTZ is undefined for 0, so we special-case it.
+        reg = conflict_mask.all() ? conflict_mask.size() : CTZ(~conflict_mask.to_ulong());
+      }
     }
 
     if (reg < (interval->HasHighInterval() ? num_regs - 1 : num_regs)) {
-      // Assign register.
+      // Assign register, to the intervals of the coalesced nodes too.
       DCHECK(!interval->HasRegister());
       interval->SetRegister(reg);
       colored_intervals.push_back(interval);
@@ -926,16 +1100,38 @@ bool RegisterAllocatorGraphColor::ColorInterferenceGraph(
         interval->GetHighInterval()->SetRegister(reg + 1);
         colored_intervals.push_back(interval->GetHighInterval());
       }
-    } else if (interval->RequiresRegister()) {
+      for (InterferenceNode* coalesced : node->GetCoalescedNodes()) {
+        LiveInterval* coalesced_interval = coalesced->GetInterval();
+        DCHECK(!coalesced_interval->HasRegister());
+        DCHECK(!coalesced_interval->HasHighInterval());
+        coalesced_interval->SetRegister(reg);
+        colored_intervals.push_back(coalesced_interval);
+      }
+    } else if (node->RequiresRegister()) {
       // The interference graph is too dense to color. Make it sparser by
       // splitting this live interval.
       successful = false;
-      SplitAtRegisterUses(interval);
+      if (interval->RequiresRegister()) {
+        SplitAtRegisterUses(interval);
+      }
+      if (!node->GetCoalescedNodes().empty()) {
+        for (InterferenceNode* coalesced : node->GetCoalescedNodes()) {
+          if (coalesced->GetInterval()->RequiresRegister()) {
+            SplitAtRegisterUses(coalesced->GetInterval());
+          }
+        }
+        // Coalescing made this node too hard to color. Stop coalescing, so that the next
+        // attempts make progress like without it.
+        coalesce_moves_ = false;
+      }
       // We continue coloring, because there may be additional intervals that cannot
       // be colored, and that we should split.
     } else {
       // Spill.
       AllocateSpillSlotFor(interval);
+      for (InterferenceNode* coalesced : node->GetCoalescedNodes()) {
+        AllocateSpillSlotFor(coalesced->GetInterval());
+      }
     }
   }
 
@@ -949,6 +1145,120 @@ bool RegisterAllocatorGraphColor::ColorInterferenceGraph(
   return successful;
 }
 
+// Coalesce `lhs` and `rhs`, or the nodes they were coalesced into, if they do not interfere
+// and if the coalesced node is sure to be colorable when they were (Briggs' criterion: it has
+// fewer than `num_regs` neighbors of significant degree).
+static void TryCoalesce(InterferenceNode* lhs, InterferenceNode* rhs, size_t num_regs) {
+  lhs = lhs->GetAlias();
+  rhs = rhs->GetAlias();
+  if (lhs == rhs ||
+      lhs->GetInterval()->HasHighInterval() ||
+      rhs->GetInterval()->HasHighInterval() ||
+      lhs->ContainsInterference(rhs)) {
+    return;
+  }
+  // Pre-colored neighbors always take a color.
+  auto significant_degree = [num_regs](InterferenceNode* adjacent) {
+    LiveInterval* interval = adjacent->GetInterval();
+    if (!interval->HasRegister() && adjacent->GetOutDegree() < num_regs) {
+      return 0u;
+    }
+    return interval->HasHighInterval() ? 2u : 1u;
+  };
+  size_t num_significant = 0;
+  for (InterferenceNode* adjacent : lhs->GetAdjacentNodes()) {
+    num_significant += significant_degree(adjacent);
+  }
+  for (InterferenceNode* adjacent : rhs->GetAdjacentNodes()) {
+    if (!lhs->ContainsInterference(adjacent)) {
+      num_significant += significant_degree(adjacent);
+    }
+  }
+  if (num_significant < num_regs) {
+    lhs->Coalesce(rhs);
+  }
+}
+
+void RegisterAllocatorGraphColor::CoalesceMoves(
+    const ArenaVector<InterferenceNode*>& prunable_nodes,
+    size_t num_regs) {
+  ArenaSafeMap<LiveInterval*, InterferenceNode*> interval_node_map(
+      std::less<LiveInterval*>(),
+      coloring_attempt_allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (InterferenceNode* node : prunable_nodes) {
+    interval_node_map.Put(node->GetInterval(), node);
+  }
+
+  // Record the move between `interval` and `other`, and try coalescing their nodes if both
+  // are to be colored.
+  auto add_move = [this, num_regs, &interval_node_map](LiveInterval* interval,
+                                                       LiveInterval* other,
+                                                       bool can_coalesce) {
+    auto it = interval_node_map.find(interval);
+    auto other_it = interval_node_map.find(other);
+    if (it != interval_node_map.end()) {
+      it->second->AddAffinity(other);
+    }
+    if (other_it != interval_node_map.end()) {
+      other_it->second->AddAffinity(interval);
+    }
+    if (can_coalesce &&
+        coalesce_moves_ &&
+        it != interval_node_map.end() &&
+        other_it != interval_node_map.end()) {
+      TryCoalesce(it->second, other_it->second, num_regs);
+    }
+  };
+
+  for (InterferenceNode* node : prunable_nodes) {
+    LiveInterval* interval = node->GetInterval();
+    if (interval->IsTemp()) {
+      continue;
+    }
+
+    if (interval->IsSplit()) {
+      // The resolver moves the value from the previous sibling. Siblings are not
+      // coalesced, which would undo the splits made for coloring.
+      LiveInterval* previous = interval->GetParent();
+      while (previous->GetNextSibling() != interval) {
+        previous = previous->GetNextSibling();
+      }
+      add_move(interval, previous, /* can_coalesce */ false);
+      continue;
+    }
+
+    HInstruction* defined_by = interval->GetDefinedBy();
+    if (defined_by->IsPhi()) {
+      if (defined_by->AsPhi()->IsCatchPhi()) {
+        // Catch phis live on the stack.
+        continue;
+      }
+      // The inputs are moved to the phi at the end of the predecessors.
+      const ArenaVector<HBasicBlock*>& predecessors = defined_by->GetBlock()->GetPredecessors();
+      HInputsRef inputs = defined_by->GetInputs();
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        size_t end = predecessors[i]->GetLifetimeEnd();
+        LiveInterval* input_interval = inputs[i]->GetLiveInterval()->GetSiblingAt(end - 1);
+        if (input_interval != nullptr) {
+          add_move(interval, input_interval, /* can_coalesce */ true);
+        }
+      }
+    } else {
+      Location out = defined_by->GetLocations()->Out();
+      if (out.IsUnallocated() && out.GetPolicy() == Location::kSameAsFirstInput) {
+        // The first input is moved to the output before the instruction.
+        LiveInterval* input_parent = defined_by->InputAt(0)->GetLiveInterval();
+        LiveInterval* input_interval = (input_parent == nullptr)
+            ? nullptr
+            : input_parent->GetSiblingAt(interval->GetStart() - 1);
+        if (input_interval != nullptr && input_interval->GetEnd() == interval->GetStart()) {
+          add_move(interval, input_interval, /* can_coalesce */ true);
+        }
+      }
+    }
+  }
+}
+
 size_t RegisterAllocatorGraphColor::ComputeMaxSafepointLiveRegisters(
     const ArenaVector<InterferenceNode*>& safepoints) {
   size_t max_safepoint_live_regs = 0;
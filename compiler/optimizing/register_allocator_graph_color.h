@@ -47,9 +47,13 @@ class InterferenceNode;
  *     different color.) As we prune nodes from the graph, more nodes may drop below degree k,
  *     enabling further pruning. The key is to maintain the pruning order in a stack, so that we
  *     can color the nodes in the reverse order.
+ *     Before pruning, nodes connected by a move (a phi and its inputs, an output and the
+ *     input it reuses) are coalesced when they do not interfere and the coalesced node is
+ *     as easy to color as they were. They then get the same color, which removes the move.
  *     When there are no more nodes with degree less than k, we start pruning alternate nodes based
  *     on heuristics. Since these nodes are not guaranteed a color, we are careful to
- *     prioritize nodes that require a register. We also prioritize short intervals, because
+ *     prioritize nodes that require a register. We then prioritize nodes with a high spill
+ *     weight: nodes with many register uses, in deep loops, and short intervals, because
  *     short intervals cannot be split very much if coloring fails (see below). "Prioritizing"
  *     a node amounts to pruning it later, since it will have fewer interferences if we prune other
  *     nodes first.
@@ -59,6 +63,7 @@ class InterferenceNode;
  *       However, we split the node's live interval in order to make the interference graph
  *       sparser, so that future coloring attempts may succeed.
  *     - If the node does not require a register, we simply assign it a location on the stack.
+ *     Among the free colors, we prefer the one of an interval the node is moved from or to.
  *
  * A good reference for graph coloring register allocation is
  * "Modern Compiler Implementation in Java" (Andrew W. Appel, 2nd Edition).
@@ -124,6 +129,12 @@ class RegisterAllocatorGraphColor : public RegisterAllocator {
                               ArenaVector<InterferenceNode*>* prunable_nodes,
                               ArenaVector<InterferenceNode*>* safepoints);
 
+  // Record the moves between the intervals of `prunable_nodes` (phi inputs, outputs
+  // reusing their first input, and split siblings), to color their nodes alike if possible.
+  // While `coalesce_moves_` is set, also coalesce the node pairs which can conservatively
+  // share a color.
+  void CoalesceMoves(const ArenaVector<InterferenceNode*>& prunable_nodes, size_t num_registers);
+
   // Prune nodes from the interference graph to be colored later. Build
   // a stack (pruned_nodes) containing these intervals in an order determined
   // by various heuristics.
@@ -184,6 +195,10 @@ class RegisterAllocatorGraphColor : public RegisterAllocator {
   size_t max_safepoint_live_core_regs_;
   size_t max_safepoint_live_fp_regs_;
 
+  // Whether the coloring attempts coalesce nodes. Cleared once a coalesced node could
+  // not be colored, to keep the forward progress of the attempts.
+  bool coalesce_moves_;
+
   // An arena allocator used for a single graph coloring attempt.
   // Many data structures are cleared between graph coloring attempts, so we reduce
   // total memory usage by using a new arena allocator for each attempt.
@@ -649,6 +649,30 @@ TEST_F(RegisterAllocatorTest, PhiHint_LinearScan) {
   PhiHint(Strategy::kRegisterAllocatorLinearScan);
 }
 
+// The phi and its inputs do not interfere, coalescing gives them the same register
+// and removes the moves at the end of the branches.
+TEST_F(RegisterAllocatorTest, PhiCoalescing_GraphColor) {
+  ArenaPool pool;
+  ArenaAllocator allocator(&pool);
+  HPhi *phi;
+  HInstruction *input1, *input2;
+
+  HGraph* graph = BuildIfElseWithPhi(&allocator, &phi, &input1, &input2);
+  std::unique_ptr<const X86InstructionSetFeatures> features_x86(
+      X86InstructionSetFeatures::FromCppDefines());
+  x86::CodeGeneratorX86 codegen(graph, *features_x86.get(), CompilerOptions());
+  SsaLivenessAnalysis liveness(graph, &codegen);
+  liveness.Analyze();
+
+  RegisterAllocator* register_allocator = RegisterAllocator::Create(
+      &allocator, &codegen, liveness, Strategy::kRegisterAllocatorGraphColor);
+  register_allocator->AllocateRegisters();
+
+  ASSERT_TRUE(phi->GetLiveInterval()->HasRegister());
+  ASSERT_EQ(input1->GetLiveInterval()->GetRegister(), phi->GetLiveInterval()->GetRegister());
+  ASSERT_EQ(input2->GetLiveInterval()->GetRegister(), phi->GetLiveInterval()->GetRegister());
+}
+
 static HGraph* BuildFieldReturn(ArenaAllocator* allocator,
                                 HInstruction** field,
                                 HInstruction** ret) {
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler.h"
+
+#include "arch/instruction_set_features.h"
+
+#ifdef ART_ENABLE_CODEGEN_arm64
+#include "scheduler_arm64.h"
+#endif
+
+namespace art {
+
+// Whether the values of `instruction` include one that must not be live across a GC
+// point, like the interior pointer of an HIntermediateAddress.
+static bool UsesGCDependentValue(const HInstruction* instruction) {
+  for (const HInstruction* input : instruction->GetInputs()) {
+    if (input->GetSideEffects().Includes(SideEffects::DependsOnGC())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether `later` must stay after `earlier`, besides using its value.
+static bool HasReorderingDependency(const HInstruction* earlier, const HInstruction* later) {
+  SideEffects earlier_effects = earlier->GetSideEffects();
+  SideEffects later_effects = later->GetSideEffects();
+  // Read after write, write after read, and GC dependencies.
+  if (later_effects.MayDependOn(earlier_effects) || earlier_effects.MayDependOn(later_effects)) {
+    return true;
+  }
+  // Write after write. Stores are cheap to keep in order, the kinds of locations they
+  // write are not compared.
+  if (earlier_effects.DoesAnyWrite() && later_effects.DoesAnyWrite()) {
+    return true;
+  }
+  // Exceptions are thrown in order, and see the heap stores done before them only.
+  if (earlier->CanThrow() && (later->CanThrow() || later_effects.DoesAnyWrite())) {
+    return true;
+  }
+  if (later->CanThrow() && earlier_effects.DoesAnyWrite()) {
+    return true;
+  }
+  // A GC point cannot move before the use of a value depending on the GC.
+  if (later_effects.Includes(SideEffects::CanTriggerGC()) && UsesGCDependentValue(earlier)) {
+    return true;
+  }
+  return false;
+}
+
+void SchedulingGraph::AddDataDependency(HInstruction* input, SchedulingNode* node) {
+  SchedulingNode* input_node = GetNode(input);
+  if (input_node != nullptr && input_node != node && !input_node->HasDataSuccessor(node)) {
+    input_node->AddDataSuccessor(node);
+  }
+}
+
+void SchedulingGraph::AddDependencies(SchedulingNode* node) {
+  HInstruction* instructions[] = { node->GetGluedInstruction(), node->GetInstruction() };
+  for (HInstruction* instruction : instructions) {
+    if (instruction == nullptr) {
+      continue;
+    }
+    for (HInstruction* input : instruction->GetInputs()) {
+      AddDataDependency(input, node);
+    }
+    // Values held by the environment must be computed before it, but their latency
+    // does not matter.
+    for (HEnvironment* environment = instruction->GetEnvironment();
+         environment != nullptr;
+         environment = environment->GetParent()) {
+      for (size_t i = 0, e = environment->Size(); i < e; ++i) {
+        SchedulingNode* value_node = GetNode(environment->GetInstructionAt(i));
+        if (value_node != nullptr &&
+            value_node != node &&
+            !value_node->HasDataSuccessor(node) &&
+            !value_node->HasOtherSuccessor(node)) {
+          value_node->AddOtherSuccessor(node);
+        }
+      }
+    }
+  }
+
+  for (SchedulingNode* other : nodes_) {
+    if (other->HasDataSuccessor(node) || other->HasOtherSuccessor(node)) {
+      continue;
+    }
+    HInstruction* other_instructions[] = { other->GetGluedInstruction(), other->GetInstruction() };
+    bool has_dependency = false;
+    for (HInstruction* earlier : other_instructions) {
+      for (HInstruction* later : instructions) {
+        if (earlier != nullptr && later != nullptr && HasReorderingDependency(earlier, later)) {
+          has_dependency = true;
+        }
+      }
+    }
+    if (has_dependency) {
+      other->AddOtherSuccessor(node);
+    }
+  }
+}
+
+SchedulingNode* SchedulingGraph::AddNode(HInstruction* instruction,
+                                         HInstruction* glued_instruction) {
+  SchedulingNode* node =
+      new (arena_) SchedulingNode(instruction, glued_instruction, nodes_.size(), arena_);
+  nodes_map_.Put(instruction, node);
+  if (glued_instruction != nullptr) {
+    nodes_map_.Put(glued_instruction, node);
+  }
+  AddDependencies(node);
+  nodes_.push_back(node);
+  return node;
+}
+
+bool SchedulingGraph::HasImmediateDataDependency(const HInstruction* earlier,
+                                                 const HInstruction* later) const {
+  SchedulingNode* earlier_node = GetNode(earlier);
+  SchedulingNode* later_node = GetNode(later);
+  return earlier_node != nullptr &&
+      later_node != nullptr &&
+      earlier_node->HasDataSuccessor(later_node);
+}
+
+bool SchedulingGraph::HasImmediateOtherDependency(const HInstruction* earlier,
+                                                  const HInstruction* later) const {
+  SchedulingNode* earlier_node = GetNode(earlier);
+  SchedulingNode* later_node = GetNode(later);
+  return earlier_node != nullptr &&
+      later_node != nullptr &&
+      earlier_node->HasOtherSuccessor(later_node);
+}
+
+// Whether the code generator needs `instruction` right before the next instruction.
+static bool IsGluedToNext(HInstruction* instruction) {
+  HInstruction* next = instruction->GetNext();
+  if (next == nullptr) {
+    return false;
+  }
+  // A condition is generated as part of its only user.
+  if (instruction->IsCondition()) {
+    return (next->IsIf() || next->IsDeoptimize() || next->IsSelect()) &&
+        instruction->HasOnlyOneNonEnvironmentUse() &&
+        !instruction->HasEnvironmentUses() &&
+        instruction->GetUses().front().GetUser() == next;
+  }
+  // A null check is implicit when the access it guards follows it.
+  if (instruction->IsNullCheck()) {
+    return next->CanDoImplicitNullCheckOn(instruction->InputAt(0));
+  }
+  return false;
+}
+
+bool HScheduler::IsSchedulable(const HBasicBlock* block) const {
+  // The entry block only holds parameters and constants, and the order of the
+  // instructions of try and catch blocks is observable by their catch phis.
+  return !block->IsEntryBlock() && !block->IsTryBlock() && !block->IsCatchBlock();
+}
+
+bool HScheduler::IsSchedulingBarrier(const HInstruction* instruction) const {
+  return instruction->IsControlFlow() ||
+      instruction->IsSuspendCheck() ||
+      instruction->IsNativeDebugInfo() ||
+      instruction->IsDeoptimize() ||
+      instruction->IsMonitorOperation() ||
+      instruction->IsMemoryBarrier() ||
+      instruction->IsLoadException() ||
+      instruction->IsClearException();
+}
+
+void HScheduler::Schedule(HGraph* graph) {
+  for (HReversePostOrderIterator it(*graph); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    if (IsSchedulable(block)) {
+      ScheduleBlock(block);
+    }
+  }
+}
+
+void HScheduler::ScheduleBlock(HBasicBlock* block) {
+  // Split the block into regions before moving anything, so that the glued instructions
+  // are the ones of the original order.
+  ArenaVector<std::pair<HInstruction*, HInstruction*>> units(
+      arena_->Adapter(kArenaAllocScheduler));
+  for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (!IsGluedToNext(instruction)) {
+      HInstruction* previous = instruction->GetPrevious();
+      HInstruction* glued = (previous != nullptr && IsGluedToNext(previous)) ? previous : nullptr;
+      units.push_back(std::make_pair(instruction, glued));
+    }
+  }
+
+  DCHECK(region_.empty());
+  for (const std::pair<HInstruction*, HInstruction*>& unit : units) {
+    HInstruction* instruction = unit.first;
+    HInstruction* glued = unit.second;
+    if (IsSchedulingBarrier(instruction)) {
+      ScheduleRegion(glued != nullptr ? glued : instruction);
+    } else {
+      if (region_.size() == kMaxRegionSize) {
+        ScheduleRegion(glued != nullptr ? glued : instruction);
+      }
+      region_.push_back(unit);
+    }
+  }
+  // The block ends with a control flow instruction, which is a barrier.
+  DCHECK(region_.empty());
+}
+
+void HScheduler::ScheduleRegion(HInstruction* cursor) {
+  if (region_.size() < 2u) {
+    region_.clear();
+    return;
+  }
+
+  scheduling_graph_.Clear();
+  for (const std::pair<HInstruction*, HInstruction*>& unit : region_) {
+    SchedulingNode* node = scheduling_graph_.AddNode(unit.first, unit.second);
+    latency_visitor_->CalculateLatency(unit.first);
+    uint32_t internal_latency = latency_visitor_->GetLastVisitedInternalLatency();
+    node->SetLatency(latency_visitor_->GetLastVisitedLatency());
+    if (unit.second != nullptr) {
+      latency_visitor_->CalculateLatency(unit.second);
+      internal_latency += latency_visitor_->GetLastVisitedInternalLatency();
+    }
+    node->SetInternalLatency(internal_latency);
+  }
+  region_.clear();
+
+  // Dependencies go forward, so heights are computed backward.
+  const ArenaVector<SchedulingNode*>& nodes = scheduling_graph_.GetNodes();
+  for (auto it = nodes.rbegin(), end = nodes.rend(); it != end; ++it) {
+    SchedulingNode* node = *it;
+    uint32_t height = node->GetLatency();
+    for (SchedulingNode* successor : node->GetDataSuccessors()) {
+      height = std::max(height, node->GetLatency() + successor->GetHeight());
+    }
+    for (SchedulingNode* successor : node->GetOtherSuccessors()) {
+      height = std::max(height, successor->GetHeight());
+    }
+    node->SetHeight(height);
+  }
+
+  ArenaVector<SchedulingNode*> ready_nodes(arena_->Adapter(kArenaAllocScheduler));
+  for (SchedulingNode* node : nodes) {
+    if (node->GetNumberOfUnscheduledPredecessors() == 0u) {
+      ready_nodes.push_back(node);
+    }
+  }
+
+  uint32_t cycle = 0u;
+  while (!ready_nodes.empty()) {
+    // Pick a node that can issue now, on the longest path to the end of the region. When
+    // all nodes would stall, pick the one stalling the least.
+    auto is_better = [cycle](const SchedulingNode* a, const SchedulingNode* b) {
+      uint32_t a_cycle = std::max(cycle, a->GetEarliestCycle());
+      uint32_t b_cycle = std::max(cycle, b->GetEarliestCycle());
+      if (a_cycle != b_cycle) {
+        return a_cycle < b_cycle;
+      }
+      if (a->GetHeight() != b->GetHeight()) {
+        return a->GetHeight() > b->GetHeight();
+      }
+      // Keep the original order otherwise.
+      return a->GetIndex() < b->GetIndex();
+    };
+    auto selected_it = std::min_element(ready_nodes.begin(), ready_nodes.end(), is_better);
+    SchedulingNode* selected = *selected_it;
+    ready_nodes.erase(selected_it);
+
+    uint32_t issue_cycle = std::max(cycle, selected->GetEarliestCycle());
+    cycle = issue_cycle + std::max(1u, selected->GetInternalLatency());
+    if (selected->GetGluedInstruction() != nullptr) {
+      selected->GetGluedInstruction()->MoveBefore(cursor, /* ensure_safety */ false);
+    }
+    selected->GetInstruction()->MoveBefore(cursor, /* ensure_safety */ false);
+
+    for (SchedulingNode* successor : selected->GetDataSuccessors()) {
+      successor->UpdateEarliestCycle(issue_cycle + selected->GetLatency());
+      successor->DecrementNumberOfUnscheduledPredecessors();
+      if (successor->GetNumberOfUnscheduledPredecessors() == 0u) {
+        ready_nodes.push_back(successor);
+      }
+    }
+    for (SchedulingNode* successor : selected->GetOtherSuccessors()) {
+      successor->UpdateEarliestCycle(issue_cycle);
+      successor->DecrementNumberOfUnscheduledPredecessors();
+      if (successor->GetNumberOfUnscheduledPredecessors() == 0u) {
+        ready_nodes.push_back(successor);
+      }
+    }
+  }
+}
+
+void HInstructionScheduling::Run() {
+  // Local allocator, for the data structures of the scheduler only.
+  ArenaAllocator arena(graph_->GetArena()->GetArenaPool());
+  switch (instruction_set_) {
+#ifdef ART_ENABLE_CODEGEN_arm64
+    case kArm64: {
+      arm64::SchedulingLatencyVisitorARM64 latency_visitor(
+          *isa_features_.AsArm64InstructionSetFeatures());
+      HScheduler scheduler(&arena, &latency_visitor);
+      scheduler.Schedule(graph_);
+      break;
+    }
+#endif
+    default:
+      break;
+  }
+}
+
+}  // namespace art
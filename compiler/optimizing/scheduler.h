@@ -0,0 +1,273 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_H_
+#define ART_COMPILER_OPTIMIZING_SCHEDULER_H_
+
+#include <algorithm>
+
+#include "arch/instruction_set.h"
+#include "base/arena_containers.h"
+#include "base/arena_object.h"
+#include "base/stl_util.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class InstructionSetFeatures;
+
+/**
+ * Computes the latencies of instructions for a given target. The base class gives every
+ * instruction the default latency; sub-classes override the visits of the instructions
+ * they model.
+ */
+class SchedulingLatencyVisitor : public HGraphDelegateVisitor {
+ public:
+  // This visitor only computes latencies, it is not used to visit graphs.
+  SchedulingLatencyVisitor()
+      : HGraphDelegateVisitor(nullptr),
+        last_visited_latency_(kDefaultLatency),
+        last_visited_internal_latency_(kDefaultLatency) {}
+
+  void VisitInstruction(HInstruction* instruction ATTRIBUTE_UNUSED) OVERRIDE {
+    last_visited_latency_ = kDefaultLatency;
+    last_visited_internal_latency_ = kDefaultLatency;
+  }
+
+  void CalculateLatency(HInstruction* instruction) {
+    last_visited_latency_ = kDefaultLatency;
+    last_visited_internal_latency_ = kDefaultLatency;
+    instruction->Accept(this);
+  }
+
+  // Number of cycles before the result of the last visited instruction can be used.
+  uint32_t GetLastVisitedLatency() const { return last_visited_latency_; }
+
+  // Number of cycles the last visited instruction keeps the pipeline busy before the
+  // next instruction can issue.
+  uint32_t GetLastVisitedInternalLatency() const { return last_visited_internal_latency_; }
+
+ protected:
+  static constexpr uint32_t kDefaultLatency = 1;
+
+  uint32_t last_visited_latency_;
+  uint32_t last_visited_internal_latency_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SchedulingLatencyVisitor);
+};
+
+/**
+ * A node of the dependency graph of a scheduling region. A node is an instruction, and
+ * possibly the instruction glued before it, which the code generator needs to see right
+ * before its user (for example a condition before its HIf, or a null check made implicit
+ * by the access it guards). Both are scheduled as one.
+ */
+class SchedulingNode : public ArenaObject<kArenaAllocScheduler> {
+ public:
+  SchedulingNode(HInstruction* instruction,
+                 HInstruction* glued_instruction,
+                 size_t index,
+                 ArenaAllocator* arena)
+      : instruction_(instruction),
+        glued_instruction_(glued_instruction),
+        index_(index),
+        latency_(0u),
+        internal_latency_(0u),
+        height_(0u),
+        earliest_cycle_(0u),
+        num_unscheduled_predecessors_(0u),
+        data_successors_(arena->Adapter(kArenaAllocScheduler)),
+        other_successors_(arena->Adapter(kArenaAllocScheduler)) {}
+
+  HInstruction* GetInstruction() const { return instruction_; }
+  HInstruction* GetGluedInstruction() const { return glued_instruction_; }
+  size_t GetIndex() const { return index_; }
+
+  bool Contains(const HInstruction* instruction) const {
+    return instruction == instruction_ || instruction == glued_instruction_;
+  }
+
+  // `successor` uses the value of this node.
+  void AddDataSuccessor(SchedulingNode* successor) {
+    data_successors_.push_back(successor);
+    successor->num_unscheduled_predecessors_++;
+  }
+
+  // `successor` must stay after this node, for another reason than using its value.
+  void AddOtherSuccessor(SchedulingNode* successor) {
+    other_successors_.push_back(successor);
+    successor->num_unscheduled_predecessors_++;
+  }
+
+  bool HasDataSuccessor(const SchedulingNode* node) const {
+    return ContainsElement(data_successors_, node);
+  }
+
+  bool HasOtherSuccessor(const SchedulingNode* node) const {
+    return ContainsElement(other_successors_, node);
+  }
+
+  const ArenaVector<SchedulingNode*>& GetDataSuccessors() const { return data_successors_; }
+  const ArenaVector<SchedulingNode*>& GetOtherSuccessors() const { return other_successors_; }
+
+  uint32_t GetLatency() const { return latency_; }
+  void SetLatency(uint32_t latency) { latency_ = latency; }
+  uint32_t GetInternalLatency() const { return internal_latency_; }
+  void SetInternalLatency(uint32_t latency) { internal_latency_ = latency; }
+
+  // Latency of the longest dependency chain starting at this node.
+  uint32_t GetHeight() const { return height_; }
+  void SetHeight(uint32_t height) { height_ = height; }
+
+  // First cycle this node can issue at without stalling on its predecessors.
+  uint32_t GetEarliestCycle() const { return earliest_cycle_; }
+  void UpdateEarliestCycle(uint32_t cycle) { earliest_cycle_ = std::max(earliest_cycle_, cycle); }
+
+  size_t GetNumberOfUnscheduledPredecessors() const { return num_unscheduled_predecessors_; }
+  void DecrementNumberOfUnscheduledPredecessors() {
+    DCHECK_NE(num_unscheduled_predecessors_, 0u);
+    num_unscheduled_predecessors_--;
+  }
+
+ private:
+  HInstruction* const instruction_;
+  HInstruction* const glued_instruction_;
+  // Position of the node in the region, before scheduling.
+  const size_t index_;
+
+  uint32_t latency_;
+  uint32_t internal_latency_;
+  uint32_t height_;
+  uint32_t earliest_cycle_;
+  size_t num_unscheduled_predecessors_;
+
+  ArenaVector<SchedulingNode*> data_successors_;
+  ArenaVector<SchedulingNode*> other_successors_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingNode);
+};
+
+/**
+ * The dependency graph of a scheduling region, a sequence of instructions of a block that
+ * can be reordered. Nodes are added in program order.
+ */
+class SchedulingGraph : public ValueObject {
+ public:
+  explicit SchedulingGraph(ArenaAllocator* arena)
+      : arena_(arena),
+        nodes_(arena->Adapter(kArenaAllocScheduler)),
+        nodes_map_(std::less<const HInstruction*>(), arena->Adapter(kArenaAllocScheduler)) {}
+
+  // Adds a node for `instruction` and `glued_instruction`, with its dependencies on the
+  // nodes already in the graph.
+  SchedulingNode* AddNode(HInstruction* instruction, HInstruction* glued_instruction = nullptr);
+
+  SchedulingNode* GetNode(const HInstruction* instruction) const {
+    auto it = nodes_map_.find(instruction);
+    return (it == nodes_map_.end()) ? nullptr : it->second;
+  }
+
+  const ArenaVector<SchedulingNode*>& GetNodes() const { return nodes_; }
+
+  // Whether `later` depends on `earlier`, directly.
+  bool HasImmediateDataDependency(const HInstruction* earlier, const HInstruction* later) const;
+  bool HasImmediateOtherDependency(const HInstruction* earlier, const HInstruction* later) const;
+
+  void Clear() {
+    nodes_.clear();
+    nodes_map_.clear();
+  }
+
+ private:
+  void AddDependencies(SchedulingNode* node);
+  void AddDataDependency(HInstruction* input, SchedulingNode* node);
+
+  ArenaAllocator* const arena_;
+  ArenaVector<SchedulingNode*> nodes_;
+  ArenaSafeMap<const HInstruction*, SchedulingNode*> nodes_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingGraph);
+};
+
+/**
+ * List scheduler working on the blocks of a graph. Each block is split into regions by
+ * the instructions that cannot be reordered (control flow, suspend checks, ...), and the
+ * instructions of a region are scheduled in cycle order: the next instruction is one whose
+ * operands are available, on the longest latency path to the end of the region. The
+ * latencies come from the target's SchedulingLatencyVisitor.
+ */
+class HScheduler {
+ public:
+  HScheduler(ArenaAllocator* arena, SchedulingLatencyVisitor* latency_visitor)
+      : arena_(arena),
+        latency_visitor_(latency_visitor),
+        scheduling_graph_(arena),
+        region_(arena->Adapter(kArenaAllocScheduler)) {}
+  virtual ~HScheduler() {}
+
+  void Schedule(HGraph* graph);
+
+ protected:
+  virtual bool IsSchedulable(const HBasicBlock* block) const;
+  virtual bool IsSchedulingBarrier(const HInstruction* instruction) const;
+
+ private:
+  // Regions are split beyond this size, to bound the cost of building their dependencies.
+  static constexpr size_t kMaxRegionSize = 128;
+
+  void ScheduleBlock(HBasicBlock* block);
+
+  // Schedules the region nodes, and moves their instructions before `cursor`.
+  void ScheduleRegion(HInstruction* cursor);
+
+  ArenaAllocator* const arena_;
+  SchedulingLatencyVisitor* const latency_visitor_;
+  SchedulingGraph scheduling_graph_;
+  ArenaVector<std::pair<HInstruction*, HInstruction*>> region_;
+
+  DISALLOW_COPY_AND_ASSIGN(HScheduler);
+};
+
+/**
+ * Instruction scheduling pass, run before register allocation on the targets with a
+ * latency model (currently ARM64). The model is picked from the instruction set features.
+ */
+class HInstructionScheduling : public HOptimization {
+ public:
+  HInstructionScheduling(HGraph* graph,
+                         InstructionSet instruction_set,
+                         const InstructionSetFeatures& isa_features,
+                         const char* name = kInstructionSchedulingPassName)
+      : HOptimization(graph, name),
+        instruction_set_(instruction_set),
+        isa_features_(isa_features) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kInstructionSchedulingPassName = "scheduler";
+
+ private:
+  const InstructionSet instruction_set_;
+  const InstructionSetFeatures& isa_features_;
+
+  DISALLOW_COPY_AND_ASSIGN(HInstructionScheduling);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SCHEDULER_H_
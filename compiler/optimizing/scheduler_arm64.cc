@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler_arm64.h"
+
+namespace art {
+namespace arm64 {
+
+// In-order cores, modelled on the Cortex-A53.
+static constexpr Arm64Latencies kInOrderLatencies = {
+  /* int_op */ 2,
+  /* int_mul */ 3,
+  /* int_div */ 12,
+  /* fp_op */ 4,
+  /* fp_mul */ 4,
+  /* fp_div */ 15,
+  /* type_conversion */ 4,
+  /* load */ 3,
+  /* call */ 20,
+};
+
+// Out-of-order cores, modelled on the Cortex-A57. The core reorders instructions itself,
+// the latencies only need to be roughly right.
+static constexpr Arm64Latencies kOutOfOrderLatencies = {
+  /* int_op */ 1,
+  /* int_mul */ 3,
+  /* int_div */ 12,
+  /* fp_op */ 3,
+  /* fp_mul */ 4,
+  /* fp_div */ 12,
+  /* type_conversion */ 5,
+  /* load */ 4,
+  /* call */ 20,
+};
+
+SchedulingLatencyVisitorARM64::SchedulingLatencyVisitorARM64(
+    const Arm64InstructionSetFeatures& isa_features)
+    : latencies_(isa_features.HasInOrderPipeline() ? kInOrderLatencies : kOutOfOrderLatencies) {}
+
+void SchedulingLatencyVisitorARM64::VisitBinaryOperation(HBinaryOperation* instruction) {
+  SetArithmeticLatency(instruction->GetResultType());
+}
+
+void SchedulingLatencyVisitorARM64::VisitUnaryOperation(HUnaryOperation* instruction) {
+  SetArithmeticLatency(instruction->GetResultType());
+}
+
+void SchedulingLatencyVisitorARM64::VisitMul(HMul* instruction) {
+  SetLatency(Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? latencies_.fp_mul
+      : latencies_.int_mul);
+}
+
+void SchedulingLatencyVisitorARM64::VisitDiv(HDiv* instruction) {
+  // The dividers are not pipelined.
+  SetLatency(Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? latencies_.fp_div
+      : latencies_.int_div);
+  last_visited_internal_latency_ = last_visited_latency_;
+}
+
+void SchedulingLatencyVisitorARM64::VisitRem(HRem* instruction) {
+  if (Primitive::IsFloatingPointType(instruction->GetResultType())) {
+    // Calls fmod or fmodf.
+    SetLatency(latencies_.call);
+  } else {
+    // A division followed by a multiply-subtract.
+    SetLatency(latencies_.int_div + latencies_.int_mul);
+  }
+  last_visited_internal_latency_ = last_visited_latency_;
+}
+
+void SchedulingLatencyVisitorARM64::VisitTypeConversion(HTypeConversion* instruction) {
+  Primitive::Type input_type = instruction->GetInputType();
+  Primitive::Type result_type = instruction->GetResultType();
+  if (Primitive::IsFloatingPointType(input_type) || Primitive::IsFloatingPointType(result_type)) {
+    SetLatency(latencies_.type_conversion);
+  } else {
+    SetLatency(latencies_.int_op);
+  }
+}
+
+void SchedulingLatencyVisitorARM64::VisitSelect(HSelect* instruction) {
+  SetArithmeticLatency(instruction->GetType());
+}
+
+void SchedulingLatencyVisitorARM64::VisitBoundsCheck(HBoundsCheck* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.int_op);
+}
+
+void SchedulingLatencyVisitorARM64::VisitArrayGet(HArrayGet* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitArrayLength(HArrayLength* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitInstanceFieldGet(
+    HInstanceFieldGet* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitStaticFieldGet(
+    HStaticFieldGet* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitLoadClass(HLoadClass* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitLoadString(HLoadString* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitInvoke(HInvoke* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.call);
+  last_visited_internal_latency_ = latencies_.call;
+}
+
+void SchedulingLatencyVisitorARM64::VisitNewInstance(HNewInstance* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.call);
+  last_visited_internal_latency_ = latencies_.call;
+}
+
+void SchedulingLatencyVisitorARM64::VisitNewArray(HNewArray* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.call);
+  last_visited_internal_latency_ = latencies_.call;
+}
+
+void SchedulingLatencyVisitorARM64::VisitBitwiseNegatedRight(
+    HBitwiseNegatedRight* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.int_op);
+}
+
+void SchedulingLatencyVisitorARM64::VisitMultiplyAccumulate(
+    HMultiplyAccumulate* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.int_mul);
+}
+
+void SchedulingLatencyVisitorARM64::VisitIntermediateAddress(
+    HIntermediateAddress* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.int_op);
+}
+
+void SchedulingLatencyVisitorARM64::VisitArm64DataProcWithShifterOp(
+    HArm64DataProcWithShifterOp* instruction ATTRIBUTE_UNUSED) {
+  // The shift is done by the instruction itself.
+  SetLatency(latencies_.int_op);
+}
+
+void SchedulingLatencyVisitorARM64::VisitVecLoad(HVecLoad* instruction ATTRIBUTE_UNUSED) {
+  SetLatency(latencies_.load);
+}
+
+void SchedulingLatencyVisitorARM64::VisitVecBinaryOperation(HVecBinaryOperation* instruction) {
+  if (instruction->GetOpKind() == HInstruction::kDiv) {
+    SetLatency(latencies_.fp_div);
+    last_visited_internal_latency_ = last_visited_latency_;
+  } else if (instruction->GetOpKind() == HInstruction::kMul) {
+    SetLatency(latencies_.fp_mul);
+  } else {
+    SetLatency(latencies_.fp_op);
+  }
+}
+
+}  // namespace arm64
+}  // namespace art
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
+#define ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
+
+#include "arch/arm64/instruction_set_features_arm64.h"
+#include "scheduler.h"
+
+namespace art {
+namespace arm64 {
+
+// Approximate latencies, in cycles, of the classes of instructions generated for ARM64.
+struct Arm64Latencies {
+  uint32_t int_op;
+  uint32_t int_mul;
+  uint32_t int_div;
+  uint32_t fp_op;
+  uint32_t fp_mul;
+  uint32_t fp_div;
+  uint32_t type_conversion;
+  uint32_t load;
+  uint32_t call;
+};
+
+class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
+ public:
+  explicit SchedulingLatencyVisitorARM64(const Arm64InstructionSetFeatures& isa_features);
+
+  void VisitBinaryOperation(HBinaryOperation* instruction) OVERRIDE;
+  void VisitUnaryOperation(HUnaryOperation* instruction) OVERRIDE;
+  void VisitMul(HMul* instruction) OVERRIDE;
+  void VisitDiv(HDiv* instruction) OVERRIDE;
+  void VisitRem(HRem* instruction) OVERRIDE;
+  void VisitTypeConversion(HTypeConversion* instruction) OVERRIDE;
+  void VisitSelect(HSelect* instruction) OVERRIDE;
+  void VisitBoundsCheck(HBoundsCheck* instruction) OVERRIDE;
+  void VisitArrayGet(HArrayGet* instruction) OVERRIDE;
+  void VisitArrayLength(HArrayLength* instruction) OVERRIDE;
+  void VisitInstanceFieldGet(HInstanceFieldGet* instruction) OVERRIDE;
+  void VisitStaticFieldGet(HStaticFieldGet* instruction) OVERRIDE;
+  void VisitLoadClass(HLoadClass* instruction) OVERRIDE;
+  void VisitLoadString(HLoadString* instruction) OVERRIDE;
+  void VisitInvoke(HInvoke* instruction) OVERRIDE;
+  void VisitNewInstance(HNewInstance* instruction) OVERRIDE;
+  void VisitNewArray(HNewArray* instruction) OVERRIDE;
+  void VisitBitwiseNegatedRight(HBitwiseNegatedRight* instruction) OVERRIDE;
+  void VisitMultiplyAccumulate(HMultiplyAccumulate* instruction) OVERRIDE;
+  void VisitIntermediateAddress(HIntermediateAddress* instruction) OVERRIDE;
+  void VisitArm64DataProcWithShifterOp(HArm64DataProcWithShifterOp* instruction) OVERRIDE;
+  void VisitVecLoad(HVecLoad* instruction) OVERRIDE;
+  void VisitVecBinaryOperation(HVecBinaryOperation* instruction) OVERRIDE;
+
+ private:
+  void SetLatency(uint32_t latency) {
+    last_visited_latency_ = latency;
+  }
+
+  void SetArithmeticLatency(Primitive::Type type) {
+    SetLatency(Primitive::IsFloatingPointType(type) ? latencies_.fp_op : latencies_.int_op);
+  }
+
+  const Arm64Latencies& latencies_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingLatencyVisitorARM64);
+};
+
+}  // namespace arm64
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
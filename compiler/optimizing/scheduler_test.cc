@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+#include "scheduler.h"
+
+#ifdef ART_ENABLE_CODEGEN_arm64
+#include "scheduler_arm64.h"
+#endif
+
+namespace art {
+
+#ifdef ART_ENABLE_CODEGEN_arm64
+
+/**
+ * Fixture class for the scheduler tests.
+ */
+class SchedulerTest : public CommonCompilerTest {
+ public:
+  SchedulerTest() : pool_(), allocator_(&pool_) {
+    graph_ = CreateGraph(&allocator_);
+  }
+
+  ~SchedulerTest() { }
+
+  // Builds a method with a single block between the entry and exit blocks, the block is
+  // populated by the tests before its return.
+  void BuildGraph() {
+    entry_ = new (&allocator_) HBasicBlock(graph_);
+    block_ = new (&allocator_) HBasicBlock(graph_);
+    exit_ = new (&allocator_) HBasicBlock(graph_);
+    graph_->AddBlock(entry_);
+    graph_->AddBlock(block_);
+    graph_->AddBlock(exit_);
+    graph_->SetEntryBlock(entry_);
+    graph_->SetExitBlock(exit_);
+    entry_->AddSuccessor(block_);
+    block_->AddSuccessor(exit_);
+
+    array_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+    int1_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 1, Primitive::kPrimInt);
+    int2_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 2, Primitive::kPrimInt);
+    entry_->AddInstruction(array_);
+    entry_->AddInstruction(int1_);
+    entry_->AddInstruction(int2_);
+    entry_->AddInstruction(new (&allocator_) HGoto());
+    exit_->AddInstruction(new (&allocator_) HExit());
+  }
+
+  HInstruction* Add(HInstruction* instruction) {
+    block_->AddInstruction(instruction);
+    return instruction;
+  }
+
+  void PerformScheduling() {
+    graph_->BuildDominatorTree();
+    std::string error;
+    std::unique_ptr<const Arm64InstructionSetFeatures> features(
+        Arm64InstructionSetFeatures::FromVariant("cortex-a53", &error));
+    arm64::SchedulingLatencyVisitorARM64 latency_visitor(*features);
+    HScheduler(&allocator_, &latency_visitor).Schedule(graph_);
+  }
+
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+
+  HBasicBlock* entry_;
+  HBasicBlock* block_;
+  HBasicBlock* exit_;
+
+  HInstruction* array_;
+  HInstruction* int1_;
+  HInstruction* int2_;
+};
+
+//
+// The actual tests.
+//
+
+TEST_F(SchedulerTest, IndependentInstructionFillsLoadLatency) {
+  BuildGraph();
+  HInstruction* load = Add(new (&allocator_) HArrayGet(
+      array_, graph_->GetIntConstant(0), Primitive::kPrimInt, kNoDexPc));
+  HInstruction* use = Add(new (&allocator_) HAdd(
+      Primitive::kPrimInt, load, graph_->GetIntConstant(1)));
+  HInstruction* mul = Add(new (&allocator_) HMul(Primitive::kPrimInt, int1_, int2_));
+  HInstruction* sum = Add(new (&allocator_) HAdd(Primitive::kPrimInt, use, mul));
+  Add(new (&allocator_) HReturn(sum));
+
+  PerformScheduling();
+
+  // The multiplication is issued while the load completes.
+  EXPECT_EQ(load->GetNext(), mul);
+  EXPECT_EQ(mul->GetNext(), use);
+  EXPECT_EQ(use->GetNext(), sum);
+}
+
+TEST_F(SchedulerTest, LoadStaysAfterStore) {
+  BuildGraph();
+  HInstruction* store = Add(new (&allocator_) HArraySet(
+      array_, graph_->GetIntConstant(0), int1_, Primitive::kPrimInt, kNoDexPc));
+  HInstruction* load = Add(new (&allocator_) HArrayGet(
+      array_, int2_, Primitive::kPrimInt, kNoDexPc));
+  HInstruction* mul = Add(new (&allocator_) HMul(Primitive::kPrimInt, load, int2_));
+  Add(new (&allocator_) HReturn(mul));
+
+  SchedulingGraph scheduling_graph(&allocator_);
+  scheduling_graph.AddNode(store);
+  scheduling_graph.AddNode(load);
+  scheduling_graph.AddNode(mul);
+  EXPECT_TRUE(scheduling_graph.HasImmediateOtherDependency(store, load));
+  EXPECT_FALSE(scheduling_graph.HasImmediateOtherDependency(store, mul));
+  EXPECT_TRUE(scheduling_graph.HasImmediateDataDependency(load, mul));
+
+  PerformScheduling();
+
+  EXPECT_EQ(store->GetNext(), load);
+  EXPECT_EQ(load->GetNext(), mul);
+}
+
+#endif  // ART_ENABLE_CODEGEN_arm64
+
+}  // namespace art
@@ -18,12 +18,40 @@
 
 namespace art {
 
+// Limits on the instructions moved in front of the If and on the number of Selects
+// replacing the phis, for architectures which lower HSelect to branches.
 static constexpr size_t kMaxInstructionsInBranch = 1u;
+static constexpr size_t kMaxSelects = 1u;
+
+// Limits for selects lowered to a single conditional move or conditional select
+// instruction, where speculating a few instructions is cheaper than a mispredicted
+// branch.
+static constexpr size_t kMaxInstructionsInBranchConditionalSelect = 3u;
+static constexpr size_t kMaxSelectsConditionalSelect = 3u;
+
+// Returns true if `select_phi` can be replaced with a Select which the code generator
+// of `instruction_set` lowers to a conditional move or conditional select instruction.
+static bool HasConditionalSelect(InstructionSet instruction_set,
+                                 HPhi* select_phi,
+                                 HInstruction* condition) {
+  switch (instruction_set) {
+    case kArm64:
+      return true;
+    case kX86_64:
+      // There are no conditional moves between XMM registers, and a floating point
+      // comparison does not set a single condition code. See SelectCanUseCMOV.
+      return !Primitive::IsFloatingPointType(select_phi->GetType()) &&
+          !(condition->IsCondition() &&
+            Primitive::IsFloatingPointType(condition->InputAt(0)->GetType()));
+    default:
+      return false;
+  }
+}
 
 // Returns true if `block` has only one predecessor, ends with a Goto and
-// contains at most `kMaxInstructionsInBranch` other movable instruction with
-// no side-effects.
-static bool IsSimpleBlock(HBasicBlock* block) {
+// contains at most `max_instructions` other movable instruction with
+// no side-effects, which cannot throw and can therefore be speculated.
+static bool IsSimpleBlock(HBasicBlock* block, size_t max_instructions) {
   if (block->GetPredecessors().size() != 1u) {
     return false;
   }
@@ -33,8 +61,10 @@ static bool IsSimpleBlock(HBasicBlock* block) {
   for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
     HInstruction* instruction = it.Current();
     if (instruction->IsControlFlow()) {
-      return instruction->IsGoto() && num_instructions <= kMaxInstructionsInBranch;
-    } else if (instruction->CanBeMoved() && !instruction->HasSideEffects()) {
+      return instruction->IsGoto() && num_instructions <= max_instructions;
+    } else if (instruction->CanBeMoved() &&
+               !instruction->HasSideEffects() &&
+               !instruction->CanThrow()) {
       num_instructions++;
     } else {
       return false;
@@ -51,28 +81,34 @@ static bool BlocksMergeTogether(HBasicBlock* block1, HBasicBlock* block2) {
   return block1->GetSingleSuccessor() == block2->GetSingleSuccessor();
 }
 
-// Returns nullptr if `block` has either no phis or there is more than one phi
-// with different inputs at `index1` and `index2`. Otherwise returns that phi.
-static HPhi* GetSingleChangedPhi(HBasicBlock* block, size_t index1, size_t index2) {
+// Collects the phis of `block` with different inputs at `index1` and `index2`
+// into `select_phis`.
+static void GetChangedPhis(HBasicBlock* block,
+                           size_t index1,
+                           size_t index2,
+                           ArenaVector<HPhi*>* select_phis) {
   DCHECK_NE(index1, index2);
+  DCHECK(select_phis->empty());
 
-  HPhi* select_phi = nullptr;
   for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
     HPhi* phi = it.Current()->AsPhi();
     if (phi->InputAt(index1) != phi->InputAt(index2)) {
-      if (select_phi == nullptr) {
-        // First phi with different inputs for the two indices found.
-        select_phi = phi;
-      } else {
-        // More than one phis has different inputs for the two indices.
-        return nullptr;
-      }
+      select_phis->push_back(phi);
     }
   }
-  return select_phi;
+}
+
+// Moves the instructions of `block` but its Goto in front of `cursor`.
+static void MoveInstructionsBefore(HBasicBlock* block, HInstruction* cursor) {
+  while (!block->IsSingleGoto()) {
+    block->GetFirstInstruction()->MoveBefore(cursor);
+  }
 }
 
 void HSelectGenerator::Run() {
+  InstructionSet instruction_set = graph_->GetInstructionSet();
+  ArenaVector<HPhi*> select_phis(graph_->GetArena()->Adapter(kArenaAllocOptimization));
+
   // Iterate in post order in the unlikely case that removing one occurrence of
   // the selection pattern empties a branch block of another occurrence.
   // Otherwise the order does not matter.
@@ -85,53 +121,70 @@ void HSelectGenerator::Run() {
     HBasicBlock* true_block = if_instruction->IfTrueSuccessor();
     HBasicBlock* false_block = if_instruction->IfFalseSuccessor();
     DCHECK_NE(true_block, false_block);
-    if (!IsSimpleBlock(true_block) ||
-        !IsSimpleBlock(false_block) ||
+    if (!IsSimpleBlock(true_block, kMaxInstructionsInBranchConditionalSelect) ||
+        !IsSimpleBlock(false_block, kMaxInstructionsInBranchConditionalSelect) ||
         !BlocksMergeTogether(true_block, false_block)) {
       continue;
     }
     HBasicBlock* merge_block = true_block->GetSingleSuccessor();
 
-    // If the branches are not empty, move instructions in front of the If.
-    // TODO(dbrazdil): This puts an instruction between If and its condition.
-    //                 Implement moving of conditions to first users if possible.
-    if (!true_block->IsSingleGoto()) {
-      true_block->GetFirstInstruction()->MoveBefore(if_instruction);
-    }
-    if (!false_block->IsSingleGoto()) {
-      false_block->GetFirstInstruction()->MoveBefore(if_instruction);
-    }
-    DCHECK(true_block->IsSingleGoto());
-    DCHECK(false_block->IsSingleGoto());
-
-    // Find the resulting true/false values.
+    // Find the phis to replace with selects.
     size_t predecessor_index_true = merge_block->GetPredecessorIndexOf(true_block);
     size_t predecessor_index_false = merge_block->GetPredecessorIndexOf(false_block);
     DCHECK_NE(predecessor_index_true, predecessor_index_false);
+    select_phis.clear();
+    GetChangedPhis(merge_block, predecessor_index_true, predecessor_index_false, &select_phis);
+    if (select_phis.empty()) {
+      continue;
+    }
 
-    HPhi* phi = GetSingleChangedPhi(merge_block, predecessor_index_true, predecessor_index_false);
-    if (phi == nullptr) {
+    // Speculating more than one instruction per branch, or selecting more than one
+    // value, only pays off when all the selects are branch free.
+    HInstruction* condition = if_instruction->InputAt(0);
+    bool conditional_select = true;
+    for (HPhi* phi : select_phis) {
+      conditional_select = conditional_select &&
+          HasConditionalSelect(instruction_set, phi, condition);
+    }
+    size_t max_instructions =
+        conditional_select ? kMaxInstructionsInBranchConditionalSelect : kMaxInstructionsInBranch;
+    size_t max_selects = conditional_select ? kMaxSelectsConditionalSelect : kMaxSelects;
+    if (select_phis.size() > max_selects ||
+        !IsSimpleBlock(true_block, max_instructions) ||
+        !IsSimpleBlock(false_block, max_instructions)) {
       continue;
     }
-    HInstruction* true_value = phi->InputAt(predecessor_index_true);
-    HInstruction* false_value = phi->InputAt(predecessor_index_false);
-
-    // Create the Select instruction and insert it in front of the If.
-    HSelect* select = new (graph_->GetArena()) HSelect(if_instruction->InputAt(0),
-                                                       true_value,
-                                                       false_value,
-                                                       if_instruction->GetDexPc());
-    if (phi->GetType() == Primitive::kPrimNot) {
-      select->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
+
+    // If the branches are not empty, move instructions in front of the If.
+    // TODO(dbrazdil): This puts an instruction between If and its condition.
+    //                 Implement moving of conditions to first users if possible.
+    MoveInstructionsBefore(true_block, if_instruction);
+    MoveInstructionsBefore(false_block, if_instruction);
+    DCHECK(true_block->IsSingleGoto());
+    DCHECK(false_block->IsSingleGoto());
+
+    // Create the Select instructions and insert them in front of the If, and
+    // make the phis take them from the false branch.
+    for (HPhi* phi : select_phis) {
+      HInstruction* true_value = phi->InputAt(predecessor_index_true);
+      HInstruction* false_value = phi->InputAt(predecessor_index_false);
+      HSelect* select = new (graph_->GetArena()) HSelect(condition,
+                                                         true_value,
+                                                         false_value,
+                                                         if_instruction->GetDexPc());
+      if (phi->GetType() == Primitive::kPrimNot) {
+        select->SetReferenceTypeInfo(phi->GetReferenceTypeInfo());
+      }
+      block->InsertInstructionBefore(select, if_instruction);
+      phi->ReplaceInput(select, predecessor_index_false);
+      MaybeRecordStat(MethodCompilationStat::kSelectGenerated);
     }
-    block->InsertInstructionBefore(select, if_instruction);
 
-    // Remove the true branch which removes the corresponding Phi input.
-    // If left only with the false branch, the Phi is automatically removed.
-    phi->ReplaceInput(select, predecessor_index_false);
+    // Remove the true branch which removes the corresponding Phi inputs.
+    // If left only with the false branch, the Phis are automatically removed.
     bool only_two_predecessors = (merge_block->GetPredecessors().size() == 2u);
     true_block->DisconnectAndDelete();
-    DCHECK_EQ(only_two_predecessors, phi->GetBlock() == nullptr);
+    DCHECK(!only_two_predecessors || merge_block->GetPhis().IsEmpty());
 
     // Merge remaining blocks which are now connected with Goto.
     DCHECK_EQ(block->GetSingleSuccessor(), false_block);
@@ -141,8 +194,6 @@ void HSelectGenerator::Run() {
       block->MergeWith(merge_block);
     }
 
-    MaybeRecordStat(MethodCompilationStat::kSelectGenerated);
-
     // No need to update dominance information, as we are simplifying
     // a simple diamond shape, where the join block is merged with the
     // entry block. Any following blocks would have had the join block
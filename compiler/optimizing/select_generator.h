@@ -27,9 +27,12 @@
  *     Phi [FalseValue, TrueValue]
  *
  * The pattern will be simplified if `true_branch` and `false_branch` each
- * contain at most one instruction without any side effects.
+ * contain at most one instruction without any side effects, and only one Phi
+ * has different inputs for them. On architectures where the selects become
+ * conditional moves (x86-64) or conditional selects (ARM64), a few more
+ * instructions are speculated and a few more Phis are replaced.
  *
- * Blocks are merged into one and Select replaces the If and the Phi:
+ * Blocks are merged into one and Selects replace the If and the Phis:
  *              true branch
  *              false branch
  *              Select [FalseValue, TrueValue, Condition]
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "graph_checker.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+#include "select_generator.h"
+
+namespace art {
+
+/**
+ * Fixture class for the SelectGenerator tests.
+ */
+class SelectGeneratorTest : public CommonCompilerTest {
+ public:
+  SelectGeneratorTest() : pool_(), allocator_(&pool_), graph_(nullptr) {}
+
+  ~SelectGeneratorTest() { }
+
+  // Builds
+  //   int x, y;
+  //   if (a > b) { x = a; y = a + 1; } else { x = b; y = b - 1; }
+  //   return x + y;
+  // for `instruction_set`.
+  void BuildGraph(InstructionSet instruction_set) {
+    graph_ = new (&allocator_) HGraph(
+        &allocator_, *reinterpret_cast<DexFile*>(allocator_.Alloc(sizeof(DexFile))), -1, false,
+        instruction_set);
+    HBasicBlock* entry = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* if_block = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* then_block = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* else_block = new (&allocator_) HBasicBlock(graph_);
+    merge_ = new (&allocator_) HBasicBlock(graph_);
+    HBasicBlock* exit = new (&allocator_) HBasicBlock(graph_);
+
+    graph_->AddBlock(entry);
+    graph_->AddBlock(if_block);
+    graph_->AddBlock(then_block);
+    graph_->AddBlock(else_block);
+    graph_->AddBlock(merge_);
+    graph_->AddBlock(exit);
+    graph_->SetEntryBlock(entry);
+    graph_->SetExitBlock(exit);
+
+    entry->AddSuccessor(if_block);
+    if_block->AddSuccessor(then_block);
+    if_block->AddSuccessor(else_block);
+    then_block->AddSuccessor(merge_);
+    else_block->AddSuccessor(merge_);
+    merge_->AddSuccessor(exit);
+
+    HInstruction* a = new (&allocator_) HParameterValue(
+        graph_->GetDexFile(), 0, 0, Primitive::kPrimInt);
+    HInstruction* b = new (&allocator_) HParameterValue(
+        graph_->GetDexFile(), 0, 1, Primitive::kPrimInt);
+    entry->AddInstruction(a);
+    entry->AddInstruction(b);
+    entry->AddInstruction(new (&allocator_) HGoto());
+
+    HInstruction* condition = new (&allocator_) HGreaterThan(a, b);
+    if_block->AddInstruction(condition);
+    if_block->AddInstruction(new (&allocator_) HIf(condition));
+
+    HInstruction* increment =
+        new (&allocator_) HAdd(Primitive::kPrimInt, a, graph_->GetIntConstant(1));
+    then_block->AddInstruction(increment);
+    then_block->AddInstruction(new (&allocator_) HGoto());
+    HInstruction* decrement =
+        new (&allocator_) HSub(Primitive::kPrimInt, b, graph_->GetIntConstant(1));
+    else_block->AddInstruction(decrement);
+    else_block->AddInstruction(new (&allocator_) HGoto());
+
+    x_ = new (&allocator_) HPhi(&allocator_, 0, 0, Primitive::kPrimInt);
+    y_ = new (&allocator_) HPhi(&allocator_, 1, 0, Primitive::kPrimInt);
+    merge_->AddPhi(x_);
+    merge_->AddPhi(y_);
+    x_->AddInput(a);
+    x_->AddInput(b);
+    y_->AddInput(increment);
+    y_->AddInput(decrement);
+    sum_ = new (&allocator_) HAdd(Primitive::kPrimInt, x_, y_);
+    merge_->AddInstruction(sum_);
+    merge_->AddInstruction(new (&allocator_) HReturn(sum_));
+    exit->AddInstruction(new (&allocator_) HExit());
+
+    graph_->BuildDominatorTree();
+  }
+
+  void CheckGraph() {
+    GraphChecker graph_checker(graph_);
+    graph_checker.Run();
+    ASSERT_TRUE(graph_checker.IsValid());
+  }
+
+  // General building fields.
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+  HGraph* graph_;
+
+  HBasicBlock* merge_;
+  HPhi* x_;
+  HPhi* y_;
+  HInstruction* sum_;
+};
+
+//
+// The actual SelectGenerator tests.
+//
+
+TEST_F(SelectGeneratorTest, TwoPhisWithConditionalSelect) {
+  BuildGraph(kArm64);
+  HSelectGenerator(graph_, nullptr).Run();
+  CheckGraph();
+
+  // Both phis are replaced, and the diamond is merged into the block of the If.
+  ASSERT_TRUE(sum_->InputAt(0)->IsSelect());
+  ASSERT_TRUE(sum_->InputAt(1)->IsSelect());
+  EXPECT_TRUE(sum_->InputAt(1)->AsSelect()->GetTrueValue()->IsAdd());
+  EXPECT_TRUE(sum_->InputAt(1)->AsSelect()->GetFalseValue()->IsSub());
+  EXPECT_EQ(x_->GetBlock(), nullptr);
+  EXPECT_EQ(y_->GetBlock(), nullptr);
+  EXPECT_EQ(merge_->GetGraph(), nullptr);
+}
+
+TEST_F(SelectGeneratorTest, TwoPhisWithoutConditionalSelect) {
+  BuildGraph(kMips);
+  HSelectGenerator(graph_, nullptr).Run();
+  CheckGraph();
+
+  // Selects would be branches, so the diamond is kept.
+  EXPECT_EQ(sum_->InputAt(0), x_);
+  EXPECT_EQ(sum_->InputAt(1), y_);
+  EXPECT_EQ(x_->GetBlock(), merge_);
+}
+
+}  // namespace art
@@ -34,6 +34,15 @@
 
 namespace art {
 
+// Objects of the boot image and of the app images are never moved nor removed, so that
+// JIT-compiled code can embed their addresses. App images are only removed if they fail to be
+// added, before any code could see their objects.
+static bool IsInImageSpace(mirror::Object* object) SHARED_REQUIRES(Locks::mutator_lock_) {
+  gc::space::ContinuousSpace* space =
+      Runtime::Current()->GetHeap()->FindContinuousSpaceFromObject(object, /* fail_ok */ true);
+  return space != nullptr && space->IsImageSpace();
+}
+
 void HSharpening::Run() {
   // We don't care about the order of the blocks here.
   for (HBasicBlock* block : graph_->GetReversePostOrder()) {
@@ -211,8 +220,9 @@ void HSharpening::ProcessLoadClass(HLoadClass* load_class) {
       // TODO: Make sure we don't set the "compile PIC" flag for JIT as that's bogus.
       // DCHECK(!codegen_->GetCompilerOptions().GetCompilePic());
       is_in_dex_cache = (klass != nullptr);
-      if (klass != nullptr && runtime->GetHeap()->ObjectIsInBootImageSpace(klass)) {
-        // TODO: Use direct pointers for all non-moving spaces, not just boot image. Bug: 29530787
+      if (klass != nullptr && IsInImageSpace(klass)) {
+        // A boot image or app image class, use its address rather than the dex cache entry.
+        // TODO: Use direct pointers for all non-moving spaces, not just images. Bug: 29530787
         desired_load_kind = HLoadClass::LoadKind::kBootImageAddress;
         address = reinterpret_cast64<uint64_t>(klass);
       } else {
@@ -311,8 +321,9 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
       // DCHECK(!codegen_->GetCompilerOptions().GetCompilePic());
       mirror::String* string = dex_cache->GetResolvedString(string_index);
       is_in_dex_cache = (string != nullptr);
-      if (string != nullptr && runtime->GetHeap()->ObjectIsInBootImageSpace(string)) {
-        // TODO: Use direct pointers for all non-moving spaces, not just boot image. Bug: 29530787
+      if (string != nullptr && IsInImageSpace(string)) {
+        // A boot image or app image string, use its address rather than the dex cache entry.
+        // TODO: Use direct pointers for all non-moving spaces, not just images. Bug: 29530787
         desired_load_kind = HLoadString::LoadKind::kBootImageAddress;
         address = reinterpret_cast64<uint64_t>(string);
       } else {
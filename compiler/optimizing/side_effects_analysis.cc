@@ -18,11 +18,34 @@
 
 namespace art {
 
+// The field of a non-volatile field load or store, which only accesses the same memory as
+// the field accesses at the same offset, or null.
+static const FieldInfo* GetNonVolatileFieldInfo(HInstruction* instruction) {
+  const FieldInfo* field_info = nullptr;
+  if (instruction->IsInstanceFieldGet()) {
+    field_info = &instruction->AsInstanceFieldGet()->GetFieldInfo();
+  } else if (instruction->IsStaticFieldGet()) {
+    field_info = &instruction->AsStaticFieldGet()->GetFieldInfo();
+  } else if (instruction->IsInstanceFieldSet()) {
+    field_info = &instruction->AsInstanceFieldSet()->GetFieldInfo();
+  } else if (instruction->IsStaticFieldSet()) {
+    field_info = &instruction->AsStaticFieldSet()->GetFieldInfo();
+  }
+  return (field_info != nullptr && !field_info->IsVolatile()) ? field_info : nullptr;
+}
+
+static bool IsNonVolatileFieldStore(HInstruction* instruction) {
+  return (instruction->IsInstanceFieldSet() || instruction->IsStaticFieldSet()) &&
+      GetNonVolatileFieldInfo(instruction) != nullptr;
+}
+
 void SideEffectsAnalysis::Run() {
   // Inlining might have created more blocks, so we need to increase the size
   // if needed.
   block_effects_.resize(graph_->GetBlocks().size());
   loop_effects_.resize(graph_->GetBlocks().size());
+  loop_other_effects_.resize(graph_->GetBlocks().size());
+  loop_field_stores_.resize(graph_->GetBlocks().size(), nullptr);
 
   // In DEBUG mode, ensure side effects are properly initialized to empty.
   if (kIsDebugBuild) {
@@ -42,14 +65,22 @@ void SideEffectsAnalysis::Run() {
     HBasicBlock* block = it.Current();
 
     SideEffects effects = SideEffects::None();
+    SideEffects other_effects = SideEffects::None();
+    HLoopInformation* loop_info = block->GetLoopInformation();
     // Update `effects` with the side effects of all instructions in this block.
     for (HInstructionIterator inst_it(block->GetInstructions()); !inst_it.Done();
          inst_it.Advance()) {
       HInstruction* instruction = inst_it.Current();
       effects = effects.Union(instruction->GetSideEffects());
+      if (loop_info != nullptr && IsNonVolatileFieldStore(instruction)) {
+        AddLoopFieldStore(loop_info, instruction);
+      } else {
+        other_effects = other_effects.Union(instruction->GetSideEffects());
+      }
       // If all side effects are represented, scanning further will not add any
       // more information to side-effects of this block.
-      if (effects.DoesAll()) {
+      if (other_effects.DoesAll()) {
+        effects = other_effects;
         break;
       }
     }
@@ -58,22 +89,55 @@ void SideEffectsAnalysis::Run() {
 
     if (block->IsLoopHeader()) {
       // The side effects of the loop header are part of the loop.
-      UpdateLoopEffects(block->GetLoopInformation(), effects);
-      HBasicBlock* pre_header = block->GetLoopInformation()->GetPreHeader();
+      UpdateLoopEffects(loop_info, effects, other_effects);
+      HBasicBlock* pre_header = loop_info->GetPreHeader();
       if (pre_header->IsInLoop()) {
         // Update the side effects of the outer loop with the side effects of the inner loop.
         // Note that this works because we know all the blocks of the inner loop are visited
         // before the loop header of the outer loop.
-        UpdateLoopEffects(pre_header->GetLoopInformation(), GetLoopEffects(block));
+        MergeIntoOuterLoop(loop_info, pre_header->GetLoopInformation());
       }
-    } else if (block->IsInLoop()) {
+    } else if (loop_info != nullptr) {
       // Update the side effects of the loop with the side effects of this block.
-      UpdateLoopEffects(block->GetLoopInformation(), effects);
+      UpdateLoopEffects(loop_info, effects, other_effects);
     }
   }
   has_run_ = true;
 }
 
+bool SideEffectsAnalysis::MayDependOn(HInstruction* instruction, HInstruction* other) {
+  if (!instruction->GetSideEffects().MayDependOn(other->GetSideEffects())) {
+    return false;
+  }
+  if (!IsNonVolatileFieldStore(other)) {
+    return true;
+  }
+  const FieldInfo* field_info = GetNonVolatileFieldInfo(instruction);
+  return field_info == nullptr ||
+      field_info->GetFieldOffset() == GetNonVolatileFieldInfo(other)->GetFieldOffset();
+}
+
+bool SideEffectsAnalysis::MayDependOnLoop(HInstruction* instruction,
+                                          HBasicBlock* loop_header) const {
+  DCHECK(loop_header->IsLoopHeader());
+  uint32_t id = loop_header->GetBlockId();
+  SideEffects effects = instruction->GetSideEffects();
+  if (!effects.MayDependOn(loop_effects_[id])) {
+    return false;
+  }
+  if (effects.MayDependOn(loop_other_effects_[id])) {
+    return true;
+  }
+  // Only the non-volatile field stores of the loop are left.
+  DCHECK(loop_field_stores_[id] != nullptr);
+  for (HInstruction* store : *loop_field_stores_[id]) {
+    if (MayDependOn(instruction, store)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 SideEffects SideEffectsAnalysis::GetLoopEffects(HBasicBlock* block) const {
   DCHECK(block->IsLoopHeader());
   return loop_effects_[block->GetBlockId()];
@@ -83,9 +147,38 @@ SideEffects SideEffectsAnalysis::GetBlockEffects(HBasicBlock* block) const {
   return block_effects_[block->GetBlockId()];
 }
 
-void SideEffectsAnalysis::UpdateLoopEffects(HLoopInformation* info, SideEffects effects) {
+void SideEffectsAnalysis::UpdateLoopEffects(HLoopInformation* info,
+                                            SideEffects effects,
+                                            SideEffects other_effects) {
   uint32_t id = info->GetHeader()->GetBlockId();
   loop_effects_[id] = loop_effects_[id].Union(effects);
+  loop_other_effects_[id] = loop_other_effects_[id].Union(other_effects);
+}
+
+void SideEffectsAnalysis::AddLoopFieldStore(HLoopInformation* info, HInstruction* store) {
+  uint32_t id = info->GetHeader()->GetBlockId();
+  ArenaVector<HInstruction*>* stores = loop_field_stores_[id];
+  if (stores == nullptr) {
+    ArenaAllocator* arena = graph_->GetArena();
+    stores = new (arena) ArenaVector<HInstruction*>(
+        arena->Adapter(kArenaAllocSideEffectsAnalysis));
+    loop_field_stores_[id] = stores;
+  }
+  if (stores->size() < kMaximumNumberOfFieldStores) {
+    stores->push_back(store);
+  } else {
+    loop_other_effects_[id] = loop_other_effects_[id].Union(store->GetSideEffects());
+  }
+}
+
+void SideEffectsAnalysis::MergeIntoOuterLoop(HLoopInformation* inner, HLoopInformation* outer) {
+  uint32_t id = inner->GetHeader()->GetBlockId();
+  UpdateLoopEffects(outer, loop_effects_[id], loop_other_effects_[id]);
+  if (loop_field_stores_[id] != nullptr) {
+    for (HInstruction* store : *loop_field_stores_[id]) {
+      AddLoopFieldStore(outer, store);
+    }
+  }
 }
 
 }  // namespace art
@@ -31,11 +31,25 @@ class SideEffectsAnalysis : public HOptimization {
         block_effects_(graph->GetBlocks().size(),
                        graph->GetArena()->Adapter(kArenaAllocSideEffectsAnalysis)),
         loop_effects_(graph->GetBlocks().size(),
-                      graph->GetArena()->Adapter(kArenaAllocSideEffectsAnalysis)) {}
+                      graph->GetArena()->Adapter(kArenaAllocSideEffectsAnalysis)),
+        loop_other_effects_(graph->GetBlocks().size(),
+                            graph->GetArena()->Adapter(kArenaAllocSideEffectsAnalysis)),
+        loop_field_stores_(graph->GetBlocks().size(),
+                           nullptr,
+                           graph->GetArena()->Adapter(kArenaAllocSideEffectsAnalysis)) {}
 
   SideEffects GetLoopEffects(HBasicBlock* block) const;
   SideEffects GetBlockEffects(HBasicBlock* block) const;
 
+  // Whether `instruction` may depend on the side effects of the loop of `loop_header`.
+  // This is more precise than checking against GetLoopEffects(), as a non-volatile field
+  // load only depends on the stores to fields at the same offset.
+  bool MayDependOnLoop(HInstruction* instruction, HBasicBlock* loop_header) const;
+
+  // Whether `instruction` may depend on the side effects of `other`, with the same
+  // precision for field loads and stores as MayDependOnLoop().
+  static bool MayDependOn(HInstruction* instruction, HInstruction* other);
+
   // Compute side effects of individual blocks and loops.
   void Run();
 
@@ -44,7 +58,9 @@ class SideEffectsAnalysis : public HOptimization {
   static constexpr const char* kSideEffectsAnalysisPassName = "SideEffects";
 
  private:
-  void UpdateLoopEffects(HLoopInformation* info, SideEffects effects);
+  void UpdateLoopEffects(HLoopInformation* info, SideEffects effects, SideEffects other_effects);
+  void AddLoopFieldStore(HLoopInformation* info, HInstruction* store);
+  void MergeIntoOuterLoop(HLoopInformation* inner, HLoopInformation* outer);
 
   HGraph* graph_;
 
@@ -60,6 +76,16 @@ class SideEffectsAnalysis : public HOptimization {
   // blocks contained in that loop.
   ArenaVector<SideEffects> loop_effects_;
 
+  // Side effects of loops, without the non-volatile field stores recorded in
+  // `loop_field_stores_`.
+  ArenaVector<SideEffects> loop_other_effects_;
+
+  // Non-volatile field stores of loops, null if there are none. Past
+  // kMaximumNumberOfFieldStores, the stores of a loop go to `loop_other_effects_`.
+  ArenaVector<ArenaVector<HInstruction*>*> loop_field_stores_;
+
+  static constexpr size_t kMaximumNumberOfFieldStores = 16;
+
   ART_FRIEND_TEST(GVNTest, LoopSideEffects);
   DISALLOW_COPY_AND_ASSIGN(SideEffectsAnalysis);
 };
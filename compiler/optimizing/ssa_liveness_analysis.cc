@@ -168,10 +168,16 @@ void SsaLivenessAnalysis::ComputeLiveness() {
   // and live_out sets are not yet correct.
   ComputeLiveRanges();
 
-  // Do a fixed point calculation to take into account backward branches,
-  // that will update live_in of loop headers, and therefore live_out and live_in
-  // of blocks in the loop.
-  ComputeLiveInAndLiveOutSets();
+  if (graph_->HasIrreducibleLoops()) {
+    // Do a fixed point calculation to take into account backward branches,
+    // that will update live_in of loop headers, and therefore live_out and live_in
+    // of blocks in the loop.
+    ComputeLiveInAndLiveOutSets();
+  } else {
+    // In a reducible graph the live_in sets of loop headers are already complete,
+    // so one pass over the loops gives the same sets as the fixed point.
+    PropagateLiveInOfLoopHeaders();
+  }
 }
 
 static void RecursivelyProcessInputs(HInstruction* current,
@@ -345,6 +351,33 @@ void SsaLivenessAnalysis::ComputeLiveInAndLiveOutSets() {
   } while (changed);
 }
 
+void SsaLivenessAnalysis::PropagateLiveInOfLoopHeaders() {
+  // A value live_in at a loop header is defined outside of the loop, and is therefore
+  // live_in everywhere in the loop: the back edges keep it alive until the loop exits.
+  // The blocks of inner loops are part of the blocks of outer loops, so the order in
+  // which the loops are processed does not matter.
+  for (HLinearOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    HBasicBlock* header = it.Current();
+    if (!header->IsLoopHeader()) {
+      continue;
+    }
+    BitVector* header_live_in = GetLiveInSet(*header);
+    for (HBlocksInLoopIterator it_loop(*header->GetLoopInformation());
+         !it_loop.Done();
+         it_loop.Advance()) {
+      HBasicBlock* block = it_loop.Current();
+      if (block != header) {
+        GetLiveInSet(*block)->Union(header_live_in);
+      }
+    }
+  }
+
+  // With all the live_in sets final, live_out sets only need one pass.
+  for (HLinearOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    UpdateLiveOut(*it.Current());
+  }
+}
+
 bool SsaLivenessAnalysis::UpdateLiveOut(const HBasicBlock& block) {
   BitVector* live_out = GetLiveOutSet(block);
   bool changed = false;
@@ -1251,6 +1251,10 @@ class SsaLivenessAnalysis : public ValueObject {
   // backwards branches.
   void ComputeLiveInAndLiveOutSets();
 
+  // Same as ComputeLiveInAndLiveOutSets for graphs without irreducible loops, in a single
+  // pass over the loops instead of a fixed point over the whole graph.
+  void PropagateLiveInOfLoopHeaders();
+
   // Update the live_in set of the block and returns whether it has changed.
   bool UpdateLiveIn(const HBasicBlock& block);
 
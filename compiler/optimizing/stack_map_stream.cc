@@ -15,6 +15,8 @@
  */
 #include "stack_map_stream.h"
 
+#include "base/stl_util.h"
+
 namespace art {
 
 void StackMapStream::BeginStackMapEntry(uint32_t dex_pc,
@@ -35,6 +37,7 @@ void StackMapStream::BeginStackMapEntry(uint32_t dex_pc,
   current_entry_.inline_infos_start_index = inline_infos_.size();
   current_entry_.dex_register_map_hash = 0;
   current_entry_.same_dex_register_map_as_ = kNoSameDexMapFound;
+  current_entry_.stack_mask_index = 0u;
   if (num_dex_registers != 0) {
     current_entry_.live_dex_registers_mask =
         ArenaBitVector::Create(allocator_, num_dex_registers, true, kArenaAllocStackMapStream);
@@ -101,12 +104,14 @@ void StackMapStream::AddDexRegisterEntry(DexRegisterLocation::Kind kind, int32_t
 void StackMapStream::BeginInlineInfoEntry(uint32_t method_index,
                                           uint32_t dex_pc,
                                           InvokeType invoke_type,
-                                          uint32_t num_dex_registers) {
+                                          uint32_t num_dex_registers,
+                                          uint32_t dex_file_index) {
   DCHECK(!in_inline_frame_);
   in_inline_frame_ = true;
   current_inline_info_.method_index = method_index;
   current_inline_info_.dex_pc = dex_pc;
   current_inline_info_.invoke_type = invoke_type;
+  current_inline_info_.dex_file_index = dex_file_index;
   current_inline_info_.num_dex_registers = num_dex_registers;
   current_inline_info_.dex_register_locations_start_index = dex_register_locations_.size();
   if (num_dex_registers != 0) {
@@ -137,6 +142,7 @@ uint32_t StackMapStream::ComputeMaxNativePcOffset() const {
 
 size_t StackMapStream::PrepareForFillIn() {
   int stack_mask_number_of_bits = stack_mask_max_ + 1;  // Need room for max element too.
+  size_t number_of_stack_masks = PrepareStackMasks(stack_mask_number_of_bits);
   dex_register_maps_size_ = ComputeDexRegisterMapsSize();
   ComputeInlineInfoEncoding();  // needs dex_register_maps_size_.
   inline_info_size_ = inline_infos_.size() * inline_info_encoding_.GetEntrySize();
@@ -146,12 +152,16 @@ size_t StackMapStream::PrepareForFillIn() {
                                                            dex_register_maps_size_,
                                                            inline_info_size_,
                                                            register_mask_max_,
-                                                           stack_mask_number_of_bits);
+                                                           number_of_stack_masks == 0u
+                                                               ? 0u
+                                                               : number_of_stack_masks - 1u);
   stack_maps_size_ = stack_maps_.size() * stack_map_size;
+  stack_masks_size_ = stack_masks_.size();
   dex_register_location_catalog_size_ = ComputeDexRegisterLocationCatalogSize();
 
   size_t non_header_size =
       stack_maps_size_ +
+      stack_masks_size_ +
       dex_register_location_catalog_size_ +
       dex_register_maps_size_ +
       inline_info_size_;
@@ -160,7 +170,10 @@ size_t StackMapStream::PrepareForFillIn() {
   CodeInfoEncoding code_info_encoding;
   code_info_encoding.non_header_size = non_header_size;
   code_info_encoding.number_of_stack_maps = stack_maps_.size();
+  code_info_encoding.number_of_sorted_stack_maps = ComputeNumberOfSortedStackMaps();
   code_info_encoding.stack_map_size_in_bytes = stack_map_size;
+  code_info_encoding.number_of_stack_masks = number_of_stack_masks;
+  code_info_encoding.stack_mask_size_in_bytes = stack_mask_size_;
   code_info_encoding.stack_map_encoding = stack_map_encoding_;
   code_info_encoding.inline_info_encoding = inline_info_encoding_;
   code_info_encoding.number_of_location_catalog_entries = location_catalog_entries_.size();
@@ -168,7 +181,8 @@ size_t StackMapStream::PrepareForFillIn() {
 
   // TODO: Move the catalog at the end. It is currently too expensive at runtime
   // to compute its size (note that we do not encode that size in the CodeInfo).
-  dex_register_location_catalog_start_ = code_info_encoding_.size() + stack_maps_size_;
+  dex_register_location_catalog_start_ =
+      code_info_encoding_.size() + stack_maps_size_ + stack_masks_size_;
   dex_register_maps_start_ =
       dex_register_location_catalog_start_ + dex_register_location_catalog_size_;
   inline_infos_start_ = dex_register_maps_start_ + dex_register_maps_size_;
@@ -185,6 +199,63 @@ size_t StackMapStream::ComputeDexRegisterLocationCatalogSize() const {
   return size;
 }
 
+// Returns the length of the longest prefix of stack maps sorted by native pc offset. The runtime
+// binary searches this prefix, and linearly searches the catch stack maps that follow it.
+size_t StackMapStream::ComputeNumberOfSortedStackMaps() const {
+  size_t number_of_sorted_stack_maps = stack_maps_.empty() ? 0u : 1u;
+  while (number_of_sorted_stack_maps < stack_maps_.size() &&
+         stack_maps_[number_of_sorted_stack_maps - 1u].native_pc_offset <=
+             stack_maps_[number_of_sorted_stack_maps].native_pc_offset) {
+    ++number_of_sorted_stack_maps;
+  }
+  return number_of_sorted_stack_maps;
+}
+
+size_t StackMapStream::PrepareStackMasks(size_t number_of_stack_mask_bits) {
+  stack_masks_.clear();
+  stack_mask_size_ = RoundUp(number_of_stack_mask_bits, kBitsPerByte) / kBitsPerByte;
+  if (stack_mask_size_ == 0u) {
+    // All the stack masks are empty, the stack map entries keep the index 0.
+    return 0u;
+  }
+  ArenaVector<uint8_t> stack_mask(stack_mask_size_, 0u,
+                                  allocator_->Adapter(kArenaAllocStackMapStream));
+  ArenaSafeMap<uint32_t, ArenaVector<uint32_t>> hash_to_stack_mask_indices(
+      std::less<uint32_t>(), allocator_->Adapter(kArenaAllocStackMapStream));
+  for (StackMapEntry& entry : stack_maps_) {
+    std::fill(stack_mask.begin(), stack_mask.end(), 0u);
+    if (entry.sp_mask != nullptr) {
+      for (uint32_t bit : entry.sp_mask->Indexes()) {
+        DCHECK_LT(bit, number_of_stack_mask_bits);
+        stack_mask[bit / kBitsPerByte] |= 1u << (bit % kBitsPerByte);
+      }
+    }
+    uint32_t hash = FNVHash<ArenaVector<uint8_t>>()(stack_mask);
+    auto it = hash_to_stack_mask_indices.find(hash);
+    if (it == hash_to_stack_mask_indices.end()) {
+      it = hash_to_stack_mask_indices.Put(
+          hash, ArenaVector<uint32_t>(allocator_->Adapter(kArenaAllocStackMapStream)));
+    }
+    bool found = false;
+    for (uint32_t index : it->second) {
+      if (memcmp(stack_masks_.data() + index * stack_mask_size_,
+                 stack_mask.data(),
+                 stack_mask_size_) == 0) {
+        entry.stack_mask_index = index;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      entry.stack_mask_index = dchecked_integral_cast<uint32_t>(
+          stack_masks_.size() / stack_mask_size_);
+      it->second.push_back(entry.stack_mask_index);
+      stack_masks_.insert(stack_masks_.end(), stack_mask.begin(), stack_mask.end());
+    }
+  }
+  return stack_masks_.size() / stack_mask_size_;
+}
+
 size_t StackMapStream::ComputeDexRegisterMapSize(uint32_t num_dex_registers,
                                                  const BitVector* live_dex_registers_mask) const {
   // For num_dex_registers == 0u live_dex_registers_mask may be null.
@@ -230,6 +301,7 @@ void StackMapStream::ComputeInlineInfoEncoding() {
   uint32_t method_index_max = 0;
   uint32_t dex_pc_max = DexFile::kDexNoIndex;
   uint32_t invoke_type_max = 0;
+  uint32_t dex_file_index_max = InlineInfo::kOuterDexFileIndex;
 
   uint32_t inline_info_index = 0;
   for (const StackMapEntry& entry : stack_maps_) {
@@ -241,6 +313,11 @@ void StackMapStream::ComputeInlineInfoEncoding() {
         dex_pc_max = inline_entry.dex_pc;
       }
       invoke_type_max = std::max(invoke_type_max, static_cast<uint32_t>(inline_entry.invoke_type));
+      if (inline_entry.dex_file_index != InlineInfo::kOuterDexFileIndex &&
+          (dex_file_index_max == InlineInfo::kOuterDexFileIndex ||
+           dex_file_index_max < inline_entry.dex_file_index)) {
+        dex_file_index_max = inline_entry.dex_file_index;
+      }
     }
   }
   DCHECK_EQ(inline_info_index, inline_infos_.size());
@@ -248,6 +325,7 @@ void StackMapStream::ComputeInlineInfoEncoding() {
   inline_info_encoding_.SetFromSizes(method_index_max,
                                      dex_pc_max,
                                      invoke_type_max,
+                                     dex_file_index_max,
                                      dex_register_maps_size_);
 }
 
@@ -287,6 +365,13 @@ void StackMapStream::FillIn(MemoryRegion region) {
   // Ensure we reached the end of the Dex registers location_catalog.
   DCHECK_EQ(location_catalog_offset, dex_register_location_catalog_region.size());
 
+  // Set the stack masks, shared by the stack maps.
+  if (stack_masks_size_ != 0u) {
+    memcpy(region.start() + code_info_encoding_.size() + stack_maps_size_,
+           stack_masks_.data(),
+           stack_masks_size_);
+  }
+
   ArenaBitVector empty_bitmask(allocator_, 0, /* expandable */ false, kArenaAllocStackMapStream);
   uintptr_t next_dex_register_map_offset = 0;
   uintptr_t next_inline_info_offset = 0;
@@ -297,17 +382,7 @@ void StackMapStream::FillIn(MemoryRegion region) {
     stack_map.SetDexPc(stack_map_encoding_, entry.dex_pc);
     stack_map.SetNativePcOffset(stack_map_encoding_, entry.native_pc_offset);
     stack_map.SetRegisterMask(stack_map_encoding_, entry.register_mask);
-    size_t number_of_stack_mask_bits = stack_map.GetNumberOfStackMaskBits(stack_map_encoding_);
-    if (entry.sp_mask != nullptr) {
-      for (size_t bit = 0; bit < number_of_stack_mask_bits; bit++) {
-        stack_map.SetStackMaskBit(stack_map_encoding_, bit, entry.sp_mask->IsBitSet(bit));
-      }
-    } else {
-      // The MemoryRegion does not have to be zeroed, so make sure we clear the bits.
-      for (size_t bit = 0; bit < number_of_stack_mask_bits; bit++) {
-        stack_map.SetStackMaskBit(stack_map_encoding_, bit, false);
-      }
-    }
+    stack_map.SetStackMaskIndex(stack_map_encoding_, entry.stack_mask_index);
 
     if (entry.num_dex_registers == 0 || (entry.live_dex_registers_mask->NumSetBits() == 0)) {
       // No dex map available.
@@ -357,6 +432,9 @@ void StackMapStream::FillIn(MemoryRegion region) {
         inline_info.SetMethodIndexAtDepth(inline_info_encoding_, depth, inline_entry.method_index);
         inline_info.SetDexPcAtDepth(inline_info_encoding_, depth, inline_entry.dex_pc);
         inline_info.SetInvokeTypeAtDepth(inline_info_encoding_, depth, inline_entry.invoke_type);
+        inline_info.SetDexFileIndexAtDepth(inline_info_encoding_,
+                                           depth,
+                                           inline_entry.dex_file_index);
         if (inline_entry.num_dex_registers == 0) {
           // No dex map available.
           inline_info.SetDexRegisterMapOffsetAtDepth(inline_info_encoding_,
@@ -514,15 +592,16 @@ void StackMapStream::CheckCodeInfo(MemoryRegion region) const {
     DCHECK_EQ(stack_map.GetNativePcOffset(stack_map_encoding), entry.native_pc_offset);
     DCHECK_EQ(stack_map.GetDexPc(stack_map_encoding), entry.dex_pc);
     DCHECK_EQ(stack_map.GetRegisterMask(stack_map_encoding), entry.register_mask);
-    size_t num_stack_mask_bits = stack_map.GetNumberOfStackMaskBits(stack_map_encoding);
+    MemoryRegion stack_mask = code_info.GetStackMaskOf(stack_map, encoding);
+    size_t num_stack_mask_bits = stack_mask.size_in_bits();
     if (entry.sp_mask != nullptr) {
       DCHECK_GE(num_stack_mask_bits, entry.sp_mask->GetNumberOfBits());
       for (size_t b = 0; b < num_stack_mask_bits; b++) {
-        DCHECK_EQ(stack_map.GetStackMaskBit(stack_map_encoding, b), entry.sp_mask->IsBitSet(b));
+        DCHECK_EQ(stack_mask.LoadBit(b), entry.sp_mask->IsBitSet(b));
       }
     } else {
       for (size_t b = 0; b < num_stack_mask_bits; b++) {
-        DCHECK_EQ(stack_map.GetStackMaskBit(stack_map_encoding, b), 0u);
+        DCHECK_EQ(stack_mask.LoadBit(b), 0u);
       }
     }
 
@@ -548,6 +627,8 @@ void StackMapStream::CheckCodeInfo(MemoryRegion region) const {
                   inline_entry.method_index);
         DCHECK_EQ(inline_info.GetInvokeTypeAtDepth(encoding.inline_info_encoding, d),
                   inline_entry.invoke_type);
+        DCHECK_EQ(inline_info.GetDexFileIndexAtDepth(encoding.inline_info_encoding, d),
+                  inline_entry.dex_file_index);
 
         CheckDexRegisterMap(code_info,
                             code_info.GetDexRegisterMapAtDepth(
@@ -66,6 +66,7 @@ class StackMapStream : public ValueObject {
         location_catalog_entries_indices_(allocator->Adapter(kArenaAllocStackMapStream)),
         dex_register_locations_(allocator->Adapter(kArenaAllocStackMapStream)),
         inline_infos_(allocator->Adapter(kArenaAllocStackMapStream)),
+        stack_masks_(allocator->Adapter(kArenaAllocStackMapStream)),
         stack_mask_max_(-1),
         dex_pc_max_(0),
         register_mask_max_(0),
@@ -78,6 +79,8 @@ class StackMapStream : public ValueObject {
         inline_info_size_(0),
         dex_register_maps_size_(0),
         stack_maps_size_(0),
+        stack_mask_size_(0),
+        stack_masks_size_(0),
         dex_register_location_catalog_size_(0),
         dex_register_location_catalog_start_(0),
         dex_register_maps_start_(0),
@@ -105,12 +108,15 @@ class StackMapStream : public ValueObject {
     BitVector* live_dex_registers_mask;
     uint32_t dex_register_map_hash;
     size_t same_dex_register_map_as_;
+    uint32_t stack_mask_index;
   };
 
   struct InlineInfoEntry {
     uint32_t dex_pc;  // DexFile::kDexNoIndex for intrinsified native methods.
     uint32_t method_index;
     InvokeType invoke_type;
+    // InlineInfo::kOuterDexFileIndex for methods from the dex file of the outer method.
+    uint32_t dex_file_index;
     uint32_t num_dex_registers;
     BitVector* live_dex_registers_mask;
     size_t dex_register_locations_start_index;
@@ -129,7 +135,8 @@ class StackMapStream : public ValueObject {
   void BeginInlineInfoEntry(uint32_t method_index,
                             uint32_t dex_pc,
                             InvokeType invoke_type,
-                            uint32_t num_dex_registers);
+                            uint32_t num_dex_registers,
+                            uint32_t dex_file_index = InlineInfo::kOuterDexFileIndex);
   void EndInlineInfoEntry();
 
   size_t GetNumberOfStackMaps() const {
@@ -153,6 +160,10 @@ class StackMapStream : public ValueObject {
 
  private:
   size_t ComputeDexRegisterLocationCatalogSize() const;
+  size_t ComputeNumberOfSortedStackMaps() const;
+  // Deduplicates the stack masks and sets the stack mask index of the stack maps.
+  // Returns the number of unique stack masks.
+  size_t PrepareStackMasks(size_t number_of_stack_mask_bits);
   size_t ComputeDexRegisterMapSize(uint32_t num_dex_registers,
                                    const BitVector* live_dex_registers_mask) const;
   size_t ComputeDexRegisterMapsSize() const;
@@ -190,6 +201,8 @@ class StackMapStream : public ValueObject {
   // A set of concatenated maps of Dex register locations indices to `location_catalog_entries_`.
   ArenaVector<size_t> dex_register_locations_;
   ArenaVector<InlineInfoEntry> inline_infos_;
+  // The unique stack masks, stack_mask_size_ bytes each.
+  ArenaVector<uint8_t> stack_masks_;
   int stack_mask_max_;
   uint32_t dex_pc_max_;
   uint32_t register_mask_max_;
@@ -205,6 +218,8 @@ class StackMapStream : public ValueObject {
   size_t inline_info_size_;
   size_t dex_register_maps_size_;
   size_t stack_maps_size_;
+  size_t stack_mask_size_;
+  size_t stack_masks_size_;
   size_t dex_register_location_catalog_size_;
   size_t dex_register_location_catalog_start_;
   size_t dex_register_maps_start_;
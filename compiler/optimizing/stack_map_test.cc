@@ -26,15 +26,17 @@ namespace art {
 // Check that the stack mask of given stack map is identical
 // to the given bit vector. Returns true if they are same.
 static bool CheckStackMask(
+    const CodeInfo& code_info,
+    const CodeInfoEncoding& encoding,
     const StackMap& stack_map,
-    StackMapEncoding& encoding,
     const BitVector& bit_vector) {
-  int number_of_bits = stack_map.GetNumberOfStackMaskBits(encoding);
+  MemoryRegion stack_mask = code_info.GetStackMaskOf(stack_map, encoding);
+  int number_of_bits = stack_mask.size_in_bits();
   if (bit_vector.GetHighestBitSet() >= number_of_bits) {
     return false;
   }
   for (int i = 0; i < number_of_bits; ++i) {
-    if (stack_map.GetStackMaskBit(encoding, i) != bit_vector.IsBitSet(i)) {
+    if (stack_mask.LoadBit(i) != bit_vector.IsBitSet(i)) {
       return false;
     }
   }
@@ -80,7 +82,7 @@ TEST(StackMapTest, Test1) {
   ASSERT_EQ(64u, stack_map.GetNativePcOffset(encoding.stack_map_encoding));
   ASSERT_EQ(0x3u, stack_map.GetRegisterMask(encoding.stack_map_encoding));
 
-  ASSERT_TRUE(CheckStackMask(stack_map, encoding.stack_map_encoding, sp_mask));
+  ASSERT_TRUE(CheckStackMask(code_info, encoding, stack_map, sp_mask));
 
   ASSERT_TRUE(stack_map.HasDexRegisterMap(encoding.stack_map_encoding));
   DexRegisterMap dex_register_map =
@@ -194,7 +196,7 @@ TEST(StackMapTest, Test2) {
     ASSERT_EQ(64u, stack_map.GetNativePcOffset(encoding.stack_map_encoding));
     ASSERT_EQ(0x3u, stack_map.GetRegisterMask(encoding.stack_map_encoding));
 
-    ASSERT_TRUE(CheckStackMask(stack_map, encoding.stack_map_encoding, sp_mask1));
+    ASSERT_TRUE(CheckStackMask(code_info, encoding, stack_map, sp_mask1));
 
     ASSERT_TRUE(stack_map.HasDexRegisterMap(encoding.stack_map_encoding));
     DexRegisterMap dex_register_map =
@@ -255,7 +257,7 @@ TEST(StackMapTest, Test2) {
     ASSERT_EQ(128u, stack_map.GetNativePcOffset(encoding.stack_map_encoding));
     ASSERT_EQ(0xFFu, stack_map.GetRegisterMask(encoding.stack_map_encoding));
 
-    ASSERT_TRUE(CheckStackMask(stack_map, encoding.stack_map_encoding, sp_mask2));
+    ASSERT_TRUE(CheckStackMask(code_info, encoding, stack_map, sp_mask2));
 
     ASSERT_TRUE(stack_map.HasDexRegisterMap(encoding.stack_map_encoding));
     DexRegisterMap dex_register_map =
@@ -309,7 +311,7 @@ TEST(StackMapTest, Test2) {
     ASSERT_EQ(192u, stack_map.GetNativePcOffset(encoding.stack_map_encoding));
     ASSERT_EQ(0xABu, stack_map.GetRegisterMask(encoding.stack_map_encoding));
 
-    ASSERT_TRUE(CheckStackMask(stack_map, encoding.stack_map_encoding, sp_mask3));
+    ASSERT_TRUE(CheckStackMask(code_info, encoding, stack_map, sp_mask3));
 
     ASSERT_TRUE(stack_map.HasDexRegisterMap(encoding.stack_map_encoding));
     DexRegisterMap dex_register_map =
@@ -363,7 +365,7 @@ TEST(StackMapTest, Test2) {
     ASSERT_EQ(256u, stack_map.GetNativePcOffset(encoding.stack_map_encoding));
     ASSERT_EQ(0xCDu, stack_map.GetRegisterMask(encoding.stack_map_encoding));
 
-    ASSERT_TRUE(CheckStackMask(stack_map, encoding.stack_map_encoding, sp_mask4));
+    ASSERT_TRUE(CheckStackMask(code_info, encoding, stack_map, sp_mask4));
 
     ASSERT_TRUE(stack_map.HasDexRegisterMap(encoding.stack_map_encoding));
     DexRegisterMap dex_register_map =
@@ -658,6 +660,100 @@ TEST(StackMapTest, TestNoDexRegisterMap) {
   ASSERT_FALSE(stack_map.HasInlineInfo(encoding.stack_map_encoding));
 }
 
+TEST(StackMapTest, TestShareStackMask) {
+  ArenaPool pool;
+  ArenaAllocator arena(&pool);
+  StackMapStream stream(&arena);
+
+  ArenaBitVector sp_mask1(&arena, 0, true);
+  sp_mask1.SetBit(2);
+  sp_mask1.SetBit(12);
+  ArenaBitVector sp_mask2(&arena, 0, true);
+  sp_mask2.SetBit(3);
+  // Same bits as sp_mask1, with more storage.
+  ArenaBitVector sp_mask3(&arena, 128, true);
+  sp_mask3.SetBit(2);
+  sp_mask3.SetBit(12);
+  stream.BeginStackMapEntry(0, 16, 0x3, &sp_mask1, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(1, 32, 0x3, &sp_mask2, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(2, 48, 0x3, &sp_mask3, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(3, 64, 0x3, nullptr, 0, 0);
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = arena.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillIn(region);
+
+  CodeInfo code_info(region);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  ASSERT_EQ(4u, code_info.GetNumberOfStackMaps(encoding));
+  // The stack masks of the first and third stack maps are shared, the last one is empty.
+  ASSERT_EQ(3u, encoding.number_of_stack_masks);
+  ASSERT_EQ(2u, encoding.stack_mask_size_in_bytes);
+
+  StackMap sm0 = code_info.GetStackMapAt(0, encoding);
+  StackMap sm1 = code_info.GetStackMapAt(1, encoding);
+  StackMap sm2 = code_info.GetStackMapAt(2, encoding);
+  StackMap sm3 = code_info.GetStackMapAt(3, encoding);
+  ASSERT_TRUE(CheckStackMask(code_info, encoding, sm0, sp_mask1));
+  ASSERT_TRUE(CheckStackMask(code_info, encoding, sm1, sp_mask2));
+  ASSERT_TRUE(CheckStackMask(code_info, encoding, sm2, sp_mask3));
+  ArenaBitVector empty_mask(&arena, 0, true);
+  ASSERT_TRUE(CheckStackMask(code_info, encoding, sm3, empty_mask));
+  ASSERT_EQ(sm0.GetStackMaskIndex(encoding.stack_map_encoding),
+            sm2.GetStackMaskIndex(encoding.stack_map_encoding));
+  ASSERT_NE(sm0.GetStackMaskIndex(encoding.stack_map_encoding),
+            sm1.GetStackMaskIndex(encoding.stack_map_encoding));
+}
+
+TEST(StackMapTest, TestUnsortedNativePcOffsets) {
+  ArenaPool pool;
+  ArenaAllocator arena(&pool);
+  StackMapStream stream(&arena);
+
+  // Safepoint stack maps, sorted, with two at the same native pc offset as for OSR.
+  ArenaBitVector sp_mask(&arena, 0, false);
+  stream.BeginStackMapEntry(0, 16, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(1, 32, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(2, 32, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(3, 64, 0x3, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  // Catch stack maps, after the safepoint ones.
+  stream.BeginStackMapEntry(4, 24, 0x0, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(5, 48, 0x0, &sp_mask, 0, 0);
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = arena.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillIn(region);
+
+  CodeInfo code_info(region);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  ASSERT_EQ(6u, code_info.GetNumberOfStackMaps(encoding));
+  ASSERT_EQ(4u, encoding.number_of_sorted_stack_maps);
+
+  // Each lookup returns the first stack map with the native pc offset.
+  const uint32_t native_pc_offsets[] = { 16u, 32u, 64u, 24u, 48u };
+  const uint32_t dex_pcs[] = { 0u, 1u, 3u, 4u, 5u };
+  for (size_t i = 0; i != arraysize(native_pc_offsets); ++i) {
+    StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offsets[i], encoding);
+    ASSERT_TRUE(stack_map.IsValid());
+    ASSERT_EQ(dex_pcs[i], stack_map.GetDexPc(encoding.stack_map_encoding));
+  }
+  ASSERT_FALSE(code_info.GetStackMapForNativePcOffset(0u, encoding).IsValid());
+  ASSERT_FALSE(code_info.GetStackMapForNativePcOffset(40u, encoding).IsValid());
+  ASSERT_FALSE(code_info.GetStackMapForNativePcOffset(128u, encoding).IsValid());
+}
+
 TEST(StackMapTest, InlineTest) {
   ArenaPool pool;
   ArenaAllocator arena(&pool);
@@ -830,4 +926,42 @@ TEST(StackMapTest, InlineTest) {
   }
 }
 
+TEST(StackMapTest, InlineDexFileIndexTest) {
+  ArenaPool pool;
+  ArenaAllocator arena(&pool);
+  StackMapStream stream(&arena);
+
+  ArenaBitVector sp_mask(&arena, 0, false);
+
+  // Methods inlined from the dex file of the outer method and from other dex files.
+  stream.BeginStackMapEntry(0, 64, 0x3, &sp_mask, 0, 3);
+  stream.BeginInlineInfoEntry(42, 2, kStatic, 0);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(82, 3, kDirect, 0, /* dex_file_index */ 0);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(52, 5, kVirtual, 0, /* dex_file_index */ 5);
+  stream.EndInlineInfoEntry();
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = arena.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillIn(region);
+
+  CodeInfo ci(region);
+  CodeInfoEncoding encoding = ci.ExtractEncoding();
+  StackMap sm0 = ci.GetStackMapAt(0, encoding);
+  InlineInfo if0 = ci.GetInlineInfoOf(sm0, encoding);
+  ASSERT_EQ(3u, if0.GetDepth(encoding.inline_info_encoding));
+  ASSERT_EQ(InlineInfo::kOuterDexFileIndex,
+            if0.GetDexFileIndexAtDepth(encoding.inline_info_encoding, 0));
+  ASSERT_EQ(42u, if0.GetMethodIndexAtDepth(encoding.inline_info_encoding, 0));
+  ASSERT_EQ(0u, if0.GetDexFileIndexAtDepth(encoding.inline_info_encoding, 1));
+  ASSERT_EQ(82u, if0.GetMethodIndexAtDepth(encoding.inline_info_encoding, 1));
+  ASSERT_EQ(kDirect, if0.GetInvokeTypeAtDepth(encoding.inline_info_encoding, 1));
+  ASSERT_EQ(5u, if0.GetDexFileIndexAtDepth(encoding.inline_info_encoding, 2));
+  ASSERT_EQ(5u, if0.GetDexPcAtDepth(encoding.inline_info_encoding, 2));
+  ASSERT_EQ(kVirtual, if0.GetInvokeTypeAtDepth(encoding.inline_info_encoding, 2));
+}
+
 }  // namespace art
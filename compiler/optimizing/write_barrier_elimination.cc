@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "write_barrier_elimination.h"
+
+#include <algorithm>
+
+#include "base/arena_containers.h"
+#include "code_generator.h"
+
+namespace art {
+
+// Whether the runtime may run a GC, and so move or age the objects allocated so far, while
+// executing `instruction`.
+static bool CanTriggerGC(HInstruction* instruction) {
+  if (instruction->IsArraySet()) {
+    // Reference array stores only call the runtime for their type check, and the runtime then
+    // does the store and marks the card itself.
+    return instruction->AsArraySet()->NeedsTypeCheck();
+  }
+  return instruction->GetSideEffects().Includes(SideEffects::CanTriggerGC());
+}
+
+void WriteBarrierElimination::Run() {
+  if (!kEmitCompilerReadBarrier) {
+    return;
+  }
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    VisitBasicBlock(block);
+  }
+}
+
+void WriteBarrierElimination::VisitBasicBlock(HBasicBlock* block) {
+  // The objects allocated in the block since the last instruction that can trigger a GC.
+  ArenaVector<HInstruction*> new_objects(graph_->GetArena()->Adapter(kArenaAllocOptimization));
+  for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    HInstruction* object = nullptr;
+    if (instruction->IsInstanceFieldSet()) {
+      HInstanceFieldSet* field_set = instruction->AsInstanceFieldSet();
+      if (CodeGenerator::StoreNeedsWriteBarrier(field_set->GetFieldType(),
+                                                field_set->GetValue())) {
+        object = field_set->InputAt(0);
+      }
+    } else if (instruction->IsArraySet()) {
+      HArraySet* array_set = instruction->AsArraySet();
+      if (CodeGenerator::StoreNeedsWriteBarrier(array_set->GetComponentType(),
+                                                array_set->GetValue())) {
+        object = array_set->GetArray();
+      }
+    }
+    if (object != nullptr &&
+        std::find(new_objects.begin(), new_objects.end(), object) != new_objects.end()) {
+      if (instruction->IsInstanceFieldSet()) {
+        instruction->AsInstanceFieldSet()->ClearNeedsWriteBarrier();
+      } else {
+        instruction->AsArraySet()->ClearNeedsWriteBarrier();
+      }
+      MaybeRecordStat(MethodCompilationStat::kRemovedWriteBarrier);
+    }
+    // The allocation is itself a GC point, the object only becomes new after it.
+    if (CanTriggerGC(instruction)) {
+      new_objects.clear();
+    }
+    if (instruction->IsNewInstance() || instruction->IsNewArray()) {
+      new_objects.push_back(instruction);
+    }
+  }
+}
+
+}  // namespace art
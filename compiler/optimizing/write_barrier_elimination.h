@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_WRITE_BARRIER_ELIMINATION_H_
+#define ART_COMPILER_OPTIMIZING_WRITE_BARRIER_ELIMINATION_H_
+
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+/**
+ * Removes the card marks of reference stores into objects allocated earlier in the same
+ * block, with no instruction that can trigger a GC in between.
+ *
+ * The concurrent copying collector only scans the cards of the immune spaces, and the cards
+ * of the objects which were old at its last pause when it is generational. Allocations after
+ * a pause go to regions, or to the live stack for the non-moving spaces, that the next
+ * collection traces in full, so such an object needs no dirty card until a GC runs. Since the
+ * other collectors rescan the dirty cards of new objects to find the references written while
+ * they mark, the pass only does anything with read barriers.
+ *
+ * Runs last, after the scheduler, which may reorder the instructions of a block.
+ */
+class WriteBarrierElimination : public HOptimization {
+ public:
+  WriteBarrierElimination(HGraph* graph, OptimizingCompilerStats* stats)
+      : HOptimization(graph, kWriteBarrierEliminationPassName, stats) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kWriteBarrierEliminationPassName = "write_barrier_elimination";
+
+ private:
+  void VisitBasicBlock(HBasicBlock* block);
+
+  DISALLOW_COPY_AND_ASSIGN(WriteBarrierElimination);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_WRITE_BARRIER_ELIMINATION_H_
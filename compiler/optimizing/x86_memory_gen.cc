@@ -20,16 +20,108 @@
 namespace art {
 namespace x86 {
 
+// Whether `value`, an input of `load`, is used by `load` only, directly or through the checks
+// feeding it, so that its register is free after the load.
+static bool IsOnlyUsedByLoad(HInstruction* value, HInstruction* load) {
+  for (const HUseListNode<HInstruction*>& use : value->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (user == load) {
+      continue;
+    }
+    if ((user->IsNullCheck() || user->IsBoundsCheck() || user->IsArrayLength()) &&
+        user->GetBlock() == load->GetBlock() &&
+        IsOnlyUsedByLoad(user, load)) {
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
 /**
  * Replace instructions with memory operand forms.
  */
-class MemoryOperandVisitor : public HGraphVisitor {
+class MemoryOperandVisitor : public HGraphDelegateVisitor {
  public:
-  MemoryOperandVisitor(HGraph* graph, bool do_implicit_null_checks)
-      : HGraphVisitor(graph),
-        do_implicit_null_checks_(do_implicit_null_checks) {}
+  MemoryOperandVisitor(HGraph* graph,
+                       bool do_implicit_null_checks,
+                       bool fold_loads,
+                       OptimizingCompilerStats* stats)
+      : HGraphDelegateVisitor(graph),
+        do_implicit_null_checks_(do_implicit_null_checks),
+        fold_loads_(fold_loads),
+        stats_(stats) {}
 
  private:
+  void VisitAdd(HAdd* add) OVERRIDE { TryFoldLoad(add); }
+  void VisitSub(HSub* sub) OVERRIDE { TryFoldLoad(sub); }
+  void VisitMul(HMul* mul) OVERRIDE { TryFoldLoad(mul); }
+  void VisitAnd(HAnd* instruction) OVERRIDE { TryFoldLoad(instruction); }
+  void VisitOr(HOr* instruction) OVERRIDE { TryFoldLoad(instruction); }
+  void VisitXor(HXor* instruction) OVERRIDE { TryFoldLoad(instruction); }
+  void VisitCompare(HCompare* compare) OVERRIDE { TryFoldLoad(compare); }
+  void VisitCondition(HCondition* condition) OVERRIDE { TryFoldLoad(condition); }
+
+  static bool IsFoldableLoad(HInstruction* instruction) {
+    if (instruction->GetType() != Primitive::kPrimInt &&
+        instruction->GetType() != Primitive::kPrimLong) {
+      return false;
+    }
+    if (instruction->IsInstanceFieldGet()) {
+      return !instruction->AsInstanceFieldGet()->IsVolatile();
+    }
+    if (instruction->IsStaticFieldGet()) {
+      return !instruction->AsStaticFieldGet()->IsVolatile();
+    }
+    return instruction->IsArrayGet();
+  }
+
+  // Let the int or long load feeding `operation` be emitted as its second operand, a memory
+  // operand, when this saves its register. The load must be the only use of the value, as the
+  // operand re-reads memory, and it must come just before `operation`, so that no store is in
+  // between and the registers of its address are not kept alive across other instructions.
+  // The address must also not need more registers at `operation` than the value it replaces:
+  // an array element whose array and index both die at the load would take two.
+  void TryFoldLoad(HBinaryOperation* operation) {
+    if (!fold_loads_) {
+      return;
+    }
+    HInstruction* left = operation->GetLeft();
+    HInstruction* right = operation->GetRight();
+    if (operation->IsCommutative() && !IsFoldableLoad(right) && IsFoldableLoad(left)) {
+      if (right->IsConstant()) {
+        // Loading the value into a register and using the immediate costs the same.
+        return;
+      }
+      std::swap(left, right);
+    }
+    HInstruction* load = right;
+    if (!IsFoldableLoad(load) ||
+        load == left ||
+        Primitive::PrimitiveKind(left->GetType()) != load->GetType() ||
+        !load->HasOnlyOneNonEnvironmentUse() ||
+        load->GetNextDisregardingMoves() != operation) {
+      return;
+    }
+    size_t freed_registers = 0;
+    for (HInstruction* input : load->GetInputs()) {
+      if (!input->IsConstant() && IsOnlyUsedByLoad(input, load)) {
+        ++freed_registers;
+      }
+    }
+    if (freed_registers > 1) {
+      return;
+    }
+    if (left != operation->GetLeft()) {
+      operation->ReplaceInput(left, 0);
+      operation->ReplaceInput(load, 1);
+    }
+    load->MarkEmittedAtUseSite();
+    if (stats_ != nullptr) {
+      stats_->RecordStat(kFoldedLoadIntoMemoryOperand);
+    }
+  }
+
   void VisitBoundsCheck(HBoundsCheck* check) OVERRIDE {
     // Replace the length by the array itself, so that we can do compares to memory.
     HArrayLength* array_len = check->InputAt(1)->AsArrayLength();
@@ -66,17 +158,21 @@ class MemoryOperandVisitor : public HGraphVisitor {
   }
 
   bool do_implicit_null_checks_;
+  // Only the x86-64 code generator takes loads as memory operands.
+  bool fold_loads_;
+  OptimizingCompilerStats* stats_;
 };
 
 X86MemoryOperandGeneration::X86MemoryOperandGeneration(HGraph* graph,
                                                        OptimizingCompilerStats* stats,
                                                        CodeGenerator* codegen)
     : HOptimization(graph, kX86MemoryOperandGenerationPassName, stats),
-      do_implicit_null_checks_(codegen->GetCompilerOptions().GetImplicitNullChecks()) {
+      do_implicit_null_checks_(codegen->GetCompilerOptions().GetImplicitNullChecks()),
+      fold_loads_(codegen->GetInstructionSet() == kX86_64) {
 }
 
 void X86MemoryOperandGeneration::Run() {
-  MemoryOperandVisitor visitor(graph_, do_implicit_null_checks_);
+  MemoryOperandVisitor visitor(graph_, do_implicit_null_checks_, fold_loads_, stats_);
   visitor.VisitInsertionOrder();
 }
 
@@ -38,6 +38,7 @@ class X86MemoryOperandGeneration : public HOptimization {
 
  private:
   bool do_implicit_null_checks_;
+  bool fold_loads_;
 };
 
 }  // namespace x86
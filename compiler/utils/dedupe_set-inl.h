@@ -20,6 +20,7 @@
 #include "dedupe_set.h"
 
 #include <algorithm>
+#include <atomic>
 #include <inttypes.h>
 #include <unordered_map>
 
@@ -42,6 +43,8 @@ struct DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Stats {
   size_t collision_max = 0u;
   size_t total_probe_distance = 0u;
   size_t total_size = 0u;
+  size_t total_lookups = 0u;
+  size_t total_hits = 0u;
 };
 
 template <typename InKey,
@@ -56,7 +59,9 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
       : alloc_(alloc),
         lock_name_(lock_name),
         lock_(lock_name_.c_str()),
-        keys_() {
+        keys_(),
+        lookups_(0u),
+        hits_(0u) {
   }
 
   ~Shard() {
@@ -67,11 +72,25 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
   }
 
   const StoreKey* Add(Thread* self, size_t hash, const InKey& in_key) REQUIRES(!lock_) {
-    MutexLock lock(self, lock_);
+    lookups_.fetch_add(1u, std::memory_order_relaxed);
     HashedKey<InKey> hashed_in_key(hash, &in_key);
+    // Most keys are duplicates, so look them up under the shared lock first and only
+    // serialize with other threads when we actually need to insert.
+    {
+      ReaderMutexLock lock(self, lock_);
+      auto it = keys_.Find(hashed_in_key);
+      if (it != keys_.end()) {
+        DCHECK(it->Key() != nullptr);
+        hits_.fetch_add(1u, std::memory_order_relaxed);
+        return it->Key();
+      }
+    }
+    WriterMutexLock lock(self, lock_);
+    // Another thread may have inserted the key since we released the shared lock.
     auto it = keys_.Find(hashed_in_key);
     if (it != keys_.end()) {
       DCHECK(it->Key() != nullptr);
+      hits_.fetch_add(1u, std::memory_order_relaxed);
       return it->Key();
     }
     const StoreKey* store_key = alloc_.Copy(in_key);
@@ -83,8 +102,10 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     // HashSet<> doesn't keep entries ordered by hash, so we actually allocate memory
     // for bookkeeping while collecting the stats.
     std::unordered_map<HashType, size_t> stats;
+    global_stats->total_lookups += lookups_.load(std::memory_order_relaxed);
+    global_stats->total_hits += hits_.load(std::memory_order_relaxed);
     {
-      MutexLock lock(self, lock_);
+      ReaderMutexLock lock(self, lock_);
       // Note: The total_probe_distance will be updated with the current state.
       // It may have been higher before a re-hash.
       global_stats->total_probe_distance += keys_.TotalProbeDistance();
@@ -174,8 +195,11 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
 
   Alloc alloc_;
   const std::string lock_name_;
-  Mutex lock_;
+  ReaderWriterMutex lock_;
   HashSet<HashedKey<StoreKey>, ShardEmptyFn, ShardHashFn, ShardPred> keys_ GUARDED_BY(lock_);
+  // Statistics for DumpStats(), updated outside of the lock.
+  std::atomic<size_t> lookups_;
+  std::atomic<size_t> hits_;
 };
 
 template <typename InKey,
@@ -238,8 +262,10 @@ std::string DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::DumpS
   for (HashType shard = 0; shard < kShard; ++shard) {
     shards_[shard]->UpdateStats(self, &stats);
   }
-  return StringPrintf("%zu collisions, %zu max hash collisions, "
+  return StringPrintf("%zu/%zu hits, %zu collisions, %zu max hash collisions, "
                       "%zu/%zu probe distance, %" PRIu64 " ns hash time",
+                      stats.total_hits,
+                      stats.total_lookups,
                       stats.collision_sum,
                       stats.collision_max,
                       stats.total_probe_distance,
@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <string>
 #include <vector>
 
 #include "dedupe_set-inl.h"
@@ -86,6 +87,9 @@ TEST(DedupeSetTest, Test) {
     ASSERT_NE(array3, array1);
     ASSERT_TRUE(std::equal(test3.begin(), test3.end(), array3->begin()));
   }
+
+  std::string stats = deduplicator.DumpStats(self);
+  EXPECT_EQ(0u, stats.find("1/3 hits")) << stats;
 }
 
 }  // namespace art
@@ -400,6 +400,8 @@ class X86_64Assembler FINAL : public Assembler, public JNIMacroAssembler<Pointer
   void leal(CpuRegister dst, const Address& src);
 
   void movaps(XmmRegister dst, XmmRegister src);
+  void movups(XmmRegister dst, const Address& src);
+  void movups(const Address& dst, XmmRegister src);
 
   void movss(XmmRegister dst, const Address& src);
   void movss(const Address& dst, XmmRegister src);
@@ -435,6 +437,21 @@ class X86_64Assembler FINAL : public Assembler, public JNIMacroAssembler<Pointer
   void divsd(XmmRegister dst, XmmRegister src);
   void divsd(XmmRegister dst, const Address& src);
 
+  void addps(XmmRegister dst, XmmRegister src);
+  void subps(XmmRegister dst, XmmRegister src);
+  void mulps(XmmRegister dst, XmmRegister src);
+  void divps(XmmRegister dst, XmmRegister src);
+  void shufps(XmmRegister dst, XmmRegister src, const Immediate& imm);
+
+  void paddd(XmmRegister dst, XmmRegister src);
+  void psubd(XmmRegister dst, XmmRegister src);
+  void pmulld(XmmRegister dst, XmmRegister src);  // SSE4.1
+  void pshufd(XmmRegister dst, XmmRegister src, const Immediate& imm);
+
+  void pcmpeqw(XmmRegister dst, XmmRegister src);
+  void punpcklwd(XmmRegister dst, XmmRegister src);
+  void pmovmskb(CpuRegister dst, XmmRegister src);
+
   void cvtsi2ss(XmmRegister dst, CpuRegister src);  // Note: this is the r/m32 version.
   void cvtsi2ss(XmmRegister dst, CpuRegister src, bool is64bit);
   void cvtsi2ss(XmmRegister dst, const Address& src, bool is64bit);
@@ -680,6 +697,7 @@ class X86_64Assembler FINAL : public Assembler, public JNIMacroAssembler<Pointer
   void repe_cmpsw();
   void repe_cmpsl();
   void repe_cmpsq();
+  void rep_movsb();
   void rep_movsw();
 
   //
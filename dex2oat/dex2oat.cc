@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include "base/memory_tool.h"
 
 #include <fstream>
@@ -51,10 +52,12 @@
 #include "debug/method_debug_info.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
 #include "dex/quick_compiler_callbacks.h"
+#include "dex/verification_deps.h"
 #include "dex/verification_results.h"
 #include "dex_file-inl.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
+#include "driver/pass_statistics.h"
 #include "elf_file.h"
 #include "elf_writer.h"
 #include "elf_writer_quick.h"
@@ -85,6 +88,12 @@ namespace art {
 static constexpr size_t kDefaultMinDexFilesForSwap = 2;
 static constexpr size_t kDefaultMinDexFileCumulativeSizeForSwap = 20 * MB;
 
+// Rough estimates used to fit the compilation into --max-memory. A compiler thread can
+// hold this much arena memory while compiling a large method, and the compiled code and
+// metadata kept until the oat file is written take about this many bytes per dex byte.
+static constexpr size_t kEstimatedMemoryPerCompilerThread = 64 * MB;
+static constexpr size_t kEstimatedCompiledMemoryPerDexByte = 4;
+
 static int original_argc;
 static char** original_argv;
 
@@ -276,7 +285,8 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      Default: speed");
   UsageError("");
   UsageError("  --huge-method-max=<method-instruction-count>: threshold size for a huge");
-  UsageError("      method for compiler filter tuning.");
+  UsageError("      method for compiler filter tuning. Huge methods are compiled without");
+  UsageError("      inlining and global optimizations.");
   UsageError("      Example: --huge-method-max=%d", CompilerOptions::kDefaultHugeMethodThreshold);
   UsageError("      Default: %d", CompilerOptions::kDefaultHugeMethodThreshold);
   UsageError("");
@@ -317,8 +327,24 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --method-compile-budget=<ms>: the wall time after which the compilation of a");
+  UsageError("      method skips the remaining optional optimizations and finishes with the passes");
+  UsageError("      the code generator needs, as for huge methods. Honored only by Optimizing.");
+  UsageError("      Example: --method-compile-budget=2000");
+  UsageError("      Default: no limit");
+  UsageError("");
+  UsageError("  --compile-budget=<ms>: the wall time for compiling the methods of all the");
+  UsageError("      input dex files. Methods not compiled by then are left to the interpreter");
+  UsageError("      and the JIT.");
+  UsageError("      Example: --compile-budget=60000");
+  UsageError("      Default: no limit");
+  UsageError("");
   UsageError("  --dump-timing: display a breakdown of where time was spent");
   UsageError("");
+  UsageError("  --dump-pass-stats=<file.json>: write the cumulative time and instruction count");
+  UsageError("      changes of each compiler pass and the slowest methods to a JSON file.");
+  UsageError("      Example: --dump-pass-stats=/data/local/tmp/pass-stats.json");
+  UsageError("");
   UsageError("  --include-patch-information: Include patching information so the generated code");
   UsageError("      can have its base address moved without full recompilation.");
   UsageError("");
@@ -349,6 +375,21 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --profile-file-fd=<number>: same as --profile-file but accepts a file descriptor.");
   UsageError("      Cannot be used together with --profile-file.");
   UsageError("");
+  UsageError("  --input-oat=<file-name>: specifies an oat file compiled from an earlier version of");
+  UsageError("      the same application. Verification results are reused for the dex files that");
+  UsageError("      did not change, if the boot image and class path are the same.");
+  UsageError("      Example: --input-oat=/data/app/Calculator/oat/arm/base.odex");
+  UsageError("");
+  UsageError("  --input-verification-deps=<file-name>: specifies the verification dependencies");
+  UsageError("      written with --verification-deps when the --input-oat file was compiled.");
+  UsageError("      The --input-oat file is then also used with a different boot image or class");
+  UsageError("      path, for the dex files whose classes used from there did not change.");
+  UsageError("      Example: --input-verification-deps=/data/app/Calculator/oat/arm/base.vdeps");
+  UsageError("");
+  UsageError("  --verification-deps=<file-name>: specifies a file to write the verification");
+  UsageError("      dependencies of the output oat file to.");
+  UsageError("      Example: --verification-deps=/data/app/Calculator/oat/arm/base.vdeps");
+  UsageError("");
   UsageError("  --swap-file=<file-name>:  specifies a file to use for swap.");
   UsageError("      Example: --swap-file=/data/tmp/swap.001");
   UsageError("");
@@ -365,6 +406,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      Example: --swap-dex-count-threshold=10");
   UsageError("      Default: %zu", kDefaultMinDexFilesForSwap);
   UsageError("");
+  UsageError("  --max-memory=<size>:  specifies a memory budget in bytes. The number of compiler");
+  UsageError("      threads is reduced to fit the budget, and swap is used regardless of the");
+  UsageError("      thresholds above if the compiled code is not expected to fit in memory.");
+  UsageError("      Example: --max-memory=500000000");
+  UsageError("      Default: no limit");
+  UsageError("");
   UsageError("  --very-large-app-threshold=<size>:  specifies the minimum total dex file size in");
   UsageError("      bytes to consider the input \"very large\" and punt on the compilation.");
   UsageError("      Example: --very-large-app-threshold=100000000");
@@ -375,6 +422,11 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --app-image-file=<file-name>: specify a file name for app image.");
   UsageError("      Example: --app-image-file=/data/dalvik-cache/system@app@Calculator.apk.art");
   UsageError("");
+  UsageError("  --app-image-all-classes: put every class of the compiled dex files that could be");
+  UsageError("      linked into the app image, not only the classes listed in the profile. The");
+  UsageError("      runtime then maps these classes with their vtables, IMTs, iftables and field");
+  UsageError("      layout instead of linking them at startup.");
+  UsageError("");
   UsageError("  --multi-image: specify that separate oat and image files be generated for each "
              "input dex file.");
   UsageError("");
@@ -382,6 +434,13 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      This option is incompatible with read barriers (e.g., if dex2oat has been");
   UsageError("      built with the environment variable `ART_USE_READ_BARRIER` set to `true`).");
   UsageError("");
+  UsageError("  --server-fd=<file-descriptor>: serve compilation requests read from a connected");
+  UsageError("      socket instead of compiling once. Each request is a 32-bit size followed by");
+  UsageError("      that many bytes of NUL-terminated dex2oat arguments, and is answered with its");
+  UsageError("      32-bit exit code. Requests are compiled in forked processes one at a time,");
+  UsageError("      until the client closes the socket. Must be the only option.");
+  UsageError("      Example: --server-fd=10");
+  UsageError("");
   std::cerr << "See log for usage error information\n";
   exit(EXIT_FAILURE);
 }
@@ -517,6 +576,7 @@ class Dex2Oat FINAL {
       compiled_methods_zip_filename_(nullptr),
       compiled_methods_filename_(nullptr),
       app_image_(false),
+      app_image_all_classes_(false),
       boot_image_(false),
       multi_image_(false),
       is_host_(false),
@@ -684,6 +744,22 @@ class Dex2Oat FINAL {
       Usage("Can't have both --image and (--app-image-fd or --app-image-file)");
     }
 
+    if (app_image_all_classes_ && !IsAppImage()) {
+      Usage("--app-image-all-classes requires --app-image-fd or --app-image-file");
+    }
+
+    if (!input_oat_filename_.empty() && IsBootImage()) {
+      Usage("--input-oat should not be used with --image");
+    }
+
+    if (!input_verification_deps_filename_.empty() && input_oat_filename_.empty()) {
+      Usage("--input-verification-deps requires --input-oat");
+    }
+
+    if (!verification_deps_filename_.empty() && IsBootImage()) {
+      Usage("--verification-deps should not be used with --image");
+    }
+
     if (oat_filenames_.empty() && oat_fd_ == -1) {
       Usage("Output must be supplied with either --oat-file or --oat-fd");
     }
@@ -852,6 +928,8 @@ class Dex2Oat FINAL {
       case kMips64:
         compiler_options_->implicit_null_checks_ = true;
         compiler_options_->implicit_so_checks_ = true;
+        compiler_options_->implicit_suspend_checks_ =
+            (instruction_set_ == kArm64 || instruction_set_ == kX86_64);
         break;
 
       default:
@@ -1141,15 +1219,26 @@ class Dex2Oat FINAL {
                         "--swap-dex-count-threshold",
                         &min_dex_files_for_swap_,
                         Usage);
+      } else if (option.starts_with("--max-memory=")) {
+        ParseUintOption(option, "--max-memory", &max_memory_, Usage);
       } else if (option.starts_with("--very-large-app-threshold=")) {
         ParseUintOption(option,
                         "--very-large-app-threshold",
                         &very_large_threshold_,
                         Usage);
+      } else if (option.starts_with("--input-oat=")) {
+        input_oat_filename_ = option.substr(strlen("--input-oat=")).data();
+      } else if (option.starts_with("--input-verification-deps=")) {
+        input_verification_deps_filename_ =
+            option.substr(strlen("--input-verification-deps=")).data();
+      } else if (option.starts_with("--verification-deps=")) {
+        verification_deps_filename_ = option.substr(strlen("--verification-deps=")).data();
       } else if (option.starts_with("--app-image-file=")) {
         app_image_file_name_ = option.substr(strlen("--app-image-file=")).data();
       } else if (option.starts_with("--app-image-fd=")) {
         ParseUintOption(option, "--app-image-fd", &app_image_fd_, Usage);
+      } else if (option == "--app-image-all-classes") {
+        app_image_all_classes_ = true;
       } else if (option.starts_with("--verbose-methods=")) {
         // TODO: rather than switch off compiler logging, make all VLOG(compiler) messages
         //       conditional on having verbost methods.
@@ -1260,7 +1349,8 @@ class Dex2Oat FINAL {
   }
 
   void LoadClassProfileDescriptors() {
-    if (profile_compilation_info_ != nullptr && app_image_) {
+    // Without a set of image classes, the app image gets all the classes of the dex files.
+    if (profile_compilation_info_ != nullptr && app_image_ && !app_image_all_classes_) {
       Runtime* runtime = Runtime::Current();
       CHECK(runtime != nullptr);
       std::set<DexCacheResolvedClasses> resolved_classes(
@@ -1428,6 +1518,10 @@ class Dex2Oat FINAL {
     }
     // Note that dex2oat won't close the swap_fd_. The compiler driver's swap space will do that.
 
+    if (max_memory_ != 0u) {
+      FitIntoMemoryBudget();
+    }
+
     // If we need to downgrade the compiler-filter for size reasons, do that check now.
     if (!IsBootImage() && IsVeryLarge(dex_files_)) {
       if (!CompilerFilter::IsAsGoodAs(CompilerFilter::kVerifyAtRuntime,
@@ -1571,9 +1665,72 @@ class Dex2Oat FINAL {
                                      swap_fd_,
                                      profile_compilation_info_.get()));
     driver_->SetDexFilesForOatFile(dex_files_);
+    OpenInputOatFile();
+    driver_->SetInputOatFile(input_oat_file_.get());
+    driver_->SetInputVerificationDeps(input_verification_deps_.get());
+    if (!verification_deps_filename_.empty()) {
+      verification_deps_.reset(new VerificationDeps());
+      driver_->SetOutputVerificationDeps(verification_deps_.get());
+    }
     driver_->CompileAll(class_loader_, dex_files_, timings_);
   }
 
+  // Open the --input-oat file. It is only kept if it was compiled for the same instruction set,
+  // boot image and class path, so that only the dex files being compiled can have changed.
+  // With --input-verification-deps, the boot image and class path may differ; the compiler
+  // driver checks the classes each dex file uses from them instead.
+  void OpenInputOatFile() {
+    if (input_oat_filename_.empty()) {
+      return;
+    }
+    TimingLogger::ScopedTiming t("Open input oat file", timings_);
+    std::string error_msg;
+    std::unique_ptr<OatFile> oat_file(OatFile::Open(input_oat_filename_,
+                                                    input_oat_filename_,
+                                                    /* requested_base */ nullptr,
+                                                    /* oat_file_begin */ nullptr,
+                                                    /* executable */ false,
+                                                    /* low_4gb */ false,
+                                                    /* abs_dex_location */ nullptr,
+                                                    &error_msg));
+    if (oat_file == nullptr) {
+      LOG(WARNING) << "Failed to open input oat file " << input_oat_filename_ << ": "
+                   << error_msg;
+      return;
+    }
+    const OatHeader& oat_header = oat_file->GetOatHeader();
+    if (!input_verification_deps_filename_.empty()) {
+      std::unique_ptr<VerificationDeps> deps =
+          VerificationDeps::ReadFromFile(input_verification_deps_filename_, &error_msg);
+      if (deps == nullptr) {
+        LOG(WARNING) << "Failed to read input verification dependencies: " << error_msg;
+      } else if (deps->GetOatChecksum() != oat_header.GetChecksum()) {
+        LOG(WARNING) << "Ignoring input verification dependencies "
+                     << input_verification_deps_filename_ << " not written for "
+                     << input_oat_filename_;
+      } else if (oat_header.GetInstructionSet() == instruction_set_) {
+        input_verification_deps_ = std::move(deps);
+        input_oat_file_ = std::move(oat_file);
+        return;
+      }
+    }
+    // Oat files compiled with filters that do not depend on the boot image record no checksum.
+    uint32_t image_checksum = oat_header.GetImageFileLocationOatChecksum();
+    const char* class_path = oat_header.GetStoreValueByKey(OatHeader::kClassPathKey);
+    auto it = key_value_store_->find(OatHeader::kClassPathKey);
+    if (oat_header.GetInstructionSet() != instruction_set_ ||
+        image_checksum == 0u ||
+        image_checksum != OatFileAssistant::CalculateCombinedImageChecksum(instruction_set_) ||
+        class_path == nullptr ||
+        it == key_value_store_->end() ||
+        it->second != class_path) {
+      LOG(WARNING) << "Ignoring input oat file " << input_oat_filename_
+                   << " compiled for a different instruction set, boot image or class path";
+      return;
+    }
+    input_oat_file_ = std::move(oat_file);
+  }
+
   // Notes on the interleaving of creating the images and oat files to
   // ensure the references between the two are correct.
   //
@@ -1719,7 +1876,7 @@ class Dex2Oat FINAL {
 
         // We need to mirror the layout of the ELF file in the compressed debug-info.
         // Therefore PrepareDebugInfo() relies on the SetLoadedSectionSizes() call further above.
-        elf_writer->PrepareDebugInfo(oat_writer->GetMethodDebugInfo());
+        elf_writer->PrepareDebugInfo(oat_writer->GetMethodDebugInfo(), thread_count_);
 
         OutputStream*& rodata = rodata_[i];
         DCHECK(rodata != nullptr);
@@ -1745,6 +1902,15 @@ class Dex2Oat FINAL {
           return false;
         }
 
+        if (verification_deps_ != nullptr) {
+          verification_deps_->SetOatChecksum(oat_writer->GetOatHeader().GetChecksum());
+          std::string error_msg;
+          if (!verification_deps_->WriteToFile(verification_deps_filename_, &error_msg)) {
+            LOG(ERROR) << "Failed to write verification dependencies: " << error_msg;
+            return false;
+          }
+        }
+
         if (IsImage()) {
           // Update oat header information.
           DCHECK(image_writer_ != nullptr);
@@ -1867,6 +2033,13 @@ class Dex2Oat FINAL {
     if (dump_passes_) {
       LOG(INFO) << Dumpable<CumulativeLogger>(*driver_->GetTimingsLogger());
     }
+    if (driver_ != nullptr && driver_->GetPassStatistics() != nullptr) {
+      std::string error_msg;
+      if (!driver_->GetPassStatistics()->WriteJsonFile(compiler_options_->GetPassStatsFileName(),
+                                                       &error_msg)) {
+        LOG(ERROR) << error_msg;
+      }
+    }
   }
 
   bool IsImage() const {
@@ -1920,20 +2093,48 @@ class Dex2Oat FINAL {
   }
 
  private:
+  static size_t GetDexFilesSize(const std::vector<const DexFile*>& dex_files) {
+    size_t dex_files_size = 0;
+    for (const auto* dex_file : dex_files) {
+      dex_files_size += dex_file->GetHeader().file_size_;
+    }
+    return dex_files_size;
+  }
+
+  // Half of the memory budget is left to the compiler threads, the other half to the output.
+  bool CompiledCodeExceedsMemoryBudget(const std::vector<const DexFile*>& dex_files) const {
+    return max_memory_ != 0u &&
+        GetDexFilesSize(dex_files) * kEstimatedCompiledMemoryPerDexByte > max_memory_ / 2u;
+  }
+
+  void FitIntoMemoryBudget() {
+    size_t max_threads =
+        std::max<size_t>(1u, max_memory_ / 2u / kEstimatedMemoryPerCompilerThread);
+    if (thread_count_ > max_threads) {
+      LOG(INFO) << "Reducing the number of threads from " << thread_count_ << " to "
+          << max_threads << " to fit in " << PrettySize(max_memory_);
+      thread_count_ = max_threads;
+    }
+    if (swap_fd_ == -1 && !IsBootImage() && CompiledCodeExceedsMemoryBudget(dex_files_)) {
+      LOG(WARNING) << "Compiled code may exceed the memory budget of " << PrettySize(max_memory_)
+          << ", consider passing --swap-file or --swap-fd.";
+    }
+  }
+
   bool UseSwap(bool is_image, const std::vector<const DexFile*>& dex_files) {
     if (is_image) {
       // Don't use swap, we know generation should succeed, and we don't want to slow it down.
       return false;
     }
+    if (CompiledCodeExceedsMemoryBudget(dex_files)) {
+      // The memory budget takes precedence over the thresholds.
+      return true;
+    }
     if (dex_files.size() < min_dex_files_for_swap_) {
       // If there are less dex files than the threshold, assume it's gonna be fine.
       return false;
     }
-    size_t dex_files_size = 0;
-    for (const auto* dex_file : dex_files) {
-      dex_files_size += dex_file->GetHeader().file_size_;
-    }
-    return dex_files_size >= min_dex_file_cumulative_size_for_swap_;
+    return GetDexFilesSize(dex_files) >= min_dex_file_cumulative_size_for_swap_;
   }
 
   bool IsVeryLarge(std::vector<const DexFile*>& dex_files) {
@@ -2181,7 +2382,7 @@ class Dex2Oat FINAL {
                                                      compiler_options_.get(),
                                                      oat_file.get()));
       elf_writers_.back()->Start();
-      oat_writers_.emplace_back(new OatWriter(IsBootImage(), timings_));
+      oat_writers_.emplace_back(new OatWriter(IsBootImage(), timings_, profile_compilation_info_.get()));
     }
   }
 
@@ -2505,6 +2706,7 @@ class Dex2Oat FINAL {
   std::unique_ptr<std::unordered_set<std::string>> compiled_classes_;
   std::unique_ptr<std::unordered_set<std::string>> compiled_methods_;
   bool app_image_;
+  bool app_image_all_classes_;
   bool boot_image_;
   bool multi_image_;
   bool is_host_;
@@ -2536,12 +2738,19 @@ class Dex2Oat FINAL {
   int swap_fd_;
   size_t min_dex_files_for_swap_ = kDefaultMinDexFilesForSwap;
   size_t min_dex_file_cumulative_size_for_swap_ = kDefaultMinDexFileCumulativeSizeForSwap;
+  size_t max_memory_ = 0u;
   size_t very_large_threshold_ = std::numeric_limits<size_t>::max();
   std::string app_image_file_name_;
   int app_image_fd_;
   std::string profile_file_;
   int profile_file_fd_;
   std::unique_ptr<ProfileCompilationInfo> profile_compilation_info_;
+  std::string input_oat_filename_;
+  std::unique_ptr<OatFile> input_oat_file_;
+  std::string input_verification_deps_filename_;
+  std::unique_ptr<VerificationDeps> input_verification_deps_;
+  std::string verification_deps_filename_;
+  std::unique_ptr<VerificationDeps> verification_deps_;
   TimingLogger* timings_;
   std::unique_ptr<CumulativeLogger> compiler_phases_timings_;
   std::vector<std::vector<const DexFile*>> dex_files_per_oat_file_;
@@ -2712,9 +2921,71 @@ static int dex2oat(int argc, char** argv) {
   dex2oat->Shutdown();
   return result;
 }
+
+// Upper bound on the size of the arguments of a server request.
+static constexpr uint32_t kMaxServerRequestSize = 1 * MB;
+
+// Compile the requests read from the --server-fd socket until the client closes it. Each
+// request runs in a child forked from this process, which never creates a runtime, so that
+// requests share no class linker or compiler state but skip the exec and the library loading.
+static int Dex2OatServer(char** argv) {
+  InitLogging(argv);
+  int fd = -1;
+  ParseUintOption(StringPiece(argv[1]), "--server-fd", &fd, Usage);
+  File server(fd, /* check_usage */ false);
+  while (true) {
+    uint32_t request_size;
+    if (!server.ReadFully(&request_size, sizeof(request_size))) {
+      // The client is done.
+      return EXIT_SUCCESS;
+    }
+    if (request_size == 0u || request_size > kMaxServerRequestSize) {
+      LOG(ERROR) << "Invalid dex2oat server request size " << request_size;
+      return EXIT_FAILURE;
+    }
+    std::vector<char> request(request_size);
+    if (!server.ReadFully(request.data(), request_size)) {
+      PLOG(ERROR) << "Failed to read dex2oat server request";
+      return EXIT_FAILURE;
+    }
+    if (request.back() != '\0') {
+      LOG(ERROR) << "Unterminated dex2oat server request";
+      return EXIT_FAILURE;
+    }
+    std::vector<char*> request_argv;
+    request_argv.push_back(argv[0]);
+    for (size_t i = 0; i != request_size; i += strlen(&request[i]) + 1u) {
+      request_argv.push_back(&request[i]);
+    }
+    request_argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+      PLOG(ERROR) << "Failed to fork for dex2oat server request";
+      return EXIT_FAILURE;
+    }
+    if (pid == 0) {
+      close(fd);
+      exit(dex2oat(static_cast<int>(request_argv.size() - 1u), request_argv.data()));
+    }
+    int status = 0;
+    if (TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)) == -1) {
+      PLOG(ERROR) << "Failed to wait for dex2oat server request";
+      return EXIT_FAILURE;
+    }
+    int32_t reply = WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE;
+    if (!server.WriteFully(&reply, sizeof(reply))) {
+      PLOG(ERROR) << "Failed to reply to dex2oat server request";
+      return EXIT_FAILURE;
+    }
+  }
+}
 }  // namespace art
 
 int main(int argc, char** argv) {
+  if (argc == 2 && art::StringPiece(argv[1]).starts_with("--server-fd=")) {
+    return art::Dex2OatServer(argv);
+  }
   int result = art::dex2oat(argc, argv);
   // Everything was done, do an explicit exit here to avoid running Runtime destructors that take
   // time (bug 10645725) unless we're a debug build or running on valgrind. Note: The Dex2Oat class
@@ -24,11 +24,14 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
 #include "dex2oat_environment_test.h"
 #include "oat.h"
 #include "oat_file.h"
+#include "os.h"
 #include "utils.h"
 
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -101,7 +104,10 @@ class Dex2oatTest : public Dex2oatEnvironmentTest {
     EXPECT_EQ(expected, actual);
   }
 
-  bool Dex2Oat(const std::vector<std::string>& dex2oat_args, std::string* error_msg) {
+  // Get the full dex2oat command line for `dex2oat_args`, starting with the executable.
+  bool GetDex2OatArgs(const std::vector<std::string>& dex2oat_args,
+                      std::vector<std::string>* out_argv,
+                      std::string* error_msg) {
     Runtime* runtime = Runtime::Current();
 
     const std::vector<gc::space::ImageSpace*>& image_spaces =
@@ -155,6 +161,16 @@ class Dex2oatTest : public Dex2oatEnvironmentTest {
     CHECK(android_root != nullptr);
     argv.push_back("--android-root=" + std::string(android_root));
 
+    *out_argv = std::move(argv);
+    return true;
+  }
+
+  bool Dex2Oat(const std::vector<std::string>& dex2oat_args, std::string* error_msg) {
+    std::vector<std::string> argv;
+    if (!GetDex2OatArgs(dex2oat_args, &argv, error_msg)) {
+      return false;
+    }
+
     int link[2];
 
     if (pipe(link) == -1) {
@@ -553,4 +569,173 @@ TEST_F(Dex2oatVeryLargeTest, UseVeryLarge) {
   RunTest(CompilerFilter::kSpeed, true, { "--very-large-app-threshold=100" });
 }
 
+class Dex2oatInputOatTest : public Dex2oatTest {
+ protected:
+  // The reused verification results must yield the same class states.
+  void CheckSameClassStatus(const std::string& dex_location,
+                            const std::string& input_odex_location,
+                            const std::string& odex_location) {
+    std::string error_msg;
+    std::unique_ptr<OatFile> input_odex_file(OatFile::Open(input_odex_location.c_str(),
+                                                           input_odex_location.c_str(),
+                                                           nullptr,
+                                                           nullptr,
+                                                           false,
+                                                           /*low_4gb*/false,
+                                                           dex_location.c_str(),
+                                                           &error_msg));
+    ASSERT_TRUE(input_odex_file != nullptr) << error_msg;
+    std::unique_ptr<OatFile> odex_file(OatFile::Open(odex_location.c_str(),
+                                                     odex_location.c_str(),
+                                                     nullptr,
+                                                     nullptr,
+                                                     false,
+                                                     /*low_4gb*/false,
+                                                     dex_location.c_str(),
+                                                     &error_msg));
+    ASSERT_TRUE(odex_file != nullptr) << error_msg;
+    ASSERT_EQ(input_odex_file->GetOatDexFiles().size(), odex_file->GetOatDexFiles().size());
+    for (size_t i = 0; i != odex_file->GetOatDexFiles().size(); ++i) {
+      const OatDexFile* input_oat_dex_file = input_odex_file->GetOatDexFiles()[i];
+      const OatDexFile* oat_dex_file = odex_file->GetOatDexFiles()[i];
+      std::unique_ptr<const DexFile> dex_file = oat_dex_file->OpenDexFile(&error_msg);
+      ASSERT_TRUE(dex_file != nullptr) << error_msg;
+      uint32_t class_def_count = dex_file->NumClassDefs();
+      for (uint16_t class_def_index = 0; class_def_index < class_def_count; ++class_def_index) {
+        EXPECT_EQ(input_oat_dex_file->GetOatClass(class_def_index).GetStatus(),
+                  oat_dex_file->GetOatClass(class_def_index).GetStatus());
+        EXPECT_EQ(input_oat_dex_file->GetOatClass(class_def_index).GetType(),
+                  oat_dex_file->GetOatClass(class_def_index).GetType());
+      }
+    }
+  }
+};
+
+TEST_F(Dex2oatInputOatTest, ReuseVerificationOfUnchangedDexFile) {
+  std::string dex_location = GetScratchDir() + "/DexInputOat.jar";
+  std::string input_odex_location = GetOdexDir() + "/DexInputOat.input.odex";
+  std::string odex_location = GetOdexDir() + "/DexInputOat.odex";
+
+  Copy(GetDexSrc1(), dex_location);
+
+  GenerateOdexForTest(dex_location, input_odex_location, CompilerFilter::kSpeed);
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--input-oat=" + input_odex_location });
+
+  CheckSameClassStatus(dex_location, input_odex_location, odex_location);
+}
+
+TEST_F(Dex2oatInputOatTest, ReuseVerificationWithVerificationDeps) {
+  std::string dex_location = GetScratchDir() + "/DexInputOat.jar";
+  std::string input_odex_location = GetOdexDir() + "/DexInputOat.input.odex";
+  std::string input_vdeps_location = GetOdexDir() + "/DexInputOat.input.vdeps";
+  std::string odex_location = GetOdexDir() + "/DexInputOat.odex";
+
+  Copy(GetDexSrc1(), dex_location);
+
+  GenerateOdexForTest(dex_location,
+                      input_odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--verification-deps=" + input_vdeps_location });
+
+  ASSERT_TRUE(OS::FileExists(input_vdeps_location.c_str()));
+
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--input-oat=" + input_odex_location,
+                        "--input-verification-deps=" + input_vdeps_location });
+
+  CheckSameClassStatus(dex_location, input_odex_location, odex_location);
+}
+
+// Running out of the compile budgets leaves methods to the baseline passes or to the
+// interpreter, but still produces a valid oat file with the requested filter.
+TEST_F(Dex2oatTest, CompileBudgets) {
+  std::string dex_location = GetScratchDir() + "/DexBudget.jar";
+  std::string odex_location = GetOdexDir() + "/DexBudget.odex";
+  Copy(GetDexSrc1(), dex_location);
+
+  GenerateOdexForTest(dex_location,
+                      odex_location,
+                      CompilerFilter::kSpeed,
+                      { "--method-compile-budget=1", "--compile-budget=1" });
+}
+
+class Dex2oatServerTest : public Dex2oatTest {
+ protected:
+  // Send a request with `args` to the server and return its exit code, or -1 on I/O error.
+  int32_t Request(File* client, const std::vector<std::string>& args) {
+    std::string request;
+    for (const std::string& arg : args) {
+      request += arg;
+      request.push_back('\0');
+    }
+    uint32_t request_size = request.size();
+    int32_t reply;
+    if (!client->WriteFully(&request_size, sizeof(request_size)) ||
+        !client->WriteFully(request.data(), request_size) ||
+        !client->ReadFully(&reply, sizeof(reply))) {
+      return -1;
+    }
+    return reply;
+  }
+
+  void CompileWithServer(File* client,
+                         const std::string& dex_location,
+                         const std::string& odex_location) {
+    std::string error_msg;
+    std::vector<std::string> args;
+    ASSERT_TRUE(GetDex2OatArgs({ "--dex-file=" + dex_location, "--oat-file=" + odex_location },
+                               &args,
+                               &error_msg)) << error_msg;
+    args.erase(args.begin());  // The server passes its own executable.
+    ASSERT_EQ(0, Request(client, args));
+
+    std::unique_ptr<OatFile> odex_file(OatFile::Open(odex_location.c_str(),
+                                                     odex_location.c_str(),
+                                                     nullptr,
+                                                     nullptr,
+                                                     false,
+                                                     /*low_4gb*/false,
+                                                     dex_location.c_str(),
+                                                     &error_msg));
+    EXPECT_TRUE(odex_file != nullptr) << error_msg;
+  }
+};
+
+TEST_F(Dex2oatServerTest, SeveralRequests) {
+  std::string dex_location = GetScratchDir() + "/DexServer.jar";
+  Copy(GetDexSrc1(), dex_location);
+
+  int fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  std::string server_fd = "--server-fd=" + std::to_string(fds[1]);
+  std::string compiler = Runtime::Current()->GetCompilerExecutable();
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    close(fds[0]);
+    execl(compiler.c_str(), compiler.c_str(), server_fd.c_str(), nullptr);
+    exit(1);
+  }
+  close(fds[1]);
+  File client(fds[0], /* check_usage */ false);
+
+  CompileWithServer(&client, dex_location, GetOdexDir() + "/DexServer1.odex");
+  CompileWithServer(&client, dex_location, GetOdexDir() + "/DexServer2.odex");
+  // A failing request, here without input, does not stop the server.
+  EXPECT_EQ(EXIT_FAILURE, Request(&client, { "--oat-file=" + GetOdexDir() + "/DexServer.odex" }));
+  CompileWithServer(&client, dex_location, GetOdexDir() + "/DexServer3.odex");
+
+  // Closing the socket shuts the server down.
+  ASSERT_EQ(0, client.Close());
+  int status = 0;
+  ASSERT_EQ(pid, TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+}
+
 }  // namespace art
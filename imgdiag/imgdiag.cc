@@ -16,7 +16,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -29,6 +31,7 @@
 #include "art_method-inl.h"
 #include "base/unix_file/fd_file.h"
 #include "base/stringprintf.h"
+#include "base/time_utils.h"
 #include "gc/space/image_space.h"
 #include "gc/heap.h"
 #include "mirror/class-inl.h"
@@ -52,12 +55,16 @@ class ImgDiagDumper {
                          const ImageHeader& image_header,
                          const std::string& image_location,
                          pid_t image_diff_pid,
-                         pid_t zygote_diff_pid)
+                         pid_t zygote_diff_pid,
+                         size_t sample_count,
+                         size_t sample_interval_ms)
       : os_(os),
         image_header_(image_header),
         image_location_(image_location),
         image_diff_pid_(image_diff_pid),
-        zygote_diff_pid_(zygote_diff_pid) {}
+        zygote_diff_pid_(zygote_diff_pid),
+        sample_count_(sample_count),
+        sample_interval_ms_(sample_interval_ms) {}
 
   bool Dump() SHARED_REQUIRES(Locks::mutator_lock_) {
     std::ostream& os = *os_;
@@ -141,7 +148,14 @@ class ImgDiagDumper {
     }
 
     // Future idea: diff against zygote so we can ignore the shared dirty pages.
-    return DumpImageDiffMap(image_diff_pid, zygote_diff_pid, boot_map);
+    if (!DumpImageDiffMap(image_diff_pid, zygote_diff_pid, boot_map)) {
+      return false;
+    }
+
+    if (sample_count_ != 0) {
+      return DumpDirtyTimeline(image_diff_pid, boot_map);
+    }
+    return true;
   }
 
   static std::string PrettyFieldValue(ArtField* field, mirror::Object* obj)
@@ -830,6 +844,185 @@ class ImgDiagDumper {
     return true;
   }
 
+  // The objects or fields of one class dirtied during a timeline.
+  struct TimelineData {
+    size_t dirty_object_count = 0;
+    size_t dirty_field_count = 0;
+    // Index of the sample where this was first seen dirty.
+    size_t first_sample = 0;
+    std::string name;
+  };
+
+  // Dirty bytes are attributed to the field that contains them, identified by the class which
+  // declares it and its offset. Static fields are owned by the class object itself, all the
+  // array elements of an array class share the data offset.
+  using FieldKey = std::pair<mirror::Class*, uint32_t>;
+
+  FieldKey GetDirtyFieldKey(mirror::Object* obj, size_t byte_offset, std::string* name)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    mirror::Class* klass = obj->GetClass();
+    ArtField* field = ArtField::FindInstanceFieldWithOffset</*exact*/false>(klass, byte_offset);
+    if (field != nullptr) {
+      *name = PrettyField(field);
+      return FieldKey(field->GetDeclaringClass(), field->GetOffset().Uint32Value());
+    }
+    if (obj->IsClass()) {
+      field = ArtField::FindStaticFieldWithOffset</*exact*/false>(obj->AsClass(), byte_offset);
+      if (field != nullptr) {
+        *name = PrettyField(field);
+        return FieldKey(obj->AsClass(), field->GetOffset().Uint32Value());
+      }
+    }
+    if (klass->IsArrayClass()) {
+      Primitive::Type primitive_type = klass->GetComponentType()->GetPrimitiveType();
+      size_t data_offset =
+          mirror::Array::DataOffset(Primitive::ComponentSize(primitive_type)).Uint32Value();
+      if (byte_offset >= data_offset) {
+        *name = PrettyClass(klass) + " elements";
+        return FieldKey(klass, data_offset);
+      }
+    }
+    *name = StringPrintf("%s+%zu", PrettyClass(klass).c_str(), byte_offset);
+    return FieldKey(klass, byte_offset);
+  }
+
+  // Read the remote boot image sample_count_ times, sample_interval_ms_ apart, and report the
+  // order in which the objects get dirtied and the fields written, ranked by the number of
+  // dirty objects. The classes and fields at the top are the ones to move out of the clean
+  // image bins or to stop writing to from the framework.
+  bool DumpDirtyTimeline(pid_t image_diff_pid, const backtrace_map_t& boot_map)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    std::ostream& os = *os_;
+    constexpr size_t kMaxNewObjectsPrint = 20;
+
+    std::string file_name =
+        StringPrintf("/proc/%ld/mem", static_cast<long>(image_diff_pid));  // NOLINT [runtime/int]
+    auto map_file = std::unique_ptr<File>(OS::OpenFileForReading(file_name.c_str()));
+    if (map_file == nullptr) {
+      os << "Failed to open " << file_name << " for reading";
+      return false;
+    }
+
+    const uint8_t* begin_image_ptr = image_header_.GetImageBegin();
+    const uint8_t* end_image_ptr = begin_image_ptr +
+        image_header_.GetImageSection(ImageHeader::kSectionObjects).Size();
+    size_t boot_map_size = boot_map.end - boot_map.start;
+    size_t objects_size = std::min(static_cast<size_t>(end_image_ptr - begin_image_ptr),
+                                   boot_map_size);
+    std::vector<uint8_t> remote_contents(boot_map_size);
+
+    // Dirty byte offsets already attributed, for each dirty local object.
+    std::map<mirror::Object*, std::set<size_t>> dirty_objects;
+    std::map<mirror::Class*, TimelineData> class_data;
+    std::map<FieldKey, TimelineData> field_data;
+
+    os << "\n" << "  Dirty object timeline (" << sample_count_ << " samples, "
+       << sample_interval_ms_ << " ms apart):\n";
+    uint64_t start_ms = MilliTime();
+    for (size_t sample = 0; sample != sample_count_; ++sample) {
+      if (sample != 0) {
+        ScopedThreadSuspension sts(Thread::Current(), kSleeping);
+        usleep(sample_interval_ms_ * 1000);
+      }
+      if (!map_file->PreadFully(&remote_contents[0], boot_map_size, boot_map.start)) {
+        os << "Could not fully read file " << file_name;
+        return false;
+      }
+      uint64_t sample_ms = MilliTime() - start_ms;
+
+      size_t different_pages = 0;
+      for (size_t offset = 0; offset < boot_map_size; offset += kPageSize) {
+        size_t size = std::min(kPageSize, boot_map_size - offset);
+        if (memcmp(begin_image_ptr + offset, &remote_contents[offset], size) != 0) {
+          ++different_pages;
+        }
+      }
+
+      std::vector<mirror::Object*> new_dirty_objects;
+      size_t new_dirty_fields = 0;
+      const uint8_t* current = begin_image_ptr + RoundUp(sizeof(ImageHeader), kObjectAlignment);
+      while (current < begin_image_ptr + objects_size) {
+        mirror::Object* obj = reinterpret_cast<mirror::Object*>(const_cast<uint8_t*>(current));
+        size_t object_size = obj->SizeOf();
+        const uint8_t* current_remote = &remote_contents[current - begin_image_ptr];
+        if (memcmp(current, current_remote, object_size) != 0) {
+          auto it = dirty_objects.find(obj);
+          mirror::Class* klass = obj->GetClass();
+          if (it == dirty_objects.end()) {
+            it = dirty_objects.emplace(obj, std::set<size_t>()).first;
+            new_dirty_objects.push_back(obj);
+            TimelineData& data = class_data[klass];
+            if (data.dirty_object_count++ == 0) {
+              data.first_sample = sample;
+              data.name = PrettyClass(klass);
+            }
+          }
+          std::set<size_t>& dirty_fields = it->second;
+          for (size_t i = 0; i < object_size; ++i) {
+            if (current[i] == current_remote[i]) {
+              continue;
+            }
+            std::string name;
+            FieldKey key = GetDirtyFieldKey(obj, i, &name);
+            // The offset of the key identifies the field within the object.
+            if (!dirty_fields.insert(key.second).second) {
+              continue;
+            }
+            ++class_data[klass].dirty_field_count;
+            TimelineData& data = field_data[key];
+            if (data.dirty_object_count++ == 0) {
+              data.first_sample = sample;
+              data.name = name;
+            }
+            ++new_dirty_fields;
+          }
+        }
+        current += RoundUp(object_size, kObjectAlignment);
+      }
+
+      os << "    Sample " << sample << " (" << sample_ms << " ms): "
+         << different_pages << " different pages, "
+         << dirty_objects.size() << " dirty objects, "
+         << new_dirty_objects.size() << " newly dirty objects, "
+         << new_dirty_fields << " newly dirty fields\n";
+      for (size_t i = 0; i < new_dirty_objects.size() && i < kMaxNewObjectsPrint; ++i) {
+        mirror::Object* obj = new_dirty_objects[i];
+        os << "      " << reinterpret_cast<void*>(obj) << " "
+           << (obj->IsClass() ? "Class " + PrettyClass(obj->AsClass())
+                              : "Instance of " + PrettyClass(obj->GetClass()))
+           << "\n";
+      }
+      if (new_dirty_objects.size() > kMaxNewObjectsPrint) {
+        os << "      ... " << new_dirty_objects.size() - kMaxNewObjectsPrint << " more\n";
+      }
+    }
+
+    auto class_values = SortByValueDesc<mirror::Class*, size_t, TimelineData>(
+        class_data, [](const TimelineData& d) { return d.dirty_object_count; });
+    os << "\n" << "  Dirty classes ranked by dirty objects over the timeline:\n";
+    for (const auto& vk_pair : class_values) {
+      const TimelineData& data = class_data[vk_pair.second];
+      os << "    " << data.name << " ("
+         << "objects: " << data.dirty_object_count << ", "
+         << "dirty fields: " << data.dirty_field_count << ", "
+         << "first dirty in sample: " << data.first_sample
+         << ")\n";
+    }
+
+    auto field_values = SortByValueDesc<FieldKey, size_t, TimelineData>(
+        field_data, [](const TimelineData& d) { return d.dirty_object_count; });
+    os << "\n" << "  Dirty fields ranked by dirty objects over the timeline:\n";
+    for (const auto& vk_pair : field_values) {
+      const TimelineData& data = field_data[vk_pair.second];
+      os << "    " << data.name << " ("
+         << "objects: " << data.dirty_object_count << ", "
+         << "first dirty in sample: " << data.first_sample
+         << ")\n";
+    }
+
+    return true;
+  }
+
   // Fixup a remote pointer that we read from a foreign boot.art to point to our own memory.
   // Returned pointer will point to inside of remote_contents.
   template <typename T>
@@ -1009,6 +1202,8 @@ class ImgDiagDumper {
   const std::string image_location_;
   pid_t image_diff_pid_;  // Dump image diff against boot.art if pid is non-negative
   pid_t zygote_diff_pid_;  // Dump image diff against zygote boot.art if pid is non-negative
+  size_t sample_count_;  // Dump a dirty object timeline of that many samples if non-zero
+  size_t sample_interval_ms_;
 
   DISALLOW_COPY_AND_ASSIGN(ImgDiagDumper);
 };
@@ -1016,7 +1211,9 @@ class ImgDiagDumper {
 static int DumpImage(Runtime* runtime,
                      std::ostream* os,
                      pid_t image_diff_pid,
-                     pid_t zygote_diff_pid) {
+                     pid_t zygote_diff_pid,
+                     size_t sample_count,
+                     size_t sample_interval_ms) {
   ScopedObjectAccess soa(Thread::Current());
   gc::Heap* heap = runtime->GetHeap();
   std::vector<gc::space::ImageSpace*> image_spaces = heap->GetBootImageSpaces();
@@ -1032,7 +1229,9 @@ static int DumpImage(Runtime* runtime,
                                   image_header,
                                   image_space->GetImageLocation(),
                                   image_diff_pid,
-                                  zygote_diff_pid);
+                                  zygote_diff_pid,
+                                  sample_count,
+                                  sample_interval_ms);
     if (!img_diag_dumper.Dump()) {
       return EXIT_FAILURE;
     }
@@ -1067,6 +1266,20 @@ struct ImgDiagArgs : public CmdlineArgs {
         *error_msg = "Zygote diff pid out of range";
         return kParseError;
       }
+    } else if (option.starts_with("--sample-count=")) {
+      const char* sample_count = option.substr(strlen("--sample-count=")).data();
+
+      if (!ParseUint(sample_count, &sample_count_)) {
+        *error_msg = "Sample count out of range";
+        return kParseError;
+      }
+    } else if (option.starts_with("--sample-interval-ms=")) {
+      const char* sample_interval_ms = option.substr(strlen("--sample-interval-ms=")).data();
+
+      if (!ParseUint(sample_interval_ms, &sample_interval_ms_)) {
+        *error_msg = "Sample interval out of range";
+        return kParseError;
+      }
     } else {
       return kParseUnknownArgument;
     }
@@ -1119,6 +1332,12 @@ struct ImgDiagArgs : public CmdlineArgs {
         "  --zygote-diff-pid=<pid>: provide the PID of the zygote whose boot.art you want to diff "
         "against.\n"
         "      Example: --zygote-diff-pid=$(pid zygote)\n"
+        "  --sample-count=<count>: after the diff, read the boot.art of the diffed process\n"
+        "      <count> more times and report the order in which objects get dirtied and the\n"
+        "      classes and fields ranked by the number of objects they dirty.\n"
+        "      Example: --sample-count=60\n"
+        "  --sample-interval-ms=<ms>: the time between two samples, 1000 by default.\n"
+        "      Example: --sample-interval-ms=500\n"
         "\n";
 
     return usage;
@@ -1127,6 +1346,8 @@ struct ImgDiagArgs : public CmdlineArgs {
  public:
   pid_t image_diff_pid_ = -1;
   pid_t zygote_diff_pid_ = -1;
+  size_t sample_count_ = 0;
+  size_t sample_interval_ms_ = 1000;
 };
 
 struct ImgDiagMain : public CmdlineMain<ImgDiagArgs> {
@@ -1136,7 +1357,9 @@ struct ImgDiagMain : public CmdlineMain<ImgDiagArgs> {
     return DumpImage(runtime,
                      args_->os_,
                      args_->image_diff_pid_,
-                     args_->zygote_diff_pid_) == EXIT_SUCCESS;
+                     args_->zygote_diff_pid_,
+                     args_->sample_count_,
+                     args_->sample_interval_ms_) == EXIT_SUCCESS;
   }
 };
 
@@ -294,6 +294,7 @@ class OatDumperOptions {
                    const char* export_dex_location,
                    const char* app_image,
                    const char* app_oat,
+                   const char* stats_json,
                    uint32_t addr2instr)
     : dump_vmap_(dump_vmap),
       dump_code_info_stack_maps_(dump_code_info_stack_maps),
@@ -307,6 +308,7 @@ class OatDumperOptions {
       export_dex_location_(export_dex_location),
       app_image_(app_image),
       app_oat_(app_oat),
+      stats_json_(stats_json),
       addr2instr_(addr2instr),
       class_loader_(nullptr) {}
 
@@ -322,6 +324,7 @@ class OatDumperOptions {
   const char* const export_dex_location_;
   const char* const app_image_;
   const char* const app_oat_;
+  const char* const stats_json_;
   uint32_t addr2instr_;
   Handle<mirror::ClassLoader>* class_loader_;
 };
@@ -471,7 +474,9 @@ class OatDumper {
     cumulative.Dump(os);
     os << "\n";
 
-    if (!options_.dump_header_only_) {
+    if (options_.stats_json_ != nullptr) {
+      success = WriteStatsJson(os);
+    } else if (!options_.dump_header_only_) {
       for (size_t i = 0; i < oat_dex_files_.size(); i++) {
         const OatFile::OatDexFile* oat_dex_file = oat_dex_files_[i];
         CHECK(oat_dex_file != nullptr);
@@ -856,6 +861,191 @@ class OatDumper {
     return true;
   }
 
+  // Append the sizes of one compiled method to the --stats-json output. Only the headers and
+  // the CodeInfo encodings are read, nothing is disassembled or verified.
+  void AppendMethodStatsJson(std::string* json,
+                             const std::string& pretty_method,
+                             size_t dex_file_index,
+                             uint32_t dex_method_idx,
+                             const DexFile::CodeItem* code_item,
+                             const OatFile::OatMethod& oat_method,
+                             bool shared_code) {
+    uint32_t code_size = oat_method.GetQuickCodeSize();
+    size_t dex_bytes = (code_item != nullptr) ? code_item->insns_size_in_code_units_ * 2 : 0u;
+    size_t code_info_bytes = 0u;
+    size_t stack_maps = 0u;
+    size_t stack_map_bytes = 0u;
+    size_t stack_mask_bytes = 0u;
+    size_t inlined_frames = 0u;
+    std::set<std::pair<uint32_t, uint32_t>> inlined_methods;
+    if (IsMethodGeneratedByOptimizingCompiler(oat_method, code_item)) {
+      CodeInfo code_info(oat_method.GetVmapTable());
+      CodeInfoEncoding encoding = code_info.ExtractEncoding();
+      code_info_bytes = encoding.header_size + encoding.non_header_size;
+      stack_maps = code_info.GetNumberOfStackMaps(encoding);
+      stack_map_bytes = code_info.GetStackMapsSize(encoding);
+      stack_mask_bytes = code_info.GetStackMasksSize(encoding);
+      if (code_info.HasInlineInfo(encoding)) {
+        for (size_t i = 0; i != stack_maps; ++i) {
+          StackMap stack_map = code_info.GetStackMapAt(i, encoding);
+          if (!stack_map.HasInlineInfo(encoding.stack_map_encoding)) {
+            continue;
+          }
+          InlineInfo inline_info = code_info.GetInlineInfoOf(stack_map, encoding);
+          uint32_t depth = inline_info.GetDepth(encoding.inline_info_encoding);
+          inlined_frames += depth;
+          for (uint32_t d = 0; d != depth; ++d) {
+            inlined_methods.emplace(
+                inline_info.GetDexFileIndexAtDepth(encoding.inline_info_encoding, d),
+                inline_info.GetMethodIndexAtDepth(encoding.inline_info_encoding, d));
+          }
+        }
+      }
+    }
+
+    *json += "{\"method\":";
+    AppendJsonString(json, pretty_method.c_str());
+    StringAppendF(json,
+                  ",\"dex_file\":%zu,\"dex_method_idx\":%u,\"dex_bytes\":%zu"
+                  ",\"code_offset\":%u,\"code_bytes\":%u,\"shared_code\":%s"
+                  ",\"method_header_bytes\":%zu,\"frame_size\":%zu"
+                  ",\"core_spills\":%d,\"fp_spills\":%d"
+                  ",\"code_info_bytes\":%zu,\"stack_maps\":%zu,\"stack_map_bytes\":%zu"
+                  ",\"stack_mask_bytes\":%zu,\"inlined_frames\":%zu,\"inlined_methods\":%zu"
+                  ",\"code_to_dex_ratio\":%.3f}",
+                  dex_file_index,
+                  dex_method_idx,
+                  dex_bytes,
+                  oat_method.GetCodeOffset(),
+                  code_size,
+                  shared_code ? "true" : "false",
+                  sizeof(OatQuickMethodHeader),
+                  oat_method.GetFrameSizeInBytes(),
+                  POPCOUNT(oat_method.GetCoreSpillMask()),
+                  POPCOUNT(oat_method.GetFpSpillMask()),
+                  code_info_bytes,
+                  stack_maps,
+                  stack_map_bytes,
+                  stack_mask_bytes,
+                  inlined_frames,
+                  inlined_methods.size(),
+                  dex_bytes != 0u ? static_cast<double>(code_size) / dex_bytes : 0.0);
+  }
+
+  // Write the code size breakdown of every compiled method matching the filters to the
+  // --stats-json file, with the totals of the whole oat file. Methods sharing code with an
+  // earlier one are marked shared and not counted again in the totals.
+  bool WriteStatsJson(std::ostream& os) {
+    std::string json;
+    StringAppendF(&json, "{\n\"location\":");
+    AppendJsonString(&json, oat_file_.GetLocation().c_str());
+    StringAppendF(&json,
+                  ",\n\"instruction_set\":\"%s\",\n\"oat_file_bytes\":%zu,\n\"dex_files\":[",
+                  GetInstructionSetString(instruction_set_),
+                  oat_file_.Size());
+    for (size_t i = 0; i < oat_dex_files_.size(); i++) {
+      json += (i != 0) ? "," : "";
+      AppendJsonString(&json, oat_dex_files_[i]->GetDexFileLocation().c_str());
+    }
+    json += "],\n\"methods\":[";
+
+    std::set<uint32_t> seen_code_offsets;
+    size_t compiled_methods = 0u;
+    size_t uncompiled_methods = 0u;
+    size_t total_code_bytes = 0u;
+    size_t total_code_info_bytes = 0u;
+    size_t total_dex_bytes = 0u;
+    for (size_t i = 0; i < oat_dex_files_.size(); i++) {
+      std::string error_msg;
+      const DexFile* const dex_file = OpenDexFile(oat_dex_files_[i], &error_msg);
+      if (dex_file == nullptr) {
+        os << "Failed to open dex file '" << oat_dex_files_[i]->GetDexFileLocation() << "': "
+           << error_msg;
+        return false;
+      }
+      for (size_t class_def_index = 0;
+           class_def_index < dex_file->NumClassDefs();
+           class_def_index++) {
+        const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+        const char* descriptor = dex_file->GetClassDescriptor(class_def);
+        if (DescriptorToDot(descriptor).find(options_.class_filter_) == std::string::npos) {
+          continue;
+        }
+        const uint8_t* class_data = dex_file->GetClassData(class_def);
+        if (class_data == nullptr) {
+          continue;
+        }
+        const OatFile::OatClass oat_class = oat_dex_files_[i]->GetOatClass(class_def_index);
+        ClassDataItemIterator it(*dex_file, class_data);
+        SkipAllFields(it);
+        for (uint32_t class_method_index = 0;
+             it.HasNextDirectMethod() || it.HasNextVirtualMethod();
+             class_method_index++, it.Next()) {
+          uint32_t dex_method_idx = it.GetMemberIndex();
+          std::string method_name =
+              dex_file->GetMethodName(dex_file->GetMethodId(dex_method_idx));
+          if (method_name.find(options_.method_filter_) == std::string::npos) {
+            continue;
+          }
+          const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+          if (oat_method.GetQuickCode() == nullptr) {
+            ++uncompiled_methods;
+            continue;
+          }
+          const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+          bool shared_code = !seen_code_offsets.insert(oat_method.GetCodeOffset()).second;
+          json += (compiled_methods != 0u) ? ",\n" : "\n";
+          AppendMethodStatsJson(&json,
+                                PrettyMethod(dex_method_idx, *dex_file, true),
+                                i,
+                                dex_method_idx,
+                                code_item,
+                                oat_method,
+                                shared_code);
+          ++compiled_methods;
+          if (code_item != nullptr) {
+            total_dex_bytes += code_item->insns_size_in_code_units_ * 2;
+          }
+          if (!shared_code) {
+            total_code_bytes += oat_method.GetQuickCodeSize();
+            if (IsMethodGeneratedByOptimizingCompiler(oat_method, code_item)) {
+              CodeInfoEncoding encoding(oat_method.GetVmapTable());
+              total_code_info_bytes += encoding.header_size + encoding.non_header_size;
+            }
+          }
+        }
+      }
+    }
+    StringAppendF(&json,
+                  "\n],\n\"compiled_methods\":%zu,\n\"uncompiled_methods\":%zu"
+                  ",\n\"code_bytes\":%zu,\n\"code_info_bytes\":%zu,\n\"dex_bytes\":%zu\n}\n",
+                  compiled_methods,
+                  uncompiled_methods,
+                  total_code_bytes,
+                  total_code_info_bytes,
+                  total_dex_bytes);
+
+    std::unique_ptr<File> file(OS::CreateEmptyFile(options_.stats_json_));
+    if (file == nullptr) {
+      os << "Failed to create stats file " << options_.stats_json_ << "\n";
+      return false;
+    }
+    if (!file->WriteFully(json.data(), json.size())) {
+      os << "Failed to write stats file " << options_.stats_json_ << "\n";
+      file->Erase();
+      return false;
+    }
+    if (file->FlushCloseOrErase() != 0) {
+      os << "Failed to flush and close stats file " << options_.stats_json_ << "\n";
+      return false;
+    }
+    os << StringPrintf("Stats of %zu compiled methods written to %s\n",
+                       compiled_methods,
+                       options_.stats_json_);
+    os << std::flush;
+    return true;
+  }
+
   static void SkipAllFields(ClassDataItemIterator& it) {
     while (it.HasNextStaticField()) {
       it.Next();
@@ -1904,13 +2094,15 @@ class ImageDumper {
           ScopedIndentation indent2(&state->vios_);
           auto* resolved_fields = dex_cache->GetResolvedFields();
           for (size_t i = 0, length = dex_cache->NumResolvedFields(); i < length; ++i) {
-            auto* elem = mirror::DexCache::GetElementPtrSize(
+            mirror::FieldDexCachePair pair = mirror::DexCache::GetFieldPairPtrSize(
                 resolved_fields, i, image_pointer_size);
+            ArtField* elem = pair.field;
             size_t run = 0;
             for (size_t j = i + 1;
-                 j != length && elem == mirror::DexCache::GetElementPtrSize(resolved_fields,
-                                                                            j,
-                                                                            image_pointer_size);
+                 j != length &&
+                 elem == mirror::DexCache::GetFieldPairPtrSize(resolved_fields,
+                                                                j,
+                                                                image_pointer_size).field;
                  ++j) {
               ++run;
             }
@@ -1925,7 +2117,8 @@ class ImageDumper {
               msg = "null";
             } else if (field_section.Contains(
                 reinterpret_cast<uint8_t*>(elem) - state->image_space_.Begin())) {
-              msg = PrettyField(reinterpret_cast<ArtField*>(elem));
+              msg = StringPrintf("field_idx=%zu ", static_cast<size_t>(pair.index)) +
+                  PrettyField(elem);
             } else {
               msg = "<not in field section>";
             }
@@ -2581,6 +2774,8 @@ struct OatdumpArgs : public CmdlineArgs {
       list_methods_ = true;
     } else if (option.starts_with("--export-dex-to=")) {
       export_dex_location_ = option.substr(strlen("--export-dex-to=")).data();
+    } else if (option.starts_with("--stats-json=")) {
+      stats_json_ = option.substr(strlen("--stats-json=")).data();
     } else if (option.starts_with("--addr2instr=")) {
       if (!ParseUint(option.substr(strlen("--addr2instr=")).data(), &addr2instr_)) {
         *error_msg = "Address conversion failed";
@@ -2616,6 +2811,9 @@ struct OatdumpArgs : public CmdlineArgs {
     } else if (image_location_ != nullptr && oat_filename_ != nullptr) {
       *error_msg = "Either --image or --oat-file must be specified but not both";
       return kParseError;
+    } else if (stats_json_ != nullptr && oat_filename_ == nullptr) {
+      *error_msg = "--stats-json requires --oat-file";
+      return kParseError;
     }
 
     return kParseOk;
@@ -2683,6 +2881,10 @@ struct OatdumpArgs : public CmdlineArgs {
         "  --export-dex-to=<directory>: may be used to export oat embedded dex files.\n"
         "      Example: --export-dex-to=/data/local/tmp\n"
         "\n"
+        "  --stats-json=<file>: write the code, stack map and inlining sizes of the compiled\n"
+        "      methods as JSON instead of dumping them (can be used with filters).\n"
+        "      Example: --stats-json=/data/local/tmp/boot.oat.json\n"
+        "\n"
         "  --addr2instr=<address>: output matching method disassembled code from relative\n"
         "                          address (e.g. PC from crash dump)\n"
         "      Example: --addr2instr=0x00001a3b\n"
@@ -2709,6 +2911,7 @@ struct OatdumpArgs : public CmdlineArgs {
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
   const char* app_oat_ = nullptr;
+  const char* stats_json_ = nullptr;
 };
 
 struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
@@ -2731,6 +2934,7 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
         args_->export_dex_location_,
         args_->app_image_,
         args_->app_oat_,
+        args_->stats_json_,
         args_->addr2instr_));
 
     return (args_->boot_image_location_ != nullptr || args_->image_location_ != nullptr) &&
@@ -233,6 +233,19 @@ TEST_F(OatDumpTest, TestListMethods) {
   ASSERT_TRUE(Exec(kModeArt, {"--list-methods"}, /*list_only*/ true, &error_msg)) << error_msg;
 }
 
+TEST_F(OatDumpTest, TestStatsJson) {
+  std::string error_msg;
+  ScratchFile stats;
+  ASSERT_TRUE(Exec(kModeOat,
+                   {"--stats-json=" + stats.GetFilename()},
+                   /*list_only*/ true,
+                   &error_msg)) << error_msg;
+  std::string json;
+  ASSERT_TRUE(ReadFileToString(stats.GetFilename(), &json));
+  EXPECT_NE(json.find("\"methods\":["), std::string::npos) << json;
+  EXPECT_NE(json.find("\"code_info_bytes\":"), std::string::npos) << json;
+}
+
 TEST_F(OatDumpTest, TestSymbolize) {
   std::string error_msg;
   ASSERT_TRUE(Exec(kModeSymbolize, {}, /*list_only*/ true, &error_msg)) << error_msg;
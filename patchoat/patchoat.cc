@@ -46,6 +46,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace art {
@@ -154,6 +155,7 @@ bool PatchOat::Patch(const std::string& image_location,
                      off_t delta,
                      const std::string& output_directory,
                      InstructionSet isa,
+                     size_t thread_count,
                      TimingLogger* timings) {
   CHECK(Runtime::Current() == nullptr);
   CHECK(!image_location.empty()) << "image file must have a filename.";
@@ -178,6 +180,12 @@ bool PatchOat::Patch(const std::string& image_location,
   // Runtime::Create acquired the mutator_lock_ that is normally given away when we Runtime::Start,
   // give it away now and then switch to a more manageable ScopedObjectAccess.
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
+  // The worker threads attach to the runtime, so create the pool before taking the mutator
+  // lock. The calling thread also patches objects while it waits for the workers.
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (thread_count > 1u) {
+    thread_pool.reset(new ThreadPool("Patchoat thread pool", thread_count - 1u));
+  }
   ScopedObjectAccess soa(Thread::Current());
 
   t.NewTiming("Image and oat Patching setup");
@@ -292,7 +300,7 @@ bool PatchOat::Patch(const std::string& image_location,
       LOG(ERROR) << "Failed to patch oat file " << input_oat_file->GetPath();
       return false;
     }
-    if (!p.PatchImage(i == 0)) {
+    if (!p.PatchImage(i == 0, thread_pool.get())) {
       LOG(ERROR) << "Failed to patch image file " << input_image_filename;
       return false;
     }
@@ -622,23 +630,24 @@ void PatchOat::PatchDexFileArrays(mirror::ObjectArray<mirror::Object>* img_roots
         mirror::DexCache::SetElementPtrSize(copy_methods, j, copy, pointer_size);
       }
     }
-    ArtField** orig_fields = orig_dex_cache->GetResolvedFields();
-    ArtField** relocated_fields = RelocatedAddressOfPointer(orig_fields);
+    mirror::FieldDexCachePair* orig_fields = orig_dex_cache->GetResolvedFields();
+    mirror::FieldDexCachePair* relocated_fields = RelocatedAddressOfPointer(orig_fields);
     copy_dex_cache->SetField64<false>(
         mirror::DexCache::ResolvedFieldsOffset(),
         static_cast<int64_t>(reinterpret_cast<uintptr_t>(relocated_fields)));
     if (orig_fields != nullptr) {
-      ArtField** copy_fields = RelocatedCopyOf(orig_fields);
+      mirror::FieldDexCachePair* copy_fields = RelocatedCopyOf(orig_fields);
       for (size_t j = 0, num = orig_dex_cache->NumResolvedFields(); j != num; ++j) {
-        ArtField* orig = mirror::DexCache::GetElementPtrSize(orig_fields, j, pointer_size);
-        ArtField* copy = RelocatedAddressOfPointer(orig);
-        mirror::DexCache::SetElementPtrSize(copy_fields, j, copy, pointer_size);
+        mirror::FieldDexCachePair orig =
+            mirror::DexCache::GetFieldPairPtrSize(orig_fields, j, pointer_size);
+        mirror::FieldDexCachePair copy(RelocatedAddressOfPointer(orig.field), orig.index);
+        mirror::DexCache::SetFieldPairPtrSize(copy_fields, j, copy, pointer_size);
       }
     }
   }
 }
 
-bool PatchOat::PatchImage(bool primary_image) {
+bool PatchOat::PatchImage(bool primary_image, ThreadPool* thread_pool) {
   ImageHeader* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
   CHECK_GT(image_->Size(), sizeof(ImageHeader));
   // These are the roots from the original file.
@@ -664,14 +673,65 @@ bool PatchOat::PatchImage(bool primary_image) {
   }
 
   {
-    TimingLogger::ScopedTiming t("Walk Bitmap", timings_);
-    // Walk the bitmap.
-    WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
-    bitmap_->Walk(PatchOat::BitmapCallback, this);
+    TimingLogger::ScopedTiming t("Patch objects", timings_);
+    PatchObjects(thread_pool);
   }
   return true;
 }
 
+class PatchOat::PatchObjectsTask FINAL : public Task {
+ public:
+  PatchObjectsTask(PatchOat* patch_oat, mirror::Object* const* begin, mirror::Object* const* end)
+      : patch_oat_(patch_oat), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    for (mirror::Object* const* it = begin_; it != end_; ++it) {
+      patch_oat_->VisitObject(*it);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  PatchOat* const patch_oat_;
+  mirror::Object* const* const begin_;
+  mirror::Object* const* const end_;
+};
+
+void PatchOat::PatchObjects(ThreadPool* thread_pool) {
+  // Collect the objects first. Walking the bitmap is cheap compared to patching the objects,
+  // which we can then split between threads. Each object is only written through its own copy,
+  // except for the IfTable method arrays shared by several classes, which all of them fix up
+  // with the same values.
+  std::vector<mirror::Object*> objects;
+  {
+    ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+    bitmap_->Walk(PatchOat::CollectObjectsCallback, &objects);
+  }
+  if (thread_pool == nullptr) {
+    for (mirror::Object* obj : objects) {
+      VisitObject(obj);
+    }
+  } else {
+    // Use more tasks than threads to balance the load; object sizes vary a lot.
+    static constexpr size_t kTasksPerThread = 8u;
+    Thread* self = Thread::Current();
+    size_t num_tasks = (thread_pool->GetThreadCount() + 1u) * kTasksPerThread;
+    size_t objects_per_task = RoundUp(objects.size(), num_tasks) / num_tasks;
+    for (size_t begin = 0; begin < objects.size(); begin += objects_per_task) {
+      size_t end = std::min(begin + objects_per_task, objects.size());
+      thread_pool->AddTask(
+          self, new PatchObjectsTask(this, objects.data() + begin, objects.data() + end));
+    }
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+    thread_pool->StopWorkers(self);
+  }
+}
+
 
 void PatchOat::PatchVisitor::operator() (mirror::Object* obj, MemberOffset off,
                                          bool is_static_unused ATTRIBUTE_UNUSED) const {
@@ -690,7 +750,6 @@ void PatchOat::PatchVisitor::operator() (mirror::Class* cls ATTRIBUTE_UNUSED,
   copy_->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(off, moved_object);
 }
 
-// Called by BitmapCallback
 void PatchOat::VisitObject(mirror::Object* object) {
   mirror::Object* copy = RelocatedCopyOf(object);
   CHECK(copy != nullptr);
@@ -948,6 +1007,10 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("");
   UsageError("  --no-lock-output: Do not attempt to obtain a flock on output oat file.");
   UsageError("");
+  UsageError("  -j<number>: specifies the number of threads used for patching the image.");
+  UsageError("      Example: -j4");
+  UsageError("      Default: number of CPUs");
+  UsageError("");
   UsageError("  --dump-timings: dump out patch timing information");
   UsageError("");
   UsageError("  --no-dump-timings: do not dump out patch timing information");
@@ -990,6 +1053,7 @@ static int patchoat_image(TimingLogger& timings,
                           const std::string& output_image_filename,
                           off_t base_delta,
                           bool base_delta_set,
+                          size_t thread_count,
                           bool debug) {
   CHECK(!input_image_location.empty());
   if (output_image_filename.empty()) {
@@ -1014,7 +1078,12 @@ static int patchoat_image(TimingLogger& timings,
 
   std::string output_directory =
       output_image_filename.substr(0, output_image_filename.find_last_of("/"));
-  bool ret = PatchOat::Patch(input_image_location, base_delta, output_directory, isa, &timings);
+  bool ret = PatchOat::Patch(input_image_location,
+                             base_delta,
+                             output_directory,
+                             isa,
+                             thread_count,
+                             &timings);
 
   if (kIsDebugBuild) {
     LOG(INFO) << "Exiting with return ... " << ret;
@@ -1264,6 +1333,7 @@ static int patchoat(int argc, char **argv) {
   std::string patched_image_location;
   bool dump_timings = kIsDebugBuild;
   bool lock_output = true;
+  unsigned int thread_count = sysconf(_SC_NPROCESSORS_CONF);
 
   for (int i = 0; i < argc; ++i) {
     const StringPiece option(argv[i]);
@@ -1340,6 +1410,11 @@ static int patchoat(int argc, char **argv) {
       dump_timings = true;
     } else if (option == "--no-dump-timings") {
       dump_timings = false;
+    } else if (option.starts_with("-j")) {
+      const char* thread_count_str = option.substr(strlen("-j")).data();
+      if (!ParseUint(thread_count_str, &thread_count) || thread_count == 0u) {
+        Usage("Failed to parse -j argument '%s' as a positive integer", thread_count_str);
+      }
     } else {
       Usage("Unknown argument %s", option.data());
     }
@@ -1358,6 +1433,7 @@ static int patchoat(int argc, char **argv) {
                          output_image_filename,
                          base_delta,
                          base_delta_set,
+                         thread_count,
                          debug);
   } else {
     ret = patchoat_oat(timings,
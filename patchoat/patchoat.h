@@ -34,6 +34,7 @@ namespace art {
 class ArtMethod;
 class ImageHeader;
 class OatHeader;
+class ThreadPool;
 
 namespace mirror {
 class Object;
@@ -53,11 +54,13 @@ class PatchOat {
   static bool Patch(const std::string& art_location, off_t delta, File* art_out, InstructionSet isa,
                     TimingLogger* timings);
 
-  // Patch both the image and the oat file
+  // Patch both the image and the oat file. The objects of the images are patched by
+  // `thread_count` threads.
   static bool Patch(const std::string& art_location,
                     off_t delta,
                     const std::string& output_directory,
                     InstructionSet isa,
+                    size_t thread_count,
                     TimingLogger* timings);
 
   ~PatchOat() {}
@@ -98,11 +101,14 @@ class PatchOat {
                                         bool output_oat_opened_from_fd,
                                         bool new_oat_out);  // Output oat was newly created?
 
-  static void BitmapCallback(mirror::Object* obj, void* arg)
-      SHARED_REQUIRES(Locks::mutator_lock_) {
-    reinterpret_cast<PatchOat*>(arg)->VisitObject(obj);
+  static void CollectObjectsCallback(mirror::Object* obj, void* arg) {
+    reinterpret_cast<std::vector<mirror::Object*>*>(arg)->push_back(obj);
   }
 
+  class PatchObjectsTask;
+
+  // Patch the objects of the image, split between the threads of the pool if not null.
+  void PatchObjects(ThreadPool* thread_pool) SHARED_REQUIRES(Locks::mutator_lock_);
   void VisitObject(mirror::Object* obj)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void FixupMethod(ArtMethod* object, ArtMethod* copy)
@@ -115,7 +121,8 @@ class PatchOat {
   template <typename ElfFileImpl>
   bool PatchOatHeader(ElfFileImpl* oat_file);
 
-  bool PatchImage(bool primary_image) SHARED_REQUIRES(Locks::mutator_lock_);
+  bool PatchImage(bool primary_image, ThreadPool* thread_pool)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void PatchArtFields(const ImageHeader* image_header) SHARED_REQUIRES(Locks::mutator_lock_);
   void PatchArtMethods(const ImageHeader* image_header) SHARED_REQUIRES(Locks::mutator_lock_);
   void PatchImTables(const ImageHeader* image_header) SHARED_REQUIRES(Locks::mutator_lock_);
@@ -16,8 +16,17 @@
 
 #include "profile_assistant.h"
 
+#include <pthread.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+
+#include "base/logging.h"
 #include "base/unix_file/fd_file.h"
 #include "os.h"
+#include "safe_map.h"
 
 namespace art {
 
@@ -153,4 +162,218 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfiles(
                                  reference_profile_file_flock);
 }
 
+namespace {
+
+// The number of aggregated profiles that contain each method of a dex file.
+struct DexFileCounts {
+  explicit DexFileCounts(uint32_t location_checksum) : checksum(location_checksum) {}
+  uint32_t checksum;
+  std::map<uint16_t, uint32_t> method_counts;
+  std::set<uint16_t> class_set;
+  // The methods executed during or after startup in any of the profiles.
+  std::set<uint16_t> startup_method_set;
+  std::set<uint16_t> post_startup_method_set;
+};
+
+using ProfileCounts = SafeMap<std::string, DexFileCounts>;
+
+// Returns the counts of the given profile key, or null if it has a different checksum.
+DexFileCounts* GetOrAddDexFileCounts(const std::string& profile_key,
+                                     uint32_t checksum,
+                                     ProfileCounts* counts) {
+  auto it = counts->find(profile_key);
+  if (it == counts->end()) {
+    it = counts->Put(profile_key, DexFileCounts(checksum));
+  } else if (it->second.checksum != checksum) {
+    LOG(WARNING) << "Checksum mismatch for dex " << profile_key << ", skipping it";
+    return nullptr;
+  }
+  return &it->second;
+}
+
+// Merges the counts of src into dst.
+void MergeCounts(const ProfileCounts& src, ProfileCounts* dst) {
+  for (const auto& src_it : src) {
+    DexFileCounts* dst_counts = GetOrAddDexFileCounts(src_it.first, src_it.second.checksum, dst);
+    if (dst_counts == nullptr) {
+      continue;
+    }
+    for (const auto& method_count : src_it.second.method_counts) {
+      dst_counts->method_counts[method_count.first] += method_count.second;
+    }
+    dst_counts->class_set.insert(src_it.second.class_set.begin(), src_it.second.class_set.end());
+    dst_counts->startup_method_set.insert(src_it.second.startup_method_set.begin(),
+                                          src_it.second.startup_method_set.end());
+    dst_counts->post_startup_method_set.insert(src_it.second.post_startup_method_set.begin(),
+                                               src_it.second.post_startup_method_set.end());
+  }
+}
+
+// A node of the reduction tree. Leaves load a range of the profiles, the other nodes merge the
+// counts of another node into theirs.
+struct AggregationTask {
+  AggregationTask()
+      : profile_files(nullptr), begin(0u), end(0u), number_of_loaded_profiles(0u), other(nullptr) {}
+
+  const std::vector<std::string>* profile_files;
+  size_t begin;
+  size_t end;
+  size_t number_of_loaded_profiles;
+  ProfileCounts counts;
+  const AggregationTask* other;
+};
+
+void* LoadProfiles(void* arg) {
+  AggregationTask* task = reinterpret_cast<AggregationTask*>(arg);
+  for (size_t i = task->begin; i != task->end; ++i) {
+    const std::string& filename = (*task->profile_files)[i];
+    ScopedFlock flock;
+    std::string error;
+    ProfileCompilationInfo info;
+    if (!flock.Init(filename.c_str(), O_RDONLY, /* block */ true, &error) ||
+        !info.Load(flock.GetFile()->Fd())) {
+      // A few bad profiles should not fail the aggregation of many.
+      LOG(WARNING) << "Skipping profile " << filename << " " << error;
+      continue;
+    }
+    ++task->number_of_loaded_profiles;
+    ProfileCounts* counts = &task->counts;
+    info.VisitDexFiles([counts](const std::string& profile_key,
+                                uint32_t checksum,
+                                const std::set<uint16_t>& method_set,
+                                const std::set<uint16_t>& class_set,
+                                const std::set<uint16_t>& startup_method_set,
+                                const std::set<uint16_t>& post_startup_method_set) {
+      DexFileCounts* dex_file_counts = GetOrAddDexFileCounts(profile_key, checksum, counts);
+      if (dex_file_counts != nullptr) {
+        for (uint16_t method_idx : method_set) {
+          ++dex_file_counts->method_counts[method_idx];
+        }
+        dex_file_counts->class_set.insert(class_set.begin(), class_set.end());
+        dex_file_counts->startup_method_set.insert(startup_method_set.begin(),
+                                                   startup_method_set.end());
+        dex_file_counts->post_startup_method_set.insert(post_startup_method_set.begin(),
+                                                        post_startup_method_set.end());
+      }
+    });
+  }
+  return nullptr;
+}
+
+void* MergeProfileCounts(void* arg) {
+  AggregationTask* task = reinterpret_cast<AggregationTask*>(arg);
+  MergeCounts(task->other->counts, &task->counts);
+  task->number_of_loaded_profiles += task->other->number_of_loaded_profiles;
+  return nullptr;
+}
+
+// Runs the function on each of the given tasks in parallel, using the current thread for one.
+void RunInParallel(const std::vector<AggregationTask*>& tasks, void* (*function)(void*)) {
+  std::vector<pthread_t> threads;
+  for (size_t i = 1; i < tasks.size(); ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, function, tasks[i]) == 0) {
+      threads.push_back(thread);
+    } else {
+      PLOG(WARNING) << "Failed to create a profile aggregation thread";
+      function(tasks[i]);
+    }
+  }
+  if (!tasks.empty()) {
+    function(tasks[0]);
+  }
+  for (pthread_t thread : threads) {
+    CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "profile aggregation thread");
+  }
+}
+
+}  // namespace
+
+ProfileAssistant::ProcessingResult ProfileAssistant::AggregateProfiles(
+    const std::vector<std::string>& profile_files,
+    const std::string& output_profile_file,
+    uint32_t hot_method_percent,
+    size_t num_threads) {
+  DCHECK(!profile_files.empty());
+  DCHECK_LE(hot_method_percent, 100u);
+  num_threads = std::max<size_t>(1u, std::min(num_threads, profile_files.size()));
+
+  // Load contiguous ranges of the profiles in parallel.
+  std::vector<AggregationTask> tasks(num_threads);
+  std::vector<AggregationTask*> leaves;
+  for (size_t i = 0; i != num_threads; ++i) {
+    tasks[i].profile_files = &profile_files;
+    tasks[i].begin = profile_files.size() * i / num_threads;
+    tasks[i].end = profile_files.size() * (i + 1) / num_threads;
+    leaves.push_back(&tasks[i]);
+  }
+  RunInParallel(leaves, LoadProfiles);
+
+  // Merge the counts with a reduction tree, halving the number of counts at each level.
+  for (size_t stride = 1u; stride < num_threads; stride *= 2u) {
+    std::vector<AggregationTask*> nodes;
+    for (size_t i = 0; i + stride < num_threads; i += 2u * stride) {
+      tasks[i].other = &tasks[i + stride];
+      nodes.push_back(&tasks[i]);
+    }
+    RunInParallel(nodes, MergeProfileCounts);
+  }
+  const ProfileCounts& counts = tasks[0].counts;
+  if (tasks[0].number_of_loaded_profiles == 0u) {
+    LOG(WARNING) << "Could not load any of the " << profile_files.size() << " profiles";
+    return kErrorBadProfiles;
+  }
+
+  // Find the smallest count that keeps the requested part of the hottest methods.
+  std::vector<uint32_t> all_counts;
+  for (const auto& it : counts) {
+    for (const auto& method_count : it.second.method_counts) {
+      all_counts.push_back(method_count.second);
+    }
+  }
+  uint32_t min_count = 0u;
+  size_t number_of_hot_methods = (all_counts.size() * hot_method_percent + 99u) / 100u;
+  if (number_of_hot_methods != 0u && number_of_hot_methods < all_counts.size()) {
+    std::nth_element(all_counts.begin(),
+                     all_counts.begin() + number_of_hot_methods - 1u,
+                     all_counts.end(),
+                     std::greater<uint32_t>());
+    min_count = all_counts[number_of_hot_methods - 1u];
+  } else if (number_of_hot_methods == 0u) {
+    min_count = std::numeric_limits<uint32_t>::max();
+  }
+
+  ProfileCompilationInfo info;
+  for (const auto& it : counts) {
+    for (const auto& method_count : it.second.method_counts) {
+      if (method_count.second >= min_count) {
+        CHECK(info.AddMethodIndex(it.first, it.second.checksum, method_count.first));
+      }
+    }
+    for (uint16_t class_idx : it.second.class_set) {
+      CHECK(info.AddClassIndex(it.first, it.second.checksum, class_idx));
+    }
+    for (uint16_t method_idx : it.second.startup_method_set) {
+      CHECK(info.AddExecutedMethodIndex(
+          it.first, it.second.checksum, method_idx, /* startup */ true));
+    }
+    for (uint16_t method_idx : it.second.post_startup_method_set) {
+      CHECK(info.AddExecutedMethodIndex(
+          it.first, it.second.checksum, method_idx, /* startup */ false));
+    }
+  }
+
+  ScopedFlock flock;
+  std::string error;
+  if (!flock.Init(output_profile_file.c_str(), &error)) {
+    LOG(WARNING) << "Could not lock the output profile " << output_profile_file << ": " << error;
+    return kErrorCannotLock;
+  }
+  if (!flock.GetFile()->ClearContent() || !info.Save(flock.GetFile()->Fd())) {
+    PLOG(WARNING) << "Could not write the output profile " << output_profile_file;
+    return kErrorIO;
+  }
+  return kCompile;
+}
+
 }  // namespace art
@@ -59,6 +59,20 @@ class ProfileAssistant {
       const std::vector<int>& profile_files_fd_,
       int reference_profile_file_fd);
 
+  // Merge the given profiles into output_profile_file, replacing its content. The profiles are
+  // loaded by num_threads threads and their counts are merged with a reduction tree.
+  //
+  // Each method is counted once per profile that contains it. Only the hot_method_percent
+  // percent of the methods with the highest counts are kept, along with the methods that have
+  // the same count as the last one kept. All the classes are kept. Profiles that cannot be
+  // loaded and dex files whose checksum does not match are skipped with a warning.
+  //
+  // Returns kCompile if the output profile was written.
+  static ProcessingResult AggregateProfiles(const std::vector<std::string>& profile_files,
+                                            const std::string& output_profile_file,
+                                            uint32_t hot_method_percent,
+                                            size_t num_threads);
+
  private:
   static ProcessingResult ProcessProfilesInternal(
       const std::vector<ScopedFlock>& profile_files,
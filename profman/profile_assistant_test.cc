@@ -85,6 +85,23 @@ class ProfileAssistantTest : public CommonRuntimeTest {
     return ExecAndReturnCode(argv_str, &error);
   }
 
+  int AggregateProfiles(const std::vector<std::string>& profile_files,
+                        const std::string& output_file,
+                        uint32_t hot_method_percent,
+                        uint32_t threads) {
+    std::string profman_cmd = GetProfmanCmd();
+    std::vector<std::string> argv_str;
+    argv_str.push_back(profman_cmd);
+    for (const std::string& profile_file : profile_files) {
+      argv_str.push_back("--profile-file=" + profile_file);
+    }
+    argv_str.push_back("--aggregate-output-file=" + output_file);
+    argv_str.push_back("--aggregate-hot-method-percent=" + std::to_string(hot_method_percent));
+    argv_str.push_back("--aggregate-threads=" + std::to_string(threads));
+    std::string error;
+    return ExecAndReturnCode(argv_str, &error);
+  }
+
   bool GenerateTestProfile(const std::string& filename) {
     std::string profman_cmd = GetProfmanCmd();
     std::vector<std::string> argv_str;
@@ -295,6 +312,47 @@ TEST_F(ProfileAssistantTest, FailProcessingBecauseOfReferenceProfiles) {
   CheckProfileInfo(profile1, info1);
 }
 
+TEST_F(ProfileAssistantTest, AggregateHottestMethods) {
+  // Profile i has the methods [i, 10), so method m is in m + 1 profiles.
+  static constexpr uint16_t kNumberOfProfiles = 10;
+  std::vector<std::unique_ptr<ScratchFile>> profiles;
+  std::vector<std::string> profile_files;
+  for (uint16_t i = 0; i < kNumberOfProfiles; i++) {
+    profiles.emplace_back(new ScratchFile());
+    ProfileCompilationInfo info;
+    SetupProfile("p", /* checksum */ 1, kNumberOfProfiles - i, /* number_of_classes */ 1,
+                 *profiles.back(), &info, /* start_method_index */ i);
+    profile_files.push_back(profiles.back()->GetFilename());
+  }
+  // A bad profile is skipped.
+  ScratchFile bad_profile;
+  ASSERT_TRUE(bad_profile.GetFile()->WriteFully("bad", 3u));
+  ASSERT_EQ(0, bad_profile.GetFile()->Flush());
+  profile_files.push_back(bad_profile.GetFilename());
+
+  // Keep the 30% hottest methods, merging with more threads than profiles.
+  ScratchFile output_profile;
+  ASSERT_EQ(ProfileAssistant::kCompile,
+            AggregateProfiles(profile_files, output_profile.GetFilename(), 30, 16));
+  ProfileCompilationInfo expected;
+  for (uint16_t i = 7; i < kNumberOfProfiles; i++) {
+    ASSERT_TRUE(expected.AddMethodIndex("location1p", 1, i));
+    ASSERT_TRUE(expected.AddMethodIndex("location2p", 10, i));
+  }
+  ASSERT_TRUE(expected.AddClassIndex("location1p", 1, 0));
+  CheckProfileInfo(output_profile, expected);
+
+  // All the methods are kept by default and the result does not depend on the threads.
+  ScratchFile union_profile;
+  ASSERT_EQ(ProfileAssistant::kCompile,
+            AggregateProfiles(profile_files, union_profile.GetFilename(), 100, 3));
+  for (uint16_t i = 0; i < 7; i++) {
+    ASSERT_TRUE(expected.AddMethodIndex("location1p", 1, i));
+    ASSERT_TRUE(expected.AddMethodIndex("location2p", 10, i));
+  }
+  CheckProfileInfo(union_profile, expected);
+}
+
 TEST_F(ProfileAssistantTest, TestProfileGeneration) {
   ScratchFile profile;
   // Generate a test profile.
@@ -100,6 +100,16 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("  --reference-profile-file-fd=<number>: same as --reference-profile-file but");
   UsageError("      accepts a file descriptor. Cannot be used together with");
   UsageError("      --reference-profile-file.");
+  UsageError("");
+  UsageError("  --aggregate-output-file=<filename>: merges all --profile-file into this file,");
+  UsageError("      replacing its content, instead of comparing them with a reference profile.");
+  UsageError("      Unreadable profiles are skipped.");
+  UsageError("  --aggregate-hot-method-percent=<number>: with --aggregate-output-file, only keep");
+  UsageError("      the given percentage of the methods found in the most profiles.");
+  UsageError("      Defaults to 100.");
+  UsageError("  --aggregate-threads=<number>: the number of threads used to load and merge the");
+  UsageError("      profiles with --aggregate-output-file. Defaults to the number of CPUs.");
+  UsageError("");
   UsageError("  --generate-test-profile=<filename>: generates a random profile file for testing.");
   UsageError("  --generate-test-profile-num-dex=<number>: number of dex files that should be");
   UsageError("      included in the generated profile. Defaults to 20.");
@@ -123,6 +133,7 @@ NO_RETURN static void Usage(const char *fmt, ...) {
 static constexpr uint16_t kDefaultTestProfileNumDex = 20;
 static constexpr uint16_t kDefaultTestProfileMethodRatio = 5;
 static constexpr uint16_t kDefaultTestProfileClassRatio = 5;
+static constexpr uint32_t kDefaultAggregateHotMethodPercent = 100;
 
 class ProfMan FINAL {
  public:
@@ -133,6 +144,8 @@ class ProfMan FINAL {
       test_profile_num_dex_(kDefaultTestProfileNumDex),
       test_profile_method_ratio_(kDefaultTestProfileMethodRatio),
       test_profile_class_ratio_(kDefaultTestProfileClassRatio),
+      aggregate_hot_method_percent_(kDefaultAggregateHotMethodPercent),
+      aggregate_threads_(static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_CONF))),
       start_ns_(NanoTime()) {}
 
   ~ProfMan() {
@@ -175,6 +188,15 @@ class ProfMan FINAL {
         dex_locations_.push_back(option.substr(strlen("--dex-location=")).ToString());
       } else if (option.starts_with("--apk-fd=")) {
         ParseFdForCollection(option, "--apk-fd", &apks_fd_);
+      } else if (option.starts_with("--aggregate-output-file=")) {
+        aggregate_output_file_ = option.substr(strlen("--aggregate-output-file=")).ToString();
+      } else if (option.starts_with("--aggregate-hot-method-percent=")) {
+        ParseUintOption(option,
+                        "--aggregate-hot-method-percent",
+                        &aggregate_hot_method_percent_,
+                        Usage);
+      } else if (option.starts_with("--aggregate-threads=")) {
+        ParseUintOption(option, "--aggregate-threads", &aggregate_threads_, Usage);
       } else if (option.starts_with("--generate-test-profile=")) {
         test_profile_ = option.substr(strlen("--generate-test-profile=")).ToString();
       } else if (option.starts_with("--generate-test-profile-num-dex=")) {
@@ -210,6 +232,18 @@ class ProfMan FINAL {
       }
       return;
     }
+    if (!aggregate_output_file_.empty()) {
+      if (profile_files_.empty()) {
+        Usage("--aggregate-output-file requires --profile-file");
+      }
+      if (aggregate_hot_method_percent_ > 100) {
+        Usage("Invalid percentage for --aggregate-hot-method-percent");
+      }
+      if (aggregate_threads_ == 0) {
+        Usage("Invalid number for --aggregate-threads");
+      }
+      return;
+    }
     // --dump-only may be specified with only --reference-profiles present.
     if (!dump_only_ && !has_profiles) {
       Usage("No profile files specified.");
@@ -355,6 +389,17 @@ class ProfMan FINAL {
     return 0;
   }
 
+  ProfileAssistant::ProcessingResult AggregateProfiles() {
+    return ProfileAssistant::AggregateProfiles(profile_files_,
+                                               aggregate_output_file_,
+                                               aggregate_hot_method_percent_,
+                                               aggregate_threads_);
+  }
+
+  bool ShouldAggregateProfiles() {
+    return !aggregate_output_file_.empty();
+  }
+
   bool ShouldOnlyDumpProfile() {
     return dump_only_;
   }
@@ -415,6 +460,9 @@ class ProfMan FINAL {
   uint16_t test_profile_num_dex_;
   uint16_t test_profile_method_ratio_;
   uint16_t test_profile_class_ratio_;
+  std::string aggregate_output_file_;
+  uint32_t aggregate_hot_method_percent_;
+  uint32_t aggregate_threads_;
   uint64_t start_ns_;
 };
 
@@ -431,6 +479,9 @@ static int profman(int argc, char** argv) {
   if (profman.ShouldOnlyDumpProfile()) {
     return profman.DumpProfileInfo();
   }
+  if (profman.ShouldAggregateProfiles()) {
+    return profman.AggregateProfiles();
+  }
   // Process profile information and assess if we need to do a profile guided compilation.
   // This operation involves I/O.
   return profman.ProcessProfiles();
@@ -27,18 +27,22 @@ LIBART_COMMON_SRC_FILES := \
   base/arena_allocator.cc \
   base/arena_bit_vector.cc \
   base/bit_vector.cc \
+  base/contention_profiler.cc \
   base/file_magic.cc \
   base/hex_dump.cc \
   base/logging.cc \
   base/mutex.cc \
+  base/numa.cc \
   base/scoped_arena_allocator.cc \
   base/scoped_flock.cc \
+  base/startup_trace.cc \
   base/stringpiece.cc \
   base/stringprintf.cc \
   base/time_utils.cc \
   base/timing_logger.cc \
   base/unix_file/fd_file.cc \
   base/unix_file/random_access_file_utils.cc \
+  cha.cc \
   check_jni.cc \
   class_linker.cc \
   class_table.cc \
@@ -52,6 +56,7 @@ LIBART_COMMON_SRC_FILES := \
   elf_file.cc \
   fault_handler.cc \
   gc/allocation_record.cc \
+  gc/allocation_sampler.cc \
   gc/allocator/dlmalloc.cc \
   gc/allocator/rosalloc.cc \
   gc/accounting/bitmap.cc \
@@ -70,6 +75,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/collector/semi_space.cc \
   gc/collector/sticky_mark_sweep.cc \
   gc/gc_cause.cc \
+  gc/gc_event_log.cc \
   gc/heap.cc \
   gc/reference_processor.cc \
   gc/reference_queue.cc \
@@ -89,10 +95,13 @@ LIBART_COMMON_SRC_FILES := \
   indirect_reference_table.cc \
   instrumentation.cc \
   intern_table.cc \
+  interpreter/dispatch_profiler.cc \
   interpreter/interpreter.cc \
+  interpreter/interpreter_cache.cc \
   interpreter/interpreter_common.cc \
   interpreter/interpreter_goto_table_impl.cc \
   interpreter/interpreter_switch_impl.cc \
+  interpreter/opcode_pair_profiler.cc \
   interpreter/unstarted_runtime.cc \
   java_vm_ext.cc \
   jdwp/jdwp_event.cc \
@@ -106,6 +115,7 @@ LIBART_COMMON_SRC_FILES := \
   jit/debugger_interface.cc \
   jit/jit.cc \
   jit/jit_code_cache.cc \
+  jit/jit_logger.cc \
   jit/offline_profiling_info.cc \
   jit/profiling_info.cc \
   jit/profile_saver.cc  \
@@ -179,9 +189,12 @@ LIBART_COMMON_SRC_FILES := \
   signal_catcher.cc \
   stack.cc \
   stack_map.cc \
+  string_builder_append.cc \
+  suspend_latency_profiler.cc \
   thread.cc \
   thread_list.cc \
   thread_pool.cc \
+  thread_stack_pool.cc \
   trace.cc \
   transaction.cc \
   type_lookup_table.cc \
@@ -224,6 +237,7 @@ LIBART_COMMON_SRC_FILES += \
   entrypoints/quick/quick_jni_entrypoints.cc \
   entrypoints/quick/quick_lock_entrypoints.cc \
   entrypoints/quick/quick_math_entrypoints.cc \
+  entrypoints/quick/quick_string_builder_append_entrypoints.cc \
   entrypoints/quick/quick_thread_entrypoints.cc \
   entrypoints/quick/quick_throw_entrypoints.cc \
   entrypoints/quick/quick_trampoline_entrypoints.cc
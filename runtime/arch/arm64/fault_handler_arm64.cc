@@ -20,6 +20,7 @@
 #include <sys/ucontext.h>
 
 #include "art_method-inl.h"
+#include "atomic.h"
 #include "base/enums.h"
 #include "base/macros.h"
 #include "globals.h"
@@ -31,7 +32,7 @@
 
 extern "C" void art_quick_throw_stack_overflow();
 extern "C" void art_quick_throw_null_pointer_exception_from_signal();
-extern "C" void art_quick_implicit_suspend();
+extern "C" void art_quick_test_suspend();
 
 //
 // ARM64 specific fault handler functions.
@@ -114,56 +115,46 @@ bool NullPointerHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info, void*
 // The offset from r18 is Thread::ThreadSuspendTriggerOffset().
 // To check for a suspend check, we examine the instructions that caused
 // the fault (at PC-4 and PC).
-bool SuspensionHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info ATTRIBUTE_UNUSED,
-                               void* context) {
-  // These are the instructions to check for.  The first one is the ldr x0,[r18,#xxx]
-  // where xxx is the offset of the suspend trigger.
-  uint32_t checkinst1 = 0xf9400240 |
-      (Thread::ThreadSuspendTriggerOffset<PointerSize::k64>().Int32Value() << 7);
-  uint32_t checkinst2 = 0xf9400000;
+bool SuspensionHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info, void* context) {
+  // These are the instructions of an implicit suspend check emitted by the optimizing
+  // compiler: ldr ip0, [tr, #xxx] where xxx is the offset of the suspend trigger, directly
+  // followed by ldr wzr, [ip0], which faults on the null trigger.
+  uint32_t trigger = Thread::ThreadSuspendTriggerOffset<PointerSize::k64>().Int32Value();
+  uint32_t checkinst1 = 0xf9400270 | (trigger << 7);  // ldr x16, [x19, #trigger]
+  uint32_t checkinst2 = 0xb940021f;                   // ldr wzr, [x16]
+
+  if (info->si_addr != nullptr) {
+    // The suspend trigger is null, any other fault is not ours.
+    return false;
+  }
 
   struct ucontext *uc = reinterpret_cast<struct ucontext *>(context);
   struct sigcontext *sc = reinterpret_cast<struct sigcontext*>(&uc->uc_mcontext);
-  uint8_t* ptr2 = reinterpret_cast<uint8_t*>(sc->pc);
-  uint8_t* ptr1 = ptr2 - 4;
+  uint32_t* pc = reinterpret_cast<uint32_t*>(sc->pc);
   VLOG(signals) << "checking suspend";
 
-  uint32_t inst2 = *reinterpret_cast<uint32_t*>(ptr2);
-  VLOG(signals) << "inst2: " << std::hex << inst2 << " checkinst2: " << checkinst2;
-  if (inst2 != checkinst2) {
-    // Second instruction is not good, not ours.
+  // Both instructions are in the same method, FaultManager has checked that the pc is in
+  // generated code and the method header precedes the code.
+  if (pc[0] != checkinst2 || pc[-1] != checkinst1) {
+    VLOG(signals) << "inst: " << std::hex << pc[-1] << " " << pc[0]
+                  << " checkinst: " << checkinst1 << " " << checkinst2;
     return false;
   }
 
-  // The first instruction can a little bit up the stream due to load hoisting
-  // in the compiler.
-  uint8_t* limit = ptr1 - 80;   // Compiler will hoist to a max of 20 instructions.
-  bool found = false;
-  while (ptr1 > limit) {
-    uint32_t inst1 = *reinterpret_cast<uint32_t*>(ptr1);
-    VLOG(signals) << "inst1: " << std::hex << inst1 << " checkinst1: " << checkinst1;
-    if (inst1 == checkinst1) {
-      found = true;
-      break;
-    }
-    ptr1 -= 4;
-  }
-  if (found) {
-    VLOG(signals) << "suspend check match";
-    // This is a suspend check.  Arrange for the signal handler to return to
-    // art_quick_implicit_suspend.  Also set LR so that after the suspend check it
-    // will resume the instruction (current PC + 4).  PC points to the
-    // ldr x0,[x0,#0] instruction (r0 will be 0, set by the trigger).
-
-    sc->regs[30] = sc->pc + 4;
-    sc->pc = reinterpret_cast<uintptr_t>(art_quick_implicit_suspend);
-
-    // Now remove the suspend trigger that caused this fault.
-    Thread::Current()->RemoveSuspendTrigger();
-    VLOG(signals) << "removed suspend trigger invoking test suspend";
-    return true;
-  }
-  return false;
+  VLOG(signals) << "suspend check match";
+  // Arrange for the signal handler to return to art_quick_test_suspend, which saves all the
+  // registers. Set LR so that after the suspend check it resumes at the next instruction.
+  // The method saved its LR in its frame since it is not a leaf.
+  sc->regs[30] = sc->pc + 4;
+  sc->pc = reinterpret_cast<uintptr_t>(art_quick_test_suspend);
+
+  // Now remove the suspend trigger that caused this fault. The fence orders the removal
+  // before the flag reads of the suspend check, a request setting its flag concurrently then
+  // either sees its trigger kept or has its flag handled.
+  Thread::Current()->RemoveSuspendTrigger();
+  QuasiAtomic::ThreadFenceSequentiallyConsistent();
+  VLOG(signals) << "removed suspend trigger invoking test suspend";
+  return true;
 }
 
 bool StackOverflowHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info ATTRIBUTE_UNUSED,
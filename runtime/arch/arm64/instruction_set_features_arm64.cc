@@ -16,6 +16,11 @@
 
 #include "instruction_set_features_arm64.h"
 
+#if defined(ART_TARGET_ANDROID) && defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
 #include <fstream>
 #include <sstream>
 
@@ -52,19 +57,34 @@ const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromVariant(
   // The variants that need a fix for 843419 are the same that need a fix for 835769.
   bool needs_a53_843419_fix = needs_a53_835769_fix;
 
-  return new Arm64InstructionSetFeatures(smp, needs_a53_835769_fix, needs_a53_843419_fix);
+  // Look for variants that implement the optional CRC32 instructions. A generic ARM64 may not.
+  static const char* arm64_variants_with_crc[] = {
+      "cortex-a53", "kryo", "exynos-m1"
+  };
+  bool has_crc = FindVariantInArray(arm64_variants_with_crc,
+                                    arraysize(arm64_variants_with_crc),
+                                    variant);
+
+  return new Arm64InstructionSetFeatures(
+      smp, needs_a53_835769_fix, needs_a53_843419_fix, has_crc);
 }
 
 const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromBitmap(uint32_t bitmap) {
   bool smp = (bitmap & kSmpBitfield) != 0;
   bool is_a53 = (bitmap & kA53Bitfield) != 0;
-  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53);
+  bool has_crc = (bitmap & kCrcBitfield) != 0;
+  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53, has_crc);
 }
 
 const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromCppDefines() {
   const bool smp = true;
   const bool is_a53 = true;  // Pessimistically assume all ARM64s are A53s.
-  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53);
+#if defined(__ARM_FEATURE_CRC32)
+  const bool has_crc = true;
+#else
+  const bool has_crc = false;
+#endif
+  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53, has_crc);
 }
 
 const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromCpuInfo() {
@@ -72,6 +92,7 @@ const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromCpuInfo() {
   // the kernel puts the appropriate feature flags in here.  Sometimes it doesn't.
   bool smp = false;
   const bool is_a53 = true;  // Conservative default.
+  bool has_crc = false;
 
   std::ifstream in("/proc/cpuinfo");
   if (!in.fail()) {
@@ -83,19 +104,27 @@ const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromCpuInfo() {
         if (line.find("processor") != std::string::npos && line.find(": 1") != std::string::npos) {
           smp = true;
         }
+        if (line.find("Features") != std::string::npos && line.find(" crc32") != std::string::npos) {
+          has_crc = true;
+        }
       }
     }
     in.close();
   } else {
     LOG(ERROR) << "Failed to open /proc/cpuinfo";
   }
-  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53);
+  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53, has_crc);
 }
 
 const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromHwcap() {
   bool smp = sysconf(_SC_NPROCESSORS_CONF) > 1;
   const bool is_a53 = true;  // Pessimistically assume all ARM64s are A53s.
-  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53);
+  bool has_crc = false;
+#if defined(ART_TARGET_ANDROID) && defined(__aarch64__)
+  uint64_t hwcaps = getauxval(AT_HWCAP);
+  has_crc = (hwcaps & HWCAP_CRC32) != 0;
+#endif
+  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53, has_crc);
 }
 
 const Arm64InstructionSetFeatures* Arm64InstructionSetFeatures::FromAssembly() {
@@ -108,11 +137,14 @@ bool Arm64InstructionSetFeatures::Equals(const InstructionSetFeatures* other) co
     return false;
   }
   const Arm64InstructionSetFeatures* other_as_arm = other->AsArm64InstructionSetFeatures();
-  return fix_cortex_a53_835769_ == other_as_arm->fix_cortex_a53_835769_;
+  return fix_cortex_a53_835769_ == other_as_arm->fix_cortex_a53_835769_ &&
+      has_crc_ == other_as_arm->has_crc_;
 }
 
 uint32_t Arm64InstructionSetFeatures::AsBitmap() const {
-  return (IsSmp() ? kSmpBitfield : 0) | (fix_cortex_a53_835769_ ? kA53Bitfield : 0);
+  return (IsSmp() ? kSmpBitfield : 0) |
+      (fix_cortex_a53_835769_ ? kA53Bitfield : 0) |
+      (has_crc_ ? kCrcBitfield : 0);
 }
 
 std::string Arm64InstructionSetFeatures::GetFeatureString() const {
@@ -127,24 +159,34 @@ std::string Arm64InstructionSetFeatures::GetFeatureString() const {
   } else {
     result += ",-a53";
   }
+  if (has_crc_) {
+    result += ",crc";
+  } else {
+    result += ",-crc";
+  }
   return result;
 }
 
 const InstructionSetFeatures* Arm64InstructionSetFeatures::AddFeaturesFromSplitString(
     const bool smp, const std::vector<std::string>& features, std::string* error_msg) const {
   bool is_a53 = fix_cortex_a53_835769_;
+  bool has_crc = has_crc_;
   for (auto i = features.begin(); i != features.end(); i++) {
     std::string feature = Trim(*i);
     if (feature == "a53") {
       is_a53 = true;
     } else if (feature == "-a53") {
       is_a53 = false;
+    } else if (feature == "crc") {
+      has_crc = true;
+    } else if (feature == "-crc") {
+      has_crc = false;
     } else {
       *error_msg = StringPrintf("Unknown instruction set feature: '%s'", feature.c_str());
       return nullptr;
     }
   }
-  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53);
+  return new Arm64InstructionSetFeatures(smp, is_a53, is_a53, has_crc);
 }
 
 }  // namespace art
@@ -53,7 +53,7 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
 
   uint32_t AsBitmap() const OVERRIDE;
 
-  // Return a string of the form "a53" or "none".
+  // Return a string of the form "smp,a53,crc" or "-smp,-a53,-crc".
   std::string GetFeatureString() const OVERRIDE;
 
   // Generate code addressing Cortex-A53 erratum 835769?
@@ -66,6 +66,17 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
       return fix_cortex_a53_843419_;
   }
 
+  // Schedule code for an in-order pipeline like the Cortex-A53's? As for the errata,
+  // generic ARM64s are pessimistically assumed to be A53s.
+  bool HasInOrderPipeline() const {
+      return fix_cortex_a53_835769_;
+  }
+
+  // Are the optional CRC32 instructions of ARMv8.0 available?
+  bool HasCRC() const {
+      return has_crc_;
+  }
+
   virtual ~Arm64InstructionSetFeatures() {}
 
  protected:
@@ -75,20 +86,26 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
                                  std::string* error_msg) const OVERRIDE;
 
  private:
-  Arm64InstructionSetFeatures(bool smp, bool needs_a53_835769_fix, bool needs_a53_843419_fix)
+  Arm64InstructionSetFeatures(bool smp,
+                              bool needs_a53_835769_fix,
+                              bool needs_a53_843419_fix,
+                              bool has_crc)
       : InstructionSetFeatures(smp),
         fix_cortex_a53_835769_(needs_a53_835769_fix),
-        fix_cortex_a53_843419_(needs_a53_843419_fix) {
+        fix_cortex_a53_843419_(needs_a53_843419_fix),
+        has_crc_(has_crc) {
   }
 
   // Bitmap positions for encoding features as a bitmap.
   enum {
     kSmpBitfield = 1,
     kA53Bitfield = 2,
+    kCrcBitfield = 4,
   };
 
   const bool fix_cortex_a53_835769_;
   const bool fix_cortex_a53_843419_;
+  const bool has_crc_;
 
   DISALLOW_COPY_AND_ASSIGN(Arm64InstructionSetFeatures);
 };
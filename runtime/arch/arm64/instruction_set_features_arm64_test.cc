@@ -28,8 +28,25 @@ TEST(Arm64InstructionSetFeaturesTest, Arm64Features) {
   ASSERT_TRUE(arm64_features.get() != nullptr) << error_msg;
   EXPECT_EQ(arm64_features->GetInstructionSet(), kArm64);
   EXPECT_TRUE(arm64_features->Equals(arm64_features.get()));
-  EXPECT_STREQ("smp,a53", arm64_features->GetFeatureString().c_str());
+  EXPECT_STREQ("smp,a53,-crc", arm64_features->GetFeatureString().c_str());
   EXPECT_EQ(arm64_features->AsBitmap(), 3U);
+
+  // Build features for a Kryo processor, which has the CRC32 instructions.
+  std::unique_ptr<const InstructionSetFeatures> kryo_features(
+      InstructionSetFeatures::FromVariant(kArm64, "kryo", &error_msg));
+  ASSERT_TRUE(kryo_features.get() != nullptr) << error_msg;
+  EXPECT_TRUE(kryo_features->AsArm64InstructionSetFeatures()->HasCRC());
+  EXPECT_FALSE(kryo_features->Equals(arm64_features.get()));
+  EXPECT_STREQ("smp,-a53,crc", kryo_features->GetFeatureString().c_str());
+  EXPECT_EQ(kryo_features->AsBitmap(), 5U);
+
+  // The CRC32 instructions can also be enabled explicitly.
+  std::unique_ptr<const InstructionSetFeatures> crc_features(
+      arm64_features->AddFeaturesFromString("crc", &error_msg));
+  ASSERT_TRUE(crc_features.get() != nullptr) << error_msg;
+  EXPECT_TRUE(crc_features->AsArm64InstructionSetFeatures()->HasCRC());
+  EXPECT_STREQ("smp,a53,crc", crc_features->GetFeatureString().c_str());
+  EXPECT_EQ(crc_features->AsBitmap(), 7U);
 }
 
 }  // namespace art
@@ -86,6 +86,15 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   qpoints->pResolveString = art_quick_resolve_string;
   static_assert(!IsDirectEntrypoint(kQuickResolveString), "Non-direct C stub marked direct.");
 
+  // String builder
+  qpoints->pStringBuilderAppend = art_quick_string_builder_append;
+  static_assert(!IsDirectEntrypoint(kQuickStringBuilderAppend),
+                "Non-direct C stub marked direct.");
+
+  // Clone
+  qpoints->pCloneObject = art_quick_clone_object;
+  static_assert(!IsDirectEntrypoint(kQuickCloneObject), "Non-direct C stub marked direct.");
+
   // Field
   qpoints->pSet8Instance = art_quick_set8_instance;
   static_assert(!IsDirectEntrypoint(kQuickSet8Instance), "Non-direct C stub marked direct.");
@@ -20,6 +20,7 @@
 #include <sys/ucontext.h>
 
 #include "art_method-inl.h"
+#include "atomic.h"
 #include "base/enums.h"
 #include "base/macros.h"
 #include "globals.h"
@@ -336,25 +337,41 @@ bool NullPointerHandler::Action(int, siginfo_t* sig, void* context) {
 // The offset from fs is Thread::ThreadSuspendTriggerOffset().
 // To check for a suspend check, we examine the instructions that caused
 // the fault.
-bool SuspensionHandler::Action(int, siginfo_t*, void* context) {
-  // These are the instructions to check for.  The first one is the mov eax, fs:[xxx]
-  // where xxx is the offset of the suspend trigger.
+bool SuspensionHandler::Action(int, siginfo_t* info, void* context) {
   uint32_t trigger = Thread::ThreadSuspendTriggerOffset<kRuntimePointerSize>().Int32Value();
 
   VLOG(signals) << "Checking for suspension point";
+  struct ucontext *uc = reinterpret_cast<struct ucontext*>(context);
+  uint8_t* pc = reinterpret_cast<uint8_t*>(uc->CTX_EIP);
+  uint8_t* sp = reinterpret_cast<uint8_t*>(uc->CTX_ESP);
+
 #if defined(__x86_64__)
-  uint8_t checkinst1[] = {0x65, 0x48, 0x8b, 0x04, 0x25, static_cast<uint8_t>(trigger & 0xff),
+  // These are the instructions of an implicit suspend check emitted by the optimizing
+  // compiler: mov r11, gs:[xxx] where xxx is the offset of the suspend trigger, directly
+  // followed by test r11d, [r11], which faults on the null trigger.
+  uint8_t checkinst1[] = {0x65, 0x4c, 0x8b, 0x1c, 0x25, static_cast<uint8_t>(trigger & 0xff),
       static_cast<uint8_t>((trigger >> 8) & 0xff), 0, 0};
+  uint8_t checkinst2[] = {0x45, 0x85, 0x1b};
+
+  if (info->si_addr != nullptr) {
+    // The suspend trigger is null, any other fault is not ours.
+    return false;
+  }
+  // FaultManager has checked that the pc is in generated code, the method header precedes it.
+  if (memcmp(pc, checkinst2, sizeof(checkinst2)) != 0 ||
+      memcmp(pc - sizeof(checkinst1), checkinst1, sizeof(checkinst1)) != 0) {
+    VLOG(signals) << "Not a suspension point";
+    return false;
+  }
+  uintptr_t retaddr = reinterpret_cast<uintptr_t>(pc + sizeof(checkinst2));
 #else
+  UNUSED(info);
+  // These are the instructions to check for.  The first one is the mov eax, fs:[xxx]
+  // where xxx is the offset of the suspend trigger.
   uint8_t checkinst1[] = {0x64, 0x8b, 0x05, static_cast<uint8_t>(trigger & 0xff),
       static_cast<uint8_t>((trigger >> 8) & 0xff), 0, 0};
-#endif
   uint8_t checkinst2[] = {0x85, 0x00};
 
-  struct ucontext *uc = reinterpret_cast<struct ucontext*>(context);
-  uint8_t* pc = reinterpret_cast<uint8_t*>(uc->CTX_EIP);
-  uint8_t* sp = reinterpret_cast<uint8_t*>(uc->CTX_ESP);
-
   if (pc[0] != checkinst2[0] || pc[1] != checkinst2[1]) {
     // Second instruction is not correct (test eax,[eax]).
     VLOG(signals) << "Not a suspension point";
@@ -373,30 +390,31 @@ bool SuspensionHandler::Action(int, siginfo_t*, void* context) {
     }
     ptr -= 1;
   }
+  if (!found) {
+    VLOG(signals) << "Not a suspend check match, first instruction mismatch";
+    return false;
+  }
+  uintptr_t retaddr = reinterpret_cast<uintptr_t>(pc + 2);
+#endif
 
-  if (found) {
-    VLOG(signals) << "suspend check match";
-
-    // We need to arrange for the signal handler to return to the null pointer
-    // exception generator.  The return address must be the address of the
-    // next instruction (this instruction + 2).  The return address
-    // is on the stack at the top address of the current frame.
+  VLOG(signals) << "suspend check match";
 
-    // Push the return address onto the stack.
-    uintptr_t retaddr = reinterpret_cast<uintptr_t>(pc + 2);
-    uintptr_t* next_sp = reinterpret_cast<uintptr_t*>(sp - sizeof(uintptr_t));
-    *next_sp = retaddr;
-    uc->CTX_ESP = reinterpret_cast<uintptr_t>(next_sp);
+  // We need to arrange for the signal handler to return to art_quick_test_suspend, which
+  // saves all the registers. The return address must be the address of the next instruction.
+  // Push the return address onto the stack.
+  uintptr_t* next_sp = reinterpret_cast<uintptr_t*>(sp - sizeof(uintptr_t));
+  *next_sp = retaddr;
+  uc->CTX_ESP = reinterpret_cast<uintptr_t>(next_sp);
 
-    uc->CTX_EIP = reinterpret_cast<uintptr_t>(art_quick_test_suspend);
+  uc->CTX_EIP = reinterpret_cast<uintptr_t>(art_quick_test_suspend);
 
-    // Now remove the suspend trigger that caused this fault.
-    Thread::Current()->RemoveSuspendTrigger();
-    VLOG(signals) << "removed suspend trigger invoking test suspend";
-    return true;
-  }
-  VLOG(signals) << "Not a suspend check match, first instruction mismatch";
-  return false;
+  // Now remove the suspend trigger that caused this fault. The fence orders the removal
+  // before the flag reads of the suspend check, a request setting its flag concurrently then
+  // either sees its trigger kept or has its flag handled.
+  Thread::Current()->RemoveSuspendTrigger();
+  QuasiAtomic::ThreadFenceSequentiallyConsistent();
+  VLOG(signals) << "removed suspend trigger invoking test suspend";
+  return true;
 }
 
 // The stack overflow check is done using the following instruction:
@@ -188,11 +188,10 @@ uint32_t ArtMethod::FindDexMethodIndexInOtherDexFile(const DexFile& other_dexfil
 uint32_t ArtMethod::FindCatchBlock(Handle<mirror::Class> exception_type,
                                    uint32_t dex_pc, bool* has_no_move_exception) {
   const DexFile::CodeItem* code_item = GetCodeItem();
-  // Set aside the exception while we resolve its type.
+  if (code_item->tries_size_ == 0) {
+    return DexFile::kDexNoIndex;
+  }
   Thread* self = Thread::Current();
-  StackHandleScope<1> hs(self);
-  Handle<mirror::Throwable> exception(hs.NewHandle(self->GetException()));
-  self->ClearException();
   // Default to handler not found.
   uint32_t found_dex_pc = DexFile::kDexNoIndex;
   // Iterate over the catch handlers associated with dex_pc.
@@ -204,21 +203,36 @@ uint32_t ArtMethod::FindCatchBlock(Handle<mirror::Class> exception_type,
       found_dex_pc = it.GetHandlerAddress();
       break;
     }
-    // Does this catch exception type apply?
+    // Does this catch exception type apply? The type is usually in the dex cache already.
     mirror::Class* iter_exception_type = GetClassFromTypeIndex(iter_type_idx,
-                                                               true /* resolve */,
+                                                               false /* resolve */,
                                                                pointer_size);
-    if (UNLIKELY(iter_exception_type == nullptr)) {
-      // Now have a NoClassDefFoundError as exception. Ignore in case the exception class was
-      // removed by a pro-guard like tool.
-      // Note: this is not RI behavior. RI would have failed when loading the class.
+    if (iter_exception_type == nullptr) {
+      // Set aside the exception while we resolve its type.
+      StackHandleScope<1> hs(self);
+      Handle<mirror::Throwable> exception(hs.NewHandle(self->GetException()));
       self->ClearException();
-      // Delete any long jump context as this routine is called during a stack walk which will
-      // release its in use context at the end.
-      delete self->GetLongJumpContext();
-      LOG(WARNING) << "Unresolved exception class when finding catch block: "
-        << DescriptorToDot(GetTypeDescriptorFromTypeIdx(iter_type_idx));
-    } else if (iter_exception_type->IsAssignableFrom(exception_type.Get())) {
+      iter_exception_type = GetClassFromTypeIndex(iter_type_idx,
+                                                  true /* resolve */,
+                                                  pointer_size);
+      if (UNLIKELY(iter_exception_type == nullptr)) {
+        // Now have a NoClassDefFoundError as exception. Ignore in case the exception class was
+        // removed by a pro-guard like tool.
+        // Note: this is not RI behavior. RI would have failed when loading the class.
+        self->ClearException();
+        // Delete any long jump context as this routine is called during a stack walk which will
+        // release its in use context at the end.
+        delete self->GetLongJumpContext();
+        LOG(WARNING) << "Unresolved exception class when finding catch block: "
+          << DescriptorToDot(GetTypeDescriptorFromTypeIdx(iter_type_idx));
+      }
+      // Put the exception back.
+      if (exception.Get() != nullptr) {
+        self->SetException(exception.Get());
+      }
+    }
+    if (iter_exception_type != nullptr &&
+        iter_exception_type->IsAssignableFrom(exception_type.Get())) {
       found_dex_pc = it.GetHandlerAddress();
       break;
     }
@@ -228,10 +242,6 @@ uint32_t ArtMethod::FindCatchBlock(Handle<mirror::Class> exception_type,
         Instruction::At(&code_item->insns_[found_dex_pc]);
     *has_no_move_exception = (first_catch_instr->Opcode() != Instruction::MOVE_EXCEPTION);
   }
-  // Put the exception back.
-  if (exception.Get() != nullptr) {
-    self->SetException(exception.Get());
-  }
   return found_dex_pc;
 }
 
@@ -316,7 +326,8 @@ void ArtMethod::Invoke(Thread* self, uint32_t* args, uint32_t args_size, JValue*
 
 void ArtMethod::RegisterNative(const void* native_method, bool is_fast) {
   CHECK(IsNative()) << PrettyMethod(this);
-  CHECK(!IsFastNative()) << PrettyMethod(this);
+  // Methods annotated with @FastNative are fast before they are registered.
+  CHECK(!is_fast || !IsFastNative()) << PrettyMethod(this);
   CHECK(native_method != nullptr) << PrettyMethod(this);
   if (is_fast) {
     SetAccessFlags(GetAccessFlags() | kAccFastNative);
@@ -325,8 +336,8 @@ void ArtMethod::RegisterNative(const void* native_method, bool is_fast) {
 }
 
 void ArtMethod::UnregisterNative() {
-  CHECK(IsNative() && !IsFastNative()) << PrettyMethod(this);
-  // restore stub to lookup native pointer via dlsym
+  CHECK(IsNative()) << PrettyMethod(this);
+  // restore stub to lookup native pointer via dlsym, which also handles fast native methods.
   RegisterNative(GetJniDlsymLookupStub(), false);
 }
 
@@ -406,8 +417,13 @@ const OatQuickMethodHeader* ArtMethod::GetOatQuickMethodHeader(uintptr_t pc) {
     }
   }
 
-  // Check whether the pc is in the JIT code cache.
+  // Check whether the pc is in the JIT code cache. A downcall that is not a generic JNI one
+  // goes through the JNI stub of the entrypoint. Prefer a JIT compiled stub over the oat file.
   jit::Jit* jit = Runtime::Current()->GetJit();
+  if (pc == 0 && IsNative() && jit != nullptr &&
+      jit->GetCodeCache()->ContainsPc(existing_entry_point)) {
+    return OatQuickMethodHeader::FromEntryPoint(existing_entry_point);
+  }
   if (jit != nullptr) {
     jit::JitCodeCache* code_cache = jit->GetCodeCache();
     OatQuickMethodHeader* method_header = code_cache->LookupMethodHeader(pc, this);
@@ -375,6 +375,22 @@ class ArtMethod FINAL {
     return (GetAccessFlags() & kAccMustCountLocks) != 0;
   }
 
+  // Returns true if no loaded class overrides this virtual method. Only maintained at
+  // runtime by the class hierarchy analysis, under Locks::cha_lock_ once the declaring
+  // class is linked.
+  bool HasSingleImplementation() {
+    return (GetAccessFlags() & kAccSingleImplementation) != 0;
+  }
+
+  void SetHasSingleImplementation(bool single_impl) {
+    uint32_t access_flags = GetAccessFlags();
+    if (single_impl) {
+      SetAccessFlags(access_flags | kAccSingleImplementation);
+    } else {
+      SetAccessFlags(access_flags & ~kAccSingleImplementation);
+    }
+  }
+
   // Returns true if this method could be overridden by a default method.
   bool IsOverridableByDefaultMethod() SHARED_REQUIRES(Locks::mutator_lock_);
 
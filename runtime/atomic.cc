@@ -28,7 +28,7 @@ Mutex* QuasiAtomic::GetSwapMutex(const volatile int64_t* addr) {
 }
 
 void QuasiAtomic::Startup() {
-  if (NeedSwapMutexes(kRuntimeISA)) {
+  if (NeedSwapMutexes(kRuntimeISA) || NeedSwapMutexes128(kRuntimeISA)) {
     gSwapMutexes = new std::vector<Mutex*>;
     for (size_t i = 0; i < kSwapMutexCount; ++i) {
       gSwapMutexes->push_back(new Mutex("QuasiAtomic stripe", kSwapMutexesLock));
@@ -37,7 +37,7 @@ void QuasiAtomic::Startup() {
 }
 
 void QuasiAtomic::Shutdown() {
-  if (NeedSwapMutexes(kRuntimeISA)) {
+  if (NeedSwapMutexes(kRuntimeISA) || NeedSwapMutexes128(kRuntimeISA)) {
     STLDeleteElements(gSwapMutexes);
     delete gSwapMutexes;
   }
@@ -63,4 +63,16 @@ bool QuasiAtomic::SwapMutexCas64(int64_t old_value, int64_t new_value, volatile
   return false;
 }
 
+void QuasiAtomic::SwapMutexRead128(volatile const int64_t* addr, int64_t* first, int64_t* second) {
+  MutexLock mu(Thread::Current(), *GetSwapMutex(addr));
+  *first = addr[0];
+  *second = addr[1];
+}
+
+void QuasiAtomic::SwapMutexWrite128(volatile int64_t* addr, int64_t first, int64_t second) {
+  MutexLock mu(Thread::Current(), *GetSwapMutex(addr));
+  addr[0] = first;
+  addr[1] = second;
+}
+
 }  // namespace art
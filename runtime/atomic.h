@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "arch/instruction_set.h"
+#include "base/bit_utils.h"
 #include "base/logging.h"
 #include "base/macros.h"
 
@@ -50,6 +51,10 @@ class QuasiAtomic {
     return (isa == kMips) || (isa == kMips64);
   }
 
+  static constexpr bool NeedSwapMutexes128(InstructionSet isa) {
+    return (isa != kArm64) && (isa != kX86_64);
+  }
+
  public:
   static void Startup();
 
@@ -131,6 +136,78 @@ class QuasiAtomic {
     }
   }
 
+  // Reads the two 64-bit values at the 16-byte aligned "addr" without tearing.
+  static void Read128(volatile const int64_t* addr, int64_t* first, int64_t* second) {
+    DCHECK_ALIGNED(addr, 16u);
+    if (!NeedSwapMutexes128(kRuntimeISA)) {
+#if defined(__aarch64__)
+      // A lone ldxp is only single-copy atomic when paired with a successful stxp.
+      int64_t lo;
+      int64_t hi;
+      uint32_t status;
+      do {
+        __asm__ __volatile__("// QuasiAtomic::Read128\n"
+          "ldxp     %0, %1, %3\n"
+          "stxp     %w2, %0, %1, %3"
+          : "=&r" (lo), "=&r" (hi), "=&r" (status), "+Q" (*const_cast<volatile int64_t*>(addr))
+          :
+          : "memory");
+      } while (UNLIKELY(status != 0));
+      *first = lo;
+      *second = hi;
+#elif defined(__x86_64__)
+      // A compare-exchange of zero with zero leaves memory unchanged and loads the old value.
+      int64_t lo = 0;
+      int64_t hi = 0;
+      __asm__ __volatile__("lock cmpxchg16b %2"
+        : "+a" (lo), "+d" (hi), "+m" (*const_cast<volatile int64_t*>(addr))
+        : "b" (INT64_C(0)), "c" (INT64_C(0))
+        : "cc", "memory");
+      *first = lo;
+      *second = hi;
+#else
+      LOG(FATAL) << "Unsupported architecture";
+#endif
+    } else {
+      SwapMutexRead128(addr, first, second);
+    }
+  }
+
+  // Writes the two 64-bit values at the 16-byte aligned "addr" without tearing.
+  static void Write128(volatile int64_t* addr, int64_t first, int64_t second) {
+    DCHECK_ALIGNED(addr, 16u);
+    if (!NeedSwapMutexes128(kRuntimeISA)) {
+#if defined(__aarch64__)
+      int64_t prev_lo;
+      int64_t prev_hi;
+      uint32_t status;
+      do {
+        __asm__ __volatile__("// QuasiAtomic::Write128\n"
+          "ldxp     %0, %1, %3\n"
+          "stlxp    %w2, %4, %5, %3"
+          : "=&r" (prev_lo), "=&r" (prev_hi), "=&r" (status), "+Q" (*addr)
+          : "r" (first), "r" (second)
+          : "memory");
+      } while (UNLIKELY(status != 0));
+#elif defined(__x86_64__)
+      int64_t expected_lo = addr[0];
+      int64_t expected_hi = addr[1];
+      bool success;
+      do {
+        __asm__ __volatile__("lock cmpxchg16b %1\n"
+          "sete     %0"
+          : "=q" (success), "+m" (*addr), "+a" (expected_lo), "+d" (expected_hi)
+          : "b" (first), "c" (second)
+          : "cc", "memory");
+      } while (!success);
+#else
+      LOG(FATAL) << "Unsupported architecture";
+#endif
+    } else {
+      SwapMutexWrite128(addr, first, second);
+    }
+  }
+
   // Atomically compare the value at "addr" to "old_value", if equal replace it with "new_value"
   // and return true. Otherwise, don't swap, and return false.
   // This is fully ordered, i.e. it has C++11 memory_order_seq_cst
@@ -176,6 +253,8 @@ class QuasiAtomic {
   static int64_t SwapMutexRead64(volatile const int64_t* addr);
   static void SwapMutexWrite64(volatile int64_t* addr, int64_t val);
   static bool SwapMutexCas64(int64_t old_value, int64_t new_value, volatile int64_t* addr);
+  static void SwapMutexRead128(volatile const int64_t* addr, int64_t* first, int64_t* second);
+  static void SwapMutexWrite128(volatile int64_t* addr, int64_t first, int64_t second);
 
   // We stripe across a bunch of different mutexes to reduce contention.
   static constexpr size_t kSwapMutexCount = 32;
@@ -24,6 +24,7 @@
 #include "mutex.h"
 #include "thread-inl.h"
 #include "systrace.h"
+#include "utils.h"
 
 namespace art {
 
@@ -67,8 +68,11 @@ const char* const ArenaAllocatorStatsImpl<kCount>::kAllocNames[] = {
   "InductionVar ",
   "BCE          ",
   "DCE          ",
+  "ConstProp    ",
   "LSE          ",
   "LICM         ",
+  "LoopVector   ",
+  "LoopUnroll   ",
   "SsaLiveness  ",
   "SsaPhiElim   ",
   "RefTypeProp  ",
@@ -82,6 +86,8 @@ const char* const ArenaAllocatorStatsImpl<kCount>::kAllocNames[] = {
   "GraphChecker ",
   "Verifier     ",
   "CallingConv  ",
+  "CHA          ",
+  "Scheduler    ",
 };
 
 template <bool kCount>
@@ -201,6 +207,8 @@ ArenaPool::ArenaPool(bool use_malloc, bool low_4gb, const char* name)
     : use_malloc_(use_malloc),
       lock_("Arena pool lock", kArenaPoolLock),
       free_arenas_(nullptr),
+      free_large_arenas_(nullptr),
+      free_large_arenas_size_(0u),
       low_4gb_(low_4gb),
       name_(name) {
   if (low_4gb) {
@@ -215,14 +223,22 @@ ArenaPool::~ArenaPool() {
   ReclaimMemory();
 }
 
-void ArenaPool::ReclaimMemory() {
-  while (free_arenas_ != nullptr) {
-    auto* arena = free_arenas_;
-    free_arenas_ = free_arenas_->next_;
+void ArenaPool::DeleteArenaChain(Arena* arena) {
+  while (arena != nullptr) {
+    Arena* next = arena->next_;
     delete arena;
+    arena = next;
   }
 }
 
+void ArenaPool::ReclaimMemory() {
+  DeleteArenaChain(free_arenas_);
+  free_arenas_ = nullptr;
+  DeleteArenaChain(free_large_arenas_);
+  free_large_arenas_ = nullptr;
+  free_large_arenas_size_ = 0u;
+}
+
 void ArenaPool::LockReclaimMemory() {
   MutexLock lock(Thread::Current(), lock_);
   ReclaimMemory();
@@ -233,9 +249,24 @@ Arena* ArenaPool::AllocArena(size_t size) {
   Arena* ret = nullptr;
   {
     MutexLock lock(self, lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
+    if (size <= Arena::kDefaultSize) {
+      if (free_arenas_ != nullptr) {
+        ret = free_arenas_;
+        free_arenas_ = free_arenas_->next_;
+      }
+    } else {
+      // Take the smallest free large arena that fits.
+      Arena** best = nullptr;
+      for (Arena** it = &free_large_arenas_; *it != nullptr; it = &(*it)->next_) {
+        if ((*it)->Size() >= size && (best == nullptr || (*it)->Size() < (*best)->Size())) {
+          best = it;
+        }
+      }
+      if (best != nullptr) {
+        ret = *best;
+        *best = ret->next_;
+        free_large_arenas_size_ -= ret->Size();
+      }
     }
   }
   if (ret == nullptr) {
@@ -254,6 +285,9 @@ void ArenaPool::TrimMaps() {
     for (auto* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
       arena->Release();
     }
+    for (auto* arena = free_large_arenas_; arena != nullptr; arena = arena->next_) {
+      arena->Release();
+    }
   }
 }
 
@@ -263,6 +297,9 @@ size_t ArenaPool::GetBytesAllocated() const {
   for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
     total += arena->GetBytesAllocated();
   }
+  for (Arena* arena = free_large_arenas_; arena != nullptr; arena = arena->next_) {
+    total += arena->GetBytesAllocated();
+  }
   return total;
 }
 
@@ -272,16 +309,59 @@ void ArenaPool::FreeArenaChain(Arena* first) {
       MEMORY_TOOL_MAKE_UNDEFINED(arena->memory_, arena->bytes_allocated_);
     }
   }
-  if (first != nullptr) {
-    Arena* last = first;
-    while (last->next_ != nullptr) {
-      last = last->next_;
+  if (first == nullptr) {
+    return;
+  }
+  // Sort the chain by size class before taking the lock.
+  Arena* default_first = nullptr;
+  Arena* default_last = nullptr;
+  Arena* large_first = nullptr;
+  Arena* large_last = nullptr;
+  size_t large_size = 0u;
+  Arena* arena = first;
+  while (arena != nullptr) {
+    Arena* next = arena->next_;
+    bool is_large = arena->Size() > Arena::kDefaultSize;
+    Arena*& list_first = is_large ? large_first : default_first;
+    Arena*& list_last = is_large ? large_last : default_last;
+    if (list_last == nullptr) {
+      list_last = arena;
     }
+    arena->next_ = list_first;
+    list_first = arena;
+    if (is_large) {
+      large_size += arena->Size();
+    }
+    arena = next;
+  }
+  Arena* to_delete = nullptr;
+  {
     Thread* self = Thread::Current();
     MutexLock lock(self, lock_);
-    last->next_ = free_arenas_;
-    free_arenas_ = first;
+    if (default_first != nullptr) {
+      default_last->next_ = free_arenas_;
+      free_arenas_ = default_first;
+    }
+    if (large_first != nullptr) {
+      large_last->next_ = free_large_arenas_;
+      free_large_arenas_ = large_first;
+      free_large_arenas_size_ += large_size;
+      // Drop the least recently freed large arenas over the limit.
+      if (free_large_arenas_size_ > kMaxFreeLargeArenasSize) {
+        size_t kept_size = 0u;
+        for (Arena** it = &free_large_arenas_; *it != nullptr; it = &(*it)->next_) {
+          if (kept_size + (*it)->Size() > kMaxFreeLargeArenasSize) {
+            to_delete = *it;
+            *it = nullptr;
+            break;
+          }
+          kept_size += (*it)->Size();
+        }
+        free_large_arenas_size_ = kept_size;
+      }
+    }
   }
+  DeleteArenaChain(to_delete);
 }
 
 size_t ArenaAllocator::BytesAllocated() const {
@@ -401,6 +481,28 @@ void MemStats::Dump(std::ostream& os) const {
   stats_->Dump(os, first_arena_, lost_bytes_adjustment_);
 }
 
+void LargestArenaUses::Add(size_t bytes, const std::string& user) {
+  if (!IsKept(bytes)) {
+    return;
+  }
+  if (uses_.size() == max_uses_) {
+    uses_.pop_back();
+  }
+  auto pos = std::upper_bound(uses_.begin(),
+                              uses_.end(),
+                              bytes,
+                              [](size_t b, const std::pair<size_t, std::string>& use) {
+                                return b > use.first;
+                              });
+  uses_.insert(pos, std::make_pair(bytes, user));
+}
+
+void LargestArenaUses::Dump(std::ostream& os) const {
+  for (const std::pair<size_t, std::string>& use : uses_) {
+    os << "  " << PrettySize(use.first) << " " << use.second << "\n";
+  }
+}
+
 // Dump memory usage stats.
 MemStats ArenaAllocator::GetMemStats() const {
   ssize_t lost_bytes_adjustment =
@@ -20,6 +20,10 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "base/bit_utils.h"
 #include "base/memory_tool.h"
 #include "debug_stack.h"
@@ -78,8 +82,11 @@ enum ArenaAllocKind {
   kArenaAllocInductionVarAnalysis,
   kArenaAllocBoundsCheckElimination,
   kArenaAllocDCE,
+  kArenaAllocConstantPropagation,
   kArenaAllocLSE,
   kArenaAllocLICM,
+  kArenaAllocLoopVectorization,
+  kArenaAllocLoopUnrolling,
   kArenaAllocSsaLiveness,
   kArenaAllocSsaPhiElimination,
   kArenaAllocReferenceTypePropagation,
@@ -93,6 +100,8 @@ enum ArenaAllocKind {
   kArenaAllocGraphChecker,
   kArenaAllocVerifier,
   kArenaAllocCallingConvention,
+  kArenaAllocCHA,
+  kArenaAllocScheduler,
   kNumArenaAllocKinds
 };
 
@@ -272,9 +281,18 @@ class ArenaPool {
   void TrimMaps() REQUIRES(!lock_);
 
  private:
+  // Keep at most that many bytes of free arenas larger than Arena::kDefaultSize.
+  static constexpr size_t kMaxFreeLargeArenasSize = 16 * Arena::kDefaultSize;
+
+  static void DeleteArenaChain(Arena* arena);
+
   const bool use_malloc_;
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Free arenas of Arena::kDefaultSize.
   Arena* free_arenas_ GUARDED_BY(lock_);
+  // Free arenas larger than Arena::kDefaultSize, most recently freed first.
+  Arena* free_large_arenas_ GUARDED_BY(lock_);
+  size_t free_large_arenas_size_ GUARDED_BY(lock_);
   const bool low_4gb_;
   const char* name_;
   DISALLOW_COPY_AND_ASSIGN(ArenaPool);
@@ -397,6 +415,26 @@ class MemStats {
   const ssize_t lost_bytes_adjustment_;
 };  // MemStats
 
+// The largest arena memory uses seen so far, with a description of their user, to report for
+// example the methods that took the most arena memory to compile. Not thread safe.
+class LargestArenaUses {
+ public:
+  explicit LargestArenaUses(size_t max_uses) : max_uses_(max_uses) {}
+
+  // Whether a use of `bytes` would be kept, so that callers only describe the uses kept.
+  bool IsKept(size_t bytes) const {
+    return uses_.size() < max_uses_ || bytes > uses_.back().first;
+  }
+
+  void Add(size_t bytes, const std::string& user);
+  void Dump(std::ostream& os) const;
+
+ private:
+  const size_t max_uses_;
+  // Sorted by decreasing size.
+  std::vector<std::pair<size_t, std::string>> uses_;
+};
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_BASE_ARENA_ALLOCATOR_H_
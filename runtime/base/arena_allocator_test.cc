@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <sstream>
+
 #include "base/arena_allocator.h"
 #include "base/arena_bit_vector.h"
 #include "gtest/gtest.h"
@@ -29,6 +31,12 @@ class ArenaAllocatorTest : public testing::Test {
     }
     return result;
   }
+
+  Arena* AllocSingleArena(ArenaPool* pool, size_t size) {
+    Arena* arena = pool->AllocArena(size);
+    arena->next_ = nullptr;
+    return arena;
+  }
 };
 
 TEST_F(ArenaAllocatorTest, Test) {
@@ -124,4 +132,39 @@ TEST_F(ArenaAllocatorTest, LargeAllocations) {
   }
 }
 
+TEST_F(ArenaAllocatorTest, ReuseLargeArenas) {
+  ArenaPool pool;
+  Arena* default_arena = AllocSingleArena(&pool, Arena::kDefaultSize);
+  Arena* large_arena = AllocSingleArena(&pool, Arena::kDefaultSize * 4);
+  Arena* larger_arena = AllocSingleArena(&pool, Arena::kDefaultSize * 8);
+  pool.FreeArenaChain(larger_arena);
+  pool.FreeArenaChain(large_arena);
+  pool.FreeArenaChain(default_arena);
+
+  // Default size requests do not take the large arenas, large requests take the best fit.
+  EXPECT_EQ(default_arena, AllocSingleArena(&pool, Arena::kDefaultSize));
+  EXPECT_EQ(large_arena, AllocSingleArena(&pool, Arena::kDefaultSize * 3));
+  EXPECT_EQ(larger_arena, AllocSingleArena(&pool, Arena::kDefaultSize * 3));
+  Arena* new_arena = AllocSingleArena(&pool, Arena::kDefaultSize * 3);
+  EXPECT_EQ(Arena::kDefaultSize * 3, new_arena->Size());
+
+  pool.FreeArenaChain(default_arena);
+  pool.FreeArenaChain(large_arena);
+  pool.FreeArenaChain(larger_arena);
+  pool.FreeArenaChain(new_arena);
+}
+
+TEST_F(ArenaAllocatorTest, LargestArenaUses) {
+  LargestArenaUses uses(2u);
+  EXPECT_TRUE(uses.IsKept(1u));
+  uses.Add(4 * KB, "b");
+  uses.Add(3 * KB, "a");
+  EXPECT_FALSE(uses.IsKept(3 * KB));
+  uses.Add(5 * KB, "c");
+  uses.Add(3 * KB, "d");
+  std::ostringstream oss;
+  uses.Dump(oss);
+  EXPECT_EQ("  5KB c\n  4KB b\n", oss.str());
+}
+
 }  // namespace art
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "contention_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "base/mutex.h"
+#include "base/time_utils.h"
+#include "thread-inl.h"
+
+namespace art {
+
+Atomic<bool> ContentionProfiler::enabled_(false);
+
+namespace {
+
+// Only the most expensive entries of each table are dumped.
+static constexpr size_t kMaxDumpedEntries = 20;
+
+struct ContentionStats {
+  ContentionStats() : count(0u), total_ns(0u), max_ns(0u) {}
+
+  void Add(uint64_t ns) {
+    ++count;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+  }
+
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+};
+
+struct ContentionProfileData {
+  ContentionProfileData() : lock("contention profiler lock", kLoggingLock) {}
+
+  Mutex lock;
+  std::map<std::string, ContentionStats> mutex_waits GUARDED_BY(lock);
+  std::map<std::pair<std::string, std::string>, ContentionStats> monitor_waits GUARDED_BY(lock);
+  std::map<std::string, ContentionStats> monitor_holds GUARDED_BY(lock);
+};
+
+// Created when first enabled and never deleted, contended threads may still be recording.
+Atomic<ContentionProfileData*> gContentionProfileData(nullptr);
+
+template <typename Key, typename Printer>
+void DumpTable(std::ostream& os,
+               const char* title,
+               const std::map<Key, ContentionStats>& table,
+               const Printer& print_key) {
+  typedef std::pair<const Key*, const ContentionStats*> Entry;
+  std::vector<Entry> entries;
+  for (const auto& entry : table) {
+    entries.emplace_back(&entry.first, &entry.second);
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.second->total_ns > rhs.second->total_ns;
+  });
+  os << title << " (" << table.size() << " entries)\n";
+  for (size_t i = 0, e = std::min(entries.size(), kMaxDumpedEntries); i != e; ++i) {
+    const ContentionStats& stats = *entries[i].second;
+    os << "  " << stats.count << " times, total " << PrettyDuration(stats.total_ns)
+       << " average " << PrettyDuration(stats.total_ns / stats.count)
+       << " max " << PrettyDuration(stats.max_ns) << ": ";
+    print_key(os, *entries[i].first);
+    os << "\n";
+  }
+}
+
+}  // namespace
+
+void ContentionProfiler::SetEnabled(bool enabled) {
+  if (enabled && gContentionProfileData.LoadAcquire() == nullptr) {
+    ContentionProfileData* data = new ContentionProfileData();
+    if (!gContentionProfileData.CompareExchangeStrongSequentiallyConsistent(nullptr, data)) {
+      delete data;  // Lost the race with another thread enabling the profiler.
+    }
+  }
+  enabled_.StoreRelaxed(enabled);
+}
+
+void ContentionProfiler::RecordMutexWait(const BaseMutex* mutex, uint64_t wait_ns) {
+  ContentionProfileData* data = gContentionProfileData.LoadAcquire();
+  // Do not record waits for our own lock, we would try to acquire it again.
+  if (data == nullptr || mutex == &data->lock) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->mutex_waits[mutex->GetName()].Add(wait_ns);
+}
+
+void ContentionProfiler::RecordMonitorWait(const std::string& owner_site,
+                                           const std::string& waiter_site,
+                                           uint64_t wait_ns) {
+  ContentionProfileData* data = gContentionProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->monitor_waits[std::make_pair(owner_site, waiter_site)].Add(wait_ns);
+}
+
+void ContentionProfiler::RecordMonitorHold(const std::string& owner_site, uint64_t hold_ns) {
+  ContentionProfileData* data = gContentionProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->monitor_holds[owner_site].Add(hold_ns);
+}
+
+bool ContentionProfiler::Dump(std::ostream& os) {
+  ContentionProfileData* data = gContentionProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return false;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  os << "Lock contention profile (" << (IsEnabled() ? "enabled" : "disabled") << "):\n";
+  DumpTable(os, "Waits for mutexes", data->mutex_waits,
+            [](std::ostream& out, const std::string& name) { out << name; });
+  DumpTable(os, "Waits for monitors", data->monitor_waits,
+            [](std::ostream& out, const std::pair<std::string, std::string>& sites) {
+              out << "locked at " << sites.first << ", waited for at " << sites.second;
+            });
+  DumpTable(os, "Holds of contended monitors", data->monitor_holds,
+            [](std::ostream& out, const std::string& site) { out << "locked at " << site; });
+  return true;
+}
+
+void ContentionProfiler::Reset() {
+  ContentionProfileData* data = gContentionProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->mutex_waits.clear();
+  data->monitor_waits.clear();
+  data->monitor_holds.clear();
+}
+
+}  // namespace art
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_BASE_CONTENTION_PROFILER_H_
+#define ART_RUNTIME_BASE_CONTENTION_PROFILER_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <string>
+
+#include "atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+class BaseMutex;
+
+// Aggregates lock contention when enabled with -Xlockcontentionprofile: the time threads wait
+// for contended runtime mutexes, keyed by mutex name, and for contended Java monitors, keyed by
+// the call sites of the owner and of the waiter, as well as how long owners hold the monitors
+// others wait for. Unlike kLogLockContentions, it can be turned on and off at runtime and costs
+// a load on the contended paths when off. Dumped on SIGQUIT and through VMDebug.
+class ContentionProfiler {
+ public:
+  static void SetEnabled(bool enabled);
+
+  static bool IsEnabled() {
+    return enabled_.LoadRelaxed();
+  }
+
+  static void RecordMutexWait(const BaseMutex* mutex, uint64_t wait_ns);
+  static void RecordMonitorWait(const std::string& owner_site,
+                                const std::string& waiter_site,
+                                uint64_t wait_ns);
+  static void RecordMonitorHold(const std::string& owner_site, uint64_t hold_ns);
+
+  // Returns false and dumps nothing if the profiler was never enabled.
+  static bool Dump(std::ostream& os);
+
+  // Drop the statistics gathered so far.
+  static void Reset();
+
+ private:
+  static Atomic<bool> enabled_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ContentionProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_BASE_CONTENTION_PROFILER_H_
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "contention_profiler.h"
+
+#include <sstream>
+
+#include "base/mutex.h"
+#include "common_runtime_test.h"
+
+namespace art {
+
+class ContentionProfilerTest : public CommonRuntimeTest {};
+
+TEST_F(ContentionProfilerTest, Aggregates) {
+  ContentionProfiler::SetEnabled(true);
+  ContentionProfiler::Reset();
+  EXPECT_TRUE(ContentionProfiler::IsEnabled());
+
+  Mutex mu("contention profiler test lock");
+  ContentionProfiler::RecordMutexWait(&mu, 1000u);
+  ContentionProfiler::RecordMutexWait(&mu, 3000u);
+  ContentionProfiler::RecordMonitorWait("Owner.run(Owner.java:1)", "Waiter.run(Waiter.java:2)",
+                                        5000u);
+  ContentionProfiler::RecordMonitorHold("Owner.run(Owner.java:1)", 7000u);
+  ContentionProfiler::SetEnabled(false);
+  EXPECT_FALSE(ContentionProfiler::IsEnabled());
+
+  std::ostringstream os;
+  ASSERT_TRUE(ContentionProfiler::Dump(os));
+  std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find("(disabled)"));
+  EXPECT_NE(std::string::npos, dump.find("2 times, total 4us average 2us max 3us: "
+                                         "contention profiler test lock"));
+  EXPECT_NE(std::string::npos, dump.find("locked at Owner.run(Owner.java:1), "
+                                         "waited for at Waiter.run(Waiter.java:2)"));
+  EXPECT_NE(std::string::npos, dump.find("1 times, total 7us average 7us max 7us: "
+                                         "locked at Owner.run(Owner.java:1)"));
+
+  ContentionProfiler::Reset();
+  std::ostringstream empty;
+  ASSERT_TRUE(ContentionProfiler::Dump(empty));
+  EXPECT_EQ(std::string::npos, empty.str().find("contention profiler test lock"));
+}
+
+}  // namespace art
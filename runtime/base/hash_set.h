@@ -21,6 +21,7 @@
 #include <iterator>
 #include <memory>
 #include <stdint.h>
+#include <string.h>
 #include <utility>
 
 #include "bit_utils.h"
@@ -52,7 +53,8 @@ class DefaultEmptyFn<T*> {
 };
 
 // Low memory version of a hash set, uses less memory than std::unordered_set since elements aren't
-// boxed. Uses linear probing to resolve collisions.
+// boxed. Uses linear probing to resolve collisions. A byte of the hash of each element is kept
+// next to the elements, so that lookups call Pred on few of the elements they probe.
 // EmptyFn needs to implement two functions MakeEmpty(T& item) and IsEmpty(const T& item).
 // TODO: We could get rid of this requirement by using a bitmap, though maybe this would be slower
 // and more complicated.
@@ -146,6 +148,7 @@ class HashSet {
         elements_until_expand_(0u),
         owns_data_(false),
         data_(nullptr),
+        hash_fragments_(nullptr),
         min_load_factor_(min_load_factor),
         max_load_factor_(max_load_factor) {
     DCHECK_GT(min_load_factor, 0.0);
@@ -162,6 +165,7 @@ class HashSet {
         elements_until_expand_(0u),
         owns_data_(false),
         data_(nullptr),
+        hash_fragments_(nullptr),
         min_load_factor_(kDefaultMinLoadFactor),
         max_load_factor_(kDefaultMaxLoadFactor) {
   }
@@ -176,12 +180,16 @@ class HashSet {
         elements_until_expand_(other.elements_until_expand_),
         owns_data_(false),
         data_(nullptr),
+        hash_fragments_(nullptr),
         min_load_factor_(other.min_load_factor_),
         max_load_factor_(other.max_load_factor_) {
     AllocateStorage(other.NumBuckets());
     for (size_t i = 0; i < num_buckets_; ++i) {
       ElementForIndex(i) = other.data_[i];
     }
+    if (num_buckets_ != 0u) {
+      memcpy(hash_fragments_, other.hash_fragments_, num_buckets_);
+    }
   }
 
   // noexcept required so that the move constructor is used instead of copy constructor.
@@ -196,6 +204,7 @@ class HashSet {
         elements_until_expand_(other.elements_until_expand_),
         owns_data_(other.owns_data_),
         data_(other.data_),
+        hash_fragments_(other.hash_fragments_),
         min_load_factor_(other.min_load_factor_),
         max_load_factor_(other.max_load_factor_) {
     other.num_elements_ = 0u;
@@ -203,6 +212,7 @@ class HashSet {
     other.elements_until_expand_ = 0u;
     other.owns_data_ = false;
     other.data_ = nullptr;
+    other.hash_fragments_ = nullptr;
   }
 
   // Construct from existing data.
@@ -224,6 +234,8 @@ class HashSet {
       owns_data_ = false;
       data_ = const_cast<T*>(reinterpret_cast<const T*>(ptr + offset));
       offset += sizeof(*data_) * num_buckets_;
+      hash_fragments_ = const_cast<uint8_t*>(ptr + offset);
+      offset += num_buckets_;
     } else {
       AllocateStorage(num_buckets_);
       // Write elements, not that this may not be safe for cross compilation if the elements are
@@ -231,6 +243,10 @@ class HashSet {
       for (size_t i = 0; i < num_buckets_; ++i) {
         offset = ReadFromBytes(ptr, offset, &data_[i]);
       }
+      if (num_buckets_ != 0u) {
+        memcpy(hash_fragments_, ptr + offset, num_buckets_);
+      }
+      offset += num_buckets_;
     }
     // Caller responsible for aligning.
     *read_count = offset;
@@ -250,6 +266,10 @@ class HashSet {
     for (size_t i = 0; i < num_buckets_; ++i) {
       offset = WriteToBytes(ptr, offset, data_[i]);
     }
+    if (ptr != nullptr && num_buckets_ != 0u) {
+      memcpy(ptr + offset, hash_fragments_, num_buckets_);
+    }
+    offset += num_buckets_;
     // Caller responsible for aligning.
     return offset;
   }
@@ -347,6 +367,7 @@ class HashSet {
         // If the target index isn't within our current range it must have been probed from before
         // the empty index.
         ElementForIndex(empty_index) = std::move(next_element);
+        hash_fragments_[empty_index] = hash_fragments_[next_index];
         filled = true;  // TODO: Optimize
         empty_index = next_index;
       }
@@ -396,6 +417,7 @@ class HashSet {
     }
     const size_t index = FirstAvailableSlot(IndexForHash(hash));
     data_[index] = element;
+    hash_fragments_[index] = HashFragment(hash);
     ++num_elements_;
   }
 
@@ -411,6 +433,7 @@ class HashSet {
     swap(emptyfn_, other.emptyfn_);
     swap(pred_, other.pred_);
     std::swap(data_, other.data_);
+    std::swap(hash_fragments_, other.hash_fragments_);
     std::swap(num_buckets_, other.num_buckets_);
     std::swap(num_elements_, other.num_elements_);
     std::swap(elements_until_expand_, other.elements_until_expand_);
@@ -518,6 +541,15 @@ class HashSet {
   }
 
  private:
+  using HashFragmentAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+
+  // The hash byte kept for each element. Only the low 32 bits of the hash are used, since the
+  // hash functions of the sets written to images return uint32_t for cross compilation.
+  static uint8_t HashFragment(size_t hash) {
+    uint32_t hash32 = static_cast<uint32_t>(hash);
+    return static_cast<uint8_t>(hash32 ^ (hash32 >> 8) ^ (hash32 >> 16) ^ (hash32 >> 24));
+  }
+
   T& ElementForIndex(size_t index) {
     DCHECK_LT(index, NumBuckets());
     DCHECK(data_ != nullptr);
@@ -555,13 +587,14 @@ class HashSet {
       return 0;
     }
     DCHECK_EQ(hashfn_(element), hash);
+    const uint8_t hash_fragment = HashFragment(hash);
     size_t index = IndexForHash(hash);
     while (true) {
       const T& slot = ElementForIndex(index);
       if (emptyfn_.IsEmpty(slot)) {
         return NumBuckets();
       }
-      if (pred_(slot, element)) {
+      if (hash_fragments_[index] == hash_fragment && pred_(slot, element)) {
         return index;
       }
       index = NextIndex(index);
@@ -581,6 +614,10 @@ class HashSet {
       allocfn_.construct(allocfn_.address(data_[i]));
       emptyfn_.MakeEmpty(data_[i]);
     }
+    hash_fragments_ = HashFragmentAlloc(allocfn_).allocate(num_buckets_);
+    if (num_buckets_ != 0u) {
+      memset(hash_fragments_, 0, num_buckets_);
+    }
   }
 
   void DeallocateStorage() {
@@ -591,9 +628,13 @@ class HashSet {
       if (data_ != nullptr) {
         allocfn_.deallocate(data_, NumBuckets());
       }
+      if (hash_fragments_ != nullptr) {
+        HashFragmentAlloc(allocfn_).deallocate(hash_fragments_, NumBuckets());
+      }
       owns_data_ = false;
     }
     data_ = nullptr;
+    hash_fragments_ = nullptr;
     num_buckets_ = 0;
   }
 
@@ -611,6 +652,7 @@ class HashSet {
     }
     DCHECK_GE(new_size, Size());
     T* const old_data = data_;
+    uint8_t* const old_hash_fragments = hash_fragments_;
     size_t old_num_buckets = num_buckets_;
     // Reinsert all of the old elements.
     const bool owned_data = owns_data_;
@@ -618,7 +660,9 @@ class HashSet {
     for (size_t i = 0; i < old_num_buckets; ++i) {
       T& element = old_data[i];
       if (!emptyfn_.IsEmpty(element)) {
-        data_[FirstAvailableSlot(IndexForHash(hashfn_(element)))] = std::move(element);
+        const size_t index = FirstAvailableSlot(IndexForHash(hashfn_(element)));
+        data_[index] = std::move(element);
+        hash_fragments_[index] = old_hash_fragments[i];
       }
       if (owned_data) {
         allocfn_.destroy(allocfn_.address(element));
@@ -626,6 +670,9 @@ class HashSet {
     }
     if (owned_data) {
       allocfn_.deallocate(old_data, old_num_buckets);
+      if (old_hash_fragments != nullptr) {
+        HashFragmentAlloc(allocfn_).deallocate(old_hash_fragments, old_num_buckets);
+      }
     }
 
     // When we hit elements_until_expand_, we are at the max load factor and must expand again.
@@ -670,6 +717,7 @@ class HashSet {
   size_t elements_until_expand_;  // Maximum number of elements until we expand the table.
   bool owns_data_;  // If we own data_ and are responsible for freeing it.
   T* data_;  // Backing storage.
+  uint8_t* hash_fragments_;  // HashFragment() of the element in each bucket.
   double min_load_factor_;
   double max_load_factor_;
 };
@@ -354,4 +354,54 @@ TEST_F(HashSetTest, TestReserve) {
   CHECK_GE(hash_set.ElementsUntilExpand(), size);
 }
 
+struct IdentityHashCountingEquals {
+  static size_t num_compares;
+
+  size_t operator()(uint32_t value) const {
+    return value;
+  }
+  bool operator()(uint32_t a, uint32_t b) const {
+    ++num_compares;
+    return a == b;
+  }
+};
+
+size_t IdentityHashCountingEquals::num_compares = 0u;
+
+TEST_F(HashSetTest, TestHashFragments) {
+  using CountingSet = HashSet<uint32_t,
+                              DefaultEmptyFn<uint32_t>,
+                              IdentityHashCountingEquals,
+                              IdentityHashCountingEquals>;
+  CountingSet hash_set;
+  static constexpr uint32_t kNumValues = 10u;
+  // All the values start probing at the same bucket, but have different hash fragments.
+  for (uint32_t i = 1u; i <= kNumValues; ++i) {
+    hash_set.Insert(i * CountingSet::kMinBuckets);
+  }
+  ASSERT_EQ(CountingSet::kMinBuckets, hash_set.NumBuckets());
+  IdentityHashCountingEquals::num_compares = 0u;
+  EXPECT_EQ(hash_set.end(), hash_set.Find((kNumValues + 1u) * CountingSet::kMinBuckets));
+  EXPECT_EQ(0u, IdentityHashCountingEquals::num_compares);
+  EXPECT_NE(hash_set.end(), hash_set.Find(kNumValues * CountingSet::kMinBuckets));
+  EXPECT_EQ(1u, IdentityHashCountingEquals::num_compares);
+
+  // The hash fragments follow the elements moved by Erase and are written to memory.
+  hash_set.Erase(hash_set.Find(CountingSet::kMinBuckets));
+  std::vector<uint64_t> memory(hash_set.WriteToMemory(nullptr) / sizeof(uint64_t) + 1u);
+  hash_set.WriteToMemory(reinterpret_cast<uint8_t*>(memory.data()));
+  for (bool make_copy_of_data : { false, true }) {
+    size_t read_count;
+    CountingSet read_set(reinterpret_cast<const uint8_t*>(memory.data()),
+                         make_copy_of_data,
+                         &read_count);
+    EXPECT_EQ(hash_set.WriteToMemory(nullptr), read_count);
+    EXPECT_EQ(kNumValues - 1u, read_set.Size());
+    EXPECT_EQ(read_set.end(), read_set.Find(CountingSet::kMinBuckets));
+    for (uint32_t i = 2u; i <= kNumValues; ++i) {
+      EXPECT_NE(read_set.end(), read_set.Find(i * CountingSet::kMinBuckets));
+    }
+  }
+}
+
 }  // namespace art
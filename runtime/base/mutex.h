@@ -66,6 +66,7 @@ enum LockLevel {
   kRosAllocGlobalLock,
   kRosAllocBracketLock,
   kRosAllocBulkFreeLock,
+  kRosAllocFreeMagazineLock,
   kMarkSweepMarkStackLock,
   kTransactionLogLock,
   kJniWeakGlobalsLock,
@@ -82,6 +83,7 @@ enum LockLevel {
   kDexFileMethodInlinerLock,
   kDexFileToMethodInlinerMapLock,
   kInternTableLock,
+  kOatFileStatusCacheLock,
   kOatFileSecondaryLookupLock,
   kHostDlOpenHandlesLock,
   kOatFileManagerLock,
@@ -89,7 +91,9 @@ enum LockLevel {
   kTracingStreamingLock,
   kDeoptimizedMethodsLock,
   kJitCodeCacheLock,
+  kCHALock,
   kClassLoaderClassesLock,
+  kThreadPoolWorkerTasksLock,
   kDefaultMutexLevel,
   kMarkSweepLargeObjectLock,
   kPinTableLock,
@@ -100,6 +104,7 @@ enum LockLevel {
   kMethodVerifiersLock,
   kClassLinkerClassesLock,  // TODO rename.
   kBreakpointLock,
+  kThinLockHashesLock,
   kMonitorLock,
   kMonitorListLock,
   kJniLoadLibraryLock,
@@ -419,6 +424,11 @@ class SHARED_LOCKABLE ReaderWriterMutex : public BaseMutex {
 // *) The most important consequence of this behaviour is that all threads must be in one of the
 // suspended states before exclusive ownership of the mutator mutex is sought.
 //
+// *) The transitions only update the thread's own state and held mutexes; they never touch the
+// shared state_ word, so that threads entering and leaving native code don't contend on it. The
+// exclusive acquirer pays instead, by requesting and waiting for the suspension of every thread.
+// Do not add SharedLock() calls to the transition paths.
+//
 std::ostream& operator<<(std::ostream& os, const MutatorMutex& mu);
 class SHARED_LOCKABLE MutatorMutex : public ReaderWriterMutex {
  public:
@@ -648,8 +658,11 @@ class Locks {
   // Guards modification of the LDT on x86.
   static Mutex* modify_ldt_lock_ ACQUIRED_AFTER(allocated_thread_ids_lock_);
 
+  // Guards the single implementation state of methods and the compiled code relying on it.
+  static Mutex* cha_lock_ ACQUIRED_AFTER(modify_ldt_lock_);
+
   // Guards opened oat files in OatFileManager.
-  static ReaderWriterMutex* oat_file_manager_lock_ ACQUIRED_AFTER(modify_ldt_lock_);
+  static ReaderWriterMutex* oat_file_manager_lock_ ACQUIRED_AFTER(cha_lock_);
 
   // Guards dlopen_handles_ in DlOpenOatFile.
   static Mutex* host_dlopen_handles_lock_ ACQUIRED_AFTER(oat_file_manager_lock_);
@@ -690,10 +703,6 @@ class Locks {
 
   // Have an exclusive logging thread.
   static Mutex* logging_lock_ ACQUIRED_AFTER(unexpected_signal_lock_);
-
-  // Allow reader-writer mutual exclusion on the boxed table of lambda objects.
-  // TODO: this should be a RW mutex lock, except that ConditionVariables don't work with it.
-  static Mutex* lambda_table_lock_ ACQUIRED_AFTER(mutator_lock_);
 };
 
 class Roles {
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "numa.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include <stdlib.h>
+
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "utils.h"
+
+namespace art {
+
+// Nodes are numbered from 0 without holes in practice, stop at the first missing one.
+static constexpr int kMaxNodes = 64;
+
+std::vector<std::vector<int>> Numa::GetNodeCpus() {
+  std::vector<std::vector<int>> nodes;
+  for (int node = 0; node != kMaxNodes; ++node) {
+    std::string cpu_list;
+    if (!ReadFileToString(StringPrintf("/sys/devices/system/node/node%d/cpulist", node),
+                          &cpu_list)) {
+      break;
+    }
+    std::vector<int> cpus;
+    if (!ParseCpuList(cpu_list, &cpus)) {
+      LOG(WARNING) << "Ignoring the NUMA topology, bad CPU list for node " << node << ": "
+                   << cpu_list;
+      nodes.clear();
+      break;
+    }
+    if (!cpus.empty()) {  // Nodes with memory only.
+      nodes.push_back(cpus);
+    }
+  }
+  if (nodes.empty()) {
+    nodes.resize(1u);
+  }
+  return nodes;
+}
+
+bool Numa::ParseCpuList(const std::string& str, std::vector<int>* cpus) {
+  std::string trimmed(Trim(str));
+  if (trimmed.empty()) {
+    return true;
+  }
+  std::vector<std::string> ranges;
+  Split(trimmed, ',', &ranges);
+  for (const std::string& range : ranges) {
+    const char* begin = range.c_str();
+    char* end;
+    long first = strtol(begin, &end, 10);
+    long last = first;
+    if (end == begin || first < 0) {
+      return false;
+    }
+    if (*end == '-') {
+      begin = end + 1;
+      last = strtol(begin, &end, 10);
+      if (end == begin || last < first) {
+        return false;
+      }
+    }
+    if (*end != '\0') {
+      return false;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus->push_back(static_cast<int>(cpu));
+    }
+  }
+  return true;
+}
+
+bool Numa::SetThreadAffinity(pid_t tid, const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+    PLOG(WARNING) << "Failed to set the CPU affinity of thread " << tid;
+    return false;
+  }
+  return true;
+#else
+  UNUSED(tid, cpus);
+  return false;
+#endif
+}
+
+}  // namespace art
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_BASE_NUMA_H_
+#define ART_RUNTIME_BASE_NUMA_H_
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace art {
+
+// The NUMA topology of the machine, as far as the runtime cares: which CPUs belong to which
+// node. Memory placement is left to the kernel's first-touch policy, so running a thread on the
+// CPUs of a node is enough for the pages it touches first to come from that node.
+class Numa {
+ public:
+  // Returns the CPUs of each node with at least one CPU, read from sysfs. Returns a single node
+  // with no CPUs if the topology is unknown.
+  static std::vector<std::vector<int>> GetNodeCpus();
+
+  // Parses a kernel CPU list such as "0-3,8,10-11". Returns false if it is malformed.
+  static bool ParseCpuList(const std::string& str, std::vector<int>* cpus);
+
+  // Restricts the thread `tid` to run on `cpus`. Returns false if that is not supported.
+  static bool SetThreadAffinity(pid_t tid, const std::vector<int>& cpus);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(Numa);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_BASE_NUMA_H_
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "numa.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+TEST(Numa, ParseCpuList) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(Numa::ParseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ((std::vector<int> { 0, 1, 2, 3, 8, 10, 11 }), cpus);
+
+  cpus.clear();
+  EXPECT_TRUE(Numa::ParseCpuList("\n", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_FALSE(Numa::ParseCpuList("3-1", &cpus));
+  EXPECT_FALSE(Numa::ParseCpuList("x", &cpus));
+  EXPECT_FALSE(Numa::ParseCpuList("1-", &cpus));
+  EXPECT_FALSE(Numa::ParseCpuList("1;2", &cpus));
+}
+
+TEST(Numa, GetNodeCpus) {
+  std::vector<std::vector<int>> nodes = Numa::GetNodeCpus();
+  ASSERT_FALSE(nodes.empty());
+  if (nodes.size() > 1u) {
+    for (const std::vector<int>& cpus : nodes) {
+      EXPECT_FALSE(cpus.empty());
+    }
+  }
+}
+
+}  // namespace art
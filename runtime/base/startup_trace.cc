@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_trace.h"
+
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include "base/mutex.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "base/timing_logger.h"
+#include "base/unix_file/fd_file.h"
+#include "os.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+
+Atomic<bool> StartupTrace::recording_(false);
+
+namespace {
+
+struct StartupTraceData {
+  StartupTraceData() : lock("startup trace lock", kLoggingLock), start_ns(NanoTime()) {}
+
+  Mutex lock;
+  const uint64_t start_ns;
+  // TimingLogger keeps the label pointers, so the names are copied here.
+  std::set<std::string> names GUARDED_BY(lock);
+  std::map<pid_t, std::unique_ptr<TimingLogger>> loggers GUARDED_BY(lock);
+};
+
+// Never deleted, threads may still end their phases after the trace was written.
+StartupTraceData* gStartupTraceData = nullptr;
+
+}  // namespace
+
+void StartupTrace::Start() {
+  CHECK(gStartupTraceData == nullptr);
+  gStartupTraceData = new StartupTraceData();
+  recording_.StoreRelease(true);
+}
+
+bool StartupTrace::Begin(const char* name) {
+  if (!IsRecording()) {
+    return false;
+  }
+  StartupTraceData* data = gStartupTraceData;
+  MutexLock mu(Thread::Current(), data->lock);
+  std::unique_ptr<TimingLogger>& logger = data->loggers[GetTid()];
+  if (logger == nullptr) {
+    logger.reset(new TimingLogger("startup", /* precise */ true, /* verbose */ false));
+  }
+  logger->StartTiming(data->names.insert(name).first->c_str());
+  return true;
+}
+
+void StartupTrace::End() {
+  StartupTraceData* data = gStartupTraceData;
+  DCHECK(data != nullptr);
+  MutexLock mu(Thread::Current(), data->lock);
+  auto it = data->loggers.find(GetTid());
+  DCHECK(it != data->loggers.end());
+  it->second->EndTiming();
+}
+
+bool StartupTrace::StopAndWrite(const std::string& filename, std::string* error_msg) {
+  StartupTraceData* data = gStartupTraceData;
+  CHECK(data != nullptr);
+  recording_.StoreRelease(false);
+  const pid_t pid = getpid();
+  std::string json("{\"traceEvents\":[");
+  {
+    MutexLock mu(Thread::Current(), data->lock);
+    bool first = true;
+    for (const auto& entry : data->loggers) {
+      // Keep a stack of the open phases, so that the "E" events can carry their names too.
+      std::vector<const char*> open_phases;
+      for (const TimingLogger::Timing& timing : entry.second->GetTimings()) {
+        if (timing.IsEndTiming() && open_phases.empty()) {
+          continue;  // Should not happen, but do not write an unbalanced trace.
+        }
+        const char* name = timing.IsStartTiming() ? timing.GetName() : open_phases.back();
+        if (timing.IsStartTiming()) {
+          open_phases.push_back(name);
+        } else {
+          open_phases.pop_back();
+        }
+        json += first ? "\n" : ",\n";
+        first = false;
+        json += "{\"name\":";
+        AppendJsonString(&json, name);
+        StringAppendF(&json,
+                      ",\"cat\":\"startup\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                      timing.IsStartTiming() ? 'B' : 'E',
+                      static_cast<double>(timing.GetTime() - data->start_ns) / 1000.0,
+                      static_cast<int>(pid),
+                      static_cast<int>(entry.first));
+      }
+    }
+  }
+  json += "\n]}\n";
+
+  std::unique_ptr<File> file(OS::CreateEmptyFile(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Failed to create startup trace file " + filename;
+    return false;
+  }
+  if (!file->WriteFully(json.data(), json.size())) {
+    *error_msg = "Failed to write startup trace file " + filename;
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = "Failed to flush and close startup trace file " + filename;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace art
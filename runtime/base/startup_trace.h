@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_BASE_STARTUP_TRACE_H_
+#define ART_RUNTIME_BASE_STARTUP_TRACE_H_
+
+#include <string>
+
+#include "atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+// Records the ScopedTrace phases of every thread into one TimingLogger per thread, and writes
+// them out in the Chrome trace event format. Enabled with -Xstartup-trace-file:<file>, which
+// records from Runtime::Create until the end of Runtime::Start.
+class StartupTrace {
+ public:
+  // Start recording. Must be called at most once, before any thread can record.
+  static void Start();
+
+  // Stop recording and write the recorded phases to filename. Phases that are still open are
+  // written without their end and ends that come later are ignored.
+  static bool StopAndWrite(const std::string& filename, std::string* error_msg);
+
+  static bool IsRecording() {
+    return recording_.LoadAcquire();
+  }
+
+  // Start a phase on the current thread. Returns false and does nothing if not recording,
+  // otherwise the phase must be closed with End().
+  static bool Begin(const char* name);
+  static void End();
+
+ private:
+  static Atomic<bool> recording_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(StartupTrace);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_BASE_STARTUP_TRACE_H_
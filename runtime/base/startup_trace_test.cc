@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_trace.h"
+
+#include "base/stringprintf.h"
+#include "base/systrace.h"
+#include "common_runtime_test.h"
+#include "utils.h"
+
+namespace art {
+
+class StartupTraceTest : public CommonRuntimeTest {};
+
+TEST_F(StartupTraceTest, NestedPhases) {
+  ASSERT_FALSE(StartupTrace::IsRecording());
+  EXPECT_FALSE(StartupTrace::Begin("Not recorded"));
+
+  StartupTrace::Start();
+  ASSERT_TRUE(StartupTrace::IsRecording());
+  {
+    ScopedTrace outer("Outer \"phase\"");
+    ScopedTrace inner("Inner phase");
+  }
+  ScopedTrace open("Open phase");
+  ScratchFile file;
+  std::string error_msg;
+  ASSERT_TRUE(StartupTrace::StopAndWrite(file.GetFilename(), &error_msg)) << error_msg;
+  EXPECT_FALSE(StartupTrace::IsRecording());
+
+  std::string json;
+  ASSERT_TRUE(ReadFileToString(file.GetFilename(), &json));
+  EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+  auto find_event = [&json](const char* escaped_name, char phase) {
+    return json.find(StringPrintf("{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"%c\"",
+                                  escaped_name,
+                                  phase));
+  };
+  size_t outer_begin = find_event("Outer \\\"phase\\\"", 'B');
+  size_t inner_begin = find_event("Inner phase", 'B');
+  size_t inner_end = find_event("Inner phase", 'E');
+  size_t outer_end = find_event("Outer \\\"phase\\\"", 'E');
+  ASSERT_NE(std::string::npos, outer_begin);
+  ASSERT_NE(std::string::npos, inner_begin);
+  ASSERT_NE(std::string::npos, inner_end);
+  ASSERT_NE(std::string::npos, outer_end);
+  EXPECT_LT(outer_begin, inner_begin);
+  EXPECT_LT(inner_begin, inner_end);
+  EXPECT_LT(inner_end, outer_end);
+  // Phases still open when the trace is written have no end.
+  EXPECT_NE(std::string::npos, find_event("Open phase", 'B'));
+  EXPECT_EQ(std::string::npos, find_event("Open phase", 'E'));
+  EXPECT_EQ(std::string::npos, json.find("Not recorded"));
+}
+
+}  // namespace art
@@ -22,19 +22,31 @@
 #include <string>
 #include <utils/Trace.h>
 
+#include "base/startup_trace.h"
+
 namespace art {
 
 class ScopedTrace {
  public:
-  explicit ScopedTrace(const char* name) {
-    ATRACE_BEGIN(name);
+  // While the startup trace records, it also emits the systrace markers.
+  explicit ScopedTrace(const char* name) : recorded_(StartupTrace::Begin(name)) {
+    if (!recorded_) {
+      ATRACE_BEGIN(name);
+    }
   }
 
   explicit ScopedTrace(const std::string& name) : ScopedTrace(name.c_str()) {}
 
   ~ScopedTrace() {
-    ATRACE_END();
+    if (recorded_) {
+      StartupTrace::End();
+    } else {
+      ATRACE_END();
+    }
   }
+
+ private:
+  const bool recorded_;
 };
 
 }  // namespace art
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cha.h"
+
+#include "art_method-inl.h"
+#include "class_linker.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "linear_alloc.h"
+#include "mirror/class-inl.h"
+#include "oat_quick_method_header.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "stack.h"
+#include "thread.h"
+#include "thread_list.h"
+#include "utils.h"
+
+namespace art {
+
+void ClassHierarchyAnalysis::AddDependency(ArtMethod* method,
+                                           ArtMethod* dependent_method,
+                                           OatQuickMethodHeader* dependent_header) {
+  cha_dependency_map_[method].push_back(std::make_pair(dependent_method, dependent_header));
+}
+
+void ClassHierarchyAnalysis::RemoveDependentsWithMethodHeaders(
+    const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
+  for (auto map_it = cha_dependency_map_.begin(); map_it != cha_dependency_map_.end();) {
+    ListOfDependentPairs& dependents = map_it->second;
+    dependents.erase(
+        std::remove_if(dependents.begin(),
+                       dependents.end(),
+                       [&method_headers](const MethodAndMethodHeaderPair& dependent) {
+                         return method_headers.find(dependent.second) != method_headers.end();
+                       }),
+        dependents.end());
+    if (dependents.empty()) {
+      map_it = cha_dependency_map_.erase(map_it);
+    } else {
+      ++map_it;
+    }
+  }
+}
+
+void ClassHierarchyAnalysis::RemoveDependenciesForLinearAlloc(const LinearAlloc* linear_alloc) {
+  MutexLock mu(Thread::Current(), *Locks::cha_lock_);
+  for (auto map_it = cha_dependency_map_.begin(); map_it != cha_dependency_map_.end();) {
+    if (linear_alloc->ContainsUnsafe(map_it->first)) {
+      map_it = cha_dependency_map_.erase(map_it);
+      continue;
+    }
+    ListOfDependentPairs& dependents = map_it->second;
+    dependents.erase(
+        std::remove_if(dependents.begin(),
+                       dependents.end(),
+                       [linear_alloc](const MethodAndMethodHeaderPair& dependent) {
+                         return linear_alloc->ContainsUnsafe(dependent.first);
+                       }),
+        dependents.end());
+    if (dependents.empty()) {
+      map_it = cha_dependency_map_.erase(map_it);
+    } else {
+      ++map_it;
+    }
+  }
+}
+
+void ClassHierarchyAnalysis::UpdateAfterLoadingOf(Handle<mirror::Class> klass) {
+  Runtime* const runtime = Runtime::Current();
+  if (runtime->IsAotCompiler() || klass->IsInterface()) {
+    // The compiled code relying on the analysis is only generated by the JIT, and only
+    // class methods are devirtualized.
+    return;
+  }
+  PointerSize image_pointer_size = runtime->GetClassLinker()->GetImagePointerSize();
+
+  // Methods overridden by `klass` do not have a single implementation anymore. This
+  // includes the vtable entries `klass` gets from default methods.
+  std::vector<ArtMethod*> invalidated_methods;
+  mirror::Class* super_class = klass->GetSuperClass();
+  if (super_class != nullptr) {
+    int32_t super_vtable_length = super_class->GetVTableLength();
+    DCHECK_GE(klass->GetVTableLength(), super_vtable_length);
+    for (int32_t i = 0; i < super_vtable_length; ++i) {
+      ArtMethod* overridden = super_class->GetVTableEntry(i, image_pointer_size);
+      if (klass->GetVTableEntry(i, image_pointer_size) != overridden &&
+          overridden->HasSingleImplementation()) {
+        invalidated_methods.push_back(overridden);
+      }
+    }
+  }
+
+  // Methods declared by `klass` are not overridden yet, as `klass` has no subclass.
+  for (ArtMethod& method : klass->GetDeclaredVirtualMethods(image_pointer_size)) {
+    if (!method.IsAbstract()) {
+      method.SetHasSingleImplementation(true);
+    }
+  }
+
+  if (!invalidated_methods.empty()) {
+    InvalidateSingleImplementationMethods(invalidated_methods);
+  }
+}
+
+// Sets the should deoptimize flag of the frames executing invalidated compiled code.
+class CHAStackVisitor FINAL : public StackVisitor {
+ public:
+  CHAStackVisitor(Thread* thread,
+                  const std::unordered_set<OatQuickMethodHeader*>& method_headers)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kSkipInlinedFrames),
+        method_headers_(method_headers) {}
+
+  bool VisitFrame() OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+    ArtMethod* method = GetMethod();
+    if (method == nullptr ||
+        method->IsRuntimeMethod() ||
+        method->IsNative() ||
+        GetCurrentQuickFrame() == nullptr) {
+      // Not a frame of JIT compiled code.
+      return true;
+    }
+    OatQuickMethodHeader* method_header =
+        const_cast<OatQuickMethodHeader*>(GetCurrentOatQuickMethodHeader());
+    if (method_header != nullptr && method_headers_.count(method_header) != 0) {
+      // The frame deoptimizes at its next CHA guard.
+      uint8_t* should_deoptimize_addr = GetShouldDeoptimizeFlagAddr();
+      DCHECK(*should_deoptimize_addr == 0 || *should_deoptimize_addr == 1);
+      *should_deoptimize_addr = 1;
+    }
+    return true;
+  }
+
+ private:
+  const std::unordered_set<OatQuickMethodHeader*>& method_headers_;
+
+  DISALLOW_COPY_AND_ASSIGN(CHAStackVisitor);
+};
+
+void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
+    const std::vector<ArtMethod*>& methods) {
+  Thread* self = Thread::Current();
+  // Threads must not run past a CHA guard between the invalidation of the code and
+  // the update of its frames.
+  ScopedThreadSuspension sts(self, kSuspended);
+  ScopedSuspendAll ssa(__FUNCTION__);
+  MutexLock thread_list_mu(self, *Locks::thread_list_lock_);
+  MutexLock cha_mu(self, *Locks::cha_lock_);
+
+  std::unordered_set<OatQuickMethodHeader*> dependent_method_headers;
+  for (ArtMethod* method : methods) {
+    if (!method->HasSingleImplementation()) {
+      // Already invalidated by another class overriding it.
+      continue;
+    }
+    method->SetHasSingleImplementation(false);
+    auto it = cha_dependency_map_.find(method);
+    if (it == cha_dependency_map_.end()) {
+      continue;
+    }
+    for (const MethodAndMethodHeaderPair& dependent : it->second) {
+      VLOG(class_linker) << "CHA invalidates compiled code of " << PrettyMethod(dependent.first)
+                         << " overriding " << PrettyMethod(method);
+      jit::Jit* jit = Runtime::Current()->GetJit();
+      DCHECK(jit != nullptr);
+      jit->GetCodeCache()->InvalidateCompiledCodeFor(dependent.first, dependent.second);
+      dependent_method_headers.insert(dependent.second);
+    }
+    cha_dependency_map_.erase(it);
+  }
+
+  if (!dependent_method_headers.empty()) {
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      CHAStackVisitor visitor(thread, dependent_method_headers);
+      visitor.WalkStack();
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CHA_H_
+#define ART_RUNTIME_CHA_H_
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "handle.h"
+
+namespace art {
+
+class ArtMethod;
+class LinearAlloc;
+class OatQuickMethodHeader;
+
+namespace mirror {
+class Class;
+}  // namespace mirror
+
+/**
+ * Class Hierarchy Analysis (CHA) tracks which virtual methods of the classes loaded by
+ * this runtime are not overridden by any loaded class. Such a method has a single
+ * implementation, and JIT compiled code can call (and inline) it directly without
+ * checking the type of the receiver.
+ *
+ * The compiled code registers a dependency on the single implementation of each
+ * method it devirtualized. When a newly linked class overrides one of those methods:
+ *  - the dependent compiled code stops being used for new invocations,
+ *  - the frames currently executing it get their should deoptimize flag set, which
+ *    the compiled code checks before each devirtualized call.
+ *
+ * The analysis is not run by the AOT compiler, and classes coming from an image are
+ * not linked by the runtime, so their methods are never considered to have a single
+ * implementation.
+ */
+class ClassHierarchyAnalysis {
+ public:
+  // Compiled code of a dependent method, identified by its header since a method
+  // can have several versions of compiled code (e.g. OSR).
+  typedef std::pair<ArtMethod*, OatQuickMethodHeader*> MethodAndMethodHeaderPair;
+  typedef std::vector<MethodAndMethodHeaderPair> ListOfDependentPairs;
+
+  ClassHierarchyAnalysis() {}
+
+  // Records that the compiled code `dependent_header` of `dependent_method` assumes
+  // that `method` has a single implementation.
+  void AddDependency(ArtMethod* method,
+                     ArtMethod* dependent_method,
+                     OatQuickMethodHeader* dependent_header) REQUIRES(Locks::cha_lock_);
+
+  // Forgets about compiled code that is being freed.
+  void RemoveDependentsWithMethodHeaders(
+      const std::unordered_set<OatQuickMethodHeader*>& method_headers)
+      REQUIRES(Locks::cha_lock_);
+
+  // Forgets about the methods allocated in `linear_alloc`, whose class loader is unloaded.
+  void RemoveDependenciesForLinearAlloc(const LinearAlloc* linear_alloc)
+      REQUIRES(!Locks::cha_lock_);
+
+  // Updates the single implementation state of the virtual methods of `klass` and of the
+  // methods it overrides. Must be called once `klass` is linked, before it is resolved
+  // and can be instantiated.
+  void UpdateAfterLoadingOf(Handle<mirror::Class> klass)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::cha_lock_, !Locks::thread_list_lock_);
+
+ private:
+  // Clears the single implementation flag of `methods` and invalidates the compiled
+  // code depending on it.
+  void InvalidateSingleImplementationMethods(const std::vector<ArtMethod*>& methods)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::cha_lock_, !Locks::thread_list_lock_);
+
+  // Maps a method to the compiled code assuming it has a single implementation.
+  std::unordered_map<ArtMethod*, ListOfDependentPairs> cha_dependency_map_
+      GUARDED_BY(Locks::cha_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ClassHierarchyAnalysis);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CHA_H_
@@ -40,6 +40,7 @@
 #include "base/time_utils.h"
 #include "base/unix_file/fd_file.h"
 #include "base/value_object.h"
+#include "cha.h"
 #include "class_linker-inl.h"
 #include "class_table-inl.h"
 #include "compiler_callbacks.h"
@@ -58,6 +59,7 @@
 #include "image-inl.h"
 #include "intern_table.h"
 #include "interpreter/interpreter.h"
+#include "interpreter/interpreter_cache.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
 #include "jit/offline_profiling_info.h"
@@ -88,6 +90,8 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "utils.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
@@ -99,6 +103,10 @@ namespace art {
 static constexpr bool kSanityCheckObjects = kIsDebugBuild;
 static constexpr bool kVerifyArtMethodDeclaringClasses = kIsDebugBuild;
 
+// Native methods annotated with this are registered as fast JNI methods.
+static constexpr const char* kFastNativeAnnotationDescriptor =
+    "Ldalvik/annotation/optimization/FastNative;";
+
 static void ThrowNoClassDefFoundError(const char* fmt, ...)
     __attribute__((__format__(__printf__, 1, 2)))
     SHARED_REQUIRES(Locks::mutator_lock_);
@@ -1274,7 +1282,7 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
         const size_t num_strings = dex_file->NumStringIds();
         const size_t num_types = dex_file->NumTypeIds();
         const size_t num_methods = dex_file->NumMethodIds();
-        const size_t num_fields = dex_file->NumFieldIds();
+        const size_t num_fields = mirror::DexCache::NumResolvedFieldsFor(dex_file->NumFieldIds());
         CHECK_EQ(num_strings, dex_cache->NumStrings());
         CHECK_EQ(num_types, dex_cache->NumResolvedTypes());
         CHECK_EQ(num_methods, dex_cache->NumResolvedMethods());
@@ -1320,10 +1328,10 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
           dex_cache->SetResolvedMethods(methods);
         }
         if (num_fields != 0u) {
-          ArtField** const fields =
-              reinterpret_cast<ArtField**>(raw_arrays + layout.FieldsOffset());
+          mirror::FieldDexCachePair* const fields =
+              reinterpret_cast<mirror::FieldDexCachePair*>(raw_arrays + layout.FieldsOffset());
           for (size_t j = 0; kIsDebugBuild && j < num_fields; ++j) {
-            DCHECK(fields[j] == nullptr);
+            DCHECK(fields[j].field == nullptr);
           }
           std::copy_n(dex_cache->GetResolvedFields(), num_fields, fields);
           dex_cache->SetResolvedFields(fields);
@@ -1723,8 +1731,10 @@ bool ClassLinker::AddImageSpace(
   if (kSanityCheckObjects) {
     for (int32_t i = 0; i < dex_caches->GetLength(); i++) {
       auto* dex_cache = dex_caches->Get(i);
+      mirror::FieldDexCachePair* const fields = dex_cache->GetResolvedFields();
       for (size_t j = 0; j < dex_cache->NumResolvedFields(); ++j) {
-        auto* field = dex_cache->GetResolvedField(j, image_pointer_size_);
+        ArtField* field =
+            mirror::DexCache::GetFieldPairPtrSize(fields, j, image_pointer_size_).field;
         if (field != nullptr) {
           CHECK(field->GetDeclaringClass()->GetClass() != nullptr);
         }
@@ -2039,13 +2049,17 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data) {
   Runtime* const runtime = Runtime::Current();
   JavaVMExt* const vm = runtime->GetJavaVM();
   vm->DeleteWeakGlobalRef(self, data.weak_root);
+  // The interpreter caches may point to the fields and methods freed with the allocator.
+  InterpreterCache::InvalidateAll();
   // Notify the JIT that we need to remove the methods and/or profiling info.
   if (runtime->GetJit() != nullptr) {
+    runtime->GetJit()->RemoveCompilationTasksIn(self, *data.allocator);
     jit::JitCodeCache* code_cache = runtime->GetJit()->GetCodeCache();
     if (code_cache != nullptr) {
       code_cache->RemoveMethodsIn(self, *data.allocator);
     }
   }
+  runtime->GetClassHierarchyAnalysis()->RemoveDependenciesForLinearAlloc(data.allocator);
   delete data.allocator;
   delete data.class_table;
 }
@@ -2079,17 +2093,19 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
     raw_arrays = dex_file.GetOatDexFile()->GetDexCacheArrays();
   } else if (dex_file.NumStringIds() != 0u || dex_file.NumTypeIds() != 0u ||
       dex_file.NumMethodIds() != 0u || dex_file.NumFieldIds() != 0u) {
-    // Zero-initialized.
-    raw_arrays = reinterpret_cast<uint8_t*>(linear_alloc->Alloc(self, layout.Size()));
+    // Zero-initialized. Aligned for the atomic accesses to the resolved field pairs.
+    DCHECK_LE(layout.Alignment(), 16u);
+    raw_arrays = reinterpret_cast<uint8_t*>(linear_alloc->AllocAlign16(self, layout.Size()));
   }
+  const size_t num_fields = mirror::DexCache::NumResolvedFieldsFor(dex_file.NumFieldIds());
   GcRoot<mirror::String>* strings = (dex_file.NumStringIds() == 0u) ? nullptr :
       reinterpret_cast<GcRoot<mirror::String>*>(raw_arrays + layout.StringsOffset());
   GcRoot<mirror::Class>* types = (dex_file.NumTypeIds() == 0u) ? nullptr :
       reinterpret_cast<GcRoot<mirror::Class>*>(raw_arrays + layout.TypesOffset());
   ArtMethod** methods = (dex_file.NumMethodIds() == 0u) ? nullptr :
       reinterpret_cast<ArtMethod**>(raw_arrays + layout.MethodsOffset());
-  ArtField** fields = (dex_file.NumFieldIds() == 0u) ? nullptr :
-      reinterpret_cast<ArtField**>(raw_arrays + layout.FieldsOffset());
+  mirror::FieldDexCachePair* fields = (num_fields == 0u) ? nullptr :
+      reinterpret_cast<mirror::FieldDexCachePair*>(raw_arrays + layout.FieldsOffset());
   if (kIsDebugBuild) {
     // Sanity check to make sure all the dex cache arrays are empty. b/28992179
     for (size_t i = 0; i < dex_file.NumStringIds(); ++i) {
@@ -2101,8 +2117,8 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
     for (size_t i = 0; i < dex_file.NumMethodIds(); ++i) {
       CHECK(mirror::DexCache::GetElementPtrSize(methods, i, image_pointer_size_) == nullptr);
     }
-    for (size_t i = 0; i < dex_file.NumFieldIds(); ++i) {
-      CHECK(mirror::DexCache::GetElementPtrSize(fields, i, image_pointer_size_) == nullptr);
+    for (size_t i = 0; i < num_fields; ++i) {
+      CHECK(mirror::DexCache::GetFieldPairPtrSize(fields, i, image_pointer_size_).field == nullptr);
     }
   }
   dex_cache->Init(&dex_file,
@@ -2114,7 +2130,7 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
                   methods,
                   dex_file.NumMethodIds(),
                   fields,
-                  dex_file.NumFieldIds(),
+                  num_fields,
                   image_pointer_size_);
   return dex_cache.Get();
 }
@@ -2583,6 +2599,10 @@ mirror::Class* ClassLinker::DefineClass(Thread* self,
   // Notify native debugger of the new class and its layout.
   jit::Jit::NewTypeLoadedIfUsingJit(h_new_class.Get());
 
+  if (background_verification_thread_pool_ != nullptr) {
+    MaybeVerifyInBackground(self, h_new_class);
+  }
+
   return h_new_class.Get();
 }
 
@@ -2798,7 +2818,7 @@ bool ClassLinker::ShouldUseInterpreterEntrypoint(ArtMethod* method, const void*
     return !runtime->GetHeap()->IsInBootImageOatFile(quick_code);
   }
 
-  if (Dbg::IsDebuggerActive()) {
+  if (Dbg::IsDebuggerActive() && !runtime->DebuggerKeepsCompiledCode()) {
     // Boot image classes may be AOT-compiled as non-debuggable.
     // This is not suitable for the Java debugger, so ignore the AOT code.
     return runtime->GetHeap()->IsInBootImageOatFile(quick_code);
@@ -3184,6 +3204,15 @@ void ClassLinker::LoadMethod(Thread* self,
       }
     }
   }
+  if (UNLIKELY((access_flags & kAccNative) != 0u) &&
+      dex_file.IsMethodAnnotationPresent(*klass->GetClassDef(),
+                                         dex_method_idx,
+                                         kFastNativeAnnotationDescriptor,
+                                         DexFile::kDexVisibilityBuild)) {
+    // The same as registering the native method with a '!' prefixed signature: calls stay
+    // runnable and skip the thread state transitions.
+    access_flags |= kAccFastNative;
+  }
   dst->SetAccessFlags(access_flags);
 }
 
@@ -3297,6 +3326,17 @@ mirror::DexCache* ClassLinker::FindDexCache(Thread* self,
   return FindDexCacheLocked(self, dex_file, allow_failure);
 }
 
+mirror::DexCache* ClassLinker::FindDexCache(Thread* self, const OatDexFile& oat_dex_file) {
+  ReaderMutexLock mu(self, dex_lock_);
+  for (const DexCacheData& data : dex_caches_) {
+    // Avoid decoding (and read barriers) other unrelated dex caches.
+    if (data.dex_file->GetOatDexFile() == &oat_dex_file) {
+      return down_cast<mirror::DexCache*>(self->DecodeJObject(data.weak_root));
+    }
+  }
+  return nullptr;
+}
+
 mirror::DexCache* ClassLinker::FindDexCacheLocked(Thread* self,
                                                   const DexFile& dex_file,
                                                   bool allow_failure) {
@@ -3476,6 +3516,7 @@ mirror::Class* ClassLinker::CreateArrayClass(Thread* self, const char* descripto
   }
   mirror::Class::SetStatus(new_class, mirror::Class::kStatusLoaded, self);
   new_class->PopulateEmbeddedVTable(image_pointer_size_);
+  new_class->PopulateSuperclassDisplay();
   ImTable* object_imt = java_lang_Object->GetImt(image_pointer_size_);
   new_class->SetImt(object_imt, image_pointer_size_);
   mirror::Class::SetStatus(new_class, mirror::Class::kStatusInitialized, self);
@@ -3563,12 +3604,34 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
     }
     LOG(INFO) << "Loaded class " << descriptor << source;
   }
-  WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
+  Thread* const self = Thread::Current();
   mirror::ClassLoader* const class_loader = klass->GetClassLoader();
-  ClassTable* const class_table = InsertClassTableForClassLoader(class_loader);
-  mirror::Class* existing = class_table->Lookup(descriptor, hash);
-  if (existing != nullptr) {
-    return existing;
+  VerifyObject(klass);
+  bool inserted = false;
+  {
+    // Each class table has its own lock, so threads loading classes for different class loaders
+    // only need to share classlinker_classes_lock_. It is taken exclusively only to create the
+    // class table or to log the new root for the GC.
+    ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    ClassTable* const class_table = ClassTableForClassLoader(class_loader);
+    if (class_table != nullptr && !log_new_class_table_roots_) {
+      mirror::Class* existing = class_table->LookupOrInsert(descriptor, klass, hash);
+      if (existing != nullptr) {
+        return existing;
+      }
+      inserted = true;
+    }
+  }
+  if (!inserted) {
+    WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    ClassTable* const class_table = InsertClassTableForClassLoader(class_loader);
+    mirror::Class* existing = class_table->LookupOrInsert(descriptor, klass, hash);
+    if (existing != nullptr) {
+      return existing;
+    }
+    if (log_new_class_table_roots_) {
+      new_class_roots_.push_back(GcRoot<mirror::Class>(klass));
+    }
   }
   if (kIsDebugBuild &&
       !klass->IsTemp() &&
@@ -3576,20 +3639,15 @@ mirror::Class* ClassLinker::InsertClass(const char* descriptor, mirror::Class* k
       dex_cache_boot_image_class_lookup_required_) {
     // Check a class loaded with the system class loader matches one in the image if the class
     // is in the image.
-    existing = LookupClassFromBootImage(descriptor);
-    if (existing != nullptr) {
-      CHECK_EQ(klass, existing);
+    mirror::Class* const image_class = LookupClassFromBootImage(descriptor);
+    if (image_class != nullptr) {
+      CHECK_EQ(klass, image_class);
     }
   }
-  VerifyObject(klass);
-  class_table->InsertWithHash(klass, hash);
   if (class_loader != nullptr) {
     // This is necessary because we need to have the card dirtied for remembered sets.
     Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(class_loader);
   }
-  if (log_new_class_table_roots_) {
-    new_class_roots_.push_back(GcRoot<mirror::Class>(klass));
-  }
   return nullptr;
 }
 
@@ -4005,6 +4063,86 @@ void ClassLinker::VerifyClass(Thread* self, Handle<mirror::Class> klass, LogSeve
   }
 }
 
+// Background thread priority, as ANDROID_PRIORITY_BACKGROUND.
+static constexpr int kBackgroundVerificationThreadPriority = 10;
+
+class BackgroundVerificationTask FINAL : public Task {
+ public:
+  explicit BackgroundVerificationTask(jobject klass) : klass_(klass) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Class> klass(hs.NewHandle(soa.Decode<mirror::Class*>(klass_)));
+    // The class may have been verified by the thread that initializes it in the meantime.
+    if (klass->GetStatus() == mirror::Class::kStatusResolved) {
+      Runtime::Current()->GetClassLinker()->VerifyClass(self, klass);
+      // A verification error is recorded in the class, and thrown again to the thread that
+      // initializes it.
+      self->ClearException();
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    Runtime::Current()->GetJavaVM()->DeleteGlobalRef(Thread::Current(), klass_);
+    delete this;
+  }
+
+ private:
+  const jobject klass_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundVerificationTask);
+};
+
+void ClassLinker::StartBackgroundVerification(Thread* self) {
+  DCHECK(background_verification_thread_pool_ == nullptr);
+  size_t num_threads = std::max(1, static_cast<int>(sysconf(_SC_NPROCESSORS_CONF)) / 2);
+  std::unique_ptr<ThreadPool> thread_pool(
+      new ThreadPool("Background verification thread pool", num_threads));
+  thread_pool->SetPthreadPriority(kBackgroundVerificationThreadPriority);
+  thread_pool->StartWorkers(self);
+  ScopedSuspendAll ssa(__FUNCTION__);
+  background_verification_thread_pool_ = std::move(thread_pool);
+}
+
+void ClassLinker::StopBackgroundVerification(Thread* self) {
+  if (background_verification_thread_pool_ == nullptr) {
+    return;
+  }
+  std::unique_ptr<ThreadPool> thread_pool;
+  {
+    // Threads defining classes check the field with the mutator lock held.
+    ScopedSuspendAll ssa(__FUNCTION__);
+    thread_pool = std::move(background_verification_thread_pool_);
+  }
+  thread_pool->StopWorkers(self);
+  thread_pool->RemoveAllTasks(self);
+  thread_pool->Wait(self, false, false);
+}
+
+void ClassLinker::MaybeVerifyInBackground(Thread* self, Handle<mirror::Class> klass) {
+  // Only the app class loader, whose classes are found without running Java code, so that the
+  // verifier does not run class loader code on the background threads.
+  mirror::ClassLoader* class_loader = klass->GetClassLoader();
+  ScopedObjectAccessUnchecked soa(self);
+  if (class_loader == nullptr ||
+      class_loader->GetClass() !=
+          soa.Decode<mirror::Class*>(WellKnownClasses::dalvik_system_PathClassLoader) ||
+      !IsBootClassLoader(soa, class_loader->GetParent())) {
+    return;
+  }
+  // Classes verified at compile time only need a look at the oat file.
+  mirror::Class::Status oat_file_class_status(mirror::Class::kStatusNotReady);
+  if (VerifyClassUsingOatFile(*klass->GetDexCache()->GetDexFile(),
+                              klass.Get(),
+                              oat_file_class_status)) {
+    return;
+  }
+  jobject global_klass = Runtime::Current()->GetJavaVM()->AddGlobalRef(self, klass.Get());
+  background_verification_thread_pool_->AddTask(self,
+                                                new BackgroundVerificationTask(global_klass));
+}
+
 void ClassLinker::EnsureSkipAccessChecksMethods(Handle<mirror::Class> klass) {
   if (!klass->WasVerificationAttempted()) {
     klass->SetSkipAccessChecksFlagOnAllMethods(image_pointer_size_);
@@ -5117,10 +5255,14 @@ bool ClassLinker::LinkClass(Thread* self,
 
     if (klass->ShouldHaveEmbeddedVTable()) {
       klass->PopulateEmbeddedVTable(image_pointer_size_);
+      klass->PopulateSuperclassDisplay();
     }
     if (klass->ShouldHaveImt()) {
       klass->SetImt(imt, image_pointer_size_);
     }
+    // Update the single implementation state of the methods klass overrides. This has
+    // to happen before klass is resolved, which allows instantiating it.
+    Runtime::Current()->GetClassHierarchyAnalysis()->UpdateAfterLoadingOf(klass);
     // This will notify waiters on klass that saw the not yet resolved
     // class in the class_table_ during EnsureResolved.
     mirror::Class::SetStatus(klass, mirror::Class::kStatusResolved, self);
@@ -5147,30 +5289,48 @@ bool ClassLinker::LinkClass(Thread* self,
     ObjectLock<mirror::Class> lock(self, h_new_class);
     FixupTemporaryDeclaringClass(klass.Get(), h_new_class.Get());
 
+    mirror::ClassLoader* const class_loader = h_new_class.Get()->GetClassLoader();
+    const size_t hash = ComputeModifiedUtf8Hash(descriptor);
+    mirror::Class* existing = nullptr;
+    bool updated = false;
     {
-      WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
-      mirror::ClassLoader* const class_loader = h_new_class.Get()->GetClassLoader();
-      ClassTable* const table = InsertClassTableForClassLoader(class_loader);
-      mirror::Class* existing = table->UpdateClass(descriptor, h_new_class.Get(),
-                                                   ComputeModifiedUtf8Hash(descriptor));
-      if (class_loader != nullptr) {
-        // We updated the class in the class table, perform the write barrier so that the GC knows
-        // about the change.
-        Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(class_loader);
-      }
-      CHECK_EQ(existing, klass.Get());
-      if (kIsDebugBuild && class_loader == nullptr && dex_cache_boot_image_class_lookup_required_) {
-        // Check a class loaded with the system class loader matches one in the image if the class
-        // is in the image.
-        mirror::Class* const image_class = LookupClassFromBootImage(descriptor);
-        if (image_class != nullptr) {
-          CHECK_EQ(klass.Get(), existing) << descriptor;
-        }
+      // The temporary class was inserted into the table already, so it exists and its own lock
+      // is enough to replace the entry, unless the new root needs to be logged for the GC.
+      ReaderMutexLock mu(self, *Locks::classlinker_classes_lock_);
+      if (!log_new_class_table_roots_) {
+        ClassTable* const table = ClassTableForClassLoader(class_loader);
+        DCHECK(table != nullptr);
+        existing = table->UpdateClass(descriptor, h_new_class.Get(), hash);
+        updated = true;
       }
+    }
+    if (!updated) {
+      WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+      ClassTable* const table = ClassTableForClassLoader(class_loader);
+      DCHECK(table != nullptr);
+      existing = table->UpdateClass(descriptor, h_new_class.Get(), hash);
       if (log_new_class_table_roots_) {
         new_class_roots_.push_back(GcRoot<mirror::Class>(h_new_class.Get()));
       }
     }
+    if (class_loader != nullptr) {
+      // We updated the class in the class table, perform the write barrier so that the GC knows
+      // about the change.
+      Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(class_loader);
+    }
+    CHECK_EQ(existing, klass.Get());
+    if (kIsDebugBuild && class_loader == nullptr && dex_cache_boot_image_class_lookup_required_) {
+      // Check a class loaded with the system class loader matches one in the image if the class
+      // is in the image.
+      mirror::Class* const image_class = LookupClassFromBootImage(descriptor);
+      if (image_class != nullptr) {
+        CHECK_EQ(klass.Get(), existing) << descriptor;
+      }
+    }
+
+    // Update the single implementation state of the methods the class overrides, before
+    // it can be instantiated.
+    Runtime::Current()->GetClassHierarchyAnalysis()->UpdateAfterLoadingOf(h_new_class);
 
     // This will notify waiters on temp class that saw the not yet resolved class in the
     // class_table_ during EnsureResolved.
@@ -6916,8 +7076,12 @@ bool ClassLinker::LinkInterfaceMethods(
                                                                         method_size,
                                                                         method_alignment);
     const size_t old_methods_ptr_size = (old_methods != nullptr) ? old_size : 0;
+    // Use the allocator the methods were loaded with: the array can then often be extended in
+    // place, for example when the super class and interfaces come from another class loader, and
+    // the new array goes away with the class loader.
+    LinearAlloc* const linear_alloc = GetAllocatorForClassLoader(klass->GetClassLoader());
     auto* methods = reinterpret_cast<LengthPrefixedArray<ArtMethod>*>(
-        runtime->GetLinearAlloc()->Realloc(self, old_methods, old_methods_ptr_size, new_size));
+        linear_alloc->Realloc(self, old_methods, old_methods_ptr_size, new_size));
     if (UNLIKELY(methods == nullptr)) {
       self->AssertPendingOOMException();
       self->EndAssertNoThreadSuspension(old_cause);
@@ -61,6 +61,7 @@ class InternTable;
 template<class T> class ObjectLock;
 class Runtime;
 class ScopedObjectAccessAlreadyRunnable;
+class ThreadPool;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
 
 enum VisitRootFlags : uint8_t;
@@ -414,6 +415,10 @@ class ClassLinker {
                                  bool allow_failure = false)
       REQUIRES(!dex_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
+  // Find the dex cache of the registered dex file opened from `oat_dex_file`, or null.
+  mirror::DexCache* FindDexCache(Thread* self, const OatDexFile& oat_dex_file)
+      REQUIRES(!dex_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void FixupDexCaches(ArtMethod* resolution_method)
       REQUIRES(!dex_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -468,6 +473,12 @@ class ClassLinker {
                                mirror::Class::Status& oat_file_class_status)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!dex_lock_);
+
+  // Start verifying, on a pool of background threads, the classes of the app class loader that
+  // are not verified in their oat file, as soon as they are defined. A thread that initializes a
+  // class then only waits for the verification of that class if it is in progress.
+  void StartBackgroundVerification(Thread* self) REQUIRES(!Locks::mutator_lock_);
+  void StopBackgroundVerification(Thread* self) REQUIRES(!Locks::mutator_lock_);
   void ResolveClassExceptionHandlerTypes(Handle<mirror::Class> klass)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!dex_lock_);
@@ -1028,6 +1039,11 @@ class ClassLinker {
   void EnsureSkipAccessChecksMethods(Handle<mirror::Class> c)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Queue the verification of a newly defined class, see StartBackgroundVerification.
+  void MaybeVerifyInBackground(Thread* self, Handle<mirror::Class> klass)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!dex_lock_);
+
   mirror::Class* LookupClassFromBootImage(const char* descriptor)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -1168,6 +1184,10 @@ class ClassLinker {
   // Image pointer size.
   PointerSize image_pointer_size_;
 
+  // Verifies classes in the background, see StartBackgroundVerification. Only changed with all
+  // threads suspended or before other threads define classes.
+  std::unique_ptr<ThreadPool> background_verification_thread_pool_;
+
   friend class ImageDumper;  // for DexLock
   friend class ImageWriter;  // for GetClassRoots
   friend class JniCompilerTest;  // for GetRuntimeQuickGenericJniStub
@@ -1150,6 +1150,34 @@ TEST_F(ClassLinkerTest, ValidatePredefinedClassSizes) {
   EXPECT_EQ(c->GetClassSize(), mirror::DexCache::ClassSize(kRuntimePointerSize));
 }
 
+TEST_F(ClassLinkerTest, SuperclassDisplay) {
+  ScopedObjectAccess soa(Thread::Current());
+  ScopedNullHandle<mirror::ClassLoader> class_loader;
+  const char* descriptors[] = {
+      "Ljava/lang/Object;",
+      "Ljava/lang/String;",
+      "Ljava/util/ArrayList;",
+      "[Ljava/lang/Object;",
+      "[I",
+  };
+  for (const char* descriptor : descriptors) {
+    mirror::Class* c = class_linker_->FindClass(soa.Self(), descriptor, class_loader);
+    ASSERT_TRUE(c != nullptr) << descriptor;
+    ASSERT_TRUE(c->ShouldHaveEmbeddedVTable()) << descriptor;
+    uint32_t depth = c->Depth();
+    mirror::Class* expected = c;
+    for (uint32_t d = depth; d != 0; --d) {
+      if (d <= mirror::Class::kSuperclassDisplayLength) {
+        EXPECT_EQ(expected, c->GetSuperclassDisplayEntry(d - 1)) << descriptor << " " << d;
+      }
+      expected = expected->GetSuperClass();
+    }
+    for (uint32_t d = depth + 1; d <= mirror::Class::kSuperclassDisplayLength; ++d) {
+      EXPECT_TRUE(c->GetSuperclassDisplayEntry(d - 1) == nullptr) << descriptor << " " << d;
+    }
+  }
+}
+
 static void CheckMethod(ArtMethod* method, bool verified)
     SHARED_REQUIRES(Locks::mutator_lock_) {
   if (!method->IsNative() && !method->IsAbstract()) {
@@ -1266,4 +1294,24 @@ TEST_F(ClassLinkerTest, RegisterDexFileName) {
   }
 }
 
+TEST_F(ClassLinkerTest, FastNativeAnnotation) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("FastNativeMethods"))));
+  Handle<mirror::Class> klass(hs.NewHandle(
+      class_linker_->FindClass(soa.Self(), "LFastNativeMethods;", class_loader)));
+  ASSERT_TRUE(klass.Get() != nullptr);
+
+  ArtMethod* fast = klass->FindDirectMethod("fastAdd", "(II)I", kRuntimePointerSize);
+  ArtMethod* normal = klass->FindDirectMethod("normalAdd", "(II)I", kRuntimePointerSize);
+  ArtMethod* deprecated = klass->FindDirectMethod("deprecatedAdd", "(II)I", kRuntimePointerSize);
+  ASSERT_TRUE(fast != nullptr);
+  ASSERT_TRUE(normal != nullptr);
+  ASSERT_TRUE(deprecated != nullptr);
+  EXPECT_TRUE(fast->IsFastNative());
+  EXPECT_FALSE(normal->IsFastNative());
+  EXPECT_FALSE(deprecated->IsFastNative());
+}
+
 }  // namespace art
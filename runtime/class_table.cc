@@ -20,15 +20,30 @@
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      frozen_class_sets_(nullptr) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
+  frozen_class_sets_storage_.emplace_back(new FrozenClassSets());
+  frozen_class_sets_.StoreRelaxed(frozen_class_sets_storage_.back().get());
+}
+
+void ClassTable::PublishFrozenClassSets() {
+  std::unique_ptr<FrozenClassSets> frozen(new FrozenClassSets());
+  frozen->reserve(classes_.size() - 1u);
+  for (size_t i = 0; i + 1u < classes_.size(); ++i) {
+    frozen->push_back(&classes_[i]);
+  }
+  frozen_class_sets_.StoreRelease(frozen.get());
+  frozen_class_sets_storage_.push_back(std::move(frozen));
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   classes_.push_back(ClassSet());
+  PublishFrozenClassSets();
 }
 
 bool ClassTable::Contains(mirror::Class* klass) {
@@ -92,14 +107,26 @@ size_t ClassTable::NumNonZygoteClasses() const {
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
+  const FrozenClassSets* frozen = frozen_class_sets_.LoadAcquire();
+  for (const ClassSet* class_set : *frozen) {
+    auto it = class_set->FindWithHash(descriptor, hash);
+    if (it != class_set->end()) {
+      return it->Read();
+    }
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(descriptor, hash);
-    if (it != class_set.end()) {
-     return it->Read();
+  if (UNLIKELY(frozen != frozen_class_sets_.LoadRelaxed())) {
+    // A set was frozen or added since, search them all again.
+    for (ClassSet& class_set : classes_) {
+      auto it = class_set.FindWithHash(descriptor, hash);
+      if (it != class_set.end()) {
+        return it->Read();
+      }
     }
+    return nullptr;
   }
-  return nullptr;
+  auto it = classes_.back().FindWithHash(descriptor, hash);
+  return (it != classes_.back().end()) ? it->Read() : nullptr;
 }
 
 void ClassTable::Insert(mirror::Class* klass) {
@@ -112,6 +139,20 @@ void ClassTable::InsertWithHash(mirror::Class* klass, size_t hash) {
   classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
 }
 
+mirror::Class* ClassTable::LookupOrInsert(const char* descriptor,
+                                          mirror::Class* klass,
+                                          size_t hash) {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  for (ClassSet& class_set : classes_) {
+    auto it = class_set.FindWithHash(descriptor, hash);
+    if (it != class_set.end()) {
+      return it->Read();
+    }
+  }
+  classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  return nullptr;
+}
+
 bool ClassTable::Remove(const char* descriptor) {
   WriterMutexLock mu(Thread::Current(), lock_);
   for (ClassSet& class_set : classes_) {
@@ -186,7 +227,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.push_front(std::move(set));
+  PublishFrozenClassSets();
 }
 
 void ClassTable::ClearStrongRoots() {
@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -111,6 +114,7 @@ class ClassTable {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor. Returns null if there are none.
+  // The frozen class sets are searched without holding lock_.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -128,7 +132,16 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Returns true if the class was found and removed, false otherwise.
+  // Insert klass unless a class with the same descriptor is already present, in which case that
+  // class is returned. Returns null if klass was inserted. The check and the insertion are done
+  // atomically with respect to other inserts into this table.
+  mirror::Class* LookupOrInsert(const char* descriptor, mirror::Class* klass, size_t hash)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Returns true if the class was found and removed, false otherwise. Removing a class from a
+  // frozen class set is only allowed while no other thread can call Lookup, as done by the image
+  // writer.
   bool Remove(const char* descriptor)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -163,10 +176,22 @@ class ClassTable {
   }
 
  private:
+  typedef std::vector<const ClassSet*> FrozenClassSets;
+
+  // Publish the class sets before the latest one for Lookup.
+  void PublishFrozenClassSets() REQUIRES(lock_);
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
-  // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // We have several class sets to help prevent dirty pages after the zygote forks by calling
+  // FreezeSnapshot. Only the last one is modified after that, and a deque keeps the address of
+  // the others stable when sets are added.
+  std::deque<ClassSet> classes_ GUARDED_BY(lock_);
+  // All the class sets but the last one, searched by Lookup without lock_. A new array is
+  // published whenever a set is frozen or added. Lookups that started before may still use an
+  // old array, so they are only freed with the table; there is one per zygote fork or app image.
+  Atomic<const FrozenClassSets*> frozen_class_sets_;
+  std::vector<std::unique_ptr<FrozenClassSets>> frozen_class_sets_storage_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -625,7 +625,10 @@ void Dbg::GoActive() {
   // entry points of methods in boot image to interpreter bridge.
   // However, the performance cost of this is non-negligible during native-debugging due to the
   // forced JIT, so we keep the AOT code in that case in exchange for limited native debugging.
-  if (!runtime->GetInstrumentation()->IsForcedInterpretOnly() && !runtime->IsNativeDebuggable()) {
+  // With -Xdebuggerkeepscompiledcode the AOT code is also kept, breakpoints in the boot class
+  // path then need full deoptimization.
+  if (!runtime->GetInstrumentation()->IsForcedInterpretOnly() && !runtime->IsNativeDebuggable() &&
+      !runtime->DebuggerKeepsCompiledCode()) {
     ScopedObjectAccess soa(self);
     UpdateEntryPointsClassVisitor visitor(runtime->GetInstrumentation());
     runtime->GetClassLinker()->VisitClasses(&visitor);
@@ -3116,12 +3119,19 @@ void Dbg::ProcessDeoptimizationRequest(const DeoptimizationRequest& request) {
       break;
     case DeoptimizationRequest::kSelectiveDeoptimization:
       VLOG(jdwp) << "Deoptimize method " << PrettyMethod(request.Method()) << " ...";
-      instrumentation->Deoptimize(request.Method());
+      // Non debuggable code, e.g. JIT code of a non debuggable app, may have the method inlined.
+      if (!instrumentation->DeoptimizeWithInliningCallers(request.Method())) {
+        instrumentation->Deoptimize(request.Method());
+      }
       VLOG(jdwp) << "Deoptimize method " << PrettyMethod(request.Method()) << " DONE";
       break;
     case DeoptimizationRequest::kSelectiveUndeoptimization:
       VLOG(jdwp) << "Undeoptimize method " << PrettyMethod(request.Method()) << " ...";
-      instrumentation->Undeoptimize(request.Method());
+      if (instrumentation->IsDeoptimizedWithInliningCallers(request.Method())) {
+        instrumentation->UndeoptimizeWithInliningCallers(request.Method());
+      } else {
+        instrumentation->Undeoptimize(request.Method());
+      }
       VLOG(jdwp) << "Undeoptimize method " << PrettyMethod(request.Method()) << " DONE";
       break;
     default:
@@ -3306,11 +3316,17 @@ static DeoptimizationRequest::Kind GetRequiredDeoptimizationKind(Thread* self,
     // deoptimize with defaults because we do not know everywhere they are used. It is possible some
     // of the copies could be missed.
     // TODO Deoptimizing on default methods might not be necessary in all cases.
-    bool need_full_deoptimization = m->IsDefault();
-    if (need_full_deoptimization) {
+    instrumentation::Instrumentation* instrumentation = Runtime::Current()->GetInstrumentation();
+    if (m->IsDefault()) {
       VLOG(jdwp) << "Need full deoptimization because of copying of method "
                  << PrettyMethod(m);
       return DeoptimizationRequest::kFullDeoptimization;
+    } else if (Runtime::Current()->DebuggerKeepsCompiledCode() &&
+               !instrumentation->CanDeoptimizeWithInliningCallers(m)) {
+      // The method may be an intrinsic or pattern replaced in the kept non debuggable code.
+      VLOG(jdwp) << "Need full deoptimization because of compiled code using method "
+                 << PrettyMethod(m);
+      return DeoptimizationRequest::kFullDeoptimization;
     } else {
       // We don't need to deoptimize if the method has not been compiled.
       const bool is_compiled = m->HasAnyCompiledCode();
@@ -3621,9 +3637,9 @@ class ScopedDebuggerThreadSuspension {
         self_suspend_ = true;
       } else {
         Thread* suspended_thread;
+        jobject thread_peer = Dbg::GetObjectRegistry()->GetJObject(thread_id);
         {
           ScopedThreadSuspension sts(self, kWaitingForDebuggerSuspension);
-          jobject thread_peer = Dbg::GetObjectRegistry()->GetJObject(thread_id);
           bool timed_out;
           ThreadList* const thread_list = Runtime::Current()->GetThreadList();
           suspended_thread = thread_list->SuspendThreadByPeer(thread_peer, true, true, &timed_out);
@@ -24,6 +24,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 
@@ -343,7 +344,19 @@ std::unique_ptr<const DexFile> DexFile::Open(const ZipArchive& zip_archive,
     *error_code = ZipOpenErrorCode::kDexFileError;
     return nullptr;
   }
-  std::unique_ptr<MemMap> map(zip_entry->ExtractToMemMap(location.c_str(), entry_name, error_msg));
+  std::unique_ptr<MemMap> map;
+  if (zip_entry->IsUncompressed() && zip_entry->IsAlignedTo(alignof(Header))) {
+    // Map the dex file straight from the zip file, its pages stay clean and shared.
+    map.reset(zip_entry->MapDirectlyFromFile(location.c_str(), error_msg));
+    if (map == nullptr) {
+      LOG(WARNING) << "Failed to map '" << entry_name << "' directly from '" << location
+                   << "', extracting it instead: " << *error_msg;
+      error_msg->clear();
+    }
+  }
+  if (map == nullptr) {
+    map.reset(zip_entry->ExtractToMemMap(location.c_str(), entry_name, error_msg));
+  }
   if (map.get() == nullptr) {
     *error_msg = StringPrintf("Failed to extract '%s' from '%s': %s", entry_name, location.c_str(),
                               error_msg->c_str());
@@ -358,7 +371,8 @@ std::unique_ptr<const DexFile> DexFile::Open(const ZipArchive& zip_archive,
     *error_code = ZipOpenErrorCode::kDexFileError;
     return nullptr;
   }
-  if (!dex_file->DisableWrite()) {
+  // Extracted dex files are writable, dex files mapped from the zip file are read only already.
+  if (!dex_file->IsReadOnly() && !dex_file->DisableWrite()) {
     *error_msg = StringPrintf("Failed to make dex file '%s' read only", location.c_str());
     *error_code = ZipOpenErrorCode::kMakeReadOnlyError;
     return nullptr;
@@ -666,6 +680,11 @@ const DexFile::StringId* DexFile::FindStringId(const char* string) const {
 }
 
 const DexFile::TypeId* DexFile::FindTypeId(const char* string) const {
+  if (LIKELY(lookup_table_ != nullptr) && lookup_table_->HasTypeIds()) {
+    const uint32_t type_idx = lookup_table_->LookupTypeId(string, ComputeModifiedUtf8Hash(string));
+    return (type_idx != DexFile::kDexNoIndex) ? &GetTypeId(type_idx) : nullptr;
+  }
+
   int32_t lo = 0;
   int32_t hi = NumTypeIds() - 1;
   while (hi >= lo) {
@@ -1204,6 +1223,29 @@ static bool IsVisibilityCompatible(uint32_t actual, uint32_t expected) {
   return actual == expected;
 }
 
+static uint32_t GetAnnotatedIndex(const DexFile::FieldAnnotationsItem& item) {
+  return item.field_idx_;
+}
+
+static uint32_t GetAnnotatedIndex(const DexFile::MethodAnnotationsItem& item) {
+  return item.method_idx_;
+}
+
+static uint32_t GetAnnotatedIndex(const DexFile::ParameterAnnotationsItem& item) {
+  return item.method_idx_;
+}
+
+// Returns the item for `index` in the field, method or parameter annotations of a directory, or
+// null if there is none. The verifier checked that the items are sorted by index.
+template <typename Item>
+static const Item* SearchAnnotationsItems(const Item* items, uint32_t count, uint32_t index) {
+  const Item* end = items + count;
+  const Item* it = std::lower_bound(items, end, index, [](const Item& item, uint32_t idx) {
+    return GetAnnotatedIndex(item) < idx;
+  });
+  return (it != end && GetAnnotatedIndex(*it) == index) ? it : nullptr;
+}
+
 const DexFile::AnnotationSetItem* DexFile::FindAnnotationSetForField(ArtField* field) const {
   mirror::Class* klass = field->GetDeclaringClass();
   const AnnotationsDirectoryItem* annotations_dir = GetAnnotationsDirectory(*klass->GetClassDef());
@@ -1214,14 +1256,9 @@ const DexFile::AnnotationSetItem* DexFile::FindAnnotationSetForField(ArtField* f
   if (field_annotations == nullptr) {
     return nullptr;
   }
-  uint32_t field_index = field->GetDexFieldIndex();
-  uint32_t field_count = annotations_dir->fields_size_;
-  for (uint32_t i = 0; i < field_count; ++i) {
-    if (field_annotations[i].field_idx_ == field_index) {
-      return GetFieldAnnotationSetItem(field_annotations[i]);
-    }
-  }
-  return nullptr;
+  const FieldAnnotationsItem* item = SearchAnnotationsItems(
+      field_annotations, annotations_dir->fields_size_, field->GetDexFieldIndex());
+  return (item != nullptr) ? GetFieldAnnotationSetItem(*item) : nullptr;
 }
 
 mirror::Object* DexFile::GetAnnotationForField(ArtField* field,
@@ -1277,14 +1314,9 @@ const DexFile::AnnotationSetItem* DexFile::FindAnnotationSetForMethod(ArtMethod*
   if (method_annotations == nullptr) {
     return nullptr;
   }
-  uint32_t method_index = method->GetDexMethodIndex();
-  uint32_t method_count = annotations_dir->methods_size_;
-  for (uint32_t i = 0; i < method_count; ++i) {
-    if (method_annotations[i].method_idx_ == method_index) {
-      return GetMethodAnnotationSetItem(method_annotations[i]);
-    }
-  }
-  return nullptr;
+  const MethodAnnotationsItem* item = SearchAnnotationsItems(
+      method_annotations, annotations_dir->methods_size_, method->GetDexMethodIndex());
+  return (item != nullptr) ? GetMethodAnnotationSetItem(*item) : nullptr;
 }
 
 const DexFile::ParameterAnnotationsItem* DexFile::FindAnnotationsItemForMethod(ArtMethod* method)
@@ -1298,14 +1330,8 @@ const DexFile::ParameterAnnotationsItem* DexFile::FindAnnotationsItemForMethod(A
   if (parameter_annotations == nullptr) {
     return nullptr;
   }
-  uint32_t method_index = method->GetDexMethodIndex();
-  uint32_t parameter_count = annotations_dir->parameters_size_;
-  for (uint32_t i = 0; i < parameter_count; ++i) {
-    if (parameter_annotations[i].method_idx_ == method_index) {
-      return &parameter_annotations[i];
-    }
-  }
-  return nullptr;
+  return SearchAnnotationsItems(
+      parameter_annotations, annotations_dir->parameters_size_, method->GetDexMethodIndex());
 }
 
 mirror::Object* DexFile::GetAnnotationDefaultValue(ArtMethod* method) const {
@@ -1416,6 +1442,41 @@ bool DexFile::IsMethodAnnotationPresent(ArtMethod* method, Handle<mirror::Class>
   return annotation_item != nullptr;
 }
 
+bool DexFile::IsMethodAnnotationPresent(const ClassDef& class_def,
+                                        uint32_t method_idx,
+                                        const char* descriptor,
+                                        uint32_t visibility) const {
+  const AnnotationsDirectoryItem* annotations_dir = GetAnnotationsDirectory(class_def);
+  if (annotations_dir == nullptr) {
+    return false;
+  }
+  const MethodAnnotationsItem* method_annotations = GetMethodAnnotations(annotations_dir);
+  if (method_annotations == nullptr) {
+    return false;
+  }
+  const MethodAnnotationsItem* item =
+      SearchAnnotationsItems(method_annotations, annotations_dir->methods_size_, method_idx);
+  if (item == nullptr) {
+    return false;
+  }
+  const AnnotationSetItem* annotation_set = GetMethodAnnotationSetItem(*item);
+  if (annotation_set == nullptr) {
+    return false;
+  }
+  for (uint32_t i = 0; i < annotation_set->size_; ++i) {
+    const AnnotationItem* annotation_item = GetAnnotationItem(annotation_set, i);
+    if (annotation_item == nullptr || annotation_item->visibility_ != visibility) {
+      continue;
+    }
+    const uint8_t* annotation = annotation_item->annotation_;
+    uint32_t type_index = DecodeUnsignedLeb128(&annotation);
+    if (strcmp(descriptor, StringByTypeIdx(type_index)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 const DexFile::AnnotationSetItem* DexFile::FindAnnotationSetForClass(Handle<mirror::Class> klass)
     const {
   const AnnotationsDirectoryItem* annotations_dir = GetAnnotationsDirectory(*klass->GetClassDef());
@@ -1694,6 +1755,10 @@ const DexFile::AnnotationItem* DexFile::GetAnnotationItemFromAnnotationSet(
     }
     const uint8_t* annotation = annotation_item->annotation_;
     uint32_t type_index = DecodeUnsignedLeb128(&annotation);
+    // Only resolve the annotations that can match, the others may not even be resolvable.
+    if (!annotation_class->DescriptorEquals(StringByTypeIdx(type_index))) {
+      continue;
+    }
     mirror::Class* resolved_class = Runtime::Current()->GetClassLinker()->ResolveType(
         klass->GetDexFile(), type_index, klass.Get());
     if (resolved_class == nullptr) {
@@ -2367,23 +2432,29 @@ std::ostream& operator<<(std::ostream& os, const Signature& sig) {
 // Decodes the header section from the class data bytes.
 void ClassDataItemIterator::ReadClassDataHeader() {
   CHECK(ptr_pos_ != nullptr);
-  header_.static_fields_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.instance_fields_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.direct_methods_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.virtual_methods_size_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t values[4];
+  DecodeUnsignedLeb128Bulk(&ptr_pos_, DataEnd(), values, arraysize(values));
+  header_.static_fields_size_ = values[0];
+  header_.instance_fields_size_ = values[1];
+  header_.direct_methods_size_ = values[2];
+  header_.virtual_methods_size_ = values[3];
 }
 
 void ClassDataItemIterator::ReadClassDataField() {
-  field_.field_idx_delta_ = DecodeUnsignedLeb128(&ptr_pos_);
-  field_.access_flags_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t values[2];
+  DecodeUnsignedLeb128Bulk(&ptr_pos_, DataEnd(), values, arraysize(values));
+  field_.field_idx_delta_ = values[0];
+  field_.access_flags_ = values[1];
   // The user of the iterator is responsible for checking if there
   // are unordered or duplicate indexes.
 }
 
 void ClassDataItemIterator::ReadClassDataMethod() {
-  method_.method_idx_delta_ = DecodeUnsignedLeb128(&ptr_pos_);
-  method_.access_flags_ = DecodeUnsignedLeb128(&ptr_pos_);
-  method_.code_off_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t values[3];
+  DecodeUnsignedLeb128Bulk(&ptr_pos_, DataEnd(), values, arraysize(values));
+  method_.method_idx_delta_ = values[0];
+  method_.access_flags_ = values[1];
+  method_.code_off_ = values[2];
   if (last_idx_ != 0 && method_.method_idx_delta_ == 0) {
     LOG(WARNING) << "Duplicate method in " << dex_file_.GetLocation();
   }
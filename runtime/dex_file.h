@@ -962,6 +962,12 @@ class DexFile {
       SHARED_REQUIRES(Locks::mutator_lock_);
   bool IsMethodAnnotationPresent(ArtMethod* method, Handle<mirror::Class> annotation_class) const
       SHARED_REQUIRES(Locks::mutator_lock_);
+  // Looks the annotation up by descriptor, without resolving any class, so that it can be used
+  // while the class of the method is being loaded.
+  bool IsMethodAnnotationPresent(const ClassDef& class_def,
+                                 uint32_t method_idx,
+                                 const char* descriptor,
+                                 uint32_t visibility) const;
 
   const AnnotationSetItem* FindAnnotationSetForClass(Handle<mirror::Class> klass) const
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -1454,6 +1460,11 @@ class ClassDataItemIterator {
   // Read and decode header from a class_data_item stream into header
   void ReadClassDataHeader();
 
+  // The end of the dex file, which bounds the loads of the LEB128 decoding.
+  const uint8_t* DataEnd() const {
+    return dex_file_.Begin() + dex_file_.Size();
+  }
+
   uint32_t EndOfStaticFieldsPos() const {
     return header_.static_fields_size_;
   }
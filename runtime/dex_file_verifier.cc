@@ -16,11 +16,17 @@
 
 #include "dex_file_verifier.h"
 
+#include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
+#include "atomic.h"
 #include "base/stringprintf.h"
 #include "dex_file-inl.h"
 #include "experimental_flags.h"
@@ -1649,8 +1655,10 @@ bool DexFileVerifier::CheckIntraSection() {
 
 bool DexFileVerifier::CheckOffsetToTypeMap(size_t offset, uint16_t type) {
   DCHECK_NE(offset, 0u);
-  auto it = offset_to_type_map_.Find(offset);
-  if (UNLIKELY(it == offset_to_type_map_.end())) {
+  const auto& offset_to_type_map =
+      (parent_ != nullptr) ? parent_->offset_to_type_map_ : offset_to_type_map_;
+  auto it = offset_to_type_map.Find(offset);
+  if (UNLIKELY(it == offset_to_type_map.end())) {
     ErrorStringPrintf("No data map entry found @ %zx; expected %x", offset, type);
     return false;
   }
@@ -2336,18 +2344,20 @@ bool DexFileVerifier::CheckInterSectionIterate(size_t offset, uint32_t count, ui
   return true;
 }
 
+// Dex files smaller than this are cross checked on the calling thread, starting threads would
+// cost more than it saves.
+static constexpr size_t kMinParallelInterSectionSize = 1 * MB;
+static constexpr size_t kMaxInterSectionThreads = 4;
+
 bool DexFileVerifier::CheckInterSection() {
   const DexFile::MapList* map = reinterpret_cast<const DexFile::MapList*>(begin_ + header_->map_off_);
   const DexFile::MapItem* item = map->list_;
   uint32_t count = map->size_;
 
-  // Cross check the items listed in the map.
+  // Collect the sections to cross check.
+  std::vector<const DexFile::MapItem*> sections;
   while (count--) {
-    uint32_t section_offset = item->offset_;
-    uint32_t section_count = item->size_;
-    uint16_t type = item->type_;
-
-    switch (type) {
+    switch (item->type_) {
       case DexFile::kDexTypeHeaderItem:
       case DexFile::kDexTypeMapList:
       case DexFile::kDexTypeTypeList:
@@ -2366,20 +2376,107 @@ bool DexFileVerifier::CheckInterSection() {
       case DexFile::kDexTypeAnnotationSetRefList:
       case DexFile::kDexTypeAnnotationSetItem:
       case DexFile::kDexTypeClassDataItem:
-      case DexFile::kDexTypeAnnotationsDirectoryItem: {
-        if (!CheckInterSectionIterate(section_offset, section_count, type)) {
-          return false;
-        }
+      case DexFile::kDexTypeAnnotationsDirectoryItem:
+        sections.push_back(item);
         break;
-      }
       default:
-        ErrorStringPrintf("Unknown map item type %x", type);
+        ErrorStringPrintf("Unknown map item type %x", item->type_);
         return false;
     }
 
     item++;
   }
 
+  if (size_ >= kMinParallelInterSectionSize && sections.size() > 1u) {
+    return CheckInterSectionsInParallel(sections);
+  }
+  for (const DexFile::MapItem* section : sections) {
+    if (!CheckInterSectionIterate(section->offset_, section->size_, section->type_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The sections of a dex file to cross check, shared by the threads checking them.
+struct DexFileVerifier::InterSectionWork {
+  InterSectionWork(const DexFileVerifier* parent_in,
+                   const std::vector<const DexFile::MapItem*>& sections_in)
+      : parent(parent_in),
+        sections(sections_in),
+        order(sections_in.size()),
+        next(0u),
+        failure_reasons(sections_in.size()) {
+    // Check the biggest sections first, so that the threads finish at about the same time.
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+      return sections[lhs]->size_ > sections[rhs]->size_;
+    });
+  }
+
+  const DexFileVerifier* const parent;
+  const std::vector<const DexFile::MapItem*>& sections;
+  // The indexes of the sections, in the order the threads pick them.
+  std::vector<size_t> order;
+  // The position in `order` of the next section to check.
+  Atomic<size_t> next;
+  // The failure reason of each section, empty if the section passed its checks.
+  std::vector<std::string> failure_reasons;
+};
+
+void DexFileVerifier::RunInterSectionWork(InterSectionWork* work) {
+  DexFileVerifier verifier(work->parent);
+  while (true) {
+    size_t position = work->next.FetchAndAddSequentiallyConsistent(1u);
+    if (position >= work->order.size()) {
+      break;
+    }
+    size_t index = work->order[position];
+    const DexFile::MapItem* section = work->sections[index];
+    if (!verifier.CheckInterSectionIterate(section->offset_, section->size_, section->type_)) {
+      work->failure_reasons[index].swap(verifier.failure_reason_);
+      verifier.failure_reason_.clear();
+    }
+  }
+}
+
+void* DexFileVerifier::InterSectionWorkerCallback(void* arg) {
+  RunInterSectionWork(reinterpret_cast<InterSectionWork*>(arg));
+  return nullptr;
+}
+
+bool DexFileVerifier::CheckInterSectionsInParallel(
+    const std::vector<const DexFile::MapItem*>& sections) {
+  InterSectionWork work(this, sections);
+  long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t num_threads = std::min(kMaxInterSectionThreads, sections.size());
+  if (num_cpus > 0) {
+    num_threads = std::min(num_threads, static_cast<size_t>(num_cpus));
+  }
+  // The calling thread checks sections too.
+  std::vector<pthread_t> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    pthread_t thread;
+    int rc = pthread_create(&thread, nullptr, &InterSectionWorkerCallback, &work);
+    if (rc != 0) {
+      // The threads already started, or the calling thread, check the remaining sections.
+      errno = rc;
+      PLOG(WARNING) << "Failed to start a dex file verifier thread for " << location_;
+      break;
+    }
+    threads.push_back(thread);
+  }
+  RunInterSectionWork(&work);
+  for (pthread_t thread : threads) {
+    CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "dex file verifier thread");
+  }
+
+  for (std::string& failure_reason : work.failure_reasons) {
+    if (!failure_reason.empty()) {
+      failure_reason_.swap(failure_reason);
+      return false;
+    }
+  }
   return true;
 }
 
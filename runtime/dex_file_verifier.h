@@ -18,6 +18,7 @@
 #define ART_RUNTIME_DEX_FILE_VERIFIER_H_
 
 #include <unordered_set>
+#include <vector>
 
 #include "dex_file.h"
 #include "safe_map.h"
@@ -49,10 +50,27 @@ class DexFileVerifier {
         location_(location),
         verify_checksum_(verify_checksum),
         header_(&dex_file->GetHeader()),
+        parent_(nullptr),
         ptr_(nullptr),
         previous_item_(nullptr)  {
   }
 
+  // A verifier for the inter-section checks of some sections on another thread. It uses the
+  // offset to type map of `parent`, which is complete and only read by then.
+  explicit DexFileVerifier(const DexFileVerifier* parent)
+      : dex_file_(parent->dex_file_),
+        begin_(parent->begin_),
+        size_(parent->size_),
+        location_(parent->location_),
+        verify_checksum_(parent->verify_checksum_),
+        header_(parent->header_),
+        parent_(parent),
+        ptr_(nullptr),
+        previous_item_(nullptr)  {
+  }
+
+  struct InterSectionWork;
+
   bool Verify();
 
   bool CheckShortyDescriptorMatch(char shorty_char, const char* descriptor, bool is_return_type);
@@ -146,6 +164,11 @@ class DexFileVerifier {
 
   bool CheckInterSectionIterate(size_t offset, uint32_t count, uint16_t type);
   bool CheckInterSection();
+  // Cross check the sections on several threads. The failure reason is the one of the first
+  // failing section in map order, as when checking them one after the other.
+  bool CheckInterSectionsInParallel(const std::vector<const DexFile::MapItem*>& sections);
+  static void RunInterSectionWork(InterSectionWork* work);
+  static void* InterSectionWorkerCallback(void* arg);
 
   // Load a string by (type) index. Checks whether the index is in bounds, printing the error if
   // not. If there is an error, null is returned.
@@ -192,6 +215,8 @@ class DexFileVerifier {
   const char* const location_;
   const bool verify_checksum_;
   const DexFile::Header* const header_;
+  // The verifier owning the offset to type map, for the inter-section checks on other threads.
+  const DexFileVerifier* const parent_;
 
   struct OffsetTypeMapEmptyFn {
     // Make a hash map slot empty by making the offset 0. Offset 0 is a valid dex file offset that
@@ -37,6 +37,7 @@
 #include "runtime.h"
 #include "stack_map.h"
 #include "thread.h"
+#include "utf.h"
 
 namespace art {
 
@@ -53,32 +54,40 @@ inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
   uint32_t method_index = inline_info.GetMethodIndexAtDepth(encoding, inlining_depth);
   InvokeType invoke_type = static_cast<InvokeType>(
         inline_info.GetInvokeTypeAtDepth(encoding, inlining_depth));
-  ArtMethod* inlined_method = outer_method->GetDexCacheResolvedMethod(method_index,
-                                                                      kRuntimePointerSize);
-  if (!inlined_method->IsRuntimeMethod()) {
-    return inlined_method;
-  }
-
-  // The method in the dex cache is the runtime method responsible for invoking
-  // the stub that will then update the dex cache. Therefore, we need to do the
-  // resolution ourselves.
-
-  // We first find the dex cache of our caller. If it is the outer method, we can directly
-  // use its dex cache. Otherwise, we also need to resolve our caller.
-  ArtMethod* caller = outer_method;
-  if (inlining_depth != 0) {
-    caller = GetResolvedMethod(outer_method,
-                               inline_info,
-                               encoding,
-                               inlining_depth - 1);
-  }
-  DCHECK_EQ(caller->GetDexCache(), outer_method->GetDexCache())
-      << "Compiler only supports inlining calls within the same dex cache";
-  const DexFile* dex_file = outer_method->GetDexFile();
+  uint32_t dex_file_index = inline_info.GetDexFileIndexAtDepth(encoding, inlining_depth);
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  mirror::DexCache* dex_cache;
+  if (dex_file_index == InlineInfo::kOuterDexFileIndex) {
+    ArtMethod* inlined_method = outer_method->GetDexCacheResolvedMethod(method_index,
+                                                                        kRuntimePointerSize);
+    if (!inlined_method->IsRuntimeMethod()) {
+      return inlined_method;
+    }
+    // The method in the dex cache is the runtime method responsible for invoking
+    // the stub that will then update the dex cache. Therefore, we need to do the
+    // resolution ourselves.
+    dex_cache = outer_method->GetDexCache();
+  } else {
+    // The method was inlined from another dex file of the oat file of the outer method,
+    // which the compiler only allows if they share the class loader.
+    const OatFile* oat_file = outer_method->GetDexFile()->GetOatDexFile()->GetOatFile();
+    DCHECK_LT(dex_file_index, oat_file->GetOatDexFiles().size());
+    dex_cache = class_linker->FindDexCache(Thread::Current(),
+                                           *oat_file->GetOatDexFiles()[dex_file_index]);
+    DCHECK(dex_cache != nullptr) << PrettyMethod(outer_method) << " " << dex_file_index;
+    ArtMethod* inlined_method = dex_cache->GetResolvedMethod(method_index, kRuntimePointerSize);
+    if (inlined_method != nullptr) {
+      return inlined_method;
+    }
+  }
+
+  ArtMethod* inlined_method;
+  const DexFile* dex_file = dex_cache->GetDexFile();
   const DexFile::MethodId& method_id = dex_file->GetMethodId(method_index);
 
   if (inline_info.GetDexPcAtDepth(encoding, inlining_depth) == static_cast<uint32_t>(-1)) {
-    // "charAt" special case. It is the only non-leaf method we inline across dex files.
+    // "charAt" special case. It is the only non-leaf method we inline across dex files
+    // of different oat files.
     if (kIsDebugBuild) {
       const char* name = dex_file->StringDataByIdx(method_id.name_idx_);
       DCHECK_EQ(std::string(name), "charAt");
@@ -87,25 +96,34 @@ inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
       DCHECK_EQ(std::string(dex_file->StringByTypeIdx(method_id.class_idx_)), "Ljava/lang/String;")
           << std::string(dex_file->StringByTypeIdx(method_id.class_idx_));
     }
-    mirror::Class* cls =
-        Runtime::Current()->GetClassLinker()->GetClassRoot(ClassLinker::kJavaLangString);
+    mirror::Class* cls = class_linker->GetClassRoot(ClassLinker::kJavaLangString);
     // Update the dex cache for future lookups.
-    caller->GetDexCache()->SetResolvedType(method_id.class_idx_, cls);
+    dex_cache->SetResolvedType(method_id.class_idx_, cls);
     inlined_method = cls->FindVirtualMethod("charAt", "(I)C", kRuntimePointerSize);
   } else {
-    mirror::Class* klass = caller->GetDexCache()->GetResolvedType(method_id.class_idx_);
-    DCHECK_EQ(klass->GetDexCache(), caller->GetDexCache())
-        << "Compiler only supports inlining calls within the same dex cache";
+    mirror::Class* klass = dex_cache->GetResolvedType(method_id.class_idx_);
+    if (klass == nullptr) {
+      // The compiled code may only have resolved the class through the dex cache of
+      // another dex file, but the class is loaded as its instances or static methods
+      // are being used.
+      const char* descriptor = dex_file->StringByTypeIdx(method_id.class_idx_);
+      klass = class_linker->LookupClass(Thread::Current(),
+                                        descriptor,
+                                        ComputeModifiedUtf8Hash(descriptor),
+                                        outer_method->GetDeclaringClass()->GetClassLoader());
+      DCHECK(klass != nullptr) << descriptor;
+      dex_cache->SetResolvedType(method_id.class_idx_, klass);
+    }
+    DCHECK_EQ(klass->GetDexCache(), dex_cache)
+        << "Compiler only supports inlining calls within the same class loader";
     switch (invoke_type) {
       case kDirect:
       case kStatic:
-        inlined_method =
-            klass->FindDirectMethod(klass->GetDexCache(), method_index, kRuntimePointerSize);
+        inlined_method = klass->FindDirectMethod(dex_cache, method_index, kRuntimePointerSize);
         break;
       case kSuper:
       case kVirtual:
-        inlined_method =
-            klass->FindVirtualMethod(klass->GetDexCache(), method_index, kRuntimePointerSize);
+        inlined_method = klass->FindVirtualMethod(dex_cache, method_index, kRuntimePointerSize);
         break;
       default:
         LOG(FATAL) << "Unimplemented inlined invocation type: " << invoke_type;
@@ -116,7 +134,11 @@ inline ArtMethod* GetResolvedMethod(ArtMethod* outer_method,
   // Update the dex cache for future lookups. Note that for static methods, this is safe
   // when the class is being initialized, as the entrypoint for the ArtMethod is at
   // this point still the resolution trampoline.
-  outer_method->SetDexCacheResolvedMethod(method_index, inlined_method, kRuntimePointerSize);
+  if (dex_file_index == InlineInfo::kOuterDexFileIndex) {
+    outer_method->SetDexCacheResolvedMethod(method_index, inlined_method, kRuntimePointerSize);
+  } else {
+    dex_cache->SetResolvedMethod(method_index, inlined_method, kRuntimePointerSize);
+  }
   return inlined_method;
 }
 
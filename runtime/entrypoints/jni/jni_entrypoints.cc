@@ -23,23 +23,13 @@
 
 namespace art {
 
-// Used by the JNI dlsym stub to find the native method to invoke if none is registered.
-#if defined(__arm__) || defined(__aarch64__)
-extern "C" void* artFindNativeMethod() {
-  Thread* self = Thread::Current();
-#else
-extern "C" void* artFindNativeMethod(Thread* self) {
-  DCHECK_EQ(self, Thread::Current());
-#endif
-  Locks::mutator_lock_->AssertNotHeld(self);  // We come here as Native.
-  ScopedObjectAccess soa(self);
-
+static void* FindNativeMethod(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_) {
   ArtMethod* method = self->GetCurrentMethod(nullptr);
   DCHECK(method != nullptr);
 
   // Lookup symbol address for method, on failure we'll return null with an exception set,
   // otherwise we return the address of the method we found.
-  void* native_code = soa.Vm()->FindCodeForNativeMethod(method);
+  void* native_code = self->GetJniEnv()->vm->FindCodeForNativeMethod(method);
   if (native_code == nullptr) {
     DCHECK(self->IsExceptionPending());
     return nullptr;
@@ -50,4 +40,21 @@ extern "C" void* artFindNativeMethod(Thread* self) {
   }
 }
 
+// Used by the JNI dlsym stub to find the native method to invoke if none is registered.
+#if defined(__arm__) || defined(__aarch64__)
+extern "C" void* artFindNativeMethod() {
+  Thread* self = Thread::Current();
+#else
+extern "C" void* artFindNativeMethod(Thread* self) {
+  DCHECK_EQ(self, Thread::Current());
+#endif
+  if (self->GetState() == kRunnable) {
+    // Fast native methods do not leave the runnable state.
+    return FindNativeMethod(self);
+  }
+  Locks::mutator_lock_->AssertNotHeld(self);  // We come here as Native.
+  ScopedObjectAccess soa(self);
+  return FindNativeMethod(self);
+}
+
 }  // namespace art
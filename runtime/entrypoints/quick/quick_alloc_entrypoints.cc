@@ -191,6 +191,16 @@ GENERATE_ENTRYPOINTS_FOR_ALLOCATOR(TLAB, gc::kAllocatorTypeTLAB)
 GENERATE_ENTRYPOINTS_FOR_ALLOCATOR(Region, gc::kAllocatorTypeRegion)
 GENERATE_ENTRYPOINTS_FOR_ALLOCATOR(RegionTLAB, gc::kAllocatorTypeRegionTLAB)
 
+// Clone an array or an instance of a Cloneable class, for the Object.clone() intrinsic. The
+// compiler has already checked that Object.clone() would not throw CloneNotSupportedException.
+// Object::Clone() uses the current allocator, with the write barrier for the copied references.
+extern "C" mirror::Object* artCloneObjectFromCode(mirror::Object* obj, Thread* self)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  ScopedQuickEntrypointChecks sqec(self);
+  DCHECK(obj != nullptr);
+  return obj->Clone(self);
+}
+
 #define GENERATE_ENTRYPOINTS(suffix) \
 extern "C" void* art_quick_alloc_array##suffix(uint32_t, int32_t, ArtMethod* ref); \
 extern "C" void* art_quick_alloc_array_resolved##suffix(mirror::Class* klass, int32_t, ArtMethod* ref); \
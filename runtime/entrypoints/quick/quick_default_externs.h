@@ -39,6 +39,12 @@ extern "C" void* art_quick_initialize_type(uint32_t);
 extern "C" void* art_quick_initialize_type_and_verify_access(uint32_t);
 extern "C" void* art_quick_resolve_string(uint32_t);
 
+// String builder entrypoint.
+extern "C" void* art_quick_string_builder_append(uint32_t, const uint32_t*);
+
+// Clone entrypoint.
+extern "C" void* art_quick_clone_object(void*);
+
 // Field entrypoints.
 extern "C" int art_quick_set8_instance(uint32_t, void*, int8_t);
 extern "C" int art_quick_set8_static(uint32_t, int8_t);
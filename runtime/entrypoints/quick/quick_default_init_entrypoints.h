@@ -39,6 +39,12 @@ void DefaultInitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints)
   qpoints->pInitializeType = art_quick_initialize_type;
   qpoints->pResolveString = art_quick_resolve_string;
 
+  // String builder
+  qpoints->pStringBuilderAppend = art_quick_string_builder_append;
+
+  // Clone
+  qpoints->pCloneObject = art_quick_clone_object;
+
   // Field
   qpoints->pSet8Instance = art_quick_set8_instance;
   qpoints->pSet8Static = art_quick_set8_static;
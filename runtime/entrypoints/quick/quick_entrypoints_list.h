@@ -162,6 +162,9 @@
   V(NewStringFromString, void) \
   V(NewStringFromStringBuffer, void) \
   V(NewStringFromStringBuilder, void) \
+\
+  V(StringBuilderAppend, void*, uint32_t, const uint32_t*) \
+  V(CloneObject, void*, mirror::Object*) \
 \
   V(ReadBarrierJni, void, mirror::CompressedReference<mirror::Object>*, Thread*) \
   V(ReadBarrierMarkReg00, mirror::Object*, mirror::Object*) \
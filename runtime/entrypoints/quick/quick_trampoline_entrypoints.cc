@@ -24,6 +24,7 @@
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "gc/accounting/card_table-inl.h"
 #include "interpreter/interpreter.h"
+#include "jit/jit.h"
 #include "linear_alloc.h"
 #include "method_reference.h"
 #include "mirror/class-inl.h"
@@ -1965,16 +1966,24 @@ extern "C" TwoWordReturn artQuickGenericJniTrampoline(Thread* self, ArtMethod**
   visitor.FinalizeHandleScope(self);
 
   // Fix up managed-stack things in Thread.
-  self->SetTopOfStack(sp);
+  self->SetTopOfStackGenericJni(sp);
 
   self->VerifyStack();
 
+  // Hot native methods get a compiled JNI stub, which does not re-parse the shorty on each call.
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    jit->AddSamplesForNative(self, called, 1);
+  }
+
   // Start JNI, save the cookie.
   uint32_t cookie;
   if (called->IsSynchronized()) {
     cookie = JniMethodStartSynchronized(visitor.GetFirstHandleScopeJObject(), self);
     if (self->IsExceptionPending()) {
       self->PopHandleScope();
+      // The assembly delivers the exception from the untagged top quick frame.
+      self->SetTopOfStack(sp);
       // A negative value denotes an error.
       return GetTwoWordFailureValue();
     }
@@ -2011,6 +2020,7 @@ extern "C" TwoWordReturn artQuickGenericJniTrampoline(Thread* self, ArtMethod**
         artQuickGenericJniEndJNINonRef(self, cookie, lock);
       }
 
+      self->SetTopOfStack(sp);
       return GetTwoWordFailureValue();
     }
     // Note that the native code pointer will be automatically set by artFindNativeMethod().
@@ -2041,7 +2051,11 @@ extern "C" uint64_t artQuickGenericJniEndTrampoline(Thread* self,
   ArtMethod* called = *sp;
   uint32_t cookie = *(sp32 - 1);
   HandleScope* table = reinterpret_cast<HandleScope*>(reinterpret_cast<uint8_t*>(sp) + sizeof(*sp));
-  return GenericJniMethodEnd(self, cookie, result, result_f, called, table);
+  uint64_t ret = GenericJniMethodEnd(self, cookie, result, result_f, called, table);
+  // The assembly code may reload the stack pointer from the top quick frame to deliver a
+  // pending exception.
+  self->SetTopOfStack(sp);
+  return ret;
 }
 
 // We use TwoWordReturn to optimize scalar returns. We use the hi value for code, and the lo value
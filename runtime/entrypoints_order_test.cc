@@ -138,8 +138,13 @@ class EntrypointsOrderTest : public CommonRuntimeTest {
     EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, nested_signal_state, flip_function, sizeof(void*));
     EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, flip_function, method_verifier, sizeof(void*));
     EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, method_verifier, thread_local_mark_stack, sizeof(void*));
-    EXPECT_OFFSET_DIFF(Thread, tlsPtr_.thread_local_mark_stack, Thread, wait_mutex_, sizeof(void*),
-                       thread_tlsptr_end);
+    EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, thread_local_mark_stack, thread_local_chunk_size,
+                        sizeof(void*));
+    EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, thread_local_chunk_size, intern_cache, sizeof(size_t));
+    EXPECT_OFFSET_DIFFP(Thread, tlsPtr_, intern_cache, intern_cache_strong_mask,
+                        sizeof(void*) * kInternCacheSizeInThread);
+    EXPECT_OFFSET_DIFF(Thread, tlsPtr_.intern_cache_strong_mask, Thread, wait_mutex_,
+                       sizeof(size_t), thread_tlsptr_end);
   }
 
   void CheckJniEntryPoints() {
@@ -322,8 +327,10 @@ class EntrypointsOrderTest : public CommonRuntimeTest {
                          sizeof(void*));
     EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pNewStringFromStringBuffer, pNewStringFromStringBuilder,
                          sizeof(void*));
-    EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pNewStringFromStringBuilder, pReadBarrierJni,
+    EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pNewStringFromStringBuilder, pStringBuilderAppend,
                          sizeof(void*));
+    EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pStringBuilderAppend, pCloneObject, sizeof(void*));
+    EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pCloneObject, pReadBarrierJni, sizeof(void*));
     EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pReadBarrierJni, pReadBarrierMarkReg00, sizeof(void*));
     EXPECT_OFFSET_DIFFNP(QuickEntryPoints, pReadBarrierMarkReg00, pReadBarrierMarkReg01,
                          sizeof(void*));
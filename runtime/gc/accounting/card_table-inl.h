@@ -49,6 +49,27 @@ static inline bool byte_cas(uint8_t old_value, uint8_t new_value, uint8_t* addre
 #endif
 }
 
+// Returns the first non zero word of [word_cur, word_end), or word_end. Most of the table is clean,
+// so the words are tested a block at a time first. The compiler turns the loads and the ORs of a
+// block into vector instructions where the target has them.
+static inline uintptr_t* FindNonZeroWord(uintptr_t* word_cur, uintptr_t* word_end) {
+  static constexpr size_t kBlockWords = 4;
+  while (static_cast<size_t>(word_end - word_cur) >= kBlockWords) {
+    uintptr_t block = 0;
+    for (size_t i = 0; i < kBlockWords; ++i) {
+      block |= word_cur[i];
+    }
+    if (block != 0) {
+      break;
+    }
+    word_cur += kBlockWords;
+  }
+  while (word_cur < word_end && *word_cur == 0) {
+    ++word_cur;
+  }
+  return word_cur;
+}
+
 template <bool kClearCard, typename Visitor>
 inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap, uint8_t* scan_begin, uint8_t* scan_end,
                               const Visitor& visitor, const uint8_t minimum_age) const {
@@ -78,36 +99,32 @@ inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap, uint8_t* scan_begin
       (reinterpret_cast<uintptr_t>(card_end) & (sizeof(uintptr_t) - 1));
 
   uintptr_t* word_end = reinterpret_cast<uintptr_t*>(aligned_end);
-  for (uintptr_t* word_cur = reinterpret_cast<uintptr_t*>(card_cur); word_cur < word_end;
-      ++word_cur) {
-    while (LIKELY(*word_cur == 0)) {
-      ++word_cur;
-      if (UNLIKELY(word_cur >= word_end)) {
-        goto exit_for;
-      }
-    }
-
-    // Find the first dirty card.
-    uintptr_t start_word = *word_cur;
-    uintptr_t start = reinterpret_cast<uintptr_t>(AddrFromCard(reinterpret_cast<uint8_t*>(word_cur)));
+  for (uintptr_t* word_cur = FindNonZeroWord(reinterpret_cast<uintptr_t*>(card_cur), word_end);
+       word_cur < word_end;
+       word_cur = FindNonZeroWord(word_cur + 1, word_end)) {
+    const uintptr_t start_word = *word_cur;
+    const uintptr_t start =
+        reinterpret_cast<uintptr_t>(AddrFromCard(reinterpret_cast<uint8_t*>(word_cur)));
+    // Only visit the non zero cards of the word, lowest address first (little endian).
     // TODO: Investigate if processing continuous runs of dirty cards with a single bitmap visit is
     // more efficient.
-    for (size_t i = 0; i < sizeof(uintptr_t); ++i) {
-      if (static_cast<uint8_t>(start_word) >= minimum_age) {
+    for (uintptr_t remaining = start_word; remaining != 0; ) {
+      const size_t i = CTZ(remaining) / kBitsPerByte;
+      const uint8_t value = static_cast<uint8_t>(start_word >> (i * kBitsPerByte));
+      remaining &= ~(static_cast<uintptr_t>(0xFF) << (i * kBitsPerByte));
+      if (value >= minimum_age) {
         auto* card = reinterpret_cast<uint8_t*>(word_cur) + i;
-        DCHECK(*card == static_cast<uint8_t>(start_word) || *card == kCardDirty)
-            << "card " << static_cast<size_t>(*card) << " intptr_t " << (start_word & 0xFF);
-        bitmap->VisitMarkedRange(start, start + kCardSize, visitor);
+        DCHECK(*card == value || *card == kCardDirty)
+            << "card " << static_cast<size_t>(*card) << " intptr_t " << static_cast<size_t>(value);
+        const uintptr_t card_start = start + i * kCardSize;
+        bitmap->VisitMarkedRange(card_start, card_start + kCardSize, visitor);
         ++cards_scanned;
         if (kClearCard) {
           *card = 0;
         }
       }
-      start_word >>= 8;
-      start += kCardSize;
     }
   }
-  exit_for:
 
   // Handle any unaligned cards at the end.
   card_cur = reinterpret_cast<uint8_t*>(word_end);
@@ -182,7 +199,7 @@ inline void CardTable::ModifyCardsAtomic(uint8_t* scan_begin, uint8_t* scan_end,
   };
 
   // TODO: Parallelize.
-  while (word_cur < word_end) {
+  while ((word_cur = FindNonZeroWord(word_cur, word_end)) < word_end) {
     while (true) {
       expected_word = *word_cur;
       if (LIKELY(expected_word == 0)) {
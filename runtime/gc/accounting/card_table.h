@@ -52,7 +52,10 @@ class CardTable {
   static constexpr uint8_t kCardClean = 0x0;
   static constexpr uint8_t kCardDirty = 0x70;
 
-  static CardTable* Create(const uint8_t* heap_begin, size_t heap_capacity);
+  // If use_huge_pages is true the card table is huge page aligned and advised for transparent
+  // huge pages.
+  static CardTable* Create(const uint8_t* heap_begin, size_t heap_capacity,
+                           bool use_huge_pages = false);
   ~CardTable();
 
   // Set the card associated with the given address to GC_CARD_DIRTY.
@@ -130,6 +133,10 @@ class CardTable {
 
   bool AddrIsInCardTable(const void* addr) const;
 
+  MemMap* GetMemMap() const {
+    return mem_map_.get();
+  }
+
  private:
   CardTable(MemMap* begin, uint8_t* biased_begin, size_t offset);
 
@@ -16,14 +16,18 @@
 
 #include "card_table-inl.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "atomic.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
+#include "mem_map.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
 #include "scoped_thread_state_change.h"
+#include "space_bitmap-inl.h"
 #include "thread_pool.h"
 #include "utils.h"
 
@@ -144,7 +148,87 @@ TEST_F(CardTableTest, TestModifyCardsAtomic) {
   }
 }
 
-// TODO: Add test for CardTable::Scan.
+class RecordingVisitor {
+ public:
+  explicit RecordingVisitor(std::vector<mirror::Object*>* visited) : visited_(visited) {}
+  void operator()(mirror::Object* obj) const {
+    visited_->push_back(obj);
+  }
+
+ private:
+  std::vector<mirror::Object*>* const visited_;
+};
+
+TEST_F(CardTableTest, TestScan) {
+  CommonSetup();
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<ContinuousSpaceBitmap> bitmap(
+      ContinuousSpaceBitmap::Create("test bitmap", HeapBegin(), HeapLimit() - HeapBegin()));
+  ASSERT_TRUE(bitmap.get() != nullptr);
+  // Skip the first cards so that the scan starts in the middle of a word.
+  const size_t first_card = 3;
+  const size_t num_cards = (HeapLimit() - HeapBegin()) / CardTable::kCardSize;
+  std::vector<mirror::Object*> dirty_objects;
+  std::vector<mirror::Object*> aged_objects;
+  for (size_t i = 0; i < num_cards; ++i) {
+    uint8_t* addr = HeapBegin() + i * CardTable::kCardSize;
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(addr + kObjectAlignment);
+    bitmap->Set(obj);
+    // Sparse cards, a run crossing words and the last card.
+    if (i % 37 == 0 || (i >= 60 && i < 70) || i == num_cards - 1) {
+      *card_table_->CardFromAddr(addr) = CardTable::kCardDirty;
+      if (i >= first_card) {
+        dirty_objects.push_back(obj);
+      }
+    } else if (i % 53 == 0) {
+      *card_table_->CardFromAddr(addr) = CardTable::kCardDirty - 1;
+      if (i >= first_card) {
+        aged_objects.push_back(obj);
+      }
+    }
+  }
+  uint8_t* const scan_begin = HeapBegin() + first_card * CardTable::kCardSize;
+  std::vector<mirror::Object*> visited;
+  EXPECT_EQ(card_table_->Scan<true>(bitmap.get(),
+                                    scan_begin,
+                                    HeapLimit(),
+                                    RecordingVisitor(&visited)),
+            dirty_objects.size());
+  EXPECT_EQ(visited, dirty_objects);
+  for (mirror::Object* obj : dirty_objects) {
+    EXPECT_EQ(card_table_->GetCard(obj), CardTable::kCardClean);
+  }
+  // The dirty card before the scanned range is left alone.
+  EXPECT_EQ(*card_table_->CardFromAddr(HeapBegin()), CardTable::kCardDirty);
+  // Only the aged cards are left in the range.
+  visited.clear();
+  EXPECT_EQ(card_table_->Scan<false>(bitmap.get(),
+                                     scan_begin,
+                                     HeapLimit(),
+                                     RecordingVisitor(&visited),
+                                     CardTable::kCardDirty - 1),
+            aged_objects.size());
+  EXPECT_EQ(visited, aged_objects);
+  for (mirror::Object* obj : aged_objects) {
+    EXPECT_EQ(card_table_->GetCard(obj), CardTable::kCardDirty - 1);
+  }
+}
+
+TEST_F(CardTableTest, TestHugePages) {
+  std::unique_ptr<CardTable> card_table(
+      CardTable::Create(HeapBegin(), HeapLimit() - HeapBegin(), /* use_huge_pages */ true));
+  ASSERT_TRUE(card_table.get() != nullptr);
+  EXPECT_TRUE(IsAligned<kHugePageSize>(card_table->GetMemMap()->BaseBegin()));
+  for (const uint8_t* addr = HeapBegin(); addr < HeapLimit(); addr += CardTable::kCardSize) {
+    auto obj = reinterpret_cast<const mirror::Object*>(addr);
+    EXPECT_EQ(card_table->GetCard(obj), CardTable::kCardClean);
+    card_table->MarkCard(addr);
+    EXPECT_TRUE(card_table->IsDirty(obj));
+  }
+  card_table->ClearCardTable();
+  EXPECT_FALSE(card_table->IsDirty(reinterpret_cast<const mirror::Object*>(HeapBegin())));
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -19,6 +19,7 @@
 
 #include "mod_union_table.h"
 
+#include "gc/heap.h"
 #include "gc/space/space.h"
 
 namespace art {
@@ -38,6 +39,23 @@ class ModUnionTableToZygoteAllocspace : public ModUnionTableReferenceCache {
   }
 };
 
+// A mod-union table to record zygote space references to the alloc spaces. Unlike the card cache,
+// it keeps the addresses of the references of each cleared card, so that a collection only rescans
+// the cards dirtied since the previous one instead of every card that references an alloc space.
+// References to the boot image are not recorded since the image is immune for every collection.
+class ModUnionTableZygoteToAllocspace : public ModUnionTableReferenceCache {
+ public:
+  explicit ModUnionTableZygoteToAllocspace(const std::string& name,
+                                           Heap* heap,
+                                           space::ContinuousSpace* space)
+      : ModUnionTableReferenceCache(name, heap, space) {}
+
+  bool ShouldAddReference(const mirror::Object* ref) const OVERRIDE ALWAYS_INLINE {
+    return !space_->HasAddress(ref) &&
+        !heap_->ObjectIsInBootImageSpace(const_cast<mirror::Object*>(ref));
+  }
+};
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -33,10 +33,11 @@ class ModUnionTableFactory {
   enum TableType {
     kTableTypeCardCache,
     kTableTypeReferenceCache,
+    kTableTypeZygoteReferenceCache,
     kTableTypeCount,  // Number of values in the enum.
   };
 
-  // Target space is ignored for the card cache implementation.
+  // Target space is ignored for the card cache and zygote implementations.
   static ModUnionTable* Create(
       TableType type, space::ContinuousSpace* space, space::ContinuousSpace* target_space);
 };
@@ -139,6 +140,10 @@ std::ostream& operator<<(std::ostream& oss, ModUnionTableFactory::TableType type
       oss << "ReferenceCache";
       break;
     }
+    case ModUnionTableFactory::kTableTypeZygoteReferenceCache: {
+      oss << "ZygoteReferenceCache";
+      break;
+    }
     default: {
       UNIMPLEMENTED(FATAL) << static_cast<size_t>(type);
     }
@@ -158,6 +163,9 @@ ModUnionTable* ModUnionTableFactory::Create(
       return new ModUnionTableRefCacheToSpace(name.str(), Runtime::Current()->GetHeap(), space,
                                               target_space);
     }
+    case kTableTypeZygoteReferenceCache: {
+      return new ModUnionTableZygoteToAllocspace(name.str(), Runtime::Current()->GetHeap(), space);
+    }
     default: {
       UNIMPLEMENTED(FATAL) << "Invalid type " << type;
     }
@@ -173,6 +181,10 @@ TEST_F(ModUnionTableTest, TestReferenceCache) {
   RunTest(ModUnionTableFactory::kTableTypeReferenceCache);
 }
 
+TEST_F(ModUnionTableTest, TestZygoteReferenceCache) {
+  RunTest(ModUnionTableFactory::kTableTypeZygoteReferenceCache);
+}
+
 void ModUnionTableTest::RunTest(ModUnionTableFactory::TableType type) {
   Thread* const self = Thread::Current();
   ScopedObjectAccess soa(self);
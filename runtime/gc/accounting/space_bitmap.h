@@ -189,6 +189,10 @@ class SpaceBitmap {
 
   std::string Dump() const;
 
+  MemMap* GetMemMap() const {
+    return mem_map_.get();
+  }
+
   // Helper function for computing bitmap size based on a 64 bit capacity.
   static size_t ComputeBitmapSize(uint64_t capacity);
   static size_t ComputeHeapSize(uint64_t bitmap_bytes);
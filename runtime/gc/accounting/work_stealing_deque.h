@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
+#define ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
+
+#include <stdint.h>
+#include <memory>
+
+#include "atomic.h"
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+// A fixed capacity Chase-Lev work-stealing deque of pointers. The owning thread pushes and pops at
+// the bottom, any thread may steal from the top. See "Correct and Efficient Work-Stealing for Weak
+// Memory Models" (Le et al., PPoPP'13); unlike the paper the buffer never grows, PushBottom fails
+// instead and the owner is expected to move work elsewhere.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  // Capacity must be a power of two.
+  explicit WorkStealingDeque(size_t capacity)
+      : mask_(capacity - 1),
+        top_(0),
+        bottom_(0),
+        buffer_(new Atomic<T*>[capacity]) {
+    CHECK(IsPowerOfTwo(capacity)) << capacity;
+  }
+
+  // Owner only. Returns false if the deque is full.
+  bool PushBottom(T* value) {
+    DCHECK(value != nullptr);
+    const int64_t bottom = bottom_.LoadRelaxed();
+    const int64_t top = top_.LoadAcquire();
+    if (bottom - top > static_cast<int64_t>(mask_)) {
+      return false;
+    }
+    buffer_[bottom & mask_].StoreRelaxed(value);
+    // Publish the element before the new bottom.
+    bottom_.StoreRelease(bottom + 1);
+    return true;
+  }
+
+  // Owner only. Returns null if the deque is empty.
+  T* PopBottom() {
+    const int64_t bottom = bottom_.LoadRelaxed() - 1;
+    bottom_.StoreRelaxed(bottom);
+    QuasiAtomic::ThreadFenceSequentiallyConsistent();
+    const int64_t top = top_.LoadRelaxed();
+    if (top > bottom) {
+      // Empty.
+      bottom_.StoreRelaxed(bottom + 1);
+      return nullptr;
+    }
+    T* value = buffer_[bottom & mask_].LoadRelaxed();
+    if (top == bottom) {
+      // Last element, race against the thieves for it.
+      if (!top_.CompareExchangeStrongSequentiallyConsistent(top, top + 1)) {
+        value = nullptr;
+      }
+      bottom_.StoreRelaxed(bottom + 1);
+    }
+    return value;
+  }
+
+  // Any thread. Returns null if the deque is empty or another thread took the top element first.
+  T* Steal() {
+    const int64_t top = top_.LoadAcquire();
+    QuasiAtomic::ThreadFenceSequentiallyConsistent();
+    const int64_t bottom = bottom_.LoadAcquire();
+    if (top >= bottom) {
+      return nullptr;
+    }
+    // The owner can't overwrite this slot before top moves past it, so the value is good if the
+    // CAS succeeds.
+    T* value = buffer_[top & mask_].LoadRelaxed();
+    if (!top_.CompareExchangeStrongSequentiallyConsistent(top, top + 1)) {
+      return nullptr;
+    }
+    return value;
+  }
+
+  // Approximate when other threads are using the deque.
+  size_t Size() const {
+    const int64_t size = bottom_.LoadSequentiallyConsistent() - top_.LoadSequentiallyConsistent();
+    return size > 0 ? static_cast<size_t>(size) : 0u;
+  }
+
+  bool IsEmpty() const {
+    return Size() == 0;
+  }
+
+  size_t Capacity() const {
+    return mask_ + 1;
+  }
+
+ private:
+  const size_t mask_;
+  Atomic<int64_t> top_;
+  Atomic<int64_t> bottom_;
+  std::unique_ptr<Atomic<T*>[]> buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ACCOUNTING_WORK_STEALING_DEQUE_H_
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "work_stealing_deque.h"
+
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+namespace gc {
+namespace accounting {
+
+class WorkStealingDequeTest : public CommonRuntimeTest {};
+
+TEST_F(WorkStealingDequeTest, PushPopSteal) {
+  static constexpr size_t kCapacity = 16;
+  int values[kCapacity];
+  WorkStealingDeque<int> deque(kCapacity);
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_EQ(deque.PopBottom(), nullptr);
+  EXPECT_EQ(deque.Steal(), nullptr);
+  for (size_t i = 0; i < kCapacity; ++i) {
+    EXPECT_TRUE(deque.PushBottom(&values[i]));
+  }
+  EXPECT_EQ(deque.Size(), kCapacity);
+  // Full.
+  EXPECT_FALSE(deque.PushBottom(&values[0]));
+  // The owner pops the newest element, thieves take the oldest.
+  EXPECT_EQ(deque.PopBottom(), &values[kCapacity - 1]);
+  EXPECT_EQ(deque.Steal(), &values[0]);
+  EXPECT_EQ(deque.Steal(), &values[1]);
+  EXPECT_EQ(deque.Size(), kCapacity - 3);
+  // Wrap around.
+  EXPECT_TRUE(deque.PushBottom(&values[0]));
+  EXPECT_TRUE(deque.PushBottom(&values[1]));
+  EXPECT_EQ(deque.PopBottom(), &values[1]);
+  EXPECT_EQ(deque.PopBottom(), &values[0]);
+  for (size_t i = kCapacity - 2; i >= 2; --i) {
+    EXPECT_EQ(deque.PopBottom(), &values[i]);
+  }
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_EQ(deque.PopBottom(), nullptr);
+}
+
+class StealTask : public Task {
+ public:
+  StealTask(WorkStealingDeque<int>* deque, Atomic<bool>* done, std::vector<int*>* stolen)
+      : deque_(deque), done_(done), stolen_(stolen) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) {
+    while (!done_->LoadSequentiallyConsistent() || !deque_->IsEmpty()) {
+      int* value = deque_->Steal();
+      if (value != nullptr) {
+        stolen_->push_back(value);
+      }
+    }
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+ private:
+  WorkStealingDeque<int>* const deque_;
+  Atomic<bool>* const done_;
+  std::vector<int*>* const stolen_;
+};
+
+// Every element is taken exactly once while thieves race with the owner.
+TEST_F(WorkStealingDequeTest, ConcurrentSteal) {
+  static constexpr size_t kNumThieves = 3;
+  static constexpr size_t kNumValues = 100000;
+  Thread* self = Thread::Current();
+  std::vector<int> values(kNumValues);
+  WorkStealingDeque<int> deque(64);
+  Atomic<bool> done(false);
+  std::vector<int*> stolen[kNumThieves];
+  ThreadPool thread_pool("Work stealing deque test thread pool", kNumThieves);
+  for (size_t i = 0; i < kNumThieves; ++i) {
+    thread_pool.AddTask(self, new StealTask(&deque, &done, &stolen[i]));
+  }
+  thread_pool.StartWorkers(self);
+  std::vector<int*> popped;
+  for (size_t i = 0; i < kNumValues; ++i) {
+    while (!deque.PushBottom(&values[i])) {
+      int* value = deque.PopBottom();
+      if (value != nullptr) {
+        popped.push_back(value);
+      }
+    }
+  }
+  done.StoreSequentiallyConsistent(true);
+  for (int* value = deque.PopBottom(); value != nullptr; value = deque.PopBottom()) {
+    popped.push_back(value);
+  }
+  thread_pool.Wait(self, false, false);
+  std::vector<size_t> counts(kNumValues, 0);
+  for (int* value : popped) {
+    ++counts[value - values.data()];
+  }
+  for (size_t i = 0; i < kNumThieves; ++i) {
+    for (int* value : stolen[i]) {
+      ++counts[value - values.data()];
+    }
+  }
+  for (size_t i = 0; i < kNumValues; ++i) {
+    EXPECT_EQ(counts[i], 1u) << i;
+  }
+}
+
+}  // namespace accounting
+}  // namespace gc
+}  // namespace art
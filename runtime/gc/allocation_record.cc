@@ -212,6 +212,11 @@ class AllocRecordStackVisitor : public StackVisitor {
   AllocRecordStackTrace* const trace_;
 };
 
+void AllocRecordStackTrace::WalkStack(Thread* thread, size_t max_depth) {
+  AllocRecordStackVisitor visitor(thread, max_depth, /*out*/ this);
+  visitor.WalkStack();
+}
+
 void AllocRecordObjectMap::SetAllocTrackingEnabled(bool enable) {
   Thread* self = Thread::Current();
   Heap* heap = Runtime::Current()->GetHeap();
@@ -268,11 +273,10 @@ void AllocRecordObjectMap::RecordAllocation(Thread* self,
   // Get stack trace outside of lock in case there are allocations during the stack walk.
   // b/27858645.
   AllocRecordStackTrace trace;
-  AllocRecordStackVisitor visitor(self, max_stack_depth_, /*out*/ &trace);
   {
     StackHandleScope<1> hs(self);
     auto obj_wrapper = hs.NewHandleWrapper(obj);
-    visitor.WalkStack();
+    trace.WalkStack(self, max_stack_depth_);
   }
 
   MutexLock mu(self, *Locks::alloc_tracker_lock_);
@@ -105,6 +105,9 @@ class AllocRecordStackTrace {
     stack_.push_back(element);
   }
 
+  // Record up to max_depth managed frames of the stack of thread.
+  void WalkStack(Thread* thread, size_t max_depth) SHARED_REQUIRES(Locks::mutator_lock_);
+
   void SetStackElementAt(size_t index, ArtMethod* m, uint32_t dex_pc) {
     DCHECK_LT(index, stack_.size());
     stack_[index].SetMethod(m);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/time_utils.h"
+#include "gc_root.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+AllocSampler::AllocSampler(size_t sample_interval)
+    : sample_interval_(sample_interval),
+      bytes_until_sample_(sample_interval),
+      lock_("allocation sampler lock", kAllocTrackerLock),
+      random_(static_cast<std::minstd_rand::result_type>(NanoTime())),
+      total_samples_(0),
+      total_estimated_bytes_(0) {
+  CHECK_GT(sample_interval, 0u);
+}
+
+int64_t AllocSampler::NextInterval() {
+  // Uniform in [sample_interval_ / 2, 3 * sample_interval_ / 2), the mean stays sample_interval_.
+  std::uniform_int_distribution<size_t> distribution(sample_interval_ / 2,
+                                                     sample_interval_ + sample_interval_ / 2);
+  return static_cast<int64_t>(std::max<size_t>(distribution(random_), 1u));
+}
+
+void AllocSampler::RecordSample(Thread* self,
+                                mirror::Object** obj,
+                                size_t byte_count,
+                                size_t overshoot) {
+  // A large allocation may span several intervals.
+  const size_t estimated_bytes = (1 + overshoot / sample_interval_) * sample_interval_;
+  {
+    // Start the next interval before walking the stack so that other threads don't wait for it.
+    MutexLock mu(self, lock_);
+    bytes_until_sample_.FetchAndAddSequentiallyConsistent(static_cast<int64_t>(overshoot) +
+                                                          NextInterval());
+  }
+  Site site;
+  {
+    StackHandleScope<1> hs(self);
+    auto obj_wrapper = hs.NewHandleWrapper(obj);
+    site.trace.WalkStack(self, kMaxStackDepth);
+  }
+  std::string storage;
+  site.class_descriptor = (*obj)->GetClass()->GetDescriptor(&storage);
+  MutexLock mu(self, lock_);
+  SiteStats& stats = sites_[site];
+  ++stats.samples;
+  stats.estimated_bytes += estimated_bytes;
+  stats.sampled_bytes += byte_count;
+  ++total_samples_;
+  total_estimated_bytes_ += estimated_bytes;
+}
+
+void AllocSampler::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor,
+                                                                  RootInfo(kRootVMInternal));
+  MutexLock mu(Thread::Current(), lock_);
+  for (const auto& pair : sites_) {
+    const AllocRecordStackTrace& trace = pair.first.trace;
+    for (size_t i = 0, depth = trace.GetDepth(); i < depth; ++i) {
+      trace.GetStackElement(i).GetMethod()->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+void AllocSampler::Dump(std::ostream& os, size_t max_sites) {
+  // Copy the sites out since resolving line numbers under the lock would stall the samplers.
+  std::vector<std::pair<Site, SiteStats>> sites;
+  uint64_t total_samples;
+  uint64_t total_estimated_bytes;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    sites.assign(sites_.begin(), sites_.end());
+    total_samples = total_samples_;
+    total_estimated_bytes = total_estimated_bytes_;
+  }
+  // Sort pointers, the stack traces are not assignable.
+  std::vector<const std::pair<Site, SiteStats>*> sorted_sites;
+  for (const auto& pair : sites) {
+    sorted_sites.push_back(&pair);
+  }
+  std::sort(sorted_sites.begin(), sorted_sites.end(), [](const std::pair<Site, SiteStats>* a,
+                                                         const std::pair<Site, SiteStats>* b) {
+    return a->second.estimated_bytes > b->second.estimated_bytes;
+  });
+  if (max_sites != 0 && sorted_sites.size() > max_sites) {
+    sorted_sites.resize(max_sites);
+  }
+  os << "Allocation samples: " << total_samples << " samples, one per "
+     << PrettySize(sample_interval_) << ", " << PrettySize(total_estimated_bytes)
+     << " estimated\n";
+  for (const std::pair<Site, SiteStats>* pair : sorted_sites) {
+    const Site& site = pair->first;
+    const SiteStats& stats = pair->second;
+    os << "  " << PrettyDescriptor(site.class_descriptor.c_str()) << ": "
+       << PrettySize(stats.estimated_bytes) << " estimated, " << stats.samples << " samples of "
+       << PrettySize(stats.sampled_bytes) << "\n";
+    for (size_t i = 0, depth = site.trace.GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = site.trace.GetStackElement(i);
+      ArtMethod* method = element.GetMethod();
+      const char* source_file = method->GetDeclaringClassSourceFile();
+      os << "    at " << PrettyMethod(method, false) << "("
+         << (source_file != nullptr ? source_file : "unknown") << ":"
+         << element.ComputeLineNumber() << ")\n";
+    }
+  }
+}
+
+}  // namespace gc
+}  // namespace art
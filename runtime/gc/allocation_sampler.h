@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "atomic.h"
+#include "base/mutex.h"
+#include "gc/allocation_record.h"
+
+namespace art {
+
+class RootVisitor;
+class Thread;
+
+namespace mirror {
+  class Object;
+}  // namespace mirror
+
+namespace gc {
+
+// Low overhead allocation profiler. Unlike AllocRecordObjectMap which records every allocation
+// with its stack trace, this samples about one allocation per sample interval and aggregates the
+// samples by allocation site (allocated class and top frames). Bytes are counted on the
+// allocation slow path where a new TLAB or thread local run is accounted for all at once, so the
+// fast paths are not slowed down. The sample is the allocation which needed the new buffer.
+class AllocSampler {
+ public:
+  static constexpr size_t kMaxStackDepth = 4;
+
+  explicit AllocSampler(size_t sample_interval);
+
+  // Count bytes handed out by the allocation slow path. Returns true if this ended the current
+  // sample interval, in which case overshoot is set to the bytes counted past its end and the
+  // caller needs to call RecordSample.
+  ALWAYS_INLINE bool CountBytes(size_t bytes, size_t* overshoot) {
+    const int64_t before = bytes_until_sample_.FetchAndSubSequentiallyConsistent(bytes);
+    const int64_t after = before - static_cast<int64_t>(bytes);
+    if (LIKELY(after > 0) || before <= 0) {
+      // Either no sample is due, or another thread is already taking it.
+      return false;
+    }
+    *overshoot = static_cast<size_t>(-after);
+    return true;
+  }
+
+  void RecordSample(Thread* self, mirror::Object** obj, size_t byte_count, size_t overshoot)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Dump the max_sites sites with the most estimated bytes, all of them if max_sites is 0.
+  void Dump(std::ostream& os, size_t max_sites) SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Keep the methods of the sampled stacks from being unloaded.
+  void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  size_t GetSampleInterval() const {
+    return sample_interval_;
+  }
+
+ private:
+  struct Site {
+    std::string class_descriptor;
+    AllocRecordStackTrace trace;
+
+    bool operator==(const Site& other) const {
+      return class_descriptor == other.class_descriptor && trace == other.trace;
+    }
+  };
+
+  struct HashSite {
+    size_t operator()(const Site& site) const {
+      return std::hash<std::string>()(site.class_descriptor) *
+          AllocRecordStackTrace::kHashMultiplier + HashAllocRecordTypes()(site.trace);
+    }
+  };
+
+  struct SiteStats {
+    uint64_t samples = 0;
+    // Each sample stands for the sample intervals that ended with the allocation.
+    uint64_t estimated_bytes = 0;
+    // Sum of the sizes of the sampled objects.
+    uint64_t sampled_bytes = 0;
+  };
+
+  // Next sample interval, randomized around sample_interval_ so that periodic allocation patterns
+  // don't always sample the same site.
+  int64_t NextInterval() REQUIRES(lock_);
+
+  const size_t sample_interval_;
+  // Bytes left before the next sample, may briefly go negative while a sample is taken.
+  Atomic<int64_t> bytes_until_sample_;
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::minstd_rand random_ GUARDED_BY(lock_);
+  uint64_t total_samples_ GUARDED_BY(lock_);
+  uint64_t total_estimated_bytes_ GUARDED_BY(lock_);
+  std::unordered_map<Site, SiteStats, HashSite> sites_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/string.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace gc {
+
+class AllocSamplerTest : public CommonRuntimeTest {};
+
+TEST_F(AllocSamplerTest, CountBytes) {
+  AllocSampler sampler(1000);
+  size_t overshoot = 0;
+  EXPECT_FALSE(sampler.CountBytes(400, &overshoot));
+  EXPECT_FALSE(sampler.CountBytes(400, &overshoot));
+  // The thread which ends the interval takes the sample.
+  EXPECT_TRUE(sampler.CountBytes(400, &overshoot));
+  EXPECT_EQ(200u, overshoot);
+  // The others don't while the sample is being taken.
+  EXPECT_FALSE(sampler.CountBytes(400, &overshoot));
+}
+
+TEST_F(AllocSamplerTest, RecordSample) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::String> str(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "sampled")));
+  ASSERT_TRUE(str.Get() != nullptr);
+  AllocSampler sampler(1000);
+  size_t overshoot = 0;
+  ASSERT_TRUE(sampler.CountBytes(2500, &overshoot));
+  mirror::Object* obj = str.Get();
+  sampler.RecordSample(soa.Self(), &obj, obj->SizeOf(), overshoot);
+  // Sampling started a new interval of at least half the sample interval.
+  EXPECT_FALSE(sampler.CountBytes(400, &overshoot));
+  std::ostringstream os;
+  sampler.Dump(os, 0u);
+  // The allocation spanned two intervals.
+  EXPECT_NE(std::string::npos, os.str().find("1 samples")) << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("java.lang.String: 2000B estimated")) << os.str();
+}
+
+}  // namespace gc
+}  // namespace art
@@ -55,8 +55,10 @@ RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
       capacity_(capacity), max_capacity_(max_capacity),
       lock_("rosalloc global lock", kRosAllocGlobalLock),
       bulk_free_lock_("rosalloc bulk free lock", kRosAllocBulkFreeLock),
+      free_magazine_lock_("rosalloc free magazine lock", kRosAllocFreeMagazineLock),
       page_release_mode_(page_release_mode),
       page_release_size_threshold_(page_release_size_threshold),
+      page_release_granularity_(kPageSize),
       is_running_on_memory_tool_(running_on_memory_tool) {
   DCHECK_ALIGNED(base, kPageSize);
   DCHECK_EQ(RoundUp(capacity, kPageSize), capacity);
@@ -761,18 +763,24 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
 }
 
 size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
+  DCHECK_EQ(run->magic_num_, kMagicNum);
+  MutexLock brackets_mu(self, *size_bracket_locks_[run->size_bracket_idx_]);
+  return FreeFromRunLocked(self, ptr, run);
+}
+
+size_t RosAlloc::FreeFromRunLocked(Thread* self, void* ptr, Run* run) {
   DCHECK_EQ(run->magic_num_, kMagicNum);
   DCHECK_LT(run, ptr);
   DCHECK_LT(ptr, run->End());
   const size_t idx = run->size_bracket_idx_;
   const size_t bracket_size = bracketSizes[idx];
   bool run_was_full = false;
-  MutexLock brackets_mu(self, *size_bracket_locks_[idx]);
+  size_bracket_locks_[idx]->AssertHeld(self);
   if (kIsDebugBuild) {
     run_was_full = run->IsFull();
   }
   if (kTraceRosAlloc) {
-    LOG(INFO) << "RosAlloc::FreeFromRun() : 0x" << std::hex << reinterpret_cast<intptr_t>(ptr);
+    LOG(INFO) << "RosAlloc::FreeFromRunLocked() : 0x" << std::hex << reinterpret_cast<intptr_t>(ptr);
   }
   if (LIKELY(run->IsThreadLocal())) {
     // It's a thread-local run. Just mark the thread-local free bit map and return.
@@ -781,7 +789,7 @@ size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
     DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
     run->AddToThreadLocalFreeList(ptr);
     if (kTraceRosAlloc) {
-      LOG(INFO) << "RosAlloc::FreeFromRun() : Freed a slot in a thread local run 0x" << std::hex
+      LOG(INFO) << "RosAlloc::FreeFromRunLocked() : Freed a slot in a thread local run 0x" << std::hex
                 << reinterpret_cast<intptr_t>(run);
     }
     // A thread local run will be kept as a thread local even if it's become all free.
@@ -796,7 +804,7 @@ size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
     if (pos != non_full_runs->end()) {
       non_full_runs->erase(pos);
       if (kTraceRosAlloc) {
-        LOG(INFO) << "RosAlloc::FreeFromRun() : Erased run 0x" << std::hex
+        LOG(INFO) << "RosAlloc::FreeFromRunLocked() : Erased run 0x" << std::hex
                   << reinterpret_cast<intptr_t>(run) << " from non_full_runs_";
       }
     }
@@ -823,14 +831,14 @@ size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
         if (kIsDebugBuild) {
           full_runs->erase(run);
           if (kTraceRosAlloc) {
-            LOG(INFO) << "RosAlloc::FreeFromRun() : Erased run 0x" << std::hex
+            LOG(INFO) << "RosAlloc::FreeFromRunLocked() : Erased run 0x" << std::hex
                       << reinterpret_cast<intptr_t>(run) << " from full_runs_";
           }
         }
         non_full_runs->insert(run);
         DCHECK(!run->IsFull());
         if (kTraceRosAlloc) {
-          LOG(INFO) << "RosAlloc::FreeFromRun() : Inserted run 0x" << std::hex
+          LOG(INFO) << "RosAlloc::FreeFromRunLocked() : Inserted run 0x" << std::hex
                     << reinterpret_cast<intptr_t>(run)
                     << " into non_full_runs_[" << std::dec << idx << "]";
         }
@@ -1001,6 +1009,87 @@ void RosAlloc::Run::InspectAllSlots(void (*handler)(void* start, void* end, size
   }
 }
 
+RosAlloc::Run* RosAlloc::RunForAllocatedSlot(void* ptr) {
+  DCHECK_LE(base_, ptr);
+  DCHECK_LT(ptr, base_ + footprint_);
+  size_t pm_idx = RoundDownToPageMapIndex(ptr);
+  uint8_t page_map_entry = page_map_[pm_idx];
+  switch (page_map_entry) {
+    case kPageMapLargeObject:
+      return nullptr;
+    case kPageMapRunPart:
+      // Find the beginning of the run.
+      do {
+        --pm_idx;
+        DCHECK_LT(pm_idx, capacity_ / kPageSize);
+      } while (page_map_[pm_idx] != kPageMapRun);
+      FALLTHROUGH_INTENDED;
+    case kPageMapRun: {
+      Run* run = reinterpret_cast<Run*>(base_ + pm_idx * kPageSize);
+      DCHECK_EQ(run->magic_num_, kMagicNum);
+      return run;
+    }
+    default:
+      LOG(FATAL) << "Unreachable - page map type: " << static_cast<int>(page_map_entry);
+      return nullptr;
+  }
+}
+
+RosAlloc::FreeMagazine::FreeMagazine(Thread* self, RosAlloc* rosalloc)
+    : self_(self), rosalloc_(rosalloc), sizes_(), entries_(nullptr) {
+  rosalloc->free_magazine_lock_.ExclusiveLock(self);
+  if (rosalloc->free_magazine_entries_ == nullptr) {
+    rosalloc->free_magazine_entries_.reset(
+        new FreeMagazineEntry[kNumOfSizeBrackets * kMagazineSize]);
+  }
+  entries_ = rosalloc->free_magazine_entries_.get();
+}
+
+RosAlloc::FreeMagazine::~FreeMagazine() {
+  for (size_t idx = 0; idx < kNumOfSizeBrackets; ++idx) {
+    DCHECK_EQ(sizes_[idx], 0u) << "Magazine destroyed without a flush, idx=" << idx;
+  }
+  rosalloc_->free_magazine_lock_.ExclusiveUnlock(self_);
+}
+
+size_t RosAlloc::FreeMagazine::Add(Thread* self, void* ptr) {
+  Run* run = rosalloc_->RunForAllocatedSlot(ptr);
+  if (run == nullptr) {
+    ReaderMutexLock rmu(self, rosalloc_->bulk_free_lock_);
+    MutexLock mu(self, rosalloc_->lock_);
+    return rosalloc_->FreePages(self, ptr, false);
+  }
+  const size_t idx = run->size_bracket_idx_;
+  DCHECK_LT(sizes_[idx], kMagazineSize);
+  FreeMagazineEntry* entry = &entries_[idx * kMagazineSize + sizes_[idx]];
+  entry->run = run;
+  entry->ptr = ptr;
+  if (++sizes_[idx] == kMagazineSize) {
+    FlushBracket(self, idx);
+  }
+  return bracketSizes[idx];
+}
+
+void RosAlloc::FreeMagazine::Flush(Thread* self) {
+  for (size_t idx = 0; idx < kNumOfSizeBrackets; ++idx) {
+    if (sizes_[idx] != 0) {
+      FlushBracket(self, idx);
+    }
+  }
+}
+
+void RosAlloc::FreeMagazine::FlushBracket(Thread* self, size_t idx) {
+  ReaderMutexLock rmu(self, rosalloc_->bulk_free_lock_);
+  MutexLock brackets_mu(self, *rosalloc_->size_bracket_locks_[idx]);
+  FreeMagazineEntry* entries = &entries_[idx * kMagazineSize];
+  for (size_t i = 0; i < sizes_[idx]; ++i) {
+    // Check the thread local state under the bracket lock, the run may have been revoked since
+    // the slot was added.
+    rosalloc_->FreeFromRunLocked(self, entries[i].ptr, entries[i].run);
+  }
+  sizes_[idx] = 0;
+}
+
 // If true, read the page map entries in BulkFree() without using the
 // lock for better performance, assuming that the existence of an
 // allocated chunk/pointer being freed in BulkFree() guarantees that
@@ -2040,6 +2129,13 @@ size_t RosAlloc::ReleasePages() {
   return reclaimed_bytes;
 }
 
+void RosAlloc::SetPageReleaseGranularity(size_t granularity) {
+  CHECK(IsPowerOfTwo(granularity)) << granularity;
+  CHECK_GE(granularity, static_cast<size_t>(kPageSize));
+  MutexLock mu(Thread::Current(), lock_);
+  page_release_granularity_ = granularity;
+}
+
 size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
   DCHECK_ALIGNED(start, kPageSize);
   DCHECK_ALIGNED(end, kPageSize);
@@ -2054,6 +2150,13 @@ size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
       return 0;
     }
   }
+  if (page_release_granularity_ != kPageSize) {
+    start = AlignUp(start, page_release_granularity_);
+    end = AlignDown(end, page_release_granularity_);
+    if (start >= end) {
+      return 0;
+    }
+  }
   if (!kMadviseZeroes) {
     // TODO: Do this when we resurrect the page instead.
     memset(start, 0, end - start);
@@ -758,11 +758,23 @@ class RosAlloc {
   // RevokeThreadLocalRuns() on the bulk free list.
   ReaderWriterMutex bulk_free_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
+  // A slot buffered by a FreeMagazine.
+  struct FreeMagazineEntry {
+    Run* run;
+    void* ptr;
+  };
+  // Held by the live FreeMagazine, which uses free_magazine_entries_.
+  Mutex free_magazine_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // The buffer of the FreeMagazines, allocated by the first one. It is too large for the stack.
+  std::unique_ptr<FreeMagazineEntry[]> free_magazine_entries_ GUARDED_BY(free_magazine_lock_);
+
   // The page release mode.
   const PageReleaseMode page_release_mode_;
   // Under kPageReleaseModeSize(AndEnd), if the free page run size is
   // greater than or equal to this value, release pages.
   const size_t page_release_size_threshold_;
+  // Free pages are only released in aligned chunks of this many bytes.
+  size_t page_release_granularity_ GUARDED_BY(lock_);
 
   // Whether this allocator is running under Valgrind.
   bool is_running_on_memory_tool_;
@@ -792,6 +804,13 @@ class RosAlloc {
   // Returns the bracket size.
   size_t FreeFromRun(Thread* self, void* ptr, Run* run)
       REQUIRES(!lock_);
+  // Same as FreeFromRun() but the caller holds the size bracket lock of the run.
+  size_t FreeFromRunLocked(Thread* self, void* ptr, Run* run)
+      REQUIRES(!lock_);
+
+  // Returns the run that contains ptr, or null if ptr is a large object. Reads the page map
+  // without the lock, ptr must be allocated.
+  Run* RunForAllocatedSlot(void* ptr);
 
   // Used to allocate a new thread local run for a size bracket.
   Run* AllocRun(Thread* self, size_t idx) REQUIRES(!lock_);
@@ -851,6 +870,39 @@ class RosAlloc {
   size_t BulkFree(Thread* self, void** ptrs, size_t num_ptrs)
       REQUIRES(!bulk_free_lock_, !lock_);
 
+  // Per size bracket buffers of slots to free. A bracket's buffer is returned to the runs under
+  // one size bracket lock acquisition when it fills up or on Flush(). Unlike BulkFree() it only
+  // needs bulk_free_lock_ shared, so individual Free() calls can go on meanwhile. The magazines of
+  // a RosAlloc share one buffer, so a magazine holds free_magazine_lock_ while it lives.
+  class SCOPED_CAPABILITY FreeMagazine {
+   public:
+    FreeMagazine(Thread* self, RosAlloc* rosalloc) ACQUIRE(rosalloc->free_magazine_lock_);
+    ~FreeMagazine() RELEASE();
+
+    // Returns the bytes freed, which are accounted for right away even if the slot is only
+    // returned to its run on a later flush. Large objects are freed immediately.
+    size_t Add(Thread* self, void* ptr) REQUIRES(!rosalloc_->bulk_free_lock_, !rosalloc_->lock_);
+
+    // Return all the buffered slots to their runs.
+    void Flush(Thread* self) REQUIRES(!rosalloc_->bulk_free_lock_, !rosalloc_->lock_);
+
+    // The number of slots buffered per size bracket.
+    static constexpr size_t kMagazineSize = 32;
+
+   private:
+    void FlushBracket(Thread* self, size_t idx)
+        REQUIRES(!rosalloc_->bulk_free_lock_, !rosalloc_->lock_);
+
+    Thread* const self_;
+    RosAlloc* const rosalloc_;
+    // The number of buffered slots for each size bracket.
+    size_t sizes_[kNumOfSizeBrackets];
+    // kMagazineSize entries per size bracket, in rosalloc_->free_magazine_entries_.
+    FreeMagazineEntry* entries_;
+
+    DISALLOW_COPY_AND_ASSIGN(FreeMagazine);
+  };
+
   // Returns true if the given allocation request can be allocated in
   // an existing thread local run without allocating a new run.
   ALWAYS_INLINE bool CanAllocFromThreadLocalRun(Thread* self, size_t size);
@@ -883,6 +935,9 @@ class RosAlloc {
 
   // Release empty pages.
   size_t ReleasePages() REQUIRES(!lock_);
+  // Only release empty pages in aligned chunks of granularity bytes, so that releasing a free
+  // page run doesn't split the transparent huge pages backing the space.
+  void SetPageReleaseGranularity(size_t granularity) REQUIRES(!lock_);
   // Returns the current footprint.
   size_t Footprint() REQUIRES(!lock_);
   // Returns the current capacity, maximum footprint.
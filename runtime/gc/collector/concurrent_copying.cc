@@ -35,6 +35,7 @@
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -52,8 +53,13 @@ static constexpr bool kDisallowReadBarrierDuringScan = kIsDebugBuild;
 // Slow path mark stack size, increase this if the stack is getting full and it is causing
 // performance problems.
 static constexpr size_t kReadBarrierMarkStackSize = 512 * KB;
+// Don't use the thread pool for fewer mark stack entries than this, and don't hand a thread-local
+// mark stack to an idle task unless it has at least this many entries.
+static constexpr size_t kMinimumParallelMarkStackSize = 128;
+static constexpr bool kParallelProcessMarkStack = true;
 
 ConcurrentCopying::ConcurrentCopying(Heap* heap,
+                                     bool young_gen,
                                      const std::string& name_prefix,
                                      bool measure_read_barrier_slow_path)
     : GarbageCollector(heap,
@@ -68,6 +74,8 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
                                                          kReadBarrierMarkStackSize)),
       rb_mark_bit_stack_full_(false),
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
+      num_started_mark_tasks_(0),
+      num_idle_mark_tasks_(0),
       thread_running_gc_(nullptr),
       is_marking_(false), is_active_(false), is_asserting_to_space_invariant_(false),
       region_space_bitmap_(nullptr),
@@ -84,6 +92,7 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       rb_slow_path_count_gc_total_(0),
       rb_table_(heap_->GetReadBarrierTable()),
       force_evacuate_all_(false),
+      young_gen_(young_gen),
       immune_gray_stack_lock_("concurrent copying immune gray stack lock",
                               kMarkSweepMarkStackLock) {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
@@ -202,9 +211,13 @@ void ConcurrentCopying::InitializePhase() {
   immune_spaces_.Reset();
   bytes_moved_.StoreRelaxed(0);
   objects_moved_.StoreRelaxed(0);
-  if (GetCurrentIteration()->GetGcCause() == kGcCauseExplicit ||
-      GetCurrentIteration()->GetGcCause() == kGcCauseForNativeAlloc ||
-      GetCurrentIteration()->GetClearSoftReferences()) {
+  if (young_gen_) {
+    // Evacuating the old regions would require tracing through them.
+    force_evacuate_all_ = false;
+  } else if (GetCurrentIteration()->GetGcCause() == kGcCauseExplicit ||
+             GetCurrentIteration()->GetGcCause() == kGcCauseForNativeAlloc ||
+             GetCurrentIteration()->GetGcCause() == kGcCauseHomogeneousSpaceCompact ||
+             GetCurrentIteration()->GetClearSoftReferences()) {
     force_evacuate_all_ = true;
   } else {
     force_evacuate_all_ = false;
@@ -315,16 +328,33 @@ class ConcurrentCopying::FlipCallback : public Closure {
     Thread* self = Thread::Current();
     CHECK(thread == self);
     Locks::mutator_lock_->AssertExclusiveHeld(self);
-    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+    space::RegionSpace::EvacMode evac_mode = space::RegionSpace::EvacMode::kEvacModeNewlyAllocated;
+    if (!cc->young_gen_) {
+      evac_mode = cc->force_evacuate_all_
+          ? space::RegionSpace::EvacMode::kEvacModeForceAll
+          : space::RegionSpace::EvacMode::kEvacModeLivePercentNewlyAllocated;
+    }
+    cc->region_space_->SetFromSpace(cc->rb_table_, evac_mode);
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      if (cc->young_gen_) {
+        // The old regions stay in the to-space.
+        cc->from_space_num_objects_at_first_pause_ =
+            cc->region_space_->GetObjectsAllocatedInFromSpace() +
+            cc->region_space_->GetObjectsAllocatedInUnevacFromSpace();
+        cc->from_space_num_bytes_at_first_pause_ =
+            cc->region_space_->GetBytesAllocatedInFromSpace() +
+            cc->region_space_->GetBytesAllocatedInUnevacFromSpace();
+      } else {
+        cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
+        cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      }
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
-    if (kIsDebugBuild) {
+    if (kIsDebugBuild && !cc->young_gen_) {
+      // The old to-space regions of a young-generation GC keep their live bytes.
       cc->region_space_->AssertAllRegionLiveBytesZeroOrCleared();
     }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
@@ -339,6 +369,13 @@ class ConcurrentCopying::FlipCallback : public Closure {
         cc->VerifyGrayImmuneObjects();
       }
     }
+    if (cc->heap_->IsGenerationalCCEnabled()) {
+      if (cc->young_gen_) {
+        cc->GrayDirtyOldObjects();
+      }
+      // Writes from here on dirty the cards that the next young-generation GC scans.
+      cc->ClearNonImmuneCards();
+    }
   }
 
  private:
@@ -488,6 +525,52 @@ void ConcurrentCopying::GrayAllDirtyImmuneObjects() {
   updated_all_immune_objects_.StoreRelaxed(true);
 }
 
+// Gray and push the old objects that may refer to objects in the regions being evacuated by a
+// young-generation GC. These are the objects on dirty cards and the non-moving objects allocated
+// since the previous GC, which are not in the live bitmaps yet.
+// TODO: Scan the cards concurrently like the immune spaces to shorten the pause.
+void ConcurrentCopying::GrayDirtyOldObjects() {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  DCHECK(young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  auto gray_and_push = [this](mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_) {
+    // The mutators are suspended, so no CAS is needed. An object may be visited twice, such as a
+    // non-moving object on the live stack and on a dirty card.
+    if (obj->GetReadBarrierPointer() == ReadBarrier::WhitePtr()) {
+      obj->SetReadBarrierPointer(ReadBarrier::GrayPtr());
+      PushOntoMarkStack(obj);
+    }
+  };
+  region_space_->VisitToSpaceObjectsOnDirtyCards(card_table, gray_and_push);
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_ || immune_spaces_.ContainsSpace(space)) {
+      continue;
+    }
+    card_table->Scan<false>(space->GetLiveBitmap(), space->Begin(), space->End(), gray_and_push);
+  }
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  for (StackReference<mirror::Object>* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+    mirror::Object* obj = it->AsMirrorPtr();
+    if (obj != nullptr && obj->GetClass<kVerifyNone, kWithoutReadBarrier>() != nullptr) {
+      gray_and_push(obj);
+    }
+  }
+}
+
+// Clear the cards of the region space and the non-immune non-moving spaces so that the next
+// young-generation GC only scans the objects written to after this pause.
+void ConcurrentCopying::ClearNonImmuneCards() {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (immune_spaces_.ContainsSpace(space)) {
+      continue;
+    }
+    card_table->ClearCardRange(space->Begin(), space->Limit());
+  }
+}
+
 void ConcurrentCopying::SwapStacks() {
   heap_->SwapStacks();
 }
@@ -685,12 +768,28 @@ void ConcurrentCopying::MarkingPhase() {
     CheckEmptyMarkStack();
   }
 
+  if (heap_->IsGenerationalCCEnabled() && !young_gen_) {
+    FillDeadObjectsInUnevacFromSpace();
+  }
+
   CHECK(weak_ref_access_enabled_);
   if (kVerboseMode) {
     LOG(INFO) << "GC end of MarkingPhase";
   }
 }
 
+// The unevacuated regions become old to-space regions that young-generation GCs walk linearly.
+// Overwrite their dead objects, whose references may become dangling, with dummy objects. This
+// must happen before the sweeping since the walk needs the classes of the dead objects.
+void ConcurrentCopying::FillDeadObjectsInUnevacFromSpace() {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  region_space_->VisitDeadObjectRunsInUnevacFromSpace(
+      region_space_bitmap_,
+      [this](mirror::Object* dead_obj, size_t byte_size) SHARED_REQUIRES(Locks::mutator_lock_) {
+        FillWithDummyObject(dead_obj, byte_size);
+      });
+}
+
 void ConcurrentCopying::ReenableWeakRefAccess(Thread* self) {
   if (kVerboseMode) {
     LOG(INFO) << "ReenableWeakRefAccess";
@@ -849,19 +948,7 @@ void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
       if (UNLIKELY(tl_mark_stack == nullptr || tl_mark_stack->IsFull())) {
         MutexLock mu(self, mark_stack_lock_);
         // Get a new thread local mark stack.
-        accounting::AtomicStack<mirror::Object>* new_tl_mark_stack;
-        if (!pooled_mark_stacks_.empty()) {
-          // Use a pooled mark stack.
-          new_tl_mark_stack = pooled_mark_stacks_.back();
-          pooled_mark_stacks_.pop_back();
-        } else {
-          // None pooled. Create a new one.
-          new_tl_mark_stack =
-              accounting::AtomicStack<mirror::Object>::Create(
-                  "thread local mark stack", 4 * KB, 4 * KB);
-        }
-        DCHECK(new_tl_mark_stack != nullptr);
-        DCHECK(new_tl_mark_stack->IsEmpty());
+        accounting::AtomicStack<mirror::Object>* new_tl_mark_stack = AllocateMarkStackLocked();
         new_tl_mark_stack->PushBack(to_ref);
         self->SetThreadLocalMarkStack(new_tl_mark_stack);
         if (tl_mark_stack != nullptr) {
@@ -896,6 +983,34 @@ void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
   }
 }
 
+accounting::ObjectStack* ConcurrentCopying::AllocateMarkStackLocked() {
+  accounting::AtomicStack<mirror::Object>* mark_stack;
+  if (!pooled_mark_stacks_.empty()) {
+    // Use a pooled mark stack.
+    mark_stack = pooled_mark_stacks_.back();
+    pooled_mark_stacks_.pop_back();
+  } else {
+    // None pooled. Create a new one.
+    mark_stack = accounting::AtomicStack<mirror::Object>::Create(
+        "thread local mark stack", 4 * KB, 4 * KB);
+  }
+  DCHECK(mark_stack != nullptr);
+  DCHECK(mark_stack->IsEmpty());
+  return mark_stack;
+}
+
+void ConcurrentCopying::RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack) {
+  MutexLock mu(self, mark_stack_lock_);
+  if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
+    // The pool has enough. Delete it.
+    delete mark_stack;
+  } else {
+    // Otherwise, put it into the pool for later reuse.
+    mark_stack->Reset();
+    pooled_mark_stacks_.push_back(mark_stack);
+  }
+}
+
 accounting::ObjectStack* ConcurrentCopying::GetAllocationStack() {
   return heap_->allocation_stack_.get();
 }
@@ -1256,12 +1371,28 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
 }
 
 size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_access) {
+  Thread* self = Thread::Current();
   // Run a checkpoint to collect all thread local mark stacks and iterate over them all.
   RevokeThreadLocalMarkStacks(disable_weak_ref_access);
+  // Other threads may only push onto their own mark stacks in the thread-local mark stack mode.
+  const size_t thread_count = GetThreadCount();
+  if (kParallelProcessMarkStack && thread_count > 1 &&
+      mark_stack_mode_.LoadRelaxed() == kMarkStackModeThreadLocal) {
+    size_t num_refs = gc_mark_stack_->Size();
+    {
+      MutexLock mu(self, mark_stack_lock_);
+      for (accounting::AtomicStack<mirror::Object>* mark_stack : revoked_mark_stacks_) {
+        num_refs += mark_stack->Size();
+      }
+    }
+    if (num_refs >= kMinimumParallelMarkStackSize) {
+      return ProcessMarkStacksParallel(thread_count);
+    }
+  }
   size_t count = 0;
   std::vector<accounting::AtomicStack<mirror::Object>*> mark_stacks;
   {
-    MutexLock mu(Thread::Current(), mark_stack_lock_);
+    MutexLock mu(self, mark_stack_lock_);
     // Make a copy of the mark stack vector.
     mark_stacks = revoked_mark_stacks_;
     revoked_mark_stacks_.clear();
@@ -1272,21 +1403,172 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
       ProcessMarkStackRef(to_ref);
       ++count;
     }
-    {
-      MutexLock mu(Thread::Current(), mark_stack_lock_);
-      if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
-        // The pool has enough. Delete it.
-        delete mark_stack;
-      } else {
-        // Otherwise, put it into the pool for later reuse.
-        mark_stack->Reset();
-        pooled_mark_stacks_.push_back(mark_stack);
+    RecycleMarkStack(self, mark_stack);
+  }
+  return count;
+}
+
+size_t ConcurrentCopying::GetThreadCount() const {
+  // Use less threads if we are in a background state (non jank perceptible) since we want to leave
+  // more CPU time for the foreground apps.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return std::min(heap_->GetConcGCThreadCount() + 1,
+                  static_cast<size_t>(kMaxParallelMarkThreads));
+}
+
+bool ConcurrentCopying::IsGcThread(Thread* self) const {
+  if (self == thread_running_gc_) {
+    return true;
+  }
+  for (const Atomic<Thread*>& thread : parallel_mark_threads_) {
+    if (thread.LoadRelaxed() == self) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Processes mark stacks until none are left. A task first drains the mark stack of its own thread,
+// then takes a mark stack that another thread overflowed or handed over.
+class ConcurrentCopying::ProcessMarkStackTask : public Task {
+ public:
+  ProcessMarkStackTask(ConcurrentCopying* collector, size_t index, Atomic<size_t>* count)
+      : collector_(collector), index_(index), count_(count) {}
+
+  // The GC-running thread waiting for the tasks holds the mutator lock.
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    collector_->parallel_mark_threads_[index_].StoreRelaxed(self);
+    collector_->num_started_mark_tasks_.FetchAndAddSequentiallyConsistent(1);
+    size_t count = 0;
+    while (true) {
+      count += collector_->ProcessLocalMarkStack(self);
+      accounting::ObjectStack* mark_stack = collector_->PopRevokedMarkStack(self);
+      if (mark_stack != nullptr) {
+        for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != mark_stack->End();
+             ++p) {
+          collector_->ProcessMarkStackRef(p->AsMirrorPtr());
+          ++count;
+        }
+        collector_->RecycleMarkStack(self, mark_stack);
+        continue;
+      }
+      // Out of work. Wait for another task to hand over a mark stack, or for every started task to
+      // run out of work too. Mark stacks revoked after that are left for the next round.
+      collector_->num_idle_mark_tasks_.FetchAndAddSequentiallyConsistent(1);
+      bool found_work = false;
+      while (collector_->num_idle_mark_tasks_.LoadSequentiallyConsistent() <
+             collector_->num_started_mark_tasks_.LoadSequentiallyConsistent()) {
+        if (collector_->HasRevokedMarkStacks(self)) {
+          found_work = true;
+          break;
+        }
+        sched_yield();
+      }
+      if (!found_work) {
+        break;
+      }
+      collector_->num_idle_mark_tasks_.FetchAndSubSequentiallyConsistent(1);
+    }
+    count_->FetchAndAddSequentiallyConsistent(count);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  const size_t index_;
+  Atomic<size_t>* const count_;
+};
+
+size_t ConcurrentCopying::ProcessMarkStacksParallel(size_t thread_count) {
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  DCHECK(thread_pool != nullptr);
+  DCHECK_GT(thread_count, 1U);
+  DCHECK_LE(thread_count, static_cast<size_t>(kMaxParallelMarkThreads));
+  // Let the workers take part of what the GC-running thread has accumulated so far.
+  ShareGcMarkStack(self);
+  num_started_mark_tasks_.StoreRelaxed(0);
+  num_idle_mark_tasks_.StoreRelaxed(0);
+  Atomic<size_t> count(0);
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new ProcessMarkStackTask(this, i, &count));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+  for (Atomic<Thread*>& thread : parallel_mark_threads_) {
+    thread.StoreRelaxed(nullptr);
+  }
+  return count.LoadSequentiallyConsistent();
+}
+
+size_t ConcurrentCopying::ProcessLocalMarkStack(Thread* self) {
+  size_t count = 0;
+  if (self == thread_running_gc_) {
+    while (!gc_mark_stack_->IsEmpty()) {
+      if (num_idle_mark_tasks_.LoadRelaxed() != 0 &&
+          gc_mark_stack_->Size() >= kMinimumParallelMarkStackSize) {
+        // Hand the rest to the idle tasks.
+        ShareGcMarkStack(self);
+        break;
       }
+      ProcessMarkStackRef(gc_mark_stack_->PopBack());
+      ++count;
     }
+    return count;
+  }
+  while (true) {
+    // Reload the stack since a push may have revoked a full one and switched to a new one.
+    accounting::AtomicStack<mirror::Object>* tl_mark_stack = self->GetThreadLocalMarkStack();
+    if (tl_mark_stack == nullptr || tl_mark_stack->IsEmpty()) {
+      break;
+    }
+    if (num_idle_mark_tasks_.LoadRelaxed() != 0 &&
+        tl_mark_stack->Size() >= kMinimumParallelMarkStackSize) {
+      // Hand the stack to the idle tasks.
+      RevokeThreadLocalMarkStack(self);
+      break;
+    }
+    ProcessMarkStackRef(tl_mark_stack->PopBack());
+    ++count;
   }
   return count;
 }
 
+void ConcurrentCopying::ShareGcMarkStack(Thread* self) {
+  DCHECK_EQ(self, thread_running_gc_);
+  MutexLock mu(self, mark_stack_lock_);
+  while (!gc_mark_stack_->IsEmpty()) {
+    accounting::AtomicStack<mirror::Object>* mark_stack = AllocateMarkStackLocked();
+    while (!gc_mark_stack_->IsEmpty() && !mark_stack->IsFull()) {
+      mark_stack->PushBack(gc_mark_stack_->PopBack());
+    }
+    revoked_mark_stacks_.push_back(mark_stack);
+  }
+  gc_mark_stack_->Reset();
+}
+
+accounting::ObjectStack* ConcurrentCopying::PopRevokedMarkStack(Thread* self) {
+  MutexLock mu(self, mark_stack_lock_);
+  if (revoked_mark_stacks_.empty()) {
+    return nullptr;
+  }
+  accounting::ObjectStack* mark_stack = revoked_mark_stacks_.back();
+  revoked_mark_stacks_.pop_back();
+  return mark_stack;
+}
+
+bool ConcurrentCopying::HasRevokedMarkStacks(Thread* self) {
+  MutexLock mu(self, mark_stack_lock_);
+  return !revoked_mark_stacks_.empty();
+}
+
 inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
   if (kUseBakerReadBarrier) {
@@ -1325,8 +1607,8 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
 #endif
 
   if (region_space_->IsInUnevacFromSpace(to_ref)) {
-    // Add to the live bytes per unevacuated from space. Note this code is always run by the
-    // GC-running thread (no synchronization required).
+    // Add to the live bytes per unevacuated from space. This may run on several GC threads at once
+    // so the region adds atomically.
     DCHECK(region_space_bitmap_->Test(to_ref));
     // Disable the read barrier in SizeOf for performance, which is safe.
     size_t obj_size = to_ref->SizeOf<kDefaultVerifyFlags, kWithoutReadBarrier>();
@@ -1511,8 +1793,17 @@ void ConcurrentCopying::ReclaimPhase() {
 
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
-    Sweep(false);
-    SwapBitmaps();
+    if (young_gen_) {
+      // A young-generation GC does not collect the non-moving spaces. Only make the objects
+      // allocated since the previous GC live so that the next GC finds them in the live bitmaps.
+      TimingLogger::ScopedTiming t("MarkStackAsLive", GetTimings());
+      accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+      heap_->MarkAllocStackAsLive(live_stack);
+      live_stack->Reset();
+    } else {
+      Sweep(false);
+      SwapBitmaps();
+    }
     heap_->UnBindBitmaps();
 
     // Delete the region bitmap.
@@ -1665,7 +1956,7 @@ void ConcurrentCopying::AssertToSpaceInvariantInNonMovingSpace(mirror::Object* o
   if (immune_spaces_.ContainsObject(ref)) {
     if (kUseBakerReadBarrier) {
       // Immune object may not be gray if called from the GC.
-      if (Thread::Current() == thread_running_gc_ && !gc_grays_immune_objects_) {
+      if (IsGcThread(Thread::Current()) && !gc_grays_immune_objects_) {
         return;
       }
       bool updated_all_immune_objects = updated_all_immune_objects_.LoadSequentiallyConsistent();
@@ -1675,6 +1966,8 @@ void ConcurrentCopying::AssertToSpaceInvariantInNonMovingSpace(mirror::Object* o
           << " ref=" << ref << " ref rb_ptr=" << ref->GetReadBarrierPointer()
           << " updated_all_immune_objects=" << updated_all_immune_objects;
     }
+  } else if (young_gen_) {
+    // A young-generation GC does not mark the non-moving spaces since all their objects are live.
   } else {
     accounting::ContinuousSpaceBitmap* mark_bitmap =
         heap_mark_bitmap_->GetContinuousSpaceBitmap(ref);
@@ -1738,7 +2031,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
     Thread::Current()->ModifyDebugDisallowReadBarrier(1);
   }
   DCHECK(!region_space_->IsInFromSpace(to_ref));
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(IsGcThread(Thread::Current()));
   RefFieldsVisitor visitor(this);
   // Disable the read barrier for a performance reason.
   to_ref->VisitReferences</*kVisitNativeRoots*/true, kDefaultVerifyFlags, kWithoutReadBarrier>(
@@ -1750,7 +2043,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
 
 // Process a field.
 inline void ConcurrentCopying::Process(mirror::Object* obj, MemberOffset offset) {
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(IsGcThread(Thread::Current()));
   mirror::Object* ref = obj->GetFieldObject<
       mirror::Object, kVerifyNone, kWithoutReadBarrier, false>(offset);
   mirror::Object* to_ref = Mark</*kGrayImmuneObject*/false>(ref);
@@ -1991,9 +2284,11 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
                                                &non_moving_space_bytes_allocated, nullptr, &dummy);
       CHECK(to_ref != nullptr) << "Fall-back non-moving space allocation failed";
       bytes_allocated = non_moving_space_bytes_allocated;
-      // Mark it in the mark bitmap.
-      accounting::ContinuousSpaceBitmap* mark_bitmap =
-          heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
+      // Mark it in the mark bitmap. A young-generation GC does not swap the bitmaps, so it marks
+      // the copy live directly.
+      accounting::ContinuousSpaceBitmap* mark_bitmap = young_gen_
+          ? heap_->non_moving_space_->GetLiveBitmap()
+          : heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
       CHECK(mark_bitmap != nullptr);
       CHECK(!mark_bitmap->AtomicTestAndSet(to_ref));
     }
@@ -2032,8 +2327,9 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
         DCHECK(heap_->non_moving_space_->HasAddress(to_ref));
         DCHECK_EQ(bytes_allocated, non_moving_space_bytes_allocated);
         // Free the non-moving-space chunk.
-        accounting::ContinuousSpaceBitmap* mark_bitmap =
-            heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
+        accounting::ContinuousSpaceBitmap* mark_bitmap = young_gen_
+            ? heap_->non_moving_space_->GetLiveBitmap()
+            : heap_mark_bitmap_->GetContinuousSpaceBitmap(to_ref);
         CHECK(mark_bitmap != nullptr);
         CHECK(mark_bitmap->Clear(to_ref));
         heap_->non_moving_space_->Free(Thread::Current(), to_ref);
@@ -2106,6 +2402,9 @@ mirror::Object* ConcurrentCopying::IsMarked(mirror::Object* from_ref) {
     if (immune_spaces_.ContainsObject(from_ref)) {
       // An immune object is alive.
       to_ref = from_ref;
+    } else if (young_gen_) {
+      // A young-generation GC does not collect the non-moving spaces.
+      to_ref = from_ref;
     } else {
       // Non-immune non-moving space. Use the mark bitmap.
       accounting::ContinuousSpaceBitmap* mark_bitmap =
@@ -2145,6 +2444,11 @@ mirror::Object* ConcurrentCopying::MarkNonMoving(mirror::Object* ref) {
   // ref is in a non-moving space (from_ref == to_ref).
   DCHECK(!region_space_->HasAddress(ref)) << ref;
   DCHECK(!immune_spaces_.ContainsObject(ref));
+  if (young_gen_) {
+    // A young-generation GC treats the non-moving objects as old. Those that may refer to young
+    // objects were grayed in the pause.
+    return ref;
+  }
   // Use the mark bitmap.
   accounting::ContinuousSpaceBitmap* mark_bitmap =
       heap_mark_bitmap_->GetContinuousSpaceBitmap(ref);
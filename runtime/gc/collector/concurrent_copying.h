@@ -61,7 +61,10 @@ class ConcurrentCopying : public GarbageCollector {
   // pages.
   static constexpr bool kGrayDirtyImmuneObjects = true;
 
+  // If young_gen is true, the collector only evacuates the regions allocated since the previous
+  // GC and treats the objects on dirty cards in the other spaces as roots.
   ConcurrentCopying(Heap* heap,
+                    bool young_gen,
                     const std::string& name_prefix = "",
                     bool measure_read_barrier_slow_path = false);
   ~ConcurrentCopying();
@@ -83,7 +86,7 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
@@ -161,8 +164,31 @@ class ConcurrentCopying : public GarbageCollector {
   void VerifyGrayImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  void GrayDirtyOldObjects()
+      REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  void ClearNonImmuneCards() REQUIRES(Locks::mutator_lock_);
+  void FillDeadObjectsInUnevacFromSpace() SHARED_REQUIRES(Locks::mutator_lock_);
   size_t ProcessThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Process the revoked mark stacks and the GC mark stack with the heap thread pool.
+  size_t ProcessMarkStacksParallel(size_t thread_count)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Drain the mark stack of the calling thread, which is the GC mark stack for the GC-running
+  // thread and the thread-local mark stack otherwise.
+  size_t ProcessLocalMarkStack(Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Move the contents of the GC mark stack onto the revoked mark stacks for other threads to take.
+  void ShareGcMarkStack(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  accounting::ObjectStack* PopRevokedMarkStack(Thread* self) REQUIRES(!mark_stack_lock_);
+  bool HasRevokedMarkStacks(Thread* self) REQUIRES(!mark_stack_lock_);
+  accounting::ObjectStack* AllocateMarkStackLocked() REQUIRES(mark_stack_lock_);
+  void RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack)
+      REQUIRES(!mark_stack_lock_);
+  size_t GetThreadCount() const;
+  // Returns true for the GC-running thread and the threads helping it process mark stacks.
+  bool IsGcThread(Thread* self) const;
   void RevokeThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void SwitchToSharedMarkStackMode() SHARED_REQUIRES(Locks::mutator_lock_)
@@ -243,6 +269,12 @@ class ConcurrentCopying : public GarbageCollector {
   static constexpr size_t kMarkStackPoolSize = 256;
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
+  // The threads running a ProcessMarkStackTask, indexed by task. Only a thread looks up itself.
+  static constexpr size_t kMaxParallelMarkThreads = 32;
+  Atomic<Thread*> parallel_mark_threads_[kMaxParallelMarkThreads];
+  // Used to detect when the parallel mark stack tasks have run out of work.
+  Atomic<size_t> num_started_mark_tasks_;
+  Atomic<size_t> num_idle_mark_tasks_;
   Thread* thread_running_gc_;
   bool is_marking_;                       // True while marking is ongoing.
   bool is_active_;                        // True while the collection is ongoing.
@@ -295,6 +327,8 @@ class ConcurrentCopying : public GarbageCollector {
 
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
+  // True if this collector only collects the regions allocated since the previous GC.
+  const bool young_gen_;
   Atomic<bool> updated_all_immune_objects_;
   bool gc_grays_immune_objects_;
   Mutex immune_gray_stack_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -310,6 +344,7 @@ class ConcurrentCopying : public GarbageCollector {
   class GrayImmuneObjectVisitor;
   class ImmuneSpaceScanObjVisitor;
   class LostCopyVisitor;
+  class ProcessMarkStackTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class ScopedGcGraysImmuneObjects;
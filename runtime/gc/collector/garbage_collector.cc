@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <utility>
 
 #include "garbage_collector.h"
 
@@ -25,6 +26,8 @@
 #include "base/systrace.h"
 #include "base/time_utils.h"
 #include "gc/accounting/heap_bitmap.h"
+#include "gc/gc_event_log.h"
+#include "gc/heap.h"
 #include "gc/space/large_object_space.h"
 #include "gc/space/space-inl.h"
 #include "thread-inl.h"
@@ -43,6 +46,7 @@ Iteration::Iteration()
 void Iteration::Reset(GcCause gc_cause, bool clear_soft_references) {
   timings_.Reset();
   pause_times_.clear();
+  pause_end_times_.clear();
   duration_ns_ = 0;
   clear_soft_references_ = clear_soft_references;
   gc_cause_ = gc_cause;
@@ -65,23 +69,46 @@ GarbageCollector::GarbageCollector(Heap* heap, const std::string& name)
   ResetCumulativeStatistics();
 }
 
-void GarbageCollector::RegisterPause(uint64_t nano_length) {
+void GarbageCollector::RegisterPause(uint64_t nano_length, uint64_t end_time) {
   GetCurrentIteration()->pause_times_.push_back(nano_length);
+  GetCurrentIteration()->pause_end_times_.push_back(end_time);
 }
 
 void GarbageCollector::ResetCumulativeStatistics() {
   cumulative_timings_.Reset();
   total_time_ns_ = 0;
+  total_cpu_time_ns_ = 0;
   total_freed_objects_ = 0;
   total_freed_bytes_ = 0;
   MutexLock mu(Thread::Current(), pause_histogram_lock_);
   pause_histogram_.Reset();
 }
 
+// Append the outermost timings of logger and their durations to phase_times.
+static void AddPhaseTimes(const TimingLogger& logger,
+                          std::vector<std::pair<std::string, uint64_t>>* phase_times) {
+  size_t depth = 0;
+  const char* phase_name = nullptr;
+  uint64_t phase_start = 0;
+  for (const TimingLogger::Timing& timing : logger.GetTimings()) {
+    if (timing.IsStartTiming()) {
+      if (depth++ == 0) {
+        phase_name = timing.GetName();
+        phase_start = timing.GetTime();
+      }
+    } else if (depth != 0 && --depth == 0) {
+      phase_times->emplace_back(phase_name, timing.GetTime() - phase_start);
+    }
+  }
+}
+
 void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
   ScopedTrace trace(StringPrintf("%s %s GC", PrettyCause(gc_cause), GetName()));
   Thread* self = Thread::Current();
   uint64_t start_time = NanoTime();
+  uint64_t start_cpu_time = ThreadCpuNanoTime();
+  const size_t bytes_allocated_before = heap_->GetBytesAllocated();
+  const size_t total_memory_before = heap_->GetTotalMemory();
   Iteration* current_iteration = GetCurrentIteration();
   current_iteration->Reset(gc_cause, clear_soft_references);
   RunPhases();  // Run all the GC phases.
@@ -98,9 +125,31 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
     // The entire GC was paused, clear the fake pauses which might be in the pause times and add
     // the whole GC duration.
     current_iteration->pause_times_.clear();
-    RegisterPause(current_iteration->GetDurationNs());
+    current_iteration->pause_end_times_.clear();
+    RegisterPause(current_iteration->GetDurationNs(), end_time);
   }
   total_time_ns_ += current_iteration->GetDurationNs();
+  const uint64_t cpu_time = ThreadCpuNanoTime() - start_cpu_time;
+  total_cpu_time_ns_ += cpu_time;
+  GcEvent event;
+  event.start_ns = start_time;
+  event.end_ns = end_time;
+  event.cpu_ns = cpu_time;
+  event.cause = gc_cause;
+  event.collector_type = GetCollectorType();
+  event.gc_type = GetGcType();
+  event.pause_times = current_iteration->GetPauseTimes();
+  event.pause_end_times = current_iteration->GetPauseEndTimes();
+  event.freed_objects =
+      current_iteration->GetFreedObjects() + current_iteration->GetFreedLargeObjects();
+  event.freed_bytes =
+      current_iteration->GetFreedBytes() + current_iteration->GetFreedLargeObjectBytes();
+  event.bytes_allocated_before = bytes_allocated_before;
+  event.bytes_allocated_after = heap_->GetBytesAllocated();
+  event.total_memory_before = total_memory_before;
+  event.total_memory_after = heap_->GetTotalMemory();
+  AddPhaseTimes(*GetTimings(), &event.phase_times);
+  heap_->GetGcEventLog()->AddEvent(std::move(event));
   for (uint64_t pause_time : current_iteration->GetPauseTimes()) {
     MutexLock mu(self, pause_histogram_lock_);
     pause_histogram_.AdjustAndAddValue(pause_time);
@@ -150,13 +199,15 @@ void GarbageCollector::ResetMeasurements() {
   }
   cumulative_timings_.Reset();
   total_time_ns_ = 0;
+  total_cpu_time_ns_ = 0;
   total_freed_objects_ = 0;
   total_freed_bytes_ = 0;
 }
 
 GarbageCollector::ScopedPause::ScopedPause(GarbageCollector* collector)
     : start_time_(NanoTime()), collector_(collector) {
-  Runtime::Current()->GetThreadList()->SuspendAll(__FUNCTION__);
+  // Named after the collector, so that the suspend latencies are attributed to it.
+  Runtime::Current()->GetThreadList()->SuspendAll(collector->GetName().c_str());
 }
 
 GarbageCollector::ScopedPause::~ScopedPause() {
@@ -203,10 +254,17 @@ void GarbageCollector::DumpPerformanceInfo(std::ostream& os) {
       Histogram<uint64_t>::CumulativeData cumulative_data;
       pause_histogram_.CreateHistogram(&cumulative_data);
       pause_histogram_.PrintConfidenceIntervals(os, 0.99, cumulative_data);
+      // Interpolated within the histogram buckets, see GcEventLog for exact recent ones.
+      os << GetName() << " pause percentiles: p50 "
+         << PrettyDuration(pause_histogram_.AdjustedPercentile(0.5, cumulative_data))
+         << " p99 " << PrettyDuration(pause_histogram_.AdjustedPercentile(0.99, cumulative_data))
+         << " p99.9 "
+         << PrettyDuration(pause_histogram_.AdjustedPercentile(0.999, cumulative_data)) << "\n";
     }
   }
   os << GetName() << " total time: " << PrettyDuration(total_ns)
      << " mean time: " << PrettyDuration(total_ns / iterations) << "\n"
+     << GetName() << " CPU time: " << PrettyDuration(total_cpu_time_ns_) << "\n"
      << GetName() << " freed: " << freed_objects
      << " objects with total size " << PrettySize(freed_bytes) << "\n"
      << GetName() << " throughput: " << freed_objects / seconds << "/s / "
@@ -22,6 +22,7 @@
 
 #include "base/histogram.h"
 #include "base/mutex.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "gc/collector_type.h"
 #include "gc/gc_cause.h"
@@ -66,6 +67,10 @@ class Iteration {
   const std::vector<uint64_t>& GetPauseTimes() const {
     return pause_times_;
   }
+  // Returns when the pauses ended, in the NanoTime() time base.
+  const std::vector<uint64_t>& GetPauseEndTimes() const {
+    return pause_end_times_;
+  }
   TimingLogger* GetTimings() {
     return &timings_;
   }
@@ -117,6 +122,7 @@ class Iteration {
   ObjectBytePair freed_los_;
   uint64_t freed_bytes_revoke_;  // see Heap::num_bytes_freed_revoke_.
   std::vector<uint64_t> pause_times_;
+  std::vector<uint64_t> pause_end_times_;
 
   friend class GarbageCollector;
   DISALLOW_COPY_AND_ASSIGN(Iteration);
@@ -146,7 +152,7 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   Heap* GetHeap() const {
     return heap_;
   }
-  void RegisterPause(uint64_t nano_length);
+  void RegisterPause(uint64_t nano_length, uint64_t end_time = NanoTime());
   const CumulativeLogger& GetCumulativeTimings() const {
     return cumulative_timings_;
   }
@@ -213,6 +219,8 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   // Cumulative statistics.
   Histogram<uint64_t> pause_histogram_ GUARDED_BY(pause_histogram_lock_);
   uint64_t total_time_ns_;
+  // CPU time of the thread which ran the collections, helper threads are not included.
+  uint64_t total_cpu_time_ns_;
   uint64_t total_freed_objects_;
   int64_t total_freed_bytes_;
   CumulativeLogger cumulative_timings_;
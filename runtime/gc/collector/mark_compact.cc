@@ -19,6 +19,7 @@
 #include "base/logging.h"
 #include "base/mutex-inl.h"
 #include "base/timing_logger.h"
+#include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/mod_union_table.h"
 #include "gc/accounting/space_bitmap-inl.h"
@@ -50,17 +51,39 @@ void MarkCompact::BindBitmaps() {
   }
 }
 
-MarkCompact::MarkCompact(Heap* heap, const std::string& name_prefix)
-    : GarbageCollector(heap, name_prefix + (name_prefix.empty() ? "" : " ") + "mark compact"),
+MarkCompact::MarkCompact(Heap* heap, bool is_concurrent, const std::string& name_prefix)
+    : GarbageCollector(heap,
+                       name_prefix + (name_prefix.empty() ? "" : " ") +
+                       (is_concurrent ? "concurrent mark compact" : "mark compact")),
       space_(nullptr),
       collector_name_(name_),
-      updating_references_(false) {}
+      updating_references_(false),
+      is_concurrent_(is_concurrent),
+      concurrent_mark_boundary_(nullptr) {}
 
 void MarkCompact::RunPhases() {
   Thread* self = Thread::Current();
   InitializePhase();
   CHECK(!Locks::mutator_lock_->IsExclusiveHeld(self));
-  {
+  if (is_concurrent_) {
+    {
+      ScopedPause pause(this);
+      GetHeap()->PreGcVerificationPaused(this);
+      InitialMarkPhase();
+    }
+    {
+      ReaderMutexLock mu(self, *Locks::mutator_lock_);
+      ConcurrentMarkingPhase();
+    }
+    {
+      // Objects can only move while the mutators are suspended since there is no read barrier to
+      // forward their references.
+      ScopedPause pause(this);
+      GetHeap()->PrePauseRosAllocVerification(this);
+      RemarkPhase();
+      ReclaimPhase();
+    }
+  } else {
     ScopedPause pause(this);
     GetHeap()->PreGcVerificationPaused(this);
     GetHeap()->PrePauseRosAllocVerification(this);
@@ -201,6 +224,117 @@ void MarkCompact::MarkingPhase() {
   // heap_->PreSweepingGcVerification(this);
 }
 
+void MarkCompact::InitialMarkPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  Thread* self = Thread::Current();
+  CHECK(Locks::mutator_lock_->IsExclusiveHeld(self));
+  // The bitmaps cover the whole capacity since the space grows while we are marking.
+  objects_before_forwarding_.reset(accounting::ContinuousSpaceBitmap::Create(
+      "objects before forwarding", space_->Begin(), space_->Capacity()));
+  objects_with_lockword_.reset(accounting::ContinuousSpaceBitmap::Create(
+      "objects with lock words", space_->Begin(), space_->Capacity()));
+  BindBitmaps();
+  t.NewTiming("ProcessCards");
+  heap_->ProcessCards(GetTimings(), false, false, true);
+  // Cards dirtied from now on are rescanned in the remark pause.
+  t.NewTiming("ClearCardTable");
+  heap_->GetCardTable()->ClearCardTable();
+  if (kUseThreadLocalAllocationStack) {
+    t.NewTiming("RevokeAllThreadLocalAllocationStacks");
+    heap_->RevokeAllThreadLocalAllocationStacks(self);
+  }
+  t.NewTiming("SwapStacks");
+  heap_->SwapStacks();
+  // Revoke the TLABs so that everything the mutators allocate from now on is above the boundary.
+  RevokeAllThreadLocalBuffers();
+  concurrent_mark_boundary_ = space_->End();
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  MarkRoots();
+  UpdateAndMarkModUnion();
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  {
+    TimingLogger::ScopedTiming t2("MarkAllocStackAsLive", GetTimings());
+    heap_->MarkAllocStackAsLive(live_stack);
+  }
+  live_stack->Reset();
+}
+
+void MarkCompact::ConcurrentMarkingPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  ProcessMarkStack();
+}
+
+void MarkCompact::RemarkPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  Thread* self = Thread::Current();
+  CHECK(Locks::mutator_lock_->IsExclusiveHeld(self));
+  if (kUseThreadLocalAllocationStack) {
+    t.NewTiming("RevokeAllThreadLocalAllocationStacks");
+    heap_->RevokeAllThreadLocalAllocationStacks(self);
+  }
+  t.NewTiming("SwapStacks");
+  heap_->SwapStacks();
+  RevokeAllThreadLocalBuffers();
+  {
+    WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    MarkAllocatedDuringMarking();
+    MarkRoots();
+    // Scan before ProcessCards since it clears the cards of the non immune spaces.
+    ScanDirtyCards();
+    t.NewTiming("ProcessCards");
+    heap_->ProcessCards(GetTimings(), false, false, true);
+    UpdateAndMarkModUnion();
+    ProcessMarkStack();
+  }
+  ProcessReferences(self);
+  {
+    ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    SweepSystemWeaks();
+  }
+  Runtime::Current()->GetClassLinker()->CleanupClassLoaders();
+}
+
+void MarkCompact::MarkAllocatedDuringMarking() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  // Bump pointer allocations don't go on the allocation stack, everything above the boundary is
+  // new.
+  DCHECK(concurrent_mark_boundary_ != nullptr);
+  space_->VisitObjectsFrom(concurrent_mark_boundary_, [this](mirror::Object* obj)
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (!objects_before_forwarding_->Set(obj)) {
+      MarkStackPush(obj);
+    }
+  });
+  // Objects allocated in the other spaces are on the live stack after the swap.
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  for (auto* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+    MarkObject(it->AsMirrorPtr());
+  }
+  heap_->MarkAllocStackAsLive(live_stack);
+  live_stack->Reset();
+}
+
+void MarkCompact::ScanDirtyCards() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  auto visitor = [this](mirror::Object* obj)
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_) {
+    ScanObject(obj);
+  };
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    // The immune spaces are handled by their mod-union tables.
+    if (immune_spaces_.ContainsSpace(space)) {
+      continue;
+    }
+    accounting::ContinuousSpaceBitmap* bitmap =
+        space == space_ ? objects_before_forwarding_.get() : space->GetMarkBitmap();
+    if (bitmap != nullptr) {
+      card_table->Scan<false>(bitmap, space->Begin(), space->End(), visitor);
+    }
+  }
+}
+
 void MarkCompact::UpdateAndMarkModUnion() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   for (auto& space : heap_->GetContinuousSpaces()) {
@@ -552,7 +686,7 @@ class MarkCompact::MarkObjectVisitor {
   explicit MarkObjectVisitor(MarkCompact* collector) : collector_(collector) {}
 
   void operator()(mirror::Object* obj, MemberOffset offset, bool /*is_static*/) const ALWAYS_INLINE
-      REQUIRES(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_) {
     // Object was already verified when we scanned it.
     collector_->MarkObject(obj->GetFieldObject<mirror::Object, kVerifyNone>(offset));
   }
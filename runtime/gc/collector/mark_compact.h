@@ -59,13 +59,23 @@ namespace collector {
 
 class MarkCompact : public GarbageCollector {
  public:
-  explicit MarkCompact(Heap* heap, const std::string& name_prefix = "");
+  // If is_concurrent is true, marking runs concurrently with the mutators between an initial mark
+  // pause and a remark pause. Forwarding and moving objects always happens in the remark pause.
+  explicit MarkCompact(Heap* heap, bool is_concurrent = false,
+                       const std::string& name_prefix = "");
   ~MarkCompact() {}
 
   virtual void RunPhases() OVERRIDE NO_THREAD_SAFETY_ANALYSIS;
   void InitializePhase();
   void MarkingPhase() REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
+  // Concurrent mode phases. The initial mark and remark are paused, concurrent marking is not.
+  void InitialMarkPhase() REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::heap_bitmap_lock_);
+  void ConcurrentMarkingPhase() SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::heap_bitmap_lock_);
+  void RemarkPhase() REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::heap_bitmap_lock_);
   void ReclaimPhase() REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   void FinishPhase() REQUIRES(Locks::mutator_lock_);
@@ -88,7 +98,7 @@ class MarkCompact : public GarbageCollector {
   void FindDefaultMarkBitmap();
 
   void ScanObject(mirror::Object* obj)
-      REQUIRES(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Marks the root set at the start of a garbage collection.
   void MarkRoots()
@@ -153,6 +163,14 @@ class MarkCompact : public GarbageCollector {
 
   // Recursively blackens objects on the mark stack.
   void ProcessMarkStack()
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Mark the objects the mutators allocated since the initial mark pause.
+  void MarkAllocatedDuringMarking()
+      REQUIRES(Locks::mutator_lock_, Locks::heap_bitmap_lock_);
+
+  // Rescan the marked objects on cards the mutators dirtied during concurrent marking.
+  void ScanDirtyCards()
       REQUIRES(Locks::mutator_lock_, Locks::heap_bitmap_lock_);
 
   // 3 pass mark compact approach.
@@ -169,9 +187,9 @@ class MarkCompact : public GarbageCollector {
   void MoveObject(mirror::Object* obj, size_t len) REQUIRES(Locks::mutator_lock_);
   // Mark a single object.
   virtual mirror::Object* MarkObject(mirror::Object* obj) OVERRIDE
-      REQUIRES(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
   virtual void MarkHeapReference(mirror::HeapReference<mirror::Object>* obj_ptr) OVERRIDE
-      REQUIRES(Locks::heap_bitmap_lock_, Locks::mutator_lock_);
+      REQUIRES(Locks::heap_bitmap_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
   virtual mirror::Object* IsMarked(mirror::Object* obj) OVERRIDE
       SHARED_REQUIRES(Locks::heap_bitmap_lock_)
       REQUIRES(Locks::mutator_lock_);
@@ -221,6 +239,13 @@ class MarkCompact : public GarbageCollector {
   // State whether or not we are updating references.
   bool updating_references_;
 
+  // Whether marking runs concurrently with the mutators.
+  const bool is_concurrent_;
+
+  // End of the bump pointer space at the initial mark pause. Objects at or above it were
+  // allocated during concurrent marking.
+  uint8_t* concurrent_mark_boundary_;
+
  private:
   class MarkObjectVisitor;
   class UpdateObjectReferencesVisitor;
@@ -27,6 +27,7 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/mutex-inl.h"
+#include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
 #include "base/timing_logger.h"
@@ -34,6 +35,7 @@
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/mod_union_table.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/accounting/work_stealing_deque.h"
 #include "gc/heap.h"
 #include "gc/reference_processor.h"
 #include "gc/space/large_object_space.h"
@@ -64,6 +66,10 @@ static constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 static constexpr size_t kMinimumParallelMarkStackSize = 128;
 static constexpr bool kParallelProcessMarkStack = true;
+// Capacity of the per thread work-stealing deques used by ProcessMarkStackParallel.
+static constexpr size_t kWorkStealingDequeSize = 4 * KB;
+// The initial mark stack is handed out in segments of this many objects.
+static constexpr size_t kMarkStackSegmentSize = 1 * KB;
 
 // Profiling and information flags.
 static constexpr bool kProfileLargeObjects = false;
@@ -100,7 +106,10 @@ MarkSweep::MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_pre
       gc_barrier_(new Barrier(0)),
       mark_stack_lock_("mark sweep mark stack lock", kMarkSweepMarkStackLock),
       is_concurrent_(is_concurrent),
-      live_stack_freeze_size_(0) {
+      live_stack_freeze_size_(0),
+      num_started_mark_tasks_(0),
+      num_idle_mark_tasks_(0),
+      work_stealing_stats_lock_("mark sweep work stealing stats lock") {
   std::string error_msg;
   MemMap* mem_map = MemMap::MapAnonymous(
       "mark sweep sweep array free buffer", nullptr,
@@ -110,6 +119,10 @@ MarkSweep::MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_pre
   sweep_array_free_buffer_mem_map_.reset(mem_map);
 }
 
+MarkSweep::~MarkSweep() {
+  STLDeleteElements(&work_stealing_deques_);
+}
+
 void MarkSweep::InitializePhase() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   mark_stack_ = heap_->GetMarkStack();
@@ -1061,7 +1074,15 @@ void MarkSweep::ReMarkRoots() {
 void MarkSweep::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(this);
+  // The mutators that create system weaks wait until the sweeping is done, so sweep the tables in
+  // parallel. IsMarked() only reads the mark bitmaps.
+  size_t thread_count = GetThreadCount(false);
+  ThreadPool* thread_pool = nullptr;
+  if (thread_count > 1) {
+    thread_pool = GetHeap()->GetThreadPool();
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  }
+  Runtime::Current()->SweepSystemWeaks(this, thread_pool);
 }
 
 class MarkSweep::VerifySystemWeakVisitor : public IsMarkedVisitor {
@@ -1350,23 +1371,260 @@ void MarkSweep::ScanObject(mirror::Object* obj) {
   ScanObjectVisit(obj, mark_visitor, ref_visitor);
 }
 
+// Each task owns a work-stealing deque. It pushes the objects it marks onto the bottom and pops
+// from there, so that it scans depth first and keeps its working set small. When its deque is
+// empty it takes a shared mark stack segment, then tries to steal the oldest object of every other
+// deque, and finally goes idle until there is work again or all the other tasks are idle too.
+class MarkSweep::WorkStealingMarkTask : public Task {
+ public:
+  WorkStealingMarkTask(MarkSweep* mark_sweep, size_t index, size_t thread_count)
+      : mark_sweep_(mark_sweep),
+        index_(index),
+        thread_count_(thread_count),
+        deque_(mark_sweep->work_stealing_deques_[index]),
+        self_(nullptr) {}
+
+  // No thread safety analysis since multiple threads run the tasks on behalf of the GC thread.
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    self_ = self;
+    mark_sweep_->num_started_mark_tasks_.FetchAndAddSequentiallyConsistent(1);
+    MarkObjectVisitor mark_visitor(this);
+    DelayReferenceReferentVisitor ref_visitor(mark_sweep_);
+    while (true) {
+      mirror::Object* obj = deque_->PopBottom();
+      if (obj == nullptr) {
+        obj = FindWork();
+        if (obj == nullptr) {
+          break;
+        }
+      }
+      mark_sweep_->ScanObjectVisit(obj, mark_visitor, ref_visitor);
+      ++stats_.objects_scanned;
+    }
+    DCHECK(deque_->IsEmpty());
+    mark_sweep_->RecordWorkStealingStats(self, index_, stats_);
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  class MarkObjectVisitor {
+   public:
+    explicit MarkObjectVisitor(WorkStealingMarkTask* task) : task_(task) {}
+
+    ALWAYS_INLINE void operator()(mirror::Object* obj,
+                                  MemberOffset offset,
+                                  bool is_static ATTRIBUTE_UNUSED) const
+        SHARED_REQUIRES(Locks::mutator_lock_) {
+      Mark(obj->GetFieldObject<mirror::Object>(offset));
+    }
+
+    void VisitRootIfNonNull(mirror::CompressedReference<mirror::Object>* root) const
+        SHARED_REQUIRES(Locks::mutator_lock_) {
+      if (!root->IsNull()) {
+        VisitRoot(root);
+      }
+    }
+
+    void VisitRoot(mirror::CompressedReference<mirror::Object>* root) const
+        SHARED_REQUIRES(Locks::mutator_lock_) {
+      Mark(root->AsMirrorPtr());
+    }
+
+   private:
+    ALWAYS_INLINE void Mark(mirror::Object* ref) const NO_THREAD_SAFETY_ANALYSIS {
+      if (ref != nullptr && task_->mark_sweep_->MarkObjectParallel(ref)) {
+        task_->Push(ref);
+      }
+    }
+
+    WorkStealingMarkTask* const task_;
+  };
+
+  ALWAYS_INLINE void Push(mirror::Object* obj) NO_THREAD_SAFETY_ANALYSIS {
+    if (UNLIKELY(!deque_->PushBottom(obj))) {
+      // The deque is full, hand its older half to the other tasks as a segment.
+      std::vector<mirror::Object*> segment;
+      const size_t segment_size = deque_->Capacity() / 2;
+      segment.reserve(segment_size);
+      while (segment.size() < segment_size && !deque_->IsEmpty()) {
+        mirror::Object* oldest = deque_->Steal();
+        if (oldest != nullptr) {
+          segment.push_back(oldest);
+        }
+      }
+      if (!segment.empty()) {
+        mark_sweep_->PushMarkStackSegment(self_, &segment);
+        ++stats_.segments_spilled;
+      }
+      bool success = deque_->PushBottom(obj);
+      CHECK(success);
+    }
+  }
+
+  mirror::Object* FindWork() NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<mirror::Object*> segment;
+    while (true) {
+      if (mark_sweep_->PopMarkStackSegment(self_, &segment)) {
+        ++stats_.segments_taken;
+        DCHECK(!segment.empty());
+        DCHECK_LE(segment.size(), deque_->Capacity());
+        mirror::Object* obj = segment.back();
+        segment.pop_back();
+        for (mirror::Object* ref : segment) {
+          bool success = deque_->PushBottom(ref);
+          CHECK(success);
+        }
+        segment.clear();
+        return obj;
+      }
+      const uint64_t steal_start = NanoTime();
+      for (size_t i = 1; i < thread_count_; ++i) {
+        accounting::WorkStealingDeque<mirror::Object>* victim =
+            mark_sweep_->work_stealing_deques_[(index_ + i) % thread_count_];
+        ++stats_.steal_attempts;
+        mirror::Object* obj = victim->Steal();
+        if (obj != nullptr) {
+          ++stats_.steals;
+          stats_.steal_ns += NanoTime() - steal_start;
+          return obj;
+        }
+      }
+      stats_.steal_ns += NanoTime() - steal_start;
+      // Out of work. Wait until there is work to steal, or until every started task has run out
+      // of work too, in which case the marking is done.
+      const uint64_t idle_start = NanoTime();
+      mark_sweep_->num_idle_mark_tasks_.FetchAndAddSequentiallyConsistent(1);
+      bool found_work = false;
+      while (mark_sweep_->num_idle_mark_tasks_.LoadSequentiallyConsistent() <
+             mark_sweep_->num_started_mark_tasks_.LoadSequentiallyConsistent()) {
+        if (HasWork()) {
+          found_work = true;
+          break;
+        }
+        sched_yield();
+      }
+      stats_.idle_ns += NanoTime() - idle_start;
+      if (!found_work) {
+        return nullptr;
+      }
+      mark_sweep_->num_idle_mark_tasks_.FetchAndSubSequentiallyConsistent(1);
+    }
+  }
+
+  bool HasWork() NO_THREAD_SAFETY_ANALYSIS {
+    for (size_t i = 0; i < thread_count_; ++i) {
+      if (!mark_sweep_->work_stealing_deques_[i]->IsEmpty()) {
+        return true;
+      }
+    }
+    return mark_sweep_->HasMarkStackSegments(self_);
+  }
+
+  MarkSweep* const mark_sweep_;
+  const size_t index_;
+  const size_t thread_count_;
+  accounting::WorkStealingDeque<mirror::Object>* const deque_;
+  Thread* self_;
+  WorkStealingStats stats_;
+};
+
+void MarkSweep::PushMarkStackSegment(Thread* self, std::vector<mirror::Object*>* segment) {
+  MutexLock mu(self, mark_stack_lock_);
+  mark_stack_segments_.push_back(std::vector<mirror::Object*>());
+  mark_stack_segments_.back().swap(*segment);
+}
+
+bool MarkSweep::PopMarkStackSegment(Thread* self, std::vector<mirror::Object*>* segment) {
+  MutexLock mu(self, mark_stack_lock_);
+  if (mark_stack_segments_.empty()) {
+    return false;
+  }
+  segment->swap(mark_stack_segments_.back());
+  mark_stack_segments_.pop_back();
+  return true;
+}
+
+bool MarkSweep::HasMarkStackSegments(Thread* self) {
+  MutexLock mu(self, mark_stack_lock_);
+  return !mark_stack_segments_.empty();
+}
+
+void MarkSweep::RecordWorkStealingStats(Thread* self,
+                                        size_t index,
+                                        const WorkStealingStats& stats) {
+  MutexLock mu(self, work_stealing_stats_lock_);
+  if (work_stealing_stats_.size() <= index) {
+    work_stealing_stats_.resize(index + 1);
+  }
+  WorkStealingStats* total = &work_stealing_stats_[index];
+  total->objects_scanned += stats.objects_scanned;
+  total->segments_taken += stats.segments_taken;
+  total->segments_spilled += stats.segments_spilled;
+  total->steal_attempts += stats.steal_attempts;
+  total->steals += stats.steals;
+  total->steal_ns += stats.steal_ns;
+  total->idle_ns += stats.idle_ns;
+}
+
+void MarkSweep::DumpPerformanceInfo(std::ostream& os) {
+  GarbageCollector::DumpPerformanceInfo(os);
+  MutexLock mu(Thread::Current(), work_stealing_stats_lock_);
+  for (size_t i = 0; i < work_stealing_stats_.size(); ++i) {
+    const WorkStealingStats& stats = work_stealing_stats_[i];
+    if (stats.objects_scanned == 0 && stats.steal_attempts == 0) {
+      continue;
+    }
+    os << GetName() << " mark thread " << i << ": scanned " << stats.objects_scanned
+       << " objects, segments taken " << stats.segments_taken
+       << " spilled " << stats.segments_spilled
+       << ", steals " << stats.steals << "/" << stats.steal_attempts
+       << " in " << PrettyDuration(stats.steal_ns)
+       << ", idle " << PrettyDuration(stats.idle_ns) << "\n";
+  }
+}
+
 void MarkSweep::ProcessMarkStackParallel(size_t thread_count) {
   Thread* self = Thread::Current();
   ThreadPool* thread_pool = GetHeap()->GetThreadPool();
-  const size_t chunk_size = std::min(mark_stack_->Size() / thread_count + 1,
-                                     static_cast<size_t>(MarkStackTask<false>::kMaxSize));
-  CHECK_GT(chunk_size, 0U);
-  // Split the current mark stack up into work tasks.
-  for (auto* it = mark_stack_->Begin(), *end = mark_stack_->End(); it < end; ) {
-    const size_t delta = std::min(static_cast<size_t>(end - it), chunk_size);
-    thread_pool->AddTask(self, new MarkStackTask<false>(thread_pool, this, delta, it));
-    it += delta;
+  while (work_stealing_deques_.size() < thread_count) {
+    work_stealing_deques_.push_back(
+        new accounting::WorkStealingDeque<mirror::Object>(kWorkStealingDequeSize));
+  }
+  // Split the current mark stack up into segments for the tasks to take.
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    DCHECK(mark_stack_segments_.empty());
+    for (auto* it = mark_stack_->Begin(), *end = mark_stack_->End(); it < end; ) {
+      const size_t delta = std::min(static_cast<size_t>(end - it), kMarkStackSegmentSize);
+      mark_stack_segments_.emplace_back();
+      std::vector<mirror::Object*>& segment = mark_stack_segments_.back();
+      segment.reserve(delta);
+      for (auto* ref = it; ref < it + delta; ++ref) {
+        segment.push_back(ref->AsMirrorPtr());
+      }
+      it += delta;
+    }
+  }
+  mark_stack_->Reset();
+  num_started_mark_tasks_.StoreRelaxed(0);
+  num_idle_mark_tasks_.StoreRelaxed(0);
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new WorkStealingMarkTask(this, i, thread_count));
   }
   thread_pool->SetMaxActiveWorkers(thread_count - 1);
   thread_pool->StartWorkers(self);
   thread_pool->Wait(self, true, true);
   thread_pool->StopWorkers(self);
-  mark_stack_->Reset();
+  if (kIsDebugBuild) {
+    MutexLock mu(self, mark_stack_lock_);
+    CHECK(mark_stack_segments_.empty());
+    for (size_t i = 0; i < thread_count; ++i) {
+      CHECK(work_stealing_deques_[i]->IsEmpty());
+    }
+  }
   CHECK_EQ(work_chunks_created_.LoadSequentiallyConsistent(),
            work_chunks_deleted_.LoadSequentiallyConsistent())
       << " some of the work chunks were leaked";
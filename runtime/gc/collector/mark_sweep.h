@@ -18,6 +18,7 @@
 #define ART_RUNTIME_GC_COLLECTOR_MARK_SWEEP_H_
 
 #include <memory>
+#include <vector>
 
 #include "atomic.h"
 #include "barrier.h"
@@ -48,6 +49,7 @@ class Heap;
 namespace accounting {
 template<typename T> class AtomicStack;
 typedef AtomicStack<mirror::Object> ObjectStack;
+template<typename T> class WorkStealingDeque;
 }  // namespace accounting
 
 namespace collector {
@@ -56,9 +58,10 @@ class MarkSweep : public GarbageCollector {
  public:
   MarkSweep(Heap* heap, bool is_concurrent, const std::string& name_prefix = "");
 
-  ~MarkSweep() {}
+  ~MarkSweep();
 
   virtual void RunPhases() OVERRIDE REQUIRES(!mark_stack_lock_);
+  void DumpPerformanceInfo(std::ostream& os) OVERRIDE REQUIRES(!work_stealing_stats_lock_);
   void InitializePhase();
   void MarkingPhase() REQUIRES(!mark_stack_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
   void PausePhase() REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
@@ -296,6 +299,13 @@ class MarkSweep : public GarbageCollector {
       REQUIRES(!mark_stack_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Mark stack segments are shared by the ProcessMarkStackParallel threads.
+  void PushMarkStackSegment(Thread* self, std::vector<mirror::Object*>* segment)
+      REQUIRES(!mark_stack_lock_);
+  bool PopMarkStackSegment(Thread* self, std::vector<mirror::Object*>* segment)
+      REQUIRES(!mark_stack_lock_);
+  bool HasMarkStackSegments(Thread* self) REQUIRES(!mark_stack_lock_);
+
   // Used to Get around thread safety annotations. The call is from MarkingPhase and is guarded by
   // IsExclusiveHeld.
   void RevokeAllThreadLocalAllocationStacks(Thread* self) NO_THREAD_SAFETY_ANALYSIS;
@@ -352,6 +362,31 @@ class MarkSweep : public GarbageCollector {
 
   std::unique_ptr<MemMap> sweep_array_free_buffer_mem_map_;
 
+  // Work-stealing deques of ProcessMarkStackParallel, one per thread. Only the GC thread resizes
+  // the vector, while no tasks are running.
+  std::vector<accounting::WorkStealingDeque<mirror::Object>*> work_stealing_deques_;
+  // Mark stack chunks that any ProcessMarkStackParallel thread may take, either from the initial
+  // mark stack or spilled from a full deque.
+  std::vector<std::vector<mirror::Object*>> mark_stack_segments_ GUARDED_BY(mark_stack_lock_);
+  // Used to detect when the ProcessMarkStackParallel tasks have run out of work.
+  Atomic<size_t> num_started_mark_tasks_;
+  Atomic<size_t> num_idle_mark_tasks_;
+
+  // Per thread ProcessMarkStackParallel counters, accumulated over all GCs.
+  struct WorkStealingStats {
+    uint64_t objects_scanned = 0;
+    uint64_t segments_taken = 0;
+    uint64_t segments_spilled = 0;
+    uint64_t steal_attempts = 0;
+    uint64_t steals = 0;
+    uint64_t steal_ns = 0;
+    uint64_t idle_ns = 0;
+  };
+  void RecordWorkStealingStats(Thread* self, size_t index, const WorkStealingStats& stats)
+      REQUIRES(!work_stealing_stats_lock_);
+  Mutex work_stealing_stats_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::vector<WorkStealingStats> work_stealing_stats_ GUARDED_BY(work_stealing_stats_lock_);
+
  private:
   class CardScanTask;
   class CheckpointMarkThreadRoots;
@@ -364,6 +399,7 @@ class MarkSweep : public GarbageCollector {
   class VerifyRootMarkedVisitor;
   class VerifyRootVisitor;
   class VerifySystemWeakVisitor;
+  class WorkStealingMarkTask;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkSweep);
 };
@@ -16,6 +16,7 @@
 
 #include "semi_space-inl.h"
 
+#include <algorithm>
 #include <climits>
 #include <functional>
 #include <numeric>
@@ -47,6 +48,7 @@
 #include "runtime.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 using ::art::mirror::Object;
 
@@ -58,6 +60,12 @@ static constexpr bool kProtectFromSpace = true;
 static constexpr bool kStoreStackTraces = false;
 static constexpr size_t kBytesPromotedThreshold = 4 * MB;
 static constexpr size_t kLargeObjectBytesAllocatedThreshold = 16 * MB;
+// Percentages driving the tenuring threshold of the generational mode: the share of the bytes
+// promoted since the last whole heap collection that died by it, above which the objects are kept
+// longer in the bump pointer space, and the share of the bytes kept in the bump pointer space
+// that survive again, above which they are promoted earlier.
+static constexpr uint64_t kPrematurePromotionPercent = 50;
+static constexpr uint64_t kAgedSurvivalPercent = 75;
 
 void SemiSpace::BindBitmaps() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
@@ -101,6 +109,11 @@ SemiSpace::SemiSpace(Heap* heap, bool generational, const std::string& name_pref
       last_gc_to_space_end_(nullptr),
       bytes_promoted_(0),
       bytes_promoted_since_last_whole_heap_collection_(0),
+      tenuring_threshold_(1),
+      from_space_ages_(nullptr),
+      to_space_ages_(nullptr),
+      aged_bytes_survived_(0),
+      promo_dest_space_bytes_freed_(0),
       large_object_bytes_allocated_at_last_whole_heap_collection_(0),
       collect_from_space_only_(generational),
       promo_dest_space_(nullptr),
@@ -220,8 +233,13 @@ void SemiSpace::MarkingPhase() {
     if (!from_space_->HasAddress(reinterpret_cast<mirror::Object*>(last_gc_to_space_end_))) {
       last_gc_to_space_end_ = from_space_->Begin();
     }
-    // Reset this before the marking starts below.
+    // Reset these before the marking starts below.
     bytes_promoted_ = 0;
+    aged_bytes_survived_ = 0;
+    promo_dest_space_bytes_freed_ = 0;
+    from_space_ages_ = GetObjectAgeTable(from_space_);
+    to_space_ages_ = GetObjectAgeTable(to_space_);
+    to_space_ages_->Clear();
   }
   // Assume the cleared space is already empty.
   BindBitmaps();
@@ -431,6 +449,7 @@ void SemiSpace::ReclaimPhase() {
     VLOG(heap) << "Avoided dirtying " << PrettySize(saved_bytes_);
   }
   if (generational_) {
+    AdjustTenuringThreshold();
     // Record the end (top) of the to space so we can distinguish
     // between objects that were allocated since the last GC and the
     // older objects.
@@ -438,6 +457,85 @@ void SemiSpace::ReclaimPhase() {
   }
 }
 
+SemiSpace::ObjectAgeTable::ObjectAgeTable(space::ContinuousMemMapAllocSpace* space) {
+  const std::string name(space->GetName());
+  const size_t capacity = space->Limit() - space->Begin();
+  low_bit_.reset(accounting::ContinuousSpaceBitmap::Create(
+      name + " age low bit", space->Begin(), capacity));
+  high_bit_.reset(accounting::ContinuousSpaceBitmap::Create(
+      name + " age high bit", space->Begin(), capacity));
+  CHECK(low_bit_ != nullptr);
+  CHECK(high_bit_ != nullptr);
+}
+
+bool SemiSpace::ObjectAgeTable::Covers(space::ContinuousMemMapAllocSpace* space) const {
+  return low_bit_->HeapBegin() == reinterpret_cast<uintptr_t>(space->Begin()) &&
+      low_bit_->HeapLimit() >= reinterpret_cast<uintptr_t>(space->Limit());
+}
+
+size_t SemiSpace::ObjectAgeTable::Get(const mirror::Object* obj) const {
+  return (high_bit_->Test(obj) ? 2u : 0u) | (low_bit_->Test(obj) ? 1u : 0u);
+}
+
+void SemiSpace::ObjectAgeTable::Set(const mirror::Object* obj, size_t age) {
+  DCHECK_LE(age, kMaxTenuringThreshold);
+  if ((age & 1u) != 0) {
+    low_bit_->Set(obj);
+  } else {
+    low_bit_->Clear(obj);
+  }
+  if ((age & 2u) != 0) {
+    high_bit_->Set(obj);
+  } else {
+    high_bit_->Clear(obj);
+  }
+}
+
+void SemiSpace::ObjectAgeTable::Clear() {
+  low_bit_->Clear();
+  high_bit_->Clear();
+}
+
+SemiSpace::ObjectAgeTable* SemiSpace::GetObjectAgeTable(space::ContinuousMemMapAllocSpace* space) {
+  for (const std::unique_ptr<ObjectAgeTable>& table : object_age_tables_) {
+    if (table->Covers(space)) {
+      return table.get();
+    }
+  }
+  // The bump pointer spaces are recreated at the zygote fork, drop the tables of the old ones.
+  auto stale = [this](const std::unique_ptr<ObjectAgeTable>& table) {
+    return !table->Covers(from_space_) && !table->Covers(to_space_);
+  };
+  object_age_tables_.erase(
+      std::remove_if(object_age_tables_.begin(), object_age_tables_.end(), stale),
+      object_age_tables_.end());
+  object_age_tables_.emplace_back(new ObjectAgeTable(space));
+  return object_age_tables_.back().get();
+}
+
+void SemiSpace::AdjustTenuringThreshold() {
+  // The objects below last_gc_to_space_end_ are the ones that survived the last collection.
+  const uint64_t aged_bytes = last_gc_to_space_end_ - from_space_->Begin();
+  const size_t old_threshold = tenuring_threshold_;
+  if (!collect_from_space_only_ && bytes_promoted_since_last_whole_heap_collection_ != 0 &&
+      promo_dest_space_bytes_freed_ * 100 >=
+          bytes_promoted_since_last_whole_heap_collection_ * kPrematurePromotionPercent) {
+    // The promoted objects die soon after their promotion, let them age more.
+    if (tenuring_threshold_ < kMaxTenuringThreshold) {
+      ++tenuring_threshold_;
+    }
+  } else if (aged_bytes != 0 && aged_bytes_survived_ * 100 >= aged_bytes * kAgedSurvivalPercent) {
+    // Most of the objects kept in the bump pointer space live on, promote them earlier.
+    if (tenuring_threshold_ > 1) {
+      --tenuring_threshold_;
+    }
+  }
+  if (tenuring_threshold_ != old_threshold) {
+    VLOG(heap) << "Tenuring threshold changed from " << old_threshold << " to "
+               << tenuring_threshold_;
+  }
+}
+
 void SemiSpace::ResizeMarkStack(size_t new_size) {
   std::vector<StackReference<Object>> temp(mark_stack_->Begin(), mark_stack_->End());
   CHECK_LE(mark_stack_->Size(), new_size);
@@ -509,10 +607,16 @@ mirror::Object* SemiSpace::MarkNonForwardedObject(mirror::Object* obj) {
   const size_t object_size = obj->SizeOf();
   size_t bytes_allocated, dummy;
   mirror::Object* forward_address = nullptr;
+  size_t age = 0;
   if (generational_ && reinterpret_cast<uint8_t*>(obj) < last_gc_to_space_end_) {
-    // If it's allocated before the last GC (older), move
-    // (pseudo-promote) it to the main free list space (as sort
-    // of an old generation.)
+    // It survived the last GC. A table recreated since then may not know it, so count it as at
+    // least one collection old.
+    age = std::max<size_t>(from_space_ages_->Get(obj), 1);
+    aged_bytes_survived_ += object_size;
+  }
+  if (generational_ && age >= tenuring_threshold_) {
+    // If it's old enough, move (pseudo-promote) it to the main free
+    // list space (as sort of an old generation.)
     forward_address = promo_dest_space_->AllocThreadUnsafe(self_, object_size, &bytes_allocated,
                                                            nullptr, &dummy);
     if (UNLIKELY(forward_address == nullptr)) {
@@ -562,13 +666,16 @@ mirror::Object* SemiSpace::MarkNonForwardedObject(mirror::Object* obj) {
       }
     }
   } else {
-    // If it's allocated after the last GC (younger), copy it to the to-space.
+    // If it's younger, copy it to the to-space.
     forward_address = to_space_->AllocThreadUnsafe(self_, object_size, &bytes_allocated, nullptr,
                                                    &dummy);
     if (forward_address != nullptr && to_space_live_bitmap_ != nullptr) {
       to_space_live_bitmap_->Set(forward_address);
     }
   }
+  if (generational_ && forward_address != nullptr && to_space_->HasAddress(forward_address)) {
+    to_space_ages_->Set(forward_address, age < kMaxTenuringThreshold ? age + 1 : age);
+  }
   // If it's still null, attempt to use the fallback space.
   if (UNLIKELY(forward_address == nullptr)) {
     forward_address = fallback_space_->AllocThreadUnsafe(self_, object_size, &bytes_allocated,
@@ -639,7 +746,16 @@ void SemiSpace::MarkRoots() {
 
 void SemiSpace::SweepSystemWeaks() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
-  Runtime::Current()->SweepSystemWeaks(this);
+  // This is done in the pause, so sweep the tables in parallel if the GC threads are available.
+  // IsMarked() only reads the forwarding addresses and the mark bitmap.
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  if (thread_pool != nullptr && Runtime::Current()->InJankPerceptibleProcessState() &&
+      GetHeap()->GetParallelGCThreadCount() != 0) {
+    thread_pool->SetMaxActiveWorkers(GetHeap()->GetParallelGCThreadCount());
+  } else {
+    thread_pool = nullptr;
+  }
+  Runtime::Current()->SweepSystemWeaks(this, thread_pool);
 }
 
 bool SemiSpace::ShouldSweepSpace(space::ContinuousSpace* space) const {
@@ -657,7 +773,11 @@ void SemiSpace::Sweep(bool swap_bitmaps) {
       }
       TimingLogger::ScopedTiming split(
           alloc_space->IsZygoteSpace() ? "SweepZygoteSpace" : "SweepAllocSpace", GetTimings());
-      RecordFree(alloc_space->Sweep(swap_bitmaps));
+      ObjectBytePair freed = alloc_space->Sweep(swap_bitmaps);
+      if (generational_ && alloc_space == promo_dest_space_) {
+        promo_dest_space_bytes_freed_ += freed.bytes;
+      }
+      RecordFree(freed);
     }
   }
   if (!is_large_object_space_immune_) {
@@ -18,6 +18,7 @@
 #define ART_RUNTIME_GC_COLLECTOR_SEMI_SPACE_H_
 
 #include <memory>
+#include <vector>
 
 #include "atomic.h"
 #include "base/macros.h"
@@ -199,6 +200,34 @@ class SemiSpace : public GarbageCollector {
   // Revoke all the thread-local buffers.
   void RevokeAllThreadLocalBuffers();
 
+  // Used for the generational mode. The number of collections that the objects of a bump
+  // pointer space survived, saturated at kMaxTenuringThreshold. The lock word has no spare bits,
+  // so the age lives in two side bitmaps holding one bit of it each.
+  class ObjectAgeTable {
+   public:
+    explicit ObjectAgeTable(space::ContinuousMemMapAllocSpace* space);
+
+    // Returns true if the table spans the whole space.
+    bool Covers(space::ContinuousMemMapAllocSpace* space) const;
+    size_t Get(const mirror::Object* obj) const;
+    void Set(const mirror::Object* obj, size_t age);
+    void Clear();
+
+   private:
+    std::unique_ptr<accounting::ContinuousSpaceBitmap> low_bit_;
+    std::unique_ptr<accounting::ContinuousSpaceBitmap> high_bit_;
+
+    DISALLOW_COPY_AND_ASSIGN(ObjectAgeTable);
+  };
+
+  // Returns the age table of the space, creating it if the space has none yet.
+  ObjectAgeTable* GetObjectAgeTable(space::ContinuousMemMapAllocSpace* space);
+
+  // Raises tenuring_threshold_ if many of the recently promoted objects die in the whole heap
+  // collections, and lowers it if most of the objects kept in the bump pointer space survive
+  // again, as copying them over and over is then wasted work.
+  void AdjustTenuringThreshold();
+
   // Current space, we check this space first to avoid searching for the appropriate space for an
   // object.
   accounting::ObjectStack* mark_stack_;
@@ -239,6 +268,26 @@ class SemiSpace : public GarbageCollector {
   // the non-moving space, since the last whole heap collection.
   uint64_t bytes_promoted_since_last_whole_heap_collection_;
 
+  // Used for the generational mode. The age at which the objects of
+  // the bump pointer space get promoted, between 1 (promote after
+  // surviving one collection) and kMaxTenuringThreshold.
+  size_t tenuring_threshold_;
+
+  // Used for the generational mode. The age tables of the bump
+  // pointer spaces, and the ones of the from-space and the to-space.
+  std::vector<std::unique_ptr<ObjectAgeTable>> object_age_tables_;
+  ObjectAgeTable* from_space_ages_;
+  ObjectAgeTable* to_space_ages_;
+
+  // Used for the generational mode. During a collection, keeps track
+  // of how many bytes of the objects that survived the last
+  // collection survive this one too.
+  uint64_t aged_bytes_survived_;
+
+  // Used for the generational mode. How many bytes of objects were
+  // freed in the promo destination space by this collection.
+  uint64_t promo_dest_space_bytes_freed_;
+
   // Used for the generational mode. Keeps track of how many bytes of
   // large objects were allocated at the last whole heap collection.
   uint64_t large_object_bytes_allocated_at_last_whole_heap_collection_;
@@ -268,6 +317,10 @@ class SemiSpace : public GarbageCollector {
   // collections.
   static constexpr int kDefaultWholeHeapCollectionInterval = 5;
 
+  // Used for the generational mode. The largest tenuring threshold,
+  // also the age at which the age tables saturate.
+  static constexpr size_t kMaxTenuringThreshold = 3;
+
   // Whether or not we swap the semi spaces in the heap during the marking phase.
   bool swap_semi_spaces_;
 
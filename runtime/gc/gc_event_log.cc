@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_event_log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/mutex-inl.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+constexpr uint64_t GcEventLog::kMmuWindowsNs[];
+constexpr size_t GcEventLog::kMaxDumpedCpuWindows;
+
+GcEventLog::GcEventLog() : lock_("GC event log lock"), next_id_(1), log_start_ns_(0) {}
+
+void GcEventLog::AddEvent(GcEvent&& event) {
+  DCHECK_EQ(event.pause_end_times.size(), event.pause_times.size());
+  MutexLock mu(Thread::Current(), lock_);
+  if (events_.empty()) {
+    log_start_ns_ = event.start_ns;
+  }
+  event.id = next_id_++;
+  for (size_t i = 0; i < event.pause_times.size(); ++i) {
+    pauses_.push_back(
+        Pause { event.pause_end_times[i] - event.pause_times[i], event.pause_end_times[i] });
+  }
+  events_.push_back(std::move(event));
+  // The logged time only starts after everything that was dropped, so that it is complete.
+  while (events_.size() > kMaxEvents) {
+    log_start_ns_ = std::max(log_start_ns_, events_.front().end_ns);
+    events_.pop_front();
+  }
+  while (!pauses_.empty() && pauses_.front().end_ns <= log_start_ns_) {
+    pauses_.pop_front();
+  }
+  while (pauses_.size() > kMaxPauses) {
+    log_start_ns_ = std::max(log_start_ns_, pauses_.front().end_ns);
+    pauses_.pop_front();
+  }
+}
+
+uint64_t GcEventLog::GetEvents(uint64_t after_id, std::vector<GcEvent>* events) const {
+  MutexLock mu(Thread::Current(), lock_);
+  uint64_t latest_id = after_id;
+  for (const GcEvent& event : events_) {
+    if (event.id > after_id) {
+      events->push_back(event);
+      latest_id = event.id;
+    }
+  }
+  return latest_id;
+}
+
+uint64_t GcEventLog::PausedTimeLocked(uint64_t start_ns, uint64_t end_ns) const {
+  // Find the first pause which ends after start_ns.
+  auto it = std::upper_bound(pauses_.begin(), pauses_.end(), start_ns,
+                             [](uint64_t time, const Pause& pause) {
+                               return time < pause.end_ns;
+                             });
+  uint64_t paused = 0;
+  for (; it != pauses_.end() && it->start_ns < end_ns; ++it) {
+    paused += std::min(end_ns, it->end_ns) - std::max(start_ns, it->start_ns);
+  }
+  return paused;
+}
+
+double GcEventLog::GetMinimumMutatorUtilizationLocked(uint64_t window_ns) const {
+  if (events_.empty() || events_.back().end_ns - log_start_ns_ < window_ns) {
+    return 1.0;
+  }
+  const uint64_t log_end_ns = events_.back().end_ns;
+  // The worst window starts with a pause or ends with one, so only those need to be checked.
+  uint64_t max_paused = 0;
+  for (const Pause& pause : pauses_) {
+    if (pause.end_ns <= log_start_ns_) {
+      continue;
+    }
+    uint64_t starting = std::min(std::max(pause.start_ns, log_start_ns_), log_end_ns - window_ns);
+    uint64_t ending = std::max(pause.end_ns, log_start_ns_ + window_ns);
+    max_paused = std::max(max_paused, PausedTimeLocked(starting, starting + window_ns));
+    max_paused = std::max(max_paused, PausedTimeLocked(ending - window_ns, ending));
+  }
+  return 1.0 - static_cast<double>(max_paused) / window_ns;
+}
+
+double GcEventLog::GetMinimumMutatorUtilization(uint64_t window_ns) const {
+  MutexLock mu(Thread::Current(), lock_);
+  return GetMinimumMutatorUtilizationLocked(window_ns);
+}
+
+std::vector<uint64_t> GcEventLog::SortedPauseTimesLocked() const {
+  std::vector<uint64_t> pause_times;
+  pause_times.reserve(pauses_.size());
+  for (const Pause& pause : pauses_) {
+    pause_times.push_back(pause.end_ns - pause.start_ns);
+  }
+  std::sort(pause_times.begin(), pause_times.end());
+  return pause_times;
+}
+
+// Nearest rank percentile of sorted values.
+static uint64_t Percentile(const std::vector<uint64_t>& sorted, double per) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(std::ceil(per * sorted.size()));
+  return sorted[std::min(std::max(rank, static_cast<size_t>(1)), sorted.size()) - 1];
+}
+
+uint64_t GcEventLog::GetPausePercentile(double per) const {
+  MutexLock mu(Thread::Current(), lock_);
+  return Percentile(SortedPauseTimesLocked(), per);
+}
+
+void GcEventLog::Dump(std::ostream& os) const {
+  MutexLock mu(Thread::Current(), lock_);
+  if (events_.empty()) {
+    return;
+  }
+  const uint64_t log_end_ns = events_.back().end_ns;
+  os << "GC event log: " << pauses_.size() << " pauses and " << events_.size()
+     << " collections over " << PrettyDuration(log_end_ns - log_start_ns_) << "\n";
+  std::vector<uint64_t> pause_times = SortedPauseTimesLocked();
+  if (!pause_times.empty()) {
+    os << "GC pause percentiles: p50 " << PrettyDuration(Percentile(pause_times, 0.5))
+       << " p99 " << PrettyDuration(Percentile(pause_times, 0.99))
+       << " p99.9 " << PrettyDuration(Percentile(pause_times, 0.999))
+       << " max " << PrettyDuration(pause_times.back()) << "\n";
+  }
+  os << "Minimum mutator utilization:";
+  for (uint64_t window_ns : kMmuWindowsNs) {
+    os << " " << PrettyDuration(window_ns) << ": ";
+    if (log_end_ns - log_start_ns_ < window_ns) {
+      os << "-";
+    } else {
+      os << StringPrintf("%.1f%%", GetMinimumMutatorUtilizationLocked(window_ns) * 100.0);
+    }
+  }
+  os << "\n";
+
+  // Spread the CPU time of each collection evenly over its duration to get the CPU time per
+  // window.
+  uint64_t total_cpu_ns = 0;
+  uint64_t total_gc_ns = 0;
+  std::vector<double> window_cpu_ns((log_end_ns - log_start_ns_) / kCpuWindowNs + 1, 0.0);
+  for (const GcEvent& event : events_) {
+    total_cpu_ns += event.cpu_ns;
+    total_gc_ns += event.end_ns - event.start_ns;
+    const uint64_t start_ns = std::max(event.start_ns, log_start_ns_);
+    if (event.end_ns <= start_ns) {
+      continue;
+    }
+    const double cpu_per_ns = static_cast<double>(event.cpu_ns) / (event.end_ns - event.start_ns);
+    for (uint64_t time = start_ns; time < event.end_ns; ) {
+      const size_t window = (time - log_start_ns_) / kCpuWindowNs;
+      const uint64_t window_end = log_start_ns_ + (window + 1) * kCpuWindowNs;
+      const uint64_t end = std::min(window_end, event.end_ns);
+      window_cpu_ns[window] += (end - time) * cpu_per_ns;
+      time = end;
+    }
+  }
+  os << "GC CPU time: " << PrettyDuration(total_cpu_ns)
+     << StringPrintf(" (%.1f%% of the GC time, %.1f%% of the logged time)",
+                     total_cpu_ns * 100.0 / std::max(total_gc_ns, UINT64_C(1)),
+                     total_cpu_ns * 100.0 / std::max(log_end_ns - log_start_ns_, UINT64_C(1)))
+     << "\n";
+  // The last window is usually partial and would read low, leave it out.
+  if (window_cpu_ns.size() > 1) {
+    window_cpu_ns.pop_back();
+    const double max_cpu_ns = *std::max_element(window_cpu_ns.begin(), window_cpu_ns.end());
+    os << "GC CPU per " << PrettyDuration(kCpuWindowNs) << ": max "
+       << StringPrintf("%.1f%%", max_cpu_ns * 100.0 / kCpuWindowNs) << ", latest:";
+    const size_t first = window_cpu_ns.size() - std::min(window_cpu_ns.size(),
+                                                         kMaxDumpedCpuWindows);
+    for (size_t i = first; i < window_cpu_ns.size(); ++i) {
+      os << StringPrintf(" %.1f%%", window_cpu_ns[i] * 100.0 / kCpuWindowNs);
+    }
+    os << "\n";
+  }
+}
+
+void GcEventLog::DumpEvents(std::ostream& os) const {
+  MutexLock mu(Thread::Current(), lock_);
+  os << "id\tstart_ns\tduration_ns\tcpu_ns\tcause\tcollector\tgc_type\tpauses_ns"
+     << "\tfreed_objects\tfreed_bytes\tallocated_before\tallocated_after"
+     << "\ttotal_memory_before\ttotal_memory_after\tphases_ns\n";
+  for (const GcEvent& event : events_) {
+    os << event.id << "\t" << event.start_ns << "\t" << event.end_ns - event.start_ns << "\t"
+       << event.cpu_ns << "\t" << PrettyCause(event.cause) << "\t" << event.collector_type
+       << "\t" << event.gc_type << "\t";
+    for (size_t i = 0; i < event.pause_times.size(); ++i) {
+      os << (i != 0 ? "," : "") << event.pause_times[i];
+    }
+    os << "\t" << event.freed_objects << "\t" << event.freed_bytes
+       << "\t" << event.bytes_allocated_before << "\t" << event.bytes_allocated_after
+       << "\t" << event.total_memory_before << "\t" << event.total_memory_after << "\t";
+    for (size_t i = 0; i < event.phase_times.size(); ++i) {
+      os << (i != 0 ? "," : "") << event.phase_times[i].first << "="
+         << event.phase_times[i].second;
+    }
+    os << "\n";
+  }
+}
+
+void GcEventLog::Reset() {
+  MutexLock mu(Thread::Current(), lock_);
+  pauses_.clear();
+  events_.clear();
+  log_start_ns_ = 0;
+}
+
+}  // namespace gc
+}  // namespace art
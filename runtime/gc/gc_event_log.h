@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_GC_EVENT_LOG_H_
+#define ART_RUNTIME_GC_GC_EVENT_LOG_H_
+
+#include <stdint.h>
+#include <deque>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/mutex.h"
+#include "gc/collector/gc_type.h"
+#include "gc/collector_type.h"
+#include "gc/gc_cause.h"
+
+namespace art {
+namespace gc {
+
+// One collection, as recorded at the end of GarbageCollector::Run. Times are in the NanoTime()
+// time base.
+struct GcEvent {
+  // Increasing from 1, so that readers polling the log can tell which events they already saw.
+  uint64_t id = 0;
+  uint64_t start_ns = 0;
+  uint64_t end_ns = 0;
+  // CPU time of the thread which ran the collection, GC helper threads are not included.
+  uint64_t cpu_ns = 0;
+  GcCause cause = kGcCauseBackground;
+  CollectorType collector_type = kCollectorTypeNone;
+  collector::GcType gc_type = collector::kGcTypeNone;
+  // The durations and the ends of the pauses, in order.
+  std::vector<uint64_t> pause_times;
+  std::vector<uint64_t> pause_end_times;
+  // Including the large objects.
+  uint64_t freed_objects = 0;
+  int64_t freed_bytes = 0;
+  size_t bytes_allocated_before = 0;
+  size_t bytes_allocated_after = 0;
+  // Heap::GetTotalMemory(), the footprint the heap may grow to before it collects.
+  size_t total_memory_before = 0;
+  size_t total_memory_after = 0;
+  // The outermost timings of the collection and their durations.
+  std::vector<std::pair<std::string, uint64_t>> phase_times;
+};
+
+// Ring buffer of the latest collections of all the collectors of a heap. Besides the per
+// collector pause histograms, it keeps when the pauses happened, which is what the mutator
+// utilization over a time window and the GC CPU usage over time need, and the details of each
+// collection for the tools which follow GC latency.
+class GcEventLog {
+ public:
+  static constexpr size_t kMaxPauses = 4096;
+  static constexpr size_t kMaxEvents = 512;
+  // The windows the minimum mutator utilization is dumped for.
+  static constexpr uint64_t kMmuWindowsNs[] = {
+      UINT64_C(10000000), UINT64_C(50000000), UINT64_C(100000000), UINT64_C(1000000000) };
+  // The window of the dumped GC CPU usage series.
+  static constexpr uint64_t kCpuWindowNs = UINT64_C(1000000000);
+  static constexpr size_t kMaxDumpedCpuWindows = 30;
+
+  GcEventLog();
+
+  // Record a collection, its id is assigned here.
+  void AddEvent(GcEvent&& event) REQUIRES(!lock_);
+
+  // Append the logged events with an id above after_id to events, oldest first. Returns the id of
+  // the latest event, or after_id if there is no newer one.
+  uint64_t GetEvents(uint64_t after_id, std::vector<GcEvent>* events) const REQUIRES(!lock_);
+
+  // Returns the smallest fraction of any window_ns long window within the logged time in which
+  // the mutators were not paused, or 1.0 if less than window_ns were logged.
+  double GetMinimumMutatorUtilization(uint64_t window_ns) const REQUIRES(!lock_);
+
+  // Returns the per percentile of the logged pauses, per is in [0, 1]. Returns 0 if there are no
+  // pauses.
+  uint64_t GetPausePercentile(double per) const REQUIRES(!lock_);
+
+  // Dump the pause percentiles, the minimum mutator utilizations and the GC CPU usage.
+  void Dump(std::ostream& os) const REQUIRES(!lock_);
+
+  // Dump the events, one tab separated line each after a header line naming the columns.
+  void DumpEvents(std::ostream& os) const REQUIRES(!lock_);
+
+  void Reset() REQUIRES(!lock_);
+
+ private:
+  struct Pause {
+    uint64_t start_ns;
+    uint64_t end_ns;
+  };
+
+  double GetMinimumMutatorUtilizationLocked(uint64_t window_ns) const REQUIRES(lock_);
+  // Returns how long the mutators were paused between start_ns and end_ns.
+  uint64_t PausedTimeLocked(uint64_t start_ns, uint64_t end_ns) const REQUIRES(lock_);
+  // Returns the sorted durations of the logged pauses.
+  std::vector<uint64_t> SortedPauseTimesLocked() const REQUIRES(lock_);
+
+  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Both ordered by time, collections and so their pauses never overlap. The pauses of the events
+  // are also kept flattened in one sequence for the mutator utilization.
+  std::deque<Pause> pauses_ GUARDED_BY(lock_);
+  std::deque<GcEvent> events_ GUARDED_BY(lock_);
+  uint64_t next_id_ GUARDED_BY(lock_);
+  // The logged time runs from here to the end of the last collection.
+  uint64_t log_start_ns_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(GcEventLog);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_GC_EVENT_LOG_H_
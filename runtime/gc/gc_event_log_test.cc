@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_event_log.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+
+namespace art {
+namespace gc {
+
+class GcEventLogTest : public CommonRuntimeTest {};
+
+static constexpr uint64_t kMs = UINT64_C(1000000);
+// Far enough from 0 that no time underflows.
+static constexpr uint64_t kBase = 1000 * kMs;
+
+static void AddCollection(GcEventLog* log,
+                          uint64_t start_ns,
+                          uint64_t end_ns,
+                          uint64_t cpu_ns,
+                          const std::vector<uint64_t>& pause_end_times,
+                          const std::vector<uint64_t>& pause_times) {
+  GcEvent event;
+  event.start_ns = start_ns;
+  event.end_ns = end_ns;
+  event.cpu_ns = cpu_ns;
+  event.pause_end_times = pause_end_times;
+  event.pause_times = pause_times;
+  log->AddEvent(std::move(event));
+}
+
+TEST_F(GcEventLogTest, MinimumMutatorUtilization) {
+  GcEventLog log;
+  EXPECT_DOUBLE_EQ(1.0, log.GetMinimumMutatorUtilization(10 * kMs));
+  // A 10ms pause ending at 50ms and a 5ms pause ending at 1s.
+  AddCollection(&log, kBase, kBase + 100 * kMs, 20 * kMs, { kBase + 50 * kMs }, { 10 * kMs });
+  AddCollection(&log, kBase + 900 * kMs, kBase + 1000 * kMs, 20 * kMs,
+                { kBase + 1000 * kMs }, { 5 * kMs });
+  EXPECT_DOUBLE_EQ(0.0, log.GetMinimumMutatorUtilization(5 * kMs));
+  EXPECT_DOUBLE_EQ(0.0, log.GetMinimumMutatorUtilization(10 * kMs));
+  EXPECT_DOUBLE_EQ(0.8, log.GetMinimumMutatorUtilization(50 * kMs));
+  EXPECT_DOUBLE_EQ(0.985, log.GetMinimumMutatorUtilization(1000 * kMs));
+  // Longer than the logged time.
+  EXPECT_DOUBLE_EQ(1.0, log.GetMinimumMutatorUtilization(2000 * kMs));
+}
+
+TEST_F(GcEventLogTest, PausePercentiles) {
+  GcEventLog log;
+  EXPECT_EQ(0u, log.GetPausePercentile(0.5));
+  std::vector<uint64_t> pause_end_times;
+  std::vector<uint64_t> pause_times;
+  for (uint64_t i = 1; i <= 100; ++i) {
+    pause_end_times.push_back(kBase + i * kMs);
+    pause_times.push_back(i * 1000);
+  }
+  AddCollection(&log, kBase, kBase + 101 * kMs, 0, pause_end_times, pause_times);
+  EXPECT_EQ(50000u, log.GetPausePercentile(0.5));
+  EXPECT_EQ(99000u, log.GetPausePercentile(0.99));
+  EXPECT_EQ(100000u, log.GetPausePercentile(0.999));
+}
+
+TEST_F(GcEventLogTest, DropsOldestCollections) {
+  GcEventLog log;
+  for (size_t i = 0; i <= GcEventLog::kMaxEvents; ++i) {
+    uint64_t start = kBase + i * 10 * kMs;
+    AddCollection(&log, start, start + 5 * kMs, kMs, { start + 2 * kMs }, { 2 * kMs });
+  }
+  std::ostringstream os;
+  log.Dump(os);
+  std::ostringstream expected;
+  expected << GcEventLog::kMaxEvents << " pauses and " << GcEventLog::kMaxEvents
+           << " collections";
+  EXPECT_NE(std::string::npos, os.str().find(expected.str())) << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("GC pause percentiles: p50 2ms")) << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("Minimum mutator utilization: 10ms: 80.0%"))
+      << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("GC CPU per 1s: max 10.0%")) << os.str();
+  log.Reset();
+  std::ostringstream reset_os;
+  log.Dump(reset_os);
+  EXPECT_TRUE(reset_os.str().empty());
+}
+
+TEST_F(GcEventLogTest, Events) {
+  GcEventLog log;
+  std::vector<GcEvent> events;
+  EXPECT_EQ(0u, log.GetEvents(0u, &events));
+  EXPECT_TRUE(events.empty());
+  GcEvent event;
+  event.start_ns = kBase;
+  event.end_ns = kBase + 10 * kMs;
+  event.cause = kGcCauseExplicit;
+  event.collector_type = kCollectorTypeCMS;
+  event.gc_type = collector::kGcTypeFull;
+  event.pause_times = { 2 * kMs };
+  event.pause_end_times = { kBase + 5 * kMs };
+  event.freed_objects = 10;
+  event.freed_bytes = 1000;
+  event.bytes_allocated_before = 5000;
+  event.bytes_allocated_after = 4000;
+  event.phase_times = { { "MarkingPhase", 6 * kMs }, { "ReclaimPhase", 4 * kMs } };
+  log.AddEvent(std::move(event));
+  AddCollection(&log, kBase + 20 * kMs, kBase + 30 * kMs, 0, {}, {});
+
+  EXPECT_EQ(2u, log.GetEvents(0u, &events));
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ(1u, events[0].id);
+  EXPECT_EQ(kGcCauseExplicit, events[0].cause);
+  EXPECT_EQ(4000u, events[0].bytes_allocated_after);
+  ASSERT_EQ(2u, events[0].phase_times.size());
+  EXPECT_EQ("ReclaimPhase", events[0].phase_times[1].first);
+  // Only the events after the given id.
+  events.clear();
+  EXPECT_EQ(2u, log.GetEvents(1u, &events));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(2u, events[0].id);
+  events.clear();
+  EXPECT_EQ(2u, log.GetEvents(2u, &events));
+  EXPECT_TRUE(events.empty());
+
+  std::ostringstream os;
+  log.DumpEvents(os);
+  EXPECT_EQ(0u, os.str().find("id\tstart_ns\t")) << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("\t2000000\t10\t1000\t5000\t4000\t"))
+      << os.str();
+  EXPECT_NE(std::string::npos, os.str().find("\tMarkingPhase=6000000,ReclaimPhase=4000000\n"))
+      << os.str();
+}
+
+}  // namespace gc
+}  // namespace art
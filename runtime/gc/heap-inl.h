@@ -22,6 +22,7 @@
 #include "base/time_utils.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/allocation_record.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -158,6 +159,14 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
     QuasiAtomic::ThreadFenceForConstructor();
     new_num_bytes_allocated = static_cast<size_t>(
         num_bytes_allocated_.FetchAndAddRelaxed(bytes_tl_bulk_allocated)) + bytes_tl_bulk_allocated;
+    // Only the slow path counts towards the next sample, a new TLAB or thread local run is
+    // counted all at once here.
+    if (UNLIKELY(alloc_sampler_ != nullptr)) {
+      size_t overshoot;
+      if (UNLIKELY(alloc_sampler_->CountBytes(bytes_tl_bulk_allocated, &overshoot))) {
+        alloc_sampler_->RecordSample(self, &obj, bytes_allocated, overshoot);
+      }
+    }
   }
   if (kIsDebugBuild && Runtime::Current()->IsStarted()) {
     CHECK_LE(obj->SizeOf(), usable_size);
@@ -345,17 +354,25 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self,
       DCHECK(region_space_ != nullptr);
       DCHECK_ALIGNED(alloc_size, space::RegionSpace::kAlignment);
       if (UNLIKELY(self->TlabSize() < alloc_size)) {
-        if (space::RegionSpace::kRegionSize >= alloc_size) {
+        // First try to grow the tlab within its region.
+        const size_t expand_bytes = region_space_->ComputeTlabExpansion(self, alloc_size);
+        if (expand_bytes != 0 &&
+            LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, expand_bytes))) {
+          region_space_->ExpandTlab(self, expand_bytes);
+          *bytes_tl_bulk_allocated = expand_bytes;
+          // Fall-through.
+        } else if (space::RegionSpace::kRegionSize >= alloc_size) {
           // Non-large. Check OOME for a tlab.
-          if (LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, space::RegionSpace::kRegionSize))) {
+          const size_t new_tlab_size = region_space_->ComputeNewTlabSize(self, alloc_size);
+          if (LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, new_tlab_size))) {
             // Try to allocate a tlab.
-            if (!region_space_->AllocNewTlab(self)) {
+            if (!region_space_->AllocNewTlab(self, new_tlab_size)) {
               // Failed to allocate a tlab. Try non-tlab.
               ret = region_space_->AllocNonvirtual<false>(alloc_size, bytes_allocated, usable_size,
                                                           bytes_tl_bulk_allocated);
               return ret;
             }
-            *bytes_tl_bulk_allocated = space::RegionSpace::kRegionSize;
+            *bytes_tl_bulk_allocated = new_tlab_size;
             // Fall-through.
           } else {
             // Check OOME for a non-tlab allocation.
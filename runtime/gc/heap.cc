@@ -26,6 +26,7 @@
 #include "base/arena_allocator.h"
 #include "base/dumpable.h"
 #include "base/histogram-inl.h"
+#include "base/numa.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
@@ -39,12 +40,14 @@
 #include "gc/accounting/mod_union_table-inl.h"
 #include "gc/accounting/remembered_set.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/concurrent_copying.h"
 #include "gc/collector/mark_compact.h"
 #include "gc/collector/mark_sweep.h"
 #include "gc/collector/partial_mark_sweep.h"
 #include "gc/collector/semi_space.h"
 #include "gc/collector/sticky_mark_sweep.h"
+#include "gc/gc_event_log.h"
 #include "gc/reference_processor.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -65,9 +68,12 @@
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/reference-inl.h"
+#include "mirror/string-inl.h"
+#include "monitor_pool.h"
 #include "os.h"
 #include "reflection.h"
 #include "runtime.h"
+#include "safe_map.h"
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "handle_scope-inl.h"
@@ -87,8 +93,16 @@ static constexpr size_t kMaxConcurrentRemainingBytes = 512 * KB;
 // relative to partial/full GC. This may be desirable since sticky GCs interfere less with mutator
 // threads (lower pauses, use less memory bandwidth).
 static constexpr double kStickyGcThroughputAdjustment = 1.0;
+// Weight of the latest GC in the smoothed GC ergonomics estimates.
+static constexpr double kGcErgonomicsSmoothing = 0.5;
+// Limit of Heap::ergonomics_headroom_.
+static constexpr double kGcErgonomicsMaxHeadroom = 8.0;
 // Whether or not we compact the zygote in PreZygoteFork.
 static constexpr bool kCompactZygote = kMovingCollector;
+// Whether the zygote space mod union table records the references of the cards, like the image
+// ones, or only the cards. The former costs memory per reference but not rescanning the cards that
+// reference alloc spaces on every GC.
+static constexpr bool kPreciseZygoteModUnionTable = true;
 // How many reserve entries are at the end of the allocation stack, these are only needed if the
 // allocation stack overflows.
 static constexpr size_t kAllocationStackReserveSize = 1024;
@@ -110,15 +124,15 @@ static constexpr size_t kVerifyObjectAllocationStackSize = 16 * KB /
     sizeof(mirror::HeapReference<mirror::Object>);
 static constexpr size_t kDefaultAllocationStackSize = 8 * MB /
     sizeof(mirror::HeapReference<mirror::Object>);
-// System.runFinalization can deadlock with native allocations, to deal with this, we have a
-// timeout on how long we wait for finalizers to run. b/21544853
-static constexpr uint64_t kNativeAllocationFinalizeTimeout = MsToNs(250u);
 
 // For deterministic compilation, we need the heap to be at a well-known address.
 static constexpr uint32_t kAllocSpaceBeginForDeterministicAoT = 0x40000000;
 // Dump the rosalloc stats on SIGQUIT.
 static constexpr bool kDumpRosAllocStatsOnSigQuit = false;
 
+// Number of allocation sites with the most sampled bytes dumped on SIGQUIT.
+static constexpr size_t kMaxSigQuitAllocSampleSites = 20;
+
 static constexpr size_t kNativeAllocationHistogramBuckets = 16;
 
 // Extra added to the heap growth multiplier. Used to adjust the GC ergonomics for the read barrier
@@ -158,6 +172,13 @@ Heap::Heap(size_t initial_size,
            bool verify_post_gc_rosalloc,
            bool gc_stress_mode,
            bool measure_gc_performance,
+           bool use_generational_cc,
+           bool use_concurrent_mark_compact,
+           bool use_huge_pages,
+           bool numa_aware_gc,
+           double gc_cpu_target_fraction,
+           size_t gc_pause_target,
+           size_t alloc_sample_interval,
            bool use_homogeneous_space_compaction_for_oom,
            uint64_t min_interval_homogeneous_space_compaction_by_oom)
     : non_moving_space_(nullptr),
@@ -187,7 +208,7 @@ Heap::Heap(size_t initial_size,
       growth_limit_(growth_limit),
       max_allowed_footprint_(initial_size),
       native_footprint_gc_watermark_(initial_size),
-      native_need_to_run_finalization_(false),
+      native_footprint_limit_(2 * initial_size),
       concurrent_start_bytes_(std::numeric_limits<size_t>::max()),
       total_bytes_freed_ever_(0),
       total_objects_freed_ever_(0),
@@ -209,6 +230,7 @@ Heap::Heap(size_t initial_size,
       verify_pre_sweeping_rosalloc_(verify_pre_sweeping_rosalloc),
       verify_post_gc_rosalloc_(verify_post_gc_rosalloc),
       gc_stress_mode_(gc_stress_mode),
+      allocation_rate_(0),
       /* For GC a lot mode, we limit the allocations stacks to be kGcAlotInterval allocations. This
        * causes a lot of GC since we do a GC for alloc whenever the stack is full. When heap
        * verification is enabled, we limit the size of allocation stacks to speed up their
@@ -230,14 +252,29 @@ Heap::Heap(size_t initial_size,
       total_wait_time_(0),
       verify_object_mode_(kVerifyObjectModeDisabled),
       disable_moving_gc_count_(0),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
+      // The young-generation collection relies on the Baker read barrier to treat the old regions
+      // as to-space without scanning them.
+      use_generational_cc_(use_generational_cc && kUseBakerReadBarrier),
+      use_concurrent_mark_compact_(use_concurrent_mark_compact),
+      use_huge_pages_(use_huge_pages),
+      numa_aware_gc_(numa_aware_gc),
+      gc_cpu_target_fraction_(gc_cpu_target_fraction),
+      gc_pause_target_(gc_pause_target),
+      ergonomics_gc_duration_(0.0),
+      ergonomics_headroom_(1.0),
+      last_gc_end_time_(0),
+      bytes_allocated_after_last_gc_(0),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      pending_monitor_deflation_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
@@ -250,6 +287,8 @@ Heap::Heap(size_t initial_size,
       blocking_gc_count_rate_histogram_("blocking gc count rate histogram", 1U,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
+      alloc_sampler_(alloc_sample_interval != 0 ? new AllocSampler(alloc_sample_interval) : nullptr),
+      gc_event_log_(new GcEventLog()),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -405,6 +444,10 @@ Heap::Heap(size_t initial_size,
     // Try to reserve virtual memory at a lower address if we have a separate non moving space.
     request_begin = reinterpret_cast<uint8_t*>(300 * MB);
   }
+  if (use_huge_pages_ && request_begin != nullptr) {
+    // The main spaces are mapped back to back from here with huge page multiple capacities.
+    request_begin = AlignUp(request_begin, kHugePageSize);
+  }
   // Attempt to create 2 mem maps at or after the requested begin.
   if (foreground_collector_type_ != kCollectorTypeCC) {
     ScopedTrace trace2("Create main mem map");
@@ -531,7 +574,8 @@ Heap::Heap(size_t initial_size,
   // reserved by the kernel.
   static constexpr size_t kMinHeapAddress = 4 * KB;
   card_table_.reset(accounting::CardTable::Create(reinterpret_cast<uint8_t*>(kMinHeapAddress),
-                                                  4 * GB - kMinHeapAddress));
+                                                  4 * GB - kMinHeapAddress,
+                                                  use_huge_pages_));
   CHECK(card_table_.get() != nullptr) << "Failed to create card table";
   if (foreground_collector_type_ == kCollectorTypeCC && kUseTableLookupReadBarrier) {
     rb_table_.reset(new accounting::ReadBarrierTable());
@@ -601,12 +645,22 @@ Heap::Heap(size_t initial_size,
     }
     if (MayUseCollector(kCollectorTypeCC)) {
       concurrent_copying_collector_ = new collector::ConcurrentCopying(this,
+                                                                       /*young_gen*/false,
                                                                        "",
                                                                        measure_gc_performance);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      active_concurrent_copying_collector_ = concurrent_copying_collector_;
+      if (use_generational_cc_) {
+        young_concurrent_copying_collector_ = new collector::ConcurrentCopying(
+            this,
+            /*young_gen*/true,
+            "young",
+            measure_gc_performance);
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
     }
     if (MayUseCollector(kCollectorTypeMC)) {
-      mark_compact_collector_ = new collector::MarkCompact(this);
+      mark_compact_collector_ = new collector::MarkCompact(this, use_concurrent_mark_compact_);
       garbage_collectors_.push_back(mark_compact_collector_);
     }
   }
@@ -859,6 +913,22 @@ void Heap::DecrementDisableMovingGC(Thread* self) {
   --disable_moving_gc_count_;
 }
 
+bool Heap::PinObjectForCriticalAccess(mirror::Object* obj) {
+  if (!kUseReadBarrier || region_space_ == nullptr || !region_space_->HasAddress(obj)) {
+    return false;
+  }
+  region_space_->PinObject(obj);
+  return true;
+}
+
+bool Heap::UnpinObjectForCriticalAccess(mirror::Object* obj) {
+  if (!kUseReadBarrier || region_space_ == nullptr || !region_space_->HasAddress(obj)) {
+    return false;
+  }
+  region_space_->UnpinObject(obj);
+  return true;
+}
+
 void Heap::IncrementDisableThreadFlip(Thread* self) {
   // Supposed to be called by mutators. If thread_flip_running_ is true, block. Otherwise, go ahead.
   CHECK(kUseReadBarrier);
@@ -971,7 +1041,18 @@ void Heap::UpdateProcessState(ProcessState old_process_state, ProcessState new_p
 void Heap::CreateThreadPool() {
   const size_t num_threads = std::max(parallel_gc_threads_, conc_gc_threads_);
   if (num_threads != 0) {
-    thread_pool_.reset(new ThreadPool("Heap thread pool", num_threads));
+    thread_pool_.reset(new ThreadPool("Heap thread pool",
+                                      num_threads,
+                                      /* prioritized */ false,
+                                      /* work_stealing */ true));
+    if (numa_aware_gc_) {
+      // Each worker marks from the tasks of its own node first. The pages a worker touches
+      // first, such as the regions it evacuates to, come from its node.
+      std::vector<std::vector<int>> node_cpus = Numa::GetNodeCpus();
+      if (node_cpus.size() > 1u) {
+        thread_pool_->SetNodeAffinity(node_cpus);
+      }
+    }
   }
 }
 
@@ -1098,6 +1179,44 @@ void Heap::AddSpace(space::Space* space) {
   if (space->IsAllocSpace()) {
     alloc_spaces_.push_back(space->AsAllocSpace());
   }
+  if (use_huge_pages_ && space->IsContinuousSpace()) {
+    AdviseHugePages(space->AsContinuousSpace());
+  }
+}
+
+void Heap::AdviseHugePages(space::ContinuousSpace* space) {
+  // Image spaces are file backed and stay on small pages.
+  if (!space->IsContinuousMemMapAllocSpace()) {
+    return;
+  }
+  space->AsContinuousMemMapAllocSpace()->GetMemMap()->AdviseHugePages();
+  accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
+  accounting::ContinuousSpaceBitmap* mark_bitmap = space->GetMarkBitmap();
+  if (live_bitmap != nullptr) {
+    live_bitmap->GetMemMap()->AdviseHugePages();
+  }
+  if (mark_bitmap != nullptr && mark_bitmap != live_bitmap) {
+    mark_bitmap->GetMemMap()->AdviseHugePages();
+  }
+  if (space->IsRosAllocSpace()) {
+    // Releasing single free pages would split the huge pages again.
+    space->AsRosAllocSpace()->GetRosAlloc()->SetPageReleaseGranularity(kHugePageSize);
+  }
+}
+
+void Heap::DumpHugePageUsage(std::ostream& os) {
+  os << "Transparent huge page usage:\n";
+  for (const auto& space : continuous_spaces_) {
+    if (space->IsContinuousMemMapAllocSpace()) {
+      MemMap* mem_map = space->AsContinuousMemMapAllocSpace()->GetMemMap();
+      os << "  " << space->GetName() << ": "
+         << PrettySize(mem_map->GetHugePageBackedBytes()) << " of "
+         << PrettySize(mem_map->BaseSize()) << "\n";
+    }
+  }
+  MemMap* card_table_map = card_table_->GetMemMap();
+  os << "  card table: " << PrettySize(card_table_map->GetHugePageBackedBytes()) << " of "
+     << PrettySize(card_table_map->BaseSize()) << "\n";
 }
 
 void Heap::SetSpaceAsDefault(space::ContinuousSpace* continuous_space) {
@@ -1195,11 +1314,16 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
       os << "\n";
     }
   }
+  gc_event_log_->Dump(os);
 
   if (kDumpRosAllocStatsOnSigQuit && rosalloc_space_ != nullptr) {
     rosalloc_space_->DumpStats(os);
   }
 
+  if (use_huge_pages_) {
+    DumpHugePageUsage(os);
+  }
+
   {
     MutexLock mu(Thread::Current(), native_histogram_lock_);
     if (native_allocation_histogram_.SampleSize() > 0u) {
@@ -1235,6 +1359,7 @@ void Heap::ResetGcPerformanceInfo() {
     gc_count_rate_histogram_.Reset();
     blocking_gc_count_rate_histogram_.Reset();
   }
+  gc_event_log_->Reset();
 }
 
 uint64_t Heap::GetGcCount() const {
@@ -1370,32 +1495,50 @@ void Heap::DoPendingCollectorTransition() {
   CollectorType desired_collector_type = desired_collector_type_;
   // Launch homogeneous space compaction if it is desired.
   if (desired_collector_type == kCollectorTypeHomogeneousSpaceCompact) {
-    if (!CareAboutPauseTimes()) {
-      PerformHomogeneousSpaceCompact();
-    } else {
+    if (CareAboutPauseTimes()) {
       VLOG(gc) << "Homogeneous compaction ignored due to jank perceptible process state";
+    } else if (collector_type_ == kCollectorTypeCC) {
+      // There is no backup space for CC, a collection that evacuates every region compacts the
+      // live objects into as few regions as possible and gives the freed ones back.
+      CollectGarbageInternal(gc_plan_.back(), kGcCauseHomogeneousSpaceCompact, false);
+    } else {
+      PerformHomogeneousSpaceCompact();
     }
   } else {
     TransitionCollector(desired_collector_type);
   }
 }
 
-void Heap::Trim(Thread* self) {
-  Runtime* const runtime = Runtime::Current();
-  if (!CareAboutPauseTimes()) {
-    // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
-    // about pauses.
+void Heap::DeflateMonitors(Thread* self) {
+  {
     ScopedTrace trace("Deflating monitors");
     ScopedSuspendAll ssa(__FUNCTION__);
     uint64_t start_time = NanoTime();
-    size_t count = runtime->GetMonitorList()->DeflateMonitors();
+    size_t count = Runtime::Current()->GetMonitorList()->DeflateMonitors();
     VLOG(heap) << "Deflating " << count << " monitors took "
         << PrettyDuration(NanoTime() - start_time);
   }
+  // The deflated monitors went back to the pool, give the chunks that became free back too.
+  size_t released = MonitorPool::ReleaseFreeChunks(self);
+  VLOG(heap) << "Released " << released << " monitor pool chunks";
+}
+
+void Heap::Trim(Thread* self) {
+  Runtime* const runtime = Runtime::Current();
+  if (!CareAboutPauseTimes()) {
+    // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
+    // about pauses.
+    DeflateMonitors(self);
+  }
   TrimIndirectReferenceTables(self);
   TrimSpaces(self);
   // Trim arenas that may have been used by JIT or verifier.
   runtime->GetArenaPool()->TrimMaps();
+  // Release the free pages of the JIT code cache, which mostly come from collected cold code.
+  if (runtime->GetJit() != nullptr) {
+    size_t reclaimed = runtime->GetJit()->GetCodeCache()->Trim(self);
+    VLOG(heap) << "JIT code cache trim reclaimed " << PrettySize(reclaimed);
+  }
 }
 
 class TrimIndirectReferenceTableClosure : public Closure {
@@ -1938,6 +2081,70 @@ void Heap::CountInstances(const std::vector<mirror::Class*>& classes, bool use_i
   VisitObjects(InstanceCounter::Callback, &counter);
 }
 
+class ClassHistogramBuilder {
+ public:
+  struct Entry {
+    std::string descriptor;
+    uint64_t count;
+    uint64_t bytes;
+  };
+
+  ClassHistogramBuilder() : total_count_(0u), total_bytes_(0u) {}
+
+  static void Callback(mirror::Object* obj, void* arg)
+      SHARED_REQUIRES(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    ClassHistogramBuilder* builder = reinterpret_cast<ClassHistogramBuilder*>(arg);
+    mirror::Class* klass = obj->GetClass();
+    size_t size = obj->SizeOf();
+    auto it = builder->entries_.find(klass);
+    if (it == builder->entries_.end()) {
+      // The classes may move once the walk is done, keep only their names.
+      Entry entry = { PrettyDescriptor(klass), 0u, 0u };
+      it = builder->entries_.Put(klass, entry);
+    }
+    ++it->second.count;
+    it->second.bytes += size;
+    ++builder->total_count_;
+    builder->total_bytes_ += size;
+  }
+
+  void Dump(std::ostream& os, size_t max_classes) {
+    std::vector<const Entry*> sorted;
+    sorted.reserve(entries_.size());
+    for (const auto& pair : entries_) {
+      sorted.push_back(&pair.second);
+    }
+    size_t num_classes = std::min(max_classes, sorted.size());
+    std::partial_sort(sorted.begin(),
+                      sorted.begin() + num_classes,
+                      sorted.end(),
+                      [](const Entry* lhs, const Entry* rhs) {
+                        return lhs->bytes > rhs->bytes ||
+                            (lhs->bytes == rhs->bytes && lhs->descriptor < rhs->descriptor);
+                      });
+    os << "Class histogram: " << total_count_ << " objects, " << PrettySize(total_bytes_)
+       << " in " << entries_.size() << " classes, top " << num_classes << " by shallow size\n";
+    for (size_t i = 0; i != num_classes; ++i) {
+      os << StringPrintf("%12" PRIu64 " bytes %10" PRIu64 " instances  ",
+                         sorted[i]->bytes,
+                         sorted[i]->count)
+         << sorted[i]->descriptor << "\n";
+    }
+  }
+
+ private:
+  SafeMap<mirror::Class*, Entry> entries_;
+  uint64_t total_count_;
+  uint64_t total_bytes_;
+  DISALLOW_COPY_AND_ASSIGN(ClassHistogramBuilder);
+};
+
+void Heap::DumpClassHistogram(std::ostream& os, size_t max_classes) {
+  ClassHistogramBuilder builder;
+  VisitObjects(ClassHistogramBuilder::Callback, &builder);
+  builder.Dump(os, max_classes);
+}
+
 class InstanceCollector {
  public:
   InstanceCollector(mirror::Class* c, int32_t max_count, std::vector<mirror::Object*>& instances)
@@ -2264,6 +2471,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (use_generational_cc_) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2373,16 +2583,29 @@ class ZygoteCompactingCollector FINAL : public collector::SemiSpace {
     return false;
   }
 
+  // Whether obj is likely to be written after the fork. These objects are packed into the bins,
+  // which are on the non moving space pages of the classes that get dirty anyway, while the
+  // other objects are kept together in the target space so that their pages stay shared.
+  static bool IsLikelyDirty(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_) {
+    // The collectors write the fields of the references they process.
+    if (obj->GetClass<kVerifyNone, kWithoutReadBarrier>()->IsTypeOfReferenceClass()) {
+      return true;
+    }
+    // Objects used as locks, their monitors are only deflated after the compaction.
+    LockWord::LockState state = obj->GetLockWord(false).GetState();
+    return state == LockWord::kThinLocked || state == LockWord::kFatLocked;
+  }
+
   virtual mirror::Object* MarkNonForwardedObject(mirror::Object* obj)
       REQUIRES(Locks::heap_bitmap_lock_, Locks::mutator_lock_) {
     size_t obj_size = obj->SizeOf();
     size_t alloc_size = RoundUp(obj_size, kObjectAlignment);
     mirror::Object* forward_address;
-    // Find the smallest bin which we can move obj in.
-    auto it = bins_.lower_bound(alloc_size);
+    // Find the smallest bin which we can move obj in, if it is likely dirty.
+    auto it = IsLikelyDirty(obj) ? bins_.lower_bound(alloc_size) : bins_.end();
     if (it == bins_.end()) {
-      // No available space in the bins, place it in the target space instead (grows the zygote
-      // space).
+      // Likely clean or no available space in the bins, place it in the target space instead
+      // (grows the zygote space).
       size_t bytes_allocated, dummy;
       forward_address = to_space_->Alloc(self_, alloc_size, &bytes_allocated, nullptr, &dummy);
       if (to_space_live_bitmap_ != nullptr) {
@@ -2429,7 +2652,16 @@ void Heap::UnBindBitmaps() {
   }
 }
 
+static void ComputeStringHashCodeCallback(mirror::Object* obj, void* arg)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  Heap* heap = reinterpret_cast<Heap*>(arg);
+  if (obj->IsString() && !heap->ObjectIsInBootImageSpace(obj)) {
+    obj->AsString()->GetHashCode();
+  }
+}
+
 void Heap::PreZygoteFork() {
+  Thread* self = Thread::Current();
   if (!HasZygoteSpace()) {
     // We still want to GC in case there is some unreachable non moving objects that could cause a
     // suboptimal bin packing when we compact the zygote space.
@@ -2437,8 +2669,11 @@ void Heap::PreZygoteFork() {
     // Trim the pages at the end of the non moving space. Trim while not holding zygote lock since
     // the trim process may require locking the mutator lock.
     non_moving_space_->Trim();
+    // Compute the string hash codes now that the strings are still private, the children would
+    // otherwise dirty the shared pages of the zygote space the first time they hash them.
+    ScopedObjectAccess soa(self);
+    VisitObjects(ComputeStringHashCodeCallback, this);
   }
-  Thread* self = Thread::Current();
   MutexLock mu(self, zygote_creation_lock_);
   // Try to see if we have any Zygote spaces.
   if (HasZygoteSpace()) {
@@ -2550,9 +2785,14 @@ void Heap::PreZygoteFork() {
   }
 
   // Create the zygote space mod union table.
-  accounting::ModUnionTable* mod_union_table =
-      new accounting::ModUnionTableCardCache("zygote space mod-union table", this,
-                                             zygote_space_);
+  accounting::ModUnionTable* mod_union_table;
+  if (kPreciseZygoteModUnionTable) {
+    mod_union_table = new accounting::ModUnionTableZygoteToAllocspace(
+        "zygote space mod-union table", this, zygote_space_);
+  } else {
+    mod_union_table = new accounting::ModUnionTableCardCache(
+        "zygote space mod-union table", this, zygote_space_);
+  }
   CHECK(mod_union_table != nullptr) << "Failed to create zygote space mod-union table";
   // Set all the cards in the mod-union table since we don't know which objects contain references
   // to large objects.
@@ -2571,6 +2811,9 @@ void Heap::PreZygoteFork() {
         << "Failed to create post-zygote non-moving space remembered set";
     AddRememberedSet(post_zygote_non_moving_space_rem_set);
   }
+  // Deflate the monitors last since the compaction bins the objects used as locks with their lock
+  // words. The children then do not share monitors nor write the ones of unused locks.
+  DeflateMonitors(self);
 }
 
 void Heap::FlushAllocStack() {
@@ -2696,10 +2939,16 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         semi_space_collector_->SetSwapSemiSpaces(true);
         collector = semi_space_collector_;
         break;
-      case kCollectorTypeCC:
-        concurrent_copying_collector_->SetRegionSpace(region_space_);
-        collector = concurrent_copying_collector_;
+      case kCollectorTypeCC: {
+        collector::ConcurrentCopying* cc_collector =
+            (use_generational_cc_ && gc_type == collector::kGcTypeSticky)
+                ? young_concurrent_copying_collector_
+                : concurrent_copying_collector_;
+        cc_collector->SetRegionSpace(region_space_);
+        active_concurrent_copying_collector_ = cc_collector;
+        collector = cc_collector;
         break;
+      }
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
         collector = mark_compact_collector_;
@@ -2707,7 +2956,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector == semi_space_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       if (kIsDebugBuild) {
         // Try to read each page of the memory map in case mprotect didn't work properly b/19894268.
@@ -2715,7 +2964,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       }
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    if (collector != young_concurrent_copying_collector_) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
@@ -2743,6 +2994,8 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   total_objects_freed_ever_ += GetCurrentGcIteration()->GetFreedObjects();
   total_bytes_freed_ever_ += GetCurrentGcIteration()->GetFreedBytes();
   RequestTrim(self);
+  RequestMonitorDeflation(self);
+  RequestLargeObjectRelease(self);
   // Enqueue cleared references.
   reference_processor_->EnqueueClearedReferences(self);
   // Grow the heap so that we know when to perform the next GC.
@@ -3513,6 +3766,10 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  if (alloc_sampler_ != nullptr) {
+    ScopedObjectAccess soa(Thread::Current());
+    alloc_sampler_->Dump(os, kMaxSigQuitAllocSampleSites);
+  }
 }
 
 size_t Heap::GetPercentFree() {
@@ -3548,7 +3805,10 @@ void Heap::UpdateMaxNativeFootprint() {
   } else if (target_size < native_size + min_free_) {
     target_size = native_size + min_free_;
   }
-  native_footprint_gc_watermark_ = std::min(growth_limit_, target_size);
+  // Neither watermark is capped by the growth limit, so that an app whose native bytes stay above
+  // it does not block on a collection for every registration.
+  native_footprint_gc_watermark_ = target_size;
+  native_footprint_limit_ = 2 * target_size - native_size;
 }
 
 collector::GarbageCollector* Heap::FindCollectorByGcType(collector::GcType gc_type) {
@@ -3569,6 +3829,57 @@ double Heap::HeapGrowthMultiplier() const {
   return foreground_heap_growth_multiplier_;
 }
 
+void Heap::UpdateGcErgonomics(collector::GcType gc_type, uint64_t bytes_allocated_before_gc) {
+  const uint64_t now = NanoTime();
+  const uint64_t gc_duration = current_gc_iteration_.GetDurationNs();
+  const uint64_t gc_start = now - std::min(now, gc_duration);
+  // The allocation rate of the mutators between the end of the last GC and the start of this one.
+  if (last_gc_end_time_ != 0 && gc_start > last_gc_end_time_ &&
+      bytes_allocated_before_gc >= bytes_allocated_after_last_gc_) {
+    const double rate = static_cast<double>(bytes_allocated_before_gc -
+                                            bytes_allocated_after_last_gc_) * 1e9 /
+        static_cast<double>(gc_start - last_gc_end_time_);
+    allocation_rate_ = allocation_rate_ == 0
+        ? static_cast<uint64_t>(rate)
+        : static_cast<uint64_t>(kGcErgonomicsSmoothing * rate +
+                                (1.0 - kGcErgonomicsSmoothing) * allocation_rate_);
+  }
+  // Sticky GCs are much shorter, only the non sticky ones set how big the heap needs to be.
+  if (gc_type != collector::kGcTypeSticky) {
+    ergonomics_gc_duration_ = ergonomics_gc_duration_ == 0.0
+        ? gc_duration
+        : kGcErgonomicsSmoothing * gc_duration +
+              (1.0 - kGcErgonomicsSmoothing) * ergonomics_gc_duration_;
+  }
+  // A GC for alloc blocks the allocating thread for the whole GC, count it as a pause.
+  uint64_t longest_pause = current_gc_iteration_.GetGcCause() == kGcCauseForAlloc ? gc_duration : 0;
+  for (uint64_t pause : current_gc_iteration_.GetPauseTimes()) {
+    longest_pause = std::max(longest_pause, pause);
+  }
+  ergonomics_headroom_ = NextGcErgonomicsHeadroom(ergonomics_headroom_,
+                                                  longest_pause,
+                                                  gc_pause_target_);
+}
+
+uint64_t Heap::GcErgonomicsFreeBytes(uint64_t allocation_rate,
+                                     double gc_duration_ns,
+                                     double gc_cpu_target_fraction) {
+  DCHECK_GT(gc_cpu_target_fraction, 0.0);
+  // With a GC of duration d every free / allocation_rate seconds, the GC runs for the fraction
+  // f = d / (d + free / allocation_rate) of the time. Solve for free.
+  const double f = gc_cpu_target_fraction;
+  return static_cast<uint64_t>(allocation_rate * (gc_duration_ns / 1e9) * (1.0 - f) / f);
+}
+
+double Heap::NextGcErgonomicsHeadroom(double headroom,
+                                      uint64_t longest_pause,
+                                      uint64_t gc_pause_target) {
+  if (longest_pause > gc_pause_target) {
+    return std::min(headroom * 2.0, kGcErgonomicsMaxHeadroom);
+  }
+  return std::max(headroom * 0.75, 1.0);
+}
+
 void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
                               uint64_t bytes_allocated_before_gc) {
   // We know what our utilization is at this moment.
@@ -3576,24 +3887,41 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   const uint64_t bytes_allocated = GetBytesAllocated();
   uint64_t target_size;
   collector::GcType gc_type = collector_ran->GetGcType();
+  const bool use_ergonomics = UseGcErgonomics();
+  if (use_ergonomics) {
+    UpdateGcErgonomics(gc_type, bytes_allocated_before_gc);
+  }
   const double multiplier = HeapGrowthMultiplier();  // Use the multiplier to grow more for
   // foreground.
   const uint64_t adjusted_min_free = static_cast<uint64_t>(min_free_ * multiplier);
   const uint64_t adjusted_max_free = static_cast<uint64_t>(max_free_ * multiplier);
   if (gc_type != collector::kGcTypeSticky) {
-    // Grow the heap for non sticky GC.
-    ssize_t delta = bytes_allocated / GetTargetHeapUtilization() - bytes_allocated;
-    CHECK_GE(delta, 0);
-    target_size = bytes_allocated + delta * multiplier;
-    target_size = std::min(target_size, bytes_allocated + adjusted_max_free);
-    target_size = std::max(target_size, bytes_allocated + adjusted_min_free);
-    native_need_to_run_finalization_ = true;
+    if (use_ergonomics && allocation_rate_ != 0) {
+      target_size = bytes_allocated + GcErgonomicsFreeBytes(allocation_rate_,
+                                                            ergonomics_gc_duration_,
+                                                            gc_cpu_target_fraction_);
+      target_size = std::max(target_size, bytes_allocated + adjusted_min_free);
+    } else {
+      // Grow the heap for non sticky GC.
+      ssize_t delta = bytes_allocated / GetTargetHeapUtilization() - bytes_allocated;
+      CHECK_GE(delta, 0);
+      target_size = bytes_allocated + delta * multiplier;
+      target_size = std::min(target_size, bytes_allocated + adjusted_max_free);
+      target_size = std::max(target_size, bytes_allocated + adjusted_min_free);
+    }
+    // Scale the native watermark to what survived, without waiting for the finalizers.
+    UpdateMaxNativeFootprint();
     next_gc_type_ = collector::kGcTypeSticky;
   } else {
     collector::GcType non_sticky_gc_type =
         HasZygoteSpace() ? collector::kGcTypePartial : collector::kGcTypeFull;
     // Find what the next non sticky collector will be.
     collector::GarbageCollector* non_sticky_collector = FindCollectorByGcType(non_sticky_gc_type);
+    if (use_generational_cc_ && non_sticky_collector == nullptr) {
+      // The full CC collector reports itself as partial regardless of the zygote space.
+      non_sticky_collector = FindCollectorByGcType(collector::kGcTypePartial);
+    }
+    CHECK(non_sticky_collector != nullptr);
     // If the throughput of the current sticky GC >= throughput of the non sticky collector, then
     // do another sticky collection next.
     // We also check that the bytes allocated aren't over the footprint limit in order to prevent a
@@ -3607,8 +3935,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     } else {
       next_gc_type_ = non_sticky_gc_type;
     }
-    // If we have freed enough memory, shrink the heap back down.
-    if (bytes_allocated + adjusted_max_free < max_allowed_footprint_) {
+    // If we have freed enough memory, shrink the heap back down. The ergonomics only resize the
+    // heap after non sticky GCs.
+    if (!use_ergonomics && bytes_allocated + adjusted_max_free < max_allowed_footprint_) {
       target_size = bytes_allocated + adjusted_max_free;
     } else {
       target_size = std::max(bytes_allocated, static_cast<uint64_t>(max_allowed_footprint_));
@@ -3626,12 +3955,24 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
       const uint64_t bytes_allocated_during_gc = bytes_allocated + freed_bytes -
           bytes_allocated_before_gc;
       // Calculate when to perform the next ConcurrentGC.
-      // Calculate the estimated GC duration.
-      const double gc_duration_seconds = NsToMs(current_gc_iteration_.GetDurationNs()) / 1000.0;
-      // Estimate how many remaining bytes we will have when we need to start the next GC.
-      size_t remaining_bytes = bytes_allocated_during_gc * gc_duration_seconds;
-      remaining_bytes = std::min(remaining_bytes, kMaxConcurrentRemainingBytes);
-      remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      size_t remaining_bytes;
+      if (use_ergonomics && allocation_rate_ != 0) {
+        // Leave enough room for the mutators to keep allocating for the whole expected GC
+        // duration, more after GCs that missed the pause target.
+        const double gc_duration_seconds = std::max(
+            ergonomics_gc_duration_, static_cast<double>(current_gc_iteration_.GetDurationNs())) /
+            1e9;
+        remaining_bytes = static_cast<size_t>(
+            allocation_rate_ * gc_duration_seconds * ergonomics_headroom_);
+        remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      } else {
+        // Calculate the estimated GC duration.
+        const double gc_duration_seconds = NsToMs(current_gc_iteration_.GetDurationNs()) / 1000.0;
+        // Estimate how many remaining bytes we will have when we need to start the next GC.
+        remaining_bytes = bytes_allocated_during_gc * gc_duration_seconds;
+        remaining_bytes = std::min(remaining_bytes, kMaxConcurrentRemainingBytes);
+        remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      }
       if (UNLIKELY(remaining_bytes > max_allowed_footprint_)) {
         // A never going to happen situation that from the estimated allocation rate we will exceed
         // the applications entire footprint with the given estimated allocation rate. Schedule
@@ -3647,6 +3988,10 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
                                          static_cast<size_t>(bytes_allocated));
     }
   }
+  if (use_ergonomics) {
+    last_gc_end_time_ = NanoTime();
+    bytes_allocated_after_last_gc_ = bytes_allocated;
+  }
 }
 
 void Heap::ClampGrowthLimit() {
@@ -3838,6 +4183,71 @@ void Heap::RequestTrim(Thread* self) {
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::MonitorDeflationTask : public HeapTask {
+ public:
+  explicit MonitorDeflationTask(uint64_t delta_time) : HeapTask(NanoTime() + delta_time) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    heap->DeflateMonitors(self);
+    heap->ClearPendingMonitorDeflation(self);
+  }
+};
+
+void Heap::ClearPendingMonitorDeflation(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_monitor_deflation_ = nullptr;
+}
+
+void Heap::RequestMonitorDeflation(Thread* self) {
+  // Unlike the trim, which only deflates monitors when we do not care about pause times, this
+  // also runs in the foreground. The pause is only worth it once many monitors are inflated.
+  if (!CanAddHeapTask(self) ||
+      Runtime::Current()->GetMonitorList()->Size() < kMonitorDeflationThreshold) {
+    return;
+  }
+  MonitorDeflationTask* added_task = nullptr;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_monitor_deflation_ != nullptr) {
+      // Already have a monitor deflation request in task processor, ignore this request.
+      return;
+    }
+    added_task = new MonitorDeflationTask(kMonitorDeflationWait);
+    pending_monitor_deflation_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+}
+
+class Heap::LargeObjectReleaseTask : public HeapTask {
+ public:
+  explicit LargeObjectReleaseTask(uint64_t target_time) : HeapTask(target_time) {}
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    // Clear the request first so that frees from a GC running concurrently with the release get
+    // a new task.
+    heap->ClearLargeObjectReleaseRequest();
+    heap->GetLargeObjectsSpace()->ReleaseFreedMemory(self);
+  }
+};
+
+void Heap::ClearLargeObjectReleaseRequest() {
+  large_object_release_pending_.StoreRelaxed(false);
+}
+
+void Heap::RequestLargeObjectRelease(Thread* self) {
+  if (large_object_space_ == nullptr || !large_object_space_->HasFreedMemoryToRelease(self)) {
+    return;
+  }
+  if (!CanAddHeapTask(self)) {
+    // No heap task thread to do it later, release right away.
+    large_object_space_->ReleaseFreedMemory(self);
+    return;
+  }
+  if (large_object_release_pending_.CompareExchangeStrongSequentiallyConsistent(false, true)) {
+    task_processor_->AddTask(self, new LargeObjectReleaseTask(NanoTime()));  // Start straight away.
+  }
+}
+
 void Heap::RevokeThreadLocalBuffers(Thread* thread) {
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeThreadLocalBuffers(thread);
@@ -3884,56 +4294,32 @@ bool Heap::IsGCRequestPending() const {
   return concurrent_gc_pending_.LoadRelaxed();
 }
 
-void Heap::RunFinalization(JNIEnv* env, uint64_t timeout) {
-  env->CallStaticVoidMethod(WellKnownClasses::dalvik_system_VMRuntime,
-                            WellKnownClasses::dalvik_system_VMRuntime_runFinalization,
-                            static_cast<jlong>(timeout));
-}
-
 void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
   Thread* self = ThreadForEnv(env);
   {
     MutexLock mu(self, native_histogram_lock_);
     native_allocation_histogram_.AddValue(bytes);
   }
-  if (native_need_to_run_finalization_) {
-    RunFinalization(env, kNativeAllocationFinalizeTimeout);
-    UpdateMaxNativeFootprint();
-    native_need_to_run_finalization_ = false;
-  }
   // Total number of native bytes allocated.
   size_t new_native_bytes_allocated = native_bytes_allocated_.FetchAndAddSequentiallyConsistent(bytes);
   new_native_bytes_allocated += bytes;
-  if (new_native_bytes_allocated > native_footprint_gc_watermark_) {
+  if (new_native_bytes_allocated > native_footprint_limit_) {
+    // The second watermark is higher than the gc watermark. If you hit this it means you are
+    // allocating native objects faster than the GC can keep up with. A requested concurrent GC
+    // may not have started yet, so collect here instead of only waiting for one that is running.
+    // The native memory itself is freed by the reference and finalizer daemons after the
+    // collection, rather than by running finalization here.
     collector::GcType gc_type = HasZygoteSpace() ? collector::kGcTypePartial :
         collector::kGcTypeFull;
-
-    // The second watermark is higher than the gc watermark. If you hit this it means you are
-    // allocating native objects faster than the GC can keep up with.
-    if (new_native_bytes_allocated > growth_limit_) {
-      if (WaitForGcToComplete(kGcCauseForNativeAlloc, self) != collector::kGcTypeNone) {
-        // Just finished a GC, attempt to run finalizers.
-        RunFinalization(env, kNativeAllocationFinalizeTimeout);
-        CHECK(!env->ExceptionCheck());
-        // Native bytes allocated may be updated by finalization, refresh it.
-        new_native_bytes_allocated = native_bytes_allocated_.LoadRelaxed();
-      }
-      // If we still are over the watermark, attempt a GC for alloc and run finalizers.
-      if (new_native_bytes_allocated > growth_limit_) {
-        CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
-        RunFinalization(env, kNativeAllocationFinalizeTimeout);
-        native_need_to_run_finalization_ = false;
-        CHECK(!env->ExceptionCheck());
-      }
-      // We have just run finalizers, update the native watermark since it is very likely that
-      // finalizers released native managed allocations.
-      UpdateMaxNativeFootprint();
-    } else if (!IsGCRequestPending()) {
-      if (IsGcConcurrent()) {
-        RequestConcurrentGC(self, true);  // Request non-sticky type.
-      } else {
-        CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
-      }
+    CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
+  } else if (new_native_bytes_allocated > native_footprint_gc_watermark_ &&
+             !IsGCRequestPending()) {
+    if (IsGcConcurrent()) {
+      RequestConcurrentGC(self, true);  // Request non-sticky type.
+    } else {
+      collector::GcType gc_type = HasZygoteSpace() ? collector::kGcTypePartial :
+          collector::kGcTypeFull;
+      CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
     }
   }
 }
@@ -4009,6 +4395,9 @@ void Heap::SetAllocationRecords(AllocRecordObjectMap* records) {
 }
 
 void Heap::VisitAllocationRecords(RootVisitor* visitor) const {
+  if (alloc_sampler_ != nullptr) {
+    alloc_sampler_->VisitRoots(visitor);
+  }
   if (IsAllocTrackingEnabled()) {
     MutexLock mu(Thread::Current(), *Locks::alloc_tracker_lock_);
     if (IsAllocTrackingEnabled()) {
@@ -57,6 +57,8 @@ namespace mirror {
 namespace gc {
 
 class AllocRecordObjectMap;
+class AllocSampler;
+class GcEventLog;
 class ReferenceProcessor;
 class TaskProcessor;
 
@@ -131,6 +133,9 @@ class Heap {
   static constexpr size_t kDefaultTLABSize = 32 * KB;
   static constexpr double kDefaultTargetUtilization = 0.5;
   static constexpr double kDefaultHeapGrowthMultiplier = 2.0;
+  // GC ergonomics are off unless a GC CPU target fraction is given.
+  static constexpr double kDefaultGcCpuTargetFraction = 0.0;
+  static constexpr size_t kDefaultGcPauseTarget = MsToNs(5);
   // Primitive arrays larger than this size are put in the large object space.
   static constexpr size_t kDefaultLargeObjectThreshold = 3 * kPageSize;
   // Whether or not parallel GC is enabled. If not, then we never create the thread pool.
@@ -150,6 +155,10 @@ class Heap {
   static constexpr uint64_t kHeapTrimWait = MsToNs(5000);
   // How long we wait after a transition request to perform a collector transition (nanoseconds).
   static constexpr uint64_t kCollectorTransitionWait = MsToNs(5000);
+  // How long we wait after a GC to deflate monitors (nanoseconds), and how many inflated monitors
+  // there must be for it to be worth a pause.
+  static constexpr uint64_t kMonitorDeflationWait = MsToNs(10000);
+  static constexpr size_t kMonitorDeflationThreshold = 1024;
 
   // Create a heap with the requested sizes. The possible empty
   // image_file_names names specify Spaces to load based on
@@ -183,6 +192,13 @@ class Heap {
        bool verify_post_gc_rosalloc,
        bool gc_stress_mode,
        bool measure_gc_performance,
+       bool use_generational_cc,
+       bool use_concurrent_mark_compact,
+       bool use_huge_pages,
+       bool numa_aware_gc,
+       double gc_cpu_target_fraction,
+       size_t gc_pause_target,
+       size_t alloc_sample_interval,
        bool use_homogeneous_space_compaction,
        uint64_t min_interval_homogeneous_space_compaction_by_oom);
 
@@ -295,6 +311,13 @@ class Heap {
   void IncrementDisableMovingGC(Thread* self) REQUIRES(!*gc_complete_lock_);
   void DecrementDisableMovingGC(Thread* self) REQUIRES(!*gc_complete_lock_);
 
+  // Pin a movable object for a JNI critical call, so that the concurrent copying collector keeps
+  // compacting the rest of the heap. Returns false if the object is not in the region space,
+  // the caller must then disable the thread flip or moving GC instead.
+  bool PinObjectForCriticalAccess(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_);
+  // Returns false if the object was not pinned by PinObjectForCriticalAccess.
+  bool UnpinObjectForCriticalAccess(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Temporarily disable thread flip for JNI critical calls.
   void IncrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
   void DecrementDisableThreadFlip(Thread* self) REQUIRES(!*thread_flip_lock_);
@@ -323,6 +346,11 @@ class Heap {
                       uint64_t* counts)
       REQUIRES(!Locks::heap_bitmap_lock_, !*gc_complete_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
+  // Writes the number of instances and the shallow size of the max_classes classes with the most
+  // bytes in the heap. Visits each object once, the caller is responsible to GC if desired.
+  void DumpClassHistogram(std::ostream& os, size_t max_classes)
+      REQUIRES(!Locks::heap_bitmap_lock_, !*gc_complete_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   // Implements JDWP RT_Instances.
   void GetInstances(mirror::Class* c, int32_t max_count, std::vector<mirror::Object*>& instances)
       REQUIRES(!Locks::heap_bitmap_lock_, !*gc_complete_lock_)
@@ -348,6 +376,18 @@ class Heap {
     return target_utilization_;
   }
 
+  // How many bytes a non sticky GC leaves free with the GC ergonomics, so that GCs taking
+  // gc_duration_ns run for gc_cpu_target_fraction of the time. Public due to usage by tests.
+  static uint64_t GcErgonomicsFreeBytes(uint64_t allocation_rate,
+                                        double gc_duration_ns,
+                                        double gc_cpu_target_fraction);
+
+  // The concurrent GC start headroom after a GC whose longest pause was longest_pause. Public due
+  // to usage by tests.
+  static double NextGcErgonomicsHeadroom(double headroom,
+                                         uint64_t longest_pause,
+                                         uint64_t gc_pause_target);
+
   // Data structure memory usage tracking.
   void RegisterGCAllocation(size_t bytes);
   void RegisterGCDeAllocation(size_t bytes);
@@ -359,6 +399,8 @@ class Heap {
   void AddSpace(space::Space* space)
       REQUIRES(!Locks::heap_bitmap_lock_)
       REQUIRES(Locks::mutator_lock_);
+  // Advise the memory of a space and of its bitmaps for transparent huge pages.
+  void AdviseHugePages(space::ContinuousSpace* space);
   void RemoveSpace(space::Space* space)
     REQUIRES(!Locks::heap_bitmap_lock_)
     REQUIRES(Locks::mutator_lock_);
@@ -659,6 +701,9 @@ class Heap {
       REQUIRES(!*gc_complete_lock_, !native_histogram_lock_);
   void ResetGcPerformanceInfo() REQUIRES(!*gc_complete_lock_);
 
+  // Dump how much of each space is backed by transparent huge pages.
+  void DumpHugePageUsage(std::ostream& os);
+
   // Thread pool.
   void CreateThreadPool();
   void DeleteThreadPool();
@@ -695,8 +740,14 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // Returns the CC collector that is running or last ran. With generational CC this is either the
+  // full or the young-generation collector, so read barriers must not cache the result.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_;
+  }
+
+  bool IsGenerationalCCEnabled() const {
+    return use_generational_cc_;
   }
 
   CollectorType CurrentCollectorType() {
@@ -722,6 +773,13 @@ class Heap {
   // Request an asynchronous trim.
   void RequestTrim(Thread* self) REQUIRES(!*pending_task_lock_);
 
+  // Request that idle monitors are deflated asynchronously, if there are many inflated monitors.
+  void RequestMonitorDeflation(Thread* self) REQUIRES(!*pending_task_lock_);
+
+  // Request that the memory of the large objects freed by the last GC is given back to the OS
+  // asynchronously.
+  void RequestLargeObjectRelease(Thread* self);
+
   // Request asynchronous GC.
   void RequestConcurrentGC(Thread* self, bool force_full) REQUIRES(!*pending_task_lock_);
 
@@ -759,6 +817,16 @@ class Heap {
   void SetAllocationRecords(AllocRecordObjectMap* records)
       REQUIRES(Locks::alloc_tracker_lock_);
 
+  // Null unless the sampling allocation profiler is enabled.
+  AllocSampler* GetAllocSampler() const {
+    return alloc_sampler_.get();
+  }
+
+  // Ring buffer of the latest collections of all the collectors, with their pauses.
+  GcEventLog* GetGcEventLog() const {
+    return gc_event_log_.get();
+  }
+
   void VisitAllocationRecords(RootVisitor* visitor) const
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::alloc_tracker_lock_);
@@ -789,6 +857,8 @@ class Heap {
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class LargeObjectReleaseTask;
+  class MonitorDeflationTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -896,9 +966,6 @@ class Heap {
   bool IsValidContinuousSpaceObjectAddress(const mirror::Object* obj) const
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Run the finalizers. If timeout is non zero, then we use the VMRuntime version.
-  void RunFinalization(JNIEnv* env, uint64_t timeout);
-
   // Blocks the caller until the garbage collector becomes idle and returns the type of GC we
   // waited for.
   collector::GcType WaitForGcToCompleteLocked(GcCause cause, Thread* self)
@@ -933,7 +1000,7 @@ class Heap {
   void PostGcVerificationPaused(collector::GarbageCollector* gc)
       REQUIRES(Locks::mutator_lock_, !*gc_complete_lock_);
 
-  // Update the watermark for the native allocated bytes based on the current number of native
+  // Update the watermarks for the native allocated bytes based on the current number of native
   // bytes allocated and the target utilization ratio.
   void UpdateMaxNativeFootprint();
 
@@ -961,6 +1028,14 @@ class Heap {
   void GrowForUtilization(collector::GarbageCollector* collector_ran,
                           uint64_t bytes_allocated_before_gc = 0);
 
+  bool UseGcErgonomics() const {
+    return gc_cpu_target_fraction_ > 0.0;
+  }
+
+  // Update the allocation rate, GC duration and concurrent start headroom estimates from the GC
+  // that just finished.
+  void UpdateGcErgonomics(collector::GcType gc_type, uint64_t bytes_allocated_before_gc);
+
   size_t GetPercentFree();
 
   static void VerificationCallback(mirror::Object* obj, void* arg)
@@ -991,6 +1066,12 @@ class Heap {
 
   void ClearConcurrentGCRequest();
   void ClearPendingTrim(Thread* self) REQUIRES(!*pending_task_lock_);
+  void ClearPendingMonitorDeflation(Thread* self) REQUIRES(!*pending_task_lock_);
+
+  // Deflate the monitors with all threads suspended, then release the monitor pool chunks that
+  // became free.
+  void DeflateMonitors(Thread* self) REQUIRES(!Locks::mutator_lock_);
+  void ClearLargeObjectReleaseRequest();
   void ClearPendingCollectorTransition(Thread* self) REQUIRES(!*pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
@@ -1139,8 +1220,9 @@ class Heap {
   // The watermark at which a concurrent GC is requested by registerNativeAllocation.
   size_t native_footprint_gc_watermark_;
 
-  // Whether or not we need to run finalizers in the next native allocation.
-  bool native_need_to_run_finalization_;
+  // The watermark at which registerNativeAllocation blocks on a collection. Like the GC
+  // watermark, it scales with the native bytes that survived the last collection.
+  size_t native_footprint_limit_;
 
   // When num_bytes_allocated_ exceeds this amount then a concurrent GC should be requested so that
   // it completes ahead of an allocation failing.
@@ -1273,9 +1355,36 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // The young-generation concurrent copying collector, only created if use_generational_cc_.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  // The CC collector that is running or last ran. Only changed while no GC is running.
+  collector::ConcurrentCopying* active_concurrent_copying_collector_;
 
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
+  // If true, the CC collector alternates between young-generation (sticky) and full collections.
+  const bool use_generational_cc_;
+  // If true, the mark compact collector marks concurrently and only compacts in a pause.
+  const bool use_concurrent_mark_compact_;
+  // If true, the spaces, their bitmaps and the card table are advised for transparent huge pages.
+  const bool use_huge_pages_;
+  // If true, the workers of the heap thread pool are spread over the NUMA nodes.
+  const bool numa_aware_gc_;
+
+  // GC ergonomics, used if gc_cpu_target_fraction_ is not 0. The heap is sized so that the GC
+  // runs for about this fraction of the time given the measured allocation rate and GC duration.
+  const double gc_cpu_target_fraction_;
+  // A GC pausing longer than this makes the next concurrent GCs start earlier.
+  const size_t gc_pause_target_;
+  // Smoothed duration of the non sticky GCs in ns, 0 before the first one.
+  double ergonomics_gc_duration_;
+  // Multiplier of the bytes left free when a concurrent GC starts. Grows when a GC misses the
+  // pause target and decays back to 1 otherwise.
+  double ergonomics_headroom_;
+  // When the last GC finished and how many bytes were allocated right after it. Used to compute
+  // allocation_rate_.
+  uint64_t last_gc_end_time_;
+  uint64_t bytes_allocated_after_last_gc_;
 
   // Pointer to the space which becomes the new main space when we do homogeneous space compaction.
   // Use unique_ptr since the space is only added during the homogeneous compaction phase.
@@ -1302,9 +1411,13 @@ class Heap {
   // Whether or not a concurrent GC is pending.
   Atomic<bool> concurrent_gc_pending_;
 
+  // Whether or not a large object release task is pending.
+  Atomic<bool> large_object_release_pending_;
+
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
+  MonitorDeflationTask* pending_monitor_deflation_ GUARDED_BY(pending_task_lock_);
 
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
@@ -1335,6 +1448,11 @@ class Heap {
   Atomic<bool> alloc_tracking_enabled_;
   std::unique_ptr<AllocRecordObjectMap> allocation_records_;
 
+  // Sampling allocation profiler, null unless enabled with -XX:AllocSampleInterval.
+  std::unique_ptr<AllocSampler> alloc_sampler_;
+
+  std::unique_ptr<GcEventLog> gc_event_log_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
@@ -62,6 +62,25 @@ TEST_F(HeapTest, GarbageCollectClassLinkerInit) {
   Runtime::Current()->GetHeap()->CollectGarbage(false);
 }
 
+TEST_F(HeapTest, DumpClassHistogram) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  // Large enough to be the class with the most bytes.
+  Handle<mirror::ObjectArray<mirror::Object>> array(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 4 * MB)));
+  ASSERT_TRUE(array.Get() != nullptr);
+
+  std::ostringstream oss;
+  Runtime::Current()->GetHeap()->DumpClassHistogram(oss, 1u);
+  std::string histogram = oss.str();
+  EXPECT_NE(std::string::npos, histogram.find("top 1 by shallow size\n")) << histogram;
+  EXPECT_NE(std::string::npos, histogram.find(" instances  java.lang.Object[]\n")) << histogram;
+  // Only one class is printed.
+  EXPECT_EQ(2, std::count(histogram.begin(), histogram.end(), '\n')) << histogram;
+}
+
 TEST_F(HeapTest, HeapBitmapCapacityTest) {
   uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x1000);
   const size_t heap_capacity = kObjectAlignment * (sizeof(intptr_t) * 8 + 1);
@@ -72,6 +91,36 @@ TEST_F(HeapTest, HeapBitmapCapacityTest) {
   bitmap->Set(fake_end_of_heap_object);
 }
 
+TEST_F(HeapTest, GcErgonomicsFreeBytes) {
+  // 100 MB/s and 10 ms GCs allocate 1 MB per GC. Running the GC for a tenth of the time needs
+  // nine times that in between.
+  EXPECT_EQ(9 * MB, Heap::GcErgonomicsFreeBytes(100 * MB, MsToNs(10), 0.1));
+  EXPECT_EQ(1 * MB, Heap::GcErgonomicsFreeBytes(100 * MB, MsToNs(10), 0.5));
+  // A lower target fraction always needs more free space.
+  EXPECT_GT(Heap::GcErgonomicsFreeBytes(100 * MB, MsToNs(10), 0.05),
+            Heap::GcErgonomicsFreeBytes(100 * MB, MsToNs(10), 0.1));
+  EXPECT_EQ(0u, Heap::GcErgonomicsFreeBytes(0, MsToNs(10), 0.1));
+}
+
+TEST_F(HeapTest, GcErgonomicsHeadroom) {
+  const uint64_t target = MsToNs(5);
+  // Missing the pause target doubles the headroom, up to a limit.
+  EXPECT_DOUBLE_EQ(2.0, Heap::NextGcErgonomicsHeadroom(1.0, target + 1, target));
+  EXPECT_DOUBLE_EQ(4.0, Heap::NextGcErgonomicsHeadroom(2.0, target + 1, target));
+  double headroom = 1.0;
+  for (size_t i = 0; i < 10; ++i) {
+    headroom = Heap::NextGcErgonomicsHeadroom(headroom, 2 * target, target);
+  }
+  EXPECT_GT(headroom, 4.0);
+  EXPECT_DOUBLE_EQ(headroom, Heap::NextGcErgonomicsHeadroom(headroom, 2 * target, target));
+  // Meeting it decays the headroom back to 1, but not below.
+  EXPECT_DOUBLE_EQ(3.0, Heap::NextGcErgonomicsHeadroom(4.0, target, target));
+  for (size_t i = 0; i < 20; ++i) {
+    headroom = Heap::NextGcErgonomicsHeadroom(headroom, 0, target);
+  }
+  EXPECT_DOUBLE_EQ(1.0, headroom);
+}
+
 class ZygoteHeapTest : public CommonRuntimeTest {
   void SetUpRuntimeOptions(RuntimeOptions* options) {
     CommonRuntimeTest::SetUpRuntimeOptions(options);
@@ -84,5 +133,37 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class GcErgonomicsHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:GcCpuTargetFraction=0.1", nullptr));
+    options->push_back(std::make_pair("-XX:GcPauseTarget=1", nullptr));
+  }
+};
+
+TEST_F(GcErgonomicsHeapTest, GarbageCollect) {
+  // Exercise the ergonomics heap sizing over GCs with allocations in between, the later GCs
+  // have an allocation rate to size the heap with.
+  Heap* heap = Runtime::Current()->GetHeap();
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  for (size_t i = 0; i < 4; ++i) {
+    StackHandleScope<1> hs2(soa.Self());
+    Handle<mirror::ObjectArray<mirror::Object>> array(hs2.NewHandle(
+        mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 1024)));
+    ASSERT_TRUE(array.Get() != nullptr);
+    for (size_t j = 0; j < 1024; ++j) {
+      array->Set<false>(j, mirror::String::AllocFromModifiedUtf8(soa.Self(), "hello, world!"));
+    }
+    {
+      ScopedThreadSuspension sts(soa.Self(), kSuspended);
+      heap->CollectGarbage(false);
+    }
+    EXPECT_GE(heap->GetTotalMemory(), heap->GetBytesAllocated());
+  }
+}
+
 }  // namespace gc
 }  // namespace art
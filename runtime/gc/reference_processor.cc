@@ -18,6 +18,7 @@
 
 #include "base/time_utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
@@ -26,6 +27,7 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "task_processor.h"
+#include "thread_pool.h"
 #include "utils.h"
 #include "well_known_classes.h"
 
@@ -33,10 +35,16 @@ namespace art {
 namespace gc {
 
 static constexpr bool kAsyncReferenceQueueAdd = false;
+static constexpr bool kParallelClearWhiteReferences = true;
+// Below this, waking up the thread pool costs more than it saves.
+static constexpr size_t kMinimumParallelReferences = 4096;
+// References the tasks take from the shared queues at a time.
+static constexpr size_t kReferenceChunkSize = 256;
 
 ReferenceProcessor::ReferenceProcessor()
     : collector_(nullptr),
       preserving_references_(false),
+      soft_references_forwarded_(false),
       condition_("reference processor condition", *Locks::reference_processor_lock_) ,
       soft_reference_queue_(Locks::reference_queue_soft_references_lock_),
       weak_reference_queue_(Locks::reference_queue_weak_references_lock_),
@@ -96,6 +104,16 @@ mirror::Object* ReferenceProcessor::GetReferent(Thread* self, mirror::Reference*
            (LIKELY(!reference->IsFinalizerReferenceInstance()) && reference->IsUnprocessed())) {
           return referent_addr->AsMirrorPtr();
         }
+      } else if (soft_references_forwarded_ &&
+                 !reference->IsFinalizerReferenceInstance() &&
+                 !reference->IsUnprocessed()) {
+        // Once the soft references are forwarded, the only objects that get marked are the ones
+        // reachable from finalizable objects, which the mutator cannot reach. A soft or weak
+        // reference still queued with a white referent is cleared by the next
+        // ClearWhiteReferences, so answer with the outcome instead of waiting for it. The
+        // referent of a reference that is not queued may only look white, for instance if it
+        // was allocated after the pause of a concurrent mark sweep: wait for that one.
+        return nullptr;
       }
     }
     condition_.WaitHoldingLocks(self);
@@ -146,9 +164,14 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
+  if (concurrent) {
+    // From now on, GetReferent can return null for white referents instead of blocking.
+    MutexLock mu(self, *Locks::reference_processor_lock_);
+    soft_references_forwarded_ = true;
+    condition_.Broadcast(self);
+  }
   // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences({&soft_reference_queue_, &weak_reference_queue_}, concurrent, collector);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -162,11 +185,11 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
-  // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  // Clear all finalizer referent reachable soft and weak references, and all phantom references,
+  // with white referents.
+  ClearWhiteReferences({&soft_reference_queue_, &weak_reference_queue_, &phantom_reference_queue_},
+                       concurrent,
+                       collector);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -179,6 +202,7 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
     // starts since there is a small window of time where slow_path_enabled_ is enabled but the
     // callback isn't yet set.
     collector_ = nullptr;
+    soft_references_forwarded_ = false;
     if (!kUseReadBarrier && concurrent) {
       // Done processing, disable the slow path and broadcast to the waiters.
       DisableSlowPath(self);
@@ -186,6 +210,85 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
   }
 }
 
+// Takes chunks of references from the shared queues until they are empty and clears the white
+// ones into a local queue, so that the only contention is on the chunks and the final append.
+class ReferenceProcessor::ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(const std::vector<ReferenceQueue*>* queues,
+                           ReferenceQueue* cleared_references,
+                           collector::GarbageCollector* collector)
+      : queues_(queues), cleared_references_(cleared_references), collector_(collector) {}
+
+  // No thread safety analysis since multiple threads run the tasks on behalf of the GC thread.
+  virtual void Run(Thread* self) NO_THREAD_SAFETY_ANALYSIS {
+    ReferenceQueue chunk(nullptr);
+    ReferenceQueue cleared(nullptr);
+    for (ReferenceQueue* queue : *queues_) {
+      while (queue->AtomicDequeuePendingReferences(self, kReferenceChunkSize, &chunk)) {
+        chunk.ClearWhiteReferences(&cleared, collector_);
+      }
+    }
+    cleared_references_->AtomicAppend(self, &cleared);
+  }
+
+  virtual void Finalize() {
+    delete this;
+  }
+
+ private:
+  const std::vector<ReferenceQueue*>* const queues_;
+  ReferenceQueue* const cleared_references_;
+  collector::GarbageCollector* const collector_;
+};
+
+size_t ReferenceProcessor::GetThreadCount(bool concurrent, collector::GarbageCollector* collector) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  // Only the mark sweep collectors test marks without updating the referents, and the read barrier
+  // collectors need the gray state of the references handled on the GC thread. Use one thread in
+  // the background like the marking does.
+  const CollectorType type = collector->GetCollectorType();
+  if (!kParallelClearWhiteReferences || kUseReadBarrier ||
+      (type != kCollectorTypeMS && type != kCollectorTypeCMS) ||
+      heap->GetThreadPool() == nullptr ||
+      Runtime::Current()->IsActiveTransaction() ||
+      !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return (concurrent ? heap->GetConcGCThreadCount() : heap->GetParallelGCThreadCount()) + 1;
+}
+
+void ReferenceProcessor::ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                                              bool concurrent,
+                                              collector::GarbageCollector* collector) {
+  const size_t thread_count = GetThreadCount(concurrent, collector);
+  size_t length = 0;
+  if (thread_count > 1) {
+    for (ReferenceQueue* queue : queues) {
+      length += queue->GetLength(kMinimumParallelReferences - length);
+      if (length == kMinimumParallelReferences) {
+        break;
+      }
+    }
+  }
+  if (length < kMinimumParallelReferences) {
+    for (ReferenceQueue* queue : queues) {
+      queue->ClearWhiteReferences(&cleared_references_, collector);
+    }
+    return;
+  }
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = Runtime::Current()->GetHeap()->GetThreadPool();
+  const std::vector<ReferenceQueue*> shared_queues(queues);
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(
+        self, new ClearWhiteReferencesTask(&shared_queues, &cleared_references_, collector));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
 // marked, put it on the appropriate list in the heap for later processing.
 void ReferenceProcessor::DelayReferenceReferent(mirror::Class* klass, mirror::Reference* ref,
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 #define ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 
+#include <initializer_list>
+
 #include "base/mutex.h"
 #include "globals.h"
 #include "jni.h"
@@ -56,7 +58,8 @@ class ReferenceProcessor {
   // GetReferent fast path as an optimization.
   void EnableSlowPath() SHARED_REQUIRES(Locks::mutator_lock_);
   void BroadcastForSlowPath(Thread* self);
-  // Decode the referent, may block if references are being processed.
+  // Decode the referent. While references are being processed this only blocks until the
+  // collector can tell whether the referent will be cleared, not until processing is done.
   mirror::Object* GetReferent(Thread* self, mirror::Reference* reference)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Locks::reference_processor_lock_);
   void EnqueueClearedReferences(Thread* self) REQUIRES(!Locks::mutator_lock_);
@@ -72,6 +75,16 @@ class ReferenceProcessor {
                !Locks::reference_queue_finalizer_references_lock_);
 
  private:
+  class ClearWhiteReferencesTask;
+
+  // Clear the references with white referents of the queues, on the GC thread pool if the
+  // collector allows it and there are enough references.
+  void ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                            bool concurrent,
+                            collector::GarbageCollector* collector)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  // The number of threads, including the GC thread, that clear the references.
+  static size_t GetThreadCount(bool concurrent, collector::GarbageCollector* collector);
   bool SlowPathEnabled() SHARED_REQUIRES(Locks::mutator_lock_);
   // Called by ProcessReferences.
   void DisableSlowPath(Thread* self) REQUIRES(Locks::reference_processor_lock_)
@@ -87,6 +100,9 @@ class ReferenceProcessor {
   // Boolean for whether or not we are preserving references (either soft references or finalizers).
   // If this is true, then we cannot return a referent (see comment in GetReferent).
   bool preserving_references_ GUARDED_BY(Locks::reference_processor_lock_);
+  // Whether the soft references of the current collection have been forwarded. After that, a
+  // queued soft or weak reference with a white referent is going to be cleared.
+  bool soft_references_forwarded_ GUARDED_BY(Locks::reference_processor_lock_);
   // Condition that people wait on if they attempt to get the referent of a reference while
   // processing is in progress.
   ConditionVariable condition_ GUARDED_BY(Locks::reference_processor_lock_);
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "reference_processor.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <functional>
+
+#include "atomic.h"
+#include "base/timing_logger.h"
+#include "collector/garbage_collector.h"
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/reference-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace gc {
+
+class ReferenceProcessorTest : public CommonRuntimeTest {};
+
+// A collector that marks nothing, like a concurrent mark sweep collector looking at an object
+// allocated after its pause. It calls back the test the first time reference processing checks
+// a referent.
+class UnmarkingCollector FINAL : public collector::GarbageCollector {
+ public:
+  explicit UnmarkingCollector(std::function<void()> on_first_check)
+      : GarbageCollector(Runtime::Current()->GetHeap(), "unmarking collector"),
+        on_first_check_(on_first_check),
+        checked_(true) {}
+
+  collector::GcType GetGcType() const OVERRIDE {
+    return collector::kGcTypeFull;
+  }
+  CollectorType GetCollectorType() const OVERRIDE {
+    return kCollectorTypeCMS;
+  }
+  mirror::Object* IsMarked(mirror::Object* obj ATTRIBUTE_UNUSED) OVERRIDE {
+    return nullptr;
+  }
+  bool IsMarkedHeapReference(mirror::HeapReference<mirror::Object>* obj ATTRIBUTE_UNUSED)
+      OVERRIDE {
+    if (!checked_) {
+      checked_ = true;
+      on_first_check_();
+    }
+    return false;
+  }
+  void ProcessMarkStack() OVERRIDE {}
+  mirror::Object* MarkObject(mirror::Object* obj) OVERRIDE {
+    return obj;
+  }
+  void MarkHeapReference(mirror::HeapReference<mirror::Object>* obj ATTRIBUTE_UNUSED) OVERRIDE {}
+  void DelayReferenceReferent(mirror::Class* klass ATTRIBUTE_UNUSED,
+                              mirror::Reference* reference ATTRIBUTE_UNUSED) OVERRIDE {}
+
+  // Calls back the test at the next check of a referent.
+  void Arm() {
+    checked_ = false;
+  }
+
+ protected:
+  void RunPhases() OVERRIDE {}
+  void RevokeAllThreadLocalBuffers() OVERRIDE {}
+
+ private:
+  const std::function<void()> on_first_check_;
+  bool checked_;
+};
+
+struct GetReferentArgs {
+  GetReferentArgs(ReferenceProcessor* p, mirror::Reference* r)
+      : processor(p), reference(r), referent(nullptr), done(0) {}
+
+  ReferenceProcessor* const processor;
+  mirror::Reference* const reference;
+  mirror::Object* referent;
+  AtomicInteger done;
+};
+
+static void* GetReferentCallback(void* arg) {
+  GetReferentArgs* args = reinterpret_cast<GetReferentArgs*>(arg);
+  Runtime* runtime = Runtime::Current();
+  CHECK(runtime->AttachCurrentThread("GetReferent", false, nullptr, false));
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    args->referent = args->processor->GetReferent(soa.Self(), args->reference);
+  }
+  args->done.StoreSequentiallyConsistent(1);
+  runtime->DetachCurrentThread();
+  return nullptr;
+}
+
+// Test that GetReferent only returns null without waiting for the end of reference processing
+// for the white referents of references that are going to be cleared.
+TEST_F(ReferenceProcessorTest, GetReferentDuringConcurrentProcessing) {
+  if (kUseReadBarrier) {
+    // Readers wait for weak reference access instead of the slow path.
+    return;
+  }
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<8> hs(self);
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  auto ref_class = hs.NewHandle(
+      class_linker->FindClass(self, "Ljava/lang/ref/WeakReference;",
+                              ScopedNullHandle<mirror::ClassLoader>()));
+  ASSERT_TRUE(ref_class.Get() != nullptr);
+  auto object_class = hs.NewHandle(class_linker->FindSystemClass(self, "Ljava/lang/Object;"));
+  ASSERT_TRUE(object_class.Get() != nullptr);
+  Handle<mirror::Reference> refs[3];
+  for (Handle<mirror::Reference>& ref : refs) {
+    ref = hs.NewHandle(ref_class->AllocObject(self)->AsReference());
+    ASSERT_TRUE(ref.Get() != nullptr);
+    mirror::Object* referent = object_class->AllocObject(self);
+    ASSERT_TRUE(referent != nullptr);
+    ref->SetReferent<false>(referent);
+  }
+  // The first two references are queued by the marking, the last one is not.
+  Handle<mirror::Reference> unqueued = refs[2];
+  mirror::Object* const unqueued_referent = unqueued->GetReferent();
+
+  ReferenceProcessor processor;
+  GetReferentArgs args(&processor, unqueued.Get());
+  pthread_t pthread;
+  bool started = false;
+  UnmarkingCollector collector([&]() NO_THREAD_SAFETY_ANALYSIS {
+    // The queued reference not being checked yet is going to be cleared: no need to wait.
+    Handle<mirror::Reference> queued = refs[0]->IsUnprocessed() ? refs[1] : refs[0];
+    EXPECT_FALSE(queued->IsUnprocessed());
+    EXPECT_TRUE(processor.GetReferent(self, queued.Get()) == nullptr);
+    EXPECT_TRUE(queued->GetReferent() != nullptr);
+    // The unqueued reference is not going to be cleared although its referent looks white, so
+    // GetReferent must wait for the end of the processing.
+    CHECK_PTHREAD_CALL(pthread_create, (&pthread, nullptr, GetReferentCallback, &args),
+                       "GetReferent thread");
+    started = true;
+    usleep(100 * 1000);
+    EXPECT_EQ(0, args.done.LoadSequentiallyConsistent());
+  });
+  processor.DelayReferenceReferent(ref_class.Get(), refs[0].Get(), &collector);
+  processor.DelayReferenceReferent(ref_class.Get(), refs[1].Get(), &collector);
+  collector.Arm();
+
+  processor.EnableSlowPath();
+  TimingLogger timings("ReferenceProcessorTest", false, false);
+  {
+    WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+    processor.ProcessReferences(/* concurrent */ true,
+                                &timings,
+                                /* clear_soft_references */ true,
+                                &collector);
+  }
+  ASSERT_TRUE(started);
+  {
+    ScopedThreadSuspension sts(self, kNative);
+    CHECK_PTHREAD_CALL(pthread_join, (pthread, nullptr), "GetReferent thread");
+  }
+  EXPECT_EQ(1, args.done.LoadSequentiallyConsistent());
+  EXPECT_EQ(unqueued_referent, args.referent);
+  EXPECT_TRUE(unqueued->GetReferent() == unqueued_referent);
+  EXPECT_TRUE(refs[0]->GetReferent() == nullptr);
+  EXPECT_TRUE(refs[1]->GetReferent() == nullptr);
+}
+
+}  // namespace gc
+}  // namespace art
@@ -58,8 +58,8 @@ mirror::Reference* ReferenceQueue::DequeuePendingReference() {
   DCHECK(!IsEmpty());
   mirror::Reference* ref = list_->GetPendingNext<kWithoutReadBarrier>();
   DCHECK(ref != nullptr);
-  // Note: the following code is thread-safe because it is only called from ProcessReferences which
-  // is single threaded.
+  // Note: the following code is not thread-safe, the reference processor either calls it from one
+  // thread or with the lock held, see AtomicDequeuePendingReferences.
   if (list_ == ref) {
     list_ = nullptr;
   } else {
@@ -95,6 +95,33 @@ mirror::Reference* ReferenceQueue::DequeuePendingReference() {
   return ref;
 }
 
+bool ReferenceQueue::AtomicDequeuePendingReferences(Thread* self,
+                                                    size_t max_count,
+                                                    ReferenceQueue* chunk) {
+  DCHECK(chunk->IsEmpty());
+  MutexLock mu(self, *lock_);
+  for (size_t i = 0; i != max_count && !IsEmpty(); ++i) {
+    chunk->EnqueueReference(DequeuePendingReference());
+  }
+  return !chunk->IsEmpty();
+}
+
+void ReferenceQueue::AtomicAppend(Thread* self, ReferenceQueue* other) {
+  if (other->IsEmpty()) {
+    return;
+  }
+  MutexLock mu(self, *lock_);
+  if (IsEmpty()) {
+    list_ = other->list_;
+  } else {
+    // Both lists are cyclic, link the last element of each to the head of the other.
+    mirror::Reference* head = list_->GetPendingNext<kWithoutReadBarrier>();
+    list_->SetPendingNext(other->list_->GetPendingNext<kWithoutReadBarrier>());
+    other->list_->SetPendingNext(head);
+  }
+  other->Clear();
+}
+
 void ReferenceQueue::Dump(std::ostream& os) const {
   mirror::Reference* cur = list_;
   os << "Reference starting at list_=" << list_ << "\n";
@@ -112,14 +139,14 @@ void ReferenceQueue::Dump(std::ostream& os) const {
   } while (cur != list_);
 }
 
-size_t ReferenceQueue::GetLength() const {
+size_t ReferenceQueue::GetLength(size_t limit) const {
   size_t count = 0;
   mirror::Reference* cur = list_;
   if (cur != nullptr) {
     do {
       ++count;
       cur = cur->GetPendingNext();
-    } while (cur != list_);
+    } while (cur != list_ && count < limit);
   }
   return count;
 }
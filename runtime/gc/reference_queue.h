@@ -18,6 +18,7 @@
 #define ART_RUNTIME_GC_REFERENCE_QUEUE_H_
 
 #include <iosfwd>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -64,6 +65,15 @@ class ReferenceQueue {
   // Dequeue a reference from the queue and return that dequeued reference.
   mirror::Reference* DequeuePendingReference() SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Move up to max_count references to chunk, which must be empty. Thread safe, used by the tasks
+  // that clear references in parallel. Returns false if there was nothing left to move.
+  bool AtomicDequeuePendingReferences(Thread* self, size_t max_count, ReferenceQueue* chunk)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!*lock_);
+
+  // Move all the references of other to this queue in constant time. Thread safe.
+  void AtomicAppend(Thread* self, ReferenceQueue* other)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!*lock_);
+
   // Enqueues finalizer references with white referents.  White referents are blackened, moved to
   // the zombie field, and the referent field is cleared.
   void EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
@@ -83,7 +93,9 @@ class ReferenceQueue {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void Dump(std::ostream& os) const SHARED_REQUIRES(Locks::mutator_lock_);
-  size_t GetLength() const SHARED_REQUIRES(Locks::mutator_lock_);
+  // Stops counting at limit, so asking whether a queue is long enough does not walk all of it.
+  size_t GetLength(size_t limit = std::numeric_limits<size_t>::max()) const
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   bool IsEmpty() const {
     return list_ == nullptr;
@@ -101,7 +113,8 @@ class ReferenceQueue {
 
  private:
   // Lock, used for parallel GC reference enqueuing. It allows for multiple threads simultaneously
-  // calling AtomicEnqueueIfNotEnqueued.
+  // calling AtomicEnqueueIfNotEnqueued. May be null for queues local to one thread, which only use
+  // the non atomic operations.
   Mutex* const lock_;
   // The actual reference list. Only a root for the mark compact GC since it will be null for other
   // GC types.
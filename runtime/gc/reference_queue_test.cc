@@ -84,5 +84,49 @@ TEST_F(ReferenceQueueTest, Dump) {
   queue.Dump(LOG(INFO));
 }
 
+TEST_F(ReferenceQueueTest, ChunksAndAppend) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<20> hs(self);
+  Mutex lock("Reference queue lock");
+  ReferenceQueue queue(&lock);
+  Mutex cleared_lock("Cleared reference queue lock");
+  ReferenceQueue cleared(&cleared_lock);
+  auto ref_class = hs.NewHandle(
+      Runtime::Current()->GetClassLinker()->FindClass(self, "Ljava/lang/ref/WeakReference;",
+                                                      ScopedNullHandle<mirror::ClassLoader>()));
+  ASSERT_TRUE(ref_class.Get() != nullptr);
+  std::set<mirror::Reference*> refs;
+  std::vector<Handle<mirror::Reference>> handles;
+  for (size_t i = 0; i != 5; ++i) {
+    handles.push_back(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+    ASSERT_TRUE(handles.back().Get() != nullptr);
+    refs.insert(handles.back().Get());
+    queue.EnqueueReference(handles.back().Get());
+  }
+  ASSERT_EQ(queue.GetLength(), 5U);
+  ASSERT_EQ(queue.GetLength(3), 3U);
+
+  ReferenceQueue chunk(nullptr);
+  ASSERT_TRUE(queue.AtomicDequeuePendingReferences(self, 2, &chunk));
+  ASSERT_EQ(chunk.GetLength(), 2U);
+  ASSERT_EQ(queue.GetLength(), 3U);
+  cleared.AtomicAppend(self, &chunk);
+  ASSERT_TRUE(chunk.IsEmpty());
+  ASSERT_EQ(cleared.GetLength(), 2U);
+  ASSERT_TRUE(queue.AtomicDequeuePendingReferences(self, 4, &chunk));
+  ASSERT_EQ(chunk.GetLength(), 3U);
+  ASSERT_TRUE(queue.IsEmpty());
+  cleared.AtomicAppend(self, &chunk);
+  ASSERT_EQ(cleared.GetLength(), 5U);
+  ASSERT_FALSE(queue.AtomicDequeuePendingReferences(self, 4, &chunk));
+
+  std::set<mirror::Reference*> dequeued;
+  while (!cleared.IsEmpty()) {
+    dequeued.insert(cleared.DequeuePendingReference());
+  }
+  ASSERT_EQ(refs, dequeued);
+}
+
 }  // namespace gc
 }  // namespace art
@@ -95,6 +95,50 @@ inline size_t BumpPointerSpace::AllocationSizeNonvirtual(mirror::Object* obj, si
   return num_bytes;
 }
 
+template <typename Visitor>
+inline void BumpPointerSpace::VisitObjectsFrom(uint8_t* start, const Visitor& visitor) {
+  uint8_t* pos = start;
+  uint8_t* end = End();
+  uint8_t* main_end = pos;
+  DCHECK_GE(pos, Begin());
+  DCHECK_LE(pos, end);
+  {
+    MutexLock mu(Thread::Current(), block_lock_);
+    // Same as Walk, with no blocks the main block extends to the end of the space.
+    if (num_blocks_ == 0) {
+      UpdateMainBlock();
+    }
+    main_end = Begin() + main_block_size_;
+    if (num_blocks_ == 0) {
+      end = main_end;
+    }
+  }
+  // Visit the rest of the main block if start is inside of it.
+  while (pos < main_end) {
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+    // No read barrier because obj may not be a valid object.
+    if (obj->GetClass<kDefaultVerifyFlags, kWithoutReadBarrier>() == nullptr) {
+      return;
+    }
+    visitor(obj);
+    pos = reinterpret_cast<uint8_t*>(GetNextObject(obj));
+  }
+  // Otherwise start is at a block header, visit the blocks from there.
+  while (pos < end) {
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(pos);
+    size_t block_size = header->size_;
+    pos += sizeof(BlockHeader);
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+    const mirror::Object* end_obj = reinterpret_cast<const mirror::Object*>(pos + block_size);
+    CHECK_LE(reinterpret_cast<const uint8_t*>(end_obj), End());
+    while (obj < end_obj && obj->GetClass<kDefaultVerifyFlags, kWithoutReadBarrier>() != nullptr) {
+      visitor(obj);
+      obj = GetNextObject(obj);
+    }
+    pos += block_size;
+  }
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
@@ -145,6 +145,12 @@ class BumpPointerSpace FINAL : public ContinuousMemMapAllocSpace {
   void Walk(ObjectCallback* callback, void* arg)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!block_lock_);
 
+  // Visit the objects at or above start, which must be an object or block boundary such as the
+  // End() of a previous point in time. The TLABs must have been revoked.
+  template <typename Visitor>
+  void VisitObjectsFrom(uint8_t* start, const Visitor& visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!block_lock_);
+
   accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() OVERRIDE;
 
   // Record objects / bytes freed.
@@ -16,7 +16,9 @@
 
 #include "image_space.h"
 
+#include <errno.h>
 #include <lz4.h>
+#include <pthread.h>
 #include <random>
 #include <sys/statvfs.h>
 #include <sys/types.h>
@@ -1096,17 +1098,18 @@ static bool RelocateInPlace(ImageHeader& image_header,
           }
         }
       }
-      ArtField** fields = dex_cache->GetResolvedFields();
+      mirror::FieldDexCachePair* fields = dex_cache->GetResolvedFields();
       if (fields != nullptr) {
-        ArtField** new_fields = fixup_adapter.ForwardObject(fields);
+        mirror::FieldDexCachePair* new_fields = fixup_adapter.ForwardObject(fields);
         if (fields != new_fields) {
           dex_cache->SetResolvedFields(new_fields);
         }
         for (size_t j = 0, num = dex_cache->NumResolvedFields(); j != num; ++j) {
-          ArtField* orig = mirror::DexCache::GetElementPtrSize(new_fields, j, pointer_size);
-          ArtField* copy = fixup_adapter.ForwardObject(orig);
-          if (orig != copy) {
-            mirror::DexCache::SetElementPtrSize(new_fields, j, copy, pointer_size);
+          mirror::FieldDexCachePair orig =
+              mirror::DexCache::GetFieldPairPtrSize(new_fields, j, pointer_size);
+          mirror::FieldDexCachePair copy(fixup_adapter.ForwardObject(orig.field), orig.index);
+          if (orig.field != copy.field) {
+            mirror::DexCache::SetFieldPairPtrSize(new_fields, j, copy, pointer_size);
           }
         }
       }
@@ -1159,6 +1162,120 @@ static bool RelocateInPlace(ImageHeader& image_header,
   return true;
 }
 
+// Images smaller than this are decompressed on the calling thread.
+static constexpr size_t kMinParallelDecompressionSize = 4 * MB;
+static constexpr size_t kMaxDecompressionThreads = 4;
+
+// The blocks of a compressed image, shared by the threads decompressing them.
+struct DecompressImageWork {
+  DecompressImageWork(const ImageHeader& header_in, const uint8_t* data_in, uint8_t* image_in)
+      : header(header_in),
+        data(data_in),
+        block_ends(reinterpret_cast<const uint32_t*>(data_in)),
+        image(image_in),
+        num_blocks(header_in.GetNumCompressedBlocks()),
+        next_block(0u),
+        failed_block(num_blocks) {}
+
+  // Returns false if a block is invalid or does not decompress to its size.
+  bool DecompressBlock(size_t i) const {
+    const size_t compressed_begin =
+        (i == 0u) ? num_blocks * sizeof(uint32_t) : block_ends[i - 1u];
+    const size_t compressed_end = block_ends[i];
+    if (compressed_end < compressed_begin || compressed_end > header.GetDataSize()) {
+      return false;
+    }
+    const size_t block_begin = header.CompressedBlockBegin(i);
+    const size_t block_size = header.CompressedBlockEnd(i) - block_begin;
+    // LZ4HC and LZ4 have same internal format, both use LZ4_decompress.
+    const int decompressed_size = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(data) + compressed_begin,
+        reinterpret_cast<char*>(image) + block_begin,
+        compressed_end - compressed_begin,
+        block_size);
+    return decompressed_size >= 0 && static_cast<size_t>(decompressed_size) == block_size;
+  }
+
+  void Run() {
+    while (true) {
+      size_t i = next_block.FetchAndAddSequentiallyConsistent(1u);
+      if (i >= num_blocks) {
+        break;
+      }
+      if (!DecompressBlock(i)) {
+        // Remember the first failing block, for the error message.
+        size_t failed = failed_block.LoadSequentiallyConsistent();
+        while (i < failed && !failed_block.CompareExchangeWeakSequentiallyConsistent(failed, i)) {
+          failed = failed_block.LoadSequentiallyConsistent();
+        }
+      }
+    }
+  }
+
+  static void* Callback(void* arg) {
+    reinterpret_cast<DecompressImageWork*>(arg)->Run();
+    return nullptr;
+  }
+
+  const ImageHeader& header;
+  // The stored data, which starts with the end offsets of the compressed blocks.
+  const uint8_t* const data;
+  const uint32_t* const block_ends;
+  uint8_t* const image;
+  const size_t num_blocks;
+  Atomic<size_t> next_block;
+  // The first block that failed to decompress, `num_blocks` if none.
+  Atomic<size_t> failed_block;
+};
+
+// Decompress the blocks of `image_header` on up to kMaxDecompressionThreads threads, the calling
+// thread included. The blocks are independent, so the threads only share the next block index.
+static bool DecompressImage(const ImageHeader& image_header,
+                            const uint8_t* data,
+                            uint8_t* image,
+                            std::string* error_msg) {
+  static_assert(sizeof(ImageHeader) % sizeof(uint32_t) == 0, "Unaligned compressed block ends");
+  DecompressImageWork work(image_header, data, image);
+  if (image_header.GetDataSize() < work.num_blocks * sizeof(uint32_t)) {
+    *error_msg = StringPrintf("Compressed image data too small for %zu blocks: %" PRIu64,
+                              work.num_blocks,
+                              image_header.GetDataSize());
+    return false;
+  }
+  size_t num_threads = 1u;
+  if (image_header.GetImageSize() >= kMinParallelDecompressionSize) {
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = std::min(kMaxDecompressionThreads, work.num_blocks);
+    if (num_cpus > 0) {
+      num_threads = std::min(num_threads, static_cast<size_t>(num_cpus));
+    }
+  }
+  std::vector<pthread_t> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    pthread_t thread;
+    int rc = pthread_create(&thread, nullptr, &DecompressImageWork::Callback, &work);
+    if (rc != 0) {
+      // The threads already started, or the calling thread, decompress the remaining blocks.
+      errno = rc;
+      PLOG(WARNING) << "Failed to start an image decompression thread";
+      break;
+    }
+    threads.push_back(thread);
+  }
+  work.Run();
+  for (pthread_t thread : threads) {
+    CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "image decompression thread");
+  }
+  size_t failed_block = work.failed_block.LoadRelaxed();
+  if (failed_block != work.num_blocks) {
+    *error_msg = StringPrintf("Failed to decompress image block %zu of %zu",
+                              failed_block,
+                              work.num_blocks);
+    return false;
+  }
+  return true;
+}
+
 static MemMap* LoadImageFile(const char* image_filename,
                              const char* image_location,
                              const ImageHeader& image_header,
@@ -1213,21 +1330,14 @@ static MemMap* LoadImageFile(const char* image_filename,
     }
     memcpy(map->Begin(), &image_header, sizeof(ImageHeader));
     const uint64_t start = NanoTime();
-    // LZ4HC and LZ4 have same internal format, both use LZ4_decompress.
     TimingLogger::ScopedTiming timing2("LZ4 decompress image", &logger);
-    const size_t decompressed_size = LZ4_decompress_safe(
-        reinterpret_cast<char*>(temp_map->Begin()) + sizeof(ImageHeader),
-        reinterpret_cast<char*>(map->Begin()) + decompress_offset,
-        stored_size,
-        map->Size() - decompress_offset);
-    VLOG(image) << "Decompressing image took " << PrettyDuration(NanoTime() - start);
-    if (decompressed_size + sizeof(ImageHeader) != image_header.GetImageSize()) {
-      *error_msg = StringPrintf(
-          "Decompressed size does not match expected image size %zu vs %zu",
-          decompressed_size + sizeof(ImageHeader),
-          image_header.GetImageSize());
+    if (!DecompressImage(image_header,
+                         temp_map->Begin() + decompress_offset,
+                         map->Begin(),
+                         error_msg)) {
       return nullptr;
     }
+    VLOG(image) << "Decompressing image took " << PrettyDuration(NanoTime() - start);
   }
 
   return map.release();
@@ -122,6 +122,11 @@ LargeObjectMapSpace::LargeObjectMapSpace(const std::string& name)
     : LargeObjectSpace(name, nullptr, nullptr),
       lock_("large object map space lock", kAllocSpaceLock) {}
 
+LargeObjectMapSpace::~LargeObjectMapSpace() {
+  MutexLock mu(Thread::Current(), lock_);
+  STLDeleteElements(&freed_maps_);
+}
+
 LargeObjectMapSpace* LargeObjectMapSpace::Create(const std::string& name) {
   if (Runtime::Current()->IsRunningOnMemoryTool()) {
     return new MemoryToolLargeObjectMapSpace(name);
@@ -201,11 +206,26 @@ size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
   size_t allocation_size = map_size;
   num_bytes_allocated_ -= allocation_size;
   --num_objects_allocated_;
-  delete mem_map;
+  // The munmap is done later by ReleaseFreedMemory, outside of the lock.
+  freed_maps_.push_back(mem_map);
   large_objects_.erase(it);
   return allocation_size;
 }
 
+void LargeObjectMapSpace::ReleaseFreedMemory(Thread* self) {
+  std::vector<MemMap*> freed_maps;
+  {
+    MutexLock mu(self, lock_);
+    freed_maps.swap(freed_maps_);
+  }
+  STLDeleteElements(&freed_maps);
+}
+
+bool LargeObjectMapSpace::HasFreedMemoryToRelease(Thread* self) const {
+  MutexLock mu(self, lock_);
+  return !freed_maps_.empty();
+}
+
 size_t LargeObjectMapSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
   MutexLock mu(Thread::Current(), lock_);
   auto it = large_objects_.find(obj);
@@ -457,7 +477,9 @@ size_t FreeListSpace::Free(Thread* self, mirror::Object* obj) {
   --num_objects_allocated_;
   DCHECK_LE(allocation_size, num_bytes_allocated_);
   num_bytes_allocated_ -= allocation_size;
-  madvise(obj, allocation_size, MADV_DONTNEED);
+  // Defer the madvise to ReleaseFreedMemory so that sweeping doesn't pay for it.
+  AddUnreleasedRange(reinterpret_cast<uintptr_t>(obj),
+                     reinterpret_cast<uintptr_t>(obj) + allocation_size);
   if (kIsDebugBuild) {
     // Can't disallow reads since we use them to find next chunks during coalescing.
     mprotect(obj, allocation_size, PROT_READ);
@@ -465,6 +487,76 @@ size_t FreeListSpace::Free(Thread* self, mirror::Object* obj) {
   return allocation_size;
 }
 
+void FreeListSpace::AddUnreleasedRange(uintptr_t begin, uintptr_t end) {
+  DCHECK_LT(begin, end);
+  auto next = unreleased_ranges_.lower_bound(begin);
+  DCHECK(next == unreleased_ranges_.end() || next->first >= end);
+  if (next != unreleased_ranges_.begin()) {
+    auto prev = std::prev(next);
+    DCHECK_LE(prev->second, begin);
+    if (prev->second == begin) {
+      begin = prev->first;
+      unreleased_ranges_.erase(prev);
+    }
+  }
+  if (next != unreleased_ranges_.end() && next->first == end) {
+    end = next->second;
+    unreleased_ranges_.erase(next);
+  }
+  unreleased_ranges_.Put(begin, end);
+}
+
+void FreeListSpace::RemoveUnreleasedRanges(
+    uintptr_t begin, uintptr_t end, std::vector<std::pair<uintptr_t, uintptr_t>>* dirty_ranges) {
+  auto it = unreleased_ranges_.lower_bound(begin);
+  if (it != unreleased_ranges_.begin() && std::prev(it)->second > begin) {
+    --it;
+  }
+  while (it != unreleased_ranges_.end() && it->first < end) {
+    const uintptr_t range_begin = it->first;
+    const uintptr_t range_end = it->second;
+    it = unreleased_ranges_.erase(it);
+    // Keep the parts outside of [begin, end) for the next release.
+    if (range_begin < begin) {
+      unreleased_ranges_.Put(range_begin, begin);
+    }
+    if (range_end > end) {
+      unreleased_ranges_.Put(end, range_end);
+    }
+    dirty_ranges->emplace_back(std::max(range_begin, begin), std::min(range_end, end));
+  }
+}
+
+void FreeListSpace::ReleaseFreedMemory(Thread* self) {
+  // The madvise needs to happen with the lock held since an allocation may otherwise reuse the
+  // range in between. Release in bounded batches so that allocations don't wait for long.
+  static constexpr size_t kReleaseBatchBytes = 4 * MB;
+  bool done = false;
+  while (!done) {
+    MutexLock mu(self, lock_);
+    size_t released_bytes = 0;
+    while (!unreleased_ranges_.empty() && released_bytes < kReleaseBatchBytes) {
+      auto it = unreleased_ranges_.begin();
+      const uintptr_t begin = it->first;
+      const uintptr_t end = it->second;
+      const size_t size = std::min(end - begin, kReleaseBatchBytes - released_bytes);
+      DCHECK_ALIGNED(size, kAlignment);
+      madvise(reinterpret_cast<void*>(begin), size, MADV_DONTNEED);
+      unreleased_ranges_.erase(it);
+      if (begin + size < end) {
+        unreleased_ranges_.Put(begin + size, end);
+      }
+      released_bytes += size;
+    }
+    done = unreleased_ranges_.empty();
+  }
+}
+
+bool FreeListSpace::HasFreedMemoryToRelease(Thread* self) const {
+  MutexLock mu(self, lock_);
+  return !unreleased_ranges_.empty();
+}
+
 size_t FreeListSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
   DCHECK(Contains(obj));
   AllocationInfo* info = GetAllocationInfoForAddress(reinterpret_cast<uintptr_t>(obj));
@@ -478,6 +570,20 @@ size_t FreeListSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
 
 mirror::Object* FreeListSpace::Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                      size_t* usable_size, size_t* bytes_tl_bulk_allocated) {
+  std::vector<std::pair<uintptr_t, uintptr_t>> dirty_ranges;
+  mirror::Object* obj = AllocWithLock(self, num_bytes, bytes_allocated, usable_size,
+                                      bytes_tl_bulk_allocated, &dirty_ranges);
+  // Memory freed since the last ReleaseFreedMemory still holds old contents, zero it outside of
+  // the lock.
+  for (const auto& range : dirty_ranges) {
+    memset(reinterpret_cast<void*>(range.first), 0, range.second - range.first);
+  }
+  return obj;
+}
+
+mirror::Object* FreeListSpace::AllocWithLock(
+    Thread* self, size_t num_bytes, size_t* bytes_allocated, size_t* usable_size,
+    size_t* bytes_tl_bulk_allocated, std::vector<std::pair<uintptr_t, uintptr_t>>* dirty_ranges) {
   MutexLock mu(self, lock_);
   const size_t allocation_size = RoundUp(num_bytes, kAlignment);
   AllocationInfo temp_info;
@@ -528,6 +634,8 @@ mirror::Object* FreeListSpace::Alloc(Thread* self, size_t num_bytes, size_t* byt
   if (kIsDebugBuild) {
     mprotect(obj, allocation_size, PROT_READ | PROT_WRITE);
   }
+  RemoveUnreleasedRanges(reinterpret_cast<uintptr_t>(obj),
+                         reinterpret_cast<uintptr_t>(obj) + allocation_size, dirty_ranges);
   new_info->SetPrevFreeBytes(0);
   new_info->SetByteSize(allocation_size, false);
   return obj;
@@ -104,6 +104,13 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
   // objects.
   virtual void SetAllLargeObjectsAsZygoteObjects(Thread* self) = 0;
 
+  // Free only unlinks objects from the space, the munmap / madvise of their memory is deferred so
+  // that sweeping doesn't pay for it. Returns the freed memory to the OS, normally called from a
+  // heap task after the GC.
+  virtual void ReleaseFreedMemory(Thread* self) = 0;
+  // Return true if there is freed memory which hasn't been given back to the OS yet.
+  virtual bool HasFreedMemoryToRelease(Thread* self) const = 0;
+
  protected:
   explicit LargeObjectSpace(const std::string& name, uint8_t* begin, uint8_t* end);
   static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg);
@@ -138,6 +145,8 @@ class LargeObjectMapSpace : public LargeObjectSpace {
   void Walk(DlMallocSpace::WalkCallback, void* arg) OVERRIDE REQUIRES(!lock_);
   // TODO: disabling thread safety analysis as this may be called when we already hold lock_.
   bool Contains(const mirror::Object* obj) const NO_THREAD_SAFETY_ANALYSIS;
+  void ReleaseFreedMemory(Thread* self) OVERRIDE REQUIRES(!lock_);
+  bool HasFreedMemoryToRelease(Thread* self) const OVERRIDE REQUIRES(!lock_);
 
  protected:
   struct LargeObject {
@@ -145,7 +154,7 @@ class LargeObjectMapSpace : public LargeObjectSpace {
     bool is_zygote;
   };
   explicit LargeObjectMapSpace(const std::string& name);
-  virtual ~LargeObjectMapSpace() {}
+  virtual ~LargeObjectMapSpace();
 
   bool IsZygoteLargeObject(Thread* self, mirror::Object* obj) const OVERRIDE REQUIRES(!lock_);
   void SetAllLargeObjectsAsZygoteObjects(Thread* self) OVERRIDE REQUIRES(!lock_);
@@ -154,6 +163,8 @@ class LargeObjectMapSpace : public LargeObjectSpace {
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   AllocationTrackingSafeMap<mirror::Object*, LargeObject, kAllocatorTagLOSMaps> large_objects_
       GUARDED_BY(lock_);
+  // Maps of freed objects, unmapped by ReleaseFreedMemory.
+  std::vector<MemMap*> freed_maps_ GUARDED_BY(lock_);
 };
 
 // A continuous large object space with a free-list to handle holes.
@@ -171,6 +182,8 @@ class FreeListSpace FINAL : public LargeObjectSpace {
   size_t Free(Thread* self, mirror::Object* obj) OVERRIDE REQUIRES(!lock_);
   void Walk(DlMallocSpace::WalkCallback callback, void* arg) OVERRIDE REQUIRES(!lock_);
   void Dump(std::ostream& os) const REQUIRES(!lock_);
+  void ReleaseFreedMemory(Thread* self) OVERRIDE REQUIRES(!lock_);
+  bool HasFreedMemoryToRelease(Thread* self) const OVERRIDE REQUIRES(!lock_);
 
  protected:
   FreeListSpace(const std::string& name, MemMap* mem_map, uint8_t* begin, uint8_t* end);
@@ -187,8 +200,20 @@ class FreeListSpace FINAL : public LargeObjectSpace {
   uintptr_t GetAddressForAllocationInfo(const AllocationInfo* info) const {
     return GetAllocationAddressForSlot(GetSlotIndexForAllocationInfo(info));
   }
+  mirror::Object* AllocWithLock(Thread* self, size_t num_bytes, size_t* bytes_allocated,
+                                size_t* usable_size, size_t* bytes_tl_bulk_allocated,
+                                std::vector<std::pair<uintptr_t, uintptr_t>>* dirty_ranges)
+      REQUIRES(!lock_);
   // Removes header from the free blocks set by finding the corresponding iterator and erasing it.
   void RemoveFreePrev(AllocationInfo* info) REQUIRES(lock_);
+  // Add the freed range [begin, end) to the ranges waiting to be madvised, coalescing it with its
+  // neighbours.
+  void AddUnreleasedRange(uintptr_t begin, uintptr_t end) REQUIRES(lock_);
+  // Remove the parts of [begin, end) which were never madvised and append them to dirty_ranges,
+  // the caller needs to zero them before handing out the memory.
+  void RemoveUnreleasedRanges(uintptr_t begin, uintptr_t end,
+                              std::vector<std::pair<uintptr_t, uintptr_t>>* dirty_ranges)
+      REQUIRES(lock_);
   bool IsZygoteLargeObject(Thread* self, mirror::Object* obj) const OVERRIDE;
   void SetAllLargeObjectsAsZygoteObjects(Thread* self) OVERRIDE REQUIRES(!lock_);
 
@@ -210,6 +235,10 @@ class FreeListSpace FINAL : public LargeObjectSpace {
   // Free bytes at the end of the space.
   size_t free_end_ GUARDED_BY(lock_);
   FreeBlocks free_blocks_ GUARDED_BY(lock_);
+  // Freed ranges which still need to be madvised, begin -> end. Ranges are coalesced and never
+  // overlap allocated memory.
+  AllocationTrackingSafeMap<uintptr_t, uintptr_t, kAllocatorTagLOSFreeList> unreleased_ranges_
+      GUARDED_BY(lock_);
 };
 
 }  // namespace space
@@ -58,6 +58,10 @@ void LargeObjectSpaceTest::LargeObjectTest() {
         ASSERT_EQ(allocation_size, los->AllocationSize(obj, nullptr));
         ASSERT_GE(allocation_size, request_size);
         ASSERT_EQ(allocation_size, bytes_tl_bulk_allocated);
+        // Reused memory must be zeroed whether or not it was released to the OS.
+        for (size_t k = 0; k < request_size; ++k) {
+          ASSERT_EQ(reinterpret_cast<const uint8_t*>(obj)[k], 0u);
+        }
         // Fill in our magic value.
         uint8_t magic = (request_size & 0xFF) | 1;
         memset(obj, magic, request_size);
@@ -96,6 +100,12 @@ void LargeObjectSpaceTest::LargeObjectTest() {
         }
         ASSERT_GE(los->Free(Thread::Current(), obj), request_size);
       }
+      // Give the first phase frees back to the OS, keep the second phase ones unreleased.
+      if (phase == 0) {
+        EXPECT_TRUE(los->HasFreedMemoryToRelease(self));
+        los->ReleaseFreedMemory(self);
+        EXPECT_FALSE(los->HasFreedMemoryToRelease(self));
+      }
     }
     // Test that dump doesn't crash.
     los->Dump(LOG(INFO));
@@ -19,6 +19,10 @@
 
 #include "region_space.h"
 
+#include "gc/accounting/card_table-inl.h"
+#include "gc/accounting/space_bitmap-inl.h"
+#include "thread-inl.h"
+
 namespace art {
 namespace gc {
 namespace space {
@@ -256,6 +260,113 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   }
 }
 
+template <typename Visitor>
+void RegionSpace::VisitToSpaceObjectsOnDirtyCards(accounting::CardTable* card_table,
+                                                  const Visitor& visitor) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (r->IsFree() || r->IsLargeTail() || !r->IsInToSpace()) {
+      continue;
+    }
+    if (r->IsLarge()) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(r->Begin());
+      if (card_table->IsDirty(obj) &&
+          obj->GetClass<kVerifyNone, kWithoutReadBarrier>() != nullptr) {
+        visitor(obj);
+      }
+      continue;
+    }
+    // Skip the walk if none of the cards of the region are dirty.
+    uint8_t* card = card_table->CardFromAddr(r->Begin());
+    uint8_t* card_end =
+        card_table->CardFromAddr(AlignUp(r->Top(), accounting::CardTable::kCardSize));
+    while (card < card_end && *card != accounting::CardTable::kCardDirty) {
+      ++card;
+    }
+    if (card == card_end) {
+      continue;
+    }
+    // Objects may span cards, so walk the region from the beginning.
+    uint8_t* pos = r->Begin();
+    uint8_t* top = r->Top();
+    while (pos < top) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+      if (obj->GetClass<kVerifyNone, kWithoutReadBarrier>() == nullptr) {
+        break;
+      }
+      size_t obj_size = obj->SizeOf<kVerifyNone, kWithoutReadBarrier>();
+      if (card_table->IsDirty(obj)) {
+        visitor(obj);
+      }
+      pos += RoundUp(obj_size, kAlignment);
+    }
+  }
+}
+
+template <typename Visitor>
+void RegionSpace::VisitDeadObjectRunsInUnevacFromSpace(accounting::ContinuousSpaceBitmap* bitmap,
+                                                       const Visitor& visitor) {
+  // Only the GC thread changes the region types while the GC is running, so no lock is needed.
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (!r->IsInUnevacFromSpace() || r->IsLargeTail()) {
+      continue;
+    }
+    if (r->IsLarge()) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(r->Begin());
+      if (!bitmap->Test(obj)) {
+        visitor(obj, RoundUp(r->BytesAllocated(), kAlignment));
+      }
+      continue;
+    }
+    uint8_t* pos = r->Begin();
+    uint8_t* top = r->Top();
+    uint8_t* dead_begin = nullptr;
+    while (pos < top) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+      if (obj->GetClass<kVerifyNone, kWithoutReadBarrier>() == nullptr) {
+        break;
+      }
+      if (bitmap->Test(obj)) {
+        if (dead_begin != nullptr) {
+          visitor(reinterpret_cast<mirror::Object*>(dead_begin), pos - dead_begin);
+          dead_begin = nullptr;
+        }
+      } else if (dead_begin == nullptr) {
+        dead_begin = pos;
+      }
+      pos += RoundUp(obj->SizeOf<kVerifyNone, kWithoutReadBarrier>(), kAlignment);
+    }
+    if (dead_begin != nullptr) {
+      visitor(reinterpret_cast<mirror::Object*>(dead_begin), pos - dead_begin);
+    }
+  }
+}
+
+inline size_t RegionSpace::ComputeTlabExpansion(Thread* self, size_t alloc_size) {
+  if (!self->HasTlab()) {
+    return 0;
+  }
+  DCHECK_ALIGNED(self->GetTlabStart(), kRegionSize);
+  size_t remaining_in_region = self->GetTlabStart() + kRegionSize - self->GetTlabEnd();
+  // The remaining TLAB bytes are still usable, so only the shortfall has to be added.
+  size_t needed = alloc_size - self->TlabSize();
+  if (needed > remaining_in_region) {
+    return 0;
+  }
+  size_t chunk = std::max(2 * self->GetTlabChunkSize(), kMinTlabChunkSize);
+  chunk = std::max(chunk, RoundUp(needed, kAlignment));
+  return std::min(chunk, remaining_in_region);
+}
+
+inline size_t RegionSpace::ComputeNewTlabSize(Thread* self, size_t alloc_size) {
+  DCHECK_LE(alloc_size, kRegionSize);
+  size_t tlab_size = std::max(self->GetTlabChunkSize() / 2, kMinTlabChunkSize);
+  tlab_size = std::max(tlab_size, alloc_size);
+  return std::min(tlab_size, kRegionSize);
+}
+
 inline mirror::Object* RegionSpace::GetNextObject(mirror::Object* obj) {
   const uintptr_t position = reinterpret_cast<uintptr_t>(obj) + obj->SizeOf();
   return reinterpret_cast<mirror::Object*>(RoundUp(position, kAlignment));
@@ -115,14 +115,16 @@ size_t RegionSpace::ToSpaceSize() {
   return num_regions * kRegionSize;
 }
 
-inline bool RegionSpace::Region::ShouldBeEvacuated() {
+inline bool RegionSpace::Region::ShouldBeEvacuated(EvacMode evac_mode) {
   DCHECK((IsAllocated() || IsLarge()) && IsInToSpace());
   // if the region was allocated after the start of the
   // previous GC or the live ratio is below threshold, evacuate
   // it.
   bool result;
-  if (is_newly_allocated_) {
+  if (evac_mode == EvacMode::kEvacModeForceAll || is_newly_allocated_) {
     result = true;
+  } else if (evac_mode == EvacMode::kEvacModeNewlyAllocated) {
+    result = false;
   } else {
     bool is_live_percent_valid = live_bytes_ != static_cast<size_t>(-1);
     if (is_live_percent_valid) {
@@ -150,7 +152,7 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
 
 // Determine which regions to evacuate and mark them as
 // from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, EvacMode evac_mode) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -169,10 +171,14 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        // The pinned regions have objects accessed by native code, their tails follow them.
+        bool should_evacuate = !r->IsPinned() && r->ShouldBeEvacuated(evac_mode);
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
+        } else if (evac_mode == EvacMode::kEvacModeNewlyAllocated) {
+          // An old region in a young-generation collection. Keep it in the to-space.
+          DCHECK(r->IsInToSpace());
         } else {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
@@ -189,6 +195,8 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         if (prev_large_evacuated) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
+        } else if (evac_mode == EvacMode::kEvacModeNewlyAllocated) {
+          DCHECK(r->IsInToSpace());
         } else {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
@@ -326,7 +334,21 @@ void RegionSpace::RecordAlloc(mirror::Object* ref) {
   reinterpret_cast<Atomic<uint64_t>*>(&r->objects_allocated_)->FetchAndAddSequentiallyConsistent(1);
 }
 
-bool RegionSpace::AllocNewTlab(Thread* self) {
+void RegionSpace::PinObject(mirror::Object* ref) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  Region* r = RefToRegionLocked(ref);
+  DCHECK(!r->IsInFromSpace()) << ref;
+  ++r->pin_count_;
+}
+
+void RegionSpace::UnpinObject(mirror::Object* ref) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  Region* r = RefToRegionLocked(ref);
+  DCHECK(r->IsPinned()) << ref;
+  --r->pin_count_;
+}
+
+bool RegionSpace::AllocNewTlab(Thread* self, size_t tlab_size) {
   MutexLock mu(self, region_lock_);
   RevokeThreadLocalBuffersLocked(self);
   // Retain sufficient free regions for full evacuation.
@@ -338,18 +360,35 @@ bool RegionSpace::AllocNewTlab(Thread* self) {
     if (r->IsFree()) {
       r->Unfree(time_);
       ++num_non_free_regions_;
-      // TODO: this is buggy. Debug it.
-      // r->SetNewlyAllocated();
-      r->SetTop(r->End());
+      r->SetNewlyAllocated();
+      DCHECK_LE(tlab_size, kRegionSize);
+      // The top tracks the bytes handed to the TLAB so far. The rest of the region stays reserved
+      // for the thread.
+      r->SetTop(r->Begin() + tlab_size);
       r->is_a_tlab_ = true;
       r->thread_ = self;
-      self->SetTlab(r->Begin(), r->End());
+      self->SetTlab(r->Begin(), r->Begin() + tlab_size);
+      self->SetTlabChunkSize(tlab_size);
       return true;
     }
   }
   return false;
 }
 
+void RegionSpace::ExpandTlab(Thread* self, size_t expand_bytes) {
+  // The rest of the region is reserved for the thread and only the thread moves the top while it
+  // owns the TLAB, revoking the TLAB needs the thread suspended or running the checkpoint. So this
+  // does not need region_lock_, and medium sized allocations that fit in the region don't take it.
+  Region* r = RefToRegionUnlocked(reinterpret_cast<mirror::Object*>(self->GetTlabStart()));
+  DCHECK(r->is_a_tlab_);
+  DCHECK_EQ(r->thread_, self);
+  DCHECK_EQ(r->Top(), self->GetTlabEnd());
+  DCHECK_LE(r->Top() + expand_bytes, r->End());
+  r->SetTop(r->Top() + expand_bytes);
+  self->ExpandTlab(expand_bytes);
+  self->SetTlabChunkSize(expand_bytes);
+}
+
 size_t RegionSpace::RevokeThreadLocalBuffers(Thread* thread) {
   MutexLock mu(Thread::Current(), region_lock_);
   RevokeThreadLocalBuffersLocked(thread);
@@ -363,7 +402,7 @@ void RegionSpace::RevokeThreadLocalBuffersLocked(Thread* thread) {
     DCHECK_ALIGNED(tlab_start, kRegionSize);
     Region* r = RefToRegionLocked(reinterpret_cast<mirror::Object*>(tlab_start));
     DCHECK(r->IsAllocated());
-    DCHECK_EQ(thread->GetThreadLocalBytesAllocated(), kRegionSize);
+    DCHECK_LE(thread->GetThreadLocalBytesAllocated(), kRegionSize);
     r->RecordThreadLocalAllocations(thread->GetThreadLocalObjectsAllocated(),
                                     thread->GetThreadLocalBytesAllocated());
     r->is_a_tlab_ = false;
@@ -24,6 +24,11 @@
 
 namespace art {
 namespace gc {
+
+namespace accounting {
+class CardTable;
+}  // namespace accounting
+
 namespace space {
 
 // A space that consists of equal-sized regions.
@@ -169,6 +174,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   static constexpr size_t kAlignment = kObjectAlignment;
   // The region size.
   static constexpr size_t kRegionSize = 1 * MB;
+  // The smallest chunk of a region handed out to a TLAB. A thread's TLAB starts at the beginning
+  // of a region and grows in chunks until it covers the whole region.
+  static constexpr size_t kMinTlabChunkSize = 16 * KB;
 
   bool IsInFromSpace(mirror::Object* ref) {
     if (HasAddress(ref)) {
@@ -202,9 +210,34 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Which regions SetFromSpace() turns into from-space (evacuated) regions.
+  enum class EvacMode {
+    // Only the regions allocated since the previous GC, used by young-generation collections.
+    // The other regions stay in the to-space.
+    kEvacModeNewlyAllocated,
+    // The newly allocated regions and those whose live ratio is below the threshold. The other
+    // regions become unevacuated from-space regions.
+    kEvacModeLivePercentNewlyAllocated,
+    // All non-free regions.
+    kEvacModeForceAll,
+  };
+
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table, EvacMode evac_mode)
       REQUIRES(!region_lock_);
 
+  // Visit the objects in the non-free to-space regions whose headers lie on dirty cards. Must be
+  // called with the mutators suspended.
+  template <typename Visitor>
+  void VisitToSpaceObjectsOnDirtyCards(accounting::CardTable* card_table, const Visitor& visitor)
+      NO_THREAD_SAFETY_ANALYSIS;
+
+  // Call visitor(begin, byte_size) for each maximal run of objects in the unevacuated from-space
+  // regions that are not marked in the given bitmap.
+  template <typename Visitor>
+  void VisitDeadObjectRunsInUnevacFromSpace(accounting::ContinuousSpaceBitmap* bitmap,
+                                            const Visitor& visitor)
+      NO_THREAD_SAFETY_ANALYSIS;
+
   size_t FromSpaceSize() REQUIRES(!region_lock_);
   size_t UnevacFromSpaceSize() REQUIRES(!region_lock_);
   size_t ToSpaceSize() REQUIRES(!region_lock_);
@@ -227,7 +260,23 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   }
 
   void RecordAlloc(mirror::Object* ref) REQUIRES(!region_lock_);
-  bool AllocNewTlab(Thread* self) REQUIRES(!region_lock_);
+
+  // Keep the region of the object, or the first region of a large object, from being evacuated
+  // until it is unpinned, so that native code can access the object in place. Must be called
+  // with a to-space reference, and while runnable so that no flip happens in between.
+  void PinObject(mirror::Object* ref) REQUIRES(!region_lock_);
+  void UnpinObject(mirror::Object* ref) REQUIRES(!region_lock_);
+  // Hand a free region to the thread with a TLAB of tlab_size bytes at its beginning.
+  bool AllocNewTlab(Thread* self, size_t tlab_size) REQUIRES(!region_lock_);
+  // Extend the thread's TLAB by expand_bytes within its region. Lock free.
+  void ExpandTlab(Thread* self, size_t expand_bytes) REQUIRES(!region_lock_);
+  // Returns how many bytes to extend the thread's TLAB by so that alloc_size bytes fit, or 0 if
+  // the rest of its region is too small. The chunk doubles on every expansion so that threads
+  // that allocate quickly refill less often.
+  ALWAYS_INLINE size_t ComputeTlabExpansion(Thread* self, size_t alloc_size);
+  // Returns the TLAB size for a thread moving to a new region. It starts at half of the thread's
+  // last chunk so that threads that slowed down give back memory.
+  ALWAYS_INLINE size_t ComputeNewTlabSize(Thread* self, size_t alloc_size);
 
   uint32_t Time() {
     return time_;
@@ -246,13 +295,13 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr), pin_count_(0u) {}
 
     Region(size_t idx, uint8_t* begin, uint8_t* end)
         : idx_(idx), begin_(begin), top_(begin), end_(end),
           state_(RegionState::kRegionStateFree), type_(RegionType::kRegionTypeNone),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {
+          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr), pin_count_(0u) {
       DCHECK_LT(begin, end);
       DCHECK_EQ(static_cast<size_t>(end - begin), kRegionSize);
     }
@@ -279,6 +328,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       is_newly_allocated_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
+      pin_count_ = 0u;
     }
 
     ALWAYS_INLINE mirror::Object* Alloc(size_t num_bytes, size_t* bytes_allocated,
@@ -381,13 +431,18 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       type_ = RegionType::kRegionTypeToSpace;
     }
 
-    ALWAYS_INLINE bool ShouldBeEvacuated();
+    ALWAYS_INLINE bool ShouldBeEvacuated(EvacMode evac_mode);
+
+    bool IsPinned() const {
+      return pin_count_ != 0u;
+    }
 
     void AddLiveBytes(size_t live_bytes) {
       DCHECK(IsInUnevacFromSpace());
       DCHECK(!IsLargeTail());
       DCHECK_NE(live_bytes_, static_cast<size_t>(-1));
-      live_bytes_ += live_bytes;
+      // Parallel marking threads may add concurrently.
+      reinterpret_cast<Atomic<size_t>*>(&live_bytes_)->FetchAndAddRelaxed(live_bytes);
       DCHECK_LE(live_bytes_, BytesAllocated());
     }
 
@@ -451,10 +506,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     void RecordThreadLocalAllocations(size_t num_objects, size_t num_bytes) {
       DCHECK(IsAllocated());
       DCHECK_EQ(objects_allocated_, 0U);
-      DCHECK_EQ(top_, end_);
+      DCHECK_LE(begin_ + num_bytes, top_);
       objects_allocated_ = num_objects;
       top_ = begin_ + num_bytes;
-      DCHECK_EQ(top_, end_);
     }
 
    private:
@@ -471,6 +525,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     bool is_newly_allocated_;      // True if it's allocated after the last collection.
     bool is_a_tlab_;               // True if it's a tlab.
     Thread* thread_;               // The owning thread if it's a tlab.
+    size_t pin_count_;             // The number of critical JNI accesses to its objects.
 
     friend class RegionSpace;
   };
@@ -38,6 +38,9 @@ static constexpr size_t kPrefetchLookAhead = 8;
 // Use this only for verification, it is not safe to use since the class of the object may have
 // been freed.
 static constexpr bool kVerifyFreedBytes = false;
+// If true, FreeList() frees through a RosAlloc::FreeMagazine instead of RosAlloc::BulkFree(),
+// which lets concurrent sweeping threads free without serializing on the bulk free lock.
+static constexpr bool kUseFreeMagazineInFreeList = true;
 
 // TODO: Fix
 // template class MemoryToolMallocSpace<RosAllocSpace, allocator::RosAlloc*>;
@@ -234,7 +237,16 @@ size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** p
     CHECK_EQ(num_broken_ptrs, 0u);
   }
 
-  const size_t bytes_freed = rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
+  size_t bytes_freed = 0;
+  if (kUseFreeMagazineInFreeList) {
+    allocator::RosAlloc::FreeMagazine magazine(self, rosalloc_);
+    for (size_t i = 0; i < num_ptrs; i++) {
+      bytes_freed += magazine.Add(self, ptrs[i]);
+    }
+    magazine.Flush(self);
+  } else {
+    bytes_freed = rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
+  }
   if (kVerifyFreedBytes) {
     CHECK_EQ(verify_bytes, bytes_freed);
   }
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "gc/allocator/rosalloc.h"
+#include "rosalloc_space.h"
+#include "space_test.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+class RosAllocSpaceTest : public SpaceTest<CommonRuntimeTest> {};
+
+TEST_F(RosAllocSpaceTest, FreeMagazine) {
+  MallocSpace* space = RosAllocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, nullptr,
+                                             Runtime::Current()->GetHeap()->IsLowMemoryMode(),
+                                             false);
+  ASSERT_TRUE(space != nullptr);
+  // Make space findable to the heap, will also delete space when runtime is cleaned up
+  AddSpace(space);
+  allocator::RosAlloc* rosalloc = space->AsRosAllocSpace()->GetRosAlloc();
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  const uint64_t objects_before = space->GetObjectsAllocated();
+
+  // Fill the buffer of each small size bracket several times. The large objects are freed right
+  // away rather than buffered.
+  const size_t sizes[] = { SizeOfZeroLengthByteArray(), 64, 200, 1000, 4 * KB };
+  const size_t num_per_size = 4 * allocator::RosAlloc::FreeMagazine::kMagazineSize + 1;
+  std::vector<mirror::Object*> objects;
+  for (size_t i = 0; i < num_per_size; ++i) {
+    for (size_t size : sizes) {
+      size_t bytes_allocated, usable_size, bytes_tl_bulk_allocated;
+      mirror::Object* obj =
+          Alloc(space, self, size, &bytes_allocated, &usable_size, &bytes_tl_bulk_allocated);
+      ASSERT_TRUE(obj != nullptr);
+      objects.push_back(obj);
+    }
+  }
+  EXPECT_EQ(objects_before + objects.size(), space->GetObjectsAllocated());
+
+  // Free the objects through two magazines in turn, the second one reuses the buffer.
+  const size_t half = objects.size() / 2;
+  for (size_t begin : { static_cast<size_t>(0), half }) {
+    const size_t end = (begin == 0) ? half : objects.size();
+    size_t expected_bytes_freed = 0;
+    size_t bytes_freed = 0;
+    {
+      allocator::RosAlloc::FreeMagazine magazine(self, rosalloc);
+      for (size_t i = begin; i < end; ++i) {
+        expected_bytes_freed += space->AllocationSize(objects[i], nullptr);
+        bytes_freed += magazine.Add(self, objects[i]);
+      }
+      magazine.Flush(self);
+    }
+    EXPECT_EQ(expected_bytes_freed, bytes_freed);
+  }
+  EXPECT_EQ(objects_before, space->GetObjectsAllocated());
+
+  // The freed slots can be allocated again.
+  for (size_t i = 0; i < objects.size(); ++i) {
+    size_t bytes_allocated, usable_size, bytes_tl_bulk_allocated;
+    objects[i] = Alloc(space, self, sizes[i % arraysize(sizes)], &bytes_allocated, &usable_size,
+                       &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(objects[i] != nullptr);
+  }
+  space->FreeList(self, objects.size(), objects.data());
+  EXPECT_EQ(objects_before, space->GetObjectsAllocated());
+}
+
+TEST_F(RosAllocSpaceTest, PageReleaseGranularity) {
+  MallocSpace* space = RosAllocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, nullptr,
+                                             /* low_memory_mode */ false, false);
+  ASSERT_TRUE(space != nullptr);
+  // Make space findable to the heap, will also delete space when runtime is cleaned up
+  AddSpace(space);
+  allocator::RosAlloc* rosalloc = space->AsRosAllocSpace()->GetRosAlloc();
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+
+  // No chunk aligned to twice the capacity fits in the space, so nothing may be released, neither
+  // when the large objects are freed nor by ReleasePages.
+  rosalloc->SetPageReleaseGranularity(32 * MB);
+  std::vector<mirror::Object*> objects;
+  for (size_t i = 0; i < 8; ++i) {
+    size_t bytes_allocated, usable_size, bytes_tl_bulk_allocated;
+    mirror::Object* obj =
+        Alloc(space, self, 256 * KB, &bytes_allocated, &usable_size, &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(obj != nullptr);
+    objects.push_back(obj);
+  }
+  space->FreeList(self, objects.size(), objects.data());
+  EXPECT_EQ(0u, rosalloc->ReleasePages());
+
+  // The free pages were kept, they are released once the granularity allows it.
+  rosalloc->SetPageReleaseGranularity(kPageSize);
+  EXPECT_GT(rosalloc->ReleasePages(), 0u);
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
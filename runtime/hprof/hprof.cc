@@ -28,16 +28,20 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include <set>
 
 #include "art_field-inl.h"
+#include "base/casts.h"
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "base/time_utils.h"
@@ -61,6 +65,7 @@
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
 #include "thread_list.h"
+#include "utils.h"
 
 namespace art {
 
@@ -379,6 +384,11 @@ class FileEndianOutput FINAL : public EndianOutputBuffered {
     return errors_;
   }
 
+  // Returns true if all the records were written.
+  bool Finish() {
+    return !errors_;
+  }
+
  protected:
   void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
     if (!errors_) {
@@ -391,6 +401,75 @@ class FileEndianOutput FINAL : public EndianOutputBuffered {
   bool errors_;
 };
 
+// Writes the records to the file in the gzip format. Finish must be called after the last one.
+class GzipFileEndianOutput FINAL : public EndianOutputBuffered {
+ public:
+  GzipFileEndianOutput(File* fp, size_t reserved_size)
+      : EndianOutputBuffered(reserved_size),
+        fp_(fp),
+        out_buffer_(new uint8_t[kOutBufferSize]),
+        errors_(false) {
+    DCHECK(fp != nullptr);
+    memset(&stream_, 0, sizeof(stream_));
+    // Adding 16 to the window bits selects the gzip format. Favor speed, the heap is large and
+    // mostly made of object references that compress well anyway.
+    initialized_ = deflateInit2(&stream_,
+                                Z_BEST_SPEED,
+                                Z_DEFLATED,
+                                16 + MAX_WBITS,
+                                /* memLevel */ 8,
+                                Z_DEFAULT_STRATEGY) == Z_OK;
+    errors_ = !initialized_;
+  }
+  ~GzipFileEndianOutput() {
+    if (initialized_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  // Writes the end of the compressed stream. Returns true if all the records were written.
+  bool Finish() {
+    Deflate(nullptr, 0u, Z_FINISH);
+    return !errors_;
+  }
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    Deflate(buffer, length, Z_NO_FLUSH);
+  }
+
+ private:
+  static constexpr size_t kOutBufferSize = 64 * KB;
+
+  void Deflate(const uint8_t* buffer, size_t length, int flush) {
+    if (errors_) {
+      return;
+    }
+    stream_.next_in = const_cast<Bytef*>(buffer);
+    stream_.avail_in = dchecked_integral_cast<uInt>(length);
+    // Deflate until zlib stops filling the output buffer, it then consumed all the input.
+    do {
+      stream_.next_out = out_buffer_.get();
+      stream_.avail_out = kOutBufferSize;
+      if (deflate(&stream_, flush) == Z_STREAM_ERROR) {
+        errors_ = true;
+        return;
+      }
+      size_t compressed_length = kOutBufferSize - stream_.avail_out;
+      if (compressed_length != 0u && !fp_->WriteFully(out_buffer_.get(), compressed_length)) {
+        errors_ = true;
+        return;
+      }
+    } while (stream_.avail_out == 0u);
+  }
+
+  File* fp_;
+  z_stream stream_;
+  std::unique_ptr<uint8_t[]> out_buffer_;
+  bool initialized_;
+  bool errors_;
+};
+
 class NetStateEndianOutput FINAL : public EndianOutputBuffered {
  public:
   NetStateEndianOutput(JDWP::JdwpNetStateBase* net_state, size_t reserved_size)
@@ -416,14 +495,16 @@ class NetStateEndianOutput FINAL : public EndianOutputBuffered {
 
 class Hprof : public SingleRootVisitor {
  public:
-  Hprof(const char* output_filename, int fd, bool direct_to_ddms)
+  Hprof(const char* output_filename, int fd, bool direct_to_ddms, bool in_forked_process)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        in_forked_process_(in_forked_process) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
-  void Dump()
+  // Returns true if the dump was written.
+  bool Dump()
     REQUIRES(Locks::mutator_lock_)
     REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
     {
@@ -463,6 +544,7 @@ class Hprof : public SingleRootVisitor {
                 << " objects " << total_objects_
                 << " objects with stack traces " << total_objects_with_stack_trace_;
     }
+    return okay;
   }
 
  private:
@@ -741,32 +823,28 @@ class Hprof : public SingleRootVisitor {
     if (fd_ >= 0) {
       out_fd = dup(fd_);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
+        ReportError(StringPrintf("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno)));
         return false;
       }
     } else {
       out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
-                              strerror(errno));
+        ReportError(StringPrintf("Couldn't dump heap; open(\"%s\") failed: %s",
+                                 filename_.c_str(),
+                                 strerror(errno)));
         return false;
       }
     }
 
     std::unique_ptr<File> file(new File(out_fd, filename_, true));
     bool okay;
-    {
+    // The ".gz" suffix also applies when writing to fd_, the name then describes its content.
+    if (EndsWith(filename_, ".gz")) {
+      GzipFileEndianOutput file_output(file.get(), max_length);
+      okay = WriteToFileOutput(&file_output, overall_size);
+    } else {
       FileEndianOutput file_output(file.get(), max_length);
-      output_ = &file_output;
-      ProcessHeap(true);
-      okay = !file_output.Errors();
-
-      if (okay) {
-        // Check for expected size. Output is expected to be less-or-equal than first phase, see
-        // b/23521263.
-        DCHECK_LE(file_output.SumLength(), overall_size);
-      }
-      output_ = nullptr;
+      okay = WriteToFileOutput(&file_output, overall_size);
     }
 
     if (okay) {
@@ -775,15 +853,37 @@ class Hprof : public SingleRootVisitor {
       file->Erase();
     }
     if (!okay) {
-      std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
-                                   filename_.c_str(), strerror(errno)));
-      ThrowRuntimeException("%s", msg.c_str());
-      LOG(ERROR) << msg;
+      ReportError(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
+                               filename_.c_str(), strerror(errno)));
     }
 
     return okay;
   }
 
+  template <typename FileOutput>
+  bool WriteToFileOutput(FileOutput* file_output, size_t overall_size)
+      REQUIRES(Locks::mutator_lock_) {
+    output_ = file_output;
+    ProcessHeap(true);
+    bool okay = file_output->Finish();
+    if (okay) {
+      // Check for expected size. Output is expected to be less-or-equal than first phase, see
+      // b/23521263.
+      DCHECK_LE(file_output->SumLength(), overall_size);
+    }
+    output_ = nullptr;
+    return okay;
+  }
+
+  void ReportError(const std::string& msg) REQUIRES(Locks::mutator_lock_) {
+    // A forked process only has this thread and exits after the dump, it must not allocate
+    // an exception that could need a GC. The parent reports its exit status instead.
+    if (!in_forked_process_) {
+      ThrowRuntimeException("%s", msg.c_str());
+    }
+    LOG(ERROR) << msg;
+  }
+
   bool DumpToDdmsDirect(size_t overall_size, size_t max_length, uint32_t chunk_type)
       REQUIRES(Locks::mutator_lock_) {
     CHECK(direct_to_ddms_);
@@ -861,6 +961,8 @@ class Hprof : public SingleRootVisitor {
   std::string filename_;
   int fd_;
   bool direct_to_ddms_;
+  // Whether the dump runs in a process forked by DumpHeap.
+  bool in_forked_process_;
 
   uint64_t start_ns_ = NanoTime();
 
@@ -1407,24 +1509,51 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
+// If "filename" ends with ".gz", the output is compressed in the gzip format.
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
   CHECK(filename != nullptr);
 
   Thread* self = Thread::Current();
-  gc::Heap* heap = Runtime::Current()->GetHeap();
+  Runtime* const runtime = Runtime::Current();
+  gc::Heap* heap = runtime->GetHeap();
   if (heap->IsGcConcurrentAndMoving()) {
     // Need to take a heap dump while GC isn't running. See the
     // comment in Heap::VisitObjects().
     heap->IncrementDisableMovingGC(self);
   }
+  pid_t child_pid = -1;
   {
     ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
-    Hprof hprof(filename, fd, direct_to_ddms);
-    hprof.Dump();
+    if (!direct_to_ddms && runtime->ShouldForkHeapDumps()) {
+      // The child gets a copy of the suspended heap and only this thread. It writes the dump
+      // while the other threads of the parent resume, and exits without running destructors.
+      child_pid = fork();
+      if (child_pid == 0) {
+        Hprof hprof(filename, fd, direct_to_ddms, /* in_forked_process */ true);
+        _exit(hprof.Dump() ? EXIT_SUCCESS : EXIT_FAILURE);
+      } else if (child_pid < 0) {
+        PLOG(WARNING) << "hprof: fork failed, dumping the heap with all threads suspended";
+      }
+    }
+    if (child_pid < 0) {
+      Hprof hprof(filename, fd, direct_to_ddms, /* in_forked_process */ false);
+      hprof.Dump();
+    }
   }
   if (heap->IsGcConcurrentAndMoving()) {
     heap->DecrementDisableMovingGC(self);
   }
+  if (child_pid > 0) {
+    // Only this thread waits for the dump to be written.
+    int status;
+    if (TEMP_FAILURE_RETRY(waitpid(child_pid, &status, 0)) != child_pid ||
+        !WIFEXITED(status) ||
+        WEXITSTATUS(status) != EXIT_SUCCESS) {
+      ScopedObjectAccess soa(self);
+      ThrowRuntimeException("Couldn't dump heap; the heap dump process %d failed",
+                            static_cast<int>(child_pid));
+    }
+  }
 }
 
 }  // namespace hprof
@@ -19,6 +19,9 @@
 
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/bit_utils.h"
 #include "base/enums.h"
 #include "globals.h"
 #include "mirror/object.h"
@@ -271,6 +274,26 @@ class PACKED(4) ImageHeader {
     return data_size_;
   }
 
+  // Compressed images store the image data, which excludes the header, as blocks compressed
+  // independently, so that they can be decompressed on several threads. Block `i` holds the
+  // image bytes from CompressedBlockBegin(i) to CompressedBlockEnd(i), which are page aligned
+  // except for the start of the first block. The stored data starts with the end offsets of the
+  // compressed blocks in the stored data, one uint32_t per block, followed by the blocks.
+  static constexpr size_t kCompressedBlockSize = 256 * KB;
+  static_assert(IsAligned<kPageSize>(kCompressedBlockSize), "Unaligned compressed block size");
+
+  size_t GetNumCompressedBlocks() const {
+    return RoundUp(image_size_, kCompressedBlockSize) / kCompressedBlockSize;
+  }
+
+  size_t CompressedBlockBegin(size_t i) const {
+    return (i == 0u) ? sizeof(ImageHeader) : i * kCompressedBlockSize;
+  }
+
+  size_t CompressedBlockEnd(size_t i) const {
+    return std::min<size_t>((i + 1u) * kCompressedBlockSize, image_size_);
+  }
+
   bool IsAppImage() const {
     // App images currently require a boot image, if the size is non zero then it is an app image
     // header.
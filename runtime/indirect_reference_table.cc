@@ -32,6 +32,8 @@ namespace art {
 
 static constexpr bool kDumpStackOnNonLocalReference = false;
 
+constexpr size_t IndirectReferenceTable::kMaxStripes;
+
 template<typename T>
 class MutatorLockedDumpable {
  public:
@@ -69,10 +71,13 @@ void IndirectReferenceTable::AbortIfNoCheckJNI() {
 
 IndirectReferenceTable::IndirectReferenceTable(size_t initialCount,
                                                size_t maxCount, IndirectRefKind desiredKind,
-                                               bool abort_on_error)
+                                               bool abort_on_error,
+                                               size_t stripe)
     : kind_(desiredKind),
-      max_entries_(maxCount) {
+      max_entries_(maxCount),
+      stripe_(stripe) {
   CHECK_GT(initialCount, 0U);
+  CHECK_LT(stripe, kMaxStripes);
   CHECK_LE(initialCount, maxCount);
   CHECK_NE(desiredKind, kHandleScopeOrInvalid);
 
@@ -102,7 +107,7 @@ bool IndirectReferenceTable::IsValid() const {
   return table_mem_map_.get() != nullptr;
 }
 
-IndirectRef IndirectReferenceTable::Add(uint32_t cookie, mirror::Object* obj) {
+IndirectRef IndirectReferenceTable::AddSlowPath(uint32_t cookie, mirror::Object* obj) {
   IRTSegmentState prevState;
   prevState.all = cookie;
   size_t topIndex = segment_state_.parts.topIndex;
@@ -170,7 +175,7 @@ void IndirectReferenceTable::AssertEmpty() {
 // This method is not called when a local frame is popped; this is only used
 // for explicit single removals.
 // Returns "false" if nothing was removed.
-bool IndirectReferenceTable::Remove(uint32_t cookie, IndirectRef iref) {
+bool IndirectReferenceTable::RemoveSlowPath(uint32_t cookie, IndirectRef iref) {
   IRTSegmentState prevState;
   prevState.all = cookie;
   int topIndex = segment_state_.parts.topIndex;
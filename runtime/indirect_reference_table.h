@@ -28,6 +28,7 @@
 #include "object_callbacks.h"
 #include "offsets.h"
 #include "read_barrier_option.h"
+#include "verify_object.h"
 
 namespace art {
 
@@ -263,8 +264,11 @@ class IndirectReferenceTable {
  public:
   // WARNING: When using with abort_on_error = false, the object may be in a partially
   //          initialized state. Use IsValid() to check.
+  // A non-zero stripe is encoded in every reference the table hands out, so that a caller
+  // splitting references of one kind across several tables can route them back with
+  // ExtractStripe().
   IndirectReferenceTable(size_t initialCount, size_t maxCount, IndirectRefKind kind,
-                         bool abort_on_error = true);
+                         bool abort_on_error = true, size_t stripe = 0u);
 
   ~IndirectReferenceTable();
 
@@ -277,7 +281,22 @@ class IndirectReferenceTable {
    * failed during expansion).
    */
   IndirectRef Add(uint32_t cookie, mirror::Object* obj)
-      SHARED_REQUIRES(Locks::mutator_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    IRTSegmentState prev_state;
+    prev_state.all = cookie;
+    const uint32_t top_index = segment_state_.parts.topIndex;
+    // Without holes in the current segment, the new entry goes on top. This is the common case
+    // of native code creating and deleting local references in a loop.
+    if (kVerifyObjectSupport == kVerifyObjectModeDisabled &&
+        LIKELY(obj != nullptr &&
+               segment_state_.parts.numHoles == prev_state.parts.numHoles &&
+               top_index != max_entries_)) {
+      table_[top_index].Add(obj);
+      segment_state_.parts.topIndex = top_index + 1u;
+      return ToIndirectRef(top_index);
+    }
+    return AddSlowPath(cookie, obj);
+  }
 
   /*
    * Given an IndirectRef in the table, return the Object it refers to.
@@ -310,7 +329,23 @@ class IndirectReferenceTable {
    *
    * Returns "false" if nothing was removed.
    */
-  bool Remove(uint32_t cookie, IndirectRef iref);
+  bool Remove(uint32_t cookie, IndirectRef iref) {
+    IRTSegmentState prev_state;
+    prev_state.all = cookie;
+    const uint32_t top_index = segment_state_.parts.topIndex;
+    const uint32_t idx = ExtractIndex(iref);
+    // Removing the top entry of a segment without holes leaves no hole to track. The serial
+    // check rejects stale references and references of other kinds, which go the slow way.
+    if (LIKELY(idx + 1u == top_index &&
+               idx >= prev_state.parts.topIndex &&
+               segment_state_.parts.numHoles == prev_state.parts.numHoles &&
+               iref == ToIndirectRef(idx))) {
+      *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
+      segment_state_.parts.topIndex = idx;
+      return true;
+    }
+    return RemoveSlowPath(cookie, iref);
+  }
 
   void AssertEmpty();
 
@@ -354,7 +389,19 @@ class IndirectReferenceTable {
   // Release pages past the end of the table that may have previously held references.
   void Trim() SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Number of tables a kind of references can be split across, limited by the bits left
+  // between the table index and the serial number.
+  static constexpr size_t kMaxStripes = 4u;
+
+  // Extract the stripe of the table that created an indirect reference.
+  static size_t ExtractStripe(IndirectRef iref) {
+    uintptr_t uref = reinterpret_cast<uintptr_t>(iref);
+    return (uref >> kStripeShift) & (kMaxStripes - 1u);
+  }
+
  private:
+  static constexpr size_t kStripeShift = 18u;
+
   // Extract the table index from an indirect reference.
   static uint32_t ExtractIndex(IndirectRef iref) {
     uintptr_t uref = reinterpret_cast<uintptr_t>(iref);
@@ -368,13 +415,18 @@ class IndirectReferenceTable {
   IndirectRef ToIndirectRef(uint32_t tableIndex) const {
     DCHECK_LT(tableIndex, 65536U);
     uint32_t serialChunk = table_[tableIndex].GetSerial();
-    uintptr_t uref = (serialChunk << 20) | (tableIndex << 2) | kind_;
+    uintptr_t uref = (serialChunk << 20) | (stripe_ << kStripeShift) | (tableIndex << 2) | kind_;
     return reinterpret_cast<IndirectRef>(uref);
   }
 
   // Abort if check_jni is not enabled.
   static void AbortIfNoCheckJNI();
 
+  // Add and Remove when the current segment has holes, or for the error cases.
+  IndirectRef AddSlowPath(uint32_t cookie, mirror::Object* obj)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+  bool RemoveSlowPath(uint32_t cookie, IndirectRef iref);
+
   /* extra debugging checks */
   bool GetChecked(IndirectRef) const;
   bool CheckEntry(const char*, IndirectRef, int) const;
@@ -391,6 +443,8 @@ class IndirectReferenceTable {
   const IndirectRefKind kind_;
   /* max #of entries allowed */
   const size_t max_entries_;
+  /* stripe bits, ORed into all irefs */
+  const uint32_t stripe_;
 };
 
 }  // namespace art
@@ -254,4 +254,71 @@ TEST_F(IndirectReferenceTableTest, BasicTest) {
   CheckDump(&irt, 0, 0);
 }
 
+// Holes in an outer segment must not keep an inner segment off the fast path, nor must a
+// removal in the inner segment consume them.
+TEST_F(IndirectReferenceTableTest, SegmentsWithHoles) {
+  // The failed removals log warnings.
+  ScopedLogSeverity sls(LogSeverity::ERROR);
+
+  ScopedObjectAccess soa(Thread::Current());
+  IndirectReferenceTable irt(10, 20, kLocal);
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  mirror::Object* obj = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj != nullptr);
+
+  const uint32_t cookie0 = IRT_FIRST_SEGMENT;
+  IndirectRef iref0 = irt.Add(cookie0, obj);
+  IndirectRef iref1 = irt.Add(cookie0, obj);
+  ASSERT_TRUE(irt.Remove(cookie0, iref0));  // Leaves a hole.
+  ASSERT_EQ(2U, irt.Capacity());
+
+  const uint32_t cookie1 = irt.GetSegmentState();
+  for (size_t i = 0; i != 100u; ++i) {
+    IndirectRef iref = irt.Add(cookie1, obj);
+    ASSERT_EQ(3U, irt.Capacity());
+    EXPECT_EQ(obj, irt.Get(iref));
+    ASSERT_TRUE(irt.Remove(cookie1, iref));
+    ASSERT_EQ(2U, irt.Capacity());
+    // A stale reference is not removed again.
+    EXPECT_FALSE(irt.Remove(cookie1, iref));
+  }
+  // References of the outer segment cannot be removed through the inner one.
+  EXPECT_FALSE(irt.Remove(cookie1, iref1));
+  irt.SetSegmentState(cookie1);  // Pop the inner segment.
+
+  ASSERT_TRUE(irt.Remove(cookie0, iref1));
+  EXPECT_EQ(0U, irt.Capacity());
+}
+
+// References remember the stripe of their table, and are rejected by the other stripes even
+// where the index matches.
+TEST_F(IndirectReferenceTableTest, Stripes) {
+  // The rejected removal logs an error.
+  ScopedLogSeverity sls(LogSeverity::FATAL);
+
+  ScopedObjectAccess soa(Thread::Current());
+  const size_t last_stripe = IndirectReferenceTable::kMaxStripes - 1u;
+  IndirectReferenceTable irt0(10, 20, kGlobal);
+  IndirectReferenceTable irt1(10, 20, kGlobal, true, last_stripe);
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  mirror::Object* obj = c->AllocObject(soa.Self());
+  ASSERT_TRUE(obj != nullptr);
+
+  const uint32_t cookie = IRT_FIRST_SEGMENT;
+  IndirectRef iref0 = irt0.Add(cookie, obj);
+  IndirectRef iref1 = irt1.Add(cookie, obj);
+  EXPECT_NE(iref0, iref1);
+  EXPECT_EQ(kGlobal, GetIndirectRefKind(iref1));
+  EXPECT_EQ(0U, IndirectReferenceTable::ExtractStripe(iref0));
+  EXPECT_EQ(last_stripe, IndirectReferenceTable::ExtractStripe(iref1));
+  EXPECT_EQ(obj, irt1.Get(iref1));
+
+  EXPECT_FALSE(irt0.Remove(cookie, iref1));
+  EXPECT_EQ(1U, irt0.Capacity());
+  ASSERT_TRUE(irt1.Remove(cookie, iref1));
+  ASSERT_TRUE(irt0.Remove(cookie, iref0));
+}
+
 }  // namespace art
@@ -16,6 +16,7 @@
 
 #include "instrumentation.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "arch/context.h"
@@ -37,6 +38,7 @@
 #include "mirror/object-inl.h"
 #include "nth_caller_visitor.h"
 #include "oat_quick_method_header.h"
+#include "quick/inline_method_analyser.h"
 #include "thread.h"
 #include "thread_list.h"
 
@@ -64,6 +66,32 @@ class InstallStubsClassVisitor : public ClassVisitor {
   Instrumentation* const instrumentation_;
 };
 
+// Collects the methods whose AOT compiled code has a given method inlined.
+class InliningCallersClassVisitor : public ClassVisitor {
+ public:
+  InliningCallersClassVisitor(ArtMethod* method, std::vector<ArtMethod*>* callers)
+      : class_linker_(Runtime::Current()->GetClassLinker()), method_(method), callers_(callers) {}
+
+  bool operator()(mirror::Class* klass) OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (klass->IsErroneous() || !klass->IsResolved()) {
+      return true;
+    }
+    for (ArtMethod& caller : klass->GetMethods(kRuntimePointerSize)) {
+      const void* code = class_linker_->GetOatMethodQuickCodeFor(&caller);
+      if (code != nullptr &&
+          OatQuickMethodHeader::FromEntryPoint(code)->HasInlinedMethod(&caller, method_)) {
+        callers_->push_back(&caller);
+      }
+    }
+    return true;  // we visit all classes.
+  }
+
+ private:
+  ClassLinker* const class_linker_;
+  ArtMethod* const method_;
+  std::vector<ArtMethod*>* const callers_;
+};
+
 
 Instrumentation::Instrumentation()
     : instrumentation_stubs_installed_(false),
@@ -108,6 +136,7 @@ static void UpdateEntrypoints(ArtMethod* method, const void* quick_code)
 bool Instrumentation::NeedDebugVersionForBootImageCode(ArtMethod* method, const void* code) const
     SHARED_REQUIRES(Locks::mutator_lock_) {
   return Dbg::IsDebuggerActive() &&
+         !Runtime::Current()->DebuggerKeepsCompiledCode() &&
          Runtime::Current()->GetHeap()->IsInBootImageOatFile(code) &&
          !method->IsNative() &&
          !method->IsProxyMethod();
@@ -722,7 +751,7 @@ void Instrumentation::UpdateMethodsCodeFromDebugger(ArtMethod* method, const voi
 }
 
 bool Instrumentation::AddDeoptimizedMethod(ArtMethod* method) {
-  if (IsDeoptimizedMethod(method)) {
+  if (deoptimized_methods_.find(method) != deoptimized_methods_.end()) {
     // Already in the map. Return.
     return false;
   }
@@ -732,7 +761,8 @@ bool Instrumentation::AddDeoptimizedMethod(ArtMethod* method) {
 }
 
 bool Instrumentation::IsDeoptimizedMethod(ArtMethod* method) {
-  return deoptimized_methods_.find(method) != deoptimized_methods_.end();
+  return deoptimized_methods_.find(method) != deoptimized_methods_.end() ||
+      deoptimized_inlining_callers_.find(method) != deoptimized_inlining_callers_.end();
 }
 
 ArtMethod* Instrumentation::BeginDeoptimizedMethod() {
@@ -753,7 +783,7 @@ bool Instrumentation::RemoveDeoptimizedMethod(ArtMethod* method) {
 }
 
 bool Instrumentation::IsDeoptimizedMethodsEmpty() const {
-  return deoptimized_methods_.empty();
+  return deoptimized_methods_.empty() && deoptimized_inlining_callers_.empty();
 }
 
 void Instrumentation::Deoptimize(ArtMethod* method) {
@@ -786,27 +816,23 @@ void Instrumentation::Undeoptimize(ArtMethod* method) {
 
   Thread* self = Thread::Current();
   bool empty;
+  bool still_deoptimized;
   {
     WriterMutexLock mu(self, deoptimized_methods_lock_);
+    CHECK(inlining_callers_.find(method) == inlining_callers_.end()) << "Method "
+        << PrettyMethod(method) << " is deoptimized with its inlining callers";
     bool found_and_erased = RemoveDeoptimizedMethod(method);
     CHECK(found_and_erased) << "Method " << PrettyMethod(method)
         << " is not deoptimized";
+    // The method may still be deoptimized as an inlining caller of another method.
+    still_deoptimized = IsDeoptimizedMethod(method);
     empty = IsDeoptimizedMethodsEmpty();
   }
 
   // Restore code and possibly stack only if we did not deoptimize everything.
   if (!interpreter_stubs_installed_) {
-    // Restore its code or resolution trampoline.
-    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
-    if (method->IsStatic() && !method->IsConstructor() &&
-        !method->GetDeclaringClass()->IsInitialized()) {
-      UpdateEntrypoints(method, GetQuickResolutionStub());
-    } else {
-      const void* quick_code = class_linker->GetQuickOatCodeFor(method);
-      if (NeedDebugVersionForBootImageCode(method, quick_code)) {
-        quick_code = GetQuickToInterpreterBridge();
-      }
-      UpdateEntrypoints(method, quick_code);
+    if (!still_deoptimized) {
+      RestoreMethodCode(method);
     }
 
     // If there is no deoptimized method left, we can restore the stack of each thread.
@@ -818,6 +844,124 @@ void Instrumentation::Undeoptimize(ArtMethod* method) {
   }
 }
 
+void Instrumentation::RestoreMethodCode(ArtMethod* method) {
+  // Restore its code or resolution trampoline.
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  if (method->IsStatic() && !method->IsConstructor() &&
+      !method->GetDeclaringClass()->IsInitialized()) {
+    UpdateEntrypoints(method, GetQuickResolutionStub());
+  } else {
+    const void* quick_code = class_linker->GetQuickOatCodeFor(method);
+    if (NeedDebugVersionForBootImageCode(method, quick_code)) {
+      quick_code = GetQuickToInterpreterBridge();
+    }
+    UpdateEntrypoints(method, quick_code);
+  }
+}
+
+void Instrumentation::FindInliningCallers(ArtMethod* method, std::vector<ArtMethod*>* callers) {
+  Runtime* const runtime = Runtime::Current();
+  InliningCallersClassVisitor visitor(method, callers);
+  runtime->GetClassLinker()->VisitClasses(&visitor);
+  if (runtime->GetJit() != nullptr) {
+    runtime->GetJit()->GetCodeCache()->GetMethodsInlining(Thread::Current(), method, callers);
+  }
+  // A method can have both AOT and JIT code inlining the method.
+  std::sort(callers->begin(), callers->end());
+  callers->erase(std::unique(callers->begin(), callers->end()), callers->end());
+}
+
+bool Instrumentation::CanDeoptimizeWithInliningCallers(ArtMethod* method) {
+  // Intrinsics, which are all in the boot class path, and the methods the compiler replaces by
+  // their pattern leave no inline info in the code using them.
+  InlineMethod inline_method;
+  return method->GetDeclaringClass()->GetClassLoader() != nullptr &&
+      !InlineMethodAnalyser::AnalyseMethodCode(method, &inline_method);
+}
+
+bool Instrumentation::DeoptimizeWithInliningCallers(ArtMethod* method) {
+  CHECK(!method->IsNative());
+  CHECK(!method->IsProxyMethod());
+  CHECK(method->IsInvokable());
+
+  if (!CanDeoptimizeWithInliningCallers(method)) {
+    return false;
+  }
+
+  std::vector<ArtMethod*> callers;
+  FindInliningCallers(method, &callers);
+  Thread* self = Thread::Current();
+  {
+    WriterMutexLock mu(self, deoptimized_methods_lock_);
+    CHECK(inlining_callers_.find(method) == inlining_callers_.end()) << "Method "
+        << PrettyMethod(method) << " is already deoptimized";
+    for (ArtMethod* caller : callers) {
+      ++deoptimized_inlining_callers_[caller];
+    }
+    inlining_callers_[method] = callers;
+  }
+  if (!interpreter_stubs_installed_) {
+    for (ArtMethod* caller : callers) {
+      // Like Deoptimize, a static method keeps its resolution trampoline until its class is
+      // initialized.
+      if (!caller->IsStatic() || caller->IsConstructor() ||
+          caller->GetDeclaringClass()->IsInitialized()) {
+        UpdateEntrypoints(caller, GetQuickInstrumentationEntryPoint());
+      }
+    }
+  }
+  // Also installs the instrumentation frames, so that the frames of the callers on the stacks
+  // get deoptimized when returned to.
+  Deoptimize(method);
+  VLOG(deopt) << "Deoptimized " << PrettyMethod(method) << " with " << callers.size()
+              << " inlining callers";
+  return true;
+}
+
+void Instrumentation::UndeoptimizeWithInliningCallers(ArtMethod* method) {
+  std::vector<ArtMethod*> released_callers;
+  {
+    WriterMutexLock mu(Thread::Current(), deoptimized_methods_lock_);
+    auto it = inlining_callers_.find(method);
+    CHECK(it != inlining_callers_.end()) << "Method " << PrettyMethod(method)
+        << " is not deoptimized with its inlining callers";
+    for (ArtMethod* caller : it->second) {
+      auto count = deoptimized_inlining_callers_.find(caller);
+      DCHECK(count != deoptimized_inlining_callers_.end());
+      if (--count->second == 0) {
+        deoptimized_inlining_callers_.erase(count);
+        if (!IsDeoptimizedMethod(caller)) {
+          released_callers.push_back(caller);
+        }
+      }
+    }
+    inlining_callers_.erase(it);
+  }
+  if (!interpreter_stubs_installed_) {
+    for (ArtMethod* caller : released_callers) {
+      RestoreMethodCode(caller);
+    }
+  }
+  // Also restores the stacks if nothing else is deoptimized.
+  Undeoptimize(method);
+}
+
+bool Instrumentation::IsDeoptimizedWithInliningCallers(ArtMethod* method) {
+  ReaderMutexLock mu(Thread::Current(), deoptimized_methods_lock_);
+  return inlining_callers_.find(method) != inlining_callers_.end();
+}
+
+bool Instrumentation::InlinesDeoptimizedMethod(ArtMethod* method,
+                                               const OatQuickMethodHeader* method_header) {
+  ReaderMutexLock mu(Thread::Current(), deoptimized_methods_lock_);
+  for (const auto& entry : inlining_callers_) {
+    if (method_header->HasInlinedMethod(method, entry.first)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool Instrumentation::IsDeoptimized(ArtMethod* method) {
   DCHECK(method != nullptr);
   ReaderMutexLock mu(Thread::Current(), deoptimized_methods_lock_);
@@ -837,6 +981,18 @@ void Instrumentation::DisableDeoptimization(const char* key) {
   if (interpreter_stubs_installed_) {
     UndeoptimizeEverything(key);
   }
+  // Undeoptimize selected methods and their inlining callers.
+  while (true) {
+    ArtMethod* method;
+    {
+      ReaderMutexLock mu(Thread::Current(), deoptimized_methods_lock_);
+      if (inlining_callers_.empty()) {
+        break;
+      }
+      method = inlining_callers_.begin()->first;
+    }
+    UndeoptimizeWithInliningCallers(method);
+  }
   // Undeoptimized selected methods.
   while (true) {
     ArtMethod* method;
@@ -19,7 +19,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "arch/instruction_set.h"
 #include "base/enums.h"
@@ -36,6 +38,7 @@ namespace mirror {
 }  // namespace mirror
 class ArtField;
 class ArtMethod;
+class OatQuickMethodHeader;
 union JValue;
 class Thread;
 
@@ -190,6 +193,33 @@ class Instrumentation {
   void Undeoptimize(ArtMethod* method)
       REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_, !deoptimized_methods_lock_);
 
+  // Whether DeoptimizeWithInliningCallers can deoptimize the method. It cannot if the method
+  // may be inlined without inline info (intrinsics and methods the compiler pattern matches),
+  // in which case the caller should deoptimize everything.
+  bool CanDeoptimizeWithInliningCallers(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Deoptimize a method and the methods whose compiled code has it inlined, found through the
+  // inline info of their stack maps, instead of everything. Returns false without deoptimizing
+  // anything if !CanDeoptimizeWithInliningCallers(method).
+  bool DeoptimizeWithInliningCallers(ArtMethod* method)
+      REQUIRES(Locks::mutator_lock_,
+               !Locks::thread_list_lock_,
+               !Locks::classlinker_classes_lock_,
+               !deoptimized_methods_lock_);
+
+  // Undo DeoptimizeWithInliningCallers. The callers stay deoptimized as long as they inline
+  // another method deoptimized this way or are deoptimized themselves.
+  void UndeoptimizeWithInliningCallers(ArtMethod* method)
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_, !deoptimized_methods_lock_);
+
+  bool IsDeoptimizedWithInliningCallers(ArtMethod* method)
+      REQUIRES(!deoptimized_methods_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Whether the given code of `method` inlines a method deoptimized with its inlining callers.
+  // The JIT discards such code, compiled before the method was deoptimized.
+  bool InlinesDeoptimizedMethod(ArtMethod* method, const OatQuickMethodHeader* method_header)
+      REQUIRES(!deoptimized_methods_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Indicates whether the method has been deoptimized so it is executed with the interpreter.
   bool IsDeoptimized(ArtMethod* method)
       REQUIRES(!deoptimized_methods_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
@@ -304,6 +334,13 @@ class Instrumentation {
         have_branch_listeners_ || have_invoke_virtual_or_interface_listeners_;
   }
 
+  // Listeners that need a callback for each dex pc, field access or branch. Mterp has none of
+  // those callbacks, so the frames it runs are handed to the switch interpreter instead.
+  bool HasPerInstructionListeners() const SHARED_REQUIRES(Locks::mutator_lock_) {
+    return have_dex_pc_listeners_ || have_field_read_listeners_ || have_field_write_listeners_ ||
+        have_branch_listeners_;
+  }
+
   // Any instrumentation *other* than what is needed for Jit profiling active?
   bool NonJitProfilingActive() const SHARED_REQUIRES(Locks::mutator_lock_) {
     return have_dex_pc_listeners_ || have_method_exit_listeners_ ||
@@ -501,6 +538,10 @@ class Instrumentation {
       SHARED_REQUIRES(Locks::mutator_lock_, deoptimized_methods_lock_);
   void UpdateMethodsCodeImpl(ArtMethod* method, const void* quick_code)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!deoptimized_methods_lock_);
+  // Restore the code or resolution trampoline of a method that is no longer deoptimized.
+  void RestoreMethodCode(ArtMethod* method) SHARED_REQUIRES(Locks::mutator_lock_);
+  void FindInliningCallers(ArtMethod* method, std::vector<ArtMethod*>* callers)
+      REQUIRES(Locks::mutator_lock_, !Locks::classlinker_classes_lock_);
 
 
   // Have we hijacked ArtMethod::code_ so that it calls instrumentation/interpreter code?
@@ -581,6 +622,12 @@ class Instrumentation {
   // only.
   mutable ReaderWriterMutex deoptimized_methods_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   std::unordered_set<ArtMethod*> deoptimized_methods_ GUARDED_BY(deoptimized_methods_lock_);
+  // The methods deoptimized with DeoptimizeWithInliningCallers, with the callers found for them.
+  std::unordered_map<ArtMethod*, std::vector<ArtMethod*>> inlining_callers_
+      GUARDED_BY(deoptimized_methods_lock_);
+  // The number of methods of `inlining_callers_` each caller is deoptimized for.
+  std::unordered_map<ArtMethod*, size_t> deoptimized_inlining_callers_
+      GUARDED_BY(deoptimized_methods_lock_);
   bool deoptimization_enabled_;
 
   // Current interpreter handler table. This is updated each time the thread state flags are
@@ -235,6 +235,32 @@ class InstrumentationTest : public CommonRuntimeTest {
     }
   }
 
+  bool DeoptimizeMethodWithInliningCallers(Thread* self, ArtMethod* method)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    Runtime* runtime = Runtime::Current();
+    instrumentation::Instrumentation* instrumentation = runtime->GetInstrumentation();
+    ScopedThreadSuspension sts(self, kSuspended);
+    gc::ScopedGCCriticalSection gcs(self,
+                                    gc::kGcCauseInstrumentation,
+                                    gc::kCollectorTypeInstrumentation);
+    ScopedSuspendAll ssa("Single method deoptimization with inlining callers");
+    instrumentation->EnableDeoptimization();
+    return instrumentation->DeoptimizeWithInliningCallers(method);
+  }
+
+  void UndeoptimizeMethodWithInliningCallers(Thread* self, ArtMethod* method, const char* key)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    Runtime* runtime = Runtime::Current();
+    instrumentation::Instrumentation* instrumentation = runtime->GetInstrumentation();
+    ScopedThreadSuspension sts(self, kSuspended);
+    gc::ScopedGCCriticalSection gcs(self,
+                                    gc::kGcCauseInstrumentation,
+                                    gc::kCollectorTypeInstrumentation);
+    ScopedSuspendAll ssa("Single method undeoptimization with inlining callers");
+    instrumentation->UndeoptimizeWithInliningCallers(method);
+    instrumentation->DisableDeoptimization(key);
+  }
+
   void DeoptimizeEverything(Thread* self, const char* key, bool enable_deoptimization)
         SHARED_REQUIRES(Locks::mutator_lock_) {
     Runtime* runtime = Runtime::Current();
@@ -481,6 +507,53 @@ TEST_F(InstrumentationTest, DeoptimizeDirectMethod) {
   EXPECT_FALSE(instr->IsDeoptimized(method_to_deoptimize));
 }
 
+TEST_F(InstrumentationTest, DeoptimizeDirectMethodWithInliningCallers) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject class_loader = LoadDex("Instrumentation");
+  Runtime* const runtime = Runtime::Current();
+  instrumentation::Instrumentation* instr = runtime->GetInstrumentation();
+  ClassLinker* class_linker = runtime->GetClassLinker();
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(hs.NewHandle(soa.Decode<mirror::ClassLoader*>(class_loader)));
+  mirror::Class* klass = class_linker->FindClass(soa.Self(), "LInstrumentation;", loader);
+  ASSERT_TRUE(klass != nullptr);
+  ArtMethod* method_to_deoptimize = klass->FindDeclaredDirectMethod("instanceMethod", "()V",
+                                                                    kRuntimePointerSize);
+  ASSERT_TRUE(method_to_deoptimize != nullptr);
+
+  EXPECT_TRUE(DeoptimizeMethodWithInliningCallers(soa.Self(), method_to_deoptimize));
+
+  EXPECT_FALSE(instr->AreAllMethodsDeoptimized());
+  EXPECT_TRUE(instr->AreExitStubsInstalled());
+  EXPECT_TRUE(instr->IsDeoptimized(method_to_deoptimize));
+
+  constexpr const char* instrumentation_key = "DeoptimizeDirectMethodWithInliningCallers";
+  UndeoptimizeMethodWithInliningCallers(soa.Self(), method_to_deoptimize, instrumentation_key);
+
+  EXPECT_FALSE(instr->AreAllMethodsDeoptimized());
+  EXPECT_FALSE(instr->AreExitStubsInstalled());
+  EXPECT_FALSE(instr->IsDeoptimized(method_to_deoptimize));
+}
+
+TEST_F(InstrumentationTest, DeoptimizeBootMethodWithInliningCallers) {
+  ScopedObjectAccess soa(Thread::Current());
+  Runtime* const runtime = Runtime::Current();
+  instrumentation::Instrumentation* instr = runtime->GetInstrumentation();
+  mirror::Class* klass = runtime->GetClassLinker()->FindSystemClass(soa.Self(),
+                                                                    "Ljava/lang/String;");
+  ASSERT_TRUE(klass != nullptr);
+  ArtMethod* method = klass->FindDeclaredVirtualMethod("length", "()I", kRuntimePointerSize);
+  ASSERT_TRUE(method != nullptr);
+
+  // Could be an intrinsic, the caller has to deoptimize everything instead.
+  EXPECT_FALSE(DeoptimizeMethodWithInliningCallers(soa.Self(), method));
+  EXPECT_FALSE(instr->IsDeoptimized(method));
+
+  ScopedThreadSuspension sts(soa.Self(), kSuspended);
+  ScopedSuspendAll ssa("Disable deoptimization");
+  instr->DisableDeoptimization("DeoptimizeBootMethodWithInliningCallers");
+}
+
 TEST_F(InstrumentationTest, FullDeoptimization) {
   ScopedObjectAccess soa(Thread::Current());
   Runtime* const runtime = Runtime::Current();
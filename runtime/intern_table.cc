@@ -316,7 +316,7 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool hold
 
 mirror::String* InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
   DCHECK(utf8_data != nullptr);
-  return InternStrong(mirror::String::AllocFromModifiedUtf8(
+  return InternStrong(mirror::String::AllocHashedFromModifiedUtf8(
       Thread::Current(), utf16_length, utf8_data));
 }
 
@@ -330,12 +330,36 @@ mirror::String* InternTable::InternStrongImageString(mirror::String* s) {
   return Insert(s, true, true);
 }
 
+mirror::String* InternTable::InsertWithThreadCache(mirror::String* s, bool is_strong) {
+  // The caches are shared by all intern tables, only use them for the one of the runtime.
+  if (s == nullptr || UNLIKELY(this != Runtime::Current()->GetInternTable())) {
+    return Insert(s, is_strong, /* holding_locks */ false);
+  }
+  Thread* const self = Thread::Current();
+  const size_t index = static_cast<uint32_t>(s->GetHashCode()) & (kInternCacheSizeInThread - 1u);
+  mirror::String* cached = self->GetInternCacheEntry(index);
+  // A weak entry cannot be returned for a strong intern, which needs the string to be promoted
+  // to the strong table.
+  if (cached != nullptr &&
+      (!is_strong || self->IsStrongInternCacheEntry(index)) &&
+      (cached == s || cached->Equals(s))) {
+    return cached;
+  }
+  mirror::String* result = Insert(s, is_strong, /* holding_locks */ false);
+  // Do not cache strings while a transaction is active, they may be removed from the table when
+  // it is rolled back.
+  if (!Runtime::Current()->IsActiveTransaction()) {
+    self->SetInternCacheEntry(index, result, is_strong);
+  }
+  return result;
+}
+
 mirror::String* InternTable::InternStrong(mirror::String* s) {
-  return Insert(s, true, false);
+  return InsertWithThreadCache(s, /* is_strong */ true);
 }
 
 mirror::String* InternTable::InternWeak(mirror::String* s) {
-  return Insert(s, false, false);
+  return InsertWithThreadCache(s, /* is_strong */ false);
 }
 
 bool InternTable::ContainsWeak(mirror::String* s) {
@@ -224,6 +224,10 @@ class InternTable {
   mirror::String* Insert(mirror::String* s, bool is_strong, bool holding_locks)
       REQUIRES(!Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Insert, but first check the intern cache of the current thread, which takes no lock.
+  mirror::String* InsertWithThreadCache(mirror::String* s, bool is_strong)
+      REQUIRES(!Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
   mirror::String* LookupStrongLocked(mirror::String* s)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
   mirror::String* LookupWeakLocked(mirror::String* s)
@@ -20,6 +20,7 @@
 #include "mirror/object.h"
 #include "handle_scope-inl.h"
 #include "mirror/string.h"
+#include "runtime.h"
 #include "scoped_thread_state_change.h"
 
 namespace art {
@@ -212,4 +213,25 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, ThreadCache) {
+  ScopedObjectAccess soa(Thread::Current());
+  // The thread caches are only used for the intern table of the runtime.
+  InternTable* const intern_table = Runtime::Current()->GetInternTable();
+  StackHandleScope<4> hs(soa.Self());
+  Handle<mirror::String> s_1(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "ThreadCache")));
+  Handle<mirror::String> s_2(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "ThreadCache")));
+  Handle<mirror::String> weak(hs.NewHandle(intern_table->InternWeak(s_1.Get())));
+  EXPECT_EQ(s_1.Get(), weak.Get());
+  EXPECT_EQ(weak.Get(), intern_table->InternWeak(s_2.Get()));
+  EXPECT_TRUE(intern_table->ContainsWeak(weak.Get()));
+  // A strong intern must promote the cached weak intern to the strong table.
+  Handle<mirror::String> strong(hs.NewHandle(intern_table->InternStrong(s_2.Get())));
+  EXPECT_EQ(weak.Get(), strong.Get());
+  EXPECT_FALSE(intern_table->ContainsWeak(strong.Get()));
+  EXPECT_EQ(strong.Get(), intern_table->LookupStrong(soa.Self(), s_2.Get()));
+  EXPECT_EQ(strong.Get(), intern_table->InternStrong(s_1.Get()));
+}
+
 }  // namespace art
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dispatch_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+namespace interpreter {
+
+static constexpr size_t kNumOpcodes = 256u;
+
+// The counts of one thread since its last flush, only accessed by that thread.
+struct DispatchProfileBuffer {
+  DispatchProfileBuffer() : pending(0u), opcode_counts(), method(nullptr), method_count(0u) {}
+
+  uint32_t pending;
+  uint64_t opcode_counts[kNumOpcodes];
+  // The counts of the method executing the latest instructions, to avoid a map lookup for each.
+  ArtMethod* method;
+  uint64_t method_count;
+  std::unordered_map<ArtMethod*, uint64_t> method_counts;
+};
+
+Atomic<bool> DispatchProfiler::enabled_(false);
+
+namespace {
+
+// Only the most frequent entries of each table are dumped.
+static constexpr size_t kMaxDumpedEntries = 20;
+
+struct MethodStats {
+  MethodStats() : instructions(0u), jit_requested(false), instructions_before_jit(0u) {}
+
+  uint64_t instructions;
+  bool jit_requested;
+  uint64_t instructions_before_jit;
+};
+
+struct DispatchProfileData {
+  DispatchProfileData() : lock("dispatch profiler lock", kLoggingLock), opcode_counts() {}
+
+  Mutex lock;
+  uint64_t opcode_counts[kNumOpcodes] GUARDED_BY(lock);
+  // Keyed by name, the methods may be unloaded before the dump.
+  std::map<std::string, MethodStats> methods GUARDED_BY(lock);
+};
+
+// Created when first enabled and never deleted, threads may still be recording.
+Atomic<DispatchProfileData*> gDispatchProfileData(nullptr);
+
+void Flush(Thread* self, DispatchProfileData* data, DispatchProfileBuffer* buffer)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  if (buffer->method != nullptr) {
+    buffer->method_counts[buffer->method] += buffer->method_count;
+    buffer->method = nullptr;
+    buffer->method_count = 0u;
+  }
+  // Name the methods before taking the lock, the logging lock must be the last one taken.
+  std::vector<std::pair<std::string, uint64_t>> methods;
+  methods.reserve(buffer->method_counts.size());
+  for (const auto& entry : buffer->method_counts) {
+    methods.emplace_back(PrettyMethod(entry.first), entry.second);
+  }
+  buffer->method_counts.clear();
+  MutexLock mu(self, data->lock);
+  for (size_t i = 0; i != kNumOpcodes; ++i) {
+    data->opcode_counts[i] += buffer->opcode_counts[i];
+    buffer->opcode_counts[i] = 0u;
+  }
+  for (const auto& entry : methods) {
+    data->methods[entry.first].instructions += entry.second;
+  }
+  buffer->pending = 0u;
+}
+
+}  // namespace
+
+void DispatchProfiler::SetEnabled(bool enabled) {
+  if (enabled && gDispatchProfileData.LoadAcquire() == nullptr) {
+    DispatchProfileData* data = new DispatchProfileData();
+    if (!gDispatchProfileData.CompareExchangeStrongSequentiallyConsistent(nullptr, data)) {
+      delete data;  // Lost the race with another thread enabling the profiler.
+    }
+  }
+  enabled_.StoreRelaxed(enabled);
+}
+
+void DispatchProfiler::RecordInstruction(Thread* self,
+                                         ArtMethod* method,
+                                         Instruction::Code opcode) {
+  DispatchProfileData* data = gDispatchProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  DispatchProfileBuffer* buffer = self->GetDispatchProfileBuffer();
+  if (UNLIKELY(buffer == nullptr)) {
+    buffer = new DispatchProfileBuffer();
+    self->SetDispatchProfileBuffer(buffer);
+  }
+  ++buffer->opcode_counts[opcode];
+  if (method != buffer->method) {
+    if (buffer->method != nullptr) {
+      buffer->method_counts[buffer->method] += buffer->method_count;
+    }
+    buffer->method = method;
+    buffer->method_count = 0u;
+  }
+  ++buffer->method_count;
+  if (UNLIKELY(++buffer->pending == kFlushInterval)) {
+    Flush(self, data, buffer);
+  }
+}
+
+void DispatchProfiler::RecordJitRequest(Thread* self, ArtMethod* method) {
+  DispatchProfileData* data = gDispatchProfileData.LoadAcquire();
+  if (data == nullptr || !IsEnabled()) {
+    return;
+  }
+  DispatchProfileBuffer* buffer = self->GetDispatchProfileBuffer();
+  if (buffer != nullptr) {
+    Flush(self, data, buffer);
+  }
+  std::string name = PrettyMethod(method);
+  MutexLock mu(self, data->lock);
+  MethodStats& stats = data->methods[name];
+  if (!stats.jit_requested) {
+    stats.jit_requested = true;
+    stats.instructions_before_jit = stats.instructions;
+  }
+}
+
+void DispatchProfiler::ThreadExited(Thread* self) {
+  DispatchProfileBuffer* buffer = self->GetDispatchProfileBuffer();
+  if (buffer == nullptr) {
+    return;
+  }
+  Flush(self, gDispatchProfileData.LoadAcquire(), buffer);
+  self->SetDispatchProfileBuffer(nullptr);
+  delete buffer;
+}
+
+bool DispatchProfiler::Dump(std::ostream& os) {
+  DispatchProfileData* data = gDispatchProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return false;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  uint64_t total = 0u;
+  typedef std::pair<uint64_t, size_t> OpcodeEntry;  // Count and opcode.
+  std::vector<OpcodeEntry> opcodes;
+  for (size_t i = 0; i != kNumOpcodes; ++i) {
+    if (data->opcode_counts[i] != 0u) {
+      opcodes.emplace_back(data->opcode_counts[i], i);
+      total += data->opcode_counts[i];
+    }
+  }
+  std::sort(opcodes.begin(), opcodes.end(), [](const OpcodeEntry& lhs, const OpcodeEntry& rhs) {
+    return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+  });
+  uint64_t after_jit_request = 0u;
+  typedef std::pair<const std::string*, const MethodStats*> MethodEntry;
+  std::vector<MethodEntry> methods;
+  for (const auto& entry : data->methods) {
+    methods.emplace_back(&entry.first, &entry.second);
+    if (entry.second.jit_requested) {
+      after_jit_request += entry.second.instructions - entry.second.instructions_before_jit;
+    }
+  }
+  std::sort(methods.begin(), methods.end(), [](const MethodEntry& lhs, const MethodEntry& rhs) {
+    return lhs.second->instructions > rhs.second->instructions;
+  });
+  // Avoid dividing by zero, the percentages are all 0 in that case anyway.
+  const double scale = 100.0 / std::max<uint64_t>(total, 1u);
+  auto percent = [scale](uint64_t count) {
+    return StringPrintf("%.2f%%", scale * count);
+  };
+
+  os << "Interpreter dispatch profile (" << (IsEnabled() ? "enabled" : "disabled") << "): "
+     << total << " instructions, " << after_jit_request << " (" << percent(after_jit_request)
+     << ") of them in methods already sent to the JIT\n";
+  os << "Instructions by opcode (" << opcodes.size() << " opcodes)\n";
+  for (size_t i = 0, e = std::min(opcodes.size(), kMaxDumpedEntries); i != e; ++i) {
+    os << "  " << opcodes[i].first << " (" << percent(opcodes[i].first) << "): "
+       << Instruction::Name(static_cast<Instruction::Code>(opcodes[i].second)) << "\n";
+  }
+  os << "Instructions by method (" << methods.size() << " methods)\n";
+  for (size_t i = 0, e = std::min(methods.size(), kMaxDumpedEntries); i != e; ++i) {
+    const MethodStats& stats = *methods[i].second;
+    os << "  " << stats.instructions << " (" << percent(stats.instructions) << "), ";
+    if (stats.jit_requested) {
+      os << "sent to the JIT after " << stats.instructions_before_jit;
+    } else {
+      os << "not sent to the JIT";
+    }
+    os << ": " << *methods[i].first << "\n";
+  }
+  return true;
+}
+
+void DispatchProfiler::Reset() {
+  DispatchProfileData* data = gDispatchProfileData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  std::fill_n(data->opcode_counts, kNumOpcodes, 0u);
+  data->methods.clear();
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_DISPATCH_PROFILER_H_
+#define ART_RUNTIME_INTERPRETER_DISPATCH_PROFILER_H_
+
+#include <iosfwd>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "dex_instruction.h"
+
+namespace art {
+
+class ArtMethod;
+class Thread;
+
+namespace interpreter {
+
+// Counts, when enabled with -Xinterpreterprofile, the instructions executed by mterp and by the
+// switch interpreter, by opcode and by method. The counts go to a buffer of the executing thread
+// which is merged into the global profile every kFlushInterval instructions, when the thread
+// exits, and when the JIT is asked to compile one of its methods, so a dump misses at most that
+// many instructions of each running thread. For the JIT thresholds, each method also records how
+// many of its instructions were interpreted before Jit::AddSamples requested its compilation.
+// Enabling it makes mterp run its alternate handlers, so it must be enabled before the threads
+// are attached. Dumped on SIGQUIT and through VMDebug.
+class DispatchProfiler {
+ public:
+  static constexpr uint32_t kFlushInterval = 16384u;
+
+  static void SetEnabled(bool enabled);
+
+  static bool IsEnabled() {
+    return enabled_.LoadRelaxed();
+  }
+
+  // Count one interpreted instruction of `method`. Callers check IsEnabled() first.
+  static void RecordInstruction(Thread* self, ArtMethod* method, Instruction::Code opcode)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Called by Jit::AddSamples when it queues the compilation of a hot method.
+  static void RecordJitRequest(Thread* self, ArtMethod* method)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Merge and free the buffer of a thread that is about to be destroyed.
+  static void ThreadExited(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Returns false and dumps nothing if the profiler was never enabled.
+  static bool Dump(std::ostream& os);
+
+  // Drop the merged counts. Counts still in the buffers of the threads are kept.
+  static void Reset();
+
+ private:
+  static Atomic<bool> enabled_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(DispatchProfiler);
+};
+
+}  // namespace interpreter
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_DISPATCH_PROFILER_H_
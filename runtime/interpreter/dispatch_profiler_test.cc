@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dispatch_profiler.h"
+
+#include <sstream>
+
+#include "art_method-inl.h"
+#include "class_linker.h"
+#include "common_runtime_test.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace interpreter {
+
+class DispatchProfilerTest : public CommonRuntimeTest {};
+
+TEST_F(DispatchProfilerTest, CountsOpcodesAndMethods) {
+  DispatchProfiler::SetEnabled(true);
+  DispatchProfiler::Reset();
+  EXPECT_TRUE(DispatchProfiler::IsEnabled());
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::Class* object_class = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+    ASSERT_TRUE(object_class != nullptr);
+    ArtMethod* hash_code =
+        object_class->FindDeclaredVirtualMethod("hashCode", "()I", kRuntimePointerSize);
+    ArtMethod* equals = object_class->FindDeclaredVirtualMethod(
+        "equals", "(Ljava/lang/Object;)Z", kRuntimePointerSize);
+    ASSERT_TRUE(hash_code != nullptr);
+    ASSERT_TRUE(equals != nullptr);
+
+    DispatchProfiler::RecordInstruction(soa.Self(), hash_code, Instruction::CONST_4);
+    DispatchProfiler::RecordInstruction(soa.Self(), hash_code, Instruction::RETURN);
+    DispatchProfiler::RecordJitRequest(soa.Self(), hash_code);
+    DispatchProfiler::RecordInstruction(soa.Self(), hash_code, Instruction::CONST_4);
+    DispatchProfiler::RecordInstruction(soa.Self(), equals, Instruction::CONST_4);
+    // Merges the counts of the test thread.
+    DispatchProfiler::ThreadExited(soa.Self());
+  }
+  DispatchProfiler::SetEnabled(false);
+
+  std::ostringstream os;
+  ASSERT_TRUE(DispatchProfiler::Dump(os));
+  std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find(
+      "(disabled): 4 instructions, 1 (25.00%) of them in methods already sent to the JIT\n"));
+  EXPECT_NE(std::string::npos, dump.find("  3 (75.00%): const/4\n"));
+  EXPECT_NE(std::string::npos, dump.find("  1 (25.00%): return\n"));
+  EXPECT_NE(std::string::npos, dump.find(
+      "  3 (75.00%), sent to the JIT after 2: int java.lang.Object.hashCode()\n"));
+  EXPECT_NE(std::string::npos, dump.find(
+      "  1 (25.00%), not sent to the JIT: boolean java.lang.Object.equals(java.lang.Object)\n"));
+
+  DispatchProfiler::Reset();
+  std::ostringstream empty;
+  ASSERT_TRUE(DispatchProfiler::Dump(empty));
+  EXPECT_EQ(std::string::npos, empty.str().find("hashCode"));
+}
+
+}  // namespace interpreter
+}  // namespace art
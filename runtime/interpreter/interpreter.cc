@@ -242,6 +242,25 @@ static std::ostream& operator<<(std::ostream& os, const InterpreterImplKind& rhs
 
 static constexpr InterpreterImplKind kInterpreterImplKind = kMterpImplKind;
 
+// Mterp has no method exit callback, so a frame it returned from gets its event here. Returns
+// export their dex pc, which tells them apart from a frame finished by OSR compiled code.
+static void MaybeSendMterpMethodExitEvent(Thread* self,
+                                          const DexFile::CodeItem* code_item,
+                                          ShadowFrame& shadow_frame,
+                                          const JValue& result)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  const instrumentation::Instrumentation* instrumentation =
+      Runtime::Current()->GetInstrumentation();
+  if (LIKELY(!instrumentation->HasMethodExitListeners()) || self->IsExceptionPending()) {
+    return;
+  }
+  const uint32_t dex_pc = shadow_frame.GetDexPC();
+  if (Instruction::At(code_item->insns_ + dex_pc)->IsReturn()) {
+    instrumentation->MethodExitEvent(self, shadow_frame.GetThisObject(code_item->ins_size_),
+                                     shadow_frame.GetMethod(), dex_pc, result);
+  }
+}
+
 #if defined(__clang__)
 // Clang 3.4 fails to build the goto interpreter implementation.
 template<bool do_access_check, bool transaction_active>
@@ -264,6 +283,35 @@ JValue ExecuteGotoImpl<false, true>(Thread* self, const DexFile::CodeItem* code_
                                     ShadowFrame& shadow_frame, JValue result_register);
 #endif
 
+// Runs `shadow_frame` with mterp. The instructions mterp does not handle are single-stepped
+// with the switch interpreter, which also runs the whole method while instrumentation needs it.
+static inline JValue ExecuteMterp(Thread* self,
+                                  const DexFile::CodeItem* code_item,
+                                  ShadowFrame& shadow_frame,
+                                  JValue result_register)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  while (true) {
+    // Mterp does not support all instrumentation/debugging.
+    if (MterpShouldSwitchInterpreters() != 0) {
+      return ExecuteSwitchImpl<false, false>(self, code_item, shadow_frame, result_register,
+                                             false);
+    }
+    bool returned = ExecuteMterpImpl(self, code_item, &shadow_frame, &result_register);
+    if (returned) {
+      MaybeSendMterpMethodExitEvent(self, code_item, shadow_frame, result_register);
+      return result_register;
+    } else {
+      // Mterp didn't like that instruction.  Single-step it with the reference interpreter.
+      result_register = ExecuteSwitchImpl<false, false>(self, code_item, shadow_frame,
+                                                         result_register, true);
+      if (shadow_frame.GetDexPC() == DexFile::kDexNoIndex) {
+        // Single-stepped a return or an exception not handled locally.  Return to caller.
+        return result_register;
+      }
+    }
+  }
+}
+
 static inline JValue Execute(
     Thread* self,
     const DexFile::CodeItem* code_item,
@@ -322,25 +370,7 @@ static inline JValue Execute(
         return ExecuteSwitchImpl<false, false>(self, code_item, shadow_frame, result_register,
                                                false);
       } else {
-        while (true) {
-          // Mterp does not support all instrumentation/debugging.
-          if (MterpShouldSwitchInterpreters() != 0) {
-            return ExecuteSwitchImpl<false, false>(self, code_item, shadow_frame, result_register,
-                                                   false);
-          }
-          bool returned = ExecuteMterpImpl(self, code_item, &shadow_frame, &result_register);
-          if (returned) {
-            return result_register;
-          } else {
-            // Mterp didn't like that instruction.  Single-step it with the reference interpreter.
-            result_register = ExecuteSwitchImpl<false, false>(self, code_item, shadow_frame,
-                                                               result_register, true);
-            if (shadow_frame.GetDexPC() == DexFile::kDexNoIndex) {
-              // Single-stepped a return or an exception not handled locally.  Return to caller.
-              return result_register;
-            }
-          }
-        }
+        return ExecuteMterp(self, code_item, shadow_frame, result_register);
       }
     } else if (kInterpreterImplKind == kSwitchImplKind) {
       if (transaction_active) {
@@ -657,6 +687,34 @@ void ArtInterpreterToInterpreterBridge(Thread* self, const DexFile::CodeItem* co
   self->PopShadowFrame();
 }
 
+void ArtInterpreterToMterpBridge(Thread* self, const DexFile::CodeItem* code_item,
+                                 ShadowFrame* shadow_frame, JValue* result) {
+  bool implicit_check = !Runtime::Current()->ExplicitStackOverflowChecks();
+  if (UNLIKELY(__builtin_frame_address(0) < self->GetStackEndForInterpreter(implicit_check))) {
+    ThrowStackOverflowError(self);
+    return;
+  }
+
+  self->PushShadowFrame(shadow_frame);
+  ArtMethod* method = shadow_frame->GetMethod();
+  DCHECK(method->SkipAccessChecks());
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    jit->MethodEntered(self, method);
+    if (UNLIKELY(jit->CanInvokeCompiledCode(method))) {
+      // The method just got its JIT code back from its ProfilingInfo, or was compiled now.
+      self->PopShadowFrame();
+      ArtInterpreterToCompiledCodeBridge(self, nullptr, code_item, shadow_frame, result);
+      return;
+    }
+  }
+  if (kIsDebugBuild) {
+    method->GetDeclaringClass()->AssertInitializedOrInitializingInThread(self);
+  }
+  result->SetJ(ExecuteMterp(self, code_item, *shadow_frame, JValue()).GetJ());
+  self->PopShadowFrame();
+}
+
 void CheckInterpreterAsmConstants() {
   CheckMterpAsmConstants();
 }
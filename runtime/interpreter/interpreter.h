@@ -53,6 +53,12 @@ void ArtInterpreterToInterpreterBridge(Thread* self, const DexFile::CodeItem* co
                                        ShadowFrame* shadow_frame, JValue* result)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+// Like ArtInterpreterToInterpreterBridge for a call from mterp to a method that
+// CanMterpFastCall accepted: runs it with mterp without the checks of Execute besides the JIT.
+void ArtInterpreterToMterpBridge(Thread* self, const DexFile::CodeItem* code_item,
+                                 ShadowFrame* shadow_frame, JValue* result)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
 // One-time sanity check.
 void CheckInterpreterAsmConstants();
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <utility>
+
+#include "atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+// A small per-thread cache of what the interpreter resolved field accesses and invokes to,
+// keyed by the address of the dex instruction. The values are ArtField* or ArtMethod* pointers,
+// or vtable indices, depending on the instruction. Running the same instruction again then
+// skips the dex cache lookup and the access checks, until the JIT has compiled the method.
+//
+// The entries of an instruction stay valid for as long as its dex file is loaded, as only
+// methods that skip access checks use the cache. When a class loader is freed, the address of
+// its dex files may be reused, so the caches of all threads are dropped the next time they are
+// used.
+class InterpreterCache {
+ public:
+  // A power of two.
+  static constexpr size_t kSize = 256u;
+
+  InterpreterCache() : generation_(generation_counter_.LoadRelaxed()) {
+    Clear();
+  }
+
+  ALWAYS_INLINE bool Get(const void* key, size_t* value) {
+    const uint32_t generation = generation_counter_.LoadRelaxed();
+    if (UNLIKELY(generation != generation_)) {
+      Clear();
+      generation_ = generation;
+      return false;
+    }
+    const Entry& entry = data_[IndexOf(key)];
+    if (LIKELY(entry.first == key)) {
+      *value = entry.second;
+      return true;
+    }
+    return false;
+  }
+
+  // Must follow a Get that missed, so that the entry is of the current generation.
+  ALWAYS_INLINE void Set(const void* key, size_t value) {
+    data_[IndexOf(key)] = Entry(key, value);
+  }
+
+  void Clear() {
+    data_.fill(Entry(nullptr, 0u));
+  }
+
+  // Drop the caches of all threads, called before a class loader and its dex files are freed.
+  static void InvalidateAll() {
+    generation_counter_.FetchAndAddSequentiallyConsistent(1u);
+  }
+
+ private:
+  typedef std::pair<const void*, size_t> Entry;
+
+  static size_t IndexOf(const void* key) {
+    // Dex instructions are 2-byte aligned.
+    return (reinterpret_cast<uintptr_t>(key) >> 1) & (kSize - 1u);
+  }
+
+  static Atomic<uint32_t> generation_counter_;
+
+  std::array<Entry, kSize> data_;
+  uint32_t generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+TEST(InterpreterCache, GetSet) {
+  uint16_t insns[2 * InterpreterCache::kSize];
+  InterpreterCache cache;
+  size_t value = 0u;
+  EXPECT_FALSE(cache.Get(&insns[0], &value));
+  cache.Set(&insns[0], 42u);
+  ASSERT_TRUE(cache.Get(&insns[0], &value));
+  EXPECT_EQ(42u, value);
+  EXPECT_FALSE(cache.Get(&insns[1], &value));
+
+  // An instruction that maps to the same entry evicts the first one.
+  cache.Set(&insns[InterpreterCache::kSize], 43u);
+  EXPECT_FALSE(cache.Get(&insns[0], &value));
+  ASSERT_TRUE(cache.Get(&insns[InterpreterCache::kSize], &value));
+  EXPECT_EQ(43u, value);
+}
+
+TEST(InterpreterCache, InvalidateAll) {
+  uint16_t insns[2];
+  InterpreterCache cache;
+  size_t value = 0u;
+  EXPECT_FALSE(cache.Get(&insns[0], &value));
+  cache.Set(&insns[0], 42u);
+  InterpreterCache::InvalidateAll();
+  EXPECT_FALSE(cache.Get(&insns[0], &value));
+  // Entries of the new generation stick.
+  cache.Set(&insns[0], 44u);
+  ASSERT_TRUE(cache.Get(&insns[0], &value));
+  EXPECT_EQ(44u, value);
+}
+
+}  // namespace art
@@ -822,6 +822,38 @@ bool DoCall(ArtMethod* called_method, Thread* self, ShadowFrame& shadow_frame,
       result, number_of_inputs, arg, vregC);
 }
 
+template<bool is_range>
+bool DoMterpFastCall(ArtMethod* called_method, Thread* self, ShadowFrame& shadow_frame,
+                     const Instruction* inst, uint16_t inst_data, JValue* result) {
+  DCHECK(CanMterpFastCall(called_method));
+  const DexFile::CodeItem* code_item = called_method->GetCodeItem();
+  const uint16_t num_regs = code_item->registers_size_;
+  const uint16_t number_of_inputs =
+      (is_range) ? inst->VRegA_3rc(inst_data) : inst->VRegA_35c(inst_data);
+  DCHECK_EQ(number_of_inputs, code_item->ins_size_);
+  const size_t first_dest_reg = num_regs - number_of_inputs;
+
+  // Copying the arguments cannot suspend, unlike the assignability checks of DoCallCommon.
+  ShadowFrameAllocaUniquePtr shadow_frame_unique_ptr =
+      CREATE_SHADOW_FRAME(num_regs, &shadow_frame, called_method, /* dex pc */ 0);
+  ShadowFrame* new_shadow_frame = shadow_frame_unique_ptr.get();
+  if (is_range) {
+    const size_t first_src_reg = inst->VRegC_3rc();
+    for (size_t i = 0; i < number_of_inputs; ++i) {
+      AssignRegister(new_shadow_frame, shadow_frame, first_dest_reg + i, first_src_reg + i);
+    }
+  } else {
+    uint32_t arg[Instruction::kMaxVarArgRegs];
+    inst->GetVarArgs(arg, inst_data);
+    for (size_t i = 0; i < number_of_inputs; ++i) {
+      AssignRegister(new_shadow_frame, shadow_frame, first_dest_reg + i, arg[i]);
+    }
+  }
+
+  ArtInterpreterToMterpBridge(self, code_item, new_shadow_frame, result);
+  return !self->IsExceptionPending();
+}
+
 template <bool is_range, bool do_access_check, bool transaction_active>
 bool DoFilledNewArray(const Instruction* inst, const ShadowFrame& shadow_frame,
                       Thread* self, JValue* result) {
@@ -947,6 +979,14 @@ EXPLICIT_DO_CALL_TEMPLATE_DECL(true, false);
 EXPLICIT_DO_CALL_TEMPLATE_DECL(true, true);
 #undef EXPLICIT_DO_CALL_TEMPLATE_DECL
 
+// Explicit DoMterpFastCall template function declarations.
+template SHARED_REQUIRES(Locks::mutator_lock_)
+bool DoMterpFastCall<false>(ArtMethod* method, Thread* self, ShadowFrame& shadow_frame,
+                            const Instruction* inst, uint16_t inst_data, JValue* result);
+template SHARED_REQUIRES(Locks::mutator_lock_)
+bool DoMterpFastCall<true>(ArtMethod* method, Thread* self, ShadowFrame& shadow_frame,
+                           const Instruction* inst, uint16_t inst_data, JValue* result);
+
 // Explicit DoLambdaCall template function declarations.
 #define EXPLICIT_DO_LAMBDA_CALL_TEMPLATE_DECL(_is_range, _do_assignability_check)               \
   template SHARED_REQUIRES(Locks::mutator_lock_)                                                \
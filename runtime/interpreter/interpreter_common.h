@@ -35,6 +35,7 @@
 #include "dex_instruction-inl.h"
 #include "entrypoints/entrypoint_utils-inl.h"
 #include "handle_scope-inl.h"
+#include "interpreter_cache.h"
 #include "jit/jit.h"
 #include "lambda/art_lambda_method.h"
 #include "lambda/box_table.h"
@@ -142,6 +143,36 @@ template<bool is_range, bool do_assignability_check>
 bool DoCall(ArtMethod* called_method, Thread* self, ShadowFrame& shadow_frame,
             const Instruction* inst, uint16_t inst_data, JValue* result);
 
+// Returns whether a call from mterp to `called_method` can use DoMterpFastCall: the callee
+// is resolved to the interpreter, runs without access checks and needs no class
+// initialization, String.<init> replacement or method entry and exit events.
+static inline bool CanMterpFastCall(ArtMethod* called_method)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  mirror::Class* declaring_class = called_method->GetDeclaringClass();
+  if (called_method->IsNative() ||
+      !called_method->SkipAccessChecks() ||
+      declaring_class->IsStringClass() ||
+      (called_method->IsStatic() && !declaring_class->IsInitialized())) {
+    return false;
+  }
+  Runtime* runtime = Runtime::Current();
+  const instrumentation::Instrumentation* instrumentation = runtime->GetInstrumentation();
+  if (instrumentation->HasMethodEntryListeners() || instrumentation->HasMethodExitListeners()) {
+    return false;
+  }
+  // Proxy methods and methods with compiled code or a resolution stub have other entrypoints.
+  return runtime->GetClassLinker()->IsQuickToInterpreterBridge(
+      called_method->GetEntryPointFromQuickCompiledCode());
+}
+
+// Invokes `called_method`, which CanMterpFastCall accepted, from mterp. Copies the arguments
+// into the callee frame and runs it with ArtInterpreterToMterpBridge.
+// Returns true on success, otherwise throws an exception and returns false.
+template<bool is_range>
+bool DoMterpFastCall(ArtMethod* called_method, Thread* self, ShadowFrame& shadow_frame,
+                     const Instruction* inst, uint16_t inst_data, JValue* result)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
 // Invokes the given lambda closure. This is part of the invocation support and is used by
 // DoLambdaInvoke functions.
 // Returns true on success, otherwise throws an exception and returns false.
@@ -624,16 +655,41 @@ static inline bool DoInvokeLambda(Thread* self, ShadowFrame& shadow_frame, const
 }
 
 // Handles invoke-XXX/range instructions (other than invoke-lambda[-range]).
+// With `from_mterp`, calls to methods that mterp can run itself use DoMterpFastCall.
 // Returns true on success, otherwise throws an exception and returns false.
-template<InvokeType type, bool is_range, bool do_access_check>
+template<InvokeType type, bool is_range, bool do_access_check, bool from_mterp = false>
 static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instruction* inst,
                             uint16_t inst_data, JValue* result) {
   const uint32_t method_idx = (is_range) ? inst->VRegB_3rc() : inst->VRegB_35c();
   const uint32_t vregC = (is_range) ? inst->VRegC_3rc() : inst->VRegC_35c();
   Object* receiver = (type == kStatic) ? nullptr : shadow_frame.GetVRegReference(vregC);
   ArtMethod* sf_method = shadow_frame.GetMethod();
-  ArtMethod* const called_method = FindMethodFromCode<type, do_access_check>(
-      method_idx, &receiver, sf_method, self);
+  // Methods that skip access checks remember what their static, direct and virtual invokes
+  // resolved to: the callee, or the vtable index of a virtual one.
+  constexpr bool kUseCache =
+      !do_access_check && (type == kStatic || type == kDirect || type == kVirtual);
+  InterpreterCache* const cache = self->GetInterpreterCache();
+  size_t cached = 0u;
+  ArtMethod* called_method;
+  if (kUseCache && cache->Get(inst, &cached) && (type == kStatic || receiver != nullptr)) {
+    called_method = (type == kVirtual)
+        ? receiver->GetClass()->GetVTableEntry(cached, kRuntimePointerSize)
+        : reinterpret_cast<ArtMethod*>(cached);
+  } else {
+    called_method = FindMethodFromCode<type, do_access_check>(
+        method_idx, &receiver, sf_method, self);
+    if (kUseCache && called_method != nullptr) {
+      if (type != kVirtual) {
+        cache->Set(inst, reinterpret_cast<size_t>(called_method));
+      } else {
+        ArtMethod* resolved_method =
+            Runtime::Current()->GetClassLinker()->GetResolvedMethod(method_idx, sf_method);
+        if (resolved_method != nullptr) {
+          cache->Set(inst, resolved_method->GetMethodIndex());
+        }
+      }
+    }
+  }
   // The shadow frame should already be pushed, so we don't need to update it.
   if (UNLIKELY(called_method == nullptr)) {
     CHECK(self->IsExceptionPending());
@@ -660,14 +716,18 @@ static inline bool DoInvoke(Thread* self, ShadowFrame& shadow_frame, const Instr
             self, receiver, sf_method, shadow_frame.GetDexPC(), called_method);
       }
     }
+    if (from_mterp && !do_access_check && CanMterpFastCall(called_method)) {
+      return DoMterpFastCall<is_range>(called_method, self, shadow_frame, inst, inst_data, result);
+    }
     return DoCall<is_range, do_access_check>(called_method, self, shadow_frame, inst, inst_data,
                                              result);
   }
 }
 
 // Handles invoke-virtual-quick and invoke-virtual-quick-range instructions.
+// `from_mterp` is as for DoInvoke.
 // Returns true on success, otherwise throws an exception and returns false.
-template<bool is_range>
+template<bool is_range, bool from_mterp = false>
 static inline bool DoInvokeVirtualQuick(Thread* self, ShadowFrame& shadow_frame,
                                         const Instruction* inst, uint16_t inst_data,
                                         JValue* result) {
@@ -705,6 +765,9 @@ static inline bool DoInvokeVirtualQuick(Thread* self, ShadowFrame& shadow_frame,
           self, receiver, shadow_frame.GetMethod(), shadow_frame.GetDexPC(), called_method);
     }
     // No need to check since we've been quickened.
+    if (from_mterp && CanMterpFastCall(called_method)) {
+      return DoMterpFastCall<is_range>(called_method, self, shadow_frame, inst, inst_data, result);
+    }
     return DoCall<is_range, false>(called_method, self, shadow_frame, inst, inst_data, result);
   }
 }
@@ -938,11 +1001,22 @@ static inline bool DoBoxLambda(Thread* self, ShadowFrame& shadow_frame, const In
   return true;
 }
 
+// Returns the size of the storage that DoUnboxLambda needs for the closure of an unbox-lambda,
+// or 0 if vB is not a boxed lambda, in which case DoUnboxLambda throws without using it.
+static inline size_t GetUnboxLambdaClosureSize(ShadowFrame& shadow_frame, const Instruction* inst)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  return lambda::BoxTable::GetUnboxedClosureSize(
+      shadow_frame.GetVRegReference(inst->VRegB_22c()));
+}
+
+// The closure is written into uninitialized_closure, which must be at least as large as
+// GetUnboxLambdaClosureSize. Like the closures of create-lambda, it is owned by the caller.
 template <bool _do_check> SHARED_REQUIRES(Locks::mutator_lock_)
 static inline bool DoUnboxLambda(Thread* self,
                                  ShadowFrame& shadow_frame,
                                  const Instruction* inst,
-                                 uint16_t inst_data) {
+                                 uint16_t inst_data,
+                                 /*inout*/lambda::Closure* uninitialized_closure) {
   /*
    * unbox-lambda vA, vB, [type id] /// opcode 0xf9, format 22c
    * - vA is the target register where the closure will be written into
@@ -959,16 +1033,14 @@ static inline bool DoUnboxLambda(Thread* self,
     return false;
   }
 
-  lambda::Closure* unboxed_closure = nullptr;
   // Raise an exception if unboxing fails.
   if (!Runtime::Current()->GetLambdaBoxTable()->UnboxLambda(boxed_closure_object,
-                                                            /*out*/&unboxed_closure)) {
+                                                            /*out*/uninitialized_closure)) {
     CHECK(self->IsExceptionPending());
     return false;
   }
 
-  DCHECK(unboxed_closure != nullptr);
-  WriteLambdaClosureIntoVRegs(/*inout*/shadow_frame, *unboxed_closure, vreg_target_closure);
+  WriteLambdaClosureIntoVRegs(/*inout*/shadow_frame, *uninitialized_closure, vreg_target_closure);
   return true;
 }
 
@@ -1095,7 +1167,7 @@ EXPLICIT_DO_BOX_LAMBDA_DECL(true);   // box-lambda
 #define EXPLICIT_DO_UNBOX_LAMBDA_DECL(_do_check)                                                \
 template SHARED_REQUIRES(Locks::mutator_lock_)                                            \
 bool DoUnboxLambda<_do_check>(Thread* self, ShadowFrame& shadow_frame, const Instruction* inst, \
-                              uint16_t inst_data);
+                              uint16_t inst_data, lambda::Closure* uninitialized_closure);
 
 EXPLICIT_DO_UNBOX_LAMBDA_DECL(false);  // unbox-lambda
 EXPLICIT_DO_UNBOX_LAMBDA_DECL(true);   // unbox-lambda
@@ -69,6 +69,10 @@ namespace interpreter {
     if (UNLIKELY(instrumentation->HasBranchListeners())) {                                      \
       instrumentation->Branch(self, method, dex_pc, offset);                                    \
     }                                                                                           \
+    if (jit != nullptr && !inst->IsUnconditional() && inst->IsBranch()) {                       \
+      jit->ConditionalBranch(                                                                   \
+          self, method, dex_pc, offset != static_cast<int32_t>(inst->SizeInCodeUnits()));       \
+    }                                                                                           \
     JValue result;                                                                              \
     if (jit::Jit::MaybeDoOnStackReplacement(self, method, dex_pc, offset, &result)) {           \
       return result;                                                                            \
@@ -2483,7 +2487,14 @@ JValue ExecuteGotoImpl(Thread* self, const DexFile::CodeItem* code_item, ShadowF
   HANDLE_EXPERIMENTAL_INSTRUCTION_END();
 
   HANDLE_EXPERIMENTAL_INSTRUCTION_START(UNBOX_LAMBDA) {
-    bool success = DoUnboxLambda<do_access_check>(self, shadow_frame, inst, inst_data);
+    // The unboxed closure lives in this frame, like the closures of create-lambda.
+    lambda::Closure* lambda_closure = reinterpret_cast<lambda::Closure*>(
+        alloca(GetUnboxLambdaClosureSize(shadow_frame, inst)));
+    bool success = DoUnboxLambda<do_access_check>(self,
+                                                  shadow_frame,
+                                                  inst,
+                                                  inst_data,
+                                                  /*inout*/lambda_closure);
     POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, 2);
   }
   HANDLE_EXPERIMENTAL_INSTRUCTION_END();
@@ -16,6 +16,7 @@
 
 #include "base/enums.h"
 #include "base/stl_util.h"  // MakeUnique
+#include "dispatch_profiler.h"
 #include "experimental_flags.h"
 #include "interpreter_common.h"
 #include "jit/jit.h"
@@ -75,6 +76,10 @@ namespace interpreter {
     if (UNLIKELY(instrumentation->HasBranchListeners())) {                                     \
       instrumentation->Branch(self, method, dex_pc, offset);                                   \
     }                                                                                          \
+    if (jit != nullptr && !inst->IsUnconditional() && inst->IsBranch()) {                      \
+      jit->ConditionalBranch(                                                                  \
+          self, method, dex_pc, offset != static_cast<int32_t>(inst->SizeInCodeUnits()));      \
+    }                                                                                          \
     JValue result;                                                                             \
     if (jit::Jit::MaybeDoOnStackReplacement(self, method, dex_pc, offset, &result)) {          \
       if (interpret_one_instruction) {                                                         \
@@ -125,6 +130,9 @@ JValue ExecuteSwitchImpl(Thread* self, const DexFile::CodeItem* code_item,
     shadow_frame.SetDexPC(dex_pc);
     TraceExecution(shadow_frame, inst, dex_pc);
     inst_data = inst->Fetch16(0);
+    if (UNLIKELY(DispatchProfiler::IsEnabled())) {
+      DispatchProfiler::RecordInstruction(self, method, inst->Opcode(inst_data));
+    }
     switch (inst->Opcode(inst_data)) {
       case Instruction::NOP:
         PREAMBLE();
@@ -2424,7 +2432,14 @@ JValue ExecuteSwitchImpl(Thread* self, const DexFile::CodeItem* code_item,
         }
 
         PREAMBLE();
-        bool success = DoUnboxLambda<do_access_check>(self, shadow_frame, inst, inst_data);
+        // The unboxed closure lives in this frame, like the closures of create-lambda.
+        lambda::Closure* lambda_closure = reinterpret_cast<lambda::Closure*>(
+            alloca(GetUnboxLambdaClosureSize(shadow_frame, inst)));
+        bool success = DoUnboxLambda<do_access_check>(self,
+                                                      shadow_frame,
+                                                      inst,
+                                                      inst_data,
+                                                      /*inout*/lambda_closure);
         POSSIBLY_HANDLE_PENDING_EXCEPTION(!success, Next_2xx);
         break;
       }
@@ -17,10 +17,11 @@
 /*
  * Mterp entry point and support functions.
  */
+#include "interpreter/dispatch_profiler.h"
 #include "interpreter/interpreter_common.h"
+#include "interpreter/opcode_pair_profiler.h"
 #include "entrypoints/entrypoint_utils-inl.h"
 #include "mterp.h"
-#include "debugger.h"
 
 namespace art {
 namespace interpreter {
@@ -46,9 +47,11 @@ void CheckMterpAsmConstants() {
 void InitMterpTls(Thread* self) {
   self->SetMterpDefaultIBase(artMterpAsmInstructionStart);
   self->SetMterpAltIBase(artMterpAsmAltInstructionStart);
-  self->SetMterpCurrentIBase((kTraceExecutionEnabled || kTestExportPC) ?
-                             artMterpAsmAltInstructionStart :
-                             artMterpAsmInstructionStart);
+  self->SetMterpCurrentIBase(
+      (kTraceExecutionEnabled || kTestExportPC || OpcodePairProfiler::IsEnabled() ||
+       DispatchProfiler::IsEnabled()) ?
+          artMterpAsmAltInstructionStart :
+          artMterpAsmInstructionStart);
 }
 
 /*
@@ -146,7 +149,10 @@ extern "C" size_t MterpShouldSwitchInterpreters()
     SHARED_REQUIRES(Locks::mutator_lock_) {
   const instrumentation::Instrumentation* const instrumentation =
       Runtime::Current()->GetInstrumentation();
-  return instrumentation->NonJitProfilingActive() || Dbg::IsDebuggerActive();
+  // Method entry and exit events are sent by Execute, the exception caught and method unwind
+  // events by MterpHandleException. The debugger gets its events through listeners too, so it
+  // only forces a switch while it is stepping, watching fields or has breakpoints.
+  return instrumentation->HasPerInstructionListeners();
 }
 
 
@@ -157,7 +163,7 @@ extern "C" size_t MterpInvokeVirtual(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kVirtual, false, false>(
+  return DoInvoke<kVirtual, false, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -168,7 +174,7 @@ extern "C" size_t MterpInvokeSuper(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kSuper, false, false>(
+  return DoInvoke<kSuper, false, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -179,7 +185,7 @@ extern "C" size_t MterpInvokeInterface(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kInterface, false, false>(
+  return DoInvoke<kInterface, false, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -190,7 +196,7 @@ extern "C" size_t MterpInvokeDirect(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kDirect, false, false>(
+  return DoInvoke<kDirect, false, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -201,7 +207,7 @@ extern "C" size_t MterpInvokeStatic(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kStatic, false, false>(
+  return DoInvoke<kStatic, false, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -212,7 +218,7 @@ extern "C" size_t MterpInvokeVirtualRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kVirtual, true, false>(
+  return DoInvoke<kVirtual, true, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -223,7 +229,7 @@ extern "C" size_t MterpInvokeSuperRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kSuper, true, false>(
+  return DoInvoke<kSuper, true, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -234,7 +240,7 @@ extern "C" size_t MterpInvokeInterfaceRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kInterface, true, false>(
+  return DoInvoke<kInterface, true, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -245,7 +251,7 @@ extern "C" size_t MterpInvokeDirectRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kDirect, true, false>(
+  return DoInvoke<kDirect, true, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -256,7 +262,7 @@ extern "C" size_t MterpInvokeStaticRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvoke<kStatic, true, false>(
+  return DoInvoke<kStatic, true, false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -267,7 +273,7 @@ extern "C" size_t MterpInvokeVirtualQuick(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvokeVirtualQuick<false>(
+  return DoInvokeVirtualQuick<false, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -278,7 +284,7 @@ extern "C" size_t MterpInvokeVirtualQuickRange(Thread* self,
     SHARED_REQUIRES(Locks::mutator_lock_) {
   JValue* result_register = shadow_frame->GetResultRegister();
   const Instruction* inst = Instruction::At(dex_pc_ptr);
-  return DoInvokeVirtualQuick<true>(
+  return DoInvokeVirtualQuick<true, /* from_mterp */ true>(
       self, *shadow_frame, inst, inst_data, result_register);
 }
 
@@ -482,6 +488,18 @@ extern "C" void MterpCheckBefore(Thread* self, ShadowFrame* shadow_frame, uint16
     uint32_t dex_pc = dex_pc_ptr - shadow_frame->GetCodeItem()->insns_;
     TraceExecution(*shadow_frame, inst, dex_pc);
   }
+  if (UNLIKELY(DispatchProfiler::IsEnabled())) {
+    DispatchProfiler::RecordInstruction(self, shadow_frame->GetMethod(), inst->Opcode(inst_data));
+  }
+  if (UNLIKELY(OpcodePairProfiler::IsEnabled())) {
+    // Pair the instruction with the one that follows it in the code, whether or not a branch is
+    // taken, since that is the pair a fused handler would cover.
+    const DexFile::CodeItem* code_item = shadow_frame->GetCodeItem();
+    const uint16_t* next = dex_pc_ptr + inst->SizeInCodeUnits();
+    if (next < code_item->insns_ + code_item->insns_size_in_code_units_) {
+      OpcodePairProfiler::Record(inst->Opcode(inst_data), Instruction::At(next)->Opcode());
+    }
+  }
   if (kTestExportPC) {
     // Save invalid dex pc to force segfault if improperly used.
     shadow_frame->SetDexPCPtr(reinterpret_cast<uint16_t*>(kExportPCPoison));
@@ -571,13 +589,161 @@ extern "C" size_t MterpSuspendCheck(Thread* self)
   return MterpShouldSwitchInterpreters();
 }
 
+// Returns the field that the access at the dex pc exported by mterp resolves to, without
+// throwing, and remembers it in the interpreter cache of `self`.
+template<FindFieldType kType, size_t kExpectedSize>
+ALWAYS_INLINE static ArtField* MterpFindFieldFast(uint32_t field_idx,
+                                                  ArtMethod* referrer,
+                                                  Thread* self)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  const uint16_t* dex_pc_ptr = self->GetManagedStack()->GetTopShadowFrame()->GetDexPCPtr();
+  InterpreterCache* cache = self->GetInterpreterCache();
+  size_t value;
+  if (LIKELY(cache->Get(dex_pc_ptr, &value))) {
+    return reinterpret_cast<ArtField*>(value);
+  }
+  ArtField* field = FindFieldFast(field_idx, referrer, kType, kExpectedSize);
+  if (field != nullptr) {
+    cache->Set(dex_pc_ptr, reinterpret_cast<size_t>(field));
+  }
+  return field;
+}
+
+// The field entrypoints of compiled code, used for the cases the cache does not cover. They
+// resolve the field and throw if needed.
+extern "C" ssize_t artGetByteInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" size_t artGetBooleanInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" ssize_t artGetShortInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" size_t artGetCharInstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" size_t artGet32InstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" uint64_t artGet64InstanceFromCode(uint32_t, mirror::Object*, ArtMethod*, Thread*);
+extern "C" mirror::Object* artGetObjInstanceFromCode(uint32_t,
+                                                     mirror::Object*,
+                                                     ArtMethod*,
+                                                     Thread*);
+extern "C" ssize_t artGetByteStaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" size_t artGetBooleanStaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" ssize_t artGetShortStaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" size_t artGetCharStaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" size_t artGet32StaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" uint64_t artGet64StaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" mirror::Object* artGetObjStaticFromCode(uint32_t, ArtMethod*, Thread*);
+extern "C" int artSet8StaticFromCode(uint32_t, uint32_t, ArtMethod*, Thread*);
+extern "C" int artSet16StaticFromCode(uint32_t, uint16_t, ArtMethod*, Thread*);
+extern "C" int artSet32StaticFromCode(uint32_t, uint32_t, ArtMethod*, Thread*);
+
+#define MTERP_INSTANCE_FIELD_GETTER(Kind, RetType, FieldType, Getter)                          \
+extern "C" RetType artGet##Kind##InstanceFromMterp(uint32_t field_idx,                          \
+                                                   mirror::Object* obj,                        \
+                                                   ArtMethod* referrer,                        \
+                                                   Thread* self)                               \
+    SHARED_REQUIRES(Locks::mutator_lock_) {                                                    \
+  ArtField* field = MterpFindFieldFast<FieldType, kFieldSize##Kind>(field_idx, referrer, self); \
+  if (LIKELY(field != nullptr && obj != nullptr)) {                                            \
+    return field->Getter(obj);                                                                 \
+  }                                                                                            \
+  return artGet##Kind##InstanceFromCode(field_idx, obj, referrer, self);                       \
+}
+
+#define MTERP_STATIC_FIELD_GETTER(Kind, RetType, FieldType, Getter)                            \
+extern "C" RetType artGet##Kind##StaticFromMterp(uint32_t field_idx,                            \
+                                                 ArtMethod* referrer,                          \
+                                                 Thread* self)                                 \
+    SHARED_REQUIRES(Locks::mutator_lock_) {                                                    \
+  ArtField* field = MterpFindFieldFast<FieldType, kFieldSize##Kind>(field_idx, referrer, self); \
+  if (LIKELY(field != nullptr)) {                                                              \
+    return field->Getter(field->GetDeclaringClass());                                          \
+  }                                                                                            \
+  return artGet##Kind##StaticFromCode(field_idx, referrer, self);                              \
+}
+
+static constexpr size_t kFieldSizeByte = sizeof(int8_t);
+static constexpr size_t kFieldSizeBoolean = sizeof(int8_t);
+static constexpr size_t kFieldSizeShort = sizeof(int16_t);
+static constexpr size_t kFieldSizeChar = sizeof(int16_t);
+static constexpr size_t kFieldSize32 = sizeof(int32_t);
+static constexpr size_t kFieldSize64 = sizeof(int64_t);
+static constexpr size_t kFieldSizeObj = sizeof(mirror::HeapReference<mirror::Object>);
+
+MTERP_INSTANCE_FIELD_GETTER(Byte, ssize_t, InstancePrimitiveRead, GetByte)
+MTERP_INSTANCE_FIELD_GETTER(Boolean, size_t, InstancePrimitiveRead, GetBoolean)
+MTERP_INSTANCE_FIELD_GETTER(Short, ssize_t, InstancePrimitiveRead, GetShort)
+MTERP_INSTANCE_FIELD_GETTER(Char, size_t, InstancePrimitiveRead, GetChar)
+MTERP_INSTANCE_FIELD_GETTER(32, size_t, InstancePrimitiveRead, Get32)
+MTERP_INSTANCE_FIELD_GETTER(64, uint64_t, InstancePrimitiveRead, Get64)
+MTERP_INSTANCE_FIELD_GETTER(Obj, mirror::Object*, InstanceObjectRead, GetObj)
+
+MTERP_STATIC_FIELD_GETTER(Byte, ssize_t, StaticPrimitiveRead, GetByte)
+MTERP_STATIC_FIELD_GETTER(Boolean, size_t, StaticPrimitiveRead, GetBoolean)
+MTERP_STATIC_FIELD_GETTER(Short, ssize_t, StaticPrimitiveRead, GetShort)
+MTERP_STATIC_FIELD_GETTER(Char, size_t, StaticPrimitiveRead, GetChar)
+MTERP_STATIC_FIELD_GETTER(32, size_t, StaticPrimitiveRead, Get32)
+MTERP_STATIC_FIELD_GETTER(64, uint64_t, StaticPrimitiveRead, Get64)
+MTERP_STATIC_FIELD_GETTER(Obj, mirror::Object*, StaticObjectRead, GetObj)
+
+#undef MTERP_INSTANCE_FIELD_GETTER
+#undef MTERP_STATIC_FIELD_GETTER
+
+extern "C" int artSet8StaticFromMterp(uint32_t field_idx,
+                                      uint32_t new_value,
+                                      ArtMethod* referrer,
+                                      Thread* self)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  ArtField* field =
+      MterpFindFieldFast<StaticPrimitiveWrite, sizeof(int8_t)>(field_idx, referrer, self);
+  if (LIKELY(field != nullptr)) {
+    if (field->GetTypeAsPrimitiveType() == Primitive::kPrimBoolean) {
+      field->SetBoolean<false>(field->GetDeclaringClass(), new_value);
+    } else {
+      DCHECK_EQ(Primitive::kPrimByte, field->GetTypeAsPrimitiveType());
+      field->SetByte<false>(field->GetDeclaringClass(), new_value);
+    }
+    return 0;  // success
+  }
+  return artSet8StaticFromCode(field_idx, new_value, referrer, self);
+}
+
+extern "C" int artSet16StaticFromMterp(uint32_t field_idx,
+                                       uint16_t new_value,
+                                       ArtMethod* referrer,
+                                       Thread* self)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  ArtField* field =
+      MterpFindFieldFast<StaticPrimitiveWrite, sizeof(int16_t)>(field_idx, referrer, self);
+  if (LIKELY(field != nullptr)) {
+    if (field->GetTypeAsPrimitiveType() == Primitive::kPrimChar) {
+      field->SetChar<false>(field->GetDeclaringClass(), new_value);
+    } else {
+      DCHECK_EQ(Primitive::kPrimShort, field->GetTypeAsPrimitiveType());
+      field->SetShort<false>(field->GetDeclaringClass(), new_value);
+    }
+    return 0;  // success
+  }
+  return artSet16StaticFromCode(field_idx, new_value, referrer, self);
+}
+
+extern "C" int artSet32StaticFromMterp(uint32_t field_idx,
+                                       uint32_t new_value,
+                                       ArtMethod* referrer,
+                                       Thread* self)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  ArtField* field =
+      MterpFindFieldFast<StaticPrimitiveWrite, sizeof(int32_t)>(field_idx, referrer, self);
+  if (LIKELY(field != nullptr)) {
+    field->Set32<false>(field->GetDeclaringClass(), new_value);
+    return 0;  // success
+  }
+  return artSet32StaticFromCode(field_idx, new_value, referrer, self);
+}
+
 extern "C" ssize_t artSet64IndirectStaticFromMterp(uint32_t field_idx,
                                                    ArtMethod* referrer,
                                                    uint64_t* new_value,
                                                    Thread* self)
     SHARED_REQUIRES(Locks::mutator_lock_) {
   ScopedQuickEntrypointChecks sqec(self);
-  ArtField* field = FindFieldFast(field_idx, referrer, StaticPrimitiveWrite, sizeof(int64_t));
+  ArtField* field =
+      MterpFindFieldFast<StaticPrimitiveWrite, sizeof(int64_t)>(field_idx, referrer, self);
   if (LIKELY(field != nullptr)) {
     // Compiled code can't use transactional mode.
     field->Set64<false>(field->GetDeclaringClass(), *new_value);
@@ -597,7 +763,8 @@ extern "C" ssize_t artSet8InstanceFromMterp(uint32_t field_idx,
                                             uint8_t new_value,
                                             ArtMethod* referrer)
     SHARED_REQUIRES(Locks::mutator_lock_) {
-  ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite, sizeof(int8_t));
+  ArtField* field = MterpFindFieldFast<InstancePrimitiveWrite, sizeof(int8_t)>(
+      field_idx, referrer, Thread::Current());
   if (LIKELY(field != nullptr && obj != nullptr)) {
     Primitive::Type type = field->GetTypeAsPrimitiveType();
     if (type == Primitive::kPrimBoolean) {
@@ -616,8 +783,8 @@ extern "C" ssize_t artSet16InstanceFromMterp(uint32_t field_idx,
                                              uint16_t new_value,
                                              ArtMethod* referrer)
     SHARED_REQUIRES(Locks::mutator_lock_) {
-  ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
-                                          sizeof(int16_t));
+  ArtField* field = MterpFindFieldFast<InstancePrimitiveWrite, sizeof(int16_t)>(
+      field_idx, referrer, Thread::Current());
   if (LIKELY(field != nullptr && obj != nullptr)) {
     Primitive::Type type = field->GetTypeAsPrimitiveType();
     if (type == Primitive::kPrimChar) {
@@ -636,8 +803,8 @@ extern "C" ssize_t artSet32InstanceFromMterp(uint32_t field_idx,
                                              uint32_t new_value,
                                              ArtMethod* referrer)
     SHARED_REQUIRES(Locks::mutator_lock_) {
-  ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
-                                          sizeof(int32_t));
+  ArtField* field = MterpFindFieldFast<InstancePrimitiveWrite, sizeof(int32_t)>(
+      field_idx, referrer, Thread::Current());
   if (LIKELY(field != nullptr && obj != nullptr)) {
     field->Set32<false>(obj, new_value);
     return 0;  // success
@@ -650,8 +817,8 @@ extern "C" ssize_t artSet64InstanceFromMterp(uint32_t field_idx,
                                              uint64_t* new_value,
                                              ArtMethod* referrer)
     SHARED_REQUIRES(Locks::mutator_lock_) {
-  ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
-                                          sizeof(int64_t));
+  ArtField* field = MterpFindFieldFast<InstancePrimitiveWrite, sizeof(int64_t)>(
+      field_idx, referrer, Thread::Current());
   if (LIKELY(field != nullptr  && obj != nullptr)) {
     field->Set64<false>(obj, *new_value);
     return 0;  // success
@@ -664,8 +831,9 @@ extern "C" ssize_t artSetObjInstanceFromMterp(uint32_t field_idx,
                                               mirror::Object* new_value,
                                               ArtMethod* referrer)
     SHARED_REQUIRES(Locks::mutator_lock_) {
-  ArtField* field = FindFieldFast(field_idx, referrer, InstanceObjectWrite,
-                                          sizeof(mirror::HeapReference<mirror::Object>));
+  ArtField* field =
+      MterpFindFieldFast<InstanceObjectWrite, sizeof(mirror::HeapReference<mirror::Object>)>(
+          field_idx, referrer, Thread::Current());
   if (LIKELY(field != nullptr && obj != nullptr)) {
     field->SetObj<false>(obj, new_value);
     return 0;  // success
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "opcode_pair_profiler.h"
+
+#include <algorithm>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "base/stringprintf.h"
+
+namespace art {
+namespace interpreter {
+
+Atomic<bool> OpcodePairProfiler::enabled_(false);
+
+namespace {
+
+// Only the most frequent pairs are dumped.
+static constexpr size_t kMaxDumpedEntries = 20;
+static constexpr size_t kNumOpcodes = 256u;
+
+struct OpcodePairData {
+  // Indexed by first * kNumOpcodes + second. Relaxed increments, a few lost counts do not matter
+  // for the ranking and they are cheaper than a lock taken before every instruction.
+  Atomic<uint32_t> counts[kNumOpcodes * kNumOpcodes];
+};
+
+// Created when first enabled and never deleted, threads may still be recording.
+Atomic<OpcodePairData*> gOpcodePairData(nullptr);
+
+}  // namespace
+
+void OpcodePairProfiler::SetEnabled(bool enabled) {
+  if (enabled && gOpcodePairData.LoadAcquire() == nullptr) {
+    OpcodePairData* data = new OpcodePairData();
+    if (!gOpcodePairData.CompareExchangeStrongSequentiallyConsistent(nullptr, data)) {
+      delete data;  // Lost the race with another thread enabling the profiler.
+    }
+  }
+  enabled_.StoreRelaxed(enabled);
+}
+
+void OpcodePairProfiler::Record(Instruction::Code first, Instruction::Code second) {
+  OpcodePairData* data = gOpcodePairData.LoadAcquire();
+  if (data == nullptr || !IsEnabled()) {
+    return;
+  }
+  data->counts[static_cast<size_t>(first) * kNumOpcodes + static_cast<size_t>(second)]
+      .FetchAndAddRelaxed(1u);
+}
+
+bool OpcodePairProfiler::Dump(std::ostream& os) {
+  OpcodePairData* data = gOpcodePairData.LoadAcquire();
+  if (data == nullptr) {
+    return false;
+  }
+  typedef std::pair<uint32_t, size_t> Entry;  // Count and index.
+  std::vector<Entry> entries;
+  uint64_t total = 0u;
+  for (size_t i = 0; i != kNumOpcodes * kNumOpcodes; ++i) {
+    uint32_t count = data->counts[i].LoadRelaxed();
+    if (count != 0u) {
+      entries.emplace_back(count, i);
+      total += count;
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+  });
+  os << "Opcode pair profile (" << (IsEnabled() ? "enabled" : "disabled") << "): "
+     << entries.size() << " pairs, " << total << " dispatches\n";
+  for (size_t i = 0, e = std::min(entries.size(), kMaxDumpedEntries); i != e; ++i) {
+    Instruction::Code first = static_cast<Instruction::Code>(entries[i].second / kNumOpcodes);
+    Instruction::Code second = static_cast<Instruction::Code>(entries[i].second % kNumOpcodes);
+    os << "  " << entries[i].first << " times ("
+       << StringPrintf("%.2f", 100.0 * entries[i].first / total) << "%): "
+       << Instruction::Name(first) << " -> " << Instruction::Name(second) << "\n";
+  }
+  return true;
+}
+
+void OpcodePairProfiler::Reset() {
+  OpcodePairData* data = gOpcodePairData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  for (Atomic<uint32_t>& count : data->counts) {
+    count.StoreRelaxed(0u);
+  }
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_OPCODE_PAIR_PROFILER_H_
+#define ART_RUNTIME_INTERPRETER_OPCODE_PAIR_PROFILER_H_
+
+#include <iosfwd>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "dex_instruction.h"
+
+namespace art {
+namespace interpreter {
+
+// Counts, when enabled with -Xopcodepairprofile, how often each dex opcode is followed by each
+// other opcode in the instruction stream executed by mterp. The histogram is meant to pick the
+// pairs worth fusing into super-instruction handlers. Enabling it makes mterp run its alternate
+// handlers, which call out before every instruction, so it must be enabled before the threads
+// are attached. Dumped on SIGQUIT and through VMDebug.
+class OpcodePairProfiler {
+ public:
+  static void SetEnabled(bool enabled);
+
+  static bool IsEnabled() {
+    return enabled_.LoadRelaxed();
+  }
+
+  // Record that `second` was reached right after `first` without an intervening branch.
+  static void Record(Instruction::Code first, Instruction::Code second);
+
+  // Returns false and dumps nothing if the profiler was never enabled.
+  static bool Dump(std::ostream& os);
+
+  // Drop the counts gathered so far.
+  static void Reset();
+
+ private:
+  static Atomic<bool> enabled_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(OpcodePairProfiler);
+};
+
+}  // namespace interpreter
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_OPCODE_PAIR_PROFILER_H_
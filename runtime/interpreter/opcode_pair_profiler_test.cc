@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "opcode_pair_profiler.h"
+
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace art {
+namespace interpreter {
+
+TEST(OpcodePairProfilerTest, RanksPairs) {
+  OpcodePairProfiler::SetEnabled(true);
+  OpcodePairProfiler::Reset();
+  EXPECT_TRUE(OpcodePairProfiler::IsEnabled());
+
+  for (size_t i = 0; i != 3u; ++i) {
+    OpcodePairProfiler::Record(Instruction::CONST_4, Instruction::IF_EQZ);
+  }
+  OpcodePairProfiler::Record(Instruction::INVOKE_STATIC, Instruction::MOVE_RESULT);
+  OpcodePairProfiler::SetEnabled(false);
+  // Not counted while disabled.
+  OpcodePairProfiler::Record(Instruction::INVOKE_STATIC, Instruction::MOVE_RESULT);
+
+  std::ostringstream os;
+  ASSERT_TRUE(OpcodePairProfiler::Dump(os));
+  std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find("(disabled): 2 pairs, 4 dispatches\n"));
+  size_t const_if = dump.find("  3 times (75.00%): const/4 -> if-eqz\n");
+  size_t invoke_move = dump.find("  1 times (25.00%): invoke-static -> move-result\n");
+  ASSERT_NE(std::string::npos, const_if);
+  ASSERT_NE(std::string::npos, invoke_move);
+  EXPECT_LT(const_if, invoke_move);
+
+  OpcodePairProfiler::Reset();
+  std::ostringstream empty;
+  ASSERT_TRUE(OpcodePairProfiler::Dump(empty));
+  EXPECT_EQ(std::string::npos, empty.str().find("const/4"));
+}
+
+}  // namespace interpreter
+}  // namespace art
@@ -43,7 +43,7 @@
 namespace art {
 
 static size_t gGlobalsInitial = 512;  // Arbitrary.
-static size_t gGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
+static size_t gGlobalsMax = 51200;  // Arbitrary sanity check per stripe. (Must fit in 16 bits.)
 
 static const size_t kWeakGlobalsInitial = 16;  // Arbitrary.
 static const size_t kWeakGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
@@ -231,12 +231,11 @@ class Libraries {
     libraries_.Put(path, library);
   }
 
-  // See section 11.3 "Linking Native Methods" of the JNI spec.
-  void* FindNativeMethod(ArtMethod* m, std::string& detail)
+  // See section 11.3 "Linking Native Methods" of the JNI spec. Looks `jni_name` up in the
+  // libraries loaded by the class loader of `m`.
+  void* FindNativeMethod(ArtMethod* m, const std::string& jni_name)
       REQUIRES(Locks::jni_libraries_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_) {
-    std::string jni_short_name(JniShortName(m));
-    std::string jni_long_name(JniLongName(m));
     mirror::ClassLoader* const declaring_class_loader = m->GetDeclaringClass()->GetClassLoader();
     ScopedObjectAccessUnchecked soa(Thread::Current());
     void* const declaring_class_loader_allocator =
@@ -249,24 +248,16 @@ class Libraries {
         // We only search libraries loaded by the appropriate ClassLoader.
         continue;
       }
-      // Try the short name then the long name...
       const char* shorty = library->NeedsNativeBridge()
           ? m->GetShorty()
           : nullptr;
-      void* fn = library->FindSymbol(jni_short_name, shorty);
-      if (fn == nullptr) {
-        fn = library->FindSymbol(jni_long_name, shorty);
-      }
+      void* fn = library->FindSymbol(jni_name, shorty);
       if (fn != nullptr) {
         VLOG(jni) << "[Found native code for " << PrettyMethod(m)
                   << " in \"" << library->GetPath() << "\"]";
         return fn;
       }
     }
-    detail += "No implementation found for ";
-    detail += PrettyMethod(m);
-    detail += " (tried " + jni_short_name + " and " + jni_long_name + ")";
-    LOG(ERROR) << detail;
     return nullptr;
   }
 
@@ -429,8 +420,6 @@ JavaVMExt::JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options
       tracing_enabled_(runtime_options.Exists(RuntimeArgumentMap::JniTrace)
                        || VLOG_IS_ON(third_party_jni)),
       trace_(runtime_options.GetOrDefault(RuntimeArgumentMap::JniTrace)),
-      globals_lock_("JNI global reference table lock"),
-      globals_(gGlobalsInitial, gGlobalsMax, kGlobal),
       libraries_(new Libraries),
       unchecked_functions_(&gJniInvokeInterface),
       weak_globals_lock_("JNI weak global reference table lock", kJniWeakGlobalsLock),
@@ -439,6 +428,11 @@ JavaVMExt::JavaVMExt(Runtime* runtime, const RuntimeArgumentMap& runtime_options
       weak_globals_add_condition_("weak globals add condition", weak_globals_lock_) {
   functions = unchecked_functions_;
   SetCheckJniEnabled(runtime_options.Exists(RuntimeArgumentMap::CheckJni));
+  for (size_t stripe = 0; stripe != kGlobalsStripes; ++stripe) {
+    globals_locks_[stripe].reset(new ReaderWriterMutex("JNI global reference table lock"));
+    globals_[stripe].reset(new IndirectReferenceTable(
+        gGlobalsInitial / kGlobalsStripes, gGlobalsMax, kGlobal, true, stripe));
+  }
 }
 
 JavaVMExt::~JavaVMExt() {
@@ -523,8 +517,9 @@ jobject JavaVMExt::AddGlobalRef(Thread* self, mirror::Object* obj) {
   if (obj == nullptr) {
     return nullptr;
   }
-  WriterMutexLock mu(self, globals_lock_);
-  IndirectRef ref = globals_.Add(IRT_FIRST_SEGMENT, obj);
+  const size_t stripe = self->GetThreadId() % kGlobalsStripes;
+  WriterMutexLock mu(self, *globals_locks_[stripe]);
+  IndirectRef ref = globals_[stripe]->Add(IRT_FIRST_SEGMENT, obj);
   return reinterpret_cast<jobject>(ref);
 }
 
@@ -544,8 +539,10 @@ void JavaVMExt::DeleteGlobalRef(Thread* self, jobject obj) {
   if (obj == nullptr) {
     return;
   }
-  WriterMutexLock mu(self, globals_lock_);
-  if (!globals_.Remove(IRT_FIRST_SEGMENT, obj)) {
+  // Globals are deleted from the stripe that added them, whichever thread deletes them.
+  const size_t stripe = IndirectReferenceTable::ExtractStripe(obj);
+  WriterMutexLock mu(self, *globals_locks_[stripe]);
+  if (!globals_[stripe]->Remove(IRT_FIRST_SEGMENT, obj)) {
     LOG(WARNING) << "JNI WARNING: DeleteGlobalRef(" << obj << ") "
                  << "failed to find entry";
   }
@@ -582,10 +579,12 @@ void JavaVMExt::DumpForSigQuit(std::ostream& os) {
     os << " (with forcecopy)";
   }
   Thread* self = Thread::Current();
-  {
-    ReaderMutexLock mu(self, globals_lock_);
-    os << "; globals=" << globals_.Capacity();
+  size_t globals_capacity = 0u;
+  for (size_t stripe = 0; stripe != kGlobalsStripes; ++stripe) {
+    ReaderMutexLock mu(self, *globals_locks_[stripe]);
+    globals_capacity += globals_[stripe]->Capacity();
   }
+  os << "; globals=" << globals_capacity;
   {
     MutexLock mu(self, weak_globals_lock_);
     if (weak_globals_.Capacity() > 0) {
@@ -627,12 +626,13 @@ void JavaVMExt::BroadcastForNewWeakGlobals() {
 }
 
 mirror::Object* JavaVMExt::DecodeGlobal(IndirectRef ref) {
-  return globals_.SynchronizedGet(ref);
+  return globals_[IndirectReferenceTable::ExtractStripe(ref)]->SynchronizedGet(ref);
 }
 
 void JavaVMExt::UpdateGlobal(Thread* self, IndirectRef ref, mirror::Object* result) {
-  WriterMutexLock mu(self, globals_lock_);
-  globals_.Update(ref, result);
+  const size_t stripe = IndirectReferenceTable::ExtractStripe(ref);
+  WriterMutexLock mu(self, *globals_locks_[stripe]);
+  globals_[stripe]->Update(ref, result);
 }
 
 inline bool JavaVMExt::MayAccessWeakGlobals(Thread* self) const {
@@ -704,9 +704,9 @@ void JavaVMExt::UpdateWeakGlobal(Thread* self, IndirectRef ref, mirror::Object*
 
 void JavaVMExt::DumpReferenceTables(std::ostream& os) {
   Thread* self = Thread::Current();
-  {
-    ReaderMutexLock mu(self, globals_lock_);
-    globals_.Dump(os);
+  for (size_t stripe = 0; stripe != kGlobalsStripes; ++stripe) {
+    ReaderMutexLock mu(self, *globals_locks_[stripe]);
+    globals_[stripe]->Dump(os);
   }
   {
     MutexLock mu(self, weak_globals_lock_);
@@ -891,16 +891,29 @@ void* JavaVMExt::FindCodeForNativeMethod(ArtMethod* m) {
   mirror::Class* c = m->GetDeclaringClass();
   // If this is a static method, it could be called before the class has been initialized.
   CHECK(c->IsInitializing()) << c->GetStatus() << " " << PrettyMethod(m);
-  std::string detail;
   void* native_method;
   Thread* self = Thread::Current();
+  // Mangle the names without holding the libraries lock, which threads binding their first
+  // native calls contend on during startup. Try the short name in all the libraries of the
+  // class loader first: the long name is only needed for overloaded native methods.
+  std::string jni_short_name(JniShortName(m));
   {
     MutexLock mu(self, *Locks::jni_libraries_lock_);
-    native_method = libraries_->FindNativeMethod(m, detail);
+    native_method = libraries_->FindNativeMethod(m, jni_short_name);
   }
-  // Throwing can cause libraries_lock to be reacquired.
   if (native_method == nullptr) {
-    self->ThrowNewException("Ljava/lang/UnsatisfiedLinkError;", detail.c_str());
+    std::string jni_long_name(JniLongName(m));
+    {
+      MutexLock mu(self, *Locks::jni_libraries_lock_);
+      native_method = libraries_->FindNativeMethod(m, jni_long_name);
+    }
+    // Throwing can cause libraries_lock to be reacquired.
+    if (native_method == nullptr) {
+      std::string detail = "No implementation found for " + PrettyMethod(m) +
+          " (tried " + jni_short_name + " and " + jni_long_name + ")";
+      LOG(ERROR) << detail;
+      self->ThrowNewException("Ljava/lang/UnsatisfiedLinkError;", detail.c_str());
+    }
   }
   return native_method;
 }
@@ -923,14 +936,19 @@ void JavaVMExt::SweepJniWeakGlobals(IsMarkedVisitor* visitor) {
 }
 
 void JavaVMExt::TrimGlobals() {
-  WriterMutexLock mu(Thread::Current(), globals_lock_);
-  globals_.Trim();
+  Thread* self = Thread::Current();
+  for (size_t stripe = 0; stripe != kGlobalsStripes; ++stripe) {
+    WriterMutexLock mu(self, *globals_locks_[stripe]);
+    globals_[stripe]->Trim();
+  }
 }
 
 void JavaVMExt::VisitRoots(RootVisitor* visitor) {
   Thread* self = Thread::Current();
-  ReaderMutexLock mu(self, globals_lock_);
-  globals_.VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  for (size_t stripe = 0; stripe != kGlobalsStripes; ++stripe) {
+    ReaderMutexLock mu(self, *globals_locks_[stripe]);
+    globals_[stripe]->VisitRoots(visitor, RootInfo(kRootJNIGlobal));
+  }
   // The weak_globals table is visited by the GC itself (because it mutates the table).
 }
 
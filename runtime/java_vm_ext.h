@@ -104,15 +104,14 @@ class JavaVMExt : public JavaVM {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void DumpForSigQuit(std::ostream& os)
-      REQUIRES(!Locks::jni_libraries_lock_, !globals_lock_, !weak_globals_lock_);
+      REQUIRES(!Locks::jni_libraries_lock_, !weak_globals_lock_);
 
   void DumpReferenceTables(std::ostream& os)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!globals_lock_, !weak_globals_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!weak_globals_lock_);
 
   bool SetCheckJniEnabled(bool enabled);
 
-  void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_)
-      REQUIRES(!globals_lock_);
+  void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
 
   void DisallowNewWeakGlobals() SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!weak_globals_lock_);
   void AllowNewWeakGlobals() SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!weak_globals_lock_);
@@ -120,12 +119,12 @@ class JavaVMExt : public JavaVM {
       REQUIRES(!weak_globals_lock_);
 
   jobject AddGlobalRef(Thread* self, mirror::Object* obj)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!globals_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   jweak AddWeakGlobalRef(Thread* self, mirror::Object* obj)
     SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!weak_globals_lock_);
 
-  void DeleteGlobalRef(Thread* self, jobject obj) REQUIRES(!globals_lock_);
+  void DeleteGlobalRef(Thread* self, jobject obj);
 
   void DeleteWeakGlobalRef(Thread* self, jweak obj) REQUIRES(!weak_globals_lock_);
 
@@ -136,7 +135,7 @@ class JavaVMExt : public JavaVM {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void UpdateGlobal(Thread* self, IndirectRef ref, mirror::Object* result)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!globals_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   mirror::Object* DecodeWeakGlobal(Thread* self, IndirectRef ref)
       SHARED_REQUIRES(Locks::mutator_lock_)
@@ -168,8 +167,7 @@ class JavaVMExt : public JavaVM {
     return unchecked_functions_;
   }
 
-  void TrimGlobals() SHARED_REQUIRES(Locks::mutator_lock_)
-      REQUIRES(!globals_lock_);
+  void TrimGlobals() SHARED_REQUIRES(Locks::mutator_lock_);
 
  private:
   // Return true if self can currently access weak globals.
@@ -192,10 +190,14 @@ class JavaVMExt : public JavaVM {
   // Extra diagnostics.
   const std::string trace_;
 
-  // JNI global references.
-  ReaderWriterMutex globals_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  // Not guarded by globals_lock since we sometimes use SynchronizedGet in Thread::DecodeJObject.
-  IndirectReferenceTable globals_;
+  // JNI global references, split into stripes with a lock each so that threads adding and
+  // deleting globals concurrently do not all contend on one lock. A thread adds to the stripe
+  // picked by its thread id, and the stripe of a reference is encoded in the reference. The
+  // locks are never held together, so they share a lock level.
+  static constexpr size_t kGlobalsStripes = IndirectReferenceTable::kMaxStripes;
+  std::unique_ptr<ReaderWriterMutex> globals_locks_[kGlobalsStripes];
+  // Not guarded by globals_locks_ since we sometimes use SynchronizedGet in Thread::DecodeJObject.
+  std::unique_ptr<IndirectReferenceTable> globals_[kGlobalsStripes];
 
   // No lock annotation since UnloadNativeLibraries is called on libraries_ but locks the
   // jni_libraries_lock_ internally.
@@ -16,15 +16,19 @@
 
 #include "object_registry.h"
 
+#include "gc_root-inl.h"
 #include "handle_scope-inl.h"
+#include "java_vm_ext.h"
 #include "jni_internal.h"
 #include "mirror/class.h"
+#include "object_callbacks.h"
 #include "scoped_thread_state_change.h"
+#include "thread.h"
 
 namespace art {
 
 std::ostream& operator<<(std::ostream& os, const ObjectRegistryEntry& rhs) {
-  os << "ObjectRegistryEntry[" << rhs.jni_reference_type
+  os << "ObjectRegistryEntry[collection_disabled=" << rhs.collection_disabled
      << ",reference=" << rhs.jni_reference
      << ",count=" << rhs.reference_count
      << ",id=" << rhs.id << "]";
@@ -32,7 +36,10 @@ std::ostream& operator<<(std::ostream& os, const ObjectRegistryEntry& rhs) {
 }
 
 ObjectRegistry::ObjectRegistry()
-    : lock_("ObjectRegistry lock", kJdwpObjectRegistryLock), next_id_(1) {
+    : lock_("ObjectRegistry lock", kJdwpObjectRegistryLock),
+      allow_new_weaks_(true),
+      new_weaks_condition_("ObjectRegistry allowed weaks", lock_),
+      next_id_(1) {
 }
 
 JDWP::RefTypeId ObjectRegistry::AddRefType(mirror::Class* c) {
@@ -86,45 +93,36 @@ JDWP::ObjectId ObjectRegistry::InternalAdd(Handle<T> obj_h) {
   // Call IdentityHashCode here to avoid a lock level violation between lock_ and monitor_lock.
   int32_t identity_hash_code = obj_h->IdentityHashCode();
 
-  ScopedObjectAccessUnchecked soa(self);
-  MutexLock mu(soa.Self(), lock_);
+  MutexLock mu(self, lock_);
+  BlockUntilWeaksAllowed(self);
   ObjectRegistryEntry* entry = nullptr;
-  if (ContainsLocked(soa.Self(), obj_h.Get(), identity_hash_code, &entry)) {
+  if (ContainsLocked(self, obj_h.Get(), identity_hash_code, &entry)) {
     // This object was already in our map.
     ++entry->reference_count;
   } else {
+    // This object isn't in the registry yet, so add it.
     entry = new ObjectRegistryEntry;
-    entry->jni_reference_type = JNIWeakGlobalRefType;
+    entry->object = GcRoot<mirror::Object>(obj_h.Get());
+    entry->collection_disabled = false;
     entry->jni_reference = nullptr;
-    entry->reference_count = 0;
-    entry->id = 0;
-    entry->identity_hash_code = identity_hash_code;
-    object_to_entry_.insert(std::make_pair(identity_hash_code, entry));
-
-    // This object isn't in the registry yet, so add it.
-    JNIEnv* env = soa.Env();
-
-    jobject local_reference = soa.AddLocalReference<jobject>(obj_h.Get());
-
-    entry->jni_reference_type = JNIWeakGlobalRefType;
-    entry->jni_reference = env->NewWeakGlobalRef(local_reference);
     entry->reference_count = 1;
     entry->id = next_id_++;
-
-    id_to_entry_.Put(entry->id, entry);
-
-    env->DeleteLocalRef(local_reference);
+    entry->identity_hash_code = identity_hash_code;
+    object_to_entry_.emplace(identity_hash_code, entry);
+    id_to_entry_.emplace(entry->id, entry);
   }
   return entry->id;
 }
 
-bool ObjectRegistry::ContainsLocked(Thread* self, mirror::Object* o, int32_t identity_hash_code,
+bool ObjectRegistry::ContainsLocked(Thread* self ATTRIBUTE_UNUSED,
+                                    mirror::Object* o,
+                                    int32_t identity_hash_code,
                                     ObjectRegistryEntry** out_entry) {
   DCHECK(o != nullptr);
-  for (auto it = object_to_entry_.lower_bound(identity_hash_code), end = object_to_entry_.end();
-       it != end && it->first == identity_hash_code; ++it) {
+  auto range = object_to_entry_.equal_range(identity_hash_code);
+  for (auto it = range.first; it != range.second; ++it) {
     ObjectRegistryEntry* entry = it->second;
-    if (o == self->DecodeJObject(entry->jni_reference)) {
+    if (o == entry->object.Read()) {
       if (out_entry != nullptr) {
         *out_entry = entry;
       }
@@ -134,6 +132,19 @@ bool ObjectRegistry::ContainsLocked(Thread* self, mirror::Object* o, int32_t ide
   return false;
 }
 
+ObjectRegistryEntry* ObjectRegistry::FindEntryLocked(Thread* self, JDWP::ObjectId id) {
+  BlockUntilWeaksAllowed(self);
+  auto it = id_to_entry_.find(id);
+  return (it != id_to_entry_.end()) ? it->second : nullptr;
+}
+
+void ObjectRegistry::BlockUntilWeaksAllowed(Thread* self) {
+  while (UNLIKELY((!kUseReadBarrier && !allow_new_weaks_) ||
+                  (kUseReadBarrier && !self->GetWeakRefAccessEnabled()))) {
+    new_weaks_condition_.WaitHoldingLocks(self);  // wait while holding mutator lock
+  }
+}
+
 void ObjectRegistry::Clear() {
   Thread* const self = Thread::Current();
 
@@ -150,15 +161,13 @@ void ObjectRegistry::Clear() {
   Locks::mutator_lock_->AssertNotExclusiveHeld(self);
 
   MutexLock mu(self, lock_);
-  VLOG(jdwp) << "Object registry contained " << object_to_entry_.size() << " entries";
+  VLOG(jdwp) << "Object registry contained " << id_to_entry_.size() << " entries";
   // Delete all the JNI references.
   JNIEnv* env = self->GetJniEnv();
-  for (const auto& pair : object_to_entry_) {
+  for (const auto& pair : id_to_entry_) {
     const ObjectRegistryEntry* entry = pair.second;
-    if (entry->jni_reference_type == JNIWeakGlobalRefType) {
+    if (entry->jni_reference != nullptr) {
       env->DeleteWeakGlobalRef(entry->jni_reference);
-    } else {
-      env->DeleteGlobalRef(entry->jni_reference);
     }
     delete entry;
   }
@@ -170,14 +179,13 @@ void ObjectRegistry::Clear() {
 mirror::Object* ObjectRegistry::InternalGet(JDWP::ObjectId id, JDWP::JdwpError* error) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
-  if (it == id_to_entry_.end()) {
+  ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+  if (entry == nullptr) {
     *error = JDWP::ERR_INVALID_OBJECT;
     return nullptr;
   }
-  ObjectRegistryEntry& entry = *it->second;
   *error = JDWP::ERR_NONE;
-  return self->DecodeJObject(entry.jni_reference);
+  return entry->object.Read();
 }
 
 jobject ObjectRegistry::GetJObject(JDWP::ObjectId id) {
@@ -185,63 +193,53 @@ jobject ObjectRegistry::GetJObject(JDWP::ObjectId id) {
     return nullptr;
   }
   Thread* self = Thread::Current();
+  StackHandleScope<1> hs(self);
+  MutableHandle<mirror::Object> obj(hs.NewHandle<mirror::Object>(nullptr));
+  {
+    MutexLock mu(self, lock_);
+    ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+    CHECK(entry != nullptr) << id;
+    if (entry->jni_reference != nullptr || entry->object.IsNull()) {
+      return entry->jni_reference;
+    }
+    obj.Assign(entry->object.Read());
+  }
+  // Create the reference without holding lock_, adding a weak global may wait for the GC, which
+  // may need lock_ to allow the weaks again.
+  jobject jni_reference = self->GetJniEnv()->vm->AddWeakGlobalRef(self, obj.Get());
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
-  CHECK(it != id_to_entry_.end()) << id;
-  ObjectRegistryEntry& entry = *it->second;
-  return entry.jni_reference;
+  ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+  if (entry == nullptr || entry->jni_reference != nullptr) {
+    // Disposed, or another thread created the reference in the meantime.
+    self->GetJniEnv()->DeleteWeakGlobalRef(jni_reference);
+    return (entry != nullptr) ? entry->jni_reference : nullptr;
+  }
+  entry->jni_reference = jni_reference;
+  return jni_reference;
 }
 
 void ObjectRegistry::DisableCollection(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
-  CHECK(it != id_to_entry_.end());
-  Promote(*it->second);
+  ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+  CHECK(entry != nullptr);
+  entry->collection_disabled = true;
 }
 
 void ObjectRegistry::EnableCollection(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
-  CHECK(it != id_to_entry_.end());
-  Demote(*it->second);
-}
-
-void ObjectRegistry::Demote(ObjectRegistryEntry& entry) {
-  if (entry.jni_reference_type == JNIGlobalRefType) {
-    Thread* self = Thread::Current();
-    JNIEnv* env = self->GetJniEnv();
-    jobject global = entry.jni_reference;
-    entry.jni_reference = env->NewWeakGlobalRef(entry.jni_reference);
-    entry.jni_reference_type = JNIWeakGlobalRefType;
-    env->DeleteGlobalRef(global);
-  }
-}
-
-void ObjectRegistry::Promote(ObjectRegistryEntry& entry) {
-  if (entry.jni_reference_type == JNIWeakGlobalRefType) {
-    Thread* self = Thread::Current();
-    JNIEnv* env = self->GetJniEnv();
-    jobject weak = entry.jni_reference;
-    entry.jni_reference = env->NewGlobalRef(entry.jni_reference);
-    entry.jni_reference_type = JNIGlobalRefType;
-    env->DeleteWeakGlobalRef(weak);
-  }
+  ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+  CHECK(entry != nullptr);
+  entry->collection_disabled = false;
 }
 
 bool ObjectRegistry::IsCollected(JDWP::ObjectId id) {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
-  auto it = id_to_entry_.find(id);
-  CHECK(it != id_to_entry_.end());
-  ObjectRegistryEntry& entry = *it->second;
-  if (entry.jni_reference_type == JNIWeakGlobalRefType) {
-    JNIEnv* env = self->GetJniEnv();
-    return env->IsSameObject(entry.jni_reference, nullptr);  // Has the jweak been collected?
-  } else {
-    return false;  // We hold a strong reference, so we know this is live.
-  }
+  ObjectRegistryEntry* entry = FindEntryLocked(self, id);
+  CHECK(entry != nullptr);
+  return entry->object.IsNull();
 }
 
 void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count) {
@@ -254,25 +252,65 @@ void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count)
   ObjectRegistryEntry* entry = it->second;
   entry->reference_count -= reference_count;
   if (entry->reference_count <= 0) {
-    JNIEnv* env = self->GetJniEnv();
-    // Erase the object from the maps. Note object may be null if it's
-    // a weak ref and the GC has cleared it.
-    int32_t hash_code = entry->identity_hash_code;
-    for (auto inner_it = object_to_entry_.lower_bound(hash_code), end = object_to_entry_.end();
-         inner_it != end && inner_it->first == hash_code; ++inner_it) {
+    // Erase the object from the maps. Note object may be null if the GC has collected it.
+    auto range = object_to_entry_.equal_range(entry->identity_hash_code);
+    for (auto inner_it = range.first; inner_it != range.second; ++inner_it) {
       if (entry == inner_it->second) {
         object_to_entry_.erase(inner_it);
         break;
       }
     }
-    if (entry->jni_reference_type == JNIWeakGlobalRefType) {
-      env->DeleteWeakGlobalRef(entry->jni_reference);
-    } else {
-      env->DeleteGlobalRef(entry->jni_reference);
+    if (entry->jni_reference != nullptr) {
+      self->GetJniEnv()->DeleteWeakGlobalRef(entry->jni_reference);
     }
-    id_to_entry_.erase(id);
+    id_to_entry_.erase(it);
     delete entry;
   }
 }
 
+void ObjectRegistry::VisitRoots(RootVisitor* visitor) {
+  MutexLock mu(Thread::Current(), lock_);
+  BufferedRootVisitor<128> root_visitor(visitor, RootInfo(kRootDebugger));
+  for (const auto& pair : id_to_entry_) {
+    ObjectRegistryEntry* entry = pair.second;
+    if (entry->collection_disabled) {
+      root_visitor.VisitRootIfNonNull(entry->object);
+    }
+  }
+}
+
+void ObjectRegistry::SweepWeaks(IsMarkedVisitor* visitor) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (const auto& pair : id_to_entry_) {
+    ObjectRegistryEntry* entry = pair.second;
+    // This does not need a read barrier because this is called by GC.
+    mirror::Object* old_object = entry->object.Read<kWithoutReadBarrier>();
+    if (old_object != nullptr) {
+      // Also update the objects whose collection is disabled, the visitor returns them marked.
+      entry->object = GcRoot<mirror::Object>(visitor->IsMarked(old_object));
+    }
+  }
+}
+
+void ObjectRegistry::DisallowNewWeaks() {
+  CHECK(!kUseReadBarrier);
+  MutexLock mu(Thread::Current(), lock_);
+  allow_new_weaks_ = false;
+}
+
+void ObjectRegistry::AllowNewWeaks() {
+  CHECK(!kUseReadBarrier);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  allow_new_weaks_ = true;
+  new_weaks_condition_.Broadcast(self);
+}
+
+void ObjectRegistry::BroadcastForNewWeaks() {
+  CHECK(kUseReadBarrier);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  new_weaks_condition_.Broadcast(self);
+}
+
 }  // namespace art
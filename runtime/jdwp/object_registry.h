@@ -20,12 +20,12 @@
 #include <jni.h>
 #include <stdint.h>
 
-#include <map>
+#include <unordered_map>
 
 #include "base/casts.h"
+#include "gc_root.h"
 #include "handle.h"
 #include "jdwp/jdwp.h"
-#include "safe_map.h"
 
 namespace art {
 
@@ -34,11 +34,18 @@ namespace mirror {
   class Class;
 }  // namespace mirror
 
+class IsMarkedVisitor;
+class RootVisitor;
+
 struct ObjectRegistryEntry {
-  // Is jni_reference a weak global or a regular global reference?
-  jobjectRefType jni_reference_type;
+  // The object, null once collected. A strong root if the debugger disabled the collection of
+  // the object, a weak root swept by the GC otherwise.
+  GcRoot<mirror::Object> object;
+
+  // Did the debugger disable the collection of the object?
+  bool collection_disabled;
 
-  // The reference itself.
+  // A JNI weak global reference to the object, only created by GetJObject.
   jobject jni_reference;
 
   // A reference count, so we can implement DisposeObject.
@@ -54,10 +61,11 @@ struct ObjectRegistryEntry {
 std::ostream& operator<<(std::ostream& os, const ObjectRegistryEntry& rhs);
 
 // Tracks those objects currently known to the debugger, so we can use consistent ids when
-// referring to them. Normally we keep JNI weak global references to objects, so they can
-// still be garbage collected. The debugger can ask us to retain objects, though, so we can
-// also promote references to regular JNI global references (and demote them back again if
-// the debugger tells us that's okay).
+// referring to them. Normally the objects are weak roots swept with the other system weaks, so
+// they can still be garbage collected. The debugger can ask us to retain objects, though, so
+// they can also be made strong roots (and weak again if the debugger tells us that's okay).
+// Unlike JNI weak global references, the entries are not limited in number and are read
+// without decoding, and the lookups are hash based.
 class ObjectRegistry {
  public:
   ObjectRegistry();
@@ -106,6 +114,18 @@ class ObjectRegistry {
   // Avoid using this and use standard Get when possible.
   jobject GetJObject(JDWP::ObjectId id) SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
 
+  // Visit the objects whose collection is disabled.
+  void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Update the moved objects and clear the collected ones.
+  void SweepWeaks(IsMarkedVisitor* visitor)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
+  // Block or unblock the accesses to the weak objects, like the other system weaks.
+  void DisallowNewWeaks() SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+  void AllowNewWeaks() SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+  void BroadcastForNewWeaks() SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
+
  private:
   template<class T>
   JDWP::ObjectId InternalAdd(Handle<T> obj_h)
@@ -115,19 +135,22 @@ class ObjectRegistry {
   mirror::Object* InternalGet(JDWP::ObjectId id, JDWP::JdwpError* error)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_);
 
-  void Demote(ObjectRegistryEntry& entry)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(lock_);
-
-  void Promote(ObjectRegistryEntry& entry)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(lock_);
+  ObjectRegistryEntry* FindEntryLocked(Thread* self, JDWP::ObjectId id)
+      REQUIRES(lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
   bool ContainsLocked(Thread* self, mirror::Object* o, int32_t identity_hash_code,
                       ObjectRegistryEntry** out_entry)
       REQUIRES(lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Wait while the GC does not allow reading the weak objects.
+  void BlockUntilWeaksAllowed(Thread* self) REQUIRES(lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  std::multimap<int32_t, ObjectRegistryEntry*> object_to_entry_ GUARDED_BY(lock_);
-  SafeMap<JDWP::ObjectId, ObjectRegistryEntry*> id_to_entry_ GUARDED_BY(lock_);
+  bool allow_new_weaks_ GUARDED_BY(lock_);
+  ConditionVariable new_weaks_condition_ GUARDED_BY(lock_);
+  // Keyed by identity hash code, which unlike the address of the object survives moving GCs.
+  std::unordered_multimap<int32_t, ObjectRegistryEntry*> object_to_entry_ GUARDED_BY(lock_);
+  std::unordered_map<JDWP::ObjectId, ObjectRegistryEntry*> id_to_entry_ GUARDED_BY(lock_);
 
   size_t next_id_ GUARDED_BY(lock_);
 };
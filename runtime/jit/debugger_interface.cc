@@ -21,6 +21,7 @@
 #include "thread-inl.h"
 #include "thread.h"
 
+#include <map>
 #include <unordered_map>
 
 namespace art {
@@ -66,6 +67,13 @@ extern "C" {
   // Static initialization is necessary to prevent GDB from seeing
   // uninitialized descriptor.
   JITDescriptor __jit_debug_descriptor = { 1, JIT_NOACTION, nullptr, nullptr };
+
+  // Debuggers and profilers call this to get the symbols of the JITed code which is still
+  // queued. The runtime writes the queued methods lazily to save the cost for everyone else.
+  void __attribute__((noinline, used)) __art_jit_debug_flush();
+  void __attribute__((noinline, used)) __art_jit_debug_flush() {
+    FlushJITMethodDebugInfo();
+  }
 }
 
 static Mutex g_jit_debug_mutex("JIT debug interface lock", kJitDebugInterfaceLock);
@@ -140,9 +148,70 @@ void CreateJITCodeEntryForAddress(uintptr_t address, std::vector<uint8_t> symfil
   g_jit_code_entries.emplace(address, entry);
 }
 
+// The methods written together to one entry.
+struct JITMethodBatch {
+  JITCodeEntry* entry;
+  std::vector<std::pair<uintptr_t, const void*>> methods;
+};
+
+static JITDebugInfoWriter* g_jit_debug_info_writer = nullptr;
+// The queued methods by address, so that the batches have sorted symbols.
+static std::map<uintptr_t, const void*> g_queued_jit_methods;
+// Mapping from the address of each written method to its batch. It owns the batches.
+static std::unordered_map<uintptr_t, JITMethodBatch*> g_jit_method_batches;
+
+static void WriteQueuedJITMethodsInternal() REQUIRES(g_jit_debug_mutex) {
+  if (g_queued_jit_methods.empty()) {
+    return;
+  }
+  DCHECK(g_jit_debug_info_writer != nullptr);
+  JITMethodBatch* batch = new JITMethodBatch;
+  std::vector<const void*> method_infos;
+  method_infos.reserve(g_queued_jit_methods.size());
+  batch->methods.reserve(g_queued_jit_methods.size());
+  for (const auto& method : g_queued_jit_methods) {
+    method_infos.push_back(method.second);
+    batch->methods.push_back(method);
+    g_jit_method_batches.emplace(method.first, batch);
+  }
+  g_queued_jit_methods.clear();
+  batch->entry = CreateJITCodeEntryInternal(g_jit_debug_info_writer->WriteElfFile(method_infos));
+}
+
+// Remove the batch from the native debugger. The other methods of the batch are queued again,
+// their symbols return with the next batch.
+static void DeleteJITMethodInBatchInternal(uintptr_t address, JITMethodBatch* batch)
+    REQUIRES(g_jit_debug_mutex) {
+  DeleteJITCodeEntryInternal(batch->entry);
+  for (const auto& method : batch->methods) {
+    g_jit_method_batches.erase(method.first);
+    if (method.second == nullptr) {
+      continue;  // The method info was released with its writer.
+    }
+    if (method.first == address) {
+      g_jit_debug_info_writer->DeleteMethodDebugInfo(method.second);
+    } else {
+      g_queued_jit_methods.emplace(method);
+    }
+  }
+  delete batch;
+}
+
 bool DeleteJITCodeEntryForAddress(uintptr_t address) {
   Thread* self = Thread::Current();
   MutexLock mu(self, g_jit_debug_mutex);
+  const auto& queued_it = g_queued_jit_methods.find(address);
+  if (queued_it != g_queued_jit_methods.end()) {
+    DCHECK(g_jit_debug_info_writer != nullptr);
+    g_jit_debug_info_writer->DeleteMethodDebugInfo(queued_it->second);
+    g_queued_jit_methods.erase(queued_it);
+    return true;
+  }
+  const auto& batch_it = g_jit_method_batches.find(address);
+  if (batch_it != g_jit_method_batches.end()) {
+    DeleteJITMethodInBatchInternal(address, batch_it->second);
+    return true;
+  }
   const auto& it = g_jit_code_entries.find(address);
   if (it == g_jit_code_entries.end()) {
     return false;
@@ -152,4 +221,42 @@ bool DeleteJITCodeEntryForAddress(uintptr_t address) {
   return true;
 }
 
+void SetJITDebugInfoWriter(JITDebugInfoWriter* writer) {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, g_jit_debug_mutex);
+  if (writer == nullptr && g_jit_debug_info_writer != nullptr) {
+    // Keep the symbols of the live code, but the written batches can no longer be split.
+    WriteQueuedJITMethodsInternal();
+    for (const auto& it : g_jit_method_batches) {
+      for (auto& method : it.second->methods) {
+        if (method.second != nullptr) {
+          g_jit_debug_info_writer->DeleteMethodDebugInfo(method.second);
+          method.second = nullptr;
+        }
+      }
+    }
+  }
+  g_jit_debug_info_writer = writer;
+}
+
+void AddJITMethodDebugInfo(uintptr_t address, const void* method_info) {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, g_jit_debug_mutex);
+  DCHECK_NE(address, 0u);
+  DCHECK(g_jit_debug_info_writer != nullptr);
+  DCHECK(g_queued_jit_methods.find(address) == g_queued_jit_methods.end());
+  DCHECK(g_jit_method_batches.find(address) == g_jit_method_batches.end());
+  g_queued_jit_methods.emplace(address, method_info);
+  // Also writes the methods queued again after deleting their batch.
+  if (g_queued_jit_methods.size() >= kJITDebugInfoBatchSize) {
+    WriteQueuedJITMethodsInternal();
+  }
+}
+
+void FlushJITMethodDebugInfo() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, g_jit_debug_mutex);
+  WriteQueuedJITMethodsInternal();
+}
+
 }  // namespace art
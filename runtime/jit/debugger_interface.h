@@ -42,8 +42,37 @@ void CreateJITCodeEntryForAddress(uintptr_t address, std::vector<uint8_t> symfil
 
 // Notify native debugger that JITed code has been removed.
 // Returns false if entry for the given address was not found.
+// This also removes the code queued with AddJITMethodDebugInfo.
 bool DeleteJITCodeEntryForAddress(uintptr_t address);
 
+// Writes the in-memory ELF file of a batch of JITed methods. The runtime cannot write ELF files,
+// so the JIT compiler implements it and the runtime only holds the opaque debug info of each
+// method until it is written.
+class JITDebugInfoWriter {
+ public:
+  virtual ~JITDebugInfoWriter() {}
+
+  // The method infos are sorted by code address.
+  virtual std::vector<uint8_t> WriteElfFile(const std::vector<const void*>& method_infos) = 0;
+  virtual void DeleteMethodDebugInfo(const void* method_info) = 0;
+};
+
+// Number of queued methods which are written together to one in-memory ELF file.
+static constexpr size_t kJITDebugInfoBatchSize = 64;
+
+// Set the writer of the queued methods, or clear it with nullptr. Clearing it flushes the
+// queued methods first.
+void SetJITDebugInfoWriter(JITDebugInfoWriter* writer);
+
+// Queue the debug info of the JITed code at the given address, it takes ownership of the
+// method info. The queued methods are only written when a batch is complete or flushed.
+void AddJITMethodDebugInfo(uintptr_t address, const void* method_info);
+
+// Write the queued methods and notify the native debugger. Called before the runtime unwinds
+// native stacks itself and exported for native debuggers and profilers, which should call
+// __art_jit_debug_flush before reading the JIT entries.
+void FlushJITMethodDebugInfo();
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_JIT_DEBUGGER_INTERFACE_H_
@@ -19,17 +19,28 @@
 #include <dlfcn.h>
 
 #include "art_method-inl.h"
+#include "base/casts.h"
 #include "base/enums.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
 #include "debugger.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
+#include "gc/heap.h"
+#include "gc/task_processor.h"
+#include "interpreter/dispatch_profiler.h"
 #include "interpreter/interpreter.h"
+#include "jit/debugger_interface.h"
 #include "jit_code_cache.h"
+#include "linear_alloc.h"
 #include "oat_file_manager.h"
 #include "oat_quick_method_header.h"
 #include "offline_profiling_info.h"
+#include "os.h"
 #include "profile_saver.h"
 #include "runtime.h"
 #include "runtime_options.h"
+#include "scoped_thread_state_change.h"
 #include "stack_map.h"
 #include "thread_list.h"
 #include "utils.h"
@@ -40,19 +51,25 @@ namespace jit {
 static constexpr bool kEnableOnStackReplacement = true;
 // At what priority to schedule jit threads. 9 is the lowest foreground priority on device.
 static constexpr int kJitPoolThreadPthreadPriority = 9;
+// How many of the methods that took the most memory to compile DumpInfo lists.
+static constexpr size_t kNumLargestMemoryUses = 10;
 
 // JIT compiler
 void* Jit::jit_library_handle_= nullptr;
 void* Jit::jit_compiler_handle_ = nullptr;
 void* (*Jit::jit_load_)(bool*) = nullptr;
 void (*Jit::jit_unload_)(void*) = nullptr;
-bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool) = nullptr;
+bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool) = nullptr;
 void (*Jit::jit_types_loaded_)(void*, mirror::Class**, size_t count) = nullptr;
 bool Jit::generate_debug_info_ = false;
 
 JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& options) {
   auto* jit_options = new JitOptions;
   jit_options->use_jit_compilation_ = options.GetOrDefault(RuntimeArgumentMap::UseJitCompilation);
+  jit_options->use_tiered_compilation_ =
+      options.GetOrDefault(RuntimeArgumentMap::UseTieredJitCompilation);
+  jit_options->warmup_from_profile_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITWarmupFromProfile);
 
   jit_options->code_cache_initial_capacity_ =
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheInitialCapacity);
@@ -60,6 +77,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheMaxCapacity);
   jit_options->dump_info_on_shutdown_ =
       options.Exists(RuntimeArgumentMap::DumpJITInfoOnShutdown);
+  jit_options->write_perf_map_ = options.Exists(RuntimeArgumentMap::JITPerfMap);
+  jit_options->write_jit_dump_ = options.Exists(RuntimeArgumentMap::JITDump);
+  if (options.Exists(RuntimeArgumentMap::JITZygoteProfile)) {
+    jit_options->zygote_profile_ = *options.Get(RuntimeArgumentMap::JITZygoteProfile);
+  }
   jit_options->profile_saver_options_ =
       options.GetOrDefault(RuntimeArgumentMap::ProfileSaverOpts);
 
@@ -117,6 +139,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
         static_cast<size_t>(1));;
   }
 
+  jit_options->thread_pool_size_ = options.GetOrDefault(RuntimeArgumentMap::JITPoolThreads);
+  if (jit_options->thread_pool_size_ == 0) {
+    LOG(FATAL) << "JIT thread pool size cannot be 0.";
+  }
+
   return jit_options;
 }
 
@@ -127,16 +154,97 @@ bool Jit::ShouldUsePriorityThreadWeight() {
 
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
+  os << "Current JIT sample weight: " << sample_weight_.LoadRelaxed() << "\n"
+     << "JIT compilation requests throttled: " << std::boolalpha
+     << throttle_compilations_.LoadRelaxed() << std::noboolalpha << "\n";
   cumulative_timings_.Dump(os);
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.PrintMemoryUse(os);
+  os << "Methods using the most memory for compilation:\n";
+  largest_memory_uses_.Dump(os);
 }
 
 void Jit::DumpForSigQuit(std::ostream& os) {
+  // The native stacks dumped after this need the symbols of all the JIT code.
+  FlushJITMethodDebugInfo();
   DumpInfo(os);
+  DumpCompilationRecords(os);
   ProfileSaver::DumpInstanceInfo(os);
 }
 
+void Jit::RecordCompilation(Thread* self,
+                            ArtMethod* method,
+                            bool osr,
+                            bool baseline,
+                            uint64_t queue_wait_ns,
+                            uint64_t compile_time_ns,
+                            bool success) {
+  method = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+  JitCompilationRecord record;
+  record.method = PrettyMethod(method);
+  record.kind = osr ? "osr" : (baseline ? "baseline" : "optimized");
+  record.queue_wait_ns = queue_wait_ns;
+  record.compile_time_ns = compile_time_ns;
+  record.code_size = 0;
+  record.inlined_methods = 0;
+  record.success = success;
+  if (success) {
+    code_cache_->GetCompiledCodeStats(
+        self, method, osr, &record.code_size, &record.inlined_methods);
+  }
+  MutexLock mu(self, lock_);
+  if (compilation_records_.size() < kCompilationRecordCapacity) {
+    compilation_records_.push_back(std::move(record));
+  } else {
+    compilation_records_[next_compilation_record_] = std::move(record);
+    next_compilation_record_ = (next_compilation_record_ + 1) % kCompilationRecordCapacity;
+  }
+}
+
+size_t Jit::GetCompilationQueueLength(Thread* self) {
+  return (thread_pool_ == nullptr) ? 0u : thread_pool_->GetTaskCount(self);
+}
+
+void Jit::UpdateCompilationLoad(Thread* self) {
+  if (thread_pool_ == nullptr) {
+    return;
+  }
+  size_t queued = thread_pool_->GetTaskCount(self);
+  uint16_t sample_weight = sample_weight_.LoadRelaxed();
+  if (queued > kCompilationQueueHighWatermark) {
+    sample_weight = 1;
+    throttle_compilations_.StoreRelaxed(true);
+  } else {
+    throttle_compilations_.StoreRelaxed(false);
+    if (code_cache_->IsNearlyFull()) {
+      // Compiling lukewarm methods would only make the code cache collect more often.
+      sample_weight = 1;
+    } else if (queued == 0) {
+      sample_weight = std::min<uint16_t>(sample_weight * 2, kMaxSampleWeight);
+    } else if (queued > thread_pool_size_) {
+      sample_weight = std::max<uint16_t>(sample_weight / 2, 1);
+    }
+  }
+  sample_weight_.StoreRelaxed(sample_weight);
+}
+
+void Jit::DumpCompilationRecords(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  os << "JIT compilation records (method, kind, queue_wait_ns, compile_time_ns, code_size, "
+     << "inlined_methods, success):\n";
+  for (size_t i = 0; i < compilation_records_.size(); ++i) {
+    const JitCompilationRecord& record =
+        compilation_records_[(next_compilation_record_ + i) % compilation_records_.size()];
+    os << record.method << "\t"
+       << record.kind << "\t"
+       << record.queue_wait_ns << "\t"
+       << record.compile_time_ns << "\t"
+       << record.code_size << "\t"
+       << record.inlined_methods << "\t"
+       << (record.success ? 1 : 0) << "\n";
+  }
+}
+
 void Jit::AddTimingLogger(const TimingLogger& logger) {
   cumulative_timings_.AddLogger(logger);
 }
@@ -144,8 +252,15 @@ void Jit::AddTimingLogger(const TimingLogger& logger) {
 Jit::Jit() : dump_info_on_shutdown_(false),
              cumulative_timings_("JIT timings"),
              memory_use_("Memory used for compilation", 16),
+             largest_memory_uses_(kNumLargestMemoryUses),
+             next_compilation_record_(0),
              lock_("JIT memory use lock"),
-             use_jit_compilation_(true) {}
+             use_jit_compilation_(true),
+             use_tiered_compilation_(false),
+             warmup_from_profile_(false),
+             sample_weight_(1),
+             throttle_compilations_(false),
+             warmup_profile_(nullptr) {}
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   DCHECK(options->UseJitCompilation() || options->GetProfileSaverOptions().IsEnabled());
@@ -158,16 +273,25 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
       options->GetCodeCacheInitialCapacity(),
       options->GetCodeCacheMaxCapacity(),
       jit->generate_debug_info_,
+      /* separate_cold_code */ options->UseTieredCompilation(),
+      // The perf map used to be written only with the debug info, keep it.
+      /* write_perf_map */ options->WritePerfMap() || jit->generate_debug_info_,
+      options->WriteJitDump(),
       error_msg));
   if (jit->GetCodeCache() == nullptr) {
     return nullptr;
   }
   jit->use_jit_compilation_ = options->UseJitCompilation();
+  jit->use_tiered_compilation_ = options->UseTieredCompilation();
+  jit->warmup_from_profile_ = options->WarmupFromProfile();
+  jit->zygote_profile_ = options->GetZygoteProfile();
   jit->profile_saver_options_ = options->GetProfileSaverOptions();
   VLOG(jit) << "JIT created with initial_capacity="
       << PrettySize(options->GetCodeCacheInitialCapacity())
       << ", max_capacity=" << PrettySize(options->GetCodeCacheMaxCapacity())
       << ", compile_threshold=" << options->GetCompileThreshold()
+      << ", threads=" << options->GetThreadPoolSize()
+      << ", tiered=" << std::boolalpha << options->UseTieredCompilation() << std::noboolalpha
       << ", profile_saver_options=" << options->GetProfileSaverOptions();
 
 
@@ -176,8 +300,12 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   jit->osr_method_threshold_ = options->GetOsrThreshold();
   jit->priority_thread_weight_ = options->GetPriorityThreadWeight();
   jit->invoke_transition_weight_ = options->GetInvokeTransitionWeight();
+  jit->thread_pool_size_ = options->GetThreadPoolSize();
 
-  jit->CreateThreadPool();
+  if (!Runtime::Current()->IsZygote()) {
+    // The zygote cannot have other threads when forking, its children start the pool.
+    jit->CreateThreadPool();
+  }
 
   // Notify native debugger about the classes already loaded before the creation of the jit.
   jit->DumpTypeInfoForLoadedTypes(Runtime::Current()->GetClassLinker());
@@ -206,7 +334,7 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -240,7 +368,7 @@ bool Jit::LoadCompiler(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
+bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
 
@@ -260,19 +388,24 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr)) {
+  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr, baseline)) {
     return false;
   }
 
   VLOG(jit) << "Compiling method "
             << PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr;
-  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr);
+            << " osr=" << std::boolalpha << osr
+            << " baseline=" << baseline;
+  bool success =
+      jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr, baseline);
   code_cache_->DoneCompiling(method_to_compile, self, osr);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
               << PrettyMethod(method_to_compile)
-              << " osr=" << std::boolalpha << osr;
+              << " osr=" << std::boolalpha << osr
+              << " baseline=" << baseline;
+  } else if (baseline) {
+    StartTierUpSampling(self);
   }
   return success;
 }
@@ -280,7 +413,8 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
 void Jit::CreateThreadPool() {
   // There is a DCHECK in the 'AddSamples' method to ensure the tread pool
   // is not null when we instrument.
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1));
+  // Requests are prioritized by hotness, see JitCompileTask::GetPriority.
+  thread_pool_.reset(new ThreadPool("Jit thread pool", thread_pool_size_, /* prioritized */ true));
   thread_pool_->SetPthreadPriority(kJitPoolThreadPthreadPriority);
   thread_pool_->StartWorkers(Thread::Current());
 }
@@ -306,10 +440,162 @@ void Jit::DeleteThreadPool() {
   }
 }
 
+void Jit::LoadWarmupProfile(const std::string& filename) {
+  if (!warmup_from_profile_ ||
+      !use_jit_compilation_ ||
+      warmup_profile_.LoadRelaxed() != nullptr) {
+    return;
+  }
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Could not open JIT warmup profile " << filename;
+    return;
+  }
+  std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+  if (!profile->Load(file->Fd())) {
+    LOG(WARNING) << "Could not load JIT warmup profile " << filename;
+    return;
+  }
+  VLOG(jit) << "JIT warmup profile " << filename << " has "
+            << profile->GetNumberOfMethods() << " methods";
+  if (profile->GetNumberOfMethods() == 0) {
+    return;
+  }
+  warmup_profile_.StoreRelease(profile.release());
+
+  // Classes loaded before now are not notified again.
+  struct WarmUpClasses : public ClassVisitor {
+    explicit WarmUpClasses(Jit* jit) : jit_(jit) {}
+    bool operator()(mirror::Class* klass) OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+      jit_->WarmUpFromProfile(klass);
+      return true;
+    }
+    Jit* const jit_;
+  };
+  ScopedObjectAccess soa(Thread::Current());
+  WarmUpClasses visitor(this);
+  Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+}
+
+void Jit::WarmUpFromProfile(mirror::Class* type) {
+  const ProfileCompilationInfo* profile = warmup_profile_.LoadAcquire();
+  if (profile == nullptr ||
+      type->IsPrimitive() ||
+      type->IsArrayClass() ||
+      type->IsProxyClass() ||
+      !type->IsResolved()) {
+    return;
+  }
+  if (Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(type)) {
+    // Boot image methods are compiled ahead of time.
+    return;
+  }
+  const DexFile& dex_file = type->GetDexFile();
+  for (ArtMethod& method : type->GetDeclaredMethods(kRuntimePointerSize)) {
+    if (method.IsNative() ||
+        method.IsAbstract() ||
+        method.IsClassInitializer() ||
+        !method.IsCompilable() ||
+        !profile->ContainsMethod(MethodReference(&dex_file, method.GetDexMethodIndex()))) {
+      continue;
+    }
+    // Leave the method one sample away from being hot. It skips the warm state, the compile
+    // task allocates its ProfilingInfo.
+    if (method.GetCounter() < hot_method_threshold_ - 1) {
+      method.SetCounter(hot_method_threshold_ - 1);
+    }
+  }
+}
+
+void Jit::PreZygoteFork() {
+  DCHECK(Runtime::Current()->IsZygote());
+  if (zygote_profile_.empty() || !use_jit_compilation_) {
+    return;
+  }
+  std::string filename;
+  filename.swap(zygote_profile_);
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Could not open JIT zygote profile " << filename;
+    return;
+  }
+  ProfileCompilationInfo profile;
+  if (!profile.Load(file->Fd())) {
+    LOG(WARNING) << "Could not load JIT zygote profile " << filename;
+    return;
+  }
+
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  std::vector<ArtMethod*> methods;
+  GetZygoteMethods(profile, &methods);
+  size_t compiled = 0;
+  for (ArtMethod* method : methods) {
+    if (method->GetProfilingInfo(kRuntimePointerSize) == nullptr &&
+        !ProfilingInfo::Create(self, method, /* retry_allocation */ true)) {
+      // The code cache is full.
+      break;
+    }
+    if (CompileMethod(method, self, /* osr */ false, /* baseline */ false)) {
+      ++compiled;
+    }
+  }
+  code_cache_->FreezeZygoteCode(self);
+  VLOG(jit) << "JIT compiled " << compiled << " of the " << methods.size()
+            << " methods of the zygote profile " << filename;
+}
+
+void Jit::GetZygoteMethods(const ProfileCompilationInfo& profile,
+                           std::vector<ArtMethod*>* methods) {
+  struct CollectMethods : public ClassVisitor {
+    CollectMethods(const ProfileCompilationInfo& profile, std::vector<ArtMethod*>* methods)
+        : profile_(profile), methods_(methods) {}
+
+    bool operator()(mirror::Class* klass) OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+      // The code of methods of classes not initialized yet would skip the initialization.
+      if (klass->GetClassLoader() != nullptr ||
+          klass->IsPrimitive() ||
+          klass->IsArrayClass() ||
+          klass->IsProxyClass() ||
+          !klass->IsInitialized()) {
+        return true;
+      }
+      ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+      const DexFile& dex_file = klass->GetDexFile();
+      for (ArtMethod& method : klass->GetDeclaredMethods(kRuntimePointerSize)) {
+        if (method.IsNative() ||
+            method.IsAbstract() ||
+            method.IsClassInitializer() ||
+            !method.IsCompilable() ||
+            // Methods with AOT code in the boot image do not need the JIT.
+            !class_linker->IsQuickToInterpreterBridge(
+                method.GetEntryPointFromQuickCompiledCode()) ||
+            !profile_.ContainsMethod(MethodReference(&dex_file, method.GetDexMethodIndex()))) {
+          continue;
+        }
+        methods_->push_back(&method);
+      }
+      return true;
+    }
+
+    const ProfileCompilationInfo& profile_;
+    std::vector<ArtMethod*>* const methods_;
+  };
+  CollectMethods visitor(profile, methods);
+  Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+}
+
+void Jit::PostZygoteFork() {
+  if (thread_pool_ == nullptr) {
+    CreateThreadPool();
+  }
+}
+
 void Jit::StartProfileSaver(const std::string& filename,
                             const std::vector<std::string>& code_paths,
                             const std::string& foreign_dex_profile_path,
                             const std::string& app_dir) {
+  LoadWarmupProfile(filename);
   if (profile_saver_options_.IsEnabled()) {
     ProfileSaver::Start(profile_saver_options_,
                         filename,
@@ -340,6 +626,7 @@ Jit::~Jit() {
     DumpInfo(LOG(INFO));
   }
   DeleteThreadPool();
+  delete warmup_profile_.LoadRelaxed();
   if (jit_compiler_handle_ != nullptr) {
     jit_unload_(jit_compiler_handle_);
     jit_compiler_handle_ = nullptr;
@@ -360,6 +647,7 @@ void Jit::NewTypeLoadedIfUsingJit(mirror::Class* type) {
     DCHECK(jit->jit_types_loaded_ != nullptr);
     jit->jit_types_loaded_(jit->jit_compiler_handle_, &type, 1);
   }
+  jit->WarmUpFromProfile(type);
 }
 
 void Jit::DumpTypeInfoForLoadedTypes(ClassLinker* linker) {
@@ -413,6 +701,12 @@ bool Jit::MaybeDoOnStackReplacement(Thread* thread,
   // and the JIT code cache do not expect methods from proxy classes.
   method = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
 
+  // Record the loop we are in, an OSR compilation only needs that loop nest as entry.
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (info != nullptr) {
+    info->SetOsrEntryDexPc(dex_pc + dex_pc_offset);
+  }
+
   // Cheap check if the method has been compiled already. That's an indicator that we should
   // osr into it.
   if (!jit->GetCodeCache()->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
@@ -449,10 +743,10 @@ bool Jit::MaybeDoOnStackReplacement(Thread* thread,
       return false;
     }
 
-    // Before allowing the jump, make sure the debugger is not active to avoid jumping from
-    // interpreter to OSR while e.g. single stepping. Note that we could selectively disable
-    // OSR when single stepping, but that's currently hard to know at this point.
-    if (Dbg::IsDebuggerActive()) {
+    // Before allowing the jump, make sure this thread is not single stepping, as the compiled
+    // code would not report the steps. Methods with breakpoints are deoptimized, so they
+    // cannot be here.
+    if (Dbg::IsDebuggerActive() && thread->GetSingleStepControl() != nullptr) {
       return false;
     }
 
@@ -543,6 +837,9 @@ void Jit::AddMemoryUsage(ArtMethod* method, size_t bytes) {
   }
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.AddValue(bytes);
+  if (largest_memory_uses_.IsKept(bytes)) {
+    largest_memory_uses_.Add(bytes, PrettyMethod(method));
+  }
 }
 
 class JitCompileTask FINAL : public Task {
@@ -550,59 +847,177 @@ class JitCompileTask FINAL : public Task {
   enum TaskKind {
     kAllocateProfile,
     kCompile,
+    kCompileBaseline,
     kCompileOsr
   };
 
-  JitCompileTask(ArtMethod* method, TaskKind kind) : method_(method), kind_(kind) {
+  JitCompileTask(ArtMethod* method, TaskKind kind)
+      : method_(method), kind_(kind), enqueue_time_ns_(NanoTime()) {
     ScopedObjectAccess soa(Thread::Current());
-    // Add a global ref to the class to prevent class unloading until compilation is done.
-    klass_ = soa.Vm()->AddGlobalRef(soa.Self(), method_->GetDeclaringClass());
+    // A queued request does not keep the class alive. If the class gets unloaded, the request
+    // is removed from the queue by Jit::RemoveCompilationTasksIn.
+    klass_ = soa.Vm()->AddWeakGlobalRef(soa.Self(), method_->GetDeclaringClass());
     CHECK(klass_ != nullptr);
   }
 
   ~JitCompileTask() {
     ScopedObjectAccess soa(Thread::Current());
-    soa.Vm()->DeleteGlobalRef(soa.Self(), klass_);
+    soa.Vm()->DeleteWeakGlobalRef(soa.Self(), klass_);
   }
 
   void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
-    if (kind_ == kCompile) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ false);
+    // DecodeJObject returns null for cleared weak globals.
+    mirror::Object* klass = self->DecodeJObject(klass_);
+    if (klass == nullptr) {
+      // The class was unloaded after a worker picked this request.
+      return;
+    }
+    // Add a global ref to the class to prevent class unloading until compilation is done.
+    jobject global_klass = soa.Vm()->AddGlobalRef(self, klass);
+    CHECK(global_klass != nullptr);
+    RunRequest(self);
+    soa.Vm()->DeleteGlobalRef(self, global_klass);
+    Runtime::Current()->GetJit()->UpdateCompilationLoad(self);
+    ProfileSaver::NotifyJitActivity();
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+  // Requests for methods currently looping in the interpreter come first, then compilations,
+  // then profiling info allocations. Within a kind, hotter methods come first. Called with the
+  // thread pool lock held: the method cannot be freed before the request leaves the queue.
+  size_t GetPriority() const OVERRIDE {
+    size_t kind_priority;
+    switch (kind_) {
+      case kCompileOsr:
+        kind_priority = 2;
+        break;
+      case kCompile:
+      case kCompileBaseline:
+        kind_priority = 1;
+        break;
+      default:
+        DCHECK(kind_ == kAllocateProfile);
+        kind_priority = 0;
+        break;
+    }
+    return (kind_priority << 16) | method_->GetCounter();
+  }
+
+  bool IsForMethodIn(const LinearAlloc& alloc) const {
+    return alloc.ContainsUnsafe(method_);
+  }
+
+ private:
+  void RunRequest(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (kind_ == kCompile || kind_ == kCompileBaseline) {
+      if (!method_->IsNative() && method_->GetProfilingInfo(kRuntimePointerSize) == nullptr) {
+        // The method was warmed up from a profile and did not go through the warm state.
+        ProfilingInfo::Create(self, method_, /* retry_allocation */ true);
+      }
+      Compile(self, /* osr */ false, /* baseline */ kind_ == kCompileBaseline);
     } else if (kind_ == kCompileOsr) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ true);
+      Compile(self, /* osr */ true, /* baseline */ false);
     } else {
       DCHECK(kind_ == kAllocateProfile);
       if (ProfilingInfo::Create(self, method_, /* retry_allocation */ true)) {
         VLOG(jit) << "Start profiling " << PrettyMethod(method_);
       }
     }
-    ProfileSaver::NotifyJitActivity();
   }
 
-  void Finalize() OVERRIDE {
-    delete this;
+  void Compile(Thread* self, bool osr, bool baseline) SHARED_REQUIRES(Locks::mutator_lock_) {
+    Jit* jit = Runtime::Current()->GetJit();
+    uint64_t start_ns = NanoTime();
+    bool success = jit->CompileMethod(method_, self, osr, baseline);
+    uint64_t end_ns = NanoTime();
+    jit->RecordCompilation(
+        self, method_, osr, baseline, start_ns - enqueue_time_ns_, end_ns - start_ns, success);
   }
 
- private:
   ArtMethod* const method_;
   const TaskKind kind_;
-  jobject klass_;
+  const uint64_t enqueue_time_ns_;
+  jweak klass_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+void Jit::RemoveCompilationTasksIn(Thread* self, const LinearAlloc& alloc) {
+  if (thread_pool_ != nullptr) {
+    // All the tasks of the JIT thread pool are compilation requests.
+    thread_pool_->RemoveTasksIf(self, [&alloc](Task* task) {
+      return down_cast<JitCompileTask*>(task)->IsForMethodIn(alloc);
+    });
+  }
+}
+
+class JitTierUpTask FINAL : public gc::HeapTask {
+ public:
+  explicit JitTierUpTask(uint64_t target_time) : gc::HeapTask(target_time) {}
+
+  void Run(Thread* self) OVERRIDE {
+    Jit* jit = Runtime::Current()->GetJit();
+    if (jit != nullptr) {
+      jit->RunTierUpSampling(self);
+    }
+  }
+};
+
+static bool CanSampleForTierUp(Thread* self) REQUIRES(!Locks::runtime_shutdown_lock_) {
+  Runtime* runtime = Runtime::Current();
+  return runtime->IsFinishedStarting() && !runtime->IsShuttingDown(self);
+}
+
+void Jit::StartTierUpSampling(Thread* self) {
+  if (CanSampleForTierUp(self) &&
+      tier_up_sampling_pending_.CompareExchangeStrongSequentiallyConsistent(false, true)) {
+    Runtime::Current()->GetHeap()->GetTaskProcessor()->AddTask(
+        self, new JitTierUpTask(NanoTime() + MsToNs(kTierUpSamplingPeriodMs)));
+  }
+}
+
+void Jit::RunTierUpSampling(Thread* self) {
+  bool keep_sampling = false;
+  {
+    ScopedObjectAccess soa(self);
+    // The thread pool is gone when shutting down.
+    if (thread_pool_ != nullptr) {
+      std::vector<ArtMethod*> hot_methods;
+      keep_sampling =
+          code_cache_->SampleBaselineCode(self, kTierUpSampleThreshold, &hot_methods) != 0;
+      for (ArtMethod* method : hot_methods) {
+        VLOG(jit) << "Tiering up " << PrettyMethod(method);
+        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+      }
+    }
+  }
+  if (keep_sampling && CanSampleForTierUp(self)) {
+    Runtime::Current()->GetHeap()->GetTaskProcessor()->AddTask(
+        self, new JitTierUpTask(NanoTime() + MsToNs(kTierUpSamplingPeriodMs)));
+  } else {
+    tier_up_sampling_pending_.StoreSequentiallyConsistent(false);
+  }
+}
+
 void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_backedges) {
   if (thread_pool_ == nullptr) {
-    // Should only see this when shutting down.
-    DCHECK(Runtime::Current()->IsShuttingDown(self));
+    // Should only see this when shutting down, in the zygote, and in the children of the
+    // zygote that do not JIT.
     return;
   }
 
-  if (method->IsClassInitializer() || method->IsNative() || !method->IsCompilable()) {
+  if (method->IsClassInitializer() || !method->IsCompilable()) {
     // We do not want to compile such methods.
     return;
   }
+  if (method->IsNative()) {
+    AddSamplesForNative(self, method, count);
+    return;
+  }
   DCHECK(thread_pool_ != nullptr);
   DCHECK_GT(warm_method_threshold_, 0);
   DCHECK_GT(hot_method_threshold_, warm_method_threshold_);
@@ -614,7 +1029,8 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   if (Jit::ShouldUsePriorityThreadWeight()) {
     count *= priority_thread_weight_;
   }
-  int32_t new_count = starting_count + count;   // int32 here to avoid wrap-around;
+  int32_t new_count = starting_count + count * sample_weight_.LoadRelaxed();  // Avoid wrap-around.
+  bool throttled = throttle_compilations_.LoadRelaxed();
   if (starting_count < warm_method_threshold_) {
     if ((new_count >= warm_method_threshold_) &&
         (method->GetProfilingInfo(kRuntimePointerSize) == nullptr)) {
@@ -642,8 +1058,18 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
     if (starting_count < hot_method_threshold_) {
       if ((new_count >= hot_method_threshold_) &&
           !code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+        if (throttled) {
+          // Stay just below the threshold, the request is made once the queue drains.
+          method->SetCounter(hot_method_threshold_ - 1);
+          return;
+        }
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+        if (UNLIKELY(interpreter::DispatchProfiler::IsEnabled())) {
+          interpreter::DispatchProfiler::RecordJitRequest(self, method);
+        }
+        thread_pool_->AddTask(self, new JitCompileTask(
+            method,
+            use_tiered_compilation_ ? JitCompileTask::kCompileBaseline : JitCompileTask::kCompile));
       }
       // Avoid jumping more than one state at a time.
       new_count = std::min(new_count, osr_method_threshold_ - 1);
@@ -653,6 +1079,10 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
         return;
       }
       if ((new_count >= osr_method_threshold_) &&  !code_cache_->IsOsrCompiled(method)) {
+        if (throttled) {
+          method->SetCounter(osr_method_threshold_ - 1);
+          return;
+        }
         DCHECK(thread_pool_ != nullptr);
         thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompileOsr));
       }
@@ -662,9 +1092,40 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   method->SetCounter(new_count);
 }
 
+void Jit::AddSamplesForNative(Thread* self, ArtMethod* method, uint16_t count) {
+  DCHECK(method->IsNative());
+  if (thread_pool_ == nullptr || !use_jit_compilation_ || !method->IsCompilable()) {
+    return;
+  }
+  // A JNI stub is only generated from the method's signature and access flags: there is
+  // nothing to profile, nor a loop to enter through OSR. Go straight to the hot threshold.
+  int32_t starting_count = method->GetCounter();
+  if (starting_count >= hot_method_threshold_) {
+    return;
+  }
+  if (Jit::ShouldUsePriorityThreadWeight()) {
+    count *= priority_thread_weight_;
+  }
+  int32_t new_count = starting_count + count * sample_weight_.LoadRelaxed();
+  if (new_count >= hot_method_threshold_) {
+    if (code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+      return;
+    }
+    if (throttle_compilations_.LoadRelaxed()) {
+      method->SetCounter(hot_method_threshold_ - 1);
+      return;
+    }
+    thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+    new_count = hot_method_threshold_;
+  }
+  method->SetCounter(new_count);
+}
+
 void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
   Runtime* runtime = Runtime::Current();
-  if (UNLIKELY(runtime->UseJitCompilation() && runtime->GetJit()->JitAtFirstUse())) {
+  if (UNLIKELY(runtime->UseJitCompilation() &&
+               runtime->GetJit()->JitAtFirstUse() &&
+               thread_pool_ != nullptr)) {
     // The compiler requires a ProfilingInfo object.
     ProfilingInfo::Create(thread, method, /* retry_allocation */ true);
     JitCompileTask compile_task(method, JitCompileTask::kCompile);
@@ -699,6 +1160,14 @@ void Jit::InvokeVirtualOrInterface(Thread* thread,
   }
 }
 
+void Jit::ConditionalBranch(Thread* thread, ArtMethod* method, uint32_t dex_pc, bool taken) {
+  ScopedAssertNoThreadSuspension ants(thread, __FUNCTION__);
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (info != nullptr) {
+    info->AddBranchInfo(dex_pc, taken);
+  }
+}
+
 void Jit::WaitForCompilationToFinish(Thread* self) {
   if (thread_pool_ != nullptr) {
     thread_pool_->Wait(self, false, false);
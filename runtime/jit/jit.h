@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_JIT_JIT_H_
 #define ART_RUNTIME_JIT_JIT_H_
 
+#include "atomic.h"
 #include "base/arena_allocator.h"
 #include "base/histogram-inl.h"
 #include "base/macros.h"
@@ -30,6 +31,7 @@
 namespace art {
 
 class ArtMethod;
+class LinearAlloc;
 struct RuntimeArgumentMap;
 
 namespace jit {
@@ -37,6 +39,17 @@ namespace jit {
 class JitCodeCache;
 class JitOptions;
 
+// What the JIT did for one compilation request, kept for diagnostics.
+struct JitCompilationRecord {
+  std::string method;
+  const char* kind;
+  uint64_t queue_wait_ns;
+  uint64_t compile_time_ns;
+  size_t code_size;
+  size_t inlined_methods;
+  bool success;
+};
+
 static constexpr int16_t kJitCheckForOSR = -1;
 static constexpr int16_t kJitHotnessDisabled = -2;
 
@@ -46,10 +59,24 @@ class Jit {
   static constexpr size_t kDefaultCompileThreshold = kStressMode ? 2 : 10000;
   static constexpr size_t kDefaultPriorityThreadWeightRatio = 1000;
   static constexpr size_t kDefaultInvokeTransitionWeightRatio = 500;
+  static constexpr size_t kDefaultPoolThreads = 1;
+  // With tiered compilation, baseline compiled methods are sampled every
+  // `kTierUpSamplingPeriodMs`, and recompiled with the optimizing tier once they have been
+  // invoked in `kTierUpSampleThreshold` consecutive periods.
+  static constexpr uint64_t kTierUpSamplingPeriodMs = 100;
+  static constexpr uint8_t kTierUpSampleThreshold = 4;
+  // The effective thresholds follow the load of the compilation queue. While the queue is empty
+  // and the code cache has room, samples weigh up to `kMaxSampleWeight` times more. While it
+  // holds more than `kCompilationQueueHighWatermark` requests, methods are kept just below
+  // the compile and OSR thresholds until it drains.
+  static constexpr uint16_t kMaxSampleWeight = 8;
+  static constexpr size_t kCompilationQueueHighWatermark = 32;
+  // Number of the latest compilations kept for DumpCompilationRecords.
+  static constexpr size_t kCompilationRecordCapacity = 256;
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
-  bool CompileMethod(ArtMethod* method, Thread* self, bool osr)
+  bool CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void CreateThreadPool();
 
@@ -62,6 +89,11 @@ class Jit {
   }
 
   void DeleteThreadPool();
+
+  // Drop the queued compilation requests for methods allocated in `alloc`, which is about
+  // to be freed with its class loader.
+  void RemoveCompilationTasksIn(Thread* self, const LinearAlloc& alloc)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   // Dump interesting info: #methods compiled, code vs data size, compile / verify cumulative
   // loggers.
   void DumpInfo(std::ostream& os) REQUIRES(!lock_);
@@ -97,6 +129,15 @@ class Jit {
     return profile_saver_options_.IsEnabled();
   }
 
+  // Returns whether hot methods are first compiled with the baseline tier.
+  bool UseTieredCompilation() const {
+    return use_tiered_compilation_;
+  }
+
+  // Sample the baseline compiled methods and queue the hot ones for optimized compilation.
+  // Called from the heap task processor.
+  void RunTierUpSampling(Thread* self) REQUIRES(!Locks::mutator_lock_);
+
   // Wait until there is no more pending compilation tasks.
   void WaitForCompilationToFinish(Thread* self);
 
@@ -107,6 +148,11 @@ class Jit {
   void AddSamples(Thread* self, ArtMethod* method, uint16_t samples, bool with_backedges)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Count invocations of `method` through the generic JNI trampoline, and request a JNI
+  // stub once the method is hot.
+  void AddSamplesForNative(Thread* self, ArtMethod* method, uint16_t samples)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void InvokeVirtualOrInterface(Thread* thread,
                                 mirror::Object* this_object,
                                 ArtMethod* caller,
@@ -114,6 +160,10 @@ class Jit {
                                 ArtMethod* callee)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Record whether the conditional branch at `dex_pc` in `method` was taken.
+  void ConditionalBranch(Thread* thread, ArtMethod* method, uint32_t dex_pc, bool taken)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void NotifyInterpreterToCompiledCodeTransition(Thread* self, ArtMethod* caller)
       SHARED_REQUIRES(Locks::mutator_lock_) {
     AddSamples(self, caller, invoke_transition_weight_, false);
@@ -124,6 +174,19 @@ class Jit {
     AddSamples(self, callee, invoke_transition_weight_, false);
   }
 
+  // With -Xjitwarmupfromprofile, load the methods recorded in the profile `filename` by a
+  // previous run. Those methods start hot, so they get compiled on their first invocations
+  // rather than after reaching the compile threshold again.
+  void LoadWarmupProfile(const std::string& filename) REQUIRES(!Locks::mutator_lock_);
+
+  // With -Xjitzygoteprofile, compile the boot class path methods that the profile marks hot
+  // and that have no AOT code, before the first fork of the zygote. The zygote has no JIT
+  // threads, its children share that code and only JIT what it does not cover.
+  void PreZygoteFork() REQUIRES(!Locks::mutator_lock_);
+
+  // Start the JIT threads in a child of the zygote.
+  void PostZygoteFork();
+
   // Starts the profile saver if the config options allow profile recording.
   // The profile will be stored in the specified `filename` and will contain
   // information collected from the given `code_paths` (a set of dex locations).
@@ -139,9 +202,33 @@ class Jit {
 
   void DumpForSigQuit(std::ostream& os) REQUIRES(!lock_);
 
+  // Keep a record of a compilation request run by the JIT thread pool.
+  void RecordCompilation(Thread* self,
+                         ArtMethod* method,
+                         bool osr,
+                         bool baseline,
+                         uint64_t queue_wait_ns,
+                         uint64_t compile_time_ns,
+                         bool success)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Adapt the sample weight and the throttling of new requests to the length of the
+  // compilation queue and the use of the code cache. Called after each request.
+  void UpdateCompilationLoad(Thread* self);
+
+  // Returns the number of compilation requests waiting for a JIT thread.
+  size_t GetCompilationQueueLength(Thread* self);
+
+  // Dump the kept compilation records, oldest first, as one tab separated line each.
+  void DumpCompilationRecords(std::ostream& os) REQUIRES(!lock_);
+
   static void NewTypeLoadedIfUsingJit(mirror::Class* type)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Make the methods of `type` found in the warmup profile hot.
+  void WarmUpFromProfile(mirror::Class* type) SHARED_REQUIRES(Locks::mutator_lock_);
+
   // If debug info generation is turned on then write the type information for types already loaded
   // into the specified class linker to the jit debug interface,
   void DumpTypeInfoForLoadedTypes(ClassLinker* linker);
@@ -173,23 +260,40 @@ class Jit {
 
   static bool LoadCompiler(std::string* error_msg);
 
+  // Return the boot class path methods of the zygote profile that are worth compiling.
+  void GetZygoteMethods(const ProfileCompilationInfo& profile, std::vector<ArtMethod*>* methods)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Schedule the tier up sampling task if it is not already pending.
+  void StartTierUpSampling(Thread* self);
+
   // JIT compiler
   static void* jit_library_handle_;
   static void* jit_compiler_handle_;
   static void* (*jit_load_)(bool*);
   static void (*jit_unload_)(void*);
-  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool);
   static void (*jit_types_loaded_)(void*, mirror::Class**, size_t count);
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
   CumulativeLogger cumulative_timings_;
   Histogram<uint64_t> memory_use_ GUARDED_BY(lock_);
+  // The methods that took the most arena memory to compile.
+  LargestArenaUses largest_memory_uses_ GUARDED_BY(lock_);
+  // Ring buffer of the latest compilations. Once full, `next_compilation_record_` is the
+  // index of the oldest one.
+  std::vector<JitCompilationRecord> compilation_records_ GUARDED_BY(lock_);
+  size_t next_compilation_record_ GUARDED_BY(lock_);
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   std::unique_ptr<jit::JitCodeCache> code_cache_;
 
   bool use_jit_compilation_;
+  bool use_tiered_compilation_;
+  bool warmup_from_profile_;
+  // Profile of the methods the zygote compiles, cleared once they are compiled.
+  std::string zygote_profile_;
   ProfileSaverOptions profile_saver_options_;
   static bool generate_debug_info_;
   uint16_t hot_method_threshold_;
@@ -197,8 +301,20 @@ class Jit {
   uint16_t osr_method_threshold_;
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   std::unique_ptr<ThreadPool> thread_pool_;
 
+  // Factor applied to hotness samples, and whether new compilation requests are held back.
+  // Set by UpdateCompilationLoad.
+  Atomic<uint16_t> sample_weight_;
+  Atomic<bool> throttle_compilations_;
+
+  // Whether a tier up sampling task is queued on the heap task processor.
+  Atomic<bool> tier_up_sampling_pending_;
+
+  // Profile of a previous run, set once by LoadWarmupProfile and read by class loading.
+  Atomic<ProfileCompilationInfo*> warmup_profile_;
+
   DISALLOW_COPY_AND_ASSIGN(Jit);
 };
 
@@ -220,6 +336,9 @@ class JitOptions {
   size_t GetInvokeTransitionWeight() const {
     return invoke_transition_weight_;
   }
+  size_t GetThreadPoolSize() const {
+    return thread_pool_size_;
+  }
   size_t GetCodeCacheInitialCapacity() const {
     return code_cache_initial_capacity_;
   }
@@ -238,6 +357,21 @@ class JitOptions {
   bool UseJitCompilation() const {
     return use_jit_compilation_;
   }
+  bool UseTieredCompilation() const {
+    return use_tiered_compilation_;
+  }
+  bool WarmupFromProfile() const {
+    return warmup_from_profile_;
+  }
+  const std::string& GetZygoteProfile() const {
+    return zygote_profile_;
+  }
+  bool WritePerfMap() const {
+    return write_perf_map_;
+  }
+  bool WriteJitDump() const {
+    return write_jit_dump_;
+  }
   void SetUseJitCompilation(bool b) {
     use_jit_compilation_ = b;
   }
@@ -251,6 +385,8 @@ class JitOptions {
 
  private:
   bool use_jit_compilation_;
+  bool use_tiered_compilation_;
+  bool warmup_from_profile_;
   size_t code_cache_initial_capacity_;
   size_t code_cache_max_capacity_;
   size_t compile_threshold_;
@@ -258,15 +394,24 @@ class JitOptions {
   size_t osr_threshold_;
   uint16_t priority_thread_weight_;
   size_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   bool dump_info_on_shutdown_;
+  bool write_perf_map_;
+  bool write_jit_dump_;
+  std::string zygote_profile_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
       : use_jit_compilation_(false),
+        use_tiered_compilation_(false),
+        warmup_from_profile_(false),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
         compile_threshold_(0),
-        dump_info_on_shutdown_(false) {}
+        thread_pool_size_(Jit::kDefaultPoolThreads),
+        dump_info_on_shutdown_(false),
+        write_perf_map_(false),
+        write_jit_dump_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
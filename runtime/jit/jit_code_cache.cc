@@ -16,6 +16,7 @@
 
 #include "jit_code_cache.h"
 
+#include <set>
 #include <sstream>
 
 #include "art_method-inl.h"
@@ -23,9 +24,11 @@
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/time_utils.h"
+#include "cha.h"
 #include "debugger_interface.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "gc/accounting/bitmap-inl.h"
+#include "gc/allocator/dlmalloc.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "jit/jit.h"
 #include "jit/profiling_info.h"
@@ -57,13 +60,17 @@ static constexpr size_t kStackMapSizeLogThreshold = 50 * KB;
 JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
                                    size_t max_capacity,
                                    bool generate_debug_info,
+                                   bool separate_cold_code,
+                                   bool write_perf_map,
+                                   bool write_jit_dump,
                                    std::string* error_msg) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   CHECK_GE(max_capacity, initial_capacity);
 
   // Generating debug information is mostly for using the 'perf' tool, which does
-  // not work with ashmem.
-  bool use_ashmem = !generate_debug_info;
+  // not work with ashmem. Neither does the perf map. The jitdump has its own copy
+  // of the code.
+  bool use_ashmem = !generate_debug_info && !write_perf_map;
   // With 'perf', we want a 1-1 mapping between an address and a method.
   bool garbage_collect_code = !generate_debug_info;
 
@@ -112,8 +119,26 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
   data_size = initial_capacity / 2;
   code_size = initial_capacity - data_size;
   DCHECK_EQ(code_size + data_size, initial_capacity);
-  return new JitCodeCache(
-      code_map, data_map, code_size, data_size, max_capacity, garbage_collect_code);
+
+  // Failing to create the logs is not fatal, the code cache works without them.
+  std::unique_ptr<JitLogger> jit_logger(new JitLogger());
+  if (write_perf_map) {
+    UNUSED(jit_logger->OpenPerfMapLog());
+  }
+  if (write_jit_dump) {
+    UNUSED(jit_logger->OpenJitDumpLog());
+  }
+  if (!jit_logger->IsEnabled()) {
+    jit_logger.reset();
+  }
+  return new JitCodeCache(code_map,
+                          data_map,
+                          code_size,
+                          data_size,
+                          max_capacity,
+                          garbage_collect_code,
+                          separate_cold_code,
+                          jit_logger.release());
 }
 
 JitCodeCache::JitCodeCache(MemMap* code_map,
@@ -121,30 +146,51 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
                            size_t initial_code_capacity,
                            size_t initial_data_capacity,
                            size_t max_capacity,
-                           bool garbage_collect_code)
+                           bool garbage_collect_code,
+                           bool separate_cold_code,
+                           JitLogger* jit_logger)
     : lock_("Jit code cache", kJitCodeCacheLock),
       lock_cond_("Jit code cache variable", lock_),
       collection_in_progress_(false),
       code_map_(code_map),
       data_map_(data_map),
+      cold_code_mspace_(nullptr),
+      cold_code_begin_(nullptr),
       max_capacity_(max_capacity),
       current_capacity_(initial_code_capacity + initial_data_capacity),
       code_end_(initial_code_capacity),
       data_end_(initial_data_capacity),
+      cold_code_end_(0),
       last_collection_increased_code_cache_(false),
       last_update_time_ns_(0),
       garbage_collect_code_(garbage_collect_code),
+      jit_logger_(jit_logger),
       used_memory_for_data_(0),
       used_memory_for_code_(0),
+      used_memory_for_cold_code_(0),
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_deoptimizations_(0),
       number_of_collections_(0),
+      number_of_full_collections_(0),
+      number_of_cold_methods_collected_(0),
+      total_collection_time_ns_(0),
+      first_collection_start_ns_(0),
+      last_collection_start_ns_(0),
+      code_index_(nullptr),
+      code_index_readers_(0),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
       histogram_code_memory_use_("Memory used for compiled code", 16),
       histogram_profiling_info_memory_use_("Memory used for profiling info", 16) {
 
   DCHECK_GE(max_capacity, initial_code_capacity + initial_data_capacity);
+  size_t cold_code_capacity = RoundDown(code_map_->Size() / kColdCodeRegionDivisor, kPageSize);
+  if (separate_cold_code && cold_code_capacity != 0) {
+    // The cold code region grows from its own base, the regular code must stay below it.
+    cold_code_begin_ = code_map_->End() - cold_code_capacity;
+    code_end_ = std::min(code_end_, static_cast<size_t>(cold_code_begin_ - code_map_->Begin()));
+    cold_code_end_ = kPageSize;
+  }
   code_mspace_ = create_mspace_with_base(code_map_->Begin(), code_end_, false /*locked*/);
   data_mspace_ = create_mspace_with_base(data_map_->Begin(), data_end_, false /*locked*/);
 
@@ -152,6 +198,13 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
     PLOG(FATAL) << "create_mspace_with_base failed";
   }
 
+  if (cold_code_begin_ != nullptr) {
+    cold_code_mspace_ = create_mspace_with_base(cold_code_begin_, cold_code_end_, false /*locked*/);
+    if (cold_code_mspace_ == nullptr) {
+      PLOG(FATAL) << "create_mspace_with_base failed";
+    }
+  }
+
   SetFootprintLimit(current_capacity_);
 
   CHECKED_MPROTECT(code_map_->Begin(), code_map_->Size(), kProtCode);
@@ -163,6 +216,12 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
             << PrettySize(initial_code_capacity);
 }
 
+JitCodeCache::~JitCodeCache() {
+  DCHECK_EQ(code_index_readers_.LoadSequentiallyConsistent(), 0);
+  delete code_index_.LoadRelaxed();
+  STLDeleteElements(&retired_code_indices_);
+}
+
 bool JitCodeCache::ContainsPc(const void* ptr) const {
   return code_map_->Begin() <= ptr && ptr < code_map_->End();
 }
@@ -203,7 +262,10 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                   size_t fp_spill_mask,
                                   const uint8_t* code,
                                   size_t code_size,
-                                  bool osr) {
+                                  bool osr,
+                                  bool baseline,
+                                  const ArenaSet<ArtMethod*>&
+                                      cha_single_implementation_list) {
   uint8_t* result = CommitCodeInternal(self,
                                        method,
                                        vmap_table,
@@ -212,7 +274,9 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                        fp_spill_mask,
                                        code,
                                        code_size,
-                                       osr);
+                                       osr,
+                                       baseline,
+                                       cha_single_implementation_list);
   if (result == nullptr) {
     // Retry.
     GarbageCollectCache(self);
@@ -224,7 +288,9 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                 fp_spill_mask,
                                 code,
                                 code_size,
-                                osr);
+                                osr,
+                                baseline,
+                                cha_single_implementation_list);
   }
   return result;
 }
@@ -277,6 +343,7 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
       }
     }
   }
+  PublishCodeIndex();
   for (auto it = osr_code_map_.begin(); it != osr_code_map_.end();) {
     if (alloc.ContainsUnsafe(it->first)) {
       // Note that the code has already been removed in the loop above.
@@ -314,7 +381,10 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                                           size_t fp_spill_mask,
                                           const uint8_t* code,
                                           size_t code_size,
-                                          bool osr) {
+                                          bool osr,
+                                          bool baseline,
+                                          const ArenaSet<ArtMethod*>&
+                                              cha_single_implementation_list) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   // Ensure the header ends up at expected instruction alignment.
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
@@ -329,7 +399,7 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     WaitForPotentialCollectionToComplete(self);
     {
       ScopedCodeCacheWrite scc(code_map_.get());
-      memory = AllocateCode(total_size);
+      memory = AllocateCode(total_size, /* cold */ baseline);
       if (memory == nullptr) {
         return nullptr;
       }
@@ -351,12 +421,52 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
   }
   // We need to update the entry point in the runnable state for the instrumentation.
   {
+    // The single implementation state of the methods the code relies on is checked and
+    // the dependencies recorded under the CHA lock, so that an invalidation either
+    // happens before the code is published, or sees the code as dependent.
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    bool single_impl_still_valid = true;
+    for (ArtMethod* single_impl : cha_single_implementation_list) {
+      if (!single_impl->HasSingleImplementation()) {
+        single_impl_still_valid = false;
+        break;
+      }
+    }
     MutexLock mu(self, lock_);
+    if (!single_impl_still_valid) {
+      VLOG(jit) << "JIT discarded code of " << PrettyMethod(method)
+                << " relying on an invalidated single implementation";
+      ScopedCodeCacheWrite scc(code_map_.get());
+      FreeCode(code_ptr, method);
+      return nullptr;
+    }
+    // A method deoptimized with its inlining callers while we were compiling must not run
+    // compiled again through this code.
+    if (Runtime::Current()->GetInstrumentation()->InlinesDeoptimizedMethod(method,
+                                                                           method_header)) {
+      VLOG(jit) << "JIT discarded code of " << PrettyMethod(method)
+                << " inlining a deoptimized method";
+      ScopedCodeCacheWrite scc(code_map_.get());
+      FreeCode(code_ptr, method);
+      return nullptr;
+    }
+    ClassHierarchyAnalysis* cha = Runtime::Current()->GetClassHierarchyAnalysis();
+    for (ArtMethod* single_impl : cha_single_implementation_list) {
+      cha->AddDependency(single_impl, method, method_header);
+    }
     method_code_map_.Put(code_ptr, method);
+    PublishCodeIndex();
     if (osr) {
       number_of_osr_compilations_++;
       osr_code_map_.Put(method, code_ptr);
     } else {
+      ProfilingInfo* info =
+          method->IsNative() ? nullptr : method->GetProfilingInfo(kRuntimePointerSize);
+      if (info != nullptr) {
+        // Any saved entry point refers to code this compilation replaces.
+        info->SetSavedEntryPoint(nullptr);
+        info->SetIsBaselineCompiled(baseline);
+      }
       Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
           method, method_header->GetEntryPoint());
     }
@@ -366,8 +476,12 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
       GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
     }
     last_update_time_ns_.StoreRelease(NanoTime());
+    if (jit_logger_ != nullptr) {
+      jit_logger_->WriteLog(code_ptr, code_size, method);
+    }
     VLOG(jit)
-        << "JIT added (osr=" << std::boolalpha << osr << std::noboolalpha << ") "
+        << "JIT added (osr=" << std::boolalpha << osr
+        << ", baseline=" << baseline << std::noboolalpha << ") "
         << PrettyMethod(method) << "@" << method
         << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
         << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
@@ -390,6 +504,11 @@ size_t JitCodeCache::CodeCacheSize() {
   return CodeCacheSizeLocked();
 }
 
+bool JitCodeCache::IsNearlyFull() {
+  MutexLock mu(Thread::Current(), lock_);
+  return CodeCacheSizeLocked() + DataCacheSizeLocked() >= max_capacity_ / 4 * 3;
+}
+
 size_t JitCodeCache::CodeCacheSizeLocked() {
   return used_memory_for_code_;
 }
@@ -399,6 +518,16 @@ size_t JitCodeCache::DataCacheSize() {
   return DataCacheSizeLocked();
 }
 
+size_t JitCodeCache::GetNumberOfCompilations() {
+  MutexLock mu(Thread::Current(), lock_);
+  return number_of_compilations_;
+}
+
+size_t JitCodeCache::GetNumberOfOsrCompilations() {
+  MutexLock mu(Thread::Current(), lock_);
+  return number_of_osr_compilations_;
+}
+
 size_t JitCodeCache::DataCacheSizeLocked() {
   return used_memory_for_data_;
 }
@@ -511,6 +640,16 @@ void JitCodeCache::SetFootprintLimit(size_t new_footprint) {
   mspace_set_footprint_limit(data_mspace_, per_space_footprint);
   {
     ScopedCodeCacheWrite scc(code_map_.get());
+    if (cold_code_mspace_ != nullptr) {
+      // The cold code gets a quarter of the code budget on top of it, within its region.
+      size_t cold_footprint =
+          std::max(kPageSize, RoundDown(per_space_footprint / kColdCodeRegionDivisor, kPageSize));
+      mspace_set_footprint_limit(
+          cold_code_mspace_,
+          std::min(cold_footprint, static_cast<size_t>(code_map_->End() - cold_code_begin_)));
+      per_space_footprint =
+          std::min(per_space_footprint, static_cast<size_t>(cold_code_begin_ - code_map_->Begin()));
+    }
     mspace_set_footprint_limit(code_mspace_, per_space_footprint);
   }
 }
@@ -586,10 +725,20 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       return;
     } else {
       number_of_collections_++;
+      last_collection_start_ns_ = NanoTime();
+      if (number_of_collections_ == 1) {
+        first_collection_start_ns_ = last_collection_start_ns_;
+      }
+      uint8_t* bitmap_end = code_map_->Begin() + current_capacity_ / 2;
+      if (cold_code_mspace_ != nullptr) {
+        // Cover what the cold code region can grow to while we collect.
+        bitmap_end = std::max(bitmap_end,
+                              cold_code_begin_ + mspace_footprint_limit(cold_code_mspace_));
+      }
       live_bitmap_.reset(CodeCacheBitmap::Create(
           "code-cache-bitmap",
           reinterpret_cast<uintptr_t>(code_map_->Begin()),
-          reinterpret_cast<uintptr_t>(code_map_->Begin() + current_capacity_ / 2)));
+          reinterpret_cast<uintptr_t>(bitmap_end)));
       collection_in_progress_ = true;
     }
   }
@@ -626,6 +775,7 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       // Increase the code cache only when we do partial collections.
       // TODO: base this strategy on how full the code cache is?
       if (do_full_collection) {
+        number_of_full_collections_++;
         last_collection_increased_code_cache_ = false;
       } else {
         last_collection_increased_code_cache_ = true;
@@ -641,7 +791,8 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
         // interpreter will update its entry point to the compiled code and call it.
         for (ProfilingInfo* info : profiling_infos_) {
           const void* entry_point = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
-          if (ContainsPc(entry_point)) {
+          if (ContainsPc(entry_point) &&
+              !IsZygoteCode(OatQuickMethodHeader::FromEntryPoint(entry_point)->GetCode())) {
             info->SetSavedEntryPoint(entry_point);
             Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
                 info->GetMethod(), GetQuickToInterpreterBridge());
@@ -651,28 +802,48 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
         DCHECK(CheckLiveCompiledCodeHasProfilingInfo());
       }
       live_bitmap_.reset(nullptr);
+      total_collection_time_ns_ += NanoTime() - last_collection_start_ns_;
       NotifyCollectionDone(self);
     }
   }
   Runtime::Current()->GetJit()->AddTimingLogger(logger);
 }
 
-void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
-  ScopedTrace trace(__FUNCTION__);
+void JitCodeCache::FreeAllMethodHeaders(
+    const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
+  Thread* self = Thread::Current();
+  {
+    // The CHA lock is above the code cache lock, so the dependencies are removed first.
+    MutexLock cha_mu(self, *Locks::cha_lock_);
+    Runtime::Current()->GetClassHierarchyAnalysis()->RemoveDependentsWithMethodHeaders(
+        method_headers);
+  }
   MutexLock mu(self, lock_);
   ScopedCodeCacheWrite scc(code_map_.get());
-  // Iterate over all compiled code and remove entries that are not marked.
-  for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
-    const void* code_ptr = it->first;
-    ArtMethod* method = it->second;
-    uintptr_t allocation = FromCodeToAllocation(code_ptr);
-    if (GetLiveBitmap()->Test(allocation)) {
-      ++it;
-    } else {
-      FreeCode(code_ptr, method);
-      it = method_code_map_.erase(it);
+  for (const OatQuickMethodHeader* method_header : method_headers) {
+    FreeCode(method_header->GetCode(), /* method */ nullptr);
+  }
+}
+
+void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
+  ScopedTrace trace(__FUNCTION__);
+  std::unordered_set<OatQuickMethodHeader*> method_headers;
+  {
+    MutexLock mu(self, lock_);
+    // Iterate over all compiled code and remove entries that are not marked.
+    for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
+      const void* code_ptr = it->first;
+      uintptr_t allocation = FromCodeToAllocation(code_ptr);
+      if (GetLiveBitmap()->Test(allocation)) {
+        ++it;
+      } else {
+        method_headers.insert(OatQuickMethodHeader::FromCodePointer(code_ptr));
+        it = method_code_map_.erase(it);
+      }
     }
+    PublishCodeIndex();
   }
+  FreeAllMethodHeaders(method_headers);
 }
 
 void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
@@ -680,37 +851,61 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
   {
     MutexLock mu(self, lock_);
     if (collect_profiling_info) {
-      // Clear the profiling info of methods that do not have compiled code as entrypoint.
-      // Also remove the saved entry point from the ProfilingInfo objects.
+      // Age the compiled code that was polled for liveness: code invoked since the poll
+      // is young again, code that stayed cold for `kColdCodeAge` polls is freed, and the
+      // rest is kept behind its saved entry point for another round.
+      // Also clear the profiling info of methods that do not have compiled code.
       for (ProfilingInfo* info : profiling_infos_) {
         const void* ptr = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
-        if (!ContainsPc(ptr) && !info->IsInUseByCompiler()) {
-          info->GetMethod()->SetProfilingInfo(nullptr);
+        const void* saved_entry_point = info->GetSavedEntryPoint();
+        bool keep_saved_code = false;
+        if (saved_entry_point != nullptr) {
+          if (ContainsPc(ptr)) {
+            info->SetSavedEntryPoint(nullptr);
+            info->ResetCodeAge();
+          } else if (info->IncrementCodeAge() < kColdCodeAge) {
+            keep_saved_code = true;
+            const void* code_ptr =
+                OatQuickMethodHeader::FromEntryPoint(saved_entry_point)->GetCode();
+            GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+          } else {
+            info->SetSavedEntryPoint(nullptr);
+            info->ResetCodeAge();
+            // We are going to move this method back to interpreter. Clear the counter now to
+            // give it a chance to be hot again.
+            info->GetMethod()->ClearCounter();
+            // The baseline code is going away with the rest of the cold code.
+            info->SetIsBaselineCompiled(false);
+            number_of_cold_methods_collected_++;
+          }
         }
 
-        if (info->GetSavedEntryPoint() != nullptr) {
-          info->SetSavedEntryPoint(nullptr);
-          // We are going to move this method back to interpreter. Clear the counter now to
-          // give it a chance to be hot again.
-          info->GetMethod()->ClearCounter();
+        if (!ContainsPc(ptr) && !keep_saved_code && !info->IsInUseByCompiler()) {
+          info->GetMethod()->SetProfilingInfo(nullptr);
         }
       }
-    } else if (kIsDebugBuild) {
-      // Sanity check that the profiling infos do not have a dangling entry point.
+    } else {
+      // Code behind a saved entry point is only waiting on its next invocation, either for
+      // a liveness poll or for tier up sampling. Keep it alive.
       for (ProfilingInfo* info : profiling_infos_) {
-        DCHECK(info->GetSavedEntryPoint() == nullptr);
+        const void* entry_point = info->GetSavedEntryPoint();
+        if (entry_point != nullptr) {
+          const void* code_ptr = OatQuickMethodHeader::FromEntryPoint(entry_point)->GetCode();
+          GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+        }
       }
     }
 
-    // Mark compiled code that are entrypoints of ArtMethods. Compiled code that is not
-    // an entry point is either:
+    // Mark compiled code that are entrypoints of ArtMethods, and the code of the zygote.
+    // Compiled code that is not an entry point is either:
     // - an osr compiled code, that will be removed if not in a thread call stack.
     // - discarded compiled code, that will be removed if not in a thread call stack.
     for (const auto& it : method_code_map_) {
       ArtMethod* method = it.second;
       const void* code_ptr = it.first;
       const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
-      if (method_header->GetEntryPoint() == method->GetEntryPointFromQuickCompiledCode()) {
+      if (method_header->GetEntryPoint() == method->GetEntryPointFromQuickCompiledCode() ||
+          IsZygoteCode(code_ptr)) {
         GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
       }
     }
@@ -768,7 +963,7 @@ bool JitCodeCache::CheckLiveCompiledCodeHasProfilingInfo() {
   // have memory leaks of compiled code otherwise.
   for (const auto& it : method_code_map_) {
     ArtMethod* method = it.second;
-    if (method->GetProfilingInfo(kRuntimePointerSize) == nullptr) {
+    if (!method->IsNative() && method->GetProfilingInfo(kRuntimePointerSize) == nullptr) {
       const void* code_ptr = it.first;
       const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
       if (method_header->GetEntryPoint() == method->GetEntryPointFromQuickCompiledCode()) {
@@ -792,25 +987,52 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
     return nullptr;
   }
 
-  MutexLock mu(Thread::Current(), lock_);
-  if (method_code_map_.empty()) {
-    return nullptr;
+  code_index_readers_.FetchAndAddSequentiallyConsistent(1);
+  const CodeIndex* index = code_index_.LoadSequentiallyConsistent();
+  OatQuickMethodHeader* method_header = nullptr;
+  ArtMethod* found_method = nullptr;
+  if (index != nullptr) {
+    // Find the last entry starting at or before `pc`.
+    auto it = std::upper_bound(
+        index->begin(),
+        index->end(),
+        reinterpret_cast<const void*>(pc),
+        [](const void* value, const std::pair<const void*, ArtMethod*>& entry) {
+          return value < entry.first;
+        });
+    if (it != index->begin()) {
+      --it;
+      OatQuickMethodHeader* header = OatQuickMethodHeader::FromCodePointer(it->first);
+      if (header->Contains(pc)) {
+        method_header = header;
+        found_method = it->second;
+      }
+    }
   }
-  auto it = method_code_map_.lower_bound(reinterpret_cast<const void*>(pc));
-  --it;
+  code_index_readers_.FetchAndSubSequentiallyConsistent(1);
 
-  const void* code_ptr = it->first;
-  OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
-  if (!method_header->Contains(pc)) {
-    return nullptr;
-  }
-  if (kIsDebugBuild && method != nullptr) {
-    DCHECK_EQ(it->second, method)
-        << PrettyMethod(method) << " " << PrettyMethod(it->second) << " " << std::hex << pc;
+  if (kIsDebugBuild && method != nullptr && method_header != nullptr) {
+    DCHECK_EQ(found_method, method)
+        << PrettyMethod(method) << " " << PrettyMethod(found_method) << " " << std::hex << pc;
   }
   return method_header;
 }
 
+void JitCodeCache::PublishCodeIndex() {
+  ScopedTrace trace(__FUNCTION__);
+  const CodeIndex* new_index = new CodeIndex(method_code_map_.begin(), method_code_map_.end());
+  const CodeIndex* old_index = code_index_.LoadRelaxed();
+  code_index_.StoreSequentiallyConsistent(new_index);
+  if (old_index != nullptr) {
+    retired_code_indices_.push_back(old_index);
+  }
+  // Readers that registered after this point will load `new_index`. If there is none
+  // registered now, nobody can still be looking at a retired snapshot.
+  if (code_index_readers_.LoadSequentiallyConsistent() == 0) {
+    STLDeleteElements(&retired_code_indices_);
+  }
+}
+
 OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
   MutexLock mu(Thread::Current(), lock_);
   auto it = osr_code_map_.find(method);
@@ -820,9 +1042,66 @@ OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
   return OatQuickMethodHeader::FromCodePointer(it->second);
 }
 
+bool JitCodeCache::GetCompiledCodeStats(Thread* self,
+                                        ArtMethod* method,
+                                        bool osr,
+                                        size_t* code_size,
+                                        size_t* inlined_methods) {
+  MutexLock mu(self, lock_);
+  const OatQuickMethodHeader* method_header = nullptr;
+  if (osr) {
+    auto it = osr_code_map_.find(method);
+    if (it != osr_code_map_.end()) {
+      method_header = OatQuickMethodHeader::FromCodePointer(it->second);
+    }
+  } else {
+    const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+    if (ContainsPc(entry_point)) {
+      method_header = OatQuickMethodHeader::FromEntryPoint(entry_point);
+    }
+  }
+  if (method_header == nullptr) {
+    return false;
+  }
+  *code_size = method_header->code_size_;
+  CodeInfo code_info = method_header->GetOptimizedCodeInfo();
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  std::set<uint32_t> inlined_method_indices;
+  for (size_t i = 0, e = code_info.GetNumberOfStackMaps(encoding); i < e; ++i) {
+    StackMap stack_map = code_info.GetStackMapAt(i, encoding);
+    if (stack_map.HasInlineInfo(encoding.stack_map_encoding)) {
+      InlineInfo inline_info = code_info.GetInlineInfoOf(stack_map, encoding);
+      uint32_t depth = inline_info.GetDepth(encoding.inline_info_encoding);
+      for (uint32_t d = 0; d < depth; ++d) {
+        inlined_method_indices.insert(
+            inline_info.GetMethodIndexAtDepth(encoding.inline_info_encoding, d));
+      }
+    }
+  }
+  *inlined_methods = inlined_method_indices.size();
+  return true;
+}
+
+void JitCodeCache::GetMethodsInlining(Thread* self,
+                                      ArtMethod* method,
+                                      std::vector<ArtMethod*>* callers) {
+  MutexLock mu(self, lock_);
+  for (const auto& it : method_code_map_) {
+    if (OatQuickMethodHeader::FromCodePointer(it.first)->HasInlinedMethod(it.second, method)) {
+      callers->push_back(it.second);
+    }
+  }
+  for (const auto& it : osr_code_map_) {
+    if (OatQuickMethodHeader::FromCodePointer(it.second)->HasInlinedMethod(it.first, method)) {
+      callers->push_back(it.first);
+    }
+  }
+}
+
 ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
                                               ArtMethod* method,
                                               const std::vector<uint32_t>& entries,
+                                              const std::vector<uint32_t>& branch_entries,
                                               bool retry_allocation)
     // No thread safety analysis as we are using TryLock/Unlock explicitly.
     NO_THREAD_SAFETY_ANALYSIS {
@@ -831,19 +1110,19 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
     // If we are allocating for the interpreter, just try to lock, to avoid
     // lock contention with the JIT.
     if (lock_.ExclusiveTryLock(self)) {
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
       lock_.ExclusiveUnlock(self);
     }
   } else {
     {
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
 
     if (info == nullptr) {
       GarbageCollectCache(self);
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
   }
   return info;
@@ -851,9 +1130,12 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
 
 ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNUSED,
                                                       ArtMethod* method,
-                                                      const std::vector<uint32_t>& entries) {
+                                                      const std::vector<uint32_t>& entries,
+                                                      const std::vector<uint32_t>& branch_entries) {
   size_t profile_info_size = RoundUp(
-      sizeof(ProfilingInfo) + sizeof(InlineCache) * entries.size(),
+      sizeof(ProfilingInfo) +
+          sizeof(InlineCache) * entries.size() +
+          sizeof(BranchCache) * branch_entries.size(),
       sizeof(void*));
 
   // Check whether some other thread has concurrently created it.
@@ -866,7 +1148,7 @@ ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNU
   if (data == nullptr) {
     return nullptr;
   }
-  info = new (data) ProfilingInfo(method, entries);
+  info = new (data) ProfilingInfo(method, entries, branch_entries);
 
   // Make sure other threads see the data in the profiling info object before the
   // store in the ArtMethod's ProfilingInfo pointer.
@@ -885,6 +1167,10 @@ void* JitCodeCache::MoreCore(const void* mspace, intptr_t increment) NO_THREAD_S
     size_t result = code_end_;
     code_end_ += increment;
     return reinterpret_cast<void*>(result + code_map_->Begin());
+  } else if (cold_code_mspace_ != nullptr && cold_code_mspace_ == mspace) {
+    size_t result = cold_code_end_;
+    cold_code_end_ += increment;
+    return reinterpret_cast<void*>(result + cold_code_begin_);
   } else {
     DCHECK_EQ(data_mspace_, mspace);
     size_t result = data_end_;
@@ -915,9 +1201,21 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   return osr_code_map_.find(method) != osr_code_map_.end();
 }
 
-bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr) {
+bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline) {
+  if (method->IsNative()) {
+    // A JNI stub has a single tier and no OSR entry, so it is compiled at most once.
+    if (osr || ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+      return false;
+    }
+    MutexLock mu(self, lock_);
+    return jni_stubs_being_compiled_.insert(method).second;
+  }
+
   if (!osr && ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
-    return false;
+    ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+    if (baseline || info == nullptr || !info->IsBaselineCompiled()) {
+      return false;
+    }
   }
 
   MutexLock mu(self, lock_);
@@ -943,6 +1241,41 @@ bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr
   return true;
 }
 
+size_t JitCodeCache::SampleBaselineCode(Thread* self,
+                                        uint8_t threshold,
+                                        std::vector<ArtMethod*>* hot_methods) {
+  MutexLock mu(self, lock_);
+  size_t number_of_baseline_methods = 0;
+  for (ProfilingInfo* info : profiling_infos_) {
+    if (!info->IsBaselineCompiled()) {
+      continue;
+    }
+    ++number_of_baseline_methods;
+    if (collection_in_progress_ || info->IsMethodBeingCompiled(/* osr */ false)) {
+      // Leave the entry points alone while they are being looked at.
+      continue;
+    }
+    ArtMethod* method = info->GetMethod();
+    const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+    if (!ContainsPc(entry_point)) {
+      // Not invoked since the previous sample (or still waiting for the first one).
+      info->ResetTierUpSamples();
+      continue;
+    }
+    if (info->GetSavedEntryPoint() == entry_point) {
+      // Jit::MethodEntered restored the entry point.
+      if (info->AddTierUpSample() >= threshold) {
+        info->ResetTierUpSamples();
+        hot_methods->push_back(method);
+      }
+    }
+    info->SetSavedEntryPoint(entry_point);
+    Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
+        method, GetQuickToInterpreterBridge());
+  }
+  return number_of_baseline_methods;
+}
+
 ProfilingInfo* JitCodeCache::NotifyCompilerUse(ArtMethod* method, Thread* self) {
   MutexLock mu(self, lock_);
   ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
@@ -959,7 +1292,15 @@ void JitCodeCache::DoneCompilerUse(ArtMethod* method, Thread* self) {
   info->DecrementInlineUse();
 }
 
-void JitCodeCache::DoneCompiling(ArtMethod* method, Thread* self ATTRIBUTE_UNUSED, bool osr) {
+void JitCodeCache::DoneCompiling(ArtMethod* method, Thread* self, bool osr) {
+  // Several compiler threads may update the flags of the same ProfilingInfo.
+  MutexLock mu(self, lock_);
+  if (method->IsNative()) {
+    DCHECK(!osr);
+    size_t erased = jni_stubs_being_compiled_.erase(method);
+    DCHECK_EQ(erased, 1u);
+    return;
+  }
   ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
   DCHECK(info->IsMethodBeingCompiled(osr));
   info->SetIsMethodBeingCompiled(false, osr);
@@ -972,6 +1313,17 @@ size_t JitCodeCache::GetMemorySizeOfCodePointer(const void* ptr) {
 
 void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
                                              const OatQuickMethodHeader* header) {
+  if (method->IsNative()) {
+    // JNI stubs make no assumptions to invalidate, but if the stub is asked to go away, fall
+    // back to the generic JNI trampoline. Native methods cannot run in the interpreter.
+    if (method->GetEntryPointFromQuickCompiledCode() == header->GetEntryPoint()) {
+      Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
+          method, GetQuickGenericJniStub());
+    }
+    MutexLock mu(Thread::Current(), lock_);
+    number_of_deoptimizations_++;
+    return;
+  }
   ProfilingInfo* profiling_info = method->GetProfilingInfo(kRuntimePointerSize);
   if ((profiling_info != nullptr) &&
       (profiling_info->GetSavedEntryPoint() == header->GetEntryPoint())) {
@@ -998,20 +1350,97 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
   number_of_deoptimizations_++;
 }
 
-uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
+bool JitCodeCache::IsInstalledCode(ArtMethod* method, const OatQuickMethodHeader* header) {
+  if (method->GetEntryPointFromQuickCompiledCode() == header->GetEntryPoint()) {
+    return true;
+  }
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  return (info != nullptr) && (info->GetSavedEntryPoint() == header->GetEntryPoint());
+}
+
+void JitCodeCache::NotifySpeculativeDeoptimization(Thread* self, ArtMethod* method) {
+  DCHECK(!method->IsNative());
+  bool stop_speculating = false;
+  {
+    MutexLock mu(self, lock_);
+    ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+    if (info == nullptr || !info->ShouldSpeculate()) {
+      return;
+    }
+    info->AddSpeculativeDeoptimization();
+    stop_speculating = !info->ShouldSpeculate();
+  }
+  if (stop_speculating) {
+    VLOG(jit) << PrettyMethod(method) << " deoptimized too often, recompiling without speculation";
+    // The method was hot before its code got invalidated: request the new compilation on its
+    // next invocation rather than after warming it up again.
+    method->SetCounter(Runtime::Current()->GetJit()->HotMethodThreshold() - 1);
+  }
+}
+
+void JitCodeCache::FreezeZygoteCode(Thread* self) {
+  MutexLock mu(self, lock_);
+  DCHECK(osr_code_map_.empty());
+  for (const auto& it : method_code_map_) {
+    zygote_code_.insert(it.first);
+  }
+  VLOG(jit) << "JIT code cache shares " << zygote_code_.size() << " methods, "
+            << PrettySize(used_memory_for_code_) << " of code with the children of the zygote";
+}
+
+bool JitCodeCache::IsZygoteCode(const void* code_ptr) const {
+  return zygote_code_.find(code_ptr) != zygote_code_.end();
+}
+
+bool JitCodeCache::IsInColdCodeRegion(const void* ptr) const {
+  return cold_code_begin_ != nullptr && cold_code_begin_ <= ptr;
+}
+
+uint8_t* JitCodeCache::AllocateCode(size_t code_size, bool cold) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
-  uint8_t* result = reinterpret_cast<uint8_t*>(
-      mspace_memalign(code_mspace_, alignment, code_size));
+  uint8_t* result = nullptr;
+  if (cold && cold_code_mspace_ != nullptr) {
+    result = reinterpret_cast<uint8_t*>(mspace_memalign(cold_code_mspace_, alignment, code_size));
+  }
+  if (result == nullptr) {
+    // Cold code falls back to the regular region when its own is full.
+    result = reinterpret_cast<uint8_t*>(mspace_memalign(code_mspace_, alignment, code_size));
+  }
+  if (result == nullptr) {
+    return nullptr;
+  }
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
   // Ensure the header ends up at expected instruction alignment.
   DCHECK_ALIGNED_PARAM(reinterpret_cast<uintptr_t>(result + header_size), alignment);
   used_memory_for_code_ += mspace_usable_size(result);
+  if (IsInColdCodeRegion(result)) {
+    used_memory_for_cold_code_ += mspace_usable_size(result);
+  }
   return result;
 }
 
 void JitCodeCache::FreeCode(uint8_t* code) {
   used_memory_for_code_ -= mspace_usable_size(code);
-  mspace_free(code_mspace_, code);
+  if (IsInColdCodeRegion(code)) {
+    used_memory_for_cold_code_ -= mspace_usable_size(code);
+    mspace_free(cold_code_mspace_, code);
+  } else {
+    mspace_free(code_mspace_, code);
+  }
+}
+
+size_t JitCodeCache::Trim(Thread* self) {
+  ScopedTrace trace(__FUNCTION__);
+  MutexLock mu(self, lock_);
+  size_t reclaimed = 0;
+  // Free chunks only hold dlmalloc's bookkeeping in their first bytes, which the
+  // callback leaves alone, so the code does not need to be made writable.
+  mspace_inspect_all(code_mspace_, DlmallocMadviseCallback, &reclaimed);
+  if (cold_code_mspace_ != nullptr) {
+    mspace_inspect_all(cold_code_mspace_, DlmallocMadviseCallback, &reclaimed);
+  }
+  mspace_inspect_all(data_mspace_, DlmallocMadviseCallback, &reclaimed);
+  return reclaimed;
 }
 
 uint8_t* JitCodeCache::AllocateData(size_t data_size) {
@@ -1027,15 +1456,34 @@ void JitCodeCache::FreeData(uint8_t* data) {
 
 void JitCodeCache::Dump(std::ostream& os) {
   MutexLock mu(Thread::Current(), lock_);
-  os << "Current JIT code cache size: " << PrettySize(used_memory_for_code_) << "\n"
-     << "Current JIT data cache size: " << PrettySize(used_memory_for_data_) << "\n"
+  os << "Current JIT code cache size: " << PrettySize(used_memory_for_code_) << "\n";
+  if (cold_code_mspace_ != nullptr) {
+    size_t hot_code = used_memory_for_code_ - used_memory_for_cold_code_;
+    os << "Current JIT hot/cold code size: " << PrettySize(hot_code) << "/"
+       << PrettySize(used_memory_for_cold_code_) << " ("
+       << (used_memory_for_code_ == 0 ? 0 : hot_code * 100 / used_memory_for_code_)
+       << "% hot)\n";
+  }
+  os << "Current JIT data cache size: " << PrettySize(used_memory_for_data_) << "\n"
      << "Current JIT capacity: " << PrettySize(current_capacity_) << "\n"
      << "Current number of JIT code cache entries: " << method_code_map_.size() << "\n"
+     << "Number of JIT code cache entries compiled by the zygote: " << zygote_code_.size() << "\n"
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
      << "Total number of deoptimizations: " << number_of_deoptimizations_ << "\n"
-     << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
+     << "Total number of JIT code cache collections: " << number_of_collections_ << "\n"
+     << "Total number of full JIT code cache collections: " << number_of_full_collections_ << "\n"
+     << "Total number of cold methods collected: " << number_of_cold_methods_collected_ << "\n"
+     << "Total time spent in JIT code cache collections: "
+        << PrettyDuration(total_collection_time_ns_) << "\n";
+  if (number_of_collections_ > 1) {
+    os << "Average time between JIT code cache collections: "
+       << PrettyDuration((last_collection_start_ns_ - first_collection_start_ns_) /
+                         (number_of_collections_ - 1))
+       << "\n";
+  }
+  os << std::flush;
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
   histogram_code_memory_use_.PrintMemoryUse(os);
   histogram_profiling_info_memory_use_.PrintMemoryUse(os);
@@ -17,14 +17,18 @@
 #ifndef ART_RUNTIME_JIT_JIT_CODE_CACHE_H_
 #define ART_RUNTIME_JIT_JIT_CODE_CACHE_H_
 
+#include <unordered_set>
+
 #include "instrumentation.h"
 
 #include "atomic.h"
+#include "base/arena_containers.h"
 #include "base/histogram-inl.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc/accounting/bitmap.h"
 #include "gc_root.h"
+#include "jit_logger.h"
 #include "jni.h"
 #include "method_reference.h"
 #include "oat_file.h"
@@ -56,20 +60,42 @@ class JitCodeCache {
   // By default, do not GC until reaching 256KB.
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
+  // Number of consecutive liveness polls compiled code must go without being invoked
+  // before a full collection frees it.
+  static constexpr uint8_t kColdCodeAge = 2;
+
+  // When cold code is kept apart, the top 1 / kColdCodeRegionDivisor of the code map
+  // is reserved for it.
+  static constexpr size_t kColdCodeRegionDivisor = 4;
+
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
   // in the out arg error_msg.
+  // If "separate_cold_code" is true, baseline compiled code is allocated in its own
+  // region, away from the optimized code.
   static JitCodeCache* Create(size_t initial_capacity,
                               size_t max_capacity,
                               bool generate_debug_info,
+                              bool separate_cold_code,
+                              bool write_perf_map,
+                              bool write_jit_dump,
                               std::string* error_msg);
 
+  ~JitCodeCache();
+
   // Number of bytes allocated in the code cache.
   size_t CodeCacheSize() REQUIRES(!lock_);
 
   // Number of bytes allocated in the data cache.
   size_t DataCacheSize() REQUIRES(!lock_);
 
-  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr)
+  // Number of compilations committed to the cache so far, and how many of them were for OSR.
+  size_t GetNumberOfCompilations() REQUIRES(!lock_);
+  size_t GetNumberOfOsrCompilations() REQUIRES(!lock_);
+
+  // Return whether `method` should be compiled. Compiled code is only replaced when it
+  // comes from the baseline tier and an optimized (non `baseline`) compilation is requested.
+  // Native methods have no ProfilingInfo and are tracked in `jni_stubs_being_compiled_`.
+  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -98,7 +124,18 @@ class JitCodeCache {
                       size_t fp_spill_mask,
                       const uint8_t* code,
                       size_t code_size,
-                      bool osr)
+                      bool osr,
+                      bool baseline,
+                      const ArenaSet<ArtMethod*>& cha_single_implementation_list)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Tier up sampling of baseline compiled code. Methods that were invoked since the previous
+  // call get a sample, the others have their samples reset. Methods reaching `threshold`
+  // consecutive samples are appended to `hot_methods`. The entry point of every baseline
+  // method is then routed through the interpreter bridge again, so that the next invocation
+  // goes through Jit::MethodEntered. Return the number of baseline compiled methods.
+  size_t SampleBaselineCode(Thread* self, uint8_t threshold, std::vector<ArtMethod*>* hot_methods)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -134,15 +171,30 @@ class JitCodeCache {
 
   // Given the 'pc', try to find the JIT compiled code associated with it.
   // Return null if 'pc' is not in the code cache. 'method' is passed for
-  // sanity check.
+  // sanity check. Does not take the code cache lock.
   OatQuickMethodHeader* LookupMethodHeader(uintptr_t pc, ArtMethod* method)
-      REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   OatQuickMethodHeader* LookupOsrMethodHeader(ArtMethod* method)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Fill in the code size and the number of distinct inlined methods of the code `method`
+  // currently runs (or enters through OSR if `osr`). Return false if there is no such code.
+  bool GetCompiledCodeStats(Thread* self,
+                            ArtMethod* method,
+                            bool osr,
+                            size_t* code_size,
+                            size_t* inlined_methods)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Add to `callers` the methods with JIT compiled code, including OSR code, that has
+  // `method` inlined.
+  void GetMethodsInlining(Thread* self, ArtMethod* method, std::vector<ArtMethod*>* callers)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Remove all methods in our cache that were allocated by 'alloc'.
   void RemoveMethodsIn(Thread* self, const LinearAlloc& alloc)
       REQUIRES(!lock_)
@@ -156,16 +208,22 @@ class JitCodeCache {
   ProfilingInfo* AddProfilingInfo(Thread* self,
                                   ArtMethod* method,
                                   const std::vector<uint32_t>& entries,
+                                  const std::vector<uint32_t>& branch_entries,
                                   bool retry_allocation)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   bool OwnsSpace(const void* mspace) const NO_THREAD_SAFETY_ANALYSIS {
-    return mspace == code_mspace_ || mspace == data_mspace_;
+    return mspace == code_mspace_ || mspace == data_mspace_ ||
+        (cold_code_mspace_ != nullptr && mspace == cold_code_mspace_);
   }
 
   void* MoreCore(const void* mspace, intptr_t increment);
 
+  // Give the unused pages of the code cache back to the kernel. Returns the number of
+  // bytes reclaimed.
+  size_t Trim(Thread* self) REQUIRES(!lock_);
+
   // Adds to `methods` all profiled methods which are part of any of the given dex locations.
   void GetProfiledMethods(const std::set<std::string>& dex_base_locations,
                           std::vector<MethodReference>& methods)
@@ -179,16 +237,35 @@ class JitCodeCache {
     return current_capacity_;
   }
 
+  // Whether three quarters of the maximum capacity are in use.
+  bool IsNearlyFull() REQUIRES(!lock_);
+
   size_t GetMemorySizeOfCodePointer(const void* ptr) REQUIRES(!lock_);
 
   void InvalidateCompiledCodeFor(ArtMethod* method, const OatQuickMethodHeader* code)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Whether `header` is the compiled code `method` runs on its next invocation, possibly
+  // held back in the profiling info while the code cache is being collected.
+  bool IsInstalledCode(ArtMethod* method, const OatQuickMethodHeader* header)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Record that compiled code of `method` deoptimized on a failed HDeoptimize check. Once
+  // this happened too often, `method` is queued for a compilation that does not speculate.
+  void NotifySpeculativeDeoptimization(Thread* self, ArtMethod* method)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) REQUIRES(!lock_);
 
   bool IsOsrCompiled(ArtMethod* method) REQUIRES(!lock_);
 
+  // Keep the code compiled so far for the lifetime of the process. Called by the zygote before
+  // forking: its children run that code from the pages they share with the zygote, and never
+  // collect it.
+  void FreezeZygoteCode(Thread* self) REQUIRES(!lock_);
+
  private:
   // Take ownership of maps.
   JitCodeCache(MemMap* code_map,
@@ -196,7 +273,9 @@ class JitCodeCache {
                size_t initial_code_capacity,
                size_t initial_data_capacity,
                size_t max_capacity,
-               bool garbage_collect_code);
+               bool garbage_collect_code,
+               bool separate_cold_code,
+               JitLogger* jit_logger);
 
   // Internal version of 'CommitCode' that will not retry if the
   // allocation fails. Return null if the allocation fails.
@@ -208,13 +287,16 @@ class JitCodeCache {
                               size_t fp_spill_mask,
                               const uint8_t* code,
                               size_t code_size,
-                              bool osr)
+                              bool osr,
+                              bool baseline,
+                              const ArenaSet<ArtMethod*>& cha_single_implementation_list)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   ProfilingInfo* AddProfilingInfoInternal(Thread* self,
                                           ArtMethod* method,
-                                          const std::vector<uint32_t>& entries)
+                                          const std::vector<uint32_t>& entries,
+                                          const std::vector<uint32_t>& branch_entries)
       REQUIRES(lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -250,6 +332,10 @@ class JitCodeCache {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Free the code of the given method headers, which are no longer in the code maps.
+  void FreeAllMethodHeaders(const std::unordered_set<OatQuickMethodHeader*>& method_headers)
+      REQUIRES(!lock_, !Locks::cha_lock_);
+
   void MarkCompiledCodeOnThreadStacks(Thread* self)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -257,8 +343,14 @@ class JitCodeCache {
   bool CheckLiveCompiledCodeHasProfilingInfo()
       REQUIRES(lock_);
 
+  // Publish a new snapshot of `method_code_map_` for LookupMethodHeader. Must be
+  // called after each update of `method_code_map_`.
+  void PublishCodeIndex() REQUIRES(lock_);
+
   void FreeCode(uint8_t* code) REQUIRES(lock_);
-  uint8_t* AllocateCode(size_t code_size) REQUIRES(lock_);
+  uint8_t* AllocateCode(size_t code_size, bool cold) REQUIRES(lock_);
+  bool IsInColdCodeRegion(const void* ptr) const REQUIRES(lock_);
+  bool IsZygoteCode(const void* code_ptr) const REQUIRES(lock_);
   void FreeData(uint8_t* data) REQUIRES(lock_);
   uint8_t* AllocateData(size_t data_size) REQUIRES(lock_);
 
@@ -276,14 +368,31 @@ class JitCodeCache {
   void* code_mspace_ GUARDED_BY(lock_);
   // The opaque mspace for allocating data.
   void* data_mspace_ GUARDED_BY(lock_);
+  // The opaque mspace for allocating cold code, or null if cold code is not kept apart.
+  // It starts at `cold_code_begin_` in the code map.
+  void* cold_code_mspace_ GUARDED_BY(lock_);
+  uint8_t* cold_code_begin_;
   // Bitmap for collecting code and data.
   std::unique_ptr<CodeCacheBitmap> live_bitmap_;
   // Holds compiled code associated to the ArtMethod.
   SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
+  // Immutable sorted copy of `method_code_map_`, which LookupMethodHeader searches
+  // without the lock. Readers register in `code_index_readers_` before loading
+  // `code_index_`; replaced snapshots are retired and deleted once a publication
+  // sees no reader, as those readers can only have loaded the newer snapshot.
+  using CodeIndex = std::vector<std::pair<const void*, ArtMethod*>>;
+  Atomic<const CodeIndex*> code_index_;
+  Atomic<int32_t> code_index_readers_;
+  std::vector<const CodeIndex*> retired_code_indices_ GUARDED_BY(lock_);
   // Holds osr compiled code associated to the ArtMethod.
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
+  // Native methods whose JNI stub is being compiled. The data pointer of a native
+  // ArtMethod holds its JNI entrypoint, so these cannot use a ProfilingInfo.
+  std::unordered_set<ArtMethod*> jni_stubs_being_compiled_ GUARDED_BY(lock_);
+  // Code compiled by the zygote, see FreezeZygoteCode.
+  std::unordered_set<const void*> zygote_code_ GUARDED_BY(lock_);
 
   // The maximum capacity in bytes this code cache can go to.
   size_t max_capacity_ GUARDED_BY(lock_);
@@ -297,6 +406,9 @@ class JitCodeCache {
   // The current footprint in bytes of the data portion of the code cache.
   size_t data_end_ GUARDED_BY(lock_);
 
+  // The current footprint in bytes of the cold code region of the code cache.
+  size_t cold_code_end_ GUARDED_BY(lock_);
+
   // Whether the last collection round increased the code cache.
   bool last_collection_increased_code_cache_ GUARDED_BY(lock_);
 
@@ -307,12 +419,18 @@ class JitCodeCache {
   // Whether we can do garbage collection.
   const bool garbage_collect_code_;
 
+  // Logs the committed code for perf, if requested. Only used with lock_ held.
+  const std::unique_ptr<JitLogger> jit_logger_;
+
   // The size in bytes of used memory for the data portion of the code cache.
   size_t used_memory_for_data_ GUARDED_BY(lock_);
 
   // The size in bytes of used memory for the code portion of the code cache.
   size_t used_memory_for_code_ GUARDED_BY(lock_);
 
+  // The part of `used_memory_for_code_` allocated in the cold code region.
+  size_t used_memory_for_cold_code_ GUARDED_BY(lock_);
+
   // Number of compilations done throughout the lifetime of the JIT.
   size_t number_of_compilations_ GUARDED_BY(lock_);
 
@@ -325,6 +443,17 @@ class JitCodeCache {
   // Number of code cache collections done throughout the lifetime of the JIT.
   size_t number_of_collections_ GUARDED_BY(lock_);
 
+  // Number of full code cache collections done throughout the lifetime of the JIT.
+  size_t number_of_full_collections_ GUARDED_BY(lock_);
+
+  // Number of methods whose compiled code was freed for being cold.
+  size_t number_of_cold_methods_collected_ GUARDED_BY(lock_);
+
+  // Time spent in code cache collections, and start time of the first and last collections.
+  uint64_t total_collection_time_ns_ GUARDED_BY(lock_);
+  uint64_t first_collection_start_ns_ GUARDED_BY(lock_);
+  uint64_t last_collection_start_ns_ GUARDED_BY(lock_);
+
   // Histograms for keeping track of stack map size statistics.
   Histogram<uint64_t> histogram_stack_map_memory_use_ GUARDED_BY(lock_);
 
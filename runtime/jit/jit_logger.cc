@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit_logger.h"
+
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "arch/instruction_set.h"
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "elf.h"
+#include "globals.h"
+#include "utils.h"
+
+namespace art {
+namespace jit {
+
+#ifdef ART_TARGET_ANDROID
+static const char* kLogPrefix = "/data/misc/trace";
+#else
+static const char* kLogPrefix = "/tmp";
+#endif
+
+// The jitdump format, see tools/perf/Documentation/jitdump-specification.txt in Linux.
+static constexpr uint32_t kJitDumpMagic = 0x4A695444;  // "JiTD"
+static constexpr uint32_t kJitDumpVersion = 1;
+
+enum JitDumpRecordType : uint32_t {
+  kJitDumpCodeLoad = 0,
+  kJitDumpCodeClose = 3,
+};
+
+struct JitDumpHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+static_assert(sizeof(JitDumpHeader) == 40, "Unexpected jitdump header size");
+
+struct JitDumpRecordPrefix {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+// Followed by the name with its terminating null and the code.
+struct JitDumpCodeLoad {
+  JitDumpRecordPrefix prefix;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+static_assert(sizeof(JitDumpCodeLoad) == 56, "Unexpected jitdump code load record size");
+
+static uint32_t GetElfMachine() {
+  switch (kRuntimeISA) {
+    case kArm:
+    case kThumb2:
+      return EM_ARM;
+    case kArm64:
+      return EM_AARCH64;
+    case kX86:
+      return EM_386;
+    case kX86_64:
+      return EM_X86_64;
+    case kMips:
+    case kMips64:
+      return EM_MIPS;
+    default:
+      return EM_NONE;
+  }
+}
+
+JitLogger::JitLogger() : jit_dump_marker_(nullptr), code_index_(0) {}
+
+JitLogger::~JitLogger() {
+  if (perf_file_ != nullptr) {
+    UNUSED(perf_file_->FlushClose());
+  }
+  if (jit_dump_file_ != nullptr) {
+    CloseJitDumpLog();
+  }
+}
+
+bool JitLogger::OpenPerfMapLog() {
+  std::string filename = StringPrintf("%s/perf-%d.map", kLogPrefix, static_cast<int>(getpid()));
+  perf_file_.reset(OS::CreateEmptyFileWriteOnly(filename.c_str()));
+  if (perf_file_ == nullptr) {
+    LOG(ERROR) << "Could not create perf file at " << filename
+               << " Are you on a user build? Perf only works on userdebug/eng builds";
+    return false;
+  }
+  return true;
+}
+
+bool JitLogger::OpenJitDumpLog() {
+  std::string filename = StringPrintf("%s/jit-%d.dump", kLogPrefix, static_cast<int>(getpid()));
+  jit_dump_file_.reset(OS::CreateEmptyFile(filename.c_str()));
+  if (jit_dump_file_ == nullptr) {
+    LOG(ERROR) << "Could not create jit dump file at " << filename
+               << " Are you on a user build? Perf only works on userdebug/eng builds";
+    return false;
+  }
+  // perf record sees this mapping and perf inject then reads the file it maps.
+  jit_dump_marker_ = mmap(nullptr,
+                          kPageSize,
+                          PROT_READ | PROT_EXEC,
+                          MAP_PRIVATE,
+                          jit_dump_file_->Fd(),
+                          0);
+  if (jit_dump_marker_ == MAP_FAILED) {
+    PLOG(ERROR) << "Could not map the jit dump file " << filename;
+    jit_dump_marker_ = nullptr;
+    jit_dump_file_->Erase();
+    jit_dump_file_.reset();
+    return false;
+  }
+  WriteJitDumpHeader();
+  return true;
+}
+
+void JitLogger::WriteJitDumpHeader() {
+  JitDumpHeader header;
+  header.magic = kJitDumpMagic;
+  header.version = kJitDumpVersion;
+  header.total_size = sizeof(header);
+  header.elf_mach = GetElfMachine();
+  header.pad1 = 0;
+  header.pid = static_cast<uint32_t>(getpid());
+  header.timestamp = NanoTime();
+  header.flags = 0;
+  bool res = jit_dump_file_->WriteFully(&header, sizeof(header));
+  CHECK(res);
+}
+
+void JitLogger::WriteJitDumpRecord(const void* code, size_t code_size, const std::string& name) {
+  JitDumpCodeLoad record;
+  record.prefix.id = kJitDumpCodeLoad;
+  record.prefix.total_size = sizeof(record) + name.size() + 1 + code_size;
+  // The same clock as perf record -k mono.
+  record.prefix.timestamp = NanoTime();
+  record.pid = static_cast<uint32_t>(getpid());
+  record.tid = static_cast<uint32_t>(GetTid());
+  record.vma = reinterpret_cast<uintptr_t>(code);
+  record.code_addr = reinterpret_cast<uintptr_t>(code);
+  record.code_size = code_size;
+  record.code_index = code_index_++;
+  bool res = jit_dump_file_->WriteFully(&record, sizeof(record)) &&
+      jit_dump_file_->WriteFully(name.c_str(), name.size() + 1) &&
+      jit_dump_file_->WriteFully(code, code_size);
+  CHECK(res);
+}
+
+void JitLogger::CloseJitDumpLog() {
+  JitDumpRecordPrefix record;
+  record.id = kJitDumpCodeClose;
+  record.total_size = sizeof(record);
+  record.timestamp = NanoTime();
+  UNUSED(jit_dump_file_->WriteFully(&record, sizeof(record)));
+  if (jit_dump_marker_ != nullptr) {
+    munmap(jit_dump_marker_, kPageSize);
+    jit_dump_marker_ = nullptr;
+  }
+  UNUSED(jit_dump_file_->FlushClose());
+  jit_dump_file_.reset();
+}
+
+void JitLogger::WriteLog(const void* code, size_t code_size, ArtMethod* method) {
+  std::string name = PrettyMethod(method);
+  if (perf_file_ != nullptr) {
+    std::string entry = StringPrintf("%" PRIxPTR " %zx %s\n",
+                                     reinterpret_cast<uintptr_t>(code),
+                                     code_size,
+                                     name.c_str());
+    bool res = perf_file_->WriteFully(entry.c_str(), entry.size());
+    CHECK(res);
+  }
+  if (jit_dump_file_ != nullptr) {
+    WriteJitDumpRecord(code, code_size, name);
+  }
+}
+
+}  // namespace jit
+}  // namespace art
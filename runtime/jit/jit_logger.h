@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_JIT_JIT_LOGGER_H_
+#define ART_RUNTIME_JIT_JIT_LOGGER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "os.h"
+
+namespace art {
+
+class ArtMethod;
+
+namespace jit {
+
+// Logs the JIT code for the Linux perf tool, as /tmp/perf-<pid>.map entries for perf report,
+// or in the jitdump format of perf inject --jit, jit-<pid>.dump. Unlike the perf map, the
+// jitdump has the time and a copy of each code, so it stays correct when the code cache reuses
+// memory. The calls are serialized by the code cache lock.
+class JitLogger {
+ public:
+  JitLogger();
+  ~JitLogger();
+
+  // Returns false if the log could not be created.
+  bool OpenPerfMapLog();
+  bool OpenJitDumpLog();
+
+  bool IsEnabled() const {
+    return perf_file_ != nullptr || jit_dump_file_ != nullptr;
+  }
+
+  void WriteLog(const void* code, size_t code_size, ArtMethod* method)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+ private:
+  void WriteJitDumpHeader();
+  void WriteJitDumpRecord(const void* code, size_t code_size, const std::string& name);
+  void CloseJitDumpLog();
+
+  std::unique_ptr<File> perf_file_;
+  std::unique_ptr<File> jit_dump_file_;
+  // perf only finds the jitdump through an executable mapping of the file.
+  void* jit_dump_marker_;
+  uint64_t code_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(JitLogger);
+};
+
+}  // namespace jit
+}  // namespace art
+
+#endif  // ART_RUNTIME_JIT_JIT_LOGGER_H_
@@ -31,16 +31,21 @@
 #include "base/systrace.h"
 #include "base/unix_file/fd_file.h"
 #include "jit/profiling_info.h"
+#include "leb128.h"
 #include "os.h"
 #include "safe_map.h"
 
 namespace art {
 
 const uint8_t ProfileCompilationInfo::kProfileMagic[] = { 'p', 'r', 'o', '\0' };
-const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '0', '1', '\0' };
+const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '0', '3', '\0' };
 
 static constexpr uint16_t kMaxDexFileKeyLength = PATH_MAX;
 
+// AppendToFile refuses to grow a profile past this many lines, so that the next MergeAndSave
+// compacts the lines of the same dex files.
+static constexpr size_t kMaxNumberOfLinesBeforeCompaction = 256u;
+
 // Debug flag to ignore checksums when testing if a method or a class is present in the profile.
 // Used to facilitate testing profile guided compilation across a large number of apps
 // using the same test profile.
@@ -79,6 +84,19 @@ bool ProfileCompilationInfo::AddMethodsAndClasses(
   return true;
 }
 
+bool ProfileCompilationInfo::AddExecutedMethods(const std::vector<MethodReference>& methods,
+                                                bool startup) {
+  for (const MethodReference& method : methods) {
+    if (!AddExecutedMethodIndex(GetProfileDexFileKey(method.dex_file->GetLocation()),
+                                method.dex_file->GetLocationChecksum(),
+                                method.dex_method_index,
+                                startup)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool ProfileCompilationInfo::MergeAndSave(const std::string& filename,
                                           uint64_t* bytes_written,
                                           bool force) {
@@ -170,29 +188,69 @@ static void AddUintToBuffer(std::vector<uint8_t>* buffer, T value) {
 }
 
 static constexpr size_t kLineHeaderSize =
-    3 * sizeof(uint16_t) +  // method_set.size + class_set.size + dex_location.size
-    sizeof(uint32_t);       // checksum
+    5 * sizeof(uint16_t) +  // dex_location.size + method_set.size + class_set.size +
+                            // startup_method_set.size + post_startup_method_set.size
+    2 * sizeof(uint32_t);   // checksum + indices_size
+
+// The largest ULEB128 encoding of an uint16_t index.
+static constexpr size_t kMaxIndexEncodingSize = 3u;
+
+// Append the sorted indices to the buffer as ULEB128 deltas from the previous index.
+static void AddIndicesToBuffer(std::vector<uint8_t>* buffer, const std::set<uint16_t>& indices) {
+  uint16_t last_index = 0u;
+  for (uint16_t index : indices) {
+    EncodeUnsignedLeb128(buffer, index - last_index);
+    last_index = index;
+  }
+}
 
 /**
  * Serialization format:
  *    magic,version,number_of_lines
- *    dex_location1,number_of_methods1,number_of_classes1,dex_location_checksum1, \
- *        method_id11,method_id12...,class_id1,class_id2...
- *    dex_location2,number_of_methods2,number_of_classes2,dex_location_checksum2, \
- *        method_id21,method_id22...,,class_id1,class_id2...
+ *    dex_location1,number_of_methods1,number_of_classes1,number_of_startup_methods1, \
+ *        number_of_post_startup_methods1,dex_location_checksum1,indices_size1, \
+ *        method_id11,method_id12...,class_id1,class_id2..., \
+ *        startup_method_id11,startup_method_id12...,post_startup_method_id11...
+ *    dex_location2,number_of_methods2,number_of_classes2,number_of_startup_methods2, \
+ *        number_of_post_startup_methods2,dex_location_checksum2,indices_size2, \
+ *        method_id21,method_id22...,class_id1,class_id2..., \
+ *        startup_method_id21,startup_method_id22...,post_startup_method_id21...
  *    .....
+ * The method and class ids of a line are sorted and stored as ULEB128 deltas from the
+ * previous id of the same kind, which usually takes a single byte for hot methods.
+ * indices_size is the number of bytes they take.
  **/
 bool ProfileCompilationInfo::Save(int fd) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   DCHECK_GE(fd, 0);
 
+  std::vector<uint8_t> header;
+  AddUintToBuffer(&header, GetNumberOfLines());
+  return WriteBuffer(fd, kProfileMagic, sizeof(kProfileMagic)) &&
+      WriteBuffer(fd, kProfileVersion, sizeof(kProfileVersion)) &&
+      WriteBuffer(fd, header.data(), header.size()) &&
+      SaveLines(fd);
+}
+
+uint16_t ProfileCompilationInfo::GetNumberOfLines() const {
+  size_t number_of_lines = 0u;
+  for (const auto& it : info_) {
+    // Save skips the empty lines.
+    if (!it.second.IsEmpty()) {
+      ++number_of_lines;
+    }
+  }
+  DCHECK_LE(number_of_lines, std::numeric_limits<uint16_t>::max());
+  return static_cast<uint16_t>(number_of_lines);
+}
+
+bool ProfileCompilationInfo::SaveLines(int fd) const {
   // Cache at most 5KB before writing.
   static constexpr size_t kMaxSizeToKeepBeforeWriting = 5 * KB;
   // Use a vector wrapper to avoid keeping track of offsets when we add elements.
   std::vector<uint8_t> buffer;
-  WriteBuffer(fd, kProfileMagic, sizeof(kProfileMagic));
-  WriteBuffer(fd, kProfileVersion, sizeof(kProfileVersion));
-  AddUintToBuffer(&buffer, static_cast<uint16_t>(info_.size()));
+  // The encoded indices of the current line.
+  std::vector<uint8_t> indices;
 
   for (const auto& it : info_) {
     if (buffer.size() > kMaxSizeToKeepBeforeWriting) {
@@ -203,7 +261,7 @@ bool ProfileCompilationInfo::Save(int fd) {
     }
     const std::string& dex_location = it.first;
     const DexFileData& dex_data = it.second;
-    if (dex_data.method_set.empty() && dex_data.class_set.empty()) {
+    if (dex_data.IsEmpty()) {
       continue;
     }
 
@@ -212,31 +270,37 @@ bool ProfileCompilationInfo::Save(int fd) {
       return false;
     }
 
+    indices.clear();
+    AddIndicesToBuffer(&indices, dex_data.method_set);
+    AddIndicesToBuffer(&indices, dex_data.class_set);
+    AddIndicesToBuffer(&indices, dex_data.startup_method_set);
+    AddIndicesToBuffer(&indices, dex_data.post_startup_method_set);
+
     // Make sure that the buffer has enough capacity to avoid repeated resizings
     // while we add data.
     size_t required_capacity = buffer.size() +
         kLineHeaderSize +
         dex_location.size() +
-        sizeof(uint16_t) * (dex_data.class_set.size() + dex_data.method_set.size());
+        indices.size();
 
     buffer.reserve(required_capacity);
 
     DCHECK_LE(dex_location.size(), std::numeric_limits<uint16_t>::max());
     DCHECK_LE(dex_data.method_set.size(), std::numeric_limits<uint16_t>::max());
     DCHECK_LE(dex_data.class_set.size(), std::numeric_limits<uint16_t>::max());
+    DCHECK_LE(dex_data.startup_method_set.size(), std::numeric_limits<uint16_t>::max());
+    DCHECK_LE(dex_data.post_startup_method_set.size(), std::numeric_limits<uint16_t>::max());
     AddUintToBuffer(&buffer, static_cast<uint16_t>(dex_location.size()));
     AddUintToBuffer(&buffer, static_cast<uint16_t>(dex_data.method_set.size()));
     AddUintToBuffer(&buffer, static_cast<uint16_t>(dex_data.class_set.size()));
+    AddUintToBuffer(&buffer, static_cast<uint16_t>(dex_data.startup_method_set.size()));
+    AddUintToBuffer(&buffer, static_cast<uint16_t>(dex_data.post_startup_method_set.size()));
     AddUintToBuffer(&buffer, dex_data.checksum);  // uint32_t
+    AddUintToBuffer(&buffer, static_cast<uint32_t>(indices.size()));
 
     AddStringToBuffer(&buffer, dex_location);
 
-    for (auto method_it : dex_data.method_set) {
-      AddUintToBuffer(&buffer, method_it);
-    }
-    for (auto class_id : dex_data.class_set) {
-      AddUintToBuffer(&buffer, class_id);
-    }
+    buffer.insert(buffer.end(), indices.begin(), indices.end());
     DCHECK_EQ(required_capacity, buffer.size())
         << "Failed to add the expected number of bytes in the buffer";
   }
@@ -244,6 +308,65 @@ bool ProfileCompilationInfo::Save(int fd) {
   return WriteBuffer(fd, buffer.data(), buffer.size());
 }
 
+bool ProfileCompilationInfo::AppendToFile(const std::string& filename, uint64_t* bytes_written) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  uint16_t number_of_new_lines = GetNumberOfLines();
+  if (number_of_new_lines == 0u) {
+    *bytes_written = 0;
+    return true;
+  }
+  ScopedFlock flock;
+  std::string error;
+  if (!flock.Init(filename.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC, /* block */ false, &error)) {
+    LOG(WARNING) << "Couldn't lock the profile file " << filename << ": " << error;
+    return false;
+  }
+  int fd = flock.GetFile()->Fd();
+
+  // Only append to a valid header, the content of the lines is checked at the next merge.
+  uint8_t header[sizeof(kProfileMagic) + sizeof(kProfileVersion) + sizeof(uint16_t)];
+  static constexpr off_t kNumberOfLinesOffset = sizeof(kProfileMagic) + sizeof(kProfileVersion);
+  if (TEMP_FAILURE_RETRY(pread(fd, header, sizeof(header), 0)) !=
+          static_cast<ssize_t>(sizeof(header)) ||
+      memcmp(header, kProfileMagic, sizeof(kProfileMagic)) != 0 ||
+      memcmp(header + sizeof(kProfileMagic), kProfileVersion, sizeof(kProfileVersion)) != 0) {
+    VLOG(profiler) << "Cannot append to the profile " << filename;
+    return false;
+  }
+  size_t number_of_lines = header[kNumberOfLinesOffset] |
+      (static_cast<size_t>(header[kNumberOfLinesOffset + 1]) << kBitsPerByte);
+  if (number_of_lines + number_of_new_lines > kMaxNumberOfLinesBeforeCompaction) {
+    VLOG(profiler) << "Too many lines to append to the profile " << filename;
+    return false;
+  }
+
+  int64_t old_length = flock.GetFile()->GetLength();
+  if (old_length < 0 || TEMP_FAILURE_RETRY(lseek(fd, 0, SEEK_END)) == static_cast<off_t>(-1)) {
+    PLOG(WARNING) << "Failed to seek to the end of the profile " << filename;
+    return false;
+  }
+  // Write the lines first and update the number of lines last, dropping the new lines if
+  // either fails so that the file stays valid.
+  std::vector<uint8_t> new_number_of_lines;
+  AddUintToBuffer(&new_number_of_lines,
+                  static_cast<uint16_t>(number_of_lines + number_of_new_lines));
+  if (!SaveLines(fd) ||
+      TEMP_FAILURE_RETRY(pwrite(fd,
+                                new_number_of_lines.data(),
+                                new_number_of_lines.size(),
+                                kNumberOfLinesOffset)) !=
+          static_cast<ssize_t>(new_number_of_lines.size())) {
+    PLOG(WARNING) << "Failed to append to the profile " << filename;
+    if (flock.GetFile()->SetLength(old_length) != 0) {
+      PLOG(WARNING) << "Failed to truncate the profile " << filename;
+    }
+    return false;
+  }
+  *bytes_written = flock.GetFile()->GetLength() - old_length;
+  VLOG(profiler) << "Appended " << *bytes_written << " bytes to the profile " << filename;
+  return true;
+}
+
 ProfileCompilationInfo::DexFileData* ProfileCompilationInfo::GetOrAddDexFileData(
     const std::string& dex_location,
     uint32_t checksum) {
@@ -291,27 +414,61 @@ bool ProfileCompilationInfo::AddClassIndex(const std::string& dex_location,
   return true;
 }
 
-bool ProfileCompilationInfo::ProcessLine(SafeBuffer& line_buffer,
-                                         uint16_t method_set_size,
-                                         uint16_t class_set_size,
-                                         uint32_t checksum,
-                                         const std::string& dex_location) {
-  for (uint16_t i = 0; i < method_set_size; i++) {
-    uint16_t method_idx = line_buffer.ReadUintAndAdvance<uint16_t>();
-    if (!AddMethodIndex(dex_location, checksum, method_idx)) {
-      return false;
-    }
+bool ProfileCompilationInfo::AddExecutedMethodIndex(const std::string& dex_location,
+                                                    uint32_t checksum,
+                                                    uint16_t method_idx,
+                                                    bool startup) {
+  DexFileData* const data = GetOrAddDexFileData(dex_location, checksum);
+  if (data == nullptr) {
+    return false;
   }
+  (startup ? data->startup_method_set : data->post_startup_method_set).insert(method_idx);
+  return true;
+}
 
-  for (uint16_t i = 0; i < class_set_size; i++) {
-    uint16_t class_def_idx = line_buffer.ReadUintAndAdvance<uint16_t>();
-    if (!AddClassIndex(dex_location, checksum, class_def_idx)) {
+// Reads `count` indices written by AddIndicesToBuffer and inserts them into `indices`.
+static bool ReadIndices(const uint8_t** data,
+                        const uint8_t* end,
+                        uint16_t count,
+                        std::set<uint16_t>* indices) {
+  uint32_t index = 0u;
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t delta;
+    if (!DecodeUnsignedLeb128Checked(data, end, &delta)) {
       return false;
     }
+    index += delta;
+    if (index > std::numeric_limits<uint16_t>::max()) {
+      return false;
+    }
+    // The indices are sorted, so insert them with a hint at the end.
+    indices->insert(indices->end(), static_cast<uint16_t>(index));
   }
   return true;
 }
 
+bool ProfileCompilationInfo::ProcessLine(SafeBuffer& line_buffer,
+                                         const ProfileLineHeader& line_header) {
+  // Look up the dex file data once for the whole line.
+  DexFileData* const data = GetOrAddDexFileData(line_header.dex_location, line_header.checksum);
+  if (data == nullptr) {
+    return false;
+  }
+  const uint8_t* current = line_buffer.GetCurrent();
+  const uint8_t* end = line_buffer.GetEnd();
+  return ReadIndices(&current, end, line_header.method_set_size, &data->method_set) &&
+      ReadIndices(&current, end, line_header.class_set_size, &data->class_set) &&
+      ReadIndices(&current,
+                  end,
+                  line_header.startup_method_set_size,
+                  &data->startup_method_set) &&
+      ReadIndices(&current,
+                  end,
+                  line_header.post_startup_method_set_size,
+                  &data->post_startup_method_set) &&
+      current == end;
+}
+
 // Tests for EOF by trying to read 1 byte from the descriptor.
 // Returns:
 //   0 if the descriptor is at the EOF,
@@ -409,13 +566,24 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
   uint16_t dex_location_size = header_buffer.ReadUintAndAdvance<uint16_t>();
   line_header->method_set_size = header_buffer.ReadUintAndAdvance<uint16_t>();
   line_header->class_set_size = header_buffer.ReadUintAndAdvance<uint16_t>();
+  line_header->startup_method_set_size = header_buffer.ReadUintAndAdvance<uint16_t>();
+  line_header->post_startup_method_set_size = header_buffer.ReadUintAndAdvance<uint16_t>();
   line_header->checksum = header_buffer.ReadUintAndAdvance<uint32_t>();
+  line_header->indices_size = header_buffer.ReadUintAndAdvance<uint32_t>();
 
   if (dex_location_size == 0 || dex_location_size > kMaxDexFileKeyLength) {
     *error = "DexFileKey has an invalid size: " +
         std::to_string(static_cast<uint32_t>(dex_location_size));
     return kProfileLoadBadData;
   }
+  size_t max_indices_size = (static_cast<size_t>(line_header->method_set_size) +
+                              line_header->class_set_size +
+                              line_header->startup_method_set_size +
+                              line_header->post_startup_method_set_size) * kMaxIndexEncodingSize;
+  if (line_header->indices_size > max_indices_size) {
+    *error = "Profile line has an invalid size: " + std::to_string(line_header->indices_size);
+    return kProfileLoadBadData;
+  }
 
   SafeBuffer location_buffer(dex_location_size);
   status = location_buffer.FillFromFd(fd, "ReadProfileHeaderDexLocation", error);
@@ -431,34 +599,16 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
       int fd,
       const ProfileLineHeader& line_header,
       /*out*/std::string* error) {
-  // Make sure that we don't try to read everything in memory (in case the profile if full).
-  // Split readings in chunks of at most 10kb.
-  static constexpr uint16_t kMaxNumberOfEntriesToRead = 5120;
-  uint16_t methods_left_to_read = line_header.method_set_size;
-  uint16_t classes_left_to_read = line_header.class_set_size;
-
-  while ((methods_left_to_read > 0) || (classes_left_to_read > 0)) {
-    uint16_t methods_to_read = std::min(kMaxNumberOfEntriesToRead, methods_left_to_read);
-    uint16_t max_classes_to_read = kMaxNumberOfEntriesToRead - methods_to_read;
-    uint16_t classes_to_read = std::min(max_classes_to_read, classes_left_to_read);
-
-    size_t line_size = sizeof(uint16_t) * (methods_to_read + classes_to_read);
-    SafeBuffer line_buffer(line_size);
-
-    ProfileLoadSatus status = line_buffer.FillFromFd(fd, "ReadProfileLine", error);
-    if (status != kProfileLoadSuccess) {
-      return status;
-    }
-    if (!ProcessLine(line_buffer,
-                     methods_to_read,
-                     classes_to_read,
-                     line_header.checksum,
-                     line_header.dex_location)) {
-      *error = "Error when reading profile file line";
-      return kProfileLoadBadData;
-    }
-    methods_left_to_read -= methods_to_read;
-    classes_left_to_read -= classes_to_read;
+  // The size was checked against the number of entries in ReadProfileLineHeader, so a full
+  // line is read at once. It takes at most 3 bytes per entry, and usually 1.
+  SafeBuffer line_buffer(line_header.indices_size);
+  ProfileLoadSatus status = line_buffer.FillFromFd(fd, "ReadProfileLine", error);
+  if (status != kProfileLoadSuccess) {
+    return status;
+  }
+  if (!ProcessLine(line_buffer, line_header)) {
+    *error = "Error when reading profile file line";
+    return kProfileLoadBadData;
   }
   return kProfileLoadSuccess;
 }
@@ -549,6 +699,11 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other) {
                                       other_dex_data.method_set.end());
     info_it->second.class_set.insert(other_dex_data.class_set.begin(),
                                      other_dex_data.class_set.end());
+    info_it->second.startup_method_set.insert(other_dex_data.startup_method_set.begin(),
+                                              other_dex_data.startup_method_set.end());
+    info_it->second.post_startup_method_set.insert(
+        other_dex_data.post_startup_method_set.begin(),
+        other_dex_data.post_startup_method_set.end());
   }
   return true;
 }
@@ -569,6 +724,20 @@ bool ProfileCompilationInfo::ContainsMethod(const MethodReference& method_ref) c
   return false;
 }
 
+bool ProfileCompilationInfo::ContainsExecutedMethod(const MethodReference& method_ref,
+                                                    bool startup) const {
+  auto info_it = info_.find(GetProfileDexFileKey(method_ref.dex_file->GetLocation()));
+  if (info_it != info_.end()) {
+    if (!ChecksumMatch(*method_ref.dex_file, info_it->second.checksum)) {
+      return false;
+    }
+    const std::set<uint16_t>& methods =
+        startup ? info_it->second.startup_method_set : info_it->second.post_startup_method_set;
+    return methods.find(method_ref.dex_method_index) != methods.end();
+  }
+  return false;
+}
+
 bool ProfileCompilationInfo::ContainsClass(const DexFile& dex_file, uint16_t class_def_idx) const {
   auto info_it = info_.find(GetProfileDexFileKey(dex_file.GetLocation()));
   if (info_it != info_.end()) {
@@ -597,6 +766,29 @@ uint32_t ProfileCompilationInfo::GetNumberOfResolvedClasses() const {
   return total;
 }
 
+uint32_t ProfileCompilationInfo::GetNumberOfExecutedMethods(bool startup) const {
+  uint32_t total = 0;
+  for (const auto& it : info_) {
+    total += startup ? it.second.startup_method_set.size()
+                     : it.second.post_startup_method_set.size();
+  }
+  return total;
+}
+
+static void DumpMethods(std::ostringstream& os,
+                        const char* title,
+                        const std::set<uint16_t>& method_set,
+                        const DexFile* dex_file) {
+  os << "\n\t" << title << ": ";
+  for (const auto method_it : method_set) {
+    if (dex_file != nullptr) {
+      os << "\n\t\t" << PrettyMethod(method_it, *dex_file, true);
+    } else {
+      os << method_it << ",";
+    }
+  }
+}
+
 std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>* dex_files,
                                              bool print_full_dex_location) const {
   std::ostringstream os;
@@ -626,14 +818,7 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>*
         }
       }
     }
-    os << "\n\tmethods: ";
-    for (const auto method_it : dex_data.method_set) {
-      if (dex_file != nullptr) {
-        os << "\n\t\t" << PrettyMethod(method_it, *dex_file, true);
-      } else {
-        os << method_it << ",";
-      }
-    }
+    DumpMethods(os, "methods", dex_data.method_set, dex_file);
     os << "\n\tclasses: ";
     for (const auto class_it : dex_data.class_set) {
       if (dex_file != nullptr) {
@@ -642,6 +827,8 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>*
         os << class_it << ",";
       }
     }
+    DumpMethods(os, "startup methods", dex_data.startup_method_set, dex_file);
+    DumpMethods(os, "post-startup methods", dex_data.post_startup_method_set, dex_file);
   }
   return os.str();
 }
@@ -34,7 +34,8 @@ namespace art {
  * performing profile guided compilation.
  * It is a serialize-friendly format based on information collected by the
  * interpreter (ProfileInfo).
- * Currently it stores only the hot compiled methods.
+ * It stores the hot methods and the resolved classes, and which methods were executed during
+ * startup or only after it, whether they got hot or not.
  */
 class ProfileCompilationInfo {
  public:
@@ -44,6 +45,17 @@ class ProfileCompilationInfo {
   // Add the given methods and classes to the current profile object.
   bool AddMethodsAndClasses(const std::vector<MethodReference>& methods,
                             const std::set<DexCacheResolvedClasses>& resolved_classes);
+  // Add a method or a class index of the given dex file. Returns false if the profile already
+  // has the dex file with a different checksum.
+  bool AddMethodIndex(const std::string& dex_location, uint32_t checksum, uint16_t method_idx);
+  bool AddClassIndex(const std::string& dex_location, uint32_t checksum, uint16_t class_idx);
+  // Add the methods that were executed during startup, or after startup if `startup` is false.
+  // A method does not need to be hot to be recorded as executed.
+  bool AddExecutedMethods(const std::vector<MethodReference>& methods, bool startup);
+  bool AddExecutedMethodIndex(const std::string& dex_location,
+                              uint32_t checksum,
+                              uint16_t method_idx,
+                              bool startup);
   // Loads profile information from the given file descriptor.
   bool Load(int fd);
   // Merge the data from another ProfileCompilationInfo into the current object.
@@ -56,15 +68,26 @@ class ProfileCompilationInfo {
   // has bad data or its version does not match. In this cases the profile content
   // is ignored.
   bool MergeAndSave(const std::string& filename, uint64_t* bytes_written, bool force);
+  // Appends the profile information of the current object to the given file, without reading
+  // the lines that are already there. The file may then list a dex file more than once, which
+  // Load and MergeAndSave handle. Returns false if the file is not a valid profile, cannot be
+  // written or has too many lines, the caller should then use MergeAndSave to rewrite it.
+  bool AppendToFile(const std::string& filename, uint64_t* bytes_written);
 
   // Returns the number of methods that were profiled.
   uint32_t GetNumberOfMethods() const;
   // Returns the number of resolved classes that were profiled.
   uint32_t GetNumberOfResolvedClasses() const;
+  // Returns the number of methods that were executed during startup, or after it.
+  uint32_t GetNumberOfExecutedMethods(bool startup) const;
 
   // Returns true if the method reference is present in the profiling info.
   bool ContainsMethod(const MethodReference& method_ref) const;
 
+  // Returns true if the method was executed during startup, or after startup if `startup` is
+  // false. A method executed in both phases is recorded in both.
+  bool ContainsExecutedMethod(const MethodReference& method_ref, bool startup) const;
+
   // Returns true if the class is present in the profiling info.
   bool ContainsClass(const DexFile& dex_file, uint16_t class_def_idx) const;
 
@@ -87,6 +110,20 @@ class ProfileCompilationInfo {
   // Clears the resolved classes from the current object.
   void ClearResolvedClasses();
 
+  // Calls visitor(profile_key, checksum, method_set, class_set, startup_method_set,
+  // post_startup_method_set) for each dex file of the profile.
+  template <typename Visitor>
+  void VisitDexFiles(const Visitor& visitor) const {
+    for (const auto& it : info_) {
+      visitor(it.first,
+              it.second.checksum,
+              it.second.method_set,
+              it.second.class_set,
+              it.second.startup_method_set,
+              it.second.post_startup_method_set);
+    }
+  }
+
   static bool GenerateTestProfile(int fd,
                                   uint16_t number_of_dex_files,
                                   uint16_t method_ratio,
@@ -105,17 +142,33 @@ class ProfileCompilationInfo {
     uint32_t checksum;
     std::set<uint16_t> method_set;
     std::set<uint16_t> class_set;
+    // The methods executed during startup and after it, hot or not.
+    std::set<uint16_t> startup_method_set;
+    std::set<uint16_t> post_startup_method_set;
+
+    bool IsEmpty() const {
+      return method_set.empty() &&
+          class_set.empty() &&
+          startup_method_set.empty() &&
+          post_startup_method_set.empty();
+    }
 
     bool operator==(const DexFileData& other) const {
-      return checksum == other.checksum && method_set == other.method_set;
+      return checksum == other.checksum &&
+          method_set == other.method_set &&
+          startup_method_set == other.startup_method_set &&
+          post_startup_method_set == other.post_startup_method_set;
     }
   };
 
   using DexFileToProfileInfoMap = SafeMap<const std::string, DexFileData>;
 
+  // Returns the number of lines that Save writes.
+  uint16_t GetNumberOfLines() const;
+  // Writes the lines of the profile, without the file header, at the current position of fd.
+  bool SaveLines(int fd) const;
+
   DexFileData* GetOrAddDexFileData(const std::string& dex_location, uint32_t checksum);
-  bool AddMethodIndex(const std::string& dex_location, uint32_t checksum, uint16_t method_idx);
-  bool AddClassIndex(const std::string& dex_location, uint32_t checksum, uint16_t class_idx);
   bool AddResolvedClasses(const DexCacheResolvedClasses& classes);
 
   // Parsing functionality.
@@ -124,7 +177,10 @@ class ProfileCompilationInfo {
     std::string dex_location;
     uint16_t method_set_size;
     uint16_t class_set_size;
+    uint16_t startup_method_set_size;
+    uint16_t post_startup_method_set_size;
     uint32_t checksum;
+    uint32_t indices_size;
   };
 
   // A helper structure to make sure we don't read past our buffers in the loops.
@@ -151,6 +207,10 @@ class ProfileCompilationInfo {
     // Get the underlying raw buffer.
     uint8_t* Get() { return storage_.get(); }
 
+    // Get the current position and the end of the buffer.
+    const uint8_t* GetCurrent() const { return ptr_current_; }
+    const uint8_t* GetEnd() const { return ptr_end_; }
+
    private:
     std::unique_ptr<uint8_t> storage_;
     uint8_t* ptr_current_;
@@ -170,11 +230,7 @@ class ProfileCompilationInfo {
                                    const ProfileLineHeader& line_header,
                                    /*out*/std::string* error);
 
-  bool ProcessLine(SafeBuffer& line_buffer,
-                   uint16_t method_set_size,
-                   uint16_t class_set_size,
-                   uint32_t checksum,
-                   const std::string& dex_location);
+  bool ProcessLine(SafeBuffer& line_buffer, const ProfileLineHeader& line_header);
 
   friend class ProfileCompilationInfoTest;
   friend class CompilerDriverProfileTest;
@@ -172,6 +172,38 @@ TEST_F(ProfileCompilationInfoTest, SaveFd) {
   ASSERT_TRUE(loaded_info2.Equals(saved_info));
 }
 
+TEST_F(ProfileCompilationInfoTest, AppendToFile) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ i, &saved_info));
+  }
+  uint64_t bytes_written;
+  // There is no valid profile to append to yet.
+  ASSERT_FALSE(saved_info.AppendToFile(profile.GetFilename(), &bytes_written));
+  ASSERT_TRUE(saved_info.MergeAndSave(profile.GetFilename(), &bytes_written, /* force */ false));
+
+  // Append new methods to an existing dex file and a new one.
+  ProfileCompilationInfo delta_info;
+  for (uint16_t i = 10; i < 20; i++) {
+    ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ i, &delta_info));
+    ASSERT_TRUE(AddMethod("dex_location2", /* checksum */ 2, /* method_idx */ i, &delta_info));
+  }
+  ASSERT_TRUE(delta_info.AppendToFile(profile.GetFilename(), &bytes_written));
+  EXPECT_NE(0u, bytes_written);
+  ASSERT_TRUE(saved_info.MergeWith(delta_info));
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+
+  // The file already has everything, even if it lists dex_location1 twice.
+  ASSERT_TRUE(saved_info.MergeAndSave(profile.GetFilename(), &bytes_written, /* force */ false));
+  EXPECT_EQ(0u, bytes_written);
+}
+
 TEST_F(ProfileCompilationInfoTest, AddMethodsAndClassesFail) {
   ScratchFile profile;
 
@@ -292,9 +324,10 @@ TEST_F(ProfileCompilationInfoTest, TooLongDexLocation) {
   uint8_t line_number[] = { 0, 1 };
   ASSERT_TRUE(profile.GetFile()->WriteFully(line_number, sizeof(line_number)));
 
-  // dex_location_size, methods_size, classes_size, checksum.
+  // dex_location_size, methods_size, classes_size, startup_methods_size,
+  // post_startup_methods_size, checksum, indices_size.
   // Dex location size is too big and should be rejected.
-  uint8_t line[] = { 255, 255, 0, 1, 0, 1, 0, 0, 0, 0 };
+  uint8_t line[] = { 255, 255, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0 };
   ASSERT_TRUE(profile.GetFile()->WriteFully(line, sizeof(line)));
   ASSERT_EQ(0, profile.GetFile()->Flush());
 
@@ -303,6 +336,61 @@ TEST_F(ProfileCompilationInfoTest, TooLongDexLocation) {
   ASSERT_FALSE(loaded_info.Load(GetFd(profile)));
 }
 
+TEST_F(ProfileCompilationInfoTest, DeltaEncodedIndices) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  // Consecutive indices take one byte each, the last one takes three.
+  for (uint16_t i = 0; i < 100; i++) {
+    ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ i, &saved_info));
+  }
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 65535, &saved_info));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+  EXPECT_EQ(kProfileMagicSize + kProfileVersionSize + sizeof(uint16_t) +  // File header.
+                5u * sizeof(uint16_t) + 2u * sizeof(uint32_t) +  // Line header.
+                strlen("dex_location1") + 100u + 3u,
+            static_cast<size_t>(profile.GetFile()->GetLength()));
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+}
+
+TEST_F(ProfileCompilationInfoTest, ExecutedMethods) {
+  ScratchFile profile;
+
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 1, &saved_info));
+  // Executed methods need not be hot, and a line may only have executed methods.
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(saved_info.AddExecutedMethodIndex("dex_location1", 1, i, /* startup */ true));
+    ASSERT_TRUE(saved_info.AddExecutedMethodIndex("dex_location2", 2, i, /* startup */ false));
+  }
+  ASSERT_TRUE(saved_info.AddExecutedMethodIndex("dex_location1", 1, 20, /* startup */ false));
+  ASSERT_FALSE(saved_info.AddExecutedMethodIndex("dex_location2", 3, 0, /* startup */ true));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+  EXPECT_EQ(1u, loaded_info.GetNumberOfMethods());
+  EXPECT_EQ(10u, loaded_info.GetNumberOfExecutedMethods(/* startup */ true));
+  EXPECT_EQ(11u, loaded_info.GetNumberOfExecutedMethods(/* startup */ false));
+
+  // Merging keeps the startup and post-startup methods apart.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(other_info.AddExecutedMethodIndex("dex_location2", 2, 0, /* startup */ true));
+  ASSERT_TRUE(other_info.AddExecutedMethodIndex("dex_location2", 2, 30, /* startup */ false));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  EXPECT_EQ(11u, loaded_info.GetNumberOfExecutedMethods(/* startup */ true));
+  EXPECT_EQ(12u, loaded_info.GetNumberOfExecutedMethods(/* startup */ false));
+  ASSERT_FALSE(loaded_info.Equals(saved_info));
+}
+
 TEST_F(ProfileCompilationInfoTest, UnexpectedContent) {
   ScratchFile profile;
 
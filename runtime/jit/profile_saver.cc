@@ -51,6 +51,7 @@ ProfileSaver::ProfileSaver(const ProfileSaverOptions& options,
       period_condition_("ProfileSaver period condition", wait_lock_),
       total_bytes_written_(0),
       total_number_of_writes_(0),
+      total_number_of_incremental_writes_(0),
       total_number_of_code_cache_queries_(0),
       total_number_of_skipped_writes_(0),
       total_number_of_failed_writes_(0),
@@ -82,7 +83,8 @@ void ProfileSaver::Run() {
   Thread* self = Thread::Current();
 
   // Fetch the resolved classes for the app images after sleeping for
-  // options_.GetSaveResolvedClassesDelayMs().
+  // options_.GetSaveResolvedClassesDelayMs(). The methods executed by then are the startup
+  // methods of the profile.
   // TODO(calin) This only considers the case of the primary profile file.
   // Anything that gets loaded in the same VM will not have their resolved
   // classes save (unless they started before the initial saving was done).
@@ -195,12 +197,16 @@ ProfileCompilationInfo* ProfileSaver::GetCachedProfiledInfo(const std::string& f
   return &info_it->second;
 }
 
-// Get resolved methods that have a profile info or more than kStartupMethodSamples samples.
+// Get resolved methods that have a profile info or more than kStartupMethodSamples samples,
+// and the ones that have any sample in `executed_methods`.
 // Excludes native methods and classes in the boot image.
 class GetMethodsVisitor : public ClassVisitor {
  public:
-  GetMethodsVisitor(std::vector<MethodReference>* methods, uint32_t startup_method_samples)
+  GetMethodsVisitor(std::vector<MethodReference>* methods,
+                    std::vector<MethodReference>* executed_methods,
+                    uint32_t startup_method_samples)
     : methods_(methods),
+      executed_methods_(executed_methods),
       startup_method_samples_(startup_method_samples) {}
 
   virtual bool operator()(mirror::Class* klass) SHARED_REQUIRES(Locks::mutator_lock_) {
@@ -209,12 +215,17 @@ class GetMethodsVisitor : public ClassVisitor {
     }
     for (ArtMethod& method : klass->GetMethods(kRuntimePointerSize)) {
       if (!method.IsNative()) {
-        if (method.GetCounter() >= startup_method_samples_ ||
-            method.GetProfilingInfo(kRuntimePointerSize) != nullptr) {
+        bool has_profiling_info = method.GetProfilingInfo(kRuntimePointerSize) != nullptr;
+        if (method.GetCounter() == 0u && !has_profiling_info) {
+          continue;
+        }
+        const DexFile* dex_file =
+            method.GetInterfaceMethodIfProxy(kRuntimePointerSize)->GetDexFile();
+        MethodReference ref(dex_file, method.GetDexMethodIndex());
+        executed_methods_->push_back(ref);
+        if (method.GetCounter() >= startup_method_samples_ || has_profiling_info) {
           // Have samples, add to profile.
-          const DexFile* dex_file =
-              method.GetInterfaceMethodIfProxy(kRuntimePointerSize)->GetDexFile();
-          methods_->push_back(MethodReference(dex_file, method.GetDexMethodIndex()));
+          methods_->push_back(ref);
         }
       }
     }
@@ -223,6 +234,7 @@ class GetMethodsVisitor : public ClassVisitor {
 
  private:
   std::vector<MethodReference>* const methods_;
+  std::vector<MethodReference>* const executed_methods_;
   uint32_t startup_method_samples_;
 };
 
@@ -233,13 +245,16 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods() {
       class_linker->GetResolvedClasses(/*ignore boot classes*/ true);
 
   std::vector<MethodReference> methods;
+  // The methods sampled so far, which ran during startup.
+  std::vector<MethodReference> startup_methods;
   {
     ScopedTrace trace2("Get hot methods");
-    GetMethodsVisitor visitor(&methods, options_.GetStartupMethodSamples());
+    GetMethodsVisitor visitor(&methods, &startup_methods, options_.GetStartupMethodSamples());
     ScopedObjectAccess soa(Thread::Current());
     class_linker->VisitClasses(&visitor);
     VLOG(profiler) << "Methods with samples greater than "
-                   << options_.GetStartupMethodSamples() << " = " << methods.size();
+                   << options_.GetStartupMethodSamples() << " = " << methods.size()
+                   << ", executed during startup = " << startup_methods.size();
   }
   MutexLock mu(Thread::Current(), *Locks::profiler_lock_);
   uint64_t total_number_of_profile_entries_cached = 0;
@@ -254,6 +269,12 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods() {
         methods_for_location.push_back(ref);
       }
     }
+    std::vector<MethodReference> startup_methods_for_location;
+    for (const MethodReference& ref : startup_methods) {
+      if (locations.find(ref.dex_file->GetBaseLocation()) != locations.end()) {
+        startup_methods_for_location.push_back(ref);
+      }
+    }
     for (const DexCacheResolvedClasses& classes : resolved_classes) {
       if (locations.find(classes.GetBaseLocation()) != locations.end()) {
         VLOG(profiler) << "Added " << classes.GetClasses().size() << " classes for location "
@@ -266,6 +287,7 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods() {
     }
     ProfileCompilationInfo* info = GetCachedProfiledInfo(filename);
     info->AddMethodsAndClasses(methods_for_location, resolved_classes_for_location);
+    info->AddExecutedMethods(startup_methods_for_location, /* startup */ true);
     total_number_of_profile_entries_cached += resolved_classes_for_location.size();
   }
   max_number_of_profile_entries_cached_ = std::max(
@@ -300,7 +322,30 @@ bool ProfileSaver::ProcessProfilingInfo(uint16_t* new_methods) {
     }
 
     ProfileCompilationInfo* cached_info = GetCachedProfiledInfo(filename);
+    // The profiled methods that did not run during startup were first executed after it. The
+    // code cache only knows about the warm methods, the others are not recorded after startup.
+    std::vector<MethodReference> post_startup_methods;
+    for (const MethodReference& ref : methods) {
+      if (!cached_info->ContainsExecutedMethod(ref, /* startup */ true) &&
+          !cached_info->ContainsExecutedMethod(ref, /* startup */ false)) {
+        post_startup_methods.push_back(ref);
+      }
+    }
+    auto unsaved_it = unsaved_profile_cache_.find(filename);
+    if (unsaved_it != unsaved_profile_cache_.end()) {
+      // Only the methods that are not in the file yet need to be appended at the next save.
+      std::vector<MethodReference> unsaved_methods;
+      for (const MethodReference& ref : methods) {
+        if (!cached_info->ContainsMethod(ref)) {
+          unsaved_methods.push_back(ref);
+        }
+      }
+      unsaved_it->second.AddMethodsAndClasses(unsaved_methods,
+                                              std::set<DexCacheResolvedClasses>());
+      unsaved_it->second.AddExecutedMethods(post_startup_methods, /* startup */ false);
+    }
     cached_info->AddMethodsAndClasses(methods, std::set<DexCacheResolvedClasses>());
+    cached_info->AddExecutedMethods(post_startup_methods, /* startup */ false);
     int64_t delta_number_of_methods =
         cached_info->GetNumberOfMethods() -
         static_cast<int64_t>(last_save_number_of_methods_);
@@ -318,9 +363,22 @@ bool ProfileSaver::ProcessProfilingInfo(uint16_t* new_methods) {
     }
     *new_methods = std::max(static_cast<uint16_t>(delta_number_of_methods), *new_methods);
     uint64_t bytes_written;
-    // Force the save. In case the profile data is corrupted or the the profile
-    // has the wrong version this will "fix" the file to the correct format.
-    if (cached_info->MergeAndSave(filename, &bytes_written, /*force*/ true)) {
+    // After the first save of a file, append what it is missing instead of merging and
+    // rewriting it. The resolved classes are only cached for the first save. If appending
+    // fails, for instance because the file was cleared or has too many lines, rewrite it.
+    bool saved = false;
+    if (unsaved_it != unsaved_profile_cache_.end() &&
+        cached_info->GetNumberOfResolvedClasses() == 0u &&
+        unsaved_it->second.AppendToFile(filename, &bytes_written)) {
+      total_number_of_incremental_writes_++;
+      saved = true;
+    } else {
+      // Force the save. In case the profile data is corrupted or the the profile
+      // has the wrong version this will "fix" the file to the correct format.
+      saved = cached_info->MergeAndSave(filename, &bytes_written, /*force*/ true);
+    }
+    if (saved) {
+      unsaved_profile_cache_.Overwrite(filename, ProfileCompilationInfo());
       last_save_number_of_methods_ = cached_info->GetNumberOfMethods();
       last_save_number_of_classes_ = cached_info->GetNumberOfResolvedClasses();
       // Clear resolved classes. No need to store them around as
@@ -625,6 +683,8 @@ void ProfileSaver::DumpInstanceInfo(std::ostream& os) {
 void ProfileSaver::DumpInfo(std::ostream& os) {
   os << "ProfileSaver total_bytes_written=" << total_bytes_written_ << '\n'
      << "ProfileSaver total_number_of_writes=" << total_number_of_writes_ << '\n'
+     << "ProfileSaver total_number_of_incremental_writes="
+     << total_number_of_incremental_writes_ << '\n'
      << "ProfileSaver total_number_of_code_cache_queries="
      << total_number_of_code_cache_queries_ << '\n'
      << "ProfileSaver total_number_of_skipped_writes=" << total_number_of_skipped_writes_ << '\n'
@@ -140,6 +140,10 @@ class ProfileSaver {
   // to just a few hundreds entries in the ProfileCompilationInfo objects.
   // It helps avoiding unnecessary writes to disk.
   SafeMap<std::string, ProfileCompilationInfo> profile_cache_;
+  // The profile information that was cached after the last save of each file, and that the
+  // next save appends. Files that were not saved yet have no entry, they are merged and
+  // rewritten instead.
+  SafeMap<std::string, ProfileCompilationInfo> unsaved_profile_cache_;
 
   // Save period condition support.
   Mutex wait_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -147,6 +151,7 @@ class ProfileSaver {
 
   uint64_t total_bytes_written_;
   uint64_t total_number_of_writes_;
+  uint64_t total_number_of_incremental_writes_;
   uint64_t total_number_of_code_cache_queries_;
   uint64_t total_number_of_skipped_writes_;
   uint64_t total_number_of_failed_writes_;
@@ -16,6 +16,8 @@
 
 #include "profiling_info.h"
 
+#include <algorithm>
+
 #include "art_method-inl.h"
 #include "dex_instruction.h"
 #include "jit/jit.h"
@@ -35,6 +37,7 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
 
   uint32_t dex_pc = 0;
   std::vector<uint32_t> entries;
+  std::vector<uint32_t> branch_entries;
   while (code_ptr < code_end) {
     const Instruction& instruction = *Instruction::At(code_ptr);
     switch (instruction.Opcode()) {
@@ -47,6 +50,21 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
         entries.push_back(dex_pc);
         break;
 
+      case Instruction::IF_EQ:
+      case Instruction::IF_NE:
+      case Instruction::IF_LT:
+      case Instruction::IF_GE:
+      case Instruction::IF_GT:
+      case Instruction::IF_LE:
+      case Instruction::IF_EQZ:
+      case Instruction::IF_NEZ:
+      case Instruction::IF_LTZ:
+      case Instruction::IF_GEZ:
+      case Instruction::IF_GTZ:
+      case Instruction::IF_LEZ:
+        branch_entries.push_back(dex_pc);
+        break;
+
       default:
         break;
     }
@@ -59,7 +77,8 @@ bool ProfilingInfo::Create(Thread* self, ArtMethod* method, bool retry_allocatio
 
   // Allocate the `ProfilingInfo` object int the JIT's data space.
   jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
-  return code_cache->AddProfilingInfo(self, method, entries, retry_allocation) != nullptr;
+  return code_cache->AddProfilingInfo(
+      self, method, entries, branch_entries, retry_allocation) != nullptr;
 }
 
 InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
@@ -74,13 +93,33 @@ InlineCache* ProfilingInfo::GetInlineCache(uint32_t dex_pc) {
   return cache;
 }
 
+const BranchCache* ProfilingInfo::GetBranchCache(uint32_t dex_pc) const {
+  const BranchCache* begin = GetBranchCaches();
+  const BranchCache* end = begin + number_of_branch_caches_;
+  const BranchCache* it = std::lower_bound(
+      begin, end, dex_pc, [](const BranchCache& cache, uint32_t pc) {
+        return cache.dex_pc_ < pc;
+      });
+  return (it != end && it->dex_pc_ == dex_pc) ? it : nullptr;
+}
+
+void ProfilingInfo::AddBranchInfo(uint32_t dex_pc, bool taken) {
+  BranchCache* cache = const_cast<BranchCache*>(GetBranchCache(dex_pc));
+  CHECK(cache != nullptr) << PrettyMethod(method_) << "@" << dex_pc;
+  uint16_t* count = taken ? &cache->taken_count_ : &cache->not_taken_count_;
+  if (*count != std::numeric_limits<uint16_t>::max()) {
+    ++*count;
+  }
+}
+
 void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
   InlineCache* cache = GetInlineCache(dex_pc);
   CHECK(cache != nullptr) << PrettyMethod(method_) << "@" << dex_pc;
   for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
     mirror::Class* existing = cache->classes_[i].Read();
     if (existing == cls) {
-      // Receiver type is already in the cache, nothing else to do.
+      // Receiver type is already in the cache, just count it.
+      InlineCache::IncrementCount(&cache->counts_[i]);
       return;
     } else if (existing == nullptr) {
       // Cache entry is empty, try to put `cls` in it.
@@ -92,13 +131,15 @@ void ProfilingInfo::AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls) {
         // entry in case the entry contains `cls`.
         --i;
       } else {
-        // We successfully set `cls`, just return.
+        // We successfully set `cls`, count it and return.
+        InlineCache::IncrementCount(&cache->counts_[i]);
         return;
       }
     }
   }
   // Unsuccessfull - cache is full, making it megamorphic. We do not DCHECK it though,
   // as the garbage collector might clear the entries concurrently.
+  InlineCache::IncrementCount(&cache->megamorphic_count_);
 }
 
 }  // namespace art
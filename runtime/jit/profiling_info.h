@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "base/macros.h"
+#include "dex_file.h"
 #include "gc_root.h"
 
 namespace art {
@@ -35,8 +36,9 @@ namespace mirror {
 class Class;
 }
 
-// Structure to store the classes seen at runtime for a specific instruction.
-// Once the classes_ array is full, we consider the INVOKE to be megamorphic.
+// Structure to store the classes seen at runtime for a specific instruction, and how often
+// each of them was seen. Once the classes_ array is full, we consider the INVOKE to be
+// megamorphic, and further receivers of other classes are only counted.
 class InlineCache {
  public:
   bool IsMonomorphic() const {
@@ -73,17 +75,63 @@ class InlineCache {
     return classes_[i].Read();
   }
 
+  // Number of times the receiver was of the class at `i`. The counts are updated without
+  // synchronization and saturate, they are only meant to rank the receivers.
+  uint16_t GetCountAt(size_t i) const {
+    return counts_[i];
+  }
+
+  // Number of times a receiver was not of any of the cached classes.
+  uint16_t GetMegamorphicCount() const {
+    return megamorphic_count_;
+  }
+
   static constexpr uint16_t kIndividualCacheSize = 5;
 
  private:
+  static void IncrementCount(uint16_t* count) {
+    if (*count != std::numeric_limits<uint16_t>::max()) {
+      ++*count;
+    }
+  }
+
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
+  uint16_t counts_[kIndividualCacheSize];
+  uint16_t megamorphic_count_;
 
   friend class ProfilingInfo;
 
   DISALLOW_COPY_AND_ASSIGN(InlineCache);
 };
 
+// Structure to store how often a conditional branch was taken and not taken at runtime.
+// Like the inline cache counts, the counts are updated without synchronization and
+// saturate, they are only meant to estimate the branch probability.
+class BranchCache {
+ public:
+  uint32_t GetDexPc() const {
+    return dex_pc_;
+  }
+
+  uint16_t GetTakenCount() const {
+    return taken_count_;
+  }
+
+  uint16_t GetNotTakenCount() const {
+    return not_taken_count_;
+  }
+
+ private:
+  uint32_t dex_pc_;
+  uint16_t taken_count_;
+  uint16_t not_taken_count_;
+
+  friend class ProfilingInfo;
+
+  DISALLOW_COPY_AND_ASSIGN(BranchCache);
+};
+
 /**
  * Profiling info for a method, created and filled by the interpreter once the
  * method is warm, and used by the compiler to drive optimizations.
@@ -102,6 +150,9 @@ class ProfilingInfo {
       REQUIRES(Roles::uninterruptible_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Add information from an executed conditional branch instruction to the profile.
+  void AddBranchInfo(uint32_t dex_pc, bool taken);
+
   // NO_THREAD_SAFETY_ANALYSIS since we don't know what the callback requires.
   template<typename RootVisitorType>
   void VisitRoots(RootVisitorType& visitor) NO_THREAD_SAFETY_ANALYSIS {
@@ -119,6 +170,10 @@ class ProfilingInfo {
 
   InlineCache* GetInlineCache(uint32_t dex_pc);
 
+  // Return the branch cache of the conditional branch at `dex_pc`, or null if the
+  // instruction is not a conditional branch.
+  const BranchCache* GetBranchCache(uint32_t dex_pc) const;
+
   bool IsMethodBeingCompiled(bool osr) const {
     return osr
         ? is_osr_method_being_compiled_
@@ -141,15 +196,72 @@ class ProfilingInfo {
     return saved_entry_point_;
   }
 
+  bool IsBaselineCompiled() const {
+    return is_baseline_compiled_;
+  }
+
+  void SetIsBaselineCompiled(bool value) {
+    is_baseline_compiled_ = value;
+    tier_up_samples_ = 0;
+  }
+
+  uint8_t AddTierUpSample() {
+    DCHECK_NE(tier_up_samples_, std::numeric_limits<uint8_t>::max());
+    return ++tier_up_samples_;
+  }
+
+  void ResetTierUpSamples() {
+    tier_up_samples_ = 0;
+  }
+
+  uint8_t IncrementCodeAge() {
+    if (code_age_ != std::numeric_limits<uint8_t>::max()) {
+      ++code_age_;
+    }
+    return code_age_;
+  }
+
+  void ResetCodeAge() {
+    code_age_ = 0;
+  }
+
+  // Loop header the interpreter last branched to, recorded for OSR compilation. Written
+  // racily by interpreter threads, it is only a hint.
+  uint32_t GetOsrEntryDexPc() const {
+    return osr_entry_dex_pc_;
+  }
+
+  void SetOsrEntryDexPc(uint32_t dex_pc) {
+    osr_entry_dex_pc_ = dex_pc;
+  }
+
   void ClearGcRootsInInlineCaches() {
     for (size_t i = 0; i < number_of_inline_caches_; ++i) {
       InlineCache* cache = &cache_[i];
       memset(&cache->classes_[0],
              0,
              InlineCache::kIndividualCacheSize * sizeof(GcRoot<mirror::Class>));
+      memset(&cache->counts_[0], 0, InlineCache::kIndividualCacheSize * sizeof(uint16_t));
+      cache->megamorphic_count_ = 0;
+    }
+  }
+
+  // Record that compiled code of the method deoptimized on a failed HDeoptimize check, and
+  // return the number of such deoptimizations, up to kMaxSpeculativeDeoptimizations.
+  uint8_t AddSpeculativeDeoptimization() {
+    if (speculative_deoptimizations_ < kMaxSpeculativeDeoptimizations) {
+      ++speculative_deoptimizations_;
     }
+    return speculative_deoptimizations_;
+  }
+
+  // Whether the compiler should still emit speculative HDeoptimize checks for the method.
+  bool ShouldSpeculate() const {
+    return speculative_deoptimizations_ < kMaxSpeculativeDeoptimizations;
   }
 
+  static constexpr uint8_t kMaxSpeculativeDeoptimizations = 3;
+
   void IncrementInlineUse() {
     DCHECK_NE(current_inline_uses_, std::numeric_limits<uint16_t>::max());
     current_inline_uses_++;
@@ -166,22 +278,47 @@ class ProfilingInfo {
   }
 
  private:
-  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries)
+  ProfilingInfo(ArtMethod* method,
+                const std::vector<uint32_t>& entries,
+                const std::vector<uint32_t>& branch_entries)
       : number_of_inline_caches_(entries.size()),
+        number_of_branch_caches_(branch_entries.size()),
         method_(method),
         is_method_being_compiled_(false),
         is_osr_method_being_compiled_(false),
         current_inline_uses_(0),
+        is_baseline_compiled_(false),
+        tier_up_samples_(0),
+        code_age_(0),
+        speculative_deoptimizations_(0),
+        osr_entry_dex_pc_(DexFile::kDexNoIndex),
         saved_entry_point_(nullptr) {
     memset(&cache_, 0, number_of_inline_caches_ * sizeof(InlineCache));
     for (size_t i = 0; i < number_of_inline_caches_; ++i) {
       cache_[i].dex_pc_ = entries[i];
     }
+    BranchCache* branch_caches = GetBranchCaches();
+    memset(branch_caches, 0, number_of_branch_caches_ * sizeof(BranchCache));
+    for (size_t i = 0; i < number_of_branch_caches_; ++i) {
+      branch_caches[i].dex_pc_ = branch_entries[i];
+    }
+  }
+
+  // The branch caches are allocated right after the inline caches.
+  BranchCache* GetBranchCaches() {
+    return reinterpret_cast<BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
+
+  const BranchCache* GetBranchCaches() const {
+    return reinterpret_cast<const BranchCache*>(&cache_[number_of_inline_caches_]);
   }
 
   // Number of instructions we are profiling in the ArtMethod.
   const uint32_t number_of_inline_caches_;
 
+  // Number of conditional branches we are profiling in the ArtMethod.
+  const uint32_t number_of_branch_caches_;
+
   // Method this profiling info is for.
   ArtMethod* const method_;
 
@@ -195,11 +332,29 @@ class ProfilingInfo {
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
 
+  // Whether the compiled code of the ArtMethod comes from the baseline JIT tier, and
+  // in how many consecutive tier up samples it was invoked. Guarded by the JIT code
+  // cache lock.
+  bool is_baseline_compiled_;
+  uint8_t tier_up_samples_;
+
+  // Number of consecutive liveness polls the compiled code of the ArtMethod survived
+  // without being invoked. Guarded by the JIT code cache lock.
+  uint8_t code_age_;
+
+  // Number of times compiled code of the ArtMethod deoptimized on a failed speculative
+  // check, see AddSpeculativeDeoptimization. Guarded by the JIT code cache lock.
+  uint8_t speculative_deoptimizations_;
+
+  // Target of the last backward branch taken by the interpreter, or kDexNoIndex.
+  uint32_t osr_entry_dex_pc_;
+
   // Entry point of the corresponding ArtMethod, while the JIT code cache
   // is poking for the liveness of compiled code.
   const void* saved_entry_point_;
 
-  // Dynamically allocated array of size `number_of_inline_caches_`.
+  // Dynamically allocated array of size `number_of_inline_caches_`, followed by
+  // the array of `number_of_branch_caches_` branch caches, sorted by dex pc.
   InlineCache cache_[0];
 
   friend class jit::JitCodeCache;
@@ -1902,15 +1902,20 @@ class JNI {
     }
     gc::Heap* heap = Runtime::Current()->GetHeap();
     if (heap->IsMovableObject(array)) {
-      if (!kUseReadBarrier) {
-        heap->IncrementDisableMovingGC(soa.Self());
+      if (heap->PinObjectForCriticalAccess(array)) {
+        // The CC collector will not evacuate the region of the array, and thanks to the to-space
+        // invariant the array does not move in the current collection either.
       } else {
-        // For the CC collector, we only need to wait for the thread flip rather than the whole GC
-        // to occur thanks to the to-space invariant.
-        heap->IncrementDisableThreadFlip(soa.Self());
+        if (!kUseReadBarrier) {
+          heap->IncrementDisableMovingGC(soa.Self());
+        } else {
+          // For the CC collector, we only need to wait for the thread flip rather than the whole
+          // GC to occur thanks to the to-space invariant.
+          heap->IncrementDisableThreadFlip(soa.Self());
+        }
+        // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
+        array = soa.Decode<mirror::Array*>(java_array);
       }
-      // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
-      array = soa.Decode<mirror::Array*>(java_array);
     }
     if (is_copy != nullptr) {
       *is_copy = JNI_FALSE;
@@ -2445,8 +2450,10 @@ class JNI {
       if (is_copy) {
         delete[] reinterpret_cast<uint64_t*>(elements);
       } else if (heap->IsMovableObject(array)) {
-        // Non copy to a movable object must means that we had disabled the moving GC.
-        if (!kUseReadBarrier) {
+        // Non copy to a movable object must means that we had pinned it or disabled the moving GC.
+        if (heap->UnpinObjectForCriticalAccess(array)) {
+          // Was pinned by GetPrimitiveArrayCritical.
+        } else if (!kUseReadBarrier) {
           heap->DecrementDisableMovingGC(soa.Self());
         } else {
           heap->DecrementDisableThreadFlip(soa.Self());
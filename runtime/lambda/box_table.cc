@@ -19,13 +19,10 @@
 #include "common_throws.h"
 #include "gc_root-inl.h"
 #include "lambda/closure.h"
-#include "lambda/leaking_allocator.h"
 #include "mirror/method.h"
 #include "mirror/object-inl.h"
 #include "thread.h"
 
-#include <vector>
-
 namespace art {
 namespace lambda {
 // Temporarily represent the lambda Closure as its raw bytes in an array.
@@ -56,32 +53,44 @@ namespace {
   };
 }  // namespace
 
-BoxTable::BoxTable()
-  : allow_new_weaks_(true),
-    new_weaks_condition_("lambda box table allowed weaks", *Locks::lambda_table_lock_) {}
+BoxTable::Shard::Shard()
+  : lock_("lambda box table shard lock", kLambdaTableLock),
+    allow_new_weaks_(true),
+    new_weaks_condition_("lambda box table allowed weaks", lock_) {}
+
+BoxTable::BoxTable() {}
 
 BoxTable::~BoxTable() {
   // Free all the copies of our closures.
-  for (auto map_iterator = map_.begin(); map_iterator != map_.end(); ) {
-    std::pair<UnorderedMapKeyType, ValueType>& key_value_pair = *map_iterator;
+  for (Shard& shard : shards_) {
+    MutexLock mu(Thread::Current(), shard.lock_);
+    for (auto map_iterator = shard.map_.begin(); map_iterator != shard.map_.end(); ) {
+      std::pair<UnorderedMapKeyType, ValueType>& key_value_pair = *map_iterator;
 
-    Closure* closure = key_value_pair.first;
+      Closure* closure = key_value_pair.first;
 
-    // Remove from the map first, so that it doesn't try to access dangling pointer.
-    map_iterator = map_.Erase(map_iterator);
+      // Remove from the map first, so that it doesn't try to access dangling pointer.
+      map_iterator = shard.map_.Erase(map_iterator);
 
-    // Safe to delete, no dangling pointers.
-    ClosureAllocator::Delete(closure);
+      // Safe to delete, no dangling pointers.
+      ClosureAllocator::Delete(closure);
+    }
   }
 }
 
+BoxTable::Shard& BoxTable::GetShard(const ClosureType& closure) {
+  // The maps reduce the same hash modulo their bucket counts, pick the shard from the high bits.
+  return shards_[(closure->GetHashCode() >> 16) % kNumShards];
+}
+
 mirror::Object* BoxTable::BoxLambda(const ClosureType& closure) {
   Thread* self = Thread::Current();
+  Shard& shard = GetShard(closure);
 
   {
     // TODO: Switch to ReaderMutexLock if ConditionVariable ever supports RW Mutexes
-    /*Reader*/MutexLock mu(self, *Locks::lambda_table_lock_);
-    BlockUntilWeaksAllowed();
+    /*Reader*/MutexLock mu(self, shard.lock_);
+    shard.BlockUntilWeaksAllowed(self);
 
     // Attempt to look up this object, it's possible it was already boxed previously.
     // If this is the case we *must* return the same object as before to maintain
@@ -92,7 +101,7 @@ mirror::Object* BoxTable::BoxLambda(const ClosureType& closure) {
     //   Object a = f;            // vA = box-lambda vA
     //   Object b = f;            // vB = box-lambda vB
     //   assert(a == f)
-    ValueType value = FindBoxedLambda(closure);
+    ValueType value = shard.FindBoxedLambda(closure);
     if (!value.IsNull()) {
       return value.Read();
     }
@@ -100,7 +109,7 @@ mirror::Object* BoxTable::BoxLambda(const ClosureType& closure) {
     // Otherwise we need to box ourselves and insert it into the hash map
   }
 
-  // Release the lambda table lock here, so that thread suspension is allowed.
+  // Release the shard lock here, so that thread suspension is allowed.
 
   // Convert the Closure into a managed byte[] which will serve
   // as the temporary 'boxed' version of the lambda. This is good enough
@@ -127,12 +136,12 @@ mirror::Object* BoxTable::BoxLambda(const ClosureType& closure) {
 
   // The method has been successfully boxed into an object, now insert it into the hash map.
   {
-    MutexLock mu(self, *Locks::lambda_table_lock_);
-    BlockUntilWeaksAllowed();
+    MutexLock mu(self, shard.lock_);
+    shard.BlockUntilWeaksAllowed(self);
 
     // Lookup the object again, it's possible another thread already boxed it while
     // we were allocating the object before.
-    ValueType value = FindBoxedLambda(closure);
+    ValueType value = shard.FindBoxedLambda(closure);
     if (UNLIKELY(!value.IsNull())) {
       // Let the GC clean up method_as_object at a later time.
       return value.Read();
@@ -148,19 +157,25 @@ mirror::Object* BoxTable::BoxLambda(const ClosureType& closure) {
     // The closure_table_copy needs to be deleted by us manually when we erase it from the map.
 
     // Actually insert into the table.
-    map_.Insert({closure_table_copy, ValueType(closure_as_array_object)});
+    shard.map_.Insert({closure_table_copy, ValueType(closure_as_array_object)});
   }
 
   return closure_as_array_object;
 }
 
-bool BoxTable::UnboxLambda(mirror::Object* object, ClosureType* out_closure) {
-  DCHECK(object != nullptr);
-  *out_closure = nullptr;
+size_t BoxTable::GetUnboxedClosureSize(mirror::Object* object) {
+  if (object == nullptr || !object->InstanceOf(GetBoxedClosureClass())) {
+    return 0u;
+  }
+  return static_cast<size_t>(down_cast<BoxedClosurePointerType>(object)->GetLength());
+}
 
-  Thread* self = Thread::Current();
+bool BoxTable::UnboxLambda(mirror::Object* object, Closure* closure_storage) {
+  DCHECK(object != nullptr);
+  DCHECK(closure_storage != nullptr);
+  DCHECK_ALIGNED(closure_storage, alignof(Closure));
 
-  // Note that we do not need to access lambda_table_lock_ here
+  // Note that we do not need to access the shard locks here
   // since we don't need to look at the map.
 
   mirror::Object* boxed_closure_object = object;
@@ -175,25 +190,21 @@ bool BoxTable::UnboxLambda(mirror::Object* object, ClosureType* out_closure) {
   // specified in [type id]. This is not currently implemented since it's always a byte[].
 
   // If we got this far, the inputs are valid.
-  // Shuffle the byte[] back into a raw closure, then allocate it, copy, and return it.
+  // Shuffle the byte[] back into a raw closure in the storage of the caller, which scopes its
+  // lifetime, e.g. to the frame that unboxes it, rather than leaking a copy per unboxing.
   BoxedClosurePointerType boxed_closure_as_array =
       down_cast<BoxedClosurePointerType>(boxed_closure_object);
 
   const int8_t* unaligned_interior_closure = boxed_closure_as_array->GetData();
 
-  // Allocate a copy that can "escape" and copy the closure data into that.
-  Closure* unboxed_closure =
-      LeakingAllocator::MakeFlexibleInstance<Closure>(self, boxed_closure_as_array->GetLength());
   // TODO: don't just memcpy the closure, it's unsafe when we add references to the mix.
-  memcpy(unboxed_closure, unaligned_interior_closure, boxed_closure_as_array->GetLength());
+  memcpy(closure_storage, unaligned_interior_closure, boxed_closure_as_array->GetLength());
 
-  DCHECK_EQ(unboxed_closure->GetSize(), static_cast<size_t>(boxed_closure_as_array->GetLength()));
-
-  *out_closure = unboxed_closure;
+  DCHECK_EQ(closure_storage->GetSize(), static_cast<size_t>(boxed_closure_as_array->GetLength()));
   return true;
 }
 
-BoxTable::ValueType BoxTable::FindBoxedLambda(const ClosureType& closure) const {
+BoxTable::ValueType BoxTable::Shard::FindBoxedLambda(const ClosureType& closure) const {
   auto map_iterator = map_.Find(closure);
   if (map_iterator != map_.end()) {
     const std::pair<UnorderedMapKeyType, ValueType>& key_value_pair = *map_iterator;
@@ -206,8 +217,7 @@ BoxTable::ValueType BoxTable::FindBoxedLambda(const ClosureType& closure) const
   return ValueType(nullptr);
 }
 
-void BoxTable::BlockUntilWeaksAllowed() {
-  Thread* self = Thread::Current();
+void BoxTable::Shard::BlockUntilWeaksAllowed(Thread* self) {
   while (UNLIKELY((!kUseReadBarrier && !allow_new_weaks_) ||
                   (kUseReadBarrier && !self->GetWeakRefAccessEnabled()))) {
     new_weaks_condition_.WaitHoldingLocks(self);  // wait while holding mutator lock
@@ -218,68 +228,73 @@ void BoxTable::SweepWeakBoxedLambdas(IsMarkedVisitor* visitor) {
   DCHECK(visitor != nullptr);
 
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::lambda_table_lock_);
-
-  /*
-   * Visit every weak root in our lambda box table.
-   * Remove unmarked objects, update marked objects to new address.
-   */
-  std::vector<ClosureType> remove_list;
-  for (auto map_iterator = map_.begin(); map_iterator != map_.end(); ) {
-    std::pair<UnorderedMapKeyType, ValueType>& key_value_pair = *map_iterator;
-
-    const ValueType& old_value = key_value_pair.second;
-
-    // This does not need a read barrier because this is called by GC.
-    mirror::Object* old_value_raw = old_value.Read<kWithoutReadBarrier>();
-    mirror::Object* new_value = visitor->IsMarked(old_value_raw);
-
-    if (new_value == nullptr) {
-      // The object has been swept away.
-      const ClosureType& closure = key_value_pair.first;
-
-      // Delete the entry from the map.
-      map_iterator = map_.Erase(map_iterator);
-
-      // Clean up the memory by deleting the closure.
-      ClosureAllocator::Delete(closure);
-
-    } else {
-      // The object has been moved.
-      // Update the map.
-      key_value_pair.second = ValueType(new_value);
-      ++map_iterator;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+
+    /*
+     * Visit every weak root in our lambda box table.
+     * Remove unmarked objects, update marked objects to new address.
+     */
+    for (auto map_iterator = shard.map_.begin(); map_iterator != shard.map_.end(); ) {
+      std::pair<UnorderedMapKeyType, ValueType>& key_value_pair = *map_iterator;
+
+      const ValueType& old_value = key_value_pair.second;
+
+      // This does not need a read barrier because this is called by GC.
+      mirror::Object* old_value_raw = old_value.Read<kWithoutReadBarrier>();
+      mirror::Object* new_value = visitor->IsMarked(old_value_raw);
+
+      if (new_value == nullptr) {
+        // The object has been swept away.
+        const ClosureType& closure = key_value_pair.first;
+
+        // Delete the entry from the map.
+        map_iterator = shard.map_.Erase(map_iterator);
+
+        // Clean up the memory by deleting the closure.
+        ClosureAllocator::Delete(closure);
+
+      } else {
+        // The object has been moved.
+        // Update the map.
+        key_value_pair.second = ValueType(new_value);
+        ++map_iterator;
+      }
     }
-  }
 
-  // Occasionally shrink the map to avoid growing very large.
-  if (map_.CalculateLoadFactor() < kMinimumLoadFactor) {
-    map_.ShrinkToMaximumLoad();
+    // Occasionally shrink the map to avoid growing very large.
+    if (shard.map_.CalculateLoadFactor() < kMinimumLoadFactor) {
+      shard.map_.ShrinkToMaximumLoad();
+    }
   }
 }
 
 void BoxTable::DisallowNewWeakBoxedLambdas() {
   CHECK(!kUseReadBarrier);
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::lambda_table_lock_);
-
-  allow_new_weaks_ = false;
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.allow_new_weaks_ = false;
+  }
 }
 
 void BoxTable::AllowNewWeakBoxedLambdas() {
   CHECK(!kUseReadBarrier);
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::lambda_table_lock_);
-
-  allow_new_weaks_ = true;
-  new_weaks_condition_.Broadcast(self);
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.allow_new_weaks_ = true;
+    shard.new_weaks_condition_.Broadcast(self);
+  }
 }
 
 void BoxTable::BroadcastForNewWeakBoxedLambdas() {
   CHECK(kUseReadBarrier);
   Thread* self = Thread::Current();
-  MutexLock mu(self, *Locks::lambda_table_lock_);
-  new_weaks_condition_.Broadcast(self);
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.new_weaks_condition_.Broadcast(self);
+  }
 }
 
 void BoxTable::EmptyFn::MakeEmpty(std::pair<UnorderedMapKeyType, ValueType>& item) const {
@@ -28,6 +28,7 @@
 namespace art {
 
 class ArtMethod;  // forward declaration
+class Thread;  // forward declaration
 
 namespace mirror {
 class Object;  // forward declaration
@@ -49,28 +50,31 @@ class BoxTable FINAL {
 
   // Boxes a closure into an object. Returns null and throws an exception on failure.
   mirror::Object* BoxLambda(const ClosureType& closure)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Locks::lambda_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Size of the storage that UnboxLambda needs for object, or 0 if object is not a boxed lambda.
+  static size_t GetUnboxedClosureSize(mirror::Object* object)
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Unboxes an object back into the lambda. Returns false and throws an exception on failure.
-  bool UnboxLambda(mirror::Object* object, ClosureType* out_closure)
+  // Unboxes an object back into the lambda. The closure is written to closure_storage, which
+  // is owned by the caller and must hold at least GetUnboxedClosureSize(object) bytes.
+  // Returns false and throws an exception on failure.
+  bool UnboxLambda(mirror::Object* object, Closure* closure_storage)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Sweep weak references to lambda boxes. Update the addresses if the objects have been
   // moved, and delete them from the table if the objects have been cleaned up.
   void SweepWeakBoxedLambdas(IsMarkedVisitor* visitor)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Locks::lambda_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   // GC callback: Temporarily block anyone from touching the map.
-  void DisallowNewWeakBoxedLambdas()
-      REQUIRES(!Locks::lambda_table_lock_);
+  void DisallowNewWeakBoxedLambdas();
 
   // GC callback: Unblock any readers who have been queued waiting to touch the map.
-  void AllowNewWeakBoxedLambdas()
-      REQUIRES(!Locks::lambda_table_lock_);
+  void AllowNewWeakBoxedLambdas();
 
   // GC callback: Unblock any readers who have been queued waiting to touch the map.
-  void BroadcastForNewWeakBoxedLambdas()
-      REQUIRES(!Locks::lambda_table_lock_);
+  void BroadcastForNewWeakBoxedLambdas();
 
   BoxTable();
   ~BoxTable();
@@ -89,14 +93,6 @@ class BoxTable FINAL {
   // Also, any reads should be protected by a read barrier to always give us the "to" space address.
   using ValueType = GcRoot<mirror::Object>;
 
-  // Attempt to look up the lambda in the map, or return null if it's not there yet.
-  ValueType FindBoxedLambda(const ClosureType& closure) const
-      SHARED_REQUIRES(Locks::lambda_table_lock_);
-
-  // If the GC has come in and temporarily disallowed touching weaks, block until is it allowed.
-  void BlockUntilWeaksAllowed()
-      SHARED_REQUIRES(Locks::lambda_table_lock_);
-
   // Wrap the Closure into a unique_ptr so that the HashMap can delete its memory automatically.
   using UnorderedMapKeyType = ClosureType;
 
@@ -128,9 +124,30 @@ class BoxTable FINAL {
                                     TrackingAllocator<std::pair<ClosureType, ValueType>,
                                                       kAllocatorTagLambdaBoxTable>>;
 
-  UnorderedMap map_                                          GUARDED_BY(Locks::lambda_table_lock_);
-  bool allow_new_weaks_                                      GUARDED_BY(Locks::lambda_table_lock_);
-  ConditionVariable new_weaks_condition_                     GUARDED_BY(Locks::lambda_table_lock_);
+  // The closures are spread over shards by hash, each with its own lock, so that threads
+  // boxing different closures do not contend, and a GC sweeping one shard does not hold up
+  // the lookups in the others. The shards are never locked together.
+  static constexpr size_t kNumShards = 16;
+
+  struct Shard {
+    Shard();
+
+    // Attempt to look up the lambda in the map, or return null if it's not there yet.
+    ValueType FindBoxedLambda(const ClosureType& closure) const REQUIRES(lock_);
+
+    // If the GC has come in and temporarily disallowed touching weaks, block until is it
+    // allowed.
+    void BlockUntilWeaksAllowed(Thread* self) REQUIRES(lock_);
+
+    Mutex lock_ ACQUIRED_AFTER(Locks::mutator_lock_);
+    UnorderedMap map_ GUARDED_BY(lock_);
+    bool allow_new_weaks_ GUARDED_BY(lock_);
+    ConditionVariable new_weaks_condition_ GUARDED_BY(lock_);
+  };
+
+  Shard& GetShard(const ClosureType& closure) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  Shard shards_[kNumShards];
 
   // Shrink the map when we get below this load factor.
   // (This is an arbitrary value that should be large enough to prevent aggressive map erases
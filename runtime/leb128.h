@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_LEB128_H_
 #define ART_RUNTIME_LEB128_H_
 
+#include <string.h>
+
 #include <vector>
 
 #include "base/bit_utils.h"
@@ -53,6 +55,67 @@ static inline uint32_t DecodeUnsignedLeb128(const uint8_t** data) {
   return static_cast<uint32_t>(result);
 }
 
+// Reads an unsigned LEB128 value like DecodeUnsignedLeb128, but with a single unaligned 64-bit
+// load and without a branch per byte. At least eight bytes must be readable at *data.
+static inline uint32_t DecodeUnsignedLeb128FromWord(const uint8_t** data) {
+  uint64_t word;
+  memcpy(&word, *data, sizeof(word));  // Little-endian, like all the targets.
+  // The value ends with the first byte without the continuation bit, or with the fifth byte.
+  uint64_t ends = (~word & UINT64_C(0x80808080)) | UINT64_C(0x8000000000);
+  size_t size = (CTZ(ends) >> 3) + 1u;
+  uint64_t bytes = word & (~UINT64_C(0) >> (64u - 8u * size));
+  uint32_t result = static_cast<uint32_t>((bytes & 0x7fu) |
+                                          ((bytes >> 1) & (UINT64_C(0x7f) << 7)) |
+                                          ((bytes >> 2) & (UINT64_C(0x7f) << 14)) |
+                                          ((bytes >> 3) & (UINT64_C(0x7f) << 21)) |
+                                          ((bytes >> 4) & (UINT64_C(0xf) << 28)));
+  *data += size;
+  return result;
+}
+
+// Reads `count` unsigned LEB128 values into `out`, updating the given pointer to point just
+// past the end of the last value. The values are read with DecodeUnsignedLeb128FromWord while
+// eight bytes before `readable_end` remain. Like DecodeUnsignedLeb128, this does not check
+// that the values end before `readable_end`.
+static inline void DecodeUnsignedLeb128Bulk(const uint8_t** data,
+                                            const void* readable_end,
+                                            uint32_t* out,
+                                            size_t count) {
+  const uint8_t* ptr = *data;
+  const uint8_t* end = reinterpret_cast<const uint8_t*>(readable_end);
+  for (size_t i = 0; i != count; ++i) {
+    if (end - ptr >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+      out[i] = DecodeUnsignedLeb128FromWord(&ptr);
+    } else {
+      out[i] = DecodeUnsignedLeb128(&ptr);
+    }
+  }
+  *data = ptr;
+}
+
+// Reads an unsigned LEB128 value that must end before `end`, updating the given pointer to
+// point just past the end of the read value. Returns false and leaves the pointer unchanged
+// if the value is truncated.
+static inline bool DecodeUnsignedLeb128Checked(const uint8_t** data,
+                                               const void* end,
+                                               uint32_t* out) {
+  const uint8_t* ptr = *data;
+  uint32_t result = 0u;
+  for (size_t shift = 0u; shift < 35u; shift += 7u) {
+    if (ptr >= end) {
+      return false;
+    }
+    uint8_t cur = *(ptr++);
+    result |= static_cast<uint32_t>(cur & 0x7f) << shift;
+    if (cur <= 0x7f) {
+      *data = ptr;
+      *out = result;
+      return true;
+    }
+  }
+  return false;  // The value takes more than five bytes.
+}
+
 // Reads an unsigned LEB128 + 1 value. updating the given pointer to point
 // just past the end of the read value. This function tolerates
 // non-zero high-order bits in the fifth encoded byte.
@@ -172,6 +172,55 @@ TEST(Leb128Test, UnsignedStream) {
   EXPECT_EQ(data_size, static_cast<size_t>(encoded_data_ptr - encoded_data));
 }
 
+TEST(Leb128Test, UnsignedChecked) {
+  for (size_t i = 0; i < arraysize(uleb128_tests); ++i) {
+    const uint8_t* data = uleb128_tests[i].leb128_data;
+    size_t size = UnsignedLeb128Size(uleb128_tests[i].decoded);
+    // A truncated value is rejected and does not move the pointer.
+    const uint8_t* data_ptr = data;
+    uint32_t value;
+    EXPECT_FALSE(DecodeUnsignedLeb128Checked(&data_ptr, data + size - 1u, &value)) << " i = " << i;
+    EXPECT_EQ(data, data_ptr) << " i = " << i;
+    EXPECT_TRUE(DecodeUnsignedLeb128Checked(&data_ptr, data + size, &value)) << " i = " << i;
+    EXPECT_EQ(uleb128_tests[i].decoded, value) << " i = " << i;
+    EXPECT_EQ(data + size, data_ptr) << " i = " << i;
+  }
+  // More than five bytes.
+  static const uint8_t kTooLong[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+  const uint8_t* data_ptr = kTooLong;
+  uint32_t value;
+  EXPECT_FALSE(DecodeUnsignedLeb128Checked(&data_ptr, kTooLong + sizeof(kTooLong), &value));
+}
+
+TEST(Leb128Test, UnsignedBulk) {
+  Leb128EncodingVector<> builder;
+  for (size_t i = 0; i < arraysize(uleb128_tests); ++i) {
+    builder.PushBackUnsigned(uleb128_tests[i].decoded);
+  }
+  // Garbage in the high bits of the fifth byte is ignored, as by DecodeUnsignedLeb128.
+  static const uint8_t kHighGarbage[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x7F };
+  std::vector<uint8_t> data = builder.GetData();
+  data.insert(data.end(), kHighGarbage, kHighGarbage + sizeof(kHighGarbage));
+  const size_t count = arraysize(uleb128_tests) + 1u;
+
+  std::vector<uint32_t> expected;
+  const uint8_t* expected_ptr = data.data();
+  for (size_t i = 0; i != count; ++i) {
+    expected.push_back(DecodeUnsignedLeb128(&expected_ptr));
+  }
+  EXPECT_EQ(0xFFFFFFFFu, expected.back());
+
+  // Decode with every readable end so that both the word loads and the single byte loads see
+  // all the values.
+  for (size_t readable = 0; readable <= data.size(); ++readable) {
+    const uint8_t* data_ptr = data.data();
+    std::vector<uint32_t> values(count);
+    DecodeUnsignedLeb128Bulk(&data_ptr, data.data() + readable, values.data(), count);
+    EXPECT_EQ(expected, values) << " readable = " << readable;
+    EXPECT_EQ(expected_ptr, data_ptr) << " readable = " << readable;
+  }
+}
+
 TEST(Leb128Test, SignedSinglesVector) {
   // Test individual encodings.
   for (size_t i = 0; i < arraysize(sleb128_tests); ++i) {
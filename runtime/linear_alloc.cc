@@ -16,6 +16,7 @@
 
 #include "linear_alloc.h"
 
+#include "base/bit_utils.h"
 #include "thread-inl.h"
 
 namespace art {
@@ -33,6 +34,13 @@ void* LinearAlloc::Alloc(Thread* self, size_t size) {
   return allocator_.Alloc(size);
 }
 
+void* LinearAlloc::AllocAlign16(Thread* self, size_t size) {
+  MutexLock mu(self, lock_);
+  // The arena allocator only guarantees 8-byte alignment, so over-allocate by the difference.
+  uint8_t* memory = reinterpret_cast<uint8_t*>(allocator_.Alloc(size + 8u));
+  return AlignUp(memory, 16u);
+}
+
 size_t LinearAlloc::GetUsedMemory() const {
   MutexLock mu(Thread::Current(), lock_);
   return allocator_.BytesUsed();
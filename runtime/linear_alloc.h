@@ -30,6 +30,9 @@ class LinearAlloc {
 
   void* Alloc(Thread* self, size_t size) REQUIRES(!lock_);
 
+  // Returns zeroed memory aligned to 16 bytes.
+  void* AllocAlign16(Thread* self, size_t size) REQUIRES(!lock_);
+
   // Realloc never frees the input pointer, it is the caller's job to do this if necessary.
   void* Realloc(Thread* self, void* ptr, size_t old_size, size_t new_size) REQUIRES(!lock_);
 
@@ -21,8 +21,10 @@
 #include <inttypes.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "base/stringprintf.h"
 #include "base/unix_file/fd_file.h"
@@ -269,6 +271,30 @@ static inline void* TryMemMapLow4GB(void* ptr,
   }
   return actual;
 }
+
+// Probing mappings that are not ours costs one msync() per page. After this many pages, look up
+// the rest of the mapping in /proc/self/maps instead.
+static constexpr size_t kMaxForeignPagesToProbe = 256;
+
+// Returns the end of the process mapping containing `addr`, or 0 if there is none. The process
+// map is read on the first call and reused afterwards. It may be stale, which at worst loses
+// a gap that opened since, as the caller still checks the candidate address.
+static uintptr_t FindProcessMappingEnd(uintptr_t addr, std::unique_ptr<BacktraceMap>* process_map) {
+  if (*process_map == nullptr) {
+    process_map->reset(BacktraceMap::Create(getpid(), true));
+    if (*process_map == nullptr) {
+      return 0;
+    }
+  }
+  ScopedBacktraceMapIteratorLock lock(process_map->get());
+  for (BacktraceMap::const_iterator it = (*process_map)->begin(); it != (*process_map)->end();
+       ++it) {
+    if (addr >= it->start && addr < it->end) {
+      return RoundUp(static_cast<uintptr_t>(it->end), kPageSize);
+    }
+  }
+  return 0;
+}
 #endif
 
 MemMap* MemMap::MapAnonymous(const char* name,
@@ -582,6 +608,91 @@ MemMap* MemMap::RemapAtEnd(uint8_t* new_end, const char* tail_name, int tail_pro
   return new MemMap(tail_name, actual, tail_size, actual, tail_base_size, tail_prot, false);
 }
 
+MemMap* MemMap::MapAnonymousAligned(const char* name,
+                                    size_t byte_count,
+                                    int prot,
+                                    bool low_4gb,
+                                    size_t alignment,
+                                    std::string* error_msg,
+                                    bool use_ashmem) {
+  CHECK(IsPowerOfTwo(alignment)) << alignment;
+  CHECK_ALIGNED_PARAM(alignment, kPageSize);
+  const size_t page_aligned_byte_count = RoundUp(byte_count, kPageSize);
+  // Reserve alignment more bytes than needed, then unmap the unaligned head and the extra tail.
+  std::unique_ptr<MemMap> map(MapAnonymous(name,
+                                           nullptr,
+                                           page_aligned_byte_count + alignment,
+                                           prot,
+                                           low_4gb,
+                                           /* reuse */ false,
+                                           error_msg,
+                                           use_ashmem));
+  if (map == nullptr) {
+    return nullptr;
+  }
+  uint8_t* aligned_begin = AlignUp(map->Begin(), alignment);
+  if (aligned_begin != map->Begin()) {
+    std::unique_ptr<MemMap> aligned_map(
+        map->RemapAtEnd(aligned_begin, name, prot, error_msg, use_ashmem));
+    if (aligned_map == nullptr) {
+      return nullptr;
+    }
+    // Deleting the head unmaps it.
+    map = std::move(aligned_map);
+  }
+  map->SetSize(page_aligned_byte_count);
+  return map.release();
+}
+
+bool MemMap::AdviseHugePages() {
+#ifdef MADV_HUGEPAGE
+  uint8_t* begin = AlignUp(reinterpret_cast<uint8_t*>(BaseBegin()), kHugePageSize);
+  uint8_t* end = AlignDown(reinterpret_cast<uint8_t*>(BaseEnd()), kHugePageSize);
+  if (begin >= end) {
+    return false;
+  }
+  if (madvise(begin, end - begin, MADV_HUGEPAGE) != 0) {
+    PLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed for " << name_;
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t MemMap::GetHugePageBackedBytes() const {
+#ifdef __linux__
+  std::string smaps;
+  if (BaseSize() == 0 || !ReadFileToString("/proc/self/smaps", &smaps)) {
+    return 0;
+  }
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(BaseBegin());
+  const uintptr_t end = reinterpret_cast<uintptr_t>(BaseEnd());
+  size_t huge_page_bytes = 0;
+  // Overlap of the current smaps entry with this map, 0 if it doesn't overlap.
+  size_t overlap = 0;
+  std::vector<std::string> lines;
+  Split(smaps, '\n', &lines);
+  for (const std::string& line : lines) {
+    uintptr_t entry_begin = 0;
+    uintptr_t entry_end = 0;
+    size_t kb = 0;
+    if (sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &entry_begin, &entry_end) == 2) {
+      const uintptr_t overlap_begin = std::max(begin, entry_begin);
+      const uintptr_t overlap_end = std::min(end, entry_end);
+      overlap = overlap_begin < overlap_end ? overlap_end - overlap_begin : 0;
+    } else if (overlap != 0 && sscanf(line.c_str(), "AnonHugePages: %zu kB", &kb) == 1) {
+      // smaps doesn't say where in the entry the huge pages are, assume they are in our part.
+      huge_page_bytes += std::min(kb * KB, overlap);
+    }
+  }
+  return huge_page_bytes;
+#else
+  return 0;
+#endif
+}
+
 void MemMap::MadviseDontNeedAndZero() {
   if (base_begin_ != nullptr || base_size_ != 0) {
     if (!kMadviseZeroes) {
@@ -802,6 +913,8 @@ void* MemMap::MapInternal(void* addr,
   // MAP_32BIT only available on x86_64.
   if (low_4gb && addr == nullptr) {
     bool first_run = true;
+    size_t foreign_pages_probed = 0;
+    std::unique_ptr<BacktraceMap> process_map;
 
     MutexLock mu(Thread::Current(), *Locks::mem_maps_lock_);
     for (uintptr_t ptr = next_mem_pos_; ptr < 4 * GB; ptr += kPageSize) {
@@ -871,6 +984,15 @@ void* MemMap::MapInternal(void* addr,
       } else {
         // Skip over last page.
         ptr = tail_ptr;
+        if (++foreign_pages_probed > kMaxForeignPagesToProbe) {
+          // Skip the whole mapping at once rather than probing it page by page.
+          // Stop short of the top so that the search still wraps around to the bottom.
+          uintptr_t mapping_end = std::min<uintptr_t>(FindProcessMappingEnd(tail_ptr, &process_map),
+                                                      4 * GB - length);
+          if (mapping_end > ptr + kPageSize) {
+            ptr = mapping_end - kPageSize;
+          }
+        }
       }
     }
 
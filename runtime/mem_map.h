@@ -43,6 +43,9 @@ static constexpr bool kMadviseZeroes = true;
 static constexpr bool kMadviseZeroes = false;
 #endif
 
+// The size of a transparent huge page.
+static constexpr size_t kHugePageSize = 2 * MB;
+
 // Used to keep track of mmap segments.
 //
 // On 64b systems not supporting MAP_32BIT, the implementation of MemMap will do a linear scan
@@ -70,6 +73,16 @@ class MemMap {
                               std::string* error_msg,
                               bool use_ashmem = !kIsTargetLinux);
 
+  // Same as MapAnonymous with a null addr, but the map begins at a multiple of alignment. The
+  // alignment must be a power of two and a multiple of the page size.
+  static MemMap* MapAnonymousAligned(const char* name,
+                                     size_t byte_count,
+                                     int prot,
+                                     bool low_4gb,
+                                     size_t alignment,
+                                     std::string* error_msg,
+                                     bool use_ashmem = !kIsTargetLinux);
+
   // Create placeholder for a region allocated by direct call to mmap.
   // This is useful when we do not have control over the code calling mmap,
   // but when we still want to keep track of it in the list.
@@ -132,6 +145,14 @@ class MemMap {
 
   void MadviseDontNeedAndZero();
 
+  // Ask the kernel to back the huge page aligned part of the map with transparent huge pages.
+  // Returns false if there is no such part or the kernel rejects the advice.
+  bool AdviseHugePages();
+
+  // Returns how many bytes of the map are backed by transparent huge pages, as reported by
+  // /proc/self/smaps. Returns 0 where that is not available.
+  size_t GetHugePageBackedBytes() const;
+
   int GetProtect() const {
     return prot_;
   }
@@ -431,4 +431,56 @@ TEST_F(MemMapTest, CheckNoGaps) {
   ASSERT_FALSE(MemMap::CheckNoGaps(map0.get(), map2.get()));
 }
 
+TEST_F(MemMapTest, MapAnonymousAligned) {
+  CommonInit();
+  std::string error_msg;
+  for (size_t alignment : { static_cast<size_t>(kPageSize), 64 * KB, kHugePageSize }) {
+    std::unique_ptr<MemMap> map(MemMap::MapAnonymousAligned("MapAnonymousAligned",
+                                                            kPageSize + 1,
+                                                            PROT_READ | PROT_WRITE,
+                                                            false,
+                                                            alignment,
+                                                            &error_msg));
+    ASSERT_TRUE(map.get() != nullptr) << error_msg;
+    ASSERT_TRUE(error_msg.empty());
+    EXPECT_TRUE(IsAlignedParam(reinterpret_cast<uintptr_t>(map->Begin()), alignment));
+    // The size is rounded up to pages, and the over-reservation is unmapped again.
+    EXPECT_EQ(2 * kPageSize, map->Size());
+    EXPECT_EQ(2 * kPageSize, map->BaseSize());
+    map->Begin()[0] = 42;
+    map->Begin()[2 * kPageSize - 1] = 43;
+    EXPECT_TRUE(MemMap::CheckNoGaps(map.get(), map.get()));
+  }
+}
+
+TEST_F(MemMapTest, AdviseHugePages) {
+  CommonInit();
+  std::string error_msg;
+  // A map without a huge page aligned part can't be advised.
+  std::unique_ptr<MemMap> small_map(MemMap::MapAnonymous("AdviseHugePagesSmall",
+                                                         nullptr,
+                                                         kPageSize,
+                                                         PROT_READ | PROT_WRITE,
+                                                         false,
+                                                         false,
+                                                         &error_msg));
+  ASSERT_TRUE(small_map.get() != nullptr) << error_msg;
+  EXPECT_FALSE(small_map->AdviseHugePages());
+  EXPECT_LE(small_map->GetHugePageBackedBytes(), small_map->BaseSize());
+
+  std::unique_ptr<MemMap> map(MemMap::MapAnonymousAligned("AdviseHugePages",
+                                                          2 * kHugePageSize,
+                                                          PROT_READ | PROT_WRITE,
+                                                          false,
+                                                          kHugePageSize,
+                                                          &error_msg,
+                                                          /* use_ashmem */ false));
+  ASSERT_TRUE(map.get() != nullptr) << error_msg;
+  // Whether the kernel takes the advice depends on its configuration, but touching the memory
+  // must work either way and the huge page accounting must stay within the map.
+  map->AdviseHugePages();
+  memset(map->Begin(), 1, map->Size());
+  EXPECT_LE(map->GetHugePageBackedBytes(), map->BaseSize());
+}
+
 }  // namespace art
@@ -271,6 +271,12 @@ inline void Class::SetEmbeddedVTableLength(int32_t len) {
   SetField32<false>(MemberOffset(EmbeddedVTableLengthOffset()), len);
 }
 
+template<VerifyObjectFlags kVerifyFlags, ReadBarrierOption kReadBarrierOption>
+inline Class* Class::GetSuperclassDisplayEntry(uint32_t i) {
+  DCHECK((ShouldHaveEmbeddedVTable<kVerifyFlags, kReadBarrierOption>()));
+  return GetFieldObject<Class, kVerifyFlags, kReadBarrierOption>(SuperclassDisplayEntryOffset(i));
+}
+
 inline ImTable* Class::GetImt(PointerSize pointer_size) {
   return GetFieldPtrWithSize<ImTable*>(MemberOffset(ImtPtrOffset(pointer_size)), pointer_size);
 }
@@ -711,7 +717,9 @@ inline uint32_t Class::ComputeClassSize(bool has_embedded_vtable,
   uint32_t size = sizeof(Class);
   // Space used by embedded tables.
   if (has_embedded_vtable) {
-    size = RoundUp(size + sizeof(uint32_t), static_cast<size_t>(pointer_size));
+    size += sizeof(uint32_t);  // size of the embedded vtable length
+    size += kSuperclassDisplayLength * sizeof(HeapReference<Class>);
+    size = RoundUp(size, static_cast<size_t>(pointer_size));
     size += static_cast<size_t>(pointer_size);  // size of pointer to IMT
     size += num_vtable_entries * VTableEntrySize(pointer_size);
   }
@@ -762,6 +770,12 @@ inline void Class::VisitReferences(mirror::Class* klass, const Visitor& visitor)
     // allocated with the right size for those. Also, unresolved classes don't have fields
     // linked yet.
     VisitStaticFieldsReferences<kVerifyFlags, kReadBarrierOption>(this, visitor);
+    if (ShouldHaveEmbeddedVTable<kVerifyFlags, kReadBarrierOption>()) {
+      // The superclass display entries must be updated when the super classes move.
+      for (uint32_t i = 0; i != kSuperclassDisplayLength; ++i) {
+        visitor(this, SuperclassDisplayEntryOffset(i), /* is_static */ true);
+      }
+    }
   }
   if (kVisitNativeRoots) {
     // Since this class is reachable, we must also visit the associated roots when we scan it.
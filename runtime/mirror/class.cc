@@ -945,6 +945,21 @@ void Class::PopulateEmbeddedVTable(PointerSize pointer_size) {
   }
 }
 
+void Class::PopulateSuperclassDisplay() {
+  DCHECK(ShouldHaveEmbeddedVTable());
+  uint32_t depth = Depth();
+  for (uint32_t d = depth + 1; d <= kSuperclassDisplayLength; ++d) {
+    SetFieldObject<false>(SuperclassDisplayEntryOffset(d - 1), nullptr);
+  }
+  Class* klass = this;
+  for (uint32_t d = depth; d != 0; --d) {
+    if (d <= kSuperclassDisplayLength) {
+      SetFieldObject<false>(SuperclassDisplayEntryOffset(d - 1), klass);
+    }
+    klass = klass->GetSuperClass();
+  }
+}
+
 class ReadBarrierOnNativeRootsVisitor {
  public:
   void operator()(mirror::Object* obj ATTRIBUTE_UNUSED,
@@ -993,6 +1008,7 @@ class CopyClassVisitor {
     mirror::Object::CopyObject(self_, h_new_class_obj.Get(), orig_->Get(), copy_bytes_);
     mirror::Class::SetStatus(h_new_class_obj, Class::kStatusResolving, self_);
     h_new_class_obj->PopulateEmbeddedVTable(pointer_size_);
+    h_new_class_obj->PopulateSuperclassDisplay();
     h_new_class_obj->SetImt(imt_, pointer_size_);
     h_new_class_obj->SetClassSize(new_length_);
     // Visit all of the references to make sure there is no from space references in the native
@@ -824,9 +824,24 @@ class MANAGED Class FINAL : public Object {
     return MemberOffset(sizeof(Class));
   }
 
+  // Number of entries in the superclass display of instantiable classes.
+  static constexpr size_t kSuperclassDisplayLength = 5;
+
+  // The superclass display follows the embedded vtable length. Entry `d - 1` holds the class at
+  // depth `d` (java.lang.Object being at depth 0) on the superclass chain of this class, the
+  // class itself included, or null past the depth of this class. Compiled code checks whether
+  // an object is an instance of a class at depth `d <= kSuperclassDisplayLength` with a single
+  // load and compare instead of walking the superclass chain.
+  static MemberOffset SuperclassDisplayEntryOffset(uint32_t i) {
+    DCHECK_LT(i, kSuperclassDisplayLength);
+    return MemberOffset(EmbeddedVTableLengthOffset().Uint32Value() + sizeof(uint32_t) +
+                        i * sizeof(HeapReference<Class>));
+  }
+
   static MemberOffset ImtPtrOffset(PointerSize pointer_size) {
     return MemberOffset(
-        RoundUp(EmbeddedVTableLengthOffset().Uint32Value() + sizeof(uint32_t),
+        RoundUp(EmbeddedVTableLengthOffset().Uint32Value() + sizeof(uint32_t) +
+                    kSuperclassDisplayLength * sizeof(HeapReference<Class>),
                 static_cast<size_t>(pointer_size)));
   }
 
@@ -873,6 +888,13 @@ class MANAGED Class FINAL : public Object {
   void PopulateEmbeddedVTable(PointerSize pointer_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags,
+           ReadBarrierOption kReadBarrierOption = kWithReadBarrier>
+  Class* GetSuperclassDisplayEntry(uint32_t i) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Fill the superclass display during linking, once the super class is set.
+  void PopulateSuperclassDisplay() SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Given a method implemented by this class but potentially from a super class, return the
   // specific implementation method for this class.
   ArtMethod* FindVirtualMethodForVirtual(ArtMethod* method, PointerSize pointer_size)
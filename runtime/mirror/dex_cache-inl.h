@@ -21,6 +21,7 @@
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "atomic.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/logging.h"
@@ -61,10 +62,17 @@ inline void DexCache::SetResolvedType(uint32_t type_idx, Class* resolved) {
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
 
+inline uint32_t DexCache::FieldSlotIndex(uint32_t field_idx) {
+  const uint32_t slot_idx = field_idx % kDexCacheFieldCacheSize;
+  DCHECK_LT(slot_idx, NumResolvedFields());
+  return slot_idx;
+}
+
 inline ArtField* DexCache::GetResolvedField(uint32_t field_idx, PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
-  DCHECK_LT(field_idx, NumResolvedFields());  // NOTE: Unchecked, i.e. not throwing AIOOB.
-  ArtField* field = GetElementPtrSize(GetResolvedFields(), field_idx, ptr_size);
+  FieldDexCachePair pair =
+      GetFieldPairPtrSize(GetResolvedFields(), FieldSlotIndex(field_idx), ptr_size);
+  ArtField* field = pair.GetFieldForIndex(field_idx);
   if (field == nullptr || field->GetDeclaringClass()->IsErroneous()) {
     return nullptr;
   }
@@ -73,8 +81,10 @@ inline ArtField* DexCache::GetResolvedField(uint32_t field_idx, PointerSize ptr_
 
 inline void DexCache::SetResolvedField(uint32_t field_idx, ArtField* field, PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
-  DCHECK_LT(field_idx, NumResolvedFields());  // NOTE: Unchecked, i.e. not throwing AIOOB.
-  SetElementPtrSize(GetResolvedFields(), field_idx, field, ptr_size);
+  SetFieldPairPtrSize(GetResolvedFields(),
+                      FieldSlotIndex(field_idx),
+                      FieldDexCachePair(field, field_idx),
+                      ptr_size);
 }
 
 inline ArtMethod* DexCache::GetResolvedMethod(uint32_t method_idx, PointerSize ptr_size) {
@@ -122,6 +132,48 @@ inline void DexCache::SetElementPtrSize(PtrType* ptr_array,
   }
 }
 
+inline FieldDexCachePair DexCache::GetFieldPairPtrSize(FieldDexCachePair* pair_array,
+                                                       size_t idx,
+                                                       PointerSize ptr_size) {
+  if (ptr_size == PointerSize::k64) {
+    auto* addr = reinterpret_cast<volatile int64_t*>(pair_array) + 2u * idx;
+    int64_t first;
+    int64_t second;
+    QuasiAtomic::Read128(addr, &first, &second);
+    uintptr_t field = dchecked_integral_cast<uintptr_t>(static_cast<uint64_t>(first));
+    return FieldDexCachePair(reinterpret_cast<ArtField*>(field),
+                             dchecked_integral_cast<uint32_t>(static_cast<uint64_t>(second)));
+  } else {
+    // The pointer is the first 32-bit word of the pair, i.e. the low half on little-endian.
+    auto* addr = reinterpret_cast<volatile int64_t*>(pair_array) + idx;
+    uint64_t value = static_cast<uint64_t>(QuasiAtomic::Read64(addr));
+    return FieldDexCachePair(
+        reinterpret_cast<ArtField*>(static_cast<uintptr_t>(static_cast<uint32_t>(value))),
+        static_cast<uint32_t>(value >> 32));
+  }
+}
+
+inline void DexCache::SetFieldPairPtrSize(FieldDexCachePair* pair_array,
+                                          size_t idx,
+                                          FieldDexCachePair pair,
+                                          PointerSize ptr_size) {
+  if (ptr_size == PointerSize::k64) {
+    auto* addr = reinterpret_cast<volatile int64_t*>(pair_array) + 2u * idx;
+    QuasiAtomic::Write128(
+        addr,
+        static_cast<int64_t>(dchecked_integral_cast<uint64_t>(
+            reinterpret_cast<uintptr_t>(pair.field))),
+        static_cast<int64_t>(dchecked_integral_cast<uint64_t>(pair.index)));
+  } else {
+    auto* addr = reinterpret_cast<volatile int64_t*>(pair_array) + idx;
+    uint64_t value =
+        static_cast<uint64_t>(dchecked_integral_cast<uint32_t>(
+            reinterpret_cast<uintptr_t>(pair.field))) |
+        (static_cast<uint64_t>(dchecked_integral_cast<uint32_t>(pair.index)) << 32);
+    QuasiAtomic::Write64(addr, static_cast<int64_t>(value));
+  }
+}
+
 template <bool kVisitNativeRoots,
           VerifyObjectFlags kVerifyFlags,
           ReadBarrierOption kReadBarrierOption,
@@ -39,7 +39,7 @@ void DexCache::Init(const DexFile* dex_file,
                     uint32_t num_resolved_types,
                     ArtMethod** resolved_methods,
                     uint32_t num_resolved_methods,
-                    ArtField** resolved_fields,
+                    FieldDexCachePair* resolved_fields,
                     uint32_t num_resolved_fields,
                     PointerSize pointer_size) {
   CHECK(dex_file != nullptr);
@@ -48,6 +48,7 @@ void DexCache::Init(const DexFile* dex_file,
   CHECK_EQ(num_resolved_types != 0u, resolved_types != nullptr);
   CHECK_EQ(num_resolved_methods != 0u, resolved_methods != nullptr);
   CHECK_EQ(num_resolved_fields != 0u, resolved_fields != nullptr);
+  CHECK_LE(num_resolved_fields, kDexCacheFieldCacheSize);
 
   SetDexFile(dex_file);
   SetLocation(location);
@@ -35,9 +35,31 @@ namespace mirror {
 
 class String;
 
+// A resolved field together with its dex field index. DexCache keeps these pairs in a fixed-size
+// array indexed by the field index modulo the array size, so the stored index tells which of the
+// colliding fields the slot currently holds. A zero-initialized slot reads as index 0 with no
+// field, i.e. unresolved.
+struct FieldDexCachePair {
+  ArtField* field;
+  // Pointer-sized so that the pair is twice the pointer size and can be accessed atomically.
+  uintptr_t index;
+
+  FieldDexCachePair(ArtField* f, uint32_t idx) : field(f), index(idx) {}
+  FieldDexCachePair() : FieldDexCachePair(nullptr, 0u) {}
+
+  ArtField* GetFieldForIndex(uint32_t idx) const {
+    return (index == idx) ? field : nullptr;
+  }
+};
+
 // C++ mirror of java.lang.DexCache.
 class MANAGED DexCache FINAL : public Object {
  public:
+  // Number of slots in the resolved fields array; dex files with fewer field ids use fewer.
+  static constexpr size_t kDexCacheFieldCacheSize = 1024;
+  static_assert(IsPowerOfTwo(kDexCacheFieldCacheSize),
+                "Field dex cache size is not a power of 2.");
+
   // Size of java.lang.DexCache.class.
   static uint32_t ClassSize(PointerSize pointer_size);
 
@@ -54,7 +76,7 @@ class MANAGED DexCache FINAL : public Object {
             uint32_t num_resolved_types,
             ArtMethod** resolved_methods,
             uint32_t num_resolved_methods,
-            ArtField** resolved_fields,
+            FieldDexCachePair* resolved_fields,
             uint32_t num_resolved_fields,
             PointerSize pointer_size) SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -163,11 +185,11 @@ class MANAGED DexCache FINAL : public Object {
     SetFieldPtr<false>(ResolvedMethodsOffset(), resolved_methods);
   }
 
-  ArtField** GetResolvedFields() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
-    return GetFieldPtr<ArtField**>(ResolvedFieldsOffset());
+  FieldDexCachePair* GetResolvedFields() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+    return GetFieldPtr<FieldDexCachePair*>(ResolvedFieldsOffset());
   }
 
-  void SetResolvedFields(ArtField** resolved_fields)
+  void SetResolvedFields(FieldDexCachePair* resolved_fields)
       ALWAYS_INLINE
       SHARED_REQUIRES(Locks::mutator_lock_) {
     SetFieldPtr<false>(ResolvedFieldsOffset(), resolved_fields);
@@ -199,9 +221,13 @@ class MANAGED DexCache FINAL : public Object {
 
   void SetLocation(mirror::String* location) SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // NOTE: Get/SetElementPtrSize() are intended for working with ArtMethod** and ArtField**
-  // provided by GetResolvedMethods/Fields() and ArtMethod::GetDexCacheResolvedMethods(),
-  // so they need to be public.
+  // Number of resolved fields slots needed for a dex file with `num_field_ids` field ids.
+  static constexpr size_t NumResolvedFieldsFor(size_t num_field_ids) {
+    return (num_field_ids < kDexCacheFieldCacheSize) ? num_field_ids : kDexCacheFieldCacheSize;
+  }
+
+  // NOTE: Get/SetElementPtrSize() are intended for working with ArtMethod** provided by
+  // GetResolvedMethods() and ArtMethod::GetDexCacheResolvedMethods(), so they need to be public.
 
   template <typename PtrType>
   static PtrType GetElementPtrSize(PtrType* ptr_array, size_t idx, PointerSize ptr_size);
@@ -209,6 +235,17 @@ class MANAGED DexCache FINAL : public Object {
   template <typename PtrType>
   static void SetElementPtrSize(PtrType* ptr_array, size_t idx, PtrType ptr, PointerSize ptr_size);
 
+  // Atomically read or write the pair in slot `idx` of a resolved fields array laid out for
+  // `ptr_size`. Public for the same reason as Get/SetElementPtrSize().
+  static FieldDexCachePair GetFieldPairPtrSize(FieldDexCachePair* pair_array,
+                                               size_t idx,
+                                               PointerSize ptr_size);
+
+  static void SetFieldPairPtrSize(FieldDexCachePair* pair_array,
+                                  size_t idx,
+                                  FieldDexCachePair pair,
+                                  PointerSize ptr_size);
+
  private:
   // Visit instance fields of the dex cache as well as its associated arrays.
   template <bool kVisitNativeRoots,
@@ -218,14 +255,17 @@ class MANAGED DexCache FINAL : public Object {
   void VisitReferences(mirror::Class* klass, const Visitor& visitor)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
 
+  uint32_t FieldSlotIndex(uint32_t field_idx) SHARED_REQUIRES(Locks::mutator_lock_);
+
   HeapReference<Object> dex_;
   HeapReference<String> location_;
   uint64_t dex_file_;           // const DexFile*
-  uint64_t resolved_fields_;    // ArtField*, array with num_resolved_fields_ elements.
+  uint64_t resolved_fields_;    // FieldDexCachePair*, array with num_resolved_fields_ elements.
   uint64_t resolved_methods_;   // ArtMethod*, array with num_resolved_methods_ elements.
   uint64_t resolved_types_;     // GcRoot<Class>*, array with num_resolved_types_ elements.
   uint64_t strings_;            // GcRoot<String>*, array with num_strings_ elements.
   uint32_t num_resolved_fields_;    // Number of elements in the resolved_fields_ array.
+                                    // At most kDexCacheFieldCacheSize.
   uint32_t num_resolved_methods_;   // Number of elements in the resolved_methods_ array.
   uint32_t num_resolved_types_;     // Number of elements in the resolved_types_ array.
   uint32_t num_strings_;            // Number of elements in the strings_ array.
@@ -21,7 +21,9 @@
 #include "class_linker.h"
 #include "common_runtime_test.h"
 #include "linear_alloc.h"
+#include "mirror/class-inl.h"
 #include "mirror/class_loader-inl.h"
+#include "mirror/dex_cache-inl.h"
 #include "handle_scope-inl.h"
 #include "scoped_thread_state_change.h"
 
@@ -43,7 +45,42 @@ TEST_F(DexCacheTest, Open) {
   EXPECT_EQ(java_lang_dex_file_->NumStringIds(), dex_cache->NumStrings());
   EXPECT_EQ(java_lang_dex_file_->NumTypeIds(),   dex_cache->NumResolvedTypes());
   EXPECT_EQ(java_lang_dex_file_->NumMethodIds(), dex_cache->NumResolvedMethods());
-  EXPECT_EQ(java_lang_dex_file_->NumFieldIds(),  dex_cache->NumResolvedFields());
+  EXPECT_EQ(DexCache::NumResolvedFieldsFor(java_lang_dex_file_->NumFieldIds()),
+            dex_cache->NumResolvedFields());
+}
+
+TEST_F(DexCacheTest, ResolvedFieldCollisions) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  ASSERT_TRUE(java_lang_dex_file_ != nullptr);
+  ASSERT_GT(java_lang_dex_file_->NumFieldIds(), DexCache::kDexCacheFieldCacheSize);
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocDexCache(soa.Self(),
+                                                *java_lang_dex_file_,
+                                                Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache.Get() != nullptr);
+  EXPECT_EQ(DexCache::kDexCacheFieldCacheSize, dex_cache->NumResolvedFields());
+  Handle<Class> string_class(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/String;")));
+  ASSERT_TRUE(string_class.Get() != nullptr);
+  ASSERT_GE(string_class->NumInstanceFields(), 2u);
+  ArtField* field = string_class->GetInstanceField(0);
+  ArtField* other_field = string_class->GetInstanceField(1);
+
+  const PointerSize pointer_size = class_linker_->GetImagePointerSize();
+  const uint32_t field_idx = 1u;
+  const uint32_t colliding_idx = field_idx + DexCache::kDexCacheFieldCacheSize;
+  EXPECT_TRUE(dex_cache->GetResolvedField(field_idx, pointer_size) == nullptr);
+  dex_cache->SetResolvedField(field_idx, field, pointer_size);
+  EXPECT_EQ(field, dex_cache->GetResolvedField(field_idx, pointer_size));
+  // The colliding index shares the slot but must not see the other index' field.
+  EXPECT_TRUE(dex_cache->GetResolvedField(colliding_idx, pointer_size) == nullptr);
+  // Resolving the colliding index evicts the first field.
+  dex_cache->SetResolvedField(colliding_idx, other_field, pointer_size);
+  EXPECT_EQ(other_field, dex_cache->GetResolvedField(colliding_idx, pointer_size));
+  EXPECT_TRUE(dex_cache->GetResolvedField(field_idx, pointer_size) == nullptr);
+  // Neighbouring slots are unaffected.
+  EXPECT_TRUE(dex_cache->GetResolvedField(field_idx + 1u, pointer_size) == nullptr);
 }
 
 TEST_F(DexCacheTest, LinearAlloc) {
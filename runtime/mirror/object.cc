@@ -161,6 +161,16 @@ int32_t Object::IdentityHashCode() const {
     LockWord lw = current_this->GetLockWord(false);
     switch (lw.GetState()) {
       case LockWord::kUnlocked: {
+        ThinLockHashTable* thin_lock_hashes =
+            Runtime::Current()->GetMonitorList()->GetThinLockHashes();
+        if (thin_lock_hashes != nullptr) {
+          // The object may have been hashed while thin locked.
+          int32_t hash_code;
+          if (thin_lock_hashes->HashUnlocked(Thread::Current(), current_this, lw, &hash_code)) {
+            return hash_code;
+          }
+          break;
+        }
         // Try to compare and swap in a new hash, if we succeed we will return the hash on the next
         // loop iteration.
         LockWord hash_word = LockWord::FromHashCode(GenerateIdentityHashCode(), lw.GCState());
@@ -171,9 +181,20 @@ int32_t Object::IdentityHashCode() const {
         break;
       }
       case LockWord::kThinLocked: {
+        Thread* self = Thread::Current();
+        ThinLockHashTable* thin_lock_hashes =
+            Runtime::Current()->GetMonitorList()->GetThinLockHashes();
+        if (thin_lock_hashes != nullptr) {
+          // Keep the hash code next to the thin lock, without suspending its owner. Fails if the
+          // object was unlocked in the meantime.
+          int32_t hash_code;
+          if (thin_lock_hashes->HashThinLocked(self, current_this, &hash_code)) {
+            return hash_code;
+          }
+          break;
+        }
         // Inflate the thin lock to a monitor and stick the hash code inside of the monitor. May
         // fail spuriously.
-        Thread* self = Thread::Current();
         StackHandleScope<1> hs(self);
         Handle<mirror::Object> h_this(hs.NewHandle(current_this));
         Monitor::InflateThinLocked(self, h_this, lw, GenerateIdentityHashCode());
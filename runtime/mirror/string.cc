@@ -131,6 +131,19 @@ String* String::AllocFromModifiedUtf8(Thread* self, int32_t utf16_length,
   return string;
 }
 
+String* String::AllocHashedFromModifiedUtf8(Thread* self, int32_t utf16_length,
+                                            const char* utf8_data_in) {
+  gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
+  SetStringCountVisitor visitor(utf16_length);
+  String* string = Alloc<true>(self, utf16_length, allocator_type, visitor);
+  if (UNLIKELY(string == nullptr)) {
+    return nullptr;
+  }
+  string->SetHashCode(ConvertModifiedUtf8ToUtf16AndComputeHash(
+      string->GetValue(), utf16_length, utf8_data_in, strlen(utf8_data_in)));
+  return string;
+}
+
 bool String::Equals(String* that) {
   if (this == that) {
     // Quick reference equality test
@@ -123,6 +123,12 @@ class MANAGED String FINAL : public Object {
   static String* AllocFromModifiedUtf8(Thread* self, int32_t utf16_length, const char* utf8_data_in)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Roles::uninterruptible_);
 
+  // Like AllocFromModifiedUtf8 but also sets the hash code, computed while converting the chars.
+  // For strings that are about to be hashed anyway, such as the interned ones.
+  static String* AllocHashedFromModifiedUtf8(Thread* self, int32_t utf16_length,
+                                             const char* utf8_data_in)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!Roles::uninterruptible_);
+
   // TODO: This is only used in the interpreter to compare against
   // entries from a dex files constant pool (ArtField names). Should
   // we unify this with Equals(const StringPiece&); ?
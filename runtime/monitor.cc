@@ -16,9 +16,13 @@
 
 #include "monitor.h"
 
+#include <unistd.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "art_method-inl.h"
+#include "base/contention_profiler.h"
 #include "base/mutex.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
@@ -40,6 +44,12 @@ namespace art {
 
 static constexpr uint64_t kLongWaitMs = 100;
 
+// Bounds for Monitor::spin_limit_. Each poll of the owner takes a few tens of cycles, so this
+// spins for up to a few tens of microseconds.
+static constexpr uint32_t kInitialSpinLimit = 128;
+static constexpr uint32_t kMinSpinLimit = 8;
+static constexpr uint32_t kMaxSpinLimit = 4096;
+
 /*
  * Every Object has a monitor associated with it, but not every Object is actually locked.  Even
  * the ones that are locked do not need a full-fledged monitor until a) there is actual contention
@@ -79,11 +89,13 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialSpinLimit),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      lock_time_ns_(0u),
       monitor_id_(MonitorPool::ComputeMonitorId(this, self)) {
 #ifdef __LP64__
   DCHECK(false) << "Should not be reached in 64b";
@@ -102,11 +114,13 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialSpinLimit),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
       locking_method_(nullptr),
       locking_dex_pc_(0),
+      lock_time_ns_(0u),
       monitor_id_(id) {
 #ifdef __LP64__
   next_free_ = nullptr;
@@ -129,12 +143,13 @@ int32_t Monitor::GetHashCode() {
 
 bool Monitor::Install(Thread* self) {
   MutexLock mu(self, monitor_lock_);  // Uncontended mutex acquisition as monitor isn't yet public.
-  CHECK(owner_ == nullptr || owner_ == self || owner_->IsSuspended());
+  Thread* const owner = owner_.LoadRelaxed();
+  CHECK(owner == nullptr || owner == self || owner->IsSuspended());
   // Propagate the lock state.
   LockWord lw(GetObject()->GetLockWord(false));
   switch (lw.GetState()) {
     case LockWord::kThinLocked: {
-      CHECK_EQ(owner_->GetThreadId(), lw.ThinLockOwner());
+      CHECK_EQ(owner->GetThreadId(), lw.ThinLockOwner());
       lock_count_ = lw.ThinLockCount();
       break;
     }
@@ -157,12 +172,19 @@ bool Monitor::Install(Thread* self) {
   }
   LockWord fat(this, lw.GCState());
   // Publish the updated lock word, which may race with other threads.
-  bool success = GetObject()->CasLockWordWeakSequentiallyConsistent(lw, fat);
+  bool success;
+  ThinLockHashTable* thin_lock_hashes = Runtime::Current()->GetMonitorList()->GetThinLockHashes();
+  if (lw.GetState() == LockWord::kThinLocked && thin_lock_hashes != nullptr) {
+    // Take over the hash code the object may have got while thin locked.
+    success = thin_lock_hashes->PublishMonitor(self, GetObject(), lw, fat, &hash_code_);
+  } else {
+    success = GetObject()->CasLockWordWeakSequentiallyConsistent(lw, fat);
+  }
   // Lock profiling.
-  if (success && owner_ != nullptr && lock_profiling_threshold_ != 0) {
+  if (success && owner != nullptr && lock_profiling_threshold_ != 0) {
     // Do not abort on dex pc errors. This can easily happen when we want to dump a stack trace on
     // abort.
-    locking_method_ = owner_->GetCurrentMethod(&locking_dex_pc_, false);
+    locking_method_ = owner->GetCurrentMethod(&locking_dex_pc_, false);
   }
   return success;
 }
@@ -172,7 +194,7 @@ Monitor::~Monitor() {
 }
 
 void Monitor::AppendToWaitSet(Thread* thread) {
-  DCHECK(owner_ == Thread::Current());
+  DCHECK(owner_.LoadRelaxed() == Thread::Current());
   DCHECK(thread != nullptr);
   DCHECK(thread->GetWaitNext() == nullptr) << thread->GetWaitNext();
   if (wait_set_ == nullptr) {
@@ -189,7 +211,7 @@ void Monitor::AppendToWaitSet(Thread* thread) {
 }
 
 void Monitor::RemoveFromWaitSet(Thread *thread) {
-  DCHECK(owner_ == Thread::Current());
+  DCHECK(owner_.LoadRelaxed() == Thread::Current());
   DCHECK(thread != nullptr);
   if (wait_set_ == nullptr) {
     return;
@@ -315,15 +337,17 @@ std::string Monitor::PrettyContentionInfo(const std::string& owner_name,
 }
 
 bool Monitor::TryLockLocked(Thread* self) {
-  if (owner_ == nullptr) {  // Unowned.
-    owner_ = self;
+  if (owner_.LoadRelaxed() == nullptr) {  // Unowned.
+    owner_.StoreRelaxed(self);
     CHECK_EQ(lock_count_, 0);
     // When debugging, save the current monitor holder for future
     // acquisition failures to use in sampled logging.
-    if (lock_profiling_threshold_ != 0) {
+    const bool profile_contention = ContentionProfiler::IsEnabled();
+    if (lock_profiling_threshold_ != 0 || profile_contention) {
       locking_method_ = self->GetCurrentMethod(&locking_dex_pc_);
     }
-  } else if (owner_ == self) {  // Recursive.
+    lock_time_ns_ = profile_contention ? NanoTime() : 0u;
+  } else if (owner_.LoadRelaxed() == self) {  // Recursive.
     lock_count_++;
   } else {
     return false;
@@ -337,15 +361,48 @@ bool Monitor::TryLock(Thread* self) {
   return TryLockLocked(self);
 }
 
+static inline void SpinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+bool Monitor::SpinLocked(Thread* self) {
+  static const bool multi_processor = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+  // The owner cannot go away while we hold monitor_lock_. Only spin if it is running, otherwise
+  // it is unlikely to release the lock before we would give up.
+  Thread* const owner = owner_.LoadRelaxed();
+  if (!multi_processor || owner == nullptr || owner->GetState() != kRunnable) {
+    return false;
+  }
+  const uint32_t spin_limit = spin_limit_;
+  // Count ourselves as a waiter while monitor_lock_ is released, like the blocking path.
+  ++num_waiters_;
+  monitor_lock_.Unlock(self);
+  // Stop early on a suspend or checkpoint request, we must not delay it while runnable.
+  for (uint32_t i = 0; i != spin_limit && GetOwner() != nullptr && !self->TestAllFlags(); ++i) {
+    SpinPause();
+  }
+  monitor_lock_.Lock(self);
+  --num_waiters_;
+  const bool acquired = TryLockLocked(self);
+  spin_limit_ = acquired ? std::min(2u * spin_limit, kMaxSpinLimit)
+                         : std::max(spin_limit / 2u, kMinSpinLimit);
+  return acquired;
+}
+
 void Monitor::Lock(Thread* self) {
   MutexLock mu(self, monitor_lock_);
   while (true) {
-    if (TryLockLocked(self)) {
+    if (TryLockLocked(self) || SpinLocked(self)) {
       return;
     }
     // Contended.
     const bool log_contention = (lock_profiling_threshold_ != 0);
     uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
+    uint64_t profile_start_ns = ContentionProfiler::IsEnabled() ? NanoTime() : 0u;
     ArtMethod* owners_method = locking_method_;
     uint32_t owners_dex_pc = locking_dex_pc_;
     // Do this before releasing the lock so that we don't get deflated.
@@ -359,14 +416,15 @@ void Monitor::Lock(Thread* self) {
       {
         // Reacquire monitor_lock_ without mutator_lock_ for Wait.
         MutexLock mu2(self, monitor_lock_);
-        if (owner_ != nullptr) {  // Did the owner_ give the lock up?
-          original_owner_thread_id = owner_->GetThreadId();
+        Thread* const owner = owner_.LoadRelaxed();
+        if (owner != nullptr) {  // Did the owner_ give the lock up?
+          original_owner_thread_id = owner->GetThreadId();
           if (ATRACE_ENABLED()) {
             std::ostringstream oss;
             std::string name;
-            owner_->GetThreadName(name);
+            owner->GetThreadName(name);
             oss << PrettyContentionInfo(name,
-                                        owner_->GetTid(),
+                                        owner->GetTid(),
                                         owners_method,
                                         owners_dex_pc,
                                         num_waiters);
@@ -440,6 +498,13 @@ void Monitor::Lock(Thread* self) {
       }
     }
     self->SetMonitorEnterObject(nullptr);
+    if (profile_start_ns != 0u) {
+      uint32_t pc;
+      ArtMethod* m = self->GetCurrentMethod(&pc);
+      ContentionProfiler::RecordMonitorWait(PrettyLocation(owners_method, owners_dex_pc),
+                                            PrettyLocation(m, pc),
+                                            NanoTime() - profile_start_ns);
+    }
     monitor_lock_.Lock(self);  // Reacquire locks in order.
     --num_waiters_;
   }
@@ -544,9 +609,14 @@ void Monitor::FailedUnlock(mirror::Object* o,
 bool Monitor::Unlock(Thread* self) {
   DCHECK(self != nullptr);
   uint32_t owner_thread_id = 0u;
+  bool unlocked = false;
+  // Set if the ContentionProfiler wants the hold time of this lock.
+  ArtMethod* held_method = nullptr;
+  uint32_t held_dex_pc = 0u;
+  uint64_t hold_ns = 0u;
   {
     MutexLock mu(self, monitor_lock_);
-    Thread* owner = owner_;
+    Thread* owner = owner_.LoadRelaxed();
     if (owner != nullptr) {
       owner_thread_id = owner->GetThreadId();
     }
@@ -554,17 +624,29 @@ bool Monitor::Unlock(Thread* self) {
       // We own the monitor, so nobody else can be in here.
       AtraceMonitorUnlock();
       if (lock_count_ == 0) {
-        owner_ = nullptr;
+        if (lock_time_ns_ != 0u && num_waiters_ != 0u) {
+          held_method = locking_method_;
+          held_dex_pc = locking_dex_pc_;
+          hold_ns = NanoTime() - lock_time_ns_;
+        }
+        owner_.StoreRelaxed(nullptr);
         locking_method_ = nullptr;
         locking_dex_pc_ = 0;
+        lock_time_ns_ = 0u;
         // Wake a contender.
         monitor_contenders_.Signal(self);
       } else {
         --lock_count_;
       }
-      return true;
+      unlocked = true;
     }
   }
+  if (unlocked) {
+    if (hold_ns != 0u) {
+      ContentionProfiler::RecordMonitorHold(PrettyLocation(held_method, held_dex_pc), hold_ns);
+    }
+    return true;
+  }
   // We don't own this, so we're not allowed to unlock it.
   // The JNI spec says that we should throw IllegalMonitorStateException in this case.
   FailedUnlock(GetObject(), self->GetThreadId(), owner_thread_id, this);
@@ -579,7 +661,7 @@ void Monitor::Wait(Thread* self, int64_t ms, int32_t ns,
   monitor_lock_.Lock(self);
 
   // Make sure that we hold the lock.
-  if (owner_ != self) {
+  if (owner_.LoadRelaxed() != self) {
     monitor_lock_.Unlock(self);
     ThrowIllegalMonitorStateExceptionF("object not locked by thread before wait()");
     return;
@@ -613,7 +695,7 @@ void Monitor::Wait(Thread* self, int64_t ms, int32_t ns,
   ++num_waiters_;
   int prev_lock_count = lock_count_;
   lock_count_ = 0;
-  owner_ = nullptr;
+  owner_.StoreRelaxed(nullptr);
   ArtMethod* saved_method = locking_method_;
   locking_method_ = nullptr;
   uintptr_t saved_dex_pc = locking_dex_pc_;
@@ -700,7 +782,7 @@ void Monitor::Wait(Thread* self, int64_t ms, int32_t ns,
    * thread owns the monitor. Aside from that, the order of member
    * updates is not order sensitive as we hold the pthread mutex.
    */
-  owner_ = self;
+  owner_.StoreRelaxed(self);
   lock_count_ = prev_lock_count;
   locking_method_ = saved_method;
   locking_dex_pc_ = saved_dex_pc;
@@ -714,7 +796,7 @@ void Monitor::Notify(Thread* self) {
   DCHECK(self != nullptr);
   MutexLock mu(self, monitor_lock_);
   // Make sure that we hold the lock.
-  if (owner_ != self) {
+  if (owner_.LoadRelaxed() != self) {
     ThrowIllegalMonitorStateExceptionF("object not locked by thread before notify()");
     return;
   }
@@ -737,7 +819,7 @@ void Monitor::NotifyAll(Thread* self) {
   DCHECK(self != nullptr);
   MutexLock mu(self, monitor_lock_);
   // Make sure that we hold the lock.
-  if (owner_ != self) {
+  if (owner_.LoadRelaxed() != self) {
     ThrowIllegalMonitorStateExceptionF("object not locked by thread before notifyAll()");
     return;
   }
@@ -763,10 +845,13 @@ bool Monitor::Deflate(Thread* self, mirror::Object* obj) {
     if (monitor->num_waiters_ > 0) {
       return false;
     }
-    Thread* owner = monitor->owner_;
+    Thread* owner = monitor->owner_.LoadRelaxed();
+    ThinLockHashTable* thin_lock_hashes =
+        Runtime::Current()->GetMonitorList()->GetThinLockHashes();
     if (owner != nullptr) {
-      // Can't deflate if we are locked and have a hash code.
-      if (monitor->HasHashCode()) {
+      // Can't deflate if we are locked and have a hash code, unless the hash code can be kept
+      // with the thin locks.
+      if (monitor->HasHashCode() && thin_lock_hashes == nullptr) {
         return false;
       }
       // Can't deflate if our lock count is too high.
@@ -779,6 +864,9 @@ bool Monitor::Deflate(Thread* self, mirror::Object* obj) {
                                                  lw.GCState());
       // Assume no concurrent read barrier state changes as mutators are suspended.
       obj->SetLockWord(new_lw, false);
+      if (monitor->HasHashCode()) {
+        thin_lock_hashes->AddDeflated(self, obj, monitor->GetHashCode());
+      }
       VLOG(monitor) << "Deflated " << obj << " to thin lock " << owner->GetTid() << " / "
           << monitor->lock_count_;
     } else if (monitor->HasHashCode()) {
@@ -796,6 +884,13 @@ bool Monitor::Deflate(Thread* self, mirror::Object* obj) {
     // The monitor is deflated, mark the object as null so that we know to delete it during the
     // next GC.
     monitor->obj_ = GcRoot<mirror::Object>(nullptr);
+  } else if (lw.GetState() == LockWord::kUnlocked) {
+    ThinLockHashTable* thin_lock_hashes =
+        Runtime::Current()->GetMonitorList()->GetThinLockHashes();
+    if (thin_lock_hashes != nullptr) {
+      // The hash code it got while thin locked.
+      thin_lock_hashes->Deflate(self, obj);
+    }
   }
   return true;
 }
@@ -878,9 +973,8 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
     switch (lock_word.GetState()) {
       case LockWord::kUnlocked: {
         LockWord thin_locked(LockWord::FromThinLockId(thread_id, 0, lock_word.GCState()));
-        if (h_obj->CasLockWordWeakSequentiallyConsistent(lock_word, thin_locked)) {
+        if (h_obj->CasLockWordWeakAcquire(lock_word, thin_locked)) {
           AtraceMonitorLock(self, h_obj.Get(), false /* is_wait */);
-          // CasLockWord enforces more than the acquire ordering we need here.
           return h_obj.Get();  // Success!
         }
         continue;  // Go again.
@@ -894,13 +988,15 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
             LockWord thin_locked(LockWord::FromThinLockId(thread_id,
                                                           new_count,
                                                           lock_word.GCState()));
+            // We already hold the lock, so this needs no ordering. Other threads only change a
+            // thin lock we own after suspending us, except for the read barrier state.
             if (!kUseReadBarrier) {
-              h_obj->SetLockWord(thin_locked, true);
+              h_obj->SetLockWord(thin_locked, false);
               AtraceMonitorLock(self, h_obj.Get(), false /* is_wait */);
               return h_obj.Get();  // Success!
             } else {
               // Use CAS to preserve the read barrier state.
-              if (h_obj->CasLockWordWeakSequentiallyConsistent(lock_word, thin_locked)) {
+              if (h_obj->CasLockWordWeakRelaxed(lock_word, thin_locked)) {
                 AtraceMonitorLock(self, h_obj.Get(), false /* is_wait */);
                 return h_obj.Get();  // Success!
               }
@@ -939,10 +1035,21 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
           return h_obj.Get();  // Success!
         }
       }
-      case LockWord::kHashCode:
-        // Inflate with the existing hashcode.
-        Inflate(self, nullptr, h_obj.Get(), lock_word.GetHashCode());
+      case LockWord::kHashCode: {
+        ThinLockHashTable* thin_lock_hashes =
+            Runtime::Current()->GetMonitorList()->GetThinLockHashes();
+        if (thin_lock_hashes != nullptr) {
+          // Thin lock it, the hash code moves to the table.
+          if (thin_lock_hashes->LockHashed(self, h_obj.Get(), lock_word)) {
+            AtraceMonitorLock(self, h_obj.Get(), false /* is_wait */);
+            return h_obj.Get();  // Success!
+          }
+        } else {
+          // Inflate with the existing hashcode.
+          Inflate(self, nullptr, h_obj.Get(), lock_word.GetHashCode());
+        }
         continue;  // Start from the beginning.
+      }
       default: {
         LOG(FATAL) << "Invalid monitor state " << lock_word.GetState();
         UNREACHABLE();
@@ -975,7 +1082,9 @@ bool Monitor::MonitorExit(Thread* self, mirror::Object* obj) {
         } else {
           // We own the lock, decrease the recursion count.
           LockWord new_lw = LockWord::Default();
-          if (lock_word.ThinLockCount() != 0) {
+          // Only the final unlock publishes our writes, the recursive ones need no ordering.
+          const bool release = lock_word.ThinLockCount() == 0;
+          if (!release) {
             uint32_t new_count = lock_word.ThinLockCount() - 1;
             new_lw = LockWord::FromThinLockId(thread_id, new_count, lock_word.GCState());
           } else {
@@ -983,13 +1092,15 @@ bool Monitor::MonitorExit(Thread* self, mirror::Object* obj) {
           }
           if (!kUseReadBarrier) {
             DCHECK_EQ(new_lw.ReadBarrierState(), 0U);
-            h_obj->SetLockWord(new_lw, true);
+            h_obj->SetLockWord(new_lw, /* as_volatile */ release);
             AtraceMonitorUnlock();
             // Success!
             return true;
           } else {
             // Use CAS to preserve the read barrier state.
-            if (h_obj->CasLockWordWeakSequentiallyConsistent(lock_word, new_lw)) {
+            bool success = release ? h_obj->CasLockWordWeakRelease(lock_word, new_lw)
+                                   : h_obj->CasLockWordWeakRelaxed(lock_word, new_lw);
+            if (success) {
               AtraceMonitorUnlock();
               // Success!
               return true;
@@ -1263,7 +1374,7 @@ bool Monitor::IsValidLockWord(LockWord lock_word) {
 
 bool Monitor::IsLocked() SHARED_REQUIRES(Locks::mutator_lock_) {
   MutexLock mu(Thread::Current(), monitor_lock_);
-  return owner_ != nullptr;
+  return owner_.LoadRelaxed() != nullptr;
 }
 
 void Monitor::TranslateLocation(ArtMethod* method,
@@ -1283,9 +1394,19 @@ void Monitor::TranslateLocation(ArtMethod* method,
   *line_number = method->GetLineNumFromDexPC(dex_pc);
 }
 
+std::string Monitor::PrettyLocation(ArtMethod* method, uint32_t dex_pc) {
+  if (method == nullptr) {
+    return "<unknown>";
+  }
+  const char* source_file;
+  int32_t line_number;
+  TranslateLocation(method, dex_pc, &source_file, &line_number);
+  return StringPrintf("%s(%s:%d)", PrettyMethod(method).c_str(), source_file, line_number);
+}
+
 uint32_t Monitor::GetOwnerThreadId() {
   MutexLock mu(Thread::Current(), monitor_lock_);
-  Thread* owner = owner_;
+  Thread* owner = owner_.LoadRelaxed();
   if (owner != nullptr) {
     return owner->GetThreadId();
   } else {
@@ -1311,6 +1432,7 @@ void MonitorList::DisallowNewMonitors() {
   CHECK(!kUseReadBarrier);
   MutexLock mu(Thread::Current(), monitor_list_lock_);
   allow_new_monitors_ = false;
+  thin_lock_hashes_.DisallowNewEntries();
 }
 
 void MonitorList::AllowNewMonitors() {
@@ -1319,6 +1441,7 @@ void MonitorList::AllowNewMonitors() {
   MutexLock mu(self, monitor_list_lock_);
   allow_new_monitors_ = true;
   monitor_add_condition_.Broadcast(self);
+  thin_lock_hashes_.AllowNewEntries();
 }
 
 void MonitorList::BroadcastForNewMonitors() {
@@ -1378,13 +1501,212 @@ class MonitorDeflateVisitor : public IsMarkedVisitor {
   size_t deflate_count_;
 };
 
+size_t MonitorList::Size() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, monitor_list_lock_);
+  return list_.size();
+}
+
 size_t MonitorList::DeflateMonitors() {
   MonitorDeflateVisitor visitor;
   Locks::mutator_lock_->AssertExclusiveHeld(visitor.self_);
   SweepMonitorList(&visitor);
+  if (ThinLockHashTable::kEnabled) {
+    thin_lock_hashes_.DeflateAll(visitor.self_);
+  }
   return visitor.deflate_count_;
 }
 
+ThinLockHashTable::ThinLockHashTable()
+    : lock_("thin lock hash codes lock", kThinLockHashesLock),
+      new_entries_condition_("thin lock hash codes disallow condition", lock_),
+      allow_new_entries_(true),
+      num_entries_(0u),
+      num_lock_free_hashers_(0u) {
+}
+
+void ThinLockHashTable::ReserveEntry() {
+  num_entries_.FetchAndAddSequentiallyConsistent(1u);
+  // The lock free hashers check num_entries_ after announcing themselves, those still running
+  // may have seen no entry.
+  while (num_lock_free_hashers_.LoadSequentiallyConsistent() != 0u) {
+    sched_yield();
+  }
+}
+
+void ThinLockHashTable::UnreserveEntry() {
+  num_entries_.FetchAndSubSequentiallyConsistent(1u);
+}
+
+ThinLockHashTable::Entries::iterator ThinLockHashTable::RemoveEntry(Entries::iterator it) {
+  UnreserveEntry();
+  return entries_.erase(it);
+}
+
+void ThinLockHashTable::WaitForNewEntriesAllowed(Thread* self) {
+  while (UNLIKELY(!allow_new_entries_)) {
+    new_entries_condition_.WaitHoldingLocks(self);
+  }
+}
+
+bool ThinLockHashTable::HashUnlocked(Thread* self,
+                                     mirror::Object* obj,
+                                     LockWord lw,
+                                     int32_t* hash_code) {
+  DCHECK_EQ(lw.GetState(), LockWord::kUnlocked);
+  num_lock_free_hashers_.FetchAndAddSequentiallyConsistent(1u);
+  if (LIKELY(num_entries_.LoadSequentiallyConsistent() == 0u)) {
+    LockWord hash_word =
+        LockWord::FromHashCode(mirror::Object::GenerateIdentityHashCode(), lw.GCState());
+    bool success = obj->CasLockWordWeakRelaxed(lw, hash_word);
+    num_lock_free_hashers_.FetchAndSubSequentiallyConsistent(1u);
+    *hash_code = hash_word.GetHashCode();
+    return success;
+  }
+  num_lock_free_hashers_.FetchAndSubSequentiallyConsistent(1u);
+  MutexLock mu(self, lock_);
+  auto it = entries_.find(obj);
+  int32_t new_hash_code = (it != entries_.end())
+      ? it->second
+      : static_cast<int32_t>(mirror::Object::GenerateIdentityHashCode());
+  LockWord hash_word = LockWord::FromHashCode(new_hash_code, lw.GCState());
+  if (!obj->CasLockWordWeakRelaxed(lw, hash_word)) {
+    return false;
+  }
+  if (it != entries_.end()) {
+    RemoveEntry(it);
+  }
+  *hash_code = new_hash_code;
+  return true;
+}
+
+bool ThinLockHashTable::HashThinLocked(Thread* self, mirror::Object* obj, int32_t* hash_code) {
+  MutexLock mu(self, lock_);
+  auto it = entries_.find(obj);
+  if (it != entries_.end()) {
+    *hash_code = it->second;
+    return true;
+  }
+  WaitForNewEntriesAllowed(self);
+  ReserveEntry();
+  // Nobody can hash the object behind our back now, but the owner may have unlocked it.
+  if (obj->GetLockWord(true).GetState() != LockWord::kThinLocked) {
+    UnreserveEntry();
+    return false;
+  }
+  *hash_code = static_cast<int32_t>(mirror::Object::GenerateIdentityHashCode());
+  entries_.emplace(obj, *hash_code);
+  return true;
+}
+
+bool ThinLockHashTable::LockHashed(Thread* self, mirror::Object* obj, LockWord lw) {
+  DCHECK_EQ(lw.GetState(), LockWord::kHashCode);
+  MutexLock mu(self, lock_);
+  WaitForNewEntriesAllowed(self);
+  ReserveEntry();
+  LockWord thin_locked(LockWord::FromThinLockId(self->GetThreadId(), 0, lw.GCState()));
+  if (!obj->CasLockWordWeakAcquire(lw, thin_locked)) {
+    UnreserveEntry();
+    return false;
+  }
+  bool inserted = entries_.emplace(obj, static_cast<int32_t>(lw.GetHashCode())).second;
+  DCHECK(inserted) << obj;
+  return true;
+}
+
+bool ThinLockHashTable::PublishMonitor(Thread* self,
+                                       mirror::Object* obj,
+                                       LockWord thin_lw,
+                                       LockWord fat_lw,
+                                       AtomicInteger* monitor_hash_code) {
+  DCHECK_EQ(thin_lw.GetState(), LockWord::kThinLocked);
+  MutexLock mu(self, lock_);
+  auto it = entries_.find(obj);
+  if (it != entries_.end()) {
+    // The monitor is not public yet and thin locked objects get their hash codes here.
+    DCHECK_EQ(monitor_hash_code->LoadRelaxed(), 0);
+    monitor_hash_code->StoreRelaxed(it->second);
+  }
+  if (!obj->CasLockWordWeakSequentiallyConsistent(thin_lw, fat_lw)) {
+    return false;
+  }
+  if (it != entries_.end()) {
+    RemoveEntry(it);
+  }
+  return true;
+}
+
+void ThinLockHashTable::AddDeflated(Thread* self, mirror::Object* obj, int32_t hash_code) {
+  MutexLock mu(self, lock_);
+  ReserveEntry();
+  bool inserted = entries_.emplace(obj, hash_code).second;
+  DCHECK(inserted) << obj;
+}
+
+void ThinLockHashTable::Deflate(Thread* self, mirror::Object* obj) {
+  MutexLock mu(self, lock_);
+  auto it = entries_.find(obj);
+  if (it == entries_.end()) {
+    return;
+  }
+  LockWord lw(obj->GetLockWord(false));
+  if (lw.GetState() == LockWord::kUnlocked) {
+    // Assume no concurrent read barrier state changes as mutators are suspended.
+    obj->SetLockWord(LockWord::FromHashCode(it->second, lw.GCState()), false);
+    RemoveEntry(it);
+  }
+}
+
+void ThinLockHashTable::DeflateAll(Thread* self) {
+  MutexLock mu(self, lock_);
+  for (auto it = entries_.begin(); it != entries_.end(); ) {
+    mirror::Object* obj = it->first;
+    LockWord lw(obj->GetLockWord(false));
+    if (lw.GetState() == LockWord::kUnlocked) {
+      obj->SetLockWord(LockWord::FromHashCode(it->second, lw.GCState()), false);
+      it = RemoveEntry(it);
+    } else {
+      DCHECK_EQ(lw.GetState(), LockWord::kThinLocked);
+      ++it;
+    }
+  }
+}
+
+void ThinLockHashTable::Sweep(IsMarkedVisitor* visitor) {
+  MutexLock mu(Thread::Current(), lock_);
+  // Re-insert the moved objects after the walk, their new addresses may still be keys.
+  std::vector<std::pair<mirror::Object*, int32_t>> moved;
+  for (auto it = entries_.begin(); it != entries_.end(); ) {
+    mirror::Object* new_obj = visitor->IsMarked(it->first);
+    if (new_obj == nullptr) {
+      it = RemoveEntry(it);
+    } else if (new_obj != it->first) {
+      moved.emplace_back(new_obj, it->second);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  entries_.insert(moved.begin(), moved.end());
+}
+
+void ThinLockHashTable::DisallowNewEntries() {
+  MutexLock mu(Thread::Current(), lock_);
+  allow_new_entries_ = false;
+}
+
+void ThinLockHashTable::AllowNewEntries() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  allow_new_entries_ = true;
+  new_entries_condition_.Broadcast(self);
+}
+
+size_t ThinLockHashTable::Size() {
+  MutexLock mu(Thread::Current(), lock_);
+  return entries_.size();
+}
+
 MonitorInfo::MonitorInfo(mirror::Object* obj) : owner_(nullptr), entry_count_(0) {
   DCHECK(obj != nullptr);
   LockWord lock_word = obj->GetLockWord(true);
@@ -1402,7 +1724,7 @@ MonitorInfo::MonitorInfo(mirror::Object* obj) : owner_(nullptr), entry_count_(0)
       break;
     case LockWord::kFatLocked: {
       Monitor* mon = lock_word.FatLockMonitor();
-      owner_ = mon->owner_;
+      owner_ = mon->owner_.LoadRelaxed();
       entry_count_ = 1 + mon->lock_count_;
       for (Thread* waiter = mon->wait_set_; waiter != nullptr; waiter = waiter->GetWaitNext()) {
         waiters_.push_back(waiter);
@@ -23,6 +23,7 @@
 
 #include <iosfwd>
 #include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "atomic.h"
@@ -114,7 +115,7 @@ class Monitor {
   void SetObject(mirror::Object* object);
 
   Thread* GetOwner() const NO_THREAD_SAFETY_ANALYSIS {
-    return owner_;
+    return owner_.LoadRelaxed();
   }
 
   int32_t GetHashCode();
@@ -202,6 +203,12 @@ class Monitor {
       REQUIRES(monitor_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Spin with monitor_lock_ released while the owner is running, in case it releases the lock
+  // soon. Returns with monitor_lock_ held, true if we acquired the lock.
+  bool SpinLocked(Thread* self)
+      REQUIRES(monitor_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void Lock(Thread* self)
       REQUIRES(!monitor_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -257,6 +264,10 @@ class Monitor {
                                 int32_t* line_number)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // The method, source file and line for the ContentionProfiler.
+  static std::string PrettyLocation(ArtMethod* method, uint32_t pc)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   uint32_t GetOwnerThreadId() REQUIRES(!monitor_lock_);
 
   // Support for systrace output of monitor operations.
@@ -279,12 +290,17 @@ class Monitor {
   // Number of people waiting on the condition.
   size_t num_waiters_ GUARDED_BY(monitor_lock_);
 
-  // Which thread currently owns the lock?
-  Thread* volatile owner_ GUARDED_BY(monitor_lock_);
+  // Which thread currently owns the lock? Only written with monitor_lock_ held, but atomic so that
+  // a spinning thread can poll it without the lock.
+  Atomic<Thread*> owner_ GUARDED_BY(monitor_lock_);
 
   // Owner's recursive lock depth.
   int lock_count_ GUARDED_BY(monitor_lock_);
 
+  // How many times to poll for the owner to release the lock before blocking. Doubled when
+  // spinning acquires the lock and halved when it does not.
+  uint32_t spin_limit_ GUARDED_BY(monitor_lock_);
+
   // What object are we part of. This is a weak root. Do not access
   // this directly, use GetObject() to read it so it will be guarded
   // by a read barrier.
@@ -302,6 +318,9 @@ class Monitor {
   ArtMethod* locking_method_ GUARDED_BY(monitor_lock_);
   uint32_t locking_dex_pc_ GUARDED_BY(monitor_lock_);
 
+  // When the owner acquired the lock, if the ContentionProfiler was enabled then, or 0.
+  uint64_t lock_time_ns_ GUARDED_BY(monitor_lock_);
+
   // The denser encoded version of this monitor as stored in the lock word.
   MonitorId monitor_id_;
 
@@ -317,6 +336,90 @@ class Monitor {
   DISALLOW_COPY_AND_ASSIGN(Monitor);
 };
 
+// Identity hash codes of thin locked objects. The lock word holds either a thin lock or a hash
+// code, keeping the hash code of an object hashed while thin locked, or thin locked while
+// hashed, here rather than in a monitor avoids the inflation. The entry stays when the object
+// is unlocked, until the next IdentityHashCode or deflation moves the hash code back into the
+// lock word. While the table is not empty, hash codes are published in unlocked lock words
+// under its lock, so that they always agree with the entries.
+// The entries are found by address, so the table is not used with a read barrier, whose
+// collector moves objects while mutators run.
+class ThinLockHashTable {
+ public:
+  static constexpr bool kEnabled = !kUseReadBarrier;
+
+  ThinLockHashTable();
+
+  // Set a new hash code in the unlocked lock word `lw` of `obj`, or the one of its entry.
+  // Return false if the lock word changed in the meantime.
+  bool HashUnlocked(Thread* self, mirror::Object* obj, LockWord lw, int32_t* hash_code)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Return the hash code of the thin locked `obj`, adding an entry for it if it has none.
+  // Return false if the object is no longer thin locked.
+  bool HashThinLocked(Thread* self, mirror::Object* obj, int32_t* hash_code)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Thin lock `obj`, hashed when read as `lw`, for `self`, keeping its hash code here. Return
+  // false if the lock word changed in the meantime.
+  bool LockHashed(Thread* self, mirror::Object* obj, LockWord lw)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Replace the thin lock word `thin_lw` of `obj` with the `fat_lw` of a new monitor, moving
+  // the hash code of the object, if any, to `monitor_hash_code` first. Return false if the
+  // lock word changed in the meantime.
+  bool PublishMonitor(Thread* self,
+                      mirror::Object* obj,
+                      LockWord thin_lw,
+                      LockWord fat_lw,
+                      AtomicInteger* monitor_hash_code)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Keep the hash code of `obj`, whose monitor is deflated to a thin lock. Only called with
+  // the other mutators suspended.
+  void AddDeflated(Thread* self, mirror::Object* obj, int32_t hash_code)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Move the hash code of `obj` back into its lock word if it is unlocked. Only called with
+  // the other mutators suspended.
+  void Deflate(Thread* self, mirror::Object* obj)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Move the hash codes of all unlocked objects back into their lock words.
+  void DeflateAll(Thread* self) REQUIRES(!lock_) REQUIRES(Locks::mutator_lock_);
+
+  void Sweep(IsMarkedVisitor* visitor)
+      REQUIRES(!lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Entries for objects allocated while the GC sweeps could be swept, see MonitorList.
+  void DisallowNewEntries() REQUIRES(!lock_);
+  void AllowNewEntries() REQUIRES(!lock_);
+
+  size_t Size() REQUIRES(!lock_);
+
+ private:
+  typedef std::unordered_map<mirror::Object*, int32_t> Entries;
+
+  // Count an entry about to be added, then wait for the threads hashing unlocked objects
+  // without the lock, so that the lock word can be read once it is counted.
+  void ReserveEntry() REQUIRES(lock_);
+  void UnreserveEntry() REQUIRES(lock_);
+  Entries::iterator RemoveEntry(Entries::iterator it) REQUIRES(lock_);
+  void WaitForNewEntriesAllowed(Thread* self) REQUIRES(lock_);
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  ConditionVariable new_entries_condition_ GUARDED_BY(lock_);
+  bool allow_new_entries_ GUARDED_BY(lock_);
+  Entries entries_ GUARDED_BY(lock_);
+  // Number of entries, plus one while one is being added. Unlocked objects are hashed without
+  // the lock while it is zero.
+  Atomic<size_t> num_entries_;
+  // Threads hashing an unlocked object without the lock.
+  Atomic<size_t> num_lock_free_hashers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThinLockHashTable);
+};
+
 class MonitorList {
  public:
   MonitorList();
@@ -331,6 +434,11 @@ class MonitorList {
   void BroadcastForNewMonitors() REQUIRES(!monitor_list_lock_);
   // Returns how many monitors were deflated.
   size_t DeflateMonitors() REQUIRES(!monitor_list_lock_) REQUIRES(Locks::mutator_lock_);
+  size_t Size() REQUIRES(!monitor_list_lock_);
+
+  ThinLockHashTable* GetThinLockHashes() {
+    return ThinLockHashTable::kEnabled ? &thin_lock_hashes_ : nullptr;
+  }
 
   typedef std::list<Monitor*, TrackingAllocator<Monitor*, kAllocatorTagMonitorList>> Monitors;
 
@@ -343,6 +451,7 @@ class MonitorList {
   Mutex monitor_list_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ConditionVariable monitor_add_condition_ GUARDED_BY(monitor_list_lock_);
   Monitors list_ GUARDED_BY(monitor_list_lock_);
+  ThinLockHashTable thin_lock_hashes_;
 
   friend class Monitor;
   DISALLOW_COPY_AND_ASSIGN(MonitorList);
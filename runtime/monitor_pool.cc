@@ -16,6 +16,8 @@
 
 #include "monitor_pool.h"
 
+#include <map>
+
 #include "base/logging.h"
 #include "base/mutex-inl.h"
 #include "thread-inl.h"
@@ -29,7 +31,7 @@ namespace mirror {
 
 MonitorPool::MonitorPool()
     : current_chunk_list_index_(0), num_chunks_(0), current_chunk_list_capacity_(0),
-    first_free_(nullptr) {
+    num_released_chunks_(0), first_free_(nullptr) {
   for (size_t i = 0; i < kMaxChunkLists; ++i) {
     monitor_chunks_[i] = nullptr;  // Not absolutely required, but ...
   }
@@ -41,19 +43,29 @@ MonitorPool::MonitorPool()
 void MonitorPool::AllocateChunk() {
   DCHECK(first_free_ == nullptr);
 
-  // Do we need to allocate another chunk list?
-  if (num_chunks_ == current_chunk_list_capacity_) {
-    if (current_chunk_list_capacity_ != 0U) {
-      ++current_chunk_list_index_;
-      CHECK_LT(current_chunk_list_index_, kMaxChunkLists) << "Out of space for inflated monitors";
-      VLOG(monitor) << "Expanding to capacity "
-          << 2 * ChunkListCapacity(current_chunk_list_index_) - kInitialChunkStorage;
-    }  // else we're initializing
-    current_chunk_list_capacity_ = ChunkListCapacity(current_chunk_list_index_);
-    uintptr_t* new_list = new uintptr_t[current_chunk_list_capacity_]();
-    DCHECK(monitor_chunks_[current_chunk_list_index_] == nullptr);
-    monitor_chunks_[current_chunk_list_index_] = new_list;
-    num_chunks_ = 0;
+  // Reuse the slot of a released chunk if we can, so that we do not run out of monitor ids.
+  size_t list_index;
+  size_t chunk_index;
+  if (FindReleasedChunk(&list_index, &chunk_index)) {
+    --num_released_chunks_;
+  } else {
+    // Do we need to allocate another chunk list?
+    if (num_chunks_ == current_chunk_list_capacity_) {
+      if (current_chunk_list_capacity_ != 0U) {
+        ++current_chunk_list_index_;
+        CHECK_LT(current_chunk_list_index_, kMaxChunkLists) << "Out of space for inflated monitors";
+        VLOG(monitor) << "Expanding to capacity "
+            << 2 * ChunkListCapacity(current_chunk_list_index_) - kInitialChunkStorage;
+      }  // else we're initializing
+      current_chunk_list_capacity_ = ChunkListCapacity(current_chunk_list_index_);
+      uintptr_t* new_list = new uintptr_t[current_chunk_list_capacity_]();
+      DCHECK(monitor_chunks_[current_chunk_list_index_] == nullptr);
+      monitor_chunks_[current_chunk_list_index_] = new_list;
+      num_chunks_ = 0;
+    }
+    list_index = current_chunk_list_index_;
+    chunk_index = num_chunks_;
+    num_chunks_++;
   }
 
   // Allocate the chunk.
@@ -64,16 +76,16 @@ void MonitorPool::AllocateChunk() {
   CHECK_EQ(0U, reinterpret_cast<uintptr_t>(chunk) % kMonitorAlignment);
 
   // Add the chunk.
-  monitor_chunks_[current_chunk_list_index_][num_chunks_] = reinterpret_cast<uintptr_t>(chunk);
-  num_chunks_++;
+  DCHECK_EQ(monitor_chunks_[list_index][chunk_index], 0U);
+  monitor_chunks_[list_index][chunk_index] = reinterpret_cast<uintptr_t>(chunk);
 
   // Set up the free list
   Monitor* last = reinterpret_cast<Monitor*>(reinterpret_cast<uintptr_t>(chunk) +
                                              (kChunkCapacity - 1) * kAlignedMonitorSize);
   last->next_free_ = nullptr;
   // Eagerly compute id.
-  last->monitor_id_ = OffsetToMonitorId(current_chunk_list_index_* (kMaxListSize * kChunkSize)
-      + (num_chunks_ - 1) * kChunkSize + (kChunkCapacity - 1) * kAlignedMonitorSize);
+  last->monitor_id_ = OffsetToMonitorId(list_index * (kMaxListSize * kChunkSize)
+      + chunk_index * kChunkSize + (kChunkCapacity - 1) * kAlignedMonitorSize);
   for (size_t i = 0; i < kChunkCapacity - 1; ++i) {
     Monitor* before = reinterpret_cast<Monitor*>(reinterpret_cast<uintptr_t>(last) -
                                                  kAlignedMonitorSize);
@@ -95,8 +107,10 @@ void MonitorPool::FreeInternal() {
     DCHECK_NE(monitor_chunks_[i], static_cast<uintptr_t*>(nullptr));
     for (size_t j = 0; j < ChunkListCapacity(i); ++j) {
       if (i < current_chunk_list_index_ || j < num_chunks_) {
-        DCHECK_NE(monitor_chunks_[i][j], 0U);
-        allocator_.deallocate(reinterpret_cast<uint8_t*>(monitor_chunks_[i][j]), kChunkSize);
+        // The chunk may have been released by ReleaseFreeChunksInPool.
+        if (monitor_chunks_[i][j] != 0U) {
+          allocator_.deallocate(reinterpret_cast<uint8_t*>(monitor_chunks_[i][j]), kChunkSize);
+        }
       } else {
         DCHECK_EQ(monitor_chunks_[i][j], 0U);
       }
@@ -154,4 +168,53 @@ void MonitorPool::ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* mon
   }
 }
 
+bool MonitorPool::FindReleasedChunk(size_t* list_index, size_t* chunk_index) {
+  if (num_released_chunks_ == 0u) {
+    return false;
+  }
+  for (size_t i = 0; i <= current_chunk_list_index_; ++i) {
+    size_t used_chunks = (i == current_chunk_list_index_) ? num_chunks_ : ChunkListCapacity(i);
+    for (size_t j = 0; j < used_chunks; ++j) {
+      if (monitor_chunks_[i][j] == 0U) {
+        *list_index = i;
+        *chunk_index = j;
+        return true;
+      }
+    }
+  }
+  LOG(FATAL) << "Did not find the released chunk.";
+  return false;
+}
+
+size_t MonitorPool::ReleaseFreeChunksInPool(Thread* self) {
+  MutexLock mu(self, *Locks::allocated_monitor_ids_lock_);
+  // Count the free monitors of each chunk.
+  std::map<size_t, size_t> free_counts;
+  for (Monitor* mon = first_free_; mon != nullptr; mon = mon->next_free_) {
+    ++free_counts[MonitorIdToChunkIndex(mon->monitor_id_)];
+  }
+  // Unlink the monitors of the fully free chunks from the free list.
+  for (Monitor** link = &first_free_; *link != nullptr; ) {
+    if (free_counts[MonitorIdToChunkIndex((*link)->monitor_id_)] == kChunkCapacity) {
+      *link = (*link)->next_free_;
+    } else {
+      link = &(*link)->next_free_;
+    }
+  }
+  // Nobody can refer to these monitors anymore, so their ids will not be looked up until the
+  // slot is reused by AllocateChunk.
+  size_t released = 0u;
+  for (const auto& entry : free_counts) {
+    if (entry.second == kChunkCapacity) {
+      uintptr_t* slot = &monitor_chunks_[entry.first / kMaxListSize][entry.first % kMaxListSize];
+      allocator_.deallocate(reinterpret_cast<uint8_t*>(*slot), kChunkSize);
+      *slot = 0U;
+      ++released;
+    }
+  }
+  num_released_chunks_ += released;
+  VLOG(monitor) << "Released " << released << " free monitor chunks";
+  return released;
+}
+
 }  // namespace art
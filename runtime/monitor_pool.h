@@ -71,6 +71,17 @@ class MonitorPool {
 #endif
   }
 
+  // Give the memory of the chunks that only hold free monitors back to the allocator. Returns
+  // how many chunks were released.
+  static size_t ReleaseFreeChunks(Thread* self) {
+#ifndef __LP64__
+    UNUSED(self);
+    return 0u;
+#else
+    return GetMonitorPool()->ReleaseFreeChunksInPool(self);
+#endif
+  }
+
   static Monitor* MonitorFromMonitorId(MonitorId mon_id) {
 #ifndef __LP64__
     return reinterpret_cast<Monitor*>(mon_id << LockWord::kMonitorIdAlignmentShift);
@@ -128,6 +139,17 @@ class MonitorPool {
   void ReleaseMonitorToPool(Thread* self, Monitor* monitor);
   void ReleaseMonitorsToPool(Thread* self, MonitorList::Monitors* monitors);
 
+  size_t ReleaseFreeChunksInPool(Thread* self) REQUIRES(!Locks::allocated_monitor_ids_lock_);
+
+  // Find the slot of a released chunk, returns false if there is none.
+  bool FindReleasedChunk(size_t* list_index, size_t* chunk_index)
+      REQUIRES(Locks::allocated_monitor_ids_lock_);
+
+  // Index of the chunk holding mon_id, counting the chunks of all the lists.
+  static constexpr size_t MonitorIdToChunkIndex(MonitorId mon_id) {
+    return MonitorIdToOffset(mon_id) / kChunkSize;
+  }
+
   // Note: This is safe as we do not ever move chunks.  All needed entries in the monitor_chunks_
   // data structure are read-only once we get here.  Updates happen-before this call because
   // the lock word was stored with release semantics and we read it with acquire semantics to
@@ -155,7 +177,7 @@ class MonitorPool {
           break;
         }
         uintptr_t chunk_addr = monitor_chunks_[i][j];
-        if (IsInChunk(chunk_addr, mon)) {
+        if (chunk_addr != 0u && IsInChunk(chunk_addr, mon)) {
           return OffsetToMonitorId(
               reinterpret_cast<uintptr_t>(mon) - chunk_addr
               + i * (kMaxListSize * kChunkSize) + j * kChunkSize);
@@ -229,6 +251,8 @@ class MonitorPool {
   // After the initial allocation, this is always equal to
   // ChunkListCapacity(current_chunk_list_index_).
   size_t current_chunk_list_capacity_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
+  // Number of chunk pointers that were cleared by ReleaseFreeChunksInPool and not reused yet.
+  size_t num_released_chunks_ GUARDED_BY(Locks::allocated_monitor_ids_lock_);
 
   typedef TrackingAllocator<uint8_t, kAllocatorTagMonitorPool> Allocator;
   Allocator allocator_;
@@ -124,4 +124,39 @@ TEST_F(MonitorPoolTest, MonitorPoolTest) {
   }
 }
 
+TEST_F(MonitorPoolTest, ReleaseFreeChunks) {
+  // More than a chunk worth of monitors, see MonitorPoolTest for the chunk capacity.
+  const size_t kNumMonitors = 100;
+
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+
+  std::vector<Monitor*> monitors;
+  for (size_t i = 0; i < kNumMonitors; ++i) {
+    monitors.push_back(MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(i)));
+  }
+  for (Monitor* mon : monitors) {
+    MonitorPool::ReleaseMonitor(self, mon);
+  }
+  monitors.clear();
+
+  size_t released = MonitorPool::ReleaseFreeChunks(self);
+#ifdef __LP64__
+  EXPECT_NE(0u, released);
+#else
+  EXPECT_EQ(0u, released);
+#endif
+
+  // The slots of the released chunks are reused.
+  for (size_t i = 0; i < kNumMonitors; ++i) {
+    Monitor* mon = MonitorPool::CreateMonitor(self, self, nullptr, static_cast<int32_t>(i));
+    VerifyMonitor(mon, self);
+    monitors.push_back(mon);
+  }
+  for (Monitor* mon : monitors) {
+    VerifyMonitor(mon, self);
+    MonitorPool::ReleaseMonitor(self, mon);
+  }
+}
+
 }  // namespace art
@@ -28,6 +28,7 @@
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
 #include "object_lock.h"
 #include "scoped_thread_state_change.h"
+#include "thread_list.h"
 #include "thread_pool.h"
 
 namespace art {
@@ -430,5 +431,60 @@ TEST_F(MonitorTest, TestTryLock) {
   thread_pool.StopWorkers(self);
 }
 
+// Test that hashing thin locked objects, or locking hashed ones, does not inflate them.
+TEST_F(MonitorTest, HashCodeOfThinLock) {
+  if (!ThinLockHashTable::kEnabled) {
+    return;
+  }
+  Thread* const self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Object> obj1(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hello, world!")));
+  Handle<mirror::Object> obj2(
+      hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "hello, world!")));
+
+  // Hash while thin locked.
+  int32_t hash_code1;
+  {
+    ObjectLock<mirror::Object> lock(self, obj1);
+    hash_code1 = obj1->IdentityHashCode();
+    EXPECT_EQ(LockWord::kThinLocked, obj1->GetLockWord(true).GetState());
+    EXPECT_EQ(hash_code1, obj1->IdentityHashCode());
+  }
+  EXPECT_EQ(LockWord::kUnlocked, obj1->GetLockWord(true).GetState());
+  EXPECT_EQ(hash_code1, obj1->IdentityHashCode());
+  EXPECT_EQ(LockWord::kHashCode, obj1->GetLockWord(true).GetState());
+
+  // Lock while hashed, and inflate to wait, the monitor takes the hash code over.
+  {
+    ObjectLock<mirror::Object> lock(self, obj1);
+    EXPECT_EQ(LockWord::kThinLocked, obj1->GetLockWord(true).GetState());
+    EXPECT_EQ(hash_code1, obj1->IdentityHashCode());
+    obj1->Wait(self, 1, 0);
+    self->AssertNoPendingException();
+    EXPECT_EQ(LockWord::kFatLocked, obj1->GetLockWord(true).GetState());
+    EXPECT_EQ(hash_code1, obj1->IdentityHashCode());
+  }
+  EXPECT_EQ(hash_code1, obj1->IdentityHashCode());
+
+  // Deflate a locked monitor with a hash code to a thin lock.
+  int32_t hash_code2;
+  {
+    ObjectLock<mirror::Object> lock(self, obj2);
+    obj2->Notify(self);  // Inflates.
+    hash_code2 = obj2->IdentityHashCode();
+    EXPECT_EQ(LockWord::kFatLocked, obj2->GetLockWord(true).GetState());
+    {
+      ScopedThreadSuspension sts(self, kSuspended);
+      ScopedSuspendAll ssa(__FUNCTION__);
+      Runtime::Current()->GetMonitorList()->DeflateMonitors();
+    }
+    EXPECT_EQ(LockWord::kThinLocked, obj2->GetLockWord(true).GetState());
+    EXPECT_EQ(hash_code2, obj2->IdentityHashCode());
+  }
+  EXPECT_EQ(hash_code2, obj2->IdentityHashCode());
+  EXPECT_EQ(LockWord::kHashCode, obj2->GetLockWord(true).GetState());
+}
 
 }  // namespace art
@@ -21,22 +21,28 @@
 
 #include <sstream>
 
+#include "base/contention_profiler.h"
 #include "base/histogram-inl.h"
 #include "base/time_utils.h"
 #include "class_linker.h"
 #include "common_throws.h"
 #include "debugger.h"
+#include "gc/allocation_sampler.h"
+#include "gc/gc_event_log.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space.h"
 #include "gc/space/large_object_space.h"
 #include "gc/space/space-inl.h"
 #include "gc/space/zygote_space.h"
 #include "hprof/hprof.h"
+#include "interpreter/dispatch_profiler.h"
+#include "interpreter/opcode_pair_profiler.h"
 #include "jni_internal.h"
 #include "mirror/class.h"
 #include "ScopedLocalRef.h"
 #include "ScopedUtfChars.h"
 #include "scoped_fast_native_object_access.h"
+#include "suspend_latency_profiler.h"
 #include "trace.h"
 #include "well_known_classes.h"
 
@@ -368,9 +374,85 @@ enum class VMDebugRuntimeStatId {
   kArtGcBlockingGcTime,
   kArtGcGcCountRateHistogram,
   kArtGcBlockingGcCountRateHistogram,
+  kArtGcAllocSampleProfile,
+  kArtLockContentionProfile,
+  kArtSuspendLatencyProfile,
+  kArtOpcodePairProfile,
+  kArtInterpreterProfile,
+  kArtGcPauseProfile,
+  kArtGcEvents,
   kNumRuntimeStats,
 };
 
+// Returns false if the sampling allocation profiler is not enabled.
+static bool DumpAllocSampleProfile(gc::Heap* heap, std::string* output) {
+  gc::AllocSampler* sampler = heap->GetAllocSampler();
+  if (sampler == nullptr) {
+    return false;
+  }
+  std::ostringstream os;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    sampler->Dump(os, 0u);
+  }
+  *output = os.str();
+  return true;
+}
+
+// Returns false if the lock contention profiler was never enabled.
+static bool DumpLockContentionProfile(std::string* output) {
+  std::ostringstream os;
+  if (!ContentionProfiler::Dump(os)) {
+    return false;
+  }
+  *output = os.str();
+  return true;
+}
+
+// Returns false if the suspend latency profiler was never enabled.
+static bool DumpSuspendLatencyProfile(std::string* output) {
+  std::ostringstream os;
+  if (!SuspendLatencyProfiler::Dump(os)) {
+    return false;
+  }
+  *output = os.str();
+  return true;
+}
+
+// Returns false if the opcode pair profiler was never enabled.
+static bool DumpOpcodePairProfile(std::string* output) {
+  std::ostringstream os;
+  if (!interpreter::OpcodePairProfiler::Dump(os)) {
+    return false;
+  }
+  *output = os.str();
+  return true;
+}
+
+// Returns false if the interpreter dispatch profiler was never enabled.
+static bool DumpInterpreterProfile(std::string* output) {
+  std::ostringstream os;
+  if (!interpreter::DispatchProfiler::Dump(os)) {
+    return false;
+  }
+  *output = os.str();
+  return true;
+}
+
+// Returns false if no collection was logged yet.
+static bool DumpGcPauseProfile(gc::Heap* heap, std::string* output) {
+  std::ostringstream os;
+  heap->GetGcEventLog()->Dump(os);
+  *output = os.str();
+  return !output->empty();
+}
+
+static std::string DumpGcEvents(gc::Heap* heap) {
+  std::ostringstream os;
+  heap->GetGcEventLog()->DumpEvents(os);
+  return os.str();
+}
+
 static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId) {
   gc::Heap* heap = Runtime::Current()->GetHeap();
   switch (static_cast<VMDebugRuntimeStatId>(statId)) {
@@ -408,6 +490,52 @@ static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId)
       heap->DumpBlockingGcCountRateHistogram(output);
       return env->NewStringUTF(output.str().c_str());
     }
+    case VMDebugRuntimeStatId::kArtGcAllocSampleProfile: {
+      std::string output;
+      if (!DumpAllocSampleProfile(heap, &output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtLockContentionProfile: {
+      std::string output;
+      if (!DumpLockContentionProfile(&output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtSuspendLatencyProfile: {
+      std::string output;
+      if (!DumpSuspendLatencyProfile(&output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtOpcodePairProfile: {
+      std::string output;
+      if (!DumpOpcodePairProfile(&output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtInterpreterProfile: {
+      std::string output;
+      if (!DumpInterpreterProfile(&output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcPauseProfile: {
+      std::string output;
+      if (!DumpGcPauseProfile(heap, &output)) {
+        return nullptr;
+      }
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcEvents: {
+      std::string output = DumpGcEvents(heap);
+      return env->NewStringUTF(output.c_str());
+    }
     default:
       return nullptr;
   }
@@ -472,6 +600,53 @@ static jobjectArray VMDebug_getRuntimeStatsInternal(JNIEnv* env, jclass) {
       return nullptr;
     }
   }
+  {
+    std::string output;
+    if (DumpAllocSampleProfile(heap, &output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcAllocSampleProfile, output)) {
+      return nullptr;
+    }
+  }
+  {
+    std::string output;
+    if (DumpLockContentionProfile(&output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtLockContentionProfile,
+                             output)) {
+      return nullptr;
+    }
+  }
+  {
+    std::string output;
+    if (DumpSuspendLatencyProfile(&output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtSuspendLatencyProfile,
+                             output)) {
+      return nullptr;
+    }
+  }
+  {
+    std::string output;
+    if (DumpOpcodePairProfile(&output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtOpcodePairProfile, output)) {
+      return nullptr;
+    }
+  }
+  {
+    std::string output;
+    if (DumpInterpreterProfile(&output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtInterpreterProfile, output)) {
+      return nullptr;
+    }
+  }
+  {
+    std::string output;
+    if (DumpGcPauseProfile(heap, &output) &&
+        !SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcPauseProfile, output)) {
+      return nullptr;
+    }
+  }
+  if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcEvents, DumpGcEvents(heap))) {
+    return nullptr;
+  }
   return result;
 }
 
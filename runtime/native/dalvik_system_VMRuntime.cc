@@ -456,7 +456,7 @@ static void PreloadDexCachesStatsFilled(DexCacheStats* filled)
         filled->num_types++;
       }
     }
-    for (size_t j = 0; j < dex_cache->NumResolvedFields(); j++) {
+    for (size_t j = 0; j < dex_file->NumFieldIds(); j++) {
       ArtField* field = class_linker->GetResolvedField(j, dex_cache);
       if (field != nullptr) {
         filled->num_fields++;
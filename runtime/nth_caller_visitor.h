@@ -34,18 +34,20 @@ struct NthCallerVisitor : public StackVisitor {
         caller(nullptr) {}
 
   bool VisitFrame() SHARED_REQUIRES(Locks::mutator_lock_) {
-    ArtMethod* m = GetMethod();
-    bool do_count = false;
-    if (m == nullptr || m->IsRuntimeMethod()) {
-      // Upcall.
-      do_count = include_runtime_and_upcalls_;
-    } else {
-      do_count = true;
+    // Inlined frames are never upcalls. Getting their method needs a stack map lookup, so only
+    // do it for the frame we stop at.
+    bool do_count = true;
+    if (!IsInInlinedFrame()) {
+      ArtMethod* m = GetMethod();
+      if (m == nullptr || m->IsRuntimeMethod()) {
+        // Upcall.
+        do_count = include_runtime_and_upcalls_;
+      }
     }
     if (do_count) {
       DCHECK(caller == nullptr);
       if (count == n) {
-        caller = m;
+        caller = GetMethod();
         caller_pc = GetCurrentQuickFramePc();
         return false;
       }
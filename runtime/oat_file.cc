@@ -18,6 +18,7 @@
 
 #include <dlfcn.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <type_traits>
 #include <unistd.h>
 
@@ -33,6 +34,7 @@
 #endif
 
 #include "art_method-inl.h"
+#include "base/bit_utils.h"
 #include "base/bit_vector.h"
 #include "base/enums.h"
 #include "base/stl_util.h"
@@ -423,7 +425,8 @@ bool OatFileBase::Setup(const char* abs_dex_location, std::string* error_msg) {
     if (lookup_table_offset != 0u &&
         (UNLIKELY(lookup_table_offset > Size()) ||
             UNLIKELY(Size() - lookup_table_offset <
-                     TypeLookupTable::RawDataLength(header->class_defs_size_)))) {
+                     TypeLookupTable::RawDataLength(header->class_defs_size_,
+                                                    header->type_ids_size_)))) {
       *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zu for '%s' with truncated "
                                     "type lookup table, offset %u of %zu, class defs %u",
                                 GetLocation().c_str(),
@@ -1063,6 +1066,19 @@ const uint8_t* OatFile::End() const {
   return end_;
 }
 
+void OatFile::ReadAheadDexFiles() const {
+  ScopedTrace trace(__FUNCTION__);
+  for (const OatDexFile* oat_dex_file : oat_dex_files_storage_) {
+    const uint8_t* dex_begin = oat_dex_file->GetDexFilePointer();
+    uint8_t* begin = AlignDown(const_cast<uint8_t*>(dex_begin), kPageSize);
+    uint8_t* end = AlignUp(const_cast<uint8_t*>(dex_begin) + oat_dex_file->FileSize(), kPageSize);
+    // Only a hint, the dex file is still readable if this fails.
+    if (madvise(begin, end - begin, MADV_WILLNEED) != 0) {
+      PLOG(WARNING) << "madvise(MADV_WILLNEED) failed for " << oat_dex_file->GetDexFileLocation();
+    }
+  }
+}
+
 const uint8_t* OatFile::BssBegin() const {
   return bss_begin_;
 }
@@ -222,6 +222,10 @@ class OatFile {
     return oat_dex_files_storage_;
   }
 
+  // Ask the kernel to start reading the dex files embedded in the oat file in the background,
+  // so that the I/O overlaps with the checks done before the dex files are first used.
+  void ReadAheadDexFiles() const;
+
   size_t Size() const {
     return End() - Begin();
   }
@@ -17,8 +17,14 @@
 #include "oat_file_assistant.h"
 
 #include <sys/stat.h>
+
+#include <map>
+#include <vector>
+
 #include "base/logging.h"
+#include "base/mutex.h"
 #include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
 #include "compiler_filter.h"
 #include "class_linker.h"
 #include "gc/heap.h"
@@ -50,6 +56,116 @@ std::ostream& operator << (std::ostream& stream, const OatFileAssistant::OatStat
   return stream;
 }
 
+// The boot image is not part of the stamps: it does not change for the lifetime of the process.
+class OatFileAssistant::StatusCache {
+ public:
+  // The identity of a file on disk. All zero if the file does not exist.
+  struct FileStamp {
+    bool operator==(const FileStamp& other) const {
+      return dev == other.dev && ino == other.ino && size == other.size &&
+          mtime == other.mtime && mtime_nsec == other.mtime_nsec && ctime == other.ctime;
+    }
+
+    dev_t dev = 0;
+    ino_t ino = 0;
+    off_t size = 0;
+    time_t mtime = 0;
+    long mtime_nsec = 0;  // NOLINT(runtime/int)
+    time_t ctime = 0;
+  };
+
+  static FileStamp GetFileStamp(const std::string& filename) {
+    FileStamp stamp;
+    struct stat st;
+    if (stat(filename.c_str(), &st) == 0) {
+      stamp.dev = st.st_dev;
+      stamp.ino = st.st_ino;
+      stamp.size = st.st_size;
+      stamp.mtime = st.st_mtime;
+#if defined(__APPLE__)
+      stamp.mtime_nsec = st.st_mtimespec.tv_nsec;
+#else
+      stamp.mtime_nsec = st.st_mtim.tv_nsec;
+#endif
+      stamp.ctime = st.st_ctime;
+    }
+    return stamp;
+  }
+
+  static bool LookUpSummary(const std::string& key,
+                            const std::vector<FileStamp>& stamps,
+                            FileSummary* summary) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    auto it = summaries_.find(key);
+    if (it == summaries_.end() || it->second.stamps != stamps) {
+      return false;
+    }
+    *summary = it->second.summary;
+    return true;
+  }
+
+  static void AddSummary(const std::string& key,
+                         const std::vector<FileStamp>& stamps,
+                         const FileSummary& summary) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    if (summaries_.size() >= kMaxEntries) {
+      summaries_.clear();
+    }
+    CachedSummary& entry = summaries_[key];
+    entry.stamps = stamps;
+    entry.summary = summary;
+  }
+
+  static bool LookUpDexChecksum(const std::string& dex_location,
+                                const FileStamp& stamp,
+                                uint32_t* checksum) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    auto it = dex_checksums_.find(dex_location);
+    if (it == dex_checksums_.end() || !(it->second.stamp == stamp)) {
+      return false;
+    }
+    *checksum = it->second.checksum;
+    return true;
+  }
+
+  static void AddDexChecksum(const std::string& dex_location,
+                             const FileStamp& stamp,
+                             uint32_t checksum) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    if (dex_checksums_.size() >= kMaxEntries) {
+      dex_checksums_.clear();
+    }
+    CachedDexChecksum& entry = dex_checksums_[dex_location];
+    entry.stamp = stamp;
+    entry.checksum = checksum;
+  }
+
+ private:
+  // Bounds the memory used by processes that look at many files, such as the package manager.
+  static constexpr size_t kMaxEntries = 1024;
+
+  struct CachedSummary {
+    std::vector<FileStamp> stamps;
+    FileSummary summary;
+  };
+
+  struct CachedDexChecksum {
+    FileStamp stamp;
+    uint32_t checksum;
+  };
+
+  static Mutex lock_;
+  static std::map<std::string, CachedSummary> summaries_ GUARDED_BY(lock_);
+  static std::map<std::string, CachedDexChecksum> dex_checksums_ GUARDED_BY(lock_);
+};
+
+Mutex OatFileAssistant::StatusCache::lock_("OatFileAssistant status cache lock",
+                                           kOatFileStatusCacheLock);
+std::map<std::string, OatFileAssistant::StatusCache::CachedSummary>
+    OatFileAssistant::StatusCache::summaries_;
+std::map<std::string, OatFileAssistant::StatusCache::CachedDexChecksum>
+    OatFileAssistant::StatusCache::dex_checksums_;
+
 OatFileAssistant::OatFileAssistant(const char* dex_location,
                                    const InstructionSet isa,
                                    bool load_executable)
@@ -346,8 +462,7 @@ CompilerFilter::Filter OatFileAssistant::OdexFileCompilerFilter() {
   return odex_.CompilerFilter();
 }
 
-static std::string ArtFileName(const OatFile* oat_file) {
-  const std::string oat_file_location = oat_file->GetLocation();
+static std::string ArtFileName(const std::string& oat_file_location) {
   // Replace extension with .art
   const size_t last_ext = oat_file_location.find_last_of('.');
   if (last_ext == std::string::npos) {
@@ -357,6 +472,27 @@ static std::string ArtFileName(const OatFile* oat_file) {
   return oat_file_location.substr(0, last_ext) + ".art";
 }
 
+static std::string ArtFileName(const OatFile* oat_file) {
+  return ArtFileName(oat_file->GetLocation());
+}
+
+// Returns where the app image next to the oat file expects the oat file to be loaded, or null if
+// there is no app image.
+static uint8_t* AppImageOatFileBegin(const std::string& oat_file_location) {
+  std::string art_file = ArtFileName(oat_file_location);
+  if (art_file.empty() || !OS::FileExists(art_file.c_str())) {
+    return nullptr;
+  }
+  std::unique_ptr<File> image_file(OS::OpenFileForReading(art_file.c_str()));
+  ImageHeader image_header;
+  if (image_file == nullptr ||
+      !image_file->ReadFully(&image_header, sizeof(image_header)) ||
+      !image_header.IsValid()) {
+    return nullptr;
+  }
+  return image_header.GetOatFileBegin();
+}
+
 const std::string* OatFileAssistant::OatFileName() {
   return oat_.Filename();
 }
@@ -748,9 +884,16 @@ const uint32_t* OatFileAssistant::GetRequiredDexChecksum() {
     required_dex_checksum_attempted_ = true;
     required_dex_checksum_found_ = false;
     std::string error_msg;
-    if (DexFile::GetChecksum(dex_location_.c_str(), &cached_required_dex_checksum_, &error_msg)) {
+    const StatusCache::FileStamp dex_stamp = StatusCache::GetFileStamp(dex_location_);
+    if (StatusCache::LookUpDexChecksum(dex_location_, dex_stamp, &cached_required_dex_checksum_)) {
       required_dex_checksum_found_ = true;
       has_original_dex_files_ = true;
+    } else if (DexFile::GetChecksum(dex_location_.c_str(),
+                                    &cached_required_dex_checksum_,
+                                    &error_msg)) {
+      required_dex_checksum_found_ = true;
+      has_original_dex_files_ = true;
+      StatusCache::AddDexChecksum(dex_location_, dex_stamp, cached_required_dex_checksum_);
     } else {
       // This can happen if the original dex file has been stripped from the
       // apk.
@@ -859,17 +1002,45 @@ bool OatFileAssistant::OatFileInfo::Exists() {
   return GetFile() != nullptr;
 }
 
-OatFileAssistant::OatStatus OatFileAssistant::OatFileInfo::Status() {
-  if (!status_attempted_) {
-    status_attempted_ = true;
-    const OatFile* file = GetFile();
-    if (file == nullptr) {
-      status_ = kOatOutOfDate;
+const OatFileAssistant::FileSummary* OatFileAssistant::OatFileInfo::GetSummary() {
+  if (!summary_attempted_) {
+    summary_attempted_ = true;
+    if (!filename_provided_) {
+      return nullptr;
+    }
+    // The status also depends on the dex checksums, which come from the dex location, or from the
+    // odex file when the dex location was stripped.
+    std::vector<StatusCache::FileStamp> stamps;
+    stamps.push_back(StatusCache::GetFileStamp(filename_));
+    stamps.push_back(StatusCache::GetFileStamp(oat_file_assistant_->dex_location_));
+    const std::string* odex_filename = oat_file_assistant_->odex_.Filename();
+    if (odex_filename != nullptr) {
+      stamps.push_back(StatusCache::GetFileStamp(*odex_filename));
+    }
+    std::string key = filename_ + ":" + oat_file_assistant_->dex_location_ + ":" +
+        GetInstructionSetString(oat_file_assistant_->isa_);
+    bool cacheable = !(stamps[0] == StatusCache::FileStamp());
+    if (cacheable && file_ == nullptr && StatusCache::LookUpSummary(key, stamps, &summary_)) {
+      summary_found_ = true;
     } else {
-      status_ = oat_file_assistant_->GivenOatFileStatus(*file);
+      const OatFile* file = GetFile();
+      if (file != nullptr) {
+        summary_.status = oat_file_assistant_->GivenOatFileStatus(*file);
+        summary_.compiler_filter = file->GetCompilerFilter();
+        summary_.has_patch_info = file->HasPatchInfo();
+        summary_found_ = true;
+        if (cacheable) {
+          StatusCache::AddSummary(key, stamps, summary_);
+        }
+      }
     }
   }
-  return status_;
+  return summary_found_ ? &summary_ : nullptr;
+}
+
+OatFileAssistant::OatStatus OatFileAssistant::OatFileInfo::Status() {
+  const FileSummary* summary = GetSummary();
+  return (summary == nullptr) ? kOatOutOfDate : summary->status;
 }
 
 bool OatFileAssistant::OatFileInfo::IsOutOfDate() {
@@ -885,9 +1056,9 @@ bool OatFileAssistant::OatFileInfo::IsUpToDate() {
 }
 
 CompilerFilter::Filter OatFileAssistant::OatFileInfo::CompilerFilter() {
-  const OatFile* file = GetFile();
-  CHECK(file != nullptr);
-  return file->GetCompilerFilter();
+  const FileSummary* summary = GetSummary();
+  CHECK(summary != nullptr);
+  return summary->compiler_filter;
 }
 
 const OatFile* OatFileAssistant::OatFileInfo::GetFile() {
@@ -896,14 +1067,32 @@ const OatFile* OatFileAssistant::OatFileInfo::GetFile() {
     load_attempted_ = true;
     if (filename_provided_) {
       std::string error_msg;
+      // If the oat file has an app image, load it where the image expects it. When that address
+      // is available, the image does not need its code pointers relocated, which would dirty all
+      // of its ArtMethods. Otherwise fall back to loading anywhere.
+      uint8_t* oat_file_begin = oat_file_assistant_->load_executable_
+          ? AppImageOatFileBegin(filename_)
+          : nullptr;
       file_.reset(OatFile::Open(filename_.c_str(),
                                 filename_.c_str(),
                                 nullptr,
-                                nullptr,
+                                oat_file_begin,
                                 oat_file_assistant_->load_executable_,
                                 /*low_4gb*/false,
                                 oat_file_assistant_->dex_location_.c_str(),
                                 &error_msg));
+      if (file_.get() == nullptr && oat_file_begin != nullptr) {
+        VLOG(oat) << "Failed to load " << filename_ << " at the app image oat address "
+                  << reinterpret_cast<const void*>(oat_file_begin) << ": " << error_msg;
+        file_.reset(OatFile::Open(filename_.c_str(),
+                                  filename_.c_str(),
+                                  nullptr,
+                                  nullptr,
+                                  oat_file_assistant_->load_executable_,
+                                  /*low_4gb*/false,
+                                  oat_file_assistant_->dex_location_.c_str(),
+                                  &error_msg));
+      }
       if (file_.get() == nullptr) {
         VLOG(oat) << "OatFileAssistant test for existing oat file "
           << filename_ << ": " << error_msg;
@@ -915,12 +1104,12 @@ const OatFile* OatFileAssistant::OatFileInfo::GetFile() {
 
 bool OatFileAssistant::OatFileInfo::CompilerFilterIsOkay(
     CompilerFilter::Filter target, bool profile_changed) {
-  const OatFile* file = GetFile();
-  if (file == nullptr) {
+  const FileSummary* summary = GetSummary();
+  if (summary == nullptr) {
     return false;
   }
 
-  CompilerFilter::Filter current = file->GetCompilerFilter();
+  CompilerFilter::Filter current = summary->compiler_filter;
   if (profile_changed && CompilerFilter::DependsOnProfile(current)) {
     VLOG(oat) << "Compiler filter not okay because Profile changed";
     return false;
@@ -934,14 +1123,15 @@ bool OatFileAssistant::OatFileInfo::IsExecutable() {
 }
 
 bool OatFileAssistant::OatFileInfo::HasPatchInfo() {
-  const OatFile* file = GetFile();
-  return (file != nullptr && file->HasPatchInfo());
+  const FileSummary* summary = GetSummary();
+  return (summary != nullptr && summary->has_patch_info);
 }
 
 void OatFileAssistant::OatFileInfo::Reset() {
   load_attempted_ = false;
   file_.reset();
-  status_attempted_ = false;
+  summary_attempted_ = false;
+  summary_found_ = false;
 }
 
 void OatFileAssistant::OatFileInfo::Reset(const std::string& filename) {
@@ -951,6 +1141,8 @@ void OatFileAssistant::OatFileInfo::Reset(const std::string& filename) {
 }
 
 std::unique_ptr<OatFile> OatFileAssistant::OatFileInfo::ReleaseFile() {
+  // The status may have come from the cache, without loading the file.
+  GetFile();
   file_released_ = true;
   return std::move(file_);
 }
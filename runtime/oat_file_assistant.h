@@ -306,6 +306,17 @@ class OatFileAssistant {
     std::string location;
   };
 
+  // What the status queries need to know about an oat file.
+  struct FileSummary {
+    OatStatus status;
+    CompilerFilter::Filter compiler_filter;
+    bool has_patch_info;
+  };
+
+  // Process-wide cache of the results that need opening the oat and dex files. Entries are only
+  // used while the files they were computed from keep the same identity on disk.
+  class StatusCache;
+
   class OatFileInfo {
    public:
     // Initially the info is for no file in particular. It will treat the
@@ -349,7 +360,7 @@ class OatFileAssistant {
     void Reset(const std::string& filename);
 
     // Release the loaded oat file.
-    // Returns null if the oat file hasn't been loaded.
+    // Loads the file if needed. Returns null if the file failed to load.
     //
     // After this call, no other methods of the OatFileInfo should be
     // called, because access to the loaded oat file has been taken away from
@@ -357,6 +368,10 @@ class OatFileAssistant {
     std::unique_ptr<OatFile> ReleaseFile();
 
    private:
+    // Returns the summary of the file, from the status cache if possible, without opening the
+    // file. Returns null if the file failed to load.
+    const FileSummary* GetSummary();
+
     OatFileAssistant* oat_file_assistant_;
 
     bool filename_provided_ = false;
@@ -365,8 +380,9 @@ class OatFileAssistant {
     bool load_attempted_ = false;
     std::unique_ptr<OatFile> file_;
 
-    bool status_attempted_ = false;
-    OatStatus status_;
+    bool summary_attempted_ = false;
+    bool summary_found_ = false;
+    FileSummary summary_;
 
     // For debugging only.
     // If this flag is set, the file has been released to the user and the
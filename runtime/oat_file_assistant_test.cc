@@ -450,6 +450,35 @@ TEST_F(OatFileAssistantTest, OatOutOfDate) {
   EXPECT_TRUE(oat_file_assistant.HasOriginalDexFiles());
 }
 
+// Case: We have a DEX file and an OAT file for it, whose status was already
+// computed when the DEX file is overwritten.
+// Expect: The cached status is not used for the new DEX file.
+TEST_F(OatFileAssistantTest, CachedStatusRevalidated) {
+  std::string dex_location = GetScratchDir() + "/CachedStatusRevalidated.jar";
+  Copy(GetDexSrc1(), dex_location);
+  GenerateOatForTest(dex_location.c_str(), CompilerFilter::kSpeed);
+
+  {
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kNoDexOptNeeded,
+        oat_file_assistant.GetDexOptNeeded(CompilerFilter::kSpeed));
+  }
+  {
+    // The status comes from the cache this time, and must not change.
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kNoDexOptNeeded,
+        oat_file_assistant.GetDexOptNeeded(CompilerFilter::kSpeed));
+    EXPECT_TRUE(oat_file_assistant.OatFileIsUpToDate());
+    EXPECT_EQ(CompilerFilter::kSpeed, oat_file_assistant.OatFileCompilerFilter());
+  }
+
+  Copy(GetDexSrc2(), dex_location);
+  OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+  EXPECT_EQ(OatFileAssistant::kDex2OatNeeded,
+      oat_file_assistant.GetDexOptNeeded(CompilerFilter::kSpeed));
+  EXPECT_TRUE(oat_file_assistant.OatFileIsOutOfDate());
+}
+
 // Case: We have a DEX file and an ODEX file, but no OAT file.
 // Expect: The status is kPatchOatNeeded.
 TEST_F(OatFileAssistantTest, DexOdexNoOat) {
@@ -596,6 +596,9 @@ std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
   std::unique_ptr<const OatFile> oat_file(oat_file_assistant.GetBestOatFile().release());
 
   if (oat_file != nullptr) {
+    // Start paging in the dex files while we check for collisions and load the app image.
+    oat_file->ReadAheadDexFiles();
+
     // Take the file only if it has no collisions, or we must take it because of preopting.
     bool accept_oat_file =
         !HasCollisions(oat_file.get(), class_loader, dex_elements, /*out*/ &error_msg);
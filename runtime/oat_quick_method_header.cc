@@ -16,7 +16,9 @@
 
 #include "oat_quick_method_header.h"
 
-#include "art_method.h"
+#include "art_method-inl.h"
+#include "dex_file.h"
+#include "oat_file.h"
 #include "scoped_thread_state_change.h"
 #include "thread.h"
 
@@ -90,4 +92,49 @@ uintptr_t OatQuickMethodHeader::ToNativeQuickPc(ArtMethod* method,
   return UINTPTR_MAX;
 }
 
+bool OatQuickMethodHeader::HasInlinedMethod(ArtMethod* outer_method, ArtMethod* method) const {
+  if (!IsOptimized()) {
+    return false;
+  }
+  const DexFile* dex_file = method->GetDexFile();
+  const DexFile* outer_dex_file = outer_method->GetDexFile();
+  const uint32_t method_index = method->GetDexMethodIndex();
+  CodeInfo code_info = GetOptimizedCodeInfo();
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  if (!code_info.HasInlineInfo(encoding)) {
+    return false;
+  }
+  for (size_t i = 0, e = code_info.GetNumberOfStackMaps(encoding); i < e; ++i) {
+    StackMap stack_map = code_info.GetStackMapAt(i, encoding);
+    if (!stack_map.HasInlineInfo(encoding.stack_map_encoding)) {
+      continue;
+    }
+    InlineInfo inline_info = code_info.GetInlineInfoOf(stack_map, encoding);
+    for (uint32_t d = 0, depth = inline_info.GetDepth(encoding.inline_info_encoding);
+         d < depth;
+         ++d) {
+      if (inline_info.GetMethodIndexAtDepth(encoding.inline_info_encoding, d) != method_index) {
+        continue;
+      }
+      uint32_t dex_file_index =
+          inline_info.GetDexFileIndexAtDepth(encoding.inline_info_encoding, d);
+      if (dex_file_index == InlineInfo::kOuterDexFileIndex) {
+        if (outer_dex_file == dex_file) {
+          return true;
+        }
+      } else if (outer_dex_file->GetOatDexFile() == nullptr) {
+        // Cannot tell which dex file the index refers to, assume it is the method's.
+        return true;
+      } else {
+        const OatFile* oat_file = outer_dex_file->GetOatDexFile()->GetOatFile();
+        DCHECK_LT(dex_file_index, oat_file->GetOatDexFiles().size());
+        if (oat_file->GetOatDexFiles()[dex_file_index] == dex_file->GetOatDexFile()) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace art
@@ -19,6 +19,7 @@
 
 #include "arch/instruction_set.h"
 #include "base/macros.h"
+#include "base/mutex.h"
 #include "quick/quick_method_frame_info.h"
 #include "stack_map.h"
 #include "utils.h"
@@ -125,6 +126,11 @@ class PACKED(4) OatQuickMethodHeader {
 
   uint32_t ToDexPc(ArtMethod* method, const uintptr_t pc, bool abort_on_failure = true) const;
 
+  // Whether this code of `outer_method` has `method` inlined at any depth, according to the
+  // inline info of its stack maps.
+  bool HasInlinedMethod(ArtMethod* outer_method, ArtMethod* method) const
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // The offset in bytes from the start of the vmap table to the end of the header.
   uint32_t vmap_table_offset_;
   // The stack frame information.
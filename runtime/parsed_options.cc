@@ -114,6 +114,15 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:ForegroundHeapGrowthMultiplier=_")
           .WithType<double>().WithRange(0.1, 1.0)
           .IntoKey(M::ForegroundHeapGrowthMultiplier)
+      .Define("-XX:GcCpuTargetFraction=_")
+          .WithType<double>().WithRange(0.01, 0.9)
+          .IntoKey(M::GcCpuTargetFraction)
+      .Define("-XX:GcPauseTarget=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::GcPauseTarget)
+      .Define("-XX:AllocSampleInterval=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::AllocSampleInterval)
       .Define("-XX:ParallelGCThreads=_")
           .WithType<unsigned int>()
           .IntoKey(M::ParallelGCThreads)
@@ -140,6 +149,10 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .IntoKey(M::IgnoreMaxFootprint)
       .Define("-XX:LowMemoryMode")
           .IntoKey(M::LowMemoryMode)
+      .Define("-XX:HeapHugePages")
+          .IntoKey(M::HeapHugePages)
+      .Define("-XX:NumaAwareGc")
+          .IntoKey(M::NumaAwareGc)
       .Define("-XX:UseTLAB")
           .WithValue(true)
           .IntoKey(M::UseTLAB)
@@ -150,10 +163,28 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::DumpNativeStackOnSigQuit)
+      .Define("-XX:DumpClassHistogramOnSigQuit:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::DumpClassHistogramOnSigQuit)
+      .Define("-XX:MaxStackTraceDepth=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::MaxStackTraceDepth)
       .Define("-Xusejit:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
           .IntoKey(M::UseJitCompilation)
+      .Define("-Xjittiered:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::UseTieredJitCompilation)
+      .Define("-Xjitwarmupfromprofile:_")
+          .WithType<bool>()
+          .WithValueMap({{"false", false}, {"true", true}})
+          .IntoKey(M::JITWarmupFromProfile)
+      .Define("-Xjitzygoteprofile:_")
+          .WithType<std::string>()
+          .IntoKey(M::JITZygoteProfile)
       .Define("-Xjitinitialsize:_")
           .WithType<MemoryKiB>()
           .IntoKey(M::JITCodeCacheInitialCapacity)
@@ -175,6 +206,13 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjittransitionweight:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITInvokeTransitionWeight)
+      .Define("-Xjitthreads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITPoolThreads)
+      .Define("-Xjitperfmap")
+          .IntoKey(M::JITPerfMap)
+      .Define("-Xjitdump")
+          .IntoKey(M::JITDump)
       .Define("-Xjitsaveprofilinginfo")
           .WithType<ProfileSaverOptions>()
           .AppendValues()
@@ -230,9 +268,29 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xlockprofthreshold:_")
           .WithType<unsigned int>()
           .IntoKey(M::LockProfThreshold)
+      .Define("-Xlockcontentionprofile")
+          .IntoKey(M::LockContentionProfile)
+      .Define("-Xsuspendlatencyprofile")
+          .IntoKey(M::SuspendLatencyProfile)
+      .Define("-Xopcodepairprofile")
+          .IntoKey(M::OpcodePairProfile)
+      .Define("-Xinterpreterprofile")
+          .IntoKey(M::InterpreterProfile)
+      .Define("-Xforkheapdumps")
+          .IntoKey(M::ForkHeapDumps)
+      .Define("-Xbackgroundverification")
+          .IntoKey(M::BackgroundVerification)
+      .Define("-Xdebuggerkeepscompiledcode")
+          .IntoKey(M::DebuggerKeepsCompiledCode)
+      .Define("-Xthreadstackpool:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::ThreadStackPoolSize)
       .Define("-Xstacktracefile:_")
           .WithType<std::string>()
           .IntoKey(M::StackTraceFile)
+      .Define("-Xstartup-trace-file:_")
+          .WithType<std::string>()
+          .IntoKey(M::StartupTraceFile)
       .Define("-Xmethod-trace")
           .IntoKey(M::MethodTrace)
       .Define("-Xmethod-trace-file:_")
@@ -649,6 +707,15 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xzygote\n");
   UsageMessage(stream, "  -Xjnitrace:substring (eg NativeClass or nativeMethod)\n");
   UsageMessage(stream, "  -Xstacktracefile:<filename>\n");
+  UsageMessage(stream, "  -Xstartup-trace-file:<filename>\n");
+  UsageMessage(stream, "  -Xlockcontentionprofile\n");
+  UsageMessage(stream, "  -Xsuspendlatencyprofile\n");
+  UsageMessage(stream, "  -Xopcodepairprofile\n");
+  UsageMessage(stream, "  -Xinterpreterprofile\n");
+  UsageMessage(stream, "  -Xforkheapdumps\n");
+  UsageMessage(stream, "  -Xbackgroundverification\n");
+  UsageMessage(stream, "  -Xdebuggerkeepscompiledcode\n");
+  UsageMessage(stream, "  -Xthreadstackpool:<number of exited threads to keep the stacks of>\n");
   UsageMessage(stream, "  -Xgc:[no]preverify\n");
   UsageMessage(stream, "  -Xgc:[no]postverify\n");
   UsageMessage(stream, "  -XX:HeapGrowthLimit=N\n");
@@ -658,6 +725,8 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:HeapTargetUtilization=doublevalue\n");
   UsageMessage(stream, "  -XX:ForegroundHeapGrowthMultiplier=doublevalue\n");
   UsageMessage(stream, "  -XX:LowMemoryMode\n");
+  UsageMessage(stream, "  -XX:HeapHugePages\n");
+  UsageMessage(stream, "  -XX:NumaAwareGc\n");
   UsageMessage(stream, "  -Xprofile:{threadcpuclock,wallclock,dualclock}\n");
   UsageMessage(stream, "  -Xjitthreshold:integervalue\n");
   UsageMessage(stream, "\n");
@@ -676,6 +745,9 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
+  UsageMessage(stream, "  -XX:GcCpuTargetFraction=doublevalue\n");
+  UsageMessage(stream, "  -XX:GcPauseTarget=integervalue\n");
+  UsageMessage(stream, "  -XX:AllocSampleInterval=N (for example 512K, 0 disables sampling)\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
@@ -684,6 +756,8 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:LargeObjectSpace={disabled,map,freelist}\n");
   UsageMessage(stream, "  -XX:LargeObjectThreshold=N\n");
   UsageMessage(stream, "  -XX:DumpNativeStackOnSigQuit=booleanvalue\n");
+  UsageMessage(stream, "  -XX:DumpClassHistogramOnSigQuit=booleanvalue\n");
+  UsageMessage(stream, "  -XX:MaxStackTraceDepth=integervalue\n");
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename");
   UsageMessage(stream, "  -Xmethod-trace-file-size:integervalue\n");
@@ -704,6 +778,12 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -Xjittiered:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitthreads:integervalue\n");
+  UsageMessage(stream, "  -Xjitwarmupfromprofile:booleanvalue\n");
+  UsageMessage(stream, "  -Xjitzygoteprofile:filename\n");
+  UsageMessage(stream, "  -Xjitperfmap (write /tmp/perf-<pid>.map for perf report)\n");
+  UsageMessage(stream, "  -Xjitdump (write jit-<pid>.dump for perf inject --jit)\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
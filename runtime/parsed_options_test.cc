@@ -21,6 +21,7 @@
 #include "arch/instruction_set.h"
 #include "base/stringprintf.h"
 #include "common_runtime_test.h"
+#include "gc/heap.h"
 
 namespace art {
 
@@ -128,6 +129,31 @@ TEST_F(ParsedOptionsTest, ParsedOptionsGc) {
   EXPECT_EQ(gc::kCollectorTypeMC, xgc.collector_type_);
 }
 
+TEST_F(ParsedOptionsTest, ParsedOptionsGcErgonomics) {
+  using Opt = RuntimeArgumentMap;
+
+  {
+    // The ergonomics are off by default.
+    RuntimeOptions options;
+    RuntimeArgumentMap map;
+    bool parsed = ParsedOptions::Parse(options, false, &map);
+    ASSERT_TRUE(parsed);
+    EXPECT_DOUBLE_EQ(gc::Heap::kDefaultGcCpuTargetFraction,
+                     map.GetOrDefault(Opt::GcCpuTargetFraction));
+    EXPECT_EQ(gc::Heap::kDefaultGcPauseTarget,
+              map.GetOrDefault(Opt::GcPauseTarget).GetNanoseconds());
+  }
+
+  RuntimeOptions options;
+  options.push_back(std::make_pair("-XX:GcCpuTargetFraction=0.25", nullptr));
+  options.push_back(std::make_pair("-XX:GcPauseTarget=3", nullptr));
+  RuntimeArgumentMap map;
+  bool parsed = ParsedOptions::Parse(options, false, &map);
+  ASSERT_TRUE(parsed);
+  EXPECT_DOUBLE_EQ(0.25, map.GetOrDefault(Opt::GcCpuTargetFraction));
+  EXPECT_EQ(MsToNs(3), map.GetOrDefault(Opt::GcPauseTarget).GetNanoseconds());
+}
+
 TEST_F(ParsedOptionsTest, ParsedOptionsInstructionSet) {
   using Opt = RuntimeArgumentMap;
 
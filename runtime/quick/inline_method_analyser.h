@@ -86,6 +86,7 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicRoundFloat,
   kIntrinsicRoundDouble,
   kIntrinsicReferenceGetReferent,
+  kIntrinsicObjectClone,
   kIntrinsicCharAt,
   kIntrinsicCompareTo,
   kIntrinsicEquals,
@@ -95,6 +96,8 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicNewStringFromBytes,
   kIntrinsicNewStringFromChars,
   kIntrinsicNewStringFromString,
+  kIntrinsicStringBuilderAppend,
+  kIntrinsicStringBuilderToString,
   kIntrinsicCurrentThread,
   kIntrinsicPeek,
   kIntrinsicPoke,
@@ -112,9 +115,18 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicUnsafeStoreFence,
   kIntrinsicUnsafeFullFence,
 
+  kIntrinsicSystemArrayCopyByteArray,
   kIntrinsicSystemArrayCopyCharArray,
+  kIntrinsicSystemArrayCopyIntArray,
+  kIntrinsicSystemArrayCopyLongArray,
   kIntrinsicSystemArrayCopy,
 
+  kIntrinsicArraysEquals,
+  kIntrinsicArraysFill,
+
+  kIntrinsicCRC32Update,
+  kIntrinsicCRC32UpdateBytes,
+
   kInlineOpNop,
   kInlineOpReturnArg,
   kInlineOpNonWideConst,
@@ -157,6 +169,13 @@ enum IntrinsicFlags {
 
   // kIntrinsicDoubleCvt, kIntrinsicFloatCvt.
   kIntrinsicFlagToFloatingPoint = kIntrinsicFlagMin,
+
+  // kIntrinsicStringBuilderAppend, the type of the appended value.
+  kIntrinsicFlagAppendString  = kIntrinsicFlagNone,
+  kIntrinsicFlagAppendBoolean = 1,
+  kIntrinsicFlagAppendChar    = 2,
+  kIntrinsicFlagAppendInt     = 3,
+  kIntrinsicFlagAppendLong    = 4,
 };
 
 struct InlineIGetIPutData {
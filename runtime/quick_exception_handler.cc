@@ -98,10 +98,16 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
  private:
   bool HandleTryItems(ArtMethod* method)
       SHARED_REQUIRES(Locks::mutator_lock_) {
-    uint32_t dex_pc = DexFile::kDexNoIndex;
-    if (!method->IsNative()) {
-      dex_pc = GetDexPc();
+    if (method->IsNative()) {
+      return true;  // Continue stack walk.
     }
+    const DexFile::CodeItem* code_item = method->GetCodeItem();
+    if (code_item != nullptr && code_item->tries_size_ == 0) {
+      // No catch handler, do not compute the dex pc of the frame.
+      MaybeRemoveDebuggerShadowFrame();
+      return true;  // Continue stack walk.
+    }
+    uint32_t dex_pc = GetDexPc();
     if (dex_pc != DexFile::kDexNoIndex) {
       bool clear_exception = false;
       StackHandleScope<1> hs(GetThread());
@@ -117,20 +123,25 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
         exception_handler_->SetHandlerQuickFrame(GetCurrentQuickFrame());
         exception_handler_->SetHandlerMethodHeader(GetCurrentOatQuickMethodHeader());
         return false;  // End stack walk.
-      } else if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
-        // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
-        size_t frame_id = GetFrameId();
-        ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
-        if (frame != nullptr) {
-          // We will not execute this shadow frame so we can safely deallocate it.
-          GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
-          ShadowFrame::DeleteDeoptimizedFrame(frame);
-        }
       }
+      MaybeRemoveDebuggerShadowFrame();
     }
     return true;  // Continue stack walk.
   }
 
+  void MaybeRemoveDebuggerShadowFrame() SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
+      // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
+      size_t frame_id = GetFrameId();
+      ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
+      if (frame != nullptr) {
+        // We will not execute this shadow frame so we can safely deallocate it.
+        GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
+        ShadowFrame::DeleteDeoptimizedFrame(frame);
+      }
+    }
+  }
+
   // The exception we're looking for the catch block of.
   Handle<mirror::Throwable>* exception_;
   // The quick exception handler we're visiting for.
@@ -436,8 +447,8 @@ class DeoptimizeStackVisitor FINAL : public StackVisitor {
           const uint8_t* addr = reinterpret_cast<const uint8_t*>(GetCurrentQuickFrame()) + offset;
           value = *reinterpret_cast<const uint32_t*>(addr);
           uint32_t bit = (offset >> 2);
-          if (stack_map.GetNumberOfStackMaskBits(encoding.stack_map_encoding) > bit &&
-              stack_map.GetStackMaskBit(encoding.stack_map_encoding, bit)) {
+          MemoryRegion stack_mask = code_info.GetStackMaskOf(stack_map, encoding);
+          if (stack_mask.size_in_bits() > bit && stack_mask.LoadBit(bit)) {
             is_reference = true;
           }
           break;
@@ -542,8 +553,16 @@ void QuickExceptionHandler::DeoptimizeSingleFrame() {
   ArtMethod* deopt_method = visitor.GetSingleFrameDeoptMethod();
   DCHECK(deopt_method != nullptr);
   if (Runtime::Current()->UseJitCompilation()) {
-    Runtime::Current()->GetJit()->GetCodeCache()->InvalidateCompiledCodeFor(
-        deopt_method, visitor.GetSingleFrameDeoptQuickMethodHeader());
+    jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
+    const OatQuickMethodHeader* header = visitor.GetSingleFrameDeoptQuickMethodHeader();
+    // The class hierarchy analysis invalidates the code before flagging its frames, so a frame
+    // leaving code that is still installed failed one of its own speculative checks. Only those
+    // count against the method: loading an overriding class is not a wrong speculation.
+    bool failed_speculation = code_cache->IsInstalledCode(deopt_method, header);
+    code_cache->InvalidateCompiledCodeFor(deopt_method, header);
+    if (failed_speculation) {
+      code_cache->NotifySpeculativeDeoptimization(self_, deopt_method);
+    }
   } else {
     // Transfer the code to interpreter.
     Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
@@ -34,6 +34,13 @@
 
 namespace art {
 
+// Returns the box class declaring the given valueOf method. Comparing the class of an argument
+// with it is much cheaper than comparing descriptors, and it stays right when the class moves.
+static inline mirror::Class* GetBoxClass(jmethodID value_of)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  return reinterpret_cast<ArtMethod*>(value_of)->GetDeclaringClass();
+}
+
 class ArgArray {
  public:
   ArgArray(const char* shorty, uint32_t shorty_len)
@@ -239,14 +246,15 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
-          if (LIKELY(arg != nullptr && arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
+#define DO_FIRST_ARG(value_of, get_fn, append) { \
+          if (LIKELY(arg != nullptr && \
+                     arg->GetClass<>() == GetBoxClass(WellKnownClasses::value_of))) { \
             ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
             append(primitive_field-> get_fn(arg));
 
-#define DO_ARG(match_descriptor, get_fn, append) \
+#define DO_ARG(value_of, get_fn, append) \
           } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
+                            arg->GetClass<>() == GetBoxClass(WellKnownClasses::value_of))) { \
             ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
             append(primitive_field-> get_fn(arg));
 
@@ -272,54 +280,54 @@ class ArgArray {
           Append(arg);
           break;
         case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
+          DO_FIRST_ARG(java_lang_Boolean_valueOf, GetBoolean, Append)
           DO_FAIL("boolean")
           break;
         case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("byte")
           break;
         case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
+          DO_FIRST_ARG(java_lang_Character_valueOf, GetChar, Append)
           DO_FAIL("char")
           break;
         case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(java_lang_Short_valueOf, GetShort, Append)
+          DO_ARG(java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("short")
           break;
         case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
+          DO_FIRST_ARG(java_lang_Integer_valueOf, GetInt, Append)
+          DO_ARG(java_lang_Character_valueOf, GetChar, Append)
+          DO_ARG(java_lang_Short_valueOf, GetShort, Append)
+          DO_ARG(java_lang_Byte_valueOf, GetByte, Append)
           DO_FAIL("int")
           break;
         case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
+          DO_FIRST_ARG(java_lang_Long_valueOf, GetLong, AppendWide)
+          DO_ARG(java_lang_Integer_valueOf, GetInt, AppendWide)
+          DO_ARG(java_lang_Character_valueOf, GetChar, AppendWide)
+          DO_ARG(java_lang_Short_valueOf, GetShort, AppendWide)
+          DO_ARG(java_lang_Byte_valueOf, GetByte, AppendWide)
           DO_FAIL("long")
           break;
         case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
+          DO_FIRST_ARG(java_lang_Float_valueOf, GetFloat, AppendFloat)
+          DO_ARG(java_lang_Long_valueOf, GetLong, AppendFloat)
+          DO_ARG(java_lang_Integer_valueOf, GetInt, AppendFloat)
+          DO_ARG(java_lang_Character_valueOf, GetChar, AppendFloat)
+          DO_ARG(java_lang_Short_valueOf, GetShort, AppendFloat)
+          DO_ARG(java_lang_Byte_valueOf, GetByte, AppendFloat)
           DO_FAIL("float")
           break;
         case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
+          DO_FIRST_ARG(java_lang_Double_valueOf, GetDouble, AppendDouble)
+          DO_ARG(java_lang_Float_valueOf, GetFloat, AppendDouble)
+          DO_ARG(java_lang_Long_valueOf, GetLong, AppendDouble)
+          DO_ARG(java_lang_Integer_valueOf, GetInt, AppendDouble)
+          DO_ARG(java_lang_Character_valueOf, GetChar, AppendDouble)
+          DO_ARG(java_lang_Short_valueOf, GetShort, AppendDouble)
+          DO_ARG(java_lang_Byte_valueOf, GetByte, AppendDouble)
           DO_FAIL("double")
           break;
 #ifndef NDEBUG
@@ -792,28 +800,28 @@ static bool UnboxPrimitive(mirror::Object* o,
   mirror::Class* src_class = nullptr;
   ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
   ArtField* primitive_field = &klass->GetIFieldsPtr()->At(0);
-  if (klass->DescriptorEquals("Ljava/lang/Boolean;")) {
+  if (klass == GetBoxClass(WellKnownClasses::java_lang_Boolean_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('Z');
     boxed_value.SetZ(primitive_field->GetBoolean(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Byte;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Byte_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('B');
     boxed_value.SetB(primitive_field->GetByte(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Character;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Character_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('C');
     boxed_value.SetC(primitive_field->GetChar(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Float;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Float_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('F');
     boxed_value.SetF(primitive_field->GetFloat(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Double;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Double_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('D');
     boxed_value.SetD(primitive_field->GetDouble(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Integer;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Integer_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('I');
     boxed_value.SetI(primitive_field->GetInt(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Long;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Long_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('J');
     boxed_value.SetJ(primitive_field->GetLong(o));
-  } else if (klass->DescriptorEquals("Ljava/lang/Short;")) {
+  } else if (klass == GetBoxClass(WellKnownClasses::java_lang_Short_valueOf)) {
     src_class = class_linker->FindPrimitiveClass('S');
     boxed_value.SetS(primitive_field->GetShort(o));
   } else {
@@ -54,11 +54,14 @@
 #include "asm_support.h"
 #include "atomic.h"
 #include "base/arena_allocator.h"
+#include "base/contention_profiler.h"
 #include "base/dumpable.h"
 #include "base/enums.h"
+#include "base/startup_trace.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/unix_file/fd_file.h"
+#include "cha.h"
 #include "class_linker-inl.h"
 #include "compiler_callbacks.h"
 #include "debugger.h"
@@ -74,7 +77,10 @@
 #include "image-inl.h"
 #include "instrumentation.h"
 #include "intern_table.h"
+#include "interpreter/dispatch_profiler.h"
 #include "interpreter/interpreter.h"
+#include "interpreter/opcode_pair_profiler.h"
+#include "jdwp/object_registry.h"
 #include "jit/jit.h"
 #include "jni_internal.h"
 #include "linear_alloc.h"
@@ -129,8 +135,11 @@
 #include "sigchain.h"
 #include "signal_catcher.h"
 #include "signal_set.h"
+#include "suspend_latency_profiler.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
+#include "thread_stack_pool.h"
 #include "trace.h"
 #include "transaction.h"
 #include "utils.h"
@@ -147,6 +156,9 @@ static constexpr double kLowMemoryMinLoadFactor = 0.5;
 static constexpr double kLowMemoryMaxLoadFactor = 0.8;
 static constexpr double kNormalMinLoadFactor = 0.4;
 static constexpr double kNormalMaxLoadFactor = 0.7;
+
+// Number of classes with the most bytes to print in the class histogram on SIGQUIT.
+static constexpr size_t kMaxSigQuitHistogramClasses = 50;
 Runtime* Runtime::instance_ = nullptr;
 
 struct TraceConfig {
@@ -210,9 +222,15 @@ Runtime::Runtime()
       zygote_max_failed_boots_(0),
       experimental_flags_(ExperimentalFlags::kNone),
       oat_file_manager_(nullptr),
+      cha_(nullptr),
       is_low_memory_mode_(false),
       safe_mode_(false),
       dump_native_stack_on_sig_quit_(true),
+      dump_class_histogram_on_sig_quit_(false),
+      max_stack_trace_depth_(0u),
+      fork_heap_dumps_(false),
+      background_verification_(false),
+      debugger_keeps_compiled_code_(false),
       pruned_dalvik_cache_(false),
       // Initially assume we perceive jank in case the process state is never updated.
       process_state_(kProcessStateJankPerceptible),
@@ -281,6 +299,7 @@ Runtime::~Runtime() {
     // Similarly, stop the profile saver thread before deleting the thread list.
     jit_->StopProfileSaver();
   }
+  class_linker_->StopBackgroundVerification(Thread::Current());
 
   // Make sure our internal threads are dead before we start tearing down things they're using.
   Dbg::StopJdwp();
@@ -291,6 +310,8 @@ Runtime::~Runtime() {
     ScopedTrace trace2("Delete thread list");
     delete thread_list_;
   }
+  // All threads that could still run on a pooled stack have exited or are suspended for good.
+  thread_stack_pool_.reset();
   // Delete the JIT after thread list to ensure that there is no remaining threads which could be
   // accessing the instrumentation when we delete it.
   if (jit_ != nullptr) {
@@ -309,6 +330,7 @@ Runtime::~Runtime() {
   delete intern_table_;
   delete java_vm_;
   delete oat_file_manager_;
+  delete cha_;
   Thread::Shutdown();
   QuasiAtomic::Shutdown();
   verifier::MethodVerifier::Shutdown();
@@ -427,6 +449,9 @@ void Runtime::Abort() {
 }
 
 void Runtime::PreZygoteFork() {
+  if (jit_ != nullptr) {
+    jit_->PreZygoteFork();
+  }
   heap_->PreZygoteFork();
 }
 
@@ -438,12 +463,84 @@ void Runtime::CallExitHook(jint status) {
   }
 }
 
-void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
+// The system weak tables other than the intern table. Each of them has its own lock, so they can
+// be swept in parallel.
+typedef void (*SystemWeakSweeper)(Runtime* runtime, IsMarkedVisitor* visitor);
+
+static void SweepMonitors(Runtime* runtime, IsMarkedVisitor* visitor)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  runtime->GetMonitorList()->SweepMonitorList(visitor);
+  if (runtime->GetMonitorList()->GetThinLockHashes() != nullptr) {
+    runtime->GetMonitorList()->GetThinLockHashes()->Sweep(visitor);
+  }
+}
+
+static void SweepJniWeakGlobals(Runtime* runtime, IsMarkedVisitor* visitor)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  runtime->GetJavaVM()->SweepJniWeakGlobals(visitor);
+}
+
+static void SweepAllocationRecords(Runtime* runtime, IsMarkedVisitor* visitor)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  runtime->GetHeap()->SweepAllocationRecords(visitor);
+}
+
+static void SweepLambdaBoxes(Runtime* runtime, IsMarkedVisitor* visitor)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  runtime->GetLambdaBoxTable()->SweepWeakBoxedLambdas(visitor);
+}
+
+static void SweepDebuggerObjects(Runtime* runtime ATTRIBUTE_UNUSED, IsMarkedVisitor* visitor)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  if (Dbg::GetObjectRegistry() != nullptr) {
+    Dbg::GetObjectRegistry()->SweepWeaks(visitor);
+  }
+}
+
+static constexpr SystemWeakSweeper kSystemWeakSweepers[] = {
+  SweepMonitors,
+  SweepJniWeakGlobals,
+  SweepAllocationRecords,
+  SweepLambdaBoxes,
+  SweepDebuggerObjects,
+};
+
+class SweepSystemWeaksTask FINAL : public SelfDeletingTask {
+ public:
+  SweepSystemWeaksTask(Runtime* runtime, IsMarkedVisitor* visitor, SystemWeakSweeper sweeper)
+      : runtime_(runtime), visitor_(visitor), sweeper_(sweeper) {}
+
+  // The thread that waits for the task holds the locks required by the visitor.
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    sweeper_(runtime_, visitor_);
+  }
+
+ private:
+  Runtime* const runtime_;
+  IsMarkedVisitor* const visitor_;
+  const SystemWeakSweeper sweeper_;
+
+  DISALLOW_COPY_AND_ASSIGN(SweepSystemWeaksTask);
+};
+
+void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor, ThreadPool* thread_pool) {
+  if (thread_pool == nullptr) {
+    GetInternTable()->SweepInternTableWeaks(visitor);
+    for (SystemWeakSweeper sweeper : kSystemWeakSweepers) {
+      sweeper(this, visitor);
+    }
+    return;
+  }
+  Thread* const self = Thread::Current();
+  for (SystemWeakSweeper sweeper : kSystemWeakSweepers) {
+    thread_pool->AddTask(self, new SweepSystemWeaksTask(this, visitor, sweeper));
+  }
+  thread_pool->StartWorkers(self);
+  // Hashing the interned strings checks that the mutator lock is held, so the intern table, which
+  // usually is the largest one, is swept by this thread while the workers sweep the others.
   GetInternTable()->SweepInternTableWeaks(visitor);
-  GetMonitorList()->SweepMonitorList(visitor);
-  GetJavaVM()->SweepJniWeakGlobals(visitor);
-  GetHeap()->SweepAllocationRecords(visitor);
-  GetLambdaBoxTable()->SweepWeakBoxedLambdas(visitor);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
 }
 
 bool Runtime::ParseOptions(const RuntimeOptions& raw_options,
@@ -463,6 +560,10 @@ bool Runtime::Create(RuntimeArgumentMap&& runtime_options) {
   if (Runtime::instance_ != nullptr) {
     return false;
   }
+  if (runtime_options.Exists(RuntimeArgumentMap::StartupTraceFile)) {
+    // Start before Init() so that all of it is recorded.
+    StartupTrace::Start();
+  }
   instance_ = new Runtime;
   if (!instance_->Init(std::move(runtime_options))) {
     // TODO: Currently deleting the instance will abort the runtime on destruction. Now This will
@@ -568,6 +669,10 @@ bool Runtime::Start() {
     // If we are the zygote then we need to wait until after forking to create the code cache
     // due to SELinux restrictions on r/w/x memory regions.
       CreateJit();
+    } else if (jit_options_->UseJitCompilation() && !jit_options_->GetZygoteProfile().empty()) {
+      // The zygote compiles the hot methods of the profile for all its children, the device
+      // lets it create the code cache.
+      CreateJit();
     } else if (jit_options_->UseJitCompilation()) {
       if (!jit::Jit::LoadCompilerLibrary(&error_msg)) {
         // Try to load compiler pre zygote to reduce PSS. b/27744947
@@ -600,7 +705,10 @@ bool Runtime::Start() {
 
   Thread::FinishStartup();
 
-  system_class_loader_ = CreateSystemClassLoader(this);
+  {
+    ScopedTrace trace2("CreateSystemClassLoader");
+    system_class_loader_ = CreateSystemClassLoader(this);
+  }
 
   if (is_zygote_) {
     if (!InitZygote()) {
@@ -629,6 +737,13 @@ bool Runtime::Start() {
   VLOG(startup) << "Runtime::Start exiting";
   finished_starting_ = true;
 
+  if (!startup_trace_file_.empty()) {
+    std::string error_msg;
+    if (!StartupTrace::StopAndWrite(startup_trace_file_, &error_msg)) {
+      LOG(WARNING) << error_msg;
+    }
+  }
+
   if (trace_config_.get() != nullptr && trace_config_->trace_file != "") {
     ScopedThreadStateChange tsc(self, kWaitingForMethodTracingStart);
     Trace::Start(trace_config_->trace_file.c_str(),
@@ -716,11 +831,19 @@ void Runtime::InitNonZygoteOrPostFork(
 
   if (!is_system_server &&
       !safe_mode_ &&
-      (jit_options_->UseJitCompilation() || jit_options_->GetSaveProfilingInfo()) &&
-      jit_.get() == nullptr) {
+      (jit_options_->UseJitCompilation() || jit_options_->GetSaveProfilingInfo())) {
     // Note that when running ART standalone (not zygote, nor zygote fork),
-    // the jit may have already been created.
-    CreateJit();
+    // the jit may have already been created. So may it have been by the zygote, for
+    // the code it shares with us.
+    if (jit_.get() == nullptr) {
+      CreateJit();
+    } else {
+      jit_->PostZygoteFork();
+    }
+  }
+
+  if (background_verification_ && !is_system_server && IsVerificationEnabled()) {
+    class_linker_->StartBackgroundVerification(Thread::Current());
   }
 
   StartSignalCatcher();
@@ -907,9 +1030,23 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   QuasiAtomic::Startup();
 
   oat_file_manager_ = new OatFileManager;
+  cha_ = new ClassHierarchyAnalysis;
 
   Thread::SetSensitiveThreadHook(runtime_options.GetOrDefault(Opt::HookIsSensitiveThread));
   Monitor::Init(runtime_options.GetOrDefault(Opt::LockProfThreshold));
+  if (runtime_options.Exists(Opt::LockContentionProfile)) {
+    ContentionProfiler::SetEnabled(true);
+  }
+  if (runtime_options.Exists(Opt::SuspendLatencyProfile)) {
+    SuspendLatencyProfiler::SetEnabled(true);
+  }
+  if (runtime_options.Exists(Opt::OpcodePairProfile)) {
+    // Before any thread is attached, the threads pick their mterp handler table when attaching.
+    interpreter::OpcodePairProfiler::SetEnabled(true);
+  }
+  if (runtime_options.Exists(Opt::InterpreterProfile)) {
+    interpreter::DispatchProfiler::SetEnabled(true);
+  }
 
   boot_class_path_string_ = runtime_options.ReleaseOrDefault(Opt::BootClassPath);
   class_path_string_ = runtime_options.ReleaseOrDefault(Opt::ClassPath);
@@ -923,6 +1060,12 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::Dex2Oat);
   image_dex2oat_enabled_ = runtime_options.GetOrDefault(Opt::ImageDex2Oat);
   dump_native_stack_on_sig_quit_ = runtime_options.GetOrDefault(Opt::DumpNativeStackOnSigQuit);
+  dump_class_histogram_on_sig_quit_ =
+      runtime_options.GetOrDefault(Opt::DumpClassHistogramOnSigQuit);
+  max_stack_trace_depth_ = runtime_options.GetOrDefault(Opt::MaxStackTraceDepth);
+  fork_heap_dumps_ = runtime_options.Exists(Opt::ForkHeapDumps);
+  background_verification_ = runtime_options.Exists(Opt::BackgroundVerification);
+  debugger_keeps_compiled_code_ = runtime_options.Exists(Opt::DebuggerKeepsCompiledCode);
 
   vfprintf_ = runtime_options.GetOrDefault(Opt::HookVfprintf);
   exit_ = runtime_options.GetOrDefault(Opt::HookExit);
@@ -930,6 +1073,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   default_stack_size_ = runtime_options.GetOrDefault(Opt::StackSize);
   stack_trace_file_ = runtime_options.ReleaseOrDefault(Opt::StackTraceFile);
+  startup_trace_file_ = runtime_options.ReleaseOrDefault(Opt::StartupTraceFile);
 
   compiler_executable_ = runtime_options.ReleaseOrDefault(Opt::Compiler);
   compiler_options_ = runtime_options.ReleaseOrDefault(Opt::CompilerOptions);
@@ -942,6 +1086,10 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
   thread_list_ = new ThreadList;
+  if (runtime_options.GetOrDefault(Opt::ThreadStackPoolSize) != 0u) {
+    thread_stack_pool_.reset(
+        new ThreadStackPool(runtime_options.GetOrDefault(Opt::ThreadStackPoolSize)));
+  }
   intern_table_ = new InternTable;
 
   verify_ = runtime_options.GetOrDefault(Opt::Verify);
@@ -992,6 +1140,13 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        xgc_option.verify_post_gc_rosalloc_,
                        xgc_option.gcstress_,
                        xgc_option.measure_,
+                       xgc_option.generational_cc_,
+                       xgc_option.concurrent_mark_compact_,
+                       runtime_options.Exists(Opt::HeapHugePages),
+                       runtime_options.Exists(Opt::NumaAwareGc),
+                       runtime_options.GetOrDefault(Opt::GcCpuTargetFraction),
+                       runtime_options.GetOrDefault(Opt::GcPauseTarget),
+                       runtime_options.GetOrDefault(Opt::AllocSampleInterval),
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
                        runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
 
@@ -1047,6 +1202,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
       implicit_null_checks_ = true;
       // Installing stack protection does not play well with valgrind.
       implicit_so_checks_ = !(RUNNING_ON_MEMORY_TOOL && kMemoryToolIsValgrind);
+      // Only the optimizing code generators of these emit implicit suspend checks.
+      implicit_suspend_checks_ = (kRuntimeISA == kArm64 || kRuntimeISA == kX86_64);
       break;
     default:
       // Keep the defaults.
@@ -1108,6 +1265,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   class_linker_ = new ClassLinker(intern_table_);
   if (GetHeap()->HasBootImageSpace()) {
     std::string error_msg;
+    ScopedTrace trace2("InitFromBootImage");
     bool result = class_linker_->InitFromBootImage(&error_msg);
     if (!result) {
       LOG(ERROR) << "Could not initialize from image: " << error_msg;
@@ -1360,6 +1518,10 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   GetInternTable()->DumpForSigQuit(os);
   GetJavaVM()->DumpForSigQuit(os);
   GetHeap()->DumpForSigQuit(os);
+  if (dump_class_histogram_on_sig_quit_) {
+    ScopedObjectAccess soa(Thread::Current());
+    GetHeap()->DumpClassHistogram(os, kMaxSigQuitHistogramClasses);
+  }
   oat_file_manager_->DumpForSigQuit(os);
   if (GetJit() != nullptr) {
     GetJit()->DumpForSigQuit(os);
@@ -1371,6 +1533,10 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
 
   thread_list_->DumpForSigQuit(os);
   BaseMutex::DumpAll(os);
+  ContentionProfiler::Dump(os);
+  SuspendLatencyProfiler::Dump(os);
+  interpreter::OpcodePairProfiler::Dump(os);
+  interpreter::DispatchProfiler::Dump(os);
 }
 
 void Runtime::DumpLockHolders(std::ostream& os) {
@@ -1547,6 +1713,10 @@ void Runtime::VisitTransactionRoots(RootVisitor* visitor) {
 
 void Runtime::VisitNonThreadRoots(RootVisitor* visitor) {
   java_vm_->VisitRoots(visitor);
+  // The objects the debugger disabled the collection of, like the JNI global references.
+  if (Dbg::GetObjectRegistry() != nullptr) {
+    Dbg::GetObjectRegistry()->VisitRoots(visitor);
+  }
   sentinel_.VisitRootIfNonNull(visitor, RootInfo(kRootVMInternal));
   pre_allocated_OutOfMemoryError_.VisitRootIfNonNull(visitor, RootInfo(kRootVMInternal));
   pre_allocated_NoClassDefFoundError_.VisitRootIfNonNull(visitor, RootInfo(kRootVMInternal));
@@ -1640,6 +1810,9 @@ void Runtime::DisallowNewSystemWeaks() {
   java_vm_->DisallowNewWeakGlobals();
   heap_->DisallowNewAllocationRecords();
   lambda_box_table_->DisallowNewWeakBoxedLambdas();
+  if (Dbg::GetObjectRegistry() != nullptr) {
+    Dbg::GetObjectRegistry()->DisallowNewWeaks();
+  }
 }
 
 void Runtime::AllowNewSystemWeaks() {
@@ -1649,6 +1822,9 @@ void Runtime::AllowNewSystemWeaks() {
   java_vm_->AllowNewWeakGlobals();
   heap_->AllowNewAllocationRecords();
   lambda_box_table_->AllowNewWeakBoxedLambdas();
+  if (Dbg::GetObjectRegistry() != nullptr) {
+    Dbg::GetObjectRegistry()->AllowNewWeaks();
+  }
 }
 
 void Runtime::BroadcastForNewSystemWeaks() {
@@ -1660,6 +1836,9 @@ void Runtime::BroadcastForNewSystemWeaks() {
   java_vm_->BroadcastForNewWeakGlobals();
   heap_->BroadcastForNewAllocationRecords();
   lambda_box_table_->BroadcastForNewWeakBoxedLambdas();
+  if (Dbg::GetObjectRegistry() != nullptr) {
+    Dbg::GetObjectRegistry()->BroadcastForNewWeaks();
+  }
 }
 
 void Runtime::SetInstructionSet(InstructionSet instruction_set) {
@@ -73,6 +73,7 @@ namespace verifier {
 }  // namespace verifier
 class ArenaPool;
 class ArtMethod;
+class ClassHierarchyAnalysis;
 class ClassLinker;
 class Closure;
 class CompilerCallbacks;
@@ -89,6 +90,8 @@ class SignalCatcher;
 class StackOverflowHandler;
 class SuspensionHandler;
 class ThreadList;
+class ThreadPool;
+class ThreadStackPool;
 class Trace;
 struct TraceConfig;
 class Transaction;
@@ -308,6 +311,11 @@ class Runtime {
     return thread_list_;
   }
 
+  // Null unless enabled with -Xthreadstackpool.
+  ThreadStackPool* GetThreadStackPool() const {
+    return thread_stack_pool_.get();
+  }
+
   static const char* GetVersion() {
     return "2.1.0";
   }
@@ -350,8 +358,10 @@ class Runtime {
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Sweep system weaks, the system weak is deleted if the visitor return null. Otherwise, the
-  // system weak is updated to be the visitor's returned value.
-  void SweepSystemWeaks(IsMarkedVisitor* visitor)
+  // system weak is updated to be the visitor's returned value. If `thread_pool` is not null, the
+  // tables are swept in parallel by its active workers, so the visitor must be thread safe. The
+  // caller keeps holding the locks that the visitor requires until all the tables are swept.
+  void SweepSystemWeaks(IsMarkedVisitor* visitor, ThreadPool* thread_pool = nullptr)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   // Constant roots are the roots which never change after the runtime is initialized, they only
@@ -522,6 +532,10 @@ class Runtime {
     return !implicit_so_checks_;
   }
 
+  bool ExplicitSuspendChecks() const {
+    return !implicit_suspend_checks_;
+  }
+
   bool IsVerificationEnabled() const;
   bool IsVerificationSoftFail() const;
 
@@ -606,6 +620,10 @@ class Runtime {
     return *oat_file_manager_;
   }
 
+  ClassHierarchyAnalysis* GetClassHierarchyAnalysis() {
+    return cha_;
+  }
+
   double GetHashTableMinLoadFactor() const;
   double GetHashTableMaxLoadFactor() const;
 
@@ -617,6 +635,27 @@ class Runtime {
     return dump_native_stack_on_sig_quit_;
   }
 
+  bool GetDumpClassHistogramOnSigQuit() const {
+    return dump_class_histogram_on_sig_quit_;
+  }
+
+  // Returns the maximum number of frames recorded in stack traces, 0 if there is no limit.
+  uint32_t GetMaxStackTraceDepth() const {
+    return max_stack_trace_depth_;
+  }
+
+  bool ShouldForkHeapDumps() const {
+    return fork_heap_dumps_;
+  }
+
+  bool UseBackgroundVerification() const {
+    return background_verification_;
+  }
+
+  bool DebuggerKeepsCompiledCode() const {
+    return debugger_keeps_compiled_code_;
+  }
+
   bool GetPrunedDalvikCache() const {
     return pruned_dalvik_cache_;
   }
@@ -728,6 +767,8 @@ class Runtime {
 
   ThreadList* thread_list_;
 
+  std::unique_ptr<ThreadStackPool> thread_stack_pool_;
+
   InternTable* intern_table_;
 
   ClassLinker* class_linker_;
@@ -735,6 +776,9 @@ class Runtime {
   SignalCatcher* signal_catcher_;
   std::string stack_trace_file_;
 
+  // Where to write the startup trace at the end of Start(), empty if not recording it.
+  std::string startup_trace_file_;
+
   JavaVMExt* java_vm_;
 
   std::unique_ptr<jit::Jit> jit_;
@@ -849,6 +893,9 @@ class Runtime {
   // Oat file manager, keeps track of what oat files are open.
   OatFileManager* oat_file_manager_;
 
+  // Single implementation state of the virtual methods, for JIT devirtualization.
+  ClassHierarchyAnalysis* cha_;
+
   // Whether or not we are on a low RAM device.
   bool is_low_memory_mode_;
 
@@ -858,6 +905,23 @@ class Runtime {
   // Whether threads should dump their native stack on SIGQUIT.
   bool dump_native_stack_on_sig_quit_;
 
+  // Whether the class histogram of the heap is dumped on SIGQUIT.
+  bool dump_class_histogram_on_sig_quit_;
+
+  // Maximum number of frames recorded in stack traces, 0 if there is no limit.
+  uint32_t max_stack_trace_depth_;
+
+  // Whether heap dumps to files are written by a forked process, see hprof::DumpHeap.
+  bool fork_heap_dumps_;
+
+  // Whether app classes are verified on background threads, see
+  // ClassLinker::StartBackgroundVerification.
+  bool background_verification_;
+
+  // Whether the non debuggable boot image code keeps running while a debugger is attached,
+  // breakpoints in the boot class path then deoptimize everything. See Dbg::GoActive.
+  bool debugger_keeps_compiled_code_;
+
   // Whether the dalvik cache was pruned when initializing the runtime.
   bool pruned_dalvik_cache_;
 
@@ -16,7 +16,6 @@
 
 #include "signal_catcher.h"
 
-#include <fcntl.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -25,11 +24,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <fstream>
 #include <sstream>
 
 #include "arch/instruction_set.h"
 #include "base/time_utils.h"
-#include "base/unix_file/fd_file.h"
 #include "class_linker.h"
 #include "gc/heap.h"
 #include "os.h"
@@ -99,35 +98,39 @@ bool SignalCatcher::ShouldHalt() {
   return halt_;
 }
 
-void SignalCatcher::Output(const std::string& s) {
+void SignalCatcher::HandleSigQuit() {
   if (stack_trace_file_.empty()) {
-    LOG(INFO) << s;
+    std::ostringstream os;
+    DumpForSigQuit(os);
+    LOG(INFO) << os.str();
     return;
   }
 
-  ScopedThreadStateChange tsc(Thread::Current(), kWaitingForSignalCatcherOutput);
-  int fd = open(stack_trace_file_.c_str(), O_APPEND | O_CREAT | O_WRONLY, 0666);
-  if (fd == -1) {
+  // Stream the dump to the file rather than buffering it, so that a reader sees the threads
+  // dumped so far even if the dump is slow or never completes.
+  std::ofstream os;
+  {
+    ScopedThreadStateChange tsc(Thread::Current(), kWaitingForSignalCatcherOutput);
+    os.open(stack_trace_file_, std::ios::out | std::ios::app);
+  }
+  if (!os.is_open()) {
     PLOG(ERROR) << "Unable to open stack trace file '" << stack_trace_file_ << "'";
     return;
   }
-  std::unique_ptr<File> file(new File(fd, stack_trace_file_, true));
-  bool success = file->WriteFully(s.data(), s.size());
-  if (success) {
-    success = file->FlushCloseOrErase() == 0;
-  } else {
-    file->Erase();
+  DumpForSigQuit(os);
+  {
+    ScopedThreadStateChange tsc(Thread::Current(), kWaitingForSignalCatcherOutput);
+    os.close();
   }
-  if (success) {
+  if (!os.fail()) {
     LOG(INFO) << "Wrote stack traces to '" << stack_trace_file_ << "'";
   } else {
     PLOG(ERROR) << "Failed to write stack traces to '" << stack_trace_file_ << "'";
   }
 }
 
-void SignalCatcher::HandleSigQuit() {
+void SignalCatcher::DumpForSigQuit(std::ostream& os) {
   Runtime* runtime = Runtime::Current();
-  std::ostringstream os;
   os << "\n"
       << "----- pid " << getpid() << " at " << GetIsoDate() << " -----\n";
 
@@ -139,7 +142,7 @@ void SignalCatcher::HandleSigQuit() {
   os << "Build fingerprint: '" << (fingerprint.empty() ? "unknown" : fingerprint) << "'\n";
   os << "ABI: '" << GetInstructionSetString(runtime->GetInstructionSet()) << "'\n";
 
-  os << "Build type: " << (kIsDebugBuild ? "debug" : "optimized") << "\n";
+  os << "Build type: " << (kIsDebugBuild ? "debug" : "optimized") << "\n" << std::flush;
 
   runtime->DumpForSigQuit(os);
 
@@ -150,7 +153,6 @@ void SignalCatcher::HandleSigQuit() {
     }
   }
   os << "----- end " << getpid() << " -----\n";
-  Output(os.str());
 }
 
 void SignalCatcher::HandleSigUsr1() {
@@ -43,8 +43,9 @@ class SignalCatcher {
   // NO_THREAD_SAFETY_ANALYSIS for static function calling into member function with excludes lock.
   static void* Run(void* arg) NO_THREAD_SAFETY_ANALYSIS;
 
+  void DumpForSigQuit(std::ostream& os) REQUIRES(!Locks::mutator_lock_, !Locks::thread_list_lock_,
+                                                 !Locks::thread_suspend_count_lock_);
   void HandleSigUsr1();
-  void Output(const std::string& s);
   void SetHaltFlag(bool new_value) REQUIRES(!lock_);
   bool ShouldHalt() REQUIRES(!lock_);
   int WaitForSignal(Thread* self, SignalSet& signals) REQUIRES(!lock_);
@@ -720,6 +720,17 @@ static uint32_t GetNumberOfReferenceArgsWithoutReceiver(ArtMethod* method)
   return refs;
 }
 
+uint8_t* StackVisitor::GetShouldDeoptimizeFlagAddr() const {
+  DCHECK(GetCurrentQuickFrame() != nullptr);
+  QuickMethodFrameInfo frame_info = GetCurrentQuickFrameInfo();
+  size_t callee_save_size =
+      POPCOUNT(frame_info.CoreSpillMask()) * GetBytesPerGprSpillLocation(kRuntimeISA) +
+      POPCOUNT(frame_info.FpSpillMask()) * GetBytesPerFprSpillLocation(kRuntimeISA);
+  DCHECK_GE(frame_info.FrameSizeInBytes(), callee_save_size + kShouldDeoptimizeFlagSize);
+  uint8_t* sp = reinterpret_cast<uint8_t*>(GetCurrentQuickFrame());
+  return sp + frame_info.FrameSizeInBytes() - callee_save_size - kShouldDeoptimizeFlagSize;
+}
+
 QuickMethodFrameInfo StackVisitor::GetCurrentQuickFrameInfo() const {
   if (cur_oat_quick_method_header_ != nullptr) {
     return cur_oat_quick_method_header_->GetFrameInfo();
@@ -746,12 +757,18 @@ QuickMethodFrameInfo StackVisitor::GetCurrentQuickFrameInfo() const {
     return runtime->GetCalleeSaveMethodFrameInfo(Runtime::kRefsAndArgs);
   }
 
-  // The only remaining case is if the method is native and uses the generic JNI stub.
+  // The only remaining case is if the method is native and uses the generic JNI stub. The
+  // method may have got a JIT compiled stub since this frame was built.
   DCHECK(method->IsNative());
-  ClassLinker* class_linker = runtime->GetClassLinker();
-  const void* entry_point = runtime->GetInstrumentation()->GetQuickCodeFor(method,
-                                                                           kRuntimePointerSize);
-  DCHECK(class_linker->IsQuickGenericJniStub(entry_point)) << PrettyMethod(method);
+  if (kIsDebugBuild) {
+    ClassLinker* class_linker = runtime->GetClassLinker();
+    const void* entry_point = runtime->GetInstrumentation()->GetQuickCodeFor(method,
+                                                                             kRuntimePointerSize);
+    jit::Jit* jit = runtime->GetJit();
+    DCHECK(class_linker->IsQuickGenericJniStub(entry_point) ||
+           (jit != nullptr && jit->GetCodeCache()->ContainsPc(entry_point)))
+        << PrettyMethod(method);
+  }
   // Generic JNI frame.
   uint32_t handle_refs = GetNumberOfReferenceArgsWithoutReceiver(method) + 1;
   size_t scope_size = HandleScope::SizeOf(handle_refs);
@@ -784,7 +801,13 @@ void StackVisitor::WalkStack(bool include_transitions) {
       DCHECK(current_fragment->GetTopShadowFrame() == nullptr);
       ArtMethod* method = *cur_quick_frame_;
       while (method != nullptr) {
-        cur_oat_quick_method_header_ = method->GetOatQuickMethodHeader(cur_quick_frame_pc_);
+        if (cur_quick_frame_pc_ == 0 && current_fragment->IsTopQuickFrameGenericJni()) {
+          // The generic JNI trampoline does not have any method header.
+          DCHECK(method->IsNative());
+          cur_oat_quick_method_header_ = nullptr;
+        } else {
+          cur_oat_quick_method_header_ = method->GetOatQuickMethodHeader(cur_quick_frame_pc_);
+        }
         SanityCheckFrame();
 
         if ((walk_kind_ == StackWalkKind::kIncludeInlinedFrames)
@@ -46,6 +46,10 @@ class ShadowFrame;
 class StackVisitor;
 class Thread;
 
+// Size of the should deoptimize flag that compiled code relying on the class hierarchy
+// analysis keeps in its frame, right below the callee-save registers.
+static constexpr size_t kShouldDeoptimizeFlagSize = 4;
+
 // The kind of vreg being accessed in calls to Set/GetVReg.
 enum VRegKind {
   kReferenceVReg,
@@ -519,7 +523,13 @@ class PACKED(4) ManagedStack {
   }
 
   ArtMethod** GetTopQuickFrame() const {
-    return top_quick_frame_;
+    return reinterpret_cast<ArtMethod**>(
+        reinterpret_cast<uintptr_t>(top_quick_frame_) & ~kGenericJniFrameTag);
+  }
+
+  // Whether the top quick frame was recorded with SetTopQuickFrameGenericJni.
+  bool IsTopQuickFrameGenericJni() const {
+    return (reinterpret_cast<uintptr_t>(top_quick_frame_) & kGenericJniFrameTag) != 0u;
   }
 
   void SetTopQuickFrame(ArtMethod** top) {
@@ -527,6 +537,17 @@ class PACKED(4) ManagedStack {
     top_quick_frame_ = top;
   }
 
+  // Record a frame built by the generic JNI trampoline. The entrypoint of the native method
+  // may be replaced by a JIT compiled stub while the call is in progress, so stack walks
+  // cannot rely on it to tell the frame layout. Assembly code reloading the stack pointer
+  // from the top quick frame expects an untagged value.
+  void SetTopQuickFrameGenericJni(ArtMethod** top) {
+    DCHECK(top_shadow_frame_ == nullptr);
+    DCHECK_ALIGNED(top, 4u);
+    top_quick_frame_ =
+        reinterpret_cast<ArtMethod**>(reinterpret_cast<uintptr_t>(top) | kGenericJniFrameTag);
+  }
+
   static size_t TopQuickFrameOffset() {
     return OFFSETOF_MEMBER(ManagedStack, top_quick_frame_);
   }
@@ -565,6 +586,8 @@ class PACKED(4) ManagedStack {
   bool ShadowFramesContain(StackReference<mirror::Object>* shadow_frame_entry) const;
 
  private:
+  static constexpr uintptr_t kGenericJniFrameTag = 1u;
+
   ArtMethod** top_quick_frame_;
   ManagedStack* link_;
   ShadowFrame* top_shadow_frame_;
@@ -780,6 +803,10 @@ class StackVisitor {
 
   QuickMethodFrameInfo GetCurrentQuickFrameInfo() const SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Returns the address of the should deoptimize flag of the current frame, which must be
+  // one of compiled code registered with the class hierarchy analysis.
+  uint8_t* GetShouldDeoptimizeFlagAddr() const SHARED_REQUIRES(Locks::mutator_lock_);
+
  private:
   // Private constructor known in the case that num_frames_ has already been computed.
   StackVisitor(Thread* thread, Context* context, StackWalkKind walk_kind, size_t num_frames)
@@ -715,7 +715,7 @@ class StackMapEncoding {
                       size_t dex_register_map_size,
                       size_t inline_info_size,
                       size_t register_mask_max,
-                      size_t stack_mask_bit_size) {
+                      size_t stack_mask_index_max) {
     size_t bit_offset = 0;
     DCHECK_EQ(kNativePcBitOffset, bit_offset);
     bit_offset += MinimumBitsToStore(native_pc_max);
@@ -739,9 +739,10 @@ class StackMapEncoding {
     register_mask_bit_offset_ = dchecked_integral_cast<uint8_t>(bit_offset);
     bit_offset += MinimumBitsToStore(register_mask_max);
 
-    stack_mask_bit_offset_ = dchecked_integral_cast<uint8_t>(bit_offset);
-    bit_offset += stack_mask_bit_size;
+    stack_mask_index_bit_offset_ = dchecked_integral_cast<uint8_t>(bit_offset);
+    bit_offset += MinimumBitsToStore(stack_mask_index_max);
 
+    total_bit_size_ = dchecked_integral_cast<uint8_t>(bit_offset);
     return RoundUp(bit_offset, kBitsPerByte) / kBitsPerByte;
   }
 
@@ -758,11 +759,10 @@ class StackMapEncoding {
     return FieldEncoding(inline_info_bit_offset_, register_mask_bit_offset_, -1 /* min_value */);
   }
   ALWAYS_INLINE FieldEncoding GetRegisterMaskEncoding() const {
-    return FieldEncoding(register_mask_bit_offset_, stack_mask_bit_offset_);
+    return FieldEncoding(register_mask_bit_offset_, stack_mask_index_bit_offset_);
   }
-  ALWAYS_INLINE size_t GetStackMaskBitOffset() const {
-    // The end offset is not encoded. It is implicitly the end of stack map entry.
-    return stack_mask_bit_offset_;
+  ALWAYS_INLINE FieldEncoding GetStackMaskIndexEncoding() const {
+    return FieldEncoding(stack_mask_index_bit_offset_, total_bit_size_);
   }
 
   void Dump(VariableIndentationOutputStream* vios) const;
@@ -773,7 +773,8 @@ class StackMapEncoding {
   uint8_t dex_register_map_bit_offset_;
   uint8_t inline_info_bit_offset_;
   uint8_t register_mask_bit_offset_;
-  uint8_t stack_mask_bit_offset_;
+  uint8_t stack_mask_index_bit_offset_;
+  uint8_t total_bit_size_;
 };
 
 /**
@@ -787,7 +788,9 @@ class StackMapEncoding {
  * The information is of the form:
  *
  *   [native_pc_offset, dex_pc, dex_register_map_offset, inlining_info_offset, register_mask,
- *   stack_mask].
+ *   stack_mask_index].
+ *
+ * The stack masks are deduplicated across the stack maps of a method, see CodeInfo::GetStackMaskOf.
  */
 class StackMap {
  public:
@@ -836,16 +839,12 @@ class StackMap {
     encoding.GetRegisterMaskEncoding().Store(region_, mask);
   }
 
-  ALWAYS_INLINE size_t GetNumberOfStackMaskBits(const StackMapEncoding& encoding) const {
-    return region_.size_in_bits() - encoding.GetStackMaskBitOffset();
-  }
-
-  ALWAYS_INLINE bool GetStackMaskBit(const StackMapEncoding& encoding, size_t index) const {
-    return region_.LoadBit(encoding.GetStackMaskBitOffset() + index);
+  ALWAYS_INLINE uint32_t GetStackMaskIndex(const StackMapEncoding& encoding) const {
+    return encoding.GetStackMaskIndexEncoding().Load(region_);
   }
 
-  ALWAYS_INLINE void SetStackMaskBit(const StackMapEncoding& encoding, size_t index, bool value) {
-    region_.StoreBit(encoding.GetStackMaskBitOffset() + index, value);
+  ALWAYS_INLINE void SetStackMaskIndex(const StackMapEncoding& encoding, uint32_t index) {
+    encoding.GetStackMaskIndexEncoding().Store(region_, index);
   }
 
   ALWAYS_INLINE bool HasDexRegisterMap(const StackMapEncoding& encoding) const {
@@ -888,6 +887,7 @@ class InlineInfoEncoding {
   void SetFromSizes(size_t method_index_max,
                     size_t dex_pc_max,
                     size_t invoke_type_max,
+                    size_t dex_file_index_max,
                     size_t dex_register_map_size) {
     total_bit_size_ = kMethodIndexBitOffset;
     total_bit_size_ += MinimumBitsToStore(method_index_max);
@@ -902,6 +902,13 @@ class InlineInfoEncoding {
     invoke_type_bit_offset_ = dchecked_integral_cast<uint8_t>(total_bit_size_);
     total_bit_size_ += MinimumBitsToStore(invoke_type_max);
 
+    // Note: We're not encoding the dex file index if all the inlined methods are
+    // from the dex file of the outer method.
+    dex_file_index_bit_offset_ = dchecked_integral_cast<uint8_t>(total_bit_size_);
+    if (dex_file_index_max != DexFile::kDexNoIndex) {
+      total_bit_size_ += MinimumBitsToStore(1 /* kOuterDexFileIndex */ + dex_file_index_max);
+    }
+
     // We also need +1 for kNoDexRegisterMap, but since the size is strictly
     // greater than any offset we might try to encode, we already implicitly have it.
     dex_register_map_bit_offset_ = dchecked_integral_cast<uint8_t>(total_bit_size_);
@@ -915,7 +922,11 @@ class InlineInfoEncoding {
     return FieldEncoding(dex_pc_bit_offset_, invoke_type_bit_offset_, -1 /* min_value */);
   }
   ALWAYS_INLINE FieldEncoding GetInvokeTypeEncoding() const {
-    return FieldEncoding(invoke_type_bit_offset_, dex_register_map_bit_offset_);
+    return FieldEncoding(invoke_type_bit_offset_, dex_file_index_bit_offset_);
+  }
+  ALWAYS_INLINE FieldEncoding GetDexFileIndexEncoding() const {
+    return FieldEncoding(
+        dex_file_index_bit_offset_, dex_register_map_bit_offset_, -1 /* min_value */);
   }
   ALWAYS_INLINE FieldEncoding GetDexRegisterMapEncoding() const {
     return FieldEncoding(dex_register_map_bit_offset_, total_bit_size_, -1 /* min_value */);
@@ -931,6 +942,7 @@ class InlineInfoEncoding {
   static constexpr uint8_t kMethodIndexBitOffset = 1;
   uint8_t dex_pc_bit_offset_;
   uint8_t invoke_type_bit_offset_;
+  uint8_t dex_file_index_bit_offset_;
   uint8_t dex_register_map_bit_offset_;
   uint8_t total_bit_size_;
 };
@@ -938,10 +950,16 @@ class InlineInfoEncoding {
 /**
  * Inline information for a specific PC. The information is of the form:
  *
- *   [is_last, method_index, dex_pc, invoke_type, dex_register_map_offset]+.
+ *   [is_last, method_index, dex_pc, invoke_type, dex_file_index, dex_register_map_offset]+.
+ *
+ * The method index is relative to the dex file at dex_file_index in the oat file of the outer
+ * method, or to the dex file of the outer method for kOuterDexFileIndex.
  */
 class InlineInfo {
  public:
+  static constexpr uint32_t kOuterDexFileIndex = DexFile::kDexNoIndex;
+
+
   explicit InlineInfo(MemoryRegion region) : region_(region) {
   }
 
@@ -991,6 +1009,17 @@ class InlineInfo {
     encoding.GetInvokeTypeEncoding().Store(GetRegionAtDepth(encoding, depth), invoke_type);
   }
 
+  ALWAYS_INLINE uint32_t GetDexFileIndexAtDepth(const InlineInfoEncoding& encoding,
+                                                uint32_t depth) const {
+    return encoding.GetDexFileIndexEncoding().Load(GetRegionAtDepth(encoding, depth));
+  }
+
+  ALWAYS_INLINE void SetDexFileIndexAtDepth(const InlineInfoEncoding& encoding,
+                                            uint32_t depth,
+                                            uint32_t dex_file_index) {
+    encoding.GetDexFileIndexEncoding().Store(GetRegionAtDepth(encoding, depth), dex_file_index);
+  }
+
   ALWAYS_INLINE uint32_t GetDexRegisterMapOffsetAtDepth(const InlineInfoEncoding& encoding,
                                                         uint32_t depth) const {
     return encoding.GetDexRegisterMapEncoding().Load(GetRegionAtDepth(encoding, depth));
@@ -1026,7 +1055,11 @@ class InlineInfo {
 struct CodeInfoEncoding {
   uint32_t non_header_size;
   uint32_t number_of_stack_maps;
+  // The first number_of_sorted_stack_maps stack maps are sorted by native pc offset.
+  uint32_t number_of_sorted_stack_maps;
   uint32_t stack_map_size_in_bytes;
+  uint32_t number_of_stack_masks;
+  uint32_t stack_mask_size_in_bytes;
   uint32_t number_of_location_catalog_entries;
   StackMapEncoding stack_map_encoding;
   InlineInfoEncoding inline_info_encoding;
@@ -1038,7 +1071,10 @@ struct CodeInfoEncoding {
     const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data);
     non_header_size = DecodeUnsignedLeb128(&ptr);
     number_of_stack_maps = DecodeUnsignedLeb128(&ptr);
+    number_of_sorted_stack_maps = DecodeUnsignedLeb128(&ptr);
     stack_map_size_in_bytes = DecodeUnsignedLeb128(&ptr);
+    number_of_stack_masks = DecodeUnsignedLeb128(&ptr);
+    stack_mask_size_in_bytes = DecodeUnsignedLeb128(&ptr);
     number_of_location_catalog_entries = DecodeUnsignedLeb128(&ptr);
     static_assert(alignof(StackMapEncoding) == 1,
                   "StackMapEncoding should not require alignment");
@@ -1059,7 +1095,10 @@ struct CodeInfoEncoding {
   void Compress(Vector* dest) const {
     EncodeUnsignedLeb128(dest, non_header_size);
     EncodeUnsignedLeb128(dest, number_of_stack_maps);
+    EncodeUnsignedLeb128(dest, number_of_sorted_stack_maps);
     EncodeUnsignedLeb128(dest, stack_map_size_in_bytes);
+    EncodeUnsignedLeb128(dest, number_of_stack_masks);
+    EncodeUnsignedLeb128(dest, stack_mask_size_in_bytes);
     EncodeUnsignedLeb128(dest, number_of_location_catalog_entries);
     const uint8_t* stack_map_ptr = reinterpret_cast<const uint8_t*>(&stack_map_encoding);
     dest->insert(dest->end(), stack_map_ptr, stack_map_ptr + sizeof(StackMapEncoding));
@@ -1074,11 +1113,13 @@ struct CodeInfoEncoding {
  * Wrapper around all compiler information collected for a method.
  * The information is of the form:
  *
- *   [CodeInfoEncoding, StackMap+, DexRegisterLocationCatalog+, DexRegisterMap+, InlineInfo*]
+ *   [CodeInfoEncoding, StackMap+, StackMask*, DexRegisterLocationCatalog+, DexRegisterMap+,
+ *    InlineInfo*]
  *
  * where CodeInfoEncoding is of the form:
  *
- *   [non_header_size, number_of_stack_maps, stack_map_size_in_bytes,
+ *   [non_header_size, number_of_stack_maps, number_of_sorted_stack_maps,
+ *    stack_map_size_in_bytes, number_of_stack_masks, stack_mask_size_in_bytes,
  *    number_of_location_catalog_entries, StackMapEncoding]
  */
 class CodeInfo {
@@ -1129,10 +1170,29 @@ class CodeInfo {
     return encoding.stack_map_size_in_bytes * GetNumberOfStackMaps(encoding);
   }
 
-  uint32_t GetDexRegisterLocationCatalogOffset(const CodeInfoEncoding& encoding) const {
+  // Get the size of all the unique stack masks of this CodeInfo object, in bytes.
+  size_t GetStackMasksSize(const CodeInfoEncoding& encoding) const {
+    return encoding.stack_mask_size_in_bytes * encoding.number_of_stack_masks;
+  }
+
+  uint32_t GetStackMasksOffset(const CodeInfoEncoding& encoding) const {
     return GetStackMapsOffset(encoding) + GetStackMapsSize(encoding);
   }
 
+  // Returns the stack mask of `stack_map`, shared with the stack maps that have the same one.
+  // Its bits past the highest stack slot of the method are zero.
+  MemoryRegion GetStackMaskOf(const StackMap& stack_map, const CodeInfoEncoding& encoding) const {
+    size_t index = stack_map.GetStackMaskIndex(encoding.stack_map_encoding);
+    DCHECK(index < encoding.number_of_stack_masks || encoding.stack_mask_size_in_bytes == 0u);
+    return region_.Subregion(
+        GetStackMasksOffset(encoding) + index * encoding.stack_mask_size_in_bytes,
+        encoding.stack_mask_size_in_bytes);
+  }
+
+  uint32_t GetDexRegisterLocationCatalogOffset(const CodeInfoEncoding& encoding) const {
+    return GetStackMasksOffset(encoding) + GetStackMasksSize(encoding);
+  }
+
   size_t GetDexRegisterMapsOffset(const CodeInfoEncoding& encoding) const {
     return GetDexRegisterLocationCatalogOffset(encoding)
          + GetDexRegisterLocationCatalogSize(encoding);
@@ -1232,12 +1292,31 @@ class CodeInfo {
 
   StackMap GetStackMapForNativePcOffset(uint32_t native_pc_offset,
                                         const CodeInfoEncoding& encoding) const {
-    // TODO: Safepoint stack maps are sorted by native_pc_offset but catch stack
-    //       maps are not. If we knew that the method does not have try/catch,
-    //       we could do binary search.
-    for (size_t i = 0, e = GetNumberOfStackMaps(encoding); i < e; ++i) {
+    // Safepoint stack maps are sorted by native_pc_offset but catch stack maps, stored
+    // after them, usually are not. Binary search the sorted stack maps for the first one
+    // with native_pc_offset, then look through the others.
+    const StackMapEncoding& stack_map_encoding = encoding.stack_map_encoding;
+    size_t low = 0u;
+    size_t high = encoding.number_of_sorted_stack_maps;
+    while (low != high) {
+      size_t mid = low + (high - low) / 2u;
+      if (GetStackMapAt(mid, encoding).GetNativePcOffset(stack_map_encoding) < native_pc_offset) {
+        low = mid + 1u;
+      } else {
+        high = mid;
+      }
+    }
+    if (low != encoding.number_of_sorted_stack_maps) {
+      StackMap stack_map = GetStackMapAt(low, encoding);
+      if (stack_map.GetNativePcOffset(stack_map_encoding) == native_pc_offset) {
+        return stack_map;
+      }
+    }
+    for (size_t i = encoding.number_of_sorted_stack_maps, e = GetNumberOfStackMaps(encoding);
+         i < e;
+         ++i) {
       StackMap stack_map = GetStackMapAt(i, encoding);
-      if (stack_map.GetNativePcOffset(encoding.stack_map_encoding) == native_pc_offset) {
+      if (stack_map.GetNativePcOffset(stack_map_encoding) == native_pc_offset) {
         return stack_map;
       }
     }
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string_builder_append.h"
+
+#include <limits>
+
+#include "base/logging.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/string-inl.h"
+#include "runtime.h"
+#include "stack.h"
+#include "thread-inl.h"
+
+namespace art {
+
+// Pre-fence visitor of the result allocation. The String arguments are kept in handles
+// between the length computation and the copy into the result, as the allocation can
+// move them.
+class StringBuilderAppend::Builder {
+ public:
+  Builder(uint32_t format, const uint32_t* args, Thread* self)
+      : format_(format),
+        args_(args),
+        length_(0),
+        hs_(self) {}
+
+  // Return the length of the result, or -1 with a pending OutOfMemoryError if it does
+  // not fit in a String.
+  int32_t CalculateLength() SHARED_REQUIRES(Locks::mutator_lock_);
+
+  void operator()(mirror::Object* obj, size_t usable_size) const
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+ private:
+  static constexpr char kNull[] = "null";
+  static constexpr size_t kNullLength = sizeof(kNull) - 1u;
+  static constexpr char kTrue[] = "true";
+  static constexpr size_t kTrueLength = sizeof(kTrue) - 1u;
+  static constexpr char kFalse[] = "false";
+  static constexpr size_t kFalseLength = sizeof(kFalse) - 1u;
+
+  static size_t Int64Length(int64_t value);
+  static uint16_t* AppendLiteral(const char* literal, size_t length, uint16_t* data);
+  static uint16_t* AppendInt64(int64_t value, uint16_t* data);
+
+  static Argument NextArgument(uint32_t* format) {
+    Argument arg = static_cast<Argument>(*format & kArgMask);
+    *format >>= kBitsPerArg;
+    return arg;
+  }
+
+  static int64_t ReadInt64(const uint32_t** current) {
+    *current = AlignUp(*current, sizeof(int64_t));
+    int64_t value = *reinterpret_cast<const int64_t*>(*current);
+    *current += 2u;
+    return value;
+  }
+
+  const uint32_t format_;
+  const uint32_t* const args_;
+  int32_t length_;
+  StackHandleScope<kMaxArgs> hs_;
+};
+
+constexpr char StringBuilderAppend::Builder::kNull[];
+constexpr size_t StringBuilderAppend::Builder::kNullLength;
+constexpr char StringBuilderAppend::Builder::kTrue[];
+constexpr size_t StringBuilderAppend::Builder::kTrueLength;
+constexpr char StringBuilderAppend::Builder::kFalse[];
+constexpr size_t StringBuilderAppend::Builder::kFalseLength;
+
+size_t StringBuilderAppend::Builder::Int64Length(int64_t value) {
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  size_t length = 1u;
+  if (value < 0) {
+    magnitude = 0u - magnitude;
+    ++length;
+  }
+  while (magnitude >= 10u) {
+    magnitude /= 10u;
+    ++length;
+  }
+  return length;
+}
+
+uint16_t* StringBuilderAppend::Builder::AppendLiteral(const char* literal,
+                                                      size_t length,
+                                                      uint16_t* data) {
+  for (size_t i = 0; i != length; ++i) {
+    data[i] = static_cast<uint16_t>(literal[i]);
+  }
+  return data + length;
+}
+
+uint16_t* StringBuilderAppend::Builder::AppendInt64(int64_t value, uint16_t* data) {
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) {
+    magnitude = 0u - magnitude;
+    data[0] = '-';
+  }
+  uint16_t* end = data + Int64Length(value);
+  uint16_t* pos = end;
+  do {
+    *--pos = static_cast<uint16_t>('0' + magnitude % 10u);
+    magnitude /= 10u;
+  } while (magnitude != 0u);
+  return end;
+}
+
+int32_t StringBuilderAppend::Builder::CalculateLength() {
+  uint64_t length = 0u;
+  const uint32_t* current = args_;
+  for (uint32_t f = format_; f != 0u; ) {
+    switch (NextArgument(&f)) {
+      case Argument::kString: {
+        mirror::String* str =
+            reinterpret_cast<const StackReference<mirror::String>*>(current)->AsMirrorPtr();
+        hs_.NewHandle(str);
+        length += (str != nullptr) ? static_cast<uint64_t>(str->GetLength()) : kNullLength;
+        ++current;
+        break;
+      }
+      case Argument::kBoolean:
+        length += (*current != 0u) ? kTrueLength : kFalseLength;
+        ++current;
+        break;
+      case Argument::kChar:
+        length += 1u;
+        ++current;
+        break;
+      case Argument::kInt:
+        length += Int64Length(static_cast<int32_t>(*current));
+        ++current;
+        break;
+      case Argument::kLong:
+        length += Int64Length(ReadInt64(&current));
+        break;
+      default:
+        LOG(FATAL) << "Unexpected argument kind in format 0x" << std::hex << format_;
+        UNREACHABLE();
+    }
+  }
+  if (length > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+    Thread::Current()->ThrowOutOfMemoryError("Concatenated string length exceeds INT_MAX");
+    return -1;
+  }
+  length_ = static_cast<int32_t>(length);
+  return length_;
+}
+
+void StringBuilderAppend::Builder::operator()(mirror::Object* obj,
+                                              size_t usable_size ATTRIBUTE_UNUSED) const {
+  // Avoid AsString as object is not yet in live bitmap or allocation stack.
+  mirror::String* result = down_cast<mirror::String*>(obj);
+  result->SetCount(length_);
+  uint16_t* data = result->GetValue();
+  size_t handle_index = 0u;
+  const uint32_t* current = args_;
+  for (uint32_t f = format_; f != 0u; ) {
+    switch (NextArgument(&f)) {
+      case Argument::kString: {
+        mirror::String* str = down_cast<mirror::String*>(hs_.GetReference(handle_index));
+        ++handle_index;
+        if (str != nullptr) {
+          memcpy(data, str->GetValue(), str->GetLength() * sizeof(uint16_t));
+          data += str->GetLength();
+        } else {
+          data = AppendLiteral(kNull, kNullLength, data);
+        }
+        ++current;
+        break;
+      }
+      case Argument::kBoolean:
+        data = (*current != 0u)
+            ? AppendLiteral(kTrue, kTrueLength, data)
+            : AppendLiteral(kFalse, kFalseLength, data);
+        ++current;
+        break;
+      case Argument::kChar:
+        *data = static_cast<uint16_t>(*current);
+        ++data;
+        ++current;
+        break;
+      case Argument::kInt:
+        data = AppendInt64(static_cast<int32_t>(*current), data);
+        ++current;
+        break;
+      case Argument::kLong:
+        data = AppendInt64(ReadInt64(&current), data);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected argument kind in format 0x" << std::hex << format_;
+        UNREACHABLE();
+    }
+  }
+  DCHECK_EQ(data, result->GetValue() + result->GetLength());
+}
+
+mirror::String* StringBuilderAppend::AppendF(uint32_t format,
+                                             const uint32_t* args,
+                                             Thread* self) {
+  Builder builder(format, args, self);
+  self->AssertNoPendingException();
+  int32_t length = builder.CalculateLength();
+  if (UNLIKELY(length < 0)) {
+    DCHECK(self->IsExceptionPending());
+    return nullptr;
+  }
+  gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
+  return mirror::String::Alloc</* kIsInstrumented */ true>(self, length, allocator_type, builder);
+}
+
+}  // namespace art
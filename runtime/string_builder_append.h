@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_STRING_BUILDER_APPEND_H_
+#define ART_RUNTIME_STRING_BUILDER_APPEND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+class String;
+}  // namespace mirror
+
+// Support for the compiled form of `new StringBuilder().append(...)...append(...).toString()`
+// chains: the arguments are converted and concatenated into a single String allocation.
+class StringBuilderAppend {
+ public:
+  // Kind of an argument, as encoded in the format of the call.
+  enum class Argument : uint8_t {
+    kEnd = 0u,
+    kString,
+    kBoolean,
+    kChar,
+    kInt,
+    kLong,
+    kLast = kLong
+  };
+
+  // The format holds the kinds of the arguments, kBitsPerArg bits each, starting with the
+  // first argument in the least significant bits. It ends with the first Argument::kEnd.
+  static constexpr size_t kBitsPerArg = 4u;
+  static constexpr size_t kMaxArgs = BitSizeOf<uint32_t>() / kBitsPerArg;
+  static_assert(static_cast<uint32_t>(Argument::kLast) < (1u << kBitsPerArg),
+                "Argument kinds must fit in kBitsPerArg bits");
+  static constexpr uint32_t kArgMask = (1u << kBitsPerArg) - 1u;
+
+  // Return the concatenation of the arguments described by `format`. The arguments
+  // are in the outgoing argument area of the caller, one 32-bit slot each, except for
+  // longs which take an 8-byte aligned 64-bit slot. References are read before any
+  // allocation, so the caller does not need to keep them alive.
+  static mirror::String* AppendF(uint32_t format, const uint32_t* args, Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+ private:
+  class Builder;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_STRING_BUILDER_APPEND_H_
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suspend_latency_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+
+Atomic<bool> SuspendLatencyProfiler::enabled_(false);
+
+namespace {
+
+// Only the slowest entries of each table are dumped.
+static constexpr size_t kMaxDumpedEntries = 20;
+
+struct LatencyStats {
+  LatencyStats() : count(0u), total_ns(0u), max_ns(0u) {}
+
+  void Add(uint64_t ns) {
+    ++count;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+  }
+
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t max_ns;
+};
+
+struct SuspendLatencyData {
+  SuspendLatencyData() : lock("suspend latency profiler lock", kLoggingLock), request_ns(0u) {}
+
+  Mutex lock;
+  // The latest request. Concurrent SuspendAlls may attribute some latencies to the wrong one.
+  std::string cause GUARDED_BY(lock);
+  uint64_t request_ns GUARDED_BY(lock);
+  std::map<std::string, LatencyStats> by_cause GUARDED_BY(lock);
+  std::map<std::string, LatencyStats> by_location GUARDED_BY(lock);
+};
+
+// Created when first enabled and never deleted, threads may still be recording.
+Atomic<SuspendLatencyData*> gSuspendLatencyData(nullptr);
+
+void DumpTable(std::ostream& os,
+               const char* title,
+               const std::map<std::string, LatencyStats>& table) {
+  typedef std::pair<const std::string*, const LatencyStats*> Entry;
+  std::vector<Entry> entries;
+  for (const auto& entry : table) {
+    entries.emplace_back(&entry.first, &entry.second);
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.second->total_ns > rhs.second->total_ns;
+  });
+  os << title << " (" << table.size() << " entries)\n";
+  for (size_t i = 0, e = std::min(entries.size(), kMaxDumpedEntries); i != e; ++i) {
+    const LatencyStats& stats = *entries[i].second;
+    os << "  " << stats.count << " times, total " << PrettyDuration(stats.total_ns)
+       << " average " << PrettyDuration(stats.total_ns / stats.count)
+       << " max " << PrettyDuration(stats.max_ns) << ": " << *entries[i].first << "\n";
+  }
+}
+
+}  // namespace
+
+void SuspendLatencyProfiler::SetEnabled(bool enabled) {
+  if (enabled && gSuspendLatencyData.LoadAcquire() == nullptr) {
+    SuspendLatencyData* data = new SuspendLatencyData();
+    if (!gSuspendLatencyData.CompareExchangeStrongSequentiallyConsistent(nullptr, data)) {
+      delete data;  // Lost the race with another thread enabling the profiler.
+    }
+  }
+  enabled_.StoreRelaxed(enabled);
+}
+
+void SuspendLatencyProfiler::RequestStarted(const char* cause) {
+  SuspendLatencyData* data = gSuspendLatencyData.LoadAcquire();
+  if (data == nullptr || !IsEnabled()) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->cause = cause;
+  data->request_ns = NanoTime();
+}
+
+void SuspendLatencyProfiler::RecordAcknowledgement(Thread* self) {
+  SuspendLatencyData* data = gSuspendLatencyData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  const uint64_t now_ns = NanoTime();
+  uint32_t dex_pc = 0u;
+  ArtMethod* method = self->GetCurrentMethod(&dex_pc, /* abort_on_error */ false);
+  std::string location;
+  if (method == nullptr) {
+    location = "<runtime>";
+  } else if (method->IsNative()) {
+    location = PrettyMethod(method) + " (native)";
+  } else {
+    location = StringPrintf("%s dex pc 0x%04x", PrettyMethod(method).c_str(), dex_pc);
+  }
+  MutexLock mu(self, data->lock);
+  if (data->request_ns == 0u || now_ns < data->request_ns) {
+    return;  // No request was seen since the profiler was enabled.
+  }
+  const uint64_t latency_ns = now_ns - data->request_ns;
+  data->by_cause[data->cause].Add(latency_ns);
+  data->by_location[location].Add(latency_ns);
+}
+
+bool SuspendLatencyProfiler::Dump(std::ostream& os) {
+  SuspendLatencyData* data = gSuspendLatencyData.LoadAcquire();
+  if (data == nullptr) {
+    return false;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  os << "Suspend latency profile (" << (IsEnabled() ? "enabled" : "disabled") << "):\n";
+  DumpTable(os, "Latencies by cause of the suspension", data->by_cause);
+  DumpTable(os, "Latencies by location of the suspended thread", data->by_location);
+  return true;
+}
+
+void SuspendLatencyProfiler::Reset() {
+  SuspendLatencyData* data = gSuspendLatencyData.LoadAcquire();
+  if (data == nullptr) {
+    return;
+  }
+  MutexLock mu(Thread::Current(), data->lock);
+  data->by_cause.clear();
+  data->by_location.clear();
+}
+
+}  // namespace art
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_SUSPEND_LATENCY_PROFILER_H_
+#define ART_RUNTIME_SUSPEND_LATENCY_PROFILER_H_
+
+#include <iosfwd>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class Thread;
+
+// Measures, when enabled with -Xsuspendlatencyprofile, how long each runnable thread takes to
+// acknowledge the suspend requests of SuspendAll and of the thread flip, from the request to the
+// moment the thread passes its suspend barrier. The latencies are keyed by the cause of the
+// suspension, that is the collector for the GC pauses, and by where the thread was: the method
+// and dex pc of the suspend check in compiled or interpreted code, or the native method it
+// was entering. Dumped on SIGQUIT and through VMDebug.
+class SuspendLatencyProfiler {
+ public:
+  static void SetEnabled(bool enabled);
+
+  static bool IsEnabled() {
+    return enabled_.LoadRelaxed();
+  }
+
+  // Called by the suspending thread before it requests the other threads to suspend.
+  static void RequestStarted(const char* cause);
+
+  // Called by a runnable thread that is about to pass its suspend barrier.
+  static void RecordAcknowledgement(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Returns false and dumps nothing if the profiler was never enabled.
+  static bool Dump(std::ostream& os);
+
+  // Drop the statistics gathered so far.
+  static void Reset();
+
+ private:
+  static Atomic<bool> enabled_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(SuspendLatencyProfiler);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_SUSPEND_LATENCY_PROFILER_H_
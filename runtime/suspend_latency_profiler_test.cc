@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "suspend_latency_profiler.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+
+class SuspendLatencyProfilerTest : public CommonRuntimeTest {};
+
+TEST_F(SuspendLatencyProfilerTest, RecordsAcknowledgements) {
+  SuspendLatencyProfiler::SetEnabled(true);
+  SuspendLatencyProfiler::Reset();
+  EXPECT_TRUE(SuspendLatencyProfiler::IsEnabled());
+
+  SuspendLatencyProfiler::RequestStarted("suspend latency test");
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    // The test thread runs no managed code, so the latency goes to the runtime.
+    SuspendLatencyProfiler::RecordAcknowledgement(soa.Self());
+    SuspendLatencyProfiler::RecordAcknowledgement(soa.Self());
+  }
+  SuspendLatencyProfiler::SetEnabled(false);
+
+  std::ostringstream os;
+  ASSERT_TRUE(SuspendLatencyProfiler::Dump(os));
+  std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find("(disabled)"));
+  EXPECT_NE(std::string::npos, dump.find(": suspend latency test\n"));
+  EXPECT_NE(std::string::npos, dump.find(": <runtime>\n"));
+  EXPECT_NE(std::string::npos, dump.find("  2 times, total "));
+
+  SuspendLatencyProfiler::Reset();
+  std::ostringstream empty;
+  ASSERT_TRUE(SuspendLatencyProfiler::Dump(empty));
+  EXPECT_EQ(std::string::npos, empty.str().find("suspend latency test"));
+}
+
+}  // namespace art
@@ -29,6 +29,7 @@
 #include "base/mutex-inl.h"
 #include "gc/heap.h"
 #include "jni_env_ext.h"
+#include "suspend_latency_profiler.h"
 #include "thread_pool.h"
 
 namespace art {
@@ -173,6 +174,10 @@ inline void Thread::PassActiveSuspendBarriers() {
 inline void Thread::TransitionFromRunnableToSuspended(ThreadState new_state) {
   AssertThreadSuspensionIsAllowable();
   DCHECK_EQ(this, Thread::Current());
+  if (UNLIKELY(ReadFlag(kActiveSuspendBarrier)) && SuspendLatencyProfiler::IsEnabled()) {
+    // Still runnable, so that the profiler can look at where we are.
+    SuspendLatencyProfiler::RecordAcknowledgement(this);
+  }
   // Change to non-runnable state, thereby appearing suspended to the system.
   TransitionToSuspendedAndRunCheckpoints(new_state);
   // Mark the release of the share of the mutator_lock_.
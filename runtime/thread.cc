@@ -69,11 +69,13 @@
 #include "stack.h"
 #include "stack_map.h"
 #include "thread_list.h"
+#include "thread_stack_pool.h"
 #include "thread-inl.h"
 #include "utils.h"
 #include "verifier/method_verifier.h"
 #include "verify_object-inl.h"
 #include "well_known_classes.h"
+#include "interpreter/dispatch_profiler.h"
 #include "interpreter/interpreter.h"
 
 #if ART_USE_FUTEXES
@@ -650,14 +652,26 @@ void Thread::CreateNativeThread(JNIEnv* env, jobject java_peer, size_t stack_siz
     pthread_attr_t attr;
     child_thread->tlsPtr_.tmp_jni_env = child_jni_env_ext.get();
     CHECK_PTHREAD_CALL(pthread_attr_init, (&attr), "new thread");
-    CHECK_PTHREAD_CALL(pthread_attr_setdetachstate, (&attr, PTHREAD_CREATE_DETACHED),
-                       "PTHREAD_CREATE_DETACHED");
-    CHECK_PTHREAD_CALL(pthread_attr_setstacksize, (&attr, stack_size), stack_size);
+    ThreadStackPool* stack_pool = runtime->GetThreadStackPool();
+    uint8_t* pooled_stack = (stack_pool != nullptr) ? stack_pool->Allocate(stack_size) : nullptr;
+    if (pooled_stack != nullptr) {
+      // Stays joinable, the pool joins the thread before handing its stack out again.
+      child_thread->pooled_stack_ = pooled_stack;
+      child_thread->pooled_stack_size_ = stack_size;
+      CHECK_PTHREAD_CALL(pthread_attr_setstack, (&attr, pooled_stack, stack_size), stack_size);
+    } else {
+      CHECK_PTHREAD_CALL(pthread_attr_setdetachstate, (&attr, PTHREAD_CREATE_DETACHED),
+                         "PTHREAD_CREATE_DETACHED");
+      CHECK_PTHREAD_CALL(pthread_attr_setstacksize, (&attr, stack_size), stack_size);
+    }
     pthread_create_result = pthread_create(&new_pthread,
                                            &attr,
                                            Thread::CreateCallback,
                                            child_thread);
     CHECK_PTHREAD_CALL(pthread_attr_destroy, (&attr), "new thread");
+    if (pthread_create_result != 0 && pooled_stack != nullptr) {
+      stack_pool->Free(pooled_stack, stack_size);
+    }
 
     if (pthread_create_result == 0) {
       // pthread_create started the new thread. The child is now responsible for managing the
@@ -1105,6 +1119,10 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
         CHECK_GT(cur_val, 0) << "Unexpected value for PassActiveSuspendBarriers(): " << cur_val;
         // Reduce value by 1.
         done = pending_threads->CompareExchangeWeakRelaxed(cur_val, cur_val - 1);
+        if (done && (cur_val - 1) == 0) {
+          // This thread was the last one SuspendAll was waiting for.
+          Runtime::Current()->GetThreadList()->last_suspend_barrier_tid_.StoreRelaxed(GetTid());
+        }
 #if ART_USE_FUTEXES
         if (done && (cur_val - 1) == 0) {  // Weak CAS may fail spuriously.
           futex(pending_threads->Address(), FUTEX_WAKE, -1, nullptr, nullptr, 0);
@@ -1523,6 +1541,10 @@ void Thread::DumpJavaStack(std::ostream& os) const {
   }
 }
 
+bool Thread::ShouldDumpNativeStack() const {
+  return gAborting > 0 || ShouldShowNativeStack(this);
+}
+
 void Thread::DumpStack(std::ostream& os,
                        bool dump_native_stack,
                        BacktraceMap* backtrace_map) const {
@@ -1753,6 +1775,7 @@ void Thread::Destroy() {
   {
     ScopedObjectAccess soa(self);
     Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(this);
+    interpreter::DispatchProfiler::ThreadExited(this);
     if (kUseReadBarrier) {
       Runtime::Current()->GetHeap()->ConcurrentCopyingCollector()->RevokeThreadLocalMarkStack(this);
     }
@@ -1800,6 +1823,7 @@ Thread::~Thread() {
   delete tlsPtr_.instrumentation_stack;
   delete tlsPtr_.name;
   delete tlsPtr_.stack_trace_sample;
+  delete method_trace_buffer_;
   free(tlsPtr_.nested_signal_state);
 
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
@@ -1980,10 +2004,11 @@ void Thread::SetClassLoaderOverride(jobject class_loader_override) {
 
 class CountStackDepthVisitor : public StackVisitor {
  public:
-  explicit CountStackDepthVisitor(Thread* thread)
+  // Stops the walk after max_depth frames, unless max_depth is 0.
+  CountStackDepthVisitor(Thread* thread, uint32_t max_depth)
       SHARED_REQUIRES(Locks::mutator_lock_)
       : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-        depth_(0), skip_depth_(0), skipping_(true) {}
+        depth_(0), skip_depth_(0), max_depth_(max_depth), skipping_(true) {}
 
   bool VisitFrame() SHARED_REQUIRES(Locks::mutator_lock_) {
     // We want to skip frames up to and including the exception's constructor.
@@ -1997,6 +2022,9 @@ class CountStackDepthVisitor : public StackVisitor {
     if (!skipping_) {
       if (!m->IsRuntimeMethod()) {  // Ignore runtime frames (in particular callee save).
         ++depth_;
+        if (depth_ == max_depth_) {
+          return false;
+        }
       }
     } else {
       ++skip_depth_;
@@ -2015,6 +2043,7 @@ class CountStackDepthVisitor : public StackVisitor {
  private:
   uint32_t depth_;
   uint32_t skip_depth_;
+  const uint32_t max_depth_;
   bool skipping_;
 
   DISALLOW_COPY_AND_ASSIGN(CountStackDepthVisitor);
@@ -2071,6 +2100,9 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
     if (trace_ == nullptr) {
       return true;  // We're probably trying to fillInStackTrace for an OutOfMemoryError.
     }
+    if (count_ == static_cast<uint32_t>(trace_->GetLength() - 1)) {
+      return false;  // The trace was truncated to the maximum depth.
+    }
     if (skip_depth_ > 0) {
       skip_depth_--;
       return true;
@@ -2120,7 +2152,8 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
 template<bool kTransactionActive>
 jobject Thread::CreateInternalStackTrace(const ScopedObjectAccessAlreadyRunnable& soa) const {
   // Compute depth of stack
-  CountStackDepthVisitor count_visitor(const_cast<Thread*>(this));
+  CountStackDepthVisitor count_visitor(const_cast<Thread*>(this),
+                                       Runtime::Current()->GetMaxStackTraceDepth());
   count_visitor.WalkStack();
   int32_t depth = count_visitor.GetDepth();
   int32_t skip_depth = count_visitor.GetSkipDepth();
@@ -2151,7 +2184,9 @@ template jobject Thread::CreateInternalStackTrace<true>(
     const ScopedObjectAccessAlreadyRunnable& soa) const;
 
 bool Thread::IsExceptionThrownByCurrentMethod(mirror::Throwable* exception) const {
-  CountStackDepthVisitor count_visitor(const_cast<Thread*>(this));
+  // Use the same limit as the stack trace of the exception.
+  CountStackDepthVisitor count_visitor(const_cast<Thread*>(this),
+                                       Runtime::Current()->GetMaxStackTraceDepth());
   count_visitor.WalkStack();
   return count_visitor.GetDepth() == exception->GetStackDepth();
 }
@@ -2576,6 +2611,8 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   QUICK_ENTRY_POINT_INFO(pNewStringFromString)
   QUICK_ENTRY_POINT_INFO(pNewStringFromStringBuffer)
   QUICK_ENTRY_POINT_INFO(pNewStringFromStringBuilder)
+  QUICK_ENTRY_POINT_INFO(pStringBuilderAppend)
+  QUICK_ENTRY_POINT_INFO(pCloneObject)
   QUICK_ENTRY_POINT_INFO(pReadBarrierJni)
   QUICK_ENTRY_POINT_INFO(pReadBarrierMarkReg00)
   QUICK_ENTRY_POINT_INFO(pReadBarrierMarkReg01)
@@ -2819,9 +2856,10 @@ class ReferenceMapVisitor : public StackVisitor {
       StackMap map = code_info.GetStackMapForNativePcOffset(native_pc_offset, encoding);
       DCHECK(map.IsValid());
       // Visit stack entries that hold pointers.
-      size_t number_of_bits = map.GetNumberOfStackMaskBits(encoding.stack_map_encoding);
+      MemoryRegion stack_mask = code_info.GetStackMaskOf(map, encoding);
+      size_t number_of_bits = stack_mask.size_in_bits();
       for (size_t i = 0; i < number_of_bits; ++i) {
-        if (map.GetStackMaskBit(encoding.stack_map_encoding, i)) {
+        if (stack_mask.LoadBit(i)) {
           auto* ref_addr = vreg_base + i;
           mirror::Object* ref = ref_addr->AsMirrorPtr();
           if (ref != nullptr) {
@@ -2914,6 +2952,15 @@ void Thread::VisitRoots(RootVisitor* visitor) {
   for (auto* verifier = tlsPtr_.method_verifier; verifier != nullptr; verifier = verifier->link_) {
     verifier->VisitRoots(visitor, RootInfo(kRootNativeStack, thread_id));
   }
+  for (auto* reg_types = tlsPtr_.reg_type_cache;
+       reg_types != nullptr;
+       reg_types = reg_types->link_) {
+    reg_types->VisitRoots(visitor, RootInfo(kRootNativeStack, thread_id));
+  }
+  for (mirror::String*& entry : tlsPtr_.intern_cache) {
+    visitor->VisitRootIfNonNull(reinterpret_cast<mirror::Object**>(&entry),
+                                RootInfo(kRootInternedString, thread_id));
+  }
   // Visit roots on this thread's stack
   Context* context = GetLongJumpContext();
   RootCallbackVisitor visitor_to_callback(visitor, thread_id);
@@ -2971,6 +3018,11 @@ void Thread::SetTlab(uint8_t* start, uint8_t* end) {
   tlsPtr_.thread_local_objects = 0;
 }
 
+void Thread::ExpandTlab(size_t bytes) {
+  DCHECK(HasTlab());
+  tlsPtr_.thread_local_end += bytes;
+}
+
 bool Thread::HasTlab() const {
   bool has_tlab = tlsPtr_.thread_local_pos != nullptr;
   if (has_tlab) {
@@ -3047,6 +3099,16 @@ void Thread::PopVerifier(verifier::MethodVerifier* verifier) {
   tlsPtr_.method_verifier = verifier->link_;
 }
 
+void Thread::PushRegTypeCache(verifier::RegTypeCache* reg_types) {
+  reg_types->link_ = tlsPtr_.reg_type_cache;
+  tlsPtr_.reg_type_cache = reg_types;
+}
+
+void Thread::PopRegTypeCache(verifier::RegTypeCache* reg_types) {
+  CHECK_EQ(tlsPtr_.reg_type_cache, reg_types);
+  tlsPtr_.reg_type_cache = reg_types->link_;
+}
+
 size_t Thread::NumberOfHeldMutexes() const {
   size_t count = 0;
   for (BaseMutex* mu : tlsPtr_.held_mutexes) {
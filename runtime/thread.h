@@ -36,6 +36,7 @@
 #include "globals.h"
 #include "handle_scope.h"
 #include "instrumentation.h"
+#include "interpreter/interpreter_cache.h"
 #include "jvalue.h"
 #include "object_callbacks.h"
 #include "offsets.h"
@@ -56,6 +57,10 @@ namespace collector {
 }  // namespace collector
 }  // namespace gc
 
+namespace interpreter {
+struct DispatchProfileBuffer;
+}  // namespace interpreter
+
 namespace mirror {
   class Array;
   class Class;
@@ -71,6 +76,7 @@ namespace mirror {
 
 namespace verifier {
 class MethodVerifier;
+class RegTypeCache;
 }  // namespace verifier
 
 class ArtMethod;
@@ -116,6 +122,12 @@ enum class StackedShadowFrameType {
 // This should match RosAlloc::kNumThreadLocalSizeBrackets.
 static constexpr size_t kNumRosAllocThreadLocalSizeBracketsInThread = 16;
 
+// Number of entries of the thread-local cache of interned strings, a power of two.
+static constexpr size_t kInternCacheSizeInThread = 32;
+static_assert((kInternCacheSizeInThread & (kInternCacheSizeInThread - 1u)) == 0u &&
+                  kInternCacheSizeInThread <= 32u,
+              "The intern cache strong mask must fit in a size_t");
+
 // Thread's stack layout for implicit stack overflow checks:
 //
 //   +---------------------+  <- highest address of stack memory
@@ -197,6 +209,10 @@ class Thread {
       REQUIRES(!Locks::thread_suspend_count_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Whether Dump() includes the kernel and native stacks of this thread, for callers that unwind
+  // them separately with DumpNativeStack.
+  bool ShouldDumpNativeStack() const SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Dumps the SIGQUIT per-thread header. 'thread' can be null for a non-attached thread, in which
   // case we use 'tid' to identify the thread, and we'll include as much information as we can.
   static void DumpState(std::ostream& os, const Thread* thread, pid_t tid)
@@ -406,6 +422,10 @@ class Thread {
     tlsPtr_.managed_stack.SetTopQuickFrame(top_method);
   }
 
+  void SetTopOfStackGenericJni(ArtMethod** top_method) {
+    tlsPtr_.managed_stack.SetTopQuickFrameGenericJni(top_method);
+  }
+
   void SetTopOfShadowStack(ShadowFrame* top) {
     tlsPtr_.managed_stack.SetTopShadowFrame(top);
   }
@@ -741,6 +761,19 @@ class Thread {
     return &tlsPtr_.managed_stack;
   }
 
+  // Only used by this thread, or by others while it is suspended.
+  InterpreterCache* GetInterpreterCache() {
+    return &interpreter_cache_;
+  }
+
+  interpreter::DispatchProfileBuffer* GetDispatchProfileBuffer() const {
+    return dispatch_profile_buffer_;
+  }
+
+  void SetDispatchProfileBuffer(interpreter::DispatchProfileBuffer* buffer) {
+    dispatch_profile_buffer_ = buffer;
+  }
+
   // Linked list recording fragments of managed stack.
   void PushManagedStackFragment(ManagedStack* fragment) {
     tlsPtr_.managed_stack.PushManagedStackFragment(fragment);
@@ -944,6 +977,14 @@ class Thread {
     tlsPtr_.stack_trace_sample = sample;
   }
 
+  std::vector<uint8_t>* GetMethodTraceBuffer() const {
+    return method_trace_buffer_;
+  }
+
+  void SetMethodTraceBuffer(std::vector<uint8_t>* buffer) {
+    method_trace_buffer_ = buffer;
+  }
+
   uint64_t GetTraceClockBase() const {
     return tls64_.trace_clock_base;
   }
@@ -991,6 +1032,8 @@ class Thread {
   // Doesn't check that there is room.
   mirror::Object* AllocTlab(size_t bytes);
   void SetTlab(uint8_t* start, uint8_t* end);
+  // Extends the end of the TLAB. The caller must own the memory past the current end.
+  void ExpandTlab(size_t bytes);
   bool HasTlab() const;
   uint8_t* GetTlabStart() {
     return tlsPtr_.thread_local_start;
@@ -998,6 +1041,35 @@ class Thread {
   uint8_t* GetTlabPos() {
     return tlsPtr_.thread_local_pos;
   }
+  uint8_t* GetTlabEnd() {
+    return tlsPtr_.thread_local_end;
+  }
+  // The size of the last region-space TLAB chunk, used to size the next one.
+  size_t GetTlabChunkSize() const {
+    return tlsPtr_.thread_local_chunk_size;
+  }
+  void SetTlabChunkSize(size_t chunk_size) {
+    tlsPtr_.thread_local_chunk_size = chunk_size;
+  }
+
+  // Direct-mapped cache of the strings recently interned by this thread, indexed by string hash.
+  // The entries are roots, so a weakly interned string stays in the intern table while cached.
+  mirror::String* GetInternCacheEntry(size_t index) const {
+    DCHECK_LT(index, kInternCacheSizeInThread);
+    return tlsPtr_.intern_cache[index];
+  }
+  bool IsStrongInternCacheEntry(size_t index) const {
+    DCHECK_LT(index, kInternCacheSizeInThread);
+    return (tlsPtr_.intern_cache_strong_mask & (static_cast<size_t>(1u) << index)) != 0u;
+  }
+  void SetInternCacheEntry(size_t index, mirror::String* s, bool is_strong) {
+    DCHECK_LT(index, kInternCacheSizeInThread);
+    tlsPtr_.intern_cache[index] = s;
+    const size_t bit = static_cast<size_t>(1u) << index;
+    tlsPtr_.intern_cache_strong_mask =
+        is_strong ? (tlsPtr_.intern_cache_strong_mask | bit)
+                  : (tlsPtr_.intern_cache_strong_mask & ~bit);
+  }
 
   // Remove the suspend trigger for this thread by making the suspend_trigger_ TLS value
   // equal to a valid pointer.
@@ -1008,8 +1080,10 @@ class Thread {
 
   // Trigger a suspend check by making the suspend_trigger_ TLS value an invalid pointer.
   // The next time a suspend check is done, it will load from the value at this address
-  // and trigger a SIGSEGV.
+  // and trigger a SIGSEGV. The fence makes the flags set by the caller visible no later
+  // than the trigger, so that the thread finds them in art_quick_test_suspend.
   void TriggerSuspend() {
+    QuasiAtomic::ThreadFenceRelease();
     tlsPtr_.suspend_trigger = nullptr;
   }
 
@@ -1092,6 +1166,9 @@ class Thread {
   void PushVerifier(verifier::MethodVerifier* verifier);
   void PopVerifier(verifier::MethodVerifier* verifier);
 
+  void PushRegTypeCache(verifier::RegTypeCache* reg_types);
+  void PopRegTypeCache(verifier::RegTypeCache* reg_types);
+
   void InitStringEntryPoints();
 
   void ModifyDebugDisallowReadBarrier(int8_t delta) {
@@ -1364,8 +1441,9 @@ class Thread {
       mterp_current_ibase(nullptr), mterp_default_ibase(nullptr), mterp_alt_ibase(nullptr),
       thread_local_alloc_stack_top(nullptr), thread_local_alloc_stack_end(nullptr),
       nested_signal_state(nullptr), flip_function(nullptr), method_verifier(nullptr),
-      thread_local_mark_stack(nullptr) {
+      reg_type_cache(nullptr), thread_local_mark_stack(nullptr), thread_local_chunk_size(0), intern_cache_strong_mask(0) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
+      std::fill(intern_cache, intern_cache + kInternCacheSizeInThread, nullptr);
     }
 
     // The biased card table, see CardTable for details.
@@ -1506,8 +1584,19 @@ class Thread {
     // Current method verifier, used for root marking.
     verifier::MethodVerifier* method_verifier;
 
+    // Current reg type cache shared by the methods of a class, used for root marking.
+    verifier::RegTypeCache* reg_type_cache;
+
     // Thread-local mark stack for the concurrent copying collector.
     gc::accounting::AtomicStack<mirror::Object>* thread_local_mark_stack;
+
+    // Size of the last chunk carved out of a region for this thread's TLAB.
+    size_t thread_local_chunk_size;
+
+    // Cache of recently interned strings, see GetInternCacheEntry().
+    mirror::String* intern_cache[kInternCacheSizeInThread];
+    // Bit i is set if intern_cache[i] is a strong intern.
+    size_t intern_cache_strong_mask;
   } tlsPtr_;
 
   // Guards the 'interrupted_' and 'wait_monitor_' members.
@@ -1527,6 +1616,19 @@ class Thread {
   // Pending extra checkpoints if checkpoint_function_ is already used.
   std::list<Closure*> checkpoint_overflow_ GUARDED_BY(Locks::thread_suspend_count_lock_);
 
+  // The stack this thread got from the runtime's ThreadStackPool, or null.
+  uint8_t* pooled_stack_ = nullptr;
+  size_t pooled_stack_size_ = 0u;
+
+  // What the interpreted field accesses and invokes of this thread resolved to.
+  InterpreterCache interpreter_cache_;
+
+  // The counts of the interpreter dispatch profiler not yet merged, or null.
+  interpreter::DispatchProfileBuffer* dispatch_profile_buffer_ = nullptr;
+
+  // The method trace events of this thread not yet written to the streaming trace, or null.
+  std::vector<uint8_t>* method_trace_buffer_ = nullptr;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
@@ -23,7 +23,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "base/histogram-inl.h"
 #include "base/mutex-inl.h"
@@ -37,7 +39,9 @@
 #include "monitor.h"
 #include "native_stack_dump.h"
 #include "scoped_thread_state_change.h"
+#include "suspend_latency_profiler.h"
 #include "thread.h"
+#include "thread_stack_pool.h"
 #include "trace.h"
 #include "well_known_classes.h"
 
@@ -62,11 +66,17 @@ static constexpr useconds_t kThreadSuspendMaxSleepUs = 5000;
 // some history.
 static constexpr bool kDumpUnattachedThreadNativeStack = true;
 
+// How many threads to keep and print statistics about being the slowest to suspend. Threads with
+// other names are accounted together once this is reached.
+static constexpr size_t kMaxSlowestSuspendThreads = 64;
+static constexpr size_t kMaxDumpedSlowestSuspendThreads = 10;
+
 ThreadList::ThreadList()
     : suspend_all_count_(0),
       debug_suspend_all_count_(0),
       unregistering_count_(0),
       suspend_all_historam_("suspend all histogram", 16, 64),
+      last_suspend_barrier_tid_(0),
       long_suspend_(false) {
   CHECK(Monitor::IsValidLockWord(LockWord::FromThinLockId(kMaxThreadId, 1, 0U)));
 }
@@ -133,6 +143,25 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
       suspend_all_historam_.CreateHistogram(&data);
       suspend_all_historam_.PrintConfidenceIntervals(os, 0.99, data);  // Dump time to suspend.
     }
+    if (!slowest_suspend_stats_.empty()) {
+      std::vector<std::pair<std::string, SlowestSuspendStats>> slowest(
+          slowest_suspend_stats_.begin(), slowest_suspend_stats_.end());
+      std::sort(slowest.begin(),
+                slowest.end(),
+                [](const std::pair<std::string, SlowestSuspendStats>& lhs,
+                   const std::pair<std::string, SlowestSuspendStats>& rhs) {
+        return lhs.second.total_time > rhs.second.total_time;
+      });
+      os << "Slowest threads to suspend:\n";
+      size_t num_dumped = std::min(slowest.size(), kMaxDumpedSlowestSuspendThreads);
+      for (size_t i = 0; i != num_dumped; ++i) {
+        const SlowestSuspendStats& stats = slowest[i].second;
+        os << "  \"" << slowest[i].first << "\" slowest " << stats.count << " times, total "
+           << PrettyDuration(stats.total_time) << " average "
+           << PrettyDuration(stats.total_time / stats.count) << " max "
+           << PrettyDuration(stats.max_time) << "\n";
+      }
+    }
   }
   bool dump_native_stack = Runtime::Current()->GetDumpNativeStackOnSigQuit();
   Dump(os, dump_native_stack);
@@ -180,19 +209,43 @@ void ThreadList::DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
 // overloaded with ANR dumps.
 static constexpr uint32_t kDumpWaitTimeout = kIsTargetBuild ? 100000 : 20000;
 
-// A closure used by Thread::Dump.
+// A closure used by Thread::Dump. When deferring native stacks, the checkpoint only records the
+// thread state and the managed stack, and the requestor unwinds the native stacks afterwards,
+// while the threads run. Unwinding and symbolizing is much slower than walking the managed stack,
+// and doing it in the checkpoint keeps each thread paused, holding the mutator lock, for as long.
 class DumpCheckpoint FINAL : public Closure {
  public:
-  DumpCheckpoint(std::ostream* os, bool dump_native_stack)
+  DumpCheckpoint(std::ostream* os, bool dump_native_stack, bool defer_native_stacks)
       : os_(os),
         barrier_(0),
         backtrace_map_(dump_native_stack ? BacktraceMap::Create(getpid()) : nullptr),
-        dump_native_stack_(dump_native_stack) {}
+        dump_native_stack_(dump_native_stack),
+        defer_native_stacks_(dump_native_stack && defer_native_stacks) {}
 
   void Run(Thread* thread) OVERRIDE {
     // Note thread and self may not be equal if thread was already suspended at the point of the
     // request.
     Thread* self = Thread::Current();
+    if (defer_native_stacks_) {
+      DeferredDump dump;
+      {
+        ScopedObjectAccess soa(self);
+        std::ostringstream state_os;
+        Thread::DumpState(state_os, thread, thread->GetTid());
+        std::ostringstream java_os;
+        thread->DumpJavaStack(java_os);
+        dump.tid = thread->GetTid();
+        dump.state = state_os.str();
+        dump.java_stack = java_os.str();
+        dump.dump_native_stack = thread->ShouldDumpNativeStack();
+      }
+      {
+        MutexLock mu(self, *Locks::logging_lock_);
+        deferred_dumps_.push_back(std::move(dump));
+      }
+      barrier_.Pass(self);
+      return;
+    }
     std::ostringstream local_os;
     {
       ScopedObjectAccess soa(self);
@@ -218,7 +271,35 @@ class DumpCheckpoint FINAL : public Closure {
     }
   }
 
+  // Writes the threads recorded by a deferring checkpoint, unwinding their native stacks now.
+  // Each thread is flushed as soon as it is written, so that a slow unwind of one thread does not
+  // hold back the output of the others.
+  void DumpDeferredThreads() {
+    std::vector<DeferredDump> dumps;
+    {
+      MutexLock mu(Thread::Current(), *Locks::logging_lock_);
+      dumps.swap(deferred_dumps_);
+    }
+    for (const DeferredDump& dump : dumps) {
+      *os_ << dump.state;
+      if (dump.dump_native_stack) {
+        DumpKernelStack(*os_, dump.tid, "  kernel: ", false);
+        // The current method recorded in the checkpoint may have returned by now, do not use it
+        // to name the frames.
+        DumpNativeStack(*os_, dump.tid, backtrace_map_.get(), "  native: ");
+      }
+      *os_ << dump.java_stack << "\n" << std::flush;
+    }
+  }
+
  private:
+  struct DeferredDump {
+    pid_t tid;
+    std::string state;
+    std::string java_stack;
+    bool dump_native_stack;
+  };
+
   // The common stream that will accumulate all the dumps.
   std::ostream* const os_;
   // The barrier to be passed through and for the requestor to wait upon.
@@ -227,6 +308,10 @@ class DumpCheckpoint FINAL : public Closure {
   std::unique_ptr<BacktraceMap> backtrace_map_;
   // Whether we should dump the native stack.
   const bool dump_native_stack_;
+  // Whether the native stacks are unwound by the requestor after the checkpoint.
+  const bool defer_native_stacks_;
+  // The threads that ran a deferring checkpoint, in the order they ran it.
+  std::vector<DeferredDump> deferred_dumps_ GUARDED_BY(Locks::logging_lock_);
 };
 
 void ThreadList::Dump(std::ostream& os, bool dump_native_stack) {
@@ -234,7 +319,8 @@ void ThreadList::Dump(std::ostream& os, bool dump_native_stack) {
     MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
     os << "DALVIK THREADS (" << list_.size() << "):\n";
   }
-  DumpCheckpoint checkpoint(&os, dump_native_stack);
+  // When aborting, unwind in the checkpoint: the threads may not get a chance to run again.
+  DumpCheckpoint checkpoint(&os, dump_native_stack, /* defer_native_stacks */ gAborting == 0);
   size_t threads_running_checkpoint;
   {
     // Use SOA to prevent deadlocks if multiple threads are calling Dump() at the same time.
@@ -244,6 +330,7 @@ void ThreadList::Dump(std::ostream& os, bool dump_native_stack) {
   if (threads_running_checkpoint != 0) {
     checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
   }
+  checkpoint.DumpDeferredThreads();
 }
 
 void ThreadList::AssertThreadsAreSuspended(Thread* self, Thread* ignore1, Thread* ignore2) {
@@ -405,6 +492,7 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
   Locks::thread_suspend_count_lock_->AssertNotHeld(self);
   CHECK_NE(self->GetState(), kRunnable);
 
+  SuspendLatencyProfiler::RequestStarted(collector->GetName().c_str());
   SuspendAllInternal(self, self, nullptr);
 
   // Run the flip callback for the collector.
@@ -478,6 +566,8 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     ScopedTrace trace("Suspending mutator threads");
     const uint64_t start_time = NanoTime();
 
+    last_suspend_barrier_tid_.StoreRelaxed(0);
+    SuspendLatencyProfiler::RequestStarted(cause);
     SuspendAllInternal(self, self);
     // All threads are known to have suspended (but a thread may still own the mutator lock)
     // Make sure this thread grabs exclusive access to the mutator lock and its protected data.
@@ -501,6 +591,7 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     const uint64_t end_time = NanoTime();
     const uint64_t suspend_time = end_time - start_time;
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
+    RecordSlowestSuspend(self, suspend_time);
     if (suspend_time > kLongThreadSuspendThreshold) {
       LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
     }
@@ -519,6 +610,40 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
   }
 }
 
+void ThreadList::RecordSlowestSuspend(Thread* self, uint64_t suspend_time) {
+  pid_t tid = last_suspend_barrier_tid_.LoadRelaxed();
+  if (tid == 0) {
+    return;
+  }
+  std::string name;
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    for (Thread* thread : list_) {
+      if (thread->GetTid() == tid) {
+        thread->GetThreadName(name);
+        break;
+      }
+    }
+  }
+  if (name.empty()) {
+    return;  // Another SuspendAll is going on, or the thread was not from this process.
+  }
+  auto it = slowest_suspend_stats_.find(name);
+  if (it == slowest_suspend_stats_.end()) {
+    if (slowest_suspend_stats_.size() >= kMaxSlowestSuspendThreads) {
+      name = "<other threads>";
+      it = slowest_suspend_stats_.find(name);
+    }
+    if (it == slowest_suspend_stats_.end()) {
+      it = slowest_suspend_stats_.Put(name, SlowestSuspendStats());
+    }
+  }
+  SlowestSuspendStats& stats = it->second;
+  ++stats.count;
+  stats.total_time += suspend_time;
+  stats.max_time = std::max(stats.max_time, suspend_time);
+}
+
 // Ensures all threads running Java suspend and that those not running Java don't start.
 // Debugger thread might be set to kRunnable for a short period of time after the
 // SuspendAllInternal. This is safe because it will be set back to suspended state before
@@ -940,6 +1065,7 @@ void ThreadList::SuspendAllForDebugger() {
 
   VLOG(threads) << *self << " SuspendAllForDebugger starting...";
 
+  SuspendLatencyProfiler::RequestStarted(__FUNCTION__);
   SuspendAllInternal(self, self, debug_thread, true);
   // Block on the mutator lock until all Runnable threads release their share of access then
   // immediately unlock again.
@@ -1274,6 +1400,8 @@ void ThreadList::Unregister(Thread* self) {
     }
     // We failed to remove the thread due to a suspend request, loop and try again.
   }
+  uint8_t* const pooled_stack = self->pooled_stack_;
+  const size_t pooled_stack_size = self->pooled_stack_size_;
   delete self;
 
   // Release the thread ID after the thread is finished and deleted to avoid cases where we can
@@ -1289,6 +1417,13 @@ void ThreadList::Unregister(Thread* self) {
   CHECK_PTHREAD_CALL(pthread_setspecific, (Thread::pthread_key_self_, nullptr), "detach self");
 #endif
 
+  // Still running on the stack, which is reused or unmapped only after joining this thread.
+  if (pooled_stack != nullptr) {
+    Runtime::Current()->GetThreadStackPool()->ReleaseExitingThread(pthread_self(),
+                                                                   pooled_stack,
+                                                                   pooled_stack_size);
+  }
+
   // Signal that a thread just detached.
   MutexLock mu(nullptr, *Locks::thread_list_lock_);
   --unregistering_count_;
@@ -17,15 +17,18 @@
 #ifndef ART_RUNTIME_THREAD_LIST_H_
 #define ART_RUNTIME_THREAD_LIST_H_
 
+#include "atomic.h"
 #include "base/histogram.h"
 #include "base/mutex.h"
 #include "base/value_object.h"
 #include "gc_root.h"
 #include "jni.h"
 #include "object_callbacks.h"
+#include "safe_map.h"
 
 #include <bitset>
 #include <list>
+#include <string>
 
 namespace art {
 namespace gc {
@@ -173,6 +176,10 @@ class ThreadList {
   void WaitForOtherNonDaemonThreadsToExit()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Account suspend_time to the thread that was the slowest to suspend.
+  void RecordSlowestSuspend(Thread* self, uint64_t suspend_time)
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
+
   void SuspendAllInternal(Thread* self,
                           Thread* ignore1,
                           Thread* ignore2 = nullptr,
@@ -198,6 +205,23 @@ class ThreadList {
   // by mutator lock ensures no thread can read when another thread is modifying it.
   Histogram<uint64_t> suspend_all_historam_ GUARDED_BY(Locks::mutator_lock_);
 
+  // Tid of the thread that passed the last suspend barrier, that is the thread the latest
+  // SuspendAll waited for the longest. Several concurrent SuspendAllInternal calls can mix this
+  // up, which only affects the statistics below.
+  Atomic<pid_t> last_suspend_barrier_tid_;
+
+  // Time to suspend of the SuspendAlls, by name of the thread that was the slowest to suspend.
+  // Threads that reached their suspend point without running (for example in native code) do not
+  // count, so SuspendAlls that did not wait for any thread do not show up.
+  struct SlowestSuspendStats {
+    SlowestSuspendStats() : count(0u), total_time(0u), max_time(0u) {}
+    uint64_t count;
+    uint64_t total_time;
+    uint64_t max_time;
+  };
+  SafeMap<std::string, SlowestSuspendStats> slowest_suspend_stats_
+      GUARDED_BY(Locks::mutator_lock_);
+
   // Whether or not the current thread suspension is long.
   bool long_suspend_;
 
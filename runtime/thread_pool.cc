@@ -24,6 +24,7 @@
 #include "base/bit_utils.h"
 #include "base/casts.h"
 #include "base/logging.h"
+#include "base/numa.h"
 #include "base/stl_util.h"
 #include "base/time_utils.h"
 #include "runtime.h"
@@ -36,7 +37,10 @@ static constexpr bool kMeasureWaitTime = false;
 ThreadPoolWorker::ThreadPoolWorker(ThreadPool* thread_pool, const std::string& name,
                                    size_t stack_size)
     : thread_pool_(thread_pool),
-      name_(name) {
+      name_(name),
+      thread_(nullptr),
+      node_(0u),
+      local_tasks_lock_("thread pool worker tasks lock", kThreadPoolWorkerTasksLock) {
   // Add an inaccessible page to catch stack overflow.
   stack_size += kPageSize;
   std::string error_msg;
@@ -74,6 +78,7 @@ void ThreadPoolWorker::SetPthreadPriority(int priority) {
 void ThreadPoolWorker::Run() {
   Thread* self = Thread::Current();
   Task* task = nullptr;
+  thread_ = self;
   thread_pool_->creation_barier_.Wait(self);
   while ((task = thread_pool_->GetTask(self)) != nullptr) {
     task->Run(self);
@@ -92,6 +97,15 @@ void* ThreadPoolWorker::Callback(void* arg) {
 }
 
 void ThreadPool::AddTask(Thread* self, Task* task) {
+  if (work_stealing_) {
+    ThreadPoolWorker* worker = FindWorker(self);
+    if (worker == nullptr) {
+      worker = threads_[next_worker_.FetchAndAddRelaxed(1u) % threads_.size()];
+    }
+    AddLocalTasks(self, worker, &task, 1u);
+    SignalLocalTasksAdded(self, 1u);
+    return;
+  }
   MutexLock mu(self, task_queue_lock_);
   tasks_.push_back(task);
   // If we have any waiters, signal one.
@@ -100,12 +114,85 @@ void ThreadPool::AddTask(Thread* self, Task* task) {
   }
 }
 
+void ThreadPool::AddTasks(Thread* self, const std::vector<Task*>& tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  if (work_stealing_) {
+    ThreadPoolWorker* worker = FindWorker(self);
+    if (worker != nullptr) {
+      // Keep them close, idle workers will steal their share.
+      AddLocalTasks(self, worker, tasks.data(), tasks.size());
+    } else {
+      // Deal them out in contiguous chunks, one per worker.
+      const size_t num_workers = threads_.size();
+      const size_t first = next_worker_.FetchAndAddRelaxed(1u);
+      for (size_t i = 0; i != num_workers; ++i) {
+        size_t begin = tasks.size() * i / num_workers;
+        size_t end = tasks.size() * (i + 1) / num_workers;
+        if (begin != end) {
+          AddLocalTasks(self, threads_[(first + i) % num_workers], &tasks[begin], end - begin);
+        }
+      }
+    }
+    SignalLocalTasksAdded(self, tasks.size());
+    return;
+  }
+  MutexLock mu(self, task_queue_lock_);
+  tasks_.insert(tasks_.end(), tasks.begin(), tasks.end());
+  if (started_ && waiting_count_ != 0) {
+    task_queue_condition_.Broadcast(self);
+  }
+}
+
+void ThreadPool::AddLocalTasks(Thread* self,
+                               ThreadPoolWorker* worker,
+                               Task* const* tasks,
+                               size_t count) {
+  MutexLock mu(self, worker->local_tasks_lock_);
+  worker->local_tasks_.insert(worker->local_tasks_.end(), tasks, tasks + count);
+  // Counted while holding the worker lock, so that the count never goes below the content.
+  num_local_tasks_.FetchAndAddSequentiallyConsistent(count);
+}
+
+void ThreadPool::SignalLocalTasksAdded(Thread* self, size_t count) {
+  // Pairs with the increment of num_sleeping_workers_ before the sleeping worker checks for tasks,
+  // so that either the worker sees the new tasks or we see the worker.
+  if (num_sleeping_workers_.LoadSequentiallyConsistent() != 0u) {
+    MutexLock mu(self, task_queue_lock_);
+    if (started_) {
+      if (count == 1u) {
+        task_queue_condition_.Signal(self);
+      } else {
+        task_queue_condition_.Broadcast(self);
+      }
+    }
+  }
+}
+
+ThreadPoolWorker* ThreadPool::FindWorker(Thread* self) const {
+  for (ThreadPoolWorker* worker : threads_) {
+    if (worker->thread_ == self) {
+      return worker;
+    }
+  }
+  return nullptr;
+}
+
 void ThreadPool::RemoveAllTasks(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
   tasks_.clear();
+  for (ThreadPoolWorker* worker : threads_) {
+    MutexLock mu2(self, worker->local_tasks_lock_);
+    num_local_tasks_.FetchAndSubSequentiallyConsistent(worker->local_tasks_.size());
+    worker->local_tasks_.clear();
+  }
 }
 
-ThreadPool::ThreadPool(const char* name, size_t num_threads)
+ThreadPool::ThreadPool(const char* name,
+                       size_t num_threads,
+                       bool prioritized,
+                       bool work_stealing)
   : name_(name),
     task_queue_lock_("task queue lock"),
     task_queue_condition_("task queue condition", task_queue_lock_),
@@ -117,7 +204,15 @@ ThreadPool::ThreadPool(const char* name, size_t num_threads)
     total_wait_time_(0),
     // Add one since the caller of constructor waits on the barrier too.
     creation_barier_(num_threads + 1),
-    max_active_workers_(num_threads) {
+    max_active_workers_(num_threads),
+    prioritized_(prioritized),
+    work_stealing_(work_stealing && num_threads != 0u),
+    num_local_tasks_(0u),
+    num_sleeping_workers_(0u),
+    next_worker_(0u),
+    num_nodes_(1u) {
+  // Worker queues have no priorities.
+  CHECK(!(prioritized && work_stealing));
   Thread* self = Thread::Current();
   while (GetThreadCount() < num_threads) {
     const std::string worker_name = StringPrintf("%s worker thread %zu", name_.c_str(),
@@ -163,6 +258,9 @@ void ThreadPool::StopWorkers(Thread* self) {
 }
 
 Task* ThreadPool::GetTask(Thread* self) {
+  if (work_stealing_) {
+    return GetWorkStealingTask(self, FindWorker(self));
+  }
   MutexLock mu(self, task_queue_lock_);
   while (!IsShuttingDown()) {
     const size_t thread_count = GetThreadCount();
@@ -194,15 +292,116 @@ Task* ThreadPool::GetTask(Thread* self) {
   return nullptr;
 }
 
+Task* ThreadPool::GetWorkStealingTask(Thread* self, ThreadPoolWorker* worker) {
+  DCHECK(worker != nullptr);
+  bool may_run = false;
+  while (true) {
+    if (may_run) {
+      Task* task = TryGetWorkStealingTask(self, worker);
+      if (task != nullptr) {
+        return task;
+      }
+    }
+    MutexLock mu(self, task_queue_lock_);
+    if (IsShuttingDown()) {
+      return nullptr;
+    }
+    may_run = started_ && IsWorkerActive(worker);
+    ++waiting_count_;
+    num_sleeping_workers_.FetchAndAddSequentiallyConsistent(1u);
+    if (may_run && HasQueuedTasks()) {
+      // Tasks were added since we looked, or we were not allowed to run them yet.
+      num_sleeping_workers_.FetchAndSubSequentiallyConsistent(1u);
+      --waiting_count_;
+      continue;
+    }
+    if (waiting_count_ == GetThreadCount() && !HasQueuedTasks()) {
+      // We may be done, lets broadcast to the completion condition.
+      completion_condition_.Broadcast(self);
+    }
+    const uint64_t wait_start = kMeasureWaitTime ? NanoTime() : 0;
+    task_queue_condition_.Wait(self);
+    if (kMeasureWaitTime) {
+      const uint64_t wait_end = NanoTime();
+      total_wait_time_ += wait_end - std::max(wait_start, start_time_);
+    }
+    num_sleeping_workers_.FetchAndSubSequentiallyConsistent(1u);
+    --waiting_count_;
+    if (IsShuttingDown()) {
+      return nullptr;
+    }
+    may_run = started_ && IsWorkerActive(worker);
+  }
+}
+
+Task* ThreadPool::TryGetWorkStealingTask(Thread* self, ThreadPoolWorker* worker) {
+  if (worker != nullptr) {
+    MutexLock mu(self, worker->local_tasks_lock_);
+    if (!worker->local_tasks_.empty()) {
+      Task* task = worker->local_tasks_.back();
+      worker->local_tasks_.pop_back();
+      num_local_tasks_.FetchAndSubSequentiallyConsistent(1u);
+      return task;
+    }
+  }
+  if (num_local_tasks_.LoadRelaxed() == 0u) {
+    return nullptr;
+  }
+  // Start after ourselves, so that thieves do not all go for the first worker.
+  const size_t num_workers = threads_.size();
+  size_t start = (worker != nullptr) ? std::find(threads_.begin(), threads_.end(), worker) -
+      threads_.begin() + 1u : next_worker_.LoadRelaxed();
+  // With several NUMA nodes, the tasks of the workers on our own node are tried first, as their
+  // data is more likely to be local.
+  const bool by_node = num_nodes_ > 1u && worker != nullptr;
+  for (size_t pass = by_node ? 0u : 1u; pass != 2u; ++pass) {
+    for (size_t i = 0; i != num_workers; ++i) {
+      ThreadPoolWorker* victim = threads_[(start + i) % num_workers];
+      if (victim == worker || (by_node && (victim->node_ == worker->node_) != (pass == 0u))) {
+        continue;
+      }
+      MutexLock mu(self, victim->local_tasks_lock_);
+      if (!victim->local_tasks_.empty()) {
+        Task* task = victim->local_tasks_.front();
+        victim->local_tasks_.pop_front();
+        num_local_tasks_.FetchAndSubSequentiallyConsistent(1u);
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
+
 Task* ThreadPool::TryGetTask(Thread* self) {
+  if (work_stealing_) {
+    {
+      MutexLock mu(self, task_queue_lock_);
+      if (!started_) {
+        return nullptr;
+      }
+    }
+    // Called by a thread helping out in Wait, it has no queue of its own.
+    return TryGetWorkStealingTask(self, FindWorker(self));
+  }
   MutexLock mu(self, task_queue_lock_);
   return TryGetTaskLocked();
 }
 
 Task* ThreadPool::TryGetTaskLocked() {
   if (started_ && !tasks_.empty()) {
-    Task* task = tasks_.front();
-    tasks_.pop_front();
+    auto it = tasks_.begin();
+    if (prioritized_) {
+      size_t best_priority = (*it)->GetPriority();
+      for (auto candidate = it + 1; candidate != tasks_.end(); ++candidate) {
+        const size_t priority = (*candidate)->GetPriority();
+        if (priority > best_priority) {
+          best_priority = priority;
+          it = candidate;
+        }
+      }
+    }
+    Task* task = *it;
+    tasks_.erase(it);
     return task;
   }
   return nullptr;
@@ -218,7 +417,7 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
   }
   // Wait until each thread is waiting and the task list is empty.
   MutexLock mu(self, task_queue_lock_);
-  while (!shutting_down_ && (waiting_count_ != GetThreadCount() || !tasks_.empty())) {
+  while (!shutting_down_ && (waiting_count_ != GetThreadCount() || HasQueuedTasks())) {
     if (!may_hold_locks) {
       completion_condition_.Wait(self);
     } else {
@@ -229,7 +428,7 @@ void ThreadPool::Wait(Thread* self, bool do_work, bool may_hold_locks) {
 
 size_t ThreadPool::GetTaskCount(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
-  return tasks_.size();
+  return tasks_.size() + num_local_tasks_.LoadSequentiallyConsistent();
 }
 
 void ThreadPool::SetPthreadPriority(int priority) {
@@ -238,4 +437,16 @@ void ThreadPool::SetPthreadPriority(int priority) {
   }
 }
 
+void ThreadPool::SetNodeAffinity(const std::vector<std::vector<int>>& node_cpus) {
+  CHECK(!node_cpus.empty());
+  for (size_t i = 0; i != threads_.size(); ++i) {
+    ThreadPoolWorker* worker = threads_[i];
+    size_t node = i % node_cpus.size();
+    if (Numa::SetThreadAffinity(worker->thread_->GetTid(), node_cpus[node])) {
+      worker->node_ = node;
+    }
+  }
+  num_nodes_ = node_cpus.size();
+}
+
 }  // namespace art
@@ -17,9 +17,11 @@
 #ifndef ART_RUNTIME_THREAD_POOL_H_
 #define ART_RUNTIME_THREAD_POOL_H_
 
+#include <algorithm>
 #include <deque>
 #include <vector>
 
+#include "atomic.h"
 #include "barrier.h"
 #include "base/mutex.h"
 #include "mem_map.h"
@@ -38,6 +40,12 @@ class Task : public Closure {
  public:
   // Called after Closure::Run has been called.
   virtual void Finalize() { }
+
+  // Tasks with a higher priority are run first by a prioritized thread pool. The priority is
+  // read each time a worker picks a task, so it may change while the task is queued.
+  virtual size_t GetPriority() const {
+    return 0;
+  }
 };
 
 class SelfDeletingTask : public Task {
@@ -71,6 +79,15 @@ class ThreadPoolWorker {
   const std::string name_;
   std::unique_ptr<MemMap> stack_;
   pthread_t pthread_;
+  // Set before the pool constructor returns, once the worker is attached.
+  Thread* thread_;
+  // The NUMA node the worker was pinned to by ThreadPool::SetNodeAffinity, 0 if it was not.
+  size_t node_;
+
+  // The tasks of a work-stealing pool that were given to this worker. The worker runs them
+  // newest first, other threads steal them oldest first.
+  Mutex local_tasks_lock_;
+  std::deque<Task*> local_tasks_ GUARDED_BY(local_tasks_lock_);
 
  private:
   friend class ThreadPool;
@@ -94,10 +111,41 @@ class ThreadPool {
   // after running it, it is the caller's responsibility.
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
+  // Add several tasks at once, taking each queue lock once rather than once per task.
+  void AddTasks(Thread* self, const std::vector<Task*>& tasks) REQUIRES(!task_queue_lock_);
+
   // Remove all tasks in the queue.
   void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
 
-  ThreadPool(const char* name, size_t num_threads);
+  // Remove the queued tasks for which `predicate` returns true, and finalize them. The
+  // predicate is called with the task queue lock held.
+  template <typename Predicate>
+  void RemoveTasksIf(Thread* self, Predicate predicate) REQUIRES(!task_queue_lock_) {
+    std::vector<Task*> removed;
+    {
+      MutexLock mu(self, task_queue_lock_);
+      RemoveIf(&tasks_, predicate, &removed);
+      for (ThreadPoolWorker* worker : threads_) {
+        MutexLock mu2(self, worker->local_tasks_lock_);
+        size_t num_removed = removed.size();
+        RemoveIf(&worker->local_tasks_, predicate, &removed);
+        num_local_tasks_.FetchAndSubSequentiallyConsistent(removed.size() - num_removed);
+      }
+    }
+    for (Task* task : removed) {
+      task->Finalize();
+    }
+  }
+
+  // A prioritized thread pool runs the queued task with the highest Task::GetPriority first,
+  // ties are broken in arrival order. Otherwise tasks are run in arrival order, unless the pool
+  // is work-stealing: then each worker has its own queue, which gets the tasks the worker adds
+  // and a share of the tasks added by other threads, and idle workers steal from the others.
+  // This spares small tasks the contention on the shared queue, but gives no ordering.
+  ThreadPool(const char* name,
+             size_t num_threads,
+             bool prioritized = false,
+             bool work_stealing = false);
   virtual ~ThreadPool();
 
   // Wait for all tasks currently on queue to get completed.
@@ -117,6 +165,11 @@ class ThreadPool {
   // Set the "nice" priorty for threads in the pool.
   void SetPthreadPriority(int priority);
 
+  // Pin the workers round-robin to the CPUs of the given NUMA nodes, so that the memory they
+  // touch first comes from their own node. Idle workers of a work-stealing pool then steal from
+  // the workers of their own node first. Must be called before any task is added.
+  void SetNodeAffinity(const std::vector<std::vector<int>>& node_cpus);
+
  protected:
   // get a task to run, blocks if there are no tasks left
   virtual Task* GetTask(Thread* self) REQUIRES(!task_queue_lock_);
@@ -125,6 +178,37 @@ class ThreadPool {
   Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
   Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
 
+  // For work-stealing pools. Returns the worker running on `self`, or null.
+  ThreadPoolWorker* FindWorker(Thread* self) const;
+  Task* GetWorkStealingTask(Thread* self, ThreadPoolWorker* worker) REQUIRES(!task_queue_lock_);
+  // Take a task from the queue of `worker` if not null, or else steal one from another worker.
+  Task* TryGetWorkStealingTask(Thread* self, ThreadPoolWorker* worker)
+      REQUIRES(!task_queue_lock_);
+  void AddLocalTasks(Thread* self, ThreadPoolWorker* worker, Task* const* tasks, size_t count)
+      REQUIRES(!task_queue_lock_);
+  // Wakes up the sleeping workers after tasks were added to the worker queues.
+  void SignalLocalTasksAdded(Thread* self, size_t count) REQUIRES(!task_queue_lock_);
+  bool IsWorkerActive(ThreadPoolWorker* worker) REQUIRES(task_queue_lock_) {
+    size_t index = std::find(threads_.begin(), threads_.end(), worker) - threads_.begin();
+    return index < max_active_workers_;
+  }
+
+  bool HasQueuedTasks() const REQUIRES(task_queue_lock_) {
+    return !tasks_.empty() || num_local_tasks_.LoadSequentiallyConsistent() != 0u;
+  }
+
+  template <typename Predicate>
+  static void RemoveIf(std::deque<Task*>* tasks, Predicate predicate, std::vector<Task*>* removed) {
+    for (auto it = tasks->begin(); it != tasks->end();) {
+      if (predicate(*it)) {
+        removed->push_back(*it);
+        it = tasks->erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
   // Are we shutting down?
   bool IsShuttingDown() const REQUIRES(task_queue_lock_) {
     return shutting_down_;
@@ -146,6 +230,18 @@ class ThreadPool {
   uint64_t total_wait_time_;
   Barrier creation_barier_;
   size_t max_active_workers_ GUARDED_BY(task_queue_lock_);
+  const bool prioritized_;
+  // Only for pools with workers, a pool without workers has nobody to steal for.
+  const bool work_stealing_;
+  // The number of tasks in the worker queues.
+  Atomic<size_t> num_local_tasks_;
+  // The number of workers sleeping on task_queue_condition_ in a work-stealing pool, so that
+  // adding a task to a worker queue only takes task_queue_lock_ when somebody needs waking up.
+  Atomic<size_t> num_sleeping_workers_;
+  // Where the tasks added by threads other than the workers go next.
+  Atomic<size_t> next_worker_;
+  // The number of NUMA nodes the workers were spread over, see SetNodeAffinity.
+  size_t num_nodes_;
 
  private:
   friend class ThreadPoolWorker;
@@ -16,7 +16,9 @@
 
 #include "thread_pool.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "atomic.h"
 #include "common_runtime_test.h"
@@ -136,4 +138,171 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
 }
 
+class PriorityTask : public Task {
+ public:
+  PriorityTask(std::vector<size_t>* order, size_t priority)
+      : order_(order), priority_(priority) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) {
+    // Only one worker runs the tasks, no need to synchronize.
+    order_->push_back(priority_);
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+  size_t GetPriority() const OVERRIDE {
+    return priority_;
+  }
+
+ private:
+  std::vector<size_t>* const order_;
+  const size_t priority_;
+};
+
+// Test that a prioritized thread pool runs the highest priority tasks first, and tasks of equal
+// priority in arrival order.
+TEST_F(ThreadPoolTest, PriorityOrder) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", 1, /* prioritized */ true);
+  std::vector<size_t> order;
+  static const size_t priorities[] = { 1, 5, 2, 5, 0, 3 };
+  for (size_t priority : priorities) {
+    thread_pool.AddTask(self, new PriorityTask(&order, priority));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, false, false);
+  std::vector<size_t> expected = { 5, 5, 3, 2, 1, 0 };
+  EXPECT_EQ(expected, order);
+}
+
+TEST_F(ThreadPoolTest, RemoveTasksIf) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  AtomicInteger count(0);
+  AtomicInteger removed_count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    thread_pool.AddTask(self, new CountTask(&count));
+    thread_pool.AddTask(self, new CountTask(&removed_count));
+  }
+  EXPECT_EQ(static_cast<size_t>(num_tasks * 2), thread_pool.GetTaskCount(self));
+  // The tasks counting into `removed_count` are every other task.
+  size_t index = 0;
+  thread_pool.RemoveTasksIf(self, [&index](Task* task ATTRIBUTE_UNUSED) {
+    return (index++ % 2) == 1;
+  });
+  EXPECT_EQ(static_cast<size_t>(num_tasks), thread_pool.GetTaskCount(self));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ(num_tasks, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0, removed_count.LoadSequentiallyConsistent());
+}
+
+// Test that a work-stealing pool runs the tasks added by its workers and by other threads.
+TEST_F(ThreadPoolTest, WorkStealing) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool",
+                         num_threads,
+                         /* prioritized */ false,
+                         /* work_stealing */ true);
+  AtomicInteger count(0);
+  static const int depth = 8;
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  static const int32_t num_tasks = num_threads * 4;
+  std::vector<Task*> tasks;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    tasks.push_back(new CountTask(&count));
+  }
+  thread_pool.AddTasks(self, tasks);
+  EXPECT_EQ(static_cast<size_t>(num_tasks + 1), thread_pool.GetTaskCount(self));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ((1 << depth) - 1 + num_tasks, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(self));
+}
+
+// Two nodes sharing CPU 0, so that stealing goes through both passes.
+TEST_F(ThreadPoolTest, WorkStealingByNode) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool",
+                         num_threads,
+                         /* prioritized */ false,
+                         /* work_stealing */ true);
+  thread_pool.SetNodeAffinity({ { 0 }, { 0 } });
+  AtomicInteger count(0);
+  static const int depth = 8;
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(self));
+}
+
+TEST_F(ThreadPoolTest, WorkStealingRemoveTasksIf) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool",
+                         num_threads,
+                         /* prioritized */ false,
+                         /* work_stealing */ true);
+  AtomicInteger count(0);
+  AtomicInteger removed_count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  std::vector<Task*> tasks;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    tasks.push_back(new CountTask(&count));
+    tasks.push_back(new CountTask(&removed_count));
+  }
+  thread_pool.AddTasks(self, tasks);
+  // The tasks counting into `removed_count` are every other task.
+  thread_pool.RemoveTasksIf(self, [&tasks](Task* task) {
+    return ((std::find(tasks.begin(), tasks.end(), task) - tasks.begin()) % 2) == 1;
+  });
+  EXPECT_EQ(static_cast<size_t>(num_tasks), thread_pool.GetTaskCount(self));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ(num_tasks, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0, removed_count.LoadSequentiallyConsistent());
+}
+
+class IncrementTask : public Task {
+ public:
+  explicit IncrementTask(AtomicInteger* count) : count_(count) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) {
+    count_->FetchAndAddRelaxed(1);
+  }
+
+ private:
+  AtomicInteger* const count_;
+};
+
+// Test that both modes run a large number of tiny tasks added one at a time and in a batch.
+TEST_F(ThreadPoolTest, TinyTasks) {
+  Thread* self = Thread::Current();
+  static const size_t kNumTasks = 100000;
+  for (bool work_stealing : { false, true }) {
+    ThreadPool thread_pool("Thread pool test thread pool",
+                           num_threads,
+                           /* prioritized */ false,
+                           work_stealing);
+    AtomicInteger count(0);
+    std::vector<IncrementTask> tasks(kNumTasks, IncrementTask(&count));
+    std::vector<Task*> task_pointers;
+    for (IncrementTask& task : tasks) {
+      task_pointers.push_back(&task);
+    }
+    thread_pool.StartWorkers(self);
+    for (Task* task : task_pointers) {
+      thread_pool.AddTask(self, task);
+    }
+    thread_pool.Wait(self, true, false);
+    EXPECT_EQ(static_cast<int32_t>(kNumTasks), count.LoadSequentiallyConsistent());
+    thread_pool.AddTasks(self, task_pointers);
+    thread_pool.Wait(self, true, false);
+    EXPECT_EQ(static_cast<int32_t>(2 * kNumTasks), count.LoadSequentiallyConsistent());
+  }
+}
+
 }  // namespace art
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread_stack_pool.h"
+
+#include <sys/mman.h>
+
+#include <iterator>
+
+#include "base/logging.h"
+#include "globals.h"
+#include "thread.h"
+
+namespace art {
+
+ThreadStackPool::ThreadStackPool(size_t max_exited_threads)
+    : max_exited_threads_(max_exited_threads), lock_("thread stack pool lock") {
+  CHECK_GT(max_exited_threads_, 0u);
+}
+
+ThreadStackPool::~ThreadStackPool() {
+  std::deque<ExitedThread> exited_threads;
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    exited_threads.swap(exited_threads_);
+  }
+  for (const ExitedThread& exited : exited_threads) {
+    JoinAndFree(exited);
+  }
+}
+
+uint8_t* ThreadStackPool::Allocate(size_t size) {
+  DCHECK_ALIGNED(size, kPageSize);
+  bool found = false;
+  ExitedThread reused = {};
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    // Prefer the most recently exited thread, its stack is the most likely to be in the caches.
+    for (auto it = exited_threads_.rbegin(); it != exited_threads_.rend(); ++it) {
+      if (it->size == size) {
+        reused = *it;
+        exited_threads_.erase(std::next(it).base());
+        found = true;
+        break;
+      }
+    }
+  }
+  if (found) {
+    // The thread has already unregistered, so this only waits for it to leave its stack.
+    CHECK_PTHREAD_CALL(pthread_join, (reused.pthread, nullptr), "reuse thread stack");
+    return reused.stack;
+  }
+  // pthread does not add a guard page to stacks it did not map itself, so map one below.
+  void* map = mmap(nullptr,
+                   size + kPageSize,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1,
+                   0);
+  if (map == MAP_FAILED) {
+    PLOG(WARNING) << "Failed to map a thread stack of " << size << " bytes";
+    return nullptr;
+  }
+  if (mprotect(map, kPageSize, PROT_NONE) != 0) {
+    PLOG(WARNING) << "Failed to protect the guard page of a thread stack";
+    munmap(map, size + kPageSize);
+    return nullptr;
+  }
+  return reinterpret_cast<uint8_t*>(map) + kPageSize;
+}
+
+void ThreadStackPool::Free(uint8_t* stack, size_t size) {
+  if (munmap(stack - kPageSize, size + kPageSize) != 0) {
+    PLOG(ERROR) << "Failed to unmap thread stack at " << reinterpret_cast<void*>(stack);
+  }
+}
+
+void ThreadStackPool::ReleaseExitingThread(pthread_t pthread, uint8_t* stack, size_t size) {
+  ExitedThread exited = { pthread, stack, size };
+  bool evict = false;
+  ExitedThread evicted = {};
+  {
+    MutexLock mu(Thread::Current(), lock_);
+    exited_threads_.push_back(exited);
+    if (exited_threads_.size() > max_exited_threads_) {
+      evicted = exited_threads_.front();
+      exited_threads_.pop_front();
+      evict = true;
+    }
+  }
+  if (evict) {
+    // Never ourselves, we were just added at the back.
+    JoinAndFree(evicted);
+  }
+}
+
+size_t ThreadStackPool::GetExitedThreadCount() {
+  MutexLock mu(Thread::Current(), lock_);
+  return exited_threads_.size();
+}
+
+void ThreadStackPool::JoinAndFree(const ExitedThread& exited) {
+  CHECK_PTHREAD_CALL(pthread_join, (exited.pthread, nullptr), "evict thread stack");
+  Free(exited.stack, exited.size);
+}
+
+}  // namespace art
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_THREAD_STACK_POOL_H_
+#define ART_RUNTIME_THREAD_STACK_POOL_H_
+
+#include <pthread.h>
+
+#include <deque>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+// Recycles the native stacks of the threads started by Thread::CreateNativeThread, enabled with
+// -Xthreadstackpool:<n>. Pooled threads are created joinable on a stack mapped here, with a guard
+// page at its low end. When such a thread exits, its stack is kept together with its pthread_t:
+// the thread may still be running on it until it is joined, which happens when the stack is
+// handed to a new thread or evicted from the pool. This saves the mmap, munmap and guard page
+// setup of every thread start for programs that start and end many threads.
+class ThreadStackPool {
+ public:
+  explicit ThreadStackPool(size_t max_exited_threads);
+
+  // All threads that got their stack from this pool must have ended.
+  ~ThreadStackPool() REQUIRES(!lock_);
+
+  // Returns the low end of a stack of `size` bytes, or null if it could not be mapped.
+  uint8_t* Allocate(size_t size) REQUIRES(!lock_);
+
+  // Unmaps a stack that no thread was started on.
+  void Free(uint8_t* stack, size_t size) REQUIRES(!lock_);
+
+  // Called by an exiting thread that runs on `stack`, which it got from Allocate.
+  void ReleaseExitingThread(pthread_t pthread, uint8_t* stack, size_t size) REQUIRES(!lock_);
+
+  size_t GetExitedThreadCount() REQUIRES(!lock_);
+
+ private:
+  struct ExitedThread {
+    pthread_t pthread;
+    uint8_t* stack;
+    size_t size;
+  };
+
+  void JoinAndFree(const ExitedThread& exited) REQUIRES(!lock_);
+
+  const size_t max_exited_threads_;
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Oldest first.
+  std::deque<ExitedThread> exited_threads_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadStackPool);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_THREAD_STACK_POOL_H_
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "thread_stack_pool.h"
+
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+
+namespace art {
+
+class ThreadStackPoolTest : public CommonRuntimeTest {};
+
+static constexpr size_t kTestStackSize = 16 * kPageSize;
+
+struct TestThreadArgs {
+  ThreadStackPool* pool;
+  uint8_t* stack;
+};
+
+static void* ReleaseStackCallback(void* arg) {
+  TestThreadArgs* args = reinterpret_cast<TestThreadArgs*>(arg);
+  args->pool->ReleaseExitingThread(pthread_self(), args->stack, kTestStackSize);
+  return nullptr;
+}
+
+static void StartThreadOnStack(TestThreadArgs* args) {
+  pthread_attr_t attr;
+  CHECK_PTHREAD_CALL(pthread_attr_init, (&attr), "test thread");
+  CHECK_PTHREAD_CALL(pthread_attr_setstack, (&attr, args->stack, kTestStackSize), "test thread");
+  pthread_t pthread;
+  CHECK_PTHREAD_CALL(pthread_create, (&pthread, &attr, ReleaseStackCallback, args), "test thread");
+  CHECK_PTHREAD_CALL(pthread_attr_destroy, (&attr), "test thread");
+}
+
+TEST_F(ThreadStackPoolTest, ReusesStacksOfExitedThreads) {
+  ThreadStackPool pool(/* max_exited_threads */ 1u);
+  TestThreadArgs first = { &pool, pool.Allocate(kTestStackSize) };
+  ASSERT_TRUE(first.stack != nullptr);
+  StartThreadOnStack(&first);
+  while (pool.GetExitedThreadCount() == 0u) {
+    NanoSleep(1000000);
+  }
+
+  // A stack of another size is mapped anew.
+  uint8_t* other = pool.Allocate(2 * kTestStackSize);
+  ASSERT_TRUE(other != nullptr);
+  EXPECT_NE(first.stack, other);
+  pool.Free(other, 2 * kTestStackSize);
+  EXPECT_EQ(1u, pool.GetExitedThreadCount());
+
+  // The exited thread is joined and its stack handed out again.
+  TestThreadArgs second = { &pool, pool.Allocate(kTestStackSize) };
+  EXPECT_EQ(first.stack, second.stack);
+  EXPECT_EQ(0u, pool.GetExitedThreadCount());
+
+  // The pool joins the second thread and unmaps its stack when deleted.
+  StartThreadOnStack(&second);
+  while (pool.GetExitedThreadCount() == 0u) {
+    NanoSleep(1000000);
+  }
+}
+
+}  // namespace art
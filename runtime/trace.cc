@@ -20,6 +20,7 @@
 #include <unistd.h>
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/stl_util.h"
@@ -51,6 +52,10 @@ static constexpr size_t TraceActionBits = MinimumBitsToStore(
 static constexpr uint8_t kOpNewMethod = 1U;
 static constexpr uint8_t kOpNewThread = 2U;
 
+// In streaming mode, each thread buffers this many bytes of events before taking the streaming
+// lock to write them out.
+static constexpr size_t kThreadBufferSize = 16 * KB;
+
 class BuildStackTraceVisitor : public StackVisitor {
  public:
   explicit BuildStackTraceVisitor(Thread* thread)
@@ -220,13 +225,30 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) SHARED_REQUIRES(Locks::mutator_lock_) {
-  BuildStackTraceVisitor build_trace_visitor(thread);
-  build_trace_visitor.WalkStack();
-  std::vector<ArtMethod*>* stack_trace = build_trace_visitor.GetStackTrace();
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
-  the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
-}
+// Samples the stack of each thread in a checkpoint, so that the running threads walk their own
+// stacks at their next suspend check instead of all of them being suspended for every sample.
+// The stacks of the threads that are already suspended are walked by the sampling thread.
+class SampleCheckpoint FINAL : public Closure {
+ public:
+  explicit SampleCheckpoint(Trace* the_trace) : the_trace_(the_trace), barrier_(0) {}
+
+  void Run(Thread* thread) OVERRIDE SHARED_REQUIRES(Locks::mutator_lock_) {
+    BuildStackTraceVisitor build_trace_visitor(thread);
+    build_trace_visitor.WalkStack();
+    the_trace_->CompareAndUpdateStackTrace(thread, build_trace_visitor.GetStackTrace());
+    barrier_.Pass(Thread::Current());
+  }
+
+  void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
+    Thread* self = Thread::Current();
+    ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+    barrier_.Increment(self, threads_running_checkpoint);
+  }
+
+ private:
+  Trace* const the_trace_;
+  Barrier barrier_;
+};
 
 static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
   thread->SetTraceClockBase(0);
@@ -235,9 +257,20 @@ static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUT
   delete stack_trace;
 }
 
+static void FlushThreadTraceBuffer(Thread* thread, void* arg)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  reinterpret_cast<Trace*>(arg)->FlushThreadBuffer(thread);
+}
+
+static void DeleteThreadTraceBuffer(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
+  delete thread->GetMethodTraceBuffer();
+  thread->SetMethodTraceBuffer(nullptr);
+}
+
 void Trace::CompareAndUpdateStackTrace(Thread* thread,
                                        std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
+  // Called by the thread itself or, while it is suspended, by the sampling thread, which waits
+  // for every sample before taking the next ones.
   std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
   // Update the thread's stack trace sample.
   thread->SetStackTraceSample(stack_trace);
@@ -295,10 +328,14 @@ void* Trace::RunSamplingThread(void* arg) {
         break;
       }
     }
+    SampleCheckpoint checkpoint(the_trace);
+    size_t threads_running_checkpoint;
     {
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+      ScopedObjectAccess soa(self);
+      threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
+    }
+    if (threads_running_checkpoint != 0) {
+      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
     }
   }
 
@@ -414,6 +451,13 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
     ScopedSuspendAll ssa(__FUNCTION__);
     if (the_trace != nullptr) {
       stop_alloc_counting = (the_trace->flags_ & Trace::kTraceCountAllocs) != 0;
+      if (the_trace->trace_output_mode_ == TraceOutputMode::kStreaming) {
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        if (finish_tracing) {
+          runtime->GetThreadList()->ForEach(FlushThreadTraceBuffer, the_trace);
+        }
+        runtime->GetThreadList()->ForEach(DeleteThreadTraceBuffer, nullptr);
+      }
       if (finish_tracing) {
         the_trace->FinishTracing();
       }
@@ -651,6 +695,14 @@ void Trace::FinishTracing() {
 
   std::set<ArtMethod*> visited_methods;
   if (trace_output_mode_ == TraceOutputMode::kStreaming) {
+    // Write out the events still in the main buffer.
+    {
+      MutexLock mu(Thread::Current(), *streaming_lock_);
+      if (!trace_file_->WriteFully(buf_.get(), cur_offset_.LoadRelaxed())) {
+        PLOG(WARNING) << "Failed streaming a tracing event.";
+      }
+      cur_offset_.StoreRelease(0);
+    }
     // Clean up.
     STLDeleteValues(&seen_methods_);
   } else {
@@ -947,7 +999,42 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
   static_assert(kPacketSize == 2 + 4 + 4 + 4, "Packet size incorrect.");
 
   if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
+    // Only the thread itself, or the sampling thread while it is suspended, writes its events.
+    std::vector<uint8_t>* buffer = thread->GetMethodTraceBuffer();
+    if (buffer == nullptr) {
+      buffer = new std::vector<uint8_t>();
+      buffer->reserve(kThreadBufferSize);
+      thread->SetMethodTraceBuffer(buffer);
+    }
+    const size_t record_size = GetRecordSize(clock_source_);
+    buffer->insert(buffer->end(), stack_buf, stack_buf + record_size);
+    if (buffer->size() + record_size > kThreadBufferSize) {
+      FlushThreadBuffer(thread);
+    }
+  }
+}
+
+void Trace::FlushThreadBuffer(Thread* thread) {
+  std::vector<uint8_t>* buffer = thread->GetMethodTraceBuffer();
+  if (buffer == nullptr || buffer->empty()) {
+    return;
+  }
+  const size_t record_size = GetRecordSize(clock_source_);
+  MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
+  if (RegisterThread(thread)) {
+    // It might be better to postpone this. Threads might not have received names...
+    std::string thread_name;
+    thread->GetThreadName(thread_name);
+    uint8_t buf2[7];
+    Append2LE(buf2, 0);
+    buf2[2] = kOpNewThread;
+    Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
+    Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
+    WriteToBuf(buf2, sizeof(buf2));
+    WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
+  }
+  for (size_t offset = 0; offset < buffer->size(); offset += record_size) {
+    ArtMethod* method = DecodeTraceMethod(ReadBytes(buffer->data() + offset + 2, 4));
     if (RegisterMethod(method)) {
       // Write a special block with the name.
       std::string method_line(GetMethodLine(method));
@@ -958,20 +1045,9 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
       WriteToBuf(buf2, sizeof(buf2));
       WriteToBuf(reinterpret_cast<const uint8_t*>(method_line.c_str()), method_line.length());
     }
-    if (RegisterThread(thread)) {
-      // It might be better to postpone this. Threads might not have received names...
-      std::string thread_name;
-      thread->GetThreadName(thread_name);
-      uint8_t buf2[7];
-      Append2LE(buf2, 0);
-      buf2[2] = kOpNewThread;
-      Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
-      Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
-      WriteToBuf(buf2, sizeof(buf2));
-      WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
-    }
-    WriteToBuf(stack_buf, sizeof(stack_buf));
   }
+  WriteToBuf(buffer->data(), buffer->size());
+  buffer->clear();
 }
 
 void Trace::GetVisitedMethods(size_t buf_size,
@@ -1011,6 +1087,14 @@ void Trace::DumpThreadList(std::ostream& os) {
 }
 
 void Trace::StoreExitingThreadInfo(Thread* thread) {
+  if (thread->GetMethodTraceBuffer() != nullptr) {
+    // The names of the methods of the buffered events are written with them.
+    ScopedObjectAccess soa(thread);
+    MutexLock mu(thread, *Locks::trace_lock_);
+    if (the_trace_ != nullptr) {
+      the_trace_->FlushThreadBuffer(thread);
+    }
+  }
   MutexLock mu(thread, *Locks::trace_lock_);
   if (the_trace_ != nullptr) {
     std::string name;
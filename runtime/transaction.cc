@@ -19,10 +19,12 @@
 #include "base/stl_util.h"
 #include "base/logging.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/heap.h"
 #include "intern_table.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
+#include "runtime.h"
 
 #include <list>
 
@@ -93,6 +95,22 @@ bool Transaction::IsAborted() {
   return aborted_;
 }
 
+bool Transaction::ModifiedBootImage() {
+  gc::Heap* const heap = Runtime::Current()->GetHeap();
+  MutexLock mu(Thread::Current(), log_lock_);
+  for (const auto& it : object_logs_) {
+    if (heap->ObjectIsInBootImageSpace(it.first)) {
+      return true;
+    }
+  }
+  for (const auto& it : array_logs_) {
+    if (heap->ObjectIsInBootImageSpace(it.first)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 const std::string& Transaction::GetAbortMessage() {
   MutexLock mu(Thread::Current(), log_lock_);
   return abort_message_;
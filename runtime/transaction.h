@@ -53,6 +53,12 @@ class Transaction FINAL {
       SHARED_REQUIRES(Locks::mutator_lock_);
   bool IsAborted() REQUIRES(!log_lock_);
 
+  // Returns whether the transaction wrote to objects in the boot image. Such writes
+  // cannot be kept when the result is stored in an app image.
+  bool ModifiedBootImage()
+      REQUIRES(!log_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Record object field changes.
   void RecordWriteFieldBoolean(mirror::Object* obj, MemberOffset field_offset, uint8_t value,
                                bool is_volatile)
@@ -43,19 +43,26 @@ uint32_t TypeLookupTable::RawDataLength() const {
 }
 
 uint32_t TypeLookupTable::RawDataLength(const DexFile& dex_file) {
-  return RawDataLength(dex_file.NumClassDefs());
+  return RawDataLength(dex_file.NumClassDefs(), dex_file.NumTypeIds());
 }
 
-uint32_t TypeLookupTable::RawDataLength(uint32_t num_class_defs) {
-  return SupportedSize(num_class_defs) ? RoundUpToPowerOfTwo(num_class_defs) * sizeof(Entry) : 0u;
+uint32_t TypeLookupTable::RawDataLength(uint32_t num_class_defs, uint32_t num_type_ids) {
+  if (!SupportedSize(num_class_defs)) {
+    return 0u;
+  }
+  uint32_t num_entries = RoundUpToPowerOfTwo(num_class_defs);
+  if (SupportedSize(num_type_ids)) {
+    num_entries += RoundUpToPowerOfTwo(num_type_ids);
+  }
+  return num_entries * sizeof(Entry);
 }
 
-uint32_t TypeLookupTable::CalculateMask(uint32_t num_class_defs) {
-  return SupportedSize(num_class_defs) ? RoundUpToPowerOfTwo(num_class_defs) - 1u : 0u;
+uint32_t TypeLookupTable::CalculateMask(uint32_t num_entries) {
+  return SupportedSize(num_entries) ? RoundUpToPowerOfTwo(num_entries) - 1u : 0u;
 }
 
-bool TypeLookupTable::SupportedSize(uint32_t num_class_defs) {
-  return num_class_defs != 0u && num_class_defs <= std::numeric_limits<uint16_t>::max();
+bool TypeLookupTable::SupportedSize(uint32_t num_entries) {
+  return num_entries != 0u && num_entries <= std::numeric_limits<uint16_t>::max();
 }
 
 TypeLookupTable* TypeLookupTable::Create(const DexFile& dex_file, uint8_t* storage) {
@@ -72,73 +79,102 @@ TypeLookupTable* TypeLookupTable::Open(const uint8_t* raw_data, const DexFile& d
 TypeLookupTable::TypeLookupTable(const DexFile& dex_file, uint8_t* storage)
     : dex_file_(dex_file),
       mask_(CalculateMask(dex_file.NumClassDefs())),
-      entries_(storage != nullptr ? reinterpret_cast<Entry*>(storage) : new Entry[mask_ + 1]),
+      type_id_mask_(CalculateMask(dex_file.NumTypeIds())),
+      entries_(storage != nullptr
+                   ? reinterpret_cast<Entry*>(storage)
+                   : new Entry[RawDataLength(dex_file) / sizeof(Entry)]),
+      type_id_entries_(SupportedSize(dex_file.NumTypeIds()) ? &entries_[mask_ + 1] : nullptr),
       owns_entries_(storage == nullptr) {
   static_assert(alignof(Entry) == 4u, "Expecting Entry to be 4-byte aligned.");
   DCHECK_ALIGNED(storage, alignof(Entry));
-  std::vector<uint16_t> conflict_class_defs;
-  // The first stage. Put elements on their initial positions. If an initial position is already
-  // occupied then delay the insertion of the element to the second stage to reduce probing
-  // distance.
+  std::vector<std::pair<uint32_t, uint16_t>> string_and_index;
+  string_and_index.reserve(dex_file.NumClassDefs());
   for (size_t i = 0; i < dex_file.NumClassDefs(); ++i) {
     const DexFile::ClassDef& class_def = dex_file.GetClassDef(i);
     const DexFile::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
-    const DexFile::StringId& str_id = dex_file.GetStringId(type_id.descriptor_idx_);
+    string_and_index.emplace_back(type_id.descriptor_idx_, i);
+  }
+  Fill(entries_.get(), mask_, dex_file, string_and_index);
+  if (type_id_entries_ != nullptr) {
+    string_and_index.clear();
+    string_and_index.reserve(dex_file.NumTypeIds());
+    for (size_t i = 0; i < dex_file.NumTypeIds(); ++i) {
+      string_and_index.emplace_back(dex_file.GetTypeId(i).descriptor_idx_, i);
+    }
+    Fill(type_id_entries_, type_id_mask_, dex_file, string_and_index);
+  }
+}
+
+TypeLookupTable::TypeLookupTable(const uint8_t* raw_data, const DexFile& dex_file)
+    : dex_file_(dex_file),
+      mask_(CalculateMask(dex_file.NumClassDefs())),
+      type_id_mask_(CalculateMask(dex_file.NumTypeIds())),
+      entries_(reinterpret_cast<Entry*>(const_cast<uint8_t*>(raw_data))),
+      type_id_entries_(SupportedSize(dex_file.NumTypeIds()) ? &entries_[mask_ + 1] : nullptr),
+      owns_entries_(false) {}
+
+void TypeLookupTable::Fill(Entry* entries,
+                           uint32_t mask,
+                           const DexFile& dex_file,
+                           const std::vector<std::pair<uint32_t, uint16_t>>& string_and_index) {
+  std::vector<size_t> conflicts;
+  // The first stage. Put elements on their initial positions. If an initial position is already
+  // occupied then delay the insertion of the element to the second stage to reduce probing
+  // distance.
+  for (size_t i = 0; i != string_and_index.size(); ++i) {
+    const DexFile::StringId& str_id = dex_file.GetStringId(string_and_index[i].first);
     const uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(str_id));
     Entry entry;
     entry.str_offset = str_id.string_data_off_;
-    entry.data = MakeData(i, hash, GetSizeMask());
-    if (!SetOnInitialPos(entry, hash)) {
-      conflict_class_defs.push_back(i);
+    entry.data = MakeData(string_and_index[i].second, hash, mask);
+    if (!SetOnInitialPos(entries, mask, entry, hash)) {
+      conflicts.push_back(i);
     }
   }
   // The second stage. The initial position of these elements had a collision. Put these elements
   // into the nearest free cells and link them together by updating next_pos_delta.
-  for (uint16_t class_def_idx : conflict_class_defs) {
-    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_idx);
-    const DexFile::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
-    const DexFile::StringId& str_id = dex_file.GetStringId(type_id.descriptor_idx_);
+  for (size_t i : conflicts) {
+    const DexFile::StringId& str_id = dex_file.GetStringId(string_and_index[i].first);
     const uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(str_id));
     Entry entry;
     entry.str_offset = str_id.string_data_off_;
-    entry.data = MakeData(class_def_idx, hash, GetSizeMask());
-    Insert(entry, hash);
+    entry.data = MakeData(string_and_index[i].second, hash, mask);
+    Insert(entries, mask, entry, hash);
   }
 }
 
-TypeLookupTable::TypeLookupTable(const uint8_t* raw_data, const DexFile& dex_file)
-    : dex_file_(dex_file),
-      mask_(CalculateMask(dex_file.NumClassDefs())),
-      entries_(reinterpret_cast<Entry*>(const_cast<uint8_t*>(raw_data))),
-      owns_entries_(false) {}
-
-bool TypeLookupTable::SetOnInitialPos(const Entry& entry, uint32_t hash) {
-  const uint32_t pos = hash & GetSizeMask();
-  if (!entries_[pos].IsEmpty()) {
+bool TypeLookupTable::SetOnInitialPos(Entry* entries,
+                                      uint32_t mask,
+                                      const Entry& entry,
+                                      uint32_t hash) {
+  const uint32_t pos = hash & mask;
+  if (!entries[pos].IsEmpty()) {
     return false;
   }
-  entries_[pos] = entry;
-  entries_[pos].next_pos_delta = 0;
+  entries[pos] = entry;
+  entries[pos].next_pos_delta = 0;
   return true;
 }
 
-void TypeLookupTable::Insert(const Entry& entry, uint32_t hash) {
-  uint32_t pos = FindLastEntryInBucket(hash & GetSizeMask());
-  uint32_t next_pos = (pos + 1) & GetSizeMask();
-  while (!entries_[next_pos].IsEmpty()) {
-    next_pos = (next_pos + 1) & GetSizeMask();
+void TypeLookupTable::Insert(Entry* entries, uint32_t mask, const Entry& entry, uint32_t hash) {
+  uint32_t pos = FindLastEntryInBucket(entries, mask, hash & mask);
+  uint32_t next_pos = (pos + 1) & mask;
+  while (!entries[next_pos].IsEmpty()) {
+    next_pos = (next_pos + 1) & mask;
   }
-  const uint32_t delta = (next_pos >= pos) ? (next_pos - pos) : (next_pos + Size() - pos);
-  entries_[pos].next_pos_delta = delta;
-  entries_[next_pos] = entry;
-  entries_[next_pos].next_pos_delta = 0;
+  const uint32_t delta = (next_pos >= pos) ? (next_pos - pos) : (next_pos + mask + 1 - pos);
+  entries[pos].next_pos_delta = delta;
+  entries[next_pos] = entry;
+  entries[next_pos].next_pos_delta = 0;
 }
 
-uint32_t TypeLookupTable::FindLastEntryInBucket(uint32_t pos) const {
-  const Entry* entry = &entries_[pos];
+uint32_t TypeLookupTable::FindLastEntryInBucket(const Entry* entries,
+                                                uint32_t mask,
+                                                uint32_t pos) {
+  const Entry* entry = &entries[pos];
   while (!entry->IsLast()) {
-    pos = (pos + entry->next_pos_delta) & GetSizeMask();
-    entry = &entries_[pos];
+    pos = (pos + entry->next_pos_delta) & mask;
+    entry = &entries[pos];
   }
   return pos;
 }
@@ -26,6 +26,8 @@ namespace art {
 /**
  * TypeLookupTable used to find class_def_idx by class descriptor quickly.
  * Implementation of TypeLookupTable is based on hash table.
+ * The raw data also holds a second hash table of the same layout that maps descriptors to type
+ * indexes, right after the class def entries, unless the dex file has too many type ids.
  * This class instantiated at compile time by calling Create() method and written into OAT file.
  * At runtime, the raw data is read from memory-mapped file by calling Open() method. The table
  * memory remains clean.
@@ -42,21 +44,19 @@ class TypeLookupTable {
   // Method search class_def_idx by class descriptor and it's hash.
   // If no data found then the method returns DexFile::kDexNoIndex
   ALWAYS_INLINE uint32_t Lookup(const char* str, uint32_t hash) const {
-    uint32_t pos = hash & GetSizeMask();
-    // Thanks to special insertion algorithm, the element at position pos can be empty or start of
-    // bucket.
-    const Entry* entry = &entries_[pos];
-    while (!entry->IsEmpty()) {
-      if (CmpHashBits(entry->data, hash) && IsStringsEquals(str, entry->str_offset)) {
-        return GetClassDefIdx(entry->data);
-      }
-      if (entry->IsLast()) {
-        return DexFile::kDexNoIndex;
-      }
-      pos = (pos + entry->next_pos_delta) & GetSizeMask();
-      entry = &entries_[pos];
-    }
-    return DexFile::kDexNoIndex;
+    return Find(entries_.get(), mask_, str, hash);
+  }
+
+  // Return whether the table can be used to search type indexes.
+  bool HasTypeIds() const {
+    return type_id_entries_ != nullptr;
+  }
+
+  // Method search type_idx by type descriptor and it's hash. Requires HasTypeIds().
+  // If no data found then the method returns DexFile::kDexNoIndex
+  ALWAYS_INLINE uint32_t LookupTypeId(const char* str, uint32_t hash) const {
+    DCHECK(HasTypeIds());
+    return Find(type_id_entries_, type_id_mask_, str, hash);
   }
 
   // Method creates lookup table for dex file
@@ -76,8 +76,9 @@ class TypeLookupTable {
   // Method returns length of binary data for the specified dex file.
   static uint32_t RawDataLength(const DexFile& dex_file);
 
-  // Method returns length of binary data for the specified number of class definitions.
-  static uint32_t RawDataLength(uint32_t num_class_defs);
+  // Method returns length of binary data for the specified number of class definitions and
+  // type ids.
+  static uint32_t RawDataLength(uint32_t num_class_defs, uint32_t num_type_ids);
 
  private:
    /**
@@ -112,8 +113,8 @@ class TypeLookupTable {
     }
   };
 
-  static uint32_t CalculateMask(uint32_t num_class_defs);
-  static bool SupportedSize(uint32_t num_class_defs);
+  static uint32_t CalculateMask(uint32_t num_entries);
+  static bool SupportedSize(uint32_t num_entries);
 
   // Construct from a dex file.
   explicit TypeLookupTable(const DexFile& dex_file, uint8_t* storage);
@@ -129,34 +130,61 @@ class TypeLookupTable {
         str, reinterpret_cast<const char*>(ptr)) == 0;
   }
 
+  ALWAYS_INLINE uint32_t Find(const Entry* entries,
+                               uint32_t mask,
+                               const char* str,
+                               uint32_t hash) const {
+    uint32_t pos = hash & mask;
+    // Thanks to special insertion algorithm, the element at position pos can be empty or start of
+    // bucket.
+    const Entry* entry = &entries[pos];
+    while (!entry->IsEmpty()) {
+      if (CmpHashBits(entry->data, hash, mask) && IsStringsEquals(str, entry->str_offset)) {
+        return GetIdx(entry->data, mask);
+      }
+      if (entry->IsLast()) {
+        return DexFile::kDexNoIndex;
+      }
+      pos = (pos + entry->next_pos_delta) & mask;
+      entry = &entries[pos];
+    }
+    return DexFile::kDexNoIndex;
+  }
+
   // Method extracts hash bits from element's data and compare them with
   // the corresponding bits of the specified hash
-  bool CmpHashBits(uint32_t data, uint32_t hash) const {
-    uint32_t mask = static_cast<uint16_t>(~GetSizeMask());
+  static bool CmpHashBits(uint32_t data, uint32_t hash, uint32_t size_mask) {
+    uint32_t mask = static_cast<uint16_t>(~size_mask);
     return (hash & mask) == (data & mask);
   }
 
-  uint32_t GetClassDefIdx(uint32_t data) const {
-    return data & mask_;
+  static uint32_t GetIdx(uint32_t data, uint32_t mask) {
+    return data & mask;
   }
 
-  uint32_t GetSizeMask() const {
-    return mask_;
-  }
+  // Fill a hash table of mask + 1 entries with the given (string id, index) pairs.
+  static void Fill(Entry* entries,
+                   uint32_t mask,
+                   const DexFile& dex_file,
+                   const std::vector<std::pair<uint32_t, uint16_t>>& string_and_index);
 
   // Attempt to set an entry on it's hash' slot. If there is alrady something there, return false.
   // Otherwise return true.
-  bool SetOnInitialPos(const Entry& entry, uint32_t hash);
+  static bool SetOnInitialPos(Entry* entries, uint32_t mask, const Entry& entry, uint32_t hash);
 
   // Insert an entry, probes until there is an empty slot.
-  void Insert(const Entry& entry, uint32_t hash);
+  static void Insert(Entry* entries, uint32_t mask, const Entry& entry, uint32_t hash);
 
   // Find the last entry in a chain.
-  uint32_t FindLastEntryInBucket(uint32_t cur_pos) const;
+  static uint32_t FindLastEntryInBucket(const Entry* entries, uint32_t mask, uint32_t cur_pos);
 
   const DexFile& dex_file_;
   const uint32_t mask_;
+  const uint32_t type_id_mask_;
   std::unique_ptr<Entry[]> entries_;
+  // The type id hash table, stored after the mask_ + 1 class def entries. Null if the dex file
+  // has no type ids or too many of them.
+  Entry* type_id_entries_;
   // owns_entries_ specifies if the lookup table owns the entries_ array.
   const bool owns_entries_;
 
@@ -36,7 +36,24 @@ TEST_F(TypeLookupTableTest, CreateLookupTable) {
   std::unique_ptr<TypeLookupTable> table(TypeLookupTable::Create(*dex_file));
   ASSERT_NE(nullptr, table.get());
   ASSERT_NE(nullptr, table->RawData());
-  ASSERT_EQ(32U, table->RawDataLength());
+  // 4 class defs and 5 type ids (the classes, Object and void), 8 bytes per entry.
+  ASSERT_EQ(32U + 64U, table->RawDataLength());
+  ASSERT_TRUE(table->HasTypeIds());
+}
+
+TEST_F(TypeLookupTableTest, FindTypeId) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Lookup"));
+  std::unique_ptr<TypeLookupTable> table(TypeLookupTable::Create(*dex_file));
+  ASSERT_NE(nullptr, table.get());
+  ASSERT_TRUE(table->HasTypeIds());
+  for (size_t i = 0; i != dex_file->NumTypeIds(); ++i) {
+    const char* descriptor = dex_file->StringByTypeIdx(i);
+    EXPECT_EQ(i, table->LookupTypeId(descriptor, ComputeModifiedUtf8Hash(descriptor)))
+        << descriptor;
+  }
+  const char* missing = "LDA;";
+  EXPECT_EQ(kDexNoIndex, table->LookupTypeId(missing, ComputeModifiedUtf8Hash(missing)));
 }
 
 TEST_P(TypeLookupTableTest, Find) {
@@ -16,6 +16,8 @@
 
 #include "utf.h"
 
+#include <string.h>
+
 #include "base/logging.h"
 #include "mirror/array.h"
 #include "mirror/object-inl.h"
@@ -23,6 +25,33 @@
 
 namespace art {
 
+// The ASCII fast paths handle that many bytes at a time.
+static constexpr size_t kAsciiWordSize = sizeof(uint64_t);
+
+// Whether the kAsciiWordSize bytes at utf8 are all one-byte encodings.
+static inline bool IsAsciiWord(const char* utf8) {
+  uint64_t word;
+  memcpy(&word, utf8, sizeof(word));
+  return (word & UINT64_C(0x8080808080808080)) == 0u;
+}
+
+// Adds four chars to a java.lang.String hash. Expanding hash * 31 + c four times keeps
+// the multiplications of the chars independent of each other.
+static inline uint32_t HashFourChars(uint32_t hash, uint32_t c0, uint32_t c1, uint32_t c2,
+                                     uint32_t c3) {
+  return hash * (31u * 31u * 31u * 31u) + c0 * (31u * 31u * 31u) + c1 * (31u * 31u) + c2 * 31u + c3;
+}
+
+// Converts and hashes the ASCII chars of a word, see IsAsciiWord.
+static inline uint32_t ConvertAndHashAsciiWord(uint16_t* utf16_out, const char* utf8,
+                                               uint32_t hash) {
+  for (size_t i = 0; i != kAsciiWordSize; ++i) {
+    utf16_out[i] = static_cast<uint8_t>(utf8[i]);
+  }
+  hash = HashFourChars(hash, utf16_out[0], utf16_out[1], utf16_out[2], utf16_out[3]);
+  return HashFourChars(hash, utf16_out[4], utf16_out[5], utf16_out[6], utf16_out[7]);
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -48,6 +77,14 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   size_t len = 0;
   const char* end = utf8 + byte_count;
   for (; utf8 < end; ++utf8) {
+    // Skip whole words of one-byte encodings.
+    while (static_cast<size_t>(end - utf8) >= kAsciiWordSize && IsAsciiWord(utf8)) {
+      utf8 += kAsciiWordSize;
+      len += kAsciiWordSize;
+    }
+    if (utf8 == end) {
+      break;
+    }
     int ic = *utf8;
     len++;
     if (LIKELY((ic & 0x80) == 0)) {
@@ -106,15 +143,52 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   // String contains non-ASCII characters.
   for (const char *p = in_start; p < in_end;) {
+    // Convert whole words of ASCII characters at once.
+    if (static_cast<size_t>(in_end - p) >= kAsciiWordSize && IsAsciiWord(p)) {
+      for (size_t i = 0; i != kAsciiWordSize; ++i) {
+        out_p[i] = static_cast<uint8_t>(p[i]);
+      }
+      p += kAsciiWordSize;
+      out_p += kAsciiWordSize;
+      continue;
+    }
+    const uint32_t ch = GetUtf16FromUtf8(&p);
+    const uint16_t leading = GetLeadingUtf16Char(ch);
+    const uint16_t trailing = GetTrailingUtf16Char(ch);
+
+    *out_p++ = leading;
+    if (trailing != 0) {
+      *out_p++ = trailing;
+    }
+  }
+}
+
+int32_t ConvertModifiedUtf8ToUtf16AndComputeHash(uint16_t* utf16_data_out, size_t out_chars,
+                                                 const char* utf8_data_in, size_t in_bytes) {
+  const char* p = utf8_data_in;
+  const char* in_end = utf8_data_in + in_bytes;
+  uint16_t* out_p = utf16_data_out;
+  uint32_t hash = 0;
+  while (p < in_end) {
+    if (static_cast<size_t>(in_end - p) >= kAsciiWordSize && IsAsciiWord(p)) {
+      hash = ConvertAndHashAsciiWord(out_p, p, hash);
+      p += kAsciiWordSize;
+      out_p += kAsciiWordSize;
+      continue;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
 
     *out_p++ = leading;
+    hash = hash * 31 + leading;
     if (trailing != 0) {
       *out_p++ = trailing;
+      hash = hash * 31 + trailing;
     }
   }
+  DCHECK_EQ(static_cast<size_t>(out_p - utf16_data_out), out_chars);
+  return static_cast<int32_t>(hash);
 }
 
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
@@ -172,6 +246,9 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
 
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
   uint32_t hash = 0;
+  for (; char_count >= 4u; char_count -= 4u, chars += 4) {
+    hash = HashFourChars(hash, chars[0], chars[1], chars[2], chars[3]);
+  }
   while (char_count--) {
     hash = hash * 31 + *chars++;
   }
@@ -181,6 +258,15 @@ int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
 int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length) {
   uint32_t hash = 0;
   while (utf16_length != 0u) {
+    // Each UTF-16 char takes at least one byte, so the whole word is part of the string.
+    if (utf16_length >= kAsciiWordSize && IsAsciiWord(utf8)) {
+      const uint8_t* c = reinterpret_cast<const uint8_t*>(utf8);
+      hash = HashFourChars(hash, c[0], c[1], c[2], c[3]);
+      hash = HashFourChars(hash, c[4], c[5], c[6], c[7]);
+      utf8 += kAsciiWordSize;
+      utf16_length -= kAsciiWordSize;
+      continue;
+    }
     const uint32_t pair = GetUtf16FromUtf8(&utf8);
     const uint16_t first = GetLeadingUtf16Char(pair);
     hash = hash * 31 + first;
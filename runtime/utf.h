@@ -55,6 +55,13 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, const char* utf8_in);
 void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, size_t out_chars,
                                 const char* utf8_in, size_t in_bytes);
 
+/*
+ * Convert from Modified UTF-8 to UTF-16 and return the java.lang.String hashCode() of the
+ * result, reading the input only once.
+ */
+int32_t ConvertModifiedUtf8ToUtf16AndComputeHash(uint16_t* utf16_out, size_t out_chars,
+                                                 const char* utf8_in, size_t in_bytes);
+
 /*
  * Compare two modified UTF-8 strings as UTF-16 code point values in a non-locale sensitive manner
  */
@@ -378,4 +378,48 @@ TEST_F(UtfTest, ExhaustiveBidirectionalCodePointCheck) {
   }
 }
 
+// The conversions and hashes handle ASCII a word at a time, so mix non-ASCII chars into
+// ASCII runs of all lengths around the word size.
+TEST_F(UtfTest, MixedAsciiRuns) {
+  for (size_t run = 0; run != 20u; ++run) {
+    for (size_t offset = 0; offset != 10u; ++offset) {
+      std::vector<uint16_t> chars;
+      for (size_t i = 0; i != offset; ++i) {
+        chars.push_back('A' + i);
+      }
+      for (size_t i = 0; i != 3u; ++i) {
+        chars.push_back(0x00e9);  // Two bytes.
+        for (size_t j = 0; j != run; ++j) {
+          chars.push_back('a' + j);
+        }
+        chars.push_back(0x20ac);  // Three bytes.
+        chars.push_back(0);  // Two bytes in modified UTF-8.
+      }
+      size_t byte_count = CountUtf8Bytes(chars.data(), chars.size());
+      std::vector<char> utf8(byte_count + 1u, '\0');
+      ConvertUtf16ToModifiedUtf8(utf8.data(), byte_count, chars.data(), chars.size());
+
+      uint32_t expected_hash = 0u;
+      for (uint16_t c : chars) {
+        expected_hash = expected_hash * 31u + c;
+      }
+      EXPECT_EQ(chars.size(), CountModifiedUtf8Chars(utf8.data(), byte_count));
+      EXPECT_EQ(static_cast<int32_t>(expected_hash), ComputeUtf16Hash(chars.data(), chars.size()));
+      EXPECT_EQ(static_cast<int32_t>(expected_hash),
+                ComputeUtf16HashFromModifiedUtf8(utf8.data(), chars.size()));
+
+      std::vector<uint16_t> converted(chars.size());
+      ConvertModifiedUtf8ToUtf16(converted.data(), converted.size(), utf8.data(), byte_count);
+      EXPECT_EQ(chars, converted);
+      std::vector<uint16_t> converted_and_hashed(chars.size());
+      EXPECT_EQ(static_cast<int32_t>(expected_hash),
+                ConvertModifiedUtf8ToUtf16AndComputeHash(converted_and_hashed.data(),
+                                                         converted_and_hashed.size(),
+                                                         utf8.data(),
+                                                         byte_count));
+      EXPECT_EQ(chars, converted_and_hashed);
+    }
+  }
+}
+
 }  // namespace art
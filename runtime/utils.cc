@@ -527,6 +527,22 @@ std::string PrintableString(const char* utf) {
   return result;
 }
 
+void AppendJsonString(std::string* out, const char* str) {
+  out->push_back('"');
+  for (; *str != '\0'; ++str) {
+    char c = *str;
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20u) {
+      StringAppendF(out, "\\u%04x", static_cast<unsigned int>(c));
+    } else {
+      out->push_back(c);
+    }
+  }
+  out->push_back('"');
+}
+
 // See http://java.sun.com/j2se/1.5.0/docs/guide/jni/spec/design.html#wp615 for the full rules.
 std::string MangleForJni(const std::string& s) {
   std::string result;
@@ -122,6 +122,9 @@ std::string PrintableChar(uint16_t ch);
 // Java escapes are used for non-ASCII characters.
 std::string PrintableString(const char* utf8);
 
+// Appends str, with its quotes, to out as a JSON string.
+void AppendJsonString(std::string* out, const char* str);
+
 // Tests whether 's' starts with 'prefix'.
 bool StartsWith(const std::string& s, const char* prefix);
 
@@ -23,6 +23,7 @@
 #include "base/logging.h"
 #include "gc_root.h"
 #include "globals.h"
+#include "mirror/dex_cache.h"
 #include "primitive.h"
 
 namespace art {
@@ -46,11 +47,15 @@ inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size, cons
 }
 
 inline size_t DexCacheArraysLayout::Alignment() const {
+  return Alignment(pointer_size_);
+}
+
+inline constexpr size_t DexCacheArraysLayout::Alignment(PointerSize pointer_size) {
   // GcRoot<> alignment is 4, i.e. lower than or equal to the pointer alignment.
   static_assert(alignof(GcRoot<mirror::Class>) == 4, "Expecting alignof(GcRoot<>) == 4");
   static_assert(alignof(GcRoot<mirror::String>) == 4, "Expecting alignof(GcRoot<>) == 4");
-  // Pointer alignment is the same as pointer size.
-  return static_cast<size_t>(pointer_size_);
+  // The field pairs need alignment to twice the pointer size, see FieldsAlignment().
+  return 2u * static_cast<size_t>(pointer_size);
 }
 
 template <typename T>
@@ -99,15 +104,19 @@ inline size_t DexCacheArraysLayout::StringsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
-  return fields_offset_ + ElementOffset(pointer_size_, field_idx);
+  size_t slot_idx = field_idx % mirror::DexCache::kDexCacheFieldCacheSize;
+  return fields_offset_ + 2u * static_cast<size_t>(pointer_size_) * slot_idx;
 }
 
 inline size_t DexCacheArraysLayout::FieldsSize(size_t num_elements) const {
-  return ArraySize(pointer_size_, num_elements);
+  // Each slot holds an ArtField* and a pointer-sized field index.
+  size_t num_slots = mirror::DexCache::NumResolvedFieldsFor(num_elements);
+  return 2u * static_cast<size_t>(pointer_size_) * num_slots;
 }
 
 inline size_t DexCacheArraysLayout::FieldsAlignment() const {
-  return static_cast<size_t>(pointer_size_);
+  // The pairs are loaded and stored atomically, which requires natural alignment.
+  return 2u * static_cast<size_t>(pointer_size_);
 }
 
 inline size_t DexCacheArraysLayout::ElementOffset(PointerSize element_size, uint32_t idx) {
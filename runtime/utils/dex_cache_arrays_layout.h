@@ -54,6 +54,8 @@ class DexCacheArraysLayout {
 
   size_t Alignment() const;
 
+  static constexpr size_t Alignment(PointerSize pointer_size);
+
   size_t TypesOffset() const {
     return types_offset_;
   }
@@ -102,8 +104,6 @@ class DexCacheArraysLayout {
   const size_t fields_offset_;
   const size_t size_;
 
-  static size_t Alignment(PointerSize pointer_size);
-
   static size_t ElementOffset(PointerSize element_size, uint32_t idx);
 
   static size_t ArraySize(PointerSize element_size, uint32_t num_elements);
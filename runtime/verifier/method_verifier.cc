@@ -186,6 +186,52 @@ void MethodVerifier::FailureData::Merge(const MethodVerifier::FailureData& fd) {
   types |= fd.types;
 }
 
+// Most reg type cache lookups are linear searches, so the cache shared by the methods of a
+// class is started again once it holds that many types.
+static constexpr size_t kMaxSharedRegTypes = 512;
+
+class MethodVerifier::SharedRegTypeCache {
+ public:
+  explicit SharedRegTypeCache(Thread* self) SHARED_REQUIRES(Locks::mutator_lock_)
+      : self_(self),
+        arena_stack_(Runtime::Current()->GetArenaPool()),
+        arena_(&arena_stack_) {
+    Create();
+  }
+
+  ~SharedRegTypeCache() {
+    Destroy();
+  }
+
+  RegTypeCache* Get() SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (reg_types_->GetCacheSize() > kMaxSharedRegTypes) {
+      Destroy();
+      arena_.Reset();
+      Create();
+    }
+    return reg_types_.get();
+  }
+
+ private:
+  void Create() SHARED_REQUIRES(Locks::mutator_lock_) {
+    reg_types_.reset(new RegTypeCache(/* can_load_classes */ true, arena_));
+    // The cache outlives the verifiers of the methods, so visit its roots from the thread.
+    self_->PushRegTypeCache(reg_types_.get());
+  }
+
+  void Destroy() {
+    self_->PopRegTypeCache(reg_types_.get());
+    reg_types_.reset();
+  }
+
+  Thread* const self_;
+  ArenaStack arena_stack_;
+  ScopedArenaAllocator arena_;
+  std::unique_ptr<RegTypeCache> reg_types_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedRegTypeCache);
+};
+
 template <bool kDirect>
 MethodVerifier::FailureData MethodVerifier::VerifyMethods(Thread* self,
                                                           ClassLinker* linker,
@@ -198,6 +244,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethods(Thread* self,
                                                           bool allow_soft_failures,
                                                           LogSeverity log_level,
                                                           bool need_precise_constants,
+                                                          SharedRegTypeCache* shared_reg_types,
                                                           std::string* error_string) {
   DCHECK(it != nullptr);
 
@@ -239,6 +286,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethods(Thread* self,
                                                       allow_soft_failures,
                                                       log_level,
                                                       need_precise_constants,
+                                                      shared_reg_types->Get(),
                                                       &hard_failure_msg);
     if (result.kind == kHardFailure) {
       if (failure_data.kind == kHardFailure) {
@@ -290,6 +338,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
     it.Next();
   }
   ClassLinker* linker = Runtime::Current()->GetClassLinker();
+  // The methods of a class mostly refer to the same types, resolve them once for all methods.
+  SharedRegTypeCache shared_reg_types(self);
   // Direct methods.
   MethodVerifier::FailureData data1 = VerifyMethods<true>(self,
                                                           linker,
@@ -302,6 +352,7 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                           allow_soft_failures,
                                                           log_level,
                                                           false /* need precise constants */,
+                                                          &shared_reg_types,
                                                           error);
   // Virtual methods.
   MethodVerifier::FailureData data2 = VerifyMethods<false>(self,
@@ -315,6 +366,7 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                            allow_soft_failures,
                                                            log_level,
                                                            false /* need precise constants */,
+                                                           &shared_reg_types,
                                                            error);
 
   data1.Merge(data2);
@@ -363,6 +415,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                                                          bool allow_soft_failures,
                                                          LogSeverity log_level,
                                                          bool need_precise_constants,
+                                                         RegTypeCache* shared_reg_types,
                                                          std::string* hard_failure_msg) {
   MethodVerifier::FailureData result;
   uint64_t start_ns = kTimeVerifyMethod ? NanoTime() : 0;
@@ -380,7 +433,8 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                           allow_soft_failures,
                           need_precise_constants,
                           false /* verify to dump */,
-                          true /* allow_thread_suspension */);
+                          true /* allow_thread_suspension */,
+                          shared_reg_types);
   if (verifier.Verify()) {
     // Verification completed, however failures may be pending that didn't cause the verification
     // to hard fail.
@@ -508,11 +562,15 @@ MethodVerifier::MethodVerifier(Thread* self,
                                bool allow_soft_failures,
                                bool need_precise_constants,
                                bool verify_to_dump,
-                               bool allow_thread_suspension)
+                               bool allow_thread_suspension,
+                               RegTypeCache* shared_reg_types)
     : self_(self),
       arena_stack_(Runtime::Current()->GetArenaPool()),
       arena_(&arena_stack_),
-      reg_types_(can_load_classes, arena_),
+      owned_reg_types_(shared_reg_types == nullptr
+                           ? new RegTypeCache(can_load_classes, arena_)
+                           : nullptr),
+      reg_types_(shared_reg_types == nullptr ? *owned_reg_types_ : *shared_reg_types),
       reg_table_(arena_),
       work_insn_idx_(DexFile::kDexNoIndex),
       dex_method_idx_(dex_method_idx),
@@ -5101,7 +5159,10 @@ void MethodVerifier::VisitStaticRoots(RootVisitor* visitor) {
 }
 
 void MethodVerifier::VisitRoots(RootVisitor* visitor, const RootInfo& root_info) {
-  reg_types_.VisitRoots(visitor, root_info);
+  // A shared reg type cache is visited by its thread.
+  if (owned_reg_types_ != nullptr) {
+    reg_types_.VisitRoots(visitor, root_info);
+  }
 }
 
 const RegType& MethodVerifier::FromClass(const char* descriptor,
@@ -295,7 +295,8 @@ class MethodVerifier {
                  bool allow_soft_failures,
                  bool need_precise_constants,
                  bool verify_to_dump,
-                 bool allow_thread_suspension)
+                 bool allow_thread_suspension,
+                 RegTypeCache* shared_reg_types = nullptr)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void UninstantiableError(const char* descriptor);
@@ -327,6 +328,9 @@ class MethodVerifier {
     void Merge(const FailureData& src);
   };
 
+  // The reg type cache shared by the methods of a class, see VerifyClass.
+  class SharedRegTypeCache;
+
   // Verify all direct or virtual methods of a class. The method assumes that the iterator is
   // positioned correctly, and the iterator will be updated.
   template <bool kDirect>
@@ -341,6 +345,7 @@ class MethodVerifier {
                                    bool allow_soft_failures,
                                    LogSeverity log_level,
                                    bool need_precise_constants,
+                                   SharedRegTypeCache* shared_reg_types,
                                    std::string* error_string)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -367,6 +372,7 @@ class MethodVerifier {
                                   bool allow_soft_failures,
                                   LogSeverity log_level,
                                   bool need_precise_constants,
+                                  RegTypeCache* shared_reg_types,
                                   std::string* hard_failure_msg)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -738,7 +744,9 @@ class MethodVerifier {
   ArenaStack arena_stack_;
   ScopedArenaAllocator arena_;
 
-  RegTypeCache reg_types_;
+  // The reg types of the method, unless they are shared with the other methods of the class.
+  std::unique_ptr<RegTypeCache> owned_reg_types_;
+  RegTypeCache& reg_types_;
 
   PcToRegisterLineTable reg_table_;
 
@@ -267,7 +267,8 @@ RegTypeCache::RegTypeCache(bool can_load_classes, ScopedArenaAllocator& arena)
     : entries_(arena.Adapter(kArenaAllocVerifier)),
       klass_entries_(arena.Adapter(kArenaAllocVerifier)),
       can_load_classes_(can_load_classes),
-      arena_(arena) {
+      arena_(arena),
+      link_(nullptr) {
   if (kIsDebugBuild) {
     Thread::Current()->AssertThreadSuspensionIsAllowable(gAborting == 0);
   }
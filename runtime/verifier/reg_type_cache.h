@@ -34,6 +34,7 @@ namespace mirror {
 }  // namespace mirror
 class ScopedArenaAllocator;
 class StringPiece;
+class Thread;
 
 namespace verifier {
 
@@ -202,6 +203,11 @@ class RegTypeCache {
   // Arena allocator.
   ScopedArenaAllocator& arena_;
 
+  // Link, for the thread's list of shared reg type caches, see MethodVerifier::VerifyClass.
+  RegTypeCache* link_;
+
+  friend class art::Thread;
+
   DISALLOW_COPY_AND_ASSIGN(RegTypeCache);
 };
 
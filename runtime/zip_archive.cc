@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <vector>
 
+#include "base/bit_utils.h"
 #include "base/stringprintf.h"
 #include "base/unix_file/fd_file.h"
 
@@ -36,6 +37,15 @@ uint32_t ZipEntry::GetCrc32() {
   return zip_entry_->crc32;
 }
 
+bool ZipEntry::IsUncompressed() {
+  return zip_entry_->method == kCompressStored;
+}
+
+bool ZipEntry::IsAlignedTo(size_t alignment) {
+  DCHECK(IsPowerOfTwo(alignment)) << alignment;
+  return IsAlignedParam(zip_entry_->offset, static_cast<int>(alignment));
+}
+
 ZipEntry::~ZipEntry() {
   delete zip_entry_;
 }
@@ -74,6 +84,31 @@ MemMap* ZipEntry::ExtractToMemMap(const char* zip_filename, const char* entry_fi
   return map.release();
 }
 
+MemMap* ZipEntry::MapDirectlyFromFile(const char* zip_filename, std::string* error_msg) {
+  if (!IsUncompressed()) {
+    *error_msg = StringPrintf("Cannot map '%s' directly, the entry is compressed", zip_filename);
+    return nullptr;
+  }
+  DCHECK_EQ(zip_entry_->compressed_length, zip_entry_->uncompressed_length);
+  std::string name("stored entry mapped from ");
+  name += zip_filename;
+  // The entry is mapped private, so that DexFile::EnableWrite() gets copy on write pages
+  // rather than modifying the zip file.
+  std::unique_ptr<MemMap> map(MemMap::MapFile(GetUncompressedLength(),
+                                              PROT_READ,
+                                              MAP_PRIVATE,
+                                              GetFileDescriptor(handle_),
+                                              zip_entry_->offset,
+                                              /* low_4gb */ false,
+                                              name.c_str(),
+                                              error_msg));
+  if (map == nullptr) {
+    DCHECK(!error_msg->empty());
+    return nullptr;
+  }
+  return map.release();
+}
+
 static void SetCloseOnExec(int fd) {
   // This dance is more portable than Linux's O_CLOEXEC open(2) flag.
   int flags = fcntl(fd, F_GETFD);
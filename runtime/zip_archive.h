@@ -39,11 +39,19 @@ class ZipEntry {
   bool ExtractToFile(File& file, std::string* error_msg);
   MemMap* ExtractToMemMap(const char* zip_filename, const char* entry_filename,
                           std::string* error_msg);
+  // Map a stored (uncompressed) entry read only from the zip file instead of copying it, so
+  // that its pages are clean and shared by all the processes mapping it. The entry must be
+  // IsUncompressed() and IsAlignedTo() the alignment the caller needs.
+  MemMap* MapDirectlyFromFile(const char* zip_filename, std::string* error_msg);
   virtual ~ZipEntry();
 
   uint32_t GetUncompressedLength();
   uint32_t GetCrc32();
 
+  bool IsUncompressed();
+  // Whether the data of the entry starts at an offset in the zip file aligned to `alignment`.
+  bool IsAlignedTo(size_t alignment);
+
  private:
   ZipEntry(ZipArchiveHandle handle,
            ::ZipEntry* zip_entry) : handle_(handle), zip_entry_(zip_entry) {}
@@ -685,6 +685,37 @@ public class Main {
     return obj2.i;
   }
 
+  /// CHECK-START: int Main.$noinline$testPartialEscape(boolean) load_store_elimination (before)
+  /// CHECK:     NewInstance
+  /// CHECK:     If
+  /// CHECK:     StaticFieldSet
+
+  /// CHECK-START: int Main.$noinline$testPartialEscape(boolean) load_store_elimination (after)
+  /// CHECK-NOT: NewInstance
+  /// CHECK:     If
+  /// CHECK:     NewInstance
+  /// CHECK:     InstanceFieldSet
+  /// CHECK:     InstanceFieldSet
+  /// CHECK:     StaticFieldSet
+
+  /// CHECK-START: int Main.$noinline$testPartialEscape(boolean) load_store_elimination (after)
+  /// CHECK-NOT: InstanceFieldGet
+
+  // Test that an allocation escaping on one path only is allocated on that path.
+  static int $noinline$testPartialEscape(boolean b) {
+    if (sFlag) {
+      throw new Error();
+    }
+    TestClass obj = new TestClass();
+    obj.i = 1;
+    obj.j = 2;
+    if (b) {
+      sEscaped = obj;
+      return 0;
+    }
+    return obj.i + obj.j;
+  }
+
   static int sumWithFilter(int[] array, Filter f) {
     int sum = 0;
     for (int i = 0; i < array.length; i++) {
@@ -779,7 +810,11 @@ public class Main {
     assertIntEquals($noinline$testHSelect(true), 0xdead);
     int[] array = {2, 5, 9, -1, -3, 10, 8, 4};
     assertIntEquals(sumWithinRange(array, 1, 5), 11);
+    assertIntEquals($noinline$testPartialEscape(false), 3);
+    assertIntEquals($noinline$testPartialEscape(true), 0);
+    assertIntEquals(sEscaped.i + sEscaped.j, 3);
   }
 
   static boolean sFlag;
+  static TestClass sEscaped;
 }
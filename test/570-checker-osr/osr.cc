@@ -138,7 +138,7 @@ class OsrCheckVisitor : public StackVisitor {
         // Sleep to yield to the compiler thread.
         usleep(1000);
         // Will either ensure it's compiled or do the compilation itself.
-        jit->CompileMethod(m, Thread::Current(), /* osr */ true);
+        jit->CompileMethod(m, Thread::Current(), /* osr */ true, /* baseline */ false);
       }
       return false;
     }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) {
+    testSimpleUse(false);
+    testFieldStores(false);
+    testUseOnBothPaths(false);
+    try {
+      testSimpleUse(true);
+      throw new Error("Expected error");
+    } catch (Error e) {
+      assertEquals("simple", e.getMessage());
+    }
+    try {
+      testFieldStores(true);
+      throw new Error("Expected error");
+    } catch (Error e) {
+      assertEquals("42", e.getMessage());
+    }
+  }
+
+  /// CHECK-START: void Main.testSimpleUse(boolean) code_sinking (before)
+  /// CHECK:                    NewInstance
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK:                    Throw
+
+  /// CHECK-START: void Main.testSimpleUse(boolean) code_sinking (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK:                    NewInstance
+  /// CHECK:                    Throw
+  public static void testSimpleUse(boolean doThrow) {
+    Main m = new Main();
+    if (doThrow) {
+      throw new Error(m.$noinline$getMessage());
+    }
+  }
+
+  /// CHECK-START: void Main.testFieldStores(boolean) code_sinking (before)
+  /// CHECK:                    NewInstance
+  /// CHECK:                    InstanceFieldSet
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK:                    Throw
+
+  /// CHECK-START: void Main.testFieldStores(boolean) code_sinking (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK:                    NewInstance
+  /// CHECK-NOT:                begin_block
+  /// CHECK:                    InstanceFieldSet
+  /// CHECK:                    Throw
+  public static void testFieldStores(boolean doThrow) {
+    Main m = new Main();
+    m.intField = 42;
+    if (doThrow) {
+      throw new Error(m.$noinline$getMessage());
+    }
+  }
+
+  // The allocation is used on the non-throwing path too, it cannot move.
+
+  /// CHECK-START: void Main.testUseOnBothPaths(boolean) code_sinking (after)
+  /// CHECK:                    NewInstance
+  /// CHECK:                    If
+  public static void testUseOnBothPaths(boolean doThrow) {
+    Main m = new Main();
+    if (doThrow) {
+      throw new Error(m.$noinline$getMessage());
+    }
+    sMain = m;
+  }
+
+  public String $noinline$getMessage() {
+    return intField == 0 ? "simple" : Integer.toString(intField);
+  }
+
+  public static void assertEquals(String expected, String actual) {
+    if (!expected.equals(actual)) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  int intField;
+  static Main sMain;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) {
+    assertEquals("ab", concatStrings("a", "b"));
+    assertEquals("anull", concatStrings("a", null));
+    assertEquals("x42", concatInt("x", 42));
+    assertEquals("x-2147483648", concatInt("x", Integer.MIN_VALUE));
+    assertEquals("x-9223372036854775808y", concatLong("x", Long.MIN_VALUE, "y"));
+    assertEquals("x1234567890123y", concatLong("x", 1234567890123L, "y"));
+    assertEquals("truecfalse", concatBooleanChar(true, 'c', false));
+    assertEquals("0", concatIntOnly(0));
+    assertEquals("a7b", concatWithSideEffect("a", 7, "b"));
+  }
+
+  /// CHECK-START: java.lang.String Main.concatStrings(java.lang.String, java.lang.String) instruction_simplifier (before)
+  /// CHECK:                    NewInstance
+  /// CHECK:                    InvokeStaticOrDirect
+  /// CHECK:                    Invoke{{(StaticOrDirect|Virtual)}} intrinsic:StringBuilderAppendString
+  /// CHECK:                    Invoke{{(StaticOrDirect|Virtual)}} intrinsic:StringBuilderAppendString
+  /// CHECK:                    Invoke{{(StaticOrDirect|Virtual)}} intrinsic:StringBuilderToString
+
+  /// CHECK-START: java.lang.String Main.concatStrings(java.lang.String, java.lang.String) instruction_simplifier (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK-NOT:                Invoke{{(StaticOrDirect|Virtual)}}
+  /// CHECK:      <<Append:l\d+>> StringBuilderAppend
+  /// CHECK:                    Return [<<Append>>]
+  public static String concatStrings(String a, String b) {
+    return a + b;
+  }
+
+  /// CHECK-START: java.lang.String Main.concatInt(java.lang.String, int) instruction_simplifier (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    StringBuilderAppend
+  public static String concatInt(String s, int i) {
+    return s + i;
+  }
+
+  /// CHECK-START: java.lang.String Main.concatLong(java.lang.String, long, java.lang.String) instruction_simplifier (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    StringBuilderAppend
+  public static String concatLong(String s, long l, String t) {
+    return s + l + t;
+  }
+
+  /// CHECK-START: java.lang.String Main.concatBooleanChar(boolean, char, boolean) instruction_simplifier (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    StringBuilderAppend
+  public static String concatBooleanChar(boolean b, char c, boolean d) {
+    return new StringBuilder().append(b).append(c).append(d).toString();
+  }
+
+  /// CHECK-START: java.lang.String Main.concatIntOnly(int) instruction_simplifier (after)
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    StringBuilderAppend
+  public static String concatIntOnly(int i) {
+    StringBuilder sb = new StringBuilder();
+    sb.append(i);
+    return sb.toString();
+  }
+
+  // The call to $noinline$identity() between the appends has an environment holding
+  // the StringBuilder, which must be kept for deoptimization.
+
+  /// CHECK-START: java.lang.String Main.concatWithSideEffect(java.lang.String, int, java.lang.String) instruction_simplifier (after)
+  /// CHECK:                    NewInstance
+  /// CHECK-NOT:                StringBuilderAppend
+  public static String concatWithSideEffect(String a, int i, String b) {
+    return a + $noinline$identity(i) + b;
+  }
+
+  public static int $noinline$identity(int i) {
+    if (doThrow) {
+      throw new Error();
+    }
+    return i;
+  }
+
+  public static void assertEquals(String expected, String actual) {
+    if (!expected.equals(actual)) {
+      throw new Error("Expected: " + expected + ", actual: " + actual);
+    }
+  }
+
+  static boolean doThrow = false;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Arrays;
+
+public class Main {
+
+  /// CHECK-START: boolean Main.$noinline$equalsByte(byte[], byte[]) intrinsics_recognition (after)
+  /// CHECK-DAG:     <<Result:z\d+>>  InvokeStaticOrDirect intrinsic:ArraysEqualsByte
+  /// CHECK-DAG:                      Return [<<Result>>]
+  private static boolean $noinline$equalsByte(byte[] a, byte[] b) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    return Arrays.equals(a, b);
+  }
+
+  /// CHECK-START: boolean Main.$noinline$equalsChar(char[], char[]) intrinsics_recognition (after)
+  /// CHECK-DAG:     <<Result:z\d+>>  InvokeStaticOrDirect intrinsic:ArraysEqualsChar
+  /// CHECK-DAG:                      Return [<<Result>>]
+  private static boolean $noinline$equalsChar(char[] a, char[] b) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    return Arrays.equals(a, b);
+  }
+
+  /// CHECK-START: boolean Main.$noinline$equalsInt(int[], int[]) intrinsics_recognition (after)
+  /// CHECK-DAG:     <<Result:z\d+>>  InvokeStaticOrDirect intrinsic:ArraysEqualsInt
+  /// CHECK-DAG:                      Return [<<Result>>]
+  private static boolean $noinline$equalsInt(int[] a, int[] b) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    return Arrays.equals(a, b);
+  }
+
+  /// CHECK-START: void Main.$noinline$fillByte(byte[], byte) intrinsics_recognition (after)
+  /// CHECK-DAG:                      InvokeStaticOrDirect intrinsic:ArraysFillByte
+  private static void $noinline$fillByte(byte[] a, byte value) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    Arrays.fill(a, value);
+  }
+
+  /// CHECK-START: void Main.$noinline$fillChar(char[], char) intrinsics_recognition (after)
+  /// CHECK-DAG:                      InvokeStaticOrDirect intrinsic:ArraysFillChar
+  private static void $noinline$fillChar(char[] a, char value) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    Arrays.fill(a, value);
+  }
+
+  /// CHECK-START: void Main.$noinline$fillInt(int[], int) intrinsics_recognition (after)
+  /// CHECK-DAG:                      InvokeStaticOrDirect intrinsic:ArraysFillInt
+  private static void $noinline$fillInt(int[] a, int value) {
+    if (doThrow) { throw new Error(); }  // Try defeating inlining.
+    Arrays.fill(a, value);
+  }
+
+  // Lengths around the 16-byte block size, to exercise both the scalar and the vector code.
+  private static final int MAX_LENGTH = 40;
+
+  public static void testArrays() {
+    expectEquals(true, $noinline$equalsByte(null, null));
+    expectEquals(false, $noinline$equalsByte(new byte[0], null));
+    expectEquals(false, $noinline$equalsChar(null, new char[0]));
+    expectEquals(false, $noinline$equalsInt(new int[1], new int[2]));
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      byte[] b1 = new byte[length];
+      byte[] b2 = new byte[length];
+      char[] c1 = new char[length];
+      char[] c2 = new char[length];
+      int[] i1 = new int[length];
+      int[] i2 = new int[length];
+      $noinline$fillByte(b1, (byte) -3);
+      $noinline$fillChar(c1, 'ꯍ');
+      $noinline$fillInt(i1, 0x12345678);
+      for (int i = 0; i < length; i++) {
+        expectEquals(-3, b1[i]);
+        expectEquals(0xabcd, c1[i]);
+        expectEquals(0x12345678, i1[i]);
+      }
+      $noinline$fillByte(b2, (byte) -3);
+      $noinline$fillChar(c2, 'ꯍ');
+      $noinline$fillInt(i2, 0x12345678);
+      expectEquals(true, $noinline$equalsByte(b1, b2));
+      expectEquals(true, $noinline$equalsChar(c1, c2));
+      expectEquals(true, $noinline$equalsInt(i1, i2));
+      // A difference at any position must be found.
+      for (int i = 0; i < length; i++) {
+        b2[i] = 0;
+        c2[i] = 0;
+        i2[i] = 0;
+        expectEquals(false, $noinline$equalsByte(b1, b2));
+        expectEquals(false, $noinline$equalsChar(c1, c2));
+        expectEquals(false, $noinline$equalsInt(i1, i2));
+        b2[i] = b1[i];
+        c2[i] = c1[i];
+        i2[i] = i1[i];
+      }
+    }
+    try {
+      $noinline$fillInt(null, 0);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+  }
+
+  public static void testStrings() {
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      char[] data = new char[length];
+      Arrays.fill(data, 'a');
+      String s1 = new String(data);
+      expectEquals(-1, s1.indexOf('b'));
+      for (int i = 0; i < length; i++) {
+        data[i] = 'b';
+        String s2 = new String(data);
+        expectEquals(false, s1.equals(s2));
+        expectEquals('a' - 'b', s1.compareTo(s2));
+        expectEquals('b' - 'a', s2.compareTo(s1));
+        expectEquals(i, s2.indexOf('b'));
+        expectEquals(i, s2.indexOf('b', i));
+        expectEquals(-1, s2.indexOf('b', i + 1));
+        expectEquals(i == 0 ? -1 : 0, s2.indexOf('a', -5));
+        data[i] = 'a';
+        expectEquals(true, s1.equals(new String(data)));
+        expectEquals(0, s1.compareTo(new String(data)));
+      }
+      // The length difference is returned when one string is a prefix of the other.
+      expectEquals(-1, s1.compareTo(s1 + "a"));
+    }
+  }
+
+  public static void main(String args[]) {
+    testArrays();
+    testStrings();
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(boolean expected, boolean result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static boolean doThrow = false;
+}
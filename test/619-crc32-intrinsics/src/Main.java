@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.zip.CRC32;
+
+public class Main {
+  private static final int MAX_LENGTH = 40;
+
+  private static final int[] TABLE = new int[256];
+
+  static {
+    for (int i = 0; i < 256; i++) {
+      int c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) != 0 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+      }
+      TABLE[i] = c;
+    }
+  }
+
+  private static long referenceCrc32(byte[] data, int offset, int length) {
+    int c = 0xffffffff;
+    for (int i = offset; i < offset + length; i++) {
+      c = TABLE[(c ^ data[i]) & 0xff] ^ (c >>> 8);
+    }
+    return (c ^ 0xffffffff) & 0xffffffffL;
+  }
+
+  public static void testUpdateByte() {
+    byte[] data = new byte[256];
+    CRC32 crc32 = new CRC32();
+    for (int i = 0; i < data.length; i++) {
+      data[i] = (byte) i;
+      // Only the low byte of the argument is used.
+      crc32.update(i + 0x1200);
+      expectEquals(referenceCrc32(data, 0, i + 1), crc32.getValue());
+    }
+  }
+
+  public static void testUpdateBytes() {
+    byte[] data = new byte[MAX_LENGTH + 8];
+    for (int i = 0; i < data.length; i++) {
+      data[i] = (byte) (i * 37 + 11);
+    }
+    CRC32 crc32 = new CRC32();
+    // All lengths around the 8-byte blocks, at all alignments.
+    for (int offset = 0; offset < 8; offset++) {
+      for (int length = 0; length <= MAX_LENGTH; length++) {
+        crc32.reset();
+        crc32.update(data, offset, length);
+        expectEquals(referenceCrc32(data, offset, length), crc32.getValue());
+      }
+    }
+    // Continue a checksum over several calls.
+    crc32.reset();
+    crc32.update(data, 0, 3);
+    crc32.update(data[3]);
+    crc32.update(data, 4, MAX_LENGTH - 4);
+    expectEquals(referenceCrc32(data, 0, MAX_LENGTH), crc32.getValue());
+    // The checked variant must still throw.
+    try {
+      crc32.update(data, 1, data.length);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+  }
+
+  public static void main(String args[]) {
+    testUpdateByte();
+    testUpdateBytes();
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  // Past the 512 bytes copied inline by the intrinsics, for all element sizes.
+  private static final int MAX_LENGTH = 600;
+  private static final int MAX_OFFSET = 17;
+
+  public static void testByte() {
+    byte[] src = new byte[MAX_LENGTH + MAX_OFFSET];
+    for (int i = 0; i < src.length; i++) {
+      src[i] = (byte) (i * 37 + 11);
+    }
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      for (int offset = 0; offset < MAX_OFFSET; offset += 3) {
+        byte[] dst = new byte[MAX_LENGTH + MAX_OFFSET + 1];
+        System.arraycopy(src, offset, dst, MAX_OFFSET - offset, length);
+        for (int i = 0; i < dst.length; i++) {
+          int j = i - (MAX_OFFSET - offset);
+          expectEquals((j >= 0 && j < length) ? src[offset + j] : 0, dst[i]);
+        }
+      }
+    }
+  }
+
+  public static void testChar() {
+    char[] src = new char[MAX_LENGTH + MAX_OFFSET];
+    for (int i = 0; i < src.length; i++) {
+      src[i] = (char) (i * 37 + 11);
+    }
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      for (int offset = 0; offset < MAX_OFFSET; offset += 3) {
+        char[] dst = new char[MAX_LENGTH + MAX_OFFSET + 1];
+        System.arraycopy(src, offset, dst, MAX_OFFSET - offset, length);
+        for (int i = 0; i < dst.length; i++) {
+          int j = i - (MAX_OFFSET - offset);
+          expectEquals((j >= 0 && j < length) ? src[offset + j] : 0, dst[i]);
+        }
+      }
+    }
+  }
+
+  public static void testInt() {
+    int[] src = new int[MAX_LENGTH + MAX_OFFSET];
+    for (int i = 0; i < src.length; i++) {
+      src[i] = i * 0x01010101 + 11;
+    }
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      for (int offset = 0; offset < MAX_OFFSET; offset += 3) {
+        int[] dst = new int[MAX_LENGTH + MAX_OFFSET + 1];
+        System.arraycopy(src, offset, dst, MAX_OFFSET - offset, length);
+        for (int i = 0; i < dst.length; i++) {
+          int j = i - (MAX_OFFSET - offset);
+          expectEquals((j >= 0 && j < length) ? src[offset + j] : 0, dst[i]);
+        }
+      }
+    }
+  }
+
+  public static void testLong() {
+    long[] src = new long[MAX_LENGTH + MAX_OFFSET];
+    for (int i = 0; i < src.length; i++) {
+      src[i] = i * 0x0101010101010101L + 11;
+    }
+    for (int length = 0; length <= MAX_LENGTH; length++) {
+      for (int offset = 0; offset < MAX_OFFSET; offset += 3) {
+        long[] dst = new long[MAX_LENGTH + MAX_OFFSET + 1];
+        System.arraycopy(src, offset, dst, MAX_OFFSET - offset, length);
+        for (int i = 0; i < dst.length; i++) {
+          int j = i - (MAX_OFFSET - offset);
+          expectEquals((j >= 0 && j < length) ? src[offset + j] : 0L, dst[i]);
+        }
+      }
+    }
+  }
+
+  public static void testOverlap() {
+    // Copies within the same array must behave as if through a temporary copy.
+    int[] array = new int[64];
+    for (int i = 0; i < array.length; i++) {
+      array[i] = i;
+    }
+    System.arraycopy(array, 0, array, 5, 40);
+    for (int i = 0; i < array.length; i++) {
+      expectEquals((i >= 5 && i < 45) ? i - 5 : i, array[i]);
+    }
+    for (int i = 0; i < array.length; i++) {
+      array[i] = i;
+    }
+    System.arraycopy(array, 5, array, 0, 40);
+    for (int i = 0; i < array.length; i++) {
+      expectEquals(i < 40 ? i + 5 : i, array[i]);
+    }
+  }
+
+  public static void testExceptions() {
+    byte[] bytes = new byte[16];
+    long[] longs = new long[16];
+    try {
+      System.arraycopy(bytes, 1, new byte[16], 0, 16);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(longs, 0, longs, -1, 1);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy(longs, 0, new long[16], 0, -1);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      System.arraycopy((int[]) null, 0, new int[16], 0, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+  }
+
+  public static void main(String[] args) {
+    testByte();
+    testChar();
+    testInt();
+    testLong();
+    testOverlap();
+    testExceptions();
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
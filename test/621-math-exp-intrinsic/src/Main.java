@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void testSpecialValues() {
+    expectEquals(Double.NaN, Math.exp(Double.NaN));
+    expectEquals(Double.POSITIVE_INFINITY, Math.exp(Double.POSITIVE_INFINITY));
+    expectEquals(0.0, Math.exp(Double.NEGATIVE_INFINITY));
+    expectEquals(1.0, Math.exp(0.0));
+    expectEquals(1.0, Math.exp(-0.0));
+    expectWithinOneUlp(Math.E, Math.exp(1.0));
+    // Overflow and denormal results, which are on the slow path.
+    expectEquals(Double.POSITIVE_INFINITY, Math.exp(710.0));
+    expectEquals(0.0, Math.exp(-746.0));
+    expectWithinOneUlp(StrictMath.exp(709.5), Math.exp(709.5));
+    expectWithinOneUlp(StrictMath.exp(-730.0), Math.exp(-730.0));
+  }
+
+  public static void testFastPath() {
+    // Around the bound of the fast path, around ties of x / ln2, and tiny values.
+    double[] values = {
+      708.0, Math.nextUp(708.0), Math.nextDown(708.0), -708.0, Math.nextUp(-708.0),
+      Math.log(2.0) / 2, Math.log(2.0) * 1.5, -Math.log(2.0) / 2, 1e-300, -1e-300, 1e-20,
+    };
+    for (double value : values) {
+      expectWithinOneUlp(StrictMath.exp(value), Math.exp(value));
+    }
+    for (int i = -70800; i <= 70800; i += 7) {
+      double value = i / 100.0 + 0.001234;
+      expectWithinOneUlp(StrictMath.exp(value), Math.exp(value));
+    }
+  }
+
+  public static void main(String args[]) {
+    testSpecialValues();
+    testFastPath();
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(double expected, double result) {
+    if (Double.compare(expected, result) != 0) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectWithinOneUlp(double expected, double result) {
+    if (!(Math.abs(expected - result) <= Math.ulp(expected))) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+final class Point implements Cloneable {
+  int x;
+  long y;
+  Object ref;
+
+  Point(int x, long y, Object ref) {
+    this.x = x;
+    this.y = y;
+    this.ref = ref;
+  }
+
+  /// CHECK-START: Point Point.copy() intrinsics_recognition (after)
+  /// CHECK:                    InvokeStaticOrDirect intrinsic:ObjectClone
+  public Point copy() throws CloneNotSupportedException {
+    return (Point) super.clone();
+  }
+}
+
+class NotCloneable {
+  /// CHECK-START: NotCloneable NotCloneable.copy() intrinsics_recognition (after)
+  /// CHECK-NOT:                intrinsic:ObjectClone
+  public NotCloneable copy() throws CloneNotSupportedException {
+    return (NotCloneable) super.clone();
+  }
+}
+
+class Base implements Cloneable {
+  int value;
+
+  @Override
+  protected Object clone() throws CloneNotSupportedException {
+    Base copy = (Base) super.clone();
+    copy.value++;
+    return copy;
+  }
+}
+
+class Derived extends Base {
+  /// CHECK-START: Derived Derived.copy() intrinsics_recognition (after)
+  /// CHECK-NOT:                intrinsic:ObjectClone
+  public Derived copy() throws CloneNotSupportedException {
+    // Calls the override in Base.
+    return (Derived) super.clone();
+  }
+}
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    int[] ints = { 1, 2, 3 };
+    int[] intsCopy = cloneIntArray(ints);
+    assertTrue(intsCopy != ints);
+    assertEquals(3, intsCopy.length);
+    assertEquals(2, intsCopy[1]);
+    intsCopy[1] = 42;
+    assertEquals(2, ints[1]);
+    assertEquals(0, cloneIntArray(new int[0]).length);
+
+    Object[] objects = { "a", ints, null };
+    Object[] objectsCopy = cloneObjectArray(objects);
+    assertTrue(objectsCopy != objects);
+    assertTrue(objectsCopy[0] == objects[0]);
+    assertTrue(objectsCopy[1] == ints);
+    assertTrue(objectsCopy[2] == null);
+    // The copy keeps the runtime type of the array.
+    String[] strings = { "x", "y" };
+    assertTrue(cloneObjectArray(strings) instanceof String[]);
+
+    try {
+      cloneIntArray(null);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    Object ref = new Object();
+    Point point = new Point(1, 2L, ref);
+    Point pointCopy = point.copy();
+    assertTrue(pointCopy != point);
+    assertEquals(1, pointCopy.x);
+    assertTrue(pointCopy.y == 2L);
+    assertTrue(pointCopy.ref == ref);
+
+    try {
+      new NotCloneable().copy();
+      throw new Error("Expected CloneNotSupportedException");
+    } catch (CloneNotSupportedException expected) {
+    }
+
+    Derived derived = new Derived();
+    derived.value = 5;
+    assertEquals(6, derived.copy().value);
+
+    // Enough copies of arrays of references to go through a few collections.
+    Object[] big = new Object[1000];
+    for (int i = 0; i < big.length; i++) {
+      big[i] = new int[] { i };
+    }
+    for (int i = 0; i < 1000; i++) {
+      big = cloneObjectArray(big);
+    }
+    for (int i = 0; i < big.length; i++) {
+      assertEquals(i, ((int[]) big[i])[0]);
+    }
+  }
+
+  /// CHECK-START: int[] Main.cloneIntArray(int[]) intrinsics_recognition (after)
+  /// CHECK:                    InvokeVirtual intrinsic:ObjectClone
+  public static int[] cloneIntArray(int[] array) {
+    return array.clone();
+  }
+
+  /// CHECK-START: java.lang.Object[] Main.cloneObjectArray(java.lang.Object[]) intrinsics_recognition (after)
+  /// CHECK:                    InvokeVirtual intrinsic:ObjectClone
+  public static Object[] cloneObjectArray(Object[] array) {
+    return array.clone();
+  }
+
+  public static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  public static void assertTrue(boolean condition) {
+    if (!condition) {
+      throw new Error("Assertion failed");
+    }
+  }
+}
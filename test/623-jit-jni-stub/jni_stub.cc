@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+namespace art {
+
+extern "C" JNIEXPORT jdouble JNICALL Java_Main_mix(JNIEnv* env,
+                                                  jclass,
+                                                  jint i,
+                                                  jlong l,
+                                                  jobject o,
+                                                  jfloat f,
+                                                  jdouble d) {
+  jclass string_class = env->FindClass("java/lang/String");
+  jdouble string_bonus = env->IsInstanceOf(o, string_class) ? 0.5 : 0.0;
+  return i + l + f + d + string_bonus;
+}
+
+extern "C" JNIEXPORT jobject JNICALL Java_Main_identity(JNIEnv*, jobject, jobject o) {
+  return o;
+}
+
+extern "C" JNIEXPORT jobject JNICALL Java_Main_syncIdentity(JNIEnv*, jobject, jobject o) {
+  return o;
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_checkPositive(JNIEnv* env, jclass, jint i) {
+  if (i < 0) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), "negative");
+    return 0;
+  }
+  return i;
+}
+
+}  // namespace art
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    Main main = new Main();
+
+    // Loop enough to get the JNI stubs JITed.
+    for (int i = 0; i < 100000; i++) {
+      main.checkAll(i);
+    }
+
+    ensureJitCompiled(Main.class, "mix");
+    ensureJitCompiled(Main.class, "identity");
+    ensureJitCompiled(Main.class, "checkPositive");
+    ensureJitCompiled(Main.class, "syncIdentity");
+
+    for (int i = 0; i < 1000; i++) {
+      main.checkAll(i);
+    }
+  }
+
+  private void checkAll(int i) {
+    assertEquals(i + 3.5 + 0.25 + 0.5, mix(i, 3L, "string", 0.25f, 0.5));
+    assertEquals(i + 3.25 + 0.5, mix(i, 3L, this, 0.25f, 0.5));
+
+    Object o = new Object();
+    if (identity(o) != o || identity(null) != null || syncIdentity(o) != o) {
+      throw new Error("Unexpected identity");
+    }
+
+    if (checkPositive(i) != i) {
+      throw new Error("Unexpected checkPositive result");
+    }
+    try {
+      checkPositive(-i - 1);
+      throw new Error("Expected IllegalArgumentException");
+    } catch (IllegalArgumentException expected) {
+    }
+  }
+
+  private static void assertEquals(double expected, double actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  private static native double mix(int i, long l, Object o, float f, double d);
+  private native Object identity(Object o);
+  private synchronized native Object syncIdentity(Object o);
+  private static native int checkPositive(int i);
+
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+interface Adder {
+  long add(long a, int b);
+}
+
+class Base implements Adder {
+  public long add(long a, int b) {
+    return a + b;
+  }
+
+  public Object pick(Object a, int b, Object c) {
+    return (b == 0) ? a : c;
+  }
+}
+
+class Derived extends Base {
+  public long add(long a, int b) {
+    return super.add(a, b) * 2;
+  }
+}
+
+class Init {
+  static int value;
+
+  static {
+    System.out.println("Init.<clinit>");
+    value = 42;
+  }
+
+  static int get() {
+    return value;
+  }
+}
+
+class Oops extends RuntimeException {
+  final int code;
+
+  Oops(int code) {
+    this.code = code;
+  }
+}
+
+public class Main {
+  static int depth = 0;
+
+  static int wide(long a, double b, int c, float d, Object e, long f) {
+    return (int) (a + (long) b + c + (long) d + f) + ((e == null) ? 0 : 1);
+  }
+
+  // Takes more than five argument registers, so it is called with invoke-static/range.
+  static long range(int a, long b, Object c, double d, int e, int f, Object g) {
+    return a + b + (long) d + e + f + ((c == g) ? 100 : 0);
+  }
+
+  private int direct(int x) {
+    return x + 1;
+  }
+
+  static void thrower(int code) {
+    throw new Oops(code);
+  }
+
+  static void recurse() {
+    depth++;
+    recurse();
+  }
+
+  static void expectEquals(long expected, long actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  public static void main(String[] args) {
+    Object o = new Object();
+    Adder[] adders = { new Base(), new Derived() };
+    Base base = new Base();
+    Main main = new Main();
+    for (int i = 0; i < 10000; i++) {
+      expectEquals(10L + i, adders[0].add(10L, i));
+      expectEquals(2 * (10L + i), adders[1].add(10L, i));
+      expectEquals(i + 10, wide(4L, 3.5, i, 1.25f, o, 1L));
+      expectEquals(1 + (1L << 40) + 2 + 3 + i + 100, range(1, 1L << 40, o, 2.5, 3, i, o));
+      expectEquals(i + 1, main.direct(i));
+      if (base.pick(o, i & 1, null) != ((i & 1) == 0 ? o : null)) {
+        throw new Error("Wrong reference argument");
+      }
+    }
+
+    System.out.println("Init.value " + Init.get());
+
+    char[] chars = { 'a', 'b', 'c' };
+    System.out.println("String " + new String(chars, 0, 3));
+
+    try {
+      thrower(7);
+    } catch (Oops e) {
+      System.out.println("Caught Oops " + e.code);
+    }
+
+    try {
+      recurse();
+    } catch (StackOverflowError e) {
+      System.out.println("Caught StackOverflowError");
+    }
+
+    System.out.println("Done");
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+class Base {
+  int value() {
+    return 1;
+  }
+}
+
+// Only loaded by reflection, so that Base.value() has a single implementation until
+// testDevirtualized() loads it.
+class Derived extends Base {
+  static {
+    System.out.println("Derived loaded");
+  }
+
+  int value() {
+    return 2;
+  }
+}
+
+public class Main {
+
+  /// CHECK-START: int Main.testDevirtualized(Base, boolean) inliner (before)
+  /// CHECK:                        InvokeVirtual method_name:Base.value
+
+  /// CHECK-START: int Main.testDevirtualized(Base, boolean) inliner (after)
+  /// CHECK-NOT:                    InvokeVirtual method_name:Base.value
+
+  /// CHECK-START: int Main.testDevirtualized(Base, boolean) inliner (after)
+  /// CHECK-DAG: <<Zero:i\d+>>      IntConstant 0
+  /// CHECK-DAG: <<Flag:i\d+>>      ShouldDeoptimizeFlag
+  /// CHECK-DAG: <<Cond:z\d+>>      NotEqual [<<Flag>>,<<Zero>>]
+  /// CHECK-DAG:                    Deoptimize [<<Cond>>]
+
+  static int testDevirtualized(Base b, boolean loadDerived) throws Exception {
+    int result = b.value();
+    if (loadDerived) {
+      if (inlining && isInterpreted()) {
+        throw new Error("Expected testDevirtualized to be compiled");
+      }
+      b = (Base) Class.forName("Derived").newInstance();
+      // Loading Derived invalidated the compiled code, and flagged this frame: the guard of the
+      // devirtualized call deoptimizes, and the interpreter calls Derived.value().
+      result += 10 * b.value();
+      if (inlining && !isInterpreted()) {
+        throw new Error("Expected testDevirtualized to be deoptimized");
+      }
+    }
+    return result;
+  }
+
+  // Runs long enough to be compiled for on stack replacement. OSR code cannot deoptimize, so it
+  // must not use the class hierarchy analysis.
+  static int $noinline$loop(Base b) {
+    int sum = 0;
+    for (int i = 0; i < 1000000; ++i) {
+      sum += b.value();
+    }
+    return sum;
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    // The JIT only inlines in non debuggable code.
+    inlining = hasJit() && !isDebuggable();
+
+    Base base = new Base();
+    for (int i = 0; i < 10; ++i) {
+      expectEquals(1, testDevirtualized(base, false));
+    }
+    ensureJitCompiled(Main.class, "testDevirtualized");
+    expectEquals(1, testDevirtualized(base, false));
+    expectEquals(1000000, $noinline$loop(base));
+
+    expectEquals(21, testDevirtualized(base, true));
+    // The invalidated code is not used anymore.
+    expectEquals(1, testDevirtualized(base, false));
+    Base derived = (Base) Class.forName("Derived").newInstance();
+    expectEquals(2, testDevirtualized(derived, false));
+    expectEquals(2000000, $noinline$loop(derived));
+    System.out.println("passed");
+  }
+
+  static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  static boolean inlining;
+
+  private static native boolean hasJit();
+  private static native boolean isDebuggable();
+  private static native boolean isInterpreted();
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
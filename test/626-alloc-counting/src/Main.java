@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class Main {
+    static final int ALLOCATIONS = 1000;
+
+    static class Plain {
+        Plain next;
+    }
+
+    // Keep the objects reachable so that the allocations are not removed.
+    static Plain sink;
+
+    public static void main(String[] args) throws Exception {
+        System.loadLibrary(args[0]);
+        // Make sure Plain is initialized, so that the compiled code uses the entrypoint for
+        // initialized classes.
+        sink = new Plain();
+        for (int i = 0; i < 10000; ++i) {
+            $noinline$allocate(1);
+        }
+        ensureJitCompiled(Main.class, "$noinline$allocate");
+
+        VMDebug.startAllocCounting();
+        VMDebug.resetAllocCount(VMDebug.KIND_ALL_COUNTS);
+        $noinline$allocate(ALLOCATIONS);
+        int count = VMDebug.getAllocCount(VMDebug.KIND_GLOBAL_ALLOCATED_OBJECTS);
+        VMDebug.stopAllocCounting();
+        sink = null;
+
+        if (count < ALLOCATIONS) {
+            throw new Error("Expected at least " + ALLOCATIONS + " allocations, got " + count);
+        }
+        System.out.println("passed");
+    }
+
+    static void $noinline$allocate(int n) {
+        Plain head = sink;
+        for (int i = 0; i < n; ++i) {
+            Plain p = new Plain();
+            p.next = head;
+            head = p;
+        }
+        sink = head;
+    }
+
+    private static native void ensureJitCompiled(Class<?> cls, String methodName);
+
+    private static class VMDebug {
+        static final int KIND_GLOBAL_ALLOCATED_OBJECTS = 1;
+        static final int KIND_ALL_COUNTS = 0xffffffff;
+
+        private static final Method startAllocCountingMethod;
+        private static final Method stopAllocCountingMethod;
+        private static final Method getAllocCountMethod;
+        private static final Method resetAllocCountMethod;
+        static {
+            try {
+                Class<?> c = Class.forName("dalvik.system.VMDebug");
+                startAllocCountingMethod = c.getDeclaredMethod("startAllocCounting");
+                stopAllocCountingMethod = c.getDeclaredMethod("stopAllocCounting");
+                getAllocCountMethod = c.getDeclaredMethod("getAllocCount", Integer.TYPE);
+                resetAllocCountMethod = c.getDeclaredMethod("resetAllocCount", Integer.TYPE);
+            } catch (Exception e) {
+                throw new RuntimeException(e);
+            }
+        }
+
+        public static void startAllocCounting() throws Exception {
+            startAllocCountingMethod.invoke(null);
+        }
+        public static void stopAllocCounting() throws Exception {
+            stopAllocCountingMethod.invoke(null);
+        }
+        public static int getAllocCount(int kind) throws Exception {
+            return (int) getAllocCountMethod.invoke(null, kind);
+        }
+        public static void resetAllocCount(int kinds) throws Exception {
+            resetAllocCountMethod.invoke(null, kinds);
+        }
+    }
+}
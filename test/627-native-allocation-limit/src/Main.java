@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class Main {
+    // Far above the native footprint limit, which is a few heap free sizes above the native
+    // bytes that survived the last collection.
+    static final int NATIVE_BYTES = 1 << 30;
+
+    public static void main(String[] args) throws Exception {
+        Class<?> vmRuntimeClass = Class.forName("dalvik.system.VMRuntime");
+        Object vmRuntime = vmRuntimeClass.getDeclaredMethod("getRuntime").invoke(null);
+        Method registerNativeAllocation =
+                vmRuntimeClass.getDeclaredMethod("registerNativeAllocation", Integer.TYPE);
+        Method registerNativeFree =
+                vmRuntimeClass.getDeclaredMethod("registerNativeFree", Integer.TYPE);
+        Method getRuntimeStat = Class.forName("dalvik.system.VMDebug")
+                .getDeclaredMethod("getRuntimeStat", String.class);
+
+        long before = Long.parseLong(
+                (String) getRuntimeStat.invoke(null, "art.gc.blocking-gc-count"));
+        registerNativeAllocation.invoke(vmRuntime, NATIVE_BYTES);
+        long after = Long.parseLong(
+                (String) getRuntimeStat.invoke(null, "art.gc.blocking-gc-count"));
+        registerNativeFree.invoke(vmRuntime, NATIVE_BYTES);
+
+        if (after <= before) {
+            throw new Error("Expected a blocking collection, the count stayed at " + before);
+        }
+        System.out.println("passed");
+    }
+}
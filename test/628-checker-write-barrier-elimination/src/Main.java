@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The pass only removes card marks in the read barrier configuration, see
+// TEST_ART_BROKEN_OPTIMIZING_NO_READ_BARRIER_RUN_TESTS.
+public class Main {
+
+  static class Holder {
+    Object field;
+  }
+
+  static boolean doThrow = false;
+
+  static void $noinline$gcPoint() {
+    if (doThrow) {
+      throw new Error();
+    }
+  }
+
+  // The store comes right after the allocation, its card mark is removed.
+  /// CHECK-START-ARM64: Main$Holder Main.$noinline$storeIntoNew(java.lang.Object) write_barrier_elimination (before)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+
+  /// CHECK-START-ARM64: Main$Holder Main.$noinline$storeIntoNew(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:false
+
+  /// CHECK-START-X86_64: Main$Holder Main.$noinline$storeIntoNew(java.lang.Object) write_barrier_elimination (before)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+
+  /// CHECK-START-X86_64: Main$Holder Main.$noinline$storeIntoNew(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:false
+  static Holder $noinline$storeIntoNew(Object o) {
+    Holder h = new Holder();
+    h.field = o;
+    return h;
+  }
+
+  // The call may run a GC, which makes the object old.
+  /// CHECK-START-ARM64: Main$Holder Main.$noinline$storeAfterCall(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InvokeStaticOrDirect
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+
+  /// CHECK-START-X86_64: Main$Holder Main.$noinline$storeAfterCall(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         InvokeStaticOrDirect
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+  static Holder $noinline$storeAfterCall(Object o) {
+    Holder h = new Holder();
+    $noinline$gcPoint();
+    h.field = o;
+    return h;
+  }
+
+  // The second allocation is a GC point for the first object only.
+  /// CHECK-START-ARM64: Main$Holder Main.$noinline$storeAfterAllocation(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<First:l\d+>>   NewInstance
+  /// CHECK:         <<Second:l\d+>>  NewInstance
+  /// CHECK-DAG:                     InstanceFieldSet [<<First>>,<<Second>>] needs_write_barrier:true
+  /// CHECK-DAG:                     InstanceFieldSet [<<Second>>,<<Param>>] needs_write_barrier:false
+
+  /// CHECK-START-X86_64: Main$Holder Main.$noinline$storeAfterAllocation(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<First:l\d+>>   NewInstance
+  /// CHECK:         <<Second:l\d+>>  NewInstance
+  /// CHECK-DAG:                     InstanceFieldSet [<<First>>,<<Second>>] needs_write_barrier:true
+  /// CHECK-DAG:                     InstanceFieldSet [<<Second>>,<<Param>>] needs_write_barrier:false
+  static Holder $noinline$storeAfterAllocation(Object o) {
+    Holder first = new Holder();
+    Holder second = new Holder();
+    first.field = second;
+    second.field = o;
+    return first;
+  }
+
+  // The pass does not look across blocks.
+  /// CHECK-START-ARM64: Main$Holder Main.$noinline$storeInOtherBlock(java.lang.Object, boolean) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         If
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+
+  /// CHECK-START-X86_64: Main$Holder Main.$noinline$storeInOtherBlock(java.lang.Object, boolean) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewInstance
+  /// CHECK:                         If
+  /// CHECK:                         InstanceFieldSet [<<New>>,<<Param>>] needs_write_barrier:true
+  static Holder $noinline$storeInOtherBlock(Object o, boolean b) {
+    Holder h = new Holder();
+    if (b) {
+      h.field = o;
+    }
+    return h;
+  }
+
+  /// CHECK-START-ARM64: java.lang.Object[] Main.$noinline$storeIntoNewArray(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewArray
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:false needs_write_barrier:false
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:false needs_write_barrier:false
+
+  /// CHECK-START-X86_64: java.lang.Object[] Main.$noinline$storeIntoNewArray(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewArray
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:false needs_write_barrier:false
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:false needs_write_barrier:false
+  static Object[] $noinline$storeIntoNewArray(Object o) {
+    Object[] array = new Object[2];
+    array[0] = o;
+    array[1] = o;
+    return array;
+  }
+
+  // A store that needs a type check may call the runtime, so it is a GC point for the stores
+  // after it. Its own card mark is removed, since the runtime marks the card when it does the
+  // store itself.
+  /// CHECK-START-ARM64: java.lang.Object[] Main.$noinline$storeTypeCheckedIntoNewArray(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewArray
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:true needs_write_barrier:false
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:true needs_write_barrier:true
+
+  /// CHECK-START-X86_64: java.lang.Object[] Main.$noinline$storeTypeCheckedIntoNewArray(java.lang.Object) write_barrier_elimination (after)
+  /// CHECK:         <<Param:l\d+>>   ParameterValue
+  /// CHECK:         <<New:l\d+>>     NewArray
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:true needs_write_barrier:false
+  /// CHECK:                         ArraySet [<<New>>,{{i\d+}},<<Param>>] needs_type_check:true needs_write_barrier:true
+  static Object[] $noinline$storeTypeCheckedIntoNewArray(Object o) {
+    Object[] array = new Holder[2];
+    array[0] = o;
+    array[1] = o;
+    return array;
+  }
+
+  public static void main(String[] args) {
+    Object o = new Object();
+    Holder holder = new Holder();
+    expectEquals(o, $noinline$storeIntoNew(o).field);
+    expectEquals(o, $noinline$storeAfterCall(o).field);
+    expectEquals(o, ((Holder) $noinline$storeAfterAllocation(o).field).field);
+    expectEquals(o, $noinline$storeInOtherBlock(o, true).field);
+    expectEquals(null, $noinline$storeInOtherBlock(o, false).field);
+    expectEquals(o, $noinline$storeIntoNewArray(o)[1]);
+    expectEquals(holder, $noinline$storeTypeCheckedIntoNewArray(holder)[1]);
+    try {
+      $noinline$storeTypeCheckedIntoNewArray(o);
+      throw new Error("Expected ArrayStoreException");
+    } catch (ArrayStoreException expected) {
+    }
+    System.out.println("passed");
+  }
+
+  static void expectEquals(Object expected, Object result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
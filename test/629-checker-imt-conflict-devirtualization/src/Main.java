@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// With at most 64 IMT slots, the 65 consecutive method ids of Itf guarantee that m00 shares its
+// slot with another method of Itf, so every class implementing Itf has a conflict in that slot.
+interface Itf {
+  int m00();
+  int m01();
+  int m02();
+  int m03();
+  int m04();
+  int m05();
+  int m06();
+  int m07();
+  int m08();
+  int m09();
+  int m10();
+  int m11();
+  int m12();
+  int m13();
+  int m14();
+  int m15();
+  int m16();
+  int m17();
+  int m18();
+  int m19();
+  int m20();
+  int m21();
+  int m22();
+  int m23();
+  int m24();
+  int m25();
+  int m26();
+  int m27();
+  int m28();
+  int m29();
+  int m30();
+  int m31();
+  int m32();
+  int m33();
+  int m34();
+  int m35();
+  int m36();
+  int m37();
+  int m38();
+  int m39();
+  int m40();
+  int m41();
+  int m42();
+  int m43();
+  int m44();
+  int m45();
+  int m46();
+  int m47();
+  int m48();
+  int m49();
+  int m50();
+  int m51();
+  int m52();
+  int m53();
+  int m54();
+  int m55();
+  int m56();
+  int m57();
+  int m58();
+  int m59();
+  int m60();
+  int m61();
+  int m62();
+  int m63();
+  int m64();
+}
+
+abstract class Base implements Itf {
+  public int m01() { return 1; }
+  public int m02() { return 2; }
+  public int m03() { return 3; }
+  public int m04() { return 4; }
+  public int m05() { return 5; }
+  public int m06() { return 6; }
+  public int m07() { return 7; }
+  public int m08() { return 8; }
+  public int m09() { return 9; }
+  public int m10() { return 10; }
+  public int m11() { return 11; }
+  public int m12() { return 12; }
+  public int m13() { return 13; }
+  public int m14() { return 14; }
+  public int m15() { return 15; }
+  public int m16() { return 16; }
+  public int m17() { return 17; }
+  public int m18() { return 18; }
+  public int m19() { return 19; }
+  public int m20() { return 20; }
+  public int m21() { return 21; }
+  public int m22() { return 22; }
+  public int m23() { return 23; }
+  public int m24() { return 24; }
+  public int m25() { return 25; }
+  public int m26() { return 26; }
+  public int m27() { return 27; }
+  public int m28() { return 28; }
+  public int m29() { return 29; }
+  public int m30() { return 30; }
+  public int m31() { return 31; }
+  public int m32() { return 32; }
+  public int m33() { return 33; }
+  public int m34() { return 34; }
+  public int m35() { return 35; }
+  public int m36() { return 36; }
+  public int m37() { return 37; }
+  public int m38() { return 38; }
+  public int m39() { return 39; }
+  public int m40() { return 40; }
+  public int m41() { return 41; }
+  public int m42() { return 42; }
+  public int m43() { return 43; }
+  public int m44() { return 44; }
+  public int m45() { return 45; }
+  public int m46() { return 46; }
+  public int m47() { return 47; }
+  public int m48() { return 48; }
+  public int m49() { return 49; }
+  public int m50() { return 50; }
+  public int m51() { return 51; }
+  public int m52() { return 52; }
+  public int m53() { return 53; }
+  public int m54() { return 54; }
+  public int m55() { return 55; }
+  public int m56() { return 56; }
+  public int m57() { return 57; }
+  public int m58() { return 58; }
+  public int m59() { return 59; }
+  public int m60() { return 60; }
+  public int m61() { return 61; }
+  public int m62() { return 62; }
+  public int m63() { return 63; }
+  public int m64() { return 64; }
+}
+
+class Impl extends Base {
+  // The try/catch keeps the inliner away, so the call is devirtualized instead.
+  public int m00() {
+    try {
+      return value;
+    } catch (Error e) {
+      return -1;
+    }
+  }
+
+  int value = 42;
+}
+
+class Other extends Base {
+  public int m00() {
+    try {
+      return 7;
+    } catch (Error e) {
+      return -1;
+    }
+  }
+}
+
+public class Main {
+
+  /// CHECK-START: int Main.$noinline$callM00(Itf) inliner (before)
+  /// CHECK:                        InvokeInterface method_name:Itf.m00
+  /// CHECK-NOT:                    InvokeVirtual
+
+  /// CHECK-START: int Main.$noinline$callM00(Itf) inliner (after)
+  /// CHECK-DAG: <<Guard:z\d+>>     NotEqual
+  /// CHECK-DAG:                    If [<<Guard>>]
+  /// CHECK-DAG: <<Virtual:i\d+>>   InvokeVirtual method_name:Itf.m00
+  /// CHECK-DAG: <<Interface:i\d+>> InvokeInterface method_name:Itf.m00
+  /// CHECK-DAG: <<Phi:i\d+>>       Phi [<<Virtual>>,<<Interface>>]
+  /// CHECK-DAG:                    Return [<<Phi>>]
+
+  /// CHECK-START: int Main.$noinline$callM00(Itf) inliner (after)
+  /// CHECK-NOT:                    Deoptimize
+
+  static int $noinline$callM00(Itf itf) {
+    return itf.m00();
+  }
+
+  public static void main(String[] args) {
+    System.loadLibrary(args[0]);
+
+    Itf impl = new Impl();
+    // Only Impl receivers are recorded in the inline cache.
+    ensureHasProfilingInfo(Main.class, "$noinline$callM00");
+    for (int i = 0; i < 10; ++i) {
+      expectEquals(42, $noinline$callM00(impl));
+    }
+    ensureJitCompiled(Main.class, "$noinline$callM00");
+    expectEquals(42, $noinline$callM00(impl));
+    // Other fails the type guard of the devirtualized call and takes the interface call.
+    expectEquals(7, $noinline$callM00(new Other()));
+    expectEquals(42, $noinline$callM00(impl));
+    System.out.println("passed");
+  }
+
+  static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  private static native void ensureHasProfilingInfo(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Base {
+  int value() {
+    return 1;
+  }
+}
+
+class Sub1 extends Base {
+  int value() {
+    return 2;
+  }
+}
+
+class Sub2 extends Base {
+  int value() {
+    return 3;
+  }
+}
+
+class Sub3 extends Base {
+  int value() {
+    return 4;
+  }
+}
+
+class Sub4 extends Base {
+  int value() {
+    return 5;
+  }
+}
+
+class A1 {
+  int value() {
+    return 1;
+  }
+}
+
+// Only loaded by reflection, see Main.chaCall().
+class SubA1 extends A1 {
+  int value() {
+    return 0;
+  }
+}
+
+class A2 {
+  int value() {
+    return 2;
+  }
+}
+
+// Only loaded by reflection, see Main.chaCall().
+class SubA2 extends A2 {
+  int value() {
+    return 0;
+  }
+}
+
+class A3 {
+  int value() {
+    return 3;
+  }
+}
+
+// Only loaded by reflection, see Main.chaCall().
+class SubA3 extends A3 {
+  int value() {
+    return 0;
+  }
+}
+
+class A4 {
+  int value() {
+    return 4;
+  }
+}
+
+// Only loaded by reflection, see Main.chaCall().
+class SubA4 extends A4 {
+  int value() {
+    return 0;
+  }
+}
+
+public class Main {
+
+  /// CHECK-START: int Main.callValue(Base, int) inliner (before)
+  /// CHECK:                        InvokeVirtual method_name:Base.value
+
+  /// CHECK-START: int Main.callValue(Base, int) inliner (after)
+  /// CHECK-NOT:                    InvokeVirtual method_name:Base.value
+
+  /// CHECK-START: int Main.callValue(Base, int) inliner (after)
+  /// CHECK:                        Deoptimize
+
+  static int callValue(Base b, int expectation) {
+    int result = b.value();
+    check("callValue", expectation);
+    return result;
+  }
+
+  /// CHECK-START: int Main.chaCall(A1, A2, A3, A4, int) inliner (after)
+  /// CHECK-DAG: <<Zero:i\d+>>      IntConstant 0
+  /// CHECK-DAG: <<Flag:i\d+>>      ShouldDeoptimizeFlag
+  /// CHECK-DAG: <<Cond:z\d+>>      NotEqual [<<Flag>>,<<Zero>>]
+  /// CHECK-DAG:                    Deoptimize [<<Cond>>]
+
+  static int chaCall(A1 a1, A2 a2, A3 a3, A4 a4, int load) throws Exception {
+    int result = a1.value() + a2.value() + a3.value() + a4.value();
+    if (load != 0) {
+      check("chaCall", kExpectCompiled);
+      // Loading the class invalidates the devirtualized call to SubA<load>'s super method and
+      // flags this frame, which deoptimizes at the next guard.
+      Class.forName("SubA" + load);
+      result += a1.value() + a2.value() + a3.value() + a4.value();
+      check("chaCall", kExpectDeoptimized);
+    }
+    return result;
+  }
+
+  static void testSpeculationLimit() {
+    Base base = new Base();
+    Base[] others = { new Sub1(), new Sub2(), new Sub3() };
+    Base last = new Sub4();
+    // Record the receiver types from the first call on, so the first compilation sees a
+    // monomorphic inline cache.
+    ensureHasProfilingInfo(Main.class, "callValue");
+    for (int i = 0; i < 10; ++i) {
+      expectEquals(1, callValue(base, kNoExpectation));
+    }
+    for (int i = 0; i < others.length; ++i) {
+      ensureJitCompiled(Main.class, "callValue");
+      expectEquals(1, callValue(base, kExpectCompiled));
+      // The receiver class is not in the inline cache: the guard of the inlined calls fails.
+      expectEquals(i + 2, callValue(others[i], kExpectDeoptimized));
+    }
+    // After kMaxSpeculativeDeoptimizations, the method is compiled without HDeoptimize: an
+    // unexpected receiver takes the fallback invoke and the frame stays compiled.
+    ensureJitCompiled(Main.class, "callValue");
+    expectEquals(5, callValue(last, kExpectCompiled));
+    expectEquals(1, callValue(base, kExpectCompiled));
+  }
+
+  static void testClassHierarchyDeoptimizations() throws Exception {
+    A1 a1 = new A1();
+    A2 a2 = new A2();
+    A3 a3 = new A3();
+    A4 a4 = new A4();
+    for (int i = 0; i < 10; ++i) {
+      expectEquals(10, chaCall(a1, a2, a3, a4, 0));
+    }
+    // Each overriding class deoptimizes the frame on its CHA guard. These do not count as failed
+    // speculation, so the last compilation still devirtualizes A4.value() and deoptimizes.
+    for (int load = 1; load <= 4; ++load) {
+      ensureJitCompiled(Main.class, "chaCall");
+      expectEquals(20, chaCall(a1, a2, a3, a4, load));
+    }
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    // The JIT only inlines in non debuggable code.
+    inlining = hasJit() && !isDebuggable();
+    testSpeculationLimit();
+    testClassHierarchyDeoptimizations();
+    System.out.println("passed");
+  }
+
+  static final int kNoExpectation = 0;
+  static final int kExpectCompiled = 1;
+  static final int kExpectDeoptimized = 2;
+
+  static void check(String method, int expectation) {
+    if (!inlining || expectation == kNoExpectation) {
+      return;
+    }
+    // isInterpreted() looks at the frame of the caller of check().
+    boolean interpreted = isCallerInterpreted();
+    if (expectation == kExpectCompiled && interpreted) {
+      throw new Error("Expected " + method + " to be compiled");
+    }
+    if (expectation == kExpectDeoptimized && !interpreted) {
+      throw new Error("Expected " + method + " to be deoptimized");
+    }
+  }
+
+  static void expectEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  static boolean inlining;
+
+  private static native boolean hasJit();
+  private static native boolean isDebuggable();
+  private static native boolean isCallerInterpreted();
+  private static native void ensureHasProfilingInfo(Class<?> cls, String methodName);
+  private static native void ensureJitCompiled(Class<?> cls, String methodName);
+}
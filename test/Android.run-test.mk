@@ -570,6 +570,23 @@ endif
 TEST_ART_BROKEN_OPTIMIZING_READ_BARRIER_RUN_TESTS :=
 TEST_ART_BROKEN_JIT_READ_BARRIER_RUN_TESTS :=
 
+# Tests that should fail without read barriers with the Optimizing compiler (AOT).
+# 628: Card marks are only removed in the read barrier configuration, so the Checker assertions
+#      on the removed ones fail.
+TEST_ART_BROKEN_OPTIMIZING_NO_READ_BARRIER_RUN_TESTS := \
+  628-checker-write-barrier-elimination
+
+ifneq ($(ART_USE_READ_BARRIER),true)
+  ifneq (,$(filter optimizing,$(COMPILER_TYPES)))
+    ART_TEST_KNOWN_BROKEN += $(call all-run-test-names,$(TARGET_TYPES),$(RUN_TYPES), \
+        $(PREBUILD_TYPES),optimizing,$(RELOCATE_TYPES),$(TRACE_TYPES),$(GC_TYPES), \
+        $(JNI_TYPES),$(IMAGE_TYPES),$(PICTEST_TYPES),$(DEBUGGABLE_TYPES), \
+        $(TEST_ART_BROKEN_OPTIMIZING_NO_READ_BARRIER_RUN_TESTS),$(ALL_ADDRESS_SIZES))
+  endif
+endif
+
+TEST_ART_BROKEN_OPTIMIZING_NO_READ_BARRIER_RUN_TESTS :=
+
 TEST_ART_BROKEN_NPIC_RUN_TESTS := 596-app-images
 ifneq (,$(filter npictest,$(PICTEST_TYPES)))
   ART_TEST_KNOWN_BROKEN += $(call all-run-test-names,$(TARGET_TYPES),$(RUN_TYPES),$(PREBUILD_TYPES), \
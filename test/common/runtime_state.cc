@@ -121,6 +121,38 @@ extern "C" JNIEXPORT jboolean JNICALL Java_Main_compiledWithOptimizing(JNIEnv* e
   return JNI_TRUE;
 }
 
+// public static native boolean hasJit();
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasJit(JNIEnv*, jclass) {
+  Runtime* runtime = Runtime::Current();
+  return runtime != nullptr && runtime->GetJit() != nullptr;
+}
+
+// public static native boolean isDebuggable();
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_isDebuggable(JNIEnv*, jclass) {
+  return Runtime::Current()->IsDebuggable() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_Main_ensureHasProfilingInfo(JNIEnv* env,
+                                                                 jclass,
+                                                                 jclass cls,
+                                                                 jstring method_name) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr) {
+    return;
+  }
+
+  ScopedObjectAccess soa(Thread::Current());
+  ScopedUtfChars chars(env, method_name);
+  CHECK(chars.c_str() != nullptr);
+  ArtMethod* method = soa.Decode<mirror::Class*>(cls)->FindDeclaredDirectMethodByName(
+      chars.c_str(), kRuntimePointerSize);
+  CHECK(method != nullptr && !method->IsNative());
+  // Have the interpreter record the receiver types of the calls from now on.
+  ProfilingInfo::Create(soa.Self(), method, /* retry_allocation */ true);
+}
+
 extern "C" JNIEXPORT void JNICALL Java_Main_ensureJitCompiled(JNIEnv* env,
                                                              jclass,
                                                              jclass cls,
@@ -150,10 +182,12 @@ extern "C" JNIEXPORT void JNICALL Java_Main_ensureJitCompiled(JNIEnv* env,
       // Sleep to yield to the compiler thread.
       usleep(1000);
       ScopedObjectAccess soa(Thread::Current());
-      // Make sure there is a profiling info, required by the compiler.
-      ProfilingInfo::Create(soa.Self(), method, /* retry_allocation */ true);
+      // Make sure there is a profiling info, required by the compiler. JNI stubs do not need one.
+      if (!method->IsNative()) {
+        ProfilingInfo::Create(soa.Self(), method, /* retry_allocation */ true);
+      }
       // Will either ensure it's compiled or do the compilation itself.
-      jit->CompileMethod(method, soa.Self(), /* osr */ false);
+      jit->CompileMethod(method, soa.Self(), /* osr */ false, /* baseline */ false);
     }
   }
 }